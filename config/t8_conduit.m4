@@ -0,0 +1,47 @@
+dnl T8_CHECK_CONDUIT
+dnl Check for conduit support and link a test program
+dnl
+dnl This macro tries to link to the conduit library and its mesh blueprint.
+dnl Use the LIBS variable on the configure line to specify a different library
+dnl or use --with-conduit=<LIBRARIES>
+dnl
+dnl Using --with-conduit without any argument defaults to
+dnl -lconduit_blueprint -lconduit.
+dnl ParaView Catalyst and Ascent link their own conduit library, which
+dnl should be used here.
+dnl
+AC_DEFUN([T8_CHECK_CONDUIT], [
+
+AC_MSG_CHECKING([for conduit linkage])
+
+T8_ARG_WITH([conduit],
+  [conduit library for in-situ visualization (optionally use --with-conduit=<CONDUIT_LIBS>)],
+  [CONDUIT])
+if test "x$T8_WITH_CONDUIT" != xno ; then
+  T8_CONDUIT_LIBS="-lconduit_blueprint -lconduit"
+  if test "x$T8_WITH_CONDUIT" != xyes ; then
+    T8_CONDUIT_LIBS="$T8_WITH_CONDUIT"
+  fi
+  PRE_CONDUIT_LIBS="$LIBS"
+  LIBS="$LIBS $T8_CONDUIT_LIBS"
+  AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+  #include <conduit.h>
+  #include <conduit_blueprint.h>
+]],[[
+  conduit_node *node = conduit_node_create ();
+  conduit_node *info = conduit_node_create ();
+  conduit_blueprint_verify ("mesh", node, info);
+  conduit_node_destroy (info);
+  conduit_node_destroy (node);
+]])],,
+                 [AC_MSG_ERROR([Unable to link with conduit library])])
+dnl Keep the variables changed as done above
+dnl LIBS="$PRE_CONDUIT_LIBS"
+
+  AC_MSG_RESULT([successful])
+else
+  AC_MSG_RESULT([not used])
+fi
+
+])
@@ -0,0 +1,47 @@
+dnl T8_CHECK_HDF5
+dnl Check for hdf5 support and link a test program
+dnl
+dnl This macro tries to link to the hdf5 library.
+dnl Use the LIBS variable on the configure line to specify a different library
+dnl or use --with-hdf5=<LIBRARY>
+dnl
+dnl Using --with-hdf5 without any argument defaults to -lhdf5.
+dnl For parallel output with more than one process, hdf5 must be built
+dnl with parallel (MPI I/O) support.
+dnl
+AC_DEFUN([T8_CHECK_HDF5], [
+
+dnl This link test changes the LIBS variable in place for posterity
+dnl SAVE_LIBS="$LIBS"
+dnl T8_CHECK_LIB([hdf5], [H5Fcreate], [HDF5])
+dnl LIBS="$SAVE_LIBS"
+dnl AC_MSG_CHECKING([for hdf5 linkage])
+
+T8_ARG_WITH([hdf5],
+  [hdf5 library (optionally use --with-hdf5=<HDF5_LIBS>)],
+  [HDF5])
+if test "x$T8_WITH_HDF5" != xno ; then
+  T8_HDF5_LIBS="-lhdf5"
+  if test "x$T8_WITH_HDF5" != xyes ; then
+    T8_HDF5_LIBS="$T8_WITH_HDF5"
+    dnl AC_MSG_ERROR([Please provide --with-hdf5 without arguments])
+  fi
+  PRE_HDF5_LIBS="$LIBS"
+  LIBS="$LIBS $T8_HDF5_LIBS"
+  AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+  #include <hdf5.h>
+]],[[
+  hid_t fapl = H5Pcreate (H5P_FILE_ACCESS);
+  H5Pclose (fapl);
+]])],,
+                 [AC_MSG_ERROR([Unable to link with hdf5 library])])
+dnl Keep the variables changed as done above
+dnl LIBS="$PRE_HDF5_LIBS"
+
+  AC_MSG_RESULT([successful])
+else
+  AC_MSG_RESULT([not used])
+fi
+
+])
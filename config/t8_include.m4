@@ -48,6 +48,9 @@ dnl
 AC_DEFUN([T8_CHECK_LIBRARIES],
 [
 T8_CHECK_NETCDF([$1])
+T8_CHECK_HDF5([$1])
+T8_CHECK_CONDUIT([$1])
+T8_CHECK_TRACE([$1])
 T8_CHECK_VTK([$1])
 T8_CHECK_CPPSTD([$1])
 ])
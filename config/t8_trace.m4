@@ -0,0 +1,65 @@
+dnl T8_CHECK_TRACE
+dnl Check for a tracing backend and link a test program
+dnl
+dnl This macro selects the backend of the region annotations in t8_trace.h.
+dnl Use --with-trace=<BACKEND> with one of nvtx, caliper or scorep.
+dnl The nvtx and caliper backends link to -lnvToolsExt and -lcaliper,
+dnl use the LIBS variable on the configure line to specify their location.
+dnl The scorep backend requires to build t8code with the scorep
+dnl compiler wrapper, for example CC="scorep --user mpicc".
+dnl
+dnl Without --with-trace the annotations compile to nothing.
+dnl
+AC_DEFUN([T8_CHECK_TRACE], [
+
+T8_ARG_WITH([trace],
+  [region annotations for external profilers (use --with-trace=<nvtx|caliper|scorep>)],
+  [TRACE])
+if test "x$T8_WITH_TRACE" != xno ; then
+  case "x$T8_WITH_TRACE" in
+  xnvtx)
+    LIBS="$LIBS -lnvToolsExt"
+    AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+  #include <nvToolsExt.h>
+]],[[
+  nvtxRangePushA ("t8");
+  nvtxRangePop ();
+]])],,
+                   [AC_MSG_ERROR([Unable to link with nvtx library])])
+    AC_DEFINE([TRACE_NVTX], 1, [Define to 1 if tracing with NVTX])
+    ;;
+  xcaliper)
+    LIBS="$LIBS -lcaliper"
+    AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+  #include <caliper/cali.h>
+]],[[
+  cali_begin_region ("t8");
+  cali_end_region ("t8");
+]])],,
+                   [AC_MSG_ERROR([Unable to link with caliper library])])
+    AC_DEFINE([TRACE_CALIPER], 1, [Define to 1 if tracing with Caliper])
+    ;;
+  xscorep)
+    AC_LINK_IFELSE([AC_LANG_PROGRAM(
+[[
+  #include <scorep/SCOREP_User.h>
+]],[[
+  SCOREP_USER_REGION_BY_NAME_BEGIN ("t8", SCOREP_USER_REGION_TYPE_COMMON);
+  SCOREP_USER_REGION_BY_NAME_END ("t8");
+]])],,
+                   [AC_MSG_ERROR([Unable to link with Score-P user regions])])
+    AC_DEFINE([TRACE_SCOREP], 1, [Define to 1 if tracing with Score-P])
+    ;;
+  *)
+    AC_MSG_ERROR([Please provide --with-trace with nvtx, caliper or scorep])
+    ;;
+  esac
+
+  AC_MSG_RESULT([successful])
+else
+  AC_MSG_RESULT([not used])
+fi
+
+])
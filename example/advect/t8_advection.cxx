@@ -33,8 +33,10 @@
 #include <t8_cmesh_vtk.h>
 #include <t8_vec.h>
 
-#define MAX_FACES 8             /* The maximum number of faces of an element */
-/* TODO: This is not memory efficient. If we run out of memory, we can optimize here. */
+/* The phases of the time loop that can be switched off with -P */
+#define ADVECT_PHASE_ADAPT 1    /* readapt the mesh every adapt_freq steps */
+#define ADVECT_PHASE_PARTITION 2        /* repartition the adapted mesh */
+#define ADVECT_PHASE_ALL 3
 
 /* Enum for statistics. */
 typedef enum
@@ -59,6 +61,7 @@ typedef enum
   ADVECT_DUMMY,                 /* dummy operations to increase load (see -s option) */
   ADVECT_SOLVE,                 /* solver runtime */
   ADVECT_TOTAL,                 /* overall runtime */
+  ADVECT_ELEM_RATE,             /* element updates per second of the solver */
   ADVECT_ERROR_INF,             /* l_infty error */
   ADVECT_ERROR_2,               /* L_2 error */
   ADVECT_VOL_LOSS,              /* The loss in volume (region with LS < 0) in percent */
@@ -87,6 +90,7 @@ const char         *advect_stat_names[ADVECT_NUM_STATS] = {
   "dummy_ops",
   "solve",
   "total",
+  "element_updates_per_second",
   "l_infty_error",
   "L_2",
   "volume_loss_[%]"
@@ -108,6 +112,8 @@ typedef struct
                               num_local_elements + num_ghosts */
   /* TODO: shorten element_data by number of ghosts */
   sc_array_t         *element_data_adapt; /**< element_data for the adapted forest, used during adaptation to interpolate values */
+  sc_array_t         *faces; /**< The faces of the local elements as t8_forest_face_pair_t.
+                                  \see t8_forest_face_list */
   /* We store the phi values in an extra array, since this data must exist for ghost
    * element as well and is communicated with other processes in ghost_exchange. */
   sc_array_t         *phi_values; /**< For each element and ghost its phi value. */
@@ -139,15 +145,9 @@ typedef struct
   double              midpoint[3]; /**< coordinates of element midpoint in R^3 */
   double              vol; /**< Volume of this element */
   double              phi_new; /**< Value of solution at midpoint in next time step */
-  double             *fluxes[MAX_FACES]; /**< The fluxes to each neeighbor at a given face */
-  int                 flux_valid[MAX_FACES];  /**< If > 0, this flux was computed, if 0 memory was allocated
-                                                   for this flux, but not computed. If < 0, no memory was allocated. */
+  double              flux_sum; /**< The sum of the fluxes across the faces in this time step */
   int                 level; /**< The refinement level of the element. */
   int                 num_faces; /**< The number of faces */
-  int                 num_neighbors[MAX_FACES]; /**< Number of neighbors for each face */
-  int                *dual_faces[MAX_FACES]; /**< The face indices of the neighbor elements */
-  t8_locidx_t        *neighs[MAX_FACES]; /**< Indices of the neighbor elements */
-  int8_t              neigh_level[MAX_FACES]; /**< The level of the face neighbors at this face. */
 } t8_advect_element_data_t;
 
 /* Return the phi value of a given local or ghost element.
@@ -469,12 +469,16 @@ t8_advect_flux_upwind_1d (const t8_advect_problem_t * problem,
 /* face is the face number as seen from el_data_plus */
 /* This works also if element_plus hangs on element_minus.
  * It does not work if it hangs the other way around. */
+/* If element_plus is a leaf of the forest, leid_in_tree is its index in
+ * the tree and the face geometry is taken from the forest's geometry cache,
+ * if present. Otherwise leid_in_tree is -1. */
 static double
 t8_advect_flux_upwind (const t8_advect_problem_t * problem,
                        double el_plus_phi,
                        double el_minus_phi,
                        t8_locidx_t ltreeid,
                        const t8_element_t * element_plus,
+                       t8_locidx_t leid_in_tree,
                        const double *tree_vertices, int face)
 {
   double              face_center[3];
@@ -488,18 +492,32 @@ t8_advect_flux_upwind (const t8_advect_problem_t * problem,
    *          face_center
    */
 
-  /* Compute the center coordinate of the face */
-  t8_forest_element_face_centroid (problem->forest, ltreeid, element_plus,
-                                   face, tree_vertices, face_center);
+  if (leid_in_tree >= 0 && t8_forest_has_geometry_cache (problem->forest)) {
+    /* Look up the face center, normal and area */
+    t8_vec_axb (t8_forest_element_cached_face_centroid
+                (problem->forest, ltreeid, leid_in_tree, face), face_center,
+                1, 0);
+    t8_vec_axb (t8_forest_element_cached_face_normal
+                (problem->forest, ltreeid, leid_in_tree, face), normal, 1,
+                0);
+    area =
+      t8_forest_element_cached_face_area (problem->forest, ltreeid,
+                                          leid_in_tree, face);
+  }
+  else {
+    /* Compute the center coordinate of the face */
+    t8_forest_element_face_centroid (problem->forest, ltreeid, element_plus,
+                                     face, tree_vertices, face_center);
+    /* Compute the normal of the element at this face */
+    t8_forest_element_face_normal (problem->forest, ltreeid, element_plus,
+                                   face, tree_vertices, normal);
+    /* Compute the area of the face */
+    area =
+      t8_forest_element_face_area (problem->forest, ltreeid, element_plus,
+                                   face, tree_vertices);
+  }
   /* Compute u at the face center. */
   problem->u (face_center, problem->t, u_at_face_center);
-  /* Compute the normal of the element at this face */
-  t8_forest_element_face_normal (problem->forest, ltreeid, element_plus,
-                                 face, tree_vertices, normal);
-  /* Compute the area of the face */
-  area =
-    t8_forest_element_face_area (problem->forest, ltreeid, element_plus,
-                                 face, tree_vertices);
 
   /* Compute the dot-product of u and the normal vector */
   normal_times_u = t8_vec_dot (normal, u_at_face_center);
@@ -536,7 +554,9 @@ t8_advect_flux_upwind (const t8_advect_problem_t * problem,
   }
 }
 
-/* Compute the flux if the element has hanging neighbors:
+/* Compute the flux across a face child of an element whose neighbors at
+ * this face are smaller, that is the flux of the face between the element
+ * and its neighbor at the given subface:
  *
  *  x -- x ---- x
  *  |    |      |
@@ -547,85 +567,38 @@ t8_advect_flux_upwind (const t8_advect_problem_t * problem,
  * neighs  el_hang
  *
  */
-int                 a = 0;
 static double
-t8_advect_flux_upwind_hanging (const t8_advect_problem_t * problem,
-                               t8_locidx_t iel_hang,
+t8_advect_flux_upwind_subface (const t8_advect_problem_t * problem,
+                               double el_plus_phi, double el_minus_phi,
                                t8_locidx_t ltreeid,
-                               t8_element_t * element_hang,
+                               const t8_element_t * element_hang,
                                const double *tree_vertices, int face,
-                               int adapted_or_partitioned)
+                               int subface)
 {
-  int                 i, num_face_children, child_face;
+  int                 num_face_children, child_face;
   t8_eclass_scheme_c *ts;
-  t8_eclass           eclass;
   t8_element_t      **face_children;
-  t8_advect_element_data_t *neigh_data;
-  double              flux = 0;
-  int                 dual_face;
-  t8_locidx_t         neigh_id;
-  int                 neigh_is_ghost;
-  t8_advect_element_data_t *el_hang;
-  double              phi_plus, phi_minus;
+  double              flux;
 
-  /* Get a pointer to the element */
-  el_hang = (t8_advect_element_data_t *)
-    t8_sc_array_index_locidx (problem->element_data, iel_hang);
-  /* Get the eclass and the scheme for the element */
-  eclass = t8_forest_get_tree_class (problem->forest, ltreeid);
-  ts = t8_forest_get_eclass_scheme (problem->forest, eclass);
+  /* Get the scheme for the element */
+  ts = t8_forest_get_eclass_scheme (problem->forest,
+                                    t8_forest_get_tree_class (problem->forest,
+                                                              ltreeid));
   /* Compute the children of the element at the face */
   num_face_children = ts->t8_element_num_face_children (element_hang, face);
-  T8_ASSERT (num_face_children == el_hang->num_neighbors[face]);
-
+  T8_ASSERT (0 <= subface && subface < num_face_children);
   face_children = T8_ALLOC (t8_element_t *, num_face_children);
   ts->t8_element_new (num_face_children, face_children);
   ts->t8_element_children_at_face (element_hang, face, face_children,
                                    num_face_children, NULL);
-
-  /* Store the phi value of el_hang. We use it as the phi value of the
-   * children to compute the flux */
-  phi_plus = t8_advect_element_get_phi (problem, iel_hang);
-
-  for (i = 0; i < num_face_children; i++) {
-    child_face = ts->t8_element_face_child_face (element_hang, face, i);
-    /* Get a pointer to the neighbor's element data */
-    neigh_id = el_hang->neighs[face][i];
-    neigh_data = (t8_advect_element_data_t *)
-      t8_sc_array_index_locidx (problem->element_data, neigh_id);
-    neigh_is_ghost =
-      neigh_id >= t8_forest_get_local_num_elements (problem->forest);
-    phi_minus = t8_advect_element_get_phi (problem, neigh_id);
-    /* Compute the flux */
-    el_hang->fluxes[face][i] =
-      t8_advect_flux_upwind (problem, phi_plus, phi_minus, ltreeid,
-                             face_children[i], tree_vertices, child_face);
-    // if (a == 1) printf  ("%i %i %f\n",face, i, el_hang->fluxes[face][i]);
-    /* Set the flux of the neighbor element */
-    dual_face = el_hang->dual_faces[face][i];
-    if (!adapted_or_partitioned && !neigh_is_ghost) {
-
-      if (neigh_data->flux_valid[dual_face] < 0) {
-        /* We need to allocate the fluxes */
-        neigh_data->fluxes[dual_face] = T8_ALLOC (double, 1);
-      }
-      // printf ("face %i neigh %i df %i\n", face, neigh_id, dual_face);
-      SC_CHECK_ABORT (dual_face < neigh_data->num_faces, "num\n");
-      // SC_CHECK_ABORT (neigh_data->num_neighbors[dual_face] == 1, "entry\n");
-      neigh_data->num_neighbors[dual_face] = 1;
-      neigh_data->fluxes[dual_face][0] = -el_hang->fluxes[face][i];
-      neigh_data->flux_valid[dual_face] = 1;
-    }
-
-    flux += el_hang->fluxes[face][i];
-  }
-
-  el_hang->flux_valid[face] = 1;
+  /* The flux across the face of the child is the flux to the neighbor */
+  child_face = ts->t8_element_face_child_face (element_hang, face, subface);
+  flux = t8_advect_flux_upwind (problem, el_plus_phi, el_minus_phi, ltreeid,
+                                face_children[subface], -1, tree_vertices,
+                                child_face);
   /* clean-up */
   ts->t8_element_destroy (num_face_children, face_children);
   T8_FREE (face_children);
-
-  a = 2;
   return flux;
 }
 
@@ -708,13 +681,90 @@ t8_advect_flux_lax_friedrich_1d (const t8_advect_problem_t * problem,
 }
 #endif
 
+/* Compute the sum of the fluxes across the faces of each local element.
+ * We loop over the face list, such that the flux across a face between two
+ * local elements is computed once and added to both elements. */
+static void
+t8_advect_compute_fluxes (t8_advect_problem_t * problem)
+{
+  const t8_forest_face_pair_t *pair;
+  t8_advect_element_data_t *elem_data;
+  const t8_element_t *element;
+  t8_locidx_t         num_local_elements, lelement, num_pairs, ipair;
+  t8_locidx_t         itree = 0, tree_offset = 0, tree_num_elements = 0;
+  double             *tree_vertices = NULL;
+  double              flux, phi_plus, phi_minus;
+
+  num_local_elements = t8_forest_get_local_num_elements (problem->forest);
+  for (lelement = 0; lelement < num_local_elements; lelement++) {
+    elem_data = (t8_advect_element_data_t *)
+      t8_sc_array_index_locidx (problem->element_data, lelement);
+    elem_data->flux_sum = 0;
+  }
+  if (t8_forest_get_num_local_trees (problem->forest) > 0) {
+    tree_num_elements = t8_forest_get_tree_num_elements (problem->forest, 0);
+    tree_vertices = t8_forest_get_tree_vertices (problem->forest, 0);
+  }
+  num_pairs = (t8_locidx_t) problem->faces->elem_count;
+  for (ipair = 0; ipair < num_pairs; ipair++) {
+    pair = (const t8_forest_face_pair_t *)
+      t8_sc_array_index_locidx (problem->faces, ipair);
+    /* The faces are sorted by their local element, find its tree */
+    while (pair->elements[0] >= tree_offset + tree_num_elements) {
+      tree_offset += tree_num_elements;
+      itree++;
+      tree_num_elements =
+        t8_forest_get_tree_num_elements (problem->forest, itree);
+      tree_vertices = t8_forest_get_tree_vertices (problem->forest, itree);
+    }
+    if (problem->dim == 1) {
+      flux = t8_advect_flux_upwind_1d (problem, pair->elements[0],
+                                       pair->elements[1], pair->faces[0]);
+    }
+    else {
+      T8_ASSERT (problem->dim == 2 || problem->dim == 3);
+      element = t8_forest_get_element_in_tree (problem->forest, itree,
+                                               pair->elements[0] -
+                                               tree_offset);
+      phi_plus = t8_advect_element_get_phi (problem, pair->elements[0]);
+      if (pair->elements[1] < 0) {
+        /* This element is at the domain boundary.
+         * We enforce outflow boundary conditions */
+        t8_advect_boundary_set_phi (problem, pair->elements[0], &phi_minus);
+      }
+      else {
+        phi_minus = t8_advect_element_get_phi (problem, pair->elements[1]);
+      }
+      if (pair->subface < 0) {
+        flux = t8_advect_flux_upwind (problem, phi_plus, phi_minus, itree,
+                                      element,
+                                      pair->elements[0] - tree_offset,
+                                      tree_vertices, pair->faces[0]);
+      }
+      else {
+        /* The neighbor is a smaller ghost at a face child */
+        flux = t8_advect_flux_upwind_subface (problem, phi_plus, phi_minus,
+                                              itree, element, tree_vertices,
+                                              pair->faces[0], pair->subface);
+      }
+    }
+    /* The flux into one element is the flux out of the other */
+    elem_data = (t8_advect_element_data_t *)
+      t8_sc_array_index_locidx (problem->element_data, pair->elements[0]);
+    elem_data->flux_sum += flux;
+    if (0 <= pair->elements[1] && pair->elements[1] < num_local_elements) {
+      elem_data = (t8_advect_element_data_t *)
+        t8_sc_array_index_locidx (problem->element_data, pair->elements[1]);
+      elem_data->flux_sum -= flux;
+    }
+  }
+}
+
 static void
 t8_advect_advance_element (t8_advect_problem_t * problem,
                            t8_locidx_t lelement)
 {
-  int                 iface, ineigh;
-  double              flux_sum = 0;
-  int                 num_faces;
+  double              flux_sum;
   double              phi;
   t8_advect_element_data_t *elem;
 
@@ -723,14 +773,8 @@ t8_advect_advance_element (t8_advect_problem_t * problem,
     t8_sc_array_index_locidx (problem->element_data, lelement);
   /* Get the phi value of the element */
   phi = t8_advect_element_get_phi (problem, lelement);
-  num_faces = elem->num_faces;
-  /* Sum all the fluxes */
-  for (iface = 0; iface < num_faces; iface++) {
-    for (ineigh = 0; ineigh < SC_MAX (1, elem->num_neighbors[iface]);
-         ineigh++) {
-      flux_sum += elem->fluxes[iface][ineigh];
-    }
-  }
+  /* The sum of the fluxes was computed by t8_advect_compute_fluxes */
+  flux_sum = elem->flux_sum;
   /* Phi^t = dt/dx * (f_(j-1/2) - f_(j+1/2)) + Phi^(t-1) */
   elem->phi_new = (problem->delta_t / elem->vol) * flux_sum + phi;
 #if 0
@@ -767,6 +811,7 @@ t8_advect_compute_element_data (t8_advect_problem_t * problem,
 }
 
 /* Replace callback to decide how to interpolate a refined or coarsened element.
+ * Unchanged elements are passed as a run and keep their phi values.
  * If an element is refined, each child gets the phi value of its parent.
  * If elements are coarsened, the parent gets the average phi value of the children.
  */
@@ -788,7 +833,7 @@ t8_advect_replace (t8_forest_t forest_old,
   t8_advect_element_data_t *elem_data_in, *elem_data_out;
   t8_locidx_t         first_incoming_data, first_outgoing_data;
   t8_element_t       *element;
-  int                 i, iface;
+  int                 i;
   double              phi_old;
 
   /* Get the problem description */
@@ -811,22 +856,22 @@ t8_advect_replace (t8_forest_t forest_old,
 
   /* Get the old phi value (used in the cases with num_outgoing = 1) */
   phi_old = t8_advect_element_get_phi (problem, first_outgoing_data);
-  if (num_incoming == num_outgoing && num_incoming == 1) {
-    /* The element is not changed, copy phi and vol */
-    memcpy (elem_data_in, elem_data_out, sizeof (t8_advect_element_data_t));
-    t8_advect_element_set_phi_adapt (problem, first_incoming_data, phi_old);
-    /* Get a pointer to the new element */
-    element =
-      t8_forest_get_element_in_tree (problem->forest_adapt, which_tree,
-                                     first_incoming);
-    /* Set the neighbor entries to uninitialized */
-    T8_ASSERT (elem_data_in->num_faces == ts->t8_element_num_faces (element));
-    for (iface = 0; iface < elem_data_in->num_faces; iface++) {
-      elem_data_in->num_neighbors[iface] = 0;
-      elem_data_in->flux_valid[iface] = -1;
-      elem_data_in->dual_faces[iface] = NULL;
-      elem_data_in->fluxes[iface] = NULL;
-      elem_data_in->neighs[iface] = NULL;
+  if (num_incoming == num_outgoing) {
+    /* The elements are not changed, copy phi and vol */
+    memcpy (elem_data_in, elem_data_out,
+            num_incoming * sizeof (t8_advect_element_data_t));
+    for (i = 0; i < num_incoming; i++) {
+      phi_old = t8_advect_element_get_phi (problem, first_outgoing_data + i);
+      t8_advect_element_set_phi_adapt (problem, first_incoming_data + i,
+                                       phi_old);
+#ifdef T8_ENABLE_DEBUG
+      /* Get a pointer to the new element */
+      element =
+        t8_forest_get_element_in_tree (problem->forest_adapt, which_tree,
+                                       first_incoming + i);
+      T8_ASSERT (elem_data_in[i].num_faces ==
+                 ts->t8_element_num_faces (element));
+#endif
     }
   }
   else if (num_outgoing == 1) {
@@ -842,17 +887,9 @@ t8_advect_replace (t8_forest_t forest_old,
                                       which_tree, ts, NULL);
       t8_advect_element_set_phi_adapt (problem, first_incoming_data + i,
                                        phi_old);
-      /* Set the neighbor entries to uninitialized */
       elem_data_in[i].num_faces = elem_data_out->num_faces;
       T8_ASSERT (elem_data_in[i].num_faces ==
                  ts->t8_element_num_faces (element));
-      for (iface = 0; iface < elem_data_in[i].num_faces; iface++) {
-        elem_data_in[i].num_neighbors[iface] = 0;
-        elem_data_in[i].flux_valid[iface] = -1;
-        elem_data_in[i].dual_faces[iface] = NULL;
-        elem_data_in[i].fluxes[iface] = NULL;
-        elem_data_in[i].neighs[iface] = NULL;
-      }
       /* Update the level */
       elem_data_in[i].level = elem_data_out->level + 1;
     }
@@ -876,52 +913,13 @@ t8_advect_replace (t8_forest_t forest_old,
     }
     phi /= num_outgoing;
     t8_advect_element_set_phi_adapt (problem, first_incoming_data, phi);
-    /* Set the neighbor entries to uninitialized */
     elem_data_in->num_faces = elem_data_out[0].num_faces;
     T8_ASSERT (elem_data_in->num_faces == ts->t8_element_num_faces (element));
-    for (iface = 0; iface < elem_data_in->num_faces; iface++) {
-      elem_data_in->num_neighbors[iface] = 0;
-      elem_data_in->flux_valid[iface] = -1;
-      elem_data_in->dual_faces[iface] = NULL;
-      elem_data_in->fluxes[iface] = NULL;
-      elem_data_in->neighs[iface] = NULL;
-    }
     /* update the level */
     elem_data_in->level = elem_data_out->level - 1;
   }
 }
 
-static void
-t8_advect_problem_elements_destroy (t8_advect_problem_t * problem)
-{
-
-  t8_locidx_t         lelement, num_local_elem;
-  int                 iface;
-  t8_advect_element_data_t *elem_data;
-
-  num_local_elem = t8_forest_get_local_num_elements (problem->forest);
-  T8_ASSERT (num_local_elem <=
-             (t8_locidx_t) problem->element_data->elem_count);
-  /* destroy all elements */
-  for (lelement = 0; lelement < num_local_elem; lelement++) {
-    elem_data = (t8_advect_element_data_t *)
-      t8_sc_array_index_locidx (problem->element_data, lelement);
-    for (iface = 0; iface < elem_data->num_faces; iface++) {
-      /* TODO: make face number dim independent */
-      if (elem_data->num_neighbors[iface] > 0) {
-        T8_FREE (elem_data->neighs[iface]);
-        T8_FREE (elem_data->dual_faces[iface]);
-        T8_FREE (elem_data->fluxes[iface]);
-        elem_data->num_neighbors[iface] = 0;
-        elem_data->flux_valid[iface] = -1;
-      }
-      else {
-        T8_FREE (elem_data->fluxes[iface]);
-      }
-    }
-  }
-}
-
 /* Adapt the forest and interpolate the phi values to the new grid,
  * compute the new u values on the grid */
 static void
@@ -952,6 +950,10 @@ t8_advect_problem_adapt (t8_advect_problem_t * problem, int measure_time)
   }
   /* We also want ghost elements in the new forest */
   t8_forest_set_ghost (problem->forest_adapt, 1, T8_GHOST_FACES);
+  /* Store the face geometry and the face neighbors of the elements
+   * for the flux computation */
+  t8_forest_set_geometry_cache (problem->forest_adapt, 1);
+  t8_forest_set_face_connectivity (problem->forest_adapt, 1);
   /* Commit the forest, adaptation and balance happens here */
   t8_forest_commit (problem->forest_adapt);
 
@@ -992,10 +994,11 @@ t8_advect_problem_adapt (t8_advect_problem_t * problem, int measure_time)
   /* We now call iterate_replace in which we interpolate the new element data.
    * It is necessary that the old and new forest only differ by at most one level.
    * We guarantee this by calling adapt non-recursively and calling balance without
-   * repartitioning. */
+   * repartitioning.
+   * Runs of unchanged elements are passed to t8_advect_replace at once. */
   replace_time = -sc_MPI_Wtime ();
-  t8_forest_iterate_replace (problem->forest_adapt, problem->forest,
-                             t8_advect_replace);
+  t8_forest_iterate_replace_runs (problem->forest_adapt, problem->forest,
+                                  t8_advect_replace, NULL, NULL);
   replace_time += sc_MPI_Wtime ();
   if (measure_time) {
     sc_stats_accumulate (&problem->stats[ADVECT_REPLACE], replace_time);
@@ -1006,7 +1009,6 @@ t8_advect_problem_adapt (t8_advect_problem_t * problem, int measure_time)
     problem->stats[ADVECT_AMR].count = 1;
   }
   /* clean the old element data */
-  t8_advect_problem_elements_destroy (problem);
   sc_array_destroy (problem->element_data);
   sc_array_destroy (problem->phi_values);
   /* Free memory for the forest */
@@ -1044,6 +1046,8 @@ t8_advect_problem_partition (t8_advect_problem_t * problem, int measure_time)
   /* Partition the forest and create ghosts */
   t8_forest_set_partition (forest_partition, problem->forest, 0);
   t8_forest_set_ghost (forest_partition, 1, T8_GHOST_FACES);
+  t8_forest_set_geometry_cache (forest_partition, 1);
+  t8_forest_set_face_connectivity (forest_partition, 1);
   t8_forest_commit (forest_partition);
   /* Add runtimes to internal stats */
   if (measure_time) {
@@ -1095,7 +1099,6 @@ t8_advect_problem_partition (t8_advect_problem_t * problem, int measure_time)
   }
 
   /* destroy the old forest and the element data */
-  t8_advect_problem_elements_destroy (problem);
   t8_forest_unref (&problem->forest);
   problem->forest = forest_partition;
   sc_array_destroy (problem->element_data);
@@ -1209,8 +1212,14 @@ t8_advect_problem_init (t8_cmesh_t cmesh,
   /* Contruct uniform forest with ghosts */
   default_scheme = t8_scheme_new_default_cxx ();
 
-  problem->forest =
-    t8_forest_new_uniform (cmesh, default_scheme, level, 1, comm);
+  t8_forest_init (&problem->forest);
+  t8_forest_set_cmesh (problem->forest, cmesh, comm);
+  t8_forest_set_scheme (problem->forest, default_scheme);
+  t8_forest_set_level (problem->forest, level);
+  t8_forest_set_ghost (problem->forest, 1, T8_GHOST_FACES);
+  /* The face list of the flux computation needs the face connectivity */
+  t8_forest_set_face_connectivity (problem->forest, 1);
+  t8_forest_commit (problem->forest);
 
   /* Initialize the element array with num_local_elements + num_ghosts entries. */
 
@@ -1218,6 +1227,7 @@ t8_advect_problem_init (t8_cmesh_t cmesh,
     sc_array_new_count (sizeof (t8_advect_element_data_t),
                         t8_forest_get_local_num_elements (problem->forest));
   problem->element_data_adapt = NULL;
+  problem->faces = sc_array_new (sizeof (t8_forest_face_pair_t));
 
   /* initialize the phi array */
   problem->phi_values =
@@ -1228,14 +1238,12 @@ t8_advect_problem_init (t8_cmesh_t cmesh,
   return problem;
 }
 
-/* Project the solution at the last time step to the forest.
- * Also set the fluxes to invalid */
+/* Project the solution at the last time step to the forest. */
 static void
 t8_advect_project_element_data (t8_advect_problem_t * problem)
 {
   t8_locidx_t         num_local_elements, ielem;
   t8_advect_element_data_t *elem_data;
-  int                 iface;
 
   num_local_elements = t8_forest_get_local_num_elements (problem->forest);
   for (ielem = 0; ielem < num_local_elements; ielem++) {
@@ -1244,13 +1252,6 @@ t8_advect_project_element_data (t8_advect_problem_t * problem)
     /* Currently the mesh does not change, thus the projected value is
      * just the computed value */
     t8_advect_element_set_phi (problem, ielem, elem_data->phi_new);
-    /* Set all fluxes to invalid */
-    for (iface = 0; iface < elem_data->num_faces; iface++) {
-      if (elem_data->flux_valid[iface] >= 0) {
-        /* If they are allocated (>= 0), set to allocated and not computed (=0) */
-        elem_data->flux_valid[iface] = 0;
-      }
-    }
   }
 }
 
@@ -1259,10 +1260,9 @@ t8_advect_problem_init_elements (t8_advect_problem_t * problem)
 {
   t8_locidx_t         itree, ielement, idata;
   t8_locidx_t         num_trees, num_elems_in_tree;
-  t8_element_t       *element, **neighbors;
-  int                 iface, ineigh;
+  t8_element_t       *element;
   t8_advect_element_data_t *elem_data;
-  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_eclass_scheme_c *ts;
   double             *tree_vertices;
   double              speed, max_speed = 0, min_diam =
     -1, delta_t, min_delta_t;
@@ -1317,35 +1317,8 @@ t8_advect_problem_init_elements (t8_advect_problem_t * problem)
                                                  problem->udata_for_phi));
       /* Set the level */
       elem_data->level = ts->t8_element_level (element);
-      /* Set the faces */
+      /* Set the number of faces */
       elem_data->num_faces = ts->t8_element_num_faces (element);
-      for (iface = 0; iface < elem_data->num_faces; iface++) {
-        /* Compute the indices of the face neighbors */
-
-        t8_forest_leaf_face_neighbors (problem->forest, itree, element,
-                                       &neighbors, iface,
-                                       &elem_data->dual_faces[iface],
-                                       &elem_data->num_neighbors[iface],
-                                       &elem_data->neighs[iface],
-                                       &neigh_scheme, 1);
-        for (ineigh = 0; ineigh < elem_data->num_neighbors[iface]; ineigh++) {
-          elem_data->neigh_level[iface] =
-            neigh_scheme->t8_element_level (neighbors[ineigh]);
-        }
-
-        if (elem_data->num_neighbors[iface] > 0) {
-          neigh_scheme->t8_element_destroy (elem_data->num_neighbors[iface],
-                                            neighbors);
-          T8_FREE (neighbors);
-          //t8_global_essentialf("alloc face %i of elem %i\n", iface, ielement);
-          elem_data->fluxes[iface] =
-            T8_ALLOC (double, elem_data->num_neighbors[iface]);
-        }
-        else {
-          elem_data->fluxes[iface] = T8_ALLOC (double, 1);
-        }
-        elem_data->flux_valid[iface] = 0;
-      }
     }
   }
   /* Exchange ghost values */
@@ -1473,10 +1446,9 @@ t8_advect_problem_destroy (t8_advect_problem_t ** pproblem)
   if (problem == NULL) {
     return;
   }
-  /* destroy elements */
-  t8_advect_problem_elements_destroy (problem);
-  /* Free the element array */
+  /* Free the element and face arrays */
   sc_array_destroy (problem->element_data);
+  sc_array_destroy (problem->faces);
   if (problem->element_data_adapt != NULL) {
     sc_array_destroy (problem->element_data_adapt);
   }
@@ -1491,36 +1463,78 @@ t8_advect_problem_destroy (t8_advect_problem_t ** pproblem)
   *pproblem = NULL;
 }
 
+/* Print the total runtime of each phase of the time loop with its minimum
+ * and maximum over all processes and the global element update rate.
+ * The statistics in problem->stats accumulate the single measurements,
+ * such that their minimum and maximum are those of one measurement. */
+static void
+t8_advect_print_benchmark (t8_advect_problem_t * problem,
+                           double local_updates, double solve_time)
+{
+  const advect_stats_t phases[] = {
+    ADVECT_ADAPT, ADVECT_BALANCE, ADVECT_REPLACE, ADVECT_PARTITION,
+    ADVECT_PARTITION_DATA, ADVECT_GHOST, ADVECT_GHOST_EXCHANGE,
+    ADVECT_NEIGHS, ADVECT_FLUX, ADVECT_SOLVE
+  };
+  const int           num_phases = sizeof (phases) / sizeof (phases[0]);
+  sc_statinfo_t       totals[sizeof (phases) / sizeof (phases[0])];
+  double              global_updates, max_solve_time;
+  int                 iphase, mpiret;
+
+  for (iphase = 0; iphase < num_phases; iphase++) {
+    sc_stats_set1 (&totals[iphase], problem->stats[phases[iphase]].sum_values,
+                   advect_stat_names[phases[iphase]]);
+  }
+  sc_stats_compute (problem->comm, num_phases, totals);
+  t8_global_essentialf ("[advect] Benchmark: %i time steps\n",
+                        problem->num_time_steps);
+  t8_global_essentialf ("[advect] %-20s %12s %12s %12s\n", "phase",
+                        "min [s]", "avg [s]", "max [s]");
+  for (iphase = 0; iphase < num_phases; iphase++) {
+    t8_global_essentialf ("[advect] %-20s %12.4e %12.4e %12.4e\n",
+                          totals[iphase].variable, totals[iphase].min,
+                          totals[iphase].average, totals[iphase].max);
+  }
+  /* The solver is as fast as its slowest process */
+  mpiret = sc_MPI_Allreduce (&local_updates, &global_updates, 1,
+                             sc_MPI_DOUBLE, sc_MPI_SUM, problem->comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&solve_time, &max_solve_time, 1,
+                             sc_MPI_DOUBLE, sc_MPI_MAX, problem->comm);
+  SC_CHECK_MPI (mpiret);
+  t8_global_essentialf ("[advect] %.0f element updates in %.4e s:"
+                        " %.4e elements per second\n", global_updates,
+                        max_solve_time,
+                        max_solve_time > 0 ? global_updates / max_solve_time
+                        : 0);
+}
+
+/* Solve the advection problem.
+ * If num_steps > 0, exactly num_steps time steps are computed and T is
+ * ignored. The phases of the time loop are selected by the
+ * ADVECT_PHASE_* bits of phases. If benchmark is true, the runtimes of
+ * the phases are printed with their extrema over the processes. */
 static void
 t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
                  t8_example_level_set_fn phi_0, void *ls_data,
                  const int level, const int maxlevel, double T, double cfl,
                  sc_MPI_Comm comm, int adapt_freq, int no_vtk,
                  int vtk_freq, double band_width, int dim, int dummy_op,
-                 int volume_refine)
+                 int volume_refine, int num_steps, int phases,
+                 int benchmark)
 {
   t8_advect_problem_t *problem;
-  int                 iface, ineigh;
-  t8_locidx_t         itree, ielement, lelement;
-  t8_advect_element_data_t *elem_data, *neigh_data = NULL;
-  double              flux;
+  t8_locidx_t         lelement, num_local_elements;
   double              l_infty, L_2;
-  double             *tree_vertices;
   int                 modulus, time_steps;
-  int                 num_faces;
   int                 done = 0;
-  int                 adapted_or_partitioned = 0;
-  int                 dual_face;
-  t8_element_t       *elem, **neighs;
-  t8_eclass_scheme_c *neigh_scheme;
+  int                 faces_outdated = 1;
   double              total_time, solve_time = 0;
   double              ghost_exchange_time, ghost_waittime, neighbor_time,
     flux_time;
   double              vtk_time = 0;
   double              start_volume, end_volume;
-  int                 hanging, neigh_is_ghost;
-  t8_locidx_t         neigh_index = -1;
-  double              phi_plus, phi_minus;
+  double              local_updates = 0;
 
   /* Initialize problem */
   /* start timing */
@@ -1542,7 +1556,6 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
       /* Re initialize the elements */
       t8_advect_problem_init_elements (problem);
     }
-    adapted_or_partitioned = 1;
   }
   start_volume = t8_advect_level_set_volume (problem);
   t8_global_essentialf ("[advect] Start volume %e\n", start_volume);
@@ -1555,7 +1568,7 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
   sc_stats_set1 (&problem->stats[ADVECT_INIT], total_time + sc_MPI_Wtime (),
                  advect_stat_names[ADVECT_INIT]);
 
-  time_steps = (int) (T / problem->delta_t);
+  time_steps = num_steps > 0 ? num_steps : (int) (T / problem->delta_t);
   t8_global_essentialf ("[advect] Starting with Computation. Level %i."
                         " Adaptive levels %i."
                         " End time %g. delta_t %g. cfl %g. %i time steps.\n",
@@ -1584,201 +1597,50 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
     /* Measure element count */
     sc_stats_accumulate (&problem->stats[ADVECT_ELEM_AVG],
                          t8_forest_get_global_num_elements (problem->forest));
+    local_updates += t8_forest_get_local_num_elements (problem->forest);
 
     solve_time -= sc_MPI_Wtime ();
-    for (itree = 0, lelement = 0;
-         itree < t8_forest_get_num_local_trees (problem->forest); itree++) {
-      /* tree loop */
-      /* Get the vertices of this tree */
-      tree_vertices = t8_forest_get_tree_vertices (problem->forest, itree);
-      /* Get the scheme of this tree */
-      for (ielement = 0;
-           ielement < t8_forest_get_tree_num_elements (problem->forest,
-                                                       itree);
-           ielement++, lelement++) {
-        /* element loop */
-        /* Get a pointer to the element data */
-        elem_data = (t8_advect_element_data_t *)
-          t8_sc_array_index_locidx (problem->element_data, lelement);
-        elem =
-          t8_forest_get_element_in_tree (problem->forest, itree, ielement);
-        num_faces = elem_data->num_faces;
-        /* Compute left and right flux */
-        for (iface = 0; iface < num_faces; iface++) {
-          if (elem_data->flux_valid[iface] <= 0 || adapted_or_partitioned) {
-
-            /* Compute flux at this face */
-            if (adapted_or_partitioned) {
-              /* We changed the mesh, so that we have to calculate the neighbor
-               * indices again. */
-              if (elem_data->num_neighbors[iface] > 0) {
-                T8_FREE (elem_data->neighs[iface]);
-                T8_FREE (elem_data->dual_faces[iface]);
-                elem_data->flux_valid[iface] = -1;
-              }
-              T8_FREE (elem_data->fluxes[iface]);
-              neighbor_time = -sc_MPI_Wtime ();
-              t8_forest_leaf_face_neighbors (problem->forest, itree, elem,
-                                             &neighs, iface,
-                                             &elem_data->dual_faces[iface],
-                                             &elem_data->num_neighbors[iface],
-                                             &elem_data->neighs[iface],
-                                             &neigh_scheme, 1);
-              for (ineigh = 0; ineigh < elem_data->num_neighbors[iface];
-                   ineigh++) {
-                elem_data->neigh_level[iface] =
-                  neigh_scheme->t8_element_level (neighs[ineigh]);
-              }
-
-
-
-              /* *INDENT-OFF* */
-              neigh_scheme->t8_element_destroy (elem_data->num_neighbors[iface],
-                                                neighs);
-              /* *INDENT-ON* */
-
-              T8_FREE (neighs);
-
-              /* Allocate flux storage */
-              elem_data->fluxes[iface] =
-                T8_ALLOC (double,
-                          SC_MAX (1, elem_data->num_neighbors[iface]));
-              elem_data->flux_valid[iface] = 0;
-
-              neighbor_time += sc_MPI_Wtime ();
-              sc_stats_accumulate (&problem->stats[ADVECT_NEIGHS],
-                                   neighbor_time);
-              /* We want to count all runs over the solver time as one */
-              problem->stats[ADVECT_NEIGHS].count = 1;
-            }
-
-            /* sensible default */
-            neigh_data = NULL;
-            neigh_is_ghost = 0;
-            /* Compute whether this is a hanging face
-             * and whether the first neighbor is a ghost */
-            if (elem_data->num_neighbors[iface] >= 1) {
-
-              neigh_index = elem_data->neighs[iface][0];
-              neigh_is_ghost = neigh_index >=
-                t8_forest_get_local_num_elements (problem->forest);
-              hanging = elem_data->level != elem_data->neigh_level[iface];
-            }
-            else {
-              hanging = 0;
-              neigh_is_ghost = 0;
-            }
-            flux_time = -sc_MPI_Wtime ();
-            if (problem->dim == 1) {
-              if (elem_data->num_neighbors[iface] == 0) {
-                T8_ASSERT (elem_data->num_neighbors[iface] <= 0);
-                /* This is a boundary */
-                neigh_index = -1;
-              }
-#if 0
-              flux =
-                t8_advect_flux_lax_friedrich_1d (problem, plus_data,
-                                                 minus_data);
-#else
-              flux =
-                t8_advect_flux_upwind_1d (problem, lelement, neigh_index,
-                                          iface);
-#endif
-              elem_data->fluxes[iface][0] = flux;
-              elem_data->flux_valid[iface] = 1;
-            }
-            else {
-              T8_ASSERT (problem->dim == 2 || problem->dim == 3);
-              /* Check whether the flux for the neighbor element was computed */
-              /* Get a pointer to the neighbor element */
-              if (elem_data->num_neighbors[iface] >= 1 && !neigh_is_ghost) {
-                neigh_data = (t8_advect_element_data_t *)
-                  t8_sc_array_index_locidx (problem->element_data,
-                                            neigh_index);
-              }
-
-              /* Get the phi value at the current element */
-              phi_plus = t8_advect_element_get_phi (problem, lelement);
-              if (elem_data->num_neighbors[iface] == 1) {
-                dual_face = elem_data->dual_faces[iface][0];
-                /* There is exactly one face-neighbor */
-                /* get the phi value at the neighbor element */
-                phi_minus = t8_advect_element_get_phi (problem, neigh_index);
-                flux =
-                  t8_advect_flux_upwind (problem, phi_plus, phi_minus,
-                                         itree, elem, tree_vertices, iface);
-
-                elem_data->flux_valid[iface] = 1;
-                elem_data->fluxes[iface][0] = flux;
-
-                /* If this face is not hanging, we can set the
-                 * flux of the neighbor element as well */
-                if (!adapted_or_partitioned && !neigh_is_ghost && !hanging) {
-                  if (neigh_data->flux_valid[dual_face] < 0) {
-                    neigh_data->fluxes[dual_face] = T8_ALLOC (double, 1);
-                    neigh_data->dual_faces[dual_face] = T8_ALLOC (int, 1);
-                    neigh_data->neighs[dual_face] = T8_ALLOC (t8_locidx_t, 1);
-                  }
-                  SC_CHECK_ABORT (dual_face < neigh_data->num_faces, "num\n");
-                  //         SC_CHECK_ABORT (neigh_data->num_neighbors[dual_face] == 1, "dual face\n");
-                  neigh_data->fluxes[dual_face][0] = -flux;
-                  neigh_data->dual_faces[dual_face][0] = iface;
-                  neigh_data->neighs[dual_face][0] = lelement;
-                  neigh_data->flux_valid[dual_face] = 1;
-                }
-              }
-              else if (elem_data->num_neighbors[iface] > 1) {
-                flux =
-                  t8_advect_flux_upwind_hanging (problem, lelement, itree,
-                                                 elem, tree_vertices, iface,
-                                                 adapted_or_partitioned);
-              }
-              else {
-                /* This element is at the domain boundary */
-                /* We enforce outflow boundary conditions */
-                T8_ASSERT (elem_data->num_neighbors[iface] <= 0);
-                t8_advect_boundary_set_phi (problem, lelement, &phi_minus);
-
-                flux =
-                  t8_advect_flux_upwind (problem, phi_plus, phi_minus,
-                                         itree, elem, tree_vertices, iface);
-
-                elem_data->flux_valid[iface] = 1;
-                elem_data->fluxes[iface][0] = flux;
-              }
-            }
-            flux_time += sc_MPI_Wtime ();
-
-            sc_stats_accumulate (&problem->stats[ADVECT_FLUX], flux_time);
-            /* We want to count all runs over the solver time as one */
-            problem->stats[ADVECT_FLUX].count = 1;
-          }
-        }
-        if (problem->dummy_op) {
-          /* simulate more load per element */
-          int                 i, j;
-          double             *phi_values;
-          double              dummy_time = -sc_MPI_Wtime ();
-          phi_values =
-            (double *) t8_sc_array_index_locidx (problem->phi_values,
-                                                 ielement);
-          phi_values[1] = 0;
-          for (i = 1; i < 5; i++) {
-            phi_values[1] *= i;
-            for (j = 0; j < 5; j++) {
-              phi_values[1] += pow (i, j);
-            }
+    if (faces_outdated) {
+      /* The mesh changed, we list its faces again */
+      neighbor_time = -sc_MPI_Wtime ();
+      t8_forest_face_list (problem->forest, problem->faces);
+      neighbor_time += sc_MPI_Wtime ();
+      sc_stats_accumulate (&problem->stats[ADVECT_NEIGHS], neighbor_time);
+      /* We want to count all runs over the solver time as one */
+      problem->stats[ADVECT_NEIGHS].count = 1;
+      faces_outdated = 0;
+    }
+    /* Compute the flux across each face once */
+    flux_time = -sc_MPI_Wtime ();
+    t8_advect_compute_fluxes (problem);
+    flux_time += sc_MPI_Wtime ();
+    sc_stats_accumulate (&problem->stats[ADVECT_FLUX], flux_time);
+    /* We want to count all runs over the solver time as one */
+    problem->stats[ADVECT_FLUX].count = 1;
+    num_local_elements = t8_forest_get_local_num_elements (problem->forest);
+    for (lelement = 0; lelement < num_local_elements; lelement++) {
+      if (problem->dummy_op) {
+        /* simulate more load per element */
+        int                 i, j;
+        double             *phi_values;
+        double              dummy_time = -sc_MPI_Wtime ();
+        phi_values =
+          (double *) t8_sc_array_index_locidx (problem->phi_values,
+                                               lelement);
+        phi_values[1] = 0;
+        for (i = 1; i < 5; i++) {
+          phi_values[1] *= i;
+          for (j = 0; j < 5; j++) {
+            phi_values[1] += pow (i, j);
           }
-          dummy_time += sc_MPI_Wtime ();
-          sc_stats_accumulate (&problem->stats[ADVECT_DUMMY], dummy_time);
-          problem->stats[ADVECT_DUMMY].count = 1;
         }
-        /* Compute time step */
-        //      printf ("advance %i\n", ielement);
-        t8_advect_advance_element (problem, lelement);
+        dummy_time += sc_MPI_Wtime ();
+        sc_stats_accumulate (&problem->stats[ADVECT_DUMMY], dummy_time);
+        problem->stats[ADVECT_DUMMY].count = 1;
       }
+      /* Compute time step */
+      t8_advect_advance_element (problem, lelement);
     }
-    adapted_or_partitioned = 0;
     /* Store the advanced phi value in each element */
     t8_advect_project_element_data (problem);
     solve_time += sc_MPI_Wtime ();
@@ -1787,14 +1649,16 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
     if (adapt && time_steps / 3 > 0
         && problem->num_time_steps % (time_steps / 3) == (time_steps / 3) - 1)
 #else
-    if (maxlevel > level) {
+    if (maxlevel > level && (phases & ADVECT_PHASE_ADAPT)) {
       /* Adapt the mesh after adapt_freq time steps */
       if (problem->num_time_steps % adapt_freq == adapt_freq - 1)
 #endif
       {
-        adapted_or_partitioned = 1;
+        faces_outdated = 1;
         t8_advect_problem_adapt (problem, 1);
-        t8_advect_problem_partition (problem, 1);
+        if (phases & ADVECT_PHASE_PARTITION) {
+          t8_advect_problem_partition (problem, 1);
+        }
       }
     }
 
@@ -1811,13 +1675,19 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
     problem->stats[ADVECT_GHOST_EXCHANGE].count = 1;
     problem->stats[ADVECT_GHOST_WAIT].count = 1;
 
-    if (problem->t + problem->delta_t > problem->T) {
-      /* Ensure that the last time step is always the given end time */
-      problem->delta_t = problem->T - problem->t;
+    if (num_steps > 0) {
+      /* Compute a fixed number of time steps */
+      done = problem->num_time_steps + 1 >= num_steps;
     }
-    /* Check whether we are finished */
-    if (problem->t >= problem->T) {
-      done = 1;
+    else {
+      if (problem->t + problem->delta_t > problem->T) {
+        /* Ensure that the last time step is always the given end time */
+        problem->delta_t = problem->T - problem->t;
+      }
+      /* Check whether we are finished */
+      if (problem->t >= problem->T) {
+        done = 1;
+      }
     }
   }                             /* End element loop */
   if (!no_vtk) {
@@ -1834,6 +1704,9 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
                  advect_stat_names[ADVECT_SOLVE]);
   sc_stats_set1 (&problem->stats[ADVECT_IO], vtk_time,
                  advect_stat_names[ADVECT_IO]);
+  sc_stats_set1 (&problem->stats[ADVECT_ELEM_RATE],
+                 solve_time > 0 ? local_updates / solve_time : 0,
+                 advect_stat_names[ADVECT_ELEM_RATE]);
   /* Compute volume loss */
 
   end_volume = t8_advect_level_set_volume (problem);
@@ -1857,6 +1730,9 @@ t8_advect_solve (t8_cmesh_t cmesh, t8_flow_function_3d_fn u,
   sc_stats_compute (problem->comm, ADVECT_NUM_STATS, problem->stats);
   sc_stats_print (t8_get_package_id (), SC_LP_ESSENTIAL, ADVECT_NUM_STATS,
                   problem->stats, 1, 1);
+  if (benchmark) {
+    t8_advect_print_benchmark (problem, local_updates, solve_time);
+  }
   /* clean-up */
   t8_advect_problem_destroy (&problem);
 }
@@ -1872,6 +1748,7 @@ main (int argc, char *argv[])
   int                 parsed, helpme, no_vtk, vtk_freq, adapt_freq;
   int                 volume_refine;
   int                 flow_arg;
+  int                 num_steps, phases, benchmark;
   double              T, cfl, band_width;
   t8_levelset_sphere_data_t ls_data;
   /* brief help message */
@@ -1969,6 +1846,20 @@ main (int argc, char *argv[])
                       "if their volume is smaller than the l+V-times refined\n"
                       " smallest element int the mesh.");
 
+  sc_options_add_int (opt, 'N', "num-steps", &num_steps, 0,
+                      "If > 0, compute exactly this many time steps "
+                      "and ignore -T.");
+  sc_options_add_int (opt, 'P', "phases", &phases, ADVECT_PHASE_ALL,
+                      "The phases of the time loop as a sum of\n"
+                      "\t\t1 - adapt the mesh every -a time steps.\n"
+                      "\t\t2 - repartition the adapted mesh.\n"
+                      "\t\t\t\t     Default: 3.");
+  sc_options_add_switch (opt, 'B', "benchmark", &benchmark,
+                         "Benchmark mode. Implies -o and prints the runtime "
+                         "of each phase\n\t\t\t\t     with its minimum "
+                         "and maximum over the processes.\n\t\t\t\t     "
+                         "Combine with -N for a fixed number of steps.");
+
   parsed =
     sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt, argc, argv);
   if (helpme) {
@@ -1977,12 +1868,17 @@ main (int argc, char *argv[])
     sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
   }
   else if (parsed >= 0 && 1 <= flow_arg && flow_arg <= 6 && 0 <= level
-           && 0 <= reflevel && 0 <= vtk_freq
+           && 0 <= reflevel && 0 <= vtk_freq && 0 <= num_steps
+           && 0 <= phases && phases <= ADVECT_PHASE_ALL
            && ((mshfile != NULL && 0 < dim && dim <= 3)
                || (1 <= eclass_int && eclass_int <= 8)) && band_width >= 0) {
     t8_cmesh_t          cmesh;
     t8_flow_function_3d_fn u;
 
+    if (benchmark) {
+      /* Do not measure the output */
+      no_vtk = 1;
+    }
     if (mshfile == NULL) {
       switch (eclass_int) {
       case 7:
@@ -2017,7 +1913,7 @@ main (int argc, char *argv[])
                      level,
                      level + reflevel, T, cfl, sc_MPI_COMM_WORLD, adapt_freq,
                      no_vtk, vtk_freq, band_width, dim, dummy_op,
-                     volume_refine);
+                     volume_refine, num_steps, phases, benchmark);
   }
   else {
     /* wrong usage */
@@ -99,8 +99,7 @@ main (int argc, char **argv)
   level = 2;
   t8_refine_p4est (level);
   t8_refine_cube (T8_ECLASS_TRIANGLE, level);
-  /* TODO: does not work with level > 0 yet */
-  t8_refine_hybrid (0);
+  t8_refine_hybrid (level);
 
   sc_finalize ();
 
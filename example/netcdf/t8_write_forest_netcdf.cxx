@@ -0,0 +1,96 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* This example writes uniform two and three dimensional forests with the
+ * volume of each element to UGRID NetCDF-4 files. */
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_forest.h>
+#include <t8_forest_netcdf.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+
+static void
+t8_write_forest_netcdf (t8_eclass_t eclass, int level, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_vtk_data_field_t volume;
+  t8_locidx_t         itree, ielement, num_elements, ilocal = 0;
+  char                fileprefix[BUFSIZ];
+
+  forest = t8_forest_new_uniform (t8_cmesh_new_hypercube (eclass, comm, 0, 0,
+                                                          0),
+                                  t8_scheme_new_default_cxx (), level, 0,
+                                  comm);
+
+  /* Compute the volume of each element */
+  volume.type = T8_VTK_SCALAR;
+  snprintf (volume.description, BUFSIZ, "volume");
+  volume.data = T8_ALLOC (double, t8_forest_get_local_num_elements (forest));
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      volume.data[ilocal++] =
+        t8_forest_element_volume (forest, itree,
+                                  t8_forest_get_element_in_tree (forest,
+                                                                 itree,
+                                                                 ielement),
+                                  t8_forest_get_tree_vertices (forest,
+                                                               itree));
+    }
+  }
+
+  snprintf (fileprefix, BUFSIZ, "t8_forest_netcdf_%s",
+            t8_eclass_to_string[eclass]);
+  if (t8_forest_write_netcdf (forest, fileprefix, 1, 1, 1, 1, &volume, 1)) {
+    t8_global_productionf ("Wrote the forest to %s.nc\n", fileprefix);
+  }
+  T8_FREE (volume.data);
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  /* Initialize MPI */
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  /* Initialize sc */
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  /* Initialize t8code */
+  t8_init (SC_LP_PRODUCTION);
+
+  t8_write_forest_netcdf (T8_ECLASS_QUAD, 3, sc_MPI_COMM_WORLD);
+  t8_write_forest_netcdf (T8_ECLASS_PRISM, 2, sc_MPI_COMM_WORLD);
+
+  /* Finalize sc */
+  sc_finalize ();
+
+  /* Finalize MPI */
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
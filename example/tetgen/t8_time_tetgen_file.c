@@ -109,8 +109,9 @@ main (int argc, char *argv[])
   opt = sc_options_new (argv[0]);
   sc_options_add_string (opt, 'f', "prefix", &prefix, "", "The prefix of the"
                          "tetgen files.");
-  sc_options_add_bool (opt, 'p', "Partition", &partition, 0, "If true"
-                       "the generated cmesh is partitioned.");
+  sc_options_add_bool (opt, 'p', "Partition", &partition, 0, "If true "
+                       "the files are read in parallel and the generated "
+                       "cmesh is partitioned.");
   parsed =
     sc_options_parse (t8_get_package_id (), SC_LP_ERROR, opt, argc, argv);
   if (parsed < 0 || strcmp (prefix, "") == 0) {
@@ -0,0 +1,468 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* A benchmark of the main algorithms of t8code with reproducible runs.
+ * For each element class we build a uniform forest on a hypercube, refine
+ * it unbalanced, partition, balance and ghost it, exchange ghost data and
+ * optionally write it to vtk. The runtimes and memory of each phase are
+ * taken from the forest profile, reduced over all processes and appended
+ * as one row per phase to a CSV or JSON file.
+ *
+ * With strong scaling the initial level is fixed. With weak scaling the
+ * initial level is the smallest level with at least the given number of
+ * elements per process, assuming 2^dim children per element. Thus the
+ * number of elements per process is constant if the number of processes
+ * is a power of 2^dim.
+ *
+ * The output contains the complete configuration of each row, such that
+ * files of different releases and machines can be concatenated and
+ * compared. */
+
+#include <sc_options.h>
+#include <sc_statistics.h>
+#include <t8_eclass.h>
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_cmesh.h>
+
+/* The element class value of the hybrid hypercube */
+#define T8_TIME_BENCHMARK_HYBRID T8_ECLASS_COUNT
+
+/* The phases of a benchmark run */
+typedef enum
+{
+  T8_TIME_BENCHMARK_UNIFORM = 0,
+  T8_TIME_BENCHMARK_ADAPT,
+  T8_TIME_BENCHMARK_PARTITION,
+  T8_TIME_BENCHMARK_BALANCE,
+  T8_TIME_BENCHMARK_GHOST,
+  T8_TIME_BENCHMARK_GHOST_EXCHANGE,
+  T8_TIME_BENCHMARK_VTK,
+  T8_TIME_BENCHMARK_NUM_PHASES
+} t8_time_benchmark_phase_t;
+
+static const char  *t8_time_benchmark_phase_names
+  [T8_TIME_BENCHMARK_NUM_PHASES] = {
+  "uniform",
+  "adapt",
+  "partition",
+  "balance",
+  "ghost",
+  "ghost_exchange",
+  "vtk"
+};
+
+/* The configuration of the benchmark and its output */
+typedef struct
+{
+  sc_MPI_Comm         comm;
+  int                 mpisize;
+  int                 mpirank;
+  int                 level;    /* The initial level for strong scaling */
+  int                 elements_per_proc;        /* If > 0 weak scaling */
+  int                 refine_levels;
+  int                 num_runs;
+  int                 write_vtk;
+  int                 write_profiles;
+  int                 json;
+  const char         *output;
+  FILE               *file;     /* The output file on rank 0 */
+  int                 num_rows; /* The number of rows written so far */
+} t8_time_benchmark_t;
+
+/* The name of an element class or of the hybrid hypercube */
+static const char  *
+t8_time_benchmark_eclass_name (int eclass)
+{
+  return eclass == T8_TIME_BENCHMARK_HYBRID ? "hybrid"
+    : t8_eclass_to_string[eclass];
+}
+
+/* Refine every 0-th, 3rd, 5-th and 6-th child up to a maximum level. */
+static int
+t8_time_benchmark_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                         t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                         t8_eclass_scheme_c * ts, int num_elements,
+                         t8_element_t * elements[])
+{
+  int                 id, max_level;
+
+  max_level = *(int *) t8_forest_get_user_data (forest);
+  if (ts->t8_element_level (elements[0]) >= max_level) {
+    return 0;
+  }
+  id = ts->t8_element_child_id (elements[0]);
+  return (id == 0 || id == 3 || id == 5 || id == 6);
+}
+
+/* Compute the initial level of a cmesh with dimension dim. */
+static int
+t8_time_benchmark_level (t8_time_benchmark_t * bench, t8_cmesh_t cmesh,
+                         int dim)
+{
+  double              num_elements;
+  int                 level;
+
+  if (bench->elements_per_proc <= 0) {
+    /* strong scaling */
+    return bench->level;
+  }
+  num_elements = (double) t8_cmesh_get_num_trees (cmesh);
+  for (level = 0; num_elements < (double) bench->elements_per_proc
+       * bench->mpisize; level++) {
+    num_elements *= 1 << dim;
+  }
+  return level;
+}
+
+/* Reduce the runtime and memory of a phase over all processes and
+ * write them as one row on rank 0. */
+static void
+t8_time_benchmark_report (t8_time_benchmark_t * bench, int eclass,
+                          int level, int run,
+                          t8_time_benchmark_phase_t phase,
+                          t8_forest_t forest, double time, size_t memory)
+{
+  sc_statinfo_t       stats[2];
+  t8_gloidx_t         num_elements;
+
+  sc_stats_set1 (&stats[0], time, "time");
+  sc_stats_set1 (&stats[1], (double) memory, "memory");
+  sc_stats_compute (bench->comm, 2, stats);
+  num_elements = t8_forest_get_global_num_elements (forest);
+  t8_global_productionf ("%s %s: %lli elements, %.6f seconds\n",
+                         t8_time_benchmark_eclass_name (eclass),
+                         t8_time_benchmark_phase_names[phase],
+                         (long long) num_elements, stats[0].max);
+  if (bench->mpirank != 0) {
+    return;
+  }
+  if (!bench->json) {
+    fprintf (bench->file, "%s,%s,%i,%i,%i,%s,%lli,%.9g,%.9g,%.9g,"
+             "%.0f,%.0f,%.0f\n", t8_time_benchmark_eclass_name (eclass),
+             bench->elements_per_proc > 0 ? "weak" : "strong",
+             bench->mpisize, level, run,
+             t8_time_benchmark_phase_names[phase], (long long) num_elements,
+             stats[0].min, stats[0].average, stats[0].max,
+             stats[1].min, stats[1].average, stats[1].max);
+  }
+  else {
+    fprintf (bench->file, "%s  {\"eclass\": \"%s\", \"scaling\": \"%s\", "
+             "\"mpisize\": %i, \"level\": %i, \"run\": %i, \"phase\": "
+             "\"%s\", \"elements\": %lli, \"time_min\": %.9g, "
+             "\"time_avg\": %.9g, \"time_max\": %.9g, \"memory_min\": %.0f, "
+             "\"memory_avg\": %.0f, \"memory_max\": %.0f}",
+             bench->num_rows > 0 ? ",\n" : "",
+             t8_time_benchmark_eclass_name (eclass),
+             bench->elements_per_proc > 0 ? "weak" : "strong",
+             bench->mpisize, level, run,
+             t8_time_benchmark_phase_names[phase], (long long) num_elements,
+             stats[0].min, stats[0].average, stats[0].max,
+             stats[1].min, stats[1].average, stats[1].max);
+  }
+  bench->num_rows++;
+}
+
+/* Write the detailed profile of a forest if requested */
+static void
+t8_time_benchmark_write_profile (t8_time_benchmark_t * bench, int eclass,
+                                 int run, t8_time_benchmark_phase_t phase,
+                                 t8_forest_t forest)
+{
+  char                filename[BUFSIZ];
+
+  if (!bench->write_profiles) {
+    return;
+  }
+  snprintf (filename, BUFSIZ, "%s_%s_run%i_%s.%s", bench->output,
+            t8_time_benchmark_eclass_name (eclass), run,
+            t8_time_benchmark_phase_names[phase],
+            bench->json ? "json" : "csv");
+  if (!t8_forest_write_profile (forest, filename, bench->json ?
+                                T8_FOREST_PROFILE_JSON :
+                                T8_FOREST_PROFILE_CSV)) {
+    t8_errorf ("Could not write profile %s\n", filename);
+  }
+}
+
+/* Commit a forest with profiling, report the phase and write its profile.
+ * The runtime is taken from the profile. */
+static t8_forest_t
+t8_time_benchmark_commit (t8_time_benchmark_t * bench, int eclass,
+                          int level, int run,
+                          t8_time_benchmark_phase_t phase,
+                          t8_forest_t forest)
+{
+  double              time = 0;
+  t8_locidx_t         ghosts_sent;
+  int                 procs_sent, balance_rounds;
+
+  t8_forest_set_profiling (forest, 1);
+  t8_forest_commit (forest);
+  switch (phase) {
+  case T8_TIME_BENCHMARK_ADAPT:
+    time = t8_forest_profile_get_adapt_time (forest);
+    break;
+  case T8_TIME_BENCHMARK_PARTITION:
+    time = t8_forest_profile_get_partition_time (forest, &procs_sent);
+    break;
+  case T8_TIME_BENCHMARK_BALANCE:
+    time = t8_forest_profile_get_balance_time (forest, &balance_rounds);
+    break;
+  case T8_TIME_BENCHMARK_GHOST:
+    time = t8_forest_profile_get_ghost_time (forest, &ghosts_sent);
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  t8_time_benchmark_report (bench, eclass, level, run, phase, forest, time,
+                            t8_forest_profile_get_memory_high_water (forest));
+  t8_time_benchmark_write_profile (bench, eclass, run, phase, forest);
+  return forest;
+}
+
+/* Run all phases of the benchmark for one element class */
+static void
+t8_time_benchmark_eclass (t8_time_benchmark_t * bench, int eclass)
+{
+  t8_forest_t         forest, forest_next;
+  t8_cmesh_t          cmesh;
+  t8_forest_memory_usage_t usage;
+  sc_array_t          ghost_data;
+  char                vtkname[BUFSIZ];
+  double              time;
+  int                 dim, level, max_level, run, mpiret;
+
+  if (eclass == T8_TIME_BENCHMARK_HYBRID) {
+    dim = 3;
+    cmesh = t8_cmesh_new_hypercube_hybrid (dim, bench->comm, 0, 0);
+  }
+  else {
+    dim = t8_eclass_to_dimension[eclass];
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, bench->comm, 0, 0,
+                                    0);
+  }
+  level = t8_time_benchmark_level (bench, cmesh, dim);
+  max_level = level + bench->refine_levels;
+
+  for (run = 0; run < bench->num_runs; run++) {
+    /* The uniform forest is not profiled, we measure its construction */
+    t8_cmesh_ref (cmesh);
+    mpiret = sc_MPI_Barrier (bench->comm);
+    SC_CHECK_MPI (mpiret);
+    time = -sc_MPI_Wtime ();
+    forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (),
+                                    level, 0, bench->comm);
+    time += sc_MPI_Wtime ();
+    t8_forest_memory_usage (forest, &usage);
+    t8_time_benchmark_report (bench, eclass, level, run,
+                              T8_TIME_BENCHMARK_UNIFORM, forest, time,
+                              usage.total);
+
+    /* Adapt, partition, balance and ghost the forest */
+    t8_forest_init (&forest_next);
+    t8_forest_set_user_data (forest_next, &max_level);
+    t8_forest_set_adapt (forest_next, forest, t8_time_benchmark_adapt, 1);
+    forest = t8_time_benchmark_commit (bench, eclass, level, run,
+                                       T8_TIME_BENCHMARK_ADAPT, forest_next);
+    t8_forest_init (&forest_next);
+    t8_forest_set_partition (forest_next, forest, 0);
+    forest = t8_time_benchmark_commit (bench, eclass, level, run,
+                                       T8_TIME_BENCHMARK_PARTITION,
+                                       forest_next);
+    t8_forest_init (&forest_next);
+    t8_forest_set_balance (forest_next, forest, 0);
+    forest = t8_time_benchmark_commit (bench, eclass, level, run,
+                                       T8_TIME_BENCHMARK_BALANCE,
+                                       forest_next);
+    t8_forest_init (&forest_next);
+    t8_forest_set_copy (forest_next, forest);
+    t8_forest_set_ghost (forest_next, 1, T8_GHOST_FACES);
+    forest = t8_time_benchmark_commit (bench, eclass, level, run,
+                                       T8_TIME_BENCHMARK_GHOST, forest_next);
+
+    /* Exchange one double per element */
+    sc_array_init_size (&ghost_data, sizeof (double),
+                        t8_forest_get_local_num_elements (forest)
+                        + t8_forest_get_num_ghosts (forest));
+    memset (ghost_data.array, 0, ghost_data.elem_count * sizeof (double));
+    mpiret = sc_MPI_Barrier (bench->comm);
+    SC_CHECK_MPI (mpiret);
+    time = -sc_MPI_Wtime ();
+    t8_forest_ghost_exchange_data (forest, &ghost_data);
+    time += sc_MPI_Wtime ();
+    t8_forest_memory_usage (forest, &usage);
+    t8_time_benchmark_report (bench, eclass, level, run,
+                              T8_TIME_BENCHMARK_GHOST_EXCHANGE, forest, time,
+                              usage.total
+                              + ghost_data.elem_count * sizeof (double));
+    sc_array_reset (&ghost_data);
+
+    if (bench->write_vtk) {
+      snprintf (vtkname, BUFSIZ, "%s_%s_run%i", bench->output,
+                t8_time_benchmark_eclass_name (eclass), run);
+      mpiret = sc_MPI_Barrier (bench->comm);
+      SC_CHECK_MPI (mpiret);
+      time = -sc_MPI_Wtime ();
+      t8_forest_write_vtk (forest, vtkname);
+      time += sc_MPI_Wtime ();
+      t8_time_benchmark_report (bench, eclass, level, run,
+                                T8_TIME_BENCHMARK_VTK, forest, time,
+                                usage.total);
+    }
+    t8_forest_unref (&forest);
+  }
+  t8_cmesh_destroy (&cmesh);
+}
+
+/* Open the output file on rank 0, run the benchmark for the selected
+ * element classes and close the file. Return true on success. */
+static int
+t8_time_benchmark (t8_time_benchmark_t * bench, int eclass, int all_eclasses)
+{
+  int                 ieclass, can_write, mpiret;
+
+  if (bench->mpirank == 0) {
+    bench->file = fopen (bench->output, "w");
+    if (bench->file == NULL) {
+      t8_errorf ("Could not open file %s for writing.\n", bench->output);
+    }
+  }
+  /* All processes need to know whether rank 0 can write */
+  can_write = bench->mpirank != 0 || bench->file != NULL;
+  mpiret = sc_MPI_Bcast (&can_write, 1, sc_MPI_INT, 0, bench->comm);
+  SC_CHECK_MPI (mpiret);
+  if (!can_write) {
+    return 0;
+  }
+  if (bench->mpirank == 0) {
+    if (!bench->json) {
+      fprintf (bench->file, "eclass,scaling,mpisize,level,run,phase,elements,"
+               "time_min,time_avg,time_max,memory_min,memory_avg,"
+               "memory_max\n");
+    }
+    else {
+      fprintf (bench->file, "[\n");
+    }
+  }
+  if (all_eclasses) {
+    for (ieclass = T8_ECLASS_LINE; ieclass <= T8_TIME_BENCHMARK_HYBRID;
+         ieclass++) {
+      t8_time_benchmark_eclass (bench, ieclass);
+    }
+  }
+  else {
+    t8_time_benchmark_eclass (bench, eclass);
+  }
+  if (bench->mpirank == 0) {
+    if (bench->json) {
+      fprintf (bench->file, "\n]\n");
+    }
+    fclose (bench->file);
+  }
+  return 1;
+}
+
+int
+main (int argc, char **argv)
+{
+  t8_time_benchmark_t bench;
+  int                 mpiret, parsed, eclass_int, all_eclasses, helpme;
+  int                 counters, success = 1;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_PRODUCTION);
+
+  memset (&bench, 0, sizeof (bench));
+  bench.comm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_size (bench.comm, &bench.mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (bench.comm, &bench.mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'l', "level", &bench.level, 3,
+                      "The initial uniform refinement level for strong "
+                      "scaling.");
+  sc_options_add_int (opt, 'w', "weak", &bench.elements_per_proc, 0,
+                      "If positive, use weak scaling with at least this "
+                      "many initial elements per process instead of a "
+                      "fixed level.");
+  sc_options_add_int (opt, 'r', "refine-level", &bench.refine_levels, 2,
+                      "The number of additional levels of unbalanced "
+                      "refinement.");
+  sc_options_add_int (opt, 'n', "runs", &bench.num_runs, 3,
+                      "The number of runs per element class.");
+  sc_options_add_int (opt, 'e', "elements", &eclass_int, T8_ECLASS_HEX,
+                      "The type of elements to use.\n"
+                      "\t\t1 - line\n\t\t2 - quad\n"
+                      "\t\t3 - triangle\n\t\t4 - hexahedron\n"
+                      "\t\t5 - tetrahedron\n\t\t6 - prism\n"
+                      "\t\t7 - pyramid\n\t\t8 - hybrid hypercube");
+  sc_options_add_switch (opt, 'a', "all", &all_eclasses,
+                         "Run the benchmark for all element classes and the "
+                         "hybrid hypercube.");
+  sc_options_add_string (opt, 'o', "output", &bench.output,
+                         "t8_time_benchmark.csv",
+                         "The file that the results are written to.");
+  sc_options_add_switch (opt, 'j', "json", &bench.json,
+                         "Write JSON instead of CSV.");
+  sc_options_add_switch (opt, 'v', "vtk", &bench.write_vtk,
+                         "Also time the vtk output of the final forest.");
+  sc_options_add_switch (opt, 'p', "profiles", &bench.write_profiles,
+                         "Write the detailed profile of each phase next to "
+                         "the output file.");
+  sc_options_add_switch (opt, 'c', "counters", &counters,
+                         "Enable the hardware counters in the profiles.");
+  sc_options_add_switch (opt, 'h', "help", &helpme,
+                         "Display a short help message.");
+
+  parsed =
+    sc_options_parse (t8_get_package_id (), SC_LP_DEFAULT, opt, argc, argv);
+  if (helpme) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed < 0 || parsed != argc || bench.level < 0
+           || bench.refine_levels < 0 || bench.num_runs < 1
+           || eclass_int < T8_ECLASS_LINE
+           || eclass_int > T8_TIME_BENCHMARK_HYBRID) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+    success = 0;
+  }
+  else {
+    if (counters && !t8_forest_profile_set_counters (1)) {
+      t8_global_errorf ("Hardware counters are not available.\n");
+    }
+    success = t8_time_benchmark (&bench, eclass_int, all_eclasses);
+    t8_forest_profile_set_counters (0);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return success ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* Compare the runtimes of the ghost algorithms.
+ * We build a uniform forest on a hypercube, refine it unbalanced and
+ * partition it. Then we create the face ghost layer of this forest with
+ * the iterative algorithms and the top-down search and report the
+ * maximum runtimes over all processes. */
+
+#include <sc_options.h>
+#include <sc_refcount.h>
+#include <t8_eclass.h>
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_cmesh.h>
+
+/* Refine every 0-th, 3rd, 5-th and 6-th child up to a maximum level. */
+static int
+t8_time_ghost_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                     t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                     t8_eclass_scheme_c * ts, int num_elements,
+                     t8_element_t * elements[])
+{
+  int                 id, max_level;
+
+  max_level = *(int *) t8_forest_get_user_data (forest);
+  if (ts->t8_element_level (elements[0]) >= max_level) {
+    return 0;
+  }
+  id = ts->t8_element_child_id (elements[0]);
+  return (id == 0 || id == 3 || id == 5 || id == 6);
+}
+
+/* Create the ghost layer of forest with a given ghost algorithm
+ * num_runs times and return the maximum runtime of the fastest run.
+ * The number of ghosts is stored in num_ghosts. */
+static double
+t8_time_ghost_version (t8_forest_t forest, int ghost_version, int num_runs,
+                       t8_locidx_t * num_ghosts)
+{
+  t8_forest_t         forest_ghost;
+  double              time, max_time, min_time = -1;
+  t8_locidx_t         ghosts_sent;
+  int                 irun, mpiret;
+
+  for (irun = 0; irun < num_runs; irun++) {
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_ghost);
+    t8_forest_set_copy (forest_ghost, forest);
+    t8_forest_set_ghost_ext (forest_ghost, 1, T8_GHOST_FACES, ghost_version);
+    t8_forest_set_profiling (forest_ghost, 1);
+    t8_forest_commit (forest_ghost);
+    time = t8_forest_profile_get_ghost_time (forest_ghost, &ghosts_sent);
+    mpiret = sc_MPI_Allreduce (&time, &max_time, 1, sc_MPI_DOUBLE,
+                               sc_MPI_MAX, t8_forest_get_mpicomm (forest));
+    SC_CHECK_MPI (mpiret);
+    if (min_time < 0 || max_time < min_time) {
+      min_time = max_time;
+    }
+    *num_ghosts = t8_forest_get_num_ghosts (forest_ghost);
+    t8_forest_unref (&forest_ghost);
+  }
+  return min_time;
+}
+
+static void
+t8_time_ghost (t8_eclass_t eclass, int level, int refine_levels,
+               int num_runs, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt;
+  t8_cmesh_t          cmesh;
+  t8_locidx_t         num_ghosts[3];
+  double              times[3];
+  int                 max_level, ghost_version;
+
+  cmesh = t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0);
+  forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (),
+                                  level, 0, comm);
+  max_level = level + refine_levels;
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_user_data (forest_adapt, &max_level);
+  t8_forest_set_adapt (forest_adapt, forest, t8_time_ghost_adapt, 1);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_commit (forest_adapt);
+  forest = forest_adapt;
+
+  t8_global_productionf ("Timing ghost on %lli %s elements\n",
+                         (long long) t8_forest_get_global_num_elements
+                         (forest), t8_eclass_to_string[eclass]);
+  /* The iterative algorithm for balanced forests is only correct
+   * if the forest is balanced. */
+  for (ghost_version = refine_levels <= 1 ? 1 : 2; ghost_version <= 3;
+       ghost_version++) {
+    times[ghost_version - 1] =
+      t8_time_ghost_version (forest, ghost_version, num_runs,
+                             num_ghosts + ghost_version - 1);
+    t8_global_productionf ("Ghost version %i: %i ghosts, %.6f seconds\n",
+                           ghost_version, num_ghosts[ghost_version - 1],
+                           times[ghost_version - 1]);
+  }
+  SC_CHECK_ABORT (num_ghosts[1] == num_ghosts[2],
+                  "Ghost algorithms computed different ghost layers.\n");
+  t8_global_productionf ("Top-down speedup over iterative: %.2f\n",
+                         times[2] > 0 ? times[1] / times[2] : 0);
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, parsed, eclass_int, level, helpme;
+  int                 refine_levels, num_runs;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_PRODUCTION);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'l', "level", &level, 3,
+                      "The initial uniform refinement level.");
+  sc_options_add_int (opt, 'r', "refine-level", &refine_levels, 2,
+                      "The number of additional levels of unbalanced "
+                      "refinement.");
+  sc_options_add_int (opt, 'n', "runs", &num_runs, 3,
+                      "The number of runs per ghost algorithm. The fastest "
+                      "run is reported.");
+  sc_options_add_int (opt, 'e', "elements", &eclass_int, T8_ECLASS_HEX,
+                      "The type of elements to use.\n"
+                      "\t\t1 - line\n\t\t2 - quad\n"
+                      "\t\t3 - triangle\n\t\t4 - hexahedron\n"
+                      "\t\t5 - tetrahedron\n\t\t6 - prism");
+  sc_options_add_switch (opt, 'h', "help", &helpme,
+                         "Display a short help message.");
+
+  parsed =
+    sc_options_parse (t8_get_package_id (), SC_LP_DEFAULT, opt, argc, argv);
+  if (helpme) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else if (parsed < 0 || parsed != argc || level < 0 || refine_levels < 0
+           || num_runs < 1 || eclass_int < T8_ECLASS_LINE
+           || eclass_int > T8_ECLASS_PRISM) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+    sc_options_destroy (opt);
+    sc_finalize ();
+    mpiret = sc_MPI_Finalize ();
+    SC_CHECK_MPI (mpiret);
+    return 1;
+  }
+  else {
+    t8_time_ghost ((t8_eclass_t) eclass_int, level, refine_levels, num_runs,
+                   sc_MPI_COMM_WORLD);
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
@@ -0,0 +1,264 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this example we measure the runtime of the linear id computation
+ * for triangles, tetrahedra and prisms. We compare the table driven
+ * routines that process several levels at once with the reference
+ * routines that process one level after the other.
+ * For each element class we create a number of pseudo random elements
+ * at a given level and compute their linear ids and the elements from
+ * their linear ids. */
+
+#include <sc_flops.h>
+#include <sc_statistics.h>
+#include <sc_options.h>
+#include <t8.h>
+#include <t8_schemes/t8_default/t8_dtri_bits.h>
+#include <t8_schemes/t8_default/t8_dtet_bits.h>
+#include <t8_schemes/t8_default/t8_dprism_bits.h>
+
+/* The number of measurements per element class */
+#define T8_TIME_LINEAR_ID_NUM_STATS 4
+
+/* Return a pseudo random linear id with a given number of bits.
+ * We use a simple linear congruential generator, such that all
+ * runs use the same elements. */
+static              t8_linearidx_t
+t8_time_linear_id_random (t8_linearidx_t * state, int bits)
+{
+  *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+  if (bits >= 64) {
+    return *state;
+  }
+  return *state & ((((t8_linearidx_t) 1) << bits) - 1);
+}
+
+/* Start a measurement */
+static void
+t8_time_linear_id_start (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot)
+{
+  sc_flops_start (fi);
+  sc_flops_snap (fi, snapshot);
+}
+
+/* Stop a measurement and store the runtime in a statistics entry */
+static void
+t8_time_linear_id_stop (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot,
+                        sc_statinfo_t * stats, const char *name)
+{
+  sc_flops_shot (fi, snapshot);
+  sc_stats_set1 (stats, snapshot->iwtime, name);
+}
+
+/* Measure the linear id routines of triangles */
+static void
+t8_time_linear_id_tri (int level, int num_elements, sc_statinfo_t * stats)
+{
+  sc_flopinfo_t       fi, snapshot;
+  t8_dtri_t          *tris;
+  t8_linearidx_t     *ids, state = 1, sum = 0;
+  int                 ielem;
+
+  level = SC_MIN (level, T8_DTRI_MAXLEVEL);
+  tris = T8_ALLOC (t8_dtri_t, num_elements);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    ids[ielem] = t8_time_linear_id_random (&state, 2 * level);
+  }
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dtri_init_linear_id_per_level (tris + ielem, ids[ielem], level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[0], "tri init per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dtri_init_linear_id (tris + ielem, ids[ielem], level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[1], "tri init table");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum += t8_dtri_linear_id_per_level (tris + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[2], "tri id per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum -= t8_dtri_linear_id (tris + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[3], "tri id table");
+
+  /* Both versions must compute the same ids */
+  SC_CHECK_ABORT (sum == 0, "Linear ids of triangles do not match");
+  T8_FREE (tris);
+  T8_FREE (ids);
+}
+
+/* Measure the linear id routines of tetrahedra */
+static void
+t8_time_linear_id_tet (int level, int num_elements, sc_statinfo_t * stats)
+{
+  sc_flopinfo_t       fi, snapshot;
+  t8_dtet_t          *tets;
+  t8_linearidx_t     *ids, state = 1, sum = 0;
+  int                 ielem;
+
+  level = SC_MIN (level, T8_DTET_MAXLEVEL);
+  tets = T8_ALLOC (t8_dtet_t, num_elements);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    ids[ielem] = t8_time_linear_id_random (&state, 3 * level);
+  }
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dtet_init_linear_id_per_level (tets + ielem, ids[ielem], level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[0], "tet init per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dtet_init_linear_id (tets + ielem, ids[ielem], level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[1], "tet init table");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum += t8_dtet_linear_id_per_level (tets + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[2], "tet id per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum -= t8_dtet_linear_id (tets + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[3], "tet id table");
+
+  /* Both versions must compute the same ids */
+  SC_CHECK_ABORT (sum == 0, "Linear ids of tetrahedra do not match");
+  T8_FREE (tets);
+  T8_FREE (ids);
+}
+
+/* Measure the linear id routines of prisms */
+static void
+t8_time_linear_id_prism (int level, int num_elements, sc_statinfo_t * stats)
+{
+  sc_flopinfo_t       fi, snapshot;
+  t8_dprism_t        *prisms;
+  t8_linearidx_t     *ids, state = 1, sum = 0;
+  int                 ielem;
+
+  level = SC_MIN (level, T8_DPRISM_MAXLEVEL);
+  prisms = T8_ALLOC (t8_dprism_t, num_elements);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    ids[ielem] = t8_time_linear_id_random (&state, 3 * level);
+  }
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dprism_init_linear_id_per_level (prisms + ielem, level, ids[ielem]);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[0],
+                          "prism init per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    t8_dprism_init_linear_id (prisms + ielem, level, ids[ielem]);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[1], "prism init table");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum += t8_dprism_linear_id_per_level (prisms + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[2], "prism id per level");
+
+  t8_time_linear_id_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    sum -= t8_dprism_linear_id (prisms + ielem, level);
+  }
+  t8_time_linear_id_stop (&fi, &snapshot, &stats[3], "prism id table");
+
+  /* Both versions must compute the same ids */
+  SC_CHECK_ABORT (sum == 0, "Linear ids of prisms do not match");
+  T8_FREE (prisms);
+  T8_FREE (ids);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_argc, help = 0;
+  int                 level, num_elements;
+  sc_options_t       *opt;
+  sc_statinfo_t       stats[3 * T8_TIME_LINEAR_ID_NUM_STATS];
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_STATISTICS);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &help,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 'l', "level", &level, T8_DTRI_MAXLEVEL,
+                      "The refinement level of the elements. For each "
+                      "element class, this is cut off at the maximum level "
+                      "of the class. Default is the maximum triangle level.");
+  sc_options_add_int (opt, 'n', "num-elements", &num_elements, 1000000,
+                      "The number of elements per element class.");
+
+  first_argc = sc_options_parse (t8_get_package_id (), SC_LP_DEFAULT,
+                                 opt, argc, argv);
+  if (first_argc < 0 || first_argc != argc || level < 0
+      || num_elements <= 0) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+    return 1;
+  }
+  if (help) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else {
+    t8_time_linear_id_tri (level, num_elements, stats);
+    t8_time_linear_id_tet (level, num_elements,
+                           stats + T8_TIME_LINEAR_ID_NUM_STATS);
+    t8_time_linear_id_prism (level, num_elements,
+                             stats + 2 * T8_TIME_LINEAR_ID_NUM_STATS);
+    sc_stats_compute (sc_MPI_COMM_WORLD, 3 * T8_TIME_LINEAR_ID_NUM_STATS,
+                      stats);
+    sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
+                    3 * T8_TIME_LINEAR_ID_NUM_STATS, stats, 1, 1);
+  }
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
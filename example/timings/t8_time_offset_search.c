@@ -0,0 +1,312 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this example we measure the runtime of the owner searches in
+ * partition offset arrays as they are used when repartitioning a cmesh.
+ * We create a synthetic offset array for a given number of ranks and
+ * trees, where some ranks are empty and some share their first tree.
+ * We compare the binary searches of t8_cmesh_offset.c and the searches
+ * with an owner lookup structure with linear reference searches and check
+ * that all give the same results.
+ * No communication takes place, thus this example can be run on a
+ * single process with any simulated number of ranks. */
+
+#include <sc_flops.h>
+#include <sc_statistics.h>
+#include <sc_options.h>
+#include <t8.h>
+#include <t8_cmesh/t8_cmesh_offset.h>
+
+/* The number of measurements */
+#define T8_TIME_OFFSET_NUM_STATS 12
+
+/* A simple linear congruential generator, such that all runs use the
+ * same offsets and trees. */
+static              uint64_t
+t8_time_offset_random (uint64_t * state)
+{
+  *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *state >> 33;
+}
+
+/* Create an offset array for num_ranks ranks and num_trees trees.
+ * The first tree of each nonempty rank is shared with probability 1/2. */
+static t8_gloidx_t *
+t8_time_offset_create (int num_ranks, t8_gloidx_t num_trees)
+{
+  t8_gloidx_t        *offset, start;
+  uint64_t            state = 1;
+  int                 rank;
+
+  offset = T8_ALLOC (t8_gloidx_t, num_ranks + 1);
+  offset[0] = 0;
+  for (rank = 1; rank < num_ranks; rank++) {
+    start = (t8_gloidx_t) ((double) num_trees * rank / num_ranks);
+    offset[rank] = start;
+    if (start > 0 && t8_time_offset_random (&state) % 2) {
+      /* This rank shares the last tree of the previous nonempty rank */
+      offset[rank] = t8_offset_first_tree_to_entry (start - 1, 1);
+    }
+  }
+  offset[num_ranks] = num_trees;
+  return offset;
+}
+
+/* The linear search for the first owner of a tree, starting at an
+ * arbitrary owner. */
+static int
+t8_time_offset_first_owner_linear (int mpisize, t8_gloidx_t gtree,
+                                   t8_gloidx_t * offset)
+{
+  int                 proc;
+
+  proc = t8_offset_any_owner_of_tree (mpisize, gtree, offset);
+  while (proc > 0 && (t8_offset_empty (proc - 1, offset)
+                      || t8_offset_in_range (gtree, proc - 1, offset))) {
+    proc--;
+  }
+  while (t8_offset_empty (proc, offset)) {
+    proc++;
+  }
+  return proc;
+}
+
+/* The linear search for the last owner of a tree, starting at an
+ * arbitrary owner. */
+static int
+t8_time_offset_last_owner_linear (int mpisize, t8_gloidx_t gtree,
+                                  t8_gloidx_t * offset)
+{
+  int                 proc;
+
+  proc = t8_offset_any_owner_of_tree (mpisize, gtree, offset);
+  while (proc < mpisize - 1 && (t8_offset_empty (proc + 1, offset)
+                                || t8_offset_in_range (gtree, proc + 1,
+                                                       offset))) {
+    proc++;
+  }
+  while (t8_offset_empty (proc, offset)) {
+    proc--;
+  }
+  return proc;
+}
+
+/* The linear search for the next nonempty rank */
+static int
+t8_time_offset_next_nonempty_linear (int rank, int mpisize,
+                                     t8_gloidx_t * offset)
+{
+  rank++;
+  while (rank < mpisize && t8_offset_empty (rank, offset)) {
+    rank++;
+  }
+  return rank;
+}
+
+/* Start a measurement */
+static void
+t8_time_offset_start (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot)
+{
+  sc_flops_start (fi);
+  sc_flops_snap (fi, snapshot);
+}
+
+/* Stop a measurement and store the runtime in a statistics entry */
+static void
+t8_time_offset_stop (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot,
+                     sc_statinfo_t * stats, const char *name)
+{
+  sc_flops_shot (fi, snapshot);
+  sc_stats_set1 (stats, snapshot->iwtime, name);
+}
+
+/* Measure the owner searches for num_queries random trees and the
+ * next nonempty search for num_queries random ranks. */
+static void
+t8_time_offset_search (int num_ranks, t8_gloidx_t num_trees,
+                       int num_queries, sc_statinfo_t * stats)
+{
+  sc_flopinfo_t       fi, snapshot;
+  t8_gloidx_t        *offset, *trees;
+  t8_offset_lookup_t *lookup;
+  int                *ranks, *results, *owners, iquery, some_owner;
+  uint64_t            state = 2;
+
+  offset = t8_time_offset_create (num_ranks, num_trees);
+  trees = T8_ALLOC (t8_gloidx_t, num_queries);
+  ranks = T8_ALLOC (int, num_queries);
+  results = T8_ALLOC (int, num_queries);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    trees[iquery] = t8_time_offset_random (&state) % num_trees;
+    ranks[iquery] = t8_time_offset_random (&state) % num_ranks;
+  }
+
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    results[iquery] =
+      t8_time_offset_first_owner_linear (num_ranks, trees[iquery], offset);
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[0], "first owner linear");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    some_owner = -1;
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_first_owner_of_tree (num_ranks, trees[iquery],
+                                                   offset, &some_owner),
+                    "First owners do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[1], "first owner search");
+  t8_time_offset_start (&fi, &snapshot);
+  lookup = t8_offset_lookup_new (num_ranks, offset);
+  t8_time_offset_stop (&fi, &snapshot, &stats[6], "lookup build");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_lookup_first_owner_of_tree (lookup,
+                                                          trees[iquery]),
+                    "First owners do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[7], "first owner lookup");
+
+  /* Compute the owner after the first owner of each tree */
+  owners = T8_ALLOC (int, num_queries);
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    owners[iquery] = t8_offset_next_owner_of_tree (num_ranks, trees[iquery],
+                                                   offset, results[iquery]);
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[8], "next owner search");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    SC_CHECK_ABORT (owners[iquery] ==
+                    t8_offset_lookup_next_owner_of_tree (lookup,
+                                                         trees[iquery],
+                                                         results[iquery]),
+                    "Next owners do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[9], "next owner lookup");
+  T8_FREE (owners);
+
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    results[iquery] =
+      t8_time_offset_last_owner_linear (num_ranks, trees[iquery], offset);
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[2], "last owner linear");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    some_owner = -1;
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_last_owner_of_tree (num_ranks, trees[iquery],
+                                                  offset, &some_owner),
+                    "Last owners do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[3], "last owner search");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_lookup_last_owner_of_tree (lookup,
+                                                         trees[iquery]),
+                    "Last owners do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[10], "last owner lookup");
+
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    results[iquery] =
+      t8_time_offset_next_nonempty_linear (ranks[iquery], num_ranks, offset);
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[4], "next nonempty linear");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_next_nonempty_rank (ranks[iquery], num_ranks,
+                                                  offset),
+                    "Next nonempty ranks do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[5], "next nonempty search");
+  t8_time_offset_start (&fi, &snapshot);
+  for (iquery = 0; iquery < num_queries; iquery++) {
+    SC_CHECK_ABORT (results[iquery] ==
+                    t8_offset_lookup_next_nonempty_rank (lookup,
+                                                         ranks[iquery]),
+                    "Next nonempty ranks do not match");
+  }
+  t8_time_offset_stop (&fi, &snapshot, &stats[11], "next nonempty lookup");
+
+  t8_offset_lookup_destroy (&lookup);
+  T8_FREE (offset);
+  T8_FREE (trees);
+  T8_FREE (ranks);
+  T8_FREE (results);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_argc, help = 0;
+  int                 num_ranks, num_trees, num_queries;
+  sc_options_t       *opt;
+  sc_statinfo_t       stats[T8_TIME_OFFSET_NUM_STATS];
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_STATISTICS);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &help,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 'p', "ranks", &num_ranks, 100000,
+                      "The number of simulated MPI ranks.");
+  sc_options_add_int (opt, 't', "trees", &num_trees, 50000,
+                      "The number of trees. If smaller than the number "
+                      "of ranks, there are empty ranks.");
+  sc_options_add_int (opt, 'n', "num-queries", &num_queries, 100000,
+                      "The number of searches per measurement.");
+
+  first_argc = sc_options_parse (t8_get_package_id (), SC_LP_DEFAULT,
+                                 opt, argc, argv);
+  if (first_argc < 0 || first_argc != argc || num_ranks <= 0
+      || num_trees <= 0 || num_queries <= 0) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+    return 1;
+  }
+  if (help) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else {
+    t8_time_offset_search (num_ranks, num_trees, num_queries, stats);
+    sc_stats_compute (sc_MPI_COMM_WORLD, T8_TIME_OFFSET_NUM_STATS, stats);
+    sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
+                    T8_TIME_OFFSET_NUM_STATS, stats, 1, 1);
+  }
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
@@ -0,0 +1,296 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/* In this example we measure the runtime of the element operations of
+ * the default schemes. For each element class except vertices we create
+ * a number of pseudo random elements at a given level in one contiguous
+ * array, as they are stored in a forest, and call each operation once per
+ * element through the virtual interface of t8_eclass_scheme_c.
+ * Faces are only transformed for the classes of tree faces.
+ * We report the runtime in nanoseconds per operation. These numbers serve
+ * as the baseline for optimizations of the element implementations. */
+
+#include <sc_flops.h>
+#include <sc_statistics.h>
+#include <sc_options.h>
+#include <t8.h>
+#include <t8_eclass.h>
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default_cxx.hxx>
+
+/* The operations that we measure */
+typedef enum
+{
+  T8_TIME_SCHEME_SET_LINEAR_ID = 0,
+  T8_TIME_SCHEME_GET_LINEAR_ID,
+  T8_TIME_SCHEME_CHILD,
+  T8_TIME_SCHEME_PARENT,
+  T8_TIME_SCHEME_SUCCESSOR,
+  T8_TIME_SCHEME_FACE_NEIGHBOR,
+  T8_TIME_SCHEME_TRANSFORM_FACE,
+  T8_TIME_SCHEME_NUM_OPS
+} t8_time_scheme_op_t;
+
+static const char  *t8_time_scheme_op_names[T8_TIME_SCHEME_NUM_OPS] = {
+  "set_linear_id",
+  "get_linear_id",
+  "child",
+  "parent",
+  "successor",
+  "face_neighbor",
+  "transform_face"
+};
+
+/* We measure all element classes except vertices */
+#define T8_TIME_SCHEME_NUM_ECLASSES (T8_ECLASS_COUNT - T8_ECLASS_LINE)
+
+/* The number of measurements */
+#define T8_TIME_SCHEME_NUM_STATS \
+  (T8_TIME_SCHEME_NUM_ECLASSES * T8_TIME_SCHEME_NUM_OPS)
+
+/* The maximum length of the name of a measurement */
+#define T8_TIME_SCHEME_NAME_LENGTH 64
+
+/* The names of the measurements, sc_stats only stores a pointer to them */
+static char
+  t8_time_scheme_names[T8_TIME_SCHEME_NUM_STATS][T8_TIME_SCHEME_NAME_LENGTH];
+
+/* Return a pseudo random number smaller than bound.
+ * We use a simple linear congruential generator, such that all
+ * runs use the same elements. */
+static              t8_linearidx_t
+t8_time_scheme_random (t8_linearidx_t * state, t8_linearidx_t bound)
+{
+  *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (*state >> 11) % bound;
+}
+
+/* Return the element at position index of a contiguous element array */
+static inline t8_element_t *
+t8_time_scheme_index (t8_element_t * elements, size_t element_size,
+                      int index)
+{
+  return (t8_element_t *) ((char *) elements + index * element_size);
+}
+
+/* Start a measurement */
+static void
+t8_time_scheme_start (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot)
+{
+  sc_flops_start (fi);
+  sc_flops_snap (fi, snapshot);
+}
+
+/* The index of the measurement of an operation of an element class */
+static int
+t8_time_scheme_stat_index (int eclass, t8_time_scheme_op_t op)
+{
+  return (eclass - T8_ECLASS_LINE) * T8_TIME_SCHEME_NUM_OPS + op;
+}
+
+/* Stop a measurement of num_elements operations and store the runtime per
+ * operation in nanoseconds in a statistics entry */
+static void
+t8_time_scheme_stop (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot,
+                     int num_elements, int eclass, t8_time_scheme_op_t op,
+                     sc_statinfo_t * stats)
+{
+  const int           index = t8_time_scheme_stat_index (eclass, op);
+
+  sc_flops_shot (fi, snapshot);
+  sc_stats_set1 (stats + index, 1e9 * snapshot->iwtime / num_elements,
+                 t8_time_scheme_names[index]);
+}
+
+/* Measure the operations of one element class. Operations that do not
+ * apply to the class are stored as 0. Return a checksum of the results,
+ * such that the compiler cannot remove the operations. */
+static              t8_linearidx_t
+t8_time_scheme_eclass (t8_eclass_scheme_c * ts, int eclass, int level,
+                       int num_elements, sc_statinfo_t * stats)
+{
+  sc_flopinfo_t       fi, snapshot;
+  t8_element_t       *elements, *results, *elem, *result;
+  t8_linearidx_t     *ids, state = 1, count, sum = 0;
+  size_t              element_size;
+  int                 ielem, op, index, num_faces, num_corners, neigh_face;
+
+  for (op = 0; op < T8_TIME_SCHEME_NUM_OPS; op++) {
+    index = t8_time_scheme_stat_index (eclass, (t8_time_scheme_op_t) op);
+    snprintf (t8_time_scheme_names[index], T8_TIME_SCHEME_NAME_LENGTH,
+              "%s %s ns/op", t8_eclass_to_string[eclass],
+              t8_time_scheme_op_names[op]);
+    sc_stats_set1 (stats + index, 0, t8_time_scheme_names[index]);
+  }
+  /* We need a parent and a child of each element */
+  level = SC_MAX (1, SC_MIN (level, ts->t8_element_maxlevel () - 1));
+  count = ts->t8_element_count_leafs_from_root (level);
+  element_size = ts->t8_element_size ();
+  elements = (t8_element_t *) T8_ALLOC (char, num_elements * element_size);
+  results = (t8_element_t *) T8_ALLOC (char, num_elements * element_size);
+  ts->t8_element_init (num_elements, elements, 0);
+  ts->t8_element_init (num_elements, results, 0);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  /* Exclude the last element, such that each element has a successor */
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    ids[ielem] = count > 1 ? t8_time_scheme_random (&state, count - 1) : 0;
+  }
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    ts->t8_element_set_linear_id (elem, level, ids[ielem]);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_SET_LINEAR_ID, stats);
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    sum += ts->t8_element_get_linear_id (elem, level);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_GET_LINEAR_ID, stats);
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    result = t8_time_scheme_index (results, element_size, ielem);
+    ts->t8_element_child (elem, ids[ielem] % ts->t8_element_num_children
+                          (elem), result);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_CHILD, stats);
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    result = t8_time_scheme_index (results, element_size, ielem);
+    ts->t8_element_parent (elem, result);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_PARENT, stats);
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    result = t8_time_scheme_index (results, element_size, ielem);
+    ts->t8_element_successor (elem, result, level);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_SUCCESSOR, stats);
+
+  t8_time_scheme_start (&fi, &snapshot);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_time_scheme_index (elements, element_size, ielem);
+    result = t8_time_scheme_index (results, element_size, ielem);
+    num_faces = ts->t8_element_num_faces (elem);
+    sum += ts->t8_element_face_neighbor_inside (elem, result,
+                                                ielem % num_faces,
+                                                &neigh_face);
+  }
+  t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                       T8_TIME_SCHEME_FACE_NEIGHBOR, stats);
+
+  if (t8_eclass_to_dimension[eclass] <= 2) {
+    /* Only the classes of tree faces can be transformed */
+    t8_time_scheme_start (&fi, &snapshot);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      elem = t8_time_scheme_index (elements, element_size, ielem);
+      result = t8_time_scheme_index (results, element_size, ielem);
+      num_corners = ts->t8_element_num_corners (elem);
+      ts->t8_element_transform_face (elem, result, ielem % num_corners,
+                                     (ielem / num_corners) % 2,
+                                     (ielem / (2 * num_corners)) % 2);
+    }
+    t8_time_scheme_stop (&fi, &snapshot, num_elements, eclass,
+                         T8_TIME_SCHEME_TRANSFORM_FACE, stats);
+  }
+
+  /* Include the last results in the checksum */
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    result = t8_time_scheme_index (results, element_size, ielem);
+    sum += ts->t8_element_level (result);
+  }
+  T8_FREE (elements);
+  T8_FREE (results);
+  T8_FREE (ids);
+  return sum;
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_argc, help = 0;
+  int                 level, num_elements, eclass;
+  t8_linearidx_t      sum = 0;
+  t8_scheme_cxx_t    *scheme;
+  sc_options_t       *opt;
+  sc_statinfo_t       stats[T8_TIME_SCHEME_NUM_STATS];
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_STATISTICS);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_switch (opt, 'h', "help", &help,
+                         "Display a short help message.");
+  sc_options_add_int (opt, 'l', "level", &level, 10,
+                      "The refinement level of the elements. For each "
+                      "element class, this is cut off below the maximum "
+                      "level of the class.");
+  sc_options_add_int (opt, 'n', "num-elements", &num_elements, 1000000,
+                      "The number of elements per element class.");
+
+  first_argc = sc_options_parse (t8_get_package_id (), SC_LP_DEFAULT,
+                                 opt, argc, argv);
+  if (first_argc < 0 || first_argc != argc || level < 0
+      || num_elements <= 0) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+    return 1;
+  }
+  if (help) {
+    sc_options_print_usage (t8_get_package_id (), SC_LP_ERROR, opt, NULL);
+  }
+  else {
+    scheme = t8_scheme_new_default_cxx ();
+    for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+      sum += t8_time_scheme_eclass (scheme->eclass_schemes[eclass], eclass,
+                                    level, num_elements, stats);
+    }
+    t8_scheme_cxx_unref (&scheme);
+    t8_debugf ("Checksum %llu\n", (unsigned long long) sum);
+    sc_stats_compute (sc_MPI_COMM_WORLD, T8_TIME_SCHEME_NUM_STATS, stats);
+    sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
+                    T8_TIME_SCHEME_NUM_STATS, stats, 1, 1);
+  }
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
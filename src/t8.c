@@ -158,6 +158,24 @@ t8_init (int log_threshold)
   t8_global_productionf ("%-*s %s\n", w, "LIBS", T8_LIBS);
 }
 
+/* The maximal number of bytes that t8_bcast_bytes sends with
+ * one call to sc_MPI_Bcast. */
+#define T8_BCAST_CHUNK_BYTES ((size_t) 1 << 26)
+
+void
+t8_bcast_bytes (void *buffer, size_t num_bytes, int root, sc_MPI_Comm comm)
+{
+  size_t              offset, count;
+  int                 mpiret;
+
+  for (offset = 0; offset < num_bytes; offset += count) {
+    count = SC_MIN (T8_BCAST_CHUNK_BYTES, num_bytes - offset);
+    mpiret = sc_MPI_Bcast ((char *) buffer + offset, (int) count,
+                           sc_MPI_BYTE, root, comm);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
 void               *
 t8_sc_array_index_topidx (sc_array_t * array, t8_topidx_t it)
 {
@@ -173,3 +191,172 @@ t8_sc_array_index_locidx (sc_array_t * array, t8_locidx_t it)
 
   return array->array + array->elem_size * (size_t) it;
 }
+
+#ifdef T8_ENABLE_ALLOC_COUNT
+
+/* The allocations of one call site of T8_ALLOC and friends. */
+typedef struct
+{
+  const char         *file;
+  int                 line;
+  long                count;    /* The number of allocations */
+  size_t              bytes;    /* The number of allocated bytes */
+}
+t8_alloc_site_t;
+
+/* All call sites that allocated memory, created on first use. */
+static sc_hash_array_t *t8_alloc_sites = NULL;
+/* The number of calls to T8_FREE with non-NULL memory. */
+static long         t8_alloc_num_frees = 0;
+
+static unsigned
+t8_alloc_site_hash (const void *v, const void *u)
+{
+  const t8_alloc_site_t *site = (const t8_alloc_site_t *) v;
+  const char         *c;
+  unsigned            hash = (unsigned) site->line;
+
+  for (c = site->file; *c != '\0'; ++c) {
+    hash = 31 * hash + (unsigned char) *c;
+  }
+  return hash;
+}
+
+static int
+t8_alloc_site_equal (const void *v1, const void *v2, const void *u)
+{
+  const t8_alloc_site_t *site1 = (const t8_alloc_site_t *) v1;
+  const t8_alloc_site_t *site2 = (const t8_alloc_site_t *) v2;
+
+  return site1->line == site2->line && !strcmp (site1->file, site2->file);
+}
+
+/* Sort call sites by descending number of allocations. */
+static int
+t8_alloc_site_compare (const void *v1, const void *v2)
+{
+  const t8_alloc_site_t *site1 = (const t8_alloc_site_t *) v1;
+  const t8_alloc_site_t *site2 = (const t8_alloc_site_t *) v2;
+
+  return site1->count < site2->count ? 1 :
+    (site1->count > site2->count ? -1 : 0);
+}
+
+static void
+t8_alloc_count_record (size_t size, const char *file, int line)
+{
+  t8_alloc_site_t     key, *site;
+  size_t              position;
+
+#ifdef T8_ENABLE_OPENMP
+#pragma omp critical (t8_alloc_count)
+#endif
+  {
+    if (t8_alloc_sites == NULL) {
+      /* We allocate with sc directly, such that the table is not counted */
+      t8_alloc_sites = sc_hash_array_new (sizeof (t8_alloc_site_t),
+                                          t8_alloc_site_hash,
+                                          t8_alloc_site_equal, NULL);
+    }
+    key.file = file;
+    key.line = line;
+    site = (t8_alloc_site_t *)
+      sc_hash_array_insert_unique (t8_alloc_sites, &key, &position);
+    if (site == NULL) {
+      /* This site has allocated before */
+      site = (t8_alloc_site_t *) sc_array_index (&t8_alloc_sites->a,
+                                                 position);
+    }
+    else {
+      site->file = file;
+      site->line = line;
+      site->count = 0;
+      site->bytes = 0;
+    }
+    site->count++;
+    site->bytes += size;
+  }
+}
+
+void               *
+t8_alloc_count_malloc (size_t size, const char *file, int line)
+{
+  t8_alloc_count_record (size, file, line);
+  return sc_malloc (p4est_package_id, size);
+}
+
+void               *
+t8_alloc_count_calloc (size_t nmemb, size_t size, const char *file,
+                       int line)
+{
+  t8_alloc_count_record (nmemb * size, file, line);
+  return sc_calloc (p4est_package_id, nmemb, size);
+}
+
+void               *
+t8_alloc_count_realloc (void *ptr, size_t size, const char *file, int line)
+{
+  t8_alloc_count_record (size, file, line);
+  return sc_realloc (p4est_package_id, ptr, size);
+}
+
+void
+t8_alloc_count_free (void *ptr, const char *file, int line)
+{
+  if (ptr != NULL) {
+#ifdef T8_ENABLE_OPENMP
+#pragma omp atomic
+#endif
+    t8_alloc_num_frees++;
+  }
+  sc_free (p4est_package_id, ptr);
+}
+
+#endif /* T8_ENABLE_ALLOC_COUNT */
+
+void
+t8_alloc_count_print (void)
+{
+#ifdef T8_ENABLE_ALLOC_COUNT
+  sc_array_t          sorted;
+  t8_alloc_site_t    *site;
+  long                total_count = 0;
+  size_t              isite, total_bytes = 0;
+
+  if (t8_alloc_sites == NULL) {
+    t8_logf (SC_LC_NORMAL, SC_LP_STATISTICS, "No allocations recorded.\n");
+    return;
+  }
+  /* Copy the sites, since sorting would invalidate the hash table */
+  sc_array_init (&sorted, sizeof (t8_alloc_site_t));
+  sc_array_copy (&sorted, &t8_alloc_sites->a);
+  sc_array_sort (&sorted, t8_alloc_site_compare);
+  t8_logf (SC_LC_NORMAL, SC_LP_STATISTICS,
+           "Allocations per call site (count, bytes):\n");
+  for (isite = 0; isite < sorted.elem_count; ++isite) {
+    site = (t8_alloc_site_t *) sc_array_index (&sorted, isite);
+    t8_logf (SC_LC_NORMAL, SC_LP_STATISTICS, "  %s:%i %li %llu\n",
+             site->file, site->line, site->count,
+             (unsigned long long) site->bytes);
+    total_count += site->count;
+    total_bytes += site->bytes;
+  }
+  t8_logf (SC_LC_NORMAL, SC_LP_STATISTICS,
+           "Allocations in total: %li (%llu bytes) at %zd sites, "
+           "frees: %li\n", total_count, (unsigned long long) total_bytes,
+           sorted.elem_count, t8_alloc_num_frees);
+  sc_array_reset (&sorted);
+#endif
+}
+
+void
+t8_alloc_count_reset (void)
+{
+#ifdef T8_ENABLE_ALLOC_COUNT
+  if (t8_alloc_sites != NULL) {
+    sc_hash_array_destroy (t8_alloc_sites);
+    t8_alloc_sites = NULL;
+  }
+  t8_alloc_num_frees = 0;
+#endif
+}
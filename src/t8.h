@@ -65,10 +65,23 @@ T8_EXTERN_C_BEGIN ();
 #define t8_restrict _sc_restrict
 
 #define T8_ASSERT P4EST_ASSERT          /**< TODO: write proper function. */
+#ifndef T8_ENABLE_ALLOC_COUNT
 #define T8_ALLOC P4EST_ALLOC            /**< TODO: write proper function. */
 #define T8_ALLOC_ZERO P4EST_ALLOC_ZERO  /**< TODO: write proper function. */
 #define T8_FREE P4EST_FREE              /**< TODO: write proper function. */
 #define T8_REALLOC P4EST_REALLOC        /**< TODO: write proper function. */
+#else
+/* With --enable-alloc-count every allocation is recorded with its
+ * call site.  The memory is still managed by libsc with p4est's package
+ * id, such that memory from T8_ALLOC may be freed with P4EST_FREE. */
+#define T8_ALLOC(t,n) \
+  ((t *) t8_alloc_count_malloc ((n) * sizeof (t), __FILE__, __LINE__))
+#define T8_ALLOC_ZERO(t,n) \
+  ((t *) t8_alloc_count_calloc ((size_t) (n), sizeof (t), __FILE__, __LINE__))
+#define T8_FREE(p) t8_alloc_count_free ((p), __FILE__, __LINE__)
+#define T8_REALLOC(p,t,n) \
+  ((t *) t8_alloc_count_realloc ((p), (n) * sizeof (t), __FILE__, __LINE__))
+#endif
 
 /** A type for counting coarse mesh related values (trees, tree vertices, ...).
  * The name topidx alludes to mesh topology as this is what cmesh defines.
@@ -122,6 +135,17 @@ typedef enum
   T8_MPI_PARTITION_FOREST,  /**< Used for forest partitioning */
   T8_MPI_GHOST_FOREST,  /**< Used for for ghost layer creation */
   T8_MPI_GHOST_EXC_FOREST,  /**< Used for ghost data exchange */
+  T8_MPI_GHOST_EXC_PLAN,  /**< Used for ghost data exchange with a plan */
+  T8_MPI_GHOST_EXC_FIELDS,  /**< Used for multi-field ghost data exchange */
+  T8_MPI_GHOST_RMA,  /**< Used for the window positions of one-sided ghost data exchange */
+  T8_MPI_GHOST_LAYERS,  /**< Used for the construction of ghost layers */
+  T8_MPI_SEARCH_PARTITION_QUERY,  /**< Used to send queries in a partition search */
+  T8_MPI_SEARCH_PARTITION_RESULT,  /**< Used to return the results of a partition search */
+  T8_MPI_MSH_NODES,  /**< Used to distribute the nodes of a .msh file */
+  T8_MPI_MSH_FACES,  /**< Used to match the faces of a .msh file */
+  T8_MPI_REFINE_CMESH,  /**< Used to exchange the children of trees in cmesh refinement */
+  T8_MPI_FOREST_TRANSFER,  /**< Used to transfer data between two forests */
+  T8_MPI_SORT_POINTS,  /**< Used to send points to the owners of their elements */
   T8_MPI_TAG_LAST
 }
 t8_MPI_tag_t;
@@ -257,6 +281,69 @@ void               *t8_sc_array_index_topidx (sc_array_t * array,
 void               *t8_sc_array_index_locidx (sc_array_t * array,
                                               t8_locidx_t it);
 
+/** Broadcast a buffer of bytes from a root process to all processes.
+ * Large buffers are split into chunks that are broadcast one after another.
+ * Thus, buffers larger than the range of int can be sent and the
+ * forwarding of a chunk overlaps with the transfer of the next one.
+ * \param [in,out] buffer    On \a root the data to broadcast, on the other
+ *                           processes allocated memory of \a num_bytes bytes.
+ * \param [in]     num_bytes The number of bytes in \a buffer.
+ * \param [in]     root      The rank that broadcasts \a buffer.
+ * \param [in]     comm      The MPI communicator to use.
+ */
+void                t8_bcast_bytes (void *buffer, size_t num_bytes, int root,
+                                    sc_MPI_Comm comm);
+
+#ifdef T8_ENABLE_ALLOC_COUNT
+
+/** Allocate memory and record the allocation for \a file and \a line.
+ * Used by T8_ALLOC if t8code is configured with --enable-alloc-count.
+ * \param [in] size    The number of bytes to allocate.
+ * \param [in] file    The source file of the call site.
+ * \param [in] line    The line of the call site.
+ * \return             The allocated memory.
+ */
+void               *t8_alloc_count_malloc (size_t size, const char *file,
+                                           int line);
+
+/** Allocate zeroed memory and record the allocation.
+ * Used by T8_ALLOC_ZERO if t8code is configured with --enable-alloc-count.
+ * \see t8_alloc_count_malloc
+ */
+void               *t8_alloc_count_calloc (size_t nmemb, size_t size,
+                                           const char *file, int line);
+
+/** Reallocate memory and record the reallocation as an allocation.
+ * Used by T8_REALLOC if t8code is configured with --enable-alloc-count.
+ * \see t8_alloc_count_malloc
+ */
+void               *t8_alloc_count_realloc (void *ptr, size_t size,
+                                            const char *file, int line);
+
+/** Free memory and count the deallocation.
+ * Used by T8_FREE if t8code is configured with --enable-alloc-count.
+ * \param [in] ptr     Memory from T8_ALLOC or NULL.
+ * \param [in] file    The source file of the call site.
+ * \param [in] line    The line of the call site.
+ */
+void                t8_alloc_count_free (void *ptr, const char *file,
+                                         int line);
+
+#endif /* T8_ENABLE_ALLOC_COUNT */
+
+/** Print the number of allocations and allocated bytes of each call site
+ * of T8_ALLOC, T8_ALLOC_ZERO and T8_REALLOC on this process, sorted by
+ * the number of allocations.  Does nothing unless t8code is configured
+ * with --enable-alloc-count.  It is called by \ref t8_forest_print_profile
+ * and may be called before sc_finalize to print the counts of a run.
+ */
+void                t8_alloc_count_print (void);
+
+/** Reset the allocation counts of \ref t8_alloc_count_print to zero and
+ * free the memory used to store them.
+ */
+void                t8_alloc_count_reset (void);
+
 /* call this at the end of a header file to match T8_EXTERN_C_BEGIN (). */
 T8_EXTERN_C_END ();
 
@@ -50,10 +50,42 @@
  *       edit: This should be achieved now.
  */
 
+/** The attribute key of the vertex indices of a tree.
+ * \see t8_cmesh_set_tree_vertex_indices */
+#define T8_CMESH_VERTEX_INDICES_ATTRIBUTE_KEY 1
+
+/** The attribute key of the index of the attributes of a tree that are
+ * stored in an attribute file.
+ * \see t8_cmesh_set_tree_attribute_file */
+#define T8_CMESH_ATTRIBUTE_FILE_KEY 2
+
 typedef struct t8_cmesh *t8_cmesh_t;
 typedef struct t8_ctree *t8_ctree_t;
 typedef struct t8_cghost *t8_cghost_t;
 
+/** The location of the data of an attribute in an attribute file.
+ * \see t8_cmesh_set_tree_attribute_file */
+typedef struct t8_cmesh_attribute_location
+{
+  int                 package_id; /**< The package id of the attribute. */
+  int                 key;        /**< The key of the attribute. */
+  size_t              offset;     /**< The offset of the data in the file in bytes. */
+  size_t              size;       /**< The size of the data in bytes. */
+} t8_cmesh_attribute_location_t;
+
+/** The number of bytes that the components of a cmesh occupy on this process.
+ * \see t8_cmesh_memory_usage */
+typedef struct
+{
+  size_t              cmesh;       /**< The cmesh struct. */
+  size_t              trees;       /**< The local trees and ghosts with their face neighbors and attributes. */
+  size_t              hash_tables; /**< The ghost id and file attribute hash tables and their memory pools. */
+  size_t              offsets;     /**< The tree offsets in shared memory. */
+  size_t              face_table;  /**< The face table. */
+  size_t              profile;     /**< The profile. */
+  size_t              total;       /**< The sum of all components. */
+} t8_cmesh_memory_usage_t;
+
 T8_EXTERN_C_BEGIN ();
 
 /** Create a new cmesh with reference count one.
@@ -235,9 +267,16 @@ void                t8_cmesh_set_partition_given (t8_cmesh_t cmesh,
 #endif
 
 /** Refine the cmesh to a given level.
- * Thus split each tree into x^level subtrees
- * TODO: implement */
-/* If level = 0  then no refinement is performed */
+ * Thus split each tree into x^level subtrees, where the children of
+ * a tree and their order are those of the elements of \a scheme.
+ * This works for replicated and partitioned cmeshes of all eclasses.
+ * If level = 0  then no refinement is performed.
+ * \param [in,out] cmesh       The cmesh to be refined. It must be derived
+ *                             from a committed cmesh.
+ * \param [in] level           The uniform refinement level.
+ * \param [in] scheme          The element scheme that describes the children.
+ *                             We take ownership of it.
+ */
 void                t8_cmesh_set_refine (t8_cmesh_t cmesh, int level,
                                          t8_scheme_cxx_t * scheme);
 
@@ -309,6 +348,158 @@ void                t8_cmesh_set_join (t8_cmesh_t cmesh, t8_gloidx_t gtree1,
                                        t8_gloidx_t gtree2, int face1,
                                        int face2, int orientation);
 
+/** Set all trees of a replicated cmesh at once from arrays in tree order.
+ * In contrast to \ref t8_cmesh_set_tree_class, \ref t8_cmesh_set_join and
+ * \ref t8_cmesh_set_tree_vertices the data does not go into the stash and
+ * is not sorted at commit. Instead, the trees are filled directly from
+ * the arrays. This saves memory and runtime for large meshes.
+ * The arrays are not copied and must not be modified or freed before
+ * \ref t8_cmesh_commit is called.
+ * The face entries of all trees are stored consecutively, thus the entries
+ * of tree i start after the t8_eclass_num_faces entries of the trees 0 to i-1.
+ * The same holds for the vertices with 3 * t8_eclass_num_vertices entries.
+ * This function must not be combined with any other function that adds
+ * trees, face connections or attributes and the cmesh must not be
+ * partitioned or derived.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     num_trees    The number of trees.
+ * \param [in]     tree_classes The class of each tree.
+ * \param [in]     face_neighbors For each face of each tree the local id of
+ *                              the neighbor tree or a negative value if the
+ *                              face is a domain boundary. May be NULL, in which case
+ *                              all faces are boundaries.
+ * \param [in]     tree_to_face For each face of each tree the face number at the
+ *                              neighbor tree and the orientation of the connection encoded as
+ *                              orientation * F + face, where F is the maximal number
+ *                              of faces of an eclass of the cmesh's dimension.
+ *                              Ignored at boundary faces. Must be given if and only if
+ *                              \a face_neighbors is given.
+ * \param [in]     vertices     The vertex coordinates of each tree, or NULL.
+ */
+void                t8_cmesh_set_tree_arrays (t8_cmesh_t cmesh,
+                                              t8_locidx_t num_trees,
+                                              const t8_eclass_t *
+                                              tree_classes,
+                                              const t8_locidx_t *
+                                              face_neighbors,
+                                              const int8_t * tree_to_face,
+                                              const double *vertices);
+
+/** Set all trees of a cmesh whose trees have the same class at once from
+ * connectivity arrays in the layout of a p4est connectivity.
+ * As with \ref t8_cmesh_set_tree_arrays the data does not go into the stash,
+ * but the cmesh may be partitioned with \ref t8_cmesh_set_partition_range or
+ * \ref t8_cmesh_set_partition_offsets. Then each process only reads the
+ * entries of its local trees and of their face neighbors, such that the
+ * global arrays are never copied or communicated.
+ * The arrays are not copied and must not be modified or freed before
+ * \ref t8_cmesh_commit is called.
+ * This function must not be combined with any other function that adds
+ * trees, face connections or attributes and the cmesh must not be derived.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     eclass       The class of all trees.
+ * \param [in]     num_trees    The global number of trees.
+ * \param [in]     tree_to_tree For each face of each tree the global id of the
+ *                              neighbor tree. A face that is connected to itself
+ *                              is a domain boundary.
+ * \param [in]     tree_to_face For each face of each tree the face number at the
+ *                              neighbor tree and the orientation of the connection encoded as
+ *                              orientation * F + face, where F is the maximal number
+ *                              of faces of an eclass of the cmesh's dimension.
+ * \param [in]     tree_to_vertex For each vertex of each tree the index of its
+ *                              coordinates in \a vertices, or NULL.
+ * \param [in]     vertices     The 3 coordinates of each vertex referenced by
+ *                              \a tree_to_vertex. Must be given if and only if
+ *                              \a tree_to_vertex is given.
+ */
+void                t8_cmesh_set_connectivity_arrays (t8_cmesh_t cmesh,
+                                                      t8_eclass_t eclass,
+                                                      t8_gloidx_t num_trees,
+                                                      const t8_locidx_t *
+                                                      tree_to_tree,
+                                                      const int8_t *
+                                                      tree_to_face,
+                                                      const t8_locidx_t *
+                                                      tree_to_vertex,
+                                                      const double
+                                                      *vertices);
+
+/** Set a table of vertex coordinates that is shared by the trees of a cmesh.
+ * Instead of storing the coordinates of each tree with
+ * \ref t8_cmesh_set_tree_vertices, the trees reference the vertices of
+ * this table with \ref t8_cmesh_set_tree_vertex_indices.
+ * Since a vertex is usually shared by several trees, this reduces the
+ * memory of the stash and the data that is sent by \ref t8_cmesh_bcast.
+ * At commit, the coordinates of the trees on this process are looked up
+ * in the table, such that \ref t8_cmesh_get_tree_vertices can be used as
+ * usual. Afterwards the table is freed.
+ * If the cmesh is partitioned, the table only needs to contain the vertices
+ * of the trees that are set on this process, but the indices must be the
+ * same on all processes.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     num_vertices The number of vertices in the table.
+ * \param [in]     vertices     The 3 * \a num_vertices coordinates of the vertices.
+ *                              The coordinates are copied.
+ * \param [in]     single_precision If true, the table is stored with single
+ *                              precision which halves its memory. Note that the
+ *                              coordinates of the trees are then rounded to float.
+ */
+void                t8_cmesh_set_vertex_table (t8_cmesh_t cmesh,
+                                               t8_gloidx_t num_vertices,
+                                               const double *vertices,
+                                               int single_precision);
+
+/** Set the vertices of a tree as indices into the vertex table of the cmesh.
+ * The table must be set with \ref t8_cmesh_set_vertex_table before the
+ * cmesh is committed.
+ * The indices are stored as an attribute of the tree with the key
+ * \ref T8_CMESH_VERTEX_INDICES_ATTRIBUTE_KEY and are replaced by the vertex
+ * coordinates at commit.
+ * It is not allowed to set the vertices of a tree with both this function
+ * and \ref t8_cmesh_set_tree_vertices.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     gtree_id     The global id of the tree.
+ * \param [in]     indices      For each vertex of the tree its index in the table.
+ *                              The indices are copied.
+ * \param [in]     num_vertices The number of entries in \a indices. Must
+ *                              match the number of vertices of the tree.
+ */
+void                t8_cmesh_set_tree_vertex_indices (t8_cmesh_t cmesh,
+                                                      t8_gloidx_t gtree_id,
+                                                      const t8_gloidx_t *
+                                                      indices,
+                                                      int num_vertices);
+
+/** Store attributes of a tree in a file instead of in the cmesh.
+ * Only an index with the locations of the attributes in the file is stored
+ * at the tree, under the key \ref T8_CMESH_ATTRIBUTE_FILE_KEY.
+ * An attribute is read from the file on the first call of
+ * \ref t8_cmesh_get_attribute with its package id and key and is kept in
+ * the committed cmesh until it is destroyed.
+ * Since the trees only store the index, the attributes neither add to the
+ * memory of the cmesh nor are they communicated when the cmesh is
+ * partitioned or broadcast. A cmesh derived from this cmesh reads the
+ * attributes that it accesses again.
+ * The file must be readable by all processes under \a filename as long as
+ * cmeshes with this tree exist.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     gtree_id     The global id of the tree.
+ * \param [in]     filename     The name of the file storing the attributes.
+ * \param [in]     num_attributes The number of entries in \a locations.
+ * \param [in]     locations    The package id, key and location in the file
+ *                              of each attribute. The locations are copied.
+ *                              If an attribute with the same package id and
+ *                              key is set with \ref t8_cmesh_set_attribute,
+ *                              that one is found first.
+ */
+void                t8_cmesh_set_tree_attribute_file (t8_cmesh_t cmesh,
+                                                      t8_gloidx_t gtree_id,
+                                                      const char *filename,
+                                                      int num_attributes,
+                                                      const
+                                                      t8_cmesh_attribute_location_t
+                                                      * locations);
+
 /** Enable or disable profiling for a cmesh. If profiling is enabled, runtimes
  * and statistics are collected during cmesh_commit.
  * \param [in,out] cmesh        The cmesh to be updated.
@@ -322,6 +513,64 @@ void                t8_cmesh_set_join (t8_cmesh_t cmesh, t8_gloidx_t gtree1,
 void                t8_cmesh_set_profiling (t8_cmesh_t cmesh,
                                             int set_profiling);
 
+/** Renumber the trees of a cmesh along a space-filling curve at commit.
+ * The trees are sorted by the Morton index of their centroids, such that
+ * contiguous ranges of trees are spatially compact. This reduces the
+ * surface of the forest partitions and the ghost layer for coarse meshes
+ * with arbitrary tree numbering, for example meshes read from files.
+ * The tree ids passed to the t8_cmesh_set_* functions are replaced by
+ * the new ids, so that tree ids of the committed cmesh differ from them.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     set_reorder  If true, the trees are reordered.
+ *
+ * Reordering is disabled by default. All trees must have vertices,
+ * otherwise the trees are not reordered. The cmesh must be replicated,
+ * constructed with \ref t8_cmesh_set_tree_class and its tree ids must be
+ * 0, ..., number of trees - 1.
+ * The cmesh must not be committed before calling this function.
+ * \see t8_cmesh_reorder for a reordering with METIS.
+ */
+void                t8_cmesh_set_reorder (t8_cmesh_t cmesh, int set_reorder);
+
+/** Store the trees of a replicated cmesh once per node in shared memory.
+ * Usually, each process of a replicated cmesh holds its own copy of all
+ * trees. If this option is set, the trees, their face neighbors and
+ * attributes are moved into shared memory at commit and all processes of a
+ * node read the same copy.
+ * To actually share the memory, the intranode communicators of the commit
+ * communicator must have been created with \ref t8_shmem_init.
+ * Otherwise each process keeps its own copy as before.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     set_shared_memory If true, the trees are stored in
+ *                              shared memory.
+ *
+ * This option is disabled by default and ignored for partitioned cmeshes.
+ * The cmesh must not be committed before calling this function.
+ * \note The trees of a shared cmesh are read-only and
+ *       \ref t8_cmesh_destroy becomes collective over the commit
+ *       communicator.
+ */
+void                t8_cmesh_set_shared_memory (t8_cmesh_t cmesh,
+                                                int set_shared_memory);
+
+/** Store the face connections of the local trees and ghosts in a compact
+ * table at commit.
+ * Each entry of the table holds the local id of the neighbor, the encoded
+ * neighbor face and orientation and the eclass of the neighbor.
+ * The face neighbors of ghosts are stored as local ids, instead of global
+ * ids that are converted with a hash lookup.
+ * \ref t8_cmesh_get_face_neighbor, \ref t8_cmesh_tree_face_is_boundary
+ * and the forest face neighbor computation use the table if it exists.
+ * \param [in,out] cmesh        The cmesh to be updated.
+ * \param [in]     set_face_table If true, the face table is built.
+ *
+ * The table is disabled by default. It needs 8 bytes per face of each local
+ * tree and ghost in addition to the face neighbors of the trees.
+ * The cmesh must not be committed before calling this function.
+ */
+void                t8_cmesh_set_face_table (t8_cmesh_t cmesh,
+                                             int set_face_table);
+
 /* returns true if cmesh_a equals cmesh_b */
 /* TODO: document
  * collective or serial */
@@ -337,6 +586,19 @@ void                t8_cmesh_set_profiling (t8_cmesh_t cmesh,
 int                 t8_cmesh_is_equal (t8_cmesh_t cmesh_a,
                                        t8_cmesh_t cmesh_b);
 
+/** Return a 64-bit hash of the local trees and ghosts of a committed cmesh.
+ * The hash covers their classes, ids, face connections and attributes.
+ * It is computed on the first call and stored with the cmesh, which does
+ * not change after commit. Equal cmeshes have the same hash, such that
+ * \ref t8_cmesh_is_equal rejects cmeshes with different known hashes
+ * without comparing the trees, and derived structures can be cached
+ * with the hash as key.
+ * \param [in]    cmesh         A committed cmesh.
+ * \return                      The hash of the local part of \a cmesh.
+ * \note This function is not collective.
+ */
+uint64_t            t8_cmesh_get_hash (t8_cmesh_t cmesh);
+
 /** Check whether a cmesh is empty on all processes.
  * \param [in]  cmesh           A committed cmesh.
  * \return                      True (non-zero) if and only if the cmesh has trees at all.
@@ -384,6 +646,72 @@ int                 t8_cmesh_save (t8_cmesh_t cmesh, const char *fileprefix);
 /* TODO: Document */
 t8_cmesh_t          t8_cmesh_load (const char *filename, sc_MPI_Comm comm);
 
+/** Save a committed cmesh to a single binary file.
+ * All processes write their trees collectively with MPI I/O if t8code is
+ * configured with MPI I/O, otherwise one after the other.
+ * A replicated cmesh is written in equal parts by all processes.
+ * The file can be loaded with \ref t8_cmesh_load_parallel on any number
+ * of processes. The format is described in \ref t8_cmesh_save.h.
+ * \param [in]      cmesh     A committed cmesh.
+ * \param [in]      filename  The name of the file to write. An existing file
+ *                            is overwritten.
+ * \param [in]      comm      The communicator of \a cmesh.
+ * \return                    True on all processes if the file was written
+ *                            successfully, false otherwise.
+ * This function is collective.
+ */
+int                 t8_cmesh_save_parallel (t8_cmesh_t cmesh,
+                                            const char *filename,
+                                            sc_MPI_Comm comm);
+
+/** Save a committed replicated cmesh in raw format.
+ * The file stores the memory of the trees, faces and attributes as it is,
+ * such that \ref t8_cmesh_load_raw can use it without parsing or copying.
+ * The format is described in \ref t8_cmesh_save.h.
+ * Only the first process writes the file.
+ * \param [in]      cmesh     A committed and replicated cmesh.
+ * \param [in]      filename  The name of the file to write. An existing file
+ *                            is overwritten.
+ * \param [in]      comm      The communicator of \a cmesh.
+ * \return                    True on all processes if the file was written
+ *                            successfully, false otherwise.
+ * This function is collective.
+ */
+int                 t8_cmesh_save_raw (t8_cmesh_t cmesh,
+                                       const char *filename,
+                                       sc_MPI_Comm comm);
+
+/** Load a replicated cmesh from a file written with \ref t8_cmesh_save_raw.
+ * If mmap is available, each process maps the file into its memory and the
+ * trees of the cmesh are stored in the mapping. The pages of the mapping are
+ * only read from the file when they are accessed and are shared between the
+ * processes of a node as long as they are not modified.
+ * Otherwise the data of the trees is read with a single call.
+ * \param [in]      filename  The name of the file to read.
+ * \param [in]      comm      The communicator of the new cmesh.
+ * \return                    A committed cmesh on all processes or NULL on
+ *                            all processes if the file could not be read.
+ * This function is collective.
+ */
+t8_cmesh_t          t8_cmesh_load_raw (const char *filename,
+                                       sc_MPI_Comm comm);
+
+/** Load a cmesh from a file written with \ref t8_cmesh_save_parallel.
+ * If \a do_partition is true, each process only reads a contiguous range
+ * of trees from the file, such that the trees are distributed uniformly.
+ * \param [in]      filename  The name of the file to read.
+ * \param [in]      do_partition If true, a partitioned cmesh is loaded.
+ *                            Otherwise each process reads all trees and the
+ *                            cmesh is replicated.
+ * \param [in]      comm      The communicator of the new cmesh.
+ * \return                    A committed cmesh on all processes or NULL on
+ *                            all processes if the file could not be read.
+ * This function is collective.
+ */
+t8_cmesh_t          t8_cmesh_load_parallel (const char *filename,
+                                            int do_partition,
+                                            sc_MPI_Comm comm);
+
 /* TODO: Document */
 /* procs_per_node is only relevant in mode==JUQUEEN.
  *  num_files = 1 => replicated cmesh is constructed */
@@ -597,6 +925,18 @@ t8_locidx_t         t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh,
  */
 void                t8_cmesh_print_profile (t8_cmesh_t cmesh);
 
+/** Compute the number of bytes that a cmesh occupies on this process.
+ * Trees in shared memory are counted on each process that accesses them,
+ * trees that are mapped from a file with the size of their data.
+ * \param [in]    cmesh         The cmesh.
+ * \param [out]   usage         On output the bytes of each component of \a cmesh.
+ *
+ * \a cmesh must be committed before calling this function.
+ * \see t8_forest_memory_usage
+ */
+void                t8_cmesh_memory_usage (t8_cmesh_t cmesh,
+                                           t8_cmesh_memory_usage_t * usage);
+
 /** Return a pointer to the vertex coordinates of a tree.
  * \param [in]    cmesh         The cmesh.
  * \param [in]    ltreeid       The id of a loca tree.
@@ -614,8 +954,10 @@ double             *t8_cmesh_get_tree_vertices (t8_cmesh_t cmesh,
  * \param [in]     tree_id      The local number of the tree.
  * \param [out]    data_size    The size of the attribute in bytes.
  * \return         The attribute pointer of the tree \a tree_id.
+ *                 If the attribute is stored in an attribute file, it is
+ *                 read on the first call.
  * \a cmesh must be committed before calling this function.
- * \see t8_cmesh_set_attribute
+ * \see t8_cmesh_set_attribute \see t8_cmesh_set_tree_attribute_file
  */
 void               *t8_cmesh_get_attribute (t8_cmesh_t cmesh,
                                             int package_id, int key,
@@ -657,6 +999,42 @@ void                t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
                                              t8_gloidx_t * child_in_tree_end,
                                              int8_t * first_tree_shared);
 
+/** Calculate the section of a uniform forest for an arbitrary process, if
+ * the forest is distributed among \a num_ranks processes.
+ * As \ref t8_cmesh_uniform_bounds, this only depends on the global number
+ * of trees of \a cmesh and needs no communication and no loop over the trees.
+ * It can for example compute the bounds of all processes of a subset of the
+ * processes that \a cmesh lives on, or of a different number of processes.
+ * \param [in]    cmesh         The cmesh to be considered.
+ * \param [in]    level         The uniform refinement level to be created.
+ * \param [in]    ts            The element scheme for which to compute the bounds.
+ * \param [in]    rank          The process, 0 <= \a rank < \a num_ranks.
+ * \param [in]    num_ranks     The number of processes among which the
+ *                              elements are distributed.
+ * \param [out]   first_local_tree  As in \ref t8_cmesh_uniform_bounds, for \a rank.
+ * \param [out]   child_in_tree_begin As in \ref t8_cmesh_uniform_bounds, for \a rank.
+ * \param [out]   last_local_tree  As in \ref t8_cmesh_uniform_bounds, for \a rank.
+ * \param [out]   child_in_tree_end As in \ref t8_cmesh_uniform_bounds, for \a rank.
+ * \param [out]   first_tree_shared As in \ref t8_cmesh_uniform_bounds, for \a rank.
+ * \a cmesh must be committed before calling this function.
+ * \note \ref t8_cmesh_uniform_bounds is this function with the rank and size
+ * of \a cmesh.
+ */
+void                t8_cmesh_uniform_bounds_for_rank (t8_cmesh_t cmesh,
+                                                      int level,
+                                                      t8_scheme_cxx_t * ts,
+                                                      int rank, int num_ranks,
+                                                      t8_gloidx_t *
+                                                      first_local_tree,
+                                                      t8_gloidx_t *
+                                                      child_in_tree_begin,
+                                                      t8_gloidx_t *
+                                                      last_local_tree,
+                                                      t8_gloidx_t *
+                                                      child_in_tree_end,
+                                                      int8_t *
+                                                      first_tree_shared);
+
 /** Increase the reference counter of a cmesh.
  * \param [in,out] cmesh        On input, this cmesh must exist with positive
  *                              reference count.  It may be in any state.
@@ -690,6 +1068,9 @@ void                t8_cmesh_destroy (t8_cmesh_t * pcmesh);
 /* Functions for construcing complete and committed cmeshes */
 
 /** Constructs a cmesh from a given p4est_connectivity structure.
+ * The trees are read directly from the arrays of \a conn, see
+ * \ref t8_cmesh_set_connectivity_arrays. If the cmesh is partitioned, each
+ * process only reads its local trees and their face neighbors.
  * \param[in]       conn       The p4est connectivity.
  * \param[in]       comm       mpi communicator to be used with the new cmesh.
  * \param[in]       do_partition Flag whether the cmesh should be partitioned or not.
@@ -701,6 +1082,9 @@ t8_cmesh_t          t8_cmesh_new_from_p4est (p4est_connectivity_t * conn,
                                              int do_partition);
 
 /** Constructs a cmesh from a given p8est_connectivity structure.
+ * The trees are read directly from the arrays of \a conn, see
+ * \ref t8_cmesh_set_connectivity_arrays. If the cmesh is partitioned, each
+ * process only reads its local trees and their face neighbors.
  * \param[in]       conn       The p8est connectivity.
  * \param[in]       comm       mpi communicator to be used with the new cmesh.
  * \param[in]       do_dup     Flag whether the communicator shall be duplicated or not.
@@ -857,6 +1241,59 @@ t8_cmesh_t          t8_cmesh_new_disjoint_bricks (t8_gloidx_t num_x,
                                                   int z_periodic,
                                                   sc_MPI_Comm comm);
 
+/** Create a partitioned brick of num_x by num_y by num_z unit cells,
+ * each subdivided into trees of one class as in \ref t8_cmesh_new_hypercube.
+ * The trees are numbered cell by cell with x running fastest and are
+ * uniformly partitioned.
+ * Each process only computes its local trees, their face connections and
+ * their ghosts from the cell indices, such that the global mesh is never
+ * constructed and meshes of billions of trees can be created in parallel.
+ * \param [in] eclass      The class of the trees. Must not be vertex or pyramid.
+ * \param [in] num_x       The number of cells in x direction. Must be > 0.
+ * \param [in] num_y       The number of cells in y direction. Must be > 0 if
+ *                         \a eclass has dimension 2 or 3, ignored otherwise.
+ * \param [in] num_z       The number of cells in z direction. Must be > 0 if
+ *                         \a eclass has dimension 3, ignored otherwise.
+ * \param [in] comm        The MPI communicator used to commit the cmesh.
+ * \return                 A committed and partitioned cmesh.
+ */
+t8_cmesh_t          t8_cmesh_new_brick_partitioned (t8_eclass_t eclass,
+                                                    t8_gloidx_t num_x,
+                                                    t8_gloidx_t num_y,
+                                                    t8_gloidx_t num_z,
+                                                    sc_MPI_Comm comm);
+
+/** Create a partitioned unit hypercube of num_cells cells per direction,
+ * each subdivided into trees of one class.
+ * This is \ref t8_cmesh_new_brick_partitioned scaled to the unit cube.
+ * \param [in] eclass      The class of the trees. Must not be vertex or pyramid.
+ * \param [in] num_cells   The number of cells in each direction. Must be > 0.
+ * \param [in] comm        The MPI communicator used to commit the cmesh.
+ * \return                 A committed and partitioned cmesh.
+ */
+t8_cmesh_t          t8_cmesh_new_hypercube_partitioned (t8_eclass_t eclass,
+                                                        t8_gloidx_t
+                                                        num_cells,
+                                                        sc_MPI_Comm comm);
+
+/** Create a partitioned hybrid brick of num_x by num_y by num_z unit cells.
+ * The cells with x index smaller than num_x / 2 are hexahedra, the others
+ * are subdivided into two prisms each. Otherwise as
+ * \ref t8_cmesh_new_brick_partitioned.
+ * \param [in] num_x       The number of cells in x direction. Must be > 0.
+ * \param [in] num_y       The number of cells in y direction. Must be > 0.
+ * \param [in] num_z       The number of cells in z direction. Must be > 0.
+ * \param [in] comm        The MPI communicator used to commit the cmesh.
+ * \return                 A committed and partitioned cmesh.
+ */
+t8_cmesh_t          t8_cmesh_new_hybrid_brick_partitioned (t8_gloidx_t
+                                                           num_x,
+                                                           t8_gloidx_t
+                                                           num_y,
+                                                           t8_gloidx_t
+                                                           num_z,
+                                                           sc_MPI_Comm comm);
+
 /** Construct a tetrahedral cmesh that has all possible face to face
  * connections and orientations.
  * This cmesh is used for testing and debugging.
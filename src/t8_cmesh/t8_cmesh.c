@@ -25,6 +25,7 @@
 #include <t8_cmesh_vtk.h>
 #include <t8_refcount.h>
 #include <t8_data/t8_shmem.h>
+#include <t8_data/t8_hash.h>
 #include <t8_vec.h>
 #ifdef T8_WITH_METIS
 #include <metis.h>
@@ -517,10 +518,135 @@ t8_cmesh_get_tree_vertices (t8_cmesh_t cmesh, t8_locidx_t ltreeid)
                                             ltreeid);
 }
 
+/* The header of the attribute file index of a tree. It is followed by
+ * num_attributes entries of type t8_cmesh_attribute_location_t and the
+ * name of the file. */
+typedef struct t8_cmesh_attribute_file_index
+{
+  size_t              num_attributes;
+  size_t              filename_length;  /* including the terminating zero */
+} t8_cmesh_attribute_file_index_t;
+
+/* An attribute that was read from an attribute file */
+typedef struct t8_cmesh_file_attribute
+{
+  t8_locidx_t         ltree_id;
+  int                 package_id;
+  int                 key;
+  void               *data;
+} t8_cmesh_file_attribute_t;
+
+static unsigned
+t8_cmesh_file_attribute_hash (const void *v, const void *u)
+{
+  const t8_cmesh_file_attribute_t *entry =
+    (const t8_cmesh_file_attribute_t *) v;
+
+  return (unsigned) entry->ltree_id * 31u + (unsigned) entry->key * 7u
+    + (unsigned) entry->package_id;
+}
+
+static int
+t8_cmesh_file_attribute_equal (const void *v1, const void *v2, const void *u)
+{
+  const t8_cmesh_file_attribute_t *entry1 =
+    (const t8_cmesh_file_attribute_t *) v1;
+  const t8_cmesh_file_attribute_t *entry2 =
+    (const t8_cmesh_file_attribute_t *) v2;
+
+  return entry1->ltree_id == entry2->ltree_id
+    && entry1->package_id == entry2->package_id && entry1->key == entry2->key;
+}
+
+static int
+t8_cmesh_file_attribute_free (void **v, const void *u)
+{
+  T8_FREE (((t8_cmesh_file_attribute_t *) * v)->data);
+  return 1;
+}
+
+/* Return an attribute of a local tree or ghost that is stored in an
+ * attribute file. The attribute is read on the first call.
+ * Returns NULL if the tree has no such attribute in its file index. */
+static void        *
+t8_cmesh_get_file_attribute (t8_cmesh_t cmesh, int package_id, int key,
+                             t8_locidx_t ltree_id)
+{
+  t8_cmesh_attribute_file_index_t index;
+  t8_cmesh_attribute_location_t location;
+  t8_cmesh_file_attribute_t lookup, *entry;
+  const char         *index_data, *filename;
+  void              **pentry;
+  size_t              iattr;
+  FILE               *fp;
+  int                 is_ghost, success;
+
+  lookup.ltree_id = ltree_id;
+  lookup.package_id = package_id;
+  lookup.key = key;
+  lookup.data = NULL;
+  if (cmesh->file_attributes != NULL
+      && sc_hash_lookup (cmesh->file_attributes, &lookup, &pentry)) {
+    /* The attribute was read before */
+    return ((t8_cmesh_file_attribute_t *) * pentry)->data;
+  }
+
+  is_ghost = t8_cmesh_treeid_is_ghost (cmesh, ltree_id);
+  index_data = (const char *)
+    t8_cmesh_trees_get_attribute (cmesh->trees, is_ghost ?
+                                  t8_cmesh_ltreeid_to_ghostid (cmesh,
+                                                               ltree_id) :
+                                  ltree_id, t8_get_package_id (),
+                                  T8_CMESH_ATTRIBUTE_FILE_KEY, NULL,
+                                  is_ghost);
+  if (index_data == NULL) {
+    return NULL;
+  }
+  /* The attribute data is not necessarily aligned, so we copy the entries
+   * of the index before we use them. */
+  memcpy (&index, index_data, sizeof (index));
+  for (iattr = 0; iattr < index.num_attributes; iattr++) {
+    memcpy (&location, index_data + sizeof (index)
+            + iattr * sizeof (location), sizeof (location));
+    if (location.package_id == package_id && location.key == key) {
+      break;
+    }
+  }
+  if (iattr == index.num_attributes) {
+    return NULL;
+  }
+  filename = index_data + sizeof (index)
+    + index.num_attributes * sizeof (location);
+
+  /* Read the attribute and store it */
+  if (cmesh->file_attributes == NULL) {
+    cmesh->file_attributes_mempool =
+      sc_mempool_new (sizeof (t8_cmesh_file_attribute_t));
+    cmesh->file_attributes =
+      sc_hash_new (t8_cmesh_file_attribute_hash,
+                   t8_cmesh_file_attribute_equal, NULL, NULL);
+  }
+  entry = (t8_cmesh_file_attribute_t *)
+    sc_mempool_alloc (cmesh->file_attributes_mempool);
+  *entry = lookup;
+  entry->data = T8_ALLOC (char, SC_MAX (location.size, 1));
+  fp = fopen (filename, "rb");
+  success = fp != NULL && fseek (fp, (long) location.offset, SEEK_SET) == 0
+    && (location.size == 0 || fread (entry->data, location.size, 1, fp) == 1);
+  SC_CHECK_ABORTF (success, "Could not read attribute %i of package %i of "
+                   "tree %li from file %s.\n", key, package_id,
+                   (long) ltree_id, filename);
+  fclose (fp);
+  sc_hash_insert_unique (cmesh->file_attributes, entry, NULL);
+  return entry->data;
+}
+
 void               *
 t8_cmesh_get_attribute (t8_cmesh_t cmesh, int package_id, int key,
                         t8_locidx_t ltree_id)
 {
+  void               *attribute;
+  t8_locidx_t         id;
   int                 is_ghost;
 
   T8_ASSERT (cmesh->committed);
@@ -528,11 +654,16 @@ t8_cmesh_get_attribute (t8_cmesh_t cmesh, int package_id, int key,
              || t8_cmesh_treeid_is_ghost (cmesh, ltree_id));
   is_ghost = t8_cmesh_treeid_is_ghost (cmesh, ltree_id);
 
-  if (is_ghost) {
-    ltree_id = t8_cmesh_ltreeid_to_ghostid (cmesh, ltree_id);
+  id = is_ghost ? t8_cmesh_ltreeid_to_ghostid (cmesh, ltree_id) : ltree_id;
+  attribute = t8_cmesh_trees_get_attribute (cmesh->trees, id, package_id,
+                                            key, NULL, is_ghost);
+  if (attribute == NULL && !(package_id == t8_get_package_id ()
+                             && key == T8_CMESH_ATTRIBUTE_FILE_KEY)) {
+    /* The attribute may be stored in an attribute file */
+    attribute = t8_cmesh_get_file_attribute (cmesh, package_id, key,
+                                             ltree_id);
   }
-  return t8_cmesh_trees_get_attribute (cmesh->trees, ltree_id, package_id,
-                                       key, NULL, is_ghost);
+  return attribute;
 }
 
 t8_shmem_array_t
@@ -748,7 +879,7 @@ t8_cmesh_no_negative_volume (t8_cmesh_t cmesh)
 #endif
 
 void
-t8_cmesh_set_tree_vertices (t8_cmesh_t cmesh, t8_locidx_t ltree_id,
+t8_cmesh_set_tree_vertices (t8_cmesh_t cmesh, t8_gloidx_t tree_id,
                             int package_id, int key,
                             double *vertices, int num_vertices)
 {
@@ -756,7 +887,7 @@ t8_cmesh_set_tree_vertices (t8_cmesh_t cmesh, t8_locidx_t ltree_id,
   T8_ASSERT (vertices != NULL);
   T8_ASSERT (!cmesh->committed);
 
-  t8_stash_add_attribute (cmesh->stash, ltree_id, package_id, key,
+  t8_stash_add_attribute (cmesh->stash, tree_id, package_id, key,
                           3 * num_vertices * sizeof (double),
                           (void *) vertices, 1);
 }
@@ -771,6 +902,160 @@ t8_cmesh_set_join (t8_cmesh_t cmesh, t8_gloidx_t gtree1, t8_gloidx_t gtree2,
                          orientation);
 }
 
+void
+t8_cmesh_set_tree_arrays (t8_cmesh_t cmesh, t8_locidx_t num_trees,
+                          const t8_eclass_t * tree_classes,
+                          const t8_locidx_t * face_neighbors,
+                          const int8_t * tree_to_face, const double *vertices)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (cmesh->set_from == NULL);
+  T8_ASSERT (cmesh->stash->classes.elem_count == 0);
+  T8_ASSERT (num_trees >= 0);
+  T8_ASSERT (num_trees == 0 || tree_classes != NULL);
+  T8_ASSERT ((face_neighbors == NULL) == (tree_to_face == NULL));
+
+  if (num_trees > 0) {
+    /* Set the dimension as in t8_cmesh_set_tree_class */
+    if (cmesh->dimension == -1) {
+      cmesh->dimension = t8_eclass_to_dimension[tree_classes[0]];
+    }
+    T8_ASSERT (t8_eclass_to_dimension[tree_classes[0]] == cmesh->dimension);
+  }
+  if (cmesh->set_tree_arrays == NULL) {
+    cmesh->set_tree_arrays = T8_ALLOC (t8_cmesh_tree_arrays_t, 1);
+  }
+  cmesh->set_tree_arrays->num_trees = num_trees;
+  cmesh->set_tree_arrays->tree_classes = tree_classes;
+  cmesh->set_tree_arrays->face_neighbors = face_neighbors;
+  cmesh->set_tree_arrays->tree_to_face = tree_to_face;
+  cmesh->set_tree_arrays->vertices = vertices;
+#ifdef T8_ENABLE_DEBUG
+  cmesh->inserted_trees = num_trees;
+#endif
+}
+
+void
+t8_cmesh_set_connectivity_arrays (t8_cmesh_t cmesh, t8_eclass_t eclass,
+                                  t8_gloidx_t num_trees,
+                                  const t8_locidx_t * tree_to_tree,
+                                  const int8_t * tree_to_face,
+                                  const t8_locidx_t * tree_to_vertex,
+                                  const double *vertices)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (cmesh->set_from == NULL);
+  T8_ASSERT (cmesh->set_tree_arrays == NULL);
+  T8_ASSERT (cmesh->stash->classes.elem_count == 0);
+  T8_ASSERT (0 <= eclass && eclass < T8_ECLASS_COUNT);
+  T8_ASSERT (num_trees >= 0);
+  T8_ASSERT (num_trees == 0 || (tree_to_tree != NULL
+                                && tree_to_face != NULL));
+  T8_ASSERT ((tree_to_vertex == NULL) == (vertices == NULL));
+
+  /* Set the dimension as in t8_cmesh_set_tree_class */
+  if (cmesh->dimension == -1) {
+    cmesh->dimension = t8_eclass_to_dimension[eclass];
+  }
+  T8_ASSERT (t8_eclass_to_dimension[eclass] == cmesh->dimension);
+  if (cmesh->set_connectivity_arrays == NULL) {
+    cmesh->set_connectivity_arrays =
+      T8_ALLOC (t8_cmesh_connectivity_arrays_t, 1);
+  }
+  cmesh->set_connectivity_arrays->eclass = eclass;
+  cmesh->set_connectivity_arrays->num_trees = num_trees;
+  cmesh->set_connectivity_arrays->tree_to_tree = tree_to_tree;
+  cmesh->set_connectivity_arrays->tree_to_face = tree_to_face;
+  cmesh->set_connectivity_arrays->tree_to_vertex = tree_to_vertex;
+  cmesh->set_connectivity_arrays->vertices = vertices;
+#ifdef T8_ENABLE_DEBUG
+  cmesh->inserted_trees = num_trees;
+#endif
+}
+
+void
+t8_cmesh_set_vertex_table (t8_cmesh_t cmesh, t8_gloidx_t num_vertices,
+                           const double *vertices, int single_precision)
+{
+  t8_cmesh_vertex_table_t *table;
+  t8_gloidx_t         icoord;
+
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (cmesh->set_from == NULL);
+  T8_ASSERT (num_vertices >= 0);
+  T8_ASSERT (num_vertices == 0 || vertices != NULL);
+
+  if (cmesh->set_vertex_table == NULL) {
+    cmesh->set_vertex_table = T8_ALLOC (t8_cmesh_vertex_table_t, 1);
+  }
+  else {
+    /* Replace a previously set table */
+    T8_FREE (cmesh->set_vertex_table->coordinates);
+  }
+  table = cmesh->set_vertex_table;
+  table->num_vertices = num_vertices;
+  table->single_precision = single_precision != 0;
+  if (table->single_precision) {
+    float              *coordinates = T8_ALLOC (float, 3 * num_vertices);
+
+    for (icoord = 0; icoord < 3 * num_vertices; icoord++) {
+      coordinates[icoord] = (float) vertices[icoord];
+    }
+    table->coordinates = coordinates;
+  }
+  else {
+    table->coordinates = T8_ALLOC (double, 3 * num_vertices);
+    memcpy (table->coordinates, vertices, 3 * num_vertices * sizeof (double));
+  }
+}
+
+void
+t8_cmesh_set_tree_vertex_indices (t8_cmesh_t cmesh, t8_gloidx_t gtree_id,
+                                  const t8_gloidx_t * indices,
+                                  int num_vertices)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (indices != NULL);
+  T8_ASSERT (num_vertices > 0);
+
+  t8_stash_add_attribute (cmesh->stash, gtree_id, t8_get_package_id (),
+                          T8_CMESH_VERTEX_INDICES_ATTRIBUTE_KEY,
+                          num_vertices * sizeof (t8_gloidx_t),
+                          (void *) indices, 1);
+}
+
+void
+t8_cmesh_set_tree_attribute_file (t8_cmesh_t cmesh, t8_gloidx_t gtree_id,
+                                  const char *filename, int num_attributes,
+                                  const t8_cmesh_attribute_location_t *
+                                  locations)
+{
+  t8_cmesh_attribute_file_index_t index;
+  size_t              locations_size, data_size;
+  char               *data;
+
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (num_attributes >= 0);
+  T8_ASSERT (num_attributes == 0 || locations != NULL);
+
+  /* Pack the index of the tree into one attribute */
+  index.num_attributes = num_attributes;
+  index.filename_length = strlen (filename) + 1;
+  locations_size = num_attributes * sizeof (t8_cmesh_attribute_location_t);
+  data_size = sizeof (index) + locations_size + index.filename_length;
+  data = T8_ALLOC (char, data_size);
+  memcpy (data, &index, sizeof (index));
+  if (num_attributes > 0) {
+    memcpy (data + sizeof (index), locations, locations_size);
+  }
+  memcpy (data + sizeof (index) + locations_size, filename,
+          index.filename_length);
+  t8_stash_add_attribute (cmesh->stash, gtree_id, t8_get_package_id (),
+                          T8_CMESH_ATTRIBUTE_FILE_KEY, data_size, data, 1);
+  T8_FREE (data);
+}
+
 void
 t8_cmesh_set_profiling (t8_cmesh_t cmesh, int set_profiling)
 {
@@ -790,6 +1075,30 @@ t8_cmesh_set_profiling (t8_cmesh_t cmesh, int set_profiling)
   }
 }
 
+void
+t8_cmesh_set_reorder (t8_cmesh_t cmesh, int set_reorder)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+
+  cmesh->set_reorder = set_reorder;
+}
+
+void
+t8_cmesh_set_shared_memory (t8_cmesh_t cmesh, int set_shared_memory)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+
+  cmesh->set_shared_memory = set_shared_memory;
+}
+
+void
+t8_cmesh_set_face_table (t8_cmesh_t cmesh, int set_face_table)
+{
+  T8_ASSERT (t8_cmesh_is_initialized (cmesh));
+
+  cmesh->set_face_table = set_face_table;
+}
+
 /* returns true if cmesh_a equals cmesh_b */
 int
 t8_cmesh_is_equal (t8_cmesh_t cmesh_a, t8_cmesh_t cmesh_b)
@@ -846,6 +1155,11 @@ t8_cmesh_is_equal (t8_cmesh_t cmesh_a, t8_cmesh_t cmesh_b)
     return 0;
   }
   /* check trees */
+  if (cmesh_a->committed && cmesh_a->hash_valid && cmesh_b->hash_valid
+      && cmesh_a->hash != cmesh_b->hash) {
+    /* Different hashes imply different trees */
+    return 0;
+  }
   if (cmesh_a->committed &&
       !t8_cmesh_trees_is_equal (cmesh_a, cmesh_a->trees, cmesh_b->trees)) {
     /* if we have committed check tree arrays */
@@ -861,6 +1175,26 @@ t8_cmesh_is_equal (t8_cmesh_t cmesh_a, t8_cmesh_t cmesh_b)
   return 1;
 }
 
+uint64_t
+t8_cmesh_get_hash (t8_cmesh_t cmesh)
+{
+  uint64_t            hash;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+
+  if (!cmesh->hash_valid) {
+    hash = t8_hash_combine (0, cmesh->dimension);
+    hash = t8_hash_combine (hash, cmesh->num_trees);
+    hash = t8_hash_combine (hash, cmesh->num_local_trees);
+    hash = t8_hash_combine (hash, cmesh->num_ghosts);
+    hash = t8_hash_combine (hash, cmesh->first_tree);
+    cmesh->hash = t8_hash_combine (hash,
+                                   t8_cmesh_trees_hash (cmesh, cmesh->trees));
+    cmesh->hash_valid = 1;
+  }
+  return cmesh->hash;
+}
+
 #if 0
 /* broadcast the tree attributes of a cmesh on root to all processors */
 /* TODO: can we optimize it by just sending the memory of the mempools? */
@@ -918,7 +1252,8 @@ t8_cmesh_bcast (t8_cmesh_t cmesh_in, int root, sc_MPI_Comm comm)
   {
     t8_cmesh_struct_t   cmesh;
     t8_gloidx_t         num_trees_per_eclass[T8_ECLASS_COUNT];
-    size_t              stash_elem_counts[3];
+    size_t              stash_elem_counts[4];
+    t8_cmesh_vertex_table_t vertex_table;
     int                 pre_commit;     /* True, if cmesh on root is not committed yet. */
 #ifdef T8_ENABLE_DEBUG
     sc_MPI_Comm         comm;
@@ -968,6 +1303,11 @@ t8_cmesh_bcast (t8_cmesh_t cmesh_in, int root, sc_MPI_Comm comm)
       meta_info.stash_elem_counts[0] = cmesh_in->stash->attributes.elem_count;
       meta_info.stash_elem_counts[1] = cmesh_in->stash->classes.elem_count;
       meta_info.stash_elem_counts[2] = cmesh_in->stash->joinfaces.elem_count;
+      meta_info.stash_elem_counts[3] =
+        t8_stash_get_attribute_bytes (cmesh_in->stash);
+      if (cmesh_in->set_vertex_table != NULL) {
+        meta_info.vertex_table = *cmesh_in->set_vertex_table;
+      }
     }
 
     /* Root returns the input cmesh */
@@ -1019,6 +1359,22 @@ t8_cmesh_bcast (t8_cmesh_t cmesh_in, int root, sc_MPI_Comm comm)
     /* broadcast all the stashed information about trees/neighbors/attributes */
     t8_stash_bcast (cmesh_out->stash, root, comm,
                     meta_info.stash_elem_counts);
+    if (meta_info.cmesh.set_vertex_table != NULL) {
+      /* broadcast the coordinates of the vertex table */
+      t8_cmesh_vertex_table_t *table = &meta_info.vertex_table;
+      size_t              coordinate_size;
+
+      coordinate_size = table->single_precision ? sizeof (float)
+        : sizeof (double);
+      if (mpirank != root) {
+        cmesh_out->set_vertex_table = T8_ALLOC (t8_cmesh_vertex_table_t, 1);
+        *cmesh_out->set_vertex_table = *table;
+        cmesh_out->set_vertex_table->coordinates =
+          T8_ALLOC (char, 3 * table->num_vertices * coordinate_size);
+      }
+      t8_bcast_bytes (cmesh_out->set_vertex_table->coordinates,
+                      3 * table->num_vertices * coordinate_size, root, comm);
+    }
   }
   else {
     /* broadcast the stored information about the trees */
@@ -1197,6 +1553,13 @@ t8_cmesh_tree_face_is_boundary (const t8_cmesh_t cmesh,
 
   T8_ASSERT (t8_cmesh_is_committed (cmesh));
 
+  if (cmesh->face_table != NULL) {
+    /* Only domain boundaries are marked with -1 in the table */
+    return cmesh->face_table[ltreeid *
+                             t8_eclass_max_num_faces[cmesh->dimension] +
+                             face].neighbor == -1;
+  }
+
   if (t8_cmesh_treeid_is_local_tree (cmesh, ltreeid)) {
     /* The local tree id belongs to a tree */
     t8_locidx_t        *face_neighbor;
@@ -1320,12 +1683,23 @@ t8_cmesh_get_face_neighbor (const t8_cmesh_t cmesh, const t8_locidx_t ltreeid,
   t8_locidx_t         face_neigh;
   int                 dual_face_temp, orientation_temp;
 
+  if (cmesh->face_table != NULL) {
+    const t8_cmesh_face_entry_t *entry =
+      cmesh->face_table + ltreeid * t8_eclass_max_num_faces[cmesh->dimension]
+      + face;
+
+    if (entry->neighbor < 0) {
+      /* This is a domain boundary or the neighbor is not local */
+      return -1;
+    }
+    face_neigh = entry->neighbor;
+    ttf = entry->ttf;
+  }
   /* If this is a domain boundary, return -1 */
-  if (t8_cmesh_tree_face_is_boundary (cmesh, ltreeid, face)) {
+  else if (t8_cmesh_tree_face_is_boundary (cmesh, ltreeid, face)) {
     return -1;
   }
-
-  if (!is_ghost) {
+  else if (!is_ghost) {
     /* The local tree id belongs to a local tree (not a ghost) */
     /* Get the tree */
     const t8_ctree_t    tree = t8_cmesh_get_tree (cmesh, ltreeid);
@@ -1421,6 +1795,52 @@ t8_cmesh_print_profile (t8_cmesh_t cmesh)
   }
 }
 
+void
+t8_cmesh_memory_usage (t8_cmesh_t cmesh, t8_cmesh_memory_usage_t * usage)
+{
+  t8_cmesh_trees_t    trees;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (usage != NULL);
+
+  memset (usage, 0, sizeof (t8_cmesh_memory_usage_t));
+  usage->cmesh = sizeof (t8_cmesh_struct_t);
+  trees = cmesh->trees;
+  if (trees != NULL) {
+    usage->trees = sizeof (t8_cmesh_trees_struct_t)
+      + t8_cmesh_trees_size (trees)
+      + cmesh->num_local_trees * sizeof (int)
+      + cmesh->num_ghosts * sizeof (int);
+    if (trees->from_proc != NULL) {
+      usage->trees += sc_array_memory_used (trees->from_proc, 1);
+    }
+    if (trees->ghost_globalid_to_local_id != NULL) {
+      usage->hash_tables +=
+        sc_hash_memory_used (trees->ghost_globalid_to_local_id)
+        + sc_mempool_memory_used (trees->global_local_mempool);
+    }
+  }
+  if (cmesh->file_attributes != NULL) {
+    usage->hash_tables += sc_hash_memory_used (cmesh->file_attributes)
+      + sc_mempool_memory_used (cmesh->file_attributes_mempool);
+  }
+  if (cmesh->tree_offsets != NULL) {
+    usage->offsets =
+      t8_shmem_array_get_elem_count (cmesh->tree_offsets)
+      * t8_shmem_array_get_elem_size (cmesh->tree_offsets);
+  }
+  if (cmesh->face_table != NULL) {
+    usage->face_table = (cmesh->num_local_trees + cmesh->num_ghosts)
+      * t8_eclass_max_num_faces[cmesh->dimension]
+      * sizeof (t8_cmesh_face_entry_t);
+  }
+  if (cmesh->profile != NULL) {
+    usage->profile = sizeof (t8_cprofile_struct_t);
+  }
+  usage->total = usage->cmesh + usage->trees + usage->hash_tables
+    + usage->offsets + usage->face_table + usage->profile;
+}
+
 static void
 t8_cmesh_reset (t8_cmesh_t * pcmesh)
 {
@@ -1446,6 +1866,8 @@ t8_cmesh_reset (t8_cmesh_t * pcmesh)
   /*TODO: write this */
   if (!cmesh->committed) {
     t8_stash_destroy (&cmesh->stash);
+    T8_FREE (cmesh->set_tree_arrays);
+    T8_FREE (cmesh->set_connectivity_arrays);
     if (cmesh->set_from != NULL) {
       /* We unref our reference of set_from */
       t8_cmesh_unref (&cmesh->set_from);
@@ -1460,6 +1882,18 @@ t8_cmesh_reset (t8_cmesh_t * pcmesh)
   if (cmesh->profile != NULL) {
     T8_FREE (cmesh->profile);
   }
+  if (cmesh->file_attributes != NULL) {
+    /* Free the attributes that were read from attribute files */
+    sc_hash_foreach (cmesh->file_attributes, t8_cmesh_file_attribute_free);
+    sc_hash_destroy (cmesh->file_attributes);
+    sc_mempool_destroy (cmesh->file_attributes_mempool);
+  }
+  if (cmesh->set_vertex_table != NULL) {
+    /* The table is usually freed at commit */
+    T8_FREE (cmesh->set_vertex_table->coordinates);
+    T8_FREE (cmesh->set_vertex_table);
+  }
+  T8_FREE (cmesh->face_table);
 
   /* unref the refine scheme (if set) */
   if (cmesh->set_refine_scheme != NULL) {
@@ -1615,18 +2049,69 @@ t8_cmesh_new_from_p4est_ext (void *conn, int dim,
 #undef _T8_CMESH_P48_CONN
 }
 
+/* Construct a cmesh from the arrays of a p4est or p8est connectivity
+ * without going through the stash. If the cmesh is partitioned, each process
+ * only reads its range of trees from conn at commit. */
+static              t8_cmesh_t
+t8_cmesh_new_from_p4est_arrays (void *conn, int dim, sc_MPI_Comm comm,
+                                int do_partition)
+{
+#define _T8_CMESH_P48_CONN(_ENTRY) \
+  (dim == 2 ? ((p4est_connectivity_t *) conn)->_ENTRY \
+            : ((p8est_connectivity_t *) conn)->_ENTRY)
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t         num_trees;
+  int                 mpirank, mpisize, mpiret;
+
+  T8_ASSERT (dim == 2 || dim == 3);
+  T8_ASSERT (dim == 3
+             ||
+             p4est_connectivity_is_valid ((p4est_connectivity_t *) (conn)));
+  T8_ASSERT (dim == 2
+             ||
+             p8est_connectivity_is_valid ((p8est_connectivity_t *) (conn)));
+  /* We pass the index arrays of conn as they are */
+  T8_ASSERT (sizeof (p4est_topidx_t) == sizeof (t8_locidx_t));
+
+  num_trees = _T8_CMESH_P48_CONN (num_trees);
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_connectivity_arrays (cmesh,
+                                    dim == 2 ? T8_ECLASS_QUAD :
+                                    T8_ECLASS_HEX, num_trees,
+                                    (const t8_locidx_t *)
+                                    _T8_CMESH_P48_CONN (tree_to_tree),
+                                    _T8_CMESH_P48_CONN (tree_to_face),
+                                    (const t8_locidx_t *)
+                                    _T8_CMESH_P48_CONN (tree_to_vertex),
+                                    _T8_CMESH_P48_CONN (tree_to_vertex) ==
+                                    NULL ? NULL :
+                                    _T8_CMESH_P48_CONN (vertices));
+  if (do_partition) {
+    mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (comm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    /* First tree and last tree according to uniform level 0 partitioning */
+    t8_cmesh_set_partition_range (cmesh, 3, (mpirank * num_trees) / mpisize,
+                                  ((mpirank + 1) * num_trees) / mpisize - 1);
+  }
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+#undef _T8_CMESH_P48_CONN
+}
+
 t8_cmesh_t
 t8_cmesh_new_from_p4est (p4est_connectivity_t * conn,
                          sc_MPI_Comm comm, int do_partition)
 {
-  return t8_cmesh_new_from_p4est_ext (conn, 2, comm, do_partition, 0);
+  return t8_cmesh_new_from_p4est_arrays (conn, 2, comm, do_partition);
 }
 
 t8_cmesh_t
 t8_cmesh_new_from_p8est (p8est_connectivity_t * conn,
                          sc_MPI_Comm comm, int do_partition)
 {
-  return t8_cmesh_new_from_p4est_ext (conn, 3, comm, do_partition, 0);
+  return t8_cmesh_new_from_p4est_arrays (conn, 3, comm, do_partition);
 }
 
 static              t8_cmesh_t
@@ -2902,6 +3387,374 @@ t8_cmesh_new_disjoint_bricks (t8_gloidx_t num_x, t8_gloidx_t num_y,
   return cmesh;
 }
 
+/* The subdivision of a unit cell of a brick into trees.
+ * The cube vertices are numbered with bit 0 for x, bit 1 for y and
+ * bit 2 for z, the patterns are those of t8_cmesh_new_hypercube.
+ * They are invariant under translation, thus the trees of neighboring
+ * cells are conforming. */
+static const int    t8_cmesh_brick_num_trees[T8_ECLASS_COUNT] = {
+  0, 1, 1, 2, 1, 6, 2, 0
+};
+
+static const int    t8_cmesh_brick_pattern[T8_ECLASS_COUNT][6][8] = {
+  {{0}},                        /* vertex */
+  {{0, 1}},                     /* line */
+  {{0, 1, 2, 3}},               /* quad */
+  {{0, 1, 3}, {0, 3, 2}},       /* triangle */
+  {{0, 1, 2, 3, 4, 5, 6, 7}},   /* hex */
+  {{0, 1, 5, 7}, {0, 3, 1, 7}, {0, 2, 3, 7},
+   {0, 6, 2, 7}, {0, 4, 6, 7}, {0, 5, 4, 7}},   /* tet */
+  {{0, 1, 3, 4, 5, 7}, {0, 3, 2, 4, 7, 6}},     /* prism */
+  {{0}}                         /* pyramid */
+};
+
+/* A brick of num_cells[0] x num_cells[1] x num_cells[2] unit cells.
+ * The cells with x index smaller than split_x are subdivided into trees of
+ * eclass[0], the others into trees of eclass[1]. The trees are numbered
+ * cell by cell with x running fastest. */
+typedef struct
+{
+  t8_gloidx_t         num_cells[3];
+  t8_gloidx_t         split_x;
+  t8_eclass_t         eclass[2];
+  double              scale[3];
+} t8_cmesh_brick_t;
+
+/* The number of trees in front of cell x in its row of cells. */
+static              t8_gloidx_t
+t8_cmesh_brick_row_prefix (const t8_cmesh_brick_t * brick, t8_gloidx_t x)
+{
+  if (x <= brick->split_x) {
+    return x * t8_cmesh_brick_num_trees[brick->eclass[0]];
+  }
+  return brick->split_x * t8_cmesh_brick_num_trees[brick->eclass[0]]
+    + (x - brick->split_x) * t8_cmesh_brick_num_trees[brick->eclass[1]];
+}
+
+/* The global number of trees of a brick. */
+static              t8_gloidx_t
+t8_cmesh_brick_num_trees_global (const t8_cmesh_brick_t * brick)
+{
+  return t8_cmesh_brick_row_prefix (brick, brick->num_cells[0])
+    * brick->num_cells[1] * brick->num_cells[2];
+}
+
+/* The global id of the tree itree of a cell. */
+static              t8_gloidx_t
+t8_cmesh_brick_tree_id (const t8_cmesh_brick_t * brick,
+                        const t8_gloidx_t cell[3], int itree)
+{
+  return (cell[1] + brick->num_cells[1] * cell[2])
+    * t8_cmesh_brick_row_prefix (brick, brick->num_cells[0])
+    + t8_cmesh_brick_row_prefix (brick, cell[0]) + itree;
+}
+
+/* Compute the cell of a tree and its index in the cell.
+ * Return the eclass of the tree. */
+static              t8_eclass_t
+t8_cmesh_brick_tree_cell (const t8_cmesh_brick_t * brick, t8_gloidx_t gtree,
+                          t8_gloidx_t cell[3], int *itree)
+{
+  t8_gloidx_t         row_trees, row, in_row, split_trees;
+  int                 part;
+
+  row_trees = t8_cmesh_brick_row_prefix (brick, brick->num_cells[0]);
+  row = gtree / row_trees;
+  in_row = gtree % row_trees;
+  cell[1] = row % brick->num_cells[1];
+  cell[2] = row / brick->num_cells[1];
+  split_trees = t8_cmesh_brick_row_prefix (brick, brick->split_x);
+  part = in_row >= split_trees;
+  if (part) {
+    in_row -= split_trees;
+  }
+  cell[0] = (part ? brick->split_x : 0)
+    + in_row / t8_cmesh_brick_num_trees[brick->eclass[part]];
+  *itree = in_row % t8_cmesh_brick_num_trees[brick->eclass[part]];
+  return brick->eclass[part];
+}
+
+/* The eclass of the trees of a cell. */
+static              t8_eclass_t
+t8_cmesh_brick_cell_class (const t8_cmesh_brick_t * brick,
+                           const t8_gloidx_t cell[3])
+{
+  return brick->eclass[cell[0] >= brick->split_x];
+}
+
+/* The global index of a vertex of the lattice of cell corners. */
+static              t8_gloidx_t
+t8_cmesh_brick_vertex_id (const t8_cmesh_brick_t * brick,
+                          const t8_gloidx_t cell[3], int cube_vertex)
+{
+  return cell[0] + (cube_vertex & 1) + (brick->num_cells[0] + 1)
+    * (cell[1] + ((cube_vertex >> 1) & 1) + (brick->num_cells[1] + 1)
+       * (cell[2] + ((cube_vertex >> 2) & 1)));
+}
+
+/* Store the lattice vertex ids of a face of a tree in face vertex order
+ * and return the number of face vertices. */
+static int
+t8_cmesh_brick_face_vertices (const t8_cmesh_brick_t * brick,
+                              const t8_gloidx_t cell[3], t8_eclass_t eclass,
+                              int itree, int face, t8_gloidx_t * vertices)
+{
+  int                 num_face_vertices, iv, cube_vertex;
+
+  num_face_vertices =
+    t8_eclass_num_vertices[t8_eclass_face_types[eclass][face]];
+  for (iv = 0; iv < num_face_vertices; iv++) {
+    cube_vertex = t8_cmesh_brick_pattern[eclass][itree]
+      [t8_face_vertex_to_tree_vertex[eclass][face][iv]];
+    vertices[iv] = t8_cmesh_brick_vertex_id (brick, cell, cube_vertex);
+  }
+  return num_face_vertices;
+}
+
+/* Return true if two arrays of n vertex ids hold the same set */
+static int
+t8_cmesh_brick_same_vertices (const t8_gloidx_t * vertices_a,
+                              const t8_gloidx_t * vertices_b, int n)
+{
+  int                 ia, ib;
+
+  for (ia = 0; ia < n; ia++) {
+    for (ib = 0; ib < n && vertices_b[ib] != vertices_a[ia]; ib++) {
+    }
+    if (ib == n) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Find the face neighbor of a face of a tree of a brick.
+ * A face on a side of the cell is matched with the trees of the neighboring
+ * cell, any other face with the trees of the same cell.
+ * Return the global id of the neighbor tree and store its face and the
+ * orientation, or return -1 if the face is on the boundary. */
+static              t8_gloidx_t
+t8_cmesh_brick_face_neighbor (const t8_cmesh_brick_t * brick,
+                              t8_gloidx_t gtree, int face, int *neigh_face,
+                              int *orientation)
+{
+  t8_gloidx_t         cell[3], neigh_cell[3], neigh_tree;
+  t8_gloidx_t         vertices[T8_ECLASS_MAX_CORNERS_2D];
+  t8_gloidx_t         neigh_vertices[T8_ECLASS_MAX_CORNERS_2D];
+  const t8_gloidx_t  *smaller;
+  const t8_gloidx_t  *bigger;
+  t8_eclass_t         eclass, neigh_class;
+  int                 itree, ineigh, iface, iv, axis, side, compare;
+  int                 num_face_vertices, cube_vertex;
+
+  eclass = t8_cmesh_brick_tree_cell (brick, gtree, cell, &itree);
+  num_face_vertices = t8_cmesh_brick_face_vertices (brick, cell, eclass,
+                                                    itree, face, vertices);
+  /* Find the side of the cell that contains the face, if any */
+  neigh_cell[0] = cell[0];
+  neigh_cell[1] = cell[1];
+  neigh_cell[2] = cell[2];
+  for (axis = 0; axis < 3; axis++) {
+    cube_vertex = t8_cmesh_brick_pattern[eclass][itree]
+      [t8_face_vertex_to_tree_vertex[eclass][face][0]];
+    side = (cube_vertex >> axis) & 1;
+    for (iv = 1; iv < num_face_vertices; iv++) {
+      cube_vertex = t8_cmesh_brick_pattern[eclass][itree]
+        [t8_face_vertex_to_tree_vertex[eclass][face][iv]];
+      if (((cube_vertex >> axis) & 1) != side) {
+        break;
+      }
+    }
+    if (iv == num_face_vertices
+        && (axis < t8_eclass_to_dimension[eclass] || side == 1)) {
+      /* The face lies on this side of the cell.
+       * In lower dimensions all vertices have z (and y) equal to zero,
+       * this does not count as a side. */
+      neigh_cell[axis] += side ? 1 : -1;
+      if (neigh_cell[axis] < 0 || neigh_cell[axis] >= brick->num_cells[axis]) {
+        return -1;
+      }
+      break;
+    }
+  }
+  /* Match the face with the faces of the trees of the neighbor cell */
+  neigh_class = t8_cmesh_brick_cell_class (brick, neigh_cell);
+  for (ineigh = 0; ineigh < t8_cmesh_brick_num_trees[neigh_class];
+       ineigh++) {
+    neigh_tree = t8_cmesh_brick_tree_id (brick, neigh_cell, ineigh);
+    for (iface = 0; iface < t8_eclass_num_faces[neigh_class]; iface++) {
+      if ((neigh_tree == gtree && iface == face)
+          || t8_eclass_face_types[neigh_class][iface] !=
+          t8_eclass_face_types[eclass][face]) {
+        continue;
+      }
+      t8_cmesh_brick_face_vertices (brick, neigh_cell, neigh_class, ineigh,
+                                    iface, neigh_vertices);
+      if (t8_cmesh_brick_same_vertices (vertices, neigh_vertices,
+                                        num_face_vertices)) {
+        /* The orientation is the position of the first vertex of the
+         * smaller face in the bigger face, as in the msh file reader. */
+        compare = t8_eclass_compare (eclass, neigh_class);
+        if (compare < 0 || (compare == 0 && gtree < neigh_tree)) {
+          smaller = vertices;
+          bigger = neigh_vertices;
+        }
+        else {
+          smaller = neigh_vertices;
+          bigger = vertices;
+        }
+        for (iv = 0; bigger[iv] != smaller[0]; iv++) {
+        }
+        *neigh_face = iface;
+        *orientation = iv;
+        return neigh_tree;
+      }
+    }
+  }
+  /* A side face always has a neighbor in the neighbor cell */
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
+
+/* Construct the local trees of a partitioned brick and their ghosts. */
+static              t8_cmesh_t
+t8_cmesh_new_brick_partitioned_ext (const t8_cmesh_brick_t * brick,
+                                    sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t         num_trees, first_tree, last_tree, gtree, neigh_tree;
+  t8_gloidx_t         cell[3];
+  t8_gloidx_t        *ghost;
+  sc_array_t          ghosts;
+  double              vertices[3 * T8_ECLASS_MAX_CORNERS];
+  t8_eclass_t         eclass;
+  int                 mpirank, mpisize, mpiret, dim;
+  int                 itree, iface, neigh_face, orientation, iv, cube_vertex;
+  size_t              ighost;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  dim = t8_eclass_to_dimension[brick->eclass[0]];
+  T8_ASSERT (dim == t8_eclass_to_dimension[brick->eclass[1]]);
+  num_trees = t8_cmesh_brick_num_trees_global (brick);
+  /* Uniform partition of the trees */
+  first_tree = (mpirank * num_trees) / mpisize;
+  last_tree = ((mpirank + 1) * num_trees) / mpisize - 1;
+
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, dim);
+  sc_array_init (&ghosts, sizeof (t8_gloidx_t));
+  for (gtree = first_tree; gtree <= last_tree; gtree++) {
+    eclass = t8_cmesh_brick_tree_cell (brick, gtree, cell, &itree);
+    t8_cmesh_set_tree_class (cmesh, gtree, eclass);
+    for (iv = 0; iv < t8_eclass_num_vertices[eclass]; iv++) {
+      cube_vertex = t8_cmesh_brick_pattern[eclass][itree][iv];
+      vertices[3 * iv] = (cell[0] + (cube_vertex & 1)) * brick->scale[0];
+      vertices[3 * iv + 1] =
+        (cell[1] + ((cube_vertex >> 1) & 1)) * brick->scale[1];
+      vertices[3 * iv + 2] =
+        (cell[2] + ((cube_vertex >> 2) & 1)) * brick->scale[2];
+    }
+    t8_cmesh_set_tree_vertices (cmesh, gtree, t8_get_package_id (), 0,
+                                vertices, t8_eclass_num_vertices[eclass]);
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      neigh_tree = t8_cmesh_brick_face_neighbor (brick, gtree, iface,
+                                                 &neigh_face, &orientation);
+      if (neigh_tree < 0) {
+        continue;
+      }
+      if (first_tree <= neigh_tree && neigh_tree <= last_tree) {
+        /* Set each join between two local trees only once */
+        if (neigh_tree < gtree || (neigh_tree == gtree && neigh_face < iface)) {
+          continue;
+        }
+      }
+      else {
+        *(t8_gloidx_t *) sc_array_push (&ghosts) = neigh_tree;
+      }
+      t8_cmesh_set_join (cmesh, gtree, neigh_tree, iface, neigh_face,
+                         orientation);
+    }
+  }
+  /* Each ghost needs its class once */
+  sc_array_sort (&ghosts, p4est_gloidx_compare);
+  for (ighost = 0; ighost < ghosts.elem_count; ighost++) {
+    ghost = (t8_gloidx_t *) sc_array_index (&ghosts, ighost);
+    if (ighost == 0 || *ghost != *(t8_gloidx_t *)
+        sc_array_index (&ghosts, ighost - 1)) {
+      t8_cmesh_set_tree_class (cmesh, *ghost,
+                               t8_cmesh_brick_tree_cell (brick, *ghost, cell,
+                                                         &itree));
+    }
+  }
+  sc_array_reset (&ghosts);
+  t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree);
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
+t8_cmesh_t
+t8_cmesh_new_brick_partitioned (t8_eclass_t eclass, t8_gloidx_t num_x,
+                                t8_gloidx_t num_y, t8_gloidx_t num_z,
+                                sc_MPI_Comm comm)
+{
+  t8_cmesh_brick_t    brick;
+  int                 dim;
+
+  SC_CHECK_ABORT (t8_cmesh_brick_num_trees[eclass] > 0,
+                  "The partitioned brick does not support this eclass.\n");
+  dim = t8_eclass_to_dimension[eclass];
+  brick.num_cells[0] = num_x;
+  brick.num_cells[1] = dim > 1 ? num_y : 1;
+  brick.num_cells[2] = dim > 2 ? num_z : 1;
+  T8_ASSERT (brick.num_cells[0] > 0 && brick.num_cells[1] > 0
+             && brick.num_cells[2] > 0);
+  brick.split_x = num_x;
+  brick.eclass[0] = brick.eclass[1] = eclass;
+  brick.scale[0] = brick.scale[1] = brick.scale[2] = 1;
+  return t8_cmesh_new_brick_partitioned_ext (&brick, comm);
+}
+
+t8_cmesh_t
+t8_cmesh_new_hypercube_partitioned (t8_eclass_t eclass,
+                                    t8_gloidx_t num_cells, sc_MPI_Comm comm)
+{
+  t8_cmesh_brick_t    brick;
+  int                 dim, i;
+
+  SC_CHECK_ABORT (t8_cmesh_brick_num_trees[eclass] > 0,
+                  "The partitioned hypercube does not support this eclass.\n");
+  T8_ASSERT (num_cells > 0);
+  dim = t8_eclass_to_dimension[eclass];
+  for (i = 0; i < 3; i++) {
+    brick.num_cells[i] = i < dim ? num_cells : 1;
+    brick.scale[i] = i < dim ? 1. / num_cells : 0;
+  }
+  brick.split_x = num_cells;
+  brick.eclass[0] = brick.eclass[1] = eclass;
+  return t8_cmesh_new_brick_partitioned_ext (&brick, comm);
+}
+
+t8_cmesh_t
+t8_cmesh_new_hybrid_brick_partitioned (t8_gloidx_t num_x, t8_gloidx_t num_y,
+                                       t8_gloidx_t num_z, sc_MPI_Comm comm)
+{
+  t8_cmesh_brick_t    brick;
+
+  T8_ASSERT (num_x > 0 && num_y > 0 && num_z > 0);
+  brick.num_cells[0] = num_x;
+  brick.num_cells[1] = num_y;
+  brick.num_cells[2] = num_z;
+  brick.split_x = num_x / 2;
+  brick.eclass[0] = T8_ECLASS_HEX;
+  brick.eclass[1] = T8_ECLASS_PRISM;
+  brick.scale[0] = brick.scale[1] = brick.scale[2] = 1;
+  return t8_cmesh_new_brick_partitioned_ext (&brick, comm);
+}
+
 static void
 t8_cmesh_translate_coordinates (const double *coords_in, double *coords_out,
                                 int num_vertices, double translate[3])
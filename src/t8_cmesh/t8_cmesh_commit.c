@@ -35,6 +35,7 @@
 #include <t8_cmesh/t8_cmesh_partition.h>
 #include <t8_cmesh/t8_cmesh_refine.h>
 #include <t8_cmesh/t8_cmesh_copy.h>
+#include <t8_trace.h>
 
 typedef struct ghost_facejoins_struct
 {
@@ -51,26 +52,163 @@ t8_ghost_facejoins_compare (const void *fj1, const void *fj2)
   return FJ1->ghost_id < FJ2->ghost_id ? -1 : FJ1->ghost_id != FJ2->ghost_id;
 }
 
+/* Compare two ghost facejoins by their ghost id and then by their local id */
 static int
-t8_ghost_facejoin_equal (const void *v1, const void *v2, const void *u)
+t8_ghost_facejoins_compare_occurrence (const void *fj1, const void *fj2)
 {
-  return t8_ghost_facejoins_compare (v1, v2) == 0;
+  const t8_ghost_facejoin_t *FJ1 = (const t8_ghost_facejoin_t *) fj1;
+  const t8_ghost_facejoin_t *FJ2 = (const t8_ghost_facejoin_t *) fj2;
+
+  if (FJ1->ghost_id != FJ2->ghost_id) {
+    return FJ1->ghost_id < FJ2->ghost_id ? -1 : 1;
+  }
+  return FJ1->local_id < FJ2->local_id ? -1 : FJ1->local_id != FJ2->local_id;
 }
 
-/* The hash value for a ghost is
- * global_id % num_local_trees
- *
- * This hash function gets as input a facejoins_struct
- * and as user data the number of hashs, which is the number of local trees if
- * nonzero and 10 otherwise.
- */
-static unsigned
-t8_ghost_hash (const void *v, const void *u)
+/* Compare two ghost facejoins by their local id */
+static int
+t8_ghost_facejoins_compare_local (const void *fj1, const void *fj2)
+{
+  const t8_ghost_facejoin_t *FJ1 = (const t8_ghost_facejoin_t *) fj1;
+  const t8_ghost_facejoin_t *FJ2 = (const t8_ghost_facejoin_t *) fj2;
+
+  return FJ1->local_id < FJ2->local_id ? -1 : FJ1->local_id != FJ2->local_id;
+}
+
+/* Given the global ghost ids in the order in which they occur in the
+ * joinfaces, with local_id storing the position of the occurrence,
+ * remove all duplicates and number the ghosts in the order of their
+ * first occurrence.
+ * Afterwards the array is sorted by the ghost ids and can be searched
+ * with \ref t8_cmesh_commit_ghost_lookup.
+ * Returns the number of ghosts. */
+static t8_locidx_t
+t8_cmesh_commit_number_ghosts (sc_array_t * ghost_ids)
 {
-  t8_gloidx_t         ghost_id = ((t8_ghost_facejoin_t *) v)->ghost_id;
-  t8_locidx_t         num_hashs = *((t8_locidx_t *) u);
+  sc_array_t          order;
+  t8_ghost_facejoin_t *ghosts, *order_entries;
+  size_t              ighost, num_ghosts = 0;
 
-  return ghost_id % num_hashs;
+  /* Sort by the ghost ids. For each ghost the first occurrence comes first. */
+  sc_array_sort (ghost_ids, t8_ghost_facejoins_compare_occurrence);
+  ghosts = (t8_ghost_facejoin_t *) ghost_ids->array;
+  for (ighost = 0; ighost < ghost_ids->elem_count; ighost++) {
+    if (num_ghosts == 0
+        || ghosts[ighost].ghost_id != ghosts[num_ghosts - 1].ghost_id) {
+      ghosts[num_ghosts++] = ghosts[ighost];
+    }
+  }
+  sc_array_resize (ghost_ids, num_ghosts);
+  ghosts = (t8_ghost_facejoin_t *) ghost_ids->array;
+
+  /* Sort a copy by the first occurrence. Its ghost_id entries store the
+   * positions in ghost_ids, such that we can set the local ids there. */
+  sc_array_init_size (&order, sizeof (t8_ghost_facejoin_t), num_ghosts);
+  order_entries = (t8_ghost_facejoin_t *) order.array;
+  for (ighost = 0; ighost < num_ghosts; ighost++) {
+    order_entries[ighost].ghost_id = ighost;
+    order_entries[ighost].local_id = ghosts[ighost].local_id;
+  }
+  sc_array_sort (&order, t8_ghost_facejoins_compare_local);
+  for (ighost = 0; ighost < num_ghosts; ighost++) {
+    ghosts[order_entries[ighost].ghost_id].local_id = ighost;
+  }
+  sc_array_reset (&order);
+  return num_ghosts;
+}
+
+/* Return the local ghost id of a global tree id or -1 if the tree is not
+ * a ghost. */
+static t8_locidx_t
+t8_cmesh_commit_ghost_lookup (sc_array_t * ghost_ids, t8_gloidx_t ghost_id)
+{
+  t8_ghost_facejoin_t search;
+  ssize_t             position;
+
+  search.ghost_id = ghost_id;
+  position = sc_array_bsearch (ghost_ids, &search,
+                               t8_ghost_facejoins_compare);
+  if (position < 0) {
+    return -1;
+  }
+  return ((t8_ghost_facejoin_t *) sc_array_index (ghost_ids,
+                                                  position))->local_id;
+}
+
+/* Set the face connection of a joinface at its local trees and ghosts.
+ * Different joinfaces set different faces, thus this function may be
+ * called for several joinfaces at once. */
+static void
+t8_cmesh_commit_partitioned_join (t8_cmesh_t cmesh,
+                                  const t8_stash_joinface_struct_t *
+                                  joinface, sc_array_t * ghost_ids,
+                                  t8_gloidx_t last_tree)
+{
+  const t8_gloidx_t   id1 = joinface->id1, id2 = joinface->id2;
+  const int           F = t8_eclass_max_num_faces[cmesh->dimension];
+  t8_locidx_t        *face_neigh = NULL, *face_neigh2 = NULL;
+  t8_gloidx_t        *face_neigh_g = NULL, *face_neigh_g2 = NULL;
+  int8_t             *ttf = NULL, *ttf2 = NULL;
+  t8_locidx_t         local_id1 = -1, local_id2 = -1, ghost_id;
+
+  /* There are the following cases:
+   * Both trees are local trees.
+   * One is a local tree and one a local ghost.
+   * Both are local ghosts.
+   * One is a local ghost and on neither ghost nor local tree.
+   * For each of these cases we have to set the correct face connection.
+   * The local ids of ghosts are counted after the local trees.
+   */
+  if (cmesh->first_tree <= id1 && id1 <= last_tree) {
+    /* First tree in the connection is a local tree */
+    local_id1 = id1 - cmesh->first_tree;
+    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, local_id1,
+                                        &face_neigh, &ttf);
+  }
+  else if ((ghost_id = t8_cmesh_commit_ghost_lookup (ghost_ids, id1)) >= 0) {
+    /* id1 is a local ghost */
+    local_id1 = ghost_id + cmesh->num_local_trees;
+    (void) t8_cmesh_trees_get_ghost_ext (cmesh->trees, ghost_id,
+                                         &face_neigh_g, &ttf);
+  }
+  if (cmesh->first_tree <= id2 && id2 <= last_tree) {
+    /* Second tree in the connection is a local tree */
+    local_id2 = id2 - cmesh->first_tree;
+    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, local_id2,
+                                        &face_neigh2, &ttf2);
+  }
+  else if ((ghost_id = t8_cmesh_commit_ghost_lookup (ghost_ids, id2)) >= 0) {
+    /* id2 is a local ghost */
+    local_id2 = ghost_id + cmesh->num_local_trees;
+    (void) t8_cmesh_trees_get_ghost_ext (cmesh->trees, ghost_id,
+                                         &face_neigh_g2, &ttf2);
+  }
+  if (ttf != NULL) {
+    /* The first entry is either a tree or ghost */
+    ttf[joinface->face1] = F * joinface->orientation + joinface->face2;
+    if (face_neigh != NULL) {
+      /* First entry is a tree */
+      T8_ASSERT (local_id2 >= 0);
+      face_neigh[joinface->face1] = local_id2;
+    }
+    else {
+      /* First entry is a ghost */
+      face_neigh_g[joinface->face1] = id2;
+    }
+  }
+  if (ttf2 != NULL) {
+    /* The second entry is either a tree or a ghost */
+    ttf2[joinface->face2] = F * joinface->orientation + joinface->face1;
+    if (face_neigh2 != NULL) {
+      /* The second entry is a tree */
+      T8_ASSERT (local_id1 >= 0);
+      face_neigh2[joinface->face2] = local_id1;
+    }
+    else {
+      /* The second entry is a ghost */
+      face_neigh_g2[joinface->face2] = id1;
+    }
+  }
 }
 
 static void
@@ -88,9 +226,15 @@ t8_cmesh_add_attributes (t8_cmesh_t cmesh)
   t8_stash_t          stash = cmesh->stash;
   t8_locidx_t         ltree;
   size_t              si, sj;
+  const size_t        num_attributes = stash->attributes.elem_count;
+  char              **attribute_data;
+  long long           iatt;
 
+  /* First we set the attribute infos. Since the offset of each attribute
+   * depends on the previous ones, we do this in order. */
+  attribute_data = T8_ALLOC_ZERO (char *, SC_MAX (num_attributes, 1));
   ltree = -1;
-  for (si = 0, sj = 0; si < stash->attributes.elem_count; si++, sj++) {
+  for (si = 0, sj = 0; si < num_attributes; si++, sj++) {
     attribute = (t8_stash_attribute_struct_t *)
       sc_array_index (&stash->attributes, si);
     if (cmesh->first_tree <= attribute->id &&
@@ -104,10 +248,27 @@ t8_cmesh_add_attributes (t8_cmesh_t cmesh)
        * Should not cause problems, since mesh is replicated */
       T8_ASSERT (attribute->id - cmesh->first_tree ==
                  (t8_locidx_t) attribute->id - cmesh->first_tree);
-      t8_cmesh_trees_add_attribute (cmesh->trees, 0, attribute,
-                                    attribute->id - cmesh->first_tree, sj);
+      attribute_data[si] =
+        t8_cmesh_trees_add_attribute_info (cmesh->trees, 0, attribute,
+                                           attribute->id - cmesh->first_tree,
+                                           sj);
+    }
+  }
+  /* Now we copy the attribute data. The attributes are stored at disjoint
+   * memory, thus we can copy them in parallel. */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (iatt = 0; iatt < (long long) num_attributes; iatt++) {
+    if (attribute_data[iatt] != NULL) {
+      const t8_stash_attribute_struct_t *copy_attribute =
+        (const t8_stash_attribute_struct_t *)
+        sc_array_index (&stash->attributes, (size_t) iatt);
+      memcpy (attribute_data[iatt], copy_attribute->attr_data,
+              copy_attribute->attr_size);
     }
   }
+  T8_FREE (attribute_data);
 }
 
 static void
@@ -183,16 +344,235 @@ t8_cmesh_commit_replicated_new (t8_cmesh_t cmesh)
   }
 }
 
+/* Construct a replicated cmesh from the arrays set with
+ * t8_cmesh_set_tree_arrays. Other than t8_cmesh_commit_replicated_new
+ * we do not need to sort anything, since all data is given in tree order. */
+static void
+t8_cmesh_commit_from_arrays (t8_cmesh_t cmesh)
+{
+  const t8_cmesh_tree_arrays_t *arrays = cmesh->set_tree_arrays;
+  const t8_locidx_t   num_trees = arrays->num_trees;
+  t8_stash_attribute_struct_t attribute;
+  t8_locidx_t         ltree, *face_neigh;
+  t8_eclass_t         eclass;
+  int8_t             *ttf;
+  size_t              face_offset, vertex_offset;
+  int                 iface;
+
+  T8_ASSERT (!cmesh->set_partition);
+  t8_cmesh_trees_init (&cmesh->trees, 1, num_trees, 0);
+  t8_cmesh_trees_start_part (cmesh->trees, 0, 0, num_trees, 0, 0, 1);
+  /* set tree classes and the size of the vertices */
+  for (ltree = 0; ltree < num_trees; ltree++) {
+    eclass = arrays->tree_classes[ltree];
+    T8_ASSERT (t8_eclass_to_dimension[eclass] == cmesh->dimension);
+    t8_cmesh_trees_add_tree (cmesh->trees, ltree, 0, eclass);
+    cmesh->num_trees_per_eclass[eclass]++;
+    cmesh->num_local_trees_per_eclass[eclass]++;
+    if (arrays->vertices != NULL) {
+      t8_cmesh_trees_init_attributes (cmesh->trees, ltree, 1,
+                                      3 * t8_eclass_num_vertices[eclass]
+                                      * sizeof (double));
+    }
+  }
+  /* Finish memory allocation of tree/face/attribute array */
+  t8_cmesh_trees_finish_part (cmesh->trees, 0);
+  cmesh->num_trees = cmesh->num_local_trees = num_trees;
+  cmesh->first_tree = 0;
+
+  /* Add the vertices as attributes */
+  if (arrays->vertices != NULL) {
+    attribute.package_id = t8_get_package_id ();
+    attribute.key = 0;
+    attribute.is_owned = 0;
+    for (ltree = 0, vertex_offset = 0; ltree < num_trees; ltree++) {
+      eclass = arrays->tree_classes[ltree];
+      attribute.id = ltree;
+      attribute.attr_size =
+        3 * t8_eclass_num_vertices[eclass] * sizeof (double);
+      attribute.attr_data = (void *) (arrays->vertices + vertex_offset);
+      t8_cmesh_trees_add_attribute (cmesh->trees, 0, &attribute, ltree, 0);
+      vertex_offset += 3 * t8_eclass_num_vertices[eclass];
+    }
+  }
+
+  /* Set all face connections */
+  t8_cmesh_trees_set_all_boundary (cmesh, cmesh->trees);
+  if (arrays->face_neighbors != NULL) {
+    for (ltree = 0, face_offset = 0; ltree < num_trees; ltree++) {
+      eclass = t8_cmesh_trees_get_tree_ext (cmesh->trees, ltree,
+                                            &face_neigh, &ttf)->eclass;
+      for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+        if (arrays->face_neighbors[face_offset + iface] >= 0) {
+          T8_ASSERT (arrays->face_neighbors[face_offset + iface]
+                     < num_trees);
+          face_neigh[iface] = arrays->face_neighbors[face_offset + iface];
+          ttf[iface] = arrays->tree_to_face[face_offset + iface];
+        }
+      }
+      face_offset += t8_eclass_num_faces[eclass];
+    }
+    T8_ASSERT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees));
+  }
+  T8_FREE (cmesh->set_tree_arrays);
+  cmesh->set_tree_arrays = NULL;
+}
+
+/* Construct a replicated or partitioned cmesh from the connectivity arrays
+ * set with t8_cmesh_set_connectivity_arrays.
+ * We only read the entries of the local trees and their face neighbors.
+ * The face neighbors that are not local become the ghosts, numbered by
+ * their first occurrence as in t8_cmesh_commit_partitioned_new.
+ * Since a boundary face is connected to itself in the arrays, we can copy
+ * the face connections of all trees and ghosts without checking for
+ * boundaries. */
+static void
+t8_cmesh_commit_from_connectivity (t8_cmesh_t cmesh, sc_MPI_Comm comm)
+{
+  const t8_cmesh_connectivity_arrays_t *conn =
+    cmesh->set_connectivity_arrays;
+  const t8_eclass_t   eclass = conn->eclass;
+  const int           num_faces = t8_eclass_num_faces[eclass];
+  const int           num_vertices = t8_eclass_num_vertices[eclass];
+  t8_stash_attribute_struct_t attribute;
+  double              vertices[3 * T8_ECLASS_MAX_CORNERS];
+  sc_array_t          ghost_ids;
+  t8_ghost_facejoin_t *ghost_facejoin;
+  t8_cghost_t         ghost;
+  t8_gloidx_t         gtree, neighbor, last_tree, *gface_neigh;
+  t8_locidx_t         ltree, lghost, *face_neigh, vertex;
+  int8_t             *ttf;
+  int                 iface, ivertex;
+
+  T8_ASSERT (t8_eclass_to_dimension[eclass] == cmesh->dimension);
+  if (cmesh->set_partition) {
+    SC_CHECK_ABORT (cmesh->set_partition_level <= 0,
+                    "A cmesh set from connectivity arrays needs a partition"
+                    " range or offsets.\n");
+    t8_cmesh_set_shmem_type (comm);
+    if (cmesh->tree_offsets != NULL) {
+      t8_gloidx_t        *tree_offsets = (t8_gloidx_t *)
+        t8_shmem_array_get_gloidx_array (cmesh->tree_offsets);
+      cmesh->first_tree = t8_offset_first (cmesh->mpirank, tree_offsets);
+      cmesh->first_tree_shared =
+        t8_shmem_array_get_gloidx (cmesh->tree_offsets, cmesh->mpirank) < 0;
+      cmesh->num_local_trees =
+        t8_offset_num_trees (cmesh->mpirank, tree_offsets);
+    }
+  }
+  else {
+    cmesh->first_tree = 0;
+    cmesh->first_tree_shared = 0;
+    cmesh->num_local_trees = conn->num_trees;
+  }
+  T8_ASSERT (cmesh->first_tree >= 0 && cmesh->num_local_trees >= 0);
+  last_tree = cmesh->first_tree + cmesh->num_local_trees - 1;
+  SC_CHECK_ABORT (last_tree < conn->num_trees,
+                  "The partition exceeds the connectivity arrays.\n");
+
+  /* Collect the face neighbors of the local trees that are not local */
+  sc_array_init (&ghost_ids, sizeof (t8_ghost_facejoin_t));
+  for (gtree = cmesh->first_tree; gtree <= last_tree; gtree++) {
+    for (iface = 0; iface < num_faces; iface++) {
+      neighbor = conn->tree_to_tree[gtree * num_faces + iface];
+      T8_ASSERT (0 <= neighbor && neighbor < conn->num_trees);
+      if (neighbor < cmesh->first_tree || neighbor > last_tree) {
+        ghost_facejoin = (t8_ghost_facejoin_t *) sc_array_push (&ghost_ids);
+        ghost_facejoin->ghost_id = neighbor;
+        ghost_facejoin->local_id = ghost_ids.elem_count - 1;
+      }
+    }
+  }
+  cmesh->num_ghosts = t8_cmesh_commit_number_ghosts (&ghost_ids);
+
+  /* Now that we know the number of trees and ghosts we can initialize
+   * the trees structure and allocate its memory in one go. */
+  t8_cmesh_trees_init (&cmesh->trees, 1, cmesh->num_local_trees,
+                       cmesh->num_ghosts);
+  t8_cmesh_trees_start_part (cmesh->trees, 0, 0, cmesh->num_local_trees, 0,
+                             cmesh->num_ghosts, 1);
+  for (ltree = 0; ltree < cmesh->num_local_trees; ltree++) {
+    t8_cmesh_trees_add_tree (cmesh->trees, ltree, 0, eclass);
+    if (conn->tree_to_vertex != NULL) {
+      t8_cmesh_trees_init_attributes (cmesh->trees, ltree, 1,
+                                      3 * num_vertices * sizeof (double));
+    }
+  }
+  for (lghost = 0; lghost < cmesh->num_ghosts; lghost++) {
+    ghost_facejoin = (t8_ghost_facejoin_t *)
+      t8_sc_array_index_locidx (&ghost_ids, lghost);
+    t8_cmesh_trees_add_ghost (cmesh->trees, ghost_facejoin->local_id,
+                              ghost_facejoin->ghost_id, 0, eclass,
+                              cmesh->num_local_trees);
+  }
+  t8_cmesh_trees_finish_part (cmesh->trees, 0);
+  cmesh->num_local_trees_per_eclass[eclass] = cmesh->num_local_trees;
+  if (!cmesh->set_partition) {
+    cmesh->num_trees_per_eclass[eclass] = cmesh->num_local_trees;
+  }
+  cmesh->num_trees = conn->num_trees;
+
+  /* Set the face connections of the local trees */
+  for (ltree = 0; ltree < cmesh->num_local_trees; ltree++) {
+    gtree = cmesh->first_tree + ltree;
+    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, ltree, &face_neigh,
+                                        &ttf);
+    for (iface = 0; iface < num_faces; iface++) {
+      neighbor = conn->tree_to_tree[gtree * num_faces + iface];
+      if (cmesh->first_tree <= neighbor && neighbor <= last_tree) {
+        face_neigh[iface] = neighbor - cmesh->first_tree;
+      }
+      else {
+        face_neigh[iface] = cmesh->num_local_trees +
+          t8_cmesh_commit_ghost_lookup (&ghost_ids, neighbor);
+      }
+      ttf[iface] = conn->tree_to_face[gtree * num_faces + iface];
+    }
+  }
+  /* The face neighbors of the ghosts are stored with their global ids */
+  for (lghost = 0; lghost < cmesh->num_ghosts; lghost++) {
+    ghost = t8_cmesh_trees_get_ghost_ext (cmesh->trees, lghost,
+                                          &gface_neigh, &ttf);
+    for (iface = 0; iface < num_faces; iface++) {
+      gface_neigh[iface] =
+        conn->tree_to_tree[ghost->treeid * num_faces + iface];
+      ttf[iface] = conn->tree_to_face[ghost->treeid * num_faces + iface];
+    }
+  }
+  sc_array_reset (&ghost_ids);
+
+  /* Add the vertices of the local trees as attributes. The attributes
+   * have to be added in order, since their offsets build on each other. */
+  if (conn->tree_to_vertex != NULL) {
+    attribute.package_id = t8_get_package_id ();
+    attribute.key = 0;
+    attribute.is_owned = 0;
+    attribute.attr_size = 3 * num_vertices * sizeof (double);
+    attribute.attr_data = vertices;
+    for (ltree = 0; ltree < cmesh->num_local_trees; ltree++) {
+      gtree = cmesh->first_tree + ltree;
+      for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+        vertex = conn->tree_to_vertex[gtree * num_vertices + ivertex];
+        memcpy (vertices + 3 * ivertex, conn->vertices + 3 * vertex,
+                3 * sizeof (double));
+      }
+      attribute.id = gtree;
+      t8_cmesh_trees_add_attribute (cmesh->trees, 0, &attribute, ltree, 0);
+    }
+  }
+  T8_ASSERT (cmesh->set_partition
+             || t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees));
+  T8_FREE (cmesh->set_connectivity_arrays);
+  cmesh->set_connectivity_arrays = NULL;
+}
+
 static void
 t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
 {
   /* Cmesh is partitioned and new */
   t8_stash_attribute_struct_t *attribute;
-  t8_locidx_t        *face_neigh, *face_neigh2;
-  int8_t             *ttf, *ttf2;
   t8_stash_joinface_struct_t *joinface;
-  t8_ctree_t          tree1, tree2;
-  int                 F;
+  t8_ctree_t          tree1;
   size_t              si;
 
 #if T8_ENABLE_DEBUG
@@ -200,21 +580,15 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   sc_statinfo_t       stats[3];
 #endif
 
-  sc_hash_t          *ghost_ids;
-  sc_mempool_t       *ghost_facejoin_mempool;
-  struct ghost_facejoins_struct *ghost_facejoin = NULL, *temp_facejoin,
-    **facejoin_pp;
+  sc_array_t          ghost_ids;
+  t8_ghost_facejoin_t *ghost_facejoin;
   size_t              joinfaces_it, iz;
+  long long           ijoin;
   t8_gloidx_t         last_tree = cmesh->num_local_trees +
     cmesh->first_tree - 1, id1, id2;
-  t8_locidx_t         temp_local_id = 0;
-  t8_locidx_t         num_hashs;
-  t8_gloidx_t        *face_neigh_g, *face_neigh_g2;
+  t8_locidx_t         ghost_id;
   t8_stash_class_struct_t *classentry;
   int                 id1_istree, id2_istree;
-#if T8_ENABLE_DEBUG
-  t8_cghost_t         ghost1, ghost2;
-#endif
 
 #if T8_ENABLE_DEBUG
   sc_flops_start (&fi);
@@ -229,6 +603,7 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     return;
   }
   t8_cmesh_set_shmem_type (comm);       /* TODO: do we actually need the shared array? */
+  /* This does not sort if the attributes are already in order */
   t8_stash_attribute_sort (cmesh->stash);
 
 #if T8_ENABLE_DEBUG
@@ -253,19 +628,10 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   T8_ASSERT (cmesh->first_tree >= 0);
   T8_ASSERT (cmesh->first_tree_shared >= 0);
 
-  num_hashs = cmesh->num_local_trees > 0 ? cmesh->num_local_trees : 10;
-  ghost_facejoin_mempool = sc_mempool_new (sizeof (t8_ghost_facejoin_t));
-  /* TODO: There could be a mayor bug here, since the mempool given to
-   * sc_hash_new should actually allocate sc_link_t objects and not the
-   * data objects. */
-  ghost_ids = sc_hash_new (t8_ghost_hash, t8_ghost_facejoin_equal,
-                           &num_hashs, NULL);
-
-  temp_facejoin =
-    (t8_ghost_facejoin_t *) sc_mempool_alloc (ghost_facejoin_mempool);
-
-  cmesh->num_ghosts = 0;
-  /* Parse joinfaces array and save all global id of local ghosts, and assign them a local id */
+  /* Parse joinfaces array and save all global id of local ghosts.
+   * We store each occurrence together with its position and assign the
+   * local ids afterwards, which is cheaper than a hash for many joins. */
+  sc_array_init (&ghost_ids, sizeof (t8_ghost_facejoin_t));
   for (joinfaces_it = 0; joinfaces_it < cmesh->stash->joinfaces.elem_count;
        joinfaces_it++) {
     joinface =
@@ -280,27 +646,21 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
        * ids of all local ghosts. */
       if (!id2_istree) {
         /* id2 is a ghost */
-        temp_facejoin->ghost_id = id2;
-        if (sc_hash_insert_unique (ghost_ids, temp_facejoin, NULL)) {
-          /* If we did not already stored id2 in the hash we do so and assign the next local ghost id */
-          temp_facejoin->local_id = cmesh->num_ghosts++;
-          temp_facejoin = (t8_ghost_facejoin_t *)
-            sc_mempool_alloc (ghost_facejoin_mempool);
-        }
+        ghost_facejoin = (t8_ghost_facejoin_t *) sc_array_push (&ghost_ids);
+        ghost_facejoin->ghost_id = id2;
+        ghost_facejoin->local_id = ghost_ids.elem_count - 1;
       }
       if (!id1_istree) {
         /* id1 is a ghost */
         T8_ASSERT (id2_istree);
-        temp_facejoin->ghost_id = id1;
-        if (sc_hash_insert_unique (ghost_ids, temp_facejoin, NULL)) {
-          /* If we did not already stored id1 in the hash we do so and assign the next local ghost id */
-          temp_facejoin->local_id = cmesh->num_ghosts++;
-          temp_facejoin = (t8_ghost_facejoin_t *)
-            sc_mempool_alloc (ghost_facejoin_mempool);
-        }
+        ghost_facejoin = (t8_ghost_facejoin_t *) sc_array_push (&ghost_ids);
+        ghost_facejoin->ghost_id = id1;
+        ghost_facejoin->local_id = ghost_ids.elem_count - 1;
       }
     }
   }
+  /* Remove duplicates and assign the local ghost ids */
+  cmesh->num_ghosts = t8_cmesh_commit_number_ghosts (&ghost_ids);
 
 #if T8_ENABLE_DEBUG
   sc_flops_shot (&fi, &snapshot);
@@ -330,13 +690,10 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     /* Only do something if the partition is not empty */
     /* TODO: optimize if non-hybrid mesh */
     /* Iterate through classes and add ghosts and trees */
-    /* We need a temporary ghost_facejoin to check the hash for existing global ids */
-    temp_facejoin->local_id = -10;
     for (iz = 0; iz < cmesh->stash->classes.elem_count; iz++) {
       /* get class and tree id */
       classentry = (t8_stash_class_struct_t *)
         sc_array_index (&cmesh->stash->classes, iz);
-      temp_facejoin->ghost_id = classentry->id;
       if (cmesh->first_tree <= classentry->id && classentry->id <= last_tree) {
         /* initialize tree */
         t8_cmesh_trees_add_tree (cmesh->trees,
@@ -345,13 +702,11 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
         cmesh->num_local_trees_per_eclass[classentry->eclass]++;
       }
       else {
-        if (sc_hash_lookup (ghost_ids, temp_facejoin,
-                            (void ***) &facejoin_pp)) {
+        ghost_id = t8_cmesh_commit_ghost_lookup (&ghost_ids, classentry->id);
+        if (ghost_id >= 0) {
           /* The classentry belongs to a local ghost */
-          ghost_facejoin = *facejoin_pp;
-          t8_cmesh_trees_add_ghost (cmesh->trees, ghost_facejoin->local_id,
-                                    ghost_facejoin->ghost_id, 0,
-                                    classentry->eclass,
+          t8_cmesh_trees_add_ghost (cmesh->trees, ghost_id, classentry->id,
+                                    0, classentry->eclass,
                                     cmesh->num_local_trees);
         }
       }
@@ -381,119 +736,22 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     t8_cmesh_trees_set_all_boundary (cmesh, cmesh->trees);
 
     /* Go through all face_neighbour entries and parse every
-     * important entry */
-    for (iz = 0; iz < cmesh->stash->joinfaces.elem_count; iz++) {
-      joinface = (t8_stash_joinface_struct_t *)
-        sc_array_index (&cmesh->stash->joinfaces, iz);
-      id1 = joinface->id1;
-      id2 = joinface->id2;
-      id1_istree = cmesh->first_tree <= id1 && last_tree >= id1;
-      id2_istree = cmesh->first_tree <= id2 && last_tree >= id2;
-      temp_facejoin->ghost_id = id1;
-      tree1 = NULL;
-#if T8_ENABLE_DEBUG
-      ghost1 = NULL;
-#endif
-      /* There are the following cases:
-       * Both trees are local trees.
-       * One is a local tree and one a local ghost.
-       * Both are local ghosts.
-       * One is a local ghost and on neither ghost nor local tree.
-       * For each of these cases we have to set the correct face connection.
-       */
-      /* TODO: This if else if else spaghetti code is quite ugly, think it over
-       *       and find a better way */
-      face_neigh = face_neigh2 = NULL;
-      ttf = ttf2 = NULL;
-      if (id1_istree) {
-        /* First tree in the connection is a local tree */
-        tree1 = t8_cmesh_trees_get_tree_ext (cmesh->trees,
-                                             joinface->id1 -
-                                             cmesh->first_tree, &face_neigh,
-                                             &ttf);
-      }
-      else if (sc_hash_lookup (ghost_ids, temp_facejoin,
-                               (void ***) &facejoin_pp)) {
-        /* id1 is a local ghost */
-        ghost_facejoin = *facejoin_pp;
-#if T8_ENABLE_DEBUG
-        ghost1 = t8_cmesh_trees_get_ghost_ext (cmesh->trees,
-                                               ghost_facejoin->local_id,
-                                               &face_neigh_g, &ttf);
-#else
-        (void) t8_cmesh_trees_get_ghost_ext (cmesh->trees,
-                                             ghost_facejoin->local_id,
-                                             &face_neigh_g, &ttf);
+     * important entry. Different entries set different faces, thus we
+     * can do this in parallel. */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static)
 #endif
-        temp_local_id = ghost_facejoin->local_id;
-      }
-#if T8_ENABLE_DEBUG
-      ghost2 = NULL;
-#endif
-      tree2 = NULL;
-      temp_facejoin->ghost_id = joinface->id2;
-      if (id2_istree) {
-        /* Second tree in the connection is a local tree */
-        tree2 = t8_cmesh_trees_get_tree_ext (cmesh->trees,
-                                             joinface->id2 -
-                                             cmesh->first_tree, &face_neigh2,
-                                             &ttf2);
-      }
-      else if (sc_hash_lookup (ghost_ids, temp_facejoin,
-                               (void ***) &facejoin_pp)) {
-        /* id1 is a local ghost */
-        ghost_facejoin = *facejoin_pp;
-#if T8_ENABLE_DEBUG
-        ghost2 = t8_cmesh_trees_get_ghost_ext (cmesh->trees,
-                                               ghost_facejoin->local_id,
-                                               &face_neigh_g2, &ttf2);
-#else
-        (void) t8_cmesh_trees_get_ghost_ext (cmesh->trees,
-                                             ghost_facejoin->local_id,
-                                             &face_neigh_g2, &ttf2);
-#endif
-      }
-      F = t8_eclass_max_num_faces[cmesh->dimension];
-      if (ttf != NULL) {
-        /* The first entry is either a tree or ghost */
-        ttf[joinface->face1] = F * joinface->orientation + joinface->face2;
-        if (tree1 != NULL) {
-          /* First entry is a tree */
-          T8_ASSERT (ghost2 != NULL || tree2 != NULL);
-          face_neigh[joinface->face1] =
-            tree2 ? id2 - cmesh->first_tree :
-            ghost_facejoin->local_id + cmesh->num_local_trees;
-        }
-        else {
-          /* First entry is a ghost */
-          T8_ASSERT (ghost1 != NULL);
-          face_neigh_g[joinface->face1] = id2;
-        }
-      }
-      if (ttf2 != NULL) {
-        /* The second entry is either a tree or a ghost */
-        ttf2[joinface->face2] = F * joinface->orientation + joinface->face1;
-        if (tree2 != NULL) {
-          /* The second entry is a tree */
-          T8_ASSERT (tree1 != NULL || ghost1 != NULL);
-          face_neigh2[joinface->face2] = tree1 ? id1 - cmesh->first_tree :
-            temp_local_id + cmesh->num_local_trees;
-        }
-        else {
-          /* The second entry is a ghost */
-          T8_ASSERT (ghost2 != NULL);
-          face_neigh_g2[joinface->face2] = id1;
-        }
-      }
-      /* Done with setting face join */
+    for (ijoin = 0;
+         ijoin < (long long) cmesh->stash->joinfaces.elem_count; ijoin++) {
+      t8_cmesh_commit_partitioned_join (cmesh,
+                                        (t8_stash_joinface_struct_t *)
+                                        sc_array_index (&cmesh->stash->
+                                                        joinfaces,
+                                                        (size_t) ijoin),
+                                        &ghost_ids, last_tree);
     }
 
-    /* Add attributes */
-    /* TODO: attribute is required to be sorted right now. Think this over
-     *       if we cant work around it, at least use the sorted array above when
-     *       counting the attributes per tree. */
-
-    t8_stash_attribute_sort (cmesh->stash);
+    /* Add attributes. They were already sorted above. */
     t8_cmesh_add_attributes (cmesh);
 
     /* compute global number of trees. id1 serves as buffer since
@@ -501,9 +759,7 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
 
   }                             /* End if nonempty partition */
 
-  sc_mempool_free (ghost_facejoin_mempool, temp_facejoin);
-  sc_hash_destroy (ghost_ids);
-  sc_mempool_destroy (ghost_facejoin_mempool);
+  sc_array_reset (&ghost_ids);
 
   id1 = cmesh->num_local_trees;
   /* We must not count shared trees. Thus, we subtract one if
@@ -524,12 +780,251 @@ t8_cmesh_commit_partitioned_new (t8_cmesh_t cmesh, sc_MPI_Comm comm)
 #endif
 }
 
+/* Replace the vertex indices of the trees in the stash by the vertex
+ * coordinates from the vertex table and free the table afterwards.
+ * The vertex indices are set with t8_cmesh_set_tree_vertex_indices.
+ * The stash attributes have to be sorted afterwards. */
+static void
+t8_cmesh_commit_resolve_vertex_indices (t8_cmesh_t cmesh)
+{
+  t8_cmesh_vertex_table_t *table = cmesh->set_vertex_table;
+  t8_stash_attribute_struct_t *attribute;
+  const t8_gloidx_t  *indices;
+  double             *vertices;
+  size_t              iattribute, ivertex, num_vertices;
+  int                 icoord;
+
+  for (iattribute = 0; iattribute < cmesh->stash->attributes.elem_count;
+       iattribute++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&cmesh->stash->attributes, iattribute);
+    if (attribute->package_id != t8_get_package_id ()
+        || attribute->key != T8_CMESH_VERTEX_INDICES_ATTRIBUTE_KEY) {
+      continue;
+    }
+    SC_CHECK_ABORT (table != NULL,
+                    "Vertex indices are set but there is no vertex table.\n");
+    indices = (const t8_gloidx_t *) attribute->attr_data;
+    num_vertices = attribute->attr_size / sizeof (t8_gloidx_t);
+    vertices = T8_ALLOC (double, 3 * num_vertices);
+    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+      SC_CHECK_ABORTF (0 <= indices[ivertex]
+                       && indices[ivertex] < table->num_vertices,
+                       "Vertex %lli of tree %lli is not in the vertex table.\n",
+                       (long long) indices[ivertex], (long long) attribute->id);
+      for (icoord = 0; icoord < 3; icoord++) {
+        vertices[3 * ivertex + icoord] = table->single_precision ?
+          ((float *) table->coordinates)[3 * indices[ivertex] + icoord] :
+          ((double *) table->coordinates)[3 * indices[ivertex] + icoord];
+      }
+    }
+    if (attribute->is_owned) {
+      T8_FREE (attribute->attr_data);
+    }
+    /* The coordinates are stored as with t8_cmesh_set_tree_vertices */
+    attribute->attr_data = vertices;
+    attribute->attr_size = 3 * num_vertices * sizeof (double);
+    attribute->is_owned = 1;
+    attribute->key = 0;
+  }
+  if (table != NULL) {
+    T8_FREE (table->coordinates);
+    T8_FREE (table);
+    cmesh->set_vertex_table = NULL;
+  }
+}
+
+/* A tree and the Morton index of its centroid */
+typedef struct
+{
+  t8_linearidx_t      key;
+  t8_gloidx_t         tree_id;
+} t8_cmesh_reorder_key_t;
+
+static int
+t8_cmesh_reorder_key_compare (const void *k1, const void *k2)
+{
+  const t8_cmesh_reorder_key_t *key1 = (const t8_cmesh_reorder_key_t *) k1;
+  const t8_cmesh_reorder_key_t *key2 = (const t8_cmesh_reorder_key_t *) k2;
+
+  if (key1->key != key2->key) {
+    return key1->key < key2->key ? -1 : 1;
+  }
+  return key1->tree_id < key2->tree_id ? -1 :
+    key1->tree_id != key2->tree_id;
+}
+
+/* Spread the lowest 21 bits of x such that there are two zero bits
+ * between each two bits. */
+static              t8_linearidx_t
+t8_cmesh_reorder_spread_bits (t8_linearidx_t x)
+{
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+/* Renumber the trees in the stash of a replicated cmesh along a Morton
+ * curve through their centroids. Thus, contiguous ranges of trees are
+ * spatially compact, which reduces the ghost layer of a partition.
+ * If a tree has no vertices, the trees are not reordered. */
+static void
+t8_cmesh_commit_reorder_stash (t8_cmesh_t cmesh)
+{
+  t8_stash_t          stash = cmesh->stash;
+  t8_stash_class_struct_t *sclass;
+  t8_stash_attribute_struct_t *attribute;
+  t8_stash_joinface_struct_t *joinface;
+  t8_cmesh_reorder_key_t *keys;
+  t8_gloidx_t        *new_id, id1, id2;
+  double             *centroids, bounds[6], scale, coordinate;
+  const double       *vertices;
+  size_t              num_trees, itree, iattribute, ijoin, ivertex,
+    num_vertices;
+  int                 icoord, face;
+  char               *has_vertices;
+
+  num_trees = stash->classes.elem_count;
+  if (num_trees == 0) {
+    return;
+  }
+  centroids = T8_ALLOC_ZERO (double, 3 * num_trees);
+  has_vertices = T8_ALLOC_ZERO (char, num_trees);
+  for (iattribute = 0; iattribute < stash->attributes.elem_count;
+       iattribute++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, iattribute);
+    if (attribute->package_id != t8_get_package_id ()
+        || attribute->key != 0) {
+      continue;
+    }
+    SC_CHECK_ABORTF (0 <= attribute->id
+                     && (size_t) attribute->id < num_trees,
+                     "Tree %lli is out of range for reordering.\n",
+                     (long long) attribute->id);
+    vertices = (const double *) attribute->attr_data;
+    num_vertices = attribute->attr_size / (3 * sizeof (double));
+    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+      for (icoord = 0; icoord < 3; icoord++) {
+        centroids[3 * attribute->id + icoord] +=
+          vertices[3 * ivertex + icoord] / num_vertices;
+      }
+    }
+    has_vertices[attribute->id] = 1;
+  }
+  for (itree = 0; itree < num_trees; itree++) {
+    if (!has_vertices[itree]) {
+      t8_debugf ("Tree %lli has no vertices. Not reordering the cmesh.\n",
+                 (long long) itree);
+      T8_FREE (centroids);
+      T8_FREE (has_vertices);
+      return;
+    }
+  }
+  T8_FREE (has_vertices);
+
+  /* Compute the bounding box of the centroids */
+  for (icoord = 0; icoord < 3; icoord++) {
+    bounds[icoord] = bounds[3 + icoord] = centroids[icoord];
+  }
+  for (itree = 1; itree < num_trees; itree++) {
+    for (icoord = 0; icoord < 3; icoord++) {
+      bounds[icoord] = SC_MIN (bounds[icoord], centroids[3 * itree + icoord]);
+      bounds[3 + icoord] = SC_MAX (bounds[3 + icoord],
+                                   centroids[3 * itree + icoord]);
+    }
+  }
+  /* Compute and sort the Morton indices of the centroids on a grid
+   * of 2^21 cells per coordinate */
+  keys = T8_ALLOC (t8_cmesh_reorder_key_t, num_trees);
+  for (itree = 0; itree < num_trees; itree++) {
+    keys[itree].key = 0;
+    keys[itree].tree_id = itree;
+    for (icoord = 0; icoord < 3; icoord++) {
+      scale = bounds[3 + icoord] - bounds[icoord];
+      scale = scale > 0 ? ((1 << 21) - 1) / scale : 0;
+      coordinate = (centroids[3 * itree + icoord] - bounds[icoord]) * scale;
+      keys[itree].key |=
+        t8_cmesh_reorder_spread_bits ((t8_linearidx_t) coordinate) << icoord;
+    }
+  }
+  T8_FREE (centroids);
+  qsort (keys, num_trees, sizeof (*keys), t8_cmesh_reorder_key_compare);
+  new_id = T8_ALLOC (t8_gloidx_t, num_trees);
+  for (itree = 0; itree < num_trees; itree++) {
+    new_id[keys[itree].tree_id] = itree;
+  }
+  T8_FREE (keys);
+
+  /* Renumber the trees in the stash */
+  for (itree = 0; itree < num_trees; itree++) {
+    sclass = (t8_stash_class_struct_t *)
+      sc_array_index (&stash->classes, itree);
+    SC_CHECK_ABORTF (0 <= sclass->id && (size_t) sclass->id < num_trees,
+                     "Tree %lli is out of range for reordering.\n",
+                     (long long) sclass->id);
+    sclass->id = new_id[sclass->id];
+  }
+  for (iattribute = 0; iattribute < stash->attributes.elem_count;
+       iattribute++) {
+    attribute = (t8_stash_attribute_struct_t *)
+      sc_array_index (&stash->attributes, iattribute);
+    attribute->id = new_id[attribute->id];
+  }
+  for (ijoin = 0; ijoin < stash->joinfaces.elem_count; ijoin++) {
+    joinface = (t8_stash_joinface_struct_t *)
+      sc_array_index (&stash->joinfaces, ijoin);
+    id1 = new_id[joinface->id1];
+    id2 = new_id[joinface->id2];
+    /* Keep id1 <= id2 as in t8_stash_add_facejoin */
+    if (id1 > id2) {
+      joinface->id1 = id2;
+      joinface->id2 = id1;
+      face = joinface->face1;
+      joinface->face1 = joinface->face2;
+      joinface->face2 = face;
+    }
+    else {
+      joinface->id1 = id1;
+      joinface->id2 = id2;
+    }
+  }
+  T8_FREE (new_id);
+  t8_debugf ("Reordered %lli trees along a Morton curve.\n",
+             (long long) num_trees);
+}
+
 void
 t8_cmesh_commit_from_stash (t8_cmesh_t cmesh, sc_MPI_Comm comm)
 {
   T8_ASSERT (cmesh != NULL);
 
-  if (cmesh->set_partition) {
+  if (cmesh->set_tree_arrays == NULL
+      && cmesh->set_connectivity_arrays == NULL) {
+    /* Look up the vertices of the trees set by index. The attributes
+     * are sorted in the commit functions below. */
+    t8_cmesh_commit_resolve_vertex_indices (cmesh);
+    if (cmesh->set_reorder) {
+      SC_CHECK_ABORT (!cmesh->set_partition,
+                      "Only replicated cmeshes can be reordered.\n");
+      t8_cmesh_commit_reorder_stash (cmesh);
+    }
+  }
+  if (cmesh->set_tree_arrays != NULL) {
+    /* commit from arrays without using the stash */
+    SC_CHECK_ABORT (!cmesh->set_partition,
+                    "A cmesh set from tree arrays cannot be partitioned.\n");
+    t8_cmesh_commit_from_arrays (cmesh);
+  }
+  else if (cmesh->set_connectivity_arrays != NULL) {
+    /* commit from connectivity arrays without using the stash */
+    t8_cmesh_commit_from_connectivity (cmesh, comm);
+  }
+  else if (cmesh->set_partition) {
     /* partitioned commit */
     t8_cmesh_commit_partitioned_new (cmesh, comm);
   }
@@ -587,7 +1082,7 @@ t8_cmesh_commit_refine (t8_cmesh_t cmesh, sc_MPI_Comm comm)
      * set it temporarily. */
     cmesh->set_refine_level = 1;
   }
-  t8_cmesh_refine (cmesh);
+  t8_cmesh_refine (cmesh, comm);
   if (level > 1) {
     /* reset the refinement level and
      * cmesh_from. */
@@ -600,6 +1095,86 @@ t8_cmesh_commit_refine (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   }
 }
 
+/* Return the eclass of a local tree or ghost of a committed cmesh. */
+static t8_eclass_t
+t8_cmesh_commit_local_class (t8_cmesh_t cmesh, t8_locidx_t local_id)
+{
+  if (local_id < cmesh->num_local_trees) {
+    return t8_cmesh_get_tree_class (cmesh, local_id);
+  }
+  return t8_cmesh_get_ghost_class (cmesh, local_id - cmesh->num_local_trees);
+}
+
+/* Build the face table of a committed cmesh.
+ * \see t8_cmesh_set_face_table */
+static void
+t8_cmesh_commit_face_table (t8_cmesh_t cmesh)
+{
+  const int           F = t8_eclass_max_num_faces[cmesh->dimension];
+  const t8_locidx_t   num_local = cmesh->num_local_trees + cmesh->num_ghosts;
+  t8_cmesh_face_entry_t *entry;
+  t8_locidx_t         local_id, neigh;
+  t8_gloidx_t        *ghost_neigh;
+  t8_locidx_t        *tree_neigh;
+  int8_t             *ttf;
+  int                 face, num_faces;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (cmesh->face_table == NULL);
+  if (F == 0 || num_local == 0) {
+    /* There are no faces */
+    return;
+  }
+  cmesh->face_table = T8_ALLOC (t8_cmesh_face_entry_t, num_local * F);
+  for (local_id = 0; local_id < num_local; ++local_id) {
+    num_faces =
+      t8_eclass_num_faces[t8_cmesh_commit_local_class (cmesh, local_id)];
+    if (local_id < cmesh->num_local_trees) {
+      (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, local_id,
+                                          &tree_neigh, &ttf);
+      ghost_neigh = NULL;
+    }
+    else {
+      (void) t8_cmesh_trees_get_ghost_ext (cmesh->trees,
+                                           local_id - cmesh->num_local_trees,
+                                           &ghost_neigh, &ttf);
+      tree_neigh = NULL;
+    }
+    for (face = 0; face < F; ++face) {
+      entry = cmesh->face_table + local_id * F + face;
+      entry->neighbor = -1;
+      entry->ttf = face;
+      entry->eclass = T8_ECLASS_COUNT;
+      if (face >= num_faces) {
+        /* The tree does not have this face */
+        continue;
+      }
+      if (tree_neigh != NULL) {
+        neigh = tree_neigh[face];
+      }
+      else if (ghost_neigh[face] == t8_cmesh_get_global_id (cmesh, local_id)) {
+        neigh = local_id;
+      }
+      else {
+        neigh = t8_cmesh_get_local_id (cmesh, ghost_neigh[face]);
+      }
+      entry->ttf = ttf[face];
+      if (neigh == local_id && ttf[face] == face) {
+        /* The tree is connected to itself at the same face.
+         * Thus this is a domain boundary */
+        continue;
+      }
+      if (neigh < 0) {
+        /* The neighbor of this ghost is not local */
+        entry->neighbor = -2;
+        continue;
+      }
+      entry->neighbor = neigh;
+      entry->eclass = t8_cmesh_commit_local_class (cmesh, neigh);
+    }
+  }
+}
+
 /* TODO: set boundary face connections here.
  *       not trivial if replicated and not level 3 face_knowledg
  *       Edit: boundary face is default. If no face-connection is added then
@@ -620,6 +1195,7 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
                   && cmesh->dimension <= T8_ECLASS_MAX_DIM,
                   "Dimension of the cmesh is not set properly.\n");
 
+  T8_TRACE_BEGIN ("t8_cmesh_commit");
   /* If profiling is enabled, we measure the runtime of  commit. */
   if (cmesh->profile != NULL) {
     cmesh->profile->commit_runtime = sc_MPI_Wtime ();
@@ -689,6 +1265,14 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
       t8_cmesh_init (&cmesh_temp);
       cmesh_temp->stash = cmesh->stash;
       cmesh->stash = NULL;
+      cmesh_temp->set_tree_arrays = cmesh->set_tree_arrays;
+      cmesh->set_tree_arrays = NULL;
+      cmesh_temp->set_connectivity_arrays = cmesh->set_connectivity_arrays;
+      cmesh->set_connectivity_arrays = NULL;
+      cmesh_temp->set_vertex_table = cmesh->set_vertex_table;
+      cmesh->set_vertex_table = NULL;
+      cmesh_temp->set_reorder = cmesh->set_reorder;
+      cmesh_temp->dimension = cmesh->dimension;
       /* TODO: This code is duplicated above and may also be shorter */
       if (cmesh->set_partition) {
         if (cmesh->tree_offsets) {
@@ -718,8 +1302,20 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     }
   }
 
+  if (cmesh->set_shared_memory && !cmesh->set_partition
+      && cmesh->trees != NULL) {
+    /* All processes store the same trees in part 0, we keep only one
+     * copy per node. */
+    T8_ASSERT (t8_cmesh_trees_get_num_procs (cmesh->trees) == 1);
+    t8_cmesh_trees_share_part (cmesh->trees, 0, comm);
+  }
+
   cmesh->committed = 1;
 
+  if (cmesh->set_face_table && cmesh->trees != NULL) {
+    t8_cmesh_commit_face_table (cmesh);
+  }
+
   /* Compute trees_per_eclass */
   t8_cmesh_gather_trees_per_eclass (cmesh, comm);
 
@@ -759,4 +1355,5 @@ t8_cmesh_commit (t8_cmesh_t cmesh, sc_MPI_Comm comm)
     cmesh->profile->first_tree_shared = cmesh->first_tree_shared
       * cmesh->mpisize;
   }
+  T8_TRACE_END ("t8_cmesh_commit");
 }
@@ -30,6 +30,7 @@
 #include "t8_cmesh_types.h"
 #include "t8_cmesh_partition.h"
 #include "t8_cmesh_trees.h"
+#include "t8_cmesh_offset.h"
 #include "t8_cmesh_copy.h"
 
 void
@@ -37,6 +38,8 @@ t8_cmesh_copy (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from, sc_MPI_Comm comm)
 {
   size_t              num_parts, iz;
   t8_locidx_t         first_tree, num_trees, first_ghost, num_ghosts;
+  t8_gloidx_t        *offsets_from;
+  int                 iproc, mpiret;
 
   T8_ASSERT (t8_cmesh_is_initialized (cmesh));
   T8_ASSERT (!cmesh->committed);
@@ -47,8 +50,12 @@ t8_cmesh_copy (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from, sc_MPI_Comm comm)
   cmesh->face_knowledge = cmesh_from->face_knowledge;
   cmesh->first_tree = cmesh_from->first_tree;
   cmesh->first_tree_shared = cmesh_from->first_tree_shared;
-  cmesh->mpirank = cmesh_from->mpirank;
-  cmesh->mpisize = cmesh_from->mpisize;
+  /* The rank and size are those of comm, which may differ from the
+   * communicator of cmesh_from */
+  mpiret = sc_MPI_Comm_size (comm, &cmesh->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &cmesh->mpirank);
+  SC_CHECK_MPI (mpiret);
   cmesh->num_ghosts = cmesh_from->num_ghosts;
   cmesh->num_local_trees = cmesh_from->num_local_trees;
   cmesh->num_trees = cmesh_from->num_trees;
@@ -61,8 +68,32 @@ t8_cmesh_copy (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from, sc_MPI_Comm comm)
   if (cmesh_from->tree_offsets != NULL) {
     T8_ASSERT (cmesh->tree_offsets == NULL);
     cmesh->tree_offsets = t8_cmesh_alloc_offsets (cmesh->mpisize, comm);
-    sc_shmem_memcpy (cmesh->tree_offsets, cmesh_from->tree_offsets,
-                     sizeof (t8_gloidx_t) * (cmesh->mpisize + 1), comm);
+    if (cmesh->mpisize == cmesh_from->mpisize) {
+      t8_shmem_array_copy (cmesh->tree_offsets, cmesh_from->tree_offsets);
+    }
+    else {
+      /* comm is a sub- or supercommunicator of the communicator of
+       * cmesh_from. Its first ranks are the ranks of cmesh_from and all
+       * trees must belong to the ranks that are in both communicators. */
+      offsets_from =
+        t8_shmem_array_get_gloidx_array (cmesh_from->tree_offsets);
+      for (iproc = cmesh->mpisize; iproc < cmesh_from->mpisize; iproc++) {
+        SC_CHECK_ABORT (t8_offset_empty (iproc, offsets_from),
+                        "Cannot copy a cmesh to a communicator that does not"
+                        " contain all processes with trees.");
+      }
+      if (t8_shmem_array_start_writing (cmesh->tree_offsets)) {
+        for (iproc = 0; iproc < cmesh->mpisize; iproc++) {
+          t8_shmem_array_set_gloidx (cmesh->tree_offsets, iproc,
+                                     iproc < cmesh_from->mpisize ?
+                                     offsets_from[iproc] :
+                                     cmesh_from->num_trees);
+        }
+        t8_shmem_array_set_gloidx (cmesh->tree_offsets, cmesh->mpisize,
+                                   cmesh_from->num_trees);
+      }
+      t8_shmem_array_end_writing (cmesh->tree_offsets);
+    }
   }
   /* Copy the numbers of trees */
   memcpy (cmesh->num_trees_per_eclass, cmesh_from->num_trees_per_eclass,
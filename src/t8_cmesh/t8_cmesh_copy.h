@@ -34,6 +34,10 @@
 
 T8_EXTERN_C_BEGIN ();
 
+/* Copy the trees of a committed cmesh into a cmesh that is being committed
+ * on comm. comm may have a different size than the communicator of
+ * cmesh_from, if the ranks in both communicators are the same and all
+ * trees belong to them. */
 void                t8_cmesh_copy (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
                                    sc_MPI_Comm comm);
 
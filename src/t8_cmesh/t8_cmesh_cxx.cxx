@@ -32,20 +32,33 @@
  */
 
 void
-t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
-                         t8_scheme_cxx_t * ts,
-                         t8_gloidx_t * first_local_tree,
-                         t8_gloidx_t * child_in_tree_begin,
-                         t8_gloidx_t * last_local_tree,
-                         t8_gloidx_t * child_in_tree_end,
-                         int8_t * first_tree_shared)
+t8_cmesh_uniform_bounds_for_rank (t8_cmesh_t cmesh, int level,
+                                  t8_scheme_cxx_t * ts, int rank,
+                                  int num_ranks,
+                                  t8_gloidx_t * first_local_tree,
+                                  t8_gloidx_t * child_in_tree_begin,
+                                  t8_gloidx_t * last_local_tree,
+                                  t8_gloidx_t * child_in_tree_end,
+                                  int8_t * first_tree_shared)
 {
   int                 is_empty;
+  t8_gloidx_t         global_num_children;
+  t8_gloidx_t         first_global_child;
+  t8_gloidx_t         child_in_tree_begin_temp;
+  t8_gloidx_t         last_global_child;
+  t8_gloidx_t         children_per_tree = 0;
+  t8_gloidx_t         first_class_children_per_tree = -1;
+#ifdef T8_ENABLE_DEBUG
+  t8_gloidx_t         prev_last_tree = -1;
+#endif
+  int                 tree_class;
+  t8_eclass_scheme_c *tree_scheme;
 
   T8_ASSERT (cmesh != NULL);
   T8_ASSERT (cmesh->committed);
   T8_ASSERT (level >= 0);
   T8_ASSERT (ts != NULL);
+  T8_ASSERT (0 <= rank && rank < num_ranks);
 
   *first_local_tree = 0;
   if (child_in_tree_begin != NULL) {
@@ -56,133 +69,128 @@ t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
     *child_in_tree_end = 0;
   }
 
-  if (cmesh->num_trees_per_eclass[T8_ECLASS_PYRAMID] == 0) {
-    t8_gloidx_t         global_num_children;
-    t8_gloidx_t         first_global_child;
-    t8_gloidx_t         child_in_tree_begin_temp;
-    t8_gloidx_t         last_global_child;
-    t8_gloidx_t         children_per_tree = 0;
-    t8_gloidx_t         first_class_children_per_tree = -1;
-#ifdef T8_ENABLE_DEBUG
-    t8_gloidx_t         prev_last_tree = -1;
-#endif
-    int                 tree_class;
-    t8_eclass_scheme_c *tree_scheme;
-
-    /* Compute the number of children on level in each tree */
-    for (tree_class = T8_ECLASS_ZERO; tree_class < T8_ECLASS_COUNT;
-         ++tree_class) {
-      /* We iterate over each element class and get the number of children for this
-       * tree class.
-       * Currently we do not supported different numbers of children for different classes.
-       * Thus, if we encounter this situation, we abort with an error.
-       * Different numbers of children for different classes will be supported in the future.
-       */
-      if (cmesh->num_trees_per_eclass[tree_class] > 0) {
-        tree_scheme = ts->eclass_schemes[tree_class];
-        T8_ASSERT (tree_scheme != NULL);
-        children_per_tree =
-          tree_scheme->t8_element_count_leafs_from_root (level);
-        if (first_class_children_per_tree >= 0
-            && first_class_children_per_tree != children_per_tree) {
-          SC_ABORT
-            ("Currently t8code does not support different leaf counts per tree.");
-        }
-        first_class_children_per_tree = children_per_tree;
+  /* Compute the number of children on level in each tree */
+  for (tree_class = T8_ECLASS_ZERO; tree_class < T8_ECLASS_COUNT;
+       ++tree_class) {
+    /* We iterate over each element class and get the number of children for this
+     * tree class.
+     * Currently we do not supported different numbers of children for different classes.
+     * Thus, if we encounter this situation, we abort with an error.
+     * Different numbers of children for different classes will be supported in the future.
+     */
+    if (cmesh->num_trees_per_eclass[tree_class] > 0) {
+      tree_scheme = ts->eclass_schemes[tree_class];
+      T8_ASSERT (tree_scheme != NULL);
+      children_per_tree =
+        tree_scheme->t8_element_count_leafs_from_root (level);
+      if (first_class_children_per_tree >= 0
+          && first_class_children_per_tree != children_per_tree) {
+        SC_ABORT
+          ("Currently t8code does not support different leaf counts per tree.");
       }
+      first_class_children_per_tree = children_per_tree;
     }
-    T8_ASSERT (children_per_tree != 0);
-
-    global_num_children = cmesh->num_trees * children_per_tree;
+  }
+  T8_ASSERT (children_per_tree != 0);
 
-    if (cmesh->mpirank == 0) {
-      first_global_child = 0;
-      if (child_in_tree_begin != NULL) {
-        *child_in_tree_begin = 0;
-      }
-    }
-    else {
-      /* The first global child of processor p
-       * with P total processor is (the biggest int smaller than)
-       * (total_num_children * p) / P
-       * We cast to long double and double first to prevent integer overflow.
-       */
-      first_global_child =
-        ((long double) global_num_children *
-         cmesh->mpirank) / (double) cmesh->mpisize;
-    }
-    if (cmesh->mpirank != cmesh->mpisize - 1) {
-      last_global_child =
-        ((long double) global_num_children *
-         (cmesh->mpirank + 1)) / (double) cmesh->mpisize;
-    }
-    else {
-      last_global_child = global_num_children;
-    }
+  global_num_children = cmesh->num_trees * children_per_tree;
 
-    T8_ASSERT (0 <= first_global_child
-               && first_global_child <= global_num_children);
-    T8_ASSERT (0 <= last_global_child
-               && last_global_child <= global_num_children);
-    *first_local_tree = first_global_child / children_per_tree;
-    child_in_tree_begin_temp =
-      first_global_child - *first_local_tree * children_per_tree;
+  if (rank == 0) {
+    first_global_child = 0;
     if (child_in_tree_begin != NULL) {
-      *child_in_tree_begin = child_in_tree_begin_temp;
+      *child_in_tree_begin = 0;
     }
+  }
+  else {
+    /* The first global child of processor p
+     * with P total processor is (the biggest int smaller than)
+     * (total_num_children * p) / P
+     * We cast to long double and double first to prevent integer overflow.
+     */
+    first_global_child =
+      ((long double) global_num_children * rank) / (double) num_ranks;
+  }
+  if (rank != num_ranks - 1) {
+    last_global_child =
+      ((long double) global_num_children * (rank + 1)) / (double) num_ranks;
+  }
+  else {
+    last_global_child = global_num_children;
+  }
 
-    *last_local_tree = (last_global_child - 1) / children_per_tree;
+  T8_ASSERT (0 <= first_global_child
+             && first_global_child <= global_num_children);
+  T8_ASSERT (0 <= last_global_child
+             && last_global_child <= global_num_children);
+  *first_local_tree = first_global_child / children_per_tree;
+  child_in_tree_begin_temp =
+    first_global_child - *first_local_tree * children_per_tree;
+  if (child_in_tree_begin != NULL) {
+    *child_in_tree_begin = child_in_tree_begin_temp;
+  }
+
+  *last_local_tree = (last_global_child - 1) / children_per_tree;
 
-    is_empty = *first_local_tree >= *last_local_tree
-      && first_global_child >= last_global_child;
-    if (first_tree_shared != NULL) {
+  is_empty = *first_local_tree >= *last_local_tree
+    && first_global_child >= last_global_child;
+  if (first_tree_shared != NULL) {
 #ifdef T8_ENABLE_DEBUG
-      prev_last_tree = (first_global_child - 1) / children_per_tree;
-      T8_ASSERT (cmesh->mpirank > 0 || prev_last_tree <= 0);
+    prev_last_tree = (first_global_child - 1) / children_per_tree;
+    T8_ASSERT (rank > 0 || prev_last_tree <= 0);
 #endif
-      if (!is_empty && cmesh->mpirank > 0 && child_in_tree_begin_temp > 0) {
-        /* We exclude empty partitions here, by def their first_tree_shared flag is zero */
-        /* We also exclude that the previous partition was empty at the beginning of the
-         * partitions array */
-        /* We also exclude the case that we have the first global element but
-         * are not rank 0. */
-        *first_tree_shared = 1;
-      }
-      else {
-        *first_tree_shared = 0;
-      }
+    if (!is_empty && rank > 0 && child_in_tree_begin_temp > 0) {
+      /* We exclude empty partitions here, by def their first_tree_shared flag is zero */
+      /* We also exclude that the previous partition was empty at the beginning of the
+       * partitions array */
+      /* We also exclude the case that we have the first global element but
+       * are not rank 0. */
+      *first_tree_shared = 1;
     }
-    if (child_in_tree_end != NULL) {
-      if (*last_local_tree > 0) {
-        *child_in_tree_end =
-          last_global_child - *last_local_tree * children_per_tree;
-      }
-      else {
-        *child_in_tree_end = last_global_child;
-      }
+    else {
+      *first_tree_shared = 0;
     }
-    if (is_empty) {
-      /* This process is empty */
-      /* We now set the first local tree to the first local tree on the
-       * next nonempty rank, and the last local tree to first - 1 */
-      *first_local_tree = last_global_child / children_per_tree;
-      if (first_global_child % children_per_tree != 0) {
-        /* The next nonempty process shares this tree. */
-        (*first_local_tree)++;
-      }
-
-      *last_local_tree = *first_local_tree - 1;
+  }
+  if (child_in_tree_end != NULL) {
+    if (*last_local_tree > 0) {
+      *child_in_tree_end =
+        last_global_child - *last_local_tree * children_per_tree;
     }
-
-#if 0
-    if (first_global_child >= last_global_child && cmesh->mpirank != 0) {
-      /* This process is empty */
-      *first_local_tree = prev_last_tree + 1;
+    else {
+      *child_in_tree_end = last_global_child;
     }
-#endif
   }
-  else {
-    SC_ABORT ("Partition with level > 0 "
-              "does not support pyramidal elements yet.");
+  if (is_empty) {
+    /* This process is empty */
+    /* We now set the first local tree to the first local tree on the
+     * next nonempty rank, and the last local tree to first - 1 */
+    *first_local_tree = last_global_child / children_per_tree;
+    if (first_global_child % children_per_tree != 0) {
+      /* The next nonempty process shares this tree. */
+      (*first_local_tree)++;
+    }
+
+    *last_local_tree = *first_local_tree - 1;
   }
+
+#if 0
+  if (first_global_child >= last_global_child && rank != 0) {
+    /* This process is empty */
+    *first_local_tree = prev_last_tree + 1;
+  }
+#endif
+}
+
+void
+t8_cmesh_uniform_bounds (t8_cmesh_t cmesh, int level,
+                         t8_scheme_cxx_t * ts,
+                         t8_gloidx_t * first_local_tree,
+                         t8_gloidx_t * child_in_tree_begin,
+                         t8_gloidx_t * last_local_tree,
+                         t8_gloidx_t * child_in_tree_end,
+                         int8_t * first_tree_shared)
+{
+  t8_cmesh_uniform_bounds_for_rank (cmesh, level, ts, cmesh->mpirank,
+                                    cmesh->mpisize, first_local_tree,
+                                    child_in_tree_begin, last_local_tree,
+                                    child_in_tree_end, first_tree_shared);
 }
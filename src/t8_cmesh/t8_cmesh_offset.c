@@ -105,16 +105,53 @@ t8_offset_empty (int proc, t8_gloidx_t * offset)
   return 0;
 }
 
+/* Return the smallest index i in [low, high] with |offset[i]| > value
+ * or high + 1 if no such index exists.
+ * Since the absolute values of the entries of an offset array are
+ * increasing, we can use a binary search. */
+static int
+t8_offset_search_abs (int low, int high, t8_gloidx_t value,
+                      t8_gloidx_t * offset)
+{
+  int                 middle;
+
+  high++;
+  while (low < high) {
+    middle = low + (high - low) / 2;
+    if (T8_GLOIDX_ABS (offset[middle]) > value) {
+      high = middle;
+    }
+    else {
+      low = middle + 1;
+    }
+  }
+  return low;
+}
+
 /* Find the next higher rank that is not empty.
  * returns mpisize if this rank does not exist. */
 int
 t8_offset_next_nonempty_rank (int rank, int mpisize, t8_gloidx_t * offset)
 {
-  int                 next_nonempty = rank + 1;
+  int                 next_nonempty = rank + 1, next_bigger;
+  t8_gloidx_t         rank_end;
 
-  while (next_nonempty < mpisize && t8_offset_empty (next_nonempty, offset)) {
+  if (next_nonempty >= mpisize) {
+    return mpisize;
+  }
+  /* The first rank after rank whose offset end is bigger than the end of rank
+   * is nonempty. A rank in between can only be nonempty, if it consists
+   * of one shared tree. */
+  rank_end = T8_GLOIDX_ABS (offset[next_nonempty]);
+  next_bigger =
+    t8_offset_search_abs (next_nonempty + 1, mpisize, rank_end, offset) - 1;
+  while (next_nonempty < next_bigger && offset[next_nonempty] >= 0) {
+    /* Each rank in between has the entry +-rank_end and is nonempty
+     * iff the entry is negative. */
     next_nonempty++;
   }
+  T8_ASSERT (next_nonempty == mpisize
+             || !t8_offset_empty (next_nonempty, offset));
   return next_nonempty;
 }
 
@@ -195,46 +232,25 @@ t8_offset_any_owner_of_tree (int mpisize, t8_gloidx_t gtree,
 }
 
 /* Find the smallest process that owns a given tree.
- * To increase the runtime, some_owner can be a process that
- * already owns the tree. Otherwise (some_owner < 0), the function will compute one. */
+ * This is the smallest process whose last tree is not smaller than the tree.
+ * If some_owner >= 0, it is used as an upper bound for the search.
+ * Otherwise (some_owner < 0), it is set to the result. */
 int
 t8_offset_first_owner_of_tree (int mpisize, t8_gloidx_t gtree,
                                t8_gloidx_t * offset, int *some_owner)
 {
-  int                 proc, proc_temp;
+  int                 proc, upper;
 
   T8_ASSERT (t8_offset_valid_tree (gtree, mpisize, offset));
-  if (*some_owner < 0) {
-    *some_owner = t8_offset_any_owner_of_tree (mpisize, gtree, offset);
-  }
   T8_ASSERT (*some_owner < mpisize);
-  proc = *some_owner;
-  /* Here, proc stores an arbitrary owner of gtree */
-  /* Now we find the smallest process that owns the tree */
-  proc_temp = proc;
-  while (proc_temp >= 0 && t8_offset_in_range (gtree, proc_temp, offset)) {
-    /* decrement temp as long as it holds the tree */
-    proc_temp--;
-    while (0 <= proc_temp && t8_offset_empty (proc_temp, offset)) {
-      /* Skip empty processes */
-      proc_temp--;
-    }
-  }
-  /* We are now one nonempty proccess below the smallest process having the tree */
-  if (proc_temp >= -1) {
-    proc_temp++;
-    while (t8_offset_empty (proc_temp, offset)) {
-      /* Skip empty processes */
-      proc_temp++;
-    }
-    T8_ASSERT (t8_offset_in_range (gtree, proc_temp, offset));
-  }
-  else {
-    /* TODO: This should never happen */
-    T8_ASSERT (1 == 0);
-    proc_temp = proc;
+  upper = *some_owner >= 0 ? *some_owner : mpisize - 1;
+  /* The last tree of proc is |offset[proc + 1]| - 1 */
+  proc = t8_offset_search_abs (1, upper + 1, gtree, offset) - 1;
+  T8_ASSERT (0 <= proc && proc <= upper);
+  T8_ASSERT (t8_offset_in_range (gtree, proc, offset));
+  if (*some_owner < 0) {
+    *some_owner = proc;
   }
-  proc = proc_temp;
   return proc;
 }
 
@@ -287,46 +303,37 @@ t8_offset_prev_owner_of_tree (int mpisize, t8_gloidx_t gtree,
 }
 
 /* Find the biggest process that owns a given tree.
- * To increase the runtime, some_owner can be a process that
- * already owns the tree. Otherwise (some_owner < 0), the function will compute one. */
+ * Each owner but the first has gtree as its shared first tree and
+ * thus the offset entry -gtree - 1.
+ * We binary search the biggest process with |offset| <= gtree + 1 and go
+ * back to the last owner. Between those, there are only processes with
+ * the entry gtree + 1, which are either empty or start with the unshared
+ * tree gtree + 1.
+ * If some_owner >= 0, it is used as a lower bound for the search.
+ * Otherwise (some_owner < 0), it is set to the first owner. */
 int
 t8_offset_last_owner_of_tree (int mpisize, t8_gloidx_t gtree,
                               t8_gloidx_t * offset, int *some_owner)
 {
-  int                 proc, proc_temp;
+  int                 proc;
 
   T8_ASSERT (t8_offset_valid_tree (gtree, mpisize, offset));
   if (*some_owner < 0) {
-    *some_owner = t8_offset_any_owner_of_tree (mpisize, gtree, offset);
+    /* This sets some_owner to the first owner */
+    (void) t8_offset_first_owner_of_tree (mpisize, gtree, offset, some_owner);
   }
   T8_ASSERT (*some_owner < mpisize);
-  proc = *some_owner;
-  /* Here, proc stores an arbitrary owner of gtree */
-  /* Now we find the smallest process that owns the tree */
-  proc_temp = proc;
-  while (proc_temp < mpisize && t8_offset_in_range (gtree, proc_temp, offset)) {
-    /* increment temp as long as it holds the tree */
-    proc_temp++;
-    while (proc_temp < mpisize && t8_offset_empty (proc_temp, offset)) {
-      /* Skip empty processes */
-      proc_temp++;
-    }
-  }
-  /* We are now one nonempty proccess above the biggest process having the tree */
-  if (proc_temp <= mpisize) {
-    proc_temp--;
-    while (t8_offset_empty (proc_temp, offset)) {
-      /* Skip empty processes */
-      proc_temp--;
-    }
-    T8_ASSERT (t8_offset_in_range (gtree, proc_temp, offset));
+  T8_ASSERT (t8_offset_in_range (gtree, *some_owner, offset));
+  proc = t8_offset_search_abs (*some_owner + 1, mpisize - 1, gtree + 1,
+                               offset) - 1;
+  while (proc > *some_owner && offset[proc] != -gtree - 1) {
+    /* Skip the processes that do not have gtree */
+    T8_ASSERT (t8_offset_empty (proc, offset)
+               || t8_offset_first (proc, offset) > gtree);
+    proc--;
   }
-  else {
-    /* TODO: This should never happen */
-    T8_ASSERT (1 == 0);
-    proc_temp = proc;
-  }
-  proc = proc_temp;
+  T8_ASSERT (t8_offset_in_range (gtree, proc, offset));
+  T8_ASSERT (!t8_offset_empty (proc, offset));
   return proc;
 }
 
@@ -364,6 +371,174 @@ t8_offset_all_owners_of_tree (int mpisize, t8_gloidx_t gtree,
   }
 }
 
+t8_offset_lookup_t *
+t8_offset_lookup_new (int mpisize, t8_gloidx_t * offset)
+{
+  t8_offset_lookup_t *lookup;
+  int                 rank, k;
+
+  T8_ASSERT (mpisize > 0);
+  T8_ASSERT (offset != NULL);
+
+  lookup = T8_ALLOC (t8_offset_lookup_t, 1);
+  lookup->mpisize = mpisize;
+  lookup->nonempty = T8_ALLOC (int, mpisize);
+  lookup->rank_to_nonempty = T8_ALLOC (int, mpisize + 1);
+  lookup->first_tree = T8_ALLOC (t8_gloidx_t, mpisize);
+  lookup->last_tree = T8_ALLOC (t8_gloidx_t, mpisize);
+  k = 0;
+  for (rank = 0; rank < mpisize; rank++) {
+    lookup->rank_to_nonempty[rank] = k;
+    if (!t8_offset_empty (rank, offset)) {
+      lookup->nonempty[k] = rank;
+      lookup->first_tree[k] = t8_offset_first (rank, offset);
+      lookup->last_tree[k] = t8_offset_last (rank, offset);
+      k++;
+    }
+  }
+  lookup->rank_to_nonempty[mpisize] = k;
+  lookup->num_nonempty = k;
+  return lookup;
+}
+
+void
+t8_offset_lookup_destroy (t8_offset_lookup_t ** plookup)
+{
+  t8_offset_lookup_t *lookup;
+
+  T8_ASSERT (plookup != NULL && *plookup != NULL);
+  lookup = *plookup;
+  T8_FREE (lookup->nonempty);
+  T8_FREE (lookup->rank_to_nonempty);
+  T8_FREE (lookup->first_tree);
+  T8_FREE (lookup->last_tree);
+  T8_FREE (lookup);
+  *plookup = NULL;
+}
+
+int
+t8_offset_lookup_next_nonempty_rank (const t8_offset_lookup_t * lookup,
+                                     int rank)
+{
+  int                 k;
+
+  T8_ASSERT (-1 <= rank && rank < lookup->mpisize);
+  k = lookup->rank_to_nonempty[rank + 1];
+  return k < lookup->num_nonempty ? lookup->nonempty[k] : lookup->mpisize;
+}
+
+int
+t8_offset_lookup_prev_nonempty_rank (const t8_offset_lookup_t * lookup,
+                                     int rank)
+{
+  int                 k;
+
+  T8_ASSERT (0 <= rank && rank <= lookup->mpisize);
+  /* The index of the biggest nonempty rank smaller than rank */
+  k = lookup->rank_to_nonempty[rank] - 1;
+  return k >= 0 ? lookup->nonempty[k] : -1;
+}
+
+/* Return the index in lookup->nonempty of the smallest owner of gtree.
+ * This is the smallest nonempty rank whose last tree is not smaller than
+ * gtree. */
+static int
+t8_offset_lookup_first_owner_index (const t8_offset_lookup_t * lookup,
+                                    t8_gloidx_t gtree)
+{
+  int                 low = 0, high = lookup->num_nonempty - 1, middle;
+
+  while (low < high) {
+    middle = low + (high - low) / 2;
+    if (lookup->last_tree[middle] >= gtree) {
+      high = middle;
+    }
+    else {
+      low = middle + 1;
+    }
+  }
+  T8_ASSERT (lookup->first_tree[low] <= gtree
+             && gtree <= lookup->last_tree[low]);
+  return low;
+}
+
+int
+t8_offset_lookup_first_owner_of_tree (const t8_offset_lookup_t * lookup,
+                                      t8_gloidx_t gtree)
+{
+  return lookup->nonempty[t8_offset_lookup_first_owner_index (lookup,
+                                                              gtree)];
+}
+
+int
+t8_offset_lookup_last_owner_of_tree (const t8_offset_lookup_t * lookup,
+                                     t8_gloidx_t gtree)
+{
+  int                 low = 0, high = lookup->num_nonempty - 1, middle;
+
+  /* Find the biggest nonempty rank whose first tree is not bigger
+   * than gtree */
+  while (low < high) {
+    middle = high - (high - low) / 2;
+    if (lookup->first_tree[middle] <= gtree) {
+      low = middle;
+    }
+    else {
+      high = middle - 1;
+    }
+  }
+  T8_ASSERT (lookup->first_tree[low] <= gtree
+             && gtree <= lookup->last_tree[low]);
+  return lookup->nonempty[low];
+}
+
+int
+t8_offset_lookup_next_owner_of_tree (const t8_offset_lookup_t * lookup,
+                                     t8_gloidx_t gtree, int current_owner)
+{
+  int                 k;
+
+  T8_ASSERT (0 <= current_owner && current_owner < lookup->mpisize);
+  k = lookup->rank_to_nonempty[current_owner + 1];
+  if (k < lookup->num_nonempty && lookup->first_tree[k] == gtree) {
+    /* The next nonempty rank shares gtree with current_owner */
+    return lookup->nonempty[k];
+  }
+  return -1;
+}
+
+int
+t8_offset_lookup_prev_owner_of_tree (const t8_offset_lookup_t * lookup,
+                                     t8_gloidx_t gtree, int current_owner)
+{
+  int                 k;
+
+  T8_ASSERT (0 <= current_owner && current_owner < lookup->mpisize);
+  k = lookup->rank_to_nonempty[current_owner] - 1;
+  if (k >= 0 && lookup->last_tree[k] == gtree) {
+    /* The previous nonempty rank shares gtree with current_owner */
+    return lookup->nonempty[k];
+  }
+  return -1;
+}
+
+void
+t8_offset_lookup_all_owners_of_tree (const t8_offset_lookup_t * lookup,
+                                     t8_gloidx_t gtree, sc_array_t * owners)
+{
+  int                 k;
+
+  T8_ASSERT (owners != NULL);
+  T8_ASSERT (owners->elem_count == 0);
+  T8_ASSERT (owners->elem_size == sizeof (int));
+
+  /* The owners are consecutive nonempty ranks */
+  for (k = t8_offset_lookup_first_owner_index (lookup, gtree);
+       k < lookup->num_nonempty && lookup->first_tree[k] <= gtree; k++) {
+    *(int *) sc_array_push (owners) = lookup->nonempty[k];
+  }
+}
+
 /* Return 1 if the process will not send any trees, that is if it is
  * empty or has only one shared tree. */
 int
@@ -401,11 +576,8 @@ t8_offset_nosend (int proc, int mpisize, t8_gloidx_t * offset_from,
         return 0;
       }
 
-      temp_proc = proc + 1;
       /* Find next nonempty process */
-      while (temp_proc < mpisize && t8_offset_empty (temp_proc, offset_from)) {
-        temp_proc++;
-      }
+      temp_proc = t8_offset_next_nonempty_rank (proc, mpisize, offset_from);
       if (temp_proc >= mpisize ||
           t8_offset_first (temp_proc, offset_from) != last_tree) {
         /* Our last tree is unique and thus we need to send it */
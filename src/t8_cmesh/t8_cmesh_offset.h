@@ -145,8 +145,9 @@ int                 t8_offset_any_owner_of_tree (int mpisize,
  * \param [in] offset     The partition to be considered.
  * \param [in] some_owner If >= 0 considered as input: a process that has \a gtree as local tree.
  *                        If < 0 on output a process that has \a gtree as local tree.
- *                        Specifying \a some_owner increases the runtime from
- *                        O(log mpisize) to O(n), where n is the number of owners of the tree.
+ *                        If >= 0, the search is restricted to the ranks
+ *                        up to \a some_owner.
+ *                        The runtime is O(log mpisize).
  * \return                The smallest rank that has \a gtree as a local tree.
  */
 int                 t8_offset_first_owner_of_tree (int mpisize,
@@ -163,8 +164,10 @@ int                 t8_offset_first_owner_of_tree (int mpisize,
  * \param [in] offset     The partition to be considered.
  * \param [in,out] some_owner If >= 0 considered as input: a process that has \a gtree as local tree.
  *                        If < 0 on output a process that has \a gtree as local tree.
- *                        Specifying \a some_owner increases the runtime from
- *                        O(log mpisize) to O(n), where n is the number of owners of the tree.
+ *                        If >= 0, the search is restricted to the ranks
+ *                        from \a some_owner on.
+ *                        The runtime is O(log mpisize + n), where n is the
+ *                        number of empty ranks between the owners of the tree.
  * \return                The biggest rank that has \a gtree as a local tree.
  */
 int                 t8_offset_last_owner_of_tree (int mpisize,
@@ -215,6 +218,128 @@ void                t8_offset_all_owners_of_tree (int mpisize,
                                                   t8_gloidx_t * offset,
                                                   sc_array_t * owners);
 
+/** A lookup structure for the owners of trees in a partition table.
+ * It stores the nonempty ranks together with their first and last trees.
+ * It is built once in O(mpisize) and afterwards the owner queries do not
+ * need to skip empty ranks. The next and previous nonempty rank and owner
+ * are found in O(1), the first and last owner of a tree in
+ * O(log(number of nonempty ranks)).
+ * This is useful if many queries are made with the same partition table.
+ */
+typedef struct
+{
+  int                 mpisize;  /**< The number of ranks in the partition. */
+  int                 num_nonempty; /**< The number of nonempty ranks. */
+  int                *nonempty; /**< The nonempty ranks in ascending order. */
+  int                *rank_to_nonempty; /**< For each rank p in 0, ..., mpisize the
+                                             index in \a nonempty of the smallest
+                                             nonempty rank >= p, or \a num_nonempty
+                                             if there is none. */
+  t8_gloidx_t        *first_tree; /**< The first tree of each nonempty rank. */
+  t8_gloidx_t        *last_tree; /**< The last tree of each nonempty rank. */
+} t8_offset_lookup_t;
+
+/** Build the owner lookup of a partition table.
+ * \param [in] mpisize    The number of MPI ranks, also the number of entries in \a offset minus 1.
+ * \param [in] offset     The partition to be considered.
+ *                        It is not referenced by the lookup.
+ * \return                A new lookup structure, which must be freed with
+ *                        \ref t8_offset_lookup_destroy.
+ */
+t8_offset_lookup_t *t8_offset_lookup_new (int mpisize, t8_gloidx_t * offset);
+
+/** Free the memory of an owner lookup.
+ * \param [in,out] plookup  On input a lookup, on output NULL.
+ */
+void                t8_offset_lookup_destroy (t8_offset_lookup_t ** plookup);
+
+/** Find the next higher rank that is not empty, as
+ * \ref t8_offset_next_nonempty_rank with runtime O(1).
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] rank     An MPI rank.
+ * \return              The smallest nonempty rank bigger than \a rank,
+ *                      mpisize if it does not exist.
+ */
+int                 t8_offset_lookup_next_nonempty_rank (const
+                                                         t8_offset_lookup_t *
+                                                         lookup, int rank);
+
+/** Find the next smaller rank that is not empty.
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] rank     An MPI rank.
+ * \return              The biggest nonempty rank smaller than \a rank,
+ *                      -1 if it does not exist.
+ */
+int                 t8_offset_lookup_prev_nonempty_rank (const
+                                                         t8_offset_lookup_t *
+                                                         lookup, int rank);
+
+/** Find the smallest process that has a given tree as local tree, as
+ * \ref t8_offset_first_owner_of_tree.
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] gtree    The global id of a tree.
+ * \return              The smallest rank that has \a gtree as a local tree.
+ */
+int                 t8_offset_lookup_first_owner_of_tree (const
+                                                          t8_offset_lookup_t
+                                                          * lookup,
+                                                          t8_gloidx_t gtree);
+
+/** Find the biggest process that has a given tree as local tree, as
+ * \ref t8_offset_last_owner_of_tree.
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] gtree    The global id of a tree.
+ * \return              The biggest rank that has \a gtree as a local tree.
+ */
+int                 t8_offset_lookup_last_owner_of_tree (const
+                                                         t8_offset_lookup_t *
+                                                         lookup,
+                                                         t8_gloidx_t gtree);
+
+/** Given a process current_owner that has the tree gtree as local tree,
+ * find the next bigger rank that also has this tree as local tree, as
+ * \ref t8_offset_next_owner_of_tree with runtime O(1).
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] gtree    The global id of a tree.
+ * \param [in] current_owner A process that has \a gtree as local tree.
+ * \return              The next bigger rank that has \a gtree as local tree,
+ *                      -1 if no such rank exists.
+ */
+int                 t8_offset_lookup_next_owner_of_tree (const
+                                                         t8_offset_lookup_t *
+                                                         lookup,
+                                                         t8_gloidx_t gtree,
+                                                         int current_owner);
+
+/** Given a process current_owner that has the tree gtree as local tree,
+ * find the next smaller rank that also has this tree as local tree, as
+ * \ref t8_offset_prev_owner_of_tree with runtime O(1).
+ * \param [in] lookup   The lookup of a partition.
+ * \param [in] gtree    The global id of a tree.
+ * \param [in] current_owner A process that has \a gtree as local tree.
+ * \return              The next smaller rank that has \a gtree as local tree,
+ *                      -1 if no such rank exists.
+ */
+int                 t8_offset_lookup_prev_owner_of_tree (const
+                                                         t8_offset_lookup_t *
+                                                         lookup,
+                                                         t8_gloidx_t gtree,
+                                                         int current_owner);
+
+/** Compute a list of all processes that own a specific tree, as
+ * \ref t8_offset_all_owners_of_tree.
+ * \param [in] lookup    The lookup of a partition.
+ * \param [in] gtree     The global index of a tree.
+ * \param [in,out] owners On input an initialized sc_array with integer entries and
+ *                        zero elements. On output a sorted list of all MPI ranks that have
+ *                        \a gtree as a local tree.
+ */
+void                t8_offset_lookup_all_owners_of_tree (const
+                                                         t8_offset_lookup_t *
+                                                         lookup,
+                                                         t8_gloidx_t gtree,
+                                                         sc_array_t * owners);
+
 /** Query whether in a repartition setting a given process
  *  does send any of its local trees to any other process (including itself)
  * \param [in] proc     A mpi rank.
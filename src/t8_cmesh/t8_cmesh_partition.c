@@ -32,6 +32,7 @@
 #include "t8_cmesh_trees.h"
 #include "t8_cmesh_partition.h"
 #include "t8_cmesh_offset.h"
+#include <t8_trace.h>
 
 #if 0
 /* Return the minimum of two t8_gloidx_t's */
@@ -226,8 +227,11 @@ t8_cmesh_gather_treecount_ext (t8_cmesh_t cmesh, sc_MPI_Comm comm,
     cmesh->tree_offsets = t8_cmesh_alloc_offsets (cmesh->mpisize, comm);
     t8_shmem_array_allgather (&tree_offset, 1, T8_MPI_GLOIDX,
                               cmesh->tree_offsets, 1, T8_MPI_GLOIDX);
-    t8_shmem_array_set_gloidx (cmesh->tree_offsets, cmesh->mpisize,
-                               cmesh->num_trees);
+    if (t8_shmem_array_start_writing (cmesh->tree_offsets)) {
+      t8_shmem_array_set_gloidx (cmesh->tree_offsets, cmesh->mpisize,
+                                 cmesh->num_trees);
+    }
+    t8_shmem_array_end_writing (cmesh->tree_offsets);
 
     if (cmesh->num_local_trees <= 0) {
       /* This process is empty */
@@ -313,8 +317,11 @@ t8_cmesh_partition_create_offsets (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   first_tree = cmesh->first_tree;
   t8_shmem_array_allgather (&first_tree, 1, T8_MPI_GLOIDX,
                             cmesh->tree_offsets, 1, T8_MPI_GLOIDX);
-  t8_shmem_array_set_gloidx (cmesh->tree_offsets, cmesh->mpisize,
-                             cmesh->num_trees);
+  if (t8_shmem_array_start_writing (cmesh->tree_offsets)) {
+    t8_shmem_array_set_gloidx (cmesh->tree_offsets, cmesh->mpisize,
+                               cmesh->num_trees);
+  }
+  t8_shmem_array_end_writing (cmesh->tree_offsets);
   offset = t8_shmem_array_get_gloidx_array (cmesh->tree_offsets);
 
   /* Now we need to find out if our first tree is shared with other processes */
@@ -2591,6 +2598,7 @@ t8_cmesh_partition (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   T8_ASSERT (cmesh->set_partition);
 
   t8_global_productionf ("Enter cmesh partition\n");
+  T8_TRACE_BEGIN ("t8_cmesh_partition");
   /* If profiling is enabled, we measure the runtime of this routine. */
   if (cmesh->profile != NULL) {
     cmesh->profile->partition_runtime = sc_MPI_Wtime ();
@@ -2642,12 +2650,15 @@ t8_cmesh_partition (t8_cmesh_t cmesh, sc_MPI_Comm comm)
   /*        Done with local num and tree_offset      */
   /***************************************************/
   t8_cmesh_partition_given (cmesh, cmesh->set_from, tree_offsets, comm);
+  /* Merge the trees received from different processes into one block */
+  t8_cmesh_trees_compact (cmesh->trees);
   /* If profiling is enabled, we measure the runtime of this routine. */
   if (cmesh->profile) {
     /* Runtime = current_time - start_time */
     cmesh->profile->partition_runtime = sc_MPI_Wtime ()
       - cmesh->profile->partition_runtime;
   }
+  T8_TRACE_END ("t8_cmesh_partition");
   t8_global_productionf ("Done cmesh partition\n");
 }
 
@@ -2698,19 +2709,24 @@ t8_cmesh_offset_concentrate (int proc, sc_MPI_Comm comm,
 
   shmem_array = t8_cmesh_alloc_offsets (mpisize, comm);
   offsets = t8_shmem_array_get_gloidx_array (shmem_array);
-  offsets[0] = 0;
-  for (iproc = 1; iproc <= mpisize; iproc++) {
-    if (iproc == proc + 1) {
-      offsets[iproc] = num_trees;
-    }
-    else {
-      offsets[iproc] = offsets[iproc - 1];
+  if (t8_shmem_array_start_writing (shmem_array)) {
+    offsets[0] = 0;
+    for (iproc = 1; iproc <= mpisize; iproc++) {
+      if (iproc == proc + 1) {
+        offsets[iproc] = num_trees;
+      }
+      else {
+        offsets[iproc] = offsets[iproc - 1];
+      }
     }
+  }
+  t8_shmem_array_end_writing (shmem_array);
 #ifdef T8_ENABLE_DEBUG
+  for (iproc = 1; iproc <= mpisize; iproc++) {
     snprintf (out + strlen (out), BUFSIZ - strlen (out), "%li,",
               offsets[iproc]);
-#endif
   }
+#endif
 #ifdef T8_ENABLE_DEBUG
   t8_debugf ("Partition with offsets:0,%s\n", out);
 #endif
@@ -2756,46 +2772,50 @@ t8_cmesh_offset_random (sc_MPI_Comm comm, t8_gloidx_t num_trees, int shared,
   SC_CHECK_MPI (mpiret);
   srand (u_seed);
 
-  offsets[0] = 0;
-  first_shared = 0;
-  for (iproc = 1; iproc < mpisize; iproc++) {
-    offsets[iproc] = 0;
-    /* Create a random number between 0 and 200% of an ideal partition */
-    /* This is the number of trees on process iproc-1. */
-    if ((int) (num_trees * 2. / mpisize) == 0) {
-      /* This case prevents division by 0 */
-      random_number = 1;
-    }
-    else {
-      random_number = rand () % (int) (num_trees * 2. / mpisize);
-    }
+  /* All processes compute the same offsets, only the writing ones store them */
+  if (t8_shmem_array_start_writing (shmem_array)) {
+    offsets[0] = 0;
+    first_shared = 0;
+    for (iproc = 1; iproc < mpisize; iproc++) {
+      offsets[iproc] = 0;
+      /* Create a random number between 0 and 200% of an ideal partition */
+      /* This is the number of trees on process iproc-1. */
+      if ((int) (num_trees * 2. / mpisize) == 0) {
+        /* This case prevents division by 0 */
+        random_number = 1;
+      }
+      else {
+        random_number = rand () % (int) (num_trees * 2. / mpisize);
+      }
 
-    if (random_number == 0 && first_shared) {
-      /* The previous proc is empty but set its first tree to be shared. */
-      /* We have to manually reset the shared flag. */
-      offsets[iproc - 1] = -offsets[iproc - 1] - 1;
-      first_shared = 0;
-    }
-    random_number += first_shared;
-    /* If we would exceed the number of trees we cut the random number */
-    new_first = t8_offset_first (iproc - 1, offsets) + random_number;
-    if (new_first > num_trees) {
-      random_number = num_trees - t8_offset_first (iproc - 1, offsets);
-      new_first = num_trees;
-    }
-    if (shared && new_first < num_trees) {      /* new first is num_trees, this process must be empty */
-      first_shared = rand () % 2;
-    }
-    else {
-      first_shared = 0;
-    }
+      if (random_number == 0 && first_shared) {
+        /* The previous proc is empty but set its first tree to be shared. */
+        /* We have to manually reset the shared flag. */
+        offsets[iproc - 1] = -offsets[iproc - 1] - 1;
+        first_shared = 0;
+      }
+      random_number += first_shared;
+      /* If we would exceed the number of trees we cut the random number */
+      new_first = t8_offset_first (iproc - 1, offsets) + random_number;
+      if (new_first > num_trees) {
+        random_number = num_trees - t8_offset_first (iproc - 1, offsets);
+        new_first = num_trees;
+      }
+      if (shared && new_first < num_trees) {      /* new first is num_trees, this process must be empty */
+        first_shared = rand () % 2;
+      }
+      else {
+        first_shared = 0;
+      }
 
-    offsets[iproc] = random_number + t8_offset_first (iproc - 1, offsets);
-    if (first_shared && offsets[iproc] != num_trees) {
-      offsets[iproc] = -offsets[iproc] - 1;
+      offsets[iproc] = random_number + t8_offset_first (iproc - 1, offsets);
+      if (first_shared && offsets[iproc] != num_trees) {
+        offsets[iproc] = -offsets[iproc] - 1;
+      }
     }
+    offsets[mpisize] = num_trees;
   }
-  offsets[mpisize] = num_trees;
+  t8_shmem_array_end_writing (shmem_array);
 
   T8_ASSERT (t8_offset_consistent (mpisize, offsets, num_trees));
   return shmem_array;
@@ -2853,8 +2873,11 @@ t8_cmesh_offset_percent (t8_cmesh_t cmesh, sc_MPI_Comm comm, int percent)
   }
   t8_shmem_array_allgather (&new_first_tree, 1, T8_MPI_GLOIDX,
                             partition_array, 1, T8_MPI_GLOIDX);
-  t8_shmem_array_set_gloidx (partition_array, mpisize,
-                             t8_cmesh_get_num_trees (cmesh));
+  if (t8_shmem_array_start_writing (partition_array)) {
+    t8_shmem_array_set_gloidx (partition_array, mpisize,
+                               t8_cmesh_get_num_trees (cmesh));
+  }
+  t8_shmem_array_end_writing (partition_array);
   if (created) {
     /* We needed to create the old partition array and thus we clean it up
      * again. */
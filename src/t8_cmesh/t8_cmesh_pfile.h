@@ -0,0 +1,170 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_cmesh_pfile.h
+ *
+ * Functions to read mesh files in parallel. Each process reads an equally
+ * sized byte range of a file and parses the lines that start in it.
+ * The nodes and elements that the processes parsed are combined into a
+ * partitioned cmesh with \ref t8_pfile_build_cmesh.
+ * They are used by the parallel .msh, TETGEN, TRIANGLE and vtu readers.
+ */
+
+#ifndef T8_CMESH_PFILE_H
+#define T8_CMESH_PFILE_H
+
+#include <t8.h>
+#include <t8_cmesh.h>
+
+#ifdef T8_ENABLE_MPIIO
+typedef MPI_File    t8_pfile_handle_t;
+#else
+typedef FILE       *t8_pfile_handle_t;
+#endif
+
+/** A node as it is distributed by the parallel readers.
+ * The index is a long, since the number of nodes may exceed the range
+ * of t8_locidx_t. */
+typedef struct
+{
+  long                index; /**< The index of the node in the file. */
+  double              coordinates[3]; /**< The coordinates of the node. */
+} t8_pfile_node_t;
+
+/** An element as it is read by a process */
+typedef struct
+{
+  t8_eclass_t         eclass; /**< The class of the element. */
+  long                node_indices[8]; /**< The node indices in .msh order. */
+} t8_pfile_element_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** The .msh file vertex number of each t8code vertex number. */
+extern const int    t8_vertex_to_msh_vertex_num[T8_ECLASS_COUNT][8];
+
+/** Open a file for reading on all processes of comm.
+ * \param [in]  filename  The name of the file.
+ * \param [in]  comm      The processes that open the file.
+ * \param [out] fh        The handle of the opened file.
+ * \return                True on all processes if the file was opened
+ *                        on all processes.
+ */
+int                 t8_pfile_open (const char *filename, sc_MPI_Comm comm,
+                                   t8_pfile_handle_t * fh);
+
+/** Close a file opened with \ref t8_pfile_open.
+ * \param [in,out] fh     The handle of the file.
+ */
+void                t8_pfile_close (t8_pfile_handle_t * fh);
+
+/** Return the size of an open file in bytes or -1 on failure.
+ * \param [in] fh         The handle of the file.
+ */
+long long           t8_pfile_size (t8_pfile_handle_t fh);
+
+/** Read up to \a size bytes at a given offset of an open file.
+ * \param [in]  fh         The handle of the file.
+ * \param [in]  offset     The offset in the file in bytes.
+ * \param [out] buffer     At least \a size bytes, on output the bytes read.
+ * \param [in]  size       The number of bytes to read.
+ * \return                 The number of bytes read, which is smaller than
+ *                         \a size at the end of the file or on failure.
+ */
+long long           t8_pfile_read_at (t8_pfile_handle_t fh, long long offset,
+                                      char *buffer, long long size);
+
+/** Read the lines of a file that start in the byte range of this process.
+ * The file is split into mpisize ranges of equal size and each line
+ * belongs to the range that contains its first byte.
+ * \param [in]  fh          The handle of the file.
+ * \param [in]  file_size   The size of the file in bytes.
+ * \param [in]  mpirank     The rank of this process.
+ * \param [in]  mpisize     The number of processes.
+ * \param [in,out] lines    An array of char. On output it holds the lines
+ *                          terminated by '\0'.
+ * \param [out] lines_offset The offset of the first line in the file.
+ * \return                  True on success.
+ */
+int                 t8_pfile_read_lines (t8_pfile_handle_t fh,
+                                         long long file_size, int mpirank,
+                                         int mpisize, sc_array_t * lines,
+                                         long long *lines_offset);
+
+/** Send records to other processes and receive the records that the other
+ * processes send to us.
+ * \param [in]  comm        The communicator.
+ * \param [in]  mpirank     The rank of this process in \a comm.
+ * \param [in]  mpisize     The size of \a comm.
+ * \param [in]  send_buffer The records sorted by their target process.
+ * \param [in]  send_counts send_counts[p] records go to process p.
+ * \param [in,out] recv_buffer An array with the same element size.
+ *                          On output the received records sorted by their
+ *                          source process.
+ * \param [out] recv_counts recv_counts[p] is the number of records from
+ *                          process p.
+ * \param [in]  tag         The MPI tag of the messages.
+ */
+void                t8_pfile_exchange (sc_MPI_Comm comm, int mpirank,
+                                       int mpisize, sc_array_t * send_buffer,
+                                       int *send_counts,
+                                       sc_array_t * recv_buffer,
+                                       int *recv_counts, int tag);
+
+/** Sort records by their target processes into a send buffer for
+ * \ref t8_pfile_exchange. The order of the records with the same target
+ * is kept.
+ * \param [in]  records     The records.
+ * \param [in]  ranks       For each record its target process.
+ * \param [in]  mpisize     The number of processes.
+ * \param [in,out] send_buffer An array with the same element size.
+ *                          On output the sorted records.
+ * \param [out] send_counts For each process the number of its records.
+ */
+void                t8_pfile_sort_by_rank (sc_array_t * records,
+                                           const int *ranks, int mpisize,
+                                           sc_array_t * send_buffer,
+                                           int *send_counts);
+
+/** Build a partitioned cmesh from the nodes and elements that the processes
+ * read. The trees of a process are its elements, numbered in the order of
+ * the processes and of \a elements. The nodes are distributed to the
+ * processes by their index and each process requests the coordinates of
+ * the nodes of its trees. The face connections are found by sending each
+ * face to a process given by its vertices.
+ * \param [in]  comm        The communicator of the cmesh.
+ * \param [in,out] nodes    An array of \ref t8_pfile_node_t, each node of
+ *                          the file is on exactly one process.
+ *                          It is reset on output.
+ * \param [in,out] elements An array of \ref t8_pfile_element_t that are of
+ *                          dimension \a dim. It is reset on output.
+ * \param [in]  dim         The dimension of the cmesh.
+ * \return                  A committed partitioned cmesh or NULL on failure.
+ *                          This function is collective.
+ */
+t8_cmesh_t          t8_pfile_build_cmesh (sc_MPI_Comm comm,
+                                          sc_array_t * nodes,
+                                          sc_array_t * elements, int dim);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_CMESH_PFILE_H */
@@ -25,6 +25,7 @@
 #include <t8_cmesh_vtk.h>
 #include "t8_cmesh_types.h"
 #include "t8_cmesh_stash.h"
+#include "t8_cmesh_pfile.h"
 
 /* The supported number of gmesh tree classes.
  * Currently, we only support first order trees.
@@ -126,8 +127,10 @@ t8_cmesh_msh_read_next_line (char **line, size_t * n, FILE * fp)
  * $EndNodes
  *
  * The node indices do not need to be in consecutive order.
- * We thus use a hash table to read all node indices and coordinates.
- * The hash value is the node index modulo the number of nodes.
+ * We thus store all nodes in an array that is sorted by the node indices.
+ * Since most files number their nodes densely, we first check whether the
+ * node with a given index is at the position of the index relative to the
+ * first index. Only if it is not, we use a binary search.
  */
 typedef struct
 {
@@ -135,45 +138,48 @@ typedef struct
   double              coordinates[3];
 } t8_msh_file_node_t;
 
-/* Return the hash value of a node.
- * \param [in]  node    The node whose hash value should be computed.
- * \param [in]  num_nodes A pointer to a locidx_t storing the total number of nodes.
- * \return              The hash value for a node. This is its index modulo the number of nodes.
- */
-static unsigned
-t8_msh_file_node_hash (const void *node, const void *num_nodes)
-{
-  t8_msh_file_node_t *Node;
-  t8_locidx_t         Num_nodes;
-
-  T8_ASSERT (node != NULL);
-  T8_ASSERT (num_nodes != NULL);
-  /* The data parameter stores the total number of nodes */
-  Num_nodes = *(t8_locidx_t *) num_nodes;
-  /* The node parameter stores a node structure */
-  Node = (t8_msh_file_node_t *) node;
-  /* The hash value of the node is its index modulo the number of nodes */
-  return Node->index % Num_nodes;
-}
-
-/* Returns true if two given nodes are the same.
- * False otherwise.
- * Two nodes are considered equal if their indices are the same.
- * u_data is not needed.
- */
+/* Compare two nodes by their indices. */
 static int
-t8_msh_file_node_compare (const void *node_a, const void *node_b,
-                          const void *u_data)
+t8_msh_file_node_compare (const void *node_a, const void *node_b)
 {
-  t8_msh_file_node_t *Node_a, *Node_b;
+  const t8_msh_file_node_t *Node_a = (const t8_msh_file_node_t *) node_a;
+  const t8_msh_file_node_t *Node_b = (const t8_msh_file_node_t *) node_b;
 
-  Node_a = (t8_msh_file_node_t *) node_a;
-  Node_b = (t8_msh_file_node_t *) node_b;
+  return Node_a->index < Node_b->index ? -1 : Node_a->index > Node_b->index;
+}
 
-  return Node_a->index == Node_b->index;
+/* Find a node in an array of nodes sorted by their indices.
+ * \param [in]  nodes   The sorted array of nodes.
+ * \param [in]  index   The index of the node to find.
+ * \return              The node with index \a index or NULL if it does
+ *                      not exist.
+ */
+static t8_msh_file_node_t *
+t8_msh_file_node_lookup (sc_array_t * nodes, long index)
+{
+  t8_msh_file_node_t *first, key;
+  ssize_t             position;
+  long                offset;
+
+  if (nodes->elem_count == 0) {
+    return NULL;
+  }
+  first = (t8_msh_file_node_t *) sc_array_index (nodes, 0);
+  offset = index - first->index;
+  /* If the indices are dense, the node is at position offset */
+  if (offset >= 0 && (size_t) offset < nodes->elem_count
+      && first[offset].index == index) {
+    return first + offset;
+  }
+  key.index = index;
+  position = sc_array_bsearch (nodes, &key, t8_msh_file_node_compare);
+  return position < 0 ? NULL : first + position;
 }
 
-/* Reads an open msh-file and checks whether the MeshFormat-Version is supported by t8code or not. */
+/* Reads an open msh-file and checks whether the MeshFormat-Version is supported by t8code or not.
+ * Returns 1 for a supported ASCII file, 2 for a supported binary file,
+ * 0 for an unsupported version and -1 on read error.
+ * For a binary file, fp is left directly after the MeshFormat line. */
 static int
 t8_cmesh_check_version_of_msh_file (FILE * fp)
 {
@@ -182,7 +188,7 @@ t8_cmesh_check_version_of_msh_file (FILE * fp)
   size_t              linen = 1024;
   int                 retval;
   int                 version_number, sub_version_number;
-  int                 check_format;
+  int                 check_format, data_size;
 
   T8_ASSERT (fp != NULL);
 
@@ -206,20 +212,30 @@ t8_cmesh_check_version_of_msh_file (FILE * fp)
   (void) t8_cmesh_msh_read_next_line (&line, &linen, fp);
   /* Get the MeshFormat number of the file */
   retval =
-    sscanf (line, "%d.%d %d", &version_number, &sub_version_number,
-            &check_format);
+    sscanf (line, "%d.%d %d %d", &version_number, &sub_version_number,
+            &check_format, &data_size);
 
   /*Checking for read/write error. */
-  if (retval != 3) {
+  if (retval < 3) {
     t8_debugf ("Reading of the MeshFormat-number failed.\n");
     goto die_format;
   }
 
   /* Checks if the file is of Binary-type. */
   if (check_format) {
+    /* We only support binary files of version 4.1 whose size_t
+     * matches ours. */
+    if (retval == 4 && version_number == T8_CMESH_SUPPORTED_BINARY_FILE_VERSION
+        && sub_version_number == 1 && data_size == (int) sizeof (size_t)) {
+      t8_debugf ("This binary msh-file (%d.%d) is supported.\n",
+                 version_number, sub_version_number);
+      free (line);
+      return 2;
+    }
     t8_global_errorf
-      ("Incompatible file-type. t8code works with ASCII-type msh-files of version %d.\n",
-       T8_CMESH_SUPPORTED_FILE_VERSION);
+      ("Incompatible file-type. t8code works with ASCII-type msh-files of version %d and binary msh-files of version %d.1.\n",
+       T8_CMESH_SUPPORTED_FILE_VERSION,
+       T8_CMESH_SUPPORTED_BINARY_FILE_VERSION);
     goto die_format;
   }
 
@@ -246,19 +262,20 @@ die_format:
   return -1;
 }
 
-/* Read an open .msh file and parse the nodes into a hash table.
+/* Read an open .msh file and parse the nodes into an array sorted by
+ * their indices, see t8_msh_file_node_lookup.
+ * Returns NULL on failure.
  */
-static sc_hash_t   *
-t8_msh_file_read_nodes (FILE * fp, t8_locidx_t * num_nodes,
-                        sc_mempool_t ** node_mempool)
+static sc_array_t  *
+t8_msh_file_read_nodes (FILE * fp)
 {
   t8_msh_file_node_t *Node;
-  sc_hash_t          *node_table = NULL;
-  t8_locidx_t         ln, last_index;
+  sc_array_t         *nodes = NULL;
+  t8_locidx_t         ln, num_nodes, last_index;
   char               *line = (char *) malloc (1024);
   char                first_word[2048] = "\0";
   size_t              linen = 1024;
-  int                 retval;
+  int                 retval, is_sorted;
   long                index, lnum_nodes;
 
   T8_ASSERT (fp != NULL);
@@ -289,19 +306,17 @@ t8_msh_file_read_nodes (FILE * fp, t8_locidx_t * num_nodes,
     t8_debugf ("The line is %s", line);
     goto die_node;
   }
-  *num_nodes = lnum_nodes;
+  num_nodes = lnum_nodes;
   /* Check for type conversion error. */
-  T8_ASSERT (*num_nodes == lnum_nodes);
+  T8_ASSERT (num_nodes == lnum_nodes);
 
-  /* Create the mempool for the nodes */
-  *node_mempool = sc_mempool_new (sizeof (t8_msh_file_node_t));
-  /* Create the hash table */
-  node_table = sc_hash_new (t8_msh_file_node_hash, t8_msh_file_node_compare,
-                            num_nodes, NULL);
+  /* Allocate all nodes at once */
+  nodes = sc_array_new_count (sizeof (t8_msh_file_node_t), num_nodes);
 
-  /* read each node and add it to the hash table */
+  /* read each node and store it in the array */
   last_index = 0;
-  for (ln = 0; ln < *num_nodes; ln++) {
+  is_sorted = 1;
+  for (ln = 0; ln < num_nodes; ln++) {
     /* Read the next line. Its format should be %i %f %f %f
      * The node index followed by its coordinates. */
     retval = t8_cmesh_msh_read_next_line (&line, &linen, fp);
@@ -309,8 +324,7 @@ t8_msh_file_read_nodes (FILE * fp, t8_locidx_t * num_nodes,
       t8_global_errorf ("Error reading node file\n");
       goto die_node;
     }
-    /* Allocate a new node */
-    Node = (t8_msh_file_node_t *) sc_mempool_alloc (*node_mempool);
+    Node = (t8_msh_file_node_t *) t8_sc_array_index_locidx (nodes, ln);
     /* Fill the node with the entries in the file */
     retval = sscanf (line, "%li %lf %lf %lf", &index,
                      &Node->coordinates[0], &Node->coordinates[1],
@@ -323,26 +337,38 @@ t8_msh_file_read_nodes (FILE * fp, t8_locidx_t * num_nodes,
     Node->index = index;
     /* Check for type conversion error */
     T8_ASSERT (Node->index == index);
-    /* Insert the node in the hash table */
-    retval = sc_hash_insert_unique (node_table, Node, NULL);
-    /* If retval is zero then the node was already in the hash table.
-     * This case should not occur. */
-    T8_ASSERT (retval);
+    if (ln > 0 && Node->index <= last_index) {
+      is_sorted = 0;
+    }
     last_index = Node->index;
   }
+  /* Usually the nodes are stored in order, so we only sort if needed */
+  if (!is_sorted) {
+    sc_array_sort (nodes, t8_msh_file_node_compare);
+  }
+  /* Node indices must be unique */
+  for (ln = 1; ln < num_nodes; ln++) {
+    if (((t8_msh_file_node_t *) t8_sc_array_index_locidx (nodes, ln))->index
+        == ((t8_msh_file_node_t *)
+            t8_sc_array_index_locidx (nodes, ln - 1))->index) {
+      t8_global_errorf ("Node index %li appears twice in the file\n",
+                        (long) ((t8_msh_file_node_t *)
+                                t8_sc_array_index_locidx (nodes,
+                                                          ln))->index);
+      goto die_node;
+    }
+  }
 
   free (line);
   t8_debugf ("Successfully read all Nodes.\n");
-  return node_table;
+  return nodes;
   /* If everything went well, the function ends here. */
 
   /* This code is execute when a read/write error occurs */
 die_node:
-  /* If we allocated the hash table, destroy it */
-  if (node_table != NULL) {
-    sc_hash_destroy (node_table);
-    sc_mempool_destroy (*node_mempool);
-    node_mempool = NULL;
+  /* If we allocated the nodes, destroy them */
+  if (nodes != NULL) {
+    sc_array_destroy (nodes);
   }
   /* Free memory */
   free (line);
@@ -350,13 +376,83 @@ die_node:
   return NULL;
 }
 
+/* Detect a negative volume of a tree given by its vertices and correct it
+ * by switching vertices.
+ * For tets we switch 0 and 3.
+ * For prisms we switch 0 and 3, 1 and 4, 2 and 5.
+ * For hexahedra we switch 0 and 4, 1 and 5, 2 and 6, 3 and 7.
+ * For pyramids we switch 0 and 4
+ * If \a vertex_indices is not NULL, the same vertices are switched in it. */
+static void
+t8_cmesh_msh_file_correct_volume (t8_eclass_t eclass, double *tree_vertices,
+                                  long *vertex_indices, int num_nodes,
+                                  t8_gloidx_t tree_id)
+{
+  double              temp;
+  long                temp_index;
+  int                 num_switches = 0;
+  int                 switch_indices[4] = { 0 };
+  int                 iswitch, i;
+
+  if (!t8_cmesh_tree_vertices_negative_volume (eclass, tree_vertices,
+                                               num_nodes)) {
+    return;
+  }
+  /* The volume described is negative. We need to change vertices. */
+  T8_ASSERT (t8_eclass_to_dimension[eclass] == 3);
+  t8_debugf ("Correcting negative volume of tree %li\n", (long) tree_id);
+  switch (eclass) {
+  case T8_ECLASS_TET:
+    /* We switch vertex 0 and vertex 3 */
+    num_switches = 1;
+    switch_indices[0] = 3;
+    break;
+  case T8_ECLASS_PRISM:
+    num_switches = 3;
+    switch_indices[0] = 3;
+    switch_indices[1] = 4;
+    switch_indices[2] = 5;
+    break;
+  case T8_ECLASS_HEX:
+    num_switches = 4;
+    switch_indices[0] = 4;
+    switch_indices[1] = 5;
+    switch_indices[2] = 6;
+    switch_indices[3] = 7;
+    break;
+  case T8_ECLASS_PYRAMID:
+    num_switches = 1;
+    switch_indices[0] = 4;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+
+  for (iswitch = 0; iswitch < num_switches; ++iswitch) {
+    /* We switch vertex 0 + iswitch and vertex switch_indices[iswitch] */
+    for (i = 0; i < 3; i++) {
+      temp = tree_vertices[3 * iswitch + i];
+      tree_vertices[3 * iswitch + i] =
+        tree_vertices[3 * switch_indices[iswitch] + i];
+      tree_vertices[3 * switch_indices[iswitch] + i] = temp;
+    }
+    if (vertex_indices != NULL) {
+      temp_index = vertex_indices[iswitch];
+      vertex_indices[iswitch] = vertex_indices[switch_indices[iswitch]];
+      vertex_indices[switch_indices[iswitch]] = temp_index;
+    }
+  }
+  T8_ASSERT (!t8_cmesh_tree_vertices_negative_volume
+             (eclass, tree_vertices, num_nodes));
+}
+
 /* fp should be set after the Nodes section, right before the tree section.
  * If vertex_indices is not NULL, it is allocated and will store
  * for each tree the indices of its vertices.
  * They are stored as arrays of long ints. */
 int
 t8_cmesh_msh_file_read_eles (t8_cmesh_t cmesh, FILE * fp,
-                             sc_hash_t * vertices,
+                             sc_array_t * vertices,
                              sc_array_t ** vertex_indices, int dim)
 {
   char               *line = (char *) malloc (1024), *line_modify;
@@ -365,7 +461,7 @@ t8_cmesh_msh_file_read_eles (t8_cmesh_t cmesh, FILE * fp,
   t8_locidx_t         num_trees, tree_loop;
   t8_gloidx_t         tree_count;
   t8_eclass_t         eclass;
-  t8_msh_file_node_t  Node, **found_node;
+  t8_msh_file_node_t *found_node;
   long                lnum_trees;
   int                 retval, i;
   int                 ele_type, num_tags;
@@ -463,67 +559,21 @@ t8_cmesh_msh_file_read_eles (t8_cmesh_t cmesh, FILE * fp,
       /* Now the nodes are read and we get their coordinates from
        * the stored nodes */
       for (i = 0; i < num_nodes; i++) {
-        Node.index = node_indices[i];
-        sc_hash_lookup (vertices, (void *) &Node, (void ***) &found_node);
+        found_node = t8_msh_file_node_lookup (vertices, node_indices[i]);
+        if (found_node == NULL) {
+          t8_global_errorf ("Node %li of tree %li does not exist.\n",
+                            node_indices[i], (long) tree_count);
+          goto die_ele;
+        }
         /* Add node coordinates to the tree vertices */
         t8_vertex_num = t8_msh_tree_vertex_to_t8_vertex_num[eclass][i];
-        tree_vertices[3 * t8_vertex_num] = (*found_node)->coordinates[0];
-        tree_vertices[3 * t8_vertex_num + 1] = (*found_node)->coordinates[1];
-        tree_vertices[3 * t8_vertex_num + 2] = (*found_node)->coordinates[2];
+        tree_vertices[3 * t8_vertex_num] = found_node->coordinates[0];
+        tree_vertices[3 * t8_vertex_num + 1] = found_node->coordinates[1];
+        tree_vertices[3 * t8_vertex_num + 2] = found_node->coordinates[2];
       }
       /* Detect and correct negative volumes */
-      if (t8_cmesh_tree_vertices_negative_volume (eclass, tree_vertices,
-                                                  num_nodes)) {
-        /* The volume described is negative. We need to change vertices.
-         * For tets we switch 0 and 3.
-         * For prisms we switch 0 and 3, 1 and 4, 2 and 5.
-         * For hexahedra we switch 0 and 4, 1 and 5, 2 and 6, 3 and 7.
-         * For pyramids we switch 0 and 4 */
-        double              temp;
-        int                 num_switches = 0;
-        int                 switch_indices[4] = { 0 };
-        int                 iswitch;
-        T8_ASSERT (t8_eclass_to_dimension[eclass] == 3);
-        t8_debugf ("Correcting negative volume of tree %li\n", tree_count);
-        switch (eclass) {
-        case T8_ECLASS_TET:
-          /* We switch vertex 0 and vertex 3 */
-          num_switches = 1;
-          switch_indices[0] = 3;
-          break;
-        case T8_ECLASS_PRISM:
-          num_switches = 3;
-          switch_indices[0] = 3;
-          switch_indices[1] = 4;
-          switch_indices[2] = 5;
-          break;
-        case T8_ECLASS_HEX:
-          num_switches = 4;
-          switch_indices[0] = 4;
-          switch_indices[1] = 5;
-          switch_indices[2] = 6;
-          switch_indices[3] = 7;
-          break;
-        case T8_ECLASS_PYRAMID:
-          num_switches = 1;
-          switch_indices[0] = 4;
-          break;
-        default:
-          SC_ABORT_NOT_REACHED ();
-        }
-
-        for (iswitch = 0; iswitch < num_switches; ++iswitch) {
-          /* We switch vertex 0 + iswitch and vertex switch_indices[iswitch] */
-          for (i = 0; i < 3; i++) {
-            temp = tree_vertices[3 * iswitch + i];
-            tree_vertices[3 * iswitch + i] =
-              tree_vertices[3 * switch_indices[iswitch] + i];
-            tree_vertices[3 * switch_indices[iswitch] + i] = temp;
-          }
-        }
-        T8_ASSERT (!t8_cmesh_tree_vertices_negative_volume
-                   (eclass, tree_vertices, num_nodes));
-      }                         /* End of negative volume handling */
+      t8_cmesh_msh_file_correct_volume (eclass, tree_vertices, NULL,
+                                        num_nodes, tree_count);
       /* Set the vertices of this tree */
       t8_cmesh_set_tree_vertices (cmesh, tree_count, t8_get_package_id (),
                                   0, tree_vertices, num_nodes);
@@ -552,99 +602,332 @@ die_ele:
   return -1;
 }
 
-/* This struct stores all information associated to a tree's face.
- * We need it to find neighbor trees.
- */
-typedef struct
+/* Read count entries of size size from fp into data.
+ * Returns true on success and false if the file ended before. */
+static int
+t8_msh_file_binary_read (FILE * fp, void *data, size_t size, size_t count)
 {
-  t8_locidx_t         ltree_id; /* The local id of the tree this face belongs to */
-  int8_t              face_number;      /* The number of that face whitin the tree */
-  int                 num_vertices;     /* The number of vertices of this face. */
-  long               *vertices; /* The indices of these vertices. */
-} t8_msh_file_face_t;
+  return fread (data, size, count, fp) == count;
+}
+
+/* Read the header of a binary entity block that consists of three ints
+ * and one size_t. */
+static int
+t8_msh_file_binary_read_block_header (FILE * fp, int header[3],
+                                      size_t *num_entries)
+{
+  return t8_msh_file_binary_read (fp, header, sizeof (int), 3)
+    && t8_msh_file_binary_read (fp, num_entries, sizeof (size_t), 1);
+}
 
-/* Hash a face. The hash value is the sum of its vertex indices */
-static unsigned
-t8_msh_file_face_hash (const void *face, const void *data)
+/* Skip the binary $Entities section. fp must be set directly after the
+ * line $Entities. The section stores the points, curves, surfaces and
+ * volumes. A point consists of its tag, its coordinates and its physical
+ * tags. The other entities store a bounding box instead of the coordinates
+ * and additionally the tags of their bounding entities. */
+static int
+t8_msh_file_binary_skip_entities (FILE * fp)
 {
-  t8_msh_file_face_t *Face;
-  int                 iv;
-  long                sum = 0;
+  size_t              num_entities[4], num_tags, ientity;
+  int                 idim, itags;
+  long                skip;
 
-  Face = (t8_msh_file_face_t *) face;
-  for (iv = 0; iv < Face->num_vertices; iv++) {
-    sum += Face->vertices[iv];
+  if (!t8_msh_file_binary_read (fp, num_entities, sizeof (size_t), 4)) {
+    return 0;
   }
-  T8_ASSERT (sum >= 0);
-  return (unsigned) sum;
+  for (idim = 0; idim < 4; idim++) {
+    for (ientity = 0; ientity < num_entities[idim]; ientity++) {
+      /* Skip the tag and the coordinates or bounding box */
+      skip = sizeof (int) + (idim == 0 ? 3 : 6) * sizeof (double);
+      /* Points only have physical tags, all other entities have
+       * physical tags and bounding entities. */
+      for (itags = 0; itags < (idim == 0 ? 1 : 2); itags++) {
+        if (fseek (fp, skip, SEEK_CUR)
+            || !t8_msh_file_binary_read (fp, &num_tags, sizeof (size_t), 1)) {
+          return 0;
+        }
+        skip = num_tags * sizeof (int);
+      }
+      if (fseek (fp, skip, SEEK_CUR)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
 }
 
-/* Two face are considered equal if they have the same vertices up
- * to renumeration. */
+/* Read the binary $Nodes section of a version 4.1 file. fp must be set
+ * directly after the line $Nodes.
+ * Since the node tags of version 4 files are usually consecutive, we store
+ * the coordinates in an array indexed by the tag minus the minimal tag.
+ * Each entity block is read with one call for the tags and one call for the
+ * coordinates.
+ * On success, *node_coords stores the 3 coordinates of each tag in the range
+ * [*min_tag, *max_tag] and *node_found is true for each tag in the file. */
 static int
-t8_msh_file_face_equal (const void *facea, const void *faceb,
-                        const void *data)
-{
-  int                 iv, jv, ret;
-  long                vertex;
-  t8_msh_file_face_t *Face_a, *Face_b;
-
-  Face_a = (t8_msh_file_face_t *) facea;
-  Face_b = (t8_msh_file_face_t *) faceb;
-  /* If both have different number of vertices they can't be equal */
-  ret = Face_a->num_vertices == Face_b->num_vertices;
-  if (!ret) {
-    return 0;
+t8_msh_file_binary_read_nodes (FILE * fp, double **node_coords,
+                               char **node_found, size_t *min_tag,
+                               size_t *max_tag)
+{
+  size_t              header[4], num_block_nodes, iblock, inode, tag;
+  size_t              stride;
+  int                 block_header[3];
+  sc_array_t          tags, coords;
+  double             *coord;
+
+  *node_coords = NULL;
+  *node_found = NULL;
+  /* The header is the number of blocks, the number of nodes and
+   * the minimal and maximal node tag. */
+  if (!t8_msh_file_binary_read (fp, header, sizeof (size_t), 4)) {
+    t8_global_errorf ("Premature end of file while reading num nodes.\n");
+    return -1;
+  }
+  *min_tag = header[2];
+  *max_tag = header[3];
+  if (header[1] == 0 || *max_tag < *min_tag) {
+    t8_global_errorf ("The msh-file does not contain any nodes.\n");
+    return -1;
   }
-  /* Check for each vertex of Face_a whether it is a vertex
-   * of Face_b */
-  for (iv = 0; iv < Face_a->num_vertices; iv++) {
-    vertex = Face_a->vertices[iv];
-    ret = 0;
-    for (jv = 0; jv < Face_b->num_vertices; jv++) {
-      ret |= vertex == Face_b->vertices[jv];
+  *node_coords = T8_ALLOC (double, 3 * (*max_tag - *min_tag + 1));
+  *node_found = T8_ALLOC_ZERO (char, *max_tag - *min_tag + 1);
+  sc_array_init (&tags, sizeof (size_t));
+  sc_array_init (&coords, sizeof (double));
+
+  for (iblock = 0; iblock < header[0]; iblock++) {
+    /* The block header is the entity dimension, the entity tag, whether
+     * parametric coordinates are stored and the number of nodes. */
+    if (!t8_msh_file_binary_read_block_header (fp, block_header,
+                                               &num_block_nodes)) {
+      goto die_binary_node;
     }
-    /* if vertex was a vertex of Face_b then ret is true here */
-    if (!ret) {
-      return 0;
+    /* Parametric nodes store as many additional coordinates
+     * as the dimension of their entity */
+    stride = 3 + (block_header[2] ? block_header[0] : 0);
+    sc_array_resize (&tags, num_block_nodes);
+    sc_array_resize (&coords, stride * num_block_nodes);
+    if (!t8_msh_file_binary_read (fp, tags.array, sizeof (size_t),
+                                  num_block_nodes)
+        || !t8_msh_file_binary_read (fp, coords.array, sizeof (double),
+                                     stride * num_block_nodes)) {
+      goto die_binary_node;
+    }
+    for (inode = 0; inode < num_block_nodes; inode++) {
+      tag = ((size_t *) tags.array)[inode];
+      if (tag < *min_tag || tag > *max_tag) {
+        t8_global_errorf ("Node tag %lu is out of range.\n",
+                          (unsigned long) tag);
+        goto die_binary_node;
+      }
+      coord = (double *) coords.array + stride * inode;
+      memcpy (*node_coords + 3 * (tag - *min_tag), coord,
+              3 * sizeof (double));
+      (*node_found)[tag - *min_tag] = 1;
     }
   }
-  return 1;
+  sc_array_reset (&tags);
+  sc_array_reset (&coords);
+  t8_debugf ("Successfully read all Nodes.\n");
+  return 0;
+
+die_binary_node:
+  t8_global_errorf ("Error reading the binary nodes.\n");
+  sc_array_reset (&tags);
+  sc_array_reset (&coords);
+  T8_FREE (*node_coords);
+  T8_FREE (*node_found);
+  *node_coords = NULL;
+  *node_found = NULL;
+  return -1;
 }
 
-/* We use this function in a loop over all elements
- * in the hash table, to free the memory of the vertices array */
+/* Read the binary $Elements section of a version 4.1 file and add all
+ * elements of dimension dim to the cmesh as trees. fp must be set directly
+ * after the line $Elements.
+ * Each entity block of the correct dimension is read with a single call,
+ * the blocks of other dimensions are skipped.
+ * vertex_indices stores, as in t8_cmesh_msh_file_read_eles, the vertex
+ * indices of each tree. */
 static int
-t8_msh_file_face_free (void **face, const void *data)
+t8_msh_file_binary_read_eles (t8_cmesh_t cmesh, FILE * fp,
+                              const double *node_coords,
+                              const char *node_found, size_t min_tag,
+                              size_t max_tag, sc_array_t * vertex_indices,
+                              int dim)
 {
-  t8_msh_file_face_t *Face;
+  size_t              header[4], num_block_eles, iblock, iele, tag;
+  size_t             *ele_data;
+  int                 block_header[3];
+  int                 ele_type, num_nodes, i, t8_vertex_num;
+  t8_eclass_t         eclass;
+  t8_gloidx_t         tree_count = 0;
+  long               *stored_indices;
+  double              tree_vertices[24];
+  sc_array_t          buffer;
 
-  Face = *(t8_msh_file_face_t **) face;
-  T8_FREE (Face->vertices);
-  return 1;
+  /* The header is the number of blocks, the number of elements and
+   * the minimal and maximal element tag. */
+  if (!t8_msh_file_binary_read (fp, header, sizeof (size_t), 4)) {
+    t8_global_errorf ("Premature end of file while reading num trees.\n");
+    return -1;
+  }
+  sc_array_init (&buffer, sizeof (size_t));
+  for (iblock = 0; iblock < header[0]; iblock++) {
+    /* The block header is the entity dimension, the entity tag,
+     * the element type and the number of elements. */
+    if (!t8_msh_file_binary_read_block_header (fp, block_header,
+                                               &num_block_eles)) {
+      goto die_binary_ele;
+    }
+    ele_type = block_header[2];
+    /* Check if the tree type is supported */
+    if (ele_type > T8_NUM_GMSH_ELEM_CLASSES || ele_type < 0
+        || t8_msh_tree_type_to_eclass[ele_type] == T8_ECLASS_COUNT) {
+      t8_global_errorf ("tree type %i is not supported by t8code.\n",
+                        ele_type);
+      goto die_binary_ele;
+    }
+    eclass = t8_msh_tree_type_to_eclass[ele_type];
+    num_nodes = t8_eclass_num_vertices[eclass];
+    if (t8_eclass_to_dimension[eclass] != dim) {
+      /* Skip the block. Each element stores its tag and its nodes. */
+      if (fseek (fp, (long) (num_block_eles * (1 + num_nodes)
+                             * sizeof (size_t)), SEEK_CUR)) {
+        goto die_binary_ele;
+      }
+      continue;
+    }
+    sc_array_resize (&buffer, num_block_eles * (1 + num_nodes));
+    if (!t8_msh_file_binary_read (fp, buffer.array, sizeof (size_t),
+                                  buffer.elem_count)) {
+      goto die_binary_ele;
+    }
+    for (iele = 0; iele < num_block_eles; iele++) {
+      /* Skip the element tag */
+      ele_data = (size_t *) buffer.array + iele * (1 + num_nodes) + 1;
+      for (i = 0; i < num_nodes; i++) {
+        tag = ele_data[i];
+        if (tag < min_tag || tag > max_tag || !node_found[tag - min_tag]) {
+          t8_global_errorf ("Node %lu of tree %li does not exist.\n",
+                            (unsigned long) tag, (long) tree_count);
+          goto die_binary_ele;
+        }
+        /* Add node coordinates to the tree vertices */
+        t8_vertex_num = t8_msh_tree_vertex_to_t8_vertex_num[eclass][i];
+        memcpy (tree_vertices + 3 * t8_vertex_num,
+                node_coords + 3 * (tag - min_tag), 3 * sizeof (double));
+      }
+      t8_cmesh_set_tree_class (cmesh, tree_count, eclass);
+      /* Detect and correct negative volumes */
+      t8_cmesh_msh_file_correct_volume (eclass, tree_vertices, NULL,
+                                        num_nodes, tree_count);
+      t8_cmesh_set_tree_vertices (cmesh, tree_count, t8_get_package_id (),
+                                  0, tree_vertices, num_nodes);
+      /* Store the node indices in t8code order */
+      stored_indices = T8_ALLOC (long, num_nodes);
+      for (i = 0; i < num_nodes; i++) {
+        stored_indices[i] =
+          (long) ele_data[t8_vertex_to_msh_vertex_num[eclass][i]];
+      }
+      *(long **) sc_array_push (vertex_indices) = stored_indices;
+      tree_count++;
+    }
+  }
+  sc_array_reset (&buffer);
+  return 0;
+
+die_binary_ele:
+  t8_global_errorf ("Error reading the binary trees.\n");
+  sc_array_reset (&buffer);
+  return -1;
 }
 
-/* Given a face and a cmesh set the face as a domain boundary.
- * We use this function in a loop over all hashed faces.
- */
+/* Read a binary msh-file of version 4.1 and add its trees to the cmesh.
+ * fp must be set directly after the MeshFormat line.
+ * The sections are read in order until the $Elements section is found.
+ * On success, *vertex_indices is allocated and stores for each tree the
+ * indices of its vertices. Returns 0 on success and -1 on failure. */
 static int
-t8_msh_file_face_set_boundary (void **face, const void *data)
+t8_cmesh_msh_file_read_binary (t8_cmesh_t cmesh, FILE * fp,
+                               sc_array_t ** vertex_indices, int dim)
 {
-  t8_msh_file_face_t *Face;
-  t8_cmesh_t          cmesh;
-  t8_gloidx_t         gtree_id;
+  char               *line = (char *) malloc (1024);
+  char                first_word[2048] = "\0";
+  char                end_word[2048];
+  size_t              linen = 1024, min_tag = 0, max_tag = 0;
+  double             *node_coords = NULL;
+  char               *node_found = NULL;
+  int                 one, retval = -1, found_elements = 0;
 
-  cmesh = (t8_cmesh_t) data;
-  Face = *(t8_msh_file_face_t **) face;
+  T8_ASSERT (fp != NULL);
+  *vertex_indices = sc_array_new (sizeof (long *));
+  /* The MeshFormat line is followed by the binary integer 1 to detect
+   * the endianness. */
+  if (!t8_msh_file_binary_read (fp, &one, sizeof (int), 1) || one != 1) {
+    t8_global_errorf ("The binary msh-file has a different endianness.\n");
+    goto die_binary;
+  }
+  while (t8_cmesh_msh_read_next_line (&line, &linen, fp) >= 0) {
+    if (sscanf (line, "%2047s", first_word) != 1) {
+      continue;
+    }
+    if (!strcmp (first_word, "$Entities")) {
+      if (!t8_msh_file_binary_skip_entities (fp)) {
+        t8_global_errorf ("Error reading the binary entities.\n");
+        goto die_binary;
+      }
+    }
+    else if (!strcmp (first_word, "$Nodes")) {
+      if (node_coords != NULL
+          || t8_msh_file_binary_read_nodes (fp, &node_coords, &node_found,
+                                            &min_tag, &max_tag)) {
+        goto die_binary;
+      }
+    }
+    else if (!strcmp (first_word, "$Elements")) {
+      if (node_coords == NULL) {
+        t8_global_errorf ("The elements are stored before the nodes.\n");
+        goto die_binary;
+      }
+      found_elements = 1;
+      retval = t8_msh_file_binary_read_eles (cmesh, fp, node_coords,
+                                             node_found, min_tag, max_tag,
+                                             *vertex_indices, dim);
+      break;
+    }
+    else if (first_word[0] == '$' && strncmp (first_word, "$End", 4)) {
+      /* Skip any other section until its end */
+      snprintf (end_word, 2048, "$End%s", first_word + 1);
+      while (strcmp (first_word, end_word)
+             && t8_cmesh_msh_read_next_line (&line, &linen, fp) >= 0) {
+        if (sscanf (line, "%2047s", first_word) != 1) {
+          first_word[0] = '\0';
+        }
+      }
+    }
+  }
+  if (!found_elements) {
+    t8_global_errorf ("The msh-file does not contain any elements.\n");
+  }
 
-  /* Get the global tree id */
-  gtree_id = Face->ltree_id;
-  /* Set the Face as a domain boundary */
-  t8_cmesh_set_join (cmesh, gtree_id, gtree_id, Face->face_number,
-                     Face->face_number, 0);
-  return 1;
+die_binary:
+  free (line);
+  T8_FREE (node_coords);
+  T8_FREE (node_found);
+  return retval;
 }
 
+/* This struct stores all information associated to a tree's face.
+ * We need it to compute the orientation of a face connection.
+ */
+typedef struct
+{
+  t8_locidx_t         ltree_id; /* The local id of the tree this face belongs to */
+  int8_t              face_number;      /* The number of that face whitin the tree */
+  int                 num_vertices;     /* The number of vertices of this face. */
+  long               *vertices; /* The indices of these vertices. */
+} t8_msh_file_face_t;
+
 /* Given two faces and the classes of their volume trees,
  * compute the orientation of the faces to each other */
 static int
@@ -704,34 +987,160 @@ t8_msh_file_face_orientation (t8_msh_file_face_t * Face_a,
   return orientation;
 }
 
+/* A tree face as it is matched with the faces of the other trees.
+ * The parallel reader sends it to the process that matches it with the
+ * face of the neighbor tree. */
+typedef struct
+{
+  long                key[4];   /* The sorted vertex indices, unused entries are -1 */
+  long                vertices[4];      /* The vertex indices in face order */
+  t8_gloidx_t         gtree_id; /* The global id of the tree */
+  int                 mpirank;  /* The process of the tree */
+  int8_t              face_number;      /* The number of the face in the tree */
+  int8_t              num_vertices;     /* The number of vertices of the face */
+  int8_t              eclass;   /* The class of the tree */
+} t8_msh_file_pface_t;
+
+/* Compare two faces by their sorted vertices */
+static int
+t8_msh_file_pface_compare (const void *a, const void *b)
+{
+  const t8_msh_file_pface_t *face_a = (const t8_msh_file_pface_t *) a;
+  const t8_msh_file_pface_t *face_b = (const t8_msh_file_pface_t *) b;
+  int                 iv;
+
+  for (iv = 0; iv < 4; iv++) {
+    if (face_a->key[iv] != face_b->key[iv]) {
+      return face_a->key[iv] < face_b->key[iv] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/* Fill a face of a tree.
+ * \param [out] face         The face to fill.
+ * \param [in]  tree_indices The vertex indices of the tree in t8code order.
+ * \param [in]  eclass       The class of the tree.
+ * \param [in]  face_number  The number of the face in the tree.
+ * \param [in]  gtree_id     The global id of the tree.
+ * \param [in]  mpirank      The process of the tree.
+ */
+static void
+t8_msh_file_pface_init (t8_msh_file_pface_t * face,
+                        const long *tree_indices, t8_eclass_t eclass,
+                        int face_number, t8_gloidx_t gtree_id, int mpirank)
+{
+  t8_eclass_t         face_class;
+  long                temp;
+  int                 iv, jv;
+
+  memset (face, 0, sizeof (*face));
+  face_class = (t8_eclass_t) t8_eclass_face_types[eclass][face_number];
+  face->num_vertices = t8_eclass_num_vertices[face_class];
+  for (iv = 0; iv < 4; iv++) {
+    face->key[iv] = face->vertices[iv] = -1;
+  }
+  for (iv = 0; iv < face->num_vertices; iv++) {
+    face->vertices[iv] = face->key[iv] =
+      tree_indices[t8_face_vertex_to_tree_vertex[eclass][face_number][iv]];
+  }
+  /* Sort the vertices with insertion sort to obtain the key */
+  for (iv = 1; iv < face->num_vertices; iv++) {
+    for (jv = iv; jv > 0 && face->key[jv - 1] > face->key[jv]; jv--) {
+      temp = face->key[jv];
+      face->key[jv] = face->key[jv - 1];
+      face->key[jv - 1] = temp;
+    }
+  }
+  face->gtree_id = gtree_id;
+  face->mpirank = mpirank;
+  face->face_number = face_number;
+  face->eclass = eclass;
+}
+
+/* Sort an array of faces by their keys with a least significant digit
+ * radix sort. This gives the same order as sorting with
+ * t8_msh_file_pface_compare, but in linear time.
+ * We sort byte wise, starting with the last key entry. Since the
+ * vertex indices are usually much smaller than the range of a long,
+ * we skip the bytes that are zero for all faces. */
+static void
+t8_msh_file_pface_radix_sort (sc_array_t * faces)
+{
+  const size_t        num_faces = faces->elem_count;
+  size_t              count[257], iface;
+  unsigned long       max_digit, digit;
+  t8_msh_file_pface_t *src, *dest, *temp;
+  int                 ikey;
+  unsigned            shift;
+
+  if (num_faces < 2) {
+    return;
+  }
+  src = (t8_msh_file_pface_t *) faces->array;
+  dest = T8_ALLOC (t8_msh_file_pface_t, num_faces);
+  for (ikey = 3; ikey >= 0; ikey--) {
+    /* Unused key entries are -1, we shift all entries by one to
+     * obtain non-negative digits. */
+    max_digit = 0;
+    for (iface = 0; iface < num_faces; iface++) {
+      max_digit = SC_MAX (max_digit, (unsigned long) (src[iface].key[ikey]
+                                                      + 1));
+    }
+    for (shift = 0; shift < 8 * sizeof (long) && (max_digit >> shift) > 0;
+         shift += 8) {
+      memset (count, 0, sizeof (count));
+      for (iface = 0; iface < num_faces; iface++) {
+        digit = ((unsigned long) (src[iface].key[ikey] + 1) >> shift) & 0xff;
+        count[digit + 1]++;
+      }
+      for (digit = 1; digit < 257; digit++) {
+        count[digit] += count[digit - 1];
+      }
+      /* Stable placement of each face at the position of its digit */
+      for (iface = 0; iface < num_faces; iface++) {
+        digit = ((unsigned long) (src[iface].key[ikey] + 1) >> shift) & 0xff;
+        dest[count[digit]++] = src[iface];
+      }
+      temp = src;
+      src = dest;
+      dest = temp;
+    }
+  }
+  /* After an odd number of passes the result is in the buffer */
+  if (src != (t8_msh_file_pface_t *) faces->array) {
+    memcpy (faces->array, src, num_faces * sizeof (t8_msh_file_pface_t));
+    dest = src;
+  }
+  T8_FREE (dest);
+}
+
 /* Given the number of vertices and for each element a list of its
- * vertices, find the neighborship relations of each element */
+ * vertices, find the neighborship relations of each element.
+ * We collect all faces of all trees in one array and sort it by the face
+ * vertices. Matching faces are then adjacent in the array. */
 /* This routine does only find neighbors between local trees.
  * Use with care if cmesh is partitioned. */
 static void
 t8_cmesh_msh_file_find_neighbors (t8_cmesh_t cmesh,
                                   sc_array_t * vertex_indices)
 {
-  sc_hash_t          *faces;
-  t8_msh_file_face_t *Face, **pNeighbor, *Neighbor;
-  sc_mempool_t       *face_mempool;
+  sc_array_t          faces;
+  t8_msh_file_pface_t *face, *face_b;
+  t8_msh_file_face_t  Face_a, Face_b;
   t8_gloidx_t         gtree_it;
-  t8_gloidx_t         gtree_id, gtree_neighbor;
-  t8_eclass_t         eclass, face_class, neighbor_tclass;
-  int                 num_face_vertices, face_it, vertex_it;
-  int                 retval, orientation;
+  t8_eclass_t         eclass;
+  size_t              iface, num_faces;
+  int                 face_it, orientation;
   long               *tree_vertices;
   t8_stash_class_struct_t *class_entry;
 
-  face_mempool = sc_mempool_new (sizeof (t8_msh_file_face_t));
-  faces = sc_hash_new (t8_msh_file_face_hash, t8_msh_file_face_equal,
-                       cmesh, NULL);
-
   /* TODO: Does currently not work with partitioned cmesh */
   T8_ASSERT (!cmesh->set_partition);
   /* The cmesh is not allowed to be committed yet */
   T8_ASSERT (t8_cmesh_is_initialized (cmesh));
   t8_debugf ("Starting to find tree neighbors\n");
+  sc_array_init (&faces, sizeof (t8_msh_file_pface_t));
   /* Iterate over all local trees */
   for (gtree_it = 0;
        gtree_it < (t8_gloidx_t) cmesh->stash->classes.elem_count;
@@ -751,61 +1160,48 @@ t8_cmesh_msh_file_find_neighbors (t8_cmesh_t cmesh,
     /* Get the vertices of that tree */
     tree_vertices = *(long **) t8_sc_array_index_locidx (vertex_indices,
                                                          gtree_it);
-    /* loop over all faces of the tree */
+    /* Add all faces of the tree to the array */
     for (face_it = 0; face_it < t8_eclass_num_faces[eclass]; face_it++) {
-      /* Create the Face struct */
-      Face = (t8_msh_file_face_t *) sc_mempool_alloc (face_mempool);
-      /* Get its eclass and the number of vertices */
-      face_class = (t8_eclass_t) t8_eclass_face_types[eclass][face_it];
-      num_face_vertices = t8_eclass_num_vertices[face_class];
-      Face->vertices = T8_ALLOC (long, num_face_vertices);
-      Face->num_vertices = num_face_vertices;
-      Face->ltree_id = gtree_it;
-      Face->face_number = face_it;
-      /* Copy the vertices of the face to the face struct */
-      for (vertex_it = 0; vertex_it < num_face_vertices; vertex_it++) {
-        Face->vertices[vertex_it] =
-          tree_vertices[t8_face_vertex_to_tree_vertex[eclass][face_it]
-                        [vertex_it]];
-      }
-      /* Try to insert the face into the hash */
-      retval = sc_hash_insert_unique (faces, Face, (void ***) &pNeighbor);
-      if (!retval) {
-        /* The face was already in the hash */
-        Neighbor = *pNeighbor;
-        T8_ASSERT (Neighbor->ltree_id != gtree_it);
-        /* The current tree is a neighbor to the tree Neighbor->ltree_id */
-        /* We need to identify the face number and the orientation */
-        gtree_id = gtree_it;
-        gtree_neighbor = Neighbor->ltree_id;
-        /* Compute the orientation of the face connection */
-        /* Get the element class of the neighbor tree */
-        class_entry = (t8_stash_class_struct_t *)
-          t8_sc_array_index_locidx (&cmesh->stash->classes,
-                                    Neighbor->ltree_id);
-        T8_ASSERT (class_entry->id == Neighbor->ltree_id);
-        neighbor_tclass = class_entry->eclass;
-        /* Calculate the orientation */
-        orientation = t8_msh_file_face_orientation (Face, Neighbor, eclass,
-                                                    neighbor_tclass);
-        /* Set the face connection */
-        t8_cmesh_set_join (cmesh, gtree_id, gtree_neighbor, face_it,
-                           Neighbor->face_number, orientation);
-        T8_FREE (Face->vertices);
-        sc_mempool_free (face_mempool, Face);
-        /* We can free the neighbor here as well */
-        sc_hash_remove (faces, Neighbor, NULL);
-        T8_FREE (Neighbor->vertices);
-        sc_mempool_free (face_mempool, Neighbor);
-      }
-    }
-  }
-  /* The remaining faces are domain boundaries */
-  sc_hash_foreach (faces, t8_msh_file_face_set_boundary);
-  /* Free the faces and the hash */
-  sc_hash_foreach (faces, t8_msh_file_face_free);
-  sc_mempool_destroy (face_mempool);
-  sc_hash_destroy (faces);
+      t8_msh_file_pface_init ((t8_msh_file_pface_t *)
+                              sc_array_push (&faces), tree_vertices, eclass,
+                              face_it, gtree_it, 0);
+    }
+  }
+  t8_msh_file_pface_radix_sort (&faces);
+
+  /* Faces with the same vertices are neighbors,
+   * the remaining faces are domain boundaries. */
+  num_faces = faces.elem_count;
+  for (iface = 0; iface < num_faces; iface++) {
+    face = (t8_msh_file_pface_t *) sc_array_index (&faces, iface);
+    face_b = iface + 1 < num_faces ?
+      (t8_msh_file_pface_t *) sc_array_index (&faces, iface + 1) : NULL;
+    if (face_b == NULL || t8_msh_file_pface_compare (face, face_b)) {
+      /* Set the face as a domain boundary */
+      t8_cmesh_set_join (cmesh, face->gtree_id, face->gtree_id,
+                         face->face_number, face->face_number, 0);
+      continue;
+    }
+    T8_ASSERT (face->gtree_id != face_b->gtree_id);
+    /* Compute the orientation of the face connection */
+    Face_a.ltree_id = face->gtree_id;
+    Face_a.face_number = face->face_number;
+    Face_a.num_vertices = face->num_vertices;
+    Face_a.vertices = face->vertices;
+    Face_b.ltree_id = face_b->gtree_id;
+    Face_b.face_number = face_b->face_number;
+    Face_b.num_vertices = face_b->num_vertices;
+    Face_b.vertices = face_b->vertices;
+    orientation = t8_msh_file_face_orientation (&Face_a, &Face_b,
+                                                (t8_eclass_t) face->eclass,
+                                                (t8_eclass_t) face_b->eclass);
+    /* Set the face connection */
+    t8_cmesh_set_join (cmesh, face->gtree_id, face_b->gtree_id,
+                       face->face_number, face_b->face_number, orientation);
+    /* A face has at most one neighbor */
+    iface++;
+  }
+  sc_array_reset (&faces);
   t8_debugf ("Done finding tree neighbors.\n");
 }
 
@@ -815,15 +1211,14 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
 {
   int                 mpirank, mpisize, mpiret;
   t8_cmesh_t          cmesh;
-  sc_hash_t          *vertices;
-  t8_locidx_t         num_vertices;
-  sc_mempool_t       *node_mempool = NULL;
+  sc_array_t         *vertices;
   sc_array_t         *vertex_indices;
   long               *indices_entry;
   char                current_file[BUFSIZ];
   FILE               *file;
   t8_gloidx_t         num_trees, first_tree, last_tree = -1;
   int                 main_proc_read_successful = 0;
+  int                 file_version;
 
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
@@ -859,7 +1254,8 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
       return NULL;
     }
     /* Check if msh-file version is compatible. */
-    if (t8_cmesh_check_version_of_msh_file (file) != 1) {
+    file_version = t8_cmesh_check_version_of_msh_file (file);
+    if (file_version != 1 && file_version != 2) {
       /* If reading the MeshFormat-number failed or the version is incompatible, close the file */
       fclose (file);
       t8_debugf
@@ -874,16 +1270,38 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
       }
       return NULL;
     }
-    /* read nodes from the file */
-    vertices = t8_msh_file_read_nodes (file, &num_vertices, &node_mempool);
-    t8_cmesh_msh_file_read_eles (cmesh, file, vertices, &vertex_indices, dim);
-    /* close the file and free the memory for the nodes */
-    fclose (file);
-    t8_cmesh_msh_file_find_neighbors (cmesh, vertex_indices);
-    if (vertices != NULL) {
-      sc_hash_destroy (vertices);
+    if (file_version == 2) {
+      /* Read the binary file with bulk reads */
+      if (t8_cmesh_msh_file_read_binary (cmesh, file, &vertex_indices, dim)) {
+        fclose (file);
+        while (vertex_indices->elem_count > 0) {
+          indices_entry = *(long **) sc_array_pop (vertex_indices);
+          T8_FREE (indices_entry);
+        }
+        sc_array_destroy (vertex_indices);
+        t8_cmesh_destroy (&cmesh);
+        if (partition) {
+          /* Communicate to the other processes that reading failed. */
+          main_proc_read_successful = 0;
+          sc_MPI_Bcast (&main_proc_read_successful, 1, sc_MPI_INT,
+                        main_proc, comm);
+        }
+        return NULL;
+      }
+      fclose (file);
+    }
+    else {
+      /* read nodes from the file */
+      vertices = t8_msh_file_read_nodes (file);
+      t8_cmesh_msh_file_read_eles (cmesh, file, vertices, &vertex_indices,
+                                   dim);
+      /* close the file and free the memory for the nodes */
+      fclose (file);
+      if (vertices != NULL) {
+        sc_array_destroy (vertices);
+      }
     }
-    sc_mempool_destroy (node_mempool);
+    t8_cmesh_msh_file_find_neighbors (cmesh, vertex_indices);
     while (vertex_indices->elem_count > 0) {
       indices_entry = *(long **) sc_array_pop (vertex_indices);
       T8_FREE (indices_entry);
@@ -934,3 +1352,889 @@ t8_cmesh_from_msh_file (const char *fileprefix, int partition,
   }
   return cmesh;
 }
+
+/* The parallel reader splits the file into equally sized byte ranges, one
+ * for each process. Each process parses the lines that start in its range.
+ * The nodes are distributed to the processes by their index modulo the
+ * number of processes and the processes request the nodes of their trees
+ * from there. Faces are matched on the process given by their smallest
+ * vertex index. */
+
+/* The maximum number of bytes that one process reads with one call */
+#define T8_MSH_FILE_MAX_BYTES (1 << 30)
+
+/* A face connection of a tree as it is sent to the processes
+ * that have the tree as local tree or as ghost */
+typedef struct
+{
+  t8_gloidx_t         gtree_id; /* The global id of the tree */
+  t8_gloidx_t         neighbor_id;      /* The global id of the neighbor tree */
+  int                 neighbor_rank;    /* The process of the neighbor tree */
+  int8_t              face;     /* The face of the tree */
+  int8_t              neighbor_face;    /* The face of the neighbor tree */
+  int8_t              eclass;   /* The class of the tree */
+  int8_t              neighbor_eclass;  /* The class of the neighbor tree */
+  int8_t              orientation;      /* The orientation of the connection */
+} t8_msh_file_pjoin_t;
+
+/* The class of a ghost tree */
+typedef struct
+{
+  t8_gloidx_t         gtree_id;
+  t8_eclass_t         eclass;
+} t8_msh_file_pghost_t;
+
+/* Compare two nodes or node indices by their index */
+static int
+t8_msh_file_pnode_compare (const void *a, const void *b)
+{
+  const long          index_a = *(const long *) a;
+  const long          index_b = *(const long *) b;
+
+  return (index_a > index_b) - (index_a < index_b);
+}
+
+/* Compare two face connections by their tree and face */
+static int
+t8_msh_file_pjoin_compare (const void *a, const void *b)
+{
+  const t8_msh_file_pjoin_t *join_a = (const t8_msh_file_pjoin_t *) a;
+  const t8_msh_file_pjoin_t *join_b = (const t8_msh_file_pjoin_t *) b;
+
+  if (join_a->gtree_id != join_b->gtree_id) {
+    return join_a->gtree_id < join_b->gtree_id ? -1 : 1;
+  }
+  return (join_a->face > join_b->face) - (join_a->face < join_b->face);
+}
+
+/* Compare two ghosts by their global id */
+static int
+t8_msh_file_pghost_compare (const void *a, const void *b)
+{
+  const t8_gloidx_t   id_a = ((const t8_msh_file_pghost_t *) a)->gtree_id;
+  const t8_gloidx_t   id_b = ((const t8_msh_file_pghost_t *) b)->gtree_id;
+
+  return (id_a > id_b) - (id_a < id_b);
+}
+
+/* Open a file for reading on all processes of comm.
+ * Returns true on all processes if it was opened on all processes. */
+int
+t8_pfile_open (const char *filename, sc_MPI_Comm comm, t8_pfile_handle_t * fh)
+{
+  int                 mpiret, local_success, success;
+
+#ifdef T8_ENABLE_MPIIO
+  local_success = MPI_File_open (comm, (char *) filename, MPI_MODE_RDONLY,
+                                 MPI_INFO_NULL, fh) == MPI_SUCCESS;
+#else
+  *fh = fopen (filename, "rb");
+  local_success = *fh != NULL;
+#endif
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success && local_success) {
+    /* Some other process could not open the file, we close it again */
+#ifdef T8_ENABLE_MPIIO
+    MPI_File_close (fh);
+#else
+    fclose (*fh);
+#endif
+  }
+  return success;
+}
+
+/* Close a file opened with t8_pfile_open */
+void
+t8_pfile_close (t8_pfile_handle_t * fh)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File_close (fh);
+#else
+  fclose (*fh);
+#endif
+}
+
+/* Return the size of an open file in bytes or -1 on failure */
+long long
+t8_pfile_size (t8_pfile_handle_t fh)
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_Offset          size;
+
+  if (MPI_File_get_size (fh, &size) != MPI_SUCCESS) {
+    return -1;
+  }
+  return (long long) size;
+#else
+  if (fseek (fh, 0, SEEK_END)) {
+    return -1;
+  }
+  return (long long) ftell (fh);
+#endif
+}
+
+/* Read up to size bytes at a given offset of an open file.
+ * Returns the number of bytes read, which is smaller than size
+ * at the end of the file or on failure. */
+long long
+t8_pfile_read_at (t8_pfile_handle_t fh, long long offset,
+                  char *buffer, long long size)
+{
+  long long           num_read = 0;
+#ifdef T8_ENABLE_MPIIO
+  MPI_Status          status;
+  int                 count;
+
+  while (num_read < size) {
+    count = (int) SC_MIN (size - num_read, (long long) T8_MSH_FILE_MAX_BYTES);
+    if (MPI_File_read_at (fh, (MPI_Offset) (offset + num_read),
+                          buffer + num_read, count, MPI_BYTE,
+                          &status) != MPI_SUCCESS
+        || MPI_Get_count (&status, MPI_BYTE, &count) != MPI_SUCCESS
+        || count <= 0) {
+      break;
+    }
+    num_read += count;
+  }
+#else
+  size_t              count;
+
+  if (fseek (fh, (long) offset, SEEK_SET)) {
+    return 0;
+  }
+  while (num_read < size) {
+    count = fread (buffer + num_read, 1,
+                   (size_t) SC_MIN (size - num_read,
+                                    (long long) T8_MSH_FILE_MAX_BYTES), fh);
+    if (count == 0) {
+      break;
+    }
+    num_read += count;
+  }
+#endif
+  return num_read;
+}
+
+/* Read the lines of a file that start in the byte range of this process.
+ * The file is split into mpisize ranges of equal size and each line
+ * belongs to the range that contains its first byte.
+ * On output \a lines holds these lines terminated by '\0' and
+ * \a lines_offset is the offset of the first of them in the file.
+ * Returns true on success. */
+int
+t8_pfile_read_lines (t8_pfile_handle_t fh, long long file_size,
+                     int mpirank, int mpisize, sc_array_t * lines,
+                     long long *lines_offset)
+{
+  const long long     start = file_size * mpirank / mpisize;
+  const long long     end = file_size * (mpirank + 1) / mpisize;
+  const long long     read_begin = start > 0 ? start - 1 : 0;
+  const long long     tail_size = 4096;
+  long long           num_read, tail_read, first_line;
+  char               *newline;
+
+  /* We also read the byte in front of our range, to know whether
+   * a line starts at the first byte of the range. */
+  sc_array_resize (lines, (size_t) (end - read_begin));
+  if (t8_pfile_read_at (fh, read_begin, lines->array, end - read_begin)
+      != end - read_begin) {
+    return 0;
+  }
+  /* Read the rest of the last line that starts in our range */
+  while (end < file_size && lines->elem_count > 0
+         && lines->array[lines->elem_count - 1] != '\n'
+         && read_begin + (long long) lines->elem_count < file_size) {
+    num_read = lines->elem_count;
+    sc_array_resize (lines, (size_t) (num_read + tail_size));
+    tail_read = t8_pfile_read_at (fh, read_begin + num_read,
+                                  lines->array + num_read, tail_size);
+    if (tail_read <= 0) {
+      return 0;
+    }
+    num_read += tail_read;
+    sc_array_resize (lines, (size_t) num_read);
+    newline = (char *) memchr (lines->array + end - read_begin, '\n',
+                               num_read - (end - read_begin));
+    if (newline != NULL) {
+      sc_array_resize (lines, newline - lines->array + 1);
+    }
+  }
+
+  /* Find the first line that starts in our range */
+  if (start == 0) {
+    first_line = 0;
+  }
+  else {
+    /* A line starts at offset start + i if the byte in front of it,
+     * which is at position i of the buffer, is a newline. */
+    newline = (char *) memchr (lines->array, '\n', end - start);
+    first_line = newline == NULL ? (long long) lines->elem_count
+      : newline - lines->array + 1;
+  }
+  num_read = lines->elem_count - first_line;
+  memmove (lines->array, lines->array + first_line, num_read);
+  sc_array_resize (lines, (size_t) num_read + 1);
+  lines->array[num_read] = '\0';
+  *lines_offset = read_begin + first_line;
+  return 1;
+}
+
+/* Send records to other processes and receive the records that the other
+ * processes send to us. The records in \a send_buffer are sorted by their
+ * target process and send_counts[p] records go to process p.
+ * On output \a recv_buffer, which must have the same element size, stores
+ * the received records sorted by their source process and recv_counts[p]
+ * is the number of records from process p. */
+void
+t8_pfile_exchange (sc_MPI_Comm comm, int mpirank, int mpisize,
+                   sc_array_t * send_buffer, int *send_counts,
+                   sc_array_t * recv_buffer, int *recv_counts, int tag)
+{
+  const size_t        record_size = send_buffer->elem_size;
+  sc_MPI_Request     *requests;
+  size_t              send_offset, recv_offset, total_recv;
+  int                 iproc, num_requests, mpiret;
+
+  T8_ASSERT (recv_buffer->elem_size == record_size);
+  /* Tell each process how many records we send to it */
+  mpiret = sc_MPI_Alltoall (send_counts, 1, sc_MPI_INT, recv_counts, 1,
+                            sc_MPI_INT, comm);
+  SC_CHECK_MPI (mpiret);
+  for (iproc = 0, total_recv = 0; iproc < mpisize; ++iproc) {
+    total_recv += recv_counts[iproc];
+  }
+  sc_array_resize (recv_buffer, total_recv);
+  requests = T8_ALLOC (sc_MPI_Request, 2 * mpisize);
+
+  /* Post the receives and sends, our own records are copied */
+  recv_offset = send_offset = 0;
+  num_requests = 0;
+  for (iproc = 0; iproc < mpisize; ++iproc) {
+    if (iproc == mpirank) {
+      T8_ASSERT (send_counts[iproc] == recv_counts[iproc]);
+      if (send_counts[iproc] > 0) {
+        memcpy (recv_buffer->array + recv_offset * record_size,
+                send_buffer->array + send_offset * record_size,
+                send_counts[iproc] * record_size);
+      }
+    }
+    else {
+      if (recv_counts[iproc] > 0) {
+        mpiret = sc_MPI_Irecv (recv_buffer->array + recv_offset * record_size,
+                               recv_counts[iproc] * record_size,
+                               sc_MPI_BYTE, iproc, tag, comm,
+                               requests + num_requests++);
+        SC_CHECK_MPI (mpiret);
+      }
+      if (send_counts[iproc] > 0) {
+        mpiret = sc_MPI_Isend (send_buffer->array + send_offset * record_size,
+                               send_counts[iproc] * record_size,
+                               sc_MPI_BYTE, iproc, tag, comm,
+                               requests + num_requests++);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    recv_offset += recv_counts[iproc];
+    send_offset += send_counts[iproc];
+  }
+  if (num_requests > 0) {
+    mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  T8_FREE (requests);
+}
+
+/* Sort records by their target processes, given in \a ranks, into a send
+ * buffer for t8_msh_file_exchange. The order of the records with the
+ * same target is kept. */
+void
+t8_pfile_sort_by_rank (sc_array_t * records, const int *ranks,
+                       int mpisize, sc_array_t * send_buffer,
+                       int *send_counts)
+{
+  const size_t        record_size = records->elem_size;
+  size_t              irecord, *offsets;
+  int                 iproc;
+
+  T8_ASSERT (send_buffer->elem_size == record_size);
+  offsets = T8_ALLOC_ZERO (size_t, mpisize);
+  memset (send_counts, 0, mpisize * sizeof (int));
+  for (irecord = 0; irecord < records->elem_count; irecord++) {
+    send_counts[ranks[irecord]]++;
+  }
+  for (iproc = 1; iproc < mpisize; iproc++) {
+    offsets[iproc] = offsets[iproc - 1] + send_counts[iproc - 1];
+  }
+  sc_array_resize (send_buffer, records->elem_count);
+  for (irecord = 0; irecord < records->elem_count; irecord++) {
+    memcpy (sc_array_index (send_buffer, offsets[ranks[irecord]]++),
+            sc_array_index (records, irecord), record_size);
+  }
+  T8_FREE (offsets);
+}
+
+/* Parse an element line of the format
+ * element_number element_type number_of_tags tag_1 ... tag_n node_1 ... node_m
+ * If the element is of dimension \a dim, its class and nodes are stored.
+ * Returns 1 if the element was stored, 0 if it is of a different
+ * dimension and -1 on failure. */
+static int
+t8_msh_file_parse_element (char *line, int dim,
+                           t8_pfile_element_t * element)
+{
+  char               *pos = line, *next;
+  long                ele_type, num_tags, value;
+  int                 i, num_nodes;
+
+  /* Skip the element number, read the type and number of tags */
+  (void) strtol (pos, &next, 10);
+  ele_type = strtol (pos = next, &next, 10);
+  num_tags = strtol (pos = next, &next, 10);
+  if (next == pos || num_tags < 0) {
+    return -1;
+  }
+  if (ele_type > T8_NUM_GMSH_ELEM_CLASSES || ele_type < 0
+      || t8_msh_tree_type_to_eclass[ele_type] == T8_ECLASS_COUNT) {
+    t8_errorf ("tree type %li is not supported by t8code.\n", ele_type);
+    return -1;
+  }
+  element->eclass = t8_msh_tree_type_to_eclass[ele_type];
+  if (t8_eclass_to_dimension[element->eclass] != dim) {
+    return 0;
+  }
+  /* Skip the tags and read the nodes */
+  for (i = 0; i < num_tags; i++) {
+    (void) strtol (pos = next, &next, 10);
+  }
+  num_nodes = t8_eclass_num_vertices[element->eclass];
+  for (i = 0; i < num_nodes; i++) {
+    value = strtol (pos = next, &next, 10);
+    if (next == pos) {
+      return -1;
+    }
+    element->node_indices[i] = value;
+  }
+  return 1;
+}
+
+/* Parse the node and element lines in the buffer of a process.
+ * The offsets are the positions of the lines following $Nodes and
+ * $Elements, which store the number of entries, and of $EndNodes and
+ * $EndElements. On output the nodes and the elements of dimension
+ * \a dim are stored in \a nodes and \a elements. The numbers of entries
+ * given in the file and the numbers of parsed entries are added to the
+ * last four entries of \a counts.
+ * Returns true on success. */
+static int
+t8_msh_file_parse_lines (char *lines, long long lines_offset,
+                         const long long *section_offsets, int dim,
+                         sc_array_t * nodes, sc_array_t * elements,
+                         long long *counts)
+{
+  t8_pfile_node_t    *node;
+  t8_pfile_element_t  element;
+  char               *line, *end, *next;
+  long long           offset;
+  long                number;
+  int                 retval;
+
+  for (line = lines; *line != '\0'; line = next) {
+    offset = lines_offset + (line - lines);
+    end = strchr (line, '\n');
+    if (end == NULL) {
+      /* The last line of the file has no newline */
+      next = line + strlen (line);
+    }
+    else {
+      *end = '\0';
+      next = end + 1;
+    }
+    if (line[0] == '#' || strspn (line, " \t\r\v") == strlen (line)) {
+      /* Skip comments and empty lines */
+      continue;
+    }
+    if (offset == section_offsets[0] || offset == section_offsets[2]) {
+      /* The number of nodes or elements */
+      if (sscanf (line, "%li", &number) != 1) {
+        t8_errorf ("Premature end of line while reading num %s.\n",
+                   offset == section_offsets[0] ? "nodes" : "trees");
+        return 0;
+      }
+      counts[offset == section_offsets[0] ? 0 : 2] += number;
+    }
+    else if (section_offsets[0] < offset && offset < section_offsets[1]) {
+      node = (t8_pfile_node_t *) sc_array_push (nodes);
+      if (sscanf (line, "%li %lf %lf %lf", &node->index,
+                  &node->coordinates[0], &node->coordinates[1],
+                  &node->coordinates[2]) != 4) {
+        t8_errorf ("Error reading node line %s\n", line);
+        return 0;
+      }
+      counts[1]++;
+    }
+    else if (section_offsets[2] < offset && offset < section_offsets[3]) {
+      retval = t8_msh_file_parse_element (line, dim, &element);
+      if (retval < 0) {
+        t8_errorf ("Error reading element line %s\n", line);
+        return 0;
+      }
+      if (retval > 0) {
+        *(t8_pfile_element_t *) sc_array_push (elements) = element;
+      }
+      counts[3]++;
+    }
+  }
+  return 1;
+}
+
+/* Find the offsets of the lines that follow $Nodes and $Elements and of
+ * the lines $EndNodes and $EndElements in the lines of this process.
+ * Offsets of sections that do not start on this process are LLONG_MAX. */
+static void
+t8_msh_file_find_sections (const char *lines, long long lines_offset,
+                           long long *section_offsets)
+{
+  const char         *markers[4] =
+    { "$Nodes", "$EndNodes", "$Elements", "$EndElements" };
+  const char         *line, *next;
+  size_t              line_length, length;
+  int                 imarker;
+
+  for (imarker = 0; imarker < 4; imarker++) {
+    section_offsets[imarker] = LLONG_MAX;
+  }
+  for (line = lines; *line != '\0'; line = next) {
+    /* The length of the line including the newline */
+    next = strchr (line, '\n');
+    next = next == NULL ? line + strlen (line) : next + 1;
+    line_length = next - line;
+    if (line[0] != '$') {
+      continue;
+    }
+    for (imarker = 0; imarker < 4; imarker++) {
+      length = strlen (markers[imarker]);
+      if (!strncmp (line, markers[imarker], length)
+          && strspn (line + length, " \t\r\n") == line_length - length) {
+        /* For the start markers, we store the offset of the next line,
+         * which holds the number of entries */
+        section_offsets[imarker] = lines_offset + (line - lines)
+          + (imarker % 2 == 0 ? (long long) line_length : 0);
+      }
+    }
+  }
+}
+
+t8_cmesh_t
+t8_pfile_build_cmesh (sc_MPI_Comm comm, sc_array_t * nodes,
+                      sc_array_t * elements, int dim)
+{
+  t8_cmesh_t          cmesh = NULL;
+  t8_pfile_node_t    *node, key_node;
+  t8_pfile_element_t *element;
+  t8_msh_file_pface_t *face, *face_b;
+  t8_msh_file_pjoin_t *join;
+  t8_msh_file_pghost_t *ghost;
+  t8_msh_file_face_t  Face_a, Face_b;
+  sc_array_t          owned_nodes, requests;
+  sc_array_t          tree_nodes, faces, joins, ghosts, send_buffer;
+  int                *ranks = NULL, *send_counts, *recv_counts;
+  double              tree_vertices[24];
+  long                tree_indices[8], *index;
+  long long           local_num_trees, first_tree;
+  ssize_t             found;
+  size_t              ielement, inode, iface, ijoin, jjoin, num_faces;
+  t8_gloidx_t         gtree_id;
+  t8_eclass_t         eclass;
+  int                 mpirank, mpisize, mpiret;
+  int                 local_success, success;
+  int                 iv, ivertex, num_vertices, num_joins;
+  int                 num_neighbor_ranks, is_local[2];
+  int                 neighbor_ranks[T8_ECLASS_MAX_FACES];
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_array_init (&owned_nodes, sizeof (t8_pfile_node_t));
+  sc_array_init (&requests, sizeof (long));
+  sc_array_init (&tree_nodes, sizeof (t8_pfile_node_t));
+  sc_array_init (&faces, sizeof (t8_msh_file_pface_t));
+  sc_array_init (&joins, sizeof (t8_msh_file_pjoin_t));
+  sc_array_init (&ghosts, sizeof (t8_msh_file_pghost_t));
+  sc_array_init (&send_buffer, sizeof (char));
+  send_counts = T8_ALLOC (int, mpisize);
+  recv_counts = T8_ALLOC (int, mpisize);
+
+  /* The trees are numbered in the order of the file */
+  local_num_trees = elements->elem_count;
+  mpiret = sc_MPI_Exscan (&local_num_trees, &first_tree, 1,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    first_tree = 0;
+  }
+
+  /* Send each node to the process given by its index */
+  ranks = T8_ALLOC (int, SC_MAX (nodes->elem_count,
+                                 8 * elements->elem_count) + 1);
+  for (inode = 0; inode < nodes->elem_count; inode++) {
+    node = (t8_pfile_node_t *) sc_array_index (nodes, inode);
+    ranks[inode] = (int) (node->index % mpisize);
+  }
+  sc_array_init (&send_buffer, sizeof (t8_pfile_node_t));
+  t8_pfile_sort_by_rank (nodes, ranks, mpisize, &send_buffer, send_counts);
+  sc_array_reset (nodes);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, send_counts,
+                     &owned_nodes, recv_counts, T8_MPI_MSH_NODES);
+  sc_array_reset (&send_buffer);
+  sc_array_sort (&owned_nodes, t8_msh_file_pnode_compare);
+
+  /* Request the nodes of our trees from the processes that own them */
+  for (ielement = 0; ielement < elements->elem_count; ielement++) {
+    element = (t8_pfile_element_t *) sc_array_index (elements, ielement);
+    num_vertices = t8_eclass_num_vertices[element->eclass];
+    memcpy (sc_array_push_count (&requests, num_vertices),
+            element->node_indices, num_vertices * sizeof (long));
+  }
+  sc_array_sort (&requests, t8_msh_file_pnode_compare);
+  sc_array_uniq (&requests, t8_msh_file_pnode_compare);
+  for (inode = 0; inode < requests.elem_count; inode++) {
+    ranks[inode] = (int) (*(long *) sc_array_index (&requests, inode)
+                          % mpisize);
+  }
+  sc_array_init (&send_buffer, sizeof (long));
+  t8_pfile_sort_by_rank (&requests, ranks, mpisize, &send_buffer,
+                         send_counts);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, send_counts,
+                     &requests, recv_counts, T8_MPI_MSH_NODES);
+  sc_array_reset (&send_buffer);
+  /* Answer the requests of the other processes in the same order */
+  sc_array_init (&send_buffer, sizeof (t8_pfile_node_t));
+  sc_array_resize (&send_buffer, requests.elem_count);
+  local_success = 1;
+  for (inode = 0; inode < requests.elem_count; inode++) {
+    index = (long *) sc_array_index (&requests, inode);
+    found = sc_array_bsearch (&owned_nodes, index,
+                              t8_msh_file_pnode_compare);
+    if (found < 0) {
+      t8_errorf ("Node %li of a tree is not in the file\n", *index);
+      local_success = 0;
+      memset (sc_array_index (&send_buffer, inode), 0,
+              sizeof (t8_pfile_node_t));
+      continue;
+    }
+    memcpy (sc_array_index (&send_buffer, inode),
+            sc_array_index_ssize_t (&owned_nodes, found),
+            sizeof (t8_pfile_node_t));
+  }
+  sc_array_reset (&owned_nodes);
+  sc_array_reset (&requests);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, recv_counts,
+                     &tree_nodes, send_counts, T8_MPI_MSH_NODES);
+  sc_array_reset (&send_buffer);
+  sc_array_sort (&tree_nodes, t8_msh_file_pnode_compare);
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    goto t8_pfile_build_cmesh_cleanup;
+  }
+
+  /* Add the local trees to the cmesh and compute their faces */
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, dim);
+  for (ielement = 0; ielement < elements->elem_count; ielement++) {
+    element = (t8_pfile_element_t *) sc_array_index (elements, ielement);
+    eclass = element->eclass;
+    gtree_id = first_tree + ielement;
+    num_vertices = t8_eclass_num_vertices[eclass];
+    for (iv = 0; iv < num_vertices; iv++) {
+      key_node.index = element->node_indices[iv];
+      found = sc_array_bsearch (&tree_nodes, &key_node,
+                                t8_msh_file_pnode_compare);
+      T8_ASSERT (found >= 0);
+      node = (t8_pfile_node_t *) sc_array_index_ssize_t (&tree_nodes, found);
+      ivertex = t8_msh_tree_vertex_to_t8_vertex_num[eclass][iv];
+      memcpy (tree_vertices + 3 * ivertex, node->coordinates,
+              3 * sizeof (double));
+      /* The node indices in t8code order */
+      tree_indices[iv] =
+        element->node_indices[t8_vertex_to_msh_vertex_num[eclass][iv]];
+    }
+    /* The faces are computed from the switched vertices */
+    t8_cmesh_msh_file_correct_volume (eclass, tree_vertices, tree_indices,
+                                      num_vertices, gtree_id);
+    t8_cmesh_set_tree_class (cmesh, gtree_id, eclass);
+    t8_cmesh_set_tree_vertices (cmesh, gtree_id, t8_get_package_id (), 0,
+                                tree_vertices, num_vertices);
+    for (iface = 0; iface < (size_t) t8_eclass_num_faces[eclass]; iface++) {
+      t8_msh_file_pface_init ((t8_msh_file_pface_t *)
+                              sc_array_push (&faces), tree_indices, eclass,
+                              iface, gtree_id, mpirank);
+    }
+  }
+  sc_array_reset (&tree_nodes);
+
+  /* Send each face to the process of its smallest vertex */
+  T8_FREE (ranks);
+  ranks = T8_ALLOC (int, faces.elem_count + 1);
+  for (iface = 0; iface < faces.elem_count; iface++) {
+    face = (t8_msh_file_pface_t *) sc_array_index (&faces, iface);
+    ranks[iface] = (int) (face->key[0] % mpisize);
+  }
+  sc_array_init (&send_buffer, sizeof (t8_msh_file_pface_t));
+  t8_pfile_sort_by_rank (&faces, ranks, mpisize, &send_buffer, send_counts);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, send_counts,
+                     &faces, recv_counts, T8_MPI_MSH_FACES);
+  sc_array_reset (&send_buffer);
+  /* There are at most as many face connections as received faces */
+  T8_FREE (ranks);
+  ranks = T8_ALLOC (int, faces.elem_count + 1);
+
+  /* Match the faces. Faces with the same vertices are neighbors,
+   * the remaining faces are domain boundaries. */
+  t8_msh_file_pface_radix_sort (&faces);
+  num_faces = faces.elem_count;
+  for (iface = 0; iface + 1 < num_faces; iface++) {
+    face = (t8_msh_file_pface_t *) sc_array_index (&faces, iface);
+    face_b = (t8_msh_file_pface_t *) sc_array_index (&faces, iface + 1);
+    if (t8_msh_file_pface_compare (face, face_b)) {
+      continue;
+    }
+    /* The orientation only depends on the order of the trees */
+    Face_a.ltree_id = face->gtree_id > face_b->gtree_id;
+    Face_a.face_number = face->face_number;
+    Face_a.num_vertices = face->num_vertices;
+    Face_a.vertices = face->vertices;
+    Face_b.ltree_id = face->gtree_id <= face_b->gtree_id;
+    Face_b.face_number = face_b->face_number;
+    Face_b.num_vertices = face_b->num_vertices;
+    Face_b.vertices = face_b->vertices;
+    for (iv = 0; iv < 2; iv++) {
+      join = (t8_msh_file_pjoin_t *) sc_array_push (&joins);
+      memset (join, 0, sizeof (*join));
+      join->gtree_id = iv ? face_b->gtree_id : face->gtree_id;
+      join->neighbor_id = iv ? face->gtree_id : face_b->gtree_id;
+      join->neighbor_rank = iv ? face->mpirank : face_b->mpirank;
+      join->face = iv ? face_b->face_number : face->face_number;
+      join->neighbor_face = iv ? face->face_number : face_b->face_number;
+      join->eclass = iv ? face_b->eclass : face->eclass;
+      join->neighbor_eclass = iv ? face->eclass : face_b->eclass;
+      join->orientation =
+        t8_msh_file_face_orientation (&Face_a, &Face_b,
+                                      (t8_eclass_t) face->eclass,
+                                      (t8_eclass_t) face_b->eclass);
+      /* The join is sent to the process of its tree */
+      ranks[joins.elem_count - 1] = iv ? face_b->mpirank : face->mpirank;
+    }
+    /* A face has at most one neighbor */
+    iface++;
+  }
+  sc_array_reset (&faces);
+  sc_array_init (&send_buffer, sizeof (t8_msh_file_pjoin_t));
+  t8_pfile_sort_by_rank (&joins, ranks, mpisize, &send_buffer, send_counts);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, send_counts,
+                     &joins, recv_counts, T8_MPI_MSH_FACES);
+  sc_array_reset (&send_buffer);
+
+  /* Now we know all face connections of our trees. We send them to the
+   * processes that have one of our trees as a ghost. */
+  sc_array_sort (&joins, t8_msh_file_pjoin_compare);
+  T8_FREE (ranks);
+  ranks = T8_ALLOC (int, T8_ECLASS_MAX_FACES * joins.elem_count + 1);
+  sc_array_init (&faces, sizeof (t8_msh_file_pjoin_t));
+  for (ijoin = 0; ijoin < joins.elem_count; ijoin += num_joins) {
+    join = (t8_msh_file_pjoin_t *) sc_array_index (&joins, ijoin);
+    gtree_id = join->gtree_id;
+    /* Find the joins of this tree and the processes of its neighbors */
+    num_neighbor_ranks = 0;
+    for (num_joins = 0; ijoin + num_joins < joins.elem_count; num_joins++) {
+      join = (t8_msh_file_pjoin_t *) sc_array_index (&joins,
+                                                     ijoin + num_joins);
+      if (join->gtree_id != gtree_id) {
+        break;
+      }
+      for (iv = 0; iv < num_neighbor_ranks
+           && neighbor_ranks[iv] != join->neighbor_rank; iv++) {
+      }
+      if (iv == num_neighbor_ranks && join->neighbor_rank != mpirank) {
+        neighbor_ranks[num_neighbor_ranks++] = join->neighbor_rank;
+      }
+    }
+    for (iv = 0; iv < num_neighbor_ranks; iv++) {
+      for (jjoin = ijoin; jjoin < ijoin + num_joins; jjoin++) {
+        ranks[faces.elem_count] = neighbor_ranks[iv];
+        memcpy (sc_array_push (&faces), sc_array_index (&joins, jjoin),
+                sizeof (t8_msh_file_pjoin_t));
+      }
+    }
+  }
+  sc_array_init (&send_buffer, sizeof (t8_msh_file_pjoin_t));
+  t8_pfile_sort_by_rank (&faces, ranks, mpisize, &send_buffer, send_counts);
+  sc_array_reset (&faces);
+  t8_pfile_exchange (comm, mpirank, mpisize, &send_buffer, send_counts,
+                     &faces, recv_counts, T8_MPI_MSH_FACES);
+  sc_array_reset (&send_buffer);
+  /* The joins of the ghosts follow the joins of the local trees */
+  memcpy (sc_array_push_count (&joins, faces.elem_count), faces.array,
+          faces.elem_count * sizeof (t8_msh_file_pjoin_t));
+  sc_array_reset (&faces);
+
+  /* Set the classes of the ghosts and all face connections.
+   * A ghost is a tree that is connected to a local tree.
+   * We normalize each connection such that the tree with the smaller
+   * id comes first, to set it only once. */
+  for (ijoin = 0; ijoin < joins.elem_count; ijoin++) {
+    join = (t8_msh_file_pjoin_t *) sc_array_index (&joins, ijoin);
+    is_local[0] = first_tree <= join->gtree_id
+      && join->gtree_id < first_tree + local_num_trees;
+    is_local[1] = first_tree <= join->neighbor_id
+      && join->neighbor_id < first_tree + local_num_trees;
+    if (is_local[0] != is_local[1]) {
+      ghost = (t8_msh_file_pghost_t *) sc_array_push (&ghosts);
+      ghost->gtree_id = is_local[0] ? join->neighbor_id : join->gtree_id;
+      ghost->eclass = (t8_eclass_t) (is_local[0] ? join->neighbor_eclass
+                                     : join->eclass);
+    }
+    if (join->gtree_id > join->neighbor_id
+        || (join->gtree_id == join->neighbor_id
+            && join->face > join->neighbor_face)) {
+      gtree_id = join->gtree_id;
+      join->gtree_id = join->neighbor_id;
+      join->neighbor_id = gtree_id;
+      iv = join->face;
+      join->face = join->neighbor_face;
+      join->neighbor_face = iv;
+    }
+  }
+  sc_array_sort (&ghosts, t8_msh_file_pghost_compare);
+  sc_array_uniq (&ghosts, t8_msh_file_pghost_compare);
+  for (ijoin = 0; ijoin < ghosts.elem_count; ijoin++) {
+    ghost = (t8_msh_file_pghost_t *) sc_array_index (&ghosts, ijoin);
+    t8_cmesh_set_tree_class (cmesh, ghost->gtree_id, ghost->eclass);
+  }
+  sc_array_sort (&joins, t8_msh_file_pjoin_compare);
+  sc_array_uniq (&joins, t8_msh_file_pjoin_compare);
+  for (ijoin = 0; ijoin < joins.elem_count; ijoin++) {
+    join = (t8_msh_file_pjoin_t *) sc_array_index (&joins, ijoin);
+    t8_cmesh_set_join (cmesh, join->gtree_id, join->neighbor_id, join->face,
+                       join->neighbor_face, join->orientation);
+  }
+  t8_cmesh_set_partition_range (cmesh, 3, first_tree,
+                                first_tree + local_num_trees - 1);
+  t8_cmesh_commit (cmesh, comm);
+
+t8_pfile_build_cmesh_cleanup:
+  sc_array_reset (nodes);
+  sc_array_reset (elements);
+  sc_array_reset (&owned_nodes);
+  sc_array_reset (&requests);
+  sc_array_reset (&tree_nodes);
+  sc_array_reset (&faces);
+  sc_array_reset (&joins);
+  sc_array_reset (&ghosts);
+  sc_array_reset (&send_buffer);
+  T8_FREE (ranks);
+  T8_FREE (send_counts);
+  T8_FREE (recv_counts);
+  return cmesh;
+}
+
+t8_cmesh_t
+t8_cmesh_from_msh_file_parallel (const char *fileprefix, sc_MPI_Comm comm,
+                                 int dim)
+{
+  t8_pfile_handle_t   fh;
+  sc_array_t          lines, nodes, elements;
+  char                current_file[BUFSIZ];
+  FILE               *file;
+  long long           file_size = 0, lines_offset;
+  long long           local_offsets[4], section_offsets[4];
+  long long           local_counts[4] = { 0, 0, 0, 0 }, counts[4];
+  int                 mpirank, mpisize, mpiret;
+  int                 local_success, success;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  snprintf (current_file, BUFSIZ, "%s.msh", fileprefix);
+
+  /* Process 0 checks the version of the file */
+  success = 0;
+  if (mpirank == 0) {
+    file = fopen (current_file, "r");
+    if (file == NULL) {
+      t8_global_errorf ("Could not open file %s\n", current_file);
+    }
+    else {
+      success = t8_cmesh_check_version_of_msh_file (file) == 1;
+      fclose (file);
+    }
+  }
+  mpiret = sc_MPI_Bcast (&success, 1, sc_MPI_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success || !t8_pfile_open (current_file, comm, &fh)) {
+    return NULL;
+  }
+  if (mpirank == 0) {
+    file_size = t8_pfile_size (fh);
+  }
+  mpiret = sc_MPI_Bcast (&file_size, 1, sc_MPI_LONG_LONG_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+
+  sc_array_init (&lines, sizeof (char));
+  sc_array_init (&nodes, sizeof (t8_pfile_node_t));
+  sc_array_init (&elements, sizeof (t8_pfile_element_t));
+
+  /* Read the lines of this process and find the sections */
+  local_success = file_size > 0
+    && t8_pfile_read_lines (fh, file_size, mpirank, mpisize, &lines,
+                            &lines_offset);
+  t8_pfile_close (&fh);
+  if (local_success) {
+    t8_msh_file_find_sections (lines.array, lines_offset, local_offsets);
+  }
+  else {
+    t8_errorf ("Error when reading file %s\n", current_file);
+    local_offsets[0] = local_offsets[1] = LLONG_MAX;
+    local_offsets[2] = local_offsets[3] = LLONG_MAX;
+  }
+  mpiret = sc_MPI_Allreduce (local_offsets, section_offsets, 4,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MIN, comm);
+  SC_CHECK_MPI (mpiret);
+  if (local_success && (section_offsets[0] == LLONG_MAX
+                        || section_offsets[1] == LLONG_MAX
+                        || section_offsets[2] == LLONG_MAX
+                        || section_offsets[3] == LLONG_MAX)) {
+    t8_global_errorf ("Could not find the nodes and elements in %s\n",
+                      current_file);
+    local_success = 0;
+  }
+
+  /* Parse the nodes and elements */
+  local_success = local_success
+    && t8_msh_file_parse_lines (lines.array, lines_offset, section_offsets,
+                                dim, &nodes, &elements, local_counts);
+  sc_array_reset (&lines);
+  mpiret = sc_MPI_Allreduce (local_counts, counts, 4, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (local_success && (counts[0] != counts[1] || counts[2] != counts[3])) {
+    t8_global_errorf ("The number of nodes or elements in %s does not match"
+                      " the number of entries.\n", current_file);
+    local_success = 0;
+  }
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    sc_array_reset (&nodes);
+    sc_array_reset (&elements);
+    return NULL;
+  }
+  return t8_pfile_build_cmesh (comm, &nodes, &elements, dim);
+}
@@ -0,0 +1,804 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_eclass.h>
+#include <t8_vtk.h>
+#include <t8_cmesh_vtk.h>
+#include "t8_cmesh_pfile.h"
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* Process 0 reads the xml part of a vtu file in chunks of this size */
+#define T8_VTU_CHUNK_SIZE 1048576
+
+/* A data array of a vtu file */
+typedef struct
+{
+  t8_vtk_format_t     format;   /* ASCII for inline text, BINARY for raw
+                                   and COMPRESSED for zlib compressed
+                                   appended data */
+  int                 type_size;        /* The number of bytes of a value */
+  int                 is_float; /* True for Float32 and Float64 */
+  int                 is_signed;        /* True for signed integer types */
+  int                 num_components;   /* The values per point or cell */
+  long long           offset;   /* The file offset of the text of an ascii
+                                   array and the offset into the appended
+                                   data otherwise */
+  long long           size;     /* The number of bytes of the text of an
+                                   ascii array */
+} t8_vtu_array_t;
+
+/* A piece of a vtu file. The point indices of its connectivity refer
+ * to the points of the piece. */
+typedef struct
+{
+  long long           num_points;
+  long long           num_cells;
+  long long           first_point;      /* The index of the first point of
+                                           the piece in the whole file */
+  long long           first_cell;       /* The index of the first cell */
+  t8_vtu_array_t      points;
+  t8_vtu_array_t      connectivity;
+  t8_vtu_array_t      offsets;
+  t8_vtu_array_t      types;
+} t8_vtu_piece_t;
+
+/* The properties of a vtu file that all processes need */
+typedef struct
+{
+  long long           appended_start;   /* The file offset of the appended
+                                           data or -1 if there is none */
+  int                 header_size;      /* The bytes of the integers that
+                                           precede the appended arrays */
+  int                 num_pieces;
+} t8_vtu_file_t;
+
+/* Return the class of a VTK cell type or T8_ECLASS_COUNT if there is none.
+ * VTK_PIXEL and VTK_VOXEL are quads and hexes with the vertices in
+ * t8code order, for them \a is_voxel is set to true. */
+static t8_eclass_t
+t8_vtu_cell_class (long long vtk_type, int *is_voxel)
+{
+  int                 eclass;
+
+  *is_voxel = 0;
+  if (vtk_type == 8 || vtk_type == 11) {
+    *is_voxel = 1;
+    return vtk_type == 8 ? T8_ECLASS_QUAD : T8_ECLASS_HEX;
+  }
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (t8_eclass_vtk_type[eclass] == vtk_type) {
+      return (t8_eclass_t) eclass;
+    }
+  }
+  return T8_ECLASS_COUNT;
+}
+
+/* Find the next tag with a given name in text. If end is not NULL,
+ * the tag has to start before end.
+ * Returns a pointer to the '<' of the tag or NULL if there is none. */
+static const char  *
+t8_vtu_find_tag (const char *text, const char *end, const char *name)
+{
+  const size_t        name_length = strlen (name);
+  const char         *tag = text;
+
+  while ((tag = strchr (tag, '<')) != NULL && (end == NULL || tag < end)) {
+    if (!strncmp (tag + 1, name, name_length)
+        && (isspace (tag[name_length + 1]) || tag[name_length + 1] == '>'
+            || tag[name_length + 1] == '/')) {
+      return tag;
+    }
+    tag++;
+  }
+  return NULL;
+}
+
+/* Copy the value of an attribute of a tag into value.
+ * Returns true if the tag has the attribute and the value fits. */
+static int
+t8_vtu_get_attribute (const char *tag, const char *name, char *value,
+                      size_t size)
+{
+  const char         *end = strchr (tag, '>');
+  const size_t        name_length = strlen (name);
+  const char         *pos = tag, *close;
+
+  while (end != NULL && (pos = strstr (pos + 1, name)) != NULL && pos < end) {
+    if (isspace (pos[-1]) && pos[name_length] == '='
+        && pos[name_length + 1] == '"') {
+      pos += name_length + 2;
+      close = strchr (pos, '"');
+      if (close == NULL || close > end || (size_t) (close - pos) >= size) {
+        return 0;
+      }
+      memcpy (value, pos, close - pos);
+      value[close - pos] = '\0';
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Set the type of an array from the name of a VTK data type.
+ * Returns true if the type is known. */
+static int
+t8_vtu_parse_type (const char *type, t8_vtu_array_t * array)
+{
+  int                 bits;
+
+  array->is_float = 0;
+  array->is_signed = 1;
+  if (sscanf (type, "Float%d", &bits) == 1) {
+    array->is_float = 1;
+  }
+  else if (sscanf (type, "UInt%d", &bits) == 1) {
+    array->is_signed = 0;
+  }
+  else if (sscanf (type, "Int%d", &bits) != 1) {
+    return 0;
+  }
+  array->type_size = bits / 8;
+  if (array->is_float) {
+    return bits == 32 || bits == 64;
+  }
+  return bits == 8 || bits == 16 || bits == 32 || bits == 64;
+}
+
+/* Parse the DataArray tag of an array. The tag is part of the xml header
+ * that starts at the beginning of the file.
+ * Returns true on success. */
+static int
+t8_vtu_parse_array (const char *header, const char *tag, int compressed,
+                    t8_vtu_array_t * array)
+{
+  char                value[BUFSIZ];
+  const char         *text, *close;
+
+  if (!t8_vtu_get_attribute (tag, "type", value, BUFSIZ)
+      || !t8_vtu_parse_type (value, array)) {
+    t8_global_errorf ("Unsupported type of a vtu data array.\n");
+    return 0;
+  }
+  array->num_components = 1;
+  if (t8_vtu_get_attribute (tag, "NumberOfComponents", value, BUFSIZ)) {
+    array->num_components = atoi (value);
+  }
+  array->size = 0;
+  if (!t8_vtu_get_attribute (tag, "format", value, BUFSIZ)) {
+    t8_global_errorf ("A vtu data array has no format.\n");
+    return 0;
+  }
+  if (!strcmp (value, "ascii")) {
+    /* The values are the text between the tag and its closing tag */
+    array->format = T8_VTK_FORMAT_ASCII;
+    text = strchr (tag, '>') + 1;
+    close = strstr (text, "</DataArray");
+    if (close == NULL) {
+      t8_global_errorf ("A vtu data array is not closed.\n");
+      return 0;
+    }
+    array->offset = text - header;
+    array->size = close - text;
+    return 1;
+  }
+  if (!strcmp (value, "appended")) {
+    array->format = compressed ? T8_VTK_FORMAT_COMPRESSED
+      : T8_VTK_FORMAT_BINARY;
+    if (!t8_vtu_get_attribute (tag, "offset", value, BUFSIZ)) {
+      t8_global_errorf ("An appended vtu data array has no offset.\n");
+      return 0;
+    }
+    array->offset = atoll (value);
+    return 1;
+  }
+  t8_global_errorf ("Unsupported format %s of a vtu data array.\n", value);
+  return 0;
+}
+
+/* Parse the xml header of a vtu file on process 0 and store the layout of
+ * its pieces. Returns true on success. */
+static int
+t8_vtu_parse_header (const char *header, t8_vtu_file_t * file,
+                     sc_array_t * pieces)
+{
+  t8_vtu_piece_t     *piece;
+  t8_vtu_array_t     *array;
+  char                value[BUFSIZ];
+  const char         *tag, *piece_tag, *piece_end, *cells_end;
+  long long           num_points = 0, num_cells = 0;
+  int                 compressed = 0;
+
+  tag = t8_vtu_find_tag (header, NULL, "VTKFile");
+  if (tag == NULL || !t8_vtu_get_attribute (tag, "type", value, BUFSIZ)
+      || strcmp (value, "UnstructuredGrid")) {
+    t8_global_errorf ("The file is no vtu file of an unstructured grid.\n");
+    return 0;
+  }
+  if (t8_vtu_get_attribute (tag, "byte_order", value, BUFSIZ)) {
+#ifdef SC_IS_BIGENDIAN
+    if (strcmp (value, "BigEndian")) {
+#else
+    if (strcmp (value, "LittleEndian")) {
+#endif
+      t8_global_errorf ("Unsupported byte order %s of a vtu file.\n", value);
+      return 0;
+    }
+  }
+  /* The integers preceding the appended data are 32 bit by default */
+  file->header_size = 4;
+  if (t8_vtu_get_attribute (tag, "header_type", value, BUFSIZ)) {
+    if (strcmp (value, "UInt32") && strcmp (value, "UInt64")) {
+      t8_global_errorf ("Unsupported header type %s of a vtu file.\n",
+                        value);
+      return 0;
+    }
+    file->header_size = strcmp (value, "UInt64") ? 4 : 8;
+  }
+  if (t8_vtu_get_attribute (tag, "compressor", value, BUFSIZ)) {
+#ifdef SC_HAVE_ZLIB
+    if (strcmp (value, "vtkZLibDataCompressor")) {
+#endif
+      t8_global_errorf ("Unsupported compressor %s of a vtu file.\n", value);
+      return 0;
+#ifdef SC_HAVE_ZLIB
+    }
+    compressed = 1;
+#endif
+  }
+  tag = t8_vtu_find_tag (header, NULL, "AppendedData");
+  if (tag != NULL && (!t8_vtu_get_attribute (tag, "encoding", value,
+                                             BUFSIZ)
+                      || strcmp (value, "raw"))) {
+    t8_global_errorf ("Only raw encoding of appended vtu data is"
+                      " supported.\n");
+    return 0;
+  }
+
+  /* Each piece has its own points and cells */
+  piece_tag = header;
+  while ((piece_tag = t8_vtu_find_tag (piece_tag, NULL, "Piece")) != NULL) {
+    piece = (t8_vtu_piece_t *) sc_array_push (pieces);
+    memset (piece, 0, sizeof (t8_vtu_piece_t));
+    if (!t8_vtu_get_attribute (piece_tag, "NumberOfPoints", value, BUFSIZ)) {
+      t8_global_errorf ("A vtu piece has no number of points.\n");
+      return 0;
+    }
+    piece->num_points = atoll (value);
+    if (!t8_vtu_get_attribute (piece_tag, "NumberOfCells", value, BUFSIZ)) {
+      t8_global_errorf ("A vtu piece has no number of cells.\n");
+      return 0;
+    }
+    piece->num_cells = atoll (value);
+    piece->first_point = num_points;
+    piece->first_cell = num_cells;
+    num_points += piece->num_points;
+    num_cells += piece->num_cells;
+    piece_end = strstr (piece_tag, "</Piece>");
+    if (piece_end == NULL) {
+      t8_global_errorf ("A vtu piece is not closed.\n");
+      return 0;
+    }
+
+    /* The coordinates of the points */
+    tag = t8_vtu_find_tag (piece_tag, piece_end, "Points");
+    if (tag != NULL) {
+      tag = t8_vtu_find_tag (tag, piece_end, "DataArray");
+    }
+    if (tag == NULL
+        || !t8_vtu_parse_array (header, tag, compressed, &piece->points)) {
+      t8_global_errorf ("Could not read the points of a vtu piece.\n");
+      return 0;
+    }
+    if (!piece->points.is_float || piece->points.num_components != 3) {
+      t8_global_errorf ("The points of a vtu piece must have three"
+                        " floating point coordinates.\n");
+      return 0;
+    }
+
+    /* The connectivity, offsets and types of the cells */
+    tag = t8_vtu_find_tag (piece_tag, piece_end, "Cells");
+    cells_end = tag == NULL ? NULL : strstr (tag, "</Cells>");
+    if (cells_end == NULL || cells_end > piece_end) {
+      t8_global_errorf ("Could not find the cells of a vtu piece.\n");
+      return 0;
+    }
+    while ((tag = t8_vtu_find_tag (tag + 1, cells_end, "DataArray"))
+           != NULL) {
+      if (!t8_vtu_get_attribute (tag, "Name", value, BUFSIZ)) {
+        continue;
+      }
+      array = !strcmp (value, "connectivity") ? &piece->connectivity
+        : !strcmp (value, "offsets") ? &piece->offsets
+        : !strcmp (value, "types") ? &piece->types : NULL;
+      if (array != NULL
+          && !t8_vtu_parse_array (header, tag, compressed, array)) {
+        return 0;
+      }
+    }
+    /* A parsed array has a positive type size */
+    if (piece->connectivity.type_size == 0 || piece->offsets.type_size == 0
+        || piece->types.type_size == 0 || piece->connectivity.is_float
+        || piece->offsets.is_float || piece->types.is_float) {
+      t8_global_errorf ("The cells of a vtu piece need integer connectivity,"
+                        " offsets and types.\n");
+      return 0;
+    }
+    piece_tag = piece_end;
+  }
+  if (pieces->elem_count == 0) {
+    t8_global_errorf ("The vtu file has no pieces.\n");
+    return 0;
+  }
+  file->num_pieces = (int) pieces->elem_count;
+  return 1;
+}
+
+/* Read the xml header of a vtu file on process 0. For files with
+ * appended data, this is everything up to the '_' that marks the start
+ * of the data, whose offset is stored in appended_start.
+ * Files without appended data are read completely.
+ * On output, header holds the text terminated by '\0'.
+ * Returns true on success. */
+static int
+t8_vtu_read_header (t8_pfile_handle_t fh, long long file_size,
+                    sc_array_t * header, long long *appended_start)
+{
+  long long           num_read = 0, chunk, search_from;
+  long long           marker_offset = -1;
+  char               *marker, *data_start;
+
+  *appended_start = -1;
+  while (num_read < file_size) {
+    chunk = SC_MIN ((long long) T8_VTU_CHUNK_SIZE, file_size - num_read);
+    sc_array_resize (header, num_read + chunk + 1);
+    if (t8_pfile_read_at (fh, num_read, header->array + num_read, chunk)
+        != chunk) {
+      return 0;
+    }
+    /* The marker may start in the previous chunk */
+    search_from = SC_MAX (0, num_read - 16);
+    num_read += chunk;
+    header->array[num_read] = '\0';
+    if (marker_offset < 0) {
+      marker = strstr (header->array + search_from, "<AppendedData");
+      if (marker == NULL) {
+        continue;
+      }
+      marker_offset = marker - header->array;
+    }
+    marker = strchr (header->array + marker_offset, '>');
+    data_start = marker == NULL ? NULL : strchr (marker, '_');
+    if (data_start != NULL) {
+      /* The appended data is not part of the xml header */
+      *appended_start = data_start + 1 - header->array;
+      *data_start = '\0';
+      return 1;
+    }
+  }
+  /* Appended data without its start marker is an error */
+  return marker_offset < 0;
+}
+
+/* Return an unsigned integer of the appended data headers */
+static long long
+t8_vtu_header_value (const char *raw, int header_size)
+{
+  uint32_t            value32;
+  uint64_t            value64;
+
+  if (header_size == 4) {
+    memcpy (&value32, raw, sizeof (uint32_t));
+    return (long long) value32;
+  }
+  memcpy (&value64, raw, sizeof (uint64_t));
+  return (long long) value64;
+}
+
+/* Convert count binary values of an array to doubles for floating point
+ * arrays and to long long otherwise. */
+static void
+t8_vtu_convert (const t8_vtu_array_t * array, const char *raw,
+                long long count, void *values)
+{
+  const char         *value;
+  long long           ivalue;
+  float               f;
+  int8_t              i8;
+  int16_t             i16;
+  int32_t             i32;
+  uint8_t             u8;
+  uint16_t            u16;
+  uint32_t            u32;
+  uint64_t            u64;
+
+  for (ivalue = 0; ivalue < count; ivalue++) {
+    value = raw + ivalue * array->type_size;
+    if (array->is_float) {
+      if (array->type_size == 4) {
+        memcpy (&f, value, sizeof (float));
+        ((double *) values)[ivalue] = f;
+      }
+      else {
+        memcpy ((double *) values + ivalue, value, sizeof (double));
+      }
+      continue;
+    }
+    switch (array->type_size) {
+    case 1:
+      memcpy (&u8, value, 1);
+      memcpy (&i8, value, 1);
+      ((long long *) values)[ivalue] = array->is_signed ? i8 : u8;
+      break;
+    case 2:
+      memcpy (&u16, value, 2);
+      memcpy (&i16, value, 2);
+      ((long long *) values)[ivalue] = array->is_signed ? i16 : u16;
+      break;
+    case 4:
+      memcpy (&u32, value, 4);
+      memcpy (&i32, value, 4);
+      ((long long *) values)[ivalue] = array->is_signed ? (long long) i32
+        : (long long) u32;
+      break;
+    default:
+      T8_ASSERT (array->type_size == 8);
+      memcpy (&u64, value, 8);
+      /* Values beyond the range of long long are not sensible here */
+      ((long long *) values)[ivalue] = (long long) u64;
+    }
+  }
+}
+
+/* Read the values first, ..., first + count - 1 of an array.
+ * The values of floating point arrays are stored as doubles and integer
+ * values as long long in values.
+ * Only the blocks of compressed arrays that hold these values are read.
+ * Returns true on success. */
+static int
+t8_vtu_read_values (t8_pfile_handle_t fh, const t8_vtu_file_t * file,
+                    const t8_vtu_array_t * array, long long first,
+                    long long count, void *values)
+{
+  const int           hs = file->header_size;
+  const long long     begin = first * array->type_size;
+  const long long     end = (first + count) * array->type_size;
+  sc_array_t          buffer;
+  long long           start, num_bytes;
+  int                 success = 1;
+
+  if (count == 0) {
+    return 1;
+  }
+  sc_array_init (&buffer, sizeof (char));
+  if (array->format == T8_VTK_FORMAT_ASCII) {
+    char               *text, *next;
+    long long           ivalue;
+
+    /* We parse the whole text and keep our values */
+    sc_array_resize (&buffer, array->size + 1);
+    text = buffer.array;
+    success = t8_pfile_read_at (fh, array->offset, text, array->size)
+      == array->size;
+    text[array->size] = '\0';
+    for (ivalue = 0; success && ivalue < first + count; ivalue++) {
+      if (array->is_float) {
+        double              dvalue = strtod (text, &next);
+
+        if (ivalue >= first) {
+          ((double *) values)[ivalue - first] = dvalue;
+        }
+      }
+      else {
+        long long           lvalue = strtoll (text, &next, 10);
+
+        if (ivalue >= first) {
+          ((long long *) values)[ivalue - first] = lvalue;
+        }
+      }
+      success = next != text;
+      text = next;
+    }
+    sc_array_reset (&buffer);
+    return success;
+  }
+  T8_ASSERT (file->appended_start >= 0);
+  start = file->appended_start + array->offset;
+  if (array->format == T8_VTK_FORMAT_BINARY) {
+    /* The values follow the number of bytes of the array */
+    num_bytes = end - begin;
+    sc_array_resize (&buffer, num_bytes);
+    success = t8_pfile_read_at (fh, start + hs + begin, buffer.array,
+                                num_bytes) == num_bytes;
+  }
+#ifdef SC_HAVE_ZLIB
+  else {
+    char                block_header[24];
+    sc_array_t          block_sizes, compressed;
+    long long           num_blocks, block_size, last_size;
+    long long           first_block, last_block, iblock;
+    long long           block_begin, block_bytes, offset;
+    long long           copy_begin, copy_end;
+    uLongf              uncompressed_bytes;
+    char               *block;
+
+    T8_ASSERT (array->format == T8_VTK_FORMAT_COMPRESSED);
+    /* The header holds the number of blocks, the uncompressed size of a
+     * block and of the last block and the compressed size of each block */
+    if (t8_pfile_read_at (fh, start, block_header, 3 * hs) != 3 * hs) {
+      return 0;
+    }
+    num_blocks = t8_vtu_header_value (block_header, hs);
+    block_size = t8_vtu_header_value (block_header + hs, hs);
+    last_size = t8_vtu_header_value (block_header + 2 * hs, hs);
+    if (block_size <= 0 || end > num_blocks * block_size) {
+      return 0;
+    }
+    sc_array_init_count (&block_sizes, hs, num_blocks);
+    success = t8_pfile_read_at (fh, start + 3 * hs, block_sizes.array,
+                                num_blocks * hs) == num_blocks * hs;
+    first_block = begin / block_size;
+    last_block = (end - 1) / block_size;
+    offset = start + (3 + num_blocks) * hs;
+    num_bytes = 0;
+    for (iblock = 0; success && iblock <= last_block; iblock++) {
+      block_bytes =
+        t8_vtu_header_value ((char *) sc_array_index (&block_sizes, iblock),
+                             hs);
+      if (iblock < first_block) {
+        offset += block_bytes;
+      }
+      else {
+        num_bytes += block_bytes;
+      }
+    }
+    /* Read all compressed blocks of our range at once */
+    sc_array_init_count (&compressed, sizeof (char), num_bytes);
+    success = success && t8_pfile_read_at (fh, offset, compressed.array,
+                                           num_bytes) == num_bytes;
+    sc_array_resize (&buffer, end - begin);
+    block = T8_ALLOC (char, block_size);
+    offset = 0;
+    for (iblock = first_block; success && iblock <= last_block; iblock++) {
+      uncompressed_bytes = (uLongf) (iblock == num_blocks - 1
+                                     && last_size > 0 ? last_size
+                                     : block_size);
+      block_bytes =
+        t8_vtu_header_value ((char *) sc_array_index (&block_sizes, iblock),
+                             hs);
+      block_begin = iblock * block_size;
+      copy_begin = SC_MAX (begin, block_begin);
+      copy_end = SC_MIN (end, block_begin + block_size);
+      success = uncompress ((Bytef *) block, &uncompressed_bytes,
+                            (Bytef *) compressed.array + offset,
+                            (uLong) block_bytes) == Z_OK
+        && (long long) uncompressed_bytes >= copy_end - block_begin;
+      offset += block_bytes;
+      if (success) {
+        /* Copy the part of the block that is in our range */
+        memcpy (buffer.array + copy_begin - begin,
+                block + copy_begin - block_begin, copy_end - copy_begin);
+      }
+    }
+    T8_FREE (block);
+    sc_array_reset (&compressed);
+    sc_array_reset (&block_sizes);
+  }
+#else
+  else {
+    /* The header check does not allow compressed files without zlib */
+    SC_ABORT_NOT_REACHED ();
+  }
+#endif
+  if (success) {
+    t8_vtu_convert (array, buffer.array, count, values);
+  }
+  sc_array_reset (&buffer);
+  return success;
+}
+
+/* Read the points of a piece from first to first + count - 1 and add
+ * them to nodes. The index of a node is its index in the whole file.
+ * Returns true on success. */
+static int
+t8_vtu_read_points (t8_pfile_handle_t fh, const t8_vtu_file_t * file,
+                    const t8_vtu_piece_t * piece, long long first,
+                    long long count, sc_array_t * nodes)
+{
+  t8_pfile_node_t    *node;
+  double             *coordinates;
+  long long           ipoint;
+  int                 success;
+
+  coordinates = T8_ALLOC (double, 3 * count);
+  success = t8_vtu_read_values (fh, file, &piece->points, 3 * first,
+                                3 * count, coordinates);
+  for (ipoint = 0; success && ipoint < count; ipoint++) {
+    node = (t8_pfile_node_t *) sc_array_push (nodes);
+    node->index = (long) (piece->first_point + first + ipoint);
+    memcpy (node->coordinates, coordinates + 3 * ipoint, 3 * sizeof (double));
+  }
+  T8_FREE (coordinates);
+  return success;
+}
+
+/* Read the cells of a piece from first to first + count - 1 and add the
+ * cells of dimension dim to elements. The vertices are sorted from VTK
+ * order to .msh order and the node indices refer to the whole file.
+ * Returns true on success. */
+static int
+t8_vtu_read_cells (t8_pfile_handle_t fh, const t8_vtu_file_t * file,
+                   const t8_vtu_piece_t * piece, long long first,
+                   long long count, int dim, sc_array_t * elements)
+{
+  t8_pfile_element_t *element;
+  t8_eclass_t         eclass;
+  long long          *ends, *types, *connectivity;
+  long long           icell, conn_begin, conn_end, cell_begin;
+  int                 ivertex, t8_vertex, is_voxel;
+  int                 success;
+
+  /* The offsets array holds the end of each cell in the connectivity */
+  ends = T8_ALLOC (long long, count + 1);
+  types = T8_ALLOC (long long, count);
+  ends[0] = 0;
+  success = t8_vtu_read_values (fh, file, &piece->offsets,
+                                first > 0 ? first - 1 : 0,
+                                first > 0 ? count + 1 : count,
+                                first > 0 ? ends : ends + 1)
+    && t8_vtu_read_values (fh, file, &piece->types, first, count, types);
+  conn_begin = ends[0];
+  conn_end = ends[count];
+  success = success && conn_begin <= conn_end;
+  connectivity = T8_ALLOC (long long, success ? conn_end - conn_begin : 0);
+  success = success
+    && t8_vtu_read_values (fh, file, &piece->connectivity, conn_begin,
+                           conn_end - conn_begin, connectivity);
+  for (icell = 0; success && icell < count; icell++) {
+    eclass = t8_vtu_cell_class (types[icell], &is_voxel);
+    if (eclass == T8_ECLASS_COUNT) {
+      t8_errorf ("Unsupported VTK cell type %lli.\n", types[icell]);
+      success = 0;
+      break;
+    }
+    if (t8_eclass_to_dimension[eclass] != dim) {
+      continue;
+    }
+    if (ends[icell + 1] - ends[icell] != t8_eclass_num_vertices[eclass]) {
+      t8_errorf ("Wrong number of vertices of a VTK cell.\n");
+      success = 0;
+      break;
+    }
+    element = (t8_pfile_element_t *) sc_array_push (elements);
+    element->eclass = eclass;
+    cell_begin = ends[icell] - conn_begin;
+    for (ivertex = 0; ivertex < t8_eclass_num_vertices[eclass]; ivertex++) {
+      t8_vertex = is_voxel ? ivertex
+        : t8_eclass_vtk_corner_number[eclass][ivertex];
+      element->node_indices[t8_vertex_to_msh_vertex_num[eclass][t8_vertex]]
+        = (long) (piece->first_point + connectivity[cell_begin + ivertex]);
+    }
+  }
+  T8_FREE (ends);
+  T8_FREE (types);
+  T8_FREE (connectivity);
+  return success;
+}
+
+t8_cmesh_t
+t8_cmesh_from_vtu_file (const char *filename, sc_MPI_Comm comm, int dim)
+{
+  t8_pfile_handle_t   fh;
+  t8_vtu_file_t       file;
+  t8_vtu_piece_t     *piece;
+  sc_array_t          header, pieces, nodes, elements;
+  long long           file_size, num_points, num_cells;
+  long long           first, last, begin, end;
+  size_t              ipiece;
+  int                 mpirank, mpisize, mpiret;
+  int                 local_success, success = 0;
+
+  T8_ASSERT (0 <= dim && dim <= 3);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  if (!t8_pfile_open (filename, comm, &fh)) {
+    t8_global_errorf ("Could not open file %s\n", filename);
+    return NULL;
+  }
+  sc_array_init (&pieces, sizeof (t8_vtu_piece_t));
+  memset (&file, 0, sizeof (t8_vtu_file_t));
+
+  /* Process 0 parses the xml header and tells the others the layout */
+  if (mpirank == 0) {
+    sc_array_init (&header, sizeof (char));
+    file_size = t8_pfile_size (fh);
+    success = file_size > 0
+      && t8_vtu_read_header (fh, file_size, &header, &file.appended_start);
+    if (!success) {
+      t8_global_errorf ("Error when reading file %s\n", filename);
+    }
+    success = success && t8_vtu_parse_header (header.array, &file, &pieces);
+    sc_array_reset (&header);
+  }
+  mpiret = sc_MPI_Bcast (&success, 1, sc_MPI_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    t8_pfile_close (&fh);
+    sc_array_reset (&pieces);
+    return NULL;
+  }
+  mpiret = sc_MPI_Bcast (&file, sizeof (t8_vtu_file_t), sc_MPI_BYTE, 0,
+                         comm);
+  SC_CHECK_MPI (mpiret);
+  sc_array_resize (&pieces, file.num_pieces);
+  mpiret = sc_MPI_Bcast (pieces.array, pieces.elem_count * pieces.elem_size,
+                         sc_MPI_BYTE, 0, comm);
+  SC_CHECK_MPI (mpiret);
+  piece = (t8_vtu_piece_t *) sc_array_index (&pieces, file.num_pieces - 1);
+  num_points = piece->first_point + piece->num_points;
+  num_cells = piece->first_cell + piece->num_cells;
+
+  /* Each process reads an equally sized range of the points and of
+   * the cells, which may span several pieces */
+  sc_array_init (&nodes, sizeof (t8_pfile_node_t));
+  sc_array_init (&elements, sizeof (t8_pfile_element_t));
+  local_success = 1;
+  for (ipiece = 0; local_success && ipiece < pieces.elem_count; ipiece++) {
+    piece = (t8_vtu_piece_t *) sc_array_index (&pieces, ipiece);
+    first = num_points * mpirank / mpisize;
+    last = num_points * (mpirank + 1) / mpisize;
+    begin = SC_MAX (first, piece->first_point);
+    end = SC_MIN (last, piece->first_point + piece->num_points);
+    if (begin < end) {
+      local_success =
+        t8_vtu_read_points (fh, &file, piece, begin - piece->first_point,
+                            end - begin, &nodes);
+    }
+    first = num_cells * mpirank / mpisize;
+    last = num_cells * (mpirank + 1) / mpisize;
+    begin = SC_MAX (first, piece->first_cell);
+    end = SC_MIN (last, piece->first_cell + piece->num_cells);
+    if (local_success && begin < end) {
+      local_success =
+        t8_vtu_read_cells (fh, &file, piece, begin - piece->first_cell,
+                           end - begin, dim, &elements);
+    }
+  }
+  t8_pfile_close (&fh);
+  sc_array_reset (&pieces);
+  if (!local_success) {
+    t8_errorf ("Error when reading the points and cells of %s\n", filename);
+  }
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    sc_array_reset (&nodes);
+    sc_array_reset (&elements);
+    return NULL;
+  }
+  return t8_pfile_build_cmesh (comm, &nodes, &elements, dim);
+}
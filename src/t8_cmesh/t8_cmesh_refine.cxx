@@ -20,947 +20,1137 @@
   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 */
 
-/** \file t8_cmesh_refine.c
+/** \file t8_cmesh_refine.cxx
  *
- * TODO: document this file
+ * Uniform refinement of a replicated or partitioned cmesh by one level.
+ * The refinement pattern of each element class is read from the refinement
+ * scheme of the cmesh, thus all element classes are supported for which the
+ * scheme implements the element functions used below.
  */
 
-/* TODO: could this file be part of cmesh_commit.c? */
-
 #include <t8_cmesh.h>
 #include <t8_element_cxx.hxx>
 #include "t8_cmesh_refine.h"
 #include "t8_cmesh_types.h"
 #include "t8_cmesh_trees.h"
 #include "t8_cmesh_partition.h"
+#include "t8_cmesh_offset.h"
 
-/* Since we do not now which children of a ghost will also be ghosts in the
- * refined cmesh we have to create a list of all those children for each coarse
- * ghost. In this list we store the child_id and the new local_id of the children
- * that are ghosts in the refined cmesh.
- * Thus, for each coarse ghost we get an array of maximal number of children entries.
- */
+/* The maximum number of vertex sets of a parent (vertices, edges, faces
+ * and the parent itself) whose center can be a vertex of a child. */
+#define T8_CMESH_REFINE_MAX_CENTERS 64
+
+/* The refinement pattern of one element class.
+ * Each vertex of a child is the center of a vertex, an edge, a face or
+ * the whole parent. We store it as the bitmask of the parent's vertices
+ * spanning this entity. Thus the vertex coordinates of a child are the
+ * mean of the coordinates of these parent vertices.
+ * Each face of a child is either connected to a face of another child
+ * or it lies on a face of the parent. */
 typedef struct
 {
-  int8_t              child_id;
-  t8_locidx_t         local_id;
-} t8_child_id_to_local_id;
-
-/* When setting the new ghost neighbors of a refined tree we have to look up the new local_ids
- * in this array. Thus we have to search in it for the respective child_id.
- * We store an additional entry with child_id = -1 at the end, so that
- * this search terminates when the entry is not found. */
-static              t8_locidx_t
-t8_cmesh_refine_childid_to_localid (t8_child_id_to_local_id ** idarray,
-                                    t8_locidx_t lparent_id, int8_t child_id)
+  /* The number of children of the parent. */
+  int                 num_children;
+  /* The reference coordinates of the parent's vertices. */
+  int                 root_coords[T8_ECLASS_MAX_CORNERS][3];
+  /* The class of each child. */
+  t8_eclass_t         child_class[T8_ECLASS_MAX_CHILDREN];
+  /* For each vertex of each child its bitmask of parent vertices. */
+  int                 child_vertex[T8_ECLASS_MAX_CHILDREN]
+    [T8_ECLASS_MAX_CORNERS];
+  /* For each face of each child the child id of its neighbor or -1 if
+   * the face lies on a face of the parent. */
+  int                 neighbor[T8_ECLASS_MAX_CHILDREN][T8_ECLASS_MAX_FACES];
+  /* The tree to face value of the connection if neighbor is not -1 and
+   * the parent face otherwise. */
+  int8_t              ttf[T8_ECLASS_MAX_CHILDREN][T8_ECLASS_MAX_FACES];
+} t8_cmesh_refine_pattern_t;
+
+/* The class and the face connections of a child tree of the refined cmesh.
+ * The face neighbors are given as global tree ids. */
+typedef struct
+{
+  t8_gloidx_t         global_id;        /* The global id of the child. */
+  /* The global ids of the face neighbors. */
+  t8_gloidx_t         neighbor[T8_ECLASS_MAX_FACES];
+  int8_t              ttf[T8_ECLASS_MAX_FACES]; /* The tree to face values of the faces. */
+  int8_t              eclass;   /* The class of the child. */
+} t8_cmesh_refine_child_t;
+
+/* A parent tree that has to be sent to a remote process */
+typedef struct
+{
+  int                 rank;     /* The remote process. */
+  t8_locidx_t         ltree_id; /* The local id of the parent tree. */
+} t8_cmesh_refine_send_t;
+
+static int
+t8_cmesh_refine_compare_send (const void *A, const void *B)
 {
-  int                 ichild;
-  int8_t              child_id_found = -2;
+  const t8_cmesh_refine_send_t *a = (const t8_cmesh_refine_send_t *) A;
+  const t8_cmesh_refine_send_t *b = (const t8_cmesh_refine_send_t *) B;
 
-  for (ichild = 0; child_id_found != child_id; ichild++) {
-    child_id_found = idarray[lparent_id][ichild].child_id;
-    T8_ASSERT (child_id_found != -1);   /* -1 marks the end of the array */
+  if (a->rank != b->rank) {
+    return a->rank < b->rank ? -1 : 1;
   }
-  T8_ASSERT (child_id_found == child_id);
-  return idarray[lparent_id][ichild - 1].local_id;
+  return (a->ltree_id > b->ltree_id) - (a->ltree_id < b->ltree_id);
 }
 
-/* Allocate memory for an array holding a child_id_to_local_id array for
- * each parent ghost. */
-static t8_child_id_to_local_id **
-t8_cmesh_refine_init_idarray (t8_cmesh_t cmesh_from)
+static int
+t8_cmesh_refine_compare_gloidx (const void *A, const void *B)
 {
-  return T8_ALLOC (t8_child_id_to_local_id *, cmesh_from->num_ghosts);
+  t8_gloidx_t         a = *(const t8_gloidx_t *) A;
+  t8_gloidx_t         b = *(const t8_gloidx_t *) B;
+
+  return (a > b) - (a < b);
 }
 
-/* Allocate and fill for a given parent ghost its entry in the idarray.
- * child_counted[i] is 1 if the child_id i of the parent will be a ghost in the
- * refined cmesh.
- * num_children is the number of nonzero entries in child_counted.
- * next_local_id is the next local ghost_id int the refined cmesh that was not
- * already set.
- * The return value is the local_id of the last child of gparent_id plus one.
- *
- * This function is meant to be called for each ghost parent in ascending order of
- * their local ids.
- */
-static              t8_locidx_t
-t8_cmesh_refine_fill_idarray (t8_child_id_to_local_id ** idarray,
-                              t8_locidx_t gparent_id,
-                              int8_t child_counted[10], int num_children,
-                              t8_locidx_t next_local_id)
+/* Return true if the first dim coordinates of two points are equal. */
+static int
+t8_cmesh_refine_coords_equal (const int *a, const int *b, int dim)
 {
-  int                 ichild, child_index;
-  int                 num_alloc;
-
-  num_alloc = num_children + 1;
-  idarray[gparent_id] = T8_ALLOC (t8_child_id_to_local_id, num_alloc);
-  for (ichild = 0, child_index = 0; ichild < num_children; ichild++) {
-    /* Look for the next nonzero entry in child_counted */
-    while (child_counted[child_index] == 0) {
-      child_index++;
-    }
-    /* set child id an local_id */
-    idarray[gparent_id][ichild].child_id = child_index;
-    idarray[gparent_id][ichild].local_id = next_local_id + ichild;
-    child_index++;
-  }
-  /* allocate one more entry and set it to -1,
-   * such that when searching we can check whether we are at the end of the array */
-  idarray[gparent_id][ichild].child_id = -1;
-  idarray[gparent_id][ichild].local_id = -1;
-  return next_local_id + num_children;
+  int                 idim;
+
+  for (idim = 0; idim < dim; idim++) {
+    if (a[idim] != b[idim]) {
+      return 0;
+    }
+  }
+  return 1;
 }
 
-static void
-t8_cmesh_refine_destroy_idarray (t8_child_id_to_local_id ** idarray,
-                                 t8_locidx_t num_parent_ghosts)
+/* Compute a value whose sign is the orientation of the vertices of
+ * an element of a given class. For 3D classes it is negative if and only
+ * if \ref t8_cmesh_tree_vertices_negative_volume is true, which uses
+ * the opposite sign for tets. */
+static double
+t8_cmesh_refine_orientation_sign (t8_eclass_t eclass,
+                                  int coords[T8_ECLASS_MAX_CORNERS][3])
 {
-  t8_locidx_t         lghost;
+  double              v[3][3], sign;
+  int                 idim, j;
 
-  for (lghost = 0; lghost < num_parent_ghosts; lghost++) {
-    T8_FREE (idarray[lghost]);
+  switch (t8_eclass_to_dimension[eclass]) {
+  case 0:
+    return 1;
+  case 1:
+    return coords[1][0] - coords[0][0];
+  case 2:
+    return (double) (coords[1][0] - coords[0][0]) *
+      (coords[2][1] - coords[0][1]) -
+      (double) (coords[1][1] - coords[0][1]) * (coords[2][0] - coords[0][0]);
+  default:
+    /* For tets and prisms the third vector is v_3, for hexes and
+     * pyramids v_4 */
+    j = eclass == T8_ECLASS_TET || eclass == T8_ECLASS_PRISM ? 3 : 4;
+    for (idim = 0; idim < 3; idim++) {
+      v[0][idim] = coords[1][idim] - coords[0][idim];
+      v[1][idim] = coords[2][idim] - coords[0][idim];
+      v[2][idim] = coords[j][idim] - coords[0][idim];
+    }
+    sign = v[2][0] * (v[0][1] * v[1][2] - v[0][2] * v[1][1])
+      + v[2][1] * (v[0][2] * v[1][0] - v[0][0] * v[1][2])
+      + v[2][2] * (v[0][0] * v[1][1] - v[0][1] * v[1][0]);
+    return eclass == T8_ECLASS_TET ? -sign : sign;
   }
-  T8_FREE (idarray);
 }
 
-/* Given a parent's local tree/ghost id and a child_id,
- * compute the new local id of the child to be used as a face neihgbor.
- * This works for local trees and ghosts. */
-/* TODO: This will not work anymore when pyramids are used together with other types */
-static              t8_locidx_t
-t8_cmesh_refine_new_neighborid (t8_cmesh_t cmesh_from, t8_locidx_t parent_id,
-                                int child_id,
-                                t8_child_id_to_local_id ** id_array,
-                                int factor)
+/* Swap two vertices of an element. */
+static void
+t8_cmesh_refine_swap_vertices (int coords[T8_ECLASS_MAX_CORNERS][3],
+                               int v1, int v2)
 {
-  if (parent_id >= cmesh_from->num_local_trees) {
-    /* The parent is a ghost */
-    return t8_cmesh_refine_childid_to_localid (id_array, parent_id
-                                               - cmesh_from->num_local_trees,
-                                               child_id)
-      + cmesh_from->num_local_trees * factor;   /* This is the new number of local trees */
-  }
-  else {
-    /* The parent is a tree */
-    return parent_id * factor + child_id;
-  }
+  int                 temp[3];
+
+  memcpy (temp, coords[v1], sizeof (temp));
+  memcpy (coords[v1], coords[v2], sizeof (temp));
+  memcpy (coords[v2], temp, sizeof (temp));
 }
 
-/*TODO: Will this function be used?*/
-#if 0
+/* Renumber the vertices of an element such that it is mirrored.
+ * The mirrored element is of the same class but has the opposite
+ * orientation. */
 static void
-t8_cmesh_refine_fill_childids (t8_eclass_t eclass, int **childidsA,
-                               int **childidsB)
+t8_cmesh_refine_mirror (t8_eclass_t eclass,
+                        int coords[T8_ECLASS_MAX_CORNERS][3])
 {
-  /* These arrays decode at index num_faces*or + neighbor_face the child id of the neighbor
-   * that we are connected to. For example if we consider child_id 0 and now it
-   * has a face neighbor along face 2 with orientation 0, then the child_id of
-   * the coarse neighbor's child we are connected to is neigh_childidsA[3*0+2] = 0.
-   * The encoding is such that neigh_childidsA is for child_id 0 (all iface) and child_id 1 if
-   * iface = 0, neigh_childidsB is for child_id 2 (all iface) and child_id 1 if iface = 1.
-   */
-  /* TODO: t8_eclass_num_children is deprecated */
-  *childidsA = T8_ALLOC (int, t8_eclass_num_children[eclass] * 2);
-  *childidsB = T8_ALLOC (int, t8_eclass_num_children[eclass] * 2);
-  switch (eclass) {
-  case T8_ECLASS_QUAD:
-    (*childidsA)[0] = (*childidsB)[4] = 0;
-    (*childidsA)[1] = (*childidsB)[5] = 1;
-    (*childidsA)[2] = (*childidsB)[6] = 0;
-    (*childidsA)[3] = (*childidsB)[7] = 2;
-    (*childidsA)[4] = (*childidsB)[0] = 2;
-    (*childidsA)[5] = (*childidsB)[1] = 3;
-    (*childidsA)[6] = (*childidsB)[2] = 1;
-    (*childidsA)[7] = (*childidsB)[3] = 3;
-    break;
-  case T8_ECLASS_TRIANGLE:
-    (*childidsA)[0] = (*childidsB)[3] = 1;
-    (*childidsA)[1] = (*childidsB)[4] = 0;
-    (*childidsA)[2] = (*childidsB)[5] = 0;
-    (*childidsA)[3] = (*childidsB)[0] = 2;
-    (*childidsA)[4] = (*childidsB)[1] = 2;
-    (*childidsA)[5] = (*childidsB)[2] = 1;
-    break;
-  default:
-    SC_ABORT_NOT_REACHED ();
+  T8_ASSERT (t8_eclass_to_dimension[eclass] >= 2);
+
+  /* Exchanging the second and third vertex mirrors quads, triangles, tets
+   * and pyramids. For prisms and hexes we also need to mirror the top. */
+  t8_cmesh_refine_swap_vertices (coords, 1, 2);
+  if (eclass == T8_ECLASS_PRISM) {
+    t8_cmesh_refine_swap_vertices (coords, 4, 5);
+  }
+  else if (eclass == T8_ECLASS_HEX) {
+    t8_cmesh_refine_swap_vertices (coords, 5, 6);
   }
 }
-#endif
 
-/* Given a parent's global tree/ghost id and a child_id,
- * compute the new global id of the child. */
-/* TODO: This will not work anymore when pyramids are used together with other types */
-static              t8_gloidx_t
-t8_cmesh_refine_new_globalid (t8_gloidx_t parent_id, int child_id, int factor)
+/* Store the bitmasks of a child's face vertices in corners and return their
+ * number. */
+static int
+t8_cmesh_refine_face_corners (const t8_cmesh_refine_pattern_t * pattern,
+                              int child_id, int face, int *corners)
 {
-  return parent_id * factor + child_id;
+  t8_eclass_t         eclass = pattern->child_class[child_id];
+  int                 num_corners, icorner;
+
+  num_corners = t8_eclass_num_vertices[t8_eclass_face_types[eclass][face]];
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    corners[icorner] = pattern->child_vertex[child_id]
+      [t8_face_vertex_to_tree_vertex[eclass][face][icorner]];
+  }
+  return num_corners;
 }
 
-/* TODO: Will this function be needed? */
-#if 0
-static void
-t8_cmesh_refine_outer_faces (t8_cmesh_t cmesh_from, t8_locidx_t parent_id,
-                             t8_gloidx_t global_parent_id,
-                             t8_eclass_t eclass,
-                             t8_child_id_to_local_id ** id_array,
-                             int child_id,
-                             t8_locidx_t * neighbor_out,
-                             t8_gloidx_t * neighbor_out_ghost,
-                             t8_locidx_t * neighbor_old,
-                             t8_gloidx_t * gneighbor_old,
-                             int8_t * ttf_out, int8_t * ttf_old, int factor,
-                             int compute_ghost)
+/* Return true if two faces have the same vertices. */
+static int
+t8_cmesh_refine_same_face (const int *corners_a, const int *corners_b,
+                           int num_corners)
 {
-  int                *neigh_childidsA, *neigh_childidsB;
-  int                 num_faces, iface, F;
-  int                 old_face, orient;
-  int                 new_neigh_childid;
-  t8_locidx_t         old_neigh;
-  t8_gloidx_t         old_neigh_ghost;
-
-  num_faces = t8_eclass_num_faces[eclass];
-  t8_cmesh_refine_fill_childids (eclass, &neigh_childidsA, &neigh_childidsB);
-  F = t8_eclass_max_num_faces[cmesh_from->dimension];
-  for (iface = 0; iface < num_faces; iface++) {
-    if (iface == child_id) {
-      /* We already set this side */
-      continue;
-    }
-    /* Get the old face neighbor, face number and orientation */
-    if (!compute_ghost) {
-      old_neigh = neighbor_old[iface];
+  int                 ia, ib;
+
+  for (ia = 0; ia < num_corners; ia++) {
+    for (ib = 0; ib < num_corners && corners_b[ib] != corners_a[ia]; ib++) {
     }
-    else {
-      old_neigh_ghost = gneighbor_old[iface];
-    }
-    old_face = ttf_old[iface] % F;
-    orient = ttf_old[iface] / F;
-    if (!compute_ghost && old_neigh == parent_id) {
-      /* We are local tree and this side is a boundary,
-       * so we set our own local id as face neighbor */
-      neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                            parent_id,
-                                                            child_id,
-                                                            id_array, factor);
-    }
-    else if (compute_ghost && old_neigh_ghost == global_parent_id) {
-      /* We are local ghost and this side is a boundary,
-       * so we set our own glocal id as face neighbor */
-      neighbor_out_ghost[iface] =
-        t8_cmesh_refine_new_globalid (global_parent_id, child_id, factor);
+    if (ib == num_corners) {
+      return 0;
     }
-    else {
-      /* depending on the child_id and old_face we set the new neighbors
-       * child_id */
-      if (2 * child_id + iface <= 2) {
-        new_neigh_childid = neigh_childidsA[orient * 3 + old_face];
-      }
-      else {
-        new_neigh_childid = neigh_childidsB[orient * 3 + old_face];
-      }
-      if (!compute_ghost) {
-        /* Compute the new neighbors local id from the old one and the new
-         * child id */
-        neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                              old_neigh,
-                                                              new_neigh_childid,
-                                                              id_array,
-                                                              factor);
-      }
-      else {
-        neighbor_out_ghost[iface] =
-          t8_cmesh_refine_new_globalid (old_neigh_ghost,
-                                        new_neigh_childid, factor);
-      }
-    }
-    /* The new orientation and face number are the same as the old
-     * ones so we do not need to change ttf_out */
-    ttf_out[iface] = ttf_old[iface];
   }
+  return 1;
 }
-#endif
 
-/* TODO: comment */
-/* The eclass is the eclass of the parent tree */
-/* parent_id is the local id of the parent and global_parent_id the
- * global one. The global id is only needed when parent is a ghost */
-/* id_array is the array storing the new local ids of the ghosts */
-/* neighbor_out are the face neighbors if parent is a local tree and
- * neighbor_out_ghost if parent is a ghost */
-/* Factor should be the same whether parent is a tree or a ghost */
-static void
-t8_cmesh_refine_new_neighbors (t8_cmesh_t cmesh_from, t8_locidx_t parent_id,
-                               t8_gloidx_t global_parent_id,
-                               t8_eclass_t eclass,
-                               t8_child_id_to_local_id ** id_array,
-                               int child_id,
-                               t8_locidx_t * neighbor_out,
-                               t8_gloidx_t * neighbor_out_ghost,
-                               int8_t * ttf_out, int factor)
+/* Compute the orientation of a connection between two faces with the
+ * same vertices. The orientation is the number of the vertex of the
+ * bigger face that coincides with the first vertex of the smaller one.
+ * A face is smaller if its tree class is smaller or if the classes are
+ * equal and its face number is smaller. */
+static int
+t8_cmesh_refine_orientation (t8_eclass_t eclass_a, int face_a,
+                             const int *corners_a,
+                             t8_eclass_t eclass_b, int face_b,
+                             const int *corners_b, int num_corners)
 {
-  t8_locidx_t         iface, old_neigh = -1, *neighbor_old;     /* old_neigh and old_neigh_ghost get initial */
-  t8_gloidx_t         old_neigh_ghost = -1, *gneighbor_old;     /* values to prevent unused variable warnings */
-  int8_t             *ttf_old;
-  int                 num_faces, F, dim, old_face, orient, new_neigh_childid;
-  int                 compute_ghost, k;
+  const int          *bigger;
+  int                 compare, first, icorner;
 
-  /* One of the inputs must be NULL and the other one must be set */
-  T8_ASSERT (neighbor_out == NULL || neighbor_out_ghost == NULL);
-  T8_ASSERT (neighbor_out != NULL || neighbor_out_ghost != NULL);
+  compare = t8_eclass_compare (eclass_a, eclass_b);
+  if (compare < 0 || (compare == 0 && face_a <= face_b)) {
+    first = corners_a[0];
+    bigger = corners_b;
+  }
+  else {
+    first = corners_b[0];
+    bigger = corners_a;
+  }
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    if (bigger[icorner] == first) {
+      return icorner;
+    }
+  }
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
 
-  /* Flag to decide whether we compute the neighbors of a ghost or not */
-  compute_ghost = neighbor_out_ghost != NULL;
+/* Compute the refinement pattern of an element class from its scheme. */
+static void
+t8_cmesh_refine_pattern_init (t8_cmesh_refine_pattern_t * pattern,
+                              t8_eclass_t eclass, t8_scheme_cxx_t * scheme)
+{
+  t8_eclass_scheme_c *ts = scheme->eclass_schemes[eclass];
+  t8_element_t       *root, **children;
+  t8_eclass_t         child_class, face_class;
+  int                 centers[T8_CMESH_REFINE_MAX_CENTERS];
+  int                 face_mask[T8_ECLASS_MAX_FACES];
+  int                 coords[T8_ECLASS_MAX_CORNERS][3];
+  int                 corners[T8_ECLASS_MAX_CORNERS_2D];
+  int                 neigh_corners[T8_ECLASS_MAX_CORNERS_2D];
+  int                 dim, F, num_vertices, num_centers, num_corners;
+  int                 ichild, jchild, iface, jface, iv, ic, idim, k, l;
+  int                 sum, count, icenter;
+  double              root_sign;
 
+  T8_ASSERT (ts != NULL);
   dim = t8_eclass_to_dimension[eclass];
   F = t8_eclass_max_num_faces[dim];
-  num_faces = t8_eclass_num_faces[eclass];
-  if (compute_ghost) {
-    (void) t8_cmesh_trees_get_ghost_ext (cmesh_from->trees, parent_id,
-                                         &gneighbor_old, &ttf_old);
+  num_vertices = t8_eclass_num_vertices[eclass];
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  memset (pattern->root_coords, 0, sizeof (pattern->root_coords));
+  for (iv = 0; iv < num_vertices; iv++) {
+    ts->t8_element_vertex_coords (root, iv, pattern->root_coords[iv]);
   }
-  else {
-    (void) t8_cmesh_trees_get_tree_ext (cmesh_from->trees, parent_id,
-                                        &neighbor_old, &ttf_old);
-  }
-  switch (eclass) {
-  case T8_ECLASS_QUAD:
-    /* Inner face connections */
-    /* For the inner face connections we have
-     *                 faces
-     * child_id     f_0 f_1 f_2 f_3
-     *    0          -   1   -   2
-     *    1          0   -   -   3
-     *    2          -   3   0   -
-     *    3          2   -   1   -
-     *
-     *   This means that child i along its face f_j is connected to the child
-     *   given in the table.
-     *   These values can be computed as follows:
-     *   child i is connected along face 1-(i%2) with child (1 xor i)
-     *                    and along face 3-(i/2) with child (2 xor i)
-     *   The face number on the neighbor of this connection is (j xor 1)
-     * The orientation for each of these connections is 0.
-     */
-    for (k = 1, iface = 1 - (child_id % 2); k <= 2;
-         k++, iface = 3 - child_id / 2) {
-      if (!compute_ghost) {
-        neighbor_out[iface] =
-          t8_cmesh_refine_new_neighborid (cmesh_from, parent_id, child_id ^ k,
-                                          id_array, factor);
-      }
-      else {
-        neighbor_out_ghost[iface] =
-          t8_cmesh_refine_new_globalid (global_parent_id, child_id ^ k,
-                                        factor);
-      }
-      ttf_out[iface] = iface ^ 1;
+  root_sign = t8_cmesh_refine_orientation_sign (eclass, pattern->root_coords);
+
+  /* Collect the vertex sets whose center may be a vertex of a child.
+   * We order them by dimension, since for example the center of a square
+   * is also the center of its diagonals. */
+  num_centers = 0;
+  for (iv = 0; iv < num_vertices; iv++) {
+    centers[num_centers++] = 1 << iv;
+  }
+  for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+    face_class = (t8_eclass_t) t8_eclass_face_types[eclass][iface];
+    num_corners = t8_eclass_num_vertices[face_class];
+    face_mask[iface] = 0;
+    for (k = 0; k < num_corners; k++) {
+      face_mask[iface] |= 1 << t8_face_vertex_to_tree_vertex[eclass][iface][k];
     }
-    /* Outer face connections */
-    for (k = 0, iface = child_id % 2; k < 2; k++, iface = 2 + child_id / 2) {
-      /* Get the old face neighbor, face number and orientation */
-      if (!compute_ghost) {
-        old_neigh = neighbor_old[iface];
-      }
-      else {
-        old_neigh_ghost = gneighbor_old[iface];
-      }
-      old_face = ttf_old[iface] % F;
-      orient = ttf_old[iface] / F;
-      if (!compute_ghost && old_neigh == parent_id) {
-        /* We are local tree and this side is a boundary,
-         * so we set our own local id as face neighbor */
-        neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                              parent_id,
-                                                              child_id,
-                                                              id_array,
-                                                              factor);
-      }
-      else if (compute_ghost && old_neigh_ghost == global_parent_id) {
-        /* We are local ghost and this side is a boundary,
-         * so we set our own glocal id as face neighbor */
-        neighbor_out_ghost[iface] =
-          t8_cmesh_refine_new_globalid (global_parent_id, child_id, factor);
-      }
-      else {
-        /* We are connected to another tree */
-        /* These arrays decode at index 4*or + neighbor_face the child id of the neighbor
-         * that we are connected to. For example if we consider child_id 0 and now it
-         * has a face neighbor along face 2 with orientation 0, then the child_id of
-         * the coarse neighbor's child we are connected to is neigh_childidsA[4*0+2] = 0.
-         * The encoding is such that neigh_childidsA is for child_id 0 (all iface), child_id 1 if
-         * iface = 2, child_id 3 if iface = 3, neigh_childidsB is for child_id 1 if iface = 1,
-         * child_id 2 if iface = 0 and child_id 3 (all ifaces).
-         */
-        int                 neigh_childidsA[8] = { 0, 1, 0, 2, 2, 3, 1, 3 };
-        int                 neigh_childidsB[8] = { 2, 3, 1, 3, 0, 1, 0, 2 };
-        /* depending on the child_id and old_face we set the new neighbors
-         * child_id */
-        if (child_id == 0 || (child_id != 3 && iface % 2)) {
-          new_neigh_childid = neigh_childidsA[orient * 4 + old_face];
-        }
-        else {
-          T8_ASSERT (child_id == 3 || iface % 2 == 0);
-          new_neigh_childid = neigh_childidsB[orient * 4 + old_face];
+    if (dim == 2) {
+      /* The faces are the edges */
+      centers[num_centers++] = face_mask[iface];
+    }
+    else if (dim == 3) {
+      /* The edges of the face, for quads 0-3 and 1-2 are diagonals */
+      for (k = 0; k < num_corners; k++) {
+        for (l = k + 1; l < num_corners; l++) {
+          if (face_class == T8_ECLASS_TRIANGLE || (k ^ l) != 3) {
+            centers[num_centers++] =
+              (1 << t8_face_vertex_to_tree_vertex[eclass][iface][k]) |
+              (1 << t8_face_vertex_to_tree_vertex[eclass][iface][l]);
+          }
         }
-        if (!compute_ghost) {
-          /* Compute the new neighbors local id from the old one and the new
-           * child id */
-          neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                                old_neigh,
-                                                                new_neigh_childid,
-                                                                id_array,
-                                                                factor);
+      }
+    }
+  }
+  if (dim == 3) {
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      centers[num_centers++] = face_mask[iface];
+    }
+  }
+  centers[num_centers++] = (1 << num_vertices) - 1;
+  T8_ASSERT (num_centers <= T8_CMESH_REFINE_MAX_CENTERS);
+
+  /* Compute the children and their vertices */
+  pattern->num_children = ts->t8_element_num_children (root);
+  T8_ASSERT (pattern->num_children <= T8_ECLASS_MAX_CHILDREN);
+  children = T8_ALLOC (t8_element_t *, pattern->num_children);
+  ts->t8_element_new (pattern->num_children, children);
+  ts->t8_element_children (root, pattern->num_children, children);
+  for (ichild = 0; ichild < pattern->num_children; ichild++) {
+    child_class = ts->t8_element_shape (children[ichild]);
+    pattern->child_class[ichild] = child_class;
+    memset (coords, 0, sizeof (coords));
+    for (iv = 0; iv < t8_eclass_num_vertices[child_class]; iv++) {
+      ts->t8_element_vertex_coords (children[ichild], iv, coords[iv]);
+    }
+    /* A child must have the same orientation as its parent, otherwise
+     * it would have negative volume. */
+    if (t8_cmesh_refine_orientation_sign (child_class, coords) * root_sign
+        < 0) {
+      t8_cmesh_refine_mirror (child_class, coords);
+    }
+    for (iv = 0; iv < t8_eclass_num_vertices[child_class]; iv++) {
+      /* Find the first vertex set whose center is this vertex */
+      for (ic = 0; ic < num_centers; ic++) {
+        for (idim = 0; idim < dim; idim++) {
+          for (icenter = 0, sum = 0, count = 0; icenter < num_vertices;
+               icenter++) {
+            if (centers[ic] & (1 << icenter)) {
+              sum += pattern->root_coords[icenter][idim];
+              count++;
+            }
+          }
+          if (sum != count * coords[iv][idim]) {
+            break;
+          }
         }
-        else {
-          neighbor_out_ghost[iface] =
-            t8_cmesh_refine_new_globalid (old_neigh_ghost,
-                                          new_neigh_childid, factor);
+        if (idim == dim) {
+          break;
         }
       }
-      /* The new orientation and face number are the same as the old
-       * ones so we do not need to change ttf_out */
-      ttf_out[iface] = ttf_old[iface];
-    }
-    break;
-  case T8_ECLASS_TRIANGLE:
-    if (child_id == 3) {
-      T8_ASSERT (!compute_ghost);
-      /* The triangle in the middle is connect to child i on face i.
-       * The orientation of each edge is 1 */
-      for (iface = 0; iface < num_faces; iface++) {
-        /* Set the new local id of the face neighbors */
-        /* face    neighbor child_id      2 - face
-         *   0          2                   2
-         *   1          1                   1
-         *   2          0                   0
-         */
-        neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                              parent_id,
-                                                              2 - iface,
-                                                              id_array,
-                                                              factor);
-        /* Set the new orientation and face number */
-        ttf_out[iface] = 1 * F + 2 - iface;
-      }
+      SC_CHECK_ABORTF (ic < num_centers, "Cannot refine a %s tree: vertex %i"
+                       " of child %i is not supported.\n",
+                       t8_eclass_to_string[eclass], iv, ichild);
+      pattern->child_vertex[ichild][iv] = centers[ic];
     }
-    else {
-      /* child_id is 0,1,2 */
-      T8_ASSERT (0 <= child_id && child_id <= 2);
-      if (!compute_ghost) {
-        /* Along face number child_id we are connected with the middle triangle
-         * which has child_id = 3, we are connected with its face 2 - child_id */
-        neighbor_out[child_id] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                                 parent_id, 3,
-                                                                 id_array,
-                                                                 factor);
+  }
+
+  /* Compute the face connections of the children */
+  for (ichild = 0; ichild < pattern->num_children; ichild++) {
+    child_class = pattern->child_class[ichild];
+    for (iface = 0; iface < t8_eclass_num_faces[child_class]; iface++) {
+      num_corners =
+        t8_cmesh_refine_face_corners (pattern, ichild, iface, corners);
+      /* Check whether the face lies on a face of the parent */
+      for (jface = 0; jface < t8_eclass_num_faces[eclass]; jface++) {
+        for (k = 0; k < num_corners && !(corners[k] & ~face_mask[jface]);
+             k++) {
+        }
+        if (k == num_corners) {
+          break;
+        }
       }
-      else {
-        neighbor_out_ghost[child_id] =
-          t8_cmesh_refine_new_globalid (global_parent_id, 3, factor);
+      if (jface < t8_eclass_num_faces[eclass]) {
+        pattern->neighbor[ichild][iface] = -1;
+        pattern->ttf[ichild][iface] = jface;
+        continue;
       }
-      ttf_out[child_id] = 1 * F + 2 - child_id;
-      for (iface = 0; iface < num_faces; iface++) {
-        if (iface == child_id) {
-          /* We already set this side */
+      /* The face is connected to another child */
+      for (jchild = 0; jchild < pattern->num_children; jchild++) {
+        if (jchild == ichild) {
           continue;
         }
-        /* Get the old face neighbor, face number and orientation */
-        if (!compute_ghost) {
-          old_neigh = neighbor_old[iface];
+        for (jface = 0;
+             jface < t8_eclass_num_faces[pattern->child_class[jchild]];
+             jface++) {
+          if (t8_cmesh_refine_face_corners (pattern, jchild, jface,
+                                            neigh_corners) == num_corners
+              && t8_cmesh_refine_same_face (corners, neigh_corners,
+                                            num_corners)) {
+            break;
+          }
         }
-        else {
-          old_neigh_ghost = gneighbor_old[iface];
+        if (jface < t8_eclass_num_faces[pattern->child_class[jchild]]) {
+          break;
         }
-        old_face = ttf_old[iface] % F;
-        orient = ttf_old[iface] / F;
-        if (!compute_ghost && old_neigh == parent_id) {
-          /* We are local tree and this side is a boundary,
-           * so we set our own local id as face neighbor */
-          neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                                parent_id,
-                                                                child_id,
-                                                                id_array,
-                                                                factor);
+      }
+      SC_CHECK_ABORTF (jchild < pattern->num_children,
+                       "Cannot refine a %s tree: No neighbor at face %i of"
+                       " child %i.\n", t8_eclass_to_string[eclass], iface,
+                       ichild);
+      pattern->neighbor[ichild][iface] = jchild;
+      pattern->ttf[ichild][iface] = F *
+        t8_cmesh_refine_orientation (child_class, iface, corners,
+                                     pattern->child_class[jchild], jface,
+                                     neigh_corners, num_corners) + jface;
+    }
+  }
+  ts->t8_element_destroy (pattern->num_children, children);
+  ts->t8_element_destroy (1, &root);
+  T8_FREE (children);
+}
+
+/* Given a face connection between two parents, compute for each vertex of
+ * the parent's face the vertex of the neighbor's face that it coincides
+ * with. We use the same face transformation as the forest does for the
+ * element neighbors across tree boundaries:
+ * For each vertex we build the corner child of the parent at this vertex,
+ * transform its face to the neighbor and extrude it there. The extruded
+ * child contains exactly one vertex of the neighbor's face. */
+static void
+t8_cmesh_refine_face_map (t8_scheme_cxx_t * scheme,
+                          const t8_cmesh_refine_pattern_t * neigh_pattern,
+                          t8_eclass_t eclass, int face,
+                          t8_eclass_t neigh_eclass, int neigh_face,
+                          int orientation,
+                          int vertex_map[T8_ECLASS_MAX_CORNERS])
+{
+  t8_eclass_scheme_c *ts, *face_scheme, *neigh_scheme;
+  t8_element_t       *root, **children, *face_element, *neigh;
+  t8_eclass_t         face_class, child_class;
+  int                 num_corners, num_children, dim, compare;
+  int                 is_smaller, sign, icorner, vertex, ichild, iv, cface;
+  int                 jcorner, found;
+  int                 coords[3], child_coords[3];
+
+  face_class = (t8_eclass_t) t8_eclass_face_types[eclass][face];
+  num_corners = t8_eclass_num_vertices[face_class];
+  if (face_class == T8_ECLASS_VERTEX) {
+    /* A vertex is mapped to the vertex */
+    vertex_map[t8_face_vertex_to_tree_vertex[eclass][face][0]] =
+      t8_face_vertex_to_tree_vertex[neigh_eclass][neigh_face][0];
+    return;
+  }
+  dim = t8_eclass_to_dimension[eclass];
+  ts = scheme->eclass_schemes[eclass];
+  face_scheme = scheme->eclass_schemes[face_class];
+  neigh_scheme = scheme->eclass_schemes[neigh_eclass];
+  /* The orientation is relative to the smaller face */
+  compare = t8_eclass_compare (eclass, neigh_eclass);
+  is_smaller = compare < 0 || (compare == 0 && face <= neigh_face);
+  sign = t8_eclass_face_orientation[eclass][face] ==
+    t8_eclass_face_orientation[neigh_eclass][neigh_face];
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  num_children = ts->t8_element_num_children (root);
+  children = T8_ALLOC (t8_element_t *, num_children);
+  ts->t8_element_new (num_children, children);
+  ts->t8_element_children (root, num_children, children);
+  face_scheme->t8_element_new (1, &face_element);
+  neigh_scheme->t8_element_new (1, &neigh);
+
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    vertex = t8_face_vertex_to_tree_vertex[eclass][face][icorner];
+    ts->t8_element_vertex_coords (root, vertex, coords);
+    /* Find the child at this vertex and its face on the parent's face */
+    found = 0;
+    for (ichild = 0; ichild < num_children && !found; ichild++) {
+      child_class = ts->t8_element_shape (children[ichild]);
+      for (iv = 0; iv < t8_eclass_num_vertices[child_class]; iv++) {
+        ts->t8_element_vertex_coords (children[ichild], iv, child_coords);
+        if (t8_cmesh_refine_coords_equal (coords, child_coords, dim)) {
+          break;
         }
-        else if (compute_ghost && old_neigh_ghost == global_parent_id) {
-          /* We are local ghost and this side is a boundary,
-           * so we set our own glocal id as face neighbor */
-          neighbor_out_ghost[iface] =
-            t8_cmesh_refine_new_globalid (global_parent_id, child_id, factor);
+      }
+      if (iv == t8_eclass_num_vertices[child_class]) {
+        continue;
+      }
+      for (cface = 0; cface < t8_eclass_num_faces[child_class] && !found;
+           cface++) {
+        if (ts->t8_element_is_root_boundary (children[ichild], cface)
+            && ts->t8_element_tree_face (children[ichild], cface) == face) {
+          ts->t8_element_boundary_face (children[ichild], cface,
+                                        face_element, face_scheme);
+          found = 1;
         }
-        else {
-          /* These arrays decode at index 3*or + neighbor_face the child id of the neighbor
-           * that we are connected to. For example if we consider child_id 0 and now it
-           * has a face neighbor along face 2 with orientation 0, then the child_id of
-           * the coarse neighbor's child we are connected to is neigh_childidsA[3*0+2] = 0.
-           * The encoding is such that neigh_childidsA is for child_id 0 (all iface) and child_id 1 if
-           * iface = 0, neigh_childidsB is for child_id 2 (all iface) and child_id 1 if iface = 1.
-           */
-          int                 neigh_childidsA[6] = { 1, 0, 0, 2, 2, 1 };
-          int                 neigh_childidsB[6] = { 2, 2, 1, 1, 0, 0 };
-          /* depending on the child_id and old_face we set the new neighbors
-           * child_id */
-          if (2 * child_id + iface <= 2) {
-            new_neigh_childid = neigh_childidsA[orient * 3 + old_face];
-          }
-          else {
-            new_neigh_childid = neigh_childidsB[orient * 3 + old_face];
-          }
-          if (!compute_ghost) {
-            /* Compute the new neighbors local id from the old one and the new
-             * child id */
-            neighbor_out[iface] = t8_cmesh_refine_new_neighborid (cmesh_from,
-                                                                  old_neigh,
-                                                                  new_neigh_childid,
-                                                                  id_array,
-                                                                  factor);
-          }
-          else {
-            neighbor_out_ghost[iface] =
-              t8_cmesh_refine_new_globalid (old_neigh_ghost,
-                                            new_neigh_childid, factor);
-          }
+      }
+    }
+    T8_ASSERT (found);
+    face_scheme->t8_element_transform_face (face_element, face_element,
+                                            orientation, sign, is_smaller);
+    (void) neigh_scheme->t8_element_extrude_face (face_element, face_scheme,
+                                                  neigh, neigh_face);
+    vertex_map[vertex] = -1;
+    child_class = neigh_scheme->t8_element_shape (neigh);
+    for (iv = 0; iv < t8_eclass_num_vertices[child_class]; iv++) {
+      neigh_scheme->t8_element_vertex_coords (neigh, iv, child_coords);
+      for (jcorner = 0; jcorner < num_corners; jcorner++) {
+        if (t8_cmesh_refine_coords_equal (child_coords,
+                                          neigh_pattern->root_coords
+                                          [t8_face_vertex_to_tree_vertex
+                                           [neigh_eclass][neigh_face]
+                                           [jcorner]], dim)) {
+          vertex_map[vertex] =
+            t8_face_vertex_to_tree_vertex[neigh_eclass][neigh_face][jcorner];
         }
-        /* The new orientation and face number are the same as the old
-         * ones so we do not need to change ttf_out */
-        ttf_out[iface] = ttf_old[iface];
       }
     }
-    break;
-  default:
-    SC_ABORTF ("Not implemented %s.\n", "yet");
+    SC_CHECK_ABORTF (vertex_map[vertex] >= 0, "Cannot match face %i of a %s"
+                     " tree with face %i of a %s tree.\n", face,
+                     t8_eclass_to_string[eclass], neigh_face,
+                     t8_eclass_to_string[neigh_eclass]);
   }
+  neigh_scheme->t8_element_destroy (1, &neigh);
+  face_scheme->t8_element_destroy (1, &face_element);
+  ts->t8_element_destroy (num_children, children);
+  ts->t8_element_destroy (1, &root);
+  T8_FREE (children);
 }
 
-/* Compute the coordinates of the i-th child of a tree of a given class
- * from the coordinates of that three.
- *
- * !!! For Triangles and Tets we use Bey's original order !!!
- *
- *          x_2
- *          /\
- *         /2 \
- *        /____\
- *       /\ 3  /\       For Triangles.
- *      /0 \  / 1\
- *     /____\/____\
- *    x_0          x_1
- *
- */
-/* TODO: Implement for prisms, Pyramids, points and lines */
+/* Return the class and the global id of a local tree or ghost of cmesh_from.
+ * ltree_id is a local tree id or the number of local trees plus a local
+ * ghost id. */
+static              t8_eclass_t
+t8_cmesh_refine_parent_class (t8_cmesh_t cmesh_from, t8_locidx_t ltree_id,
+                              t8_gloidx_t * global_id)
+{
+  t8_cghost_t         ghost;
+
+  if (ltree_id < cmesh_from->num_local_trees) {
+    *global_id = cmesh_from->first_tree + ltree_id;
+    return t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id)->eclass;
+  }
+  ghost = t8_cmesh_trees_get_ghost (cmesh_from->trees,
+                                    ltree_id - cmesh_from->num_local_trees);
+  *global_id = ghost->treeid;
+  return ghost->eclass;
+}
+
+/* Compute the classes and face connections of the children of a local tree
+ * of cmesh_from.
+ * child_offset stores for each local tree and ghost of cmesh_from the global
+ * id of its first child. It must be known for the tree and for all its
+ * face neighbors. */
 static void
-t8_cmesh_refine_new_coord (const double *coords_in,
-                           t8_eclass_t eclass, int child_id,
-                           double *coords_out)
+t8_cmesh_refine_tree_children (t8_cmesh_t cmesh_from,
+                               t8_scheme_cxx_t * scheme,
+                               const t8_cmesh_refine_pattern_t * patterns,
+                               const t8_gloidx_t * child_offset,
+                               t8_locidx_t ltree_id,
+                               t8_cmesh_refine_child_t * children)
 {
-  int                 num_vertices, ivertex, dim, idim;
-  int                 coord_lookup[8];
+  t8_ctree_t          tree;
+  t8_locidx_t        *tree_neighbors, lneigh;
+  t8_gloidx_t         gneigh;
+  t8_eclass_t         neigh_class;
+  t8_cmesh_refine_child_t *child;
+  const t8_cmesh_refine_pattern_t *pattern, *neigh_pattern;
+  int8_t             *tree_ttf;
+  int                 vertex_map[T8_ECLASS_MAX_FACES][T8_ECLASS_MAX_CORNERS];
+  int                 corners[T8_ECLASS_MAX_CORNERS_2D];
+  int                 neigh_corners[T8_ECLASS_MAX_CORNERS_2D];
+  int                 F, pface, neigh_face, ichild, iface, jchild, jface;
+  int                 num_corners, icorner, iv, mask;
 
-  T8_ASSERT (coords_in != NULL);
-  T8_ASSERT (eclass == T8_ECLASS_HEX || eclass == T8_ECLASS_QUAD
-             || eclass == T8_ECLASS_TRIANGLE || eclass == T8_ECLASS_TET);
+  tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, ltree_id,
+                                      &tree_neighbors, &tree_ttf);
+  pattern = patterns + tree->eclass;
+  F = t8_eclass_max_num_faces[cmesh_from->dimension];
+  T8_ASSERT (child_offset[ltree_id] >= 0);
 
-  num_vertices = t8_eclass_num_vertices[eclass];
-  dim = t8_eclass_to_dimension[eclass];
-  switch (eclass) {
-  case T8_ECLASS_QUAD:
-  case T8_ECLASS_HEX:
-    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
-      for (idim = 0; idim < dim; idim++) {
-        /* Xout_i = Xin_i,childid   ,where i=ivertex and x_ij = (x_i+x_j)/2 */
-        coords_out[dim * ivertex + idim] =
-          (coords_in[dim * ivertex + idim] +
-           coords_in[dim * child_id + idim]) / 2;
-      }
+  /* Match the vertices of the parent's faces with those of the neighbors */
+  for (pface = 0; pface < t8_eclass_num_faces[tree->eclass]; pface++) {
+    lneigh = tree_neighbors[pface];
+    neigh_face = tree_ttf[pface] % F;
+    if (lneigh == ltree_id && neigh_face == pface) {
+      /* This face is a boundary */
+      continue;
     }
-    break;
-  case T8_ECLASS_TET:
-  case T8_ECLASS_TRIANGLE:
-    switch (child_id) {
-    case 0:
-    case 1:
-    case 2:
-    case 3:                    /* Xout_i = Xin_i,childid   ,where i=ivertex and x_ij = (x_i+x_j)/2 */
-      coord_lookup[0] = 0;
-      coord_lookup[1] = child_id;
-      coord_lookup[2] = 1;
-      coord_lookup[3] = child_id;
-      coord_lookup[4] = 2;
-      coord_lookup[5] = child_id;
-      coord_lookup[6] = 3;
-      coord_lookup[7] = child_id;
-      if (eclass == T8_ECLASS_TRIANGLE && child_id == 3) {
-        coord_lookup[0] = 0;
-        coord_lookup[1] = 1;
-        coord_lookup[2] = 0;
-        coord_lookup[3] = 2;
-        coord_lookup[4] = 1;
-        coord_lookup[5] = 2;
+    neigh_class = t8_cmesh_refine_parent_class (cmesh_from, lneigh, &gneigh);
+    t8_cmesh_refine_face_map (scheme, patterns + neigh_class, tree->eclass,
+                              pface, neigh_class, neigh_face,
+                              tree_ttf[pface] / F, vertex_map[pface]);
+  }
+
+  for (ichild = 0; ichild < pattern->num_children; ichild++) {
+    child = children + ichild;
+    child->global_id = child_offset[ltree_id] + ichild;
+    child->eclass = pattern->child_class[ichild];
+    for (iface = 0; iface < t8_eclass_num_faces[child->eclass]; iface++) {
+      if (pattern->neighbor[ichild][iface] >= 0) {
+        /* The neighbor is a sibling */
+        child->neighbor[iface] =
+          child_offset[ltree_id] + pattern->neighbor[ichild][iface];
+        child->ttf[iface] = pattern->ttf[ichild][iface];
+        continue;
+      }
+      pface = pattern->ttf[ichild][iface];
+      lneigh = tree_neighbors[pface];
+      neigh_face = tree_ttf[pface] % F;
+      if (lneigh == ltree_id && neigh_face == pface) {
+        /* The face lies on the domain boundary */
+        child->neighbor[iface] = child->global_id;
+        child->ttf[iface] = iface;
+        continue;
+      }
+      /* The neighbor is a child of the parent's face neighbor. We map the
+       * vertices of the face to the neighbor parent and look for the child
+       * face with these vertices. */
+      neigh_class = t8_cmesh_refine_parent_class (cmesh_from, lneigh,
+                                                  &gneigh);
+      neigh_pattern = patterns + neigh_class;
+      T8_ASSERT (child_offset[lneigh] >= 0);
+      num_corners =
+        t8_cmesh_refine_face_corners (pattern, ichild, iface, corners);
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        mask = 0;
+        for (iv = 0; iv < T8_ECLASS_MAX_CORNERS; iv++) {
+          if (corners[icorner] & (1 << iv)) {
+            mask |= 1 << vertex_map[pface][iv];
+          }
+        }
+        corners[icorner] = mask;
       }
-      break;
-    case 4:
-      coord_lookup[0] = 0;
-      coord_lookup[1] = 1;
-      coord_lookup[2] = 0;
-      coord_lookup[3] = 2;
-      coord_lookup[4] = 0;
-      coord_lookup[5] = 3;
-      coord_lookup[6] = 1;
-      coord_lookup[7] = 3;
-      break;
-    case 5:
-      coord_lookup[0] = 0;
-      coord_lookup[1] = 1;
-      coord_lookup[2] = 0;
-      coord_lookup[3] = 2;
-      coord_lookup[4] = 1;
-      coord_lookup[5] = 2;
-      coord_lookup[6] = 1;
-      coord_lookup[7] = 3;
-      break;
-    case 6:
-      coord_lookup[0] = 0;
-      coord_lookup[1] = 2;
-      coord_lookup[2] = 0;
-      coord_lookup[3] = 3;
-      coord_lookup[4] = 1;
-      coord_lookup[5] = 3;
-      coord_lookup[6] = 2;
-      coord_lookup[7] = 3;
-      break;
-    case 7:
-      coord_lookup[0] = 0;
-      coord_lookup[1] = 2;
-      coord_lookup[2] = 1;
-      coord_lookup[3] = 2;
-      coord_lookup[4] = 1;
-      coord_lookup[5] = 3;
-      coord_lookup[6] = 2;
-      coord_lookup[7] = 3;
-      break;
-    }
-
-    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
-      for (idim = 0; idim < 3; idim++) {
-        coords_out[3 * ivertex + idim] =
-          (coords_in[3 * coord_lookup[2 * ivertex] + idim] +
-           coords_in[3 * coord_lookup[2 * ivertex + 1] + idim]) / 2;
+      for (jchild = 0; jchild < neigh_pattern->num_children; jchild++) {
+        for (jface = 0;
+             jface < t8_eclass_num_faces[neigh_pattern->child_class[jchild]];
+             jface++) {
+          if (neigh_pattern->neighbor[jchild][jface] < 0
+              && neigh_pattern->ttf[jchild][jface] == neigh_face
+              && t8_cmesh_refine_face_corners (neigh_pattern, jchild, jface,
+                                               neigh_corners) == num_corners
+              && t8_cmesh_refine_same_face (corners, neigh_corners,
+                                            num_corners)) {
+            break;
+          }
+        }
+        if (jface < t8_eclass_num_faces[neigh_pattern->child_class[jchild]]) {
+          break;
+        }
       }
+      SC_CHECK_ABORTF (jchild < neigh_pattern->num_children,
+                       "No neighbor of child %i of tree %lli at face %i.\n",
+                       ichild, (long long) (cmesh_from->first_tree
+                                            + ltree_id), iface);
+      child->neighbor[iface] = child_offset[lneigh] + jchild;
+      child->ttf[iface] = F *
+        t8_cmesh_refine_orientation ((t8_eclass_t) child->eclass, iface,
+                                     corners,
+                                     neigh_pattern->child_class[jchild],
+                                     jface, neigh_corners, num_corners)
+        + jface;
     }
-    break;
-  default:
-    SC_ABORT_NOT_REACHED ();
   }
 }
 
-/* Set the number of attributes and the class for each child of a given tree in cmesh_from */
-static void
-t8_cmesh_refine_inittree (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
-                          t8_locidx_t treeid, t8_locidx_t firstnewtree,
-                          int factor)
+/* Return true if an attribute stores the vertex coordinates of a tree */
+static int
+t8_cmesh_refine_is_vertex_attribute (t8_attribute_info_struct_t * attr_info)
 {
-  t8_ctree_t          tree, newtree;
-  t8_locidx_t         itree;
-  t8_locidx_t        *tree_neighbors;
-  int8_t             *ttf;
-  size_t              newattr_size;
-
-  tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, treeid,
-                                      &tree_neighbors, &ttf);
-  newattr_size = t8_cmesh_trees_attribute_size (tree);
-  for (itree = 0; itree < factor; itree++) {
-    newtree = t8_cmesh_trees_get_tree (cmesh->trees, firstnewtree + itree);
-    newtree->eclass = tree->eclass;     /* TODO: For pyramid support we will
-                                           need to change the eclass here to tets for some trees */
-    newtree->num_attributes = tree->num_attributes;
-    newtree->treeid = firstnewtree + itree;
-    t8_cmesh_trees_init_attributes (cmesh->trees, firstnewtree + itree,
-                                    newtree->num_attributes, newattr_size);
+  return attr_info->package_id == t8_get_package_id ()
+    && attr_info->key == 0;
+}
+
+/* Return the number of attribute bytes of a child of a tree */
+static              size_t
+t8_cmesh_refine_attribute_size (t8_ctree_t tree, t8_eclass_t child_class)
+{
+  t8_attribute_info_struct_t *attr_info;
+  size_t              total = 0;
+  int                 iatt;
+
+  for (iatt = 0; iatt < tree->num_attributes; iatt++) {
+    attr_info = T8_TREE_ATTR_INFO (tree, iatt);
+    if (t8_cmesh_refine_is_vertex_attribute (attr_info)) {
+      total += 3 * t8_eclass_num_vertices[child_class] * sizeof (double);
+    }
+    else {
+      total += attr_info->attribute_size;
+    }
   }
+  return total;
 }
 
-/* Set the attributes and face_neighbors for each child of a given tree (treeid) in cmesh_from */
-/* The attributes are just copies of the parent's attributes,
- * except for the coordinate attribute if it is set (t8_package_id and key=0).
- * The new coordinates are then calculated.
+/* Set the attributes of the children of a local tree of cmesh_from.
+ * The attributes are copies of the parent's attributes, except for the
+ * vertex coordinates which are computed from the parent's vertices.
+ * lfirst_child is the local id of the first child in cmesh.
  */
 static void
-t8_cmesh_refine_tree (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
-                      t8_child_id_to_local_id ** id_array,
-                      t8_locidx_t treeid, t8_locidx_t firstnewtree,
-                      int factor)
+t8_cmesh_refine_tree_attributes (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
+                                 const t8_cmesh_refine_pattern_t * pattern,
+                                 t8_locidx_t ltree_id,
+                                 t8_locidx_t lfirst_child)
 {
-  t8_ctree_t          tree, newtree;
-  t8_locidx_t         itree;
-  t8_locidx_t        *tree_neighbors, *ntree_neighbors;
-  int8_t             *ttf, *nttf;
-  int                 iatt;
-  double             *coords;
+  t8_ctree_t          tree;
   t8_attribute_info_struct_t *attr_info;
   t8_stash_attribute_struct_t attr_struct;
+  double              vertices[3 * T8_ECLASS_MAX_CORNERS];
+  const double       *parent_vertices;
+  int                 ichild, iatt, iv, jv, idim, num_vertices, count;
 
-  tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, treeid,
-                                      &tree_neighbors, &ttf);
-  for (itree = 0; itree < factor; itree++) {
-    newtree = t8_cmesh_trees_get_tree_ext (cmesh->trees, firstnewtree + itree,
-                                           &ntree_neighbors, &nttf);
-    /* Set all attributes of the child tree */
+  tree = t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id);
+  for (ichild = 0; ichild < pattern->num_children; ichild++) {
     for (iatt = 0; iatt < tree->num_attributes; iatt++) {
       attr_info = T8_TREE_ATTR_INFO (tree, iatt);
       attr_struct.attr_data = T8_TREE_ATTR (tree, attr_info);
       attr_struct.attr_size = attr_info->attribute_size;
-      attr_struct.id = cmesh->first_tree + firstnewtree + itree;
+      attr_struct.id = cmesh->first_tree + lfirst_child + ichild;
       attr_struct.key = attr_info->key;
       attr_struct.package_id = attr_info->package_id;
-      attr_struct.is_owned = 0; /* Make sure that the attribute data is copied
-                                   from the old tree */
-      t8_cmesh_trees_add_attribute (cmesh->trees, 0, &attr_struct,
-                                    firstnewtree + itree, iatt);
-      if (attr_struct.package_id == t8_get_package_id ()
-          && attr_struct.key == 0) {
-        /* The attribute was the tree's coordinates.
-         * In this case we compute the new coordinates */
-        /* TODO: We assume here that this particular combination of package id and
-         *       key is only used for attributes. This must be ensured */
-        coords = (double *) T8_TREE_ATTR (newtree, T8_TREE_ATTR_INFO (newtree,
-                                                                      iatt));
-        /* coords is the attribute of newtree */
-        t8_cmesh_refine_new_coord ((double *) attr_struct.attr_data,
-                                   tree->eclass, itree, coords);
-        attr_struct.is_owned = 1;
+      attr_struct.is_owned = 0;
+      if (t8_cmesh_refine_is_vertex_attribute (attr_info)) {
+        /* Each vertex of the child is the mean of some parent vertices */
+        parent_vertices = (const double *) attr_struct.attr_data;
+        num_vertices = t8_eclass_num_vertices[pattern->child_class[ichild]];
+        for (iv = 0; iv < num_vertices; iv++) {
+          for (idim = 0; idim < 3; idim++) {
+            vertices[3 * iv + idim] = 0;
+          }
+          for (jv = 0, count = 0; jv < T8_ECLASS_MAX_CORNERS; jv++) {
+            if (pattern->child_vertex[ichild][iv] & (1 << jv)) {
+              for (idim = 0; idim < 3; idim++) {
+                vertices[3 * iv + idim] += parent_vertices[3 * jv + idim];
+              }
+              count++;
+            }
+          }
+          for (idim = 0; idim < 3; idim++) {
+            vertices[3 * iv + idim] /= count;
+          }
+        }
+        attr_struct.attr_data = vertices;
+        attr_struct.attr_size = 3 * num_vertices * sizeof (double);
       }
+      t8_cmesh_trees_add_attribute (cmesh->trees, 0, &attr_struct,
+                                    lfirst_child + ichild, iatt);
     }
-    /* Set all face_neighbors of the child tree */
-    t8_cmesh_refine_new_neighbors (cmesh_from, treeid, -1, tree->eclass,
-                                   id_array, itree,
-                                   ntree_neighbors, NULL, nttf, factor);
   }
 }
 
-/* Set the class for each child of a given ghost in cmesh_from.
- * The number of childs that stay a ghost on this process depends on the
- * faces of the ghost connected to local trees. */
+/* Send the i-th buffer to the i-th remote process and receive one message
+ * from each remote process. The receive buffers are initialized with the
+ * element size of the send buffers. */
 static void
-t8_cmesh_refine_initghost (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
-                           t8_child_id_to_local_id ** idarray,
-                           t8_locidx_t ghostid, int factor)
+t8_cmesh_refine_exchange (const int *remotes, int num_remotes,
+                          sc_array_t * send_buffers,
+                          sc_array_t * recv_buffers, size_t elem_size,
+                          sc_MPI_Comm comm)
 {
-  t8_cghost_t         ghost, newghost;
-  t8_locidx_t         ighost, lghost_id;
-  t8_gloidx_t        *ghost_neighbors;
-  int8_t             *ttf, child_id = -2;
-
-  ghost = t8_cmesh_trees_get_ghost_ext (cmesh_from->trees, ghostid,
-                                        &ghost_neighbors, &ttf);
-  child_id = idarray[ghostid][0].child_id;
-  for (ighost = 0; child_id != -1; ighost++) {
-    lghost_id = idarray[ghostid][ighost].local_id;
-    newghost = t8_cmesh_trees_get_ghost (cmesh->trees, lghost_id);
-    newghost->eclass = ghost->eclass;   /* TODO: For pyramid support we will
-                                           need to change the eclass here to tets for some ghosts */
-    /*     ighost     child_id
-     * tri
-     * face 0
-     *        0           1
-     *        1           2
-     * face 1
-     *        0           0
-     *        1           2
-     * face 2
-     *        0           0
-     *        1           1
-     */
-    newghost->treeid = ghost->treeid * factor + child_id;
-    child_id = idarray[ghostid][ighost + 1].child_id;
+  sc_MPI_Request     *requests;
+  sc_MPI_Status       status;
+  int                 iremote, recv_bytes, mpiret;
+
+  requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    mpiret = sc_MPI_Isend (send_buffers[iremote].array,
+                           send_buffers[iremote].elem_count * elem_size,
+                           sc_MPI_BYTE, remotes[iremote],
+                           T8_MPI_REFINE_CMESH, comm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
   }
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    mpiret = sc_MPI_Probe (remotes[iremote], T8_MPI_REFINE_CMESH, comm,
+                           &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &recv_bytes);
+    SC_CHECK_MPI (mpiret);
+    T8_ASSERT (recv_bytes % elem_size == 0);
+    sc_array_init_size (recv_buffers + iremote, elem_size,
+                        recv_bytes / elem_size);
+    mpiret = sc_MPI_Recv (recv_buffers[iremote].array, recv_bytes,
+                          sc_MPI_BYTE, remotes[iremote], T8_MPI_REFINE_CMESH,
+                          comm, sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = sc_MPI_Waitall (num_remotes, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (requests);
 }
 
+/* Compute the processes that need the children of our trees as ghosts.
+ * These are the first owners of the face neighbors of our trees.
+ * The relation is symmetric, we receive the ghost children from the same
+ * processes.
+ * On output sends is sorted by rank and stores unique pairs of remote
+ * process and local tree. */
 static void
-t8_cmesh_refine_ghost (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
-                       t8_child_id_to_local_id ** idarray,
-                       t8_locidx_t ghostid, int factor)
+t8_cmesh_refine_compute_sends (t8_cmesh_t cmesh_from,
+                               t8_locidx_t first_owned, sc_array_t * sends)
 {
-  t8_cghost_t         newghost;
-  t8_gloidx_t        *ghost_neighbors, *nghost_neighbors;
-  int8_t             *ttf, *nttf, child_id = -2;
-  t8_locidx_t         lghost_id;
-  int                 ichild;
-
-  (void) t8_cmesh_trees_get_ghost_ext (cmesh_from->trees, ghostid,
-                                       &ghost_neighbors, &ttf);
-  child_id = idarray[ghostid][0].child_id;
-  for (ichild = 0; child_id != -1; ichild++) {
-    lghost_id = idarray[ghostid][ichild].local_id;
-    newghost = t8_cmesh_trees_get_ghost_ext (cmesh->trees, lghost_id,
-                                             &nghost_neighbors, &nttf);
-    /* Set all face_neighbors of the child ghost */
-    /* *INDENT-OFF* */
-    t8_cmesh_refine_new_neighbors (cmesh_from, ghostid,
-     t8_cmesh_get_global_id (cmesh_from, cmesh_from->num_local_trees + ghostid),
-                                   newghost->eclass, idarray, (int) child_id,
-                                   NULL, nghost_neighbors, nttf, factor);
-    /* *INDENT-ON* */
-    child_id = idarray[ghostid][ichild + 1].child_id;
+  t8_ctree_t          tree;
+  t8_locidx_t         ltree_id, *tree_neighbors, lneigh;
+  t8_gloidx_t         gneigh;
+  t8_offset_lookup_t *lookup;
+  t8_cmesh_refine_send_t *send;
+  int8_t             *tree_ttf;
+  int                 F, iface, rank;
+
+  F = t8_eclass_max_num_faces[cmesh_from->dimension];
+  /* We look up the owners of all ghost neighbors */
+  lookup = t8_offset_lookup_new (cmesh_from->mpisize,
+                                 t8_shmem_array_get_gloidx_array
+                                 (cmesh_from->tree_offsets));
+  for (ltree_id = first_owned; ltree_id < cmesh_from->num_local_trees;
+       ltree_id++) {
+    tree = t8_cmesh_trees_get_tree_ext (cmesh_from->trees, ltree_id,
+                                        &tree_neighbors, &tree_ttf);
+    for (iface = 0; iface < t8_eclass_num_faces[tree->eclass]; iface++) {
+      lneigh = tree_neighbors[iface];
+      if ((lneigh == ltree_id && tree_ttf[iface] % F == iface)
+          || (lneigh >= first_owned
+              && lneigh < cmesh_from->num_local_trees)) {
+        /* A boundary face or a neighbor that we own */
+        continue;
+      }
+      (void) t8_cmesh_refine_parent_class (cmesh_from, lneigh, &gneigh);
+      rank = t8_offset_lookup_first_owner_of_tree (lookup, gneigh);
+      if (rank != cmesh_from->mpirank) {
+        send = (t8_cmesh_refine_send_t *) sc_array_push (sends);
+        send->rank = rank;
+        send->ltree_id = ltree_id;
+      }
+    }
   }
+  t8_offset_lookup_destroy (&lookup);
+  sc_array_sort (sends, t8_cmesh_refine_compare_send);
+  sc_array_uniq (sends, t8_cmesh_refine_compare_send);
 }
 
+/* Return the local id of a tree of the refined cmesh given its global id.
+ * For ghosts this is the number of local trees plus the position of the
+ * ghost in the sorted array ghost_ids. */
 static              t8_locidx_t
-t8_cmesh_refine_count_ghost (t8_cmesh_t cmesh, t8_cmesh_t cmesh_from,
-                             t8_child_id_to_local_id ** idarray)
+t8_cmesh_refine_local_id (t8_cmesh_t cmesh, sc_array_t * ghost_ids,
+                          t8_gloidx_t global_id)
 {
-  t8_cghost_t         ghost;
-  t8_gloidx_t        *face_neighbor, neighbor;
-  t8_locidx_t         num_ghosts, ighost;
-  int                 iface, ichild, num_face_child, num_local_children;
-  /* For each eclass we give a lookup table of the child id's on a given face.
-   * For example for type T8_ECLASS_QUAD we have
-   *                    f_3
-   *                     _ _
-   *              f_0  |2 3|  f_1
-   *                   |0 1|
-   *                     - -
-   *                    f_2
-   * where the numbers inside refer to the chlid_ids of the quad.
-   * The lookup table then gives:  0 -> 0,2
-   *                               1 -> 1,3
-   *                               2 -> 0,1
-   *                               3 -> 2,3
-   * as can be see in the 2nd line of the array */
-  int8_t              child_id_by_class_and_face[T8_ECLASS_COUNT][6][10] = {
-    {{}},                       /* VERTEX */
-    {{0}, {1}},                 /* LINE */
-    {{0, 2}, {1, 3}, {0, 1}, {2, 3}},   /* QUAD */
-    {{1, 2}, {0, 2}, {0, 1}},   /* TRIANGLE */
-    {{0, 2, 4, 6}, {1, 3, 5, 7}, {0, 1, 4, 5}, {2, 3, 6, 7}, {0, 1, 2, 3}, {4, 5, 6, 7}},       /* HEX */
-    {{1, 2, 3, 7}, {0, 2, 3, 6}, {0, 1, 3, 4}, {0, 1, 2, 5}}    /* TET */
-  };
-  int8_t              child_counted[10] = { 0 }, *temp_child_counted;
-  t8_locidx_t         next_local_id = 0;
-  t8_eclass_scheme_c *ts;
-  t8_element_t       *root_elem;
-
-  num_ghosts = 0;
-  for (ighost = 0; ighost < cmesh_from->num_ghosts; ighost++) {
-    ghost = t8_cmesh_trees_get_ghost_ext (cmesh_from->trees, ighost,
-                                          &face_neighbor, NULL);
-    T8_ASSERT (ghost->eclass != T8_ECLASS_PRISM &&
-               ghost->eclass != T8_ECLASS_PYRAMID &&
-               ghost->eclass != T8_ECLASS_VERTEX);
-
-    /* In order to compute the number of face children of the ghost, we need to call
-     * the element_num_children function with the root element as argument.
-     * Thus, we need to create this root element first. */
-    ts = cmesh->set_refine_scheme->eclass_schemes[ghost->eclass];
-    ts->t8_element_new (1, &root_elem);
-
-    num_local_children = 0;
-    memset (child_counted, 0, 10 * sizeof (int8_t));
-    for (iface = 0; iface < t8_eclass_num_faces[ghost->eclass]; iface++) {
-      /* Compute the number of face children */
-      num_face_child = ts->t8_element_num_face_children (root_elem, iface);
-      neighbor = face_neighbor[iface];
-      if (neighbor >= cmesh_from->first_tree &&
-          neighbor < cmesh_from->first_tree + cmesh_from->num_local_trees) {
-        /* This neighbor of the ghost is a local tree */
-        for (ichild = 0; ichild < num_face_child; ichild++) {
-          /* For each child of this face check whether we counted the corresponding ghost */
-          temp_child_counted =
-            &child_counted[child_id_by_class_and_face[ghost->eclass][iface]
-                           [ichild]];
-          if (*temp_child_counted != 1) {
-            /* If we did not count this ghost child then we do it now */
-            num_ghosts++;
-            num_local_children++;
-            *temp_child_counted = 1;
-          }
-        }
-      }
-    }
-    next_local_id = t8_cmesh_refine_fill_idarray (idarray, ighost,
-                                                  child_counted,
-                                                  num_local_children,
-                                                  next_local_id);
-    ts->t8_element_destroy (1, &root_elem);
+  ssize_t             pos;
+
+  if (cmesh->first_tree <= global_id
+      && global_id < cmesh->first_tree + cmesh->num_local_trees) {
+    return global_id - cmesh->first_tree;
   }
-  return num_ghosts;
+  pos = sc_array_bsearch (ghost_ids, &global_id,
+                          t8_cmesh_refine_compare_gloidx);
+  T8_ASSERT (pos >= 0);
+  return cmesh->num_local_trees + (t8_locidx_t) pos;
 }
 
 void
-t8_cmesh_refine (t8_cmesh_t cmesh)
+t8_cmesh_refine (t8_cmesh_t cmesh, sc_MPI_Comm comm)
 {
   t8_cmesh_t          cmesh_from;
-  t8_locidx_t         itree, firstnewtree;
-  t8_locidx_t         ighost;
-  t8_child_id_to_local_id **idarray;
-  int                 dim, factor, level, iclass;
+  t8_scheme_cxx_t    *scheme;
+  t8_cmesh_refine_pattern_t patterns[T8_ECLASS_COUNT], *pattern;
+  t8_cmesh_refine_child_t *children, *ghosts, *child;
+  t8_cmesh_refine_send_t *send;
+  t8_ctree_t          tree;
+  t8_cghost_t         ghost;
+  t8_locidx_t         ltree_id, first_owned, num_parents, lchild, lghost;
+  t8_locidx_t        *tree_neighbors, num_children;
+  t8_gloidx_t        *child_offset, *ghost_neighbors, global_id;
+  t8_gloidx_t         num_owned_children, first_child, *pair;
+  sc_array_t          sends, ghost_ids;
+  sc_array_t         *send_buffers = NULL, *recv_buffers = NULL;
+  int                *remotes = NULL, *remote_offsets = NULL;
+  int8_t             *tree_ttf;
+  int                 iclass, factor, is_partitioned, num_remotes = 0;
+  int                 iremote, iface, ichild, mpiret;
+  size_t              isend, irecv;
+  ssize_t             pos;
 
   T8_ASSERT (cmesh != NULL);
   T8_ASSERT (cmesh->set_from != NULL);
   T8_ASSERT (cmesh->set_from->committed);
-  T8_ASSERT (cmesh->set_from->num_trees_per_eclass[T8_ECLASS_PYRAMID] == 0);
-  T8_ASSERT (cmesh->set_refine_level == 1);     /* levels bigger than 1 are not yet implemented */
-
-  if (cmesh->set_from->set_partition && cmesh->set_from->first_tree_shared) {
-    SC_ABORT ("Refining a partioned cmesh with shared first trees "
-              "is not implemented yet.\n");
-  }
+  /* levels bigger than 1 are refined successively */
+  T8_ASSERT (cmesh->set_refine_level == 1);
+  T8_ASSERT (cmesh->set_refine_scheme != NULL);
 
   cmesh_from = (t8_cmesh_t) cmesh->set_from;
-  dim = cmesh_from->dimension;
-  level = cmesh->set_refine_level;
-  /* The number of new trees per old tree
-   * dim     factor (level = 1)
-   *  0         1   (points)
-   *  1         2   (lines)
-   *  2         4   (quads and triangles)
-   *  3         8   (Hexes, prisms, Tets)
-   */
-  factor = ((t8_linearidx_t) 1) << (dim * level);
-  cmesh->num_local_trees = cmesh_from->num_local_trees * factor;
-  cmesh->num_trees = cmesh_from->num_trees * factor;
+  scheme = cmesh->set_refine_scheme;
+  is_partitioned = cmesh_from->set_partition;
+
+  /* Compute the refinement pattern of each class in the cmesh and
+   * check whether all trees have the same number of children */
+  factor = 0;
+  cmesh->num_trees = 0;
   for (iclass = T8_ECLASS_ZERO; iclass < T8_ECLASS_COUNT; iclass++) {
-    /* TODO: This does not work with pyramids */
-    cmesh->num_trees_per_eclass[iclass] =
-      cmesh_from->num_trees_per_eclass[iclass] * factor;
+    if (cmesh_from->num_trees_per_eclass[iclass] > 0) {
+      t8_cmesh_refine_pattern_init (patterns + iclass, (t8_eclass_t) iclass,
+                                    scheme);
+      cmesh->num_trees += cmesh_from->num_trees_per_eclass[iclass]
+        * patterns[iclass].num_children;
+      if (factor == 0) {
+        factor = patterns[iclass].num_children;
+      }
+      else if (factor != patterns[iclass].num_children) {
+        factor = -1;
+      }
+    }
+  }
+
+  /* A shared first tree is refined by the first process that owns it */
+  first_owned = is_partitioned && cmesh_from->first_tree_shared ? 1 : 0;
+  num_owned_children = 0;
+  for (ltree_id = first_owned; ltree_id < cmesh_from->num_local_trees;
+       ltree_id++) {
+    tree = t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id);
+    num_owned_children += patterns[tree->eclass].num_children;
+  }
+  first_child = 0;
+  if (is_partitioned) {
+    mpiret = sc_MPI_Exscan (&num_owned_children, &first_child, 1,
+                            T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+    SC_CHECK_MPI (mpiret);
+    if (cmesh->mpirank == 0) {
+      first_child = 0;
+    }
+  }
+
+  /* Compute the global id of the first child of each parent */
+  num_parents = cmesh_from->num_local_trees + cmesh_from->num_ghosts;
+  child_offset = T8_ALLOC (t8_gloidx_t, num_parents);
+  for (ltree_id = 0; ltree_id < num_parents; ltree_id++) {
+    (void) t8_cmesh_refine_parent_class (cmesh_from, ltree_id, &global_id);
+    child_offset[ltree_id] = factor > 0 ? global_id * factor : -1;
+  }
+  if (factor <= 0) {
+    for (ltree_id = first_owned, global_id = first_child;
+         ltree_id < cmesh_from->num_local_trees; ltree_id++) {
+      child_offset[ltree_id] = global_id;
+      tree = t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id);
+      global_id += patterns[tree->eclass].num_children;
+    }
+  }
+
+  sc_array_init (&sends, sizeof (t8_cmesh_refine_send_t));
+  if (is_partitioned) {
+    /* Group the trees that we send by remote process */
+    t8_cmesh_refine_compute_sends (cmesh_from, first_owned, &sends);
+    remotes = T8_ALLOC (int, sends.elem_count);
+    remote_offsets = T8_ALLOC (int, sends.elem_count + 1);
+    for (isend = 0; isend < sends.elem_count; isend++) {
+      send = (t8_cmesh_refine_send_t *) sc_array_index (&sends, isend);
+      if (num_remotes == 0 || remotes[num_remotes - 1] != send->rank) {
+        remote_offsets[num_remotes] = isend;
+        remotes[num_remotes++] = send->rank;
+      }
+    }
+    remote_offsets[num_remotes] = sends.elem_count;
+    send_buffers = T8_ALLOC (sc_array_t, num_remotes);
+    recv_buffers = T8_ALLOC (sc_array_t, num_remotes);
+  }
+
+  if (is_partitioned && factor <= 0) {
+    /* The trees do not all have the same number of children, the remote
+     * processes send us the first child ids of their trees. */
+    for (iremote = 0; iremote < num_remotes; iremote++) {
+      sc_array_init (send_buffers + iremote, 2 * sizeof (t8_gloidx_t));
+      for (isend = remote_offsets[iremote];
+           isend < (size_t) remote_offsets[iremote + 1]; isend++) {
+        send = (t8_cmesh_refine_send_t *) sc_array_index (&sends, isend);
+        pair = (t8_gloidx_t *) sc_array_push (send_buffers + iremote);
+        pair[0] = cmesh_from->first_tree + send->ltree_id;
+        pair[1] = child_offset[send->ltree_id];
+      }
+    }
+    t8_cmesh_refine_exchange (remotes, num_remotes, send_buffers,
+                              recv_buffers, 2 * sizeof (t8_gloidx_t), comm);
+    for (iremote = 0; iremote < num_remotes; iremote++) {
+      for (irecv = 0; irecv < recv_buffers[iremote].elem_count; irecv++) {
+        pair = (t8_gloidx_t *) sc_array_index (recv_buffers + iremote,
+                                               irecv);
+        if (cmesh_from->first_tree <= pair[0] && pair[0] <
+            cmesh_from->first_tree + cmesh_from->num_local_trees) {
+          ltree_id = pair[0] - cmesh_from->first_tree;
+        }
+        else {
+          ltree_id =
+            t8_cmesh_trees_get_ghost_local_id (cmesh_from->trees, pair[0]);
+        }
+        T8_ASSERT (ltree_id >= 0);
+        child_offset[ltree_id] = pair[1];
+      }
+      sc_array_reset (send_buffers + iremote);
+      sc_array_reset (recv_buffers + iremote);
+    }
   }
 
-  cmesh->first_tree = cmesh_from->first_tree * factor;
+  /* Compute the children of our trees */
+  T8_ASSERT ((t8_locidx_t) num_owned_children == num_owned_children);
+  num_children = num_owned_children;
+  children = T8_ALLOC (t8_cmesh_refine_child_t, num_children);
+  for (ltree_id = first_owned; ltree_id < cmesh_from->num_local_trees;
+       ltree_id++) {
+    t8_cmesh_refine_tree_children (cmesh_from, scheme, patterns,
+                                   child_offset, ltree_id,
+                                   children + (child_offset[ltree_id]
+                                               - first_child));
+  }
+
+  /* The ghosts are the neighbors of our children that are not local */
+  sc_array_init (&ghost_ids, sizeof (t8_gloidx_t));
+  for (lchild = 0; lchild < num_children; lchild++) {
+    child = children + lchild;
+    for (iface = 0; iface < t8_eclass_num_faces[child->eclass]; iface++) {
+      if (child->neighbor[iface] < first_child
+          || child->neighbor[iface] >= first_child + num_children) {
+        *(t8_gloidx_t *) sc_array_push (&ghost_ids) = child->neighbor[iface];
+      }
+    }
+  }
+  sc_array_sort (&ghost_ids, t8_cmesh_refine_compare_gloidx);
+  sc_array_uniq (&ghost_ids, t8_cmesh_refine_compare_gloidx);
+  ghosts = T8_ALLOC (t8_cmesh_refine_child_t, ghost_ids.elem_count);
+  for (isend = 0; isend < ghost_ids.elem_count; isend++) {
+    ghosts[isend].global_id = -1;
+  }
+
+  if (is_partitioned) {
+    /* Exchange the children of the trees at the partition boundary */
+    for (iremote = 0; iremote < num_remotes; iremote++) {
+      sc_array_init (send_buffers + iremote,
+                     sizeof (t8_cmesh_refine_child_t));
+      for (isend = remote_offsets[iremote];
+           isend < (size_t) remote_offsets[iremote + 1]; isend++) {
+        send = (t8_cmesh_refine_send_t *) sc_array_index (&sends, isend);
+        tree = t8_cmesh_trees_get_tree (cmesh_from->trees, send->ltree_id);
+        lchild = child_offset[send->ltree_id] - first_child;
+        memcpy (sc_array_push_count (send_buffers + iremote,
+                                     patterns[tree->eclass].num_children),
+                children + lchild, patterns[tree->eclass].num_children
+                * sizeof (t8_cmesh_refine_child_t));
+      }
+    }
+    t8_cmesh_refine_exchange (remotes, num_remotes, send_buffers,
+                              recv_buffers, sizeof (t8_cmesh_refine_child_t),
+                              comm);
+    for (iremote = 0; iremote < num_remotes; iremote++) {
+      for (irecv = 0; irecv < recv_buffers[iremote].elem_count; irecv++) {
+        child = (t8_cmesh_refine_child_t *)
+          sc_array_index (recv_buffers + iremote, irecv);
+        pos = sc_array_bsearch (&ghost_ids, &child->global_id,
+                                t8_cmesh_refine_compare_gloidx);
+        if (pos >= 0) {
+          ghosts[pos] = *child;
+        }
+      }
+      sc_array_reset (send_buffers + iremote);
+      sc_array_reset (recv_buffers + iremote);
+    }
+    T8_FREE (send_buffers);
+    T8_FREE (recv_buffers);
+    T8_FREE (remotes);
+    T8_FREE (remote_offsets);
+  }
+  sc_array_reset (&sends);
+#ifdef T8_ENABLE_DEBUG
+  for (isend = 0; isend < ghost_ids.elem_count; isend++) {
+    T8_ASSERT (ghosts[isend].global_id ==
+               *(t8_gloidx_t *) sc_array_index (&ghost_ids, isend));
+  }
+#endif
 
-  /* Count the number of new ghosts and temporarily store their local ids */
-  idarray = t8_cmesh_refine_init_idarray (cmesh_from);
-  cmesh->num_ghosts =
-    t8_cmesh_refine_count_ghost (cmesh, cmesh_from, idarray);
-  /* Check for locidx overflow */
-  T8_ASSERT ((t8_gloidx_t) cmesh_from->num_local_trees * factor ==
-             cmesh->num_local_trees);
   /************************/
   /* Create the new trees */
   /************************/
+  cmesh->set_partition = is_partitioned;
+  cmesh->first_tree = first_child;
+  cmesh->first_tree_shared = 0;
+  cmesh->num_local_trees = num_children;
+  cmesh->num_ghosts = ghost_ids.elem_count;
+  if (cmesh->tree_offsets != NULL) {
+    /* The offsets refer to the unrefined cmesh, they are recomputed
+     * at commit */
+    t8_shmem_array_destroy (&cmesh->tree_offsets);
+  }
+  memset (cmesh->num_local_trees_per_eclass, 0,
+          sizeof (cmesh->num_local_trees_per_eclass));
   /* We create the new cmesh with only one part, independent of the number of
    * parts of cmesh_from */
   t8_cmesh_trees_init (&cmesh->trees, 1, cmesh->num_local_trees,
                        cmesh->num_ghosts);
   t8_cmesh_trees_start_part (cmesh->trees, 0, 0, cmesh->num_local_trees, 0,
                              cmesh->num_ghosts, 1);
-  /* Loop over all trees in cmesh_from and set the classes for their children */
-  for (itree = 0, firstnewtree = 0; itree < cmesh_from->num_local_trees;
-       itree++, firstnewtree += factor) {
-    t8_cmesh_refine_inittree (cmesh, cmesh_from, itree, firstnewtree, factor);
+  for (lchild = 0; lchild < num_children; lchild++) {
+    t8_cmesh_trees_add_tree (cmesh->trees, lchild, 0,
+                             (t8_eclass_t) children[lchild].eclass);
+    cmesh->num_local_trees_per_eclass[children[lchild].eclass]++;
+  }
+  for (ltree_id = first_owned; ltree_id < cmesh_from->num_local_trees;
+       ltree_id++) {
+    tree = t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id);
+    pattern = patterns + tree->eclass;
+    lchild = child_offset[ltree_id] - first_child;
+    for (ichild = 0; ichild < pattern->num_children; ichild++) {
+      t8_cmesh_trees_init_attributes (cmesh->trees, lchild + ichild,
+                                      tree->num_attributes,
+                                      t8_cmesh_refine_attribute_size
+                                      (tree, pattern->child_class[ichild]));
+    }
   }
-  for (ighost = 0; ighost < cmesh_from->num_ghosts; ighost++) {
-    t8_cmesh_refine_initghost (cmesh, cmesh_from, idarray, ighost, factor);
+  for (lghost = 0; lghost < cmesh->num_ghosts; lghost++) {
+    t8_cmesh_trees_add_ghost (cmesh->trees, lghost, ghosts[lghost].global_id,
+                              0, (t8_eclass_t) ghosts[lghost].eclass,
+                              cmesh->num_local_trees);
   }
-  /* Allocate face neihbors and attributes for new trees */
+  /* Allocate face neighbors and attributes for new trees */
   t8_cmesh_trees_finish_part (cmesh->trees, 0);
-  /* Loop over all trees in cmesh_from and set the new face-neighbors and attributes */
-  for (itree = 0, firstnewtree = 0; itree < cmesh_from->num_local_trees;
-       itree++, firstnewtree += factor) {
-    t8_cmesh_refine_tree (cmesh, cmesh_from, idarray, itree, firstnewtree,
-                          factor);
+
+  /* Set the attributes and face neighbors */
+  for (ltree_id = first_owned; ltree_id < cmesh_from->num_local_trees;
+       ltree_id++) {
+    tree = t8_cmesh_trees_get_tree (cmesh_from->trees, ltree_id);
+    t8_cmesh_refine_tree_attributes (cmesh, cmesh_from,
+                                     patterns + tree->eclass, ltree_id,
+                                     child_offset[ltree_id] - first_child);
+  }
+  for (lchild = 0; lchild < num_children; lchild++) {
+    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees, lchild,
+                                        &tree_neighbors, &tree_ttf);
+    for (iface = 0; iface < t8_eclass_num_faces[children[lchild].eclass];
+         iface++) {
+      tree_neighbors[iface] =
+        t8_cmesh_refine_local_id (cmesh, &ghost_ids,
+                                  children[lchild].neighbor[iface]);
+      tree_ttf[iface] = children[lchild].ttf[iface];
+    }
   }
-  for (ighost = 0; ighost < cmesh_from->num_ghosts; ighost++) {
-    t8_cmesh_refine_ghost (cmesh, cmesh_from, idarray, ighost, factor);
+  for (lghost = 0; lghost < cmesh->num_ghosts; lghost++) {
+    ghost = t8_cmesh_trees_get_ghost_ext (cmesh->trees, lghost,
+                                          &ghost_neighbors, &tree_ttf);
+    for (iface = 0; iface < t8_eclass_num_faces[ghost->eclass]; iface++) {
+      ghost_neighbors[iface] = ghosts[lghost].neighbor[iface];
+      tree_ttf[iface] = ghosts[lghost].ttf[iface];
+    }
   }
-  t8_cmesh_refine_destroy_idarray (idarray, cmesh_from->num_ghosts);
+
+  sc_array_reset (&ghost_ids);
+  T8_FREE (ghosts);
+  T8_FREE (children);
+  T8_FREE (child_offset);
 }
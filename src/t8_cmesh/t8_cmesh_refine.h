@@ -22,7 +22,7 @@
 
 /** \file t8_cmesh_refine.h
  *
- * TODO: document this file
+ * Uniform refinement of a committed cmesh.
  */
 
 #ifndef T8_CMESH_REFINE_H
@@ -34,13 +34,6 @@
 
 T8_EXTERN_C_BEGIN ();
 
-/* TODO: Implement cmesh_refine as follows:
- *        create a forest,
- *        refine to level 1
- *        build a ctree from each forest element
- *            this will need forest_element_transform_face (see p4est_quadrant_transform_face)
- *            which is not yet implemented */
-
 /* A cmesh is refined uniformly by replacing each tree with a certain number
  * of subtrees. This number depends on the element class of the tree.
  * Per default these are:
@@ -53,19 +46,26 @@ T8_EXTERN_C_BEGIN ();
  *  - Prism become eight subprisms,
  *  - Pyramids becom six subpyramids and four subtetrahedra.
  *
- * When refining a cmesh new treeid's and face neighbors have to be computed,
- * to this end it is necessary to specify a order of the children of each eclass
- * and an enumeration of the faces of each eclass.
- * The standard schemes are Morton for lines/quads/hexes
- * and Bey order for triangles/tets.
+ * The children and their order are given by the refinement scheme of the
+ * cmesh. The children of a tree get consecutive tree ids in this order.
+ * Their vertices are computed from the vertices of the tree and their
+ * face connections from the face connections of the tree.
+ *
+ * A partitioned cmesh stays partitioned. Each process refines its local
+ * trees, a tree that is shared by several processes is refined by the first
+ * of them. Thus the refined cmesh has no shared trees.
+ * The children along the partition boundary are exchanged with the
+ * neighboring processes to build the new ghosts.
  */
 
 /** Populate a cmesh that is derived via refinement from another cmesh.
  * \param [in,out]  cmesh       The cmesh to be populated. Its set_from entry has
  *                              to be set to a committed cmesh and its set_refine_level
- *                              entry has to be positive.
+ *                              entry has to be 1.
+ * \param [in]      comm        The MPI communicator of the cmesh.
+ * This function is collective if set_from is partitioned.
  */
-void                t8_cmesh_refine (t8_cmesh_t cmesh);
+void                t8_cmesh_refine (t8_cmesh_t cmesh, sc_MPI_Comm comm);
 
 T8_EXTERN_C_END ();
 
@@ -33,6 +33,9 @@
 #include <t8_cmesh/t8_cmesh_save.h>
 #include <t8_cmesh/t8_cmesh_partition.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+#include <sys/mman.h>
+#endif
 
 /* This macro is called to check a condition and if not fulfilled
  * close the file and exit the function */
@@ -933,3 +936,747 @@ t8_cmesh_load_and_distribute (const char *fileprefix, int num_files,
   T8_ASSERT (t8_cmesh_is_committed (cmesh));
   return cmesh;
 }
+
+/* The functions below write and read a cmesh as a single binary file.
+ * The format of the file is described in t8_cmesh_save.h. */
+
+#ifdef T8_ENABLE_MPIIO
+/* The maximum number of bytes that one process reads or writes with one
+ * MPI I/O call. */
+#define T8_CMESH_SAVE_MAX_BYTES (1 << 30)
+#endif
+
+/* The first part of the record of a tree in a single cmesh file */
+typedef struct
+{
+  int32_t             eclass;
+  int32_t             num_attributes;
+} t8_cmesh_save_tree_t;
+
+/* The information of an attribute in a single cmesh file,
+ * followed by the data of the attribute */
+typedef struct
+{
+  int32_t             package_id;
+  int32_t             key;
+  int64_t             size;
+} t8_cmesh_save_attribute_t;
+
+/* A ghost tree that is found while loading the trees of a process */
+typedef struct
+{
+  t8_gloidx_t         gtree_id;
+  t8_eclass_t         eclass;
+} t8_cmesh_save_ghost_t;
+
+/* A single cmesh file opened by all processes of a communicator */
+typedef struct
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File            file;
+#else
+  FILE               *file;
+#endif
+  sc_MPI_Comm         comm;
+  int                 mpirank;
+  int                 mpisize;
+  int                 failed;   /* True if an operation failed on this process */
+} t8_cmesh_save_file_t;
+
+/* Open a file on all processes of comm for reading or writing.
+ * If the file is opened for writing, it is truncated.
+ * Returns true on all processes if the file was opened on all processes. */
+static int
+t8_cmesh_save_open (t8_cmesh_save_file_t * fh, const char *filename,
+                    int do_write, sc_MPI_Comm comm)
+{
+  int                 mpiret, local_success, success;
+
+  fh->comm = comm;
+  fh->failed = 0;
+  mpiret = sc_MPI_Comm_rank (comm, &fh->mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &fh->mpisize);
+  SC_CHECK_MPI (mpiret);
+#ifdef T8_ENABLE_MPIIO
+  if (do_write) {
+    /* Delete an old file, since MPI_MODE_CREATE does not truncate it */
+    if (fh->mpirank == 0) {
+      MPI_File_delete ((char *) filename, MPI_INFO_NULL);
+    }
+    mpiret = sc_MPI_Barrier (comm);
+    SC_CHECK_MPI (mpiret);
+  }
+  fh->failed = MPI_File_open (comm, (char *) filename,
+                              do_write ? MPI_MODE_WRONLY | MPI_MODE_CREATE
+                              : MPI_MODE_RDONLY, MPI_INFO_NULL,
+                              &fh->file) != MPI_SUCCESS;
+#else
+  /* Process 0 creates the file before the other processes open it */
+  fh->file = NULL;
+  if (!do_write || fh->mpirank == 0) {
+    fh->file = fopen (filename, do_write ? "wb" : "rb");
+  }
+  if (do_write) {
+    mpiret = sc_MPI_Barrier (comm);
+    SC_CHECK_MPI (mpiret);
+    if (fh->mpirank > 0) {
+      fh->file = fopen (filename, "r+b");
+    }
+  }
+  fh->failed = fh->file == NULL;
+#endif
+  local_success = !fh->failed;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success && !fh->failed) {
+    /* Some other process could not open the file, we close it again */
+#ifdef T8_ENABLE_MPIIO
+    MPI_File_close (&fh->file);
+#else
+    fclose (fh->file);
+#endif
+  }
+  return success;
+}
+
+/* Collectively write or read size bytes of a buffer at a given offset
+ * of a file. Processes that write or read nothing pass size 0. */
+static void
+t8_cmesh_save_access_at (t8_cmesh_save_file_t * fh, long long offset,
+                         void *buffer, long long size, int do_write)
+{
+#ifdef T8_ENABLE_MPIIO
+  long long           num_rounds, max_rounds, iround, count;
+  MPI_Status          status;
+  int                 mpiret, num_bytes;
+  char               *position;
+
+  /* The buffer may be larger than what fits into one MPI call, thus the
+   * processes access it in rounds of at most T8_CMESH_SAVE_MAX_BYTES */
+  num_rounds = (size + T8_CMESH_SAVE_MAX_BYTES - 1) / T8_CMESH_SAVE_MAX_BYTES;
+  mpiret = sc_MPI_Allreduce (&num_rounds, &max_rounds, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  for (iround = 0; iround < max_rounds; iround++) {
+    count = SC_MAX (0, SC_MIN (size - iround * T8_CMESH_SAVE_MAX_BYTES,
+                               (long long) T8_CMESH_SAVE_MAX_BYTES));
+    position = (char *) buffer
+      + (count > 0 ? iround * T8_CMESH_SAVE_MAX_BYTES : 0);
+    if (do_write) {
+      fh->failed |= MPI_File_write_at_all (fh->file, (MPI_Offset) offset
+                                           + iround * T8_CMESH_SAVE_MAX_BYTES,
+                                           position, (int) count, MPI_BYTE,
+                                           &status) != MPI_SUCCESS;
+    }
+    else {
+      fh->failed |= MPI_File_read_at_all (fh->file, (MPI_Offset) offset
+                                          + iround * T8_CMESH_SAVE_MAX_BYTES,
+                                          position, (int) count, MPI_BYTE,
+                                          &status) != MPI_SUCCESS;
+      /* Detect files that are too short */
+      fh->failed |= MPI_Get_count (&status, MPI_BYTE, &num_bytes)
+        != MPI_SUCCESS || num_bytes != count;
+    }
+  }
+#else
+  int                 iproc, mpiret;
+
+  if (!do_write) {
+    /* Reading from the file does not need to be serialized */
+    if (size > 0) {
+      fh->failed |= fseek (fh->file, offset, SEEK_SET) != 0
+        || fread (buffer, 1, size, fh->file) != (size_t) size;
+    }
+    return;
+  }
+  /* Without MPI I/O the processes write one after the other */
+  for (iproc = 0; iproc < fh->mpisize; iproc++) {
+    if (iproc == fh->mpirank && size > 0) {
+      fh->failed |= fseek (fh->file, offset, SEEK_SET) != 0
+        || fwrite (buffer, 1, size, fh->file) != (size_t) size
+        || fflush (fh->file) != 0;
+    }
+    mpiret = sc_MPI_Barrier (fh->comm);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+}
+
+/* Close a file on all processes.
+ * Returns true on all processes if all operations were successful. */
+static int
+t8_cmesh_save_close (t8_cmesh_save_file_t * fh)
+{
+  int                 mpiret, local_success, success;
+
+#ifdef T8_ENABLE_MPIIO
+  fh->failed |= MPI_File_close (&fh->file) != MPI_SUCCESS;
+#else
+  fh->failed |= fclose (fh->file) != 0;
+#endif
+  local_success = !fh->failed;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  return success;
+}
+
+/* Return the global id and eclass of a local tree or ghost */
+static              t8_gloidx_t
+t8_cmesh_save_global_id (t8_cmesh_t cmesh, t8_locidx_t local_id,
+                         int8_t * eclass)
+{
+  t8_cghost_t         ghost;
+
+  if (local_id < cmesh->num_local_trees) {
+    *eclass = t8_cmesh_trees_get_tree (cmesh->trees, local_id)->eclass;
+    return (cmesh->set_partition ? cmesh->first_tree : 0) + local_id;
+  }
+  ghost = t8_cmesh_trees_get_ghost (cmesh->trees,
+                                    local_id - cmesh->num_local_trees);
+  *eclass = ghost->eclass;
+  return ghost->treeid;
+}
+
+/* Write the record of a local tree to a buffer and return its size.
+ * If buffer is NULL, only the size is computed. */
+static size_t
+t8_cmesh_save_pack_tree (t8_cmesh_t cmesh, t8_locidx_t ltree, char *buffer)
+{
+  t8_ctree_t          tree;
+  t8_locidx_t        *face_neighbors;
+  int8_t             *ttf, eclass;
+  t8_attribute_info_struct_t *info;
+  t8_cmesh_save_tree_t record;
+  t8_cmesh_save_attribute_t attribute;
+  int64_t             neighbor;
+  size_t              offset;
+  int                 iface, num_faces, iatt;
+
+  tree = t8_cmesh_trees_get_tree_ext (cmesh->trees, ltree, &face_neighbors,
+                                      &ttf);
+  num_faces = t8_eclass_num_faces[tree->eclass];
+  offset = sizeof (record) + num_faces * (sizeof (int64_t) + 2);
+  if (buffer != NULL) {
+    record.eclass = tree->eclass;
+    record.num_attributes = tree->num_attributes;
+    memcpy (buffer, &record, sizeof (record));
+    for (iface = 0; iface < num_faces; iface++) {
+      neighbor = t8_cmesh_save_global_id (cmesh, face_neighbors[iface],
+                                          &eclass);
+      memcpy (buffer + sizeof (record) + iface * sizeof (int64_t),
+              &neighbor, sizeof (int64_t));
+      buffer[sizeof (record) + num_faces * sizeof (int64_t) + iface] =
+        ttf[iface];
+      buffer[sizeof (record) + num_faces * (sizeof (int64_t) + 1) + iface] =
+        eclass;
+    }
+  }
+  for (iatt = 0; iatt < tree->num_attributes; iatt++) {
+    info = T8_TREE_ATTR_INFO (tree, iatt);
+    if (buffer != NULL) {
+      attribute.package_id = info->package_id == t8_get_package_id () ?
+        T8_CMESH_SAVE_T8_PACKAGE : info->package_id;
+      attribute.key = info->key;
+      attribute.size = info->attribute_size;
+      memcpy (buffer + offset, &attribute, sizeof (attribute));
+      memcpy (buffer + offset + sizeof (attribute), T8_TREE_ATTR (tree, info),
+              info->attribute_size);
+    }
+    offset += sizeof (attribute) + info->attribute_size;
+  }
+  return offset;
+}
+
+int
+t8_cmesh_save_parallel (t8_cmesh_t cmesh, const char *filename,
+                        sc_MPI_Comm comm)
+{
+  t8_cmesh_save_file_t fh;
+  t8_cmesh_save_header_t header;
+  t8_locidx_t         first_ltree, num_save_trees, itree;
+  int64_t            *offsets, data_offset;
+  long long           local_counts[2], first_counts[2];
+  char               *buffer;
+  size_t              num_bytes;
+  int                 iclass, mpiret, success;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (t8_cmesh_comm_is_valid (cmesh, comm));
+  T8_ASSERT (filename != NULL);
+
+  /* Determine the trees that this process writes.
+   * A shared first tree is written by the previous process. */
+  if (cmesh->set_partition) {
+    first_ltree = cmesh->num_local_trees > 0 && cmesh->first_tree_shared;
+    num_save_trees = cmesh->num_local_trees - first_ltree;
+  }
+  else {
+    first_ltree = cmesh->num_trees * cmesh->mpirank / cmesh->mpisize;
+    num_save_trees = cmesh->num_trees * (cmesh->mpirank + 1)
+      / cmesh->mpisize - first_ltree;
+  }
+
+  /* Compute the size of our records */
+  offsets = T8_ALLOC (int64_t, num_save_trees + 1);
+  offsets[0] = 0;
+  for (itree = 0; itree < num_save_trees; itree++) {
+    offsets[itree + 1] = offsets[itree]
+      + t8_cmesh_save_pack_tree (cmesh, first_ltree + itree, NULL);
+  }
+  num_bytes = offsets[num_save_trees];
+  buffer = T8_ALLOC (char, SC_MAX (num_bytes, 1));
+  for (itree = 0; itree < num_save_trees; itree++) {
+    (void) t8_cmesh_save_pack_tree (cmesh, first_ltree + itree,
+                                    buffer + offsets[itree]);
+  }
+
+  /* Compute the first tree and the first byte of this process in the file */
+  local_counts[0] = num_save_trees;
+  local_counts[1] = num_bytes;
+  mpiret = sc_MPI_Exscan (local_counts, first_counts, 2,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (cmesh->mpirank == 0) {
+    /* The result of Exscan is undefined on the first process */
+    first_counts[0] = first_counts[1] = 0;
+  }
+  T8_ASSERT (!cmesh->set_partition || num_save_trees == 0
+             || first_counts[0] == cmesh->first_tree + first_ltree);
+  data_offset = sizeof (header) + (cmesh->num_trees + 1) * sizeof (int64_t)
+    + first_counts[1];
+  for (itree = 0; itree <= num_save_trees; itree++) {
+    offsets[itree] += data_offset;
+  }
+
+  memset (&header, 0, sizeof (header));
+  header.magic = T8_CMESH_SAVE_MAGIC;
+  header.format = T8_CMESH_FILE_FORMAT;
+  header.dimension = cmesh->dimension;
+  header.num_trees = cmesh->num_trees;
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    header.num_trees_per_eclass[iclass] = cmesh->num_trees_per_eclass[iclass];
+  }
+
+  success = t8_cmesh_save_open (&fh, filename, 1, comm);
+  if (success) {
+    t8_cmesh_save_access_at (&fh, 0, &header,
+                             cmesh->mpirank == 0 ? sizeof (header) : 0, 1);
+    /* The last process also writes the end of the file */
+    t8_cmesh_save_access_at (&fh, sizeof (header)
+                             + first_counts[0] * sizeof (int64_t), offsets,
+                             (num_save_trees +
+                              (cmesh->mpirank == cmesh->mpisize - 1))
+                             * sizeof (int64_t), 1);
+    t8_cmesh_save_access_at (&fh, data_offset, buffer, num_bytes, 1);
+    success = t8_cmesh_save_close (&fh);
+  }
+  if (!success) {
+    t8_global_errorf ("Error when writing file %s.\n", filename);
+  }
+  T8_FREE (offsets);
+  T8_FREE (buffer);
+  return success;
+}
+
+/* Compare two ghosts by their global id */
+static int
+t8_cmesh_save_ghost_compare (const void *a, const void *b)
+{
+  const t8_gloidx_t   id_a = ((const t8_cmesh_save_ghost_t *) a)->gtree_id;
+  const t8_gloidx_t   id_b = ((const t8_cmesh_save_ghost_t *) b)->gtree_id;
+
+  return (id_a > id_b) - (id_a < id_b);
+}
+
+/* Add the trees in the records of a single cmesh file to the stash of a
+ * cmesh. The trees first_tree, ..., last_tree - 1 are local. Returns false
+ * if the records are inconsistent. */
+static int
+t8_cmesh_load_parallel_trees (t8_cmesh_t cmesh, const char *buffer,
+                              const int64_t * offsets, t8_gloidx_t first_tree,
+                              t8_gloidx_t last_tree, t8_gloidx_t num_trees)
+{
+  const char         *record;
+  t8_cmesh_save_tree_t tree;
+  t8_cmesh_save_attribute_t attribute;
+  t8_cmesh_save_ghost_t *ghost;
+  sc_array_t          ghosts;
+  t8_gloidx_t         gtree, neighbor;
+  int64_t             size, offset;
+  int                 iface, num_faces, neighbor_face, iatt, F;
+  int8_t              ttf, neighbor_eclass;
+  size_t              ighost;
+
+  F = t8_eclass_max_num_faces[cmesh->dimension];
+  sc_array_init (&ghosts, sizeof (t8_cmesh_save_ghost_t));
+  for (gtree = first_tree; gtree < last_tree; gtree++) {
+    record = buffer + (offsets[gtree - first_tree] - offsets[0]);
+    size = offsets[gtree - first_tree + 1] - offsets[gtree - first_tree];
+    if (size < (int64_t) sizeof (tree)) {
+      sc_array_reset (&ghosts);
+      return 0;
+    }
+    memcpy (&tree, record, sizeof (tree));
+    if (tree.eclass < 0 || tree.eclass >= T8_ECLASS_COUNT
+        || t8_eclass_to_dimension[tree.eclass] != cmesh->dimension) {
+      sc_array_reset (&ghosts);
+      return 0;
+    }
+    t8_cmesh_set_tree_class (cmesh, gtree, (t8_eclass_t) tree.eclass);
+    num_faces = t8_eclass_num_faces[tree.eclass];
+    offset = sizeof (tree) + num_faces * (sizeof (int64_t) + 2);
+    if (size < offset) {
+      sc_array_reset (&ghosts);
+      return 0;
+    }
+    for (iface = 0; iface < num_faces; iface++) {
+      memcpy (&neighbor, record + sizeof (tree) + iface * sizeof (int64_t),
+              sizeof (int64_t));
+      ttf = record[sizeof (tree) + num_faces * sizeof (int64_t) + iface];
+      neighbor_eclass =
+        record[sizeof (tree) + num_faces * (sizeof (int64_t) + 1) + iface];
+      neighbor_face = ttf % F;
+      if (neighbor < 0 || neighbor >= num_trees || neighbor_eclass < 0
+          || neighbor_eclass >= T8_ECLASS_COUNT) {
+        sc_array_reset (&ghosts);
+        return 0;
+      }
+      if (neighbor == gtree && neighbor_face == iface) {
+        /* This face is a domain boundary */
+        continue;
+      }
+      if (first_tree <= neighbor && neighbor < last_tree) {
+        /* Both trees are local, we set the connection only once */
+        if (gtree < neighbor || (gtree == neighbor && iface < neighbor_face)) {
+          t8_cmesh_set_join (cmesh, gtree, neighbor, iface, neighbor_face,
+                             ttf / F);
+        }
+      }
+      else {
+        t8_cmesh_set_join (cmesh, gtree, neighbor, iface, neighbor_face,
+                           ttf / F);
+        ghost = (t8_cmesh_save_ghost_t *) sc_array_push (&ghosts);
+        ghost->gtree_id = neighbor;
+        ghost->eclass = (t8_eclass_t) neighbor_eclass;
+      }
+    }
+    for (iatt = 0; iatt < tree.num_attributes; iatt++) {
+      if (size < offset + (int64_t) sizeof (attribute)) {
+        sc_array_reset (&ghosts);
+        return 0;
+      }
+      memcpy (&attribute, record + offset, sizeof (attribute));
+      offset += sizeof (attribute);
+      if (attribute.size < 0 || size < offset + attribute.size) {
+        sc_array_reset (&ghosts);
+        return 0;
+      }
+      t8_cmesh_set_attribute (cmesh, gtree,
+                              attribute.package_id == T8_CMESH_SAVE_T8_PACKAGE
+                              ? t8_get_package_id () : attribute.package_id,
+                              attribute.key, (void *) (record + offset),
+                              attribute.size, 0);
+      offset += attribute.size;
+    }
+  }
+  /* Set the classes of the ghosts */
+  sc_array_sort (&ghosts, t8_cmesh_save_ghost_compare);
+  sc_array_uniq (&ghosts, t8_cmesh_save_ghost_compare);
+  for (ighost = 0; ighost < ghosts.elem_count; ighost++) {
+    ghost = (t8_cmesh_save_ghost_t *) sc_array_index (&ghosts, ighost);
+    t8_cmesh_set_tree_class (cmesh, ghost->gtree_id, ghost->eclass);
+  }
+  sc_array_reset (&ghosts);
+  return 1;
+}
+
+t8_cmesh_t
+t8_cmesh_load_parallel (const char *filename, int do_partition,
+                        sc_MPI_Comm comm)
+{
+  t8_cmesh_save_file_t fh;
+  t8_cmesh_save_header_t header;
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t         first_tree, last_tree;
+  int64_t            *offsets = NULL;
+  char               *buffer = NULL;
+  long long           num_bytes;
+  int                 success, local_success, mpiret;
+
+  T8_ASSERT (filename != NULL);
+
+  if (!t8_cmesh_save_open (&fh, filename, 0, comm)) {
+    t8_global_errorf ("Error when opening file %s.\n", filename);
+    return NULL;
+  }
+  /* Read the header and check whether it is a cmesh file in the
+   * current format */
+  memset (&header, 0, sizeof (header));
+  t8_cmesh_save_access_at (&fh, 0, &header, sizeof (header), 0);
+  local_success = !fh.failed && header.magic == T8_CMESH_SAVE_MAGIC
+    && header.format == T8_CMESH_FILE_FORMAT && header.num_trees >= 0
+    && 0 <= header.dimension && header.dimension <= T8_ECLASS_MAX_DIM;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (success) {
+    /* Read the offsets and records of our trees */
+    first_tree = do_partition ?
+      header.num_trees * fh.mpirank / fh.mpisize : 0;
+    last_tree = do_partition ?
+      header.num_trees * (fh.mpirank + 1) / fh.mpisize : header.num_trees;
+    offsets = T8_ALLOC (int64_t, last_tree - first_tree + 1);
+    t8_cmesh_save_access_at (&fh, sizeof (header)
+                             + first_tree * sizeof (int64_t), offsets,
+                             (last_tree - first_tree + 1) * sizeof (int64_t),
+                             0);
+    num_bytes = fh.failed ? 0 : offsets[last_tree - first_tree] - offsets[0];
+    fh.failed |= num_bytes < 0;
+    num_bytes = SC_MAX (num_bytes, 0);
+    buffer = T8_ALLOC (char, SC_MAX (num_bytes, 1));
+    t8_cmesh_save_access_at (&fh, fh.failed ? 0 : offsets[0], buffer,
+                             fh.failed ? 0 : num_bytes, 0);
+  }
+  if (!t8_cmesh_save_close (&fh) || !success) {
+    t8_global_errorf ("Error when reading file %s.\n", filename);
+    T8_FREE (offsets);
+    T8_FREE (buffer);
+    return NULL;
+  }
+
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, header.dimension);
+  local_success = t8_cmesh_load_parallel_trees (cmesh, buffer, offsets,
+                                                first_tree, last_tree,
+                                                header.num_trees);
+  T8_FREE (offsets);
+  T8_FREE (buffer);
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    t8_global_errorf ("File %s is corrupted.\n", filename);
+    t8_cmesh_destroy (&cmesh);
+    return NULL;
+  }
+  if (do_partition) {
+    t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree - 1);
+  }
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
+/* The data of a raw cmesh file starts at a multiple of this many bytes */
+#define T8_CMESH_RAW_ALIGNMENT 64
+
+int
+t8_cmesh_save_raw (t8_cmesh_t cmesh, const char *filename, sc_MPI_Comm comm)
+{
+  t8_cmesh_raw_header_t header;
+  t8_part_tree_t      part;
+  char                padding[T8_CMESH_RAW_ALIGNMENT];
+  const char         *data = NULL;
+  FILE               *fp;
+  int                 success = 1, mpiret, iclass;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (filename != NULL);
+
+  if (cmesh->set_partition) {
+    t8_global_errorf ("Only a replicated cmesh can be saved in raw format.\n");
+    return 0;
+  }
+  if (cmesh->mpirank == 0) {
+    memset (&header, 0, sizeof (header));
+    header.magic = T8_CMESH_RAW_MAGIC;
+    header.format = T8_CMESH_RAW_FORMAT;
+    header.dimension = cmesh->dimension;
+    header.num_trees = cmesh->num_trees;
+    for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+      header.num_trees_per_eclass[iclass] =
+        cmesh->num_trees_per_eclass[iclass];
+    }
+    header.package_id = t8_get_package_id ();
+    header.tree_size = sizeof (t8_ctree_struct_t);
+    header.attribute_info_size = sizeof (t8_attribute_info_struct_t);
+    if (cmesh->trees != NULL) {
+      T8_ASSERT (t8_cmesh_trees_get_num_procs (cmesh->trees) == 1);
+      part = t8_cmesh_trees_get_part (cmesh->trees, 0);
+      data = part->first_tree;
+      header.num_bytes = t8_cmesh_trees_get_part_alloc (cmesh->trees, part);
+    }
+    header.data_offset = (sizeof (header) + T8_CMESH_RAW_ALIGNMENT - 1)
+      / T8_CMESH_RAW_ALIGNMENT * T8_CMESH_RAW_ALIGNMENT;
+    memset (padding, 0, sizeof (padding));
+
+    fp = fopen (filename, "wb");
+    if (fp == NULL) {
+      success = 0;
+    }
+    else {
+      success = fwrite (&header, sizeof (header), 1, fp) == 1
+        && fwrite (padding, 1, header.data_offset - sizeof (header), fp)
+        == header.data_offset - sizeof (header)
+        && (header.num_bytes == 0
+            || fwrite (data, header.num_bytes, 1, fp) == 1);
+      success = !fclose (fp) && success;
+    }
+  }
+  mpiret = sc_MPI_Bcast (&success, 1, sc_MPI_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    t8_global_errorf ("Error when writing file %s.\n", filename);
+  }
+  return success;
+}
+
+/* Gets two attribute_info structs and compares their package id and key */
+static int
+t8_cmesh_load_raw_compare_attributes (const void *A1, const void *A2)
+{
+  const t8_attribute_info_struct_t *attr1 = A1, *attr2 = A2;
+
+  if (attr1->package_id != attr2->package_id) {
+    return attr1->package_id < attr2->package_id ? -1 : 1;
+  }
+  return attr1->key < attr2->key ? -1 : attr1->key != attr2->key;
+}
+
+/* The package id of t8code may differ from the one of the program that
+ * wrote a raw cmesh file. We replace the package id of the t8code attributes
+ * and sort the attribute infos of each tree again, since they are searched
+ * by package id and key. This only touches the pages of the attribute
+ * infos. */
+static void
+t8_cmesh_load_raw_package_id (t8_cmesh_t cmesh, int file_package_id)
+{
+  t8_attribute_info_struct_t *attr_info;
+  t8_ctree_t          tree;
+  t8_locidx_t         ltree;
+  sc_array_t          tree_attr;
+  int                 iattr;
+
+  for (ltree = 0; ltree < cmesh->num_local_trees; ltree++) {
+    tree = t8_cmesh_trees_get_tree (cmesh->trees, ltree);
+    for (iattr = 0; iattr < tree->num_attributes; iattr++) {
+      attr_info = T8_TREE_ATTR_INFO (tree, iattr);
+      if (attr_info->package_id == file_package_id) {
+        attr_info->package_id = t8_get_package_id ();
+      }
+    }
+    sc_array_init_data (&tree_attr, T8_TREE_FIRST_ATT (tree),
+                        sizeof (t8_attribute_info_struct_t),
+                        tree->num_attributes);
+    sc_array_sort (&tree_attr, t8_cmesh_load_raw_compare_attributes);
+  }
+}
+
+t8_cmesh_t
+t8_cmesh_load_raw (const char *filename, sc_MPI_Comm comm)
+{
+  t8_cmesh_raw_header_t header;
+  t8_cmesh_t          cmesh;
+  t8_part_tree_t      part;
+  char               *data = NULL;
+  void               *mapped = NULL;
+  size_t              mapped_length = 0;
+  FILE               *fp;
+  long                file_size = -1;
+  int                 success, local_success, mpiret, iclass;
+
+  T8_ASSERT (filename != NULL);
+
+  /* Read the header and check whether the file fits to this build */
+  memset (&header, 0, sizeof (header));
+  fp = fopen (filename, "rb");
+  if (fp != NULL && fread (&header, sizeof (header), 1, fp) == 1
+      && fseek (fp, 0, SEEK_END) == 0) {
+    file_size = ftell (fp);
+  }
+  local_success = file_size >= 0 && header.magic == T8_CMESH_RAW_MAGIC
+    && header.format == T8_CMESH_RAW_FORMAT
+    && header.tree_size == (int64_t) sizeof (t8_ctree_struct_t)
+    && header.attribute_info_size ==
+    (int64_t) sizeof (t8_attribute_info_struct_t)
+    && 0 <= header.dimension && header.dimension <= T8_ECLASS_MAX_DIM
+    && 0 <= header.num_trees
+    && header.num_trees == (t8_locidx_t) header.num_trees
+    && (int64_t) sizeof (header) <= header.data_offset
+    && header.data_offset % T8_CMESH_RAW_ALIGNMENT == 0
+    && 0 <= header.num_bytes
+    && header.data_offset + header.num_bytes <= file_size
+    && (header.num_trees == 0) == (header.num_bytes == 0);
+  if (local_success && header.num_bytes > 0) {
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+    /* The mapping is private, such that the trees may be modified without
+     * changing the file. */
+    mapped_length = header.data_offset + header.num_bytes;
+    mapped = mmap (NULL, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                   fileno (fp), 0);
+    if (mapped == MAP_FAILED) {
+      mapped = NULL;
+      local_success = 0;
+    }
+    else {
+      data = (char *) mapped + header.data_offset;
+    }
+#else
+    data = T8_ALLOC (char, header.num_bytes);
+    local_success = fseek (fp, header.data_offset, SEEK_SET) == 0
+      && fread (data, header.num_bytes, 1, fp) == 1;
+#endif
+  }
+  if (fp != NULL) {
+    fclose (fp);
+  }
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success) {
+    t8_global_errorf ("Error when reading file %s.\n", filename);
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+    if (mapped != NULL) {
+      munmap (mapped, mapped_length);
+    }
+#else
+    T8_FREE (data);
+#endif
+    return NULL;
+  }
+
+  t8_cmesh_init (&cmesh);
+  cmesh->dimension = header.dimension;
+  cmesh->num_trees = cmesh->num_local_trees = header.num_trees;
+  cmesh->first_tree = 0;
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    cmesh->num_trees_per_eclass[iclass] =
+      cmesh->num_local_trees_per_eclass[iclass] =
+      header.num_trees_per_eclass[iclass];
+  }
+  if (header.num_trees > 0) {
+    /* The trees use the data of the file in place */
+    t8_cmesh_trees_init (&cmesh->trees, 1, cmesh->num_local_trees, 0);
+    t8_cmesh_trees_start_part (cmesh->trees, 0, 0, cmesh->num_local_trees,
+                               0, 0, 0);
+    part = t8_cmesh_trees_get_part (cmesh->trees, 0);
+    part->first_tree = data;
+    if (mapped != NULL) {
+      cmesh->trees->mapped_part = mapped;
+      cmesh->trees->mapped_length = mapped_length;
+      cmesh->trees->shared_part_id = 0;
+    }
+    if (header.package_id != t8_get_package_id ()) {
+      t8_cmesh_load_raw_package_id (cmesh, header.package_id);
+    }
+  }
+  cmesh->committed = 1;
+  mpiret = sc_MPI_Comm_rank (comm, &cmesh->mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &cmesh->mpisize);
+  SC_CHECK_MPI (mpiret);
+  t8_stash_destroy (&cmesh->stash);
+  return cmesh;
+}
@@ -24,13 +24,40 @@
  *
  * We define routines to save and load a cmesh to/from the file system.
  *
- * TODO: document this file
+ * A cmesh can be saved with one ascii file per process via
+ * \ref t8_cmesh_save or with a single binary file for all processes via
+ * \ref t8_cmesh_save_parallel.
+ * The single file consists of
+ *  - a header of type \ref t8_cmesh_save_header_t,
+ *  - num_trees + 1 int64_t file offsets, the i-th one pointing to the
+ *    record of tree i and the last one to the end of the file,
+ *  - the records of the trees in global order. The record of a tree is its
+ *    eclass and number of attributes as two int32_t, then for each face the
+ *    global id of the face neighbor as int64_t, then for each face the
+ *    tree_to_face entry as int8_t, then for each face the eclass of
+ *    the face neighbor as int8_t and finally for each attribute its package id
+ *    and key as two int32_t, its size as int64_t and its data.
+ *
+ * All numbers are stored in the native byte order. A domain boundary is
+ * stored as a face that is connected to itself.
+ * Since the offsets of all trees are stored, any range of trees can be
+ * read directly from the file.
+ *
+ * A replicated cmesh can also be saved in raw format via
+ * \ref t8_cmesh_save_raw. A raw file consists of a header of type
+ * \ref t8_cmesh_raw_header_t followed by the memory block that stores the
+ * trees, faces and attributes of the cmesh exactly as described in
+ * t8_cmesh_trees.h. Since this block only uses offsets and no pointers,
+ * \ref t8_cmesh_load_raw maps the file into memory and uses it in place.
+ * A raw file can only be read by a build of t8code with the same memory
+ * layout of the trees.
  */
 
 #ifndef T8_CMESH_SAVE_H
 #define T8_CMESH_SAVE_H
 
 #include <t8.h>
+#include <t8_eclass.h>
 
 /** Increment this constant each time the file format changes.
  *  We can only read files that were written in the same format. */
@@ -56,6 +83,52 @@ typedef enum t8_load_mode
   T8_LOAD_COUNT
 } t8_load_mode_t;
 
+/** The first 8 bytes of a single file cmesh, "t8cmesh" in ascii. */
+#define T8_CMESH_SAVE_MAGIC 0x7438636d657368LL
+
+/** Increment this constant each time the single file format changes. */
+#define T8_CMESH_FILE_FORMAT 0x0001
+
+/** The package id under which the attributes of t8code are stored in a
+ * single cmesh file. Since the package id of t8code may change from program
+ * to program, we store this value instead. */
+#define T8_CMESH_SAVE_T8_PACKAGE (-1)
+
+/** The header of a single cmesh file. */
+typedef struct t8_cmesh_save_header
+{
+  int64_t             magic;      /**< Always \ref T8_CMESH_SAVE_MAGIC. */
+  int64_t             format;     /**< The \ref T8_CMESH_FILE_FORMAT of the file. */
+  int64_t             dimension;  /**< The dimension of the cmesh. */
+  int64_t             num_trees;  /**< The global number of trees. */
+  int64_t             num_trees_per_eclass[T8_ECLASS_COUNT]; /**< The global number of trees of each eclass. */
+} t8_cmesh_save_header_t;
+
+/** The first 8 bytes of a raw cmesh file, "t8craw" in ascii. */
+#define T8_CMESH_RAW_MAGIC 0x743863726177LL
+
+/** Increment this constant each time the raw file format or the memory
+ * layout of the trees changes. */
+#define T8_CMESH_RAW_FORMAT 0x0001
+
+/** The header of a raw cmesh file.
+ * The data of the trees starts at data_offset, which is a multiple of
+ * 64 bytes, such that the trees are properly aligned when the file is mapped
+ * into memory. */
+typedef struct t8_cmesh_raw_header
+{
+  int64_t             magic;      /**< Always \ref T8_CMESH_RAW_MAGIC. */
+  int64_t             format;     /**< The \ref T8_CMESH_RAW_FORMAT of the file. */
+  int64_t             dimension;  /**< The dimension of the cmesh. */
+  int64_t             num_trees;  /**< The number of trees. */
+  int64_t             num_trees_per_eclass[T8_ECLASS_COUNT]; /**< The number of trees of each eclass. */
+  int64_t             package_id; /**< The package id of t8code when the file was written. */
+  int64_t             tree_size;  /**< The size of a \ref t8_ctree_struct_t in bytes. */
+  int64_t             attribute_info_size; /**< The size of a \ref t8_attribute_info_struct_t in bytes. */
+  int64_t             num_bytes;  /**< The size of the data of the trees in bytes. */
+  int64_t             data_offset; /**< The offset of the data of the trees in the file. */
+} t8_cmesh_raw_header_t;
+
 T8_EXTERN_C_BEGIN ();
 
 T8_EXTERN_C_END ();
@@ -95,7 +95,10 @@ t8_stash_class_sort (t8_stash_t stash)
 {
   T8_ASSERT (stash != NULL);
 
-  sc_array_sort (&stash->classes, t8_stash_class_compare);
+  /* Classes are usually added in order, so we only sort if needed */
+  if (!sc_array_is_sorted (&stash->classes, t8_stash_class_compare)) {
+    sc_array_sort (&stash->classes, t8_stash_class_compare);
+  }
 }
 
 static int
@@ -153,7 +156,9 @@ t8_stash_joinface_sort (t8_stash_t stash)
 {
   T8_ASSERT (stash != NULL);
 
-  sc_array_sort (&stash->joinfaces, t8_stash_facejoin_compare);
+  if (!sc_array_is_sorted (&stash->joinfaces, t8_stash_facejoin_compare)) {
+    sc_array_sort (&stash->joinfaces, t8_stash_facejoin_compare);
+  }
 }
 
 void
@@ -242,96 +247,93 @@ t8_stash_attribute_compare (const void *v1, const void *v2)
 void
 t8_stash_attribute_sort (t8_stash_t stash)
 {
-  sc_array_sort (&stash->attributes, t8_stash_attribute_compare);
+  /* Attributes are usually added in order, so we only sort if needed */
+  if (!sc_array_is_sorted (&stash->attributes, t8_stash_attribute_compare)) {
+    sc_array_sort (&stash->attributes, t8_stash_attribute_compare);
+  }
 }
 
-static void
-t8_stash_bcast_attributes (sc_array_t * attributes, int root,
-                           sc_MPI_Comm comm)
+size_t
+t8_stash_get_attribute_bytes (t8_stash_t stash)
 {
-  size_t              num_atts, iatt, att_size, copied_bytes;
-  t8_stash_attribute_struct_t *att;
-  char               *buffer;
-  int                 mpirank, mpisize, mpiret;
-  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
-  SC_CHECK_MPI (mpiret);
-  mpiret = sc_MPI_Comm_size (comm, &mpisize);
-  SC_CHECK_MPI (mpiret);
+  size_t              iatt, att_size;
 
-  T8_ASSERT (attributes != NULL);
-
-  num_atts = attributes->elem_count;
-
-  /* Count the number of byte of all attributes */
+  T8_ASSERT (stash != NULL);
   att_size = 0;
-  for (iatt = 0; iatt < num_atts; iatt++) {
-    att = (t8_stash_attribute_struct_t *) sc_array_index (attributes, iatt);
-    att_size += att->attr_size;
-  }
-  /* Allocat buffer */
-  buffer = T8_ALLOC_ZERO (char, att_size);
-  /* Copy all attributes to send buffer */
-  if (mpirank == root) {
-    copied_bytes = 0;
-    for (iatt = 0; iatt < num_atts; iatt++) {
-      att = (t8_stash_attribute_struct_t *) sc_array_index (attributes, iatt);
-      memcpy (buffer + copied_bytes, att->attr_data, att->attr_size);
-      copied_bytes += att->attr_size;
-    }
-  }
-  /* broadcast buffer */
-  sc_MPI_Bcast (buffer, att_size, sc_MPI_BYTE, root, comm);
-  /* Copy attributes from buffer back to stash */
-  if (mpirank != root) {
-    copied_bytes = 0;
-    for (iatt = 0; iatt < num_atts; iatt++) {
-      att = (t8_stash_attribute_struct_t *) sc_array_index (attributes, iatt);
-      att->attr_data = T8_ALLOC (char, att->attr_size);
-      memcpy (att->attr_data, buffer + copied_bytes, att->attr_size);
-      copied_bytes += att->attr_size;
-    }
+  for (iatt = 0; iatt < stash->attributes.elem_count; iatt++) {
+    att_size += t8_stash_get_attribute_size (stash, iatt);
   }
-  T8_FREE (buffer);
+  return att_size;
 }
 
 /* bcast the data of stash on root to all procs.
- * On the other procs stash_init has to be called before */
+ * On the other procs stash_init has to be called before.
+ * We pack the attributes, classes and joinfaces arrays and the data of
+ * the attributes into one buffer and broadcast it at once. */
 t8_stash_t
 t8_stash_bcast (t8_stash_t stash, int root, sc_MPI_Comm comm,
-                size_t elem_counts[3])
+                size_t elem_counts[])
 {
-  int                 mpirank, mpisize, mpiret;
+  int                 mpirank, mpiret;
+  size_t              array_bytes[3], num_bytes, offset, iatt;
+  sc_array_t         *arrays[3];
+  t8_stash_attribute_struct_t *att;
+  char               *buffer;
+  int                 iarray;
+
   mpiret = sc_MPI_Comm_rank (comm, &mpirank);
   SC_CHECK_MPI (mpiret);
-  mpiret = sc_MPI_Comm_size (comm, &mpisize);
-  SC_CHECK_MPI (mpiret);
 
-  if (mpirank != root) {
-    sc_array_resize (&stash->attributes, elem_counts[0]);
-    sc_array_resize (&stash->classes, elem_counts[1]);
-    sc_array_resize (&stash->joinfaces, elem_counts[2]);
+  arrays[0] = &stash->attributes;
+  arrays[1] = &stash->classes;
+  arrays[2] = &stash->joinfaces;
+  num_bytes = elem_counts[3];
+  for (iarray = 0; iarray < 3; iarray++) {
+    if (mpirank != root) {
+      sc_array_resize (arrays[iarray], elem_counts[iarray]);
+    }
+    T8_ASSERT (arrays[iarray]->elem_count == elem_counts[iarray]);
+    array_bytes[iarray] = elem_counts[iarray] * arrays[iarray]->elem_size;
+    num_bytes += array_bytes[iarray];
   }
-  if (elem_counts[0] > 0) {
-    mpiret = sc_MPI_Bcast (stash->attributes.array,
-                           elem_counts[0] *
-                           sizeof (t8_stash_attribute_struct_t), sc_MPI_BYTE,
-                           0, comm);
-    SC_CHECK_MPI (mpiret);
-    t8_stash_bcast_attributes (&stash->attributes, root, comm);
+  if (num_bytes == 0) {
+    return stash;
   }
-  if (elem_counts[1] > 0) {
-    mpiret = sc_MPI_Bcast (stash->classes.array,
-                           elem_counts[1] * sizeof (t8_stash_class_struct_t),
-                           sc_MPI_BYTE, 0, comm);
-    SC_CHECK_MPI (mpiret);
+  buffer = T8_ALLOC (char, num_bytes);
+  if (mpirank == root) {
+    T8_ASSERT (elem_counts[3] == t8_stash_get_attribute_bytes (stash));
+    offset = 0;
+    for (iarray = 0; iarray < 3; iarray++) {
+      memcpy (buffer + offset, arrays[iarray]->array, array_bytes[iarray]);
+      offset += array_bytes[iarray];
+    }
+    for (iatt = 0; iatt < elem_counts[0]; iatt++) {
+      att = (t8_stash_attribute_struct_t *)
+        sc_array_index (&stash->attributes, iatt);
+      memcpy (buffer + offset, att->attr_data, att->attr_size);
+      offset += att->attr_size;
+    }
+    T8_ASSERT (offset == num_bytes);
   }
-  if (elem_counts[2] > 0) {
-    mpiret = sc_MPI_Bcast (stash->joinfaces.array,
-                           elem_counts[2] *
-                           sizeof (t8_stash_joinface_struct_t), sc_MPI_BYTE,
-                           0, comm);
-    SC_CHECK_MPI (mpiret);
+  t8_bcast_bytes (buffer, num_bytes, root, comm);
+  if (mpirank != root) {
+    offset = 0;
+    for (iarray = 0; iarray < 3; iarray++) {
+      memcpy (arrays[iarray]->array, buffer + offset, array_bytes[iarray]);
+      offset += array_bytes[iarray];
+    }
+    for (iatt = 0; iatt < elem_counts[0]; iatt++) {
+      att = (t8_stash_attribute_struct_t *)
+        sc_array_index (&stash->attributes, iatt);
+      /* The attribute pointers of root are not valid here, we copy the data */
+      att->attr_data = T8_ALLOC (char, att->attr_size);
+      att->is_owned = 1;
+      memcpy (att->attr_data, buffer + offset, att->attr_size);
+      offset += att->attr_size;
+    }
+    T8_ASSERT (offset == num_bytes);
   }
+  T8_FREE (buffer);
   return stash;
 }
 
@@ -210,16 +210,27 @@ int                 t8_stash_attribute_is_owned (t8_stash_t stash,
  */
 void                t8_stash_attribute_sort (t8_stash_t stash);
 
+/** Return the total number of bytes of the data of all attributes
+ * in a stash.
+ * \param [in]      stash   The stash to be considered.
+ * \return          The sum of the sizes of all attributes.
+ */
+size_t              t8_stash_get_attribute_bytes (t8_stash_t stash);
+
 /** Broadcast a stash on the root process to all processes in a communicator.
- *  The number of entries in the classes, joinfaces and attributes arrays must
- *  be known on the receiving processes before calling this function.
+ *  The number of entries in the attributes, classes and joinfaces arrays
+ *  and the number of attribute bytes must be known on the receiving
+ *  processes before calling this function.
+ *  All data is sent with a single message.
  *  \param [in,out] stash   On root the stash that is to be broadcasted.
  *                          On the other process an initialized stash. Its entries will
  *                          get overwritten by the entries in the root stash.
  *  \param [in]     root    The mpirank of the root process.
  *  \param [in]     comm    The mpi communicator which is used fpr broadcast.
- *  \param [in]     elem_counts An array with three entries giving the number of
- *                  elements in the classes, joinfaces and attributes arrays.
+ *  \param [in]     elem_counts An array with four entries giving the number of
+ *                  elements in the attributes, classes and joinfaces arrays
+ *                  and the return value of \ref t8_stash_get_attribute_bytes
+ *                  on root.
  */
 t8_stash_t          t8_stash_bcast (t8_stash_t stash, int root,
                                     sc_MPI_Comm comm, size_t elem_counts[]);
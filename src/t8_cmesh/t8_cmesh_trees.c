@@ -27,6 +27,10 @@
 
 #include "t8_cmesh_stash.h"
 #include "t8_cmesh_trees.h"
+#include <t8_data/t8_hash.h>
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+#include <sys/mman.h>
+#endif
 
 /* This struct is needed as a key to search
  * for an argument in the arguments array of a tree */
@@ -88,6 +92,10 @@ t8_cmesh_trees_init (t8_cmesh_trees_t * ptrees, int num_procs,
   trees->ghost_globalid_to_local_id =
     sc_hash_new (t8_cmesh_trees_glo_lo_hash_func,
                  t8_cmesh_trees_glo_lo_hash_equal, NULL, NULL);
+  trees->shared_part = NULL;
+  trees->mapped_part = NULL;
+  trees->mapped_length = 0;
+  trees->shared_part_id = -1;
 
 }
 
@@ -416,7 +424,7 @@ t8_cmesh_trees_ghost_attribute_size (t8_cghost_t ghost)
 
 /* Return the number of allocated bytes for a part's
  * first_tree array */
-static              size_t
+size_t
 t8_cmesh_trees_get_part_alloc (t8_cmesh_trees_t trees, t8_part_tree_t part)
 {
   size_t              byte_alloc;
@@ -434,6 +442,8 @@ t8_cmesh_trees_get_part_alloc (t8_cmesh_trees_t trees, t8_part_tree_t part)
   }
   for (lghost = 0; lghost < part->num_ghosts; lghost++) {
     ghost = t8_cmesh_trees_get_ghost (trees, lghost + part->first_ghost_id);
+    byte_alloc += t8_cmesh_trees_ghost_attribute_size (ghost);
+    byte_alloc += ghost->num_attributes * sizeof (t8_attribute_info_struct_t);
     byte_alloc += t8_cmesh_trees_gneighbor_bytes (ghost);
   }
   return byte_alloc;
@@ -470,12 +480,205 @@ t8_cmesh_trees_copy_part (t8_cmesh_trees_t trees_dest, int part_dest,
   memcpy (partD->first_tree, partS->first_tree, byte_count);
 }
 
+void
+t8_cmesh_trees_share_part (t8_cmesh_trees_t trees, int proc,
+                           sc_MPI_Comm comm)
+{
+  t8_part_tree_t      part;
+  size_t              byte_count;
+
+  T8_ASSERT (trees != NULL);
+  T8_ASSERT (trees->shared_part == NULL && trees->mapped_part == NULL);
+  T8_ASSERT (0 <= proc && proc < t8_cmesh_trees_get_num_procs (trees));
+
+  part = t8_cmesh_trees_get_part (trees, proc);
+  byte_count = t8_cmesh_trees_get_part_alloc (trees, part);
+  t8_shmem_array_init (&trees->shared_part, sizeof (char), byte_count,
+                       comm);
+  /* Only one process per shared memory region copies the data */
+  if (t8_shmem_array_start_writing (trees->shared_part)) {
+    memcpy (t8_shmem_array_get_array (trees->shared_part), part->first_tree,
+            byte_count);
+  }
+  t8_shmem_array_end_writing (trees->shared_part);
+  T8_FREE (part->first_tree);
+  part->first_tree = (char *) t8_shmem_array_get_array (trees->shared_part);
+  trees->shared_part_id = proc;
+}
+
+/* Copy the face neighbors and attributes of a tree or ghost from src to
+ * dest, which lies at byte position dest_pos of the compacted part.
+ * The face neighbors are stored at face_pos, the attribute infos at
+ * info_pos and the attribute data at data_pos. */
+static void
+t8_cmesh_trees_compact_entry (char *first_tree, size_t dest_pos,
+                              size_t *neigh_offset, size_t *att_offset,
+                              int num_attributes, const char *src_face,
+                              size_t face_bytes,
+                              const t8_attribute_info_struct_t *src_info,
+                              const char *src_first_att, size_t face_pos,
+                              size_t info_pos, size_t data_pos)
+{
+  t8_attribute_info_struct_t *dest_info;
+  int                 iatt;
+
+  memcpy (first_tree + face_pos, src_face, face_bytes);
+  *neigh_offset = face_pos - dest_pos;
+  dest_info = (t8_attribute_info_struct_t *) (first_tree + info_pos);
+  for (iatt = 0; iatt < num_attributes; iatt++) {
+    dest_info[iatt] = src_info[iatt];
+    memcpy (first_tree + data_pos,
+            src_first_att + src_info[iatt].attribute_offset,
+            src_info[iatt].attribute_size);
+    /* The attribute offset is relative to the first attribute info */
+    dest_info[iatt].attribute_offset = data_pos - info_pos;
+    data_pos += src_info[iatt].attribute_size;
+  }
+  *att_offset = info_pos - dest_pos;
+}
+
+void
+t8_cmesh_trees_compact (t8_cmesh_trees_t trees)
+{
+  t8_part_tree_t      part;
+  t8_ctree_t          tree;
+  t8_cghost_t         ghost;
+  t8_locidx_t         num_trees, num_ghosts, num_entries;
+  size_t             *positions, face_pos, info_pos, data_pos;
+  size_t              byte_count;
+  char               *first_tree;
+  long long           ientry;
+  int                 iproc, num_parts;
+
+  T8_ASSERT (trees != NULL);
+  num_parts = (int) trees->from_proc->elem_count;
+  if (num_parts <= 1) {
+    /* The trees are already stored in one block */
+    return;
+  }
+  T8_ASSERT (trees->shared_part == NULL && trees->mapped_part == NULL);
+
+  num_trees = num_ghosts = 0;
+  for (iproc = 0; iproc < num_parts; iproc++) {
+    part = t8_cmesh_trees_get_part (trees, iproc);
+    T8_ASSERT (part->num_trees == 0 || part->first_tree_id == num_trees);
+    T8_ASSERT (part->num_ghosts == 0 || part->first_ghost_id == num_ghosts);
+    num_trees += part->num_trees;
+    num_ghosts += part->num_ghosts;
+  }
+  num_entries = num_trees + num_ghosts;
+
+  /* Compute the positions of the face neighbors, attribute infos and
+   * attribute data of each tree and ghost. The face neighbors follow the
+   * tree and ghost structs, then all attribute infos, then the data. */
+  positions = T8_ALLOC (size_t, 3 * num_entries);
+  face_pos = num_trees * sizeof (t8_ctree_struct_t)
+    + num_ghosts * sizeof (t8_cghost_struct_t);
+  info_pos = data_pos = 0;
+  for (ientry = 0; ientry < num_entries; ientry++) {
+    positions[3 * ientry] = face_pos;
+    positions[3 * ientry + 1] = info_pos;
+    positions[3 * ientry + 2] = data_pos;
+    if (ientry < num_trees) {
+      tree = t8_cmesh_trees_get_tree (trees, (t8_locidx_t) ientry);
+      face_pos += t8_cmesh_trees_neighbor_bytes (tree);
+      info_pos += tree->num_attributes * sizeof (t8_attribute_info_struct_t);
+      data_pos += t8_cmesh_trees_attribute_size (tree);
+    }
+    else {
+      ghost = t8_cmesh_trees_get_ghost (trees,
+                                        (t8_locidx_t) (ientry - num_trees));
+      face_pos += t8_cmesh_trees_gneighbor_bytes (ghost);
+      info_pos += ghost->num_attributes * sizeof (t8_attribute_info_struct_t);
+      data_pos += t8_cmesh_trees_ghost_attribute_size (ghost);
+    }
+  }
+  /* Shift the info and data positions behind the face neighbors */
+  for (ientry = 0; ientry < num_entries; ientry++) {
+    positions[3 * ientry + 1] += face_pos;
+    positions[3 * ientry + 2] += face_pos + info_pos;
+  }
+  byte_count = face_pos + info_pos + data_pos;
+  /* Zero the memory, such that the padding bytes compare equal */
+  first_tree = T8_ALLOC_ZERO (char, byte_count);
+
+  /* Each tree and ghost is copied to disjoint memory, thus we can copy
+   * them in parallel. */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (ientry = 0; ientry < (long long) num_entries; ientry++) {
+    if (ientry < num_trees) {
+      const t8_ctree_t    src_tree =
+        t8_cmesh_trees_get_tree (trees, (t8_locidx_t) ientry);
+      const t8_ctree_t    dest_tree = ((t8_ctree_t) first_tree) + ientry;
+
+      *dest_tree = *src_tree;
+      t8_cmesh_trees_compact_entry (first_tree,
+                                    (char *) dest_tree - first_tree,
+                                    &dest_tree->neigh_offset,
+                                    &dest_tree->att_offset,
+                                    src_tree->num_attributes,
+                                    T8_TREE_FACE (src_tree),
+                                    t8_cmesh_trees_neighbor_bytes (src_tree),
+                                    T8_TREE_ATTR_INFO (src_tree, 0),
+                                    T8_TREE_FIRST_ATT (src_tree),
+                                    positions[3 * ientry],
+                                    positions[3 * ientry + 1],
+                                    positions[3 * ientry + 2]);
+    }
+    else {
+      const t8_cghost_t   src_ghost =
+        t8_cmesh_trees_get_ghost (trees, (t8_locidx_t) (ientry - num_trees));
+      const t8_cghost_t   dest_ghost =
+        ((t8_cghost_t) (first_tree + num_trees * sizeof (t8_ctree_struct_t)))
+        + (ientry - num_trees);
+
+      *dest_ghost = *src_ghost;
+      t8_cmesh_trees_compact_entry (first_tree,
+                                    (char *) dest_ghost - first_tree,
+                                    &dest_ghost->neigh_offset,
+                                    &dest_ghost->att_offset,
+                                    src_ghost->num_attributes,
+                                    T8_GHOST_FACE (src_ghost),
+                                    t8_cmesh_trees_gneighbor_bytes (src_ghost),
+                                    T8_GHOST_ATTR_INFO (src_ghost, 0),
+                                    T8_GHOST_FIRST_ATT (src_ghost),
+                                    positions[3 * ientry],
+                                    positions[3 * ientry + 1],
+                                    positions[3 * ientry + 2]);
+    }
+  }
+  T8_FREE (positions);
+
+  /* Replace all parts by one */
+  for (iproc = 0; iproc < num_parts; iproc++) {
+    T8_FREE (t8_cmesh_trees_get_part (trees, iproc)->first_tree);
+  }
+  sc_array_resize (trees->from_proc, 1);
+  part = t8_cmesh_trees_get_part (trees, 0);
+  part->first_tree = first_tree;
+  part->first_tree_id = 0;
+  part->first_ghost_id = 0;
+  part->num_trees = num_trees;
+  part->num_ghosts = num_ghosts;
+  memset (trees->tree_to_proc, 0, num_trees * sizeof (int));
+  if (num_ghosts > 0) {
+    memset (trees->ghost_to_proc, 0, num_ghosts * sizeof (int));
+  }
+}
+
 t8_ctree_t
 t8_cmesh_trees_get_tree (t8_cmesh_trees_t trees, t8_locidx_t ltree)
 {
   int                 proc;
   T8_ASSERT (trees != NULL);
   T8_ASSERT (ltree >= 0);
+  if (trees->from_proc->elem_count == 1) {
+    /* All trees are stored in one part, we index it directly */
+    return t8_part_tree_get_tree ((t8_part_tree_t) trees->from_proc->array,
+                                  ltree);
+  }
   proc = trees->tree_to_proc[ltree];
   T8_ASSERT (proc >= 0 && proc < t8_cmesh_trees_get_num_procs (trees));
 
@@ -548,6 +751,10 @@ t8_cmesh_trees_get_ghost (t8_cmesh_trees_t trees, t8_locidx_t lghost)
   int                 proc;
   T8_ASSERT (trees != NULL);
   T8_ASSERT (lghost >= 0);
+  if (trees->from_proc->elem_count == 1) {
+    return t8_part_tree_get_ghost ((t8_part_tree_t) trees->from_proc->array,
+                                   lghost);
+  }
   proc = trees->ghost_to_proc[lghost];
   T8_ASSERT (proc >= 0 && proc < t8_cmesh_trees_get_num_procs (trees));
 
@@ -658,6 +865,18 @@ void
 t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
                               t8_stash_attribute_struct_t * attr,
                               t8_locidx_t tree_id, size_t index)
+{
+  char               *new_attr;
+
+  new_attr = t8_cmesh_trees_add_attribute_info (trees, proc, attr, tree_id,
+                                                index);
+  memcpy (new_attr, attr->attr_data, attr->attr_size);
+}
+
+char               *
+t8_cmesh_trees_add_attribute_info (t8_cmesh_trees_t trees, int proc,
+                                   t8_stash_attribute_struct_t * attr,
+                                   t8_locidx_t tree_id, size_t index)
 {
   t8_part_tree_t      part;
   t8_ctree_t          tree;
@@ -675,8 +894,6 @@ t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
   attr_info = T8_TREE_ATTR_INFO (tree, index);
   new_attr = T8_TREE_ATTR (tree, attr_info);
 
-  memcpy (new_attr, attr->attr_data, attr->attr_size);
-
   /* Set new values */
   attr_info->key = attr->key;
   attr_info->package_id = attr->package_id;
@@ -693,6 +910,7 @@ t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees, int proc,
         sizeof (t8_attribute_info_struct_t);
     }
   }
+  return new_attr;
 }
 
 #if 0
@@ -1011,23 +1229,37 @@ t8_cmesh_trees_ghost_id (t8_cmesh_t cmesh, t8_cmesh_trees_t trees,
   return -1;
 }
 
+/* The information about a part that is sent by t8_cmesh_trees_bcast */
+typedef struct
+{
+  t8_locidx_t         num_trees;
+  t8_locidx_t         first_tree_id;
+  size_t              num_bytes;
+} t8_cmesh_trees_bcast_part_t;
+
+/* We broadcast the trees with a single message.
+ * The message starts with the data of part 0, followed by the data of the
+ * other parts, the part information and the tree_to_proc array.
+ * On root, we grow the memory of part 0 to the size of the message,
+ * such that the (usually only) part does not need to be copied.
+ * Likewise, the receiving processes shrink the message to part 0. */
 void
 t8_cmesh_trees_bcast (t8_cmesh_t cmesh_in, int root, sc_MPI_Comm comm)
 {
-  int                 num_parts, ipart;
-  int                 mpirank, mpiret, mpisize;
+  int                 ipart;
+  int                 mpirank, mpiret;
   t8_cmesh_trees_t    trees = NULL;
   t8_part_tree_t      part;
+  t8_cmesh_trees_bcast_part_t *part_info;
+  char               *buffer = NULL;
+  size_t              part_offset, info_offset;
 
   struct
   {
-    t8_locidx_t         num_trees;
-    t8_locidx_t         first_tree_id;
+    int                 num_parts;
     size_t              num_bytes;
-  } part_info;
+  } header;
 
-  mpiret = sc_MPI_Comm_size (comm, &mpisize);
-  SC_CHECK_MPI (mpiret);
   mpiret = sc_MPI_Comm_rank (comm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
@@ -1046,49 +1278,90 @@ t8_cmesh_trees_bcast (t8_cmesh_t cmesh_in, int root, sc_MPI_Comm comm)
 
   if (mpirank == root) {
     trees = cmesh_in->trees;
-    num_parts = trees->from_proc->elem_count;
+    header.num_parts = trees->from_proc->elem_count;
+    T8_ASSERT (header.num_parts > 0);
+    header.num_bytes = header.num_parts * sizeof (*part_info)
+      + cmesh_in->num_trees * sizeof (int);
+    for (ipart = 0; ipart < header.num_parts; ipart++) {
+      part = t8_cmesh_trees_get_part (trees, ipart);
+      T8_ASSERT (part->num_ghosts == 0);
+      header.num_bytes += t8_cmesh_trees_get_part_alloc (trees, part);
+    }
   }
-  /* Broadcast the number of parts */
-  mpiret = sc_MPI_Bcast (&num_parts, 1, sc_MPI_INT, root, comm);
+  /* Broadcast the size of the message */
+  mpiret = sc_MPI_Bcast (&header, sizeof (header), sc_MPI_BYTE, root, comm);
   SC_CHECK_MPI (mpiret);
+  info_offset = header.num_bytes - header.num_parts * sizeof (*part_info)
+    - cmesh_in->num_trees * sizeof (int);
 
-  if (mpirank != root) {
+  if (mpirank == root) {
+    /* Pack the message */
+    part = t8_cmesh_trees_get_part (trees, 0);
+    part_offset = t8_cmesh_trees_get_part_alloc (trees, part);
+    if (trees->shared_part_id == 0) {
+      /* Shared or mapped memory cannot be resized */
+      buffer = T8_ALLOC (char, header.num_bytes);
+      memcpy (buffer, part->first_tree, part_offset);
+    }
+    else {
+      buffer = part->first_tree =
+        T8_REALLOC (part->first_tree, char, header.num_bytes);
+    }
+    part_info = (t8_cmesh_trees_bcast_part_t *) (buffer + info_offset);
+    for (ipart = 0; ipart < header.num_parts; ipart++) {
+      part = t8_cmesh_trees_get_part (trees, ipart);
+      part_info[ipart].num_trees = part->num_trees;
+      part_info[ipart].first_tree_id = part->first_tree_id;
+      part_info[ipart].num_bytes = t8_cmesh_trees_get_part_alloc (trees, part);
+      if (ipart > 0) {
+        memcpy (buffer + part_offset, part->first_tree,
+                part_info[ipart].num_bytes);
+        part_offset += part_info[ipart].num_bytes;
+      }
+    }
+    T8_ASSERT (part_offset == info_offset);
+    memcpy (part_info + header.num_parts, trees->tree_to_proc,
+            cmesh_in->num_trees * sizeof (int));
+  }
+  else {
     /* Init trees structure */
-    t8_cmesh_trees_init (&cmesh_in->trees, num_parts, cmesh_in->num_trees, 0);
+    t8_cmesh_trees_init (&cmesh_in->trees, header.num_parts,
+                         cmesh_in->num_trees, 0);
     trees = cmesh_in->trees;
+    buffer = T8_ALLOC (char, header.num_bytes);
   }
 
-  for (ipart = 0; ipart < num_parts; ipart++) {
-    part = t8_cmesh_trees_get_part (trees, ipart);
-    if (mpirank == 0) {
-      /* Gather information about part */
-      part_info.num_trees = part->num_trees;
-      part_info.first_tree_id = part->first_tree_id;
-      part_info.num_bytes = t8_cmesh_trees_get_part_alloc (trees, part);
-      T8_ASSERT (part->num_ghosts == 0);
-    }
-    /* Bcast the meta information about part */
-    mpiret =
-      sc_MPI_Bcast (&part_info, sizeof (part_info), sc_MPI_BYTE, root, comm);
-    SC_CHECK_MPI (mpiret);
-
-    if (mpirank != root) {
-      part->first_tree_id = part_info.first_tree_id;
-      part->num_trees = part_info.num_trees;
-      /* Allocate memory for part's trees */
-      part->first_tree = T8_ALLOC (char, part_info.num_bytes);
+  t8_bcast_bytes (buffer, header.num_bytes, root, comm);
+
+  part_info = (t8_cmesh_trees_bcast_part_t *) (buffer + info_offset);
+  if (mpirank != root) {
+    /* Unpack the message */
+    memcpy (trees->tree_to_proc, part_info + header.num_parts,
+            cmesh_in->num_trees * sizeof (int));
+    part_offset = part_info[0].num_bytes;
+    for (ipart = 0; ipart < header.num_parts; ipart++) {
+      part = t8_cmesh_trees_get_part (trees, ipart);
+      part->first_tree_id = part_info[ipart].first_tree_id;
+      part->num_trees = part_info[ipart].num_trees;
       part->num_ghosts = 0;
       part->first_ghost_id = 0;
+      if (ipart > 0) {
+        part->first_tree = T8_ALLOC (char, part_info[ipart].num_bytes);
+        memcpy (part->first_tree, buffer + part_offset,
+                part_info[ipart].num_bytes);
+        part_offset += part_info[ipart].num_bytes;
+      }
     }
-    /* Bcast the part information */
-    mpiret =
-      sc_MPI_Bcast (part->first_tree, part_info.num_bytes, sc_MPI_BYTE, root,
-                    comm);
-    SC_CHECK_MPI (mpiret);
-  }                             /* end for */
-  /* Bcast the tree_to_proc array */
-  sc_MPI_Bcast (trees->tree_to_proc, cmesh_in->num_trees, sc_MPI_INT, root,
-                comm);
+  }
+  part = t8_cmesh_trees_get_part (trees, 0);
+  if (trees->shared_part_id == 0) {
+    T8_ASSERT (mpirank == root);
+    T8_FREE (buffer);
+  }
+  else {
+    /* Shrink the message to the data of part 0 */
+    part->first_tree = T8_REALLOC (buffer, char, part_info[0].num_bytes);
+  }
 }
 
 /* Check whether for each tree its neighbors are set consistently, that means that
@@ -1304,6 +1577,60 @@ t8_cmesh_trees_is_equal (t8_cmesh_t cmesh, t8_cmesh_trees_t trees_a,
   return 1;
 }
 
+uint64_t
+t8_cmesh_trees_hash (t8_cmesh_t cmesh, t8_cmesh_trees_t trees)
+{
+  t8_locidx_t         itree, ighost;
+  t8_ctree_t          tree;
+  t8_cghost_t         ghost;
+  t8_locidx_t        *face_neighbors;
+  t8_gloidx_t        *gface_neighbors;
+  int8_t             *ttf;
+  int                 num_faces;
+  size_t              attsize;
+  uint64_t            hash = 0;
+
+  T8_ASSERT (cmesh != NULL);
+  if (trees == NULL) {
+    return 0;
+  }
+  for (itree = 0; itree < cmesh->num_local_trees; itree++) {
+    tree = t8_cmesh_trees_get_tree_ext (trees, itree, &face_neighbors, &ttf);
+    num_faces = t8_eclass_num_faces[tree->eclass];
+    hash = t8_hash_combine (hash, tree->eclass);
+    hash = t8_hash_combine (hash, tree->num_attributes);
+    hash = t8_hash_combine (hash, tree->treeid);
+    hash = t8_hash_bytes (hash, face_neighbors,
+                          num_faces * sizeof (t8_locidx_t));
+    hash = t8_hash_bytes (hash, ttf, num_faces * sizeof (int8_t));
+    attsize = t8_cmesh_trees_attribute_size (tree);
+    if (attsize > 0) {
+      hash = t8_hash_bytes (hash, T8_TREE_ATTR (tree,
+                                                T8_TREE_ATTR_INFO (tree, 0)),
+                            attsize);
+    }
+  }
+  for (ighost = 0; ighost < cmesh->num_ghosts; ighost++) {
+    ghost = t8_cmesh_trees_get_ghost_ext (trees, ighost, &gface_neighbors,
+                                          &ttf);
+    num_faces = t8_eclass_num_faces[ghost->eclass];
+    hash = t8_hash_combine (hash, ghost->eclass);
+    hash = t8_hash_combine (hash, ghost->num_attributes);
+    hash = t8_hash_combine (hash, ghost->treeid);
+    hash = t8_hash_bytes (hash, gface_neighbors,
+                          num_faces * sizeof (t8_gloidx_t));
+    hash = t8_hash_bytes (hash, ttf, num_faces * sizeof (int8_t));
+    attsize = t8_cmesh_trees_ghost_attribute_size (ghost);
+    if (attsize > 0) {
+      hash = t8_hash_bytes (hash, T8_GHOST_ATTR (ghost,
+                                                 T8_GHOST_ATTR_INFO (ghost,
+                                                                     0)),
+                            attsize);
+    }
+  }
+  return hash;
+}
+
 void
 t8_cmesh_trees_destroy (t8_cmesh_trees_t * ptrees)
 {
@@ -1313,7 +1640,21 @@ t8_cmesh_trees_destroy (t8_cmesh_trees_t * ptrees)
 
   for (proc = 0; proc < trees->from_proc->elem_count; proc++) {
     part = t8_cmesh_trees_get_part (trees, proc);
-    T8_FREE (part->first_tree);
+    if (trees->shared_part != NULL && (int) proc == trees->shared_part_id) {
+      /* The data of this part lives in shared memory */
+      t8_shmem_array_destroy (&trees->shared_part);
+    }
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+    else if (trees->mapped_part != NULL
+             && (int) proc == trees->shared_part_id) {
+      /* The data of this part is mapped from a file */
+      munmap (trees->mapped_part, trees->mapped_length);
+      trees->mapped_part = NULL;
+    }
+#endif
+    else {
+      T8_FREE (part->first_tree);
+    }
   }
   T8_FREE (trees->ghost_to_proc);
   T8_FREE (trees->tree_to_proc);
@@ -229,6 +229,42 @@ void                t8_cmesh_trees_start_part (t8_cmesh_trees_t trees,
 void                t8_cmesh_trees_finish_part (t8_cmesh_trees_t trees,
                                                 int proc);
 
+/** Return the number of bytes of the data of a finished part, that is
+ * the size of the memory block starting at the part's first_tree entry.
+ * \param [in]            trees The trees structure.
+ * \param [in]            part  A finished part of \a trees.
+ * \return                The number of bytes of the part's trees, ghosts,
+ *                        face neighbors and attributes.
+ */
+size_t              t8_cmesh_trees_get_part_alloc (t8_cmesh_trees_t trees,
+                                                   t8_part_tree_t part);
+
+/** Move the data of a finished part into shared memory.
+ * Afterwards, the processes of \a comm that share a node also share one copy
+ * of the trees, ghosts, face neighbors and attributes of this part.
+ * The data must not be modified from then on.
+ * All processes of \a comm must have the same data in this part.
+ * This function is collective and so is \ref t8_cmesh_trees_destroy afterwards.
+ * \param [in,out]        trees The trees structure to be updated.
+ * \param [in]            proc  The number of the part to be shared.
+ * \param [in]            comm  The communicator over which the part is shared.
+ */
+void                t8_cmesh_trees_share_part (t8_cmesh_trees_t trees,
+                                               int proc, sc_MPI_Comm comm);
+
+/** Merge all parts of a trees structure into one part.
+ * After partitioning, the trees and ghosts are stored in one part per
+ * process from which they were received. This function copies them, their
+ * face neighbors and their attributes into one allocation, ordered by
+ * local id, such that trees and ghosts are accessed without looking up
+ * their part. The local ids of the trees and ghosts do not change.
+ * With OpenMP, the trees are copied in parallel.
+ * \param [in,out]        trees The trees structure to be compacted.
+ *                              Its parts must be finished and may not be
+ *                              stored in shared memory or a file mapping.
+ */
+void                t8_cmesh_trees_compact (t8_cmesh_trees_t trees);
+
 /** Copy the tree_to_proc and ghost_to_proc arrays of one tree structure to
  * another one.
  * \param [in,out]      trees_dest    The destination trees structure.
@@ -473,6 +509,26 @@ void                t8_cmesh_trees_add_attribute (t8_cmesh_trees_t trees,
                                                   * attr, t8_locidx_t tree_id,
                                                   size_t index);
 
+/** Set the attribute info of an attribute as in \ref t8_cmesh_trees_add_attribute
+ * but do not copy the attribute data.
+ * Since the offset of an attribute depends on the previous attributes, this
+ * function has to be called in order. The data can then be copied
+ * independently, for example by several threads.
+ * \param [in,out]  trees The trees structure to be updated.
+ * \param [in]      proc  The part of the tree.
+ * \param [in]      attr  The attribute to be added.
+ * \param [in]      tree_id The local id of the tree.
+ * \param [in]      index The index of the attribute in the tree's attribute array.
+ * \return          The memory to which the attr->attr_size bytes of the
+ *                  attribute data have to be copied.
+ */
+char               *t8_cmesh_trees_add_attribute_info (t8_cmesh_trees_t
+                                                       trees, int proc,
+                                                       t8_stash_attribute_struct_t
+                                                       * attr,
+                                                       t8_locidx_t tree_id,
+                                                       size_t index);
+
 /** Return the number of parts of a trees structure.
  * \param [in]        trees The trees structure.
  * \return            The number of parts in \a trees.
@@ -546,6 +602,16 @@ int                 t8_cmesh_trees_is_equal (t8_cmesh_t cmesh,
                                              t8_cmesh_trees_t trees_a,
                                              t8_cmesh_trees_t trees_b);
 
+/** Compute a hash of the trees and ghosts of a trees structure.
+ * It covers the same data as \ref t8_cmesh_trees_is_equal, such that
+ * trees structures that are equal have the same hash.
+ * \param [in]      cmesh The cmesh of the trees structure.
+ * \param [in]      trees The trees structure.
+ * \return          The hash of the trees, 0 if \a trees is NULL.
+ */
+uint64_t            t8_cmesh_trees_hash (t8_cmesh_t cmesh,
+                                         t8_cmesh_trees_t trees);
+
 /** Free all memory allocated with a trees structure.
  *  This means that all coarse trees and ghosts, their face neighbor entries
  *  and attributes and the additional structures of trees are freed.
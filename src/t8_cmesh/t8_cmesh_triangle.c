@@ -25,6 +25,7 @@
 #include <t8_cmesh_vtk.h>
 #include "t8_cmesh_types.h"
 #include "t8_cmesh_stash.h"
+#include "t8_cmesh_pfile.h"
 
 /* TODO: if partitioned then only add the needed face-connections to join faces
  *       maybe also only trees and ghosts to classes.
@@ -460,6 +461,191 @@ die_neigh:
   return -1;
 }
 
+/* Find the offset of the first line that is neither a comment nor empty
+ * in the lines of a process, LLONG_MAX if there is none. */
+static long long
+t8_cmesh_triangle_first_line (const char *lines, long long lines_offset)
+{
+  const char         *line, *next;
+
+  for (line = lines; *line != '\0'; line = next) {
+    next = strchr (line, '\n');
+    next = next == NULL ? line + strlen (line) : next + 1;
+    if (line[0] != '#'
+        && strspn (line, " \t\r\v\n") < (size_t) (next - line)) {
+      return lines_offset + (line - lines);
+    }
+  }
+  return LLONG_MAX;
+}
+
+/* Parse the lines of a .node or .ele file that a process read.
+ * The first line of the file, at offset \a header_offset, holds the number
+ * of entries, which is added to counts[0]. If \a nodes is not NULL, the
+ * lines are nodes and are stored in \a nodes, otherwise they are elements
+ * and are stored in \a elements. The number of parsed entries is added to
+ * counts[1].
+ * Returns true on success. */
+static int
+t8_cmesh_triangle_parse_lines (char *lines, long long lines_offset,
+                               long long header_offset, int dim,
+                               sc_array_t * nodes, sc_array_t * elements,
+                               long long *counts)
+{
+  t8_pfile_node_t    *node;
+  t8_pfile_element_t *element;
+  char               *line, *end, *next;
+  long long           offset;
+  long                number;
+  int                 retval;
+
+  for (line = lines; *line != '\0'; line = next) {
+    offset = lines_offset + (line - lines);
+    end = strchr (line, '\n');
+    if (end == NULL) {
+      /* The last line of the file has no newline */
+      next = line + strlen (line);
+    }
+    else {
+      *end = '\0';
+      next = end + 1;
+    }
+    if (line[0] == '#' || strspn (line, " \t\r\v") == strlen (line)
+        || offset < header_offset) {
+      /* Skip comments and empty lines */
+      continue;
+    }
+    if (offset == header_offset) {
+      /* The number of nodes or elements */
+      if (sscanf (line, "%li", &number) != 1) {
+        t8_errorf ("Premature end of line.\n");
+        return 0;
+      }
+      counts[0] += number;
+      continue;
+    }
+    if (nodes != NULL) {
+      node = (t8_pfile_node_t *) sc_array_push (nodes);
+      node->coordinates[2] = 0;
+      /* In 2d the coordinates may be followed by attributes */
+      retval = sscanf (line, dim == 2 ? "%li %lf %lf" : "%li %lf %lf %lf",
+                       &node->index, &node->coordinates[0],
+                       &node->coordinates[1], &node->coordinates[2]);
+    }
+    else {
+      element = (t8_pfile_element_t *) sc_array_push (elements);
+      element->eclass = dim == 2 ? T8_ECLASS_TRIANGLE : T8_ECLASS_TET;
+      retval = sscanf (line, "%li %li %li %li %li", &number,
+                       element->node_indices, element->node_indices + 1,
+                       element->node_indices + 2, element->node_indices + 3);
+    }
+    if (retval < dim + 1 + (elements != NULL)) {
+      t8_errorf ("Premature end of line %s\n", line);
+      return 0;
+    }
+    counts[1]++;
+  }
+  return 1;
+}
+
+/* Read the nodes or elements of a .node or .ele file in parallel.
+ * Each process parses the lines in its byte range of the file.
+ * If \a nodes is not NULL the file is a .node file and the nodes are
+ * stored in \a nodes, otherwise the elements are stored in \a elements.
+ * Returns true on all processes on success. */
+static int
+t8_cmesh_triangle_read_parallel (const char *filename, int dim,
+                                 sc_array_t * nodes, sc_array_t * elements,
+                                 sc_MPI_Comm comm)
+{
+  t8_pfile_handle_t   fh;
+  sc_array_t          lines;
+  long long           file_size = 0, lines_offset;
+  long long           local_offset, header_offset;
+  long long           local_counts[2] = { 0, 0 }, counts[2];
+  int                 mpirank, mpisize, mpiret;
+  int                 local_success, success;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (!t8_pfile_open (filename, comm, &fh)) {
+    t8_global_errorf ("Failed to open %s.\n", filename);
+    return 0;
+  }
+  if (mpirank == 0) {
+    file_size = t8_pfile_size (fh);
+  }
+  mpiret = sc_MPI_Bcast (&file_size, 1, sc_MPI_LONG_LONG_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Read the lines of this process and find the first line of the file */
+  sc_array_init (&lines, sizeof (char));
+  local_success = file_size > 0
+    && t8_pfile_read_lines (fh, file_size, mpirank, mpisize, &lines,
+                            &lines_offset);
+  t8_pfile_close (&fh);
+  local_offset = local_success ?
+    t8_cmesh_triangle_first_line (lines.array, lines_offset) : LLONG_MAX;
+  mpiret = sc_MPI_Allreduce (&local_offset, &header_offset, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MIN, comm);
+  SC_CHECK_MPI (mpiret);
+  if (local_success && header_offset == LLONG_MAX) {
+    t8_global_errorf ("Failed to read first line from %s.\n", filename);
+    local_success = 0;
+  }
+
+  /* Parse the nodes or elements */
+  local_success = local_success
+    && t8_cmesh_triangle_parse_lines (lines.array, lines_offset,
+                                      header_offset, dim, nodes, elements,
+                                      local_counts);
+  sc_array_reset (&lines);
+  mpiret = sc_MPI_Allreduce (local_counts, counts, 2, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  if (local_success && counts[0] != counts[1]) {
+    t8_global_errorf ("The number of entries in %s does not match the"
+                      " number given in its first line.\n", filename);
+    local_success = 0;
+  }
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  return success;
+}
+
+/* Read the .node and .ele files in parallel and build a partitioned cmesh.
+ * The face connections are computed from the vertices of the trees, thus
+ * the .neigh file is not read. */
+static              t8_cmesh_t
+t8_cmesh_from_tetgen_or_triangle_file_parallel (char *fileprefix,
+                                                sc_MPI_Comm comm, int dim)
+{
+  sc_array_t          nodes, elements;
+  char                current_file[BUFSIZ];
+  int                 success;
+
+  sc_array_init (&nodes, sizeof (t8_pfile_node_t));
+  sc_array_init (&elements, sizeof (t8_pfile_element_t));
+  snprintf (current_file, BUFSIZ, "%s.node", fileprefix);
+  success = t8_cmesh_triangle_read_parallel (current_file, dim, &nodes,
+                                             NULL, comm);
+  if (success) {
+    snprintf (current_file, BUFSIZ, "%s.ele", fileprefix);
+    success = t8_cmesh_triangle_read_parallel (current_file, dim, NULL,
+                                               &elements, comm);
+  }
+  if (!success) {
+    t8_global_errorf ("Error while parsing file %s.\n", current_file);
+    sc_array_reset (&nodes);
+    sc_array_reset (&elements);
+    return NULL;
+  }
+  return t8_pfile_build_cmesh (comm, &nodes, &elements, dim);
+}
+
 /* TODO: remove do_dup argument */
 static              t8_cmesh_t
 t8_cmesh_from_tetgen_or_triangle_file (char *fileprefix, int partition,
@@ -469,7 +655,11 @@ t8_cmesh_from_tetgen_or_triangle_file (char *fileprefix, int partition,
   t8_cmesh_t          cmesh;
   double             *vertices;
   long                num_vertices;
-  t8_gloidx_t         first_tree, last_tree;
+
+  if (partition) {
+    return t8_cmesh_from_tetgen_or_triangle_file_parallel (fileprefix, comm,
+                                                           dim);
+  }
 
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
@@ -535,17 +725,10 @@ t8_cmesh_from_tetgen_or_triangle_file (char *fileprefix, int partition,
 #endif
 
   if (cmesh != NULL) {
-    if (partition) {
-      first_tree = (mpirank * cmesh->num_trees) / mpisize;
-      last_tree = ((mpirank + 1) * cmesh->num_trees) / mpisize - 1;
-      t8_debugf ("Partition range [%lli,%lli]\n", (long long) first_tree,
-                 (long long) last_tree);
-      t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree);
-    }
     t8_cmesh_commit (cmesh, comm);
   }
 #ifdef T8_WITH_METIS
-  if (cmesh != NULL && !partition) {
+  if (cmesh != NULL) {
     t8_cmesh_reorder (cmesh, comm);
     t8_debugf ("Reordered mesh with METIS.\n");
   }
@@ -566,7 +749,16 @@ t8_cmesh_from_tetgen_or_triangle_file_time (char *fileprefix,
   t8_cmesh_t          cmesh;
   double             *vertices;
   long                num_vertices;
-  t8_gloidx_t         first_tree, last_tree;
+
+  if (partition) {
+    sc_flops_snap (fi, snapshot);
+    cmesh = t8_cmesh_from_tetgen_or_triangle_file_parallel (fileprefix,
+                                                            comm, dim);
+    sc_flops_shot (fi, snapshot);
+    sc_stats_set1 (&stats[statindex], snapshot->iwtime,
+                   "Parallel read and commit");
+    return cmesh;
+  }
 
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
@@ -574,7 +766,7 @@ t8_cmesh_from_tetgen_or_triangle_file_time (char *fileprefix,
   SC_CHECK_MPI (mpiret);
 
   cmesh = NULL;
-  if (mpirank == 0 || partition) {
+  if (mpirank == 0) {
     int                 retval, corner_offset;
     char                current_file[BUFSIZ];
 
@@ -620,18 +812,9 @@ t8_cmesh_from_tetgen_or_triangle_file_time (char *fileprefix,
    *       other processes if something went wrong. */
   /* This broadcasts the NULL pointer if anything went wrong */
 
-  if (!partition) {
-    cmesh = t8_cmesh_bcast (cmesh, 0, comm);
-  }
+  cmesh = t8_cmesh_bcast (cmesh, 0, comm);
 
   if (cmesh != NULL) {
-    if (partition) {
-      first_tree = (mpirank * cmesh->num_trees) / mpisize;
-      last_tree = ((mpirank + 1) * cmesh->num_trees) / mpisize - 1;
-      t8_debugf ("Partition range [%lli,%lli]\n", (long long) first_tree,
-                 (long long) last_tree);
-      t8_cmesh_set_partition_range (cmesh, 3, first_tree, last_tree);
-    }
     sc_flops_snap (fi, snapshot);
     t8_cmesh_commit (cmesh, comm);
     sc_stats_set1 (&stats[statindex], snapshot->iwtime, "Partitioned Commit");
@@ -58,6 +58,54 @@ typedef enum t8_cmesh_from
 t8_cmesh_from_t;
 #endif
 
+/** The arrays of a replicated cmesh that is constructed without the stash.
+ * \see t8_cmesh_set_tree_arrays */
+typedef struct t8_cmesh_tree_arrays
+{
+  t8_locidx_t         num_trees; /**< The number of trees. */
+  const t8_eclass_t  *tree_classes; /**< The class of each tree. */
+  const t8_locidx_t  *face_neighbors; /**< For each face of each tree its neighbor tree, negative at the boundary. */
+  const int8_t       *tree_to_face; /**< For each face of each tree the encoded face number and orientation at the neighbor. */
+  const double       *vertices; /**< The vertex coordinates of each tree. */
+} t8_cmesh_tree_arrays_t;
+
+/** The connectivity arrays of a cmesh with trees of a single class that is
+ * constructed without the stash. The arrays contain all trees of the cmesh,
+ * but each process only reads the entries of its local trees and ghosts.
+ * \see t8_cmesh_set_connectivity_arrays */
+typedef struct t8_cmesh_connectivity_arrays
+{
+  t8_eclass_t         eclass; /**< The class of all trees. */
+  t8_gloidx_t         num_trees; /**< The global number of trees. */
+  const t8_locidx_t  *tree_to_tree; /**< For each face of each tree its global neighbor tree. */
+  const int8_t       *tree_to_face; /**< For each face of each tree the encoded face number and orientation at the neighbor. */
+  const t8_locidx_t  *tree_to_vertex; /**< For each vertex of each tree its index in \a vertices. */
+  const double       *vertices; /**< The coordinates of the vertices. */
+} t8_cmesh_connectivity_arrays_t;
+
+/** A table of vertex coordinates that are shared by the trees of a cmesh.
+ * The trees reference the vertices by their index in the table.
+ * \see t8_cmesh_set_vertex_table */
+typedef struct t8_cmesh_vertex_table
+{
+  t8_gloidx_t         num_vertices; /**< The number of vertices. */
+  int                 single_precision; /**< If true, the coordinates are stored as float, otherwise as double. */
+  void               *coordinates; /**< The 3 * \a num_vertices coordinates. */
+} t8_cmesh_vertex_table_t;
+
+/** The face connection of one face of a local tree or ghost in the face
+ * table of a committed cmesh. All entries are local, such that a face
+ * neighbor lookup needs a single memory access.
+ * \see t8_cmesh_set_face_table */
+typedef struct t8_cmesh_face_entry
+{
+  t8_locidx_t         neighbor; /**< The local id of the neighbor tree or ghost.
+                                     -1 at a domain boundary and -2 if the neighbor
+                                     of a ghost is neither a local tree nor a ghost. */
+  int8_t              ttf; /**< The encoded face number and orientation at the neighbor. */
+  int8_t              eclass; /**< The eclass of the neighbor if \a neighbor >= 0, otherwise T8_ECLASS_COUNT. */
+} t8_cmesh_face_entry_t;
+
 /** This structure holds the connectivity data of the coarse mesh.
  *  It can either be replicated, then each process stores a copy of the whole
  *  mesh, or partitioned. In the latter case, each process only stores a local
@@ -87,6 +135,13 @@ typedef struct t8_cmesh
 
   int                 set_partition; /**< If nonzero the cmesh is partitioned.
                                             If zero each process has the whole cmesh. */
+  int                 set_reorder; /**< If nonzero the trees are renumbered along a space-filling
+                                          curve at commit. \ref t8_cmesh_set_reorder */
+  int                 set_shared_memory; /**< If nonzero and the cmesh is replicated, the trees are
+                                              stored once per node in shared memory.
+                                              \ref t8_cmesh_set_shared_memory */
+  int                 set_face_table; /**< If nonzero, \a face_table is built at commit.
+                                           \ref t8_cmesh_set_face_table */
   int                 face_knowledge;  /**< If partitioned the level of face knowledge that is expected. \ref t8_mesh_set_partioned;
                             see \ref t8_cmesh_set_partition.
 */
@@ -141,7 +196,23 @@ typedef struct t8_cmesh
                                            check at commit if it equals the total number. */
 #endif
   t8_stash_t          stash; /**< Used as temporary storage for the trees before commit. */
+  t8_cmesh_tree_arrays_t *set_tree_arrays; /**< If not NULL, the trees are constructed from these arrays
+                                                instead of the stash. \ref t8_cmesh_set_tree_arrays */
+  t8_cmesh_connectivity_arrays_t *set_connectivity_arrays; /**< If not NULL, the trees are constructed from
+                                                                these arrays instead of the stash.
+                                                                \ref t8_cmesh_set_connectivity_arrays */
+  t8_cmesh_vertex_table_t *set_vertex_table; /**< If not NULL, the vertices that are referenced by
+                                                  \ref t8_cmesh_set_tree_vertex_indices. */
   t8_cprofile_t      *profile; /**< Used to measure runtimes and statistics of the cmesh algorithms. */
+  sc_hash_t          *file_attributes; /**< If not NULL, the attributes that were read from
+                                            attribute files. \ref t8_cmesh_set_tree_attribute_file */
+  sc_mempool_t       *file_attributes_mempool; /**< The memory pool for the entries of \a file_attributes. */
+  t8_cmesh_face_entry_t *face_table; /**< If not NULL, for each face of each local tree and ghost its
+                                          connection. The entry of face f of the local tree or ghost
+                                          with local id l is at l * max_num_faces[dimension] + f. */
+  uint64_t            hash; /**< The hash of the local trees and ghosts if \a hash_valid.
+                                 \ref t8_cmesh_get_hash */
+  int                 hash_valid; /**< True if \a hash was computed. */
 }
 t8_cmesh_struct_t;
 
@@ -235,6 +306,13 @@ typedef struct t8_cmesh_trees
                                                            global_id -> local_id for the ghost trees.
                                                            The local_id is the local ghost id starting at num_local_trees  */
   sc_mempool_t       *global_local_mempool;     /* Memory pool for the entries in the hash table */
+  t8_shmem_array_t    shared_part;      /* If not NULL, the shared memory that stores the
+                                           data of part shared_part_id. This data is read-only. */
+  void               *mapped_part;      /* If not NULL, the start of the file mapping that
+                                           stores the data of part shared_part_id.
+                                           \see t8_cmesh_load_raw */
+  size_t              mapped_length;    /* The length of the file mapping in bytes */
+  int                 shared_part_id;   /* The part that is stored in shared_part or mapped_part */
 }
 t8_cmesh_trees_struct_t;
 
@@ -37,6 +37,11 @@
  */
 #define T8_CMESH_SUPPORTED_FILE_VERSION 2
 
+/* The supported binary .msh file version.
+ * We support gmsh's file version 4.1 in binary format.
+ */
+#define T8_CMESH_SUPPORTED_BINARY_FILE_VERSION 4
+
 /* put typedefs here */
 
 T8_EXTERN_C_BEGIN ();
@@ -58,11 +63,35 @@ T8_EXTERN_C_BEGIN ();
  *                              read the file and store all the trees alone.
  * \return        A committed cmesh holding the mesh of dimension \a dim in the
  *                specified .msh file.
+ * \note Supported are ASCII files of version 2 and binary files of
+ *       version 4.1. Binary files are read block wise with bulk reads.
  */
 t8_cmesh_t
 t8_cmesh_from_msh_file (const char *fileprefix, int partition,
                         sc_MPI_Comm comm, int dim, int master);
 
+/** Read a .msh file in parallel and create a partitioned cmesh from it.
+ * Each process reads an equally sized byte range of the file, with MPI I/O
+ * if t8code is configured with it. The nodes are distributed to the
+ * processes by their index and each process requests the coordinates of
+ * the nodes of its trees. The face connections are found by sending each
+ * face to a process given by its vertices. Thus no process needs to store
+ * the whole mesh.
+ * \param [in]    fileprefix    The prefix of the mesh file.
+ *                              The file fileprefix.msh is read.
+ * \param [in]    comm          The MPI communicator with which the cmesh is to be committed.
+ * \param [in]    dim           The dimension to read from the .msh files.
+ * \return        A committed partitioned cmesh holding the mesh of dimension
+ *                \a dim in the specified .msh file, or NULL on failure.
+ *                The trees of a process are the elements of dimension
+ *                \a dim in its byte range, numbered in the order of the file.
+ * \note The line holding the number of nodes (elements) must directly
+ *       follow the line $Nodes ($Elements).
+ */
+t8_cmesh_t          t8_cmesh_from_msh_file_parallel (const char *fileprefix,
+                                                     sc_MPI_Comm comm,
+                                                     int dim);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_CMESH_READMSHFILE_H */
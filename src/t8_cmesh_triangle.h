@@ -39,18 +39,23 @@ T8_EXTERN_C_BEGIN ();
 /* put declarations here */
 
 /** Open a .node, .ele and .neigh file created by TRIANGLE to read
- * and create a cmesh from them. The cmesh will be replicated.
- * The files are opened and read by one process and the cmesh is then
- * broadcasted to the other processes.
+ * and create a cmesh from them.
+ * If the cmesh is replicated, the files are opened and read by one process
+ * and the cmesh is then broadcasted to the other processes.
  * \param [in] fileprefix A string holding the prefix of the TRIANGLE files.
  *                        The files \a fileprefix.node, \a fileprefix.ele and
  *                        \a fileprefix.neigh are read.
- * \param [in] partition  In the future this flag can decide whether the returned
- *                        cmesh is partitioned or not. Currently it is always replicated.
+ * \param [in] partition  If true, the files are read in parallel and the
+ *                        returned cmesh is partitioned. Each process reads an
+ *                        equally sized byte range of the .node and .ele files
+ *                        and its trees are the elements in its byte range.
+ *                        The face connections are computed from the vertices
+ *                        of the trees and the .neigh file is not read.
  * \param [in] comm       The mpi communicator to be used.
  * \param [in] do_dup     Whether \a comm should be duplicated by cmesh.
- * \return                A ommited, replicated cmesh constructed from the info
- *                        in the TRIANGLE files.
+ * \return                A commited cmesh constructed from the info
+ *                        in the TRIANGLE files, replicated if \a partition
+ *                        is false.
  */
 t8_cmesh_t
 t8_cmesh_from_triangle_file (char *fileprefix, int partition,
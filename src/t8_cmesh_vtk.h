@@ -39,6 +39,27 @@ int                 t8_cmesh_vtk_write_file (t8_cmesh_t cmesh,
                                              const char *fileprefix,
                                              double scale);
 
+/** Read a cmesh from a .vtu file of an unstructured grid in parallel.
+ * Process 0 parses the xml header of the file. Then each process reads
+ * an equally sized range of the points and cells, such that the arrays
+ * are read in bulk and only once. The face connections are found by
+ * matching the faces of the trees via their vertex indices.
+ * Supported are ascii data arrays and appended raw data, which may be
+ * zlib compressed, as well as files with several pieces like the ones
+ * written by \ref t8_forest_vtk_write_file_mpiio.
+ * Cells whose dimension is not \a dim are ignored.
+ * \param [in] filename  The name of the .vtu file.
+ * \param [in] comm      The communicator of the cmesh.
+ * \param [in] dim       The dimension of the cmesh.
+ * \return               A committed partitioned cmesh or NULL on failure.
+ *                       This function is collective.
+ * \note Faces are only connected if the trees share the points of the
+ *       face. Files in which each cell has its own points yield a cmesh
+ *       without face connections.
+ */
+t8_cmesh_t          t8_cmesh_from_vtu_file (const char *filename,
+                                            sc_MPI_Comm comm, int dim);
+
 /* TODO: Should this function be part of the interface?
  * Not for now: Move to _vtk.h but mark as DEPRECATED */
 /** Set the vertices of a tree in the cmesh.
@@ -54,7 +75,7 @@ int                 t8_cmesh_vtk_write_file (t8_cmesh_t cmesh,
  *                              match the number of corners of the tree.
  */
 void                t8_cmesh_set_tree_vertices (t8_cmesh_t cmesh,
-                                                t8_locidx_t ltree_id,
+                                                t8_gloidx_t tree_id,
                                                 int package_id, int key,
                                                 double *vertices,
                                                 int num_vertices);
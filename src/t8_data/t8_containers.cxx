@@ -27,6 +27,14 @@
 #include <t8_element_cxx.hxx>
 #include <sc_containers.h>
 #include <t8_data/t8_containers.h>
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+#include <sys/mman.h>
+#endif
+
+/* Reserved element arrays of at least this many bytes are advised to be
+ * backed by transparent huge pages. This is the size of one huge page on
+ * most systems. */
+#define T8_ELEMENT_ARRAY_HUGE_PAGE_SIZE 2097152
 
 T8_EXTERN_C_BEGIN ();
 
@@ -199,6 +207,49 @@ t8_element_array_resize (t8_element_array_t * element_array, size_t new_count)
   }
 }
 
+void
+t8_element_array_reserve (t8_element_array_t * element_array,
+                          size_t capacity)
+{
+  sc_array_t         *array;
+  size_t              count;
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  array = &element_array->array;
+  T8_ASSERT (SC_ARRAY_IS_OWNER (array));
+  if (capacity == 0
+      || capacity * array->elem_size <= (size_t) array->byte_alloc) {
+    /* There is enough memory allocated */
+    return;
+  }
+  /* Growing the array allocates the memory with a single realloc.
+   * Setting the count back keeps the memory and does not touch the
+   * elements, thus it is legal without calling t8_element_init. */
+  count = array->elem_count;
+  sc_array_resize (array, capacity);
+  array->elem_count = count;
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP) \
+  && defined(MADV_HUGEPAGE)
+  if ((size_t) array->byte_alloc >= 2 * T8_ELEMENT_ARRAY_HUGE_PAGE_SIZE) {
+    /* Scans over large element arrays cause fewer TLB misses with huge
+     * pages. We can only advise the huge pages that lie completely
+     * within the array. Failure is harmless, the advice is ignored then. */
+    const uintptr_t     begin = (uintptr_t) array->array;
+    const uintptr_t     end = begin + (size_t) array->byte_alloc;
+    const uintptr_t     page_begin =
+      (begin + T8_ELEMENT_ARRAY_HUGE_PAGE_SIZE - 1)
+      & ~(uintptr_t) (T8_ELEMENT_ARRAY_HUGE_PAGE_SIZE - 1);
+    const uintptr_t     page_end =
+      end & ~(uintptr_t) (T8_ELEMENT_ARRAY_HUGE_PAGE_SIZE - 1);
+
+    if (page_begin < page_end) {
+      (void) madvise ((void *) page_begin, page_end - page_begin,
+                      MADV_HUGEPAGE);
+    }
+  }
+#endif
+}
+
 void
 t8_element_array_copy (t8_element_array_t * dest, t8_element_array_t * src)
 {
@@ -305,4 +356,341 @@ t8_element_array_truncate (t8_element_array_t * element_array)
   sc_array_truncate (&element_array->array);
 }
 
+void
+t8_element_array_soa_init (t8_element_array_soa_t * soa,
+                           t8_element_array_t * element_array, int level)
+{
+  t8_eclass_scheme_c *scheme;
+  t8_element_t       *first_element;
+
+  T8_ASSERT (soa != NULL);
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+
+  scheme = element_array->scheme;
+  soa->count = t8_element_array_get_count (element_array);
+  soa->level = level;
+  soa->levels = NULL;
+  soa->ids = NULL;
+  if (soa->count == 0) {
+    return;
+  }
+  T8_ASSERT (soa->count <= (size_t) T8_LOCIDX_MAX);
+  soa->levels = T8_ALLOC (int, soa->count);
+  soa->ids = T8_ALLOC (t8_linearidx_t, soa->count);
+  /* Since the elements are stored contiguously, we compute the levels
+   * and ids with one call to the scheme each. */
+  first_element = t8_element_array_index_locidx (element_array, 0);
+  scheme->t8_element_batch_level (first_element, (int) soa->count,
+                                  soa->levels);
+  scheme->t8_element_batch_get_linear_id (first_element, (int) soa->count,
+                                          level, soa->ids);
+}
+
+void
+t8_element_array_soa_reset (t8_element_array_soa_t * soa)
+{
+  T8_ASSERT (soa != NULL);
+  T8_FREE (soa->levels);
+  T8_FREE (soa->ids);
+  soa->levels = NULL;
+  soa->ids = NULL;
+  soa->count = 0;
+}
+
+int
+t8_element_array_soa_get_level (const t8_element_array_soa_t * soa,
+                                t8_locidx_t index)
+{
+  T8_ASSERT (soa != NULL);
+  T8_ASSERT (0 <= index && (size_t) index < soa->count);
+  return soa->levels[index];
+}
+
+t8_linearidx_t
+t8_element_array_soa_get_id (const t8_element_array_soa_t * soa,
+                             t8_locidx_t index)
+{
+  T8_ASSERT (soa != NULL);
+  T8_ASSERT (0 <= index && (size_t) index < soa->count);
+  return soa->ids[index];
+}
+
+int
+t8_element_array_soa_compare (const t8_element_array_soa_t * soa,
+                              t8_locidx_t index_a, t8_locidx_t index_b)
+{
+  T8_ASSERT (soa != NULL);
+  T8_ASSERT (0 <= index_a && (size_t) index_a < soa->count);
+  T8_ASSERT (0 <= index_b && (size_t) index_b < soa->count);
+
+  /* The linear id at the finest level is the id of the first descendant.
+   * If two elements have the same first descendant, the one with the
+   * smaller level is the ancestor and thus the smaller element. */
+  if (soa->ids[index_a] != soa->ids[index_b]) {
+    return soa->ids[index_a] < soa->ids[index_b] ? -1 : 1;
+  }
+  return soa->levels[index_a] - soa->levels[index_b];
+}
+
+t8_locidx_t
+t8_element_array_soa_search_lower (const t8_element_array_soa_t * soa,
+                                   t8_linearidx_t id)
+{
+  t8_locidx_t         low, high, guess;
+
+  T8_ASSERT (soa != NULL);
+  if (soa->count == 0 || soa->ids[0] > id) {
+    /* No element has id smaller than the given one */
+    return -1;
+  }
+  /* Binary search for the last id that is smaller or equal to the
+   * given one. */
+  low = 0;
+  high = (t8_locidx_t) soa->count - 1;
+  while (low < high) {
+    guess = (low + high + 1) / 2;
+    if (soa->ids[guess] == id) {
+      return guess;
+    }
+    else if (soa->ids[guess] > id) {
+      /* look further left */
+      high = guess - 1;
+    }
+    else {
+      /* look further right, but keep guess in the search range */
+      low = guess;
+    }
+  }
+  T8_ASSERT (low == high);
+  return low;
+}
+
+/* The number of elements whose levels are buffered at once while packing */
+#define T8_ELEMENT_ARRAY_PACK_BATCH 256
+
+/* The number of bits that store the level of a packed pyramid */
+#define T8_ELEMENT_ARRAY_PACK_LEVEL_BITS 5
+
+/* Return the number of bits per level in the linear id of an element class.
+ * For all default classes this is the dimension. */
+static int
+t8_element_array_pack_bits (t8_eclass_scheme_c * scheme, int maxlevel)
+{
+  int                 bits;
+
+  bits = t8_eclass_to_dimension[scheme->eclass];
+  /* The id at maxlevel and one additional bit must fit into 64 bits */
+  SC_CHECK_ABORT (bits * maxlevel < 64,
+                  "Level too large for compressed element storage.");
+  return bits;
+}
+
+/* Pyramids refine into 10 children and tetrahedra into 8, thus the linear
+ * id of a pyramid tree element at maxlevel is not its id at its own level
+ * shifted by 3 * (maxlevel - level). Instead we store the id at the own
+ * level of the element and the level in the lowest bits. */
+static void
+t8_element_array_pack_pyramid (t8_element_array_t * element_array,
+                               size_t first, size_t count, int maxlevel,
+                               t8_linearidx_t * packed)
+{
+  t8_eclass_scheme_c *scheme = element_array->scheme;
+  t8_element_t       *element;
+  size_t              ielem;
+  int                 level;
+
+  for (ielem = 0; ielem < count; ielem++) {
+    element = t8_element_array_index_locidx (element_array, first + ielem);
+    level = scheme->t8_element_level (element);
+    T8_ASSERT (level <= maxlevel);
+    /* An id of a pyramid of level l is smaller than 2 * 8^l */
+    SC_CHECK_ABORT (3 * level + 1 + T8_ELEMENT_ARRAY_PACK_LEVEL_BITS <= 64,
+                    "Level too large for compressed element storage.");
+    packed[ielem] = (scheme->t8_element_get_linear_id (element, level)
+                     << T8_ELEMENT_ARRAY_PACK_LEVEL_BITS) | level;
+  }
+}
+
+/* Pack the elements first, ..., first + count - 1 of an element array,
+ * see t8_element_array_pack. */
+static void
+t8_element_array_pack_range (t8_element_array_t * element_array,
+                             size_t first, size_t count, int maxlevel,
+                             t8_linearidx_t * packed)
+{
+  t8_eclass_scheme_c *scheme;
+  t8_element_t       *elements;
+  size_t              offset, ielem;
+  int                 bits, num, levels[T8_ELEMENT_ARRAY_PACK_BATCH];
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  T8_ASSERT (first + count <= t8_element_array_get_count (element_array));
+  T8_ASSERT (packed != NULL || count == 0);
+
+  scheme = element_array->scheme;
+  if (scheme->eclass == T8_ECLASS_PYRAMID) {
+    t8_element_array_pack_pyramid (element_array, first, count, maxlevel,
+                                   packed);
+    return;
+  }
+  bits = t8_element_array_pack_bits (scheme, maxlevel);
+  for (offset = 0; offset < count; offset += num) {
+    num = (int) SC_MIN (count - offset, T8_ELEMENT_ARRAY_PACK_BATCH);
+    elements = t8_element_array_index_locidx (element_array, first + offset);
+    scheme->t8_element_batch_level (elements, num, levels);
+    scheme->t8_element_batch_get_linear_id (elements, num, maxlevel,
+                                            packed + offset);
+    for (ielem = 0; ielem < (size_t) num; ielem++) {
+      T8_ASSERT (levels[ielem] <= maxlevel);
+      if (bits == 0) {
+        /* All elements have linear id 0, we only store the level */
+        packed[offset + ielem] = levels[ielem];
+      }
+      else {
+        /* Mark the position of the last significant bit of the level */
+        packed[offset + ielem] = (packed[offset + ielem] << 1)
+          | ((t8_linearidx_t) 1 << (bits * (maxlevel - levels[ielem])));
+      }
+    }
+  }
+}
+
+void
+t8_element_array_pack (t8_element_array_t * element_array, int maxlevel,
+                       t8_linearidx_t * packed)
+{
+  t8_element_array_pack_range (element_array, 0,
+                               t8_element_array_get_count (element_array),
+                               maxlevel, packed);
+}
+
+/* Return the bits per level used to pack the elements of a scheme, or -1
+ * for pyramids, which are packed differently, see t8_element_array_pack. */
+static int
+t8_element_array_unpack_bits (t8_eclass_scheme_c * scheme, int maxlevel)
+{
+  return scheme->eclass == T8_ECLASS_PYRAMID ? -1 :
+    t8_element_array_pack_bits (scheme, maxlevel);
+}
+
+/* Restore one element from its packed form, bits as returned by
+ * t8_element_array_unpack_bits. */
+static void
+t8_element_array_unpack_element (t8_eclass_scheme_c * scheme, int bits,
+                                 int maxlevel, t8_linearidx_t packed,
+                                 t8_element_t * element)
+{
+  t8_linearidx_t      id;
+  int                 shift, level;
+
+  if (bits < 0) {
+    level = (int) (packed & ((1 << T8_ELEMENT_ARRAY_PACK_LEVEL_BITS) - 1));
+    id = packed >> T8_ELEMENT_ARRAY_PACK_LEVEL_BITS;
+  }
+  else if (bits == 0) {
+    level = (int) packed;
+    id = 0;
+  }
+  else {
+    T8_ASSERT (packed != 0);
+    /* The lowest set bit encodes the level */
+    for (shift = 0; ((packed >> shift) & 1) == 0; shift++) {
+    }
+    T8_ASSERT (shift % bits == 0);
+    level = maxlevel - shift / bits;
+    id = packed >> (shift + 1);
+  }
+  scheme->t8_element_set_linear_id (element, level, id);
+}
+
+void
+t8_element_array_unpack (t8_element_array_t * element_array, int maxlevel,
+                         const t8_linearidx_t * packed, size_t count)
+{
+  t8_eclass_scheme_c *scheme;
+  size_t              ielem;
+  int                 bits;
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  T8_ASSERT (packed != NULL || count == 0);
+
+  scheme = element_array->scheme;
+  bits = t8_element_array_unpack_bits (scheme, maxlevel);
+  /* Resizing calls t8_element_init on the new elements */
+  t8_element_array_resize (element_array, count);
+  for (ielem = 0; ielem < count; ielem++) {
+    t8_element_array_unpack_element (scheme, bits, maxlevel, packed[ielem],
+                                     t8_element_array_index_locidx
+                                     (element_array, ielem));
+  }
+}
+
+size_t
+t8_element_array_encode (t8_element_array_t * element_array, size_t first,
+                         size_t count, int maxlevel, char *buffer)
+{
+  t8_linearidx_t      packed[T8_ELEMENT_ARRAY_PACK_BATCH];
+  t8_linearidx_t      previous, value;
+  size_t              offset, ielem, bytes;
+  int                 num;
+
+  T8_ASSERT (buffer != NULL || count == 0);
+
+  previous = 0;
+  bytes = 0;
+  for (offset = 0; offset < count; offset += num) {
+    num = (int) SC_MIN (count - offset, T8_ELEMENT_ARRAY_PACK_BATCH);
+    t8_element_array_pack_range (element_array, first + offset, num,
+                                 maxlevel, packed);
+    for (ielem = 0; ielem < (size_t) num; ielem++) {
+      /* Store the difference to the previous element in zigzag encoding,
+       * such that small negative differences are small numbers as well */
+      value = packed[ielem] - previous;
+      value = (value << 1) ^ ((t8_linearidx_t) 0 - (value >> 63));
+      previous = packed[ielem];
+      /* Write it with 7 bits per byte, the high bit marks continuation */
+      while (value >= 0x80) {
+        buffer[bytes++] = (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+      }
+      buffer[bytes++] = (char) value;
+    }
+  }
+  T8_ASSERT (bytes <= count * T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES);
+  return bytes;
+}
+
+size_t
+t8_element_array_decode (t8_element_array_t * element_array, size_t first,
+                         size_t count, int maxlevel, const char *buffer)
+{
+  const unsigned char *bytes = (const unsigned char *) buffer;
+  t8_eclass_scheme_c *scheme;
+  t8_linearidx_t      previous, value;
+  size_t              ielem, pos;
+  int                 bits, shift;
+
+  T8_ASSERT (t8_element_array_is_valid (element_array));
+  T8_ASSERT (first + count <= t8_element_array_get_count (element_array));
+  T8_ASSERT (buffer != NULL || count == 0);
+
+  scheme = element_array->scheme;
+  bits = t8_element_array_unpack_bits (scheme, maxlevel);
+  previous = 0;
+  pos = 0;
+  for (ielem = 0; ielem < count; ielem++) {
+    value = 0;
+    shift = 0;
+    do {
+      value |= (t8_linearidx_t) (bytes[pos] & 0x7f) << shift;
+      shift += 7;
+    } while (bytes[pos++] & 0x80);
+    previous += (value >> 1) ^ ((t8_linearidx_t) 0 - (value & 1));
+    t8_element_array_unpack_element (scheme, bits, maxlevel, previous,
+                                     t8_element_array_index_locidx
+                                     (element_array, first + ielem));
+  }
+  return pos;
+}
+
 T8_EXTERN_C_END ();
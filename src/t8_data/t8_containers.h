@@ -44,6 +44,24 @@ typedef struct
   sc_array_t          array;  /**< The array in which the elements are stored */
 } t8_element_array_t;
 
+/** The t8_element_array_soa_t stores the levels and linear ids of the
+ * elements of a \ref t8_element_array_t in separate contiguous arrays
+ * (structure of arrays).
+ * Algorithms that only need the levels or the space-filling curve position
+ * of the elements, for example searching or comparing elements, can
+ * then stream through contiguous memory without accessing the elements
+ * themselves and without calling the eclass scheme for each element.
+ * The structure is a snapshot. It is not updated automatically if the
+ * element array changes.
+ */
+typedef struct
+{
+  size_t              count;  /**< The number of elements */
+  int                 level;  /**< The level of the uniform refinement that the linear ids refer to */
+  int                *levels; /**< The levels of the elements */
+  t8_linearidx_t     *ids;    /**< The linear ids of the elements at \a level */
+} t8_element_array_soa_t;
+
 T8_EXTERN_C_BEGIN ();
 
 /** Creates a new array structure with 0 elements.
@@ -137,6 +155,24 @@ void                t8_element_array_init_copy (t8_element_array_t *
 void                t8_element_array_resize (t8_element_array_t *
                                              element_array, size_t new_count);
 
+/** Allocate memory for a number of elements without changing the element
+ * count of an array.
+ * Subsequent pushes and resizes up to \a capacity elements do not
+ * reallocate the memory. Use this if the number of elements that will
+ * be added can be predicted, to avoid copying the array repeatedly
+ * while it grows. The memory of large arrays is advised to be backed by
+ * transparent huge pages if the system supports it.
+ * \param [in,out] element_array  The element array. It must not be a view.
+ * \param [in] capacity           The number of elements to allocate memory
+ *                                for. If it is not larger than the current
+ *                                allocation, nothing happens.
+ * \note Resizing the array to a much smaller count may free the memory
+ *       that exceeds the new count.
+ */
+void                t8_element_array_reserve (t8_element_array_t *
+                                              element_array,
+                                              size_t capacity);
+
 /** Copy the contents of an array into another.
  * Both arrays must have the same eclass_scheme.
  * \param [in] dest Array will be resized and get new data.
@@ -233,6 +269,147 @@ void                t8_element_array_reset (t8_element_array_t *
 void                t8_element_array_truncate (t8_element_array_t *
                                                element_array);
 
+/** Initialize the structure of arrays of an element array.
+ * \param [in,out] soa     The structure to be initialized.
+ * \param [in] element_array The elements whose levels and linear ids
+ *                          are computed.
+ * \param [in] level       The level of the uniform refinement for the linear
+ *                          ids. Must be greater or equal to the level of each
+ *                          element. Usually the maxlevel of the forest.
+ * \note This requires \ref t8_element_array_soa_reset to free the memory.
+ */
+void                t8_element_array_soa_init (t8_element_array_soa_t * soa,
+                                               t8_element_array_t *
+                                               element_array, int level);
+
+/** Free the memory of a structure of arrays.
+ * \param [in,out] soa     The structure to be reset.
+ */
+void                t8_element_array_soa_reset (t8_element_array_soa_t * soa);
+
+/** Return the level of an element in a structure of arrays.
+ * \param [in] soa         The structure of arrays.
+ * \param [in] index       The index of an element.
+ * \return                 The level of the element at position \a index.
+ */
+int                 t8_element_array_soa_get_level (const
+                                                    t8_element_array_soa_t *
+                                                    soa, t8_locidx_t index);
+
+/** Return the linear id of an element in a structure of arrays.
+ * \param [in] soa         The structure of arrays.
+ * \param [in] index       The index of an element.
+ * \return                 The linear id at level \a soa->level of the
+ *                          element at position \a index.
+ */
+t8_linearidx_t      t8_element_array_soa_get_id (const
+                                                 t8_element_array_soa_t *
+                                                 soa, t8_locidx_t index);
+
+/** Compare two elements of a structure of arrays by their position in the
+ * space-filling curve order.
+ * \param [in] soa         The structure of arrays.
+ * \param [in] index_a     The index of the first element.
+ * \param [in] index_b     The index of the second element.
+ * \return                 Negative, zero, or positive if the first element
+ *                          is smaller, equal, or larger than the second.
+ *                          An element is smaller than its descendants.
+ */
+int                 t8_element_array_soa_compare (const
+                                                  t8_element_array_soa_t *
+                                                  soa, t8_locidx_t index_a,
+                                                  t8_locidx_t index_b);
+
+/** Find the last element in a structure of arrays whose linear id is
+ * smaller or equal than a given one.
+ * \param [in] soa         The structure of arrays. The elements must be
+ *                          sorted in space-filling curve order.
+ * \param [in] id          A linear id at level \a soa->level.
+ * \return                 The largest index i, such that the element at
+ *                          position i has a smaller or equal id than \a id.
+ *                          If no such i exists, return -1.
+ */
+t8_locidx_t         t8_element_array_soa_search_lower (const
+                                                       t8_element_array_soa_t
+                                                       * soa,
+                                                       t8_linearidx_t id);
+
+/** Store the elements of an element array in compressed form.
+ * Each element is encoded in one 64 bit integer that contains its linear id
+ * at level \a maxlevel and its level. This requires that the dimension of
+ * the elements times \a maxlevel is smaller than 64.
+ * Pyramids are encoded by their linear id at their own level and their level,
+ * which requires their level to be smaller than 20.
+ * \param [in] element_array The elements to compress.
+ * \param [in] maxlevel    The maximum level of the elements,
+ *                          usually the maxlevel of the forest.
+ * \param [out] packed     Allocated array of at least as many entries as
+ *                          elements in \a element_array. On output the
+ *                          encoded elements in the same order.
+ * \see t8_element_array_unpack
+ */
+void                t8_element_array_pack (t8_element_array_t *
+                                           element_array, int maxlevel,
+                                           t8_linearidx_t * packed);
+
+/** Restore the elements of an element array from their compressed form.
+ * \param [in,out] element_array An initialized element array, whose scheme
+ *                          matches the one used for packing. On output
+ *                          its count is \a count and it stores the
+ *                          decoded elements.
+ * \param [in] maxlevel    The level that was used for packing.
+ * \param [in] packed      The elements as computed by
+ *                          \ref t8_element_array_pack.
+ * \param [in] count       The number of entries in \a packed.
+ */
+void                t8_element_array_unpack (t8_element_array_t *
+                                             element_array, int maxlevel,
+                                             const t8_linearidx_t * packed,
+                                             size_t count);
+
+/** The maximum number of bytes of one element encoded by
+ * \ref t8_element_array_encode. */
+#define T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES 10
+
+/** Encode a range of elements of an element array into a byte stream,
+ * for example to send them in a message.
+ * Each element is packed as in \ref t8_element_array_pack, and its
+ * difference to the previous packed element is stored as a variable-length
+ * integer. Since the elements of a tree are sorted along the space-filling
+ * curve, the differences are small and most elements need only a few bytes.
+ * \param [in] element_array The elements.
+ * \param [in] first       The index of the first element to encode.
+ * \param [in] count       The number of elements to encode.
+ * \param [in] maxlevel    The maximum level of the elements,
+ *                          usually the maxlevel of the forest.
+ * \param [out] buffer     Allocated array of at least
+ *                          \a count * \ref T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES
+ *                          bytes. On output the encoded elements.
+ * \return                 The number of bytes written to \a buffer.
+ * \see t8_element_array_decode
+ */
+size_t              t8_element_array_encode (t8_element_array_t *
+                                             element_array, size_t first,
+                                             size_t count, int maxlevel,
+                                             char *buffer);
+
+/** Decode elements that were encoded with \ref t8_element_array_encode.
+ * \param [in,out] element_array An element array, whose scheme matches the
+ *                          one used for encoding, with at least
+ *                          \a first + \a count elements. On output the
+ *                          elements first, ..., first + count - 1 are the
+ *                          decoded elements.
+ * \param [in] first       The index of the first decoded element.
+ * \param [in] count       The number of encoded elements.
+ * \param [in] maxlevel    The level that was used for encoding.
+ * \param [in] buffer      The encoded elements.
+ * \return                 The number of bytes read from \a buffer.
+ */
+size_t              t8_element_array_decode (t8_element_array_t *
+                                             element_array, size_t first,
+                                             size_t count, int maxlevel,
+                                             const char *buffer);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_CONTAINERS_HXX */
@@ -0,0 +1,89 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_hash.h
+ * Cheap 64-bit hash functions for the content hashes of forests and
+ * coarse meshes.
+ */
+
+#ifndef T8_HASH_H
+#define T8_HASH_H
+
+#include <t8.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Mix the bits of a 64-bit value, such that similar values have
+ * unrelated hashes. This is the finalizer of splitmix64.
+ * \param [in] value    Any value.
+ * \return              The mixed value.
+ */
+static inline uint64_t
+t8_hash_mix (uint64_t value)
+{
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+/** Combine a hash with a further value. The result depends on the order
+ * in which the values are combined.
+ * \param [in] hash     The current hash.
+ * \param [in] value    The value to add to the hash.
+ * \return              The combined hash.
+ */
+static inline uint64_t
+t8_hash_combine (uint64_t hash, uint64_t value)
+{
+  return t8_hash_mix (hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6)
+                              + (hash >> 2)));
+}
+
+/** Combine a hash with the bytes of a memory block.
+ * \param [in] hash     The current hash.
+ * \param [in] data     The memory block.
+ * \param [in] size     The number of bytes of \a data.
+ * \return              The combined hash.
+ */
+static inline uint64_t
+t8_hash_bytes (uint64_t hash, const void *data, size_t size)
+{
+  const char         *bytes = (const char *) data;
+  uint64_t            word;
+  size_t              ibyte;
+
+  for (ibyte = 0; ibyte + sizeof (word) <= size; ibyte += sizeof (word)) {
+    memcpy (&word, bytes + ibyte, sizeof (word));
+    hash = t8_hash_combine (hash, word);
+  }
+  /* The remaining bytes and the size, such that trailing zeros count */
+  word = 0;
+  memcpy (&word, bytes + ibyte, size - ibyte);
+  return t8_hash_combine (hash, word ^ ((uint64_t) size << 56));
+}
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_HASH_H */
@@ -37,13 +37,59 @@ typedef struct t8_shmem_array
   sc_MPI_Comm         comm;
 #ifdef T8_ENABLE_DEBUG
   sc_shmem_type_t     shmem_type;
+  int                 writing_possible; /* True between start and end writing,
+                                           if this process may write */
 #endif
 } t8_shmem_array_struct_t;
 
+void
+t8_shmem_init (sc_MPI_Comm comm)
+{
+  sc_MPI_Comm         intranode, internode;
+
+  /* Only compute the node communicators if they are not already attached */
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL) {
+    sc_mpi_comm_attach_node_comms (comm, 0);
+  }
+}
+
+void
+t8_shmem_finalize (sc_MPI_Comm comm)
+{
+  sc_MPI_Comm         intranode, internode;
+
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode != sc_MPI_COMM_NULL) {
+    sc_mpi_comm_detach_node_comms (comm);
+  }
+}
+
+/* Return true if a shmem type shares the arrays in MPI-3 windows */
+static int
+t8_shmem_type_is_window (sc_shmem_type_t type)
+{
+#if defined(SC_ENABLE_MPIWINSHARED)
+  return type == SC_SHMEM_WINDOW || type == SC_SHMEM_WINDOW_PRESCAN;
+#else
+  return 0;
+#endif
+}
+
 int
 t8_shmem_set_type (sc_MPI_Comm comm, sc_shmem_type_t type)
 {
+  sc_MPI_Comm         intranode, internode;
+
   if (sc_shmem_get_type (comm) == SC_SHMEM_NOT_SET) {
+    if (t8_shmem_type_is_window (type)) {
+      /* Without node communicators there is nothing to share.
+       * They are attached on all processes of comm or on none. */
+      sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+      if (intranode == sc_MPI_COMM_NULL) {
+        type = SC_SHMEM_BASIC;
+      }
+    }
     /* This communicator does not have a shmem type, so we set it */
     sc_shmem_set_type (comm, type);
     return 1;
@@ -73,10 +119,37 @@ t8_shmem_array_init (t8_shmem_array_t * parray, size_t elem_size,
   array->elem_count = elem_count;
   array->elem_size = elem_size;
 #ifdef T8_ENABLE_DEBUG
-  array->shmem_type = T8_SHMEM_BEST_TYPE;
+  array->shmem_type = sc_shmem_get_type (comm);
 #endif
 }
 
+int
+t8_shmem_array_start_writing (t8_shmem_array_t array)
+{
+  int                 writing_possible;
+
+  T8_ASSERT (array != NULL);
+  T8_ASSERT (array->array != NULL);
+
+  writing_possible = sc_shmem_write_start (array->array, array->comm);
+#ifdef T8_ENABLE_DEBUG
+  array->writing_possible = writing_possible;
+#endif
+  return writing_possible;
+}
+
+void
+t8_shmem_array_end_writing (t8_shmem_array_t array)
+{
+  T8_ASSERT (array != NULL);
+  T8_ASSERT (array->array != NULL);
+
+#ifdef T8_ENABLE_DEBUG
+  array->writing_possible = 0;
+#endif
+  sc_shmem_write_end (array->array, array->comm);
+}
+
 void
 t8_shmem_array_copy (t8_shmem_array_t dest, t8_shmem_array_t source)
 {
@@ -97,15 +170,107 @@ t8_shmem_array_copy (t8_shmem_array_t dest, t8_shmem_array_t source)
   sc_shmem_memcpy (dest->array, source->array, bytes, source->comm);
 }
 
+/* Allgather into an array that is shared between the processes of a node.
+ * Each process sends its rank together with its data to the first process
+ * of its node. These node leaders exchange the data of their nodes in one
+ * allgather over the internode communicator and copy each block to the
+ * position of its rank. Since the ranks are sent with the data, the
+ * nodes may be of different size and their ranks need not be consecutive.
+ * Afterwards the processes of a node synchronize with a barrier. */
+static void
+t8_shmem_array_allgather_window (void *sendbuf, int sendcount,
+                                 sc_MPI_Datatype sendtype,
+                                 t8_shmem_array_t recvarray, int recvcount,
+                                 sc_MPI_Datatype recvtype,
+                                 sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  const size_t        block_size = recvcount * sc_mpi_sizeof (recvtype);
+  const size_t        entry_size = sizeof (int) + block_size;
+  char               *entry, *node_entries = NULL, *entries;
+  int                *node_bytes, *node_displs;
+  int                 mpirank, intrarank, intrasize, num_nodes;
+  int                 local_bytes, bytes, inode, rank, mpiret;
+  size_t              num_entries, ientry;
+
+  T8_ASSERT (sendcount * sc_mpi_sizeof (sendtype) == block_size);
+  mpiret = sc_MPI_Comm_rank (recvarray->comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Gather the ranks and data of the node on its first process */
+  entry = T8_ALLOC (char, entry_size);
+  memcpy (entry, &mpirank, sizeof (int));
+  memcpy (entry + sizeof (int), sendbuf, block_size);
+  if (intrarank == 0) {
+    node_entries = T8_ALLOC (char, intrasize * entry_size);
+  }
+  mpiret = sc_MPI_Gather (entry, (int) entry_size, sc_MPI_BYTE,
+                          node_entries, (int) entry_size, sc_MPI_BYTE, 0,
+                          intranode);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (entry);
+
+  if (t8_shmem_array_start_writing (recvarray)) {
+    /* Only the first process of each node writes */
+    T8_ASSERT (intrarank == 0);
+    mpiret = sc_MPI_Comm_size (internode, &num_nodes);
+    SC_CHECK_MPI (mpiret);
+    node_bytes = T8_ALLOC (int, 2 * num_nodes);
+    node_displs = node_bytes + num_nodes;
+    local_bytes = (int) (intrasize * entry_size);
+    mpiret = sc_MPI_Allgather (&local_bytes, 1, sc_MPI_INT, node_bytes, 1,
+                               sc_MPI_INT, internode);
+    SC_CHECK_MPI (mpiret);
+    bytes = 0;
+    for (inode = 0; inode < num_nodes; inode++) {
+      node_displs[inode] = bytes;
+      bytes += node_bytes[inode];
+    }
+    entries = T8_ALLOC (char, bytes);
+    mpiret = sc_MPI_Allgatherv (node_entries, local_bytes, sc_MPI_BYTE,
+                                entries, node_bytes, node_displs,
+                                sc_MPI_BYTE, internode);
+    SC_CHECK_MPI (mpiret);
+    /* Copy the data of each process to the position of its rank */
+    num_entries = bytes / entry_size;
+    for (ientry = 0; ientry < num_entries; ientry++) {
+      memcpy (&rank, entries + ientry * entry_size, sizeof (int));
+      T8_ASSERT (0 <= rank && (size_t) rank * recvcount
+                 < recvarray->elem_count);
+      memcpy ((char *) recvarray->array + rank * block_size,
+              entries + ientry * entry_size + sizeof (int), block_size);
+    }
+    T8_FREE (entries);
+    T8_FREE (node_bytes);
+  }
+  /* Synchronizes the processes of the node */
+  t8_shmem_array_end_writing (recvarray);
+  T8_FREE (node_entries);
+}
+
 void
 t8_shmem_array_allgather (void *sendbuf, int sendcount,
                           sc_MPI_Datatype sendtype,
                           t8_shmem_array_t recvarray, int recvcount,
                           sc_MPI_Datatype recvtype)
 {
+  sc_MPI_Comm         intranode, internode;
+
   T8_ASSERT (recvarray != NULL);
   T8_ASSERT (recvarray->array != NULL);
 
+  if (t8_shmem_type_is_window (sc_shmem_get_type (recvarray->comm))) {
+    sc_mpi_comm_get_node_comms (recvarray->comm, &intranode, &internode);
+    if (intranode != sc_MPI_COMM_NULL) {
+      t8_shmem_array_allgather_window (sendbuf, sendcount, sendtype,
+                                       recvarray, recvcount, recvtype,
+                                       intranode, internode);
+      return;
+    }
+  }
   sc_shmem_allgather (sendbuf, sendcount, sendtype, recvarray->array,
                       recvcount, recvtype, recvarray->comm);
 }
@@ -158,6 +323,7 @@ t8_shmem_array_set_gloidx (t8_shmem_array_t array, int index,
   T8_ASSERT (array->array != NULL);
   T8_ASSERT (array->elem_size == sizeof (t8_gloidx_t));
   T8_ASSERT (0 <= index && (size_t) index < array->elem_count);
+  T8_ASSERT (array->writing_possible);
 
   ((t8_gloidx_t *) array->array)[index] = value;
 }
@@ -34,10 +34,11 @@ typedef struct t8_shmem_array *t8_shmem_array_t;
 
 /** Defines the shared memory type that is best suited for t8code and the
  * current machine.
+ * The window type needs node communicators. On a communicator without
+ * them, \ref t8_shmem_set_type selects the basic type instead, such that
+ * this type can be used on any communicator.
  * \see sc_shmem.h
  */
-/* TODO: Change it as soon as we do not always need basic */
-#if 1
 #if defined(__bgq__)
 #define T8_SHMEM_BEST_TYPE SC_SHMEM_BGQ
 #elif defined(SC_ENABLE_MPIWINSHARED)
@@ -45,18 +46,38 @@ typedef struct t8_shmem_array *t8_shmem_array_t;
 #else
 #define T8_SHMEM_BEST_TYPE SC_SHMEM_BASIC
 #endif
-#endif
-#if 0
-/* For testing we only use basic shmem type */
-#define T8_SHMEM_BEST_TYPE SC_SHMEM_BASIC
-#endif
 
 T8_EXTERN_C_BEGIN ();
 
+/** Enable node-local shared memory arrays on a communicator.
+ * This computes the intranode and internode communicators of \a comm and
+ * attaches them to \a comm. Afterwards, a shared memory array on \a comm
+ * exists only once per compute node instead of once per process and
+ * \ref t8_shmem_array_allgather gathers data hierarchically over the
+ * node leaders. This is useful for the arrays of size mpisize held by each
+ * forest, such as the element offsets, which otherwise cost O(mpisize)
+ * memory on every single process.
+ * Without MPI-3 shared windows, this function has no effect.
+ * This function is collective on \a comm and must be called before any
+ * shared memory array on \a comm is allocated.
+ * \param [in]          comm    The MPI communicator.
+ * \see t8_shmem_finalize
+ */
+void                t8_shmem_init (sc_MPI_Comm comm);
+
+/** Detach the communicators that were attached by \ref t8_shmem_init.
+ * Must be called after all shared memory arrays on \a comm are freed.
+ * \param [in]          comm    The MPI communicator.
+ */
+void                t8_shmem_finalize (sc_MPI_Comm comm);
+
 /** Try to set a shared memory type of a communicator.
  * If the type was set, returns true, otherwise false.
  * This will not set the type, if ther already was a type set
  * on this communicator. \see sc_shmem_set_type
+ * The window types are only set on communicators with node communicators
+ * attached by \ref t8_shmem_init. On other communicators the basic type
+ * is set instead, since each process would hold the whole array anyway.
  * \param [in,out]      comm    The MPI Communicator
  * \param [in]          type    A shared memory type.
  * \return                      Non-zero if the type was set. Zero if it wasn't.
@@ -70,14 +91,35 @@ int                 t8_shmem_set_type (sc_MPI_Comm comm,
  * \param [in]          elem_size The size in bytes of an array element.
  * \param [in]          elem_count The total number of elements to allocate.
  * \param [in]          comm      The MPI communicator to be associated with the shmem_array.
- *                                The shared memory type must have been set. Best practice would be
- *                                calling \ref sc_shmem_set_type (comm, T8_SHMEM_BEST_TYPE).
+ *                                If no shared memory type was set, \ref T8_SHMEM_BEST_TYPE
+ *                                is set with \ref t8_shmem_set_type.
  */
 void                t8_shmem_array_init (t8_shmem_array_t * parray,
                                          size_t elem_size,
                                          size_t elem_count, sc_MPI_Comm comm);
 
+/** Enable writing to a shared memory array.
+ * If the array is shared between the processes of a node, only one process
+ * per node may write to it. Writing must happen between a call to this
+ * function and \ref t8_shmem_array_end_writing.
+ * This function is collective on the communicator of \a array.
+ * \param [in,out]      array   The array to be written to.
+ * \return              Non-zero if this process may write to \a array,
+ *                      for example with \ref t8_shmem_array_set_gloidx.
+ */
+int                 t8_shmem_array_start_writing (t8_shmem_array_t array);
+
+/** Finish writing to a shared memory array and make the written data
+ * visible to all processes.
+ * This function is collective on the communicator of \a array.
+ * \param [in,out]      array   The array that was written to.
+ * \see t8_shmem_array_start_writing
+ */
+void                t8_shmem_array_end_writing (t8_shmem_array_t array);
+
 /** Set an entry of a t8_shmem array that is used to store t8_gloidx_t.
+ * Only a process for which \ref t8_shmem_array_start_writing returned
+ * true may call this function.
  * \param [in,out]      array   The array to be mofified.
  * \param [in]          index   The array entry to be modified.
  * \param [in]          value   The new value to be set.
@@ -94,6 +136,13 @@ void                t8_shmem_array_copy (t8_shmem_array_t dest,
                                          t8_shmem_array_t source);
 
 /** Fill a t8_shmem array with an allgather.
+ * If the array is shared between the processes of a node, the processes
+ * gather their data on the first process of their node. Only these node
+ * leaders exchange data with each other, with one allgather across the
+ * nodes, and write it into the shared array. The other processes only
+ * wait in a barrier within their node. The nodes may have different
+ * numbers of processes, whose ranks need not be consecutive.
+ * This function is collective on the communicator of \a recvarray.
  *
  * \param[in] sendbuf         the source from this process
  * \param[in] sendcount       the number of items to allgather
@@ -54,7 +54,7 @@ t8_eclass_face_orientation[T8_ECLASS_COUNT][T8_ECLASS_MAX_FACES] = {
   {0, 1, 1, 0, 0, 1},           /* hex */
   {0, 1, 0, 1, -1, -1},         /* tet */
   {1, 0, 1, 0, 1, -1},          /* prism */
-  {0, 1, 0, 1, 0, -1}           /* pyramid */
+  {0, 1, 1, 0, 0, -1}           /* pyramid */
 };
 
 const int    t8_eclass_num_vertices[T8_ECLASS_COUNT] =
@@ -154,7 +154,7 @@ t8_eclass_compare (t8_eclass_t eclass1, t8_eclass_t eclass2)
       return eclass2 == T8_ECLASS_PYRAMID ? -1 : 1;
     default:
       T8_ASSERT (eclass1 == T8_ECLASS_PYRAMID);
-      return -1;
+      return 1;
     }
   }
 }
@@ -70,6 +70,8 @@ t8_eclass_t;
 #define T8_ECLASS_MAX_CORNERS_2D 4
 /** The maximum number of cornes an element class can have. */
 #define T8_ECLASS_MAX_CORNERS 8
+/** The maximum number of children an element of any class can have. */
+#define T8_ECLASS_MAX_CHILDREN 10
 /** The maximal possible dimension for an eclass */
 #define T8_ECLASS_MAX_DIM 3
 
@@ -21,13 +21,14 @@
 */
 
 #include <t8_element.h>
+#include <t8_refcount.h>
 
 void
 t8_scheme_cxx_ref (t8_scheme_cxx_t * scheme)
 {
   T8_ASSERT (scheme != NULL);
 
-  sc_refcount_ref (&scheme->rc);
+  t8_refcount_ref (&scheme->rc);
 }
 
 void
@@ -39,7 +40,7 @@ t8_scheme_cxx_unref (t8_scheme_cxx_t ** pscheme)
   scheme = *pscheme;
   T8_ASSERT (scheme != NULL);
 
-  if (sc_refcount_unref (&scheme->rc)) {
+  if (t8_refcount_unref (&scheme->rc)) {
     t8_scheme_cxx_destroy (scheme);
     *pscheme = NULL;
   }
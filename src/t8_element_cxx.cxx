@@ -22,6 +22,39 @@
 
 #include <t8_element_cxx.hxx>
 
+/* The minimum size of a block of scratch memory in bytes */
+#define T8_ELEMENT_SCRATCH_BLOCK_SIZE 65536
+/* The alignment of the scratch elements */
+#define T8_ELEMENT_SCRATCH_ALIGN 16
+
+/* The scratch memory of one thread. It is a list of blocks on which we
+ * allocate linearly. The blocks are never moved, such that the elements
+ * stay valid until they are released.
+ * The memory lives as long as the thread, in particular possibly longer
+ * than t8code is initialized. We thus use the system allocator and do not
+ * count the memory as memory of the t8code package. */
+struct t8_element_scratch_arena
+{
+  char              **blocks;   /* The memory blocks */
+  size_t             *block_sizes;      /* The size of each block */
+  size_t              num_blocks;       /* The number of allocated blocks */
+  size_t              block;    /* The current block */
+  size_t              offset;   /* The first free byte in the current block */
+
+  ~t8_element_scratch_arena ()
+  {
+    size_t              iblock;
+
+    for (iblock = 0; iblock < num_blocks; iblock++) {
+      free (blocks[iblock]);
+    }
+    free (blocks);
+    free (block_sizes);
+  }
+};
+
+static thread_local t8_element_scratch_arena t8_element_scratch;
+
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
@@ -68,6 +101,360 @@ t8_eclass_scheme::t8_element_array_index (sc_array_t * array, size_t it)
   return (t8_element_t *) sc_array_index (array, it);
 }
 
+/* Return a pointer to the i-th element in a contiguous range of elements */
+#define T8_ELEMENT_BATCH_INDEX(ELEMS,I,SIZE) \
+  ((t8_element_t *) ((char *) (ELEMS) + (size_t) (I) * (SIZE)))
+
+/* Default implementation for the batch level computation */
+void
+t8_eclass_scheme::t8_element_batch_level (const t8_element_t * elems,
+                                          int count, int *levels)
+{
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    levels[ielem] =
+      t8_element_level (T8_ELEMENT_BATCH_INDEX (elems, ielem, element_size));
+  }
+}
+
+/* Default implementation for the batch child id computation */
+void
+t8_eclass_scheme::t8_element_batch_child_id (const t8_element_t * elems,
+                                             int count, int *child_ids)
+{
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    child_ids[ielem] =
+      t8_element_child_id (T8_ELEMENT_BATCH_INDEX
+                           (elems, ielem, element_size));
+  }
+}
+
+/* Default implementation for the batch parent computation */
+void
+t8_eclass_scheme::t8_element_batch_parent (const t8_element_t * elems,
+                                           int count, t8_element_t * parents)
+{
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    t8_element_parent (T8_ELEMENT_BATCH_INDEX (elems, ielem, element_size),
+                       T8_ELEMENT_BATCH_INDEX (parents, ielem, element_size));
+  }
+}
+
+/* Default implementation for the batch children computation */
+void
+t8_eclass_scheme::t8_element_batch_children (const t8_element_t * elems,
+                                             int count,
+                                             t8_element_t * children)
+{
+  int                 ielem, ichild, num_children;
+  t8_element_t       *elem;
+  t8_element_t      **child_pointers;
+
+  T8_ASSERT (count >= 0);
+  if (count == 0) {
+    return;
+  }
+  elem = T8_ELEMENT_BATCH_INDEX (elems, 0, element_size);
+  num_children = t8_element_num_children (elem);
+  child_pointers = T8_ALLOC (t8_element_t *, num_children);
+  for (ielem = 0; ielem < count; ielem++) {
+    elem = T8_ELEMENT_BATCH_INDEX (elems, ielem, element_size);
+    T8_ASSERT (t8_element_num_children (elem) == num_children);
+    for (ichild = 0; ichild < num_children; ichild++) {
+      child_pointers[ichild] =
+        T8_ELEMENT_BATCH_INDEX (children, ielem * num_children + ichild,
+                                element_size);
+    }
+    t8_element_children (elem, num_children, child_pointers);
+  }
+  T8_FREE (child_pointers);
+}
+
+/* Default implementation for the batch linear id computation */
+void
+t8_eclass_scheme::t8_element_batch_get_linear_id (const t8_element_t *
+                                                  elems, int count,
+                                                  int level,
+                                                  t8_linearidx_t * ids)
+{
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    ids[ielem] =
+      t8_element_get_linear_id (T8_ELEMENT_BATCH_INDEX
+                                (elems, ielem, element_size), level);
+  }
+}
+
+/* Default implementation for the batch construction from linear ids */
+void
+t8_eclass_scheme::t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                  int count, int level,
+                                                  t8_linearidx_t first_id)
+{
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  if (count == 0) {
+    return;
+  }
+  t8_element_set_linear_id (elems, level, first_id);
+  for (ielem = 1; ielem < count; ielem++) {
+    t8_element_successor (T8_ELEMENT_BATCH_INDEX
+                          (elems, ielem - 1, element_size),
+                          T8_ELEMENT_BATCH_INDEX (elems, ielem, element_size),
+                          level);
+  }
+}
+
+/* Default implementation for the face neighbor across a tree face */
+int
+t8_eclass_scheme::t8_element_tree_face_neighbor (const t8_element_t * elem,
+                                                 int face,
+                                                 t8_eclass_scheme_c *
+                                                 boundary_scheme,
+                                                 int orientation, int sign,
+                                                 int is_smaller_face,
+                                                 t8_eclass_scheme_c *
+                                                 neigh_scheme,
+                                                 t8_element_t * neigh,
+                                                 int neigh_tree_face)
+{
+  t8_element_t       *face_element;
+  t8_element_scratch_mark_t scratch_mark;
+  int                 neigh_face;
+
+  scratch_mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (boundary_scheme, 1, &face_element);
+  t8_element_boundary_face (elem, face, face_element, boundary_scheme);
+  boundary_scheme->t8_element_transform_face (face_element, face_element,
+                                              orientation, sign,
+                                              is_smaller_face);
+  neigh_face =
+    neigh_scheme->t8_element_extrude_face (face_element, boundary_scheme,
+                                           neigh, neigh_tree_face);
+  t8_element_scratch_release (scratch_mark);
+  return neigh_face;
+}
+
+/* Default implementation for the linear ids of the descendants */
+void
+t8_eclass_scheme::t8_element_descendant_range (const t8_element_t * elem,
+                                               int level,
+                                               t8_linearidx_t * first_id,
+                                               t8_linearidx_t * last_id)
+{
+  T8_ASSERT (t8_element_level (elem) <= level);
+  *first_id = t8_element_get_linear_id (elem, level);
+  *last_id = *first_id + t8_element_count_leafs (elem, level) - 1;
+}
+
+/* Default implementation for the linear ids of the descendants at a face */
+void
+t8_eclass_scheme::t8_element_face_descendant_range (const t8_element_t *
+                                                    elem, int face,
+                                                    int level,
+                                                    t8_linearidx_t * first_id,
+                                                    t8_linearidx_t * last_id)
+{
+  t8_element_t       *desc;
+  t8_element_scratch_mark_t scratch_mark;
+
+  T8_ASSERT (t8_element_level (elem) <= level);
+  scratch_mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (this, 1, &desc);
+  t8_element_first_descendant_face (elem, face, desc, level);
+  *first_id = t8_element_get_linear_id (desc, level);
+  t8_element_last_descendant_face (elem, face, desc, level);
+  *last_id = t8_element_get_linear_id (desc, level);
+  t8_element_scratch_release (scratch_mark);
+}
+
+/* Default implementation for the intersection of the descendants with
+ * an interval of linear ids */
+int
+t8_eclass_scheme::t8_element_descendants_intersect (const t8_element_t *
+                                                    elem, int level,
+                                                    t8_linearidx_t first_id,
+                                                    t8_linearidx_t last_id)
+{
+  t8_linearidx_t      desc_first, desc_last;
+
+  t8_element_descendant_range (elem, level, &desc_first, &desc_last);
+  return desc_first <= last_id && first_id <= desc_last;
+}
+
+/* Default implementation for finding a corner by its coordinates */
+int
+t8_eclass_scheme::t8_element_find_vertex (const t8_element_t * elem,
+                                          const int coords[3])
+{
+  int                 icorner, num_corners;
+  int                 corner_coords[3];
+
+  num_corners = t8_element_num_corners (elem);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    corner_coords[0] = corner_coords[1] = corner_coords[2] = 0;
+    t8_element_vertex_coords (elem, icorner, corner_coords);
+    if (corner_coords[0] == coords[0] && corner_coords[1] == coords[1]
+        && corner_coords[2] == coords[2]) {
+      return icorner;
+    }
+  }
+  return -1;
+}
+
+/* Default implementation for the child at a corner */
+void
+t8_eclass_scheme::t8_element_vertex_child (const t8_element_t * elem,
+                                           int corner, t8_element_t * child)
+{
+  int                 coords[3] = { 0, 0, 0 };
+  int                 ichild, num_children;
+
+  T8_ASSERT (0 <= corner && corner < t8_element_num_corners (elem));
+  T8_ASSERT (elem != child);
+
+  t8_element_vertex_coords (elem, corner, coords);
+  num_children = t8_element_num_children (elem);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    t8_element_child (elem, ichild, child);
+    if (t8_element_find_vertex (child, coords) >= 0) {
+      return;
+    }
+  }
+  SC_ABORT_NOT_REACHED ();
+}
+
+/* Default implementation for the neighbors at a corner.
+ * The elements of the same level at a corner are connected by their faces
+ * that contain the corner. We thus collect them by repeatedly constructing
+ * the face neighbors of the elements found so far and keeping those
+ * that have the corner. */
+int
+t8_eclass_scheme::t8_element_corner_neighbors_inside (const t8_element_t *
+                                                      elem, int corner,
+                                                      int max_neighbors,
+                                                      t8_element_t **
+                                                      neighbors)
+{
+  int                 coords[3] = { 0, 0, 0 };
+  int                 num_neighbors = 0, ivisit, iface, num_faces;
+  int                 ineigh, dual_face, is_new;
+  const t8_element_t *visit;
+  t8_element_t       *neigh;
+  t8_element_scratch_mark_t mark;
+
+  T8_ASSERT (0 <= corner && corner < t8_element_num_corners (elem));
+
+  mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (this, 1, &neigh);
+  t8_element_vertex_coords (elem, corner, coords);
+  /* We visit elem first and then all neighbors found so far */
+  for (ivisit = -1; ivisit < num_neighbors; ivisit++) {
+    visit = ivisit < 0 ? elem : neighbors[ivisit];
+    num_faces = t8_element_num_faces (visit);
+    for (iface = 0; iface < num_faces; iface++) {
+      if (!t8_element_face_neighbor_inside (visit, neigh, iface, &dual_face)
+          || t8_element_find_vertex (neigh, coords) < 0
+          || t8_element_compare (neigh, elem) == 0) {
+        /* The neighbor is outside of the tree or does not have the corner */
+        continue;
+      }
+      is_new = 1;
+      for (ineigh = 0; ineigh < num_neighbors && is_new; ineigh++) {
+        is_new = t8_element_compare (neigh, neighbors[ineigh]) != 0;
+      }
+      if (is_new) {
+        SC_CHECK_ABORT (num_neighbors < max_neighbors,
+                        "Too many neighbors at corner");
+        t8_element_copy (neigh, neighbors[num_neighbors++]);
+      }
+    }
+  }
+  t8_element_scratch_release (mark);
+  return num_neighbors;
+}
+
+t8_element_scratch_mark_t
+t8_element_scratch_mark (void)
+{
+  t8_element_scratch_mark_t mark;
+
+  mark.block = t8_element_scratch.block;
+  mark.offset = t8_element_scratch.offset;
+  return mark;
+}
+
+void
+t8_element_scratch_new (t8_eclass_scheme_c * ts, int length,
+                        t8_element_t ** elems)
+{
+  t8_element_scratch_arena *arena = &t8_element_scratch;
+  size_t              element_size, num_bytes;
+  char               *first;
+  int                 ielem;
+
+  T8_ASSERT (length >= 0);
+  if (length == 0) {
+    return;
+  }
+  element_size = ts->t8_element_size ();
+  num_bytes = element_size * length;
+  num_bytes = (num_bytes + T8_ELEMENT_SCRATCH_ALIGN - 1)
+    / T8_ELEMENT_SCRATCH_ALIGN * T8_ELEMENT_SCRATCH_ALIGN;
+  /* Find the first block with enough free memory */
+  while (arena->block < arena->num_blocks
+         && arena->offset + num_bytes > arena->block_sizes[arena->block]) {
+    arena->block++;
+    arena->offset = 0;
+  }
+  if (arena->block == arena->num_blocks) {
+    /* Add a new block */
+    arena->blocks = (char **) realloc (arena->blocks, (arena->num_blocks + 1)
+                                       * sizeof (char *));
+    arena->block_sizes =
+      (size_t *) realloc (arena->block_sizes,
+                          (arena->num_blocks + 1) * sizeof (size_t));
+    SC_CHECK_ABORT (arena->blocks != NULL && arena->block_sizes != NULL,
+                    "Could not allocate scratch memory");
+    arena->block_sizes[arena->num_blocks] =
+      SC_MAX (num_bytes, T8_ELEMENT_SCRATCH_BLOCK_SIZE);
+    arena->blocks[arena->num_blocks] =
+      (char *) malloc (arena->block_sizes[arena->num_blocks]);
+    SC_CHECK_ABORT (arena->blocks[arena->num_blocks] != NULL,
+                    "Could not allocate scratch memory");
+    arena->num_blocks++;
+    arena->offset = 0;
+  }
+  first = arena->blocks[arena->block] + arena->offset;
+  arena->offset += num_bytes;
+  for (ielem = 0; ielem < length; ielem++) {
+    elems[ielem] = (t8_element_t *) (first + ielem * element_size);
+  }
+  ts->t8_element_init (length, (t8_element_t *) first, 0);
+}
+
+void
+t8_element_scratch_release (t8_element_scratch_mark_t mark)
+{
+  T8_ASSERT (mark.block < t8_element_scratch.block
+             || (mark.block == t8_element_scratch.block
+                 && mark.offset <= t8_element_scratch.offset));
+
+  t8_element_scratch.block = mark.block;
+  t8_element_scratch.offset = mark.offset;
+}
+
 T8_EXTERN_C_END ();
 
 #if 0
@@ -42,6 +42,10 @@ T8_EXTERN_C_BEGIN ();
  */
 /* TODO: Implement a test that boundary and extrude leads to the original element. */
 
+/** The maximum number of elements of one level in a tree that share a corner
+ * with a given element, see \ref t8_element_corner_neighbors_inside. */
+#define T8_ELEMENT_MAX_CORNER_NEIGHBORS 64
+
 /** This struct holds virtual functions for a particular element class. */
 struct t8_eclass_scheme
 {
@@ -619,6 +623,225 @@ public:
    */
   virtual t8_gloidx_t t8_element_count_leafs_from_root (int level) = 0;
 
+  /* The batch functions below operate on \a count many elements that are
+   * stored contiguously in memory, as it is the case for the elements of
+   * a \ref t8_element_array_t. The i-th element starts at byte offset
+   * i * \ref t8_element_size of \a elems.
+   * We provide default implementations that call the single element
+   * functions in a loop. An implementation should override them with a
+   * loop that does not call any virtual function, such that the compiler
+   * can inline the element operations. */
+
+  /** Compute the levels of a range of elements.
+   * \param [in] elems    Pointer to the first of \a count contiguous elements.
+   * \param [in] count    The number of elements.
+   * \param [out] levels  Array of at least \a count entries. On output
+   *                      levels[i] is the level of the i-th element.
+   */
+  virtual void        t8_element_batch_level (const t8_element_t * elems,
+                                              int count, int *levels);
+
+  /** Compute the child ids of a range of elements.
+   * \param [in] elems    Pointer to the first of \a count contiguous elements.
+   * \param [in] count    The number of elements.
+   * \param [out] child_ids Array of at least \a count entries. On output
+   *                      child_ids[i] is the child id of the i-th element.
+   */
+  virtual void        t8_element_batch_child_id (const t8_element_t * elems,
+                                                 int count, int *child_ids);
+
+  /** Compute the parents of a range of elements.
+   * \param [in] elems    Pointer to the first of \a count contiguous elements.
+   *                      Each element must have level > 0.
+   * \param [in] count    The number of elements.
+   * \param [in,out] parents Pointer to the first of \a count contiguous
+   *                      initialized elements. On output the i-th element
+   *                      is the parent of the i-th element of \a elems.
+   *                      \a parents may be equal to \a elems.
+   */
+  virtual void        t8_element_batch_parent (const t8_element_t * elems,
+                                               int count,
+                                               t8_element_t * parents);
+
+  /** Compute the children of a range of elements.
+   * \param [in] elems    Pointer to the first of \a count contiguous elements.
+   *                      All elements must have the same number of children
+   *                      \a num_children.
+   * \param [in] count    The number of elements.
+   * \param [in,out] children Pointer to the first of \a count * \a num_children
+   *                      contiguous initialized elements. On output the
+   *                      children of the i-th element are stored at the
+   *                      positions i * \a num_children, ...,
+   *                      (i + 1) * \a num_children - 1.
+   *                      \a children must not overlap with \a elems.
+   */
+  virtual void        t8_element_batch_children (const t8_element_t * elems,
+                                                 int count,
+                                                 t8_element_t * children);
+
+  /** Compute the linear ids of a range of elements in a hypothetical
+   * uniform refinement of a given level.
+   * \param [in] elems    Pointer to the first of \a count contiguous elements.
+   * \param [in] count    The number of elements.
+   * \param [in] level    The level of the uniform refinement to consider.
+   * \param [out] ids     Array of at least \a count entries. On output
+   *                      ids[i] is the linear id of the i-th element.
+   */
+  virtual void        t8_element_batch_get_linear_id (const t8_element_t *
+                                                      elems, int count,
+                                                      int level,
+                                                      t8_linearidx_t * ids);
+
+  /** Initialize a range of contiguous elements as consecutive elements of
+   * a uniform refinement of a given level.
+   * \param [in,out] elems Pointer to the first of \a count contiguous
+   *                      initialized elements. On output the i-th element
+   *                      has the linear id \a first_id + i at \a level.
+   * \param [in] count    The number of elements.
+   * \param [in] level    The level of the uniform refinement to consider.
+   * \param [in] first_id The linear id of the first element.
+   *                      \a first_id + \a count must not exceed the number
+   *                      of elements of the uniform refinement.
+   */
+  virtual void        t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                      int count, int level,
+                                                      t8_linearidx_t first_id);
+
+  /** Construct the same level face neighbor of an element across a tree
+   * face in the neighbor tree.
+   * This is the same as \ref t8_element_boundary_face,
+   * \ref t8_eclass_scheme::t8_element_transform_face of the boundary scheme
+   * and \ref t8_element_extrude_face of the neighbor scheme.
+   * The default implementation calls these functions with a temporary
+   * face element from the scratch memory, a scheme may override it with
+   * a version that does not need any virtual calls or temporary memory.
+   * \param [in] elem     The element. Its face \a face must lie on the tree
+   *                      face \a tree_face, see \ref t8_element_tree_face.
+   * \param [in] face     A face of \a elem.
+   * \param [in] boundary_scheme The scheme of the face element.
+   * \param [in] orientation The orientation of the tree-tree connection.
+   * \param [in] sign     The sign as in \ref t8_element_transform_face.
+   * \param [in] is_smaller_face Flag as in \ref t8_element_transform_face.
+   * \param [in] neigh_scheme The scheme of the neighbor tree.
+   * \param [in,out] neigh An allocated element of \a neigh_scheme. On output
+   *                      the face neighbor of \a elem in the neighbor tree.
+   * \param [in] neigh_tree_face The face of the neighbor tree at which
+   *                      the trees are connected.
+   * \return              The face of \a neigh at which \a elem is its
+   *                      neighbor.
+   */
+  virtual int         t8_element_tree_face_neighbor (const t8_element_t *
+                                                     elem, int face,
+                                                     t8_eclass_scheme_c *
+                                                     boundary_scheme,
+                                                     int orientation,
+                                                     int sign,
+                                                     int is_smaller_face,
+                                                     t8_eclass_scheme_c *
+                                                     neigh_scheme,
+                                                     t8_element_t * neigh,
+                                                     int neigh_tree_face);
+
+  /* The range functions below describe the descendants of an element
+   * by the linear ids they have in the uniform refinement of a given level,
+   * such that no descendant element needs to be constructed.
+   * We provide default implementations via \ref t8_element_get_linear_id,
+   * \ref t8_element_count_leafs and the descendant functions. */
+
+  /** Compute the interval of linear ids of the descendants of an element.
+   * \param [in] elem     The element.
+   * \param [in] level    A level greater or equal to the level of \a elem.
+   * \param [out] first_id The linear id of the first descendant of \a elem
+   *                      at \a level in a uniform refinement of \a level.
+   * \param [out] last_id The linear id of the last descendant of \a elem
+   *                      at \a level.
+   */
+  virtual void        t8_element_descendant_range (const t8_element_t *
+                                                   elem, int level,
+                                                   t8_linearidx_t * first_id,
+                                                   t8_linearidx_t * last_id);
+
+  /** Compute the linear ids of the first and the last descendant of an
+   * element that touch a given face.
+   * \param [in] elem     The element.
+   * \param [in] face     A face of \a elem.
+   * \param [in] level    A level greater or equal to the level of \a elem.
+   * \param [out] first_id The linear id of the descendant computed by
+   *                      \ref t8_element_first_descendant_face at \a level.
+   * \param [out] last_id The linear id of the descendant computed by
+   *                      \ref t8_element_last_descendant_face at \a level.
+   */
+  virtual void        t8_element_face_descendant_range (const t8_element_t *
+                                                        elem, int face,
+                                                        int level,
+                                                        t8_linearidx_t *
+                                                        first_id,
+                                                        t8_linearidx_t *
+                                                        last_id);
+
+  /** Query whether an element has a descendant in a given interval of
+   * linear ids.
+   * \param [in] elem     The element.
+   * \param [in] level    A level greater or equal to the level of \a elem.
+   * \param [in] first_id The first linear id of the interval at \a level.
+   * \param [in] last_id  The last linear id of the interval at \a level.
+   * \return              True if one of the descendants of \a elem at
+   *                      \a level has a linear id in
+   *                      [\a first_id, \a last_id].
+   */
+  virtual int         t8_element_descendants_intersect (const t8_element_t *
+                                                        elem, int level,
+                                                        t8_linearidx_t
+                                                        first_id,
+                                                        t8_linearidx_t
+                                                        last_id);
+
+  /* The corner neighbor functions below identify the corners of elements
+   * in the same tree by their integer coordinates, see
+   * \ref t8_element_vertex_coords.
+   * We provide default implementations that only use the face neighbors
+   * of elements. */
+
+  /** Find the corner of an element at given integer coordinates.
+   * \param [in] elem     The element.
+   * \param [in] coords   Integer coordinates of a point in the root tree,
+   *                      as computed by \ref t8_element_vertex_coords.
+   *                      Unused entries must be 0.
+   * \return              The number of the corner of \a elem at \a coords,
+   *                      or -1 if \a coords is not a corner of \a elem.
+   */
+  virtual int         t8_element_find_vertex (const t8_element_t * elem,
+                                              const int coords[3]);
+
+  /** Construct the child of an element that has a given corner of the
+   * element as a corner.
+   * \param [in] elem     The element. Its level must be smaller than maxlevel.
+   * \param [in] corner   A corner of \a elem.
+   * \param [in,out] child An allocated element, not equal to \a elem.
+   *                      On output the child of \a elem at \a corner.
+   */
+  virtual void        t8_element_vertex_child (const t8_element_t * elem,
+                                               int corner,
+                                               t8_element_t * child);
+
+  /** Compute all elements of the same level as a given element inside the
+   * root tree that have a given corner of the element as a corner.
+   * These are the face, edge and corner neighbors at this corner.
+   * \param [in] elem     The element.
+   * \param [in] corner   A corner of \a elem.
+   * \param [in] max_neighbors The number of elements in \a neighbors, at most
+   *                      \ref T8_ELEMENT_MAX_CORNER_NEIGHBORS are needed.
+   * \param [in,out] neighbors Allocated elements. On output the first
+   *                      elements are the neighbors of \a elem at \a corner.
+   *                      \a elem itself is not among them.
+   * \return              The number of neighbors.
+   */
+  virtual int         t8_element_corner_neighbors_inside (const t8_element_t
+                                                          * elem, int corner,
+                                                          int max_neighbors,
+                                                          t8_element_t **
+                                                          neighbors);
+
   /** This function has no defined effect but each implementation is free to
    *  provide its own meaning of it. Thus this function can be used to compute or
    *  lookup very scheme implementation specific data.
@@ -669,6 +892,8 @@ public:
    * \note If an element was created by \ref t8_element_new then \ref t8_element_init
    * may not be called for it. Thus, \ref t8_element_new should initialize an element
    * in the same way as a call to \ref t8_element_init would.
+   * \note This function and \ref t8_element_destroy must be safe to call
+   * concurrently from multiple threads.
    * \see t8_element_init
    * \see t8_element_is_valid
    */
@@ -710,6 +935,46 @@ public:
 /* TODO: document */
 void                t8_scheme_cxx_destroy (t8_scheme_cxx_t * s);
 
+/** A position in the scratch memory for temporary elements.
+ * \see t8_element_scratch_mark */
+typedef struct
+{
+  size_t              block;  /**< The current memory block */
+  size_t              offset; /**< The first free byte in the current block */
+} t8_element_scratch_mark_t;
+
+/** Get the current position of the scratch memory of the calling thread.
+ * The scratch memory is a stack of memory blocks for short-lived temporary
+ * elements that replaces calls to \ref t8_eclass_scheme::t8_element_new and
+ * \ref t8_eclass_scheme::t8_element_destroy. The memory is kept between uses,
+ * such that after a warm-up no allocation takes place.
+ * Each thread has its own scratch memory.
+ * \return                 The position to pass to \ref t8_element_scratch_release.
+ */
+t8_element_scratch_mark_t t8_element_scratch_mark (void);
+
+/** Get temporary elements from the scratch memory of the calling thread.
+ * The elements are initialized with \ref t8_eclass_scheme::t8_element_init.
+ * They stay valid until \ref t8_element_scratch_release is called with a mark
+ * obtained before this call.
+ * \param [in] ts          The scheme of the elements.
+ * \param [in] length      The number of elements.
+ * \param [out] elems      An array of \a length element pointers that are
+ *                         set to the new elements.
+ */
+void                t8_element_scratch_new (t8_eclass_scheme_c * ts,
+                                            int length,
+                                            t8_element_t ** elems);
+
+/** Release all scratch elements of the calling thread that were obtained
+ * after a given mark.
+ * The memory is not freed but reused by the following calls to
+ * \ref t8_element_scratch_new.
+ * \param [in] mark        A mark returned by \ref t8_element_scratch_mark.
+ */
+void                t8_element_scratch_release (t8_element_scratch_mark_t
+                                                mark);
+
 /* TODO: Copy the doxygen comments to the class definition above,
  * then delete all the functions below */
 #if 0
@@ -22,6 +22,14 @@
 
 /** \file t8_forest.h
  * We define the forest of trees in this file.
+ *
+ * The functions that query a committed forest without changing it, for
+ * example \ref t8_forest_get_element, \ref t8_forest_leaf_face_neighbors
+ * and \ref t8_forest_element_face_neighbor, can be called concurrently
+ * from multiple threads. Each thread must use its own elements, allocated
+ * with t8_element_new of the scheme, and its own workspaces.
+ * Functions that set, commit, change or destroy a forest, or exchange data
+ * between processes, must not be called concurrently for the same forest.
  */
 
 /* TODO: begin documenting this file: make doxygen 2>&1 | grep t8_forest */
@@ -31,29 +39,152 @@
 
 #include <t8_cmesh.h>
 #include <t8_element.h>
+#include <t8_geometry.h>
 #include <t8_data/t8_containers.h>
 
 /** Opaque pointer to a forest implementation. */
 typedef struct t8_forest *t8_forest_t;
 typedef struct t8_tree *t8_tree_t;
+/** Opaque handle of a non-blocking ghost data exchange.
+ * \see t8_forest_ghost_exchange_begin */
+typedef struct t8_ghost_data_exchange *t8_ghost_exchange_t;
+/** Opaque handle of a persistent ghost data exchange plan.
+ * \see t8_forest_ghost_exchange_plan_new */
+typedef struct t8_ghost_exchange_plan *t8_ghost_exchange_plan_t;
+/** Opaque handle of reusable buffers for leaf face neighbor queries.
+ * \see t8_forest_leaf_face_neighbors_workspace */
+typedef struct t8_forest_face_neighbor_workspace
+  *t8_forest_face_neighbor_workspace_t;
+/** Opaque handle of a data transfer between two forests.
+ * \see t8_forest_transfer_new */
+typedef struct t8_forest_transfer *t8_forest_transfer_t;
+/** Opaque handle of a model of the runtime per element that is fitted to
+ * measured runtimes. \see t8_forest_cost_model_new */
+typedef struct t8_forest_cost_model *t8_forest_cost_model_t;
+/** Opaque handle of a hierarchy of successively coarsened forests.
+ * \see t8_forest_hierarchy_new */
+typedef struct t8_forest_hierarchy *t8_forest_hierarchy_t;
+/** Opaque handle of a view of a subset of the elements of a forest.
+ * \see t8_forest_view_new */
+typedef struct t8_forest_view *t8_forest_view_t;
 
 /** This type controls, which neighbors count as ghost elements.
- * Currently, we support face-neighbors. Vertex and edge neighbors
- * will eventually be added. */
+ * Edge and vertex neighbors are currently only supported inside of a tree.
+ * Across tree boundaries only face neighbors are considered.
+ * It also controls which neighbors are balanced, see
+ * \ref t8_forest_set_balance_type. */
 typedef enum
 {
   T8_GHOST_NONE = 0,  /**< Do not create ghost layer. */
   T8_GHOST_FACES,     /**< Consider all face (codimension 1) neighbors. */
-  T8_GHOST_EDGES,     /**< Consider all edge (codimension 2) and face neighbors. */
+  T8_GHOST_EDGES,     /**< Consider all edge (codimension 2) and face neighbors.
+                           Creates the same ghost layer as T8_GHOST_VERTICES. */
   T8_GHOST_VERTICES   /**< Consider all vertex (codimension 3) and edge and face neighbors. */
 } t8_ghost_type_t;
 
+/** This type controls whether and how the ghost data is exchanged with
+ * one-sided communication. \see t8_forest_set_ghost_rma */
+typedef enum
+{
+  T8_GHOST_RMA_NONE = 0,  /**< Exchange the ghost data with messages. */
+  T8_GHOST_RMA_FENCE,     /**< Fetch the ghost data from windows, synchronized by fences. */
+  T8_GHOST_RMA_PSCW       /**< Fetch the ghost data from windows, synchronized by
+                               post, start, complete and wait among the remote processes. */
+} t8_ghost_rma_t;
+
 /** This typedef is needed as a helper construct to 
  * properly be able to define a function that returns
  * a pointer to a void fun(void) function. \see t8_forest_get_user_function.
  */
 typedef void        (*t8_generic_function_pointer) (void);
 
+/** The kind of change of a run of elements during adaptation.
+ * \see t8_forest_adapt_run_t */
+typedef enum
+{
+  T8_FOREST_ADAPT_UNCHANGED = 0, /**< The elements are kept as they are. */
+  T8_FOREST_ADAPT_REFINED,       /**< Each element is replaced by its children (or finer descendants). */
+  T8_FOREST_ADAPT_COARSENED      /**< Each family is replaced by its parent. */
+} t8_forest_adapt_change_t;
+
+/** A run of consecutive local elements of a forest that were changed in the
+ * same way during adaptation. The old elements
+ * first_old, ..., first_old + num_old - 1 of the forest that was adapted from
+ * became the new elements first_new, ..., first_new + num_new - 1 of the
+ * adapted forest.
+ * For unchanged runs num_old equals num_new and the elements match one by one.
+ * A refined (coarsened) run may consist of several refined elements (coarsened
+ * families), whose new (old) elements follow each other in linear order.
+ * All of them are replaced by the same number num_per_element of new (old)
+ * elements, such that a run can be processed without the elements of the
+ * forest that was adapted from.
+ * \see t8_forest_set_adapt_record_runs
+ */
+typedef struct
+{
+  t8_forest_adapt_change_t kind; /**< How the elements of this run changed. */
+  t8_locidx_t         first_old; /**< The local index of the first old element. */
+  t8_locidx_t         num_old;   /**< The number of old elements. */
+  t8_locidx_t         first_new; /**< The local index of the first new element. */
+  t8_locidx_t         num_new;   /**< The number of new elements. */
+  t8_locidx_t         num_per_element; /**< For refined runs the number of new elements of each old
+                                           element, for coarsened runs the number of old elements
+                                           of each new element, 1 for unchanged runs. */
+} t8_forest_adapt_run_t;
+
+/** A range of consecutive elements of a forest view. The elements
+ * first, ..., first + num - 1 belong to the view. The indices are local
+ * element indices, ghosts have the number of local elements plus their
+ * ghost index. \see t8_forest_view_get_tree_ranges */
+typedef struct
+{
+  t8_locidx_t         first;     /**< The index of the first element. */
+  t8_locidx_t         num;       /**< The number of elements. */
+} t8_forest_view_range_t;
+
+/** A callback that selects the elements of a forest view.
+ * \param [in] forest    The forest.
+ * \param [in] ltreeid   The local tree of \a element. Ghost trees have the
+ *                       number of local trees plus their ghost tree id.
+ * \param [in] element   A local element or a ghost.
+ * \param [in] element_index The local element index of \a element. Ghosts
+ *                       have the number of local elements plus their ghost
+ *                       index.
+ * \param [in] user_data The user data passed to \ref t8_forest_view_new.
+ * \return               True if \a element belongs to the view.
+ */
+typedef int         (*t8_forest_view_select_fn) (t8_forest_t forest,
+                                                 t8_locidx_t ltreeid,
+                                                 const t8_element_t *
+                                                 element,
+                                                 t8_locidx_t element_index,
+                                                 void *user_data);
+
+/** A callback that is called for each local element of a forest view.
+ * The parameters are the same as for \ref t8_forest_view_select_fn.
+ * \see t8_forest_view_iterate */
+typedef void        (*t8_forest_view_iterate_fn) (t8_forest_t forest,
+                                                  t8_locidx_t ltreeid,
+                                                  const t8_element_t *
+                                                  element,
+                                                  t8_locidx_t element_index,
+                                                  void *user_data);
+
+/** The number of bytes that the components of a forest occupy on this process.
+ * \see t8_forest_memory_usage */
+typedef struct
+{
+  size_t              forest;      /**< The forest struct, its trees and their first and last descendants. */
+  size_t              leaves;      /**< The local elements, compressed or mapped from a file. */
+  size_t              ghosts;      /**< The ghost elements, the remote elements and the ghost layers. */
+  size_t              hash_tables; /**< The lookup tables of the ghost layer and their memory pools. */
+  size_t              offsets;     /**< The element, tree and first descendant offsets in shared memory. */
+  size_t              caches;      /**< The geometry cache, face connectivity, search index,
+                                        bounding volume hierarchy, bounding boxes and adaptation runs. */
+  size_t              profile;     /**< The profile. */
+  size_t              total;       /**< The sum of all components. */
+} t8_forest_memory_usage_t;
+
 T8_EXTERN_C_BEGIN ();
 
 /* TODO: if eclass is a vertex then num_outgoing/num_incoming are always
@@ -112,6 +243,8 @@ typedef void        (*t8_forest_replace_t) (t8_forest_t forest_old,
  * \return greater zero if the first entry in \a elements should be refined,
  *         smaller zero if the family \a elements shall be coarsened,
  *         zero else.
+ * \note If \ref t8_forest_set_adapt_threaded is enabled, this function
+ *       may be called concurrently from multiple threads.
  */
 /* TODO: Do we really need the forest argument? Since the forest is not committed yet it
  *       seems dangerous to expose to the user. */
@@ -123,6 +256,153 @@ typedef int         (*t8_forest_adapt_t) (t8_forest_t forest,
                                           int num_elements,
                                           t8_element_t * elements[]);
 
+/** Callback function prototype to decide for refining and coarsening of
+ * all elements of a tree at once.
+ * The elements of the tree are passed as one contiguous array, such that
+ * the element with local id i in the tree starts at byte i * ts->t8_element_size ()
+ * of \a elements.
+ * For each element the callback has to fill the corresponding entry of
+ * \a markers with
+ *    a value greater zero if the element should be refined,
+ *    a value smaller zero if the element may be coarsened,
+ *    zero else.
+ * A family is coarsened if all of its members are marked for coarsening.
+ * Elements that are marked for coarsening but do not form a family marked
+ * for coarsening remain as they are.
+ * \param [in] forest      the forest to which the new elements belong
+ * \param [in] forest_from the forest that is adapted.
+ * \param [in] which_tree  the local tree containing \a elements
+ * \param [in] ts          the eclass scheme of the tree
+ * \param [in] num_elements the number of elements in \a which_tree
+ * \param [in] elements    The elements of the tree.
+ * \param [out] markers    An array of length \a num_elements to be filled
+ *                         with the markers of the elements.
+ * \see t8_forest_set_adapt_batch
+ */
+typedef void        (*t8_forest_adapt_batch_t) (t8_forest_t forest,
+                                                t8_forest_t forest_from,
+                                                t8_locidx_t which_tree,
+                                                t8_eclass_scheme_c * ts,
+                                                t8_locidx_t num_elements,
+                                                const t8_element_t *
+                                                elements, int *markers);
+
+/** Callback function prototype to compute the weight of an element for
+ * partitioning.
+ * The weight models the cost of the element, for example the number of
+ * degrees of freedom or the expected runtime. Weights must not be negative.
+ * \param [in] forest_from the forest that is partitioned.
+ * \param [in] which_tree  the local tree containing \a element
+ * \param [in] lelement_id the local element id in \a forest_from in the tree of \a element
+ * \param [in] ts          the eclass scheme of the tree
+ * \param [in] element     the element
+ * \return the weight of \a element.
+ * \see t8_forest_set_partition_weights
+ */
+typedef double      (*t8_forest_partition_weight_t) (t8_forest_t forest_from,
+                                                     t8_locidx_t which_tree,
+                                                     t8_locidx_t lelement_id,
+                                                     t8_eclass_scheme_c * ts,
+                                                     const t8_element_t *
+                                                     element);
+
+/** Interpolate the entry of an element data field to the children of a
+ * refined element.
+ * \param [in] data_old    The entry of the refined element.
+ * \param [in] num_new     The number of new elements. This is the number of
+ *                         children, or the number of descendants if the
+ *                         forest was adapted recursively.
+ * \param [out] data_new   The \a num_new entries of the new elements.
+ * \param [in] user        The user pointer of the field.
+ * \see t8_forest_data_add_field
+ */
+typedef void        (*t8_forest_data_refine_t) (const void *data_old,
+                                                t8_locidx_t num_new,
+                                                void *data_new, void *user);
+
+/** Restrict the entries of an element data field of a coarsened family to
+ * the parent.
+ * \param [in] data_old    The \a num_old entries of the old elements.
+ * \param [in] num_old     The number of old elements. This is the number of
+ *                         siblings, or the number of descendants if the
+ *                         forest was adapted recursively.
+ * \param [out] data_new   The entry of the new element.
+ * \param [in] user        The user pointer of the field.
+ * \see t8_forest_data_add_field
+ */
+typedef void        (*t8_forest_data_coarsen_t) (const void *data_old,
+                                                 t8_locidx_t num_old,
+                                                 void *data_new, void *user);
+
+/** The identifier of the built-in lossless codec for the element data of
+ * a checkpoint file. \see t8_forest_codec_lossless */
+#define T8_FOREST_CODEC_LOSSLESS 1
+/** The identifier of the built-in lossy codec for the element data of
+ * a checkpoint file. \see t8_forest_codec_lossy */
+#define T8_FOREST_CODEC_LOSSY 2
+
+typedef struct t8_forest_codec t8_forest_codec_t;
+
+/** Return an upper bound for the compressed size of element data.
+ * \param [in] codec       The codec.
+ * \param [in] data_size   The number of bytes per element.
+ * \param [in] num_elements The number of elements.
+ * \return The maximum number of bytes that \a compress writes.
+ */
+typedef size_t      (*t8_forest_codec_bound_t) (const t8_forest_codec_t *
+                                                codec, size_t data_size,
+                                                size_t num_elements);
+
+/** Compress the data of consecutive elements of one tree.
+ * \param [in] codec       The codec.
+ * \param [in] data_size   The number of bytes per element.
+ * \param [in] num_elements The number of elements.
+ * \param [in] in          The \a num_elements * \a data_size bytes of data.
+ * \param [out] out        Space for as many bytes as \a bound returns.
+ * \return The number of bytes written to \a out.
+ */
+typedef size_t      (*t8_forest_codec_compress_t) (const t8_forest_codec_t *
+                                                   codec, size_t data_size,
+                                                   size_t num_elements,
+                                                   const void *in, void *out);
+
+/** Decompress the data of consecutive elements of one tree.
+ * \param [in] codec       The codec.
+ * \param [in] data_size   The number of bytes per element.
+ * \param [in] num_elements The number of elements.
+ * \param [in] in          The compressed data written by \a compress.
+ * \param [in] in_bytes    The number of bytes of \a in.
+ * \param [out] out        The \a num_elements * \a data_size bytes of data.
+ * \return True if successful, false if \a in is corrupt.
+ */
+typedef int         (*t8_forest_codec_decompress_t) (const t8_forest_codec_t *
+                                                     codec, size_t data_size,
+                                                     size_t num_elements,
+                                                     const void *in,
+                                                     size_t in_bytes,
+                                                     void *out);
+
+/** A codec that compresses the element data of a checkpoint file.
+ * The data is compressed in chunks of consecutive elements of one tree,
+ * such that the codec sees the data in the order of the space-filling
+ * curve. The chunks are compressed and decompressed independently by
+ * the processes that write and read them.
+ * \see t8_forest_save_ext \see t8_forest_load_data_ext
+ */
+struct t8_forest_codec
+{
+  int                 id;       /**< A positive number that identifies the codec in the file.
+                                     Loading requires a codec with the same id. */
+  t8_forest_codec_bound_t bound; /**< The upper bound of the compressed size. */
+  t8_forest_codec_compress_t compress; /**< The compression function. */
+  t8_forest_codec_decompress_t decompress; /**< The decompression function. */
+  int                 level;    /**< The compression level of the built-in codecs,
+                                     between 0 and 9 or -1 for the default. */
+  double              error_bound; /**< The maximum absolute error of the built-in lossy codec. */
+  void               *user;     /**< Anything the user wants, e.g. the parameters of an
+                                     external compressor. */
+};
+
   /** Create a new forest with reference count one.
  * This forest needs to be specialized with the t8_forest_set_* calls.
  * Currently it is manatory to either call the functions \ref
@@ -165,10 +445,40 @@ int                 t8_forest_is_committed (t8_forest_t forest);
  *                      for each pair of elements of \a forest_a and \a forest_b.
  * \note This function is not collective. It only returns the state on the current
  * rank.
+ * \note If the tree hashes of both forests are known, see
+ * \ref t8_forest_get_tree_hash, forests with different hashes are rejected
+ * without comparing their elements.
  */
 int                 t8_forest_is_equal (t8_forest_t forest_a,
                                         t8_forest_t forest_b);
 
+/** Return a 64-bit hash of the local elements of a tree of a forest.
+ * The hash is the sum of hashes of the individual elements, each of which
+ * depends on the global tree id, the level and the linear id of the element.
+ * Forests with the same elements in a tree thus have the same hash, and
+ * forests with a different hash differ.
+ * The hashes of all local trees are computed on the first call. Afterwards,
+ * forests that are adapted or partitioned from this forest maintain their
+ * hashes by only hashing the changed and moved elements.
+ * \param [in] forest   A committed forest that is not compressed.
+ * \param [in] ltreeid  A local tree of \a forest.
+ * \return              The hash of the local elements of the tree.
+ */
+uint64_t            t8_forest_get_tree_hash (t8_forest_t forest,
+                                             t8_locidx_t ltreeid);
+
+/** Return a 64-bit hash of all elements of a forest.
+ * Since it is the sum of the tree hashes of all processes, it does not
+ * depend on the partition. Two forests with the same hash are equal with
+ * high probability, such that derived structures can be cached with the
+ * hash as key. A full comparison is needed to be sure.
+ * \param [in] forest   A committed forest that is not compressed.
+ * \return              The hash of the forest.
+ * \note This function is collective.
+ * \see t8_forest_get_tree_hash
+ */
+uint64_t            t8_forest_get_hash (t8_forest_t forest);
+
 /** Set the cmesh associated to a forest.
  * By default, the forest takes ownership of the cmesh such that it will be
  * destroyed when the forest is destroyed.  To keep ownership of the cmesh,
@@ -245,6 +555,9 @@ void                t8_forest_set_copy (t8_forest_t forest,
  * 1) Adapt 2) Balance 3) Partition
  * \note This setting may not be combined with \ref t8_forest_set_copy and overwrites
  * this setting.
+ * \note If \b set_from is not referenced elsewhere and adaptation is not recursive,
+ * the elements of \b set_from are adapted in place and their memory is reused
+ * by \b forest.
  */
 /* TODO: make recursive flag to int specifying the number of recursions? */
 void                t8_forest_set_adapt (t8_forest_t forest,
@@ -252,6 +565,89 @@ void                t8_forest_set_adapt (t8_forest_t forest,
                                          t8_forest_adapt_t adapt_fn,
                                          int recursive);
 
+/** Set a source forest with a batched adapt function to be adapted on commiting.
+ * This is the same as \ref t8_forest_set_adapt with non-recursive adaptation,
+ * but \b adapt_batch_fn is called once per local tree of \b set_from
+ * with all elements of the tree, instead of once per element or family.
+ * \param [in,out] forest   The forest
+ * \param [in] set_from     The source forest from which \b forest will be adapted.
+ *                          We take ownership. This can be prevented by
+ *                          referencing \b set_from.
+ *                          If NULL, a previously (or later) set forest will
+ *                          be taken (\ref t8_forest_set_partition, \ref t8_forest_set_balance).
+ * \param [in] adapt_batch_fn The batched adapt function used on commiting.
+ * \note This setting can be combined with \ref t8_forest_set_partition and \ref
+ * t8_forest_set_balance, see \ref t8_forest_set_adapt.
+ * \see t8_forest_adapt_batch_t
+ */
+void                t8_forest_set_adapt_batch (t8_forest_t forest,
+                                               const t8_forest_t set_from,
+                                               t8_forest_adapt_batch_t
+                                               adapt_batch_fn);
+
+/** Set a source forest to be adapted on commiting according to an array of markers.
+ * No adapt callback is called, instead the new elements are build directly
+ * from the markers. This lets the markers be computed elsewhere, for example
+ * by a solver on an accelerator, and only the marker array be transferred.
+ * With \ref t8_forest_set_adapt_threaded the new elements are created in
+ * parallel. For the element with local id i in \b set_from,
+ *    markers[i] = k > 0 refines the element k times, such that it is
+ *                       replaced by its descendants of k levels finer,
+ *    markers[i] < 0 marks the element for coarsening,
+ *    markers[i] = 0 keeps the element.
+ * A family is coarsened if all of its members are marked for coarsening.
+ * Elements that are marked for coarsening but do not form a family marked
+ * for coarsening remain as they are.
+ * \param [in,out] forest   The forest
+ * \param [in] set_from     The source forest from which \b forest will be adapted.
+ *                          We take ownership. This can be prevented by
+ *                          referencing \b set_from.
+ *                          If NULL, a previously (or later) set forest will
+ *                          be taken (\ref t8_forest_set_partition, \ref t8_forest_set_balance).
+ * \param [in] markers      An array with one entry per local element of \b set_from.
+ *                          It must stay valid until \ref t8_forest_commit is called.
+ * \param [in] max_level    Elements are not refined beyond this level.
+ *                          If negative, the maximum refinement level of
+ *                          the forest is used.
+ * \note This setting can be combined with \ref t8_forest_set_partition and \ref
+ * t8_forest_set_balance, see \ref t8_forest_set_adapt.
+ */
+void                t8_forest_set_adapt_markers (t8_forest_t forest,
+                                                 const t8_forest_t set_from,
+                                                 const int8_t *markers,
+                                                 int max_level);
+
+/** Count the elements that a forest will be adapted to, without adapting it.
+ * The adapt callback, the batched adapt callback or the markers that were
+ * set with \ref t8_forest_set_adapt, \ref t8_forest_set_adapt_batch or
+ * \ref t8_forest_set_adapt_markers are evaluated for the elements of the
+ * source forest as on commit, but no new elements are created.
+ * The predicted weights can be passed to \ref t8_forest_set_partition_weights
+ * to partition the source forest by the size it will have after adapting.
+ * If the adaptation is then set for the partitioned forest, the elements
+ * are refined after they were migrated, such that less data is sent and
+ * the peak memory of each process stays bounded.
+ * To get the same result after partitioning, the adapt callback must not
+ * depend on the local element ids and the partition should be set for
+ * coarsening, see \ref t8_forest_set_partition.
+ * \param [in,out] forest   An initialized forest that is set to be adapted,
+ *                          but not recursively. It is not committed.
+ * \param [out] tree_counts If not NULL, an array with one entry per local
+ *                          tree of the source forest that is filled with
+ *                          the number of elements of the adapted tree.
+ * \param [out] weights     If not NULL, an array with one entry per local
+ *                          element of the source forest. A kept element gets
+ *                          weight 1, a refined element the number of its new
+ *                          elements and each of the n members of a coarsened
+ *                          family 1 / n.
+ * \return                  The number of local elements of the adapted forest.
+ * \note Since the callbacks are evaluated, they are called twice for each
+ * element if the forest is committed afterwards.
+ */
+t8_locidx_t         t8_forest_adapt_count (t8_forest_t forest,
+                                           t8_locidx_t *tree_counts,
+                                           double *weights);
+
 /** Set the user data of a forest. This can i.e. be used to pass user defined
  * arguments to the adapt routine.
  * \param [in,out] forest   The forest
@@ -300,9 +696,11 @@ t8_generic_function_pointer t8_forest_get_user_function (t8_forest_t forest);
  *                          referencing \b set_from.
  *                          If NULL, a previously (or later) set forest will
  *                          be taken (\ref t8_forest_set_adapt, \ref t8_forest_set_balance).
- * \param [in]      set_for_coarsening CURRENTLY DISABLED. If true, then the partitions
- *                          are choose such that coarsening an element once is a process local
- *                          operation.
+ * \param [in]      set_for_coarsening If true, then the partitions
+ *                          are chosen such that coarsening an element once is a process local
+ *                          operation. No family of elements is split between processes,
+ *                          which may move the partition boundaries by less than the size of
+ *                          a family.
  * \note This setting can be combined with \ref t8_forest_set_adapt and \ref
  * t8_forest_set_balance. The order in which these operations are executed is always
  * 1) Adapt 2) Balance 3) Partition
@@ -315,6 +713,264 @@ void                t8_forest_set_partition (t8_forest_t forest,
                                              const t8_forest_t set_from,
                                              int set_for_coarsening);
 
+/** Assign weights to the elements that are used when partitioning the forest.
+ * Instead of distributing the same number of elements to each process,
+ * the partition boundaries are chosen such that each process receives
+ * approximately the same sum of element weights.
+ * The weights are either computed by a callback or given as an array.
+ * \param [in, out] forest  The forest.
+ * \param [in]      weight_fn A callback returning the weight of an element of
+ *                          the forest that is partitioned. May be NULL.
+ * \param [in]      weights An array with one entry per local element of the
+ *                          forest that is partitioned. It must stay valid until
+ *                          \ref t8_forest_commit is called. May be NULL.
+ *                          Since the local elements change during adapt and
+ *                          balance, an array can only be used if the forest
+ *                          is only partitioned.
+ * \note At most one of \a weight_fn and \a weights may be non-NULL.
+ * If both are NULL, each element has weight one.
+ * \note This setting only has an effect together with \ref t8_forest_set_partition,
+ * or \ref t8_forest_set_balance with repartitioning and
+ * \ref t8_forest_set_balance_repartition_once.
+ * \see t8_forest_partition_weight_t
+ */
+void                t8_forest_set_partition_weights (t8_forest_t forest,
+                                                     t8_forest_partition_weight_t
+                                                     weight_fn,
+                                                     const double *weights);
+
+/** Assign a weight to each element class that is used when partitioning
+ * the forest.
+ * Each element has the weight of the eclass of its tree, such that each
+ * process receives approximately the same sum of weights. This is useful
+ * for hybrid forests, in which elements of different classes have
+ * different costs, for example a prism costs about twice as much as a tetrahedron.
+ * Since all elements of a tree have the same weight, the partition is computed
+ * per tree and the elements are not visited.
+ * \param [in, out] forest  The forest.
+ * \param [in]      eclass_weights The weight of an element of each eclass.
+ *                          The values are copied. Weights must not be negative.
+ *                          If NULL, a previously set table is removed.
+ * \note This setting may not be combined with \ref t8_forest_set_partition_weights.
+ * It can be combined with adapt and balance, see \ref t8_forest_set_partition_weights.
+ */
+void                t8_forest_set_partition_eclass_weights (t8_forest_t
+                                                            forest,
+                                                            const double
+                                                            eclass_weights
+                                                            [T8_ECLASS_COUNT]);
+
+/** Partition the forest with the costs of a fitted cost model.
+ * Each element has the weight that \a model predicts for its eclass and
+ * level, see \ref t8_forest_cost_model_get_cost. If profiling is enabled,
+ * the imbalance of the last fit of \a model is stored in the profile, see
+ * \ref t8_forest_profile_get_partition_imbalance.
+ * \param [in, out] forest  The forest.
+ * \param [in]      model   A cost model. It must stay valid until
+ *                          \ref t8_forest_commit is called.
+ *                          If NULL, a previously set model is removed.
+ * \note This setting may not be combined with \ref t8_forest_set_partition_weights
+ * or \ref t8_forest_set_partition_eclass_weights.
+ * It can be combined with adapt and balance.
+ */
+void                t8_forest_set_partition_cost_model (t8_forest_t forest,
+                                                        t8_forest_cost_model_t
+                                                        model);
+
+/** Create a cost model that predicts the runtime of an element from its
+ * eclass and level.
+ * The application reports measured runtimes with
+ * \ref t8_forest_cost_model_record after each step and calls
+ * \ref t8_forest_cost_model_fit before the next partition. The model is
+ * then passed to \ref t8_forest_set_partition_cost_model, such that the
+ * partition follows the measured cost instead of hand-tuned weights.
+ * \param [in]      smoothing The weight of a new fit relative to the previous
+ *                          costs, in (0, 1]. With 1 only the last fit is used,
+ *                          smaller values damp measurement noise.
+ * \return                  The new cost model. Until it is fitted, each
+ *                          element has cost 1.
+ */
+t8_forest_cost_model_t t8_forest_cost_model_new (double smoothing);
+
+/** Destroy a cost model.
+ * \param [in,out]  pmodel  The cost model. Set to NULL on output.
+ */
+void                t8_forest_cost_model_destroy (t8_forest_cost_model_t *
+                                                  pmodel);
+
+/** Report the measured runtime of a range of elements of a local tree.
+ * The runtime is distributed among the elements proportionally to
+ * their currently predicted costs, thus ranges that mix several levels
+ * converge to the cost of each level over repeated fits.
+ * \param [in,out]  model   The cost model.
+ * \param [in]      forest  A committed forest.
+ * \param [in]      ltreeid A local tree of \a forest.
+ * \param [in]      first_element The first tree local element of the range.
+ * \param [in]      num_elements The number of elements of the range.
+ *                          If negative, all elements from \a first_element
+ *                          to the end of the tree.
+ * \param [in]      runtime The measured runtime of the range in seconds.
+ */
+void                t8_forest_cost_model_record (t8_forest_cost_model_t
+                                                 model, t8_forest_t forest,
+                                                 t8_locidx_t ltreeid,
+                                                 t8_locidx_t first_element,
+                                                 t8_locidx_t num_elements,
+                                                 double runtime);
+
+/** Fit the costs of a model to the runtimes that were recorded since the
+ * last fit and reset the records.
+ * The cost of an eclass and level is the recorded runtime of its elements
+ * divided by their number, summed over all processes and combined with the
+ * previous cost according to the smoothing of the model.
+ * This function is collective over \a comm.
+ * \param [in,out]  model   The cost model.
+ * \param [in]      comm    The communicator of the processes that recorded
+ *                          runtimes.
+ * \return                  The imbalance of the recorded runtimes, that is
+ *                          the maximum runtime of a process divided by the
+ *                          average. 1 if no runtime was recorded.
+ */
+double              t8_forest_cost_model_fit (t8_forest_cost_model_t model,
+                                              sc_MPI_Comm comm);
+
+/** Return the predicted runtime of an element.
+ * Levels without measurements get the average cost of the measured levels
+ * of the eclass, eclasses without measurements the average of all.
+ * \param [in]      model   The cost model.
+ * \param [in]      eclass  The eclass of the element.
+ * \param [in]      level   The level of the element.
+ * \return                  The cost of the element. 1 if the model was
+ *                          never fitted.
+ */
+double              t8_forest_cost_model_get_cost (t8_forest_cost_model_t
+                                                   model, t8_eclass_t eclass,
+                                                   int level);
+
+/** Return the imbalance computed by the last \ref t8_forest_cost_model_fit.
+ * \param [in]      model   The cost model.
+ * \return                  The imbalance, 1 if the model was never fitted.
+ */
+double              t8_forest_cost_model_get_imbalance (t8_forest_cost_model_t
+                                                        model);
+
+/** Allow the partition to deviate from the ideal load in order to move fewer
+ * elements.
+ * By default, the new partition distributes the elements (or their weights)
+ * as evenly as possible, which may shift every process boundary even if the
+ * forest is almost balanced. With a positive tolerance, each process boundary
+ * of \a set_from is only moved as far as needed to bring it within
+ * \a tolerance / 2 times the average load of its ideal position.
+ * Thus a forest whose boundaries are all within this band is not changed
+ * at all, and after small local adaptations only the processes near the
+ * imbalance exchange elements.
+ * \param [in, out] forest  The forest.
+ * \param [in]      tolerance The allowed deviation relative to the average load
+ *                          per process. Must not be negative.
+ *                          0 computes the ideal partition (the default).
+ * \note This setting is combined with \ref t8_forest_set_partition_weights and
+ * \ref t8_forest_set_partition_eclass_weights, in which case the load is the
+ * weight. It is applied before \a set_for_coarsening of
+ * \ref t8_forest_set_partition.
+ */
+void                t8_forest_set_partition_tolerance (t8_forest_t forest,
+                                                       double tolerance);
+
+/** Partition in two levels, first between the compute nodes and then
+ * between the processes within each node.
+ * The forest's communicator must have node communicators attached with
+ * \ref t8_shmem_init, and the processes of each node must have consecutive
+ * ranks. Otherwise this setting has no effect.
+ * The processes of a node then hold a contiguous part of the space-filling
+ * curve, such that most ghost elements of a process are owned by processes
+ * on the same node.
+ * Together with \ref t8_forest_set_partition_tolerance, the tolerance only
+ * applies to the boundaries between nodes, while the boundaries between the
+ * processes of a node are placed ideally within the node's range.
+ * Thus elements only migrate between nodes if the load of
+ * a node is out of the tolerance, few but large messages are sent between
+ * nodes and the balance within each node is restored with intranode messages.
+ * Without a tolerance, the resulting partition is the same as without node
+ * awareness.
+ * \param [in, out] forest  The forest.
+ * \param [in]      node_aware If true, partition node aware.
+ */
+void                t8_forest_set_partition_node_aware (t8_forest_t forest,
+                                                        int node_aware);
+
+/** Partition the forest with given element offsets instead of computing them.
+ * This applies a partition computed by an external partitioner, see
+ * \ref t8_forest_partition_offsets_from_assignment.
+ * \param [in, out] forest  The forest.
+ * \param [in]      element_offsets An array of mpisize + 1 entries, the same
+ *                          on each process. Process p receives the elements
+ *                          element_offsets[p], ..., element_offsets[p + 1] - 1
+ *                          of \a set_from in space-filling curve order.
+ *                          It must stay valid until \ref t8_forest_commit is
+ *                          called. If NULL, the offsets are computed.
+ * \note Since the offsets refer to the elements of \a set_from, they can only
+ * be given if the forest is only partitioned. The weights, tolerance and
+ * \a set_for_coarsening are then ignored.
+ */
+void                t8_forest_set_partition_offsets (t8_forest_t forest,
+                                                     const t8_gloidx_t *
+                                                     element_offsets);
+
+/** Register a user data array that is partitioned together with the elements.
+ * The entries of \a data_in are packed into the same messages as the elements,
+ * such that no second communication phase as in \ref t8_forest_partition_data
+ * is needed.
+ * This function can be called several times to register several arrays.
+ * \param [in, out] forest  The forest.
+ * \param [in]      data_in An array with one entry per local element of the forest
+ *                          that is partitioned. It must stay valid until
+ *                          \ref t8_forest_commit is called.
+ * \param [in,out]  data_out An initialized array with the same element size as
+ *                          \a data_in. On commit, it is resized to the number of
+ *                          local elements of \a forest and filled with the entries
+ *                          of its elements.
+ * \note The forest must only be partitioned, it cannot be adapted or balanced
+ * in the same commit.
+ */
+void                t8_forest_set_partition_data (t8_forest_t forest,
+                                                  const sc_array_t *data_in,
+                                                  sc_array_t *data_out);
+
+/** Register a variable-size user data array that is partitioned together with
+ * the elements.
+ * A local element i of the forest that is partitioned has the payload entries
+ * offsets_in[i], ..., offsets_in[i + 1] - 1 of \a payload_in.
+ * The number of entries of each element is shipped with the elements and
+ * the payload follows in one message per process, whose size the receiver
+ * knows from the offsets of the new partition.
+ * This function can be called several times and can be combined with
+ * \ref t8_forest_set_partition_data.
+ * \param [in, out] forest  The forest.
+ * \param [in]      offsets_in An array of size_t with one entry more than the
+ *                          number of local elements of the forest that is
+ *                          partitioned. offsets_in[0] must be 0.
+ * \param [in]      payload_in The payload with offsets_in[num_local] entries.
+ * \param [in,out]  offsets_out An initialized array of size_t. On commit, it is
+ *                          resized to the number of local elements of \a forest
+ *                          plus one and filled with the offsets in \a payload_out.
+ * \param [in,out]  payload_out An initialized array with the same element size as
+ *                          \a payload_in. On commit, it is filled with the payload
+ *                          of the local elements of \a forest.
+ * All input arrays must stay valid until \ref t8_forest_commit is called.
+ * \note The forest must only be partitioned, it cannot be adapted or balanced
+ * in the same commit.
+ */
+void                t8_forest_set_partition_data_variable (t8_forest_t
+                                                           forest,
+                                                           const sc_array_t
+                                                           *offsets_in,
+                                                           const sc_array_t
+                                                           *payload_in,
+                                                           sc_array_t
+                                                           *offsets_out,
+                                                           sc_array_t
+                                                           *payload_out);
+
 /** Set a source forest to be balanced during commit.
  * A forest is said to be balanced if each element has face neighbors of level
  * at most +1 or -1 of the element's level.
@@ -342,13 +998,71 @@ void                t8_forest_set_balance (t8_forest_t forest,
                                            const t8_forest_t set_from,
                                            int no_repartition);
 
+/** Choose the algorithm that balances a forest during commit.
+ * Balance refines elements in rounds until no element has a face neighbor
+ * of a level larger than its level + 1.
+ * If \a do_local is true, the local elements are balanced in rounds against
+ * the current ghost layer, until no process refines an element anymore.
+ * Only then a new ghost layer is created (and the forest is repartitioned)
+ * and the process is repeated if any element was refined. Thus, a refinement
+ * only needs a new ghost layer if it ripples across a process boundary.
+ * Otherwise, a new ghost layer is created (and the forest is repartitioned)
+ * after each round.
+ * Both algorithms produce the same balanced forest.
+ * On default the local rounds are used.
+ * \param [in, out] forest  The forest.
+ * \param [in]      do_local If true, balance in local rounds.
+ * \see t8_forest_set_balance
+ */
+void                t8_forest_set_balance_local (t8_forest_t forest,
+                                                 int do_local);
+
+/** Choose which neighbors of an element are balanced.
+ * With T8_GHOST_FACES an element is refined if it has a face neighbor of a
+ * level larger than its level + 1. With T8_GHOST_EDGES also edge neighbors
+ * and with T8_GHOST_VERTICES all neighbors that share a corner with the
+ * element are considered. The ghost layers that balance creates are of
+ * the same type.
+ * Edge and vertex neighbors are only balanced inside of a tree, across the
+ * boundaries of trees only face neighbors are balanced.
+ * On default the face neighbors are balanced.
+ * \param [in, out] forest  The forest.
+ * \param [in]      balance_type The neighbors to balance, must not be
+ *                          T8_GHOST_NONE.
+ * \see t8_forest_set_balance
+ */
+void                t8_forest_set_balance_type (t8_forest_t forest,
+                                                t8_ghost_type_t
+                                                balance_type);
+
+/** Choose when a forest that is balanced with repartitioning is partitioned.
+ * Since balance refines elements, the load of the processes changes in
+ * every round. If \a once is false, the intermediate forests are
+ * repartitioned in each round, which moves the elements of every round.
+ * If \a once is true, the forest is balanced without repartitioning and
+ * only the balanced forest is partitioned, such that the elements are only
+ * moved once. The intermediate forests may then be unevenly distributed.
+ * On default the intermediate forests are repartitioned.
+ * This setting has no effect if balance is set without repartitioning.
+ * \param [in, out] forest  The forest.
+ * \param [in]      once    If true, only partition the balanced forest.
+ * \see t8_forest_set_balance
+ */
+void                t8_forest_set_balance_repartition_once (t8_forest_t
+                                                            forest, int once);
+
 /** Enable or disable the creation of a layer of ghost elements.
  * On default no ghosts are created.
  * \param [in]      forest    The forest.
  * \param [in]      do_ghost  If non-zero a ghost layer will be created.
- * \param [in]      ghost_type Controls which neighbors count as ghost elements,
- *                             currently only T8_GHOST_FACES is supported. This value
- *                             is ignored if \a do_ghost = 0.
+ * \param [in]      ghost_type Controls which neighbors count as ghost elements.
+ *                             For T8_GHOST_EDGES and T8_GHOST_VERTICES
+ *                             the top-down search is not used.
+ *                             These include the neighbors at the corners
+ *                             inside a tree and across tree faces, but not
+ *                             in trees that share only an edge or a vertex
+ *                             with the element's tree.
+ *                             This value is ignored if \a do_ghost = 0.
  */
 void                t8_forest_set_ghost (t8_forest_t forest, int do_ghost,
                                          t8_ghost_type_t ghost_type);
@@ -365,17 +1079,431 @@ void                t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost,
                                              t8_ghost_type_t ghost_type,
                                              int ghost_version);
 
-/* TODO: use assertions and document that the forest_set (..., from) and
- *       set_load are mutually exclusive. */
+/** Set the number of ghost layers that are created.
+ * With \a ghost_depth = k the ghost layer does not only contain the face
+ * neighbors of the local elements, but all elements that can be reached from
+ * a local element by crossing at most k faces. This is needed for numerical
+ * schemes with wide stencils. Each additional layer costs one round of
+ * communication with the processes of the first layer.
+ * The ghosts keep their order by process, tree and linear id. The layer of
+ * each ghost can be queried with \ref t8_forest_get_ghost_layer, and
+ * \ref t8_forest_ghost_exchange_data_layers only exchanges the data of the
+ * inner layers.
+ * On default one layer is created.
+ * \param [in, out] forest      The forest.
+ * \param [in]      ghost_depth The number of layers, must be positive.
+ *                              Depths greater than 1 are only supported for
+ *                              the ghost type T8_GHOST_FACES.
+ * \see t8_forest_set_ghost
+ */
+void                t8_forest_set_ghost_depth (t8_forest_t forest,
+                                               int ghost_depth);
+
+/** Defer the creation of the ghost layer until it is first used.
+ * If enabled, \ref t8_forest_commit does not create the ghost layer that
+ * was requested with \ref t8_forest_set_ghost. It is created on the first
+ * call to a function that needs it, for example
+ * \ref t8_forest_get_num_ghosts, \ref t8_forest_ghost_exchange_data or
+ * \ref t8_forest_leaf_face_neighbors, or explicitly with
+ * \ref t8_forest_ghost_ensure. Forests that are only used as the source
+ * of another adapted or partitioned forest thus never pay for a ghost layer.
+ * Since the creation communicates, the first such call must be made on all
+ * processes of the forest's communicator.
+ * If data fields, compression or the face connectivity are set, the ghost
+ * layer is still created during commit.
+ * On default the ghost layer is created in commit.
+ * \param [in, out] forest  The forest.
+ * \param [in]      lazy    If true, create the ghost layer on first use.
+ * \note The incremental ghost algorithm needs the source forest, thus a
+ * deferred ghost layer is always created with the top-down search or, for
+ * ghost version 1, with the balanced algorithm.
+ * \see t8_forest_set_ghost
+ */
+void                t8_forest_set_ghost_lazy (t8_forest_t forest, int lazy);
+
+/** Exchange the ghost data between the processes of a compute node via
+ * shared memory.
+ * If enabled, \ref t8_forest_ghost_exchange_data does not send messages to
+ * the remote processes on the same node. Instead, each process writes the
+ * data of its remote elements into an MPI-3 shared memory window, from
+ * which the processes on the same node copy their ghost entries directly.
+ * Only the data of ghosts on other nodes is sent via MPI.
+ * The forest's communicator must have node communicators attached with
+ * \ref t8_shmem_init and MPI-3 shared windows must be available.
+ * Otherwise this setting has no effect.
+ * \param [in, out] forest  The forest.
+ * \param [in]      ghost_shmem If true, exchange ghost data via shared memory.
+ * \note The ghost elements themselves are still communicated via MPI when
+ * the ghost layer is created.
+ */
+void                t8_forest_set_ghost_shmem (t8_forest_t forest,
+                                               int ghost_shmem);
+
+/** Exchange the ghost data with one-sided MPI communication.
+ * If enabled, \ref t8_forest_ghost_exchange_begin does not send messages.
+ * Instead, each process packs the data of its remote elements into an
+ * MPI window and fetches its ghost entries from the windows of its remote
+ * processes with MPI_Get.
+ * The positions of the ghost data in the windows are computed once when
+ * the ghost layer is created, such that no messages have to be matched
+ * during an exchange.
+ * With \ref T8_GHOST_RMA_FENCE the access epochs are opened and closed by
+ * fences on the forest's communicator. With \ref T8_GHOST_RMA_PSCW each
+ * process only synchronizes with its remote processes, which is preferable
+ * for sparse communication patterns.
+ * MPI-3 one-sided communication must be available. Otherwise this setting
+ * has no effect. On default the ghost data is exchanged with messages.
+ * \param [in, out] forest  The forest.
+ * \param [in]      ghost_rma The synchronization of the one-sided exchange,
+ *                          or \ref T8_GHOST_RMA_NONE to use messages.
+ * \note If enabled, \ref t8_forest_set_ghost_shmem is ignored.
+ */
+void                t8_forest_set_ghost_rma (t8_forest_t forest,
+                                             t8_ghost_rma_t ghost_rma);
+
+/** Send the ghost data of contiguous boundary layers without copying it.
+ * The ghost data for a remote process is packed into a send buffer with one
+ * memcpy per run of consecutive local elements that the remote needs.
+ * If enabled, the data for a remote whose elements form a single run, as is
+ * common for the boundary layer to a neighbor along the space-filling curve,
+ * is sent directly from the element data array by
+ * \ref t8_forest_ghost_exchange_begin and by the persistent requests of
+ * \ref t8_forest_ghost_exchange_plan_new.
+ * The entries of the local elements must then not be changed until
+ * \ref t8_forest_ghost_exchange_end or
+ * \ref t8_forest_ghost_exchange_plan_wait returned.
+ * On default the data is always copied to send buffers.
+ * \param [in, out] forest  The forest.
+ * \param [in]      zero_copy If true, send contiguous ghost data directly.
+ * \note Shared memory and one-sided exchanges always copy the data into
+ * their windows.
+ */
+void                t8_forest_set_ghost_zero_copy (t8_forest_t forest,
+                                                   int zero_copy);
+
+/** Enable or disable the compressed storage of the elements of a forest.
+ * If enabled, \ref t8_forest_compress is called at the end of
+ * \ref t8_forest_commit, after the ghost layer was created.
+ * On default the elements are not compressed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_compress If non-zero the forest will be compressed.
+ * \see t8_forest_compress
+ */
+void                t8_forest_set_compress (t8_forest_t forest,
+                                            int do_compress);
+
+/** Enable or disable the contiguous storage of the leaves of a forest.
+ * If enabled, the elements of all local trees are moved into a single
+ * allocation at the end of \ref t8_forest_commit, in the order of the
+ * local trees. The element array of each tree is a view into this memory,
+ * as are the first and last descendants of the trees. This replaces one
+ * allocation per tree by one allocation per forest, which matters for
+ * forests of many small trees, and lets a loop over the elements of
+ * consecutive trees stream through consecutive memory.
+ * A forest that is adapted from a forest with contiguous leaves does not
+ * reuse the element memory of the source forest.
+ * On default each tree has its own allocation.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_contiguous If non-zero the leaves are stored
+ *                            contiguously.
+ */
+void                t8_forest_set_contiguous_leaves (t8_forest_t forest,
+                                                     int do_contiguous);
+
+/** Enable or disable the compressed encoding of the elements in the messages
+ * that create the ghost layer and partition a forest.
+ * If enabled, the elements are not sent as structs but by their level and
+ * the differences of their linear ids, as variable-length integers, see
+ * \ref t8_element_array_encode. This reduces the message volume
+ * considerably, at the cost of encoding and decoding the elements.
+ * The elements must be determined by their level and linear id, which is
+ * the case for the default schemes.
+ * A forest that is derived from this forest uses the same setting if it does
+ * not set its own. On default the elements are sent as structs.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_compress If non-zero the elements are sent compressed.
+ */
+void                t8_forest_set_compress_messages (t8_forest_t forest,
+                                                     int do_compress);
+
+/** Enable or disable the geometry cache of a forest.
+ * If enabled, the centroid, volume, face areas, face normals and face
+ * centroids of all local elements are computed in one sweep in
+ * \ref t8_forest_commit and stored in contiguous arrays.
+ * They can then be accessed with the t8_forest_element_cached_* functions.
+ * If the forest is only adapted from a forest that has a geometry cache,
+ * the data is only recomputed for the elements that changed.
+ * On default no geometry cache is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_cache  If non-zero the geometry cache will be computed.
+ */
+void                t8_forest_set_geometry_cache (t8_forest_t forest,
+                                                  int do_cache);
+
+/** Enable or disable the face connectivity table of a forest.
+ * If enabled, the face neighbors of all local elements are computed once in
+ * \ref t8_forest_commit and stored in compressed row storage together with
+ * the dual faces and the orientation of each face connection.
+ * Solvers can then sweep over the faces without calling
+ * \ref t8_forest_leaf_face_neighbors for each element.
+ * The forest must be balanced and, if it is distributed over more than one
+ * process, have a ghost layer.
+ * On default no face connectivity is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_connectivity If non-zero the face connectivity will be
+ *                            computed.
+ */
+void                t8_forest_set_face_connectivity (t8_forest_t forest,
+                                                     int do_connectivity);
+
+/** Enable or disable the search index of a forest.
+ * If enabled, the offsets at which \ref t8_forest_split_array splits the
+ * leaf arrays in a top-down search are computed once in
+ * \ref t8_forest_commit for all elements that the search can visit.
+ * Each search of the forest then reads the offsets from the index instead
+ * of computing them with a binary search.
+ * This pays off if the same forest is searched many times.
+ * On default no search index is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_index  If non-zero the search index will be computed.
+ */
+void                t8_forest_set_search_index (t8_forest_t forest,
+                                                int do_index);
+
+/** Enable or disable the element index of a forest.
+ * If enabled, the local tree of each local element is stored in
+ * \ref t8_forest_commit in an array indexed by the local element id.
+ * \ref t8_forest_get_element and \ref t8_forest_get_element_batch then look
+ * up the tree of an element in constant time instead of a binary search
+ * over the local trees. The index needs one \ref t8_locidx_t per element.
+ * On default no element index is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_index  If non-zero the element index will be computed.
+ */
+void                t8_forest_set_element_index (t8_forest_t forest,
+                                                 int do_index);
+
+/** Enable or disable the bounding volume hierarchy of a forest.
+ * If enabled, the axis-aligned bounding boxes of all local elements are
+ * computed in \ref t8_forest_commit and arranged in a hierarchy of boxes.
+ * Geometric queries with \ref t8_forest_bvh_query_box,
+ * \ref t8_forest_bvh_query_sphere and \ref t8_forest_bvh_query_ray then
+ * only test the elements in boxes that intersect the query region,
+ * regardless of how well the refinement of the trees matches the geometry.
+ * If the forest is adapted from a forest with a bounding volume hierarchy,
+ * the boxes of the elements that did not change are reused.
+ * On default no bounding volume hierarchy is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_bvh    If non-zero the hierarchy will be computed.
+ */
+void                t8_forest_set_bvh (t8_forest_t forest, int do_bvh);
+
+/** Enable or disable the boundary index of a forest.
+ * If enabled, the local leaves at each face of a local tree that lies at the
+ * domain boundary are listed in \ref t8_forest_commit.
+ * They are found by a top-down search along the tree face that is restricted
+ * to the range of leaves between the first and the last descendant at the
+ * face, such that only elements near the boundary are visited.
+ * \ref t8_forest_get_boundary_leaves then returns the leaves of a tree face
+ * without looping over all elements.
+ * If the forest is only adapted from a forest with a boundary index, the
+ * index is updated along the runs of the adaptation and only the changed
+ * elements at the boundary are tested.
+ * On default no boundary index is computed.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_index  If non-zero the boundary index will be computed.
+ */
+void                t8_forest_set_boundary_index (t8_forest_t forest,
+                                                  int do_index);
+
+/** Enable or disable the thread parallel adaptation of a forest.
+ * If enabled and t8code is configured with OpenMP, a non-recursive adaptation
+ * splits the local elements into chunks that do not cut through a family.
+ * The adapt callback is evaluated for the chunks in parallel, the number of
+ * new elements is computed with a prefix sum and the new elements are
+ * created in parallel. The resulting forest is the same as with serial
+ * adaptation.
+ * Each thread first touches the memory of the new elements it creates,
+ * so on NUMA systems the elements are spread over the memory domains of
+ * the threads. Consecutive threaded adaptations assign the same ranges of
+ * elements to the same threads if the thread placement is fixed, for
+ * example with OMP_PROC_BIND.
+ * The adapt callback must then be thread-safe: It may be called concurrently
+ * for different elements, the order of the calls is not specified and it may
+ * only read from \a forest and \a forest_from.
+ * The adaptation with markers, see \ref t8_forest_set_adapt_markers, is
+ * threaded the same way: The markers of all chunks are converted in
+ * parallel and the new leaf arrays are compacted with the prefix sum.
+ * Batched adaptation, see \ref t8_forest_set_adapt_batch, stays serial.
+ * Without OpenMP or for recursive adaptation this setting has no effect.
+ * On default adaptation is serial.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_threaded If non-zero the adapt callback may be called
+ *                            from multiple threads.
+ * \see t8_forest_adapt_t
+ */
+void                t8_forest_set_adapt_threaded (t8_forest_t forest,
+                                                  int do_threaded);
+
+/** Set the number of threads of the thread parallel algorithms of a forest.
+ * If t8code is configured with OpenMP, the threaded adaptation, the
+ * population of a uniform forest, the parallel search and the computation
+ * of the shared vertices of the vtk output use this number of threads
+ * for this forest, independent of the number of threads of OpenMP.
+ * A forest that is derived from this forest uses the same number of
+ * threads if it does not set its own.
+ * Without OpenMP this setting has no effect.
+ * \param [in]      forest    The forest.
+ * \param [in]      num_threads The number of threads. If zero, the number of
+ *                            threads of the source forest or, if there is
+ *                            none, the maximum number of threads of OpenMP
+ *                            is used. This is also the default.
+ * \see t8_forest_set_adapt_threaded
+ */
+void                t8_forest_set_num_threads (t8_forest_t forest,
+                                               int num_threads);
+
+/** Set the geometry of a forest.
+ * If a geometry is set, the coordinates of the elements are computed by
+ * mapping their reference coordinates in the tree with the geometry instead
+ * of interpolating the tree vertices. This applies to all functions that
+ * compute coordinates, such as \ref t8_forest_element_coordinate and
+ * \ref t8_forest_tree_element_coordinates, and thus also to the volumes,
+ * face geometry and the vtk output.
+ * A forest that is derived from this forest uses the same geometry if it
+ * does not set its own.
+ * \param [in,out] forest    The forest.
+ * \param [in]     geometry  The geometry. The forest takes ownership of
+ *                           one reference of \a geometry.
+ *                           If you want to keep using it, call
+ *                           \ref t8_geometry_ref before.
+ * \note The axis-aligned bounding boxes of the trees and elements are
+ * computed from the corner coordinates and are thus only exact for
+ * geometries that map the elements to convex hulls of their corners.
+ */
+void                t8_forest_set_geometry (t8_forest_t forest,
+                                            t8_geometry_t geometry);
+
+/** Return the geometry of a forest.
+ * \param [in]      forest    The forest.
+ * \return                   The geometry of \a forest, or NULL if its
+ *                           coordinates are interpolated from the tree
+ *                           vertices.
+ * \see t8_forest_set_geometry
+ */
+t8_geometry_t       t8_forest_get_geometry (t8_forest_t forest);
+
+/** Record which ranges of elements change during the adaptation of a forest.
+ * If enabled, the adaptation stores a compact list of runs of elements that
+ * are unchanged, refined or coarsened, see \ref t8_forest_get_adapt_runs.
+ * With these, data of the elements can be carried over to the adapted forest
+ * by copying the unchanged runs as a whole instead of calling
+ * \ref t8_forest_iterate_replace for each element.
+ * The runs are only recorded if the forest is only adapted and not also
+ * partitioned or balanced, since the local elements may move to other
+ * processes otherwise.
+ * On default no runs are recorded.
+ * \param [in]      forest    The forest.
+ * \param [in]      do_record If non-zero the runs are recorded.
+ */
+void                t8_forest_set_adapt_record_runs (t8_forest_t forest,
+                                                     int do_record);
+
+/** Load the elements of the forest from a checkpoint file when it is
+ * committed, instead of creating a uniform refinement.
+ * The file must have been written by \ref t8_forest_save for a forest on
+ * the same coarse mesh, but possibly with a different number of processes.
+ * The loaded elements are evenly distributed among the processes.
+ * \param [in,out] forest    The forest.
+ * \param [in]     filename  The name of the checkpoint file.
+ * \note This setting must be combined with \ref t8_forest_set_cmesh and
+ * \ref t8_forest_set_scheme and cannot be combined with any of the derived
+ * forest methods (\ref t8_forest_set_copy, \ref t8_forest_set_adapt,
+ * \ref t8_forest_set_partition, and \ref t8_forest_set_balance).
+ * The coarse mesh must be replicated or its partition must contain the
+ * trees of the loaded elements.
+ * \see t8_forest_load_data
+ */
 void                t8_forest_set_load (t8_forest_t forest,
                                         const char *filename);
 
+/** Map the elements of the forest into memory instead of reading them
+ * when it is loaded from a checkpoint file with \ref t8_forest_set_load.
+ * Each process maps its part of the elements of the file directly into
+ * the element arrays of its trees, the elements are not parsed or copied.
+ * This makes loading large forests that are only read almost instant.
+ * The file must have been written with the same scheme on the same
+ * architecture. The file must not be modified while the forest exists.
+ * If mmap is not available, the elements are read as usual.
+ * \param [in,out] forest    The forest.
+ * \param [in]     do_mmap   If non-zero the elements are mapped.
+ *                           On default the elements are read.
+ */
+void                t8_forest_set_load_mmap (t8_forest_t forest,
+                                             int do_mmap);
+
 /** Compute the global number of elements in a forest as the sum
  *  of the local element counts.
  *  \param [in] forest    The forest.
  */
 void                t8_forest_comm_global_num_elements (t8_forest_t forest);
 
+/** The scalars that \ref t8_forest_reduce combines into one collective.
+ * The values before \ref T8_FOREST_REDUCE_FIRST_MAX are summed, the
+ * others are maximized. */
+typedef enum t8_forest_reduce_value
+{
+  T8_FOREST_REDUCE_NUM_ELEMENTS = 0,  /**< Sum of the local element counts. */
+  T8_FOREST_REDUCE_NUM_NOT_DONE,      /**< Sum of the processes that are not done,
+                                           for example with a balance round. */
+  T8_FOREST_REDUCE_MAX_LEVEL,         /**< Maximum of the local element levels. */
+  T8_FOREST_REDUCE_COUNT              /**< The number of reduced values. */
+} t8_forest_reduce_value_t;
+
+/** The first value of \ref t8_forest_reduce_value_t that is maximized. */
+#define T8_FOREST_REDUCE_FIRST_MAX T8_FOREST_REDUCE_MAX_LEVEL
+
+/** A batch of global reductions that are performed with one collective. */
+typedef struct t8_forest_reduce
+{
+  t8_gloidx_t         local[T8_FOREST_REDUCE_COUNT]; /**< The process local values, set by the user. */
+  t8_gloidx_t         global[T8_FOREST_REDUCE_COUNT]; /**< The reduced values. */
+  sc_MPI_Request      request; /**< The request of a non-blocking reduction. */
+} t8_forest_reduce_t;
+
+/** Set all local values of a reduction to zero.
+ * \param [out] reduce    The reduction.
+ */
+void                t8_forest_reduce_init (t8_forest_reduce_t * reduce);
+
+/** Reduce the local values of all processes with one collective.
+ * Each scalar reduction of a commit stage costs the latency of a global
+ * collective, which dominates on many processes. Thus, all scalars that
+ * are known at the same time should be reduced together.
+ * \param [in,out] reduce  The reduction with the local values set.
+ *                        On output \a global holds the reduced values.
+ * \param [in]     comm    The communicator of the reduction.
+ * \note This function is collective.
+ */
+void                t8_forest_reduce (t8_forest_reduce_t * reduce,
+                                      sc_MPI_Comm comm);
+
+/** Start a non-blocking reduction, such that the reduction can overlap
+ * with local work. The local values must not be changed and the global
+ * values must not be read until \ref t8_forest_reduce_end is called.
+ * \param [in,out] reduce  The reduction with the local values set.
+ * \param [in]     comm    The communicator of the reduction.
+ * \note This function is collective.
+ */
+void                t8_forest_reduce_begin (t8_forest_reduce_t * reduce,
+                                            sc_MPI_Comm comm);
+
+/** Complete a reduction started with \ref t8_forest_reduce_begin.
+ * \param [in,out] reduce  The reduction.
+ *                        On output \a global holds the reduced values.
+ */
+void                t8_forest_reduce_end (t8_forest_reduce_t * reduce);
+
 /** After allocating and adding properties to a forest, commit the changes.
  * This call sets up the internal state of the forest.
  * \param [in,out] forest       Must be created with \ref t8_forest_init and
@@ -383,6 +1511,34 @@ void                t8_forest_comm_global_num_elements (t8_forest_t forest);
  */
 void                t8_forest_commit (t8_forest_t forest);
 
+/** Store the elements of all local trees of a committed forest in compressed
+ * form. Each element is replaced by its linear id at the maxlevel of
+ * the forest and its level, packed into a 64 bit integer.
+ * This reduces the memory per element to 8 bytes at the cost of decoding
+ * the elements when they are accessed.
+ * The elements of a tree are decoded on demand by \ref t8_forest_get_element,
+ * \ref t8_forest_get_element_in_tree and
+ * \ref t8_forest_get_tree_element_array. A forest derived from a
+ * compressed forest decompresses it in \ref t8_forest_commit.
+ * The ghost elements are not compressed.
+ * \param [in,out] forest       A committed forest.
+ * \see t8_element_array_pack
+ */
+void                t8_forest_compress (t8_forest_t forest);
+
+/** Restore the elements of all local trees of a compressed forest.
+ * \param [in,out] forest       A committed forest.
+ * \see t8_forest_compress
+ */
+void                t8_forest_decompress (t8_forest_t forest);
+
+/** Query whether a forest stores some of its elements in compressed form.
+ * \param [in]     forest       A committed forest.
+ * \return                      True if \ref t8_forest_compress was called
+ *                              and some trees were not yet decompressed.
+ */
+int                 t8_forest_is_compressed (t8_forest_t forest);
+
 /** Return the maximum allowed refinement level for any element in a forest.
  * \param [in]  forest    A forest.
  * \return                The maximum level of refinement that is allowed for
@@ -419,6 +1575,164 @@ t8_gloidx_t         t8_forest_get_global_num_elements (t8_forest_t forest);
  */
 t8_locidx_t         t8_forest_get_num_ghosts (t8_forest_t forest);
 
+/** Return the number of ghost layers of a forest.
+ * \param [in]      forest      The forest.
+ * \return                      The number of ghost layers in the ghost structure
+ *                              of \a forest. 0 if no ghosts were constructed.
+ *                              \see t8_forest_set_ghost_depth
+ * \a forest must be committed before calling this function.
+ */
+int                 t8_forest_get_num_ghost_layers (t8_forest_t forest);
+
+/** Return the layer of a ghost element.
+ * The ghosts of layer 1 are face neighbors of local elements, the ghosts of
+ * layer k > 1 are face neighbors of ghosts of layer k - 1 that are not in
+ * a smaller layer.
+ * \param [in]      forest      The forest.
+ * \param [in]      lghost      The index of a ghost element,
+ *                              0 <= \a lghost < number of ghosts.
+ * \return                      The layer of the ghost, between 1 and
+ *                              \ref t8_forest_get_num_ghost_layers.
+ * \a forest must be committed before calling this function.
+ */
+int                 t8_forest_get_ghost_layer (t8_forest_t forest,
+                                               t8_locidx_t lghost);
+
+/** Return the number of ghosts that precede the local elements in the
+ * order of the space-filling curve.
+ * These are the ghosts of the processes with smaller rank, which are the
+ * first ghosts in the ghost numbering.
+ * \param [in]      forest      The forest.
+ * \return                      The number of ghosts before the first local
+ *                              element. 0 if no ghosts were constructed.
+ * \a forest must be committed before calling this function.
+ */
+t8_locidx_t         t8_forest_get_num_ghosts_before (t8_forest_t forest);
+
+/** Compute the order of the local elements and the ghosts along the
+ * space-filling curve.
+ * In the canonical numbering of element data, index i < num_local is the
+ * local element i and index num_local + g is the ghost g. In the SFC order
+ * the local elements and ghosts are merged as in the global order of the
+ * forest, such that the ghosts of smaller ranks precede the local elements.
+ * Element data laid out in this order stores the ghosts next to the
+ * elements of the tree they belong to.
+ * \param [in]      forest       The forest.
+ * \param [out]     sfc_to_index If not NULL, an array of length
+ *                               num_local + num_ghosts. On output entry k is
+ *                               the canonical index of the k-th element in
+ *                               SFC order.
+ * \param [out]     index_to_sfc If not NULL, an array of length
+ *                               num_local + num_ghosts. On output entry i is
+ *                               the position in SFC order of the element
+ *                               with canonical index i.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_element_data_to_sfc_order
+ */
+void                t8_forest_get_sfc_order (t8_forest_t forest,
+                                             t8_locidx_t * sfc_to_index,
+                                             t8_locidx_t * index_to_sfc);
+
+/** Reorder element data from the canonical numbering to the SFC order of
+ * \ref t8_forest_get_sfc_order.
+ * Since the reordering only moves the ghosts of smaller ranks in front of
+ * the local elements, it is done with three memcpy.
+ * \param [in]      forest       The forest.
+ * \param [in]      element_data An array of length num_local + num_ghosts in
+ *                               the canonical numbering.
+ * \param [in,out]  sfc_data     An array with the same element size and
+ *                               count as \a element_data. On output the
+ *                               entries of \a element_data in SFC order.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_element_data_to_sfc_order (t8_forest_t forest,
+                                                         const sc_array_t *
+                                                         element_data,
+                                                         sc_array_t *
+                                                         sfc_data);
+
+/** Reorder element data from the SFC order of \ref t8_forest_get_sfc_order
+ * to the canonical numbering.
+ * This is the inverse of \ref t8_forest_element_data_to_sfc_order.
+ * \param [in]      forest       The forest.
+ * \param [in]      sfc_data     An array of length num_local + num_ghosts in
+ *                               SFC order.
+ * \param [in,out]  element_data An array with the same element size and
+ *                               count as \a sfc_data. On output the
+ *                               entries of \a sfc_data in the canonical
+ *                               numbering.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_element_data_from_sfc_order (t8_forest_t
+                                                           forest,
+                                                           const sc_array_t *
+                                                           sfc_data,
+                                                           sc_array_t *
+                                                           element_data);
+
+/** Return the runs of unchanged, refined and coarsened elements that the
+ * adaptation of a forest has recorded.
+ * The runs cover all local elements of the forest and of the forest that it
+ * was adapted from and are sorted by their element indices.
+ * \param [in]      forest    A committed forest.
+ * \param [out]     num_runs  On output the number of runs.
+ * \return          The array of \a num_runs runs, which is valid as long as
+ *                  \a forest is. NULL if no runs were recorded.
+ * \see t8_forest_set_adapt_record_runs
+ */
+const t8_forest_adapt_run_t *t8_forest_get_adapt_runs (t8_forest_t forest,
+                                                       t8_locidx_t *
+                                                       num_runs);
+
+/** Add an element data field to a forest.
+ * The field has one entry per local element followed by one entry per ghost.
+ * It is carried along when a forest is derived from \a forest:
+ * A copied, balanced or partitioned forest has the same entries for the same
+ * elements, an adapted forest has the entries computed by \a refine and
+ * \a coarsen, and the ghost entries of the new forest are exchanged once
+ * for all fields at commit.
+ * \param [in,out] forest   A committed forest.
+ * \param [in]     size     The number of bytes of an entry.
+ * \param [in]     refine   Interpolation to the children of a refined element.
+ *                          If NULL, the entry of the element is copied.
+ * \param [in]     coarsen  Restriction to the parent of a coarsened family.
+ *                          If NULL, the entry of the first sibling is copied.
+ * \param [in]     user     Passed to \a refine and \a coarsen.
+ * \return                  The id of the field, whose entries are set to zero.
+ * \note Adapting a forest with fields records its adapt runs internally,
+ * see \ref t8_forest_get_adapt_runs.
+ */
+int                 t8_forest_data_add_field (t8_forest_t forest,
+                                              size_t size,
+                                              t8_forest_data_refine_t refine,
+                                              t8_forest_data_coarsen_t
+                                              coarsen, void *user);
+
+/** Return the number of element data fields of a forest.
+ * \param [in]      forest    A forest.
+ * \return                    The number of fields added with
+ *                            \ref t8_forest_data_add_field or taken over
+ *                            from the forest it was derived from.
+ */
+int                 t8_forest_data_get_num_fields (t8_forest_t forest);
+
+/** Return the entries of an element data field.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      field     The id of a field.
+ * \return                    The entries of the local elements followed by
+ *                            the entries of the ghosts. The pointer is valid
+ *                            as long as \a forest is.
+ */
+void               *t8_forest_data_get_field (t8_forest_t forest, int field);
+
+/** Update the ghost entries of all element data fields of a forest with the
+ * entries of the local elements on the owning processes.
+ * \param [in,out]  forest    A committed forest.
+ * \note This function is collective and hence must be called by all processes
+ * in the forest's MPI Communicator.
+ */
+void                t8_forest_data_exchange_ghosts (t8_forest_t forest);
+
 /** Return the element class of a forest local tree.
  *  \param [in] forest    The forest.
  *  \param [in] ltreeid   The local id of a tree in \a forest.
@@ -490,7 +1804,10 @@ t8_ctree_t          t8_forest_get_coarse_tree (t8_forest_t forest,
  *                        otherwise.
  * \note If there are no face neighbors, then *neighbor_leafs = NULL, num_neighbors = 0,
  * and *pelement_indices = NULL on output.
- * \note Currently \a forest must be balanced.
+ * \note If \a forest_is_balanced is false, the neighbor leafs may have any level
+ * and are searched in the leaf arrays of the neighbor tree. They are ordered
+ * with the local leafs first. In parallel the ghost layer must have been created
+ * with an algorithm that supports unbalanced forests, \see t8_forest_set_ghost_ext.
  * \note \a forest must be committed before calling this function.
  */
 void                t8_forest_leaf_face_neighbors (t8_forest_t forest,
@@ -507,6 +1824,86 @@ void                t8_forest_leaf_face_neighbors (t8_forest_t forest,
                                                    pneigh_scheme,
                                                    int forest_is_balanced);
 
+/** Return the orientation of the connection of a leaf to its neighbors
+ * across a face.
+ * \param [in]    forest  A committed forest.
+ * \param [in]    ltreeid A local tree id.
+ * \param [in]    leaf    A leaf in tree \a ltreeid of \a forest.
+ * \param [in]    face    A face of \a leaf.
+ * \return                The orientation of the tree face connection across
+ *                        \a face, \see t8_cmesh_get_face_neighbor.
+ *                        0 if the face is inside the tree or on the domain
+ *                        boundary.
+ */
+int                 t8_forest_leaf_face_orientation (t8_forest_t forest,
+                                                     t8_locidx_t ltreeid,
+                                                     const t8_element_t *
+                                                     leaf, int face);
+
+/** Create a workspace for \ref t8_forest_leaf_face_neighbors_workspace.
+ * The workspace can be used for all forests with the same scheme as
+ * \a forest.
+ * \param [in]    forest  A committed forest.
+ * \return                A new workspace. Free it with
+ *                        \ref t8_forest_face_neighbor_workspace_destroy.
+ */
+t8_forest_face_neighbor_workspace_t
+t8_forest_face_neighbor_workspace_new (t8_forest_t forest);
+
+/** Destroy a workspace for leaf face neighbor queries.
+ * \param [in,out] pworkspace The workspace. Set to NULL on output.
+ */
+void                t8_forest_face_neighbor_workspace_destroy
+  (t8_forest_face_neighbor_workspace_t * pworkspace);
+
+/** Compute the leaf face neighbors of a forest without heap allocations.
+ * This function computes the same as \ref t8_forest_leaf_face_neighbors,
+ * but stores the result in \a workspace instead of newly allocated arrays.
+ * The output is valid until the next call with the same workspace and must
+ * not be freed.
+ * \param [in]    forest  The forest. Must have a valid ghost layer.
+ * \param [in]    ltreeid A local tree id.
+ * \param [in]    leaf    A leaf in tree \a ltreeid of \a forest.
+ * \param [in]    face    The index of the face across which the face neighbors
+ *                        are searched.
+ * \param [in,out] workspace A workspace created for the scheme of \a forest.
+ * \param [out]   pneighbor_leafs If not NULL, on output the neighbor leafs.
+ * \param [out]   dual_faces If not NULL, on output the face id's of the
+ *                        neighboring elements' faces.
+ * \param [out]   pelement_indices If not NULL, on output the element indices
+ *                        of the neighbor leafs,
+ *                        \see t8_forest_leaf_face_neighbors.
+ * \param [out]   pneigh_scheme If not NULL, on output the eclass scheme of the
+ *                        neighbor elements.
+ * \param [in]    forest_is_balanced True if we know that \a forest is balanced,
+ *                        false otherwise.
+ * \return                The number of neighbor leafs.
+ * \note If \a forest_is_balanced is false, the neighbors are searched as in
+ * \ref t8_forest_leaf_face_neighbors and the buffers of \a workspace grow
+ * with the largest number of neighbors of a face.
+ */
+int                 t8_forest_leaf_face_neighbors_workspace (t8_forest_t
+                                                             forest,
+                                                             t8_locidx_t
+                                                             ltreeid,
+                                                             const
+                                                             t8_element_t *
+                                                             leaf, int face,
+                                                             t8_forest_face_neighbor_workspace_t
+                                                             workspace,
+                                                             t8_element_t
+                                                             ***
+                                                             pneighbor_leafs,
+                                                             const int
+                                                             **dual_faces,
+                                                             const
+                                                             t8_locidx_t **
+                                                             pelement_indices,
+                                                             t8_eclass_scheme_c
+                                                             ** pneigh_scheme,
+                                                             int
+                                                             forest_is_balanced);
+
 /** Exchange ghost information of user defined element data.
  * \param[in] forest       The forest. Must be committed.
  * \param[in] element_data An array of length num_local_elements + num_ghosts
@@ -516,13 +1913,233 @@ void                t8_forest_leaf_face_neighbors (t8_forest_t forest,
  *                         the corresponding owning process.
  * \note This function is collective and hence must be called by all processes in the forest's
  *       MPI Communicator.
+ * \see t8_forest_ghost_exchange_begin for a non-blocking version.
  */
-/* TODO: In \ref t8_forest_ghost_cxx we already implemented a begin and end function
- *       that allow for overlapping communication and computation. We will make them
- *       available in this interface in the future. */
 void                t8_forest_ghost_exchange_data (t8_forest_t forest,
                                                    sc_array_t * element_data);
 
+/** Exchange ghost information of user defined element data only for the
+ * ghosts in the first layers of a multi-layer ghost structure.
+ * Only the entries of the ghosts whose layer is at most \a max_layer are
+ * updated, the other ghost entries are not changed.
+ * Thus, a stencil that only needs the first layers does not have to
+ * communicate the data of the whole ghost structure.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] element_data An array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data.
+ * \param[in] max_layer    The maximum layer of the ghosts that are updated.
+ *                         Must be positive.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \see t8_forest_set_ghost_depth
+ */
+void                t8_forest_ghost_exchange_data_layers (t8_forest_t forest,
+                                                          sc_array_t *
+                                                          element_data,
+                                                          int max_layer);
+
+/** Exchange ghost information of user defined element data only for the
+ * elements whose refinement level lies in a given range.
+ * Only the entries of the ghosts with level in [\a min_level, \a max_level]
+ * are updated, the other ghost entries are not changed.
+ * A local time stepping scheme can thus communicate only the data of the
+ * level group that advances in the current substep.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] element_data An array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data.
+ * \param[in] min_level    The minimum level of the updated ghosts.
+ * \param[in] max_level    The maximum level of the updated ghosts.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ */
+void                t8_forest_ghost_exchange_data_levels (t8_forest_t forest,
+                                                          sc_array_t *
+                                                          element_data,
+                                                          int min_level,
+                                                          int max_level);
+
+/** Exchange ghost information of multiple user defined element data arrays.
+ * This has the same effect as calling \ref t8_forest_ghost_exchange_data for
+ * each field, but the data of all fields is packed into one message per remote
+ * process. In the message the data of each field is stored contiguously, such
+ * that the received ghost entries are copied with one memcpy per field and
+ * remote process.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] num_fields   The number of fields.
+ * \param[in,out] fields   Array of \a num_fields element data arrays.
+ *                         Each is an array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data. The element sizes
+ *                         of the fields may differ.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \note This function always communicates with MPI messages, also if
+ * \ref t8_forest_set_ghost_shmem or \ref t8_forest_set_ghost_rma is set.
+ */
+void                t8_forest_ghost_exchange_data_fields (t8_forest_t forest,
+                                                          int num_fields,
+                                                          sc_array_t **
+                                                          fields);
+
+/** Exchange ghost information of user defined element data that is stored in
+ * user owned memory with a fixed stride.
+ * This has the same effect as \ref t8_forest_ghost_exchange_data, but
+ * the data of the local elements is read directly from \a local_data and
+ * the data of the ghosts is written directly to \a ghost_data, such that
+ * no intermediate sc_array_t is needed.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] local_data   The data of the local elements. The data of local element
+ *                         i starts at byte i * \a stride.
+ * \param[in,out] ghost_data The data of the ghosts. The data of ghost i starts at
+ *                         byte i * \a stride. On output the first \a elem_size
+ *                         bytes of each ghost entry are updated. May point into
+ *                         the same buffer as \a local_data, for example at
+ *                         local_data + num_local_elements * stride.
+ * \param[in] elem_size    The number of bytes that are exchanged per element.
+ * \param[in] stride       The distance in bytes of two consecutive entries.
+ *                         Must be at least \a elem_size. Padding bytes between the
+ *                         entries are neither sent nor modified.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \note This function always communicates with MPI messages, also if
+ * \ref t8_forest_set_ghost_shmem or \ref t8_forest_set_ghost_rma is set.
+ */
+void                t8_forest_ghost_exchange_data_strided (t8_forest_t
+                                                           forest,
+                                                           const void
+                                                           *local_data,
+                                                           void *ghost_data,
+                                                           size_t elem_size,
+                                                           size_t stride);
+
+/** Compute the indices of the local elements whose data is sent in a ghost
+ * data exchange, in the order in which \ref t8_forest_ghost_exchange_packed
+ * expects them in its send buffer.
+ * These indices can be computed once per forest and used to pack the send
+ * buffer outside of t8code, for example with a kernel on a GPU.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in,out] send_indices An initialized array of t8_locidx_t.
+ *                         On output it is resized and stores in position i the
+ *                         local index of the element whose data is the i-th
+ *                         entry of the send buffer. An element may occur
+ *                         multiple times if it is a ghost of several processes.
+ */
+void                t8_forest_ghost_exchange_send_indices (t8_forest_t
+                                                           forest,
+                                                           sc_array_t *
+                                                           send_indices);
+
+/** Exchange ghost information of user defined element data from an already
+ * packed send buffer.
+ * The send buffer must store the data of the elements given by
+ * \ref t8_forest_ghost_exchange_send_indices in that order. The ghost data is
+ * received directly into \a ghost_data, which hence does not need to be unpacked.
+ * Both buffers are only passed to MPI and never accessed by t8code.
+ * With a CUDA-aware MPI they may thus be device pointers, such that only the
+ * ghost boundary data is communicated and no host staging is necessary.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in] send_buffer  The packed data. Must have space for
+ *                         elem_count of the send indices times \a elem_size bytes.
+ * \param[in,out] ghost_data The data of the ghosts, contiguously with \a elem_size
+ *                         bytes per ghost. On output the ghost entries are updated.
+ * \param[in] elem_size    The number of bytes per element.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \note This function always communicates with MPI messages, also if
+ * \ref t8_forest_set_ghost_shmem or \ref t8_forest_set_ghost_rma is set.
+ */
+void                t8_forest_ghost_exchange_packed (t8_forest_t forest,
+                                                     const void *send_buffer,
+                                                     void *ghost_data,
+                                                     size_t elem_size);
+
+/** Start a non-blocking exchange of ghost information of user defined element data.
+ * The data of the local elements is copied to send buffers before this function
+ * returns. Thus, the entries of the local elements may be changed afterwards,
+ * for example while computing on the interior elements, unless
+ * \ref t8_forest_set_ghost_zero_copy is set.
+ * The entries of the ghost elements are only valid after
+ * \ref t8_forest_ghost_exchange_end returned.
+ * \param[in] forest       The forest. Must be committed.
+ * \param[in,out] element_data An array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data.
+ *                         It must not be resized or freed until the exchange is ended.
+ * \return                 A handle of the exchange that must be passed to
+ *                         \ref t8_forest_ghost_exchange_end. May be NULL if this
+ *                         process has no ghosts.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator. If several exchanges are in progress at the same time, all
+ *       processes must begin and end them in the same order.
+ */
+t8_ghost_exchange_t t8_forest_ghost_exchange_begin (t8_forest_t forest,
+                                                    sc_array_t *
+                                                    element_data);
+
+/** Wait for a ghost data exchange to finish.
+ * After this function returned, the entries of the ghost elements in the
+ * element data array of \ref t8_forest_ghost_exchange_begin are updated.
+ * If profiling is enabled for the forest, the time spent in this function
+ * is stored as ghost exchange waittime.
+ * \param[in,out] pexchange The handle returned by \ref t8_forest_ghost_exchange_begin.
+ *                         It is freed and set to NULL.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \see t8_forest_profile_get_ghostexchange_waittime
+ */
+void                t8_forest_ghost_exchange_end (t8_ghost_exchange_t *
+                                                  pexchange);
+
+/** Create a plan for repeated ghost data exchanges of one element data array.
+ * The plan stores preallocated send buffers and persistent MPI requests and
+ * uses the runs of local elements that each remote process needs. The ghost
+ * entries are received directly into \a element_data.
+ * Each exchange with \ref t8_forest_ghost_exchange_plan_start and
+ * \ref t8_forest_ghost_exchange_plan_wait then only packs the send buffers
+ * and starts and completes the requests.
+ * \param[in] forest       The forest. Must be committed and stay valid as long as
+ *                         the plan exists. The plan must be recreated when
+ *                         the forest changes, for example after adapt.
+ * \param[in,out] element_data An array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data.
+ *                         It must not be resized or freed as long as the plan exists.
+ * \return                 The plan. Must be destroyed with
+ *                         \ref t8_forest_ghost_exchange_plan_destroy.
+ * \note This function is collective and hence must be called by all processes in the forest's
+ *       MPI Communicator.
+ * \note A plan always communicates with MPI messages, also if
+ * \ref t8_forest_set_ghost_shmem or \ref t8_forest_set_ghost_rma is set.
+ */
+t8_ghost_exchange_plan_t t8_forest_ghost_exchange_plan_new (t8_forest_t
+                                                            forest,
+                                                            sc_array_t *
+                                                            element_data);
+
+/** Start a ghost data exchange with a plan.
+ * The entries of the local elements are packed before this function returns
+ * and may be changed afterwards, unless \ref t8_forest_set_ghost_zero_copy
+ * was set for the forest of the plan.
+ * \param[in,out] plan     A plan that is not started.
+ * \note This function is collective.
+ */
+void                t8_forest_ghost_exchange_plan_start
+  (t8_ghost_exchange_plan_t plan);
+
+/** Wait for a ghost data exchange with a plan to finish.
+ * Afterwards the ghost entries of the plan's element data are updated and
+ * the plan can be started again.
+ * If profiling is enabled for the forest, the time spent in this function
+ * is stored as ghost exchange waittime.
+ * \param[in,out] plan     A started plan.
+ * \note This function is collective.
+ */
+void                t8_forest_ghost_exchange_plan_wait
+  (t8_ghost_exchange_plan_t plan);
+
+/** Destroy a ghost data exchange plan and free its requests and buffers.
+ * \param[in,out] pplan    The plan. It must not be started. Set to NULL on output.
+ */
+void                t8_forest_ghost_exchange_plan_destroy
+  (t8_ghost_exchange_plan_t * pplan);
+
 /** Enable or disable profiling for a forest. If profiling is enabled, runtimes
  * and statistics are collected during forest_commit.
  * \param [in,out] forest        The forest to be updated.
@@ -544,6 +2161,50 @@ void                t8_forest_set_profiling (t8_forest_t forest,
  */
 void                t8_forest_print_profile (t8_forest_t forest);
 
+/** The file formats of \ref t8_forest_write_profile. */
+typedef enum
+{
+  T8_FOREST_PROFILE_CSV = 0,    /**< One line name,min,average,max,min_rank,max_rank per statistic. */
+  T8_FOREST_PROFILE_JSON        /**< One object with the members min, average, max, min_rank and max_rank per statistic. */
+} t8_forest_profile_format_t;
+
+/** Write the collected statistics from a forest profile to a file.
+ * The statistics are reduced over the processes of the forest. For each
+ * statistic its minimum, average and maximum together with the ranks of
+ * the minimum and maximum are written.
+ * Next to the totals of \ref t8_forest_print_profile the runtime, the number
+ * of calls, the bytes communicated and the hardware counters of each phase of
+ * adapt, partition, balance and ghost are written. Phases are named by their
+ * path, for example "ghost/receive/parse/runtime".
+ * This function is collective and rank 0 writes the file.
+ * \param [in]    forest        The forest.
+ * \param [in]    filename      The name of the file to be written.
+ * \param [in]    format        The format of the file.
+ * \return                      True if successful, false if the file could
+ *                              not be written. False only on rank 0.
+ * \a forest must be committed before calling this function.
+ * Processes on which profiling is disabled contribute zeros.
+ * \see t8_forest_set_profiling
+ * \see t8_forest_profile_set_counters
+ */
+int                 t8_forest_write_profile (t8_forest_t forest,
+                                             const char *filename,
+                                             t8_forest_profile_format_t format);
+
+/** Enable or disable the hardware counters of the forest profiles.
+ * If enabled, the cycles and the last level cache misses of this process are
+ * counted during each profiled phase of a forest that has profiling enabled.
+ * The counters are global to the process and count the threads that are
+ * created after enabling them.
+ * \param [in]    enable        If true, the counters are enabled, if false
+ *                              disabled.
+ * \return                      True if the counters are enabled. If the
+ *                              system does not provide them, false.
+ * The counters are disabled by default.
+ * \see t8_forest_write_profile
+ */
+int                 t8_forest_profile_set_counters (int enable);
+
 /** Get the runtime of the last call to \ref t8_forest_adapt.
  * \param [in]   forest         The forest.
  * \return                      The runtime of adapt if profiling was activated.
@@ -595,7 +2256,8 @@ double              t8_forest_profile_get_ghost_time (t8_forest_t forest,
                                                       t8_locidx_t *
                                                       ghosts_sent);
 
-/** Get the waittime of the last call to \ref t8_forest_ghost_exchange_data.
+/** Get the waittime of the last call to \ref t8_forest_ghost_exchange_data
+ * or \ref t8_forest_ghost_exchange_end.
  * \param [in]   forest         The forest.
  * \return                      The time of ghost_exchange_data that was spent waiting
  *                              for other MPI processes, if profiling was activated.
@@ -607,11 +2269,53 @@ double              t8_forest_profile_get_ghost_time (t8_forest_t forest,
 double              t8_forest_profile_get_ghostexchange_waittime (t8_forest_t
                                                                   forest);
 
+/** Get the high-water mark of the memory used in the last call to \ref t8_forest_commit.
+ * The memory is measured after each phase of commit, that is adapt, partition,
+ * balance and ghost, as the sum of the forest under construction and the forest
+ * it is derived from. Intermediate forests of commit are included.
+ * \param [in]   forest         The forest.
+ * \return                      The maximum number of bytes of the forests on this
+ *                              process if profiling was activated. 0 otherwise.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_set_profiling
+ * \see t8_forest_memory_usage
+ */
+size_t              t8_forest_profile_get_memory_high_water (t8_forest_t
+                                                             forest);
+
+/** Get the runtime imbalance on which the last partition was based.
+ * \param [in]   forest         The forest.
+ * \return                      The imbalance of the cost model's last fit
+ *                              if profiling was activated and the forest was
+ *                              partitioned with \ref t8_forest_set_partition_cost_model.
+ *                              0 otherwise.
+ * \a forest must be committed before calling this function.
+ * \see t8_forest_cost_model_fit
+ */
+double              t8_forest_profile_get_partition_imbalance (t8_forest_t
+                                                               forest);
+
+/** Compute the number of bytes that a forest occupies on this process.
+ * Shared memory arrays are counted on each process that accesses them, elements
+ * that are mapped from a file with the length of their mapping.
+ * The coarse mesh and the eclass schemes are not included.
+ * \param [in]   forest         The forest.
+ * \param [out]  usage          On output the bytes of each component of \a forest.
+ * \a forest must be committed before calling this function.
+ * \see t8_cmesh_memory_usage
+ */
+void                t8_forest_memory_usage (t8_forest_t forest,
+                                            t8_forest_memory_usage_t *
+                                            usage);
+
 /** Print the ghost structure of a forest. Only used for debugging. */
 void                t8_forest_ghost_print (t8_forest_t forest);
 
 /** Change the cmesh associated to a forest to a partitioned cmesh that
  * is partitioned according to the tree distribution in the forest.
+ * If the local trees of the current cmesh already match this distribution
+ * on every process, the cmesh is kept and no communication besides one
+ * reduction takes place.
  * \param [in,out]   forest The forest.
  * \param [in]       comm   The MPI communicator that is used to partition
  *                          and commit the cmesh.
@@ -674,8 +2378,13 @@ t8_tree_t           t8_forest_get_tree (t8_forest_t forest,
                                         t8_locidx_t ltree_id);
 
 /** Return a pointer to the vertex coordinates of a tree.
+ * The vertices of the local and ghost trees are cached together with their
+ * maps, see \ref t8_forest_get_tree_map, such that the coarse mesh is only
+ * searched once per tree and ghost trees are as cheap as local trees.
+ * The cache of the ghost trees is refreshed when the ghost layer is created.
  * \param [in]    forest        The forest.
- * \param [in]    ltreeid       The id of a local tree.
+ * \param [in]    ltreeid       The id of a local tree or the number of local
+ *                              trees plus the id of a ghost tree.
  * \return    If stored, a pointer to the vertex coordinates of \a tree.
  *            If no coordinates for this tree are found, NULL.
  */
@@ -703,13 +2412,40 @@ t8_cmesh_t          t8_forest_get_cmesh (t8_forest_t forest);
  * \param [out]     ltreeid     If not NULL, on output the local tree id of the tree in which the
  *                              element lies in.
  * \return          A pointer to the element. NULL if this element does not exist.
- * \note This function performs a binary search. For constant access, use \ref t8_forest_get_element_in_tree
+ * \note This function performs a binary search, unless the forest has an element index.
+ * For constant access, use \ref t8_forest_get_element_in_tree or \ref t8_forest_set_element_index
  * \a forest must be committed before calling this function.
  */
 t8_element_t       *t8_forest_get_element (t8_forest_t forest,
                                            t8_locidx_t lelement_id,
                                            t8_locidx_t * ltreeid);
 
+/** Look up many elements of the forest by their global index.
+ * For each global element index the local tree, the index within the tree
+ * and the element are returned. Indices of elements that are not local to
+ * this process yield the tree id -1 and a NULL element.
+ * If the forest has an element index, each lookup takes constant time.
+ * \param [in]      forest      The committed forest.
+ * \param [in]      num_ids     The number of indices in \a gelement_ids.
+ * \param [in]      gelement_ids Global element indices.
+ * \param [out]     ltreeids    If not NULL, an array of length \a num_ids
+ *                              that is filled with the local tree ids.
+ * \param [out]     tree_element_ids If not NULL, an array of length
+ *                              \a num_ids that is filled with the index of
+ *                              each element within its tree.
+ * \param [out]     elements    If not NULL, an array of length \a num_ids
+ *                              that is filled with the elements.
+ * \see t8_forest_set_element_index
+ */
+void                t8_forest_get_element_batch (t8_forest_t forest,
+                                                 size_t num_ids,
+                                                 const t8_gloidx_t
+                                                 *gelement_ids,
+                                                 t8_locidx_t * ltreeids,
+                                                 t8_locidx_t *
+                                                 tree_element_ids,
+                                                 t8_element_t ** elements);
+
 /** Return an element of a local tree in a forest.
  * \param [in]      forest      The forest.
  * \param [in]      ltreeid     An id of a local tree in the forest.
@@ -820,8 +2556,127 @@ t8_gloidx_t         t8_forest_element_face_neighbor (t8_forest_t forest,
                                                      neigh_scheme, int face,
                                                      int *neigh_face);
 
-/* TODO: implement */
-void                t8_forest_save (t8_forest_t forest);
+/** Save a forest and optionally fixed size data of its elements to a
+ * checkpoint file. All processes write into the same binary file, using
+ * MPI I/O if t8code was configured with it.
+ * The forest can be restored with \ref t8_forest_set_load on any
+ * number of processes.
+ * This function is collective.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      filename  The name of the file. An existing file is overwritten.
+ * \param [in]      data_size The number of bytes of data per element. May be 0.
+ * \param [in]      data      If \a data_size > 0, an array of
+ *                            \a data_size bytes for each local element.
+ * \return                    True if successful, false if not (on all processes).
+ * \note A compressed forest is decompressed.
+ */
+int                 t8_forest_save (t8_forest_t forest, const char *filename,
+                                    size_t data_size, const void *data);
+
+/** Read the element data of a forest from a checkpoint file.
+ * The forest must have the same elements as the forest that was saved,
+ * for example by loading it from the same file with \ref t8_forest_set_load.
+ * This function is collective.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      filename  The name of the file written by \ref t8_forest_save.
+ * \param [in]      data_size The number of bytes of data per element. Must be
+ *                            the same that was used when saving the forest.
+ * \param [out]     data      An array of \a data_size bytes for each local
+ *                            element. On output the data of the local elements.
+ * \return                    True if successful, false if not (on all processes).
+ */
+int                 t8_forest_load_data (t8_forest_t forest,
+                                         const char *filename,
+                                         size_t data_size, void *data);
+
+/** Save a forest like \ref t8_forest_save, but compress the element data
+ * with a codec.
+ * Each process compresses the data of its local trees in chunks of
+ * consecutive elements of one tree. A table of the chunks is stored in
+ * the file, such that each loading process reads and decompresses only
+ * the chunks of its own elements.
+ * This function is collective.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      filename  The name of the file. An existing file is overwritten.
+ * \param [in]      data_size The number of bytes of data per element. May be 0.
+ * \param [in]      data      If \a data_size > 0, an array of
+ *                            \a data_size bytes for each local element.
+ * \param [in]      codec     The codec, or NULL to store the data uncompressed.
+ *                            Must be the same on all processes.
+ * \return                    True if successful, false if not (on all processes).
+ */
+int                 t8_forest_save_ext (t8_forest_t forest,
+                                        const char *filename,
+                                        size_t data_size, const void *data,
+                                        const t8_forest_codec_t * codec);
+
+/** Read the element data of a forest from a checkpoint file like
+ * \ref t8_forest_load_data, and decompress it with a codec.
+ * This function is collective.
+ * \param [in]      forest    A committed forest.
+ * \param [in]      filename  The name of the file written by \ref t8_forest_save_ext.
+ * \param [in]      data_size The number of bytes of data per element. Must be
+ *                            the same that was used when saving the forest.
+ * \param [out]     data      An array of \a data_size bytes for each local
+ *                            element. On output the data of the local elements.
+ * \param [in]      codec     The codec that was used to save the data.
+ *                            If NULL, data compressed with a built-in codec
+ *                            or uncompressed data can be read.
+ * \return                    True if successful, false if not (on all processes).
+ */
+int                 t8_forest_load_data_ext (t8_forest_t forest,
+                                             const char *filename,
+                                             size_t data_size, void *data,
+                                             const t8_forest_codec_t *
+                                             codec);
+
+/** Initialize the built-in lossless codec for checkpoint data.
+ * The bytes of the elements are shuffled, such that the i-th bytes of all
+ * elements are stored together, and deflated with zlib.
+ * Without zlib, the data is stored shuffled but uncompressed.
+ * \param [out]     codec     The codec.
+ * \param [in]      level     The zlib compression level, between 0 and 9,
+ *                            or -1 for the default.
+ */
+void                t8_forest_codec_lossless (t8_forest_codec_t * codec,
+                                              int level);
+
+/** Initialize the built-in lossy codec for checkpoint data.
+ * The element data must consist of doubles. Each double is quantized to a
+ * multiple of 2 * \a error_bound, and the difference to the same double of
+ * the previous element is compressed with the lossless codec.
+ * Chunks with values that cannot be quantized, such as infinities and NaNs,
+ * are stored lossless.
+ * \param [out]     codec     The codec.
+ * \param [in]      error_bound The maximum absolute error of each double.
+ *                            Must be positive.
+ * \param [in]      level     The zlib compression level, between 0 and 9,
+ *                            or -1 for the default.
+ */
+void                t8_forest_codec_lossy (t8_forest_codec_t * codec,
+                                           double error_bound, int level);
+
+/** Build a new cmesh whose trees are the elements of a forest at a given
+ * level. Each element of this level that contains leaves of \a forest
+ * becomes one tree, with the vertices computed by
+ * \ref t8_forest_element_coordinate and the face connections of the
+ * elements. The trees are numbered in the order of the forest's elements,
+ * so a forest of level 0 on the new cmesh, partitioned uniformly, has the
+ * same elements as the level \a level elements of \a forest.
+ * This can be used to restart a computation on a finer coarse mesh whose
+ * partition has a better granularity.
+ * This function is collective.
+ * \param [in]      forest    A committed forest. All of its leaves must have
+ *                            level at least \a level.
+ * \param [in]      level     The refinement level of the new trees.
+ * \return                    A new replicated cmesh on the communicator
+ *                            of \a forest. It can be partitioned by deriving
+ *                            a cmesh from it.
+ * \note The orientations of face connections are found by comparing the
+ * vertices relative to the face centers. This is correct for conforming
+ * and periodic (translated) faces.
+ */
+t8_cmesh_t          t8_forest_to_cmesh (t8_forest_t forest, int level);
 
 /** Write the forest in a parallel vtu format. There is one master
  * .pvtu file and each process writes in its own .vtu file.
@@ -840,9 +2695,6 @@ void                t8_forest_save (t8_forest_t forest);
 void                t8_forest_write_vtk (t8_forest_t forest,
                                          const char *filename);
 
-/* TODO: implement */
-void                t8_forest_iterate (t8_forest_t forest);
-
 /** Compute the coordinates of a given vertex of an element if the
  * vertex coordinates of the surrounding tree are known.
  * \param [in]      forest     The forest.
@@ -862,6 +2714,622 @@ void                t8_forest_element_coordinate (t8_forest_t forest,
                                                   int corner_number,
                                                   double *coordinates);
 
+/** Map points in reference coordinates of a local tree to physical space.
+ * If the forest has a geometry, it is evaluated once for all points,
+ * otherwise the tree vertices are interpolated as in
+ * \ref t8_forest_element_coordinate.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \param [in]      num_points The number of points.
+ * \param [in]      ref        The reference coordinates in [0,1]^d of the
+ *                             points, stored as consecutive triples.
+ * \param [out]     coordinates On output the physical coordinates of the
+ *                             points. Must not overlap with \a ref.
+ * \param [out]     jacobian   If not NULL, on output the 9 entries of the
+ *                             Jacobian matrix of each point in row major
+ *                             order.
+ *                             This requires a geometry with a batched
+ *                             transformation, see \ref t8_forest_set_geometry.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_tree_map_reference_points (t8_forest_t forest,
+                                                         t8_locidx_t ltreeid,
+                                                         size_t num_points,
+                                                         const double *ref,
+                                                         double *coordinates,
+                                                         double *jacobian);
+
+/** The map from the reference coordinates of a tree to its physical
+ * coordinates that interpolates the tree vertices.
+ * It is written in monomials of the reference coordinates (a, b, c):
+ *  - lines, triangles, tets:
+ *    x = coeff[0] + coeff[1] a + coeff[2] b + coeff[3] c
+ *  - prisms: additionally + (coeff[4] a + coeff[5] b) c
+ *  - quads: x = coeff[0] + coeff[1] a + coeff[2] b + coeff[3] a b
+ *  - hexes: (1 - c) times the quad map plus c times the quad map
+ *    with coeff[4..7]
+ *  - pyramids: the quad map of the projection of (a, b) along the line
+ *    through the apex coeff[4] onto the base, interpolated with the apex.
+ */
+typedef struct t8_forest_tree_map
+{
+  t8_eclass_t         eclass;   /**< The class of the tree. */
+  const double       *vertices; /**< The tree vertices the map was computed from. */
+  double              coeff[8][3]; /**< The coefficients of the map. */
+} t8_forest_tree_map_t;
+
+/** Return the precomputed map from reference to physical coordinates of a
+ * tree.
+ * The maps of all local and ghost trees are computed when the forest is
+ * committed. User kernels can use them with \ref t8_forest_tree_map_apply
+ * to compute coordinates without calling \ref t8_forest_element_coordinate.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest or
+ *                             the number of local trees plus the id of a
+ *                             ghost tree.
+ * \return                     The map of the tree. NULL if the tree has no
+ *                             vertices or the forest has a geometry, see
+ *                             \ref t8_forest_set_geometry.
+ * \a forest must be committed before calling this function.
+ */
+const t8_forest_tree_map_t *t8_forest_get_tree_map (t8_forest_t forest,
+                                                    t8_locidx_t ltreeid);
+
+/** Apply the map of a tree to points given in reference coordinates.
+ * \param [in]      map        The map of a tree,
+ *                             see \ref t8_forest_get_tree_map.
+ * \param [in]      num_points The number of points.
+ * \param [in,out]  points     The reference coordinates of the points, stored
+ *                             as consecutive triples. On output their
+ *                             physical coordinates.
+ */
+void                t8_forest_tree_map_apply (const t8_forest_tree_map_t *
+                                              map, size_t num_points,
+                                              double *points);
+
+/** Return the number of corners of all leaf elements of a local tree.
+ * This is the number of points for which \ref t8_forest_tree_element_coordinates
+ * computes coordinates.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \return                     The sum of the numbers of corners of all leaf
+ *                             elements of the tree.
+ * \a forest must be committed before calling this function.
+ */
+t8_locidx_t         t8_forest_get_tree_num_corners (t8_forest_t forest,
+                                                    t8_locidx_t ltreeid);
+
+/** Compute the coordinates of all corners of all leaf elements of a local tree.
+ * The result is the same as calling \ref t8_forest_element_coordinate for each
+ * corner of each element, but the vertices of the tree are only looked up
+ * once and the coordinate map is applied to all corners in one pass.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \param [out]     coordinates On input an allocated array to store
+ *                             3 * \ref t8_forest_get_tree_num_corners doubles.
+ *                             On output the x, y and z coordinates of the corners,
+ *                             ordered by element and for each element by its
+ *                             corner numbers in Z-order.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_tree_element_coordinates (t8_forest_t forest,
+                                                        t8_locidx_t ltreeid,
+                                                        double *coordinates);
+
+/** Compute the physical coordinates of a set of nodes of all leaf elements
+ * of a local tree, for example the Gauss-Lobatto nodes of a DG method.
+ * The nodes are given in the reference coordinates of an element, that is
+ * in the reference cube [0,1]^d for quads and hexes and in the reference
+ * simplex with vertices (0,0,0), (1,0,0), (1,0,1) and (1,1,1) for tets
+ * and (0,0), (1,0), (1,1) for triangles, such that the reference corners
+ * are mapped to the corners of \ref t8_forest_element_coordinate.
+ * In pyramid trees the same nodes are used for pyramid and tet elements.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \param [in]      num_nodes  The number of nodes per element.
+ * \param [in]      ref_nodes  The reference coordinates of the nodes,
+ *                             stored as \a num_nodes consecutive triples.
+ * \param [out]     nodes      An array of 3 * \a num_nodes * n doubles,
+ *                             where n is the number of elements of the tree.
+ *                             On output coordinate j of node i of element e
+ *                             is stored at 3 * (\a num_nodes * e + i) + j.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_tree_element_nodes (t8_forest_t forest,
+                                                  t8_locidx_t ltreeid,
+                                                  size_t num_nodes,
+                                                  const double *ref_nodes,
+                                                  double *nodes);
+
+/** Compute the physical coordinates of a set of nodes of all local elements.
+ * This is \ref t8_forest_tree_element_nodes for all local trees, such that
+ * the nodes of the local element with index e start at 3 * \a num_nodes * e.
+ * Optionally, the nodes of the elements that did not change since a
+ * previous forest are copied instead of recomputed.
+ * \param [in]      forest     The forest.
+ * \param [in]      num_nodes  The number of nodes per element.
+ * \param [in]      ref_nodes  The reference coordinates of the nodes.
+ * \param [in]      forest_from If not NULL, a forest from which \a forest
+ *                             was adapted, with the same geometry.
+ * \param [in]      nodes_from If \a forest_from is not NULL, the nodes of
+ *                             the local elements of \a forest_from for the
+ *                             same \a ref_nodes.
+ * \param [out]     nodes      An array of 3 * \a num_nodes doubles per
+ *                             local element. On output the nodes.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_element_nodes (t8_forest_t forest,
+                                             size_t num_nodes,
+                                             const double *ref_nodes,
+                                             t8_forest_t forest_from,
+                                             const double *nodes_from,
+                                             double *nodes);
+
+/** Query whether a forest has a geometry cache.
+ * \param [in]      forest     A committed forest.
+ * \return                     True if \ref t8_forest_set_geometry_cache
+ *                             was enabled for \a forest.
+ */
+int                 t8_forest_has_geometry_cache (t8_forest_t forest);
+
+/** Return the cached centroid of a local element.
+ * \param [in]      forest     A committed forest with geometry cache.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \return                     The x, y and z coordinates of the centroid,
+ *                             \see t8_forest_element_centroid.
+ */
+const double       *t8_forest_element_cached_centroid (t8_forest_t forest,
+                                                       t8_locidx_t ltreeid,
+                                                       t8_locidx_t
+                                                       leid_in_tree);
+
+/** Return the cached volume of a local element.
+ * \param [in]      forest     A committed forest with geometry cache.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \return                     The volume of the element,
+ *                             \see t8_forest_element_volume.
+ */
+double              t8_forest_element_cached_volume (t8_forest_t forest,
+                                                     t8_locidx_t ltreeid,
+                                                     t8_locidx_t
+                                                     leid_in_tree);
+
+/** Return the cached area of a face of a local element.
+ * \param [in]      forest     A committed forest with geometry cache.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \param [in]      face       A face of the element.
+ * \return                     The area of the face,
+ *                             \see t8_forest_element_face_area.
+ */
+double              t8_forest_element_cached_face_area (t8_forest_t forest,
+                                                        t8_locidx_t ltreeid,
+                                                        t8_locidx_t
+                                                        leid_in_tree,
+                                                        int face);
+
+/** Return the cached outward pointing normal of a face of a local element.
+ * \param [in]      forest     A committed forest with geometry cache.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \param [in]      face       A face of the element.
+ * \return                     The x, y and z coordinates of the normal,
+ *                             \see t8_forest_element_face_normal.
+ */
+const double       *t8_forest_element_cached_face_normal (t8_forest_t forest,
+                                                          t8_locidx_t
+                                                          ltreeid,
+                                                          t8_locidx_t
+                                                          leid_in_tree,
+                                                          int face);
+
+/** Return the cached centroid of a face of a local element.
+ * \param [in]      forest     A committed forest with geometry cache.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \param [in]      face       A face of the element.
+ * \return                     The x, y and z coordinates of the face centroid,
+ *                             \see t8_forest_element_face_centroid.
+ */
+const double       *t8_forest_element_cached_face_centroid (t8_forest_t
+                                                            forest,
+                                                            t8_locidx_t
+                                                            ltreeid,
+                                                            t8_locidx_t
+                                                            leid_in_tree,
+                                                            int face);
+
+/** Query whether a forest has a face connectivity table.
+ * \param [in]      forest     A committed forest.
+ * \return                     True if \ref t8_forest_set_face_connectivity
+ *                             was enabled for \a forest.
+ */
+int                 t8_forest_has_face_connectivity (t8_forest_t forest);
+
+/** Query whether a forest has a search index.
+ * \param [in]      forest       A committed forest.
+ * \return                     True if \ref t8_forest_set_search_index
+ *                              was called for this forest.
+ */
+int                 t8_forest_has_search_index (t8_forest_t forest);
+
+/** Query whether a forest has an element index.
+ * \param [in]      forest       A committed forest.
+ * \return                     True if \ref t8_forest_set_element_index
+ *                              was enabled for \a forest.
+ */
+int                 t8_forest_has_element_index (t8_forest_t forest);
+
+/** Query whether the leaves of a forest are stored in one allocation.
+ * \param [in]      forest       A committed forest.
+ * \return                     True if \ref t8_forest_set_contiguous_leaves
+ *                              was enabled for \a forest or the forest took
+ *                              over the contiguous leaves of another forest.
+ * \note The trees that are decompressed after \ref t8_forest_compress
+ *       have their own allocations.
+ */
+int                 t8_forest_has_contiguous_leaves (t8_forest_t forest);
+
+/** Query whether a forest has a bounding volume hierarchy.
+ * \param [in]      forest       A committed forest.
+ * \return                     True if \ref t8_forest_set_bvh
+ *                              was enabled for \a forest.
+ */
+int                 t8_forest_has_bvh (t8_forest_t forest);
+
+/** Query whether a forest has a boundary index.
+ * \param [in]      forest       A committed forest.
+ * \return                     True if \ref t8_forest_set_boundary_index
+ *                              was enabled for \a forest.
+ */
+int                 t8_forest_has_boundary_index (t8_forest_t forest);
+
+/** Return the local leaves of a tree that lie at a face of the tree at the
+ * domain boundary.
+ * \param [in]      forest     A committed forest with boundary index.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      tree_face  A face of the tree.
+ * \param [out]     leaves     If not NULL, on output the indices of the
+ *                             leaves in the tree, in ascending order.
+ * \param [out]     faces      If not NULL, on output for each leaf its face
+ *                             that lies at \a tree_face.
+ * \return                     The number of leaves at \a tree_face. 0 if the
+ *                             tree face is connected to another tree.
+ * \note The returned arrays belong to the forest and must not be freed.
+ */
+t8_locidx_t         t8_forest_get_boundary_leaves (t8_forest_t forest,
+                                                   t8_locidx_t ltreeid,
+                                                   int tree_face,
+                                                   const t8_locidx_t **
+                                                   leaves, const int **faces);
+
+/** Find the local elements whose bounding boxes intersect a box.
+ * \param [in]      forest     A committed forest with bounding volume hierarchy.
+ * \param [in]      box        The lower corner of the box in the first
+ *                             and the upper corner in the last 3 entries.
+ * \param [in,out]  elements   An array of \ref t8_locidx_t. On output the
+ *                             local indices of the elements are appended in
+ *                             ascending order.
+ * \note The bounding boxes are those of \ref t8_forest_element_bounding_box,
+ * thus the elements are candidates that may need an exact test.
+ */
+void                t8_forest_bvh_query_box (t8_forest_t forest,
+                                             const double box[6],
+                                             sc_array_t * elements);
+
+/** Find the local elements whose bounding boxes intersect a sphere.
+ * \param [in]      forest     A committed forest with bounding volume hierarchy.
+ * \param [in]      center     The center of the sphere.
+ * \param [in]      radius     The non-negative radius of the sphere.
+ * \param [in,out]  elements   As in \ref t8_forest_bvh_query_box.
+ */
+void                t8_forest_bvh_query_sphere (t8_forest_t forest,
+                                                const double center[3],
+                                                double radius,
+                                                sc_array_t * elements);
+
+/** Find the local elements whose bounding boxes intersect a ray.
+ * The ray consists of the points origin + t * direction with
+ * 0 <= t <= \a length.
+ * \param [in]      forest     A committed forest with bounding volume hierarchy.
+ * \param [in]      origin     The origin of the ray.
+ * \param [in]      direction  The direction of the ray, not necessarily normalized.
+ * \param [in]      length     The non-negative maximum parameter of the ray.
+ * \param [in,out]  elements   As in \ref t8_forest_bvh_query_box.
+ */
+void                t8_forest_bvh_query_ray (t8_forest_t forest,
+                                             const double origin[3],
+                                             const double direction[3],
+                                             double length,
+                                             sc_array_t * elements);
+
+/** Return the cached face neighbors of a local element.
+ * \param [in]      forest     A committed forest with face connectivity.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of an element in the tree.
+ * \param [in]      face       A face of the element.
+ * \param [out]     neighbor_indices If not NULL, on output the local indices
+ *                             of the neighbors. Ghost neighbors have the number
+ *                             of local elements plus their ghost index.
+ * \param [out]     dual_faces If not NULL, on output the face of each
+ *                             neighbor at this face.
+ * \param [out]     orientation If not NULL, on output the orientation of the
+ *                             tree connection across \a face. 0 if the face is
+ *                             inside the tree.
+ * \return                     The number of neighbors across \a face.
+ * \note The returned arrays belong to the forest and must not be freed.
+ */
+int                 t8_forest_element_cached_face_neighbors (t8_forest_t
+                                                             forest,
+                                                             t8_locidx_t
+                                                             ltreeid,
+                                                             t8_locidx_t
+                                                             leid_in_tree,
+                                                             int face,
+                                                             const
+                                                             t8_locidx_t **
+                                                             neighbor_indices,
+                                                             const int
+                                                             **dual_faces,
+                                                             int
+                                                             *orientation);
+
+/** Return the arrays of the face connectivity table of a forest.
+ * The faces of the local element \a i are face_offsets[i], ...,
+ * face_offsets[i + 1] - 1. The neighbors of the face \a f are stored in
+ * neighbor_indices[j] and dual_faces[j] for j = neighbor_offsets[f], ...,
+ * neighbor_offsets[f + 1] - 1. The arrays belong to the forest.
+ * \param [in]      forest     A committed forest with face connectivity.
+ * \param [out]     face_offsets For each local element its first face.
+ * \param [out]     neighbor_offsets For each face its first neighbor.
+ * \param [out]     neighbor_indices For each neighbor its element index,
+ *                             \see t8_forest_element_cached_face_neighbors.
+ * \param [out]     dual_faces For each neighbor its face.
+ * \param [out]     orientations For each face its orientation.
+ * \return                     The number of local elements.
+ */
+t8_locidx_t         t8_forest_get_face_connectivity (t8_forest_t forest,
+                                                     const t8_locidx_t **
+                                                     face_offsets,
+                                                     const t8_locidx_t **
+                                                     neighbor_offsets,
+                                                     const t8_locidx_t **
+                                                     neighbor_indices,
+                                                     const int **dual_faces,
+                                                     const int
+                                                     **orientations);
+
+/** A face between a local element and a face neighbor or the domain boundary.
+ * \see t8_forest_face_list */
+typedef struct t8_forest_face_pair
+{
+  t8_locidx_t         elements[2]; /**< The local element and its neighbor. The neighbor is a local
+                                        index, the number of local elements plus a ghost index,
+                                        or -1 at the domain boundary. */
+  int                 faces[2]; /**< The faces of the elements. faces[1] is -1 at the domain boundary. */
+  int                 subface; /**< -1 if the face of elements[0] is the whole face between the
+                                    elements. Otherwise elements[0] is coarser than the ghost
+                                    elements[1], which is at the face child \a subface of
+                                    elements[0], \see t8_element_children_at_face. */
+} t8_forest_face_pair_t;
+
+/** List the faces of the local elements of a forest, such that a face between
+ * two local elements is listed only once.
+ * An assembly can loop over the list, compute one flux per entry and add it
+ * to both elements. A face between a local element and a ghost is listed on
+ * both processes, with the local element first.
+ * At hanging faces between two local elements, the smaller element is
+ * \a elements[0] and its face is the whole face between the elements.
+ * \param [in]      forest     A committed forest with face connectivity.
+ * \param [in,out]  face_list  An array of \ref t8_forest_face_pair_t.
+ *                             On output it holds the faces sorted by
+ *                             their local element \a elements[0].
+ * \return                     The number of entries of \a face_list.
+ * \see t8_forest_set_face_connectivity
+ */
+t8_locidx_t         t8_forest_face_list (t8_forest_t forest,
+                                         sc_array_t * face_list);
+
+/** The non-conforming faces of a forest in flat arrays.
+ * Mortar i is the face big_faces[i] of the element big_elements[i], which
+ * is covered by the faces small_faces[j] of the smaller elements
+ * small_elements[j] for small_offsets[i] <= j < small_offsets[i + 1].
+ * Elements are given by a local index or by the number of local elements
+ * plus a ghost index.
+ * \see t8_forest_mortars_new */
+typedef struct t8_forest_mortars
+{
+  t8_locidx_t         num_mortars; /**< The number of mortars. */
+  t8_locidx_t        *big_elements; /**< For each mortar its larger element. */
+  int                *big_faces; /**< For each mortar the face of the larger element. */
+  int                *orientations; /**< For each mortar the orientation of the tree face
+                                         connection, 0 inside of a tree. */
+  t8_locidx_t        *small_offsets; /**< For each mortar its first small side,
+                                          num_mortars + 1 entries. */
+  t8_locidx_t        *small_elements; /**< For each small side its element. */
+  int                *small_faces; /**< For each small side the face of its element. */
+  int                *subfaces; /**< For each small side the face child of the big face
+                                     it covers, \see t8_element_children_at_face. */
+} t8_forest_mortars_struct_t;
+
+/** A pointer to the mortars of a forest. */
+typedef t8_forest_mortars_struct_t *t8_forest_mortars_t;
+
+/** Build the mortars of a forest, the faces between a local or ghost element
+ * and the smaller elements at its face children.
+ * A DG solver can build these once per forest and run its mortar kernels
+ * as loops over the arrays instead of querying the neighbors of each
+ * hanging face in each stage.
+ * If the larger element is local, all smaller elements are listed in the
+ * order of the face children, they are local elements or ghosts.
+ * If the larger element is a ghost, only the local smaller elements are
+ * listed, sorted by their face child.
+ * Mortars are sorted by their larger element, first the local elements
+ * then the ghosts.
+ * \param [in]      forest     A committed forest with face connectivity.
+ * \return                     The mortars of \a forest. They stay valid
+ *                             until they are freed with
+ *                             \ref t8_forest_mortars_destroy.
+ * \see t8_forest_set_face_connectivity
+ */
+t8_forest_mortars_t t8_forest_mortars_new (t8_forest_t forest);
+
+/** Free the mortars of a forest.
+ * \param [in,out]  pmortars   Mortars created by \ref t8_forest_mortars_new.
+ *                             Set to NULL on output.
+ */
+void                t8_forest_mortars_destroy (t8_forest_mortars_t *
+                                               pmortars);
+
+/** Export the dual graph of a forest in the distributed compressed sparse row
+ * format of ParMETIS and similar graph partitioners.
+ * The vertices of the graph are the elements with their global ids, two
+ * elements are connected if they share a face. Faces to ghosts are included.
+ * \param [in]      forest     A committed forest with face connectivity.
+ * \param [out]     vtxdist    An array of mpisize + 1 entries. Process p owns
+ *                             the vertices vtxdist[p], ..., vtxdist[p + 1] - 1.
+ * \param [out]     xadj       An array of num_local_elements + 1 entries.
+ *                             The neighbors of local element i are
+ *                             adjncy[xadj[i]], ..., adjncy[xadj[i + 1] - 1].
+ * \param [out]     adjncy     The global ids of the neighbors, sorted for
+ *                             each element.
+ * \param [out]     adjwgt     The number of faces shared with each neighbor,
+ *                             parallel to \a adjncy. May be NULL.
+ * \return                     The number of local elements.
+ * \note The arrays are allocated with T8_ALLOC and must be freed with T8_FREE.
+ * Since \a adjncy and \a adjwgt are allocated for the number of faces, they
+ * may be longer than xadj[num_local_elements].
+ * \note This function is collective.
+ * \see t8_forest_set_face_connectivity
+ */
+t8_locidx_t         t8_forest_dual_graph (t8_forest_t forest,
+                                          t8_gloidx_t ** vtxdist,
+                                          t8_locidx_t ** xadj,
+                                          t8_gloidx_t ** adjncy,
+                                          t8_locidx_t ** adjwgt);
+
+/** Convert an assignment of the local elements to processes, for example
+ * computed from \ref t8_forest_dual_graph by a graph partitioner, into
+ * element offsets for \ref t8_forest_set_partition_offsets.
+ * Since each process holds a contiguous range of the space-filling curve,
+ * each process receives as many elements as are assigned to it, in
+ * space-filling curve order. This is the given assignment if it is monotone
+ * along the curve, otherwise only its load per process is kept.
+ * \param [in]      forest     A committed forest.
+ * \param [in]      assignment For each local element its new process.
+ * \param [out]     offsets    An array of mpisize + 1 entries.
+ * \note This function is collective.
+ */
+void                t8_forest_partition_offsets_from_assignment (t8_forest_t
+                                                                 forest,
+                                                                 const int
+                                                                 *assignment,
+                                                                 t8_gloidx_t
+                                                                 * offsets);
+
+/** Compute the refinement levels of all local elements and ghosts.
+ * \param [in]      forest     A committed forest.
+ * \param [in,out]  levels     An array of length
+ *                             num_local_elements + num_ghosts.
+ *                             On output the level of local element i is
+ *                             levels[i], the level of ghost i is
+ *                             levels[num_local_elements + i].
+ */
+void                t8_forest_element_levels (t8_forest_t forest,
+                                              int8_t * levels);
+
+/** Sort the elements of a local tree by their refinement level.
+ * For local time stepping, where elements of the same level advance with
+ * the same time step, each level can then be processed in one loop.
+ * \param [in]      forest     A committed forest.
+ * \param [in]      ltreeid    A local tree of \a forest.
+ * \param [in,out]  level_offsets  An array of \ref t8_forest_get_maxlevel + 2
+ *                             entries. On output the elements of level l
+ *                             are element_indices[level_offsets[l]] up to
+ *                             element_indices[level_offsets[l + 1] - 1].
+ * \param [in,out]  element_indices  An array with one entry per element of
+ *                             the tree. On output the tree local element
+ *                             indices sorted by level; elements of the
+ *                             same level keep their order.
+ */
+void                t8_forest_tree_elements_by_level (t8_forest_t forest,
+                                                      t8_locidx_t ltreeid,
+                                                      t8_locidx_t *
+                                                      level_offsets,
+                                                      t8_locidx_t *
+                                                      element_indices);
+
+/** Select the faces of a face list where at least one of the two elements
+ * has a refinement level in [\a min_level, \a max_level].
+ * For a local time stepping scheme with level groups, this yields the faces
+ * whose fluxes are needed when the group advances. Faces between two groups
+ * are selected for both groups and can be told apart by the levels of
+ * their elements.
+ * \param [in]      face_list  A face list from \ref t8_forest_face_list.
+ * \param [in]      levels     The levels of the local elements and ghosts
+ *                             as computed by \ref t8_forest_element_levels.
+ * \param [in]      min_level  The minimum level of the group.
+ * \param [in]      max_level  The maximum level of the group.
+ * \param [in,out]  level_face_list  An array of \ref t8_forest_face_pair_t.
+ *                             On output it holds the selected faces in the
+ *                             order of \a face_list.
+ * \return                     The number of entries of \a level_face_list.
+ */
+t8_locidx_t         t8_forest_face_list_levels (sc_array_t * face_list,
+                                                const int8_t * levels,
+                                                int min_level,
+                                                int max_level,
+                                                sc_array_t *
+                                                level_face_list);
+
+/** Create a reusable transfer of element data from one forest to another.
+ * The two forests must be built from the same coarse mesh but may be
+ * refined and partitioned independently, for example a fluid and a
+ * structure solver on the same domain.
+ * Each process intersects the space-filling curve ranges of its elements
+ * in \a forest_from with the ranges of the processes in \a forest_to and
+ * exchanges only with processes whose ranges overlap.
+ * \param [in]  forest_from The committed source forest.
+ * \param [in]  forest_to   The committed target forest. It must have the
+ *                          same MPI communicator and maximum level as
+ *                          \a forest_from.
+ * \return                  The transfer. It stays valid as long as the two
+ *                          forests are not changed and must be destroyed with
+ *                          \ref t8_forest_transfer_destroy.
+ * \note This function is collective.
+ */
+t8_forest_transfer_t t8_forest_transfer_new (t8_forest_t forest_from,
+                                             t8_forest_t forest_to);
+
+/** Transfer element data with a transfer created by
+ * \ref t8_forest_transfer_new.
+ * Each entry is interpreted as an array of doubles and each target value
+ * is the average of the overlapping source values, weighted by the number
+ * of common descendants at the maximum level. Thus a target element inside a
+ * coarser source element gets a copy of the source value and a target element
+ * covering finer source elements gets their mean. For cell averages this is
+ * conservative as long as all elements of a level have equal volume in
+ * the reference tree, which is not the case for pyramids.
+ * \param [in]  transfer    The transfer.
+ * \param [in]  data_from   The data of the local elements of the source forest.
+ *                          Its element size must be a multiple of sizeof (double).
+ * \param [in,out] data_to  An array of the same element size with at least
+ *                          one entry per local element of the target forest.
+ *                          On output these entries hold the transferred data.
+ * \note This function is collective.
+ */
+void                t8_forest_transfer_data (t8_forest_transfer_t transfer,
+                                             sc_array_t *data_from,
+                                             sc_array_t *data_to);
+
+/** Destroy a forest data transfer.
+ * \param [in,out] ptransfer The transfer. Set to NULL on output.
+ */
+void                t8_forest_transfer_destroy (t8_forest_transfer_t
+                                                *ptransfer);
+
 /** Compute the coordinates of the centroid of an element if the
  * vertex coordinates of the surrounding tree are known.
  * The centroid is the sum of all corner vertices divided by the number of corners.
@@ -912,6 +3380,36 @@ double              t8_forest_element_volume (t8_forest_t forest,
                                               const t8_element_t * element,
                                               const double *vertices);
 
+/** Compute the centroids of all elements of a local tree.
+ * The result is the same as calling \ref t8_forest_element_centroid for
+ * each element, but the arithmetic is done on all elements at once.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \param [out]     centroids  An array of 3 * n doubles, where n is the
+ *                             number of elements of the tree. On output the
+ *                             x, y and z coordinates of the centroid of
+ *                             the i-th element are stored at 3 * i.
+ * \a forest must be committed when calling this function.
+ */
+void                t8_forest_tree_element_centroids (t8_forest_t forest,
+                                                      t8_locidx_t ltreeid,
+                                                      double *centroids);
+
+/** Compute the volumes of all elements of a local tree.
+ * The result is the same as calling \ref t8_forest_element_volume for
+ * each element. For triangle, quad, tet and hex trees the arithmetic is
+ * done on all elements at once.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The local id of a local tree of \a forest.
+ * \param [out]     volumes    An array of n doubles, where n is the number
+ *                             of elements of the tree. On output the
+ *                             volumes of the elements.
+ * \a forest must be committed when calling this function.
+ */
+void                t8_forest_tree_element_volumes (t8_forest_t forest,
+                                                    t8_locidx_t ltreeid,
+                                                    double *volumes);
+
 /** Compute the area of an element's face.
  * Currently implemented for 2D elements only.
  * \param [in]      forest     The forest.
@@ -975,6 +3473,9 @@ void                t8_forest_element_face_normal (t8_forest_t forest,
  *                  The return value is also true if the point lies on the element boundary.
  *                  Thus, this function may return true for different leaf elements, if they
  *                  are neighbors and the point lies on the common boundary.
+ * \note Points outside the bounding box of the tree (\ref t8_forest_tree_bounding_box)
+ *       or of the element (\ref t8_forest_element_bounding_box), enlarged by \a tolerance,
+ *       are rejected before the exact test is carried out.
  */
 int                 t8_forest_element_point_inside (t8_forest_t forest,
                                                     t8_locidx_t ltreeid,
@@ -985,6 +3486,78 @@ int                 t8_forest_element_point_inside (t8_forest_t forest,
                                                     const double point[3],
                                                     const double tolerance);
 
+/** Query for many points at once whether they lie inside an element.
+ * The result is the same as calling \ref t8_forest_element_point_inside
+ * for each point, but the bounding box of the element and, for volume
+ * elements, its face normals are only computed once.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The forest local id of the tree in which the element is.
+ * \param [in]      element    The element.
+ * \param [in]      tree_vertices An array storing the vertex coordinates of the tree.
+ * \param [in]      points     The 3-dimensional coordinates of the points to check,
+ *                             3 * \a num_points doubles.
+ * \param [in]      num_points The number of points.
+ * \param [out]     is_inside  On input an allocated array of \a num_points ints.
+ *                             On output true (non-zero) at each point that lies within
+ *                             \a element, false otherwise.
+ * \param [in]      tolerance  The tolerance, see \ref t8_forest_element_point_inside.
+ */
+void                t8_forest_element_points_inside (t8_forest_t forest,
+                                                     t8_locidx_t ltreeid,
+                                                     const t8_element_t *
+                                                     element,
+                                                     const double
+                                                     *tree_vertices,
+                                                     const double *points,
+                                                     int num_points,
+                                                     int *is_inside,
+                                                     const double tolerance);
+
+/** Compute the axis-aligned bounding box of an element.
+ * This is the bounding box of the corners of the element.
+ * \param [in]      forest     The forest.
+ * \param [in]      ltreeid    The forest local id of the tree in which the element is.
+ * \param [in]      element    The element.
+ * \param [in]      tree_vertices An array storing the vertex coordinates of the tree.
+ * \param [out]     bbox       On output the lower corner of the box in the first
+ *                             and the upper corner in the last 3 entries.
+ */
+void                t8_forest_element_bounding_box (t8_forest_t forest,
+                                                    t8_locidx_t ltreeid,
+                                                    const t8_element_t *
+                                                    element,
+                                                    const double
+                                                    *tree_vertices,
+                                                    double bbox[6]);
+
+/** Return the axis-aligned bounding box of a local tree.
+ * The boxes of all local trees are computed on the first call and are
+ * stored in the forest.
+ * This function can be called concurrently from multiple threads.
+ * \param [in]      forest     A committed forest.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \return                     The lower corner of the box in the first
+ *                             and the upper corner in the last 3 entries.
+ */
+const double       *t8_forest_tree_bounding_box (t8_forest_t forest,
+                                                 t8_locidx_t ltreeid);
+
+/** Return the axis-aligned bounding box of a leaf element.
+ * The box of each leaf is computed on the first call for this leaf
+ * and is stored in the forest. If t8code is configured with OpenMP,
+ * the boxes of all leafs are computed on the first call, such that this
+ * function can be called concurrently from multiple threads.
+ * \param [in]      forest     A committed forest.
+ * \param [in]      ltreeid    The local id of a local tree.
+ * \param [in]      leid_in_tree The index of a leaf element in the tree.
+ * \return                     The lower corner of the box in the first
+ *                             and the upper corner in the last 3 entries,
+ *                             \see t8_forest_element_bounding_box.
+ */
+const double       *t8_forest_leaf_bounding_box (t8_forest_t forest,
+                                                 t8_locidx_t ltreeid,
+                                                 t8_locidx_t leid_in_tree);
+
 /* TODO: if set level and partition/adapt/balance all give NULL, then
  * refine uniformly and partition/adapt/balance the unfiform forest. */
 /** Build a uniformly refined forest on a coarse mesh.
@@ -1020,6 +3593,359 @@ t8_forest_t         t8_forest_new_adapt (t8_forest_t forest_from,
                                          int recursive, int do_face_ghost,
                                          void *user_data);
 
+/** Move a small forest to a subcommunicator of the processes with elements.
+ * After heavy coarsening a forest may have fewer elements than processes.
+ * The collective operations of commit, partition and ghost then involve
+ * many processes with empty partitions. This function concentrates the
+ * elements on the first processes, such that each of them gets at least
+ * \a min_elements elements, and builds a forest with the same elements on
+ * a subcommunicator of only these processes.
+ * The coarse mesh is copied to the subcommunicator.
+ * Once the forest has grown, \ref t8_forest_expand moves it back.
+ * \param [in]    forest       A committed forest. We take ownership of it.
+ * \param [in]    min_elements The minimum number of elements per active
+ *                             process, at least 1.
+ * \return        The shrunk forest on the active processes and NULL on
+ *                the others. If all processes stay active, this is
+ *                \a forest, possibly repartitioned.
+ * \note The ghost, thread and message settings and the geometry of
+ * \a forest are kept. The data fields and the user data are not.
+ * \note This function is collective on the communicator of \a forest.
+ */
+t8_forest_t         t8_forest_shrink (t8_forest_t forest,
+                                      t8_gloidx_t min_elements);
+
+/** Move a forest that was shrunk with \ref t8_forest_shrink back to a
+ * bigger communicator. The result has the same elements on the same
+ * processes, the processes that join are empty. Repartition it with
+ * \ref t8_forest_set_partition to distribute the elements.
+ * \param [in]    forest    The shrunk forest, NULL on the processes that
+ *                          are not in its communicator. We take ownership.
+ * \param [in]    cmesh     The coarse mesh on \a comm, for example the one
+ *                          \a forest was originally built on. If it is
+ *                          partitioned, it is repartitioned to fit the
+ *                          forest. We take ownership of it.
+ * \param [in]    scheme    The scheme of \a forest. We take ownership.
+ * \param [in]    comm      The communicator of the expanded forest. Its
+ *                          first processes must be those of the
+ *                          communicator of \a forest in the same order.
+ * \return        The expanded forest.
+ * \note The ghost and message settings of \a forest are kept. Its
+ * geometry, the data fields and the user data are not.
+ * \note This function is collective on \a comm.
+ */
+t8_forest_t         t8_forest_expand (t8_forest_t forest, t8_cmesh_t cmesh,
+                                      t8_scheme_cxx_t * scheme,
+                                      sc_MPI_Comm comm);
+
+/** Build a hierarchy of successively coarsened forests for geometric
+ * multigrid.
+ * Level 0 is \a forest, each further level replaces every family of local
+ * elements of the previous level by its parent. The levels are adapted
+ * with markers along the leaf array of the previous level, see
+ * \ref t8_forest_set_adapt_markers, and are not repartitioned, such that
+ * the parent of each element is local and known from the adapt runs.
+ * See \ref t8_forest_hierarchy_get_parents for these maps.
+ * Families that are split among processes stay on the coarser level.
+ * The coarse levels have the same kind of ghost layer as \a forest.
+ * \param [in]    forest       A committed forest. We take ownership of it.
+ * \param [in]    max_levels   The maximal number of levels, at least 1.
+ *                             Fewer levels are built if a level cannot be
+ *                             coarsened further.
+ * \param [in]    min_elements If positive, a coarse level with fewer than
+ *                             \a min_elements elements per process is
+ *                             aggregated on the first processes, such that
+ *                             each of them has at least \a min_elements
+ *                             elements, see
+ *                             \ref t8_forest_hierarchy_aggregate_data.
+ *                             If 0, no level is aggregated.
+ * \return        The hierarchy, to be destroyed with
+ *                \ref t8_forest_hierarchy_destroy.
+ * \note This function is collective on the communicator of \a forest.
+ */
+t8_forest_hierarchy_t t8_forest_hierarchy_new (t8_forest_t forest,
+                                               int max_levels,
+                                               t8_gloidx_t min_elements);
+
+/** Return the number of levels of a hierarchy.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \return        The number of levels, at least 1.
+ */
+int                 t8_forest_hierarchy_get_num_levels (t8_forest_hierarchy_t
+                                                        hierarchy);
+
+/** Return the forest of a level of a hierarchy.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \param [in]    level        A level, 0 is the finest.
+ * \return        The forest of \a level, which is valid as long as
+ *                \a hierarchy is. Reference it to keep it longer.
+ */
+t8_forest_t         t8_forest_hierarchy_get_forest (t8_forest_hierarchy_t
+                                                    hierarchy, int level);
+
+/** Return the parents of the local elements of a level on the next coarser
+ * level. For restriction the entries of the elements are combined into
+ * their parents, for prolongation the parent entries are spread to their
+ * elements. If the coarser level is aggregated, the parents are the local
+ * elements before the aggregation and their entries are moved with
+ * \ref t8_forest_hierarchy_aggregate_data and
+ * \ref t8_forest_hierarchy_disaggregate_data.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \param [in]    level        A level other than the coarsest.
+ * \param [out]   num_parents  If not NULL, on output the number of local
+ *                             parents on level \a level + 1.
+ * \return        For each local element of \a level the index of its
+ *                parent among the local parents, or the index of itself
+ *                if it was not coarsened. Valid as long as \a hierarchy is.
+ */
+const t8_locidx_t  *t8_forest_hierarchy_get_parents (t8_forest_hierarchy_t
+                                                     hierarchy, int level,
+                                                     t8_locidx_t *
+                                                     num_parents);
+
+/** Query whether a level of a hierarchy was aggregated on fewer processes.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \param [in]    level        A level.
+ * \return        True if \a level was aggregated.
+ */
+int                 t8_forest_hierarchy_is_aggregated (t8_forest_hierarchy_t
+                                                       hierarchy, int level);
+
+/** Move the entries of the local parents of a level to the local elements
+ * of its forest, such as restricted values. Without aggregation the
+ * entries are copied.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \param [in]    level        A level other than the finest.
+ * \param [in]    data_in      One entry per local parent, see
+ *                             \ref t8_forest_hierarchy_get_parents.
+ * \param [in,out] data_out    Allocated with one entry of the same size per
+ *                             local element of the forest of \a level.
+ * \note This function is collective if \a level is aggregated.
+ */
+void                t8_forest_hierarchy_aggregate_data (t8_forest_hierarchy_t
+                                                        hierarchy, int level,
+                                                        const sc_array_t *
+                                                        data_in,
+                                                        sc_array_t *
+                                                        data_out);
+
+/** Move the entries of the local elements of a level back to its local
+ * parents, such as values to be prolongated. This reverses
+ * \ref t8_forest_hierarchy_aggregate_data.
+ * \param [in]    hierarchy    A forest hierarchy.
+ * \param [in]    level        A level other than the finest.
+ * \param [in]    data_in      One entry per local element of the forest of
+ *                             \a level.
+ * \param [in,out] data_out    Allocated with one entry of the same size per
+ *                             local parent.
+ * \note This function is collective if \a level is aggregated.
+ */
+void                t8_forest_hierarchy_disaggregate_data
+  (t8_forest_hierarchy_t hierarchy, int level, const sc_array_t * data_in,
+   sc_array_t * data_out);
+
+/** Destroy a forest hierarchy and unreference its forests.
+ * \param [in,out] phierarchy  The hierarchy. Set to NULL on output.
+ */
+void                t8_forest_hierarchy_destroy (t8_forest_hierarchy_t *
+                                                 phierarchy);
+
+/** Create a view of the local elements and ghosts of a forest that are
+ * selected by a callback, for computations that only concern a subregion
+ * of the mesh.
+ * The view stores the selected elements as ranges of element indices into
+ * the leaf arrays of the forest, the elements are not copied.
+ * \param [in]    forest    A committed forest. It is referenced by the view.
+ * \param [in]    select_fn Called once for each local element and ghost.
+ *                          For a restricted ghost exchange it must select a
+ *                          ghost if and only if its owner selects it.
+ * \param [in]    user_data Passed to \a select_fn.
+ * \return        The view, valid until \ref t8_forest_view_destroy.
+ */
+t8_forest_view_t    t8_forest_view_new (t8_forest_t forest,
+                                        t8_forest_view_select_fn select_fn,
+                                        void *user_data);
+
+/** Destroy a forest view and unreference its forest.
+ * \param [in,out] pview   The view. Set to NULL on output.
+ */
+void                t8_forest_view_destroy (t8_forest_view_t * pview);
+
+/** Return the forest of a view.
+ * \param [in]    view      A forest view.
+ * \return        The forest, which is valid as long as \a view is.
+ */
+t8_forest_t         t8_forest_view_get_forest (t8_forest_view_t view);
+
+/** Return the number of local elements of a view.
+ * \param [in]    view      A forest view.
+ * \return        The number of selected local elements.
+ */
+t8_locidx_t         t8_forest_view_get_num_elements (t8_forest_view_t view);
+
+/** Return the number of ghosts of a view.
+ * \param [in]    view      A forest view.
+ * \return        The number of selected ghosts.
+ */
+t8_locidx_t         t8_forest_view_get_num_ghosts (t8_forest_view_t view);
+
+/** Return the ranges of the elements of a view in one tree.
+ * \param [in]    view      A forest view.
+ * \param [in]    ltreeid   A local tree, or the number of local trees plus
+ *                          a ghost tree id.
+ * \param [out]   num_ranges On output the number of ranges of the tree.
+ * \return        The ranges sorted by element index, NULL if none.
+ *                Subtract \ref t8_forest_get_tree_element_offset to get the
+ *                indices of the elements in the leaf array of a local tree.
+ */
+const t8_forest_view_range_t *t8_forest_view_get_tree_ranges (t8_forest_view_t
+                                                              view,
+                                                              t8_locidx_t
+                                                              ltreeid,
+                                                              t8_locidx_t *
+                                                              num_ranges);
+
+/** Query whether an element belongs to a view.
+ * \param [in]    view      A forest view.
+ * \param [in]    element_index A local element index, ghosts have the number
+ *                          of local elements plus their ghost index.
+ * \return        True if the element is in \a view.
+ * \note The ranges are searched with a binary search.
+ */
+int                 t8_forest_view_contains (t8_forest_view_t view,
+                                             t8_locidx_t element_index);
+
+/** Call a callback for each local element of a view in the order of the
+ * leaf arrays.
+ * \param [in]    view      A forest view.
+ * \param [in]    iterate_fn The callback.
+ * \param [in]    user_data Passed to \a iterate_fn.
+ */
+void                t8_forest_view_iterate (t8_forest_view_t view,
+                                            t8_forest_view_iterate_fn
+                                            iterate_fn, void *user_data);
+
+/** Find the face neighbors of a leaf that belong to a view.
+ * The neighbors are searched as in \ref t8_forest_leaf_face_neighbors,
+ * those outside of the view are discarded.
+ * \param [in]    view      A forest view. Its forest must have a face ghost
+ *                          layer if it is distributed.
+ * \param [in]    ltreeid   A local tree id.
+ * \param [in]    leaf      A leaf in tree \a ltreeid, not necessarily in
+ *                          \a view.
+ * \param [in]    face      A face of \a leaf.
+ * \param [in,out] indices  The element indices of the neighbors in the view
+ *                          are pushed to this array of t8_locidx_t. Ghosts
+ *                          have the number of local elements plus their
+ *                          ghost index.
+ * \param [in,out] dual_faces If not NULL, the face of each neighbor is pushed
+ *                          to this array of int.
+ */
+void                t8_forest_view_leaf_face_neighbors (t8_forest_view_t view,
+                                                        t8_locidx_t ltreeid,
+                                                        const t8_element_t *
+                                                        leaf, int face,
+                                                        sc_array_t * indices,
+                                                        sc_array_t *
+                                                        dual_faces);
+
+/** Exchange the ghost entries of user defined element data only for the
+ * ghosts in a view. Only the elements of the view are sent and only
+ * their ghost entries are updated.
+ * \param [in]    view      A forest view.
+ * \param [in,out] element_data An array of length num_local_elements +
+ *                          num_ghosts as in \ref t8_forest_ghost_exchange_data.
+ * \note This function is collective on the communicator of the forest.
+ */
+void                t8_forest_view_ghost_exchange_data (t8_forest_view_t view,
+                                                        sc_array_t *
+                                                        element_data);
+
+/** A level set function, for example the signed distance to an interface.
+ * \param [in] x       A point in physical space.
+ * \param [in] udata   The user data passed to \ref t8_forest_new_level_set.
+ * \return             The value of the level set function at \a x.
+ */
+typedef double      (*t8_forest_level_set_fn) (const double x[3],
+                                               void *udata);
+
+/** Build a forest that is refined in a band around the zero level set of a
+ * function. An element is in the band if the absolute value of \a level_set
+ * at its centroid is smaller than \a band_width times its diameter.
+ * The elements are recursively refined to \a min_level everywhere and to
+ * \a max_level in the band. A family with a parent outside of the band is
+ * coarsened to \a min_level. The function is evaluated once per family for
+ * coarsening and not at all for elements that are not refined, such that
+ * the elements far from the interface are pruned early.
+ * \param [in]    forest_from The forest to adapt. We take ownership.
+ * \param [in]    level_set   The level set function.
+ *                            For a signed distance function the band has a
+ *                            width of about \a band_width elements.
+ * \param [in]    udata       Passed to \a level_set.
+ * \param [in]    band_width  The width of the band in element diameters, > 0.
+ * \param [in]    min_level   The minimum level of the elements.
+ * \param [in]    max_level   The maximum level, reached in the band.
+ * \param [in]    do_balance  If true, the new forest is balanced.
+ *                            Otherwise it is only partitioned.
+ * \param [in]    do_face_ghost If true, a layer of ghost elements is created.
+ * \return        The adapted forest.
+ */
+t8_forest_t         t8_forest_new_level_set (t8_forest_t forest_from,
+                                             t8_forest_level_set_fn
+                                             level_set, void *udata,
+                                             double band_width,
+                                             int min_level, int max_level,
+                                             int do_balance,
+                                             int do_face_ghost);
+
+/** Compute adaptation markers for refinement around a level set from given
+ * values of the level set function, one per local element.
+ * For the element with local index i the marker is
+ *  - min_level - level if its level is smaller than \a min_level,
+ *  - 1 if |values[i]| is smaller than \a band_width times its diameter and
+ *    its level is smaller than \a max_level,
+ *  - -1 if it is outside of the band and its level is larger than
+ *    \a min_level, or its level is larger than \a max_level,
+ *  - 0 otherwise.
+ * \param [in]    forest      A committed forest.
+ * \param [in]    values      The level set values of the local elements,
+ *                            for example at their centroids.
+ * \param [in]    band_width  The width of the band in element diameters, > 0.
+ * \param [in]    min_level   The minimum level of the elements.
+ * \param [in]    max_level   The maximum level in the band.
+ * \param [out]   markers     An array with one entry per local element.
+ *                            On output the markers,
+ *                            see \ref t8_forest_set_adapt_markers.
+ */
+void                t8_forest_level_set_markers (t8_forest_t forest,
+                                                 const double *values,
+                                                 double band_width,
+                                                 int min_level,
+                                                 int max_level,
+                                                 int8_t * markers);
+
+/** Build a forest that is adapted around a level set given by values per
+ * element. This adapts each element at most one level, except for the
+ * refinement to \a min_level, see \ref t8_forest_level_set_markers.
+ * \param [in]    forest_from The forest to adapt. We take ownership.
+ * \param [in]    values      The level set values of the local elements
+ *                            of \a forest_from.
+ * \param [in]    band_width  The width of the band in element diameters, > 0.
+ * \param [in]    min_level   The minimum level of the elements.
+ * \param [in]    max_level   The maximum level in the band.
+ * \param [in]    do_balance  If true, the new forest is balanced.
+ *                            Otherwise it is only partitioned.
+ * \param [in]    do_face_ghost If true, a layer of ghost elements is created.
+ * \return        The adapted forest.
+ */
+t8_forest_t         t8_forest_new_level_set_values (t8_forest_t forest_from,
+                                                    const double *values,
+                                                    double band_width,
+                                                    int min_level,
+                                                    int max_level,
+                                                    int do_balance,
+                                                    int do_face_ghost);
+
 /** Increase the reference counter of a forest.
  * \param [in,out] forest       On input, this forest must exist with positive
  *                              reference count.  It may be in any state.
@@ -29,9 +29,22 @@
 #include <t8_forest/t8_forest_ghost.h>
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest/t8_forest_balance.h>
+#include <t8_forest/t8_forest_geometry_cache.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_forest/t8_forest_search_index.h>
+#include <t8_forest/t8_forest_boundary_index.h>
+#include <t8_forest/t8_forest_bvh.h>
+#include <t8_forest/t8_forest_data.h>
+#include <t8_forest/t8_forest_save.h>
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_trace.h>
 #include <t8_forest_vtk.h>
+#include <t8_element_c_interface.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
+#ifdef T8_ENABLE_OPENMP
+#include <omp.h>
+#endif
 
 void
 t8_forest_init (t8_forest_t * pforest)
@@ -54,6 +67,10 @@ t8_forest_init (t8_forest_t * pforest)
   forest->global_num_elements = -1;
   forest->set_adapt_recursive = -1;
   forest->set_balance = -1;
+  forest->set_balance_local = 1;
+  forest->set_balance_type = T8_GHOST_FACES;
+  forest->set_balance_repartition_once = 0;
+  forest->ghost_depth = 1;
   forest->maxlevel_existing = -1;
 }
 
@@ -156,6 +173,28 @@ t8_forest_set_level (t8_forest_t forest, int level)
   forest->set_level = level;
 }
 
+void
+t8_forest_set_load (t8_forest_t forest, const char *filename)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->rc.refcount > 0);
+  T8_ASSERT (!forest->committed);
+  T8_ASSERT (forest->set_from == NULL);
+  T8_ASSERT (filename != NULL);
+
+  T8_FREE (forest->set_load_file);
+  forest->set_load_file = T8_ALLOC (char, strlen (filename) + 1);
+  strcpy (forest->set_load_file, filename);
+}
+
+void
+t8_forest_set_load_mmap (t8_forest_t forest, int do_mmap)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_load_mmap = do_mmap;
+}
+
 void
 t8_forest_set_copy (t8_forest_t forest, const t8_forest_t set_from)
 {
@@ -177,9 +216,22 @@ t8_forest_set_copy (t8_forest_t forest, const t8_forest_t set_from)
 
   /* Overwrite any previous setting */
   forest->set_adapt_fn = NULL;
+  forest->set_adapt_batch_fn = NULL;
+  forest->set_adapt_markers = NULL;
   forest->set_adapt_recursive = -1;
   forest->set_balance = -1;
   forest->set_for_coarsening = -1;
+  forest->set_partition_weight_fn = NULL;
+  forest->set_partition_weights = NULL;
+  forest->set_partition_use_eclass_weights = 0;
+  forest->set_partition_cost_model = NULL;
+  forest->set_partition_tolerance = 0;
+  forest->set_partition_node_aware = 0;
+  forest->set_partition_offsets = NULL;
+  if (forest->set_partition_data != NULL) {
+    sc_array_destroy (forest->set_partition_data);
+    forest->set_partition_data = NULL;
+  }
 }
 
 void
@@ -209,6 +261,119 @@ t8_forest_set_partition (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_partition_weights (t8_forest_t forest,
+                                 t8_forest_partition_weight_t weight_fn,
+                                 const double *weights)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (weight_fn == NULL || weights == NULL);
+
+  forest->set_partition_weight_fn = weight_fn;
+  forest->set_partition_weights = weights;
+}
+
+void
+t8_forest_set_partition_eclass_weights (t8_forest_t forest,
+                                        const double
+                                        eclass_weights[T8_ECLASS_COUNT])
+{
+  int                 eclass;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  if (eclass_weights == NULL) {
+    forest->set_partition_use_eclass_weights = 0;
+    return;
+  }
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    T8_ASSERT (eclass_weights[eclass] >= 0);
+    forest->set_partition_eclass_weights[eclass] = eclass_weights[eclass];
+  }
+  forest->set_partition_use_eclass_weights = 1;
+}
+
+void
+t8_forest_set_partition_cost_model (t8_forest_t forest,
+                                    t8_forest_cost_model_t model)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_partition_cost_model = model;
+}
+
+void
+t8_forest_set_partition_offsets (t8_forest_t forest,
+                                 const t8_gloidx_t * element_offsets)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_partition_offsets = element_offsets;
+}
+
+void
+t8_forest_set_partition_tolerance (t8_forest_t forest, double tolerance)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (tolerance >= 0);
+
+  forest->set_partition_tolerance = tolerance;
+}
+
+void
+t8_forest_set_partition_node_aware (t8_forest_t forest, int node_aware)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_partition_node_aware = node_aware;
+}
+
+void
+t8_forest_set_partition_data (t8_forest_t forest, const sc_array_t * data_in,
+                              sc_array_t * data_out)
+{
+  t8_forest_partition_data_t *data;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (data_in != NULL && data_out != NULL);
+  T8_ASSERT (data_in != data_out);
+  T8_ASSERT (data_in->elem_size == data_out->elem_size);
+
+  if (forest->set_partition_data == NULL) {
+    forest->set_partition_data =
+      sc_array_new (sizeof (t8_forest_partition_data_t));
+  }
+  data = (t8_forest_partition_data_t *)
+    sc_array_push (forest->set_partition_data);
+  data->data_in = data_in;
+  data->data_out = data_out;
+  data->offsets_in = NULL;
+  data->offsets_out = NULL;
+}
+
+void
+t8_forest_set_partition_data_variable (t8_forest_t forest,
+                                       const sc_array_t * offsets_in,
+                                       const sc_array_t * payload_in,
+                                       sc_array_t * offsets_out,
+                                       sc_array_t * payload_out)
+{
+  t8_forest_partition_data_t *data;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (offsets_in != NULL && offsets_out != NULL);
+  T8_ASSERT (offsets_in != offsets_out);
+  T8_ASSERT (offsets_in->elem_size == sizeof (size_t));
+  T8_ASSERT (offsets_out->elem_size == sizeof (size_t));
+
+  t8_forest_set_partition_data (forest, payload_in, payload_out);
+  data = (t8_forest_partition_data_t *)
+    sc_array_index (forest->set_partition_data,
+                    forest->set_partition_data->elem_count - 1);
+  data->offsets_in = offsets_in;
+  data->offsets_out = offsets_out;
+}
+
 void
 t8_forest_set_balance (t8_forest_t forest, const t8_forest_t set_from,
                        int no_repartition)
@@ -239,14 +404,36 @@ t8_forest_set_balance (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_balance_local (t8_forest_t forest, int do_local)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_balance_local = (do_local != 0);
+}
+
+void
+t8_forest_set_balance_type (t8_forest_t forest, t8_ghost_type_t balance_type)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (balance_type != T8_GHOST_NONE);
+
+  forest->set_balance_type = balance_type;
+}
+
+void
+t8_forest_set_balance_repartition_once (t8_forest_t forest, int once)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_balance_repartition_once = (once != 0);
+}
+
 void
 t8_forest_set_ghost_ext (t8_forest_t forest, int do_ghost,
                          t8_ghost_type_t ghost_type, int ghost_version)
 {
   T8_ASSERT (t8_forest_is_initialized (forest));
-  /* We currently only support face ghosts */
-  SC_CHECK_ABORT (do_ghost == 0 || ghost_type == T8_GHOST_FACES,
-                  "Ghost neighbors other than face-neighbors are not supported.\n");
   SC_CHECK_ABORT (1 <= ghost_version && ghost_version <= 3,
                   "Invalid choice for ghost version. Choose 1, 2, or 3.\n");
 
@@ -271,6 +458,181 @@ t8_forest_set_ghost (t8_forest_t forest, int do_ghost,
   t8_forest_set_ghost_ext (forest, do_ghost, ghost_type, 3);
 }
 
+void
+t8_forest_set_ghost_depth (t8_forest_t forest, int ghost_depth)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  SC_CHECK_ABORT (ghost_depth >= 1, "The ghost depth must be positive.\n");
+
+  forest->ghost_depth = ghost_depth;
+}
+
+void
+t8_forest_set_ghost_lazy (t8_forest_t forest, int lazy)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_lazy = (lazy != 0);
+}
+
+void
+t8_forest_set_ghost_shmem (t8_forest_t forest, int ghost_shmem)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_shmem = (ghost_shmem != 0);
+}
+
+void
+t8_forest_set_ghost_rma (t8_forest_t forest, t8_ghost_rma_t ghost_rma)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (T8_GHOST_RMA_NONE <= ghost_rma
+             && ghost_rma <= T8_GHOST_RMA_PSCW);
+
+  forest->ghost_rma = ghost_rma;
+}
+
+void
+t8_forest_set_ghost_zero_copy (t8_forest_t forest, int zero_copy)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->ghost_zero_copy = (zero_copy != 0);
+}
+
+void
+t8_forest_set_compress (t8_forest_t forest, int do_compress)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_compress = (do_compress != 0);
+}
+
+void
+t8_forest_set_contiguous_leaves (t8_forest_t forest, int do_contiguous)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_contiguous_leaves = (do_contiguous != 0);
+}
+
+void
+t8_forest_set_geometry_cache (t8_forest_t forest, int do_cache)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_geometry_cache = (do_cache != 0);
+}
+
+void
+t8_forest_set_face_connectivity (t8_forest_t forest, int do_connectivity)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_face_connectivity = (do_connectivity != 0);
+}
+
+void
+t8_forest_set_search_index (t8_forest_t forest, int do_index)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_search_index = (do_index != 0);
+}
+
+void
+t8_forest_set_boundary_index (t8_forest_t forest, int do_index)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_boundary_index = (do_index != 0);
+}
+
+void
+t8_forest_set_element_index (t8_forest_t forest, int do_index)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_element_index = (do_index != 0);
+}
+
+void
+t8_forest_set_bvh (t8_forest_t forest, int do_bvh)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_bvh = (do_bvh != 0);
+}
+
+void
+t8_forest_set_adapt_threaded (t8_forest_t forest, int do_threaded)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_adapt_threaded = (do_threaded != 0);
+}
+
+void
+t8_forest_set_compress_messages (t8_forest_t forest, int do_compress)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->compress_messages = do_compress ? 1 : -1;
+}
+
+void
+t8_forest_set_num_threads (t8_forest_t forest, int num_threads)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (num_threads >= 0);
+
+  forest->num_threads = num_threads;
+}
+
+void
+t8_forest_set_geometry (t8_forest_t forest, t8_geometry_t geometry)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  T8_ASSERT (geometry != NULL);
+
+  if (forest->geometry != NULL) {
+    t8_geometry_unref (&forest->geometry);
+  }
+  forest->geometry = geometry;
+}
+
+t8_geometry_t
+t8_forest_get_geometry (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+
+  return forest->geometry;
+}
+
+int
+t8_forest_get_num_threads (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+
+#ifdef T8_ENABLE_OPENMP
+  if (forest->num_threads > 0) {
+    return forest->num_threads;
+  }
+  return omp_get_max_threads ();
+#else
+  return 1;
+#endif
+}
+
+void
+t8_forest_set_adapt_record_runs (t8_forest_t forest, int do_record)
+{
+  T8_ASSERT (t8_forest_is_initialized (forest));
+
+  forest->set_adapt_record_runs = (do_record != 0);
+}
+
 void
 t8_forest_set_adapt (t8_forest_t forest, const t8_forest_t set_from,
                      t8_forest_adapt_t adapt_fn, int recursive)
@@ -282,6 +644,8 @@ t8_forest_set_adapt (t8_forest_t forest, const t8_forest_t set_from,
   T8_ASSERT (forest->cmesh == NULL);
   T8_ASSERT (forest->scheme_cxx == NULL);
   T8_ASSERT (forest->set_adapt_fn == NULL);
+  T8_ASSERT (forest->set_adapt_batch_fn == NULL);
+  T8_ASSERT (forest->set_adapt_markers == NULL);
   T8_ASSERT (forest->set_adapt_recursive == -1);
 
   forest->set_adapt_fn = adapt_fn;
@@ -303,6 +667,29 @@ t8_forest_set_adapt (t8_forest_t forest, const t8_forest_t set_from,
   }
 }
 
+void
+t8_forest_set_adapt_batch (t8_forest_t forest, const t8_forest_t set_from,
+                           t8_forest_adapt_batch_t adapt_batch_fn)
+{
+  T8_ASSERT (adapt_batch_fn != NULL);
+
+  /* Batched adaptation is never recursive */
+  t8_forest_set_adapt (forest, set_from, NULL, 0);
+  forest->set_adapt_batch_fn = adapt_batch_fn;
+}
+
+void
+t8_forest_set_adapt_markers (t8_forest_t forest, const t8_forest_t set_from,
+                             const int8_t *markers, int max_level)
+{
+  T8_ASSERT (markers != NULL);
+
+  /* Adaptation by markers is never recursive */
+  t8_forest_set_adapt (forest, set_from, NULL, 0);
+  forest->set_adapt_markers = markers;
+  forest->set_adapt_markers_maxlevel = max_level;
+}
+
 void
 t8_forest_set_user_data (t8_forest_t forest, void *data)
 {
@@ -340,16 +727,317 @@ t8_forest_get_user_function (t8_forest_t forest)
 
 void
 t8_forest_comm_global_num_elements (t8_forest_t forest)
+{
+  t8_forest_reduce_t  reduce;
+
+  t8_forest_reduce_init (&reduce);
+  reduce.local[T8_FOREST_REDUCE_NUM_ELEMENTS] = forest->local_num_elements;
+  t8_forest_reduce (&reduce, forest->mpicomm);
+  forest->global_num_elements = reduce.global[T8_FOREST_REDUCE_NUM_ELEMENTS];
+}
+
+#ifdef T8_ENABLE_MPI
+/* The datatype of all values of a reduction and the operation that sums
+ * and maximizes them. They are created on first use and kept until
+ * MPI is finalized. */
+static MPI_Datatype t8_forest_reduce_type = MPI_DATATYPE_NULL;
+static MPI_Op       t8_forest_reduce_op = MPI_OP_NULL;
+
+static void
+t8_forest_reduce_combine (void *invec, void *inoutvec, int *len,
+                          MPI_Datatype * datatype)
+{
+  const t8_gloidx_t  *in = (const t8_gloidx_t *) invec;
+  t8_gloidx_t        *inout = (t8_gloidx_t *) inoutvec;
+  int                 ibatch, ivalue;
+
+  for (ibatch = 0; ibatch < *len; ibatch++) {
+    for (ivalue = 0; ivalue < T8_FOREST_REDUCE_FIRST_MAX; ivalue++) {
+      inout[ivalue] += in[ivalue];
+    }
+    for (; ivalue < T8_FOREST_REDUCE_COUNT; ivalue++) {
+      inout[ivalue] = SC_MAX (inout[ivalue], in[ivalue]);
+    }
+    in += T8_FOREST_REDUCE_COUNT;
+    inout += T8_FOREST_REDUCE_COUNT;
+  }
+}
+
+static void
+t8_forest_reduce_create_op (void)
 {
   int                 mpiret;
-  t8_gloidx_t         local_num_el;
-  t8_gloidx_t         global_num_el;
 
-  local_num_el = (t8_gloidx_t) forest->local_num_elements;
-  mpiret = sc_MPI_Allreduce (&local_num_el, &global_num_el, 1,
-                             T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
-  SC_CHECK_MPI (mpiret);
-  forest->global_num_elements = global_num_el;
+  if (t8_forest_reduce_op != MPI_OP_NULL) {
+    return;
+  }
+  /* One element of the datatype holds all values, such that the operation
+   * is never called on a part of them */
+  mpiret = MPI_Type_contiguous (T8_FOREST_REDUCE_COUNT, T8_MPI_GLOIDX,
+                                &t8_forest_reduce_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_commit (&t8_forest_reduce_type);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Op_create (t8_forest_reduce_combine, 1, &t8_forest_reduce_op);
+  SC_CHECK_MPI (mpiret);
+}
+#endif
+
+void
+t8_forest_reduce_init (t8_forest_reduce_t * reduce)
+{
+  T8_ASSERT (reduce != NULL);
+
+  memset (reduce->local, 0, sizeof (reduce->local));
+  memset (reduce->global, 0, sizeof (reduce->global));
+  reduce->request = sc_MPI_REQUEST_NULL;
+}
+
+void
+t8_forest_reduce (t8_forest_reduce_t * reduce, sc_MPI_Comm comm)
+{
+#ifdef T8_ENABLE_MPI
+  int                 mpiret;
+
+  t8_forest_reduce_create_op ();
+  mpiret = MPI_Allreduce (reduce->local, reduce->global, 1,
+                          t8_forest_reduce_type, t8_forest_reduce_op, comm);
+  SC_CHECK_MPI (mpiret);
+#else
+  memcpy (reduce->global, reduce->local, sizeof (reduce->local));
+#endif
+}
+
+void
+t8_forest_reduce_begin (t8_forest_reduce_t * reduce, sc_MPI_Comm comm)
+{
+#ifdef T8_ENABLE_MPI
+  int                 mpiret;
+
+  t8_forest_reduce_create_op ();
+  mpiret = MPI_Iallreduce (reduce->local, reduce->global, 1,
+                           t8_forest_reduce_type, t8_forest_reduce_op, comm,
+                           &reduce->request);
+  SC_CHECK_MPI (mpiret);
+#else
+  memcpy (reduce->global, reduce->local, sizeof (reduce->local));
+#endif
+}
+
+void
+t8_forest_reduce_end (t8_forest_reduce_t * reduce)
+{
+#ifdef T8_ENABLE_MPI
+  int                 mpiret;
+
+  mpiret = MPI_Wait (&reduce->request, MPI_STATUS_IGNORE);
+  SC_CHECK_MPI (mpiret);
+#endif
+}
+
+void
+t8_forest_compress (t8_forest_t forest)
+{
+  t8_tree_t           tree;
+  t8_locidx_t         itree, num_trees, num_elements;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    if (tree->packed_elements != NULL) {
+      /* This tree is already compressed */
+      continue;
+    }
+    num_elements = t8_forest_get_tree_element_count (tree);
+    /* Encode the elements and free the memory of the element array */
+    tree->packed_elements = T8_ALLOC (t8_linearidx_t, num_elements);
+    t8_element_array_pack (&tree->elements, forest->maxlevel,
+                           tree->packed_elements);
+    tree->num_packed_elements = num_elements;
+    t8_forest_tree_reset_elements (tree);
+  }
+  forest->compressed = 1;
+}
+
+void
+t8_forest_decompress (t8_forest_t forest)
+{
+  t8_locidx_t         itree, num_trees;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (!forest->compressed) {
+    return;
+  }
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    t8_forest_tree_decompress (forest, t8_forest_get_tree (forest, itree));
+  }
+  forest->compressed = 0;
+}
+
+int
+t8_forest_is_compressed (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->compressed;
+}
+
+/* Store the local tree id of each local element of a forest.
+ * \see t8_forest_set_element_index */
+static void
+t8_forest_element_index_compute (t8_forest_t forest)
+{
+  t8_locidx_t         itree, num_trees, ielement, num_elements;
+  t8_tree_t           tree;
+
+  T8_ASSERT (forest->element_trees == NULL);
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  forest->element_trees = T8_ALLOC (t8_locidx_t, num_elements);
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    num_elements = t8_forest_get_tree_element_count (tree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      forest->element_trees[tree->elements_offset + ielement] = itree;
+    }
+  }
+}
+
+/* The alignment in bytes of the element memory of each tree in the
+ * contiguous leaf storage. */
+#define T8_FOREST_LEAF_STORAGE_ALIGN 16
+
+/* Return the number of bytes of a tree's elements and its first and last
+ * descendant, rounded up to the leaf storage alignment. */
+static size_t
+t8_forest_leaf_storage_tree_bytes (t8_tree_t tree)
+{
+  size_t              bytes;
+
+  bytes = (t8_element_array_get_count (&tree->elements) + 2)
+    * tree->elements.array.elem_size;
+  return (bytes + T8_FOREST_LEAF_STORAGE_ALIGN - 1)
+    / T8_FOREST_LEAF_STORAGE_ALIGN * T8_FOREST_LEAF_STORAGE_ALIGN;
+}
+
+/* Move the elements and the first and last descendants of all local trees
+ * into one allocation and turn the element arrays into views of it.
+ * \see t8_forest_set_contiguous_leaves */
+static void
+t8_forest_leaves_make_contiguous (t8_forest_t forest)
+{
+  t8_locidx_t         itree, num_trees;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  char               *storage, *position;
+  size_t              num_elements, elem_size, bytes;
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  bytes = 0;
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    if (tree->packed_elements != NULL) {
+      /* The elements of compressed trees are not moved */
+      return;
+    }
+    bytes += t8_forest_leaf_storage_tree_bytes (tree);
+  }
+  storage = position = T8_ALLOC (char, SC_MAX (bytes, 1));
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    num_elements = t8_element_array_get_count (&tree->elements);
+    elem_size = tree->elements.array.elem_size;
+    /* Copy the elements and replace the array by a view */
+    if (num_elements > 0) {
+      memcpy (position, t8_element_array_get_data (&tree->elements),
+              num_elements * elem_size);
+    }
+    t8_forest_tree_reset_elements (tree);
+    t8_element_array_init_data (&tree->elements, (t8_element_t *) position,
+                                ts, num_elements);
+    /* The first and last descendant follow the elements */
+    T8_ASSERT (tree->first_desc != NULL && tree->last_desc != NULL);
+    memcpy (position + num_elements * elem_size, tree->first_desc,
+            elem_size);
+    memcpy (position + (num_elements + 1) * elem_size, tree->last_desc,
+            elem_size);
+    if (forest->leaf_storage == NULL) {
+      /* The descendants were allocated by the scheme */
+      t8_element_destroy (ts, 1, &tree->first_desc);
+      t8_element_destroy (ts, 1, &tree->last_desc);
+    }
+    tree->first_desc = (t8_element_t *) (position + num_elements * elem_size);
+    tree->last_desc =
+      (t8_element_t *) (position + (num_elements + 1) * elem_size);
+    position += t8_forest_leaf_storage_tree_bytes (tree);
+  }
+  T8_ASSERT ((size_t) (position - storage) == bytes);
+  /* Release a previous storage that the forest took over */
+  T8_FREE (forest->leaf_storage);
+  forest->leaf_storage = storage;
+  forest->leaf_storage_bytes = bytes;
+}
+
+/* Copy the elements of forest->set_comm_from, which lives on another
+ * communicator, into the trees of forest. The processes that are not in
+ * the communicator of set_comm_from are empty.
+ * \see t8_forest_shrink */
+static void
+t8_forest_take_elements (t8_forest_t forest)
+{
+  t8_forest_t         from = forest->set_comm_from;
+  t8_locidx_t         itree, num_trees;
+  t8_tree_t           tree, fromtree;
+  t8_eclass_scheme_c *ts;
+
+  if (from != NULL) {
+    T8_ASSERT (t8_forest_is_committed (from));
+    T8_ASSERT (from->scheme_cxx == forest->scheme_cxx);
+    t8_forest_decompress (from);
+    num_trees = t8_forest_get_num_local_trees (from);
+    forest->trees = sc_array_new_count (sizeof (t8_tree_struct_t), num_trees);
+    sc_array_copy (forest->trees, from->trees);
+    for (itree = 0; itree < num_trees; itree++) {
+      tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, itree);
+      fromtree = (t8_tree_t) t8_sc_array_index_locidx (from->trees, itree);
+      ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+      t8_element_array_init_size (&tree->elements, ts,
+                                  t8_element_array_get_count
+                                  (&fromtree->elements));
+      t8_element_array_copy (&tree->elements, &fromtree->elements);
+      /* The descendants are computed in commit */
+      tree->first_desc = tree->last_desc = NULL;
+      tree->packed_elements = NULL;
+      tree->num_packed_elements = 0;
+      tree->shared = NULL;
+    }
+    forest->first_local_tree = from->first_local_tree;
+    forest->last_local_tree = from->last_local_tree;
+    forest->local_num_elements = from->local_num_elements;
+    forest->hash_valid = from->hash_valid;
+  }
+  else {
+    /* This process is empty */
+    forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
+    forest->first_local_tree = 0;
+    forest->last_local_tree = -1;
+    forest->local_num_elements = 0;
+  }
+  t8_forest_comm_global_num_elements (forest);
+  SC_CHECK_ABORT (from == NULL
+                  || forest->global_num_elements == from->global_num_elements,
+                  "The new communicator does not contain all processes"
+                  " with elements");
+  if (from != NULL) {
+    t8_forest_unref (&forest->set_comm_from);
+  }
+  forest->set_comm_change = 0;
 }
 
 void
@@ -358,11 +1046,16 @@ t8_forest_commit (t8_forest_t forest)
   int                 mpiret;
   int                 partitioned = 0;
   sc_MPI_Comm         comm_dup;
+  t8_forest_t         geometry_from = NULL;
+  t8_forest_t         bvh_from = NULL;
+  t8_forest_t         boundary_from = NULL;
+  t8_forest_t         ghost_from = NULL;
 
   T8_ASSERT (forest != NULL);
   T8_ASSERT (forest->rc.refcount > 0);
   T8_ASSERT (!forest->committed);
 
+  T8_TRACE_BEGIN ("t8_forest_commit");
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of commit */
     forest->profile->commit_runtime = sc_MPI_Wtime ();
@@ -392,14 +1085,63 @@ t8_forest_commit (t8_forest_t forest)
     /* Compute the maximum allowed refinement level */
     t8_forest_compute_maxlevel (forest);
     T8_ASSERT (forest->set_level <= forest->maxlevel);
-    /* populate a new forest with tree and quadrant objects */
-    t8_forest_populate (forest);
+    if (forest->set_load_file != NULL) {
+      /* read the elements from a checkpoint file */
+      t8_forest_load_elements (forest);
+    }
+    else if (forest->set_comm_change) {
+      /* take over the elements of a forest on another communicator */
+      t8_forest_take_elements (forest);
+      /* The cmesh may be partitioned differently than the elements */
+      partitioned = 1;
+    }
+    else {
+      /* populate a new forest with tree and quadrant objects */
+      t8_forest_populate (forest);
+    }
     forest->global_num_trees = t8_cmesh_get_num_trees (forest->cmesh);
+    t8_forest_profile_record_memory (forest, NULL);
   }
   else {                        /* set_from != NULL */
-    t8_forest_t         forest_from = forest->set_from; /* temporarily store set_from, since we may overwrite it */
+    t8_forest_t         forest_from = forest->set_from; /* temporarily store set_from, since we may overwrite it.
+                                                           NULL if an intermediate forest took over its reference. */
+    void               *user_data_from;
 
     t8_debugf ("[h] from method %i\n", forest->from_method);
+    if (forest->set_geometry_cache
+        && forest->from_method == T8_FOREST_FROM_ADAPT
+        && forest->set_from->geometry_cache != NULL) {
+      /* The forest is only adapted, we can reuse the geometry of the
+       * elements that do not change. We keep the source forest alive
+       * until the geometry cache is computed. */
+      geometry_from = forest->set_from;
+      t8_forest_ref (geometry_from);
+    }
+    if (forest->set_bvh && forest->from_method == T8_FOREST_FROM_ADAPT
+        && forest->set_from->bvh != NULL) {
+      /* The forest is only adapted, we can reuse the boxes of the
+       * elements that do not change. */
+      bvh_from = forest->set_from;
+      t8_forest_ref (bvh_from);
+    }
+    if (forest->set_boundary_index
+        && forest->from_method == T8_FOREST_FROM_ADAPT
+        && forest->set_from->boundary_index != NULL) {
+      /* The forest is only adapted, we update the boundary leaves along
+       * the runs of the adaptation. */
+      boundary_from = forest->set_from;
+      t8_forest_ref (boundary_from);
+    }
+    if (forest->do_ghost && forest->ghost_algorithm == 3
+        && !forest->ghost_lazy && forest->from_method == T8_FOREST_FROM_ADAPT
+        && forest->set_from->ghosts != NULL) {
+      /* The forest is only adapted, we can reuse the remote ghosts of
+       * the elements that do not change. We keep the source forest alive
+       * until the ghost layer is created. */
+      ghost_from = forest->set_from;
+      t8_forest_ref (ghost_from);
+    }
+    T8_ASSERT (forest->set_load_file == NULL);
     T8_ASSERT (forest->mpicomm == sc_MPI_COMM_NULL);
     T8_ASSERT (forest->cmesh == NULL);
     T8_ASSERT (forest->scheme_cxx == NULL);
@@ -418,6 +1160,23 @@ t8_forest_commit (t8_forest_t forest)
       SC_CHECK_MPI (mpiret);
     }
     forest->do_dup = forest->set_from->do_dup;
+    if (forest->num_threads == 0) {
+      /* Use the same number of threads as the source forest */
+      forest->num_threads = forest->set_from->num_threads;
+    }
+    if (forest->compress_messages == 0) {
+      /* Encode the messages as the source forest does */
+      forest->compress_messages = forest->set_from->compress_messages;
+    }
+    if (forest->geometry == NULL && forest->set_from->geometry != NULL) {
+      /* Use the same geometry as the source forest */
+      t8_geometry_ref (forest->set_from->geometry);
+      forest->geometry = forest->set_from->geometry;
+    }
+
+    /* The algorithms below work on the elements of set_from, we thus
+     * need to decode them if they are compressed. */
+    t8_forest_decompress (forest->set_from);
 
     /* Set mpirank and mpisize */
     mpiret = sc_MPI_Comm_size (forest->mpicomm, &forest->mpisize);
@@ -440,12 +1199,28 @@ t8_forest_commit (t8_forest_t forest)
       SC_CHECK_ABORT (forest->set_from != NULL,
                       "No forest to copy from was specified.");
       t8_forest_copy_trees (forest, forest->set_from, 1);
+      t8_forest_data_copy (forest, forest->set_from, 0);
+      t8_forest_profile_record_memory (forest, forest->set_from);
     }
     /* TODO: currently we can only handle copy, adapt, partition, and balance */
 
     /* T8_ASSERT (forest->from_method == T8_FOREST_FROM_COPY); */
+    SC_CHECK_ABORT (forest->set_partition_weights == NULL
+                    || forest->from_method == T8_FOREST_FROM_PARTITION,
+                    "Partition weight arrays can only be used if the forest"
+                    " is only partitioned");
+    SC_CHECK_ABORT (forest->set_partition_offsets == NULL
+                    || forest->from_method == T8_FOREST_FROM_PARTITION,
+                    "Given partition offsets can only be used if the forest"
+                    " is only partitioned");
+    SC_CHECK_ABORT (forest->set_partition_data == NULL
+                    || forest->from_method == T8_FOREST_FROM_PARTITION,
+                    "Partition data can only be used if the forest"
+                    " is only partitioned");
     if (forest->from_method & T8_FOREST_FROM_ADAPT) {
-      SC_CHECK_ABORT (forest->set_adapt_fn != NULL,
+      SC_CHECK_ABORT (forest->set_adapt_fn != NULL
+                      || forest->set_adapt_batch_fn != NULL
+                      || forest->set_adapt_markers != NULL,
                       "No adapt function specified");
       forest->from_method -= T8_FOREST_FROM_ADAPT;
       if (forest->from_method > 0) {
@@ -454,36 +1229,72 @@ t8_forest_commit (t8_forest_t forest)
         t8_forest_t         forest_adapt;
 
         t8_forest_init (&forest_adapt);
-        /* forest_adapt should not change ownership of forest->set_from */
-        t8_forest_ref (forest->set_from);
+        /* forest_adapt takes over the reference of forest to set_from.
+         * If set_from is not referenced elsewhere, it is thus adapted in
+         * place and destroyed as soon as forest_adapt is committed. */
+        forest_from = NULL;
         /* set user data of forest to forest_adapt */
         t8_forest_set_user_data (forest_adapt,
                                  t8_forest_get_user_data (forest));
         /* Construct an intermediate, adapted forest */
-        t8_forest_set_adapt (forest_adapt, forest->set_from,
-                             forest->set_adapt_fn,
-                             forest->set_adapt_recursive);
+        if (forest->set_adapt_batch_fn != NULL) {
+          t8_forest_set_adapt_batch (forest_adapt, forest->set_from,
+                                     forest->set_adapt_batch_fn);
+        }
+        else if (forest->set_adapt_markers != NULL) {
+          t8_forest_set_adapt_markers (forest_adapt, forest->set_from,
+                                       forest->set_adapt_markers,
+                                       forest->set_adapt_markers_maxlevel);
+        }
+        else {
+          t8_forest_set_adapt (forest_adapt, forest->set_from,
+                               forest->set_adapt_fn,
+                               forest->set_adapt_recursive);
+        }
+        t8_forest_set_adapt_threaded (forest_adapt,
+                                      forest->set_adapt_threaded);
+        t8_forest_set_num_threads (forest_adapt, forest->num_threads);
+        forest_adapt->compress_messages = forest->compress_messages;
         /* Set profiling if enabled */
         t8_forest_set_profiling (forest_adapt, forest->profile != NULL);
+        /* The user data of set_from, which may not exist after commit */
+        user_data_from = t8_forest_get_user_data (forest->set_from);
         t8_forest_commit (forest_adapt);
         /* The new forest will be partitioned/balanced from forest_adapt */
         forest->set_from = forest_adapt;
         /* Set the user data of forest_from to forest_adapt */
-        t8_forest_set_user_data (forest_adapt,
-                                 t8_forest_get_user_data (forest_from));
+        t8_forest_set_user_data (forest_adapt, user_data_from);
         /* If profiling is enabled copy the runtime of adapt. */
         if (forest->profile != NULL) {
           forest->profile->adapt_runtime =
             forest_adapt->profile->adapt_runtime;
+          forest->profile->memory_high_water =
+            forest_adapt->profile->memory_high_water;
+          t8_forest_profile_merge (forest, forest_adapt);
         }
       }
       else {
         /* This forest should only be adapted */
         t8_forest_copy_trees (forest, forest->set_from, 0);
+        /* The data fields are interpolated along the adapt runs */
+        if (forest->set_adapt_record_runs
+            || t8_forest_data_get_num_fields (forest->set_from) > 0
+            || forest->set_from->hash_valid || boundary_from != NULL) {
+          forest->adapt_runs = sc_array_new (sizeof (t8_forest_adapt_run_t));
+        }
         t8_forest_adapt (forest);
+        t8_forest_data_adapt (forest, forest->set_from);
+        if (!forest->set_adapt_record_runs && forest->adapt_runs != NULL
+            && boundary_from == NULL) {
+          sc_array_destroy (forest->adapt_runs);
+          forest->adapt_runs = NULL;
+        }
+        t8_forest_profile_record_memory (forest, forest->set_from);
       }
     }
     if (forest->from_method & T8_FOREST_FROM_PARTITION) {
+      sc_array_t         *data_views;
+
       partitioned = 1;
       /* Partition this forest */
       forest->from_method -= T8_FOREST_FROM_PARTITION;
@@ -493,12 +1304,27 @@ t8_forest_commit (t8_forest_t forest)
         t8_forest_t         forest_partition;
 
         t8_forest_init (&forest_partition);
-        if (forest_from == forest->set_from) {
-          /* forest_partition should not change ownership of forest->set_from */
-          t8_forest_ref (forest->set_from);
-        }
+        /* forest_partition takes over the reference of forest to set_from,
+         * such that set_from can be destroyed as soon as possible. */
+        forest_from = NULL;
         t8_forest_set_partition (forest_partition, forest->set_from,
                                  forest->set_for_coarsening);
+        t8_forest_set_partition_weights (forest_partition,
+                                         forest->set_partition_weight_fn,
+                                         forest->set_partition_weights);
+        if (forest->set_partition_use_eclass_weights) {
+          t8_forest_set_partition_eclass_weights (forest_partition,
+                                                  forest->
+                                                  set_partition_eclass_weights);
+        }
+        t8_forest_set_partition_cost_model (forest_partition,
+                                            forest->set_partition_cost_model);
+        t8_forest_set_partition_tolerance (forest_partition,
+                                           forest->set_partition_tolerance);
+        t8_forest_set_partition_node_aware (forest_partition,
+                                            forest->set_partition_node_aware);
+        t8_forest_set_num_threads (forest_partition, forest->num_threads);
+        forest_partition->compress_messages = forest->compress_messages;
         /* activate profiling, if this forest has profiling */
         t8_forest_set_profiling (forest_partition, forest->profile != NULL);
         /* Commit the partitioned forest */
@@ -515,6 +1341,12 @@ t8_forest_commit (t8_forest_t forest)
             forest_partition->profile->partition_procs_sent;
           forest->profile->partition_runtime =
             forest_partition->profile->partition_runtime;
+          forest->profile->partition_imbalance =
+            forest_partition->profile->partition_imbalance;
+          forest->profile->memory_high_water =
+            SC_MAX (forest->profile->memory_high_water,
+                    forest_partition->profile->memory_high_water);
+          t8_forest_profile_merge (forest, forest_partition);
         }
       }
       else {
@@ -522,8 +1354,11 @@ t8_forest_commit (t8_forest_t forest)
         forest->global_num_elements = forest->set_from->global_num_elements;
         /* Initialize the trees array of the forest */
         forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
-        /* partition the forest */
+        /* partition the forest and its data fields */
+        data_views = t8_forest_data_partition_begin (forest, forest->set_from);
         t8_forest_partition (forest);
+        t8_forest_data_partition_end (forest, data_views);
+        t8_forest_profile_record_memory (forest, forest->set_from);
       }
     }
     if (forest->from_method & T8_FOREST_FROM_BALANCE) {
@@ -537,10 +1372,51 @@ t8_forest_commit (t8_forest_t forest)
       if (forest->set_balance == T8_FOREST_BALANCE_NO_REPART) {
         /* balance without repartition */
         t8_forest_balance (forest, 0);
+        t8_forest_profile_record_memory (forest, forest->set_from);
+      }
+      else if (forest->set_balance_repartition_once) {
+        /* The forest should be balanced without repartitioning
+         * between the rounds and then be partitioned once */
+        t8_forest_t         forest_balance;
+        sc_array_t         *data_views;
+
+        t8_forest_init (&forest_balance);
+        /* forest_balance takes over the reference of forest to set_from */
+        forest_from = NULL;
+        t8_forest_set_balance (forest_balance, forest->set_from, 1);
+        t8_forest_set_balance_local (forest_balance,
+                                     forest->set_balance_local);
+        t8_forest_set_balance_type (forest_balance,
+                                    forest->set_balance_type);
+        t8_forest_set_num_threads (forest_balance, forest->num_threads);
+        forest_balance->compress_messages = forest->compress_messages;
+        /* activate profiling, if this forest has profiling */
+        t8_forest_set_profiling (forest_balance, forest->profile != NULL);
+        t8_forest_commit (forest_balance);
+        forest->set_from = forest_balance;
+        if (forest->profile != NULL) {
+          forest->profile->balance_runtime =
+            forest_balance->profile->balance_runtime;
+          forest->profile->balance_rounds =
+            forest_balance->profile->balance_rounds;
+          forest->profile->memory_high_water =
+            SC_MAX (forest->profile->memory_high_water,
+                    forest_balance->profile->memory_high_water);
+          t8_forest_profile_merge (forest, forest_balance);
+        }
+        forest->global_num_elements = forest_balance->global_num_elements;
+        /* Initialize the trees array of the forest */
+        forest->trees = sc_array_new (sizeof (t8_tree_struct_t));
+        /* partition the balanced forest and its data fields */
+        data_views = t8_forest_data_partition_begin (forest, forest_balance);
+        t8_forest_partition (forest);
+        t8_forest_data_partition_end (forest, data_views);
+        t8_forest_profile_record_memory (forest, forest->set_from);
       }
       else {
         /* balance with repartition */
         t8_forest_balance (forest, 1);
+        t8_forest_profile_record_memory (forest, forest->set_from);
       }
     }
 
@@ -548,10 +1424,12 @@ t8_forest_commit (t8_forest_t forest)
       /* decrease reference count of intermediate input forest, possibly destroying it */
       t8_forest_unref (&forest->set_from);
     }
-    /* reset forest->set_from */
-    forest->set_from = forest_from;
-    /* decrease reference count of input forest, possibly destroying it */
-    t8_forest_unref (&forest->set_from);
+    if (forest_from != NULL) {
+      /* reset forest->set_from */
+      forest->set_from = forest_from;
+      /* decrease reference count of input forest, possibly destroying it */
+      t8_forest_unref (&forest->set_from);
+    }
   }                             /* end set_from != NULL */
 
   /* Compute the element offset of the trees */
@@ -562,7 +1440,20 @@ t8_forest_commit (t8_forest_t forest)
 
   /* we do not need the set parameters anymore */
   forest->set_level = 0;
+  T8_FREE (forest->set_load_file);
+  forest->set_load_file = NULL;
   forest->set_for_coarsening = 0;
+  forest->set_partition_weight_fn = NULL;
+  forest->set_partition_weights = NULL;
+  forest->set_partition_use_eclass_weights = 0;
+  forest->set_partition_cost_model = NULL;
+  forest->set_partition_tolerance = 0;
+  forest->set_partition_node_aware = 0;
+  forest->set_partition_offsets = NULL;
+  if (forest->set_partition_data != NULL) {
+    sc_array_destroy (forest->set_partition_data);
+    forest->set_partition_data = NULL;
+  }
   forest->set_from = NULL;
   forest->committed = 1;
   t8_debugf ("Committed forest with %li local elements and %lli "
@@ -609,7 +1500,13 @@ t8_forest_commit (t8_forest_t forest)
 
   if (forest->mpisize > 1) {
     /* Construct a ghost layer, if desired */
-    if (forest->do_ghost) {
+    if (forest->do_ghost && forest->ghost_lazy && !forest->set_compress
+        && !forest->set_face_connectivity) {
+      /* Create the ghost layer on first use. If the data fields need
+       * their ghost entries, this happens right below. */
+      forest->ghost_pending = 1;
+    }
+    else if (forest->do_ghost) {
       /* TODO: ghost type */
       switch (forest->ghost_algorithm) {
       case 1:
@@ -619,7 +1516,7 @@ t8_forest_commit (t8_forest_t forest)
         t8_forest_ghost_create (forest);
         break;
       case 3:
-        t8_forest_ghost_create_topdown (forest);
+        t8_forest_ghost_create_incremental (forest, ghost_from);
         break;
       default:
         SC_ABORT ("Invalid choice of ghost algorithm");
@@ -627,6 +1524,79 @@ t8_forest_commit (t8_forest_t forest)
     }
     forest->do_ghost = 0;
   }
+  if (ghost_from != NULL) {
+    t8_forest_unref (&ghost_from);
+  }
+  /* Fill the ghost entries of the data fields */
+  t8_forest_data_ghost (forest);
+
+  /* Precompute the coordinate maps of the local and ghost trees */
+  t8_forest_tree_maps_compute (forest);
+
+  if (forest->set_face_connectivity) {
+    /* Compute the face neighbors of the local elements */
+    t8_forest_face_connectivity_compute (forest);
+    forest->set_face_connectivity = 0;
+  }
+
+  if (forest->set_search_index) {
+    /* Compute the split offsets of the search */
+    t8_forest_search_index_compute (forest);
+    forest->set_search_index = 0;
+  }
+
+  if (forest->set_element_index) {
+    /* Store the local tree of each local element */
+    t8_forest_element_index_compute (forest);
+    forest->set_element_index = 0;
+  }
+
+  if (forest->set_geometry_cache) {
+    /* Compute the geometry of the local elements */
+    t8_forest_geometry_cache_compute (forest, geometry_from);
+    if (geometry_from != NULL) {
+      t8_forest_unref (&geometry_from);
+    }
+    forest->set_geometry_cache = 0;
+  }
+
+  if (forest->set_bvh) {
+    /* Compute the bounding volume hierarchy of the local elements */
+    t8_forest_bvh_compute (forest, bvh_from);
+    if (bvh_from != NULL) {
+      t8_forest_unref (&bvh_from);
+    }
+    forest->set_bvh = 0;
+  }
+
+  if (forest->set_boundary_index) {
+    /* List the leaves at the domain boundary */
+    t8_forest_boundary_index_compute (forest, boundary_from);
+    if (boundary_from != NULL) {
+      t8_forest_unref (&boundary_from);
+      if (!forest->set_adapt_record_runs && forest->adapt_runs != NULL) {
+        /* The runs were only kept for the boundary index */
+        sc_array_destroy (forest->adapt_runs);
+        forest->adapt_runs = NULL;
+      }
+    }
+    forest->set_boundary_index = 0;
+  }
+
+  if (forest->set_contiguous_leaves) {
+    /* Move the elements of all trees into one allocation */
+    t8_forest_leaves_make_contiguous (forest);
+    forest->set_contiguous_leaves = 0;
+  }
+
+  if (forest->set_compress) {
+    /* Compress the elements after all their information was computed */
+    t8_forest_compress (forest);
+    forest->set_compress = 0;
+  }
+  /* Measure the memory of the forest with its ghosts and caches */
+  t8_forest_profile_record_memory (forest, NULL);
+  T8_TRACE_END ("t8_forest_commit");
 }
 
 t8_locidx_t
@@ -650,6 +1620,7 @@ t8_forest_get_num_ghosts (t8_forest_t forest)
 {
   T8_ASSERT (t8_forest_is_committed (forest));
 
+  t8_forest_ghost_ensure (forest);
   /* Return the number of ghost elements, or 0 if no ghost structure
    * existst. */
   if (forest->ghosts == NULL) {
@@ -658,6 +1629,46 @@ t8_forest_get_num_ghosts (t8_forest_t forest)
   return forest->ghosts->num_ghosts_elements;
 }
 
+int
+t8_forest_get_num_ghost_layers (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  t8_forest_ghost_ensure (forest);
+  if (forest->ghosts == NULL) {
+    return 0;
+  }
+  return forest->ghosts->num_layers;
+}
+
+int
+t8_forest_get_ghost_layer (t8_forest_t forest, t8_locidx_t lghost)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->ghosts != NULL);
+  T8_ASSERT (0 <= lghost && lghost < forest->ghosts->num_ghosts_elements);
+
+  if (forest->ghosts->ghost_layers == NULL) {
+    /* There is only one layer */
+    return 1;
+  }
+  return forest->ghosts->ghost_layers[lghost];
+}
+
+const t8_forest_adapt_run_t *
+t8_forest_get_adapt_runs (t8_forest_t forest, t8_locidx_t *num_runs)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_runs != NULL);
+
+  if (forest->adapt_runs == NULL) {
+    *num_runs = 0;
+    return NULL;
+  }
+  *num_runs = (t8_locidx_t) forest->adapt_runs->elem_count;
+  return (const t8_forest_adapt_run_t *) forest->adapt_runs->array;
+}
+
 /* Currently this function is not used */
 #if 0
 static t8_element_t *
@@ -695,6 +1706,42 @@ t8_forest_compute_cmesh_offset (t8_forest_t forest, sc_MPI_Comm comm)
   return offset;
 }
 
+/* Return true if on every process the local trees of the forest's cmesh
+ * already match the cmesh partition \a offsets.
+ * This function is collective over \a comm. */
+static int
+t8_forest_cmesh_partition_is_unchanged (t8_forest_t forest,
+                                        t8_shmem_array_t offsets,
+                                        sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh = forest->cmesh;
+  t8_gloidx_t        *offset_array;
+  t8_gloidx_t         num_trees;
+  int                 rank, mpiret;
+  int                 unchanged, all_unchanged;
+
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  if (!cmesh->set_partition) {
+    /* A replicated cmesh always has to be partitioned. */
+    return 0;
+  }
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+  offset_array = t8_shmem_array_get_gloidx_array (offsets);
+  num_trees = t8_offset_num_trees (rank, offset_array);
+  unchanged = num_trees == (t8_gloidx_t) cmesh->num_local_trees;
+  if (unchanged && num_trees > 0) {
+    /* Same number of trees, the first tree and its shared flag
+     * must match as well. */
+    unchanged = t8_offset_first (rank, offset_array) == cmesh->first_tree
+      && (offset_array[rank] < 0) == (cmesh->first_tree_shared != 0);
+  }
+  mpiret = sc_MPI_Allreduce (&unchanged, &all_unchanged, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  return all_unchanged;
+}
+
 void
 t8_forest_partition_cmesh (t8_forest_t forest, sc_MPI_Comm comm,
                            int set_profiling)
@@ -704,14 +1751,21 @@ t8_forest_partition_cmesh (t8_forest_t forest, sc_MPI_Comm comm,
 
   t8_debugf ("Partitioning cmesh according to forest\n");
 
-  t8_cmesh_init (&cmesh_partition);
-  t8_cmesh_set_derive (cmesh_partition, forest->cmesh);
   /* set partition range of new cmesh according to forest trees */
   if (forest->tree_offsets == NULL) {
     t8_forest_partition_create_tree_offsets (forest);
   }
   offsets = t8_forest_compute_cmesh_offset (forest, comm);
 
+  if (t8_forest_cmesh_partition_is_unchanged (forest, offsets, comm)) {
+    /* No process gains or loses a tree, we keep the current cmesh. */
+    t8_debugf ("Cmesh partition unchanged, skipping repartition\n");
+    t8_shmem_array_destroy (&offsets);
+    return;
+  }
+
+  t8_cmesh_init (&cmesh_partition);
+  t8_cmesh_set_derive (cmesh_partition, forest->cmesh);
   t8_cmesh_set_partition_offsets (cmesh_partition, offsets);
   /* Set the profiling of the cmesh */
   t8_cmesh_set_profiling (cmesh_partition, set_profiling);
@@ -740,6 +1794,7 @@ t8_forest_get_first_local_tree_id (t8_forest_t forest)
 t8_locidx_t
 t8_forest_get_num_ghost_trees (t8_forest_t forest)
 {
+  t8_forest_ghost_ensure (forest);
   if (forest->ghosts != NULL) {
     return t8_forest_ghost_num_trees (forest);
   }
@@ -808,6 +1863,11 @@ t8_forest_get_tree (t8_forest_t forest, t8_locidx_t ltree_id)
 double             *
 t8_forest_get_tree_vertices (t8_forest_t forest, t8_locidx_t ltreeid)
 {
+  if (forest->tree_maps != NULL && ltreeid < forest->tree_maps_num_trees) {
+    /* The vertices of the local and ghost trees are cached with their maps,
+     * such that we do not search the cmesh attributes again. */
+    return (double *) forest->tree_maps[ltreeid].vertices;
+  }
   return t8_cmesh_get_tree_vertices (forest->cmesh,
                                      t8_forest_ltreeid_to_cmesh_ltreeid
                                      (forest, ltreeid));
@@ -845,8 +1905,8 @@ t8_forest_compare_elem_tree (const void *lelement_id, const void *ltree)
     /* We have to look further to the left */
     return -1;
   }
-  else if (tree->elements_offset + (t8_locidx_t)
-           t8_element_array_get_count (&tree->elements) > leid) {
+  else if (tree->elements_offset +
+           t8_forest_get_tree_element_count (tree) > leid) {
     /* We have found the tree */
     return 0;
   }
@@ -888,8 +1948,7 @@ t8_forest_get_element (t8_forest_t forest, t8_locidx_t lelement_id,
         ltree_b = ltreedebug;
       }
       else if (tree->elements_offset +
-               (t8_locidx_t) t8_element_array_get_count (&tree->elements) >
-               lelement_id) {
+               t8_forest_get_tree_element_count (tree) > lelement_id) {
         /* We have found the tree */
         ltree_a = ltree_b;
       }
@@ -900,9 +1959,14 @@ t8_forest_get_element (t8_forest_t forest, t8_locidx_t lelement_id,
     }
   }
 #endif
-  ltree =
-    sc_array_bsearch (forest->trees, &lelement_id,
-                      t8_forest_compare_elem_tree);
+  if (forest->element_trees != NULL) {
+    ltree = forest->element_trees[lelement_id];
+  }
+  else {
+    ltree =
+      sc_array_bsearch (forest->trees, &lelement_id,
+                        t8_forest_compare_elem_tree);
+  }
   T8_ASSERT (ltreedebug == ltree);
   if (ltreeid != NULL) {
     *ltreeid = ltree;
@@ -911,6 +1975,8 @@ t8_forest_get_element (t8_forest_t forest, t8_locidx_t lelement_id,
   /* The tree that contains the element is now local tree ltree.
    * Or the element is not a local element. */
   tree = t8_forest_get_tree (forest, ltree);
+  /* Decode the elements if they are compressed */
+  t8_forest_tree_decompress (forest, tree);
   if (tree->elements_offset <= lelement_id && lelement_id <
       tree->elements_offset +
       (t8_locidx_t) t8_element_array_get_count (&tree->elements)) {
@@ -925,6 +1991,90 @@ t8_forest_get_element (t8_forest_t forest, t8_locidx_t lelement_id,
   return NULL;
 }
 
+int
+t8_forest_has_element_index (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->element_trees != NULL;
+}
+
+int
+t8_forest_has_contiguous_leaves (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->leaf_storage != NULL;
+}
+
+void
+t8_forest_get_element_batch (t8_forest_t forest, size_t num_ids,
+                             const t8_gloidx_t * gelement_ids,
+                             t8_locidx_t * ltreeids,
+                             t8_locidx_t * tree_element_ids,
+                             t8_element_t ** elements)
+{
+  t8_gloidx_t         first_element;
+  t8_locidx_t         num_elements, lelement_id, ltree;
+  t8_tree_t           tree;
+  size_t              iid;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_ids == 0 || gelement_ids != NULL);
+
+  first_element = t8_forest_get_first_local_element_id (forest);
+  num_elements = t8_forest_get_local_num_elements (forest);
+  /* Consecutive ids mostly lie in the same tree, we first check whether
+   * the id lies in the tree of the previous one. */
+  tree = NULL;
+  ltree = -1;
+  for (iid = 0; iid < num_ids; iid++) {
+    if (gelement_ids[iid] < first_element
+        || gelement_ids[iid] >= first_element + num_elements) {
+      /* This element is not local */
+      if (ltreeids != NULL) {
+        ltreeids[iid] = -1;
+      }
+      if (tree_element_ids != NULL) {
+        tree_element_ids[iid] = -1;
+      }
+      if (elements != NULL) {
+        elements[iid] = NULL;
+      }
+      continue;
+    }
+    lelement_id = (t8_locidx_t) (gelement_ids[iid] - first_element);
+    if (tree == NULL || lelement_id < tree->elements_offset
+        || lelement_id >= tree->elements_offset +
+        t8_forest_get_tree_element_count (tree)) {
+      if (forest->element_trees != NULL) {
+        ltree = forest->element_trees[lelement_id];
+      }
+      else {
+        ltree = sc_array_bsearch (forest->trees, &lelement_id,
+                                  t8_forest_compare_elem_tree);
+      }
+      tree = t8_forest_get_tree (forest, ltree);
+      if (elements != NULL) {
+        /* Decode the elements if they are compressed */
+        t8_forest_tree_decompress (forest, tree);
+      }
+    }
+    T8_ASSERT (tree->elements_offset <= lelement_id);
+    if (ltreeids != NULL) {
+      ltreeids[iid] = ltree;
+    }
+    if (tree_element_ids != NULL) {
+      tree_element_ids[iid] = lelement_id - tree->elements_offset;
+    }
+    if (elements != NULL) {
+      elements[iid] =
+        t8_forest_get_tree_element (tree, lelement_id -
+                                    tree->elements_offset);
+    }
+  }
+}
+
 t8_element_t
   * t8_forest_get_element_in_tree (t8_forest_t forest, t8_locidx_t ltreeid,
                                    t8_locidx_t leid_in_tree)
@@ -935,6 +2085,8 @@ t8_element_t
              && ltreeid < t8_forest_get_num_local_trees (forest));
 
   tree = t8_forest_get_tree (forest, ltreeid);
+  /* Decode the elements if they are compressed */
+  t8_forest_tree_decompress (forest, tree);
   return t8_forest_get_tree_element (tree, leid_in_tree);
 }
 
@@ -952,6 +2104,10 @@ t8_forest_get_tree_element_count (t8_tree_t tree)
   t8_locidx_t         element_count;
 
   T8_ASSERT (tree != NULL);
+  if (tree->packed_elements != NULL) {
+    /* The elements of this tree are compressed */
+    return tree->num_packed_elements;
+  }
   element_count = t8_element_array_get_count (&tree->elements);
   /* check for type conversion errors */
   T8_ASSERT ((size_t) element_count ==
@@ -1156,51 +2312,172 @@ t8_forest_set_profiling (t8_forest_t forest, int set_profiling)
   }
 }
 
+/* The keys of the statistics in t8_forest_write_profile, in the order
+ * of t8_forest_profile_set_stats. The phase statistics use their names. */
+static const char  *t8_forest_profile_keys[T8_PROFILE_NUM_STATS] = {
+  "partition_elements_shipped",
+  "partition_elements_recv",
+  "partition_bytes_sent",
+  "partition_procs_sent",
+  "ghosts_shipped",
+  "ghosts_received",
+  "ghosts_remotes",
+  "adapt_runtime",
+  "partition_runtime",
+  "commit_runtime",
+  "ghost_runtime",
+  "ghost_waittime",
+  "balance_runtime",
+  "balance_rounds",
+  "memory_high_water",
+  "partition_imbalance"
+};
+
+/* The number of statistics in a forest profile including the phases */
+#define T8_FOREST_PROFILE_ALL_STATS \
+  (T8_PROFILE_NUM_STATS + T8_PROFILE_PHASE_NUM_STATS * T8_PROFILE_PHASE_COUNT)
+
+/* Set the statistics of a profile in an array of length
+ * T8_FOREST_PROFILE_ALL_STATS. The statistics of the phases follow
+ * the fixed ones, \see t8_forest_profile_set_phase_stats */
+static void
+t8_forest_profile_set_stats (const t8_profile_t * profile,
+                             sc_statinfo_t * stats)
+{
+  sc_stats_set1 (&stats[0], profile->partition_elements_shipped,
+                 "forest: Number of elements sent.");
+  sc_stats_set1 (&stats[1], profile->partition_elements_recv,
+                 "forest: Number of elements received.");
+  sc_stats_set1 (&stats[2], profile->partition_bytes_sent,
+                 "forest: Number of bytes sent.");
+  sc_stats_set1 (&stats[3], profile->partition_procs_sent,
+                 "forest: Number of processes sent to.");
+  sc_stats_set1 (&stats[4], profile->ghosts_shipped,
+                 "forest: Number of ghost elements sent.");
+  sc_stats_set1 (&stats[5], profile->ghosts_received,
+                 "forest: Number of ghost elements received.");
+  sc_stats_set1 (&stats[6], profile->ghosts_remotes,
+                 "forest: Number of processes we sent ghosts to/received from.");
+  sc_stats_set1 (&stats[7], profile->adapt_runtime, "forest: Adapt runtime.");
+  sc_stats_set1 (&stats[8], profile->partition_runtime,
+                 "forest: Partition runtime.");
+  sc_stats_set1 (&stats[9], profile->commit_runtime,
+                 "forest: Commit runtime.");
+  sc_stats_set1 (&stats[10], profile->ghost_runtime,
+                 "forest: Ghost runtime.");
+  sc_stats_set1 (&stats[11], profile->ghost_waittime,
+                 "forest: Ghost waittime.");
+  sc_stats_set1 (&stats[12], profile->balance_runtime,
+                 "forest: Balance runtime.");
+  sc_stats_set1 (&stats[13], profile->balance_rounds,
+                 "forest: Balance rounds.");
+  sc_stats_set1 (&stats[14], profile->memory_high_water,
+                 "forest: Memory high-water mark in bytes.");
+  sc_stats_set1 (&stats[15], profile->partition_imbalance,
+                 "forest: Runtime imbalance of the partition cost model.");
+  t8_forest_profile_set_phase_stats (profile, stats + T8_PROFILE_NUM_STATS);
+}
+
+/* Print the statistics of one kind of all phases */
+static void
+t8_forest_profile_print_phase_stats (sc_statinfo_t * stats, int kind)
+{
+  sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
+                  T8_PROFILE_PHASE_COUNT, stats + T8_PROFILE_NUM_STATS
+                  + kind * T8_PROFILE_PHASE_COUNT, 1, 1);
+}
+
 void
 t8_forest_print_profile (t8_forest_t forest)
 {
   T8_ASSERT (t8_forest_is_committed (forest));
   if (forest->profile != NULL) {
     /* Only print something if profiling is enabled */
-    sc_statinfo_t       stats[T8_PROFILE_NUM_STATS];
-    t8_profile_t       *profile = forest->profile;
+    sc_statinfo_t       stats[T8_FOREST_PROFILE_ALL_STATS];
 
     /* Set the stats */
-    sc_stats_set1 (&stats[0], profile->partition_elements_shipped,
-                   "forest: Number of elements sent.");
-    sc_stats_set1 (&stats[1], profile->partition_elements_recv,
-                   "forest: Number of elements received.");
-    sc_stats_set1 (&stats[2], profile->partition_bytes_sent,
-                   "forest: Number of bytes sent.");
-    sc_stats_set1 (&stats[3], profile->partition_procs_sent,
-                   "forest: Number of processes sent to.");
-    sc_stats_set1 (&stats[4], profile->ghosts_shipped,
-                   "forest: Number of ghost elements sent.");
-    sc_stats_set1 (&stats[5], profile->ghosts_received,
-                   "forest: Number of ghost elements received.");
-    sc_stats_set1 (&stats[6], profile->ghosts_remotes,
-                   "forest: Number of processes we sent ghosts to/received from.");
-    sc_stats_set1 (&stats[7], profile->adapt_runtime,
-                   "forest: Adapt runtime.");
-    sc_stats_set1 (&stats[8], profile->partition_runtime,
-                   "forest: Partition runtime.");
-    sc_stats_set1 (&stats[9], profile->commit_runtime,
-                   "forest: Commit runtime.");
-    sc_stats_set1 (&stats[10], profile->ghost_runtime,
-                   "forest: Ghost runtime.");
-    sc_stats_set1 (&stats[11], profile->ghost_waittime,
-                   "forest: Ghost waittime.");
-    sc_stats_set1 (&stats[12], profile->balance_runtime,
-                   "forest: Balance runtime.");
-    sc_stats_set1 (&stats[13], profile->balance_rounds,
-                   "forest: Balance rounds.");
+    t8_forest_profile_set_stats (forest->profile, stats);
     /* compute stats */
-    sc_stats_compute (sc_MPI_COMM_WORLD, T8_PROFILE_NUM_STATS, stats);
+    sc_stats_compute (sc_MPI_COMM_WORLD, T8_FOREST_PROFILE_ALL_STATS, stats);
     /* print stats */
     t8_logf (SC_LC_GLOBAL, SC_LP_STATISTICS, "Printing stats for forest.\n");
     sc_stats_print (t8_get_package_id (), SC_LP_STATISTICS,
                     T8_PROFILE_NUM_STATS, stats, 1, 1);
+    t8_logf (SC_LC_GLOBAL, SC_LP_STATISTICS,
+             "Printing phase stats for forest.\n");
+    t8_forest_profile_print_phase_stats (stats, 0);
+    t8_forest_profile_print_phase_stats (stats, 2 + T8_PROFILE_COUNTER_BYTES);
+    if (t8_forest_profile_counters_enabled ()) {
+      t8_forest_profile_print_phase_stats (stats,
+                                           2 + T8_PROFILE_COUNTER_CYCLES);
+      t8_forest_profile_print_phase_stats (stats,
+                                           2 + T8_PROFILE_COUNTER_LLC_MISSES);
+    }
+    t8_alloc_count_print ();
+  }
+}
+
+int
+t8_forest_write_profile (t8_forest_t forest, const char *filename,
+                         t8_forest_profile_format_t format)
+{
+  sc_statinfo_t       stats[T8_FOREST_PROFILE_ALL_STATS];
+  t8_profile_t        empty_profile;
+  FILE               *file;
+  const char         *key;
+  int                 mpiret, mpirank, istat;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (format == T8_FOREST_PROFILE_CSV
+             || format == T8_FOREST_PROFILE_JSON);
+
+  /* Processes without a profile contribute zeros */
+  memset (&empty_profile, 0, sizeof (empty_profile));
+  t8_forest_profile_set_stats (forest->profile != NULL ? forest->profile
+                               : &empty_profile, stats);
+  sc_stats_compute (forest->mpicomm, T8_FOREST_PROFILE_ALL_STATS, stats);
+
+  mpiret = sc_MPI_Comm_rank (forest->mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank != 0) {
+    return 1;
+  }
+  file = fopen (filename, "w");
+  if (file == NULL) {
+    t8_errorf ("Could not open file %s for writing.\n", filename);
+    return 0;
+  }
+  if (format == T8_FOREST_PROFILE_CSV) {
+    fprintf (file, "name,min,average,max,min_rank,max_rank\n");
+  }
+  else {
+    fprintf (file, "{\n");
+  }
+  for (istat = 0; istat < T8_FOREST_PROFILE_ALL_STATS; istat++) {
+    key = istat < T8_PROFILE_NUM_STATS ? t8_forest_profile_keys[istat]
+      : stats[istat].variable;
+    if (format == T8_FOREST_PROFILE_CSV) {
+      fprintf (file, "%s,%.9g,%.9g,%.9g,%i,%i\n", key, stats[istat].min,
+               stats[istat].average, stats[istat].max,
+               stats[istat].min_at_rank, stats[istat].max_at_rank);
+    }
+    else {
+      fprintf (file, "  \"%s\": {\"min\": %.9g, \"average\": %.9g, "
+               "\"max\": %.9g, \"min_rank\": %i, \"max_rank\": %i}%s\n",
+               key, stats[istat].min, stats[istat].average, stats[istat].max,
+               stats[istat].min_at_rank, stats[istat].max_at_rank,
+               istat + 1 < T8_FOREST_PROFILE_ALL_STATS ? "," : "");
+    }
+  }
+  if (format == T8_FOREST_PROFILE_JSON) {
+    fprintf (file, "}\n");
+  }
+  if (fclose (file)) {
+    t8_errorf ("Could not close file %s.\n", filename);
+    return 0;
   }
+  return 1;
 }
 
 double
@@ -1259,6 +2536,26 @@ t8_forest_profile_get_ghostexchange_waittime (t8_forest_t forest)
   return 0;
 }
 
+size_t
+t8_forest_profile_get_memory_high_water (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->profile != NULL) {
+    return forest->profile->memory_high_water;
+  }
+  return 0;
+}
+
+double
+t8_forest_profile_get_partition_imbalance (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (forest->profile != NULL) {
+    return forest->profile->partition_imbalance;
+  }
+  return 0;
+}
+
 double
 t8_forest_profile_get_balance (t8_forest_t forest, int *balance_rounds)
 {
@@ -1348,6 +2645,173 @@ t8_forest_new_adapt (t8_forest_t forest_from,
   return forest;
 }
 
+/* The number of settings that are kept when a forest changes its
+ * communicator. */
+#define T8_FOREST_COMM_CHANGE_SETTINGS 4
+
+int
+t8_forest_has_ghost_setting (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+
+  return forest->do_ghost || forest->ghost_pending || forest->ghosts != NULL;
+}
+
+/* Store the ghost and message settings of a forest. */
+static void
+t8_forest_comm_change_settings (t8_forest_t forest, int *settings)
+{
+  settings[0] = t8_forest_has_ghost_setting (forest);
+  settings[1] = (int) forest->ghost_type;
+  settings[2] = forest->ghost_algorithm;
+  settings[3] = forest->compress_messages;
+}
+
+/* Build a forest on comm with the elements of forest_from, which is NULL
+ * on the processes that are not in its communicator. We take ownership of
+ * forest_from, cmesh and scheme. The settings are those stored with
+ * t8_forest_comm_change_settings on rank 0 of comm, which must be in
+ * both communicators. */
+static t8_forest_t
+t8_forest_new_comm_change (t8_forest_t forest_from, t8_cmesh_t cmesh,
+                           t8_scheme_cxx_t * scheme, t8_geometry_t geometry,
+                           int *settings, sc_MPI_Comm comm, int do_dup)
+{
+  t8_forest_t         forest;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Bcast (settings, T8_FOREST_COMM_CHANGE_SETTINGS,
+                         sc_MPI_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  forest->do_dup = do_dup;
+  t8_forest_set_scheme (forest, scheme);
+  if (settings[0]) {
+    t8_forest_set_ghost_ext (forest, 1, (t8_ghost_type_t) settings[1],
+                             settings[2]);
+  }
+  forest->compress_messages = settings[3];
+  if (forest_from != NULL) {
+    forest->num_threads = forest_from->num_threads;
+  }
+  if (geometry != NULL) {
+    t8_geometry_ref (geometry);
+    forest->geometry = geometry;
+  }
+  forest->set_comm_change = 1;
+  forest->set_comm_from = forest_from;
+  t8_forest_commit (forest);
+  return forest;
+}
+
+int
+t8_forest_concentrate_offsets (t8_forest_t forest, t8_gloidx_t min_elements,
+                               t8_gloidx_t **poffsets)
+{
+  const t8_gloidx_t  *offsets;
+  t8_gloidx_t         num_elements;
+  int                 num_active, iproc;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (min_elements > 0);
+  T8_ASSERT (forest->element_offsets != NULL);
+
+  /* Each active process gets at least min_elements elements */
+  num_elements = forest->global_num_elements;
+  num_active = (int) SC_MAX (1, SC_MIN (num_elements / min_elements,
+                                        (t8_gloidx_t) forest->mpisize));
+  *poffsets = NULL;
+  offsets = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  if (num_active < forest->mpisize && offsets[num_active] != num_elements) {
+    *poffsets = T8_ALLOC (t8_gloidx_t, forest->mpisize + 1);
+    for (iproc = 0; iproc <= forest->mpisize; iproc++) {
+      (*poffsets)[iproc] = iproc >= num_active ? num_elements :
+        (t8_gloidx_t) (((long double) iproc * num_elements) / num_active);
+    }
+  }
+  return num_active;
+}
+
+t8_forest_t
+t8_forest_shrink (t8_forest_t forest, t8_gloidx_t min_elements)
+{
+  t8_forest_t         forest_partition, forest_shrunk;
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t        *offsets;
+  sc_MPI_Comm         comm, subcomm;
+  int                 num_active, mpiret;
+  int                 settings[T8_FOREST_COMM_CHANGE_SETTINGS];
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (min_elements > 0);
+
+  /* The partitioned forest below has no ghosts */
+  t8_forest_comm_change_settings (forest, settings);
+
+  num_active = t8_forest_concentrate_offsets (forest, min_elements, &offsets);
+  if (offsets != NULL) {
+    /* Move all elements to the first num_active processes */
+    t8_forest_init (&forest_partition);
+    t8_forest_set_partition (forest_partition, forest, 0);
+    t8_forest_set_partition_offsets (forest_partition, offsets);
+    t8_forest_commit (forest_partition);
+    T8_FREE (offsets);
+    forest = forest_partition;
+  }
+  if (num_active == forest->mpisize) {
+    /* All processes stay active */
+    return forest;
+  }
+
+  comm = forest->mpicomm;
+  mpiret = sc_MPI_Comm_split (comm, forest->mpirank < num_active ? 0 :
+                              sc_MPI_UNDEFINED, forest->mpirank, &subcomm);
+  SC_CHECK_MPI (mpiret);
+  if (subcomm == sc_MPI_COMM_NULL) {
+    /* This process does not take part in the shrunk forest */
+    T8_ASSERT (forest->local_num_elements == 0);
+    t8_forest_unref (&forest);
+    return NULL;
+  }
+
+  /* Copy the coarse mesh to the subcommunicator. All trees belong to
+   * the active processes, since the inactive ones have no elements. */
+  t8_cmesh_ref (forest->cmesh);
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_derive (cmesh, forest->cmesh);
+  t8_cmesh_commit (cmesh, subcomm);
+
+  t8_scheme_cxx_ref (forest->scheme_cxx);
+  forest_shrunk = t8_forest_new_comm_change (forest, cmesh,
+                                             forest->scheme_cxx,
+                                             forest->geometry, settings,
+                                             subcomm, 1);
+  /* The forest keeps a duplicate of the subcommunicator */
+  mpiret = sc_MPI_Comm_free (&subcomm);
+  SC_CHECK_MPI (mpiret);
+  t8_debugf ("Shrunk forest to %i processes\n", forest_shrunk->mpisize);
+  return forest_shrunk;
+}
+
+t8_forest_t
+t8_forest_expand (t8_forest_t forest, t8_cmesh_t cmesh,
+                  t8_scheme_cxx_t * scheme, sc_MPI_Comm comm)
+{
+  int                 settings[T8_FOREST_COMM_CHANGE_SETTINGS];
+
+  T8_ASSERT (forest == NULL || t8_forest_is_committed (forest));
+  T8_ASSERT (t8_cmesh_is_committed (cmesh));
+  T8_ASSERT (forest == NULL || scheme == forest->scheme_cxx);
+
+  if (forest != NULL) {
+    t8_forest_comm_change_settings (forest, settings);
+  }
+  return t8_forest_new_comm_change (forest, cmesh, scheme, NULL, settings,
+                                    comm, 0);
+}
+
 /* Iterate through all the trees and free the element memory as well as
  * the tree memory.
  */
@@ -1363,7 +2827,8 @@ t8_forest_free_trees (t8_forest_t forest)
   number_of_trees = forest->trees->elem_count;
   for (jt = 0; jt < number_of_trees; jt++) {
     tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt);
-    t8_element_array_reset (&tree->elements);
+    t8_forest_tree_reset_elements (tree);
+    T8_FREE (tree->packed_elements);
   }
   sc_array_destroy (forest->trees);
 }
@@ -1387,6 +2852,13 @@ t8_forest_reset (t8_forest_t * pforest)
       /* in this case we have taken ownership and not released it yet */
       t8_forest_unref (&forest->set_from);
     }
+    if (forest->set_partition_data != NULL) {
+      sc_array_destroy (forest->set_partition_data);
+    }
+    if (forest->set_comm_from != NULL) {
+      t8_forest_unref (&forest->set_comm_from);
+    }
+    T8_FREE (forest->set_load_file);
   }
   else {
     T8_ASSERT (forest->set_from == NULL);
@@ -1399,12 +2871,44 @@ t8_forest_reset (t8_forest_t * pforest)
       SC_CHECK_MPI (mpiret);
     }
     t8_forest_free_trees (forest);
+    /* Release the file mapping of the elements if they were loaded */
+    t8_forest_unmap_elements (forest);
+    /* Release the contiguous leaves. The trees only stored views of it. */
+    T8_FREE (forest->leaf_storage);
   }
 
   /* Destroy the ghost layer if it exists */
   if (forest->ghosts != NULL) {
     t8_forest_ghost_unref (&forest->ghosts);
   }
+  /* Destroy the geometry cache if it exists */
+  t8_forest_geometry_cache_destroy (forest);
+  /* Destroy the face connectivity if it exists */
+  t8_forest_face_connectivity_destroy (forest);
+  /* Destroy the search index if it exists */
+  t8_forest_search_index_destroy (forest);
+  /* Destroy the element index if it exists */
+  T8_FREE (forest->element_trees);
+  /* Destroy the bounding volume hierarchy if it exists */
+  t8_forest_bvh_destroy (forest);
+  /* Destroy the boundary index if it exists */
+  t8_forest_boundary_index_destroy (forest);
+  /* Free the element data fields */
+  t8_forest_data_destroy (forest);
+  /* Free the runs of the adaptation if they were recorded */
+  if (forest->adapt_runs != NULL) {
+    sc_array_destroy (forest->adapt_runs);
+  }
+  if (forest->tree_maps != NULL) {
+    T8_FREE (forest->tree_maps);
+  }
+  /* Free the bounding boxes if they were computed */
+  if (forest->tree_bounding_boxes != NULL) {
+    T8_FREE (forest->tree_bounding_boxes);
+  }
+  if (forest->leaf_bounding_boxes != NULL) {
+    T8_FREE (forest->leaf_bounding_boxes);
+  }
   /* we have taken ownership on calling t8_forest_set_* */
   if (forest->scheme_cxx != NULL) {
     t8_scheme_cxx_unref (&forest->scheme_cxx);
@@ -1412,6 +2916,9 @@ t8_forest_reset (t8_forest_t * pforest)
   if (forest->cmesh != NULL) {
     t8_cmesh_unref (&forest->cmesh);
   }
+  if (forest->geometry != NULL) {
+    t8_geometry_unref (&forest->geometry);
+  }
 
   /* free the memory of the offset array */
   if (forest->element_offsets != NULL) {
@@ -22,6 +22,10 @@
 
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_forest/t8_forest_hash.h>
+#include <t8_trace.h>
 #include <t8_forest.h>
 #include <t8_data/t8_containers.h>
 #include <t8_element_cxx.hxx>
@@ -29,6 +33,95 @@
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+/* Append a run of changed elements to the runs of forest, if they are
+ * recorded. The run is merged with the last run if it continues it.
+ * When adapting recursively, only unchanged runs are merged, such that
+ * a recursive coarsening can remove the runs of the coarsened family.
+ * Refined and coarsened runs are only merged if each of their elements
+ * changed into the same number of elements.
+ * The indices are local element indices of forest->set_from and forest. */
+static void
+t8_forest_adapt_runs_add (t8_forest_t forest, t8_forest_adapt_change_t kind,
+                          t8_locidx_t first_old, t8_locidx_t num_old,
+                          t8_locidx_t first_new, t8_locidx_t num_new)
+{
+  t8_forest_adapt_run_t *run;
+  sc_array_t         *runs = forest->adapt_runs;
+  t8_locidx_t         num_per_element;
+
+  if (runs == NULL) {
+    return;
+  }
+  T8_ASSERT (kind != T8_FOREST_ADAPT_REFINED || num_old == 1);
+  T8_ASSERT (kind != T8_FOREST_ADAPT_COARSENED || num_new == 1);
+  num_per_element = kind == T8_FOREST_ADAPT_REFINED ? num_new :
+    kind == T8_FOREST_ADAPT_COARSENED ? num_old : 1;
+  if (runs->elem_count > 0) {
+    run = (t8_forest_adapt_run_t *) sc_array_index (runs,
+                                                    runs->elem_count - 1);
+    if (run->kind == kind && run->first_old + run->num_old == first_old
+        && run->first_new + run->num_new == first_new
+        && run->num_per_element == num_per_element
+        && (kind == T8_FOREST_ADAPT_UNCHANGED
+            || !forest->set_adapt_recursive)) {
+      run->num_old += num_old;
+      run->num_new += num_new;
+      return;
+    }
+  }
+  run = (t8_forest_adapt_run_t *) sc_array_push (runs);
+  run->kind = kind;
+  run->first_old = first_old;
+  run->num_old = num_old;
+  run->first_new = first_new;
+  run->num_new = num_new;
+  run->num_per_element = num_per_element;
+}
+
+/* Update the recorded runs after the last \a num_siblings new elements,
+ * starting at local index \a first_new, were coarsened recursively.
+ * These elements are the end of the recorded runs, we replace their runs
+ * by one coarsened run. */
+static void
+t8_forest_adapt_runs_fold (t8_forest_t forest, t8_locidx_t first_new,
+                           int num_siblings)
+{
+  t8_forest_adapt_run_t *run;
+  sc_array_t         *runs = forest->adapt_runs;
+  t8_locidx_t         first_old, end_old, num_cut;
+
+  if (runs == NULL) {
+    return;
+  }
+  T8_ASSERT (runs->elem_count > 0);
+  run = (t8_forest_adapt_run_t *) sc_array_index (runs, runs->elem_count - 1);
+  T8_ASSERT (run->first_new + run->num_new == first_new + num_siblings);
+  end_old = first_old = run->first_old + run->num_old;
+  while (runs->elem_count > 0) {
+    run =
+      (t8_forest_adapt_run_t *) sc_array_index (runs, runs->elem_count - 1);
+    if (run->first_new >= first_new) {
+      /* The run is part of the family, remove it */
+      first_old = run->first_old;
+      sc_array_resize (runs, runs->elem_count - 1);
+    }
+    else {
+      if (run->first_new + run->num_new > first_new) {
+        /* The run only partly belongs to the family. Since only unchanged
+         * runs are merged, it is unchanged and we can cut it. */
+        T8_ASSERT (run->kind == T8_FOREST_ADAPT_UNCHANGED);
+        num_cut = run->first_new + run->num_new - first_new;
+        run->num_old -= num_cut;
+        run->num_new -= num_cut;
+        first_old = run->first_old + run->num_old;
+      }
+      break;
+    }
+  }
+  t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_COARSENED, first_old,
+                            end_old - first_old, first_new, 1);
+}
+
 /* Check the lastly inserted elements of an array for recursive coarsening.
  * The last inserted element must be the last element of a family.
  * \param [in] forest  The new forest currently in construction.
@@ -42,6 +135,8 @@ T8_EXTERN_C_BEGIN ();
  * \param [in,out] el_inserted On input the number of elements in \a telement, on output
  *                        the new number of elements (so it will be smaller or equal to its input).
  * \param [in] el_buffer Buffer space to store a family of elements.
+ * \param [in] el_offset The local index of the first element of \a telements
+ *                        in \a forest.
  */
 static void
 t8_forest_adapt_coarsen_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
@@ -50,13 +145,14 @@ t8_forest_adapt_coarsen_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
                                    t8_element_array_t * telements,
                                    t8_locidx_t el_coarsen,
                                    t8_locidx_t * el_inserted,
-                                   t8_element_t ** el_buffer)
+                                   t8_element_t ** el_buffer,
+                                   t8_locidx_t el_offset)
 {
   t8_element_t       *element;
   t8_element_t      **fam;
   t8_locidx_t         pos;
   size_t              elements_in_array;
-  int                 num_children, i, isfamily;
+  int                 num_siblings, i, isfamily;
   int                 child_id;
   /* el_inserted is the index of the last element in telements plus one.
    * el_coarsen is the index of the first element which could possibly
@@ -66,21 +162,21 @@ t8_forest_adapt_coarsen_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
   T8_ASSERT (*el_inserted == (t8_locidx_t) elements_in_array);
   T8_ASSERT (el_coarsen >= 0);
   element = t8_element_array_index_locidx (telements, *el_inserted - 1);
-  /* TODO: This assumes that the number of children is the same for each
-   *       element in that class. This may not be the case. */
-  num_children = ts->t8_element_num_children (element);
-  T8_ASSERT (ts->t8_element_child_id (element) == num_children - 1);
+  /* The size of a family depends on the element, since for example
+   * the parent of a tetrahedron may be a pyramid or a tetrahedron. */
+  num_siblings = ts->t8_element_num_siblings (element);
+  T8_ASSERT (ts->t8_element_child_id (element) == num_siblings - 1);
   T8_ASSERT (ts->t8_element_level (element) > 0);
 
   fam = el_buffer;
-  pos = *el_inserted - num_children;
+  pos = *el_inserted - num_siblings;
   isfamily = 1;
   child_id = ts->t8_element_child_id (element);
   while (isfamily && pos >= el_coarsen && child_id > 0 && child_id
-         == num_children - 1) {
+         == num_siblings - 1) {
     isfamily = 1;
-    /* Get all elements at indices pos, pos + 1, ... ,pos + num_children - 1 */
-    for (i = 0; i < num_children; i++) {
+    /* Get all elements at indices pos, pos + 1, ... ,pos + num_siblings - 1 */
+    for (i = 0; i < num_siblings; i++) {
       fam[i] = t8_element_array_index_locidx (telements, pos + i);
       if (ts->t8_element_child_id (fam[i]) != i) {
         /* These elements cannot form a family. Stop coarsening. */
@@ -91,139 +187,1032 @@ t8_forest_adapt_coarsen_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
     T8_ASSERT (!isfamily || ts->t8_element_is_family (fam));
     if (isfamily
         && forest->set_adapt_fn (forest, forest->set_from, ltreeid,
-                                 lelement_id, ts, num_children, fam) < 0) {
+                                 lelement_id, ts, num_siblings, fam) < 0) {
       /* Coarsen the element */
-      *el_inserted -= num_children - 1;
-      /* remove num_children - 1 elements from the array */
+      *el_inserted -= num_siblings - 1;
+      /* remove num_siblings - 1 elements from the array */
       T8_ASSERT (elements_in_array == t8_element_array_get_count (telements));
       ts->t8_element_parent (fam[0], fam[0]);
-      elements_in_array -= num_children - 1;
+      elements_in_array -= num_siblings - 1;
       t8_element_array_resize (telements, elements_in_array);
+      t8_forest_adapt_runs_fold (forest, el_offset + pos, num_siblings);
       /* Set element to the new constructed parent. Since resizing the array
        * may change the position in memory, we have to do it after resizing. */
       element = t8_element_array_index_locidx (telements, pos);
+      child_id = ts->t8_element_child_id (element);
+      if (child_id > 0) {
+        num_siblings = ts->t8_element_num_siblings (element);
+      }
     }
     else {
       /* If the elements are no family or
        * the family is not to be coarsened we abort the coarsening process */
       isfamily = 0;
     }
-    pos -= num_children - 1;
+    pos -= num_siblings - 1;
   }
 }
 
-/* Check the lastly inserted element of an array for recursive refining.
+/* Push the children of an element onto a stack of elements, such that
+ * the first child is on top of the stack.
+ * \param [in] ts         The scheme of the element.
+ * \param [in] element    The element to refine. It must not be stored in
+ *                        \a refine_stack.
+ * \param [in,out] refine_stack The stack of elements to check for refinement.
+ */
+static void
+t8_forest_adapt_push_children (t8_eclass_scheme_c * ts,
+                               const t8_element_t * element,
+                               t8_element_array_t * refine_stack)
+{
+  t8_element_t       *children[T8_ECLASS_MAX_CHILDREN];
+  size_t              top;
+  int                 ci, num_children;
+
+  num_children = ts->t8_element_num_children (element);
+  T8_ASSERT (num_children <= T8_ECLASS_MAX_CHILDREN);
+  top = t8_element_array_get_count (refine_stack);
+  (void) t8_element_array_push_count (refine_stack, num_children);
+  /* Pointers into the array are only valid after pushing */
+  for (ci = 0; ci < num_children; ci++) {
+    children[ci] =
+      t8_element_array_index_locidx (refine_stack,
+                                     top + num_children - 1 - ci);
+  }
+  ts->t8_element_children (element, num_children, children);
+}
+
+/* Check the elements of a stack for recursive refining.
+ * The elements are processed depth first, such that they are inserted into
+ * \a telements in linear order. The memory of the stack is reused for all
+ * elements, such that no element is allocated individually.
  * \param [in] forest  The new forest currently in construction.
  * \param [in] ltreeid The current local tree.
  * \param [in] lelement_id The id of the currently coarsened element in the tree of the original forest.
  * \param [in] ts      The scheme for this local tree.
- * \param [in] elem_list Helper list to temporarily insert the newly refined elements.
- *                       These will eventually get copied to \a telements.
+ * \param [in,out] refine_stack Stack of the newly refined elements, the top element
+ *                       is the last one. On output the stack is empty.
  * \param [in] telements The array of newly created (adapted) elements.
  *                      The last inserted element must be the last child in its family.
  * \param [in,out] num_inserted On input the number of elements in \a telement, on output
  *                        the new number of elements (so it will be smaller or equal to its input).
- * \param [in] el_buffer Enough buffer space to store all children of the lastly created element.
+ * \param [in] el_buffer Buffer to store one element, which is the currently
+ *                      checked one.
  */
 static void
 t8_forest_adapt_refine_recursive (t8_forest_t forest, t8_locidx_t ltreeid,
                                   t8_locidx_t lelement_id,
                                   t8_eclass_scheme_c * ts,
-                                  sc_list_t * elem_list,
+                                  t8_element_array_t * refine_stack,
                                   t8_element_array_t * telements,
                                   t8_locidx_t * num_inserted,
                                   t8_element_t ** el_buffer)
 {
   t8_element_t       *insert_el;
-  int                 num_children;
-  int                 ci;
+  size_t              top;
 
-  if (elem_list->elem_count <= 0) {
-    return;
-  }
-  while (elem_list->elem_count > 0) {
-    /* Until the list is empty we
-     * - remove the first element from the list.
+  while ((top = t8_element_array_get_count (refine_stack)) > 0) {
+    /* Until the stack is empty we
+     * - remove the top element from the stack.
      * - Check whether it should get refined
-     * - If yes, we add all its children to the list
+     * - If yes, we push all its children onto the stack
      * - If no, we add the element to the array of new elements
      */
-    el_buffer[0] = (t8_element_t *) sc_list_pop (elem_list);
-    num_children = ts->t8_element_num_children (el_buffer[0]);
+    ts->t8_element_copy (t8_element_array_index_locidx (refine_stack,
+                                                        top - 1),
+                         el_buffer[0]);
+    t8_element_array_resize (refine_stack, top - 1);
     if (forest->set_adapt_fn (forest, forest->set_from, ltreeid, lelement_id,
                               ts, 1, el_buffer) > 0) {
       /* The element should be refined */
       if (ts->t8_element_level (el_buffer[0]) < forest->maxlevel) {
         /* only refine, if we do not exceed the maximum allowed level */
-        /* Create the children and add them to the list */
-        ts->t8_element_new (num_children - 1, el_buffer + 1);
-        ts->t8_element_children (el_buffer[0], num_children, el_buffer);
-        for (ci = num_children - 1; ci >= 0; ci--) {
-          (void) sc_list_prepend (elem_list, el_buffer[ci]);
+        t8_forest_adapt_push_children (ts, el_buffer[0], refine_stack);
+        continue;
+      }
+    }
+    /* This element should not get refined,
+     * we add it to the array of new elements. */
+    insert_el = t8_element_array_push (telements);
+    ts->t8_element_copy (el_buffer[0], insert_el);
+    (*num_inserted)++;
+  }
+}
+
+/* Load the element at position \a el_considered of an element array and at
+ * most num_siblings - 1 many following ones into the \a elements_from buffer.
+ * Stop when we are certain that they cannot form a family.
+ * \param [in] tscheme  The scheme of the tree.
+ * \param [in] telements_from The elements of the tree in the original forest.
+ * \param [in] el_considered The index of the first element to consider.
+ * \param [out] elements_from On output the considered element(s).
+ * \param [in,out] child_ids Buffer for T8_ECLASS_MAX_CHILDREN child ids.
+ * \param [out] num_siblings The number of siblings of the considered element.
+ * \return The number of elements to pass to the adapt callback, that is
+ *         \a num_siblings if the elements form a family and 1 otherwise.
+ */
+static int
+t8_forest_adapt_get_candidates (t8_eclass_scheme_c * tscheme,
+                                t8_element_array_t * telements_from,
+                                t8_locidx_t el_considered,
+                                t8_element_t ** elements_from,
+                                int *child_ids, size_t *num_siblings)
+{
+  t8_locidx_t         num_el_from;
+  int                 num_candidates;
+  size_t              zz;
+
+  num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+  *num_siblings =
+    tscheme->t8_element_num_siblings (t8_element_array_index_locidx
+                                      (telements_from, el_considered));
+  T8_ASSERT (*num_siblings <= T8_ECLASS_MAX_CHILDREN);
+  /* Compute the child ids of all candidates with one call to the scheme,
+   * the elements are stored contiguously in the tree's element array. */
+  num_candidates =
+    (int) SC_MIN ((t8_locidx_t) * num_siblings, num_el_from - el_considered);
+  tscheme->t8_element_batch_child_id (t8_element_array_index_locidx
+                                      (telements_from, el_considered),
+                                      num_candidates, child_ids);
+  for (zz = 0; zz < (size_t) num_candidates; zz++) {
+    elements_from[zz] = t8_element_array_index_locidx (telements_from,
+                                                       el_considered + zz);
+    if ((size_t) child_ids[zz] != zz) {
+      break;
+    }
+  }
+  if (zz != *num_siblings) {
+    /* We are certain that the elements do not form a family.
+     * So we will only pass the first element to the adapt callback. */
+    return 1;
+  }
+  T8_ASSERT (tscheme->t8_element_is_family (elements_from));
+  return (int) *num_siblings;
+}
+
+/* The number of child ids that t8_forest_adapt_family_sizes computes
+ * with one call to the scheme */
+#define T8_FOREST_ADAPT_FAMILY_BLOCK 256
+
+/* Find all families among the elements first, ..., last - 1 of a tree.
+ * A family starts at position i if the child ids of the elements
+ * i, ..., i + n - 1 are 0, ..., n - 1, where n is the number of siblings
+ * of the i-th element.
+ * The child ids are computed blockwise with t8_element_batch_child_id and
+ * the number of siblings is only queried for elements with child id 0.
+ * \param [out] family_sizes On output family_sizes[i] is the number of
+ *                      siblings if a family starts at position i and 0
+ *                      otherwise, for first <= i < last.
+ * Since only stack memory is used, this function can be called for
+ * disjoint ranges from multiple threads.
+ */
+static void
+t8_forest_adapt_family_sizes (t8_eclass_scheme_c * tscheme,
+                              t8_element_array_t * telements_from,
+                              t8_locidx_t first, t8_locidx_t last,
+                              int8_t * family_sizes)
+{
+  int                 child_ids[T8_FOREST_ADAPT_FAMILY_BLOCK];
+  t8_locidx_t         block, ielem, family_first;
+  int                 num_block, ib, num_siblings;
+
+  family_first = -1;
+  num_siblings = 0;
+  for (block = first; block < last; block += num_block) {
+    num_block = (int) SC_MIN (T8_FOREST_ADAPT_FAMILY_BLOCK, last - block);
+    tscheme->t8_element_batch_child_id (t8_element_array_index_locidx
+                                        (telements_from, block), num_block,
+                                        child_ids);
+    for (ib = 0; ib < num_block; ib++) {
+      ielem = block + ib;
+      family_sizes[ielem] = 0;
+      if (child_ids[ib] == 0) {
+        family_first = ielem;
+        num_siblings =
+          tscheme->t8_element_num_siblings (t8_element_array_index_locidx
+                                            (telements_from, ielem));
+        T8_ASSERT (num_siblings <= T8_ECLASS_MAX_CHILDREN);
+      }
+      else if (family_first < 0 || child_ids[ib] != ielem - family_first) {
+        family_first = -1;
+        continue;
+      }
+      if (ielem - family_first + 1 == num_siblings) {
+        family_sizes[family_first] = (int8_t) num_siblings;
+        family_first = -1;
+      }
+    }
+  }
+}
+
+/* Load the candidates for the adapt callback at position \a el_considered
+ * into \a elements_from, given the family sizes computed by
+ * t8_forest_adapt_family_sizes.
+ * \return The number of elements to pass to the adapt callback.
+ */
+static int
+t8_forest_adapt_load_candidates (t8_eclass_scheme_c * tscheme,
+                                 t8_element_array_t * telements_from,
+                                 t8_locidx_t el_considered, int family_size,
+                                 t8_element_t ** elements_from)
+{
+  int                 num_elements, ie;
+
+  num_elements = SC_MAX (family_size, 1);
+  for (ie = 0; ie < num_elements; ie++) {
+    elements_from[ie] = t8_element_array_index_locidx (telements_from,
+                                                       el_considered + ie);
+  }
+  T8_ASSERT (family_size == 0
+             || tscheme->t8_element_is_family (elements_from));
+  return num_elements;
+}
+
+/* Return the number of elements that an element is replaced with
+ * if it is refined \a depth times. */
+static              t8_locidx_t
+t8_forest_adapt_num_refined (t8_eclass_scheme_c * tscheme,
+                             const t8_element_t * element, int depth)
+{
+  T8_ASSERT (depth > 0);
+  if (depth == 1) {
+    return tscheme->t8_element_num_children (element);
+  }
+  return (t8_locidx_t) tscheme->t8_element_count_leafs (element,
+                                                        tscheme->
+                                                        t8_element_level
+                                                        (element) + depth);
+}
+
+/* Replace an element by its descendants of \a depth levels finer and
+ * store them in \a telements starting at position \a el_inserted.
+ * \a element must not be stored in this range of \a telements.
+ * \return The number of inserted elements.
+ */
+static              t8_locidx_t
+t8_forest_adapt_refine_element (t8_eclass_scheme_c * tscheme,
+                                const t8_element_t * element, int depth,
+                                t8_element_array_t * telements,
+                                t8_locidx_t el_inserted)
+{
+  t8_element_t       *elements[T8_ECLASS_MAX_CHILDREN];
+  t8_locidx_t         num_refined, ielem;
+  int                 ci, level;
+
+  num_refined = t8_forest_adapt_num_refined (tscheme, element, depth);
+  if (depth == 1) {
+    T8_ASSERT (num_refined <= T8_ECLASS_MAX_CHILDREN);
+    for (ci = 0; ci < num_refined; ci++) {
+      elements[ci] =
+        t8_element_array_index_locidx (telements, el_inserted + ci);
+    }
+    tscheme->t8_element_children (element, num_refined, elements);
+  }
+  else {
+    /* Walk along the space-filling curve from the first descendant */
+    level = tscheme->t8_element_level (element) + depth;
+    tscheme->t8_element_first_descendant (element,
+                                          t8_element_array_index_locidx
+                                          (telements, el_inserted), level);
+    for (ielem = 1; ielem < num_refined; ielem++) {
+      tscheme->t8_element_successor (t8_element_array_index_locidx
+                                     (telements, el_inserted + ielem - 1),
+                                     t8_element_array_index_locidx
+                                     (telements, el_inserted + ielem),
+                                     level);
+    }
+  }
+  return num_refined;
+}
+
+/* Query the adapt callback for the elements first, ..., last - 1 of a tree
+ * of forest->set_from and store the result in \a tree_flags.
+ * For the element at position i of the tree, tree_flags[i] is set to
+ *  k > 0 if it is refined k times (only k = 1 here),
+ *  0 if it is kept,
+ * -1 if it is the first element of a family that is coarsened.
+ * The flags of the other elements of a coarsened family are not set.
+ * No family may cross the position \a last.
+ * Since only stack memory is used, this function can be called for
+ * disjoint ranges from multiple threads.
+ * \return The number of elements that the range is adapted to.
+ */
+static              t8_locidx_t
+t8_forest_adapt_query (t8_forest_t forest, t8_locidx_t ltree_id,
+                       t8_eclass_scheme_c * tscheme,
+                       t8_element_array_t * telements_from,
+                       t8_locidx_t first, t8_locidx_t last,
+                       int8_t * tree_flags)
+{
+  t8_element_t       *elements_from[T8_ECLASS_MAX_CHILDREN];
+  t8_locidx_t         el_considered, num_el_new;
+  int                 num_elements;
+  int                 refine;
+
+  /* Find the families first, their sizes are stored in tree_flags and
+   * overwritten by the flags below. */
+  t8_forest_adapt_family_sizes (tscheme, telements_from, first, last,
+                                tree_flags);
+  num_el_new = 0;
+  el_considered = first;
+  while (el_considered < last) {
+    num_elements =
+      t8_forest_adapt_load_candidates (tscheme, telements_from,
+                                       el_considered,
+                                       tree_flags[el_considered],
+                                       elements_from);
+    refine =
+      forest->set_adapt_fn (forest, forest->set_from, ltree_id,
+                            el_considered, tscheme, num_elements,
+                            elements_from);
+    T8_ASSERT (num_elements > 1 || refine >= 0);
+    if (refine > 0 && tscheme->t8_element_level (elements_from[0]) >=
+        forest->maxlevel) {
+      /* Only refine an element if it does not exceed the maximum level */
+      refine = 0;
+    }
+    if (refine > 0) {
+      tree_flags[el_considered] = 1;
+      num_el_new += tscheme->t8_element_num_children (elements_from[0]);
+      el_considered++;
+    }
+    else if (refine < 0) {
+      tree_flags[el_considered] = -1;
+      num_el_new++;
+      el_considered += num_elements;
+    }
+    else {
+      tree_flags[el_considered] = 0;
+      num_el_new++;
+      el_considered++;
+    }
+  }
+  T8_ASSERT (el_considered == last);
+  return num_el_new;
+}
+
+/* Convert refinement markers of the elements first, ..., last - 1 of a
+ * tree of forest->set_from to flags as in t8_forest_adapt_query.
+ * markers[i] = k > 0 refines the i-th element k times, but not beyond
+ * \a max_level and the maximum level of the forest. A family is coarsened
+ * if all of its members have negative markers.
+ * As t8_forest_adapt_query, this function can be called for disjoint
+ * ranges from multiple threads.
+ * \return The number of elements that the range is adapted to.
+ */
+static              t8_locidx_t
+t8_forest_adapt_markers_query (t8_forest_t forest,
+                               t8_eclass_scheme_c * tscheme,
+                               t8_element_array_t * telements_from,
+                               t8_locidx_t first, t8_locidx_t last,
+                               const int8_t * markers, int max_level,
+                               int8_t * tree_flags)
+{
+  t8_element_t       *elements_from[T8_ECLASS_MAX_CHILDREN];
+  t8_locidx_t         el_considered, num_el_new;
+  int                 num_elements, ie;
+  int                 depth;
+
+  if (max_level < 0 || max_level > forest->maxlevel) {
+    max_level = forest->maxlevel;
+  }
+  /* Find the families first, their sizes are stored in tree_flags and
+   * overwritten by the flags below. */
+  t8_forest_adapt_family_sizes (tscheme, telements_from, first, last,
+                                tree_flags);
+  num_el_new = 0;
+  el_considered = first;
+  while (el_considered < last) {
+    num_elements =
+      t8_forest_adapt_load_candidates (tscheme, telements_from,
+                                       el_considered,
+                                       tree_flags[el_considered],
+                                       elements_from);
+    if (num_elements > 1) {
+      /* Coarsen the family if all of its members are marked */
+      for (ie = 0; ie < num_elements; ie++) {
+        if (markers[el_considered + ie] >= 0) {
+          break;
         }
       }
+      if (ie == num_elements) {
+        tree_flags[el_considered] = -1;
+        num_el_new++;
+        el_considered += num_elements;
+        continue;
+      }
+    }
+    /* Only refine an element if it does not exceed the maximum level */
+    depth = SC_MIN (markers[el_considered],
+                    max_level - tscheme->t8_element_level (elements_from[0]));
+    if (depth > 0) {
+      tree_flags[el_considered] = depth;
+      num_el_new +=
+        t8_forest_adapt_num_refined (tscheme, elements_from[0], depth);
     }
     else {
-      /* This element should not get refined,
-       * we remove it from the buffer and add it to the array of new elements. */
-      insert_el = t8_element_array_push (telements);
-      ts->t8_element_copy (el_buffer[0], insert_el);
-      ts->t8_element_destroy (1, el_buffer);
-      (*num_inserted)++;
+      tree_flags[el_considered] = 0;
+      num_el_new++;
     }
+    el_considered++;
   }
+  T8_ASSERT (el_considered == last);
+  return num_el_new;
 }
 
-/* TODO: optimize this when we own forest_from */
-void
-t8_forest_adapt (t8_forest_t forest)
+/* Call the batched adapt callback for all elements of a tree of
+ * forest->set_from and convert the markers to flags as in
+ * t8_forest_adapt_query.
+ * \return The number of elements that the tree is adapted to.
+ */
+static              t8_locidx_t
+t8_forest_adapt_batch_query (t8_forest_t forest, t8_locidx_t ltree_id,
+                             t8_eclass_scheme_c * tscheme,
+                             t8_element_array_t * telements_from,
+                             int8_t * tree_flags)
+{
+  t8_locidx_t         ielem, num_el_from, num_el_new;
+  int8_t             *tree_markers;
+  int                *markers;
+
+  T8_ASSERT (forest->set_adapt_batch_fn != NULL);
+  num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+  if (num_el_from == 0) {
+    return 0;
+  }
+  markers = T8_ALLOC_ZERO (int, num_el_from);
+  forest->set_adapt_batch_fn (forest, forest->set_from, ltree_id, tscheme,
+                              num_el_from,
+                              t8_element_array_get_data (telements_from),
+                              markers);
+  /* The batched callback can only refine once */
+  tree_markers = T8_ALLOC (int8_t, num_el_from);
+  for (ielem = 0; ielem < num_el_from; ielem++) {
+    tree_markers[ielem] = (markers[ielem] > 0) - (markers[ielem] < 0);
+  }
+  num_el_new =
+    t8_forest_adapt_markers_query (forest, tscheme, telements_from, 0,
+                                   num_el_from, tree_markers, -1,
+                                   tree_flags);
+  T8_FREE (markers);
+  T8_FREE (tree_markers);
+  return num_el_new;
+}
+
+/* Compute the flags of all elements of a tree of forest->set_from with the
+ * adapt callback, the batched adapt callback or the markers.
+ * \return The number of elements that the tree is adapted to.
+ */
+static              t8_locidx_t
+t8_forest_adapt_tree_flags (t8_forest_t forest, t8_locidx_t ltree_id,
+                            t8_eclass_scheme_c * tscheme,
+                            t8_element_array_t * telements_from,
+                            int8_t * tree_flags)
+{
+  if (forest->set_adapt_batch_fn != NULL) {
+    return t8_forest_adapt_batch_query (forest, ltree_id, tscheme,
+                                        telements_from, tree_flags);
+  }
+  if (forest->set_adapt_markers != NULL) {
+    const t8_tree_t     tree_from =
+      t8_forest_get_tree (forest->set_from, ltree_id);
+
+    return t8_forest_adapt_markers_query (forest, tscheme, telements_from,
+                                          0, (t8_locidx_t)
+                                          t8_element_array_get_count
+                                          (telements_from),
+                                          forest->set_adapt_markers +
+                                          tree_from->elements_offset,
+                                          forest->set_adapt_markers_maxlevel,
+                                          tree_flags);
+  }
+  return t8_forest_adapt_query (forest, ltree_id, tscheme, telements_from, 0,
+                                (t8_locidx_t)
+                                t8_element_array_get_count (telements_from),
+                                tree_flags);
+}
+
+/* Record the runs of the elements first, ..., last - 1 of a tree of
+ * forest->set_from from the flags computed by t8_forest_adapt_query.
+ * \a offset_from is the local index of the first element of the tree in
+ * forest->set_from and \a first_new the local index in forest of the first
+ * new element of the range. */
+static void
+t8_forest_adapt_runs_from_flags (t8_forest_t forest,
+                                 t8_eclass_scheme_c * tscheme,
+                                 t8_element_array_t * telements_from,
+                                 t8_locidx_t first, t8_locidx_t last,
+                                 const int8_t * tree_flags,
+                                 t8_locidx_t offset_from,
+                                 t8_locidx_t first_new)
+{
+  t8_element_t       *element_from;
+  t8_locidx_t         el_considered, num_new;
+  int                 num_siblings;
+
+  if (forest->adapt_runs == NULL) {
+    return;
+  }
+  el_considered = first;
+  while (el_considered < last) {
+    element_from =
+      t8_element_array_index_locidx (telements_from, el_considered);
+    if (tree_flags[el_considered] > 0) {
+      num_new = t8_forest_adapt_num_refined (tscheme, element_from,
+                                             tree_flags[el_considered]);
+      t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_REFINED,
+                                offset_from + el_considered, 1, first_new,
+                                num_new);
+      first_new += num_new;
+      el_considered++;
+    }
+    else if (tree_flags[el_considered] < 0) {
+      num_siblings = tscheme->t8_element_num_siblings (element_from);
+      t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_COARSENED,
+                                offset_from + el_considered, num_siblings,
+                                first_new, 1);
+      first_new++;
+      el_considered += num_siblings;
+    }
+    else {
+      t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_UNCHANGED,
+                                offset_from + el_considered, 1, first_new, 1);
+      first_new++;
+      el_considered++;
+    }
+  }
+  T8_ASSERT (el_considered == last);
+}
+
+/* Create the new elements of the elements first, ..., last - 1 of a tree
+ * of forest->set_from from the flags computed by t8_forest_adapt_query.
+ * The new elements are written to \a telements starting at position
+ * \a el_inserted. Runs of kept elements are copied as a whole.
+ * This function can be called for disjoint ranges from multiple threads.
+ */
+static void
+t8_forest_adapt_fill (t8_eclass_scheme_c * tscheme,
+                      t8_element_array_t * telements_from,
+                      t8_locidx_t first, t8_locidx_t last,
+                      const int8_t * tree_flags,
+                      t8_element_array_t * telements,
+                      t8_locidx_t el_inserted)
+{
+  t8_element_t       *element_from;
+  t8_locidx_t         el_considered, el_run;
+  size_t              element_size;
+
+  element_size = tscheme->t8_element_size ();
+  el_considered = first;
+  while (el_considered < last) {
+    element_from =
+      t8_element_array_index_locidx (telements_from, el_considered);
+    if (tree_flags[el_considered] > 0) {
+      /* Add the children or finer descendants of the element */
+      el_inserted +=
+        t8_forest_adapt_refine_element (tscheme, element_from,
+                                        tree_flags[el_considered],
+                                        telements, el_inserted);
+      el_considered++;
+    }
+    else if (tree_flags[el_considered] < 0) {
+      /* Add the parent of the family */
+      tscheme->t8_element_parent (element_from,
+                                  t8_element_array_index_locidx (telements,
+                                                                 el_inserted));
+      el_inserted++;
+      el_considered += tscheme->t8_element_num_siblings (element_from);
+    }
+    else {
+      /* Copy the run of kept elements */
+      el_run = el_considered;
+      while (el_considered < last && tree_flags[el_considered] == 0) {
+        el_considered++;
+      }
+      memcpy (t8_element_array_index_locidx (telements, el_inserted),
+              element_from, (el_considered - el_run) * element_size);
+      el_inserted += el_considered - el_run;
+    }
+  }
+  T8_ASSERT (el_considered == last);
+}
+
+#ifdef T8_ENABLE_OPENMP
+/* The minimum number of elements in a chunk for the threaded adaptation */
+#define T8_FOREST_ADAPT_CHUNK_SIZE 1024
+
+/* A range of elements of a tree that is adapted by one thread */
+typedef struct
+{
+  t8_locidx_t         ltree_id;         /**< The local tree of the chunk */
+  t8_locidx_t         first;            /**< The first element of the chunk in the tree */
+  t8_locidx_t         last;             /**< One after the last element of the chunk in the tree */
+  t8_locidx_t         flag_offset;      /**< The position of the tree's flags in the flag array */
+  t8_locidx_t         el_inserted;      /**< On output the number of new elements of the chunk,
+                                             after the prefix sum its first new element in the tree */
+  t8_locidx_t         num_inserted;     /**< The number of new elements of the chunk */
+} t8_forest_adapt_chunk_t;
+
+/* Adapt forest->set_from non-recursively with multiple threads.
+ * The local elements are split into chunks that end in front of an element
+ * with child id 0, so that no family is cut. Since only the first element
+ * of a family has child id 0, no element of a chunk can be consumed
+ * by the coarsening of a family of another chunk.
+ * We query the adapt callback, or convert the markers if they are given,
+ * for all chunks in parallel, compute the
+ * position of the new elements of each chunk with a prefix sum, and
+ * then create the new elements of all chunks in parallel.
+ * Since each chunk only depends on its own elements, the result is
+ * the same as that of the serial adaptation.
+ * The memory of the new elements is allocated without touching it, and
+ * each thread initializes the new elements of its chunks itself. Thus on
+ * NUMA systems the pages are placed on the memory domain of the thread
+ * that fills them. Both loops over the chunks are scheduled statically,
+ * such that each thread works on about the same contiguous range of
+ * elements as the thread that created them in the previous adaptation.
+ */
+static void
+t8_forest_adapt_threaded (t8_forest_t forest)
 {
   t8_forest_t         forest_from;
-  sc_list_t          *refine_list = NULL;       /* This is only needed when we adapt recursively */
+  t8_element_array_t *telements_from;
+  t8_locidx_t         ltree_id, num_trees;
+  t8_locidx_t         num_el_from, num_el_new;
+  t8_locidx_t         first, last, el_offset, flag_offset;
+  t8_locidx_t         ichunk, num_chunks;
+  t8_tree_t           tree, tree_from;
+  t8_eclass_scheme_c *tscheme;
+  t8_forest_adapt_chunk_t *chunk;
+  sc_array_t          chunks;
+  int8_t             *refine_flags;
+  int                 num_threads;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (!forest->set_adapt_recursive);
+  num_threads = t8_forest_get_num_threads (forest);
+
+  /* Split the elements of all trees into chunks */
+  num_trees = t8_forest_get_num_local_trees (forest);
+  sc_array_init (&chunks, sizeof (t8_forest_adapt_chunk_t));
+  flag_offset = 0;
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree_from = t8_forest_get_tree (forest_from, ltree_id);
+    telements_from = &tree_from->elements;
+    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+    tscheme = t8_forest_get_eclass_scheme (forest_from, tree_from->eclass);
+    for (first = 0; first < num_el_from; first = last) {
+      last = SC_MIN (first + T8_FOREST_ADAPT_CHUNK_SIZE, num_el_from);
+      while (last < num_el_from && tscheme->t8_element_child_id
+             (t8_element_array_index_locidx (telements_from, last)) != 0) {
+        last++;
+      }
+      chunk = (t8_forest_adapt_chunk_t *) sc_array_push (&chunks);
+      chunk->ltree_id = ltree_id;
+      chunk->first = first;
+      chunk->last = last;
+      chunk->flag_offset = flag_offset;
+    }
+    flag_offset += num_el_from;
+  }
+  T8_ASSERT (flag_offset == forest_from->local_num_elements);
+  num_chunks = (t8_locidx_t) chunks.elem_count;
+  refine_flags = T8_ALLOC (int8_t, SC_MAX (flag_offset, 1));
+
+  /* Query the adapt callback for all chunks */
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+    t8_forest_adapt_chunk_t *const chunk_q =
+      (t8_forest_adapt_chunk_t *) sc_array_index (&chunks, ichunk);
+    const t8_tree_t     tree_q =
+      t8_forest_get_tree (forest_from, chunk_q->ltree_id);
+
+    t8_eclass_scheme_c *const tscheme_q =
+      t8_forest_get_eclass_scheme (forest_from, tree_q->eclass);
+
+    if (forest->set_adapt_markers != NULL) {
+      chunk_q->el_inserted =
+        t8_forest_adapt_markers_query (forest, tscheme_q, &tree_q->elements,
+                                       chunk_q->first, chunk_q->last,
+                                       forest->set_adapt_markers +
+                                       tree_q->elements_offset,
+                                       forest->set_adapt_markers_maxlevel,
+                                       refine_flags + chunk_q->flag_offset);
+    }
+    else {
+      chunk_q->el_inserted =
+        t8_forest_adapt_query (forest, chunk_q->ltree_id, tscheme_q,
+                               &tree_q->elements, chunk_q->first,
+                               chunk_q->last,
+                               refine_flags + chunk_q->flag_offset);
+    }
+  }
+
+  /* Compute the new element positions and allocate the new trees */
+  forest->local_num_elements = 0;
+  el_offset = 0;
+  ichunk = 0;
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree = t8_forest_get_tree (forest, ltree_id);
+    num_el_new = 0;
+    for (; ichunk < num_chunks; ichunk++) {
+      chunk = (t8_forest_adapt_chunk_t *) sc_array_index (&chunks, ichunk);
+      if (chunk->ltree_id != ltree_id) {
+        break;
+      }
+      chunk->num_inserted = chunk->el_inserted;
+      chunk->el_inserted = num_el_new;
+      num_el_new += chunk->num_inserted;
+    }
+    /* Allocate the new elements without initializing them. This is done
+     * by the threads that fill them, see below. */
+    T8_ASSERT (t8_element_array_get_count (&tree->elements) == 0);
+    sc_array_resize (t8_element_array_get_array (&tree->elements),
+                     num_el_new);
+    tree->elements_offset = el_offset;
+    el_offset += num_el_new;
+    forest->local_num_elements += num_el_new;
+  }
+
+  /* Record the runs of all chunks in order */
+  for (ichunk = 0; forest->adapt_runs != NULL && ichunk < num_chunks;
+       ichunk++) {
+    chunk = (t8_forest_adapt_chunk_t *) sc_array_index (&chunks, ichunk);
+    tree = t8_forest_get_tree (forest, chunk->ltree_id);
+    tree_from = t8_forest_get_tree (forest_from, chunk->ltree_id);
+    t8_forest_adapt_runs_from_flags (forest,
+                                     t8_forest_get_eclass_scheme (forest_from,
+                                                                  tree_from->
+                                                                  eclass),
+                                     &tree_from->elements, chunk->first,
+                                     chunk->last,
+                                     refine_flags + chunk->flag_offset,
+                                     tree_from->elements_offset,
+                                     tree->elements_offset +
+                                     chunk->el_inserted);
+  }
+
+  /* Create the new elements of all chunks. The first touch of their
+   * memory happens here. */
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+    const t8_forest_adapt_chunk_t *const chunk_f =
+      (t8_forest_adapt_chunk_t *) sc_array_index (&chunks, ichunk);
+    const t8_tree_t     tree_f =
+      t8_forest_get_tree (forest, chunk_f->ltree_id);
+    const t8_tree_t     tree_from_f =
+      t8_forest_get_tree (forest_from, chunk_f->ltree_id);
+    t8_eclass_scheme_c *const tscheme_f =
+      t8_forest_get_eclass_scheme (forest_from, tree_from_f->eclass);
+
+    if (chunk_f->num_inserted > 0) {
+      tscheme_f->t8_element_init (chunk_f->num_inserted,
+                                  t8_element_array_index_locidx
+                                  (&tree_f->elements, chunk_f->el_inserted),
+                                  0);
+    }
+    t8_forest_adapt_fill (tscheme_f, &tree_from_f->elements, chunk_f->first,
+                          chunk_f->last,
+                          refine_flags + chunk_f->flag_offset,
+                          &tree_f->elements, chunk_f->el_inserted);
+  }
+
+  /* clean up */
+  T8_FREE (refine_flags);
+  sc_array_reset (&chunks);
+}
+#endif
+
+/* Adapt the elements of forest->set_from in place and let the trees
+ * of forest take over the element memory of forest->set_from.
+ * This is only possible if adaptation is not recursive and set_from
+ * is owned exclusively by forest, since set_from is invalid afterwards.
+ * We first query the adapt callback for all elements of all trees, such
+ * that set_from stays unchanged while the callback is executed.
+ * Then, for each tree, we coarsen with a forward sweep over the elements,
+ * since this can only shrink the array, and refine with a backward sweep over
+ * the compacted elements after growing the array, since the refined elements
+ * can only move towards the end of the array.
+ * Untouched runs of elements are moved as a whole.
+ */
+static void
+t8_forest_adapt_in_place (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_element_array_t *telements_from;
+  t8_locidx_t         ltree_id, num_trees;
+  t8_locidx_t         num_el_from;
+  t8_locidx_t         el_read, el_write, el_run;
+  t8_locidx_t         num_el_new, el_offset, el_offset_from, el_offset_new;
+  t8_tree_t           tree, tree_from;
+  t8_eclass_scheme_c *tscheme;
+  t8_element_t       *parent;
+  size_t              element_size, num_siblings;
+  int8_t             *refine_flags, *tree_flags;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (!forest->set_adapt_recursive);
+  T8_ASSERT (forest_from->rc.refcount == 1);
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  /* The refine flags of all elements of forest_from,
+   * see t8_forest_adapt_query */
+  refine_flags =
+    T8_ALLOC (int8_t, SC_MAX (forest_from->local_num_elements, 1));
+
+  /* Query the adapt callback for all elements */
+  el_offset = el_offset_new = 0;
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree = t8_forest_get_tree (forest, ltree_id);
+    tree_from = t8_forest_get_tree (forest_from, ltree_id);
+    telements_from = &tree_from->elements;
+    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+    tscheme = t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+    num_el_new = t8_forest_adapt_tree_flags (forest, ltree_id, tscheme,
+                                             telements_from,
+                                             refine_flags + el_offset);
+    /* The runs must be recorded before the elements are changed */
+    t8_forest_adapt_runs_from_flags (forest, tscheme, telements_from, 0,
+                                     num_el_from, refine_flags + el_offset,
+                                     el_offset, el_offset_new);
+    el_offset += num_el_from;
+    el_offset_new += num_el_new;
+  }
+  T8_ASSERT (el_offset == forest_from->local_num_elements);
+  /* The old elements are overwritten below, we remove their hashes now */
+  t8_forest_hash_adapt (forest, 0);
+
+  /* Apply the flags to the element arrays of forest_from */
+  forest->local_num_elements = 0;
+  el_offset = el_offset_from = 0;
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree = t8_forest_get_tree (forest, ltree_id);
+    tree_from = t8_forest_get_tree (forest_from, ltree_id);
+    /* The elements may be shared with another forest */
+    t8_forest_tree_unshare_elements (tree_from);
+    telements_from = &tree_from->elements;
+    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+    tscheme = t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+    element_size = tscheme->t8_element_size ();
+    tree_flags = refine_flags + el_offset_from;
+    el_offset_from += num_el_from;
+    /* Forward sweep: Replace coarsened families by their parents and
+     * close the gaps. The flags are compacted alongside the elements. */
+    el_read = el_write = 0;
+    num_el_new = 0;
+    while (el_read < num_el_from) {
+      if (tree_flags[el_read] < 0) {
+        num_siblings =
+          tscheme->t8_element_num_siblings (t8_element_array_index_locidx
+                                            (telements_from, el_read));
+        tscheme->t8_element_parent (t8_element_array_index_locidx
+                                    (telements_from, el_read),
+                                    t8_element_array_index_locidx
+                                    (telements_from, el_write));
+        tree_flags[el_write++] = 0;
+        el_read += num_siblings;
+        num_el_new++;
+      }
+      else {
+        /* Find the run of elements that are refined or kept */
+        el_run = el_read;
+        while (el_read < num_el_from && tree_flags[el_read] >= 0) {
+          num_el_new += tree_flags[el_read] ?
+            t8_forest_adapt_num_refined (tscheme,
+                                         t8_element_array_index_locidx
+                                         (telements_from, el_read),
+                                         tree_flags[el_read]) : 1;
+          el_read++;
+        }
+        if (el_write != el_run) {
+          memmove (t8_element_array_index_locidx (telements_from, el_write),
+                   t8_element_array_index_locidx (telements_from, el_run),
+                   (el_read - el_run) * element_size);
+          memmove (tree_flags + el_write, tree_flags + el_run,
+                   el_read - el_run);
+        }
+        el_write += el_read - el_run;
+      }
+    }
+    if (num_el_new > num_el_from) {
+      /* Make room for the children */
+      t8_element_array_resize (telements_from, num_el_new);
+    }
+    /* Backward sweep: Replace refined elements by their children.
+     * el_write now counts the compacted elements and el_read is the
+     * end of the not yet processed new elements. */
+    el_read = num_el_new;
+    if (el_write < num_el_new) {
+      tscheme->t8_element_new (1, &parent);
+      while (el_write > 0) {
+        if (tree_flags[el_write - 1] > 0) {
+          /* The children may overwrite the element itself */
+          el_write--;
+          tscheme->t8_element_copy (t8_element_array_index_locidx
+                                    (telements_from, el_write), parent);
+          el_read -= t8_forest_adapt_num_refined (tscheme, parent,
+                                                  tree_flags[el_write]);
+          (void) t8_forest_adapt_refine_element (tscheme, parent,
+                                                 tree_flags[el_write],
+                                                 telements_from, el_read);
+        }
+        else {
+          el_run = el_write;
+          while (el_write > 0 && tree_flags[el_write - 1] == 0) {
+            el_write--;
+          }
+          el_read -= el_run - el_write;
+          if (el_read != el_write) {
+            memmove (t8_element_array_index_locidx (telements_from, el_read),
+                     t8_element_array_index_locidx (telements_from,
+                                                    el_write),
+                     (el_run - el_write) * element_size);
+          }
+        }
+      }
+      tscheme->t8_element_destroy (1, &parent);
+    }
+    T8_ASSERT (el_read == el_write);
+    t8_element_array_resize (telements_from, num_el_new);
+    /* The new tree takes over the elements, the old tree is left empty */
+    t8_element_array_reset (&tree->elements);
+    tree->elements = tree_from->elements;
+    t8_element_array_init (&tree_from->elements, tscheme);
+    tree->elements_offset = el_offset;
+    el_offset += num_el_new;
+    forest->local_num_elements += num_el_new;
+  }
+
+  /* clean up */
+  T8_FREE (refine_flags);
+}
+
+/* Adapt forest->set_from non-recursively by first computing the flags of
+ * a tree and then creating its new elements in the element arrays of
+ * forest, leaving set_from unchanged. */
+static void
+t8_forest_adapt_by_flags (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_element_array_t *telements_from;
+  t8_locidx_t         ltree_id, num_trees;
+  t8_locidx_t         num_el_from, num_el_new, el_offset;
+  t8_tree_t           tree, tree_from;
+  t8_eclass_scheme_c *tscheme;
+  int8_t             *tree_flags;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (!forest->set_adapt_recursive);
+
+  forest->local_num_elements = 0;
+  el_offset = 0;
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree = t8_forest_get_tree (forest, ltree_id);
+    tree_from = t8_forest_get_tree (forest_from, ltree_id);
+    telements_from = &tree_from->elements;
+    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+    tscheme = t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+    tree_flags = T8_ALLOC (int8_t, SC_MAX (num_el_from, 1));
+    num_el_new = t8_forest_adapt_tree_flags (forest, ltree_id, tscheme,
+                                             telements_from, tree_flags);
+    t8_forest_adapt_runs_from_flags (forest, tscheme, telements_from, 0,
+                                     num_el_from, tree_flags,
+                                     tree_from->elements_offset, el_offset);
+    t8_element_array_resize (&tree->elements, num_el_new);
+    t8_forest_adapt_fill (tscheme, telements_from, 0, num_el_from,
+                          tree_flags, &tree->elements, 0);
+    T8_FREE (tree_flags);
+    tree->elements_offset = el_offset;
+    el_offset += num_el_new;
+    forest->local_num_elements += num_el_new;
+  }
+}
+
+/* Adapt forest->set_from by creating the new elements in the element
+ * arrays of forest, leaving set_from unchanged. */
+static void
+t8_forest_adapt_copy (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_element_array_t  refine_stack;    /* This is only needed when we adapt recursively */
+  t8_element_t       *refine_element = NULL;
   t8_element_array_t *telements, *telements_from;
   t8_locidx_t         ltree_id, num_trees;
   t8_locidx_t         el_considered;
   t8_locidx_t         el_inserted;
   t8_locidx_t         el_coarsen;
   t8_locidx_t         num_el_from;
-  t8_locidx_t         el_offset;
-  size_t              num_children, zz;
+  t8_locidx_t         el_offset, el_offset_from;
+  t8_locidx_t         el_refined;
+  size_t              num_children, num_siblings, zz;
   t8_tree_t           tree, tree_from;
   t8_eclass_scheme_c *tscheme;
   t8_element_t      **elements, **elements_from;
+  int                *child_ids;
   int                 refine;
-  int                 ci;
   int                 num_elements;
-#ifdef T8_ENABLE_DEBUG
-  int                 is_family;
-#endif
-
-  T8_ASSERT (forest != NULL);
-  T8_ASSERT (forest->set_from != NULL);
-  T8_ASSERT (forest->set_adapt_recursive != -1);
-
-  /* if profiling is enabled, measure runtime */
-  if (forest->profile != NULL) {
-    forest->profile->adapt_runtime = -sc_MPI_Wtime ();
-    /* DO NOT DELETE THE FOLLOWING line.
-     * even if you do not want this output. It fixes a bug that occured on JUQUEEN, where the
-     * runtimes were computed to 0.
-     * Only delete the line, if you know what you are doing. */
-    t8_global_productionf ("Start adadpt %f %f\n", sc_MPI_Wtime (),
-                           forest->profile->adapt_runtime);
-  }
 
   forest_from = forest->set_from;
-  t8_global_productionf ("Into t8_forest_adapt from %lld total elements\n",
-                         (long long) forest_from->global_num_elements);
-
-  /* TODO: Allocate memory for the trees of forest.
-   * Will we do this here or in an extra function? */
-  T8_ASSERT (forest->trees->elem_count == forest_from->trees->elem_count);
-
-  if (forest->set_adapt_recursive) {
-    refine_list = sc_list_new (NULL);
-  }
   forest->local_num_elements = 0;
   el_offset = 0;
   num_trees = t8_forest_get_num_local_trees (forest);
@@ -240,6 +1229,8 @@ t8_forest_adapt (t8_forest_t forest)
                t8_forest_get_tree_num_elements (forest_from, ltree_id));
     /* Get the element scheme for this tree */
     tscheme = t8_forest_get_eclass_scheme (forest_from, tree->eclass);
+    /* The local index of the first element of the old tree */
+    el_offset_from = tree_from->elements_offset;
     /* Index of the element we currently consider for refinement/coarsening. */
     el_considered = 0;
     /* Index into the newly inserted elements */
@@ -247,44 +1238,32 @@ t8_forest_adapt (t8_forest_t forest)
     /* el_coarsen is the index of the first element in the new element
      * array which could be coarsened recursively. */
     el_coarsen = 0;
-    /* TODO: this will generate problems with pyramidal elements */
-    num_children =
-      tscheme->t8_element_num_children (t8_element_array_index_locidx
-                                        (telements_from, 0));
+    /* We expect the new tree to have about as many elements as the old one,
+     * so we allocate them at once instead of growing the array repeatedly */
+    t8_element_array_reserve (telements, num_el_from);
+    /* The number of children may differ between the elements of a tree,
+     * thus we allocate the buffers for the maximum number of children. */
     /* Buffer for a family of new elements */
-    elements = T8_ALLOC (t8_element_t *, num_children);
+    elements = T8_ALLOC (t8_element_t *, T8_ECLASS_MAX_CHILDREN);
     /* Buffer for a family of old elements */
-    elements_from = T8_ALLOC (t8_element_t *, num_children);
+    elements_from = T8_ALLOC (t8_element_t *, T8_ECLASS_MAX_CHILDREN);
+    /* Buffer for the child ids of the old elements */
+    child_ids = T8_ALLOC (int, T8_ECLASS_MAX_CHILDREN);
+    if (forest->set_adapt_recursive) {
+      /* The stack of elements to check for recursive refinement and
+       * a buffer for the currently checked element. */
+      t8_element_array_init (&refine_stack, tscheme);
+      tscheme->t8_element_new (1, &refine_element);
+    }
     /* We now iterate over all elements in this tree and check them for refinement/coarsening. */
     while (el_considered < num_el_from) {
-#ifdef T8_ENABLE_DEBUG
-      /* Will get set to 0 later if this is not a family */
-      is_family = 1;
-#endif
-      /* Load the current element and at most num_children-1 many others into
-       * the elements_from buffer. Stop when we are certain that they cannot from
-       * a family.
-       * At the end is_family will be true, if these elements form a family.
-       */
-      num_elements = num_children;
-      for (zz = 0; zz < num_children &&
-           el_considered + (t8_locidx_t) zz < num_el_from; zz++) {
-        elements_from[zz] = t8_element_array_index_locidx (telements_from,
-                                                           el_considered +
-                                                           zz);
-        if ((size_t) tscheme->t8_element_child_id (elements_from[zz]) != zz) {
-          break;
-        }
-      }
-      if (zz != num_children) {
-        /* We are certain that the elements do not form a family.
-         * So we will only pass the first element to the adapt callback. */
-        num_elements = 1;
-#ifdef T8_ENABLE_DEBUG
-        is_family = 0;
-#endif
-      }
-      T8_ASSERT (!is_family || tscheme->t8_element_is_family (elements_from));
+      /* Load the current element and at most num_siblings-1 many others into
+       * the elements_from buffer. If they form a family, all of them are
+       * passed to the adapt callback. */
+      num_elements =
+        t8_forest_adapt_get_candidates (tscheme, telements_from,
+                                        el_considered, elements_from,
+                                        child_ids, &num_siblings);
       /* Pass the element, or the family to the adapt callback.
        * The output will be > 0 if the element should be refined
        *                    = 0 if the element should remain as is
@@ -294,7 +1273,7 @@ t8_forest_adapt (t8_forest_t forest)
         forest->set_adapt_fn (forest, forest->set_from, ltree_id,
                               el_considered, tscheme, num_elements,
                               elements_from);
-      T8_ASSERT (is_family || refine >= 0);
+      T8_ASSERT (num_elements > 1 || refine >= 0);
       if (refine > 0 && tscheme->t8_element_level (elements_from[0]) >=
           forest->maxlevel) {
         /* Only refine an element if it does not exceed the maximum level */
@@ -302,21 +1281,24 @@ t8_forest_adapt (t8_forest_t forest)
       }
       if (refine > 0) {
         /* The first element is to be refined */
+        num_children = tscheme->t8_element_num_children (elements_from[0]);
+        T8_ASSERT (num_children <= T8_ECLASS_MAX_CHILDREN);
         if (forest->set_adapt_recursive) {
-          /* Create the children of this element */
-          tscheme->t8_element_new (num_children, elements);
-          tscheme->t8_element_children (elements_from[0], num_children,
-                                        elements);
-          for (ci = num_children - 1; ci >= 0; ci--) {
-            /* Prepend the children to the refine_list.
-             * These should now be the only elements in the list.
-             */
-            (void) sc_list_prepend (refine_list, elements[ci]);
-          }
+          /* Push the children of this element onto the refine_stack.
+           * These should now be the only elements on the stack. */
+          T8_ASSERT (t8_element_array_get_count (&refine_stack) == 0);
+          el_refined = el_inserted;
+          t8_forest_adapt_push_children (tscheme, elements_from[0],
+                                         &refine_stack);
           /* We now recursively check the newly created elements for refinement. */
           t8_forest_adapt_refine_recursive (forest, ltree_id, el_considered,
-                                            tscheme, refine_list, telements,
-                                            &el_inserted, elements);
+                                            tscheme, &refine_stack,
+                                            telements, &el_inserted,
+                                            &refine_element);
+          t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_REFINED,
+                                    el_offset_from + el_considered, 1,
+                                    el_offset + el_refined,
+                                    el_inserted - el_refined);
           /* el_coarsen is the index of the first element in the new element
            * array which could be coarsened recursively.
            * We can set this here to the next element after the current family, since a family that emerges from a refinement will never be coarsened */
@@ -332,6 +1314,9 @@ t8_forest_adapt (t8_forest_t forest)
           }
           tscheme->t8_element_children (elements_from[0], num_children,
                                         elements);
+          t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_REFINED,
+                                    el_offset_from + el_considered, 1,
+                                    el_offset + el_inserted, num_children);
           el_inserted += num_children;
         }
         el_considered++;
@@ -343,6 +1328,9 @@ t8_forest_adapt (t8_forest_t forest)
         /* Compute the parent of the current family.
          * This parent is now inserted in telements. */
         tscheme->t8_element_parent (elements_from[0], elements[0]);
+        t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_COARSENED,
+                                  el_offset_from + el_considered,
+                                  num_siblings, el_offset + el_inserted, 1);
         el_inserted++;
         if (forest->set_adapt_recursive) {
           /* Adaptation is recursive.
@@ -351,14 +1339,16 @@ t8_forest_adapt (t8_forest_t forest)
            * If so, we check this family for recursive coarsening. */
           const int           child_id =
             tscheme->t8_element_child_id (elements[0]);
-          if (child_id > 0 && (size_t) child_id == num_children - 1) {
+          if (child_id > 0 && child_id ==
+              tscheme->t8_element_num_siblings (elements[0]) - 1) {
             t8_forest_adapt_coarsen_recursive (forest, ltree_id,
                                                el_considered, tscheme,
                                                telements, el_coarsen,
-                                               &el_inserted, elements);
+                                               &el_inserted, elements,
+                                               el_offset);
           }
         }
-        el_considered += num_children;
+        el_considered += num_siblings;
       }
       else {
         /* The considered elements are neither to be coarsened nor is the first
@@ -367,23 +1357,31 @@ t8_forest_adapt (t8_forest_t forest)
         T8_ASSERT (refine == 0);
         elements[0] = t8_element_array_push (telements);
         tscheme->t8_element_copy (elements_from[0], elements[0]);
+        t8_forest_adapt_runs_add (forest, T8_FOREST_ADAPT_UNCHANGED,
+                                  el_offset_from + el_considered, 1,
+                                  el_offset + el_inserted, 1);
         el_inserted++;
         const int           child_id =
           tscheme->t8_element_child_id (elements[0]);
         if (forest->set_adapt_recursive && child_id > 0
-            && (size_t) tscheme->t8_element_child_id (elements[0])
-            == num_children - 1) {
+            && child_id == tscheme->t8_element_num_siblings (elements[0])
+            - 1) {
           /* If adaptation is recursive and this was the last element in its
            * family (and not the only one), we need to check for recursive coarsening. */
           t8_forest_adapt_coarsen_recursive (forest, ltree_id, el_considered,
                                              tscheme, telements, el_coarsen,
-                                             &el_inserted, elements);
+                                             &el_inserted, elements,
+                                             el_offset);
         }
         el_considered++;
       }
     }
-    /* Check that if we had recursive adaptation, the refine list is now empty. */
-    T8_ASSERT (!forest->set_adapt_recursive || refine_list->elem_count == 0);
+    if (forest->set_adapt_recursive) {
+      /* Check that the refine stack is now empty. */
+      T8_ASSERT (t8_element_array_get_count (&refine_stack) == 0);
+      t8_element_array_reset (&refine_stack);
+      tscheme->t8_element_destroy (1, &refine_element);
+    }
     /* Set the new element offset of this tree */
     tree->elements_offset = el_offset;
     el_offset += el_inserted;
@@ -395,18 +1393,93 @@ t8_forest_adapt (t8_forest_t forest)
     /* clean up */
     T8_FREE (elements);
     T8_FREE (elements_from);
+    T8_FREE (child_ids);
   }
-  if (forest->set_adapt_recursive) {
-    /* clean up */
-    sc_list_destroy (refine_list);
+}
+
+void
+t8_forest_adapt (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_forest_reduce_t  reduce;
+  int                *pdone;
+  int                 in_place = 0;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->set_from != NULL);
+  T8_ASSERT (forest->set_adapt_recursive != -1);
+
+  /* if profiling is enabled, measure runtime */
+  if (forest->profile != NULL) {
+    forest->profile->adapt_runtime = -sc_MPI_Wtime ();
+    /* DO NOT DELETE THE FOLLOWING line.
+     * even if you do not want this output. It fixes a bug that occured on JUQUEEN, where the
+     * runtimes were computed to 0.
+     * Only delete the line, if you know what you are doing. */
+    t8_global_productionf ("Start adadpt %f %f\n", sc_MPI_Wtime (),
+                           forest->profile->adapt_runtime);
+  }
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_ADAPT);
+  T8_TRACE_BEGIN ("t8_forest_adapt");
+
+  forest_from = forest->set_from;
+  t8_global_productionf ("Into t8_forest_adapt from %lld total elements\n",
+                         (long long) forest_from->global_num_elements);
+
+  /* TODO: Allocate memory for the trees of forest.
+   * Will we do this here or in an extra function? */
+  T8_ASSERT (forest->trees->elem_count == forest_from->trees->elem_count);
+
+#ifdef T8_ENABLE_OPENMP
+  if (!forest->set_adapt_recursive && forest->set_adapt_threaded
+      && (forest->set_adapt_fn != NULL
+          || forest->set_adapt_markers != NULL)) {
+    t8_forest_adapt_threaded (forest);
+  }
+  else
+#endif
+  if (!forest->set_adapt_recursive && t8_refcount_is_last (&forest_from->rc)
+      && forest_from->mmap_regions == NULL
+      && forest_from->leaf_storage == NULL) {
+    /* We own forest_from exclusively and it is destroyed after commit,
+     * we can thus reuse its element memory. Elements mapped from a file
+     * and contiguous leaves cannot grow. */
+    t8_forest_adapt_in_place (forest);
+    in_place = 1;
+  }
+  else if (forest->set_adapt_fn == NULL) {
+    /* Batched or marker based adaptation */
+    t8_forest_adapt_by_flags (forest);
+  }
+  else {
+    t8_forest_adapt_copy (forest);
   }
+  /* Update the tree hashes along the changed runs */
+  if (!in_place) {
+    t8_forest_hash_adapt (forest, 0);
+  }
+  t8_forest_hash_adapt (forest, 1);
 
   /* We now adapted all local trees */
-  /* Compute the new global number of elements */
-  t8_forest_comm_global_num_elements (forest);
+  /* Compute the new global number of elements. During a balance round,
+   * t8code_data points to the done flag of the round, which we reduce
+   * with the same collective. */
+  t8_forest_reduce_init (&reduce);
+  reduce.local[T8_FOREST_REDUCE_NUM_ELEMENTS] = forest->local_num_elements;
+  pdone = (int *) forest->t8code_data;
+  if (pdone != NULL) {
+    reduce.local[T8_FOREST_REDUCE_NUM_NOT_DONE] = !*pdone;
+  }
+  t8_forest_reduce (&reduce, forest->mpicomm);
+  forest->global_num_elements = reduce.global[T8_FOREST_REDUCE_NUM_ELEMENTS];
+  if (pdone != NULL) {
+    *pdone = reduce.global[T8_FOREST_REDUCE_NUM_NOT_DONE] == 0;
+  }
   t8_global_productionf ("Done t8_forest_adapt with %lld total elements\n",
                          (long long) forest->global_num_elements);
 
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_ADAPT);
+  T8_TRACE_END ("t8_forest_adapt");
   /* if profiling is enabled, measure runtime */
   if (forest->profile != NULL) {
     forest->profile->adapt_runtime += sc_MPI_Wtime ();
@@ -419,4 +1492,77 @@ t8_forest_adapt (t8_forest_t forest)
   }
 }
 
+t8_locidx_t
+t8_forest_adapt_count (t8_forest_t forest, t8_locidx_t * tree_counts,
+                       double *weights)
+{
+  t8_forest_t         forest_from;
+  t8_element_array_t *telements_from;
+  t8_element_t       *element_from;
+  t8_locidx_t         ltree_id, num_trees;
+  t8_locidx_t         num_el_from, num_el_new, num_el_total;
+  t8_locidx_t         el_considered, ie;
+  t8_tree_t           tree_from;
+  t8_eclass_scheme_c *tscheme;
+  int8_t             *tree_flags;
+  int                 num_siblings;
+
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  forest_from = forest->set_from;
+  SC_CHECK_ABORT (forest_from != NULL
+                  && (forest->from_method & T8_FOREST_FROM_ADAPT),
+                  "No forest to adapt from was specified");
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  SC_CHECK_ABORT (!forest->set_adapt_recursive,
+                  "The adaptation can only be counted if it is not "
+                  "recursive");
+  /* The queries do not refine beyond the maximum level, which forest gets
+   * from the same cmesh and scheme on commit. */
+  forest->maxlevel = forest_from->maxlevel;
+
+  num_el_total = 0;
+  num_trees = t8_forest_get_num_local_trees (forest_from);
+  for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+    tree_from = t8_forest_get_tree (forest_from, ltree_id);
+    telements_from = &tree_from->elements;
+    num_el_from = (t8_locidx_t) t8_element_array_get_count (telements_from);
+    tscheme = t8_forest_get_eclass_scheme (forest_from, tree_from->eclass);
+    tree_flags = T8_ALLOC (int8_t, SC_MAX (num_el_from, 1));
+    num_el_new = t8_forest_adapt_tree_flags (forest, ltree_id, tscheme,
+                                             telements_from, tree_flags);
+    if (tree_counts != NULL) {
+      tree_counts[ltree_id] = num_el_new;
+    }
+    /* Each kept element weighs one, a refined element the number of its
+     * new elements and each member of a coarsened family its share of the
+     * parent, such that the weights sum up to num_el_new. */
+    el_considered = 0;
+    while (weights != NULL && el_considered < num_el_from) {
+      element_from =
+        t8_element_array_index_locidx (telements_from, el_considered);
+      if (tree_flags[el_considered] > 0) {
+        weights[tree_from->elements_offset + el_considered] =
+          t8_forest_adapt_num_refined (tscheme, element_from,
+                                       tree_flags[el_considered]);
+        el_considered++;
+      }
+      else if (tree_flags[el_considered] < 0) {
+        num_siblings = tscheme->t8_element_num_siblings (element_from);
+        for (ie = 0; ie < num_siblings; ie++) {
+          weights[tree_from->elements_offset + el_considered + ie] =
+            1. / num_siblings;
+        }
+        el_considered += num_siblings;
+      }
+      else {
+        weights[tree_from->elements_offset + el_considered] = 1;
+        el_considered++;
+      }
+    }
+    T8_FREE (tree_flags);
+    num_el_total += num_el_new;
+  }
+  return num_el_total;
+}
+
 T8_EXTERN_C_END ();
@@ -25,12 +25,86 @@
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_forest/t8_forest_data.h>
+#include <t8_trace.h>
 #include <t8_forest.h>
 #include <t8_element_cxx.hxx>
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+/* The number of element levels that are computed with one call to
+ * t8_element_batch_level when we determine the maximum level */
+#define T8_FOREST_BALANCE_LEVEL_BATCH 256
+
+/* Check whether a leaf in the same tree with a level larger than the
+ * element's level + 1 touches one of the element's corners, if balance_type
+ * is T8_GHOST_VERTICES, or one of its edges, if balance_type is
+ * T8_GHOST_EDGES.
+ * Such a leaf exists if the child at the corner of a neighbor of the same
+ * level has a leaf descendant. */
+static int
+t8_forest_balance_corner_refine (t8_forest_t forest_from,
+                                 t8_locidx_t ltree_id,
+                                 const t8_element_t * element,
+                                 t8_eclass_scheme_c * ts,
+                                 t8_ghost_type_t balance_type)
+{
+  t8_element_t       *neighbors[T8_ELEMENT_MAX_CORNER_NEIGHBORS], *child;
+  t8_element_scratch_mark_t mark;
+  t8_gloidx_t         gtreeid;
+  int                 coords[3], other_coords[3];
+  int                 icorner, jcorner, num_corners, ineigh, num_neighbors;
+  int                 shares_edge, refine = 0;
+
+  if ((balance_type == T8_GHOST_EDGES
+       && t8_eclass_to_dimension[ts->eclass] < 3)
+      || ts->t8_element_level (element) >= ts->t8_element_maxlevel ()) {
+    /* The edges are faces or there are no finer leaves */
+    return 0;
+  }
+  gtreeid = ltree_id + t8_forest_get_first_local_tree_id (forest_from);
+  mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (ts, T8_ELEMENT_MAX_CORNER_NEIGHBORS, neighbors);
+  t8_element_scratch_new (ts, 1, &child);
+  num_corners = ts->t8_element_num_corners (element);
+  for (icorner = 0; icorner < num_corners && !refine; icorner++) {
+    coords[0] = coords[1] = coords[2] = 0;
+    ts->t8_element_vertex_coords (element, icorner, coords);
+    num_neighbors =
+      ts->t8_element_corner_neighbors_inside (element, icorner,
+                                              T8_ELEMENT_MAX_CORNER_NEIGHBORS,
+                                              neighbors);
+    for (ineigh = 0; ineigh < num_neighbors && !refine; ineigh++) {
+      if (balance_type == T8_GHOST_EDGES) {
+        /* Only consider the neighbors that share another corner
+         * and thus an edge with the element */
+        shares_edge = 0;
+        for (jcorner = 0; jcorner < num_corners && !shares_edge; jcorner++) {
+          other_coords[0] = other_coords[1] = other_coords[2] = 0;
+          ts->t8_element_vertex_coords (element, jcorner, other_coords);
+          shares_edge = jcorner != icorner
+            && ts->t8_element_find_vertex (neighbors[ineigh],
+                                           other_coords) >= 0;
+        }
+        if (!shares_edge) {
+          continue;
+        }
+      }
+      ts->t8_element_vertex_child (neighbors[ineigh],
+                                   ts->t8_element_find_vertex (neighbors
+                                                               [ineigh],
+                                                               coords),
+                                   child);
+      refine =
+        t8_forest_element_has_leaf_desc (forest_from, gtreeid, child, ts);
+    }
+  }
+  t8_element_scratch_release (mark);
+  return refine;
+}
+
 /* This is the adapt function called during one round of balance.
  * We refine an element if it has any face neighbor with a level larger
  * than the element's level + 1.
@@ -105,20 +179,29 @@ t8_forest_balance_adapt (t8_forest_t forest, t8_forest_t forest_from,
       neigh_scheme->t8_element_destroy (num_half_neighbors, half_neighbors);
       T8_FREE (half_neighbors);
     }
+    if (forest->set_balance_type != T8_GHOST_FACES
+        && t8_forest_balance_corner_refine (forest_from, ltree_id, element,
+                                            ts, forest->set_balance_type)) {
+      /* This element should be refined */
+      *pdone = 0;
+      return 1;
+    }
   }
 
   return 0;
 }
 
-/* Collective function to compute the maximum occurring refinement level in a forest */
-static void
-t8_forest_compute_max_element_level (t8_forest_t forest)
+/* Compute the maximum refinement level of the local elements of a forest */
+static int
+t8_forest_local_max_element_level (t8_forest_t forest)
 {
   t8_locidx_t         ielement, elem_in_tree;
   t8_locidx_t         itree, num_trees;
   t8_element_t       *elem;
   t8_eclass_scheme_c *scheme;
-  int                 local_max_level = 0, elem_level;
+  int                 local_max_level = 0;
+  int                 levels[T8_FOREST_BALANCE_LEVEL_BATCH];
+  int                 ilevel, batch_count;
 
   /* Iterate over all local trees and all local elements and comupte the maximum occurring level */
   num_trees = t8_forest_get_num_local_trees (forest);
@@ -127,23 +210,198 @@ t8_forest_compute_max_element_level (t8_forest_t forest)
     scheme =
       t8_forest_get_eclass_scheme (forest,
                                    t8_forest_get_tree_class (forest, itree));
-    for (ielement = 0; ielement < elem_in_tree; ielement++) {
-      /* Get the element and compute its level */
+    for (ielement = 0; ielement < elem_in_tree; ielement += batch_count) {
+      /* Get the next batch of elements and compute their levels */
+      batch_count =
+        (int) SC_MIN (T8_FOREST_BALANCE_LEVEL_BATCH, elem_in_tree - ielement);
       elem = t8_forest_get_element_in_tree (forest, itree, ielement);
-      elem_level = scheme->t8_element_level (elem);
-      local_max_level = SC_MAX (local_max_level, elem_level);
+      scheme->t8_element_batch_level (elem, batch_count, levels);
+      for (ilevel = 0; ilevel < batch_count; ilevel++) {
+        local_max_level = SC_MAX (local_max_level, levels[ilevel]);
+      }
     }
   }
-  /* Communicate the local maximum levels */
-  sc_MPI_Allreduce (&local_max_level, &forest->maxlevel_existing, 1,
-                    sc_MPI_INT, sc_MPI_MAX, forest->mpicomm);
+  return local_max_level;
+}
+
+/* Return forest->set_from with a ghost layer of the balance type of forest.
+ * If set_from has no ghost layer, we create it. If it has a ghost layer of
+ * fewer neighbors, we return a copy of set_from with a new ghost layer,
+ * since the user may rely on the ghost layer of set_from.
+ * The returned forest is referenced. */
+static              t8_forest_t
+t8_forest_balance_ghost_from (t8_forest_t forest)
+{
+  t8_forest_t         set_from = forest->set_from, forest_copy;
+
+  t8_forest_ref (set_from);
+  /* A deferred ghost layer of set_from is created first */
+  t8_forest_ghost_ensure (set_from);
+  if (set_from->ghosts == NULL) {
+    set_from->ghost_type = forest->set_balance_type;
+    t8_forest_ghost_create_topdown (set_from);
+  }
+  else if (set_from->ghosts->ghost_type < forest->set_balance_type) {
+    t8_forest_init (&forest_copy);
+    t8_forest_set_copy (forest_copy, set_from);
+    t8_forest_set_ghost (forest_copy, 1, forest->set_balance_type);
+    t8_forest_commit (forest_copy);
+    forest_copy->maxlevel_existing = set_from->maxlevel_existing;
+    return forest_copy;
+  }
+  return set_from;
+}
+
+/* Compute the maximum occurring refinement level of forest->set_from and
+ * return set_from with a ghost layer as t8_forest_balance_ghost_from.
+ * The reduction of the level overlaps with the creation of the ghost layer. */
+static              t8_forest_t
+t8_forest_balance_prepare (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_forest_reduce_t  reduce;
+
+  t8_forest_reduce_init (&reduce);
+  reduce.local[T8_FOREST_REDUCE_MAX_LEVEL] =
+    t8_forest_local_max_element_level (forest->set_from);
+  t8_forest_reduce_begin (&reduce, forest->mpicomm);
+  forest_from = t8_forest_balance_ghost_from (forest);
+  t8_forest_reduce_end (&reduce);
+  forest->set_from->maxlevel_existing =
+    (int) reduce.global[T8_FOREST_REDUCE_MAX_LEVEL];
+  forest_from->maxlevel_existing = forest->set_from->maxlevel_existing;
+  t8_global_productionf ("Computed maximum occurring level:\t%i\n",
+                         forest->set_from->maxlevel_existing);
+  return forest_from;
+}
+
+/* Create a forest that is adapted from forest_from by one round of
+ * t8_forest_balance_adapt without creating a new ghost layer.
+ * The new forest shares the ghost layer of forest_from, which stays valid
+ * as long as the elements of the other processes do not change.
+ * We take ownership of forest_from.
+ * On output done is false if any local element was refined. */
+static              t8_forest_t
+t8_forest_balance_local_round (t8_forest_t forest_from,
+                               t8_ghost_type_t balance_type, int *done)
+{
+  t8_forest_t         forest_temp;
+  t8_forest_ghost_t   ghosts;
+
+  t8_forest_init (&forest_temp);
+  forest_temp->maxlevel_existing = forest_from->maxlevel_existing;
+  forest_temp->set_balance_type = balance_type;
+  t8_forest_set_adapt (forest_temp, forest_from, t8_forest_balance_adapt, 0);
+  forest_temp->t8code_data = done;
+  /* Keep the ghost layer alive, since forest_from may be destroyed */
+  ghosts = forest_from->ghosts;
+  if (ghosts != NULL) {
+    t8_forest_ghost_ref (ghosts);
+  }
+  *done = 1;
+  t8_forest_commit (forest_temp);
+  forest_temp->ghosts = ghosts;
+  return forest_temp;
+}
+
+/* Balance a forest by balancing the local elements against the current
+ * ghost layer in rounds that do not create a ghost layer or repartition,
+ * until no process refines an element anymore. Only then we create a new
+ * ghost layer, possibly after repartitioning, and repeat if any element
+ * was refined, since the ghost elements may have changed.
+ * Thus, a refinement ripples through the local elements of a process without
+ * a ghost layer per step, and only ripples across process boundaries
+ * need a new ghost layer.
+ * The result is the same as with the global rounds of t8_forest_balance,
+ * since each element that is refined is also refined there. */
+static void
+t8_forest_balance_local (t8_forest_t forest, int repartition)
+{
+  t8_forest_t         forest_from, forest_partition;
+  int                 done;
+  int                 count_rounds = 0, count_local_rounds, total_local_rounds;
+
+  if (forest->profile != NULL) {
+    forest->profile->balance_runtime = -sc_MPI_Wtime ();
+  }
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE);
+  T8_TRACE_BEGIN ("t8_forest_balance");
+
+  /* Compute the maximum occurring refinement level in the forest.
+   * This function is reference neutral regarding set_from */
+  forest_from = t8_forest_balance_prepare (forest);
+
+  total_local_rounds = 0;
+  do {
+    /* Balance the local elements against the current ghost layer.
+     * Since committing a forest is collective, all processes perform
+     * the same number of rounds. */
+    count_local_rounds = 0;
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE_ROUND);
+    do {
+      t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE_ROUND_ADAPT);
+      forest_from =
+        t8_forest_balance_local_round (forest_from,
+                                       forest->set_balance_type, &done);
+      t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE_ROUND_ADAPT);
+      /* The done flag was reduced with the element count of the round */
+      count_local_rounds++;
+    } while (!done);
+    total_local_rounds += count_local_rounds;
+    count_rounds++;
+    if (count_local_rounds > 1) {
+      /* Elements were refined, such that the ghost layer is outdated and
+       * we need to check the local elements against the new one. */
+      if (repartition) {
+        t8_forest_profile_begin (forest,
+                                 T8_PROFILE_PHASE_BALANCE_ROUND_PARTITION);
+        t8_forest_init (&forest_partition);
+        forest_partition->maxlevel_existing = forest_from->maxlevel_existing;
+        forest_partition->set_balance_type = forest->set_balance_type;
+        t8_forest_set_partition (forest_partition, forest_from, 0);
+        t8_forest_set_ghost (forest_partition, 1, forest->set_balance_type);
+        t8_forest_commit (forest_partition);
+        forest_from = forest_partition;
+        t8_forest_profile_end (forest,
+                               T8_PROFILE_PHASE_BALANCE_ROUND_PARTITION);
+      }
+      else {
+        t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE_ROUND_GHOST);
+        if (forest_from->ghosts != NULL) {
+          t8_forest_ghost_unref (&forest_from->ghosts);
+        }
+        forest_from->ghost_type = forest->set_balance_type;
+        t8_forest_ghost_create_topdown (forest_from);
+        t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE_ROUND_GHOST);
+      }
+    }
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE_ROUND);
+  } while (count_local_rounds > 1);
+
+  T8_ASSERT (t8_forest_is_balanced (forest_from));
+  /* We own forest_from exclusively and move its elements to forest */
+  t8_forest_move_trees (forest, forest_from);
+  t8_forest_data_copy (forest, forest_from, 1);
+  t8_global_productionf
+    ("Done t8_forest_balance with %lli global elements.\n",
+     (long long) forest->global_num_elements);
+  t8_debugf ("t8_forest_balance needed %i rounds with %i local rounds.\n",
+             count_rounds, total_local_rounds);
+  t8_forest_unref (&forest_from);
+
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE);
+  T8_TRACE_END ("t8_forest_balance");
+  if (forest->profile != NULL) {
+    forest->profile->balance_runtime += sc_MPI_Wtime ();
+    forest->profile->balance_rounds = count_rounds;
+  }
 }
 
 void
 t8_forest_balance (t8_forest_t forest, int repartition)
 {
   t8_forest_t         forest_temp, forest_from, forest_partition;
-  int                 done = 0, done_global = 0;
+  int                 done = 0;
   int                 count_rounds = 0;
   /* The following variables are only required if profiling is
    * enabled. */
@@ -157,6 +415,12 @@ t8_forest_balance (t8_forest_t forest, int repartition)
   t8_global_productionf
     ("Into t8_forest_balance with %lli global elements.\n",
      (long long) t8_forest_get_global_num_elements (forest->set_from));
+  if (forest->set_balance_local) {
+    t8_log_indent_push ();
+    t8_forest_balance_local (forest, repartition);
+    t8_log_indent_pop ();
+    return;
+  }
   t8_log_indent_push ();
 
   /* Set default value to prevent compiler warning */
@@ -177,33 +441,28 @@ t8_forest_balance (t8_forest_t forest, int repartition)
       partition_stats = T8_ALLOC_ZERO (sc_statinfo_t, num_stats_allocated);
     }
   }
-
-  /* Compute the maximum occurring refinement level in the forest */
-  t8_forest_compute_max_element_level (forest->set_from);
-  t8_global_productionf ("Computed maximum occurring level:\t%i\n",
-                         forest->set_from->maxlevel_existing);
-  /* Use set_from as the first forest to adapt */
-  forest_from = forest->set_from;
-  /* This function is reference neutral regarding forest_from */
-  t8_forest_ref (forest_from);
-
-  if (forest->set_from->ghosts == NULL) {
-    forest->set_from->ghost_type = T8_GHOST_FACES;
-    t8_forest_ghost_create_topdown (forest->set_from);
-  }
-  while (!done_global) {
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE);
+  T8_TRACE_BEGIN ("t8_forest_balance");
+
+  /* Compute the maximum occurring refinement level in the forest and
+   * use set_from as the first forest to adapt.
+   * This function is reference neutral regarding set_from */
+  forest_from = t8_forest_balance_prepare (forest);
+  while (!done) {
     done = 1;
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_BALANCE_ROUND);
 
     T8_ASSERT (forest_from->maxlevel_existing >= 0);
     /* Initialize the temp forest to be adapted from forest_from */
     t8_forest_init (&forest_temp);
     /* Update the maximum occurring level */
     forest_temp->maxlevel_existing = forest_from->maxlevel_existing;
+    forest_temp->set_balance_type = forest->set_balance_type;
     /* Adapt the forest */
     t8_forest_set_adapt (forest_temp, forest_from, t8_forest_balance_adapt,
                          0);
     if (!repartition) {
-      t8_forest_set_ghost (forest_temp, 1, T8_GHOST_FACES);
+      t8_forest_set_ghost (forest_temp, 1, forest->set_balance_type);
     }
     forest_temp->t8code_data = &done;
     /* If profiling is enabled, measure ghost/adapt rumtimes */
@@ -240,20 +499,24 @@ t8_forest_balance (t8_forest_t forest, int repartition)
                        "forest balance: Ghost time");
         count_ghost_stats++;
       }
+      t8_forest_profile_merge_phase (forest,
+                                     T8_PROFILE_PHASE_BALANCE_ROUND_ADAPT,
+                                     forest_temp, T8_PROFILE_PHASE_ADAPT);
+      t8_forest_profile_merge_phase (forest,
+                                     T8_PROFILE_PHASE_BALANCE_ROUND_GHOST,
+                                     forest_temp, T8_PROFILE_PHASE_GHOST);
     }
 
-    /* Compute the logical and of all process local done values, if this results
-     * in 1 then all processes are finished */
-    sc_MPI_Allreduce (&done, &done_global, 1, sc_MPI_INT, sc_MPI_LAND,
-                      forest->mpicomm);
-
-    if (repartition && !done_global) {
+    /* The commit reduced the process local done values together with the
+     * element count, done is 1 if all processes are finished */
+    if (repartition && !done) {
       /* If repartitioning is used, we partition the forest */
       t8_forest_init (&forest_partition);
       /* Update the maximum occurring level */
       forest_partition->maxlevel_existing = forest_temp->maxlevel_existing;
+      forest_partition->set_balance_type = forest->set_balance_type;
       t8_forest_set_partition (forest_partition, forest_temp, 0);
-      t8_forest_set_ghost (forest_partition, 1, T8_GHOST_FACES);
+      t8_forest_set_ghost (forest_partition, 1, forest->set_balance_type);
       /* If profiling is enabled, measure partition rumtimes */
       if (forest->profile != NULL) {
         t8_forest_set_profiling (forest_partition, 1);
@@ -270,6 +533,14 @@ t8_forest_balance (t8_forest_t forest, int repartition)
                        forest_partition->profile->ghost_runtime,
                        "forest balance: Ghost time");
         count_ghost_stats++;
+        t8_forest_profile_merge_phase (forest,
+                                       T8_PROFILE_PHASE_BALANCE_ROUND_PARTITION,
+                                       forest_partition,
+                                       T8_PROFILE_PHASE_PARTITION);
+        t8_forest_profile_merge_phase (forest,
+                                       T8_PROFILE_PHASE_BALANCE_ROUND_GHOST,
+                                       forest_partition,
+                                       T8_PROFILE_PHASE_GHOST);
       }
 
       forest_temp = forest_partition;
@@ -278,21 +549,32 @@ t8_forest_balance (t8_forest_t forest, int repartition)
     /* Adapt forest_temp in the next round */
     forest_from = forest_temp;
     count_rounds++;
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE_ROUND);
   }
 
   T8_ASSERT (t8_forest_is_balanced (forest_temp));
-  /* Forest_temp is now balanced, we copy its trees and elements to forest */
-  t8_forest_copy_trees (forest, forest_temp, 1);
+  /* Forest_temp is now balanced, we move its trees and elements to forest.
+   * We only need to copy them if someone else still references forest_temp. */
+  if (t8_refcount_is_last (&forest_temp->rc)) {
+    t8_forest_move_trees (forest, forest_temp);
+  }
+  else {
+    t8_forest_copy_trees (forest, forest_temp, 1);
+  }
+  t8_forest_data_copy (forest, forest_temp,
+                       t8_refcount_is_last (&forest_temp->rc));
   /* TODO: Also copy ghost elements if ghost creation is set */
 
   t8_log_indent_pop ();
   t8_global_productionf
     ("Done t8_forest_balance with %lli global elements.\n",
-     (long long) t8_forest_get_global_num_elements (forest_temp));
+     (long long) forest->global_num_elements);
   t8_debugf ("t8_forest_balance needed %i rounds.\n", count_rounds);
   /* clean-up */
   t8_forest_unref (&forest_temp);
 
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_BALANCE);
+  T8_TRACE_END ("t8_forest_balance");
   if (forest->profile != NULL) {
     /* Profiling is enabled, so we measure the runtime of balance. */
     forest->profile->balance_runtime += sc_MPI_Wtime ();
@@ -392,4 +674,119 @@ t8_forest_is_balanced (t8_forest_t forest)
   return 1;
 }
 
+/* Check whether an element of a balanced forest can stay a leaf next to
+ * its face neighbors. We return 0 if the element has a face neighbor leaf
+ * of level larger than the element's level + 1 or smaller than the
+ * element's level - 1. */
+static int
+t8_forest_balance_check_element (t8_forest_t forest, t8_locidx_t ltree_id,
+                                 t8_locidx_t lelement_id,
+                                 t8_eclass_scheme_c * ts,
+                                 t8_element_t * element)
+{
+  t8_eclass_t         neigh_class;
+  t8_eclass_scheme_c *neigh_scheme;
+  t8_element_t       *neigh[2];
+  t8_gloidx_t         neighbor_tree;
+  int                 iface, num_faces, dual_face, level, is_balanced;
+
+  /* Check for finer neighbors */
+  if (t8_forest_balance_adapt (forest, forest, ltree_id, lelement_id, ts, 1,
+                               &element)) {
+    return 0;
+  }
+  level = ts->t8_element_level (element);
+  if (level < 2) {
+    /* There cannot be a leaf of level smaller than level - 1 */
+    return 1;
+  }
+
+  /* Check for coarser neighbors. The neighbor leaf at a face is too coarse
+   * if the ancestor of level - 2 of the same level face neighbor has
+   * no true leaf descendant. */
+  is_balanced = 1;
+  num_faces = ts->t8_element_num_faces (element);
+  for (iface = 0; iface < num_faces && is_balanced; iface++) {
+    neigh_class = t8_forest_element_neighbor_eclass (forest, ltree_id,
+                                                     element, iface);
+    neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+    neigh_scheme->t8_element_new (2, neigh);
+    neighbor_tree = t8_forest_element_face_neighbor (forest, ltree_id,
+                                                     element, neigh[0],
+                                                     neigh_scheme, iface,
+                                                     &dual_face);
+    if (neighbor_tree >= 0) {
+      neigh_scheme->t8_element_parent (neigh[0], neigh[1]);
+      neigh_scheme->t8_element_parent (neigh[1], neigh[0]);
+      is_balanced = t8_forest_element_has_leaf_desc (forest, neighbor_tree,
+                                                     neigh[0], neigh_scheme);
+    }
+    neigh_scheme->t8_element_destroy (2, neigh);
+  }
+  return is_balanced;
+}
+
+/* Check whether an adapted forest is balanced by only checking the
+ * elements that changed during adaptation. */
+int
+t8_forest_is_balanced_incremental (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  const t8_forest_adapt_run_t *runs;
+  t8_locidx_t         num_runs, irun, ielem, ltree_id, tree_offset;
+  t8_element_t       *element;
+  t8_eclass_scheme_c *ts;
+  void               *data_temp;
+  int                 dummy_int, is_balanced, is_balanced_global;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (forest->mpisize == 1 || forest->ghosts != NULL);
+
+  runs = t8_forest_get_adapt_runs (forest, &num_runs);
+  if (runs == NULL || forest->set_balance_type != T8_GHOST_FACES) {
+    /* We do not know which elements changed or only check face neighbors
+     * of changed elements and thus check all elements */
+    is_balanced = t8_forest_is_balanced (forest);
+    sc_MPI_Allreduce (&is_balanced, &is_balanced_global, 1, sc_MPI_INT,
+                      sc_MPI_LAND, forest->mpicomm);
+    return is_balanced_global;
+  }
+
+  /* temporarily save forest_from and the t8code_data,
+   * see t8_forest_is_balanced */
+  forest_from = forest->set_from;
+  forest->set_from = forest;
+  data_temp = forest->t8code_data;
+  forest->t8code_data = &dummy_int;
+
+  is_balanced = 1;
+  for (irun = 0; irun < num_runs && is_balanced; irun++) {
+    if (runs[irun].kind == T8_FOREST_ADAPT_UNCHANGED) {
+      /* These elements were balanced before and only
+       * their changed neighbors can violate the balance */
+      continue;
+    }
+    for (ielem = runs[irun].first_new;
+         ielem < runs[irun].first_new + runs[irun].num_new && is_balanced;
+         ielem++) {
+      element = t8_forest_get_element (forest, ielem, &ltree_id);
+      tree_offset = t8_forest_get_tree_element_offset (forest, ltree_id);
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_get_tree_class (forest,
+                                                                  ltree_id));
+      is_balanced =
+        t8_forest_balance_check_element (forest, ltree_id,
+                                         ielem - tree_offset, ts, element);
+    }
+  }
+
+  forest->set_from = forest_from;
+  forest->t8code_data = data_temp;
+
+  sc_MPI_Allreduce (&is_balanced, &is_balanced_global, 1, sc_MPI_INT,
+                    sc_MPI_LAND, forest->mpicomm);
+  return is_balanced_global;
+}
+
 T8_EXTERN_C_END ();
@@ -42,6 +42,15 @@ void                t8_forest_balance (t8_forest_t forest, int repartition);
 /* Check whether the local elements of a forest are balanced. */
 int                 t8_forest_is_balanced (t8_forest_t forest);
 
+/* Check whether an adapted forest is balanced, provided that the forest
+ * it was adapted from is balanced.
+ * Only the elements that changed during adaptation are checked against their
+ * face neighbors, see t8_forest_set_adapt_record_runs. If no runs were
+ * recorded, all local elements are checked.
+ * The forest needs a ghost layer if it has more than one process.
+ * This function is collective and returns the same value on all processes. */
+int                 t8_forest_is_balanced_incremental (t8_forest_t forest);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_BALANCE_H! */
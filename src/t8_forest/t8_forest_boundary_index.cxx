@@ -0,0 +1,319 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_boundary_index.h>
+#include <t8_element_cxx.hxx>
+#include <vector>
+
+/* The boundary leaves that are collected while the index is computed */
+typedef struct
+{
+  std::vector < t8_locidx_t > leaves;
+  std::vector < int >faces;
+} t8_forest_boundary_index_data_t;
+
+/* Callback of t8_forest_iterate_faces that collects the leaves at the face */
+static int
+t8_forest_boundary_index_add_leaf (t8_forest_t forest, t8_locidx_t ltreeid,
+                                   const t8_element_t * element, int face,
+                                   void *user_data,
+                                   t8_locidx_t tree_leaf_index)
+{
+  t8_forest_boundary_index_data_t *data =
+    (t8_forest_boundary_index_data_t *) user_data;
+
+  if (tree_leaf_index >= 0) {
+    /* element is a leaf */
+    data->leaves.push_back (tree_leaf_index);
+    data->faces.push_back (face);
+  }
+  return 1;
+}
+
+/* Collect the leaves of a local tree at one of its faces.
+ * Only the leaves between the leaf containing the first and the leaf
+ * containing the last descendant at the face can touch the face, the
+ * search along the face starts with this range. */
+static void
+t8_forest_boundary_index_search_face (t8_forest_t forest, t8_locidx_t itree,
+                                      t8_eclass_scheme_c * ts, int tree_face,
+                                      t8_forest_boundary_index_data_t * data)
+{
+  t8_element_array_t *leaf_elements, face_leafs;
+  t8_element_t       *root;
+  t8_linearidx_t      first_id, last_id;
+  t8_locidx_t         first, last;
+  int                 maxlevel;
+
+  leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+  if (t8_element_array_get_count (leaf_elements) == 0) {
+    return;
+  }
+  maxlevel = ts->t8_element_maxlevel ();
+  ts->t8_element_new (1, &root);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  ts->t8_element_face_descendant_range (root, tree_face, maxlevel, &first_id,
+                                        &last_id);
+  last = t8_forest_bin_search_lower (leaf_elements, last_id, maxlevel);
+  if (last >= 0) {
+    first = SC_MAX (0, t8_forest_bin_search_lower (leaf_elements, first_id,
+                                                   maxlevel));
+    t8_element_array_init_view (&face_leafs, leaf_elements, first,
+                                last - first + 1);
+    t8_forest_iterate_faces (forest, itree, root, tree_face, &face_leafs,
+                             data, first, t8_forest_boundary_index_add_leaf);
+  }
+  ts->t8_element_destroy (1, &root);
+}
+
+/* Return the face of an element that lies at a face of its tree,
+ * or -1 if the element does not touch the tree face. */
+static int
+t8_forest_boundary_index_element_face (t8_eclass_scheme_c * ts,
+                                       const t8_element_t * element,
+                                       int tree_face)
+{
+  int                 iface, num_faces;
+
+  num_faces = ts->t8_element_num_faces (element);
+  for (iface = 0; iface < num_faces; iface++) {
+    if (ts->t8_element_is_root_boundary (element, iface)
+        && ts->t8_element_tree_face (element, iface) == tree_face) {
+      return iface;
+    }
+  }
+  return -1;
+}
+
+/* Collect the leaves of a local tree at one of its faces from the leaves
+ * at the same face of forest_from and the runs of the adaptation.
+ * The leaves of unchanged runs are copied. The new elements of a refined
+ * or coarsened run can only touch the face if one of the old elements
+ * of the run did, only these are tested.
+ * irun is the first run that contains elements of the tree. */
+static void
+t8_forest_boundary_index_update_face (t8_forest_t forest,
+                                      t8_forest_t forest_from,
+                                      t8_locidx_t itree,
+                                      t8_eclass_scheme_c * ts, int tree_face,
+                                      size_t irun,
+                                      t8_forest_boundary_index_data_t * data)
+{
+  t8_forest_boundary_index_t index_from = forest_from->boundary_index;
+  const t8_forest_adapt_run_t *run;
+  t8_element_array_t *leaf_elements;
+  t8_tree_t           tree, tree_from;
+  t8_locidx_t         offset, offset_from, count, count_from;
+  t8_locidx_t         ileaf, end_leaf, run_end, first_new, end_new, ielement;
+  int                 face, has_old;
+
+  tree = t8_forest_get_tree (forest, itree);
+  tree_from = t8_forest_get_tree (forest_from, itree);
+  offset = tree->elements_offset;
+  count = t8_forest_get_tree_element_count (tree);
+  offset_from = tree_from->elements_offset;
+  count_from = t8_forest_get_tree_element_count (tree_from);
+  leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+
+  ileaf = index_from->face_offsets[itree * T8_ECLASS_MAX_FACES + tree_face];
+  end_leaf =
+    index_from->face_offsets[itree * T8_ECLASS_MAX_FACES + tree_face + 1];
+  for (; ileaf < end_leaf && irun < forest->adapt_runs->elem_count; irun++) {
+    run = (const t8_forest_adapt_run_t *)
+      sc_array_index (forest->adapt_runs, irun);
+    /* The old elements of the run in this tree end before run_end */
+    run_end = SC_MIN (run->first_old + run->num_old,
+                      offset_from + count_from) - offset_from;
+    has_old = 0;
+    while (ileaf < end_leaf && index_from->leaves[ileaf] < run_end) {
+      has_old = 1;
+      if (run->kind == T8_FOREST_ADAPT_UNCHANGED) {
+        /* The leaf is kept at its new position */
+        data->leaves.push_back (run->first_new - offset
+                                + offset_from + index_from->leaves[ileaf]
+                                - run->first_old);
+        data->faces.push_back (index_from->faces[ileaf]);
+      }
+      ileaf++;
+    }
+    if (!has_old || run->kind == T8_FOREST_ADAPT_UNCHANGED) {
+      continue;
+    }
+    /* Test the new elements of the run in this tree */
+    first_new = SC_MAX (run->first_new, offset) - offset;
+    end_new = SC_MIN (run->first_new + run->num_new, offset + count) - offset;
+    for (ielement = first_new; ielement < end_new; ielement++) {
+      face = t8_forest_boundary_index_element_face (ts,
+                                                    t8_element_array_index_locidx
+                                                    (leaf_elements, ielement),
+                                                    tree_face);
+      if (face >= 0) {
+        data->leaves.push_back (ielement);
+        data->faces.push_back (face);
+      }
+    }
+  }
+  T8_ASSERT (ileaf == end_leaf);
+}
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_boundary_index_compute (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_boundary_index_t index;
+  t8_forest_boundary_index_data_t data;
+  const t8_forest_adapt_run_t *run;
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_tree_t           tree_from;
+  t8_locidx_t         num_local_trees, itree, cmesh_ltree, offset_from;
+  size_t              irun;
+  int                 tree_face;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->boundary_index == NULL);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest_from != NULL) {
+    T8_ASSERT (t8_forest_is_committed (forest_from));
+    T8_ASSERT (forest_from->boundary_index != NULL);
+    /* We can only update the index if both forests have the same local
+     * trees and we know how the elements changed. */
+    if (forest_from->first_local_tree != forest->first_local_tree
+        || t8_forest_get_num_local_trees (forest_from) != num_local_trees
+        || forest->adapt_runs == NULL) {
+      forest_from = NULL;
+    }
+  }
+
+  index = forest->boundary_index =
+    T8_ALLOC_ZERO (t8_forest_boundary_index_struct_t, 1);
+  index->num_local_trees = num_local_trees;
+  index->face_offsets =
+    T8_ALLOC (t8_locidx_t, num_local_trees * T8_ECLASS_MAX_FACES + 1);
+  irun = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    cmesh_ltree = t8_forest_ltreeid_to_cmesh_ltreeid (forest, itree);
+    if (forest_from != NULL) {
+      /* Skip the runs that end before this tree */
+      tree_from = t8_forest_get_tree (forest_from, itree);
+      offset_from = tree_from->elements_offset;
+      while (irun < forest->adapt_runs->elem_count) {
+        run = (const t8_forest_adapt_run_t *)
+          sc_array_index (forest->adapt_runs, irun);
+        if (run->first_old + run->num_old > offset_from) {
+          break;
+        }
+        irun++;
+      }
+    }
+    for (tree_face = 0; tree_face < T8_ECLASS_MAX_FACES; tree_face++) {
+      index->face_offsets[itree * T8_ECLASS_MAX_FACES + tree_face] =
+        (t8_locidx_t) data.leaves.size ();
+      if (tree_face >= t8_eclass_num_faces[tree_class]
+          || !t8_cmesh_tree_face_is_boundary (forest->cmesh, cmesh_ltree,
+                                              tree_face)) {
+        /* The tree face is not at the domain boundary */
+        continue;
+      }
+      if (forest_from != NULL) {
+        t8_forest_boundary_index_update_face (forest, forest_from, itree, ts,
+                                              tree_face, irun, &data);
+      }
+      else {
+        t8_forest_boundary_index_search_face (forest, itree, ts, tree_face,
+                                              &data);
+      }
+    }
+  }
+  index->face_offsets[num_local_trees * T8_ECLASS_MAX_FACES] =
+    (t8_locidx_t) data.leaves.size ();
+
+  /* Copy the leaves to arrays of the exact size */
+  index->leaves = T8_ALLOC (t8_locidx_t, data.leaves.size ());
+  index->faces = T8_ALLOC (int, data.faces.size ());
+  if (!data.leaves.empty ()) {
+    memcpy (index->leaves, &data.leaves[0],
+            data.leaves.size () * sizeof (t8_locidx_t));
+    memcpy (index->faces, &data.faces[0], data.faces.size () * sizeof (int));
+  }
+}
+
+void
+t8_forest_boundary_index_destroy (t8_forest_t forest)
+{
+  t8_forest_boundary_index_t index;
+
+  T8_ASSERT (forest != NULL);
+  index = forest->boundary_index;
+  if (index == NULL) {
+    return;
+  }
+  T8_FREE (index->face_offsets);
+  T8_FREE (index->leaves);
+  T8_FREE (index->faces);
+  T8_FREE (index);
+  forest->boundary_index = NULL;
+}
+
+int
+t8_forest_has_boundary_index (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->boundary_index != NULL;
+}
+
+t8_locidx_t
+t8_forest_get_boundary_leaves (t8_forest_t forest, t8_locidx_t ltreeid,
+                               int tree_face, const t8_locidx_t **leaves,
+                               const int **faces)
+{
+  t8_forest_boundary_index_t index;
+  t8_locidx_t         first;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  index = forest->boundary_index;
+  SC_CHECK_ABORT (index != NULL, "The forest has no boundary index. See "
+                  "t8_forest_set_boundary_index.\n");
+  T8_ASSERT (0 <= ltreeid && ltreeid < index->num_local_trees);
+  T8_ASSERT (0 <= tree_face && tree_face < T8_ECLASS_MAX_FACES);
+
+  first = index->face_offsets[ltreeid * T8_ECLASS_MAX_FACES + tree_face];
+  if (leaves != NULL) {
+    *leaves = index->leaves + first;
+  }
+  if (faces != NULL) {
+    *faces = index->faces + first;
+  }
+  return index->face_offsets[ltreeid * T8_ECLASS_MAX_FACES + tree_face + 1]
+    - first;
+}
+
+T8_EXTERN_C_END ();
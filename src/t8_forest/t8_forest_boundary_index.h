@@ -0,0 +1,57 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_boundary_index.h
+ * We define routines to compute and store the leaves of a forest that lie
+ * at the domain boundary, sorted by the faces of the local trees.
+ * \see t8_forest_set_boundary_index
+ */
+
+#ifndef T8_FOREST_BOUNDARY_INDEX_H
+#define T8_FOREST_BOUNDARY_INDEX_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the boundary index of a forest.
+ * \param [in,out] forest       A forest with local elements.
+ *                              On output its boundary index is set.
+ * \param [in]     forest_from  NULL or a committed forest with boundary
+ *                              index from which \a forest was adapted.
+ *                              If the runs of the adaptation are known,
+ *                              only the changed elements near the boundary
+ *                              of forest_from are tested.
+ */
+void                t8_forest_boundary_index_compute (t8_forest_t forest,
+                                                      t8_forest_t
+                                                      forest_from);
+
+/** Free the memory of the boundary index of a forest, if it has one.
+ * \param [in,out] forest       A forest. On output its boundary index is NULL.
+ */
+void                t8_forest_boundary_index_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_BOUNDARY_INDEX_H! */
@@ -0,0 +1,385 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_bvh.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The maximum number of elements in a leaf node of the hierarchy */
+#define T8_FOREST_BVH_LEAF_SIZE 4
+
+/* The maximum depth of the hierarchy. Since the nodes are split in halves,
+ * this suffices for any number of local elements. */
+#define T8_FOREST_BVH_MAX_DEPTH 64
+
+/* Return the number of nodes of the hierarchy over num_elements elements */
+static t8_locidx_t
+t8_forest_bvh_count_nodes (t8_locidx_t num_elements)
+{
+  t8_locidx_t         half;
+
+  if (num_elements <= T8_FOREST_BVH_LEAF_SIZE) {
+    return 1;
+  }
+  half = num_elements / 2;
+  return 1 + t8_forest_bvh_count_nodes (half)
+    + t8_forest_bvh_count_nodes (num_elements - half);
+}
+
+/* Build the node of the elements first, ..., first + count - 1 and its
+ * descendants, starting at the node with index *next_node.
+ * The left child of a node directly follows the node, its right child
+ * follows the descendants of the left child.
+ * The box of each node is the union of the boxes of its elements. */
+static void
+t8_forest_bvh_build_node (t8_forest_bvh_t bvh, t8_locidx_t first,
+                          t8_locidx_t count, t8_locidx_t * next_node)
+{
+  t8_locidx_t         node, left, ielement, half;
+  double             *box;
+  const double       *child_box;
+  int                 i;
+
+  T8_ASSERT (count > 0);
+  node = (*next_node)++;
+  box = bvh->node_boxes + 6 * node;
+  bvh->node_first[node] = first;
+  bvh->node_count[node] = count;
+  if (count <= T8_FOREST_BVH_LEAF_SIZE) {
+    /* This is a leaf node, we unite the boxes of its elements */
+    bvh->node_right[node] = -1;
+    memcpy (box, bvh->element_boxes + 6 * first, 6 * sizeof (double));
+    for (ielement = first + 1; ielement < first + count; ielement++) {
+      child_box = bvh->element_boxes + 6 * ielement;
+      for (i = 0; i < 3; i++) {
+        box[i] = SC_MIN (box[i], child_box[i]);
+        box[i + 3] = SC_MAX (box[i + 3], child_box[i + 3]);
+      }
+    }
+    return;
+  }
+  /* Split the elements in halves. Since they are ordered along the space
+   * filling curve, each half is spatially coherent. */
+  half = count / 2;
+  left = *next_node;
+  t8_forest_bvh_build_node (bvh, first, half, next_node);
+  bvh->node_right[node] = *next_node;
+  t8_forest_bvh_build_node (bvh, first + half, count - half, next_node);
+  /* Unite the boxes of the children */
+  memcpy (box, bvh->node_boxes + 6 * left, 6 * sizeof (double));
+  child_box = bvh->node_boxes + 6 * bvh->node_right[node];
+  for (i = 0; i < 3; i++) {
+    box[i] = SC_MIN (box[i], child_box[i]);
+    box[i + 3] = SC_MAX (box[i + 3], child_box[i + 3]);
+  }
+}
+
+void
+t8_forest_bvh_compute (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_bvh_t     bvh;
+  t8_element_array_t *elements, *elements_from;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  const double       *tree_vertices;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_elements, ielement, lelement;
+  t8_locidx_t         num_elements_from, ielement_from, offset_from;
+  t8_locidx_t         next_node;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->bvh == NULL);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest_from != NULL) {
+    T8_ASSERT (t8_forest_is_committed (forest_from));
+    T8_ASSERT (forest_from->bvh != NULL);
+    /* We can only reuse the boxes if both forests have the same local trees,
+     * which is the case for adapted forests. */
+    if (forest_from->first_local_tree != forest->first_local_tree
+        || t8_forest_get_num_local_trees (forest_from) != num_local_trees) {
+      forest_from = NULL;
+    }
+  }
+
+  bvh = forest->bvh = T8_ALLOC_ZERO (t8_forest_bvh_struct_t, 1);
+  bvh->num_elements = t8_forest_get_local_num_elements (forest);
+  bvh->element_boxes = T8_ALLOC (double, 6 * bvh->num_elements);
+
+  /* Compute the boxes of the elements */
+  for (itree = 0, lelement = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    if (forest_from != NULL) {
+      elements_from = t8_forest_get_tree_element_array (forest_from, itree);
+      num_elements_from =
+        t8_forest_get_tree_num_elements (forest_from, itree);
+      offset_from = t8_forest_get_tree_element_offset (forest_from, itree);
+    }
+    else {
+      elements_from = NULL;
+      num_elements_from = offset_from = 0;
+    }
+    ielement_from = 0;
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      element = t8_element_array_index_locidx (elements, ielement);
+      /* Both element arrays are sorted. We skip the elements of the old tree
+       * that are smaller than the current element and check whether the
+       * next one is the current element. */
+      while (ielement_from < num_elements_from
+             && ts->t8_element_compare (t8_element_array_index_locidx
+                                        (elements_from, ielement_from),
+                                        element) < 0) {
+        ielement_from++;
+      }
+      if (ielement_from < num_elements_from
+          && !ts->t8_element_compare (t8_element_array_index_locidx
+                                      (elements_from, ielement_from),
+                                      element)) {
+        /* The element did not change */
+        memcpy (bvh->element_boxes + 6 * lelement,
+                forest_from->bvh->element_boxes
+                + 6 * (offset_from + ielement_from), 6 * sizeof (double));
+      }
+      else {
+        t8_forest_element_bounding_box (forest, itree, element,
+                                        tree_vertices,
+                                        bvh->element_boxes + 6 * lelement);
+      }
+    }
+  }
+  T8_ASSERT (lelement == bvh->num_elements);
+
+  /* Build the nodes over the elements */
+  if (bvh->num_elements == 0) {
+    return;
+  }
+  bvh->num_nodes = t8_forest_bvh_count_nodes (bvh->num_elements);
+  bvh->node_boxes = T8_ALLOC (double, 6 * bvh->num_nodes);
+  bvh->node_first = T8_ALLOC (t8_locidx_t, bvh->num_nodes);
+  bvh->node_count = T8_ALLOC (t8_locidx_t, bvh->num_nodes);
+  bvh->node_right = T8_ALLOC (t8_locidx_t, bvh->num_nodes);
+  next_node = 0;
+  t8_forest_bvh_build_node (bvh, 0, bvh->num_elements, &next_node);
+  T8_ASSERT (next_node == bvh->num_nodes);
+}
+
+void
+t8_forest_bvh_destroy (t8_forest_t forest)
+{
+  t8_forest_bvh_t     bvh;
+
+  T8_ASSERT (forest != NULL);
+  bvh = forest->bvh;
+  if (bvh == NULL) {
+    return;
+  }
+  T8_FREE (bvh->element_boxes);
+  T8_FREE (bvh->node_boxes);
+  T8_FREE (bvh->node_first);
+  T8_FREE (bvh->node_count);
+  T8_FREE (bvh->node_right);
+  T8_FREE (bvh);
+  forest->bvh = NULL;
+}
+
+int
+t8_forest_has_bvh (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->bvh != NULL;
+}
+
+/* The shapes that the hierarchy can be queried with */
+typedef struct
+{
+  double              box[6];   /* The box */
+  double              center[3];        /* The center of the sphere */
+  double              radius;   /* The radius of the sphere */
+  double              origin[3];        /* The origin of the ray */
+  double              direction[3];     /* The direction of the ray */
+  double              length;   /* The maximum parameter of the ray */
+} t8_forest_bvh_shape_t;
+
+/* Return true if a box intersects another box */
+static int
+t8_forest_bvh_overlaps_box (const double box[6],
+                            const t8_forest_bvh_shape_t * shape)
+{
+  return box[0] <= shape->box[3] && shape->box[0] <= box[3]
+    && box[1] <= shape->box[4] && shape->box[1] <= box[4]
+    && box[2] <= shape->box[5] && shape->box[2] <= box[5];
+}
+
+/* Return true if a box intersects a sphere */
+static int
+t8_forest_bvh_overlaps_sphere (const double box[6],
+                               const t8_forest_bvh_shape_t * shape)
+{
+  double              dist, dist_squared = 0;
+  int                 i;
+
+  /* Add the squared distances of the center to the box in each direction */
+  for (i = 0; i < 3; i++) {
+    dist = 0;
+    if (shape->center[i] < box[i]) {
+      dist = box[i] - shape->center[i];
+    }
+    else if (shape->center[i] > box[i + 3]) {
+      dist = shape->center[i] - box[i + 3];
+    }
+    dist_squared += dist * dist;
+  }
+  return dist_squared <= shape->radius * shape->radius;
+}
+
+/* Return true if a box intersects a ray.
+ * We intersect the parameter ranges in which the ray is between the two
+ * planes of the box in each coordinate direction. */
+static int
+t8_forest_bvh_overlaps_ray (const double box[6],
+                            const t8_forest_bvh_shape_t * shape)
+{
+  double              tmin = 0, tmax = shape->length, t0, t1, tswap;
+  int                 i;
+
+  for (i = 0; i < 3; i++) {
+    if (shape->direction[i] == 0) {
+      /* The ray is parallel to these planes */
+      if (shape->origin[i] < box[i] || shape->origin[i] > box[i + 3]) {
+        return 0;
+      }
+      continue;
+    }
+    t0 = (box[i] - shape->origin[i]) / shape->direction[i];
+    t1 = (box[i + 3] - shape->origin[i]) / shape->direction[i];
+    if (t0 > t1) {
+      tswap = t0;
+      t0 = t1;
+      t1 = tswap;
+    }
+    tmin = SC_MAX (tmin, t0);
+    tmax = SC_MIN (tmax, t1);
+    if (tmin > tmax) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Traverse the hierarchy of a forest and append the local indices of all
+ * elements whose boxes overlap a shape to elements */
+static void
+t8_forest_bvh_query (t8_forest_t forest,
+                     int (*overlaps) (const double box[6],
+                                      const t8_forest_bvh_shape_t * shape),
+                     const t8_forest_bvh_shape_t * shape,
+                     sc_array_t * elements)
+{
+  t8_forest_bvh_t     bvh;
+  t8_locidx_t         stack[T8_FOREST_BVH_MAX_DEPTH];
+  t8_locidx_t         node, ielement, last;
+  int                 stack_size;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (elements != NULL);
+  T8_ASSERT (elements->elem_size == sizeof (t8_locidx_t));
+  bvh = forest->bvh;
+  SC_CHECK_ABORT (bvh != NULL,
+                  "The forest has no bounding volume hierarchy.\n");
+  if (bvh->num_nodes == 0) {
+    return;
+  }
+
+  /* We descend left first, such that the elements are found in
+   * ascending order */
+  stack[0] = 0;
+  stack_size = 1;
+  while (stack_size > 0) {
+    node = stack[--stack_size];
+    if (!overlaps (bvh->node_boxes + 6 * node, shape)) {
+      continue;
+    }
+    if (bvh->node_right[node] < 0) {
+      /* Check the elements of this leaf node */
+      last = bvh->node_first[node] + bvh->node_count[node];
+      for (ielement = bvh->node_first[node]; ielement < last; ielement++) {
+        if (overlaps (bvh->element_boxes + 6 * ielement, shape)) {
+          *(t8_locidx_t *) sc_array_push (elements) = ielement;
+        }
+      }
+    }
+    else {
+      T8_ASSERT (stack_size + 2 <= T8_FOREST_BVH_MAX_DEPTH);
+      stack[stack_size++] = bvh->node_right[node];
+      stack[stack_size++] = node + 1;
+    }
+  }
+}
+
+void
+t8_forest_bvh_query_box (t8_forest_t forest, const double box[6],
+                         sc_array_t * elements)
+{
+  t8_forest_bvh_shape_t shape;
+
+  memcpy (shape.box, box, 6 * sizeof (double));
+  t8_forest_bvh_query (forest, t8_forest_bvh_overlaps_box, &shape, elements);
+}
+
+void
+t8_forest_bvh_query_sphere (t8_forest_t forest, const double center[3],
+                            double radius, sc_array_t * elements)
+{
+  t8_forest_bvh_shape_t shape;
+
+  T8_ASSERT (radius >= 0);
+  memcpy (shape.center, center, 3 * sizeof (double));
+  shape.radius = radius;
+  t8_forest_bvh_query (forest, t8_forest_bvh_overlaps_sphere, &shape,
+                       elements);
+}
+
+void
+t8_forest_bvh_query_ray (t8_forest_t forest, const double origin[3],
+                         const double direction[3], double length,
+                         sc_array_t * elements)
+{
+  t8_forest_bvh_shape_t shape;
+
+  T8_ASSERT (length >= 0);
+  memcpy (shape.origin, origin, 3 * sizeof (double));
+  memcpy (shape.direction, direction, 3 * sizeof (double));
+  shape.length = length;
+  t8_forest_bvh_query (forest, t8_forest_bvh_overlaps_ray, &shape, elements);
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,56 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_bvh.h
+ * We define routines to compute and store a bounding volume hierarchy
+ * over the local elements of a forest.
+ * \see t8_forest_set_bvh
+ */
+
+#ifndef T8_FOREST_BVH_H
+#define T8_FOREST_BVH_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the bounding volume hierarchy of a forest.
+ * \param [in,out] forest       A forest with local elements and computed
+ *                              tree element offsets. On output its bounding
+ *                              volume hierarchy is set.
+ * \param [in]     forest_from  If not NULL, a committed forest with bounding
+ *                              volume hierarchy from which \a forest was
+ *                              adapted. The boxes of the elements that did
+ *                              not change are copied from its hierarchy.
+ */
+void                t8_forest_bvh_compute (t8_forest_t forest,
+                                           t8_forest_t forest_from);
+
+/** Free the memory of the bounding volume hierarchy of a forest, if it has one.
+ * \param [in,out] forest       A forest. On output its hierarchy is NULL.
+ */
+void                t8_forest_bvh_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_BVH_H! */
@@ -0,0 +1,338 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest_conduit.h>
+#include <t8_element_cxx.hxx>
+#include "t8_forest_types.h"
+#if T8_WITH_CONDUIT
+#include <conduit.h>
+#include <conduit_blueprint.h>
+#endif
+
+void
+t8_forest_conduit_mesh_init (t8_forest_conduit_mesh_t * mesh,
+                             t8_forest_t forest, int write_treeid,
+                             int write_mpirank, int write_level,
+                             int write_element_id, int num_data,
+                             t8_vtk_data_field_t * data)
+{
+  t8_locidx_t         itree, ielement, num_local_trees, num_elements;
+  t8_locidx_t         lelement, ipoint;
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_element_shape_t  shape;
+  t8_gloidx_t         gtreeid, first_element;
+  double             *tree_vertices;
+  int                 ivertex;
+
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_data == 0 || data != NULL);
+
+  t8_forest_ref (forest);
+  mesh->forest = forest;
+  mesh->num_elements = t8_forest_get_local_num_elements (forest);
+  mesh->num_data = num_data;
+  mesh->data = data;
+
+  /* Count the corners of all elements */
+  mesh->num_points = 0;
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      mesh->num_points += ts->t8_element_num_corners (element);
+    }
+  }
+
+  mesh->coordinates = T8_ALLOC (double, 3 * mesh->num_points);
+  mesh->connectivity = T8_ALLOC (int64_t, mesh->num_points);
+  mesh->offsets = T8_ALLOC (int64_t, mesh->num_elements);
+  mesh->sizes = T8_ALLOC (int32_t, mesh->num_elements);
+  mesh->shapes = T8_ALLOC (int32_t, mesh->num_elements);
+  mesh->treeids = write_treeid ? T8_ALLOC (int64_t, mesh->num_elements)
+    : NULL;
+  mesh->element_ids = write_element_id ?
+    T8_ALLOC (int64_t, mesh->num_elements) : NULL;
+  mesh->mpiranks = write_mpirank ? T8_ALLOC (int32_t, mesh->num_elements)
+    : NULL;
+  mesh->levels = write_level ? T8_ALLOC (int32_t, mesh->num_elements)
+    : NULL;
+  mesh->single_shape = -1;
+
+  first_element = t8_forest_get_first_local_element_id (forest);
+  lelement = ipoint = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    gtreeid = t8_forest_global_tree_id (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      shape = ts->t8_element_shape (element);
+      mesh->offsets[lelement] = ipoint;
+      mesh->sizes[lelement] = t8_eclass_num_vertices[shape];
+      mesh->shapes[lelement] = t8_eclass_vtk_type[shape];
+      if (lelement == 0) {
+        mesh->single_shape = shape;
+      }
+      else if (mesh->single_shape != (int) shape) {
+        mesh->single_shape = -2;
+      }
+      for (ivertex = 0; ivertex < t8_eclass_num_vertices[shape];
+           ivertex++, ipoint++) {
+        mesh->connectivity[ipoint] = ipoint;
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      t8_eclass_vtk_corner_number[shape]
+                                      [ivertex],
+                                      mesh->coordinates + 3 * ipoint);
+      }
+      if (write_treeid) {
+        mesh->treeids[lelement] = gtreeid;
+      }
+      if (write_element_id) {
+        mesh->element_ids[lelement] = first_element + lelement;
+      }
+      if (write_mpirank) {
+        mesh->mpiranks[lelement] = forest->mpirank;
+      }
+      if (write_level) {
+        mesh->levels[lelement] = ts->t8_element_level (element);
+      }
+    }
+  }
+  T8_ASSERT (lelement == mesh->num_elements);
+  T8_ASSERT (ipoint == mesh->num_points);
+  if (mesh->single_shape < -1) {
+    /* The local elements have different shapes */
+    mesh->single_shape = -1;
+  }
+}
+
+void
+t8_forest_conduit_mesh_reset (t8_forest_conduit_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+
+  T8_FREE (mesh->coordinates);
+  T8_FREE (mesh->connectivity);
+  T8_FREE (mesh->offsets);
+  T8_FREE (mesh->sizes);
+  T8_FREE (mesh->shapes);
+  T8_FREE (mesh->treeids);
+  T8_FREE (mesh->element_ids);
+  T8_FREE (mesh->mpiranks);
+  T8_FREE (mesh->levels);
+  t8_forest_unref (&mesh->forest);
+}
+
+#if T8_WITH_CONDUIT
+/* The names of the element shapes in the Mesh Blueprint in the order of
+ * t8_eclass_t. */
+static const char  *t8_forest_conduit_shape_name[T8_ECLASS_COUNT] = {
+  "point", "line", "quad", "tri", "hex", "tet", "wedge", "pyramid"
+};
+
+/* Set a field of 1 or 3 double values per element that references the
+ * values without copying them. */
+static void
+t8_forest_conduit_set_double_field (conduit_node * fields, const char *name,
+                                    const char *topology, double *values,
+                                    int num_components,
+                                    t8_locidx_t num_elements)
+{
+  conduit_node       *field = conduit_node_fetch (fields, name);
+  const char         *components[3] = { "values/x", "values/y", "values/z" };
+  int                 icomp;
+
+  conduit_node_set_path_char8_str (field, "association", "element");
+  conduit_node_set_path_char8_str (field, "topology", topology);
+  if (num_components == 1) {
+    conduit_node_set_path_external_float64_ptr (field, "values", values,
+                                                num_elements);
+    return;
+  }
+  T8_ASSERT (num_components == 3);
+  for (icomp = 0; icomp < 3; icomp++) {
+    conduit_node_set_path_external_float64_ptr_detailed (field,
+                                                         components[icomp],
+                                                         values,
+                                                         num_elements,
+                                                         icomp *
+                                                         sizeof (double),
+                                                         3 * sizeof (double),
+                                                         sizeof (double),
+                                                         CONDUIT_ENDIANNESS_DEFAULT_ID);
+  }
+}
+
+/* Set a field of integer values per element that references the values
+ * without copying them. */
+static void
+t8_forest_conduit_set_int_field (conduit_node * fields, const char *name,
+                                 const char *topology, int32_t *values32,
+                                 int64_t *values64, t8_locidx_t num_elements)
+{
+  conduit_node       *field = conduit_node_fetch (fields, name);
+
+  conduit_node_set_path_char8_str (field, "association", "element");
+  conduit_node_set_path_char8_str (field, "topology", topology);
+  if (values32 != NULL) {
+    conduit_node_set_path_external_int32_ptr (field, "values",
+                                              (conduit_int32 *) values32,
+                                              num_elements);
+  }
+  else {
+    conduit_node_set_path_external_int64_ptr (field, "values",
+                                              (conduit_int64 *) values64,
+                                              num_elements);
+  }
+}
+#endif
+
+int
+t8_forest_conduit_publish (const t8_forest_conduit_mesh_t * mesh,
+                           void *node, const char *name)
+{
+#if T8_WITH_CONDUIT
+  conduit_node       *cnode = (conduit_node *) node;
+  conduit_node       *coords, *elements, *fields;
+  t8_forest_geometry_cache_t cache;
+  char                path[BUFSIZ];
+  int                 ieclass, idata;
+  const char         *components[3] = { "values/x", "values/y", "values/z" };
+
+  T8_ASSERT (mesh != NULL && mesh->forest != NULL);
+  T8_ASSERT (node != NULL && name != NULL);
+
+  /* The corner coordinates, strided views into the interleaved array */
+  coords = conduit_node_fetch (cnode, "coordsets/coords");
+  conduit_node_set_path_char8_str (coords, "type", "explicit");
+  for (idata = 0; idata < 3; idata++) {
+    conduit_node_set_path_external_float64_ptr_detailed (coords,
+                                                         components[idata],
+                                                         mesh->coordinates,
+                                                         mesh->num_points,
+                                                         idata *
+                                                         sizeof (double),
+                                                         3 * sizeof (double),
+                                                         sizeof (double),
+                                                         CONDUIT_ENDIANNESS_DEFAULT_ID);
+  }
+
+  /* The unstructured topology */
+  snprintf (path, BUFSIZ, "topologies/%s", name);
+  elements = conduit_node_fetch (cnode, path);
+  conduit_node_set_path_char8_str (elements, "type", "unstructured");
+  conduit_node_set_path_char8_str (elements, "coordset", "coords");
+  elements = conduit_node_fetch (elements, "elements");
+  if (mesh->single_shape >= 0) {
+    conduit_node_set_path_char8_str (elements, "shape",
+                                     t8_forest_conduit_shape_name
+                                     [mesh->single_shape]);
+  }
+  else {
+    conduit_node_set_path_char8_str (elements, "shape", "mixed");
+    for (ieclass = T8_ECLASS_ZERO; ieclass < T8_ECLASS_COUNT; ieclass++) {
+      snprintf (path, BUFSIZ, "shape_map/%s",
+                t8_forest_conduit_shape_name[ieclass]);
+      conduit_node_set_path_int32 (elements, path,
+                                   t8_eclass_vtk_type[ieclass]);
+    }
+    conduit_node_set_path_external_int32_ptr (elements, "shapes",
+                                              (conduit_int32 *) mesh->shapes,
+                                              mesh->num_elements);
+  }
+  conduit_node_set_path_external_int64_ptr (elements, "connectivity",
+                                            (conduit_int64 *)
+                                            mesh->connectivity,
+                                            mesh->num_points);
+  conduit_node_set_path_external_int32_ptr (elements, "sizes",
+                                            (conduit_int32 *) mesh->sizes,
+                                            mesh->num_elements);
+  conduit_node_set_path_external_int64_ptr (elements, "offsets",
+                                            (conduit_int64 *) mesh->offsets,
+                                            mesh->num_elements);
+
+  /* The element fields */
+  fields = conduit_node_fetch (cnode, "fields");
+  if (mesh->treeids != NULL) {
+    t8_forest_conduit_set_int_field (fields, "treeid", name, NULL,
+                                     mesh->treeids, mesh->num_elements);
+  }
+  if (mesh->element_ids != NULL) {
+    t8_forest_conduit_set_int_field (fields, "element_id", name, NULL,
+                                     mesh->element_ids, mesh->num_elements);
+  }
+  if (mesh->mpiranks != NULL) {
+    t8_forest_conduit_set_int_field (fields, "mpirank", name,
+                                     mesh->mpiranks, NULL,
+                                     mesh->num_elements);
+  }
+  if (mesh->levels != NULL) {
+    t8_forest_conduit_set_int_field (fields, "level", name, mesh->levels,
+                                     NULL, mesh->num_elements);
+  }
+  cache = mesh->forest->geometry_cache;
+  if (cache != NULL) {
+    T8_ASSERT (cache->num_elements == mesh->num_elements);
+    t8_forest_conduit_set_double_field (fields, "centroid", name,
+                                        cache->centroids, 3,
+                                        mesh->num_elements);
+    t8_forest_conduit_set_double_field (fields, "volume", name,
+                                        cache->volumes, 1,
+                                        mesh->num_elements);
+  }
+  for (idata = 0; idata < mesh->num_data; idata++) {
+    t8_forest_conduit_set_double_field (fields,
+                                        mesh->data[idata].description, name,
+                                        mesh->data[idata].data,
+                                        mesh->data[idata].type ==
+                                        T8_VTK_VECTOR ? 3 : 1,
+                                        mesh->num_elements);
+  }
+
+#ifdef T8_ENABLE_DEBUG
+  {
+    conduit_node       *info = conduit_node_create ();
+    int                 valid;
+
+    valid = conduit_blueprint_verify ("mesh", cnode, info);
+    if (!valid) {
+      t8_errorf ("The Conduit node is not a valid Blueprint mesh.\n");
+    }
+    conduit_node_destroy (info);
+    return valid;
+  }
+#endif
+  return 1;
+#else
+  t8_global_errorf ("Warning: t8code is not linked against conduit. "
+                    "Did not publish the mesh %s.\n", name);
+  return 0;
+#endif
+}
@@ -0,0 +1,239 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_cost_model.cxx
+ * A model of the runtime of an element by its eclass and level that is
+ * fitted to measured runtimes and used as partition weights.
+ * \see t8_forest_cost_model_new
+ */
+
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The number of levels for which a cost is stored per eclass.
+ * Elements of a finer level share the cost of the finest stored level. */
+#define T8_FOREST_COST_MODEL_LEVELS 32
+
+/* The costs and the runtimes recorded since the last fit. */
+typedef struct t8_forest_cost_model
+{
+  double              smoothing;        /* Weight of a new fit. */
+  int                 fitted;           /* True after the first fit. */
+  double              imbalance;        /* The imbalance of the last fit. */
+  double              cost[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  int8_t              measured[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  double              eclass_cost[T8_ECLASS_COUNT]; /* Average cost of the measured
+                                                       levels of an eclass, or -1. */
+  double              average_cost;     /* Average over the measured eclasses. */
+  /* The recorded runtime and number of elements of each eclass and level. */
+  double              runtime[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  double              count[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  double              local_runtime;    /* The total recorded runtime. */
+} t8_forest_cost_model_struct_t;
+
+t8_forest_cost_model_t
+t8_forest_cost_model_new (double smoothing)
+{
+  t8_forest_cost_model_t model;
+
+  T8_ASSERT (0 < smoothing && smoothing <= 1);
+
+  model = T8_ALLOC_ZERO (t8_forest_cost_model_struct_t, 1);
+  model->smoothing = smoothing;
+  model->imbalance = 1;
+  return model;
+}
+
+void
+t8_forest_cost_model_destroy (t8_forest_cost_model_t * pmodel)
+{
+  T8_ASSERT (pmodel != NULL && *pmodel != NULL);
+
+  T8_FREE (*pmodel);
+  *pmodel = NULL;
+}
+
+/* Clamp a level to the stored levels */
+static int
+t8_forest_cost_model_level (int level)
+{
+  T8_ASSERT (level >= 0);
+  return SC_MIN (level, T8_FOREST_COST_MODEL_LEVELS - 1);
+}
+
+double
+t8_forest_cost_model_get_cost (t8_forest_cost_model_t model,
+                               t8_eclass_t eclass, int level)
+{
+  T8_ASSERT (model != NULL);
+  T8_ASSERT (0 <= eclass && eclass < T8_ECLASS_COUNT);
+
+  if (!model->fitted) {
+    return 1;
+  }
+  level = t8_forest_cost_model_level (level);
+  if (model->measured[eclass][level]) {
+    return model->cost[eclass][level];
+  }
+  if (model->eclass_cost[eclass] >= 0) {
+    return model->eclass_cost[eclass];
+  }
+  return model->average_cost;
+}
+
+double
+t8_forest_cost_model_get_imbalance (t8_forest_cost_model_t model)
+{
+  T8_ASSERT (model != NULL);
+  return model->imbalance;
+}
+
+void
+t8_forest_cost_model_record (t8_forest_cost_model_t model,
+                             t8_forest_t forest, t8_locidx_t ltreeid,
+                             t8_locidx_t first_element,
+                             t8_locidx_t num_elements, double runtime)
+{
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         eclass;
+  const t8_element_t *element;
+  t8_locidx_t         ielement, last_element;
+  double              predicted, cost;
+  int                 level;
+
+  T8_ASSERT (model != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (runtime >= 0);
+
+  eclass = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  last_element = num_elements < 0 ?
+    t8_forest_get_tree_num_elements (forest, ltreeid) :
+    first_element + num_elements;
+  T8_ASSERT (0 <= first_element && first_element <= last_element);
+  T8_ASSERT (last_element <= t8_forest_get_tree_num_elements (forest,
+                                                              ltreeid));
+
+  /* The predicted runtime of the range */
+  predicted = 0;
+  for (ielement = first_element; ielement < last_element; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+    predicted += t8_forest_cost_model_get_cost (model, eclass,
+                                                ts->t8_element_level
+                                                (element));
+  }
+  /* Each element gets the share of the runtime that it was predicted to
+   * take. If nothing was predicted, all elements get the same share. */
+  for (ielement = first_element; ielement < last_element; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+    level = ts->t8_element_level (element);
+    cost = predicted > 0 ?
+      t8_forest_cost_model_get_cost (model, eclass, level) / predicted :
+      1. / (last_element - first_element);
+    level = t8_forest_cost_model_level (level);
+    model->runtime[eclass][level] += cost * runtime;
+    model->count[eclass][level] += 1;
+  }
+  model->local_runtime += runtime;
+}
+
+double
+t8_forest_cost_model_fit (t8_forest_cost_model_t model, sc_MPI_Comm comm)
+{
+  double              runtime[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  double              count[T8_ECLASS_COUNT][T8_FOREST_COST_MODEL_LEVELS];
+  double              max_runtime, sum_runtime, cost, sum;
+  int                 eclass, level, num_levels, num_eclasses;
+  int                 mpiret, mpisize;
+
+  T8_ASSERT (model != NULL);
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (model->runtime, runtime,
+                             T8_ECLASS_COUNT * T8_FOREST_COST_MODEL_LEVELS,
+                             sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (model->count, count,
+                             T8_ECLASS_COUNT * T8_FOREST_COST_MODEL_LEVELS,
+                             sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&model->local_runtime, &max_runtime, 1,
+                             sc_MPI_DOUBLE, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&model->local_runtime, &sum_runtime, 1,
+                             sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  model->imbalance = sum_runtime > 0 ?
+    max_runtime * mpisize / sum_runtime : 1;
+
+  /* Combine the measured costs with the previous ones */
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    for (level = 0; level < T8_FOREST_COST_MODEL_LEVELS; level++) {
+      if (count[eclass][level] > 0) {
+        cost = runtime[eclass][level] / count[eclass][level];
+        if (model->measured[eclass][level]) {
+          cost = model->smoothing * cost
+            + (1 - model->smoothing) * model->cost[eclass][level];
+        }
+        model->cost[eclass][level] = cost;
+        model->measured[eclass][level] = 1;
+      }
+    }
+  }
+  /* Compute the costs of unmeasured levels and eclasses */
+  sum = 0;
+  num_eclasses = 0;
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    cost = 0;
+    num_levels = 0;
+    for (level = 0; level < T8_FOREST_COST_MODEL_LEVELS; level++) {
+      if (model->measured[eclass][level]) {
+        cost += model->cost[eclass][level];
+        num_levels++;
+      }
+    }
+    if (num_levels > 0) {
+      model->eclass_cost[eclass] = cost / num_levels;
+      sum += model->eclass_cost[eclass];
+      num_eclasses++;
+    }
+    else {
+      model->eclass_cost[eclass] = -1;
+    }
+  }
+  model->average_cost = num_eclasses > 0 ? sum / num_eclasses : 1;
+  model->fitted = 1;
+
+  /* Reset the records for the next fit */
+  memset (model->runtime, 0, sizeof (model->runtime));
+  memset (model->count, 0, sizeof (model->count));
+  model->local_runtime = 0;
+  return model->imbalance;
+}
+
+T8_EXTERN_C_END ();
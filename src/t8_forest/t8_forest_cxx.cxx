@@ -30,6 +30,8 @@
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_ghost.h>
 #include <t8_forest/t8_forest_balance.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_save.h>
 #include <t8_element_cxx.hxx>
 #include <t8_cmesh/t8_cmesh_trees.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
@@ -172,6 +174,12 @@ t8_forest_is_equal (t8_forest_t forest_a, t8_forest_t forest_b)
     if (elems_in_tree_a != elems_in_tree_b) {
       return 0;
     }
+    if (forest_a->hash_valid && forest_b->hash_valid
+        && t8_forest_get_tree (forest_a, itree)->hash !=
+        t8_forest_get_tree (forest_b, itree)->hash) {
+      /* Different hashes imply different elements */
+      return 0;
+    }
     for (ielem = 0; ielem < elems_in_tree_a; ielem++) {
       /* Get pointers to both elements */
       elem_a = t8_forest_get_element_in_tree (forest_a, itree, ielem);
@@ -219,6 +227,20 @@ t8_forest_bilinear_interpolation (const double *vertex,
   }
 }
 
+/* Return the precomputed map of a local or ghost tree if it was computed
+ * from the given vertices, otherwise NULL. */
+static const t8_forest_tree_map_t *
+t8_forest_tree_map_lookup (t8_forest_t forest, t8_locidx_t ltreeid,
+                           const double *vertices)
+{
+  if (forest->tree_maps == NULL || vertices == NULL
+      || ltreeid >= forest->tree_maps_num_trees
+      || forest->tree_maps[ltreeid].vertices != vertices) {
+    return NULL;
+  }
+  return forest->tree_maps + ltreeid;
+}
+
 /* given an element in a coarse tree, the corner coordinates of the coarse tree
  * and a corner number of the element compute the coordinates of that corner
  * within the coarse tree.
@@ -236,6 +258,7 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
   t8_eclass_t         tree_class;
   double              len;
   int                 dim;
+  const t8_forest_tree_map_t *map;
 
   T8_ASSERT (forest != NULL);
   T8_ASSERT (forest->scheme_cxx != NULL);
@@ -246,6 +269,25 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
   dim = t8_eclass_to_dimension[tree_class];
   len = 1. / ts->t8_element_root_len (element);
   ts->t8_element_vertex_coords (element, corner_number, corner_coords);
+  if (forest->geometry != NULL) {
+    /* Map the reference coordinates of the corner with the geometry */
+    for (i = 0; i < 3; i++) {
+      vertex_coords[i] = i < dim ? len * corner_coords[i] : 0;
+    }
+    t8_geometry_evaluate (forest->geometry, (t8_topidx_t)
+                          t8_forest_global_tree_id (forest, ltree_id), 1,
+                          vertex_coords, coordinates, NULL);
+    return;
+  }
+  map = t8_forest_tree_map_lookup (forest, ltree_id, vertices);
+  if (map != NULL) {
+    /* Apply the precomputed map of the tree */
+    for (i = 0; i < 3; i++) {
+      coordinates[i] = i < dim ? len * corner_coords[i] : 0;
+    }
+    t8_forest_tree_map_apply (map, 1, coordinates);
+    return;
+  }
   /* Check whether we support this tree_class */
   T8_ASSERT (tree_class == T8_ECLASS_VERTEX
              || tree_class == T8_ECLASS_TRIANGLE
@@ -253,7 +295,8 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
              || tree_class == T8_ECLASS_QUAD
              || tree_class == T8_ECLASS_HEX
              || tree_class == T8_ECLASS_LINE
-             || tree_class == T8_ECLASS_PRISM);
+             || tree_class == T8_ECLASS_PRISM
+             || tree_class == T8_ECLASS_PYRAMID);
   /* Compute the coordinates, depending on the class of the tree */
   switch (tree_class) {
   case T8_ECLASS_VERTEX:
@@ -313,13 +356,550 @@ t8_forest_element_coordinate (t8_forest_t forest, t8_locidx_t ltree_id,
     t8_forest_bilinear_interpolation ((const double *) vertex_coords,
                                       vertices, dim, coordinates);
     break;
+  case T8_ECLASS_PYRAMID:
+    {
+      /* The reference pyramid has the base [0,1]^2 x {0} and the apex
+       * (1,1,1). Its intersection with the plane at height z is the square
+       * [z,1]^2, which we map to the base of the tree and then
+       * interpolate between the base and the apex. */
+      double              base_coords[3], base[3];
+
+      for (i = 0; i < 3; i++) {
+        vertex_coords[i] = len * corner_coords[i];
+      }
+      if (vertex_coords[2] == 1) {
+        /* The corner is the apex */
+        for (i = 0; i < 3; i++) {
+          coordinates[i] = vertices[12 + i];
+        }
+        break;
+      }
+      base_coords[0] = (vertex_coords[0] - vertex_coords[2])
+        / (1 - vertex_coords[2]);
+      base_coords[1] = (vertex_coords[1] - vertex_coords[2])
+        / (1 - vertex_coords[2]);
+      base_coords[2] = 0;
+      t8_forest_bilinear_interpolation ((const double *) base_coords,
+                                        vertices, 2, base);
+      for (i = 0; i < 3; i++) {
+        coordinates[i] = (1 - vertex_coords[2]) * base[i]
+          + vertex_coords[2] * vertices[12 + i];
+      }
+    }
+    break;
   default:
     SC_ABORT ("Forest coordinate computation is supported only for "
-              "vertices/lines/triangles/tets/quads/prisms/hexes.");
+              "vertices/lines/triangles/tets/quads/prisms/hexes/pyramids.");
   }
   return;
 }
 
+/* Compute the coefficients of the map from the reference coordinates of a
+ * coarse tree to its physical coordinates. The map is the same as in
+ * t8_forest_element_coordinate, but written in monomials such that it can
+ * be applied to many points with a few multiply-adds per coordinate. */
+static void
+t8_forest_tree_map_init (t8_eclass_t tree_class, const double *vertices,
+                         t8_forest_tree_map_t * map)
+{
+  double            (*coeff)[3] = map->coeff;
+  int                 i;
+
+  memset (map, 0, sizeof (*map));
+  map->eclass = tree_class;
+  map->vertices = vertices;
+  switch (tree_class) {
+  case T8_ECLASS_VERTEX:
+    /* As in t8_forest_element_coordinate, the coordinates of a vertex
+     * are its reference coordinates. */
+    break;
+  case T8_ECLASS_LINE:
+  case T8_ECLASS_TRIANGLE:
+  case T8_ECLASS_TET:
+    /* The map is affine: x = v_0 + A ref, where the columns of A
+     * are stored in coeff[1], coeff[2] and coeff[3]. */
+    for (i = 0; i < 3; i++) {
+      coeff[0][i] = vertices[i];
+      coeff[1][i] = vertices[3 + i] - vertices[i];
+      if (tree_class == T8_ECLASS_TRIANGLE) {
+        coeff[2][i] = vertices[6 + i] - vertices[3 + i];
+      }
+      else if (tree_class == T8_ECLASS_TET) {
+        coeff[2][i] = vertices[9 + i] - vertices[6 + i];
+        coeff[3][i] = vertices[6 + i] - vertices[3 + i];
+      }
+    }
+    break;
+  case T8_ECLASS_PRISM:
+    /* The map is affine in the triangle coordinates and linear in
+     * the height, we expand it into its monomials. */
+    for (i = 0; i < 3; i++) {
+      coeff[0][i] = vertices[i];
+      coeff[1][i] = vertices[3 + i] - vertices[i];
+      coeff[2][i] = vertices[6 + i] - vertices[3 + i];
+      coeff[3][i] = vertices[9 + i] - vertices[i];
+      coeff[4][i] = vertices[12 + i] - vertices[9 + i] - coeff[1][i];
+      coeff[5][i] = vertices[15 + i] - vertices[12 + i] - coeff[2][i];
+    }
+    break;
+  case T8_ECLASS_QUAD:
+  case T8_ECLASS_HEX:
+  case T8_ECLASS_PYRAMID:
+    /* Monomial coefficients of the bilinear map of the base square and,
+     * for hexes, of the bilinear map of the top square in coeff[4..7].
+     * For pyramids coeff[4] is the apex. */
+    for (i = 0; i < 3; i++) {
+      coeff[0][i] = vertices[i];
+      coeff[1][i] = vertices[3 + i] - vertices[i];
+      coeff[2][i] = vertices[6 + i] - vertices[i];
+      coeff[3][i] = vertices[9 + i] - vertices[6 + i] - coeff[1][i];
+      if (tree_class == T8_ECLASS_HEX) {
+        coeff[4][i] = vertices[12 + i];
+        coeff[5][i] = vertices[15 + i] - vertices[12 + i];
+        coeff[6][i] = vertices[18 + i] - vertices[12 + i];
+        coeff[7][i] = vertices[21 + i] - vertices[18 + i] - coeff[5][i];
+      }
+      else if (tree_class == T8_ECLASS_PYRAMID) {
+        coeff[4][i] = vertices[12 + i];
+      }
+    }
+    break;
+  default:
+    SC_ABORT ("Forest coordinate computation is supported only for "
+              "vertices/lines/triangles/tets/quads/prisms/hexes/pyramids.");
+  }
+}
+
+void
+t8_forest_tree_map_apply (const t8_forest_tree_map_t * map,
+                          size_t num_points, double *points)
+{
+  const double        (*coeff)[3] = map->coeff;
+  double              ref[3];
+  size_t              ipoint;
+  int                 i;
+
+  T8_ASSERT (map != NULL);
+  switch (map->eclass) {
+  case T8_ECLASS_VERTEX:
+    break;
+  case T8_ECLASS_LINE:
+  case T8_ECLASS_TRIANGLE:
+  case T8_ECLASS_TET:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      double             *point = points + 3 * ipoint;
+
+      for (i = 0; i < 3; i++) {
+        ref[i] = point[i];
+      }
+      for (i = 0; i < 3; i++) {
+        point[i] = coeff[0][i] + coeff[1][i] * ref[0]
+          + coeff[2][i] * ref[1] + coeff[3][i] * ref[2];
+      }
+    }
+    break;
+  case T8_ECLASS_PRISM:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      double             *point = points + 3 * ipoint;
+
+      for (i = 0; i < 3; i++) {
+        ref[i] = point[i];
+      }
+      for (i = 0; i < 3; i++) {
+        point[i] = coeff[0][i] + coeff[1][i] * ref[0]
+          + coeff[2][i] * ref[1] + coeff[3][i] * ref[2]
+          + (coeff[4][i] * ref[0] + coeff[5][i] * ref[1]) * ref[2];
+      }
+    }
+    break;
+  case T8_ECLASS_QUAD:
+  case T8_ECLASS_HEX:
+  case T8_ECLASS_PYRAMID:
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      double             *point = points + 3 * ipoint;
+      double              height = 0;
+
+      for (i = 0; i < 3; i++) {
+        ref[i] = point[i];
+      }
+      if (map->eclass == T8_ECLASS_PYRAMID) {
+        /* Project the point along the line through the apex onto the
+         * base, see t8_forest_element_coordinate. */
+        height = ref[2];
+        if (height == 1) {
+          for (i = 0; i < 3; i++) {
+            point[i] = coeff[4][i];
+          }
+          continue;
+        }
+        ref[0] = (ref[0] - height) / (1 - height);
+        ref[1] = (ref[1] - height) / (1 - height);
+      }
+      for (i = 0; i < 3; i++) {
+        point[i] = coeff[0][i] + coeff[1][i] * ref[0]
+          + coeff[2][i] * ref[1] + coeff[3][i] * ref[0] * ref[1];
+      }
+      if (map->eclass == T8_ECLASS_HEX) {
+        for (i = 0; i < 3; i++) {
+          point[i] = (1 - ref[2]) * point[i]
+            + ref[2] * (coeff[4][i] + coeff[5][i] * ref[0]
+                        + coeff[6][i] * ref[1]
+                        + coeff[7][i] * ref[0] * ref[1]);
+        }
+      }
+      else if (map->eclass == T8_ECLASS_PYRAMID) {
+        for (i = 0; i < 3; i++) {
+          point[i] = (1 - height) * point[i] + height * coeff[4][i];
+        }
+      }
+    }
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+void
+t8_forest_tree_maps_compute (t8_forest_t forest)
+{
+  t8_locidx_t         num_trees, itree;
+  const double       *vertices;
+
+  T8_ASSERT (forest->tree_maps == NULL);
+  num_trees = t8_forest_get_num_local_trees (forest)
+    + t8_forest_get_num_ghost_trees (forest);
+  /* t8_forest_get_tree_vertices looks up the vertices in the cmesh
+   * until the cache is filled */
+  forest->tree_maps_num_trees = 0;
+  forest->tree_maps = T8_ALLOC_ZERO (t8_forest_tree_map_t, num_trees);
+  for (itree = 0; itree < num_trees; itree++) {
+    vertices = t8_forest_get_tree_vertices (forest, itree);
+    if (vertices != NULL) {
+      t8_forest_tree_map_init (t8_forest_get_tree_class (forest, itree),
+                               vertices, forest->tree_maps + itree);
+    }
+  }
+  forest->tree_maps_num_trees = num_trees;
+}
+
+/* Map points in reference coordinates of a tree to its physical
+ * coordinates in place, using the precomputed map if it exists. */
+static void
+t8_forest_tree_map_points (t8_forest_t forest, t8_locidx_t ltreeid,
+                           const double *vertices, size_t num_points,
+                           double *points)
+{
+  const t8_forest_tree_map_t *map;
+  t8_forest_tree_map_t tree_map;
+
+  map = t8_forest_tree_map_lookup (forest, ltreeid, vertices);
+  if (map == NULL) {
+    t8_forest_tree_map_init (t8_forest_get_tree_class (forest, ltreeid),
+                             vertices, &tree_map);
+    map = &tree_map;
+  }
+  t8_forest_tree_map_apply (map, num_points, points);
+}
+
+const t8_forest_tree_map_t *
+t8_forest_get_tree_map (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid && ltreeid < forest->tree_maps_num_trees);
+
+  if (forest->geometry != NULL
+      || forest->tree_maps[ltreeid].vertices == NULL) {
+    return NULL;
+  }
+  return forest->tree_maps + ltreeid;
+}
+
+void
+t8_forest_tree_map_reference_points (t8_forest_t forest, t8_locidx_t ltreeid,
+                                     size_t num_points, const double *ref,
+                                     double *coordinates, double *jacobian)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (num_points == 0 || ref != coordinates);
+
+  if (forest->geometry != NULL) {
+    /* One call of the geometry for all points */
+    t8_geometry_evaluate (forest->geometry, (t8_topidx_t)
+                          t8_forest_global_tree_id (forest, ltreeid),
+                          num_points, ref, coordinates, jacobian);
+    return;
+  }
+  SC_CHECK_ABORT (jacobian == NULL, "Jacobians can only be computed for"
+                  " forests with a geometry");
+  memcpy (coordinates, ref, 3 * num_points * sizeof (double));
+  t8_forest_tree_map_points (forest, ltreeid,
+                             t8_forest_get_tree_vertices (forest, ltreeid),
+                             num_points, coordinates);
+}
+
+/* Map points in reference coordinates of a local tree to physical space in
+ * place, with the geometry of the forest if it exists. */
+static void
+t8_forest_tree_points_to_physical (t8_forest_t forest, t8_locidx_t ltreeid,
+                                   size_t num_points, double *points)
+{
+  double             *ref;
+
+  if (num_points == 0) {
+    return;
+  }
+  if (forest->geometry == NULL) {
+    t8_forest_tree_map_points (forest, ltreeid,
+                               t8_forest_get_tree_vertices (forest, ltreeid),
+                               num_points, points);
+    return;
+  }
+  /* The geometry needs separate input and output arrays */
+  ref = T8_ALLOC (double, 3 * num_points);
+  memcpy (ref, points, 3 * num_points * sizeof (double));
+  t8_forest_tree_map_reference_points (forest, ltreeid, num_points, ref,
+                                       points, NULL);
+  T8_FREE (ref);
+}
+
+t8_locidx_t
+t8_forest_get_tree_num_corners (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  t8_element_array_t *elements;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  t8_locidx_t         num_elements, ielement, num_corners;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  if (tree_class != T8_ECLASS_PYRAMID) {
+    /* All elements of the tree have the same number of corners */
+    return num_elements * t8_eclass_num_vertices[tree_class];
+  }
+  /* A pyramid tree also contains tetrahedra */
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  elements = t8_forest_get_tree_element_array (forest, ltreeid);
+  for (ielement = 0, num_corners = 0; ielement < num_elements; ielement++) {
+    num_corners +=
+      ts->t8_element_num_corners (t8_element_array_index_locidx
+                                  (elements, ielement));
+  }
+  return num_corners;
+}
+
+void
+t8_forest_tree_element_coordinates (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    double *coordinates)
+{
+  t8_element_array_t *elements;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  t8_locidx_t         num_elements, ielement;
+  size_t              num_points;
+  int                 corner_coords[3];
+  int                 num_corners, icorner, i, dim;
+  double              len;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (coordinates != NULL);
+
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  if (num_elements == 0) {
+    return;
+  }
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  dim = t8_eclass_to_dimension[tree_class];
+  elements = t8_forest_get_tree_element_array (forest, ltreeid);
+  /* The root length is the same for all elements of a tree */
+  len = 1. / ts->t8_element_root_len (t8_element_array_index_locidx
+                                      (elements, 0));
+
+  /* Store the corners of all elements in reference coordinates */
+  num_points = 0;
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    element = t8_element_array_index_locidx (elements, ielement);
+    num_corners = ts->t8_element_num_corners (element);
+    for (icorner = 0; icorner < num_corners; icorner++, num_points++) {
+      ts->t8_element_vertex_coords (element, icorner, corner_coords);
+      /* The coordinates beyond the dimension of the tree are not used */
+      for (i = dim; i < 3; i++) {
+        corner_coords[i] = 0;
+      }
+      for (i = 0; i < 3; i++) {
+        coordinates[3 * num_points + i] = len * corner_coords[i];
+      }
+    }
+  }
+  T8_ASSERT (num_points ==
+             (size_t) t8_forest_get_tree_num_corners (forest, ltreeid));
+  /* Map all points to the tree geometry at once */
+  t8_forest_tree_points_to_physical (forest, ltreeid, num_points,
+                                     coordinates);
+}
+
+/* Compute the coordinates in the reference space of the tree of the nodes
+ * of an element, given by their reference coordinates in the element. */
+static void
+t8_forest_element_nodes_in_tree (t8_eclass_scheme_c * ts,
+                                 const t8_element_t * element, int dim,
+                                 size_t num_nodes, const double *ref_nodes,
+                                 double *nodes)
+{
+  t8_forest_tree_map_t element_map;
+  t8_element_shape_t  shape;
+  double              corners[T8_ECLASS_MAX_CORNERS * 3];
+  double              len;
+  int                 corner_coords[3];
+  int                 num_corners, icorner, i;
+
+  /* The map of the element to the tree is the vertex interpolation of its
+   * corners in the reference space of the tree. */
+  shape = ts->t8_element_shape (element);
+  num_corners = ts->t8_element_num_corners (element);
+  len = 1. / ts->t8_element_root_len (element);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    ts->t8_element_vertex_coords (element, icorner, corner_coords);
+    for (i = 0; i < 3; i++) {
+      corners[3 * icorner + i] = i < dim ? len * corner_coords[i] : 0;
+    }
+  }
+  t8_forest_tree_map_init (shape, corners, &element_map);
+  memcpy (nodes, ref_nodes, 3 * num_nodes * sizeof (double));
+  t8_forest_tree_map_apply (&element_map, num_nodes, nodes);
+}
+
+void
+t8_forest_tree_element_nodes (t8_forest_t forest, t8_locidx_t ltreeid,
+                              size_t num_nodes, const double *ref_nodes,
+                              double *nodes)
+{
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  t8_locidx_t         num_elements, ielement;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (num_nodes == 0 || (ref_nodes != NULL && nodes != NULL));
+
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    t8_forest_element_nodes_in_tree (ts,
+                                     t8_forest_get_element_in_tree (forest,
+                                                                    ltreeid,
+                                                                    ielement),
+                                     t8_eclass_to_dimension[tree_class],
+                                     num_nodes, ref_nodes,
+                                     nodes + 3 * num_nodes * ielement);
+  }
+  /* Map the nodes of all elements to physical space at once */
+  t8_forest_tree_points_to_physical (forest, ltreeid,
+                                     num_nodes * num_elements, nodes);
+}
+
+void
+t8_forest_element_nodes (t8_forest_t forest, size_t num_nodes,
+                         const double *ref_nodes, t8_forest_t forest_from,
+                         const double *nodes_from, double *nodes)
+{
+  t8_element_array_t *elements, *elements_from;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_elements, ielement, first_new;
+  t8_locidx_t         num_elements_from, ielement_from, offset, offset_from;
+  const size_t        stride = 3 * num_nodes;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest_from != NULL) {
+    T8_ASSERT (t8_forest_is_committed (forest_from));
+    T8_ASSERT (nodes_from != NULL);
+    /* As for the geometry cache, we can only reuse the nodes if both
+     * forests have the same local trees. */
+    if (forest_from->first_local_tree != forest->first_local_tree
+        || t8_forest_get_num_local_trees (forest_from) != num_local_trees) {
+      forest_from = NULL;
+    }
+  }
+  if (forest_from == NULL) {
+    for (itree = 0; itree < num_local_trees; itree++) {
+      t8_forest_tree_element_nodes (forest, itree, num_nodes, ref_nodes,
+                                    nodes + stride *
+                                    t8_forest_get_tree_element_offset
+                                    (forest, itree));
+    }
+    return;
+  }
+
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    offset = t8_forest_get_tree_element_offset (forest, itree);
+    elements_from = t8_forest_get_tree_element_array (forest_from, itree);
+    num_elements_from = t8_forest_get_tree_num_elements (forest_from, itree);
+    offset_from = t8_forest_get_tree_element_offset (forest_from, itree);
+    ielement_from = 0;
+    /* first_new is the start of the current run of elements that are not
+     * in forest_from. We map each run to physical space at once. */
+    first_new = 0;
+    for (ielement = 0; ielement <= num_elements; ielement++) {
+      int                 reuse = 0;
+
+      if (ielement < num_elements) {
+        element = t8_element_array_index_locidx (elements, ielement);
+        /* Both element arrays are sorted, see
+         * t8_forest_geometry_cache_compute */
+        while (ielement_from < num_elements_from
+               && ts->t8_element_compare (t8_element_array_index_locidx
+                                          (elements_from, ielement_from),
+                                          element) < 0) {
+          ielement_from++;
+        }
+        reuse = ielement_from < num_elements_from
+          && !ts->t8_element_compare (t8_element_array_index_locidx
+                                      (elements_from, ielement_from),
+                                      element);
+        if (!reuse) {
+          t8_forest_element_nodes_in_tree (ts, element,
+                                           t8_eclass_to_dimension
+                                           [tree_class], num_nodes,
+                                           ref_nodes, nodes +
+                                           stride * (offset + ielement));
+          continue;
+        }
+      }
+      if (first_new < ielement) {
+        t8_forest_tree_points_to_physical (forest, itree, num_nodes *
+                                           (ielement - first_new),
+                                           nodes + stride *
+                                           (offset + first_new));
+      }
+      if (reuse) {
+        memcpy (nodes + stride * (offset + ielement),
+                nodes_from + stride * (offset_from + ielement_from),
+                stride * sizeof (double));
+      }
+      first_new = ielement + 1;
+    }
+  }
+}
+
 /* Compute the diameter of an element. */
 double
 t8_forest_element_diam (t8_forest_t forest, t8_locidx_t ltreeid,
@@ -634,6 +1214,32 @@ t8_forest_element_volume (t8_forest_t forest, t8_locidx_t ltreeid,
                                     coordinates[3]);
       volume += t8_forest_element_tet_volume (coordinates);
 
+      return volume;
+    }
+  case T8_ECLASS_PYRAMID:
+    {
+      /* We divide the pyramid into 2 tetrahedra and compute their
+       * volumes. */
+      double              coordinates[4][3], volume;
+
+      /* The first tetrahedron has pyramid vertices 0, 1, 3, and 4 */
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 0,
+                                    coordinates[0]);
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 1,
+                                    coordinates[1]);
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 3,
+                                    coordinates[2]);
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 4,
+                                    coordinates[3]);
+      volume = t8_forest_element_tet_volume (coordinates);
+
+      /* The second tetrahedron has pyramid vertices 0, 3, 2, and 4 */
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 3,
+                                    coordinates[1]);
+      t8_forest_element_coordinate (forest, ltreeid, element, vertices, 2,
+                                    coordinates[2]);
+      volume += t8_forest_element_tet_volume (coordinates);
+
       return volume;
     }
   default:
@@ -642,20 +1248,230 @@ t8_forest_element_volume (t8_forest_t forest, t8_locidx_t ltreeid,
   return -1;                    /* default return prevents compiler warning */
 }
 
-/* Compute the area of an element's face */
-double
-t8_forest_element_face_area (t8_forest_t forest, t8_locidx_t ltreeid,
-                             const t8_element_t * element, int face,
-                             const double *vertices)
+/* Compute the coordinates of the corner with number corner of each element
+ * of a local tree and store them as the vectors of corner_coords. */
+static void
+t8_forest_tree_element_corner_soa (t8_forest_t forest, t8_locidx_t ltreeid,
+                                   const double *vertices, int corner,
+                                   t8_vec_soa_t * corner_coords)
+{
+  const t8_element_t *element;
+  t8_locidx_t         num_elements, ielement;
+  double              coordinates[3];
+
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+    t8_forest_element_coordinate (forest, ltreeid, element, vertices,
+                                  corner, coordinates);
+    corner_coords->x[ielement] = coordinates[0];
+    corner_coords->y[ielement] = coordinates[1];
+    corner_coords->z[ielement] = coordinates[2];
+  }
+}
+
+/* Let vec point to three arrays of n doubles starting at memory. */
+static void
+t8_forest_vec_soa_init (t8_vec_soa_t * vec, double *memory, size_t n)
 {
+  vec->x = memory;
+  vec->y = memory + n;
+  vec->z = memory + 2 * n;
+}
 
+void
+t8_forest_tree_element_centroids (t8_forest_t forest, t8_locidx_t ltreeid,
+                                  double *centroids)
+{
   t8_eclass_t         tree_class;
-  t8_element_shape_t  face_shape;
-  t8_eclass_scheme_c *ts;
+  t8_locidx_t         num_elements, ielement;
+  const double       *vertices;
+  t8_vec_soa_t        sum, corner_coords;
+  double             *memory;
+  int                 num_corners, icorner;
 
   T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
 
-  /* get the eclass of the forest */
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  vertices = t8_forest_get_tree_vertices (forest, ltreeid);
+  if (tree_class == T8_ECLASS_PYRAMID) {
+    /* The elements of a pyramid tree have different numbers of corners */
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      t8_forest_element_centroid (forest, ltreeid,
+                                  t8_forest_get_element_in_tree (forest,
+                                                                 ltreeid,
+                                                                 ielement),
+                                  vertices, centroids + 3 * ielement);
+    }
+    return;
+  }
+  if (num_elements == 0) {
+    return;
+  }
+
+  /* We compute the same sums as t8_forest_element_centroid */
+  memory = T8_ALLOC_ZERO (double, 6 * num_elements);
+  t8_forest_vec_soa_init (&sum, memory, num_elements);
+  t8_forest_vec_soa_init (&corner_coords, memory + 3 * num_elements,
+                          num_elements);
+  num_corners = t8_eclass_num_vertices[tree_class];
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    t8_forest_tree_element_corner_soa (forest, ltreeid, vertices, icorner,
+                                       &corner_coords);
+    /* sum = sum + corner_coords */
+    t8_vec_soa_axpy (&corner_coords, &sum, num_elements, 1);
+  }
+  t8_vec_soa_ax (&sum, num_elements, 1. / num_corners);
+  t8_vec_soa_scatter (&sum, num_elements, 3, centroids);
+  T8_FREE (memory);
+}
+
+void
+t8_forest_tree_element_volumes (t8_forest_t forest, t8_locidx_t ltreeid,
+                                double *volumes)
+{
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         num_elements, ielement;
+  const t8_element_t *element;
+  const double       *vertices;
+  t8_vec_soa_t        coords[4], cross;
+  double             *memory, *dots[3];
+  int                 corners[4], num_corners, icorner;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  vertices = t8_forest_get_tree_vertices (forest, ltreeid);
+  if (num_elements == 0) {
+    return;
+  }
+
+  /* Select the corners that t8_forest_element_volume uses */
+  switch (tree_class) {
+  case T8_ECLASS_QUAD:
+    {
+      int                 face_a, face_b;
+
+      /* Quads have no types, thus the corners are the same for all elements */
+      ts = t8_forest_get_eclass_scheme (forest, T8_ECLASS_QUAD);
+      element = t8_forest_get_element_in_tree (forest, ltreeid, 0);
+      face_a = ts->t8_element_get_corner_face (element, 0, 0);
+      face_b = ts->t8_element_get_corner_face (element, 0, 1);
+      corners[0] = 0;
+      corners[1] = ts->t8_element_get_face_corner (element, face_a, 1);
+      corners[2] = ts->t8_element_get_face_corner (element, face_b, 1);
+      num_corners = 3;
+    }
+    break;
+  case T8_ECLASS_TRIANGLE:
+    corners[0] = 0;
+    corners[1] = 1;
+    corners[2] = 2;
+    num_corners = 3;
+    break;
+  case T8_ECLASS_TET:
+  case T8_ECLASS_HEX:
+    corners[0] = 0;
+    corners[1] = 1;
+    corners[2] = 2;
+    corners[3] = tree_class == T8_ECLASS_TET ? 3 : 4;
+    num_corners = 4;
+    break;
+  default:
+    /* Vertices, lines, prisms and pyramids are computed element by element */
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+      volumes[ielement] =
+        t8_forest_element_volume (forest, ltreeid, element, vertices);
+    }
+    return;
+  }
+
+  memory = T8_ALLOC (double, 3 * (num_corners + 2) * num_elements);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    t8_forest_vec_soa_init (&coords[icorner],
+                            memory + 3 * icorner * num_elements,
+                            num_elements);
+    t8_forest_tree_element_corner_soa (forest, ltreeid, vertices,
+                                       corners[icorner], &coords[icorner]);
+  }
+  t8_forest_vec_soa_init (&cross, memory + 3 * num_corners * num_elements,
+                          num_elements);
+  for (icorner = 0; icorner < 3; icorner++) {
+    dots[icorner] = memory + (3 * num_corners + 3 + icorner) * num_elements;
+  }
+
+  /* The same operations as in t8_forest_element_volume, applied to all
+   * elements at once */
+  switch (tree_class) {
+  case T8_ECLASS_QUAD:
+  case T8_ECLASS_TRIANGLE:
+    /* v_1 = v_1 - v_0 and v_2 = v_2 - v_0 */
+    t8_vec_soa_axpy (&coords[0], &coords[1], num_elements, -1);
+    t8_vec_soa_axpy (&coords[0], &coords[2], num_elements, -1);
+    t8_vec_soa_dot (&coords[1], &coords[1], num_elements, dots[0]);
+    t8_vec_soa_dot (&coords[1], &coords[2], num_elements, dots[1]);
+    t8_vec_soa_dot (&coords[2], &coords[2], num_elements, dots[2]);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      volumes[ielement] =
+        0.5 * sqrt (fabs (dots[0][ielement] * dots[2][ielement]
+                          - dots[1][ielement] * dots[1][ielement]));
+    }
+    if (tree_class == T8_ECLASS_QUAD) {
+      for (ielement = 0; ielement < num_elements; ielement++) {
+        volumes[ielement] *= 2;
+      }
+    }
+    break;
+  case T8_ECLASS_TET:
+    /* V = |(a-d)*((b-d) x (c-d))|/6 */
+    for (icorner = 0; icorner < 3; icorner++) {
+      t8_vec_soa_axpy (&coords[3], &coords[icorner], num_elements, -1);
+    }
+    t8_vec_soa_cross (&coords[1], &coords[2], num_elements, &cross);
+    t8_vec_soa_dot (&coords[0], &cross, num_elements, volumes);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      volumes[ielement] = fabs (volumes[ielement]) / 6;
+    }
+    break;
+  case T8_ECLASS_HEX:
+    /* The determinant of the vectors from corner 0 to 1, to 2 and to 4 */
+    for (icorner = 1; icorner < 4; icorner++) {
+      t8_vec_soa_axpy (&coords[0], &coords[icorner], num_elements, -1);
+    }
+    t8_vec_soa_cross (&coords[2], &coords[3], num_elements, &cross);
+    t8_vec_soa_dot (&coords[1], &cross, num_elements, volumes);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      volumes[ielement] = fabs (volumes[ielement]);
+    }
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  T8_FREE (memory);
+}
+
+/* Compute the area of an element's face */
+double
+t8_forest_element_face_area (t8_forest_t forest, t8_locidx_t ltreeid,
+                             const t8_element_t * element, int face,
+                             const double *vertices)
+{
+
+  t8_eclass_t         tree_class;
+  t8_element_shape_t  face_shape;
+  t8_eclass_scheme_c *ts;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  /* get the eclass of the forest */
   tree_class = t8_forest_get_tree_class (forest, ltreeid);
   /* get the element's scheme and the face scheme */
   ts = t8_forest_get_eclass_scheme (forest, tree_class);
@@ -986,11 +1802,344 @@ t8_forest_element_face_normal (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
-int
-t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
+/* Compute the axis-aligned bounding box of a set of points.
+ * bbox[0..2] is the lower and bbox[3..5] the upper corner. */
+static void
+t8_forest_bounding_box_of_points (const double *points, int num_points,
+                                  double bbox[6])
+{
+  int                 ipoint, i;
+
+  T8_ASSERT (num_points > 0);
+  for (i = 0; i < 3; i++) {
+    bbox[i] = bbox[3 + i] = points[i];
+  }
+  for (ipoint = 1; ipoint < num_points; ipoint++) {
+    for (i = 0; i < 3; i++) {
+      bbox[i] = SC_MIN (bbox[i], points[3 * ipoint + i]);
+      bbox[3 + i] = SC_MAX (bbox[3 + i], points[3 * ipoint + i]);
+    }
+  }
+}
+
+/* Return true if a point lies in a bounding box enlarged by tolerance */
+static inline int
+t8_forest_bounding_box_contains (const double bbox[6], const double point[3],
+                                 const double tolerance)
+{
+  return bbox[0] - tolerance <= point[0] && point[0] <= bbox[3] + tolerance
+    && bbox[1] - tolerance <= point[1] && point[1] <= bbox[4] + tolerance
+    && bbox[2] - tolerance <= point[2] && point[2] <= bbox[5] + tolerance;
+}
+
+void
+t8_forest_element_bounding_box (t8_forest_t forest, t8_locidx_t ltreeid,
                                 const t8_element_t * element,
-                                const double *tree_vertices,
-                                const double point[3], const double tolerance)
+                                const double *tree_vertices, double bbox[6])
+{
+  t8_eclass_scheme_c *ts;
+  double              coordinates[T8_ECLASS_MAX_CORNERS][3];
+  int                 num_corners, icorner;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  num_corners = ts->t8_element_num_corners (element);
+  T8_ASSERT (0 < num_corners && num_corners <= T8_ECLASS_MAX_CORNERS);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    t8_forest_element_coordinate (forest, ltreeid, element, tree_vertices,
+                                  icorner, coordinates[icorner]);
+  }
+  t8_forest_bounding_box_of_points ((const double *) coordinates,
+                                    num_corners, bbox);
+}
+
+/* Compute the bounding boxes of all local trees. The tree geometry is a
+ * convex combination of the tree vertices, hence their bounding box
+ * contains the tree. */
+static double      *
+t8_forest_tree_bounding_boxes_compute (t8_forest_t forest)
+{
+  t8_locidx_t         num_local_trees, itree;
+  t8_eclass_t         tree_class;
+  double             *boxes;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  boxes = T8_ALLOC (double, 6 * num_local_trees);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    t8_forest_bounding_box_of_points (t8_forest_get_tree_vertices
+                                      (forest, itree),
+                                      t8_eclass_num_vertices[tree_class],
+                                      boxes + 6 * itree);
+  }
+  return boxes;
+}
+
+/* Allocate the bounding boxes of all leaf elements. Without OpenMP the
+ * boxes are marked as not computed and computed on their first use.
+ * With OpenMP all boxes are computed here, since a box that is computed
+ * by one thread could be read by another one while it is written. */
+static double      *
+t8_forest_leaf_bounding_boxes_compute (t8_forest_t forest)
+{
+  t8_locidx_t         num_elements, ielement;
+  double             *boxes;
+#ifdef T8_ENABLE_OPENMP
+  t8_locidx_t         num_local_trees, itree, ielem, num_tree_elements;
+  const double       *tree_vertices;
+#endif
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  boxes = T8_ALLOC (double, 6 * num_elements);
+#ifdef T8_ENABLE_OPENMP
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, ielement = 0; itree < num_local_trees; itree++) {
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_tree_elements; ielem++, ielement++) {
+      t8_forest_element_bounding_box (forest, itree,
+                                      t8_forest_get_element_in_tree (forest,
+                                                                     itree,
+                                                                     ielem),
+                                      tree_vertices, boxes + 6 * ielement);
+    }
+  }
+#else
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    boxes[6 * ielement] = 1;
+    boxes[6 * ielement + 3] = 0;
+  }
+#endif
+  return boxes;
+}
+
+/* Return the bounding boxes stored in *pboxes. If they do not exist yet,
+ * they are created with compute. With OpenMP the first thread that needs
+ * the boxes creates them while the other threads wait for them. */
+static const double *
+t8_forest_bounding_boxes_get (t8_forest_t forest, double **pboxes,
+                              double *(*compute) (t8_forest_t forest))
+{
+  double             *boxes;
+
+#ifdef T8_ENABLE_OPENMP
+#pragma omp atomic read
+  boxes = *pboxes;
+#pragma omp flush
+  if (boxes == NULL) {
+#pragma omp critical (t8_forest_bounding_boxes)
+    {
+      boxes = *pboxes;
+      if (boxes == NULL) {
+        boxes = compute (forest);
+        /* Publish the boxes only after they are written */
+#pragma omp flush
+#pragma omp atomic write
+        *pboxes = boxes;
+      }
+    }
+  }
+#else
+  boxes = *pboxes;
+  if (boxes == NULL) {
+    boxes = *pboxes = compute (forest);
+  }
+#endif
+  return boxes;
+}
+
+const double       *
+t8_forest_tree_bounding_box (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+
+  return t8_forest_bounding_boxes_get (forest, &forest->tree_bounding_boxes,
+                                       t8_forest_tree_bounding_boxes_compute)
+    + 6 * ltreeid;
+}
+
+const double       *
+t8_forest_leaf_bounding_box (t8_forest_t forest, t8_locidx_t ltreeid,
+                             t8_locidx_t leid_in_tree)
+{
+  const double       *bbox;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (0 <= leid_in_tree
+             && leid_in_tree < t8_forest_get_tree_num_elements (forest,
+                                                                ltreeid));
+
+  bbox = t8_forest_bounding_boxes_get (forest, &forest->leaf_bounding_boxes,
+                                       t8_forest_leaf_bounding_boxes_compute)
+    + 6 * (t8_forest_get_tree_element_offset (forest, ltreeid) +
+           leid_in_tree);
+#ifndef T8_ENABLE_OPENMP
+  if (bbox[0] > bbox[3]) {
+    /* This box was not computed yet */
+    t8_forest_element_bounding_box (forest, ltreeid,
+                                    t8_forest_get_element_in_tree (forest,
+                                                                   ltreeid,
+                                                                   leid_in_tree),
+                                    t8_forest_get_tree_vertices (forest,
+                                                                 ltreeid),
+                                    (double *) bbox);
+  }
+#endif
+  return bbox;
+}
+
+/* Compute the memory usage of a forest that may not be committed yet.
+ * The first and last descendants of the trees only exist after commit. */
+static void
+t8_forest_memory_usage_compute (t8_forest_t forest,
+                                t8_forest_memory_usage_t * usage)
+{
+  t8_tree_t           tree;
+  t8_forest_geometry_cache_t cache;
+  t8_forest_face_connectivity_t conn;
+  t8_forest_search_index_t index;
+  t8_forest_bvh_t     bvh;
+  t8_locidx_t         num_faces;
+  size_t              itree, iregion, num_trees, hash_bytes;
+
+  T8_ASSERT (forest != NULL);
+  memset (usage, 0, sizeof (t8_forest_memory_usage_t));
+
+  usage->forest = sizeof (t8_forest_struct_t);
+  num_trees = forest->trees != NULL ? forest->trees->elem_count : 0;
+  if (forest->trees != NULL) {
+    usage->forest += sc_array_memory_used (forest->trees, 1);
+  }
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = (t8_tree_t) sc_array_index (forest->trees, itree);
+    usage->leaves += sc_array_memory_used (&tree->elements.array, 0)
+      + tree->num_packed_elements * sizeof (t8_linearidx_t);
+    if (forest->committed) {
+      usage->forest += 2 * forest->scheme_cxx->eclass_schemes[tree->eclass]
+        ->t8_element_size ();
+    }
+  }
+  /* The element arrays may be views into the contiguous leaves */
+  usage->leaves += forest->leaf_storage_bytes;
+  if (forest->mmap_regions != NULL) {
+    /* The element arrays are views into these mappings */
+    usage->forest += sc_array_memory_used (forest->mmap_regions, 1);
+    for (iregion = 0; iregion < forest->mmap_regions->elem_count; iregion++) {
+      usage->leaves += ((t8_forest_mmap_region_t *)
+                        sc_array_index (forest->mmap_regions,
+                                        iregion))->length;
+    }
+  }
+
+  if (forest->ghosts != NULL) {
+    usage->ghosts = t8_forest_ghost_memory_usage (forest->ghosts,
+                                                  &hash_bytes);
+    usage->hash_tables = hash_bytes;
+  }
+
+  if (forest->element_offsets != NULL) {
+    usage->offsets += t8_shmem_array_get_elem_count (forest->element_offsets)
+      * t8_shmem_array_get_elem_size (forest->element_offsets);
+  }
+  if (forest->global_first_desc != NULL) {
+    usage->offsets +=
+      t8_shmem_array_get_elem_count (forest->global_first_desc)
+      * t8_shmem_array_get_elem_size (forest->global_first_desc);
+  }
+  if (forest->tree_offsets != NULL) {
+    usage->offsets += t8_shmem_array_get_elem_count (forest->tree_offsets)
+      * t8_shmem_array_get_elem_size (forest->tree_offsets);
+  }
+
+  if ((cache = forest->geometry_cache) != NULL) {
+    num_faces = cache->face_offsets[cache->num_elements];
+    usage->caches += sizeof (t8_forest_geometry_cache_struct_t)
+      + cache->num_elements * 4 * sizeof (double)
+      + (cache->num_elements + 1) * sizeof (t8_locidx_t)
+      + num_faces * 7 * sizeof (double);
+  }
+  if ((conn = forest->face_connectivity) != NULL) {
+    num_faces = conn->face_offsets[conn->num_elements];
+    usage->caches += sizeof (t8_forest_face_connectivity_struct_t)
+      + (conn->num_elements + 1) * sizeof (t8_locidx_t)
+      + (num_faces + 1) * sizeof (t8_locidx_t)
+      + num_faces * sizeof (int)
+      + conn->neighbor_offsets[num_faces]
+      * (sizeof (t8_locidx_t) + sizeof (int));
+  }
+  if ((index = forest->search_index) != NULL) {
+    usage->caches += sizeof (t8_forest_search_index_struct_t)
+      + (index->num_local_trees + 1) * sizeof (size_t)
+      + (index->num_nodes + 1) * sizeof (size_t)
+      + (2 * index->node_offsets[index->num_nodes] + index->num_nodes)
+      * sizeof (size_t);
+  }
+  if ((bvh = forest->bvh) != NULL) {
+    usage->caches += sizeof (t8_forest_bvh_struct_t)
+      + 6 * (bvh->num_elements + bvh->num_nodes) * sizeof (double)
+      + 3 * bvh->num_nodes * sizeof (t8_locidx_t);
+  }
+  if (forest->tree_bounding_boxes != NULL) {
+    usage->caches += 6 * num_trees * sizeof (double);
+  }
+  if (forest->leaf_bounding_boxes != NULL) {
+    usage->caches += 6 * forest->local_num_elements * sizeof (double);
+  }
+  if (forest->adapt_runs != NULL) {
+    usage->caches += sc_array_memory_used (forest->adapt_runs, 1);
+  }
+
+  if (forest->profile != NULL) {
+    usage->profile = sizeof (t8_profile_struct_t);
+  }
+  usage->total = usage->forest + usage->leaves + usage->ghosts
+    + usage->hash_tables + usage->offsets + usage->caches + usage->profile;
+}
+
+void
+t8_forest_memory_usage (t8_forest_t forest, t8_forest_memory_usage_t * usage)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (usage != NULL);
+
+  t8_forest_memory_usage_compute (forest, usage);
+}
+
+void
+t8_forest_profile_record_memory (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_memory_usage_t usage;
+  size_t              bytes;
+
+  T8_ASSERT (forest != NULL);
+  if (forest->profile == NULL) {
+    /* Profiling is not enabled */
+    return;
+  }
+  t8_forest_memory_usage_compute (forest, &usage);
+  bytes = usage.total;
+  if (forest_from != NULL && forest_from != forest) {
+    t8_forest_memory_usage_compute (forest_from, &usage);
+    bytes += usage.total;
+  }
+  forest->profile->memory_high_water =
+    SC_MAX (forest->profile->memory_high_water, bytes);
+}
+
+/* The exact point inside test, without bounding box rejection */
+static int
+t8_forest_element_point_inside_exact (t8_forest_t forest,
+                                      t8_locidx_t ltreeid,
+                                      const t8_element_t * element,
+                                      const double *tree_vertices,
+                                      const double point[3],
+                                      const double tolerance)
 {
   const t8_eclass_t   tree_class = t8_forest_get_tree_class (forest, ltreeid);
   t8_eclass_scheme_c *ts = t8_forest_get_eclass_scheme (forest, tree_class);
@@ -1198,6 +2347,108 @@ t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
+int
+t8_forest_element_point_inside (t8_forest_t forest, t8_locidx_t ltreeid,
+                                const t8_element_t * element,
+                                const double *tree_vertices,
+                                const double point[3], const double tolerance)
+{
+  double              bbox[6];
+
+  /* Reject points that are not in the bounding box of the tree
+   * or of the element */
+  if (ltreeid < t8_forest_get_num_local_trees (forest)
+      && !t8_forest_bounding_box_contains (t8_forest_tree_bounding_box
+                                           (forest, ltreeid), point,
+                                           tolerance)) {
+    return 0;
+  }
+  t8_forest_element_bounding_box (forest, ltreeid, element, tree_vertices,
+                                  bbox);
+  if (!t8_forest_bounding_box_contains (bbox, point, tolerance)) {
+    return 0;
+  }
+  return t8_forest_element_point_inside_exact (forest, ltreeid, element,
+                                               tree_vertices, point,
+                                               tolerance);
+}
+
+void
+t8_forest_element_points_inside (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 const t8_element_t * element,
+                                 const double *tree_vertices,
+                                 const double *points, int num_points,
+                                 int *is_inside, const double tolerance)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_shape_t  element_shape;
+  double              bbox[6];
+  double              face_normals[T8_ECLASS_MAX_FACES][3];
+  double              face_points[T8_ECLASS_MAX_FACES][3];
+  double              diff[3];
+  int                 ipoint, iface, num_faces, num_candidates;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_points >= 0);
+  if (num_points == 0) {
+    return;
+  }
+
+  /* Reject all points that are not in the bounding box of the element */
+  t8_forest_element_bounding_box (forest, ltreeid, element, tree_vertices,
+                                  bbox);
+  for (ipoint = 0, num_candidates = 0; ipoint < num_points; ipoint++) {
+    is_inside[ipoint] =
+      t8_forest_bounding_box_contains (bbox, points + 3 * ipoint, tolerance);
+    num_candidates += is_inside[ipoint];
+  }
+  if (num_candidates == 0) {
+    return;
+  }
+
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  element_shape = ts->t8_element_shape (element);
+  if (t8_eclass_to_dimension[element_shape] < 3) {
+    /* Test the remaining points one by one */
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      if (is_inside[ipoint]) {
+        is_inside[ipoint] =
+          t8_forest_element_point_inside_exact (forest, ltreeid, element,
+                                                tree_vertices,
+                                                points + 3 * ipoint,
+                                                tolerance);
+      }
+    }
+    return;
+  }
+
+  /* For volume elements we compute the face normals and a point on
+   * each face only once for all points, see
+   * t8_forest_element_point_inside_exact */
+  num_faces = ts->t8_element_num_faces (element);
+  T8_ASSERT (num_faces <= T8_ECLASS_MAX_FACES);
+  for (iface = 0; iface < num_faces; iface++) {
+    t8_forest_element_face_normal (forest, ltreeid, element, iface,
+                                   tree_vertices, face_normals[iface]);
+    t8_forest_element_coordinate (forest, ltreeid, element, tree_vertices,
+                                  ts->t8_element_get_face_corner (element,
+                                                                  iface, 0),
+                                  face_points[iface]);
+  }
+  for (ipoint = 0; ipoint < num_points; ipoint++) {
+    for (iface = 0; iface < num_faces && is_inside[ipoint]; iface++) {
+      /* diff = x - p for the point x on the face */
+      t8_vec_axpyz (points + 3 * ipoint, face_points[iface], diff, -1);
+      if (t8_vec_dot (diff, face_normals[iface]) < 0) {
+        /* The point is outside of the element */
+        is_inside[ipoint] = 0;
+      }
+    }
+  }
+}
+
 /* For each tree in a forest compute its first and last descendant */
 void
 t8_forest_compute_desc (t8_forest_t forest)
@@ -1234,6 +2485,41 @@ t8_forest_compute_desc (t8_forest_t forest)
   }
 }
 
+/* The number of elements that are constructed in one piece when
+ * populating a tree. */
+#define T8_FOREST_POPULATE_CHUNK_SIZE 4096
+
+/* Construct the elements of an allocated, uninitialized element array as
+ * consecutive elements of a uniform refinement, starting at linear id
+ * \a start. The elements are initialized and constructed in chunks, such
+ * that with OpenMP each chunk is first touched by the thread that fills it.
+ * With OpenMP \a num_threads threads are used. */
+static void
+t8_forest_populate_tree (t8_element_array_t * telements, int level,
+                         t8_gloidx_t start, int num_threads)
+{
+  t8_eclass_scheme_c *ts = telements->scheme;
+  t8_locidx_t         num_elements, num_chunks, ichunk;
+
+  num_elements = (t8_locidx_t) t8_element_array_get_count (telements);
+  T8_ASSERT (num_elements > 0);
+  num_chunks = (num_elements + T8_FOREST_POPULATE_CHUNK_SIZE - 1)
+    / T8_FOREST_POPULATE_CHUNK_SIZE;
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+#endif
+  for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+    t8_locidx_t         first = ichunk * T8_FOREST_POPULATE_CHUNK_SIZE;
+    t8_locidx_t         count =
+      SC_MIN (T8_FOREST_POPULATE_CHUNK_SIZE, num_elements - first);
+    t8_element_t       *elems =
+      t8_element_array_index_locidx (telements, first);
+
+    ts->t8_element_init (count, elems, 0);
+    ts->t8_element_batch_set_linear_id (elems, count, level, start + first);
+  }
+}
+
 /* Create the elements on this process given a uniform partition
  * of the coarse mesh. */
 void
@@ -1245,9 +2531,8 @@ t8_forest_populate (t8_forest_t forest)
   t8_locidx_t         num_tree_elements;
   t8_locidx_t         num_local_trees;
   t8_gloidx_t         jt, first_ctree;
-  t8_gloidx_t         start, end, et;
+  t8_gloidx_t         start, end;
   t8_tree_t           tree;
-  t8_element_t       *element, *element_succ;
   t8_element_array_t *telements;
   t8_eclass_t         tree_class;
   t8_eclass_scheme_c *eclass_scheme;
@@ -1303,6 +2588,9 @@ t8_forest_populate (t8_forest_t forest)
       tree_class = tree->eclass =
         t8_cmesh_get_tree_class (forest->cmesh, jt - first_ctree);
       tree->elements_offset = count_elements;
+      tree->packed_elements = NULL;
+      tree->num_packed_elements = 0;
+      tree->shared = NULL;
       eclass_scheme = forest->scheme_cxx->eclass_schemes[tree_class];
       T8_ASSERT (eclass_scheme != NULL);
       telements = &tree->elements;
@@ -1312,27 +2600,29 @@ t8_forest_populate (t8_forest_t forest)
         eclass_scheme->t8_element_count_leafs_from_root (forest->set_level);
       num_tree_elements = end - start;
       T8_ASSERT (num_tree_elements > 0);
-      /* Allocate elements for this processor. */
-      t8_element_array_init_size (telements, eclass_scheme,
-                                  num_tree_elements);
-      element = t8_element_array_index_locidx (telements, 0);
-      eclass_scheme->t8_element_set_linear_id (element, forest->set_level,
-                                               start);
-      count_elements++;
-      for (et = start + 1; et < end; et++, count_elements++) {
-        element_succ = t8_element_array_index_locidx (telements, et - start);
-        eclass_scheme->t8_element_successor (element, element_succ,
-                                             forest->set_level);
-        /* TODO: process elements here */
-        element = element_succ;
-      }
+      /* Allocate elements for this processor, they are initialized
+       * when they are constructed. */
+      t8_element_array_init (telements, eclass_scheme);
+      sc_array_resize (&telements->array, num_tree_elements);
+      t8_forest_populate_tree (telements, forest->set_level, start,
+                               t8_forest_get_num_threads (forest));
+      count_elements += num_tree_elements;
     }
   }
   forest->local_num_elements = count_elements;
-  /* TODO: if no tree has pyramid type we can optimize this to
-   * global_num_elements = global_num_trees * 2^(dim*level)
-   */
-  t8_forest_comm_global_num_elements (forest);
+  /* Each tree of the cmesh has all its leaves on set_level, thus we know
+   * the global number of elements without communication */
+  forest->global_num_elements = 0;
+  for (tree_class = T8_ECLASS_ZERO; tree_class < T8_ECLASS_COUNT;
+       tree_class = (t8_eclass_t) (tree_class + 1)) {
+    if (forest->cmesh->num_trees_per_eclass[tree_class] > 0) {
+      eclass_scheme = forest->scheme_cxx->eclass_schemes[tree_class];
+      forest->global_num_elements +=
+        forest->cmesh->num_trees_per_eclass[tree_class] *
+        eclass_scheme->t8_element_count_leafs_from_root (forest->set_level);
+    }
+  }
+  T8_ASSERT (forest->local_num_elements <= forest->global_num_elements);
   /* TODO: figure out global_first_position, global_first_quadrant without comm */
 }
 
@@ -1411,9 +2701,91 @@ t8_forest_last_tree_shared (t8_forest_t forest)
   return t8_forest_tree_shared (forest, 1);
 }
 
+/* Let tree share the elements of fromtree, moving them to shared memory */
+int
+t8_forest_tree_share_elements (t8_tree_t tree, t8_tree_t fromtree)
+{
+  t8_tree_shared_elements_t *shared;
+
+  T8_ASSERT (tree != NULL && fromtree != NULL);
+  T8_ASSERT (fromtree->packed_elements == NULL);
+
+  shared = fromtree->shared;
+  if (shared == NULL) {
+    if (!SC_ARRAY_IS_OWNER (&fromtree->elements.array)) {
+      /* The elements are a view on memory of the forest of fromtree,
+       * for example contiguous leaves or a mapped file */
+      return 0;
+    }
+    /* Move the elements of fromtree to the shared memory */
+    shared = T8_ALLOC (t8_tree_shared_elements_t, 1);
+    t8_refcount_init (&shared->rc);
+    shared->elements = fromtree->elements;
+    t8_element_array_init_view (&fromtree->elements, &shared->elements, 0,
+                                t8_element_array_get_count
+                                (&shared->elements));
+    fromtree->shared = shared;
+  }
+  t8_refcount_ref (&shared->rc);
+  t8_element_array_init_view (&tree->elements, &shared->elements, 0,
+                              t8_element_array_get_count (&shared->elements));
+  tree->shared = shared;
+  return 1;
+}
+
+/* Copy or take over the shared elements of a tree before modifying them */
+void
+t8_forest_tree_unshare_elements (t8_tree_t tree)
+{
+  t8_tree_shared_elements_t *shared;
+
+  T8_ASSERT (tree != NULL);
+
+  shared = tree->shared;
+  if (shared == NULL) {
+    /* The elements belong to this tree */
+    return;
+  }
+  if (t8_refcount_is_last (&shared->rc)) {
+    /* No other tree uses the elements, we take them over */
+    tree->elements = shared->elements;
+    T8_FREE (shared);
+  }
+  else {
+    /* Copy the elements and release them */
+    t8_element_array_init_size (&tree->elements, shared->elements.scheme,
+                                t8_element_array_get_count
+                                (&shared->elements));
+    t8_element_array_copy (&tree->elements, &shared->elements);
+    (void) t8_refcount_unref (&shared->rc);
+  }
+  tree->shared = NULL;
+}
+
+/* Free the elements of a tree or release its reference to shared ones */
+void
+t8_forest_tree_reset_elements (t8_tree_t tree)
+{
+  t8_tree_shared_elements_t *shared;
+
+  T8_ASSERT (tree != NULL);
+
+  shared = tree->shared;
+  t8_element_array_reset (&tree->elements);
+  if (shared != NULL) {
+    if (t8_refcount_unref (&shared->rc)) {
+      /* This was the last tree using the elements */
+      t8_element_array_reset (&shared->elements);
+      T8_FREE (shared);
+    }
+    tree->shared = NULL;
+  }
+}
+
 /* Allocate memory for trees and set their values as in from.
- * For each tree allocate enough element memory to fit the elements of from.
- * If copy_elements is true, copy the elements of from into the element memory.
+ * If copy_elements is true, the trees share the elements of from, see
+ * t8_forest_tree_share_elements, or copy them if they cannot be shared.
+ * Otherwise, the element arrays of the trees are left empty.
  */
 void
 t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
@@ -1436,15 +2808,24 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
     tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees, jt);
     fromtree = (t8_tree_t) t8_sc_array_index_locidx (from->trees, jt);
     tree->eclass = fromtree->eclass;
+    /* The elements of from are not compressed */
+    T8_ASSERT (fromtree->packed_elements == NULL);
+    tree->packed_elements = NULL;
+    tree->num_packed_elements = 0;
+    tree->shared = NULL;
     eclass_scheme = forest->scheme_cxx->eclass_schemes[tree->eclass];
-    num_tree_elements = t8_element_array_get_count (&fromtree->elements);
-    t8_element_array_init_size (&tree->elements, eclass_scheme,
-                                num_tree_elements);
     /* TODO: replace with t8_elem_copy (not existing yet), in order to
      * eventually copy additional pointer data stored in the elements?
      * -> i.m.o. we should not allow such pointer data at the elements */
     if (copy_elements) {
-      t8_element_array_copy (&tree->elements, &fromtree->elements);
+      /* The elements are only copied when one of the trees modifies them */
+      if (!t8_forest_tree_share_elements (tree, fromtree)) {
+        num_tree_elements =
+          t8_element_array_get_count (&fromtree->elements);
+        t8_element_array_init_size (&tree->elements, eclass_scheme,
+                                    num_tree_elements);
+        t8_element_array_copy (&tree->elements, &fromtree->elements);
+      }
       tree->elements_offset = fromtree->elements_offset;
       /* Copy the first and last descendant */
       eclass_scheme->t8_element_new (1, &tree->first_desc);
@@ -1453,11 +2834,16 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
       eclass_scheme->t8_element_copy (fromtree->last_desc, tree->last_desc);
     }
     else {
-      t8_element_array_truncate (&tree->elements);
+      /* The adaptation allocates the element memory itself, the in place
+       * adaptation even takes over the memory of from. */
+      t8_element_array_init (&tree->elements, eclass_scheme);
     }
   }
   forest->first_local_tree = from->first_local_tree;
   forest->last_local_tree = from->last_local_tree;
+  /* The tree hashes are copied with the trees. Without the elements,
+   * the adaptation updates them. */
+  forest->hash_valid = from->hash_valid;
   if (copy_elements) {
     forest->local_num_elements = from->local_num_elements;
     forest->global_num_elements = from->global_num_elements;
@@ -1468,13 +2854,36 @@ t8_forest_copy_trees (t8_forest_t forest, t8_forest_t from, int copy_elements)
   }
 }
 
-/* Search for a linear element id (at forest->maxlevel) in a sorted array of
- * elements. If the element does not exist, return the largest index i
- * such that the element at position i has a smaller id than the given one.
- * If no such i exists, return -1.
- */
+/* Take over the trees and elements of from. */
+void
+t8_forest_move_trees (t8_forest_t forest, t8_forest_t from)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (from != NULL);
+  T8_ASSERT (!forest->committed);
+  T8_ASSERT (from->committed);
+  T8_ASSERT (from->rc.refcount == 1);
+
+  forest->trees = from->trees;
+  /* Leave from without local trees */
+  from->trees = sc_array_new (sizeof (t8_tree_struct_t));
+  forest->first_local_tree = from->first_local_tree;
+  forest->last_local_tree = from->last_local_tree;
+  forest->local_num_elements = from->local_num_elements;
+  forest->global_num_elements = from->global_num_elements;
+  forest->hash_valid = from->hash_valid;
+  /* The element arrays may be views into the contiguous leaves of from */
+  T8_ASSERT (forest->leaf_storage == NULL);
+  forest->leaf_storage = from->leaf_storage;
+  forest->leaf_storage_bytes = from->leaf_storage_bytes;
+  from->leaf_storage = NULL;
+  from->leaf_storage_bytes = 0;
+  from->local_num_elements = 0;
+  from->hash_valid = 0;
+}
+
 /* TODO: should return t8_locidx_t */
-static t8_locidx_t
+t8_locidx_t
 t8_forest_bin_search_lower (t8_element_array_t * elements,
                             t8_linearidx_t element_id, int maxlevel)
 {
@@ -1593,13 +3002,13 @@ t8_forest_element_face_neighbor (t8_forest_t forest,
      * is undefined right now. */
     t8_eclass_scheme_c *boundary_scheme, *neighbor_scheme;
     t8_eclass_t         neigh_eclass, boundary_class;
-    t8_element_t       *face_element;
     t8_cmesh_t          cmesh;
     t8_locidx_t         lctree_id, lcneigh_id;
     t8_locidx_t        *face_neighbor;
     t8_gloidx_t         global_neigh_id;
     t8_cghost_t         ghost;
     int8_t             *ttf;
+    int8_t              face_ttf;
     int                 tree_face, tree_neigh_face;
     int                 is_smaller, eclass_compare;
     int                 F, sign;
@@ -1611,39 +3020,53 @@ t8_forest_element_face_neighbor (t8_forest_t forest,
     tree_face = ts->t8_element_tree_face (elem, face);
     /* compute coarse tree id */
     lctree_id = t8_forest_ltreeid_to_cmesh_ltreeid (forest, ltreeid);
-    if (t8_cmesh_tree_face_is_boundary (cmesh, lctree_id, tree_face)) {
-      /* This face is a domain boundary. We do not need to continue */
-      return -1;
-    }
-    /* Get the eclass scheme for the boundary */
-    boundary_class = (t8_eclass_t) t8_eclass_face_types[eclass][tree_face];
-    boundary_scheme = t8_forest_get_eclass_scheme (forest, boundary_class);
-    /* Allocate the face element */
-    boundary_scheme->t8_element_new (1, &face_element);
-    /* Compute the face element. */
-    ts->t8_element_boundary_face (elem, face, face_element, boundary_scheme);
-    /* Get the coarse tree that contains elem.
-     * Also get the face neighbor information of the coarse tree. */
-    (void) t8_cmesh_trees_get_tree_ext (cmesh->trees,
-                                        lctree_id, &face_neighbor, &ttf);
-    /* Compute the local id of the face neighbor tree. */
-    lcneigh_id = face_neighbor[tree_face];
     /* F is needed to compute the neighbor face number and the orientation.
      * tree_neigh_face = ttf % F
      * or = ttf / F
      */
     F = t8_eclass_max_num_faces[cmesh->dimension];
+    if (cmesh->face_table != NULL) {
+      /* Read the neighbor, its face and its class from the face table */
+      const t8_cmesh_face_entry_t *entry =
+        cmesh->face_table + lctree_id * F + tree_face;
+      if (entry->neighbor < 0) {
+        /* This face is a domain boundary. We do not need to continue */
+        T8_ASSERT (entry->neighbor == -1);
+        return -1;
+      }
+      lcneigh_id = entry->neighbor;
+      face_ttf = entry->ttf;
+      neigh_eclass = (t8_eclass_t) entry->eclass;
+    }
+    else {
+      if (t8_cmesh_tree_face_is_boundary (cmesh, lctree_id, tree_face)) {
+        /* This face is a domain boundary. We do not need to continue */
+        return -1;
+      }
+      /* Get the face neighbor information of the coarse tree. */
+      (void) t8_cmesh_trees_get_tree_ext (cmesh->trees,
+                                          lctree_id, &face_neighbor, &ttf);
+      /* Compute the local id of the face neighbor tree. */
+      lcneigh_id = face_neighbor[tree_face];
+      face_ttf = ttf[tree_face];
+      neigh_eclass = T8_ECLASS_COUNT;
+    }
     /* compute the neighbor face */
-    tree_neigh_face = ttf[tree_face] % F;
+    tree_neigh_face = face_ttf % F;
     if (lcneigh_id == lctree_id && tree_face == tree_neigh_face) {
       /* This face is a domain boundary and there is no neighbor */
       return -1;
     }
+    /* Get the eclass scheme for the boundary */
+    boundary_class = (t8_eclass_t) t8_eclass_face_types[eclass][tree_face];
+    boundary_scheme = t8_forest_get_eclass_scheme (forest, boundary_class);
     /* We now compute the eclass of the neighbor tree. */
     if (lcneigh_id < t8_cmesh_get_num_local_trees (cmesh)) {
       /* The face neighbor is a local tree */
       /* Get the eclass of the neighbor tree */
-      neigh_eclass = t8_cmesh_get_tree_class (cmesh, lcneigh_id);
+      if (neigh_eclass == T8_ECLASS_COUNT) {
+        neigh_eclass = t8_cmesh_get_tree_class (cmesh, lcneigh_id);
+      }
       global_neigh_id = lcneigh_id + t8_cmesh_get_first_treeid (cmesh);
     }
     else {
@@ -1679,20 +3102,17 @@ t8_forest_element_face_neighbor (t8_forest_t forest,
        * the face of the neighbor tree. */
       is_smaller = tree_face <= tree_neigh_face;
     }
-    /* We now transform the face element to the other tree. */
     sign =
       t8_eclass_face_orientation[eclass][tree_face] ==
       t8_eclass_face_orientation[neigh_eclass][tree_neigh_face];
-    boundary_scheme->t8_element_transform_face (face_element,
-                                                face_element,
-                                                ttf[tree_face] / F, sign,
-                                                is_smaller);
-    /* And now we extrude the face to the new neighbor element */
+    /* Compute the face element, transform it to the other tree and
+     * extrude it to the new neighbor element in one call */
     neighbor_scheme = forest->scheme_cxx->eclass_schemes[neigh_eclass];
     *neigh_face =
-      neighbor_scheme->t8_element_extrude_face (face_element,
-                                                boundary_scheme, neigh,
-                                                tree_neigh_face);
+      ts->t8_element_tree_face_neighbor (elem, face, boundary_scheme,
+                                         face_ttf / F, sign, is_smaller,
+                                         neighbor_scheme, neigh,
+                                         tree_neigh_face);
 
     return global_neigh_id;
   }
@@ -1710,7 +3130,8 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
   t8_eclass_scheme_c *ts;
   t8_tree_t           tree;
   t8_eclass_t         eclass;
-  t8_element_t      **children_at_face;
+  t8_element_t       *children_at_face[T8_ECLASS_MAX_CHILDREN];
+  t8_element_scratch_mark_t scratch_mark;
   t8_gloidx_t         neighbor_tree = -1;
 #ifdef T8_ENABLE_DEBUG
   t8_gloidx_t         last_neighbor_tree = -1;
@@ -1730,9 +3151,10 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
   /* The number of children of elem at face */
   T8_ASSERT (num_neighs == ts->t8_element_num_face_children (elem, face));
   num_children_at_face = num_neighs;
-  /* Allocate memory for the children of elem that share a face with face. */
-  children_at_face = T8_ALLOC (t8_element_t *, num_children_at_face);
-  ts->t8_element_new (num_children_at_face, children_at_face);
+  T8_ASSERT (num_children_at_face <= T8_ECLASS_MAX_CHILDREN);
+  /* Get scratch memory for the children of elem that share a face with face. */
+  scratch_mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (ts, num_children_at_face, children_at_face);
 
   /* Construct the children of elem at face
    *
@@ -1768,309 +3190,986 @@ t8_forest_element_half_face_neighbors (t8_forest_t forest,
     last_neighbor_tree = neighbor_tree;
 #endif
   }
-  /* Clean-up the memory */
-  ts->t8_element_destroy (num_children_at_face, children_at_face);
-  T8_FREE (children_at_face);
-  return neighbor_tree;
+  /* Clean-up the memory */
+  t8_element_scratch_release (scratch_mark);
+  return neighbor_tree;
+}
+
+void
+t8_forest_half_neighbors_init (t8_forest_half_neighbors_t * half)
+{
+  T8_ASSERT (half != NULL);
+
+  memset (half, 0, sizeof (*half));
+  sc_array_init (&half->face_offsets, sizeof (t8_locidx_t));
+  sc_array_init (&half->neighbor_trees, sizeof (t8_gloidx_t));
+  sc_array_init (&half->neighbor_classes, sizeof (t8_eclass_t));
+  sc_array_init (&half->neighbor_first, sizeof (t8_locidx_t));
+  sc_array_init (&half->dual_faces, sizeof (int));
+}
+
+void
+t8_forest_half_neighbors_reset (t8_forest_half_neighbors_t * half)
+{
+  int                 eclass;
+
+  T8_ASSERT (half != NULL);
+
+  sc_array_reset (&half->face_offsets);
+  sc_array_reset (&half->neighbor_trees);
+  sc_array_reset (&half->neighbor_classes);
+  sc_array_reset (&half->neighbor_first);
+  sc_array_reset (&half->dual_faces);
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (half->neighbors[eclass].scheme != NULL) {
+      t8_element_array_reset (&half->neighbors[eclass]);
+    }
+  }
+}
+
+void
+t8_forest_tree_half_face_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    t8_locidx_t first, t8_locidx_t last,
+                                    t8_forest_half_neighbors_t * half)
+{
+  t8_tree_t           tree;
+  t8_eclass_t         tree_class, neigh_class;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_array_t *neighbors;
+  const t8_element_t *elem;
+  t8_element_t       *neighs[T8_ECLASS_MAX_CHILDREN];
+  t8_locidx_t         ielem, ientry, num_half, first_neigh;
+  t8_gloidx_t        *neighbor_trees;
+  t8_locidx_t        *face_offsets, *neighbor_first;
+  t8_eclass_t        *neighbor_classes;
+  int                 eclass, iface, num_faces, ineigh, num_neighs;
+  int                 at_maxlevel;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (half != NULL);
+  tree = t8_forest_get_tree (forest, ltreeid);
+  T8_ASSERT (0 <= first && first <= last
+             && last <= t8_forest_get_tree_element_count (tree));
+  tree_class = tree->eclass;
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+
+  half->first_element = first;
+  half->num_elements = last - first;
+  half->max_faces = t8_eclass_num_faces[tree_class];
+  /* Allocate the face entries at once, the half neighbors grow with them */
+  sc_array_resize (&half->face_offsets,
+                   half->num_elements * half->max_faces + 1);
+  sc_array_resize (&half->neighbor_trees,
+                   half->num_elements * half->max_faces);
+  sc_array_resize (&half->neighbor_classes,
+                   half->num_elements * half->max_faces);
+  sc_array_resize (&half->neighbor_first,
+                   half->num_elements * half->max_faces);
+  sc_array_truncate (&half->dual_faces);
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (half->neighbors[eclass].scheme != NULL) {
+      t8_element_array_truncate (&half->neighbors[eclass]);
+    }
+  }
+  face_offsets = (t8_locidx_t *) half->face_offsets.array;
+  neighbor_trees = (t8_gloidx_t *) half->neighbor_trees.array;
+  neighbor_classes = (t8_eclass_t *) half->neighbor_classes.array;
+  neighbor_first = (t8_locidx_t *) half->neighbor_first.array;
+
+  num_half = 0;
+  ientry = 0;
+  for (ielem = first; ielem < last; ielem++) {
+    elem = t8_forest_get_tree_element (tree, ielem);
+    num_faces = ts->t8_element_num_faces (elem);
+    at_maxlevel = ts->t8_element_level (elem) == ts->t8_element_maxlevel ();
+    for (iface = 0; iface < half->max_faces; iface++, ientry++) {
+      face_offsets[ientry] = num_half;
+      neighbor_trees[ientry] = -1;
+      neighbor_classes[ientry] = tree_class;
+      neighbor_first[ientry] = 0;
+      if (iface >= num_faces) {
+        /* The element does not have this face */
+        continue;
+      }
+      neigh_class =
+        t8_forest_element_neighbor_eclass (forest, ltreeid, elem, iface);
+      neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+      neighbors = &half->neighbors[neigh_class];
+      if (neighbors->scheme == NULL) {
+        t8_element_array_init (neighbors, neigh_scheme);
+      }
+      num_neighs = at_maxlevel ? 1 :
+        ts->t8_element_num_face_children (elem, iface);
+      T8_ASSERT (num_neighs <= T8_ECLASS_MAX_CHILDREN);
+      /* Append the half neighbors and their dual faces to the buffers */
+      first_neigh = (t8_locidx_t) t8_element_array_get_count (neighbors);
+      (void) t8_element_array_push_count (neighbors, num_neighs);
+      for (ineigh = 0; ineigh < num_neighs; ineigh++) {
+        neighs[ineigh] =
+          t8_element_array_index_locidx (neighbors, first_neigh + ineigh);
+      }
+      (void) sc_array_push_count (&half->dual_faces, num_neighs);
+      if (at_maxlevel) {
+        /* We cannot refine the element, we construct its neighbor */
+        neighbor_trees[ientry] =
+          t8_forest_element_face_neighbor (forest, ltreeid, elem, neighs[0],
+                                           neigh_scheme, iface, (int *)
+                                           sc_array_index (&half->dual_faces,
+                                                           num_half));
+      }
+      else {
+        neighbor_trees[ientry] =
+          t8_forest_element_half_face_neighbors (forest, ltreeid, elem,
+                                                 neighs, neigh_scheme, iface,
+                                                 num_neighs, (int *)
+                                                 sc_array_index
+                                                 (&half->dual_faces,
+                                                  num_half));
+      }
+      if (neighbor_trees[ientry] < 0) {
+        /* There is no neighbor across this face */
+        t8_element_array_resize (neighbors, first_neigh);
+        sc_array_resize (&half->dual_faces, num_half);
+        continue;
+      }
+      neighbor_classes[ientry] = neigh_class;
+      neighbor_first[ientry] = first_neigh;
+      num_half += num_neighs;
+    }
+  }
+  face_offsets[ientry] = num_half;
+}
+
+int
+t8_forest_half_neighbors_get (t8_forest_half_neighbors_t * half,
+                              t8_locidx_t ielement, int face,
+                              t8_gloidx_t * neighbor_tree,
+                              t8_eclass_t * neigh_class,
+                              t8_element_t * neighs[], int **dual_faces)
+{
+  t8_locidx_t         ientry, first_neigh;
+  t8_eclass_t         eclass;
+  int                 num_neighs, ineigh;
+
+  T8_ASSERT (half != NULL);
+  T8_ASSERT (half->first_element <= ielement
+             && ielement < half->first_element + half->num_elements);
+  T8_ASSERT (0 <= face && face < half->max_faces);
+
+  ientry = (ielement - half->first_element) * half->max_faces + face;
+  num_neighs = *(t8_locidx_t *) sc_array_index (&half->face_offsets,
+                                                ientry + 1)
+    - *(t8_locidx_t *) sc_array_index (&half->face_offsets, ientry);
+  eclass = *(t8_eclass_t *) sc_array_index (&half->neighbor_classes, ientry);
+  if (neighbor_tree != NULL) {
+    *neighbor_tree =
+      *(t8_gloidx_t *) sc_array_index (&half->neighbor_trees, ientry);
+  }
+  if (neigh_class != NULL) {
+    *neigh_class = eclass;
+  }
+  if (neighs != NULL) {
+    first_neigh =
+      *(t8_locidx_t *) sc_array_index (&half->neighbor_first, ientry);
+    for (ineigh = 0; ineigh < num_neighs; ineigh++) {
+      neighs[ineigh] =
+        t8_element_array_index_locidx (&half->neighbors[eclass],
+                                       first_neigh + ineigh);
+    }
+  }
+  if (dual_faces != NULL) {
+    *dual_faces = num_neighs == 0 ? NULL : (int *)
+      sc_array_index (&half->dual_faces, *(t8_locidx_t *)
+                      sc_array_index (&half->face_offsets, ientry));
+  }
+  return num_neighs;
+}
+
+/* Return the number of half face neighbors that are computed for a leaf
+ * in a balanced forest. These are the children of the same level neighbor
+ * at the face, or the neighbor itself if the leaf is at the maximum level. */
+static int
+t8_forest_leaf_face_neighbors_num_half (t8_forest_t forest,
+                                        const t8_element_t * leaf, int face,
+                                        t8_eclass_scheme_c * ts)
+{
+  if (ts->t8_element_level (leaf) == t8_forest_get_maxlevel (forest)) {
+    return 1;
+  }
+  return ts->t8_element_num_face_children (leaf, face);
+}
+
+/* Compute the leaf face neighbors of a leaf in a balanced forest and write
+ * them into caller provided buffers.
+ * \a neighbor_leafs must hold at least as many allocated elements of
+ * \a neigh_scheme as \ref t8_forest_leaf_face_neighbors_num_half returns,
+ * \a dual_faces and \a element_indices must have as many entries.
+ * The elements in \a neighbor_leafs are overwritten.
+ * Returns the number of neighbor leafs, 0 if there is no neighbor. */
+static int
+t8_forest_leaf_face_neighbors_buffered (t8_forest_t forest,
+                                        t8_locidx_t ltreeid,
+                                        const t8_element_t * leaf, int face,
+                                        t8_eclass_t neigh_class,
+                                        t8_eclass_scheme_c * neigh_scheme,
+                                        t8_element_t ** neighbor_leafs,
+                                        int *dual_faces,
+                                        t8_locidx_t * element_indices)
+{
+  t8_eclass_t         eclass;
+  t8_gloidx_t         gneigh_treeid;
+  t8_locidx_t         lneigh_treeid = -1;
+  t8_locidx_t         lghost_treeid = -1, element_index;
+  t8_eclass_scheme_c *ts;
+  t8_element_array_t *element_array;
+  t8_element_t       *ancestor;
+  t8_linearidx_t      neigh_id;
+  int                 num_children_at_face, at_maxlevel;
+  int                 owners[T8_ECLASS_MAX_CHILDREN];
+  int                 ineigh, different_owners, have_ghosts;
+
+  /* In a balanced forest, the leaf neighbor of a leaf is either the neighbor element itself,
+   * its parent or its children at the face. */
+  eclass = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  /* If we are at the maximum refinement level, we compute the neighbor instead */
+  at_maxlevel =
+    ts->t8_element_level (leaf) == t8_forest_get_maxlevel (forest);
+  num_children_at_face =
+    t8_forest_leaf_face_neighbors_num_half (forest, leaf, face, ts);
+  if (at_maxlevel) {
+    /* Compute neighbor element and global treeid of the neighbor */
+    gneigh_treeid =
+      t8_forest_element_face_neighbor (forest, ltreeid, leaf,
+                                       neighbor_leafs[0], neigh_scheme,
+                                       face, dual_faces);
+  }
+  else {
+    /* Compute neighbor elements and global treeid of the neighbor */
+    gneigh_treeid =
+      t8_forest_element_half_face_neighbors (forest, ltreeid, leaf,
+                                             neighbor_leafs,
+                                             neigh_scheme, face,
+                                             num_children_at_face,
+                                             dual_faces);
+  }
+  if (gneigh_treeid < 0) {
+    /* There exists no face neighbor across this face */
+    return 0;
+  }
+  T8_ASSERT (gneigh_treeid >= 0
+             && gneigh_treeid < forest->global_num_trees);
+  /* We have computed the half face neighbor elements, we now compute their owners,
+   * if they differ, we know that the half face neighbors are the neighbor leafs.
+   * If the owners do not differ, we have to check if the neighbor leaf is their
+   * parent or grandparent. */
+  T8_ASSERT (num_children_at_face <= T8_ECLASS_MAX_CHILDREN);
+  different_owners = 0;
+  have_ghosts = 0;
+  for (ineigh = 0; ineigh < num_children_at_face; ineigh++) {
+    /* At first, we check whether the current rank owns the neighbor, since
+     * this is a constant time check and it is the most common case */
+    if (t8_forest_element_check_owner (forest, neighbor_leafs[ineigh],
+                                       gneigh_treeid, neigh_class,
+                                       forest->mpirank, at_maxlevel)) {
+      owners[ineigh] = forest->mpirank;
+      /* The neighbor tree is also a local tree. we store its local treeid */
+      lneigh_treeid = t8_forest_get_local_id (forest, gneigh_treeid);
+    }
+    else {
+      owners[ineigh] =
+        t8_forest_element_find_owner (forest, gneigh_treeid,
+                                      neighbor_leafs[ineigh], neigh_class);
+      /* Store that at least one neighbor is a ghost */
+      have_ghosts = 1;
+    }
+    if (ineigh > 0) {
+      /* Check if all owners are the same for all neighbors or not */
+      different_owners = different_owners
+        || (owners[ineigh] != owners[ineigh - 1]);
+    }
+  }
+  if (have_ghosts) {
+    /* At least one neighbor is a ghost, we compute the ghost treeid of the neighbor
+     * tree. */
+    lghost_treeid =
+      t8_forest_ghost_get_ghost_treeid (forest, gneigh_treeid);
+    T8_ASSERT (lghost_treeid >= 0);
+  }
+  /* TODO: Maybe we do not need to compute the owners. It suffices to know
+   *       whether the neighbor is owned by mpirank or not. */
+
+  if (!different_owners) {
+    /* The face neighbors belong to the same process, we thus need to determine
+     * if they are leafs or their parent or grandparent. */
+    neigh_id =
+      neigh_scheme->t8_element_get_linear_id (neighbor_leafs[0],
+                                              forest->maxlevel);
+    if (owners[0] != forest->mpirank) {
+      /* The elements are ghost elements of the same owner */
+      /* Find the index in the ghost tree of the leaf ancestor of the first neighbor.
+       * This is either the neighbor itself or its parent, or its grandparent.
+       * We search the precomputed linear ids of the ghost tree. */
+      element_index =
+        t8_element_array_soa_search_lower (t8_forest_ghost_get_tree_soa
+                                           (forest, lghost_treeid),
+                                           neigh_id);
+      /* Get the element */
+      ancestor =
+        t8_forest_ghost_get_element (forest, lghost_treeid, element_index);
+      /* Add the number of ghost elements on previous ghost trees and the number
+       * of local elements. */
+      element_index +=
+        t8_forest_ghost_get_tree_element_offset (forest, lghost_treeid);
+      element_index += t8_forest_get_local_num_elements (forest);
+      T8_ASSERT (forest->local_num_elements <= element_index
+                 && element_index <
+                 forest->local_num_elements +
+                 t8_forest_get_num_ghosts (forest));
+    }
+    else {
+      /* the elements are local elements */
+      element_array =
+        t8_forest_get_tree_element_array (forest, lneigh_treeid);
+      /* Find the index in element_array of the leaf ancestor of the first neighbor.
+       * This is either the neighbor itself or its parent, or its grandparent */
+      element_index =
+        t8_forest_bin_search_lower (element_array, neigh_id,
+                                    forest->maxlevel);
+      /* Get the element */
+      ancestor =
+        t8_forest_get_tree_element (t8_forest_get_tree
+                                    (forest, lneigh_treeid), element_index);
+      /* Add the element offset of this tree to the index */
+      element_index +=
+        t8_forest_get_tree_element_offset (forest, lneigh_treeid);
+    }
+    if (neigh_scheme->t8_element_compare (ancestor, neighbor_leafs[0]) < 0) {
+      /* ancestor is a real ancestor, and thus the neighbor is either the
+       * parent or grandparent of the half neighbors. we can return it and
+       * the indices. */
+      /* We need to determine the dual face */
+      if (neigh_scheme->t8_element_level (ancestor) ==
+          ts->t8_element_level (leaf)) {
+        /* The ancestor is the same-level neighbor of leaf */
+        if (!at_maxlevel) {
+          /* its dual face is the face of the parent of the first neighbor leaf */
+          dual_faces[0] =
+            neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
+                                                       dual_faces[0]);
+
+        }
+      }
+      else {
+        /* The ancestor is the parent of the parent */
+        T8_ASSERT (neigh_scheme->t8_element_level (ancestor) ==
+                   ts->t8_element_level (leaf) - 1);
+
+        dual_faces[0] =
+          neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
+                                                     dual_faces[0]);
+        if (!at_maxlevel) {
+          /* We need to compute the dual face of the grandparent. */
+          /* Construct the parent of the grand child */
+          neigh_scheme->t8_element_parent (neighbor_leafs[0],
+                                           neighbor_leafs[0]);
+          /* Compute the face id of the parent's face */
+          dual_faces[0] =
+            neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
+                                                       dual_faces[0]);
+        }
+      }
+
+      /* copy the ancestor */
+      neigh_scheme->t8_element_copy (ancestor, neighbor_leafs[0]);
+      /* set return values */
+      element_indices[0] = element_index;
+      return 1;
+    }
+  }
+  /* The leafs are the face neighbors that we are looking for. */
+  /* The face neighbors either belong to different processes and thus must be leafs
+   * in the forest, or the ancestor leaf of the first half neighbor is the half
+   * neighbor itself and thus all half neighbors must be leafs.
+   * Since the forest is balanced, we found all neighbor leafs.
+   * It remains to compute their local ids */
+  for (ineigh = 0; ineigh < num_children_at_face; ineigh++) {
+    /* Compute the linear id at maxlevel of the neighbor leaf */
+    neigh_id =
+      neigh_scheme->t8_element_get_linear_id (neighbor_leafs[ineigh],
+                                              forest->maxlevel);
+    /* Get a pointer to the element array in which the neighbor lies and search
+     * for the element's index in this array.
+     * This is either the local leaf array of the local tree or the corresponding leaf array
+     * in the ghost structure */
+    if (owners[ineigh] == forest->mpirank) {
+      /* The neighbor is a local leaf */
+      element_array =
+        t8_forest_get_tree_element_array (forest, lneigh_treeid);
+      /* Find the index of the neighbor in the array */
+      element_indices[ineigh] =
+        t8_forest_bin_search_lower (element_array, neigh_id,
+                                    forest->maxlevel);
+      T8_ASSERT (element_indices[ineigh] >= 0);
+      /* We have to add the tree's element offset to the index found to get
+       * the actual local element id */
+      element_indices[ineigh] +=
+        t8_forest_get_tree_element_offset (forest, lneigh_treeid);
+#if T8_ENABLE_DEBUG
+      /* We check whether the element is really the element at this local id */
+      {
+        t8_locidx_t         check_ltreeid;
+        t8_element_t       *check_element;
+        check_element =
+          t8_forest_get_element (forest, element_indices[ineigh],
+                                 &check_ltreeid);
+        T8_ASSERT (check_ltreeid == lneigh_treeid);
+        T8_ASSERT (!neigh_scheme->t8_element_compare (check_element,
+                                                      neighbor_leafs
+                                                      [ineigh]));
+      }
+#endif
+    }
+    else {
+      /* The neighbor is a ghost */
+      /* Find the index of the neighbor in the ghost tree */
+      element_indices[ineigh] =
+        t8_element_array_soa_search_lower (t8_forest_ghost_get_tree_soa
+                                           (forest, lghost_treeid),
+                                           neigh_id);
+
+#if T8_ENABLE_DEBUG
+      /* We check whether the element is really the element at this local id */
+      {
+        t8_element_t       *check_element;
+        check_element =
+          t8_forest_ghost_get_element (forest, lghost_treeid,
+                                       element_indices[ineigh]);
+        T8_ASSERT (!neigh_scheme->t8_element_compare (check_element,
+                                                      neighbor_leafs
+                                                      [ineigh]));
+      }
+#endif
+      /* Add the element offset of previous ghosts to this index */
+      element_indices[ineigh] +=
+        t8_forest_ghost_get_tree_element_offset (forest, lghost_treeid);
+      /* Add the number of all local elements to this index */
+      element_indices[ineigh] += t8_forest_get_local_num_elements (forest);
+    }
+  }                           /* End for loop over neighbor leafs */
+  return num_children_at_face;
+}
+
+/* Given an element and a sorted array of leaves that are descendants of it,
+ * push the indices of the leaves that touch the face face of element
+ * to indices. The index of the first leaf in leaves is first_index.
+ * If dual_faces is not NULL, the face of each leaf at the face of element
+ * is pushed to it. If leafs is not NULL, pointers to the leaves are pushed.
+ * This is the same recursion as in t8_forest_iterate_faces, but it also
+ * works for the elements of ghost trees. */
+static void
+t8_forest_face_leaves_recursion (t8_eclass_scheme_c * ts,
+                                 const t8_element_t * element, int face,
+                                 t8_element_array_t * leaves,
+                                 t8_locidx_t first_index,
+                                 sc_array_t * indices,
+                                 sc_array_t * dual_faces, sc_array_t * leafs)
+{
+  t8_element_t      **face_children;
+  t8_element_array_t  face_child_leaves;
+  int                 num_face_children, iface, child_face;
+  int                *child_indices;
+  size_t             *split_offsets, indexa, indexb, elem_count;
+
+  elem_count = t8_element_array_get_count (leaves);
+  if (elem_count == 0) {
+    return;
+  }
+  if (elem_count == 1
+      && !ts->t8_element_compare (element,
+                                  t8_element_array_index_locidx (leaves,
+                                                                 0))) {
+    /* The element is the leaf */
+    *(t8_locidx_t *) sc_array_push (indices) = first_index;
+    if (dual_faces != NULL) {
+      *(int *) sc_array_push (dual_faces) = face;
+    }
+    if (leafs != NULL) {
+      *(const t8_element_t **) sc_array_push (leafs) =
+        t8_element_array_index_locidx (leaves, 0);
+    }
+    return;
+  }
+  T8_ASSERT (ts->t8_element_level (element) <
+             ts->t8_element_level (t8_element_array_index_locidx
+                                   (leaves, 0)));
+
+  num_face_children = ts->t8_element_num_face_children (element, face);
+  face_children = T8_ALLOC (t8_element_t *, num_face_children);
+  ts->t8_element_new (num_face_children, face_children);
+  child_indices = T8_ALLOC (int, num_face_children);
+  split_offsets = T8_ALLOC (size_t, ts->t8_element_num_children (element) + 1);
+  ts->t8_element_children_at_face (element, face, face_children,
+                                   num_face_children, child_indices);
+  /* Split the leaves in portions belonging to the children of element */
+  t8_forest_split_array (element, leaves, split_offsets);
+  for (iface = 0; iface < num_face_children; iface++) {
+    indexa = split_offsets[child_indices[iface]];
+    indexb = split_offsets[child_indices[iface] + 1];
+    if (indexa < indexb) {
+      /* There are leaves of this face child, we continue the recursion */
+      t8_element_array_init_view (&face_child_leaves, leaves, indexa,
+                                  indexb - indexa);
+      child_face = ts->t8_element_face_child_face (element, face, iface);
+      t8_forest_face_leaves_recursion (ts, face_children[iface],
+                                       child_face, &face_child_leaves,
+                                       first_index + indexa, indices,
+                                       dual_faces, leafs);
+    }
+  }
+  ts->t8_element_destroy (num_face_children, face_children);
+  T8_FREE (face_children);
+  T8_FREE (child_indices);
+  T8_FREE (split_offsets);
+}
+
+/* Given an element and a face of it, push the indices of the leaves in a
+ * sorted array of leaves that either contain the element or are descendants
+ * of the element that touch the face. The index of the first leaf in leaves
+ * is first_index. dual_faces and leafs are as in
+ * t8_forest_face_leaves_recursion. */
+static void
+t8_forest_face_tree_leaves (t8_forest_t forest, t8_eclass_scheme_c * ts,
+                            const t8_element_t * element, int face,
+                            t8_element_array_t * leaves,
+                            t8_locidx_t first_index, sc_array_t * indices,
+                            sc_array_t * dual_faces, sc_array_t * leafs)
+{
+  t8_element_t       *leaf, *scratch;
+  t8_element_array_t  desc_leaves;
+  t8_linearidx_t      element_id, last_id;
+  t8_locidx_t         lower, first, last;
+  int                 is_ancestor, leaf_face, level;
+
+  if (t8_element_array_get_count (leaves) == 0) {
+    return;
+  }
+  ts->t8_element_new (1, &scratch);
+  element_id = ts->t8_element_get_linear_id (element, forest->maxlevel);
+  lower = t8_forest_bin_search_lower (leaves, element_id, forest->maxlevel);
+  first = lower + 1;
+  if (lower >= 0) {
+    leaf = t8_element_array_index_locidx (leaves, lower);
+    is_ancestor = 0;
+    if (ts->t8_element_level (leaf) <= ts->t8_element_level (element)) {
+      ts->t8_element_nca (leaf, element, scratch);
+      is_ancestor = !ts->t8_element_compare (leaf, scratch);
+    }
+    if (is_ancestor) {
+      /* The leaf contains element and is the only neighbor in leaves */
+      *(t8_locidx_t *) sc_array_push (indices) = first_index + lower;
+      if (dual_faces != NULL) {
+        /* The face of element lies on the boundary of the leaf, we compute
+         * the face of the leaf by going up the ancestors of element */
+        leaf_face = face;
+        ts->t8_element_copy (element, scratch);
+        for (level = ts->t8_element_level (element);
+             level > ts->t8_element_level (leaf); level--) {
+          leaf_face = ts->t8_element_face_parent_face (scratch, leaf_face);
+          T8_ASSERT (leaf_face >= 0);
+          ts->t8_element_parent (scratch, scratch);
+        }
+        *(int *) sc_array_push (dual_faces) = leaf_face;
+      }
+      if (leafs != NULL) {
+        *(const t8_element_t **) sc_array_push (leafs) = leaf;
+      }
+      ts->t8_element_destroy (1, &scratch);
+      return;
+    }
+    if (ts->t8_element_get_linear_id (leaf, forest->maxlevel)
+        == element_id) {
+      /* The leaf is the first descendant of element */
+      first = lower;
+    }
+  }
+  /* The descendants of element are the leaves up to the last one whose
+   * id is at most the id of the last descendant of element. */
+  ts->t8_element_last_descendant (element, scratch, forest->maxlevel);
+  last_id = ts->t8_element_get_linear_id (scratch, forest->maxlevel);
+  last = t8_forest_bin_search_lower (leaves, last_id, forest->maxlevel);
+  ts->t8_element_destroy (1, &scratch);
+  if (first <= last) {
+    t8_element_array_init_view (&desc_leaves, leaves, first,
+                                last - first + 1);
+    t8_forest_face_leaves_recursion (ts, element, face, &desc_leaves,
+                                     first_index + first, indices,
+                                     dual_faces, leafs);
+  }
+}
+
+void
+t8_forest_leaf_face_neighbors_search (t8_forest_t forest,
+                                      t8_locidx_t ltreeid,
+                                      const t8_element_t * leaf, int face,
+                                      sc_array_t * indices,
+                                      sc_array_t * dual_faces,
+                                      sc_array_t * leafs)
+{
+  t8_eclass_scheme_c *neigh_scheme;
+  t8_element_t       *neigh;
+  t8_gloidx_t         gneigh_tree;
+  t8_locidx_t         lneigh_tree, lghost_tree, offset;
+  int                 dual_face;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (indices != NULL);
+
+  t8_forest_ghost_ensure (forest);
+  neigh_scheme =
+    t8_forest_get_eclass_scheme (forest,
+                                 t8_forest_element_neighbor_eclass (forest,
+                                                                    ltreeid,
+                                                                    leaf,
+                                                                    face));
+  neigh_scheme->t8_element_new (1, &neigh);
+  gneigh_tree = t8_forest_element_face_neighbor (forest, ltreeid, leaf,
+                                                 neigh, neigh_scheme, face,
+                                                 &dual_face);
+  if (gneigh_tree >= 0) {
+    /* The neighbor leaves may be local and ghost elements */
+    lneigh_tree = t8_forest_get_local_id (forest, gneigh_tree);
+    if (lneigh_tree >= 0) {
+      t8_forest_face_tree_leaves (forest, neigh_scheme, neigh, dual_face,
+                                  t8_forest_get_tree_element_array
+                                  (forest, lneigh_tree),
+                                  t8_forest_get_tree_element_offset
+                                  (forest, lneigh_tree), indices,
+                                  dual_faces, leafs);
+    }
+    lghost_tree = forest->ghosts == NULL ? -1 :
+      t8_forest_ghost_get_ghost_treeid (forest, gneigh_tree);
+    if (lghost_tree >= 0) {
+      offset = t8_forest_get_local_num_elements (forest)
+        + t8_forest_ghost_get_tree_element_offset (forest, lghost_tree);
+      t8_forest_face_tree_leaves (forest, neigh_scheme, neigh, dual_face,
+                                  t8_forest_ghost_get_tree_elements
+                                  (forest, lghost_tree), offset, indices,
+                                  dual_faces, leafs);
+    }
+  }
+  neigh_scheme->t8_element_destroy (1, &neigh);
+}
+
+/* Compute the leaf face neighbors of a leaf in a forest that may not be
+ * balanced. The output is as in t8_forest_leaf_face_neighbors. The leafs
+ * are ordered with the local leafs first and the ghosts second. */
+static void
+t8_forest_leaf_face_neighbors_unbalanced (t8_forest_t forest,
+                                          t8_locidx_t ltreeid,
+                                          const t8_element_t * leaf,
+                                          t8_element_t ** pneighbor_leafs[],
+                                          int face, int *dual_faces[],
+                                          int *num_neighbors,
+                                          t8_locidx_t ** pelement_indices,
+                                          t8_eclass_scheme_c * neigh_scheme)
+{
+  sc_array_t          indices, faces, leafs;
+  int                 ineigh;
+
+  sc_array_init (&indices, sizeof (t8_locidx_t));
+  sc_array_init (&faces, sizeof (int));
+  sc_array_init (&leafs, sizeof (const t8_element_t *));
+  t8_forest_leaf_face_neighbors_search (forest, ltreeid, leaf, face,
+                                        &indices, &faces, &leafs);
+  *num_neighbors = indices.elem_count;
+  if (*num_neighbors == 0) {
+    /* There exists no face neighbor across this face */
+    *dual_faces = NULL;
+    *pelement_indices = NULL;
+    *pneighbor_leafs = NULL;
+  }
+  else {
+    /* Copy the neighbors to the output arrays */
+    *pelement_indices = T8_ALLOC (t8_locidx_t, *num_neighbors);
+    memcpy (*pelement_indices, indices.array,
+            *num_neighbors * sizeof (t8_locidx_t));
+    *dual_faces = T8_ALLOC (int, *num_neighbors);
+    memcpy (*dual_faces, faces.array, *num_neighbors * sizeof (int));
+    *pneighbor_leafs = T8_ALLOC (t8_element_t *, *num_neighbors);
+    neigh_scheme->t8_element_new (*num_neighbors, *pneighbor_leafs);
+    for (ineigh = 0; ineigh < *num_neighbors; ineigh++) {
+      neigh_scheme->t8_element_copy (*(const t8_element_t **)
+                                     sc_array_index_int (&leafs, ineigh),
+                                     (*pneighbor_leafs)[ineigh]);
+    }
+  }
+  sc_array_reset (&indices);
+  sc_array_reset (&faces);
+  sc_array_reset (&leafs);
+}
+
+void
+t8_forest_leaf_face_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
+                               const t8_element_t * leaf,
+                               t8_element_t ** pneighbor_leafs[],
+                               int face, int *dual_faces[],
+                               int *num_neighbors,
+                               t8_locidx_t ** pelement_indices,
+                               t8_eclass_scheme_c ** pneigh_scheme,
+                               int forest_is_balanced)
+{
+  t8_eclass_t         neigh_class;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t      **neighbor_leafs;
+  int                 num_children_at_face;
+
+  /* TODO: implement is_leaf check to apply to leaf */
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (!forest_is_balanced || t8_forest_is_balanced (forest));
+  t8_forest_ghost_ensure (forest);
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL,
+                  "Ghost structure is needed for t8_forest_leaf_face_neighbors "
+                  "but was not found in forest.\n");
+
+  if (!forest_is_balanced) {
+    /* The neighbors may be on arbitrary levels, we search them in the
+     * leaf arrays of the neighbor tree */
+    neigh_class =
+      t8_forest_element_neighbor_eclass (forest, ltreeid, leaf, face);
+    *pneigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+    t8_forest_leaf_face_neighbors_unbalanced (forest, ltreeid, leaf,
+                                              pneighbor_leafs, face,
+                                              dual_faces, num_neighbors,
+                                              pelement_indices,
+                                              *pneigh_scheme);
+    return;
+  }
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  /* At first we compute these children of the face neighbor elements of leaf. For this, we need the
+   * neighbor tree's eclass, scheme, and tree id */
+  neigh_class =
+    t8_forest_element_neighbor_eclass (forest, ltreeid, leaf, face);
+  neigh_scheme = *pneigh_scheme =
+    t8_forest_get_eclass_scheme (forest, neigh_class);
+  /* Allocate the neighbor elements and the output arrays */
+  num_children_at_face =
+    t8_forest_leaf_face_neighbors_num_half (forest, leaf, face, ts);
+  neighbor_leafs = T8_ALLOC (t8_element_t *, num_children_at_face);
+  *dual_faces = T8_ALLOC (int, num_children_at_face);
+  *pelement_indices = T8_ALLOC (t8_locidx_t, num_children_at_face);
+  neigh_scheme->t8_element_new (num_children_at_face, neighbor_leafs);
+  *num_neighbors =
+    t8_forest_leaf_face_neighbors_buffered (forest, ltreeid, leaf, face,
+                                            neigh_class, neigh_scheme,
+                                            neighbor_leafs, *dual_faces,
+                                            *pelement_indices);
+  if (*num_neighbors == 0) {
+    /* There exists no face neighbor across this face, we return with this info */
+    neigh_scheme->t8_element_destroy (num_children_at_face, neighbor_leafs);
+    T8_FREE (neighbor_leafs);
+    T8_FREE (*dual_faces);
+    T8_FREE (*pelement_indices);
+    *dual_faces = NULL;
+    *pelement_indices = NULL;
+    *pneighbor_leafs = NULL;
+    return;
+  }
+  if (*num_neighbors < num_children_at_face) {
+    /* The neighbor is an ancestor of the half neighbors, free the others */
+    neigh_scheme->t8_element_destroy (num_children_at_face - *num_neighbors,
+                                      neighbor_leafs + *num_neighbors);
+  }
+  *pneighbor_leafs = neighbor_leafs;
+}
+
+int
+t8_forest_leaf_face_orientation (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 const t8_element_t * leaf, int face)
+{
+  t8_eclass_scheme_c *ts;
+  int                 orientation = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  if (ts->t8_element_is_root_boundary (leaf, face)) {
+    /* The face lies on the tree boundary, we look up the orientation of
+     * the tree connection. If there is no neighbor, it remains 0. */
+    (void) t8_cmesh_get_face_neighbor (t8_forest_get_cmesh (forest),
+                                       t8_forest_ltreeid_to_cmesh_ltreeid
+                                       (forest, ltreeid),
+                                       ts->t8_element_tree_face (leaf, face),
+                                       NULL, &orientation);
+  }
+  return orientation;
+}
+
+/* Reusable buffers for leaf face neighbor queries.
+ * The buffers grow with the largest number of neighbors that was queried. */
+typedef struct t8_forest_face_neighbor_workspace
+{
+  t8_scheme_cxx_t    *scheme;   /* The scheme of the elements */
+  /* For each eclass the allocated neighbor elements (t8_element_t *) */
+  sc_array_t          neighbor_leafs[T8_ECLASS_COUNT];
+  sc_array_t          dual_faces;       /* Dual faces (int) */
+  sc_array_t          element_indices;  /* Indices (t8_locidx_t) */
+  sc_array_t          leafs;    /* Leafs found by the unbalanced search */
+} t8_forest_face_neighbor_workspace_struct_t;
+
+/* Return at least count allocated elements of an eclass in a workspace.
+ * The returned array is valid until the next call. */
+static t8_element_t **
+t8_forest_face_neighbor_workspace_elements (t8_forest_face_neighbor_workspace_t
+                                            workspace, t8_eclass_t eclass,
+                                            t8_eclass_scheme_c * scheme,
+                                            size_t count)
+{
+  sc_array_t         *elements = &workspace->neighbor_leafs[eclass];
+  const size_t        num_allocated = elements->elem_count;
+
+  if (count > num_allocated) {
+    /* Allocate the missing elements */
+    sc_array_resize (elements, count);
+    scheme->t8_element_new ((int) (count - num_allocated),
+                            (t8_element_t **) sc_array_index (elements,
+                                                              num_allocated));
+  }
+  return (t8_element_t **) elements->array;
+}
+
+t8_forest_face_neighbor_workspace_t
+t8_forest_face_neighbor_workspace_new (t8_forest_t forest)
+{
+  t8_forest_face_neighbor_workspace_t workspace;
+  int                 eclass;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  workspace = T8_ALLOC_ZERO (t8_forest_face_neighbor_workspace_struct_t, 1);
+  /* The elements are allocated on first use for each eclass */
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    sc_array_init (&workspace->neighbor_leafs[eclass],
+                   sizeof (t8_element_t *));
+  }
+  sc_array_init (&workspace->dual_faces, sizeof (int));
+  sc_array_init (&workspace->element_indices, sizeof (t8_locidx_t));
+  sc_array_init (&workspace->leafs, sizeof (const t8_element_t *));
+  workspace->scheme = forest->scheme_cxx;
+  t8_scheme_cxx_ref (workspace->scheme);
+  return workspace;
 }
 
 void
-t8_forest_leaf_face_neighbors (t8_forest_t forest, t8_locidx_t ltreeid,
-                               const t8_element_t * leaf,
-                               t8_element_t ** pneighbor_leafs[],
-                               int face, int *dual_faces[],
-                               int *num_neighbors,
-                               t8_locidx_t ** pelement_indices,
-                               t8_eclass_scheme_c ** pneigh_scheme,
-                               int forest_is_balanced)
+t8_forest_face_neighbor_workspace_destroy (t8_forest_face_neighbor_workspace_t
+                                           * pworkspace)
 {
-  t8_eclass_t         neigh_class, eclass;
-  t8_gloidx_t         gneigh_treeid;
-  t8_locidx_t         lneigh_treeid = -1;
-  t8_locidx_t         lghost_treeid = -1, *element_indices, element_index;
-  t8_eclass_scheme_c *ts, *neigh_scheme;
-  t8_element_array_t *element_array;
-  t8_element_t       *ancestor, **neighbor_leafs;
-  t8_linearidx_t      neigh_id;
-  int                 num_children_at_face, at_maxlevel;
-  int                 ineigh, *owners, different_owners, have_ghosts;
+  t8_forest_face_neighbor_workspace_t workspace;
+  int                 eclass;
+
+  T8_ASSERT (pworkspace != NULL && *pworkspace != NULL);
+  workspace = *pworkspace;
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (workspace->neighbor_leafs[eclass].elem_count > 0) {
+      workspace->scheme->eclass_schemes[eclass]->t8_element_destroy
+        ((int) workspace->neighbor_leafs[eclass].elem_count,
+         (t8_element_t **) workspace->neighbor_leafs[eclass].array);
+    }
+    sc_array_reset (&workspace->neighbor_leafs[eclass]);
+  }
+  sc_array_reset (&workspace->dual_faces);
+  sc_array_reset (&workspace->element_indices);
+  sc_array_reset (&workspace->leafs);
+  t8_scheme_cxx_unref (&workspace->scheme);
+  T8_FREE (workspace);
+  *pworkspace = NULL;
+}
+
+int
+t8_forest_leaf_face_neighbors_workspace (t8_forest_t forest,
+                                         t8_locidx_t ltreeid,
+                                         const t8_element_t * leaf, int face,
+                                         t8_forest_face_neighbor_workspace_t
+                                         workspace,
+                                         t8_element_t ***pneighbor_leafs,
+                                         const int **dual_faces,
+                                         const t8_locidx_t **
+                                         pelement_indices,
+                                         t8_eclass_scheme_c ** pneigh_scheme,
+                                         int forest_is_balanced)
+{
+  t8_eclass_t         neigh_class;
+  t8_eclass_scheme_c *neigh_scheme;
+  t8_element_t      **neighbor_leafs;
+  int                 num_neighbors, ineigh;
 
-  /* TODO: implement is_leaf check to apply to leaf */
   T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (workspace != NULL && workspace->scheme == forest->scheme_cxx);
   T8_ASSERT (!forest_is_balanced || t8_forest_is_balanced (forest));
-  SC_CHECK_ABORT (forest_is_balanced, "leaf face neighbors is not implemented " "for unbalanced forests.\n");   /* TODO: write version for unbalanced forests */
+  t8_forest_ghost_ensure (forest);
   SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL,
                   "Ghost structure is needed for t8_forest_leaf_face_neighbors "
                   "but was not found in forest.\n");
 
+  neigh_class =
+    t8_forest_element_neighbor_eclass (forest, ltreeid, leaf, face);
+  neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
   if (forest_is_balanced) {
-    /* In a balanced forest, the leaf neighbor of a leaf is either the neighbor element itself,
-     * its parent or its children at the face. */
-    eclass = t8_forest_get_tree_class (forest, ltreeid);
-    ts = t8_forest_get_eclass_scheme (forest, eclass);
-    /* At first we compute these children of the face neighbor elements of leaf. For this, we need the
-     * neighbor tree's eclass, scheme, and tree id */
-    neigh_class =
-      t8_forest_element_neighbor_eclass (forest, ltreeid, leaf, face);
-    neigh_scheme = *pneigh_scheme =
-      t8_forest_get_eclass_scheme (forest, neigh_class);
-    /* If we are at the maximum refinement level, we compute the neighbor instead */
-    at_maxlevel =
-      ts->t8_element_level (leaf) == t8_forest_get_maxlevel (forest);
-    if (at_maxlevel) {
-      num_children_at_face = 1;
-      neighbor_leafs = *pneighbor_leafs = T8_ALLOC (t8_element_t *, 1);
-      *dual_faces = T8_ALLOC (int, 1);
-      neigh_scheme->t8_element_new (num_children_at_face, neighbor_leafs);
-      /* Compute neighbor element and global treeid of the neighbor */
-      gneigh_treeid =
-        t8_forest_element_face_neighbor (forest, ltreeid, leaf,
-                                         neighbor_leafs[0], neigh_scheme,
-                                         face, *dual_faces);
-    }
-    else {
-      /* Allocate neighbor element */
-      num_children_at_face = ts->t8_element_num_face_children (leaf, face);
-      neighbor_leafs = *pneighbor_leafs =
-        T8_ALLOC (t8_element_t *, num_children_at_face);
-      *dual_faces = T8_ALLOC (int, num_children_at_face);
-      neigh_scheme->t8_element_new (num_children_at_face, neighbor_leafs);
-      /* Compute neighbor elements and global treeid of the neighbor */
-      gneigh_treeid =
-        t8_forest_element_half_face_neighbors (forest, ltreeid, leaf,
-                                               neighbor_leafs,
-                                               neigh_scheme, face,
-                                               num_children_at_face,
-                                               *dual_faces);
-    }
-    if (gneigh_treeid < 0) {
-      /* There exists no face neighbor across this face, we return with this info */
-      neigh_scheme->t8_element_destroy (1, neighbor_leafs);
-      T8_FREE (neighbor_leafs);
-      T8_FREE (*dual_faces);
-      *dual_faces = NULL;
-      *num_neighbors = 0;
-      *pelement_indices = NULL;
-      *pneighbor_leafs = NULL;
-      return;
-    }
-    T8_ASSERT (gneigh_treeid >= 0
-               && gneigh_treeid < forest->global_num_trees);
-    /* We have computed the half face neighbor elements, we now compute their owners,
-     * if they differ, we know that the half face neighbors are the neighbor leafs.
-     * If the owners do not differ, we have to check if the neighbor leaf is their
-     * parent or grandparent. */
-    owners = T8_ALLOC (int, num_children_at_face);
-    different_owners = 0;
-    have_ghosts = 0;
-    for (ineigh = 0; ineigh < num_children_at_face; ineigh++) {
-      /* At first, we check whether the current rank owns the neighbor, since
-       * this is a constant time check and it is the most common case */
-      if (t8_forest_element_check_owner (forest, neighbor_leafs[ineigh],
-                                         gneigh_treeid, neigh_class,
-                                         forest->mpirank, at_maxlevel)) {
-        owners[ineigh] = forest->mpirank;
-        /* The neighbor tree is also a local tree. we store its local treeid */
-        lneigh_treeid = t8_forest_get_local_id (forest, gneigh_treeid);
-      }
-      else {
-        owners[ineigh] =
-          t8_forest_element_find_owner (forest, gneigh_treeid,
-                                        neighbor_leafs[ineigh], neigh_class);
-        /* Store that at least one neighbor is a ghost */
-        have_ghosts = 1;
-      }
-      if (ineigh > 0) {
-        /* Check if all owners are the same for all neighbors or not */
-        different_owners = different_owners
-          || (owners[ineigh] != owners[ineigh - 1]);
-      }
-    }
-    if (have_ghosts) {
-      /* At least one neighbor is a ghost, we compute the ghost treeid of the neighbor
-       * tree. */
-      lghost_treeid =
-        t8_forest_ghost_get_ghost_treeid (forest, gneigh_treeid);
-      T8_ASSERT (lghost_treeid >= 0);
-    }
-    /* TODO: Maybe we do not need to compute the owners. It suffices to know
-     *       whether the neighbor is owned by mpirank or not. */
-
-    if (!different_owners) {
-      /* The face neighbors belong to the same process, we thus need to determine
-       * if they are leafs or their parent or grandparent. */
-      neigh_id =
-        neigh_scheme->t8_element_get_linear_id (neighbor_leafs[0],
-                                                forest->maxlevel);
-      if (owners[0] != forest->mpirank) {
-        /* The elements are ghost elements of the same owner */
-        element_array =
-          t8_forest_ghost_get_tree_elements (forest, lghost_treeid);
-        /* Find the index in element_array of the leaf ancestor of the first neighbor.
-         * This is either the neighbor itself or its parent, or its grandparent */
-        element_index =
-          t8_forest_bin_search_lower (element_array, neigh_id,
-                                      forest->maxlevel);
-        /* Get the element */
-        ancestor =
-          t8_forest_ghost_get_element (forest, lghost_treeid, element_index);
-        /* Add the number of ghost elements on previous ghost trees and the number
-         * of local elements. */
-        element_index +=
-          t8_forest_ghost_get_tree_element_offset (forest, lghost_treeid);
-        element_index += t8_forest_get_local_num_elements (forest);
-        T8_ASSERT (forest->local_num_elements <= element_index
-                   && element_index <
-                   forest->local_num_elements +
-                   t8_forest_get_num_ghosts (forest));
-      }
-      else {
-        /* the elements are local elements */
-        element_array =
-          t8_forest_get_tree_element_array (forest, lneigh_treeid);
-        /* Find the index in element_array of the leaf ancestor of the first neighbor.
-         * This is either the neighbor itself or its parent, or its grandparent */
-        element_index =
-          t8_forest_bin_search_lower (element_array, neigh_id,
-                                      forest->maxlevel);
-        /* Get the element */
-        ancestor =
-          t8_forest_get_tree_element (t8_forest_get_tree
-                                      (forest, lneigh_treeid), element_index);
-        /* Add the element offset of this tree to the index */
-        element_index +=
-          t8_forest_get_tree_element_offset (forest, lneigh_treeid);
-      }
-      if (neigh_scheme->t8_element_compare (ancestor, neighbor_leafs[0]) < 0) {
-        /* ancestor is a real ancestor, and thus the neighbor is either the
-         * parent or grandparent of the half neighbors. we can return it and
-         * the indices. */
-        /* We need to determine the dual face */
-        if (neigh_scheme->t8_element_level (ancestor) ==
-            ts->t8_element_level (leaf)) {
-          /* The ancestor is the same-level neighbor of leaf */
-          if (!at_maxlevel) {
-            /* its dual face is the face of the parent of the first neighbor leaf */
-            *dual_faces[0] =
-              neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
-                                                         *dual_faces[0]);
-
-          }
-        }
-        else {
-          /* The ancestor is the parent of the parent */
-          T8_ASSERT (neigh_scheme->t8_element_level (ancestor) ==
-                     ts->t8_element_level (leaf) - 1);
-
-          *dual_faces[0] =
-            neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
-                                                       *dual_faces[0]);
-          if (!at_maxlevel) {
-            /* We need to compute the dual face of the grandparent. */
-            /* Construct the parent of the grand child */
-            neigh_scheme->t8_element_parent (neighbor_leafs[0],
-                                             neighbor_leafs[0]);
-            /* Compute the face id of the parent's face */
-            *dual_faces[0] =
-              neigh_scheme->t8_element_face_parent_face (neighbor_leafs[0],
-                                                         *dual_faces[0]);
-          }
-        }
-
-        /* free memory */
-        neigh_scheme->t8_element_destroy (num_children_at_face - 1,
-                                          neighbor_leafs + 1);
-        /* copy the ancestor */
-        neigh_scheme->t8_element_copy (ancestor, neighbor_leafs[0]);
-        /* set return values */
-        *num_neighbors = 1;
-        *pelement_indices = T8_ALLOC (t8_locidx_t, 1);
-        (*pelement_indices)[0] = element_index;
-
-        T8_FREE (owners);
-        return;
-      }
-    }
-    /* The leafs are the face neighbors that we are looking for. */
-    /* The face neighbors either belong to different processes and thus must be leafs
-     * in the forest, or the ancestor leaf of the first half neighbor is the half
-     * neighbor itself and thus all half neighbors must be leafs.
-     * Since the forest is balanced, we found all neighbor leafs.
-     * It remains to compute their local ids */
-    *num_neighbors = num_children_at_face;
-    *pelement_indices = T8_ALLOC (t8_locidx_t, num_children_at_face);
-    element_indices = *pelement_indices;
-    for (ineigh = 0; ineigh < num_children_at_face; ineigh++) {
-      /* Compute the linear id at maxlevel of the neighbor leaf */
-      neigh_id =
-        neigh_scheme->t8_element_get_linear_id (neighbor_leafs[ineigh],
-                                                forest->maxlevel);
-      /* Get a pointer to the element array in which the neighbor lies and search
-       * for the element's index in this array.
-       * This is either the local leaf array of the local tree or the corresponding leaf array
-       * in the ghost structure */
-      if (owners[ineigh] == forest->mpirank) {
-        /* The neighbor is a local leaf */
-        element_array =
-          t8_forest_get_tree_element_array (forest, lneigh_treeid);
-        /* Find the index of the neighbor in the array */
-        element_indices[ineigh] =
-          t8_forest_bin_search_lower (element_array, neigh_id,
-                                      forest->maxlevel);
-        T8_ASSERT (element_indices[ineigh] >= 0);
-        /* We have to add the tree's element offset to the index found to get
-         * the actual local element id */
-        element_indices[ineigh] +=
-          t8_forest_get_tree_element_offset (forest, lneigh_treeid);
-#if T8_ENABLE_DEBUG
-        /* We check whether the element is really the element at this local id */
-        {
-          t8_locidx_t         check_ltreeid;
-          t8_element_t       *check_element;
-          check_element =
-            t8_forest_get_element (forest, element_indices[ineigh],
-                                   &check_ltreeid);
-          T8_ASSERT (check_ltreeid == lneigh_treeid);
-          T8_ASSERT (!neigh_scheme->t8_element_compare (check_element,
-                                                        neighbor_leafs
-                                                        [ineigh]));
-        }
-#endif
-      }
-      else {
-        /* The neighbor is a ghost */
-        element_array =
-          t8_forest_ghost_get_tree_elements (forest, lghost_treeid);
-        /* Find the index of the neighbor in the array */
-        element_indices[ineigh] =
-          t8_forest_bin_search_lower (element_array, neigh_id,
-                                      forest->maxlevel);
-
-#if T8_ENABLE_DEBUG
-        /* We check whether the element is really the element at this local id */
-        {
-          t8_element_t       *check_element;
-          check_element =
-            t8_forest_ghost_get_element (forest, lghost_treeid,
-                                         element_indices[ineigh]);
-          T8_ASSERT (!neigh_scheme->t8_element_compare (check_element,
-                                                        neighbor_leafs
-                                                        [ineigh]));
-        }
-#endif
-        /* Add the element offset of previous ghosts to this index */
-        element_indices[ineigh] +=
-          t8_forest_ghost_get_tree_element_offset (forest, lghost_treeid);
-        /* Add the number of all local elements to this index */
-        element_indices[ineigh] += t8_forest_get_local_num_elements (forest);
-      }
-    }                           /* End for loop over neighbor leafs */
-    T8_FREE (owners);
+    /* There are at most as many neighbors as children at a face */
+    neighbor_leafs =
+      t8_forest_face_neighbor_workspace_elements (workspace, neigh_class,
+                                                  neigh_scheme,
+                                                  T8_ECLASS_MAX_CHILDREN);
+    sc_array_resize (&workspace->dual_faces, T8_ECLASS_MAX_CHILDREN);
+    sc_array_resize (&workspace->element_indices, T8_ECLASS_MAX_CHILDREN);
+    num_neighbors =
+      t8_forest_leaf_face_neighbors_buffered (forest, ltreeid, leaf, face,
+                                              neigh_class, neigh_scheme,
+                                              neighbor_leafs,
+                                              (int *) workspace->
+                                              dual_faces.array,
+                                              (t8_locidx_t *) workspace->
+                                              element_indices.array);
   }
   else {
-    /* TODO: implement unbalanced version */
-    SC_ABORT_NOT_REACHED ();
+    /* The neighbors may be on arbitrary levels, we search them in the
+     * leaf arrays of the neighbor tree as t8_forest_leaf_face_neighbors */
+    sc_array_truncate (&workspace->dual_faces);
+    sc_array_truncate (&workspace->element_indices);
+    sc_array_truncate (&workspace->leafs);
+    t8_forest_leaf_face_neighbors_search (forest, ltreeid, leaf, face,
+                                          &workspace->element_indices,
+                                          &workspace->dual_faces,
+                                          &workspace->leafs);
+    num_neighbors = workspace->element_indices.elem_count;
+    neighbor_leafs =
+      t8_forest_face_neighbor_workspace_elements (workspace, neigh_class,
+                                                  neigh_scheme,
+                                                  num_neighbors);
+    for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      neigh_scheme->t8_element_copy (*(const t8_element_t **)
+                                     sc_array_index_int (&workspace->leafs,
+                                                         ineigh),
+                                     neighbor_leafs[ineigh]);
+    }
+  }
+  if (pneighbor_leafs != NULL) {
+    *pneighbor_leafs = neighbor_leafs;
+  }
+  if (dual_faces != NULL) {
+    *dual_faces = (const int *) workspace->dual_faces.array;
   }
+  if (pelement_indices != NULL) {
+    *pelement_indices =
+      (const t8_locidx_t *) workspace->element_indices.array;
+  }
+  if (pneigh_scheme != NULL) {
+    *pneigh_scheme = neigh_scheme;
+  }
+  return num_neighbors;
 }
 
 void
@@ -2139,25 +4238,17 @@ t8_forest_print_all_leaf_neighbors (t8_forest_t forest)
   }
 }
 
-/* Check if an element is owned by a specific rank */
-int
-t8_forest_element_check_owner (t8_forest_t forest,
-                               t8_element_t * element,
-                               t8_gloidx_t gtreeid, t8_eclass_t eclass,
-                               int rank, int element_is_desc)
+/* Check if the element with a given linear id of its first descendant at
+ * the maximum level in a global tree is owned by a specific rank */
+static int
+t8_forest_element_check_owner_id (t8_forest_t forest, t8_gloidx_t gtreeid,
+                                  t8_linearidx_t first_desc_id, int rank)
 {
-  t8_element_t       *first_desc;
-  t8_eclass_scheme_c *ts;
   t8_gloidx_t        *first_global_trees;
-  t8_linearidx_t      rfirst_desc_id, rnext_desc_id = -1, first_desc_id;
+  t8_linearidx_t      rfirst_desc_id, rnext_desc_id = -1;
   int                 is_first, is_last, check_next;
   int                 next_nonempty;
 
-  T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (element != NULL);
-  T8_ASSERT (0 <= gtreeid
-             && gtreeid < t8_forest_get_num_global_trees (forest));
-
   /* Get a pointer to the first_global_trees array of forest */
   first_global_trees = t8_shmem_array_get_gloidx_array (forest->tree_offsets);
 
@@ -2174,22 +4265,6 @@ t8_forest_element_check_owner (t8_forest_t forest,
         t8_offset_in_range (gtreeid, next_nonempty, first_global_trees);
       /* The tree is either the first or the last tree on rank, we thus
        * have to check whether element is in the range of the tree */
-      /* Get the eclass scheme of the tree */
-      ts = t8_forest_get_eclass_scheme (forest, eclass);
-      /* Compute the linear id of the first descendant of element */
-      if (!element_is_desc) {
-        ts->t8_element_new (1, &first_desc);
-        ts->t8_element_first_descendant (element, first_desc,
-                                         forest->maxlevel);
-        first_desc_id =
-          ts->t8_element_get_linear_id (first_desc, forest->maxlevel);
-        ts->t8_element_destroy (1, &first_desc);
-      }
-      else {
-        /* The element is its own first descendant */
-        first_desc_id =
-          ts->t8_element_get_linear_id (element, forest->maxlevel);
-      }
       /* Get the id of the trees first descendant and the first descendant
        * of the next nonempty rank */
       rfirst_desc_id =
@@ -2222,6 +4297,36 @@ t8_forest_element_check_owner (t8_forest_t forest,
   return 0;
 }
 
+/* Check if an element is owned by a specific rank */
+int
+t8_forest_element_check_owner (t8_forest_t forest,
+                               t8_element_t * element,
+                               t8_gloidx_t gtreeid, t8_eclass_t eclass,
+                               int rank, int element_is_desc)
+{
+  t8_eclass_scheme_c *ts;
+  t8_linearidx_t      first_desc_id, last_desc_id;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (element != NULL);
+  T8_ASSERT (0 <= gtreeid
+             && gtreeid < t8_forest_get_num_global_trees (forest));
+
+  /* Get the eclass scheme of the tree */
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  /* Compute the linear id of the first descendant of element */
+  if (!element_is_desc) {
+    ts->t8_element_descendant_range (element, forest->maxlevel,
+                                     &first_desc_id, &last_desc_id);
+  }
+  else {
+    /* The element is its own first descendant */
+    first_desc_id = ts->t8_element_get_linear_id (element, forest->maxlevel);
+  }
+  return t8_forest_element_check_owner_id (forest, gtreeid, first_desc_id,
+                                           rank);
+}
+
 /* The data that we use as key in the binary owner search.
  * It contains the linear id of the element that we look for and
  * a pointer to the forest, we also store the index of the biggest
@@ -2276,49 +4381,29 @@ t8_forest_element_find_owner_compare (const void *find_owner_data,
   }
 }
 
-int
-t8_forest_element_find_owner_ext (t8_forest_t forest,
-                                  t8_gloidx_t gtreeid,
-                                  t8_element_t * element,
-                                  t8_eclass_t eclass, int lower_bound,
-                                  int upper_bound, int guess,
-                                  int element_is_desc)
+/* Binary search for the owner process of the element with linear id
+ * \a element_desc_id at the maximum level in a global tree between
+ * \a lower_bound and \a upper_bound, starting at \a guess.
+ * See t8_forest_element_find_owner_ext. */
+static int
+t8_forest_element_find_owner_search (t8_forest_t forest,
+                                     t8_gloidx_t gtreeid,
+                                     t8_linearidx_t element_desc_id,
+                                     int lower_bound, int upper_bound,
+                                     int guess)
 {
-  t8_element_t       *first_desc;
-  t8_eclass_scheme_c *ts;
   t8_gloidx_t        *first_trees, *element_offsets;
   t8_gloidx_t         current_first_tree;
-  t8_linearidx_t      current_id, element_desc_id;
+  t8_linearidx_t      current_id;
   t8_linearidx_t     *first_descs;
   int                 found = 0;
   int                 empty_dir = 1, last_guess, reached_bound;
   int                 next_nonempty;
 
-  T8_ASSERT (t8_forest_is_committed (forest));
-  T8_ASSERT (0 <= gtreeid
-             && gtreeid < t8_forest_get_num_global_trees (forest));
-  T8_ASSERT (element != NULL);
   T8_ASSERT (0 <= lower_bound && lower_bound <= upper_bound
              && upper_bound < forest->mpisize);
   T8_ASSERT (lower_bound <= guess && guess <= upper_bound);
 
-  /* If the upper and lower bound only leave one process left, we can immediately
-   * return this process as the owner */
-  if (upper_bound == lower_bound) {
-    return upper_bound;
-  }
-
-  ts = t8_forest_get_eclass_scheme (forest, eclass);
-  if (element_is_desc) {
-    /* The element is already its own first_descendant */
-    first_desc = element;
-  }
-  else {
-    /* Build the first descendant of element */
-    ts->t8_element_new (1, &first_desc);
-    ts->t8_element_first_descendant (element, first_desc, forest->maxlevel);
-  }
-
   T8_ASSERT (forest->tree_offsets != NULL);
   T8_ASSERT (forest->global_first_desc != NULL);
 
@@ -2326,10 +4411,6 @@ t8_forest_element_find_owner_ext (t8_forest_t forest,
   first_trees = t8_shmem_array_get_gloidx_array (forest->tree_offsets);
   first_descs =
     (t8_linearidx_t *) t8_shmem_array_get_array (forest->global_first_desc);
-  /* Compute the linear id of the element's first descendant */
-  element_desc_id =
-    ts->t8_element_get_linear_id (first_desc,
-                                  ts->t8_element_level (first_desc));
   /* Get a pointer to the element offset array */
   element_offsets = t8_shmem_array_get_gloidx_array (forest->element_offsets);
 
@@ -2435,13 +4516,119 @@ t8_forest_element_find_owner_ext (t8_forest_t forest,
     }
   }
 
-  /* clean-up */
-  if (!element_is_desc) {
-    ts->t8_element_destroy (1, &first_desc);
+  return guess;
+}
+
+/* The number of processes on each side of the last found owner that are
+ * checked before we search the owner among all processes */
+#define T8_FOREST_OWNER_WINDOW 2
+
+/* Read and write the last found owner of a forest. Since the owner search
+ * may be called from multiple threads, we access it atomically. */
+static int
+t8_forest_owner_cache_get (t8_forest_t forest)
+{
+  int                 rank;
+
+#ifdef T8_ENABLE_OPENMP
+#pragma omp atomic read
+#endif
+  rank = forest->owner_cache;
+  return rank;
+}
+
+static void
+t8_forest_owner_cache_set (t8_forest_t forest, int rank)
+{
+#ifdef T8_ENABLE_OPENMP
+#pragma omp atomic write
+#endif
+  forest->owner_cache = rank;
+}
+
+/* Find the owner process of the element with linear id \a element_desc_id
+ * at the maximum level in a global tree between \a lower_bound and
+ * \a upper_bound. Since consecutive queries are usually close to each other,
+ * we first check the last found owner and the processes in a window around
+ * it, and only then start the binary search at \a guess.
+ * See t8_forest_element_find_owner_ext. */
+static int
+t8_forest_element_find_owner_id (t8_forest_t forest, t8_gloidx_t gtreeid,
+                                 t8_linearidx_t element_desc_id,
+                                 int lower_bound, int upper_bound, int guess)
+{
+  int                 cached, rank, dist, side;
+
+  T8_ASSERT (0 <= lower_bound && lower_bound <= upper_bound
+             && upper_bound < forest->mpisize);
+  if (lower_bound == upper_bound) {
+    return lower_bound;
+  }
+  cached = t8_forest_owner_cache_get (forest);
+  for (dist = 0; dist <= T8_FOREST_OWNER_WINDOW; dist++) {
+    /* Check cached + dist first, since queries usually move forward */
+    for (side = 1; side >= (dist == 0 ? 1 : -1); side -= 2) {
+      rank = cached + side * dist;
+      if (lower_bound <= rank && rank <= upper_bound
+          && t8_forest_element_check_owner_id (forest, gtreeid,
+                                               element_desc_id, rank)) {
+        if (rank != cached) {
+          t8_forest_owner_cache_set (forest, rank);
+        }
+        return rank;
+      }
+    }
+  }
+  rank =
+    t8_forest_element_find_owner_search (forest, gtreeid, element_desc_id,
+                                         lower_bound, upper_bound, guess);
+  t8_forest_owner_cache_set (forest, rank);
+  return rank;
+}
+
+int
+t8_forest_element_find_owner_ext (t8_forest_t forest,
+                                  t8_gloidx_t gtreeid,
+                                  t8_element_t * element,
+                                  t8_eclass_t eclass, int lower_bound,
+                                  int upper_bound, int guess,
+                                  int element_is_desc)
+{
+  t8_eclass_scheme_c *ts;
+  t8_linearidx_t      element_desc_id, last_desc_id;
+  int                 owner;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= gtreeid
+             && gtreeid < t8_forest_get_num_global_trees (forest));
+  T8_ASSERT (element != NULL);
+  T8_ASSERT (0 <= lower_bound && lower_bound <= upper_bound
+             && upper_bound < forest->mpisize);
+  T8_ASSERT (lower_bound <= guess && guess <= upper_bound);
+
+  /* If the upper and lower bound only leave one process left, we can immediately
+   * return this process as the owner */
+  if (upper_bound == lower_bound) {
+    return upper_bound;
+  }
+
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  if (element_is_desc) {
+    /* The element is already its own first_descendant */
+    element_desc_id =
+      ts->t8_element_get_linear_id (element, ts->t8_element_level (element));
+  }
+  else {
+    /* Compute the linear id of the element's first descendant */
+    ts->t8_element_descendant_range (element, forest->maxlevel,
+                                     &element_desc_id, &last_desc_id);
   }
+  owner =
+    t8_forest_element_find_owner_id (forest, gtreeid, element_desc_id,
+                                     lower_bound, upper_bound, guess);
   T8_ASSERT (t8_forest_element_check_owner
-             (forest, element, gtreeid, eclass, guess, element_is_desc));
-  return guess;
+             (forest, element, gtreeid, eclass, owner, element_is_desc));
+  return owner;
 }
 
 int
@@ -2453,6 +4640,81 @@ t8_forest_element_find_owner (t8_forest_t forest, t8_gloidx_t gtreeid,
                                            (forest->mpisize - 1) / 2, 0);
 }
 
+void
+t8_forest_element_find_owners_sorted (t8_forest_t forest,
+                                      t8_gloidx_t gtreeid,
+                                      t8_eclass_t eclass,
+                                      const t8_element_t * elements,
+                                      t8_locidx_t num_elements, int *owners)
+{
+  t8_eclass_scheme_c *ts;
+  t8_linearidx_t     *ids;
+
+  T8_ASSERT (num_elements >= 0);
+
+  if (num_elements == 0) {
+    return;
+  }
+  /* Compute the linear ids of the first descendants of all elements */
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  ts->t8_element_batch_get_linear_id (elements, num_elements,
+                                      forest->maxlevel, ids);
+  t8_forest_element_find_owners_sorted_ids (forest, gtreeid, ids,
+                                            num_elements, owners);
+  T8_FREE (ids);
+}
+
+void
+t8_forest_element_find_owners_sorted_ids (t8_forest_t forest,
+                                          t8_gloidx_t gtreeid,
+                                          const t8_linearidx_t * ids,
+                                          t8_locidx_t num_ids, int *owners)
+{
+  t8_gloidx_t        *first_trees;
+  t8_linearidx_t     *first_descs;
+  t8_locidx_t         ielem;
+  int                 owner, next;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= gtreeid
+             && gtreeid < t8_forest_get_num_global_trees (forest));
+  T8_ASSERT (forest->tree_offsets != NULL);
+  T8_ASSERT (forest->global_first_desc != NULL);
+  T8_ASSERT (num_ids >= 0);
+
+  if (num_ids == 0) {
+    return;
+  }
+  first_trees = t8_shmem_array_get_gloidx_array (forest->tree_offsets);
+  first_descs =
+    (t8_linearidx_t *) t8_shmem_array_get_array (forest->global_first_desc);
+
+  /* Search the owner of the first element */
+  owner = t8_forest_element_find_owner_id (forest, gtreeid, ids[0], 0,
+                                           forest->mpisize - 1,
+                                           (forest->mpisize - 1) / 2);
+  owners[0] = owner;
+  next = t8_offset_next_nonempty_rank (owner, forest->mpisize, first_trees);
+  for (ielem = 1; ielem < num_ids; ielem++) {
+    T8_ASSERT (ids[ielem - 1] <= ids[ielem]);
+    /* The owner of an element is the last process that starts in front of
+     * it. Since owner has elements of the tree, all following processes
+     * start in this tree or in a later tree. */
+    while (next < forest->mpisize
+           && t8_offset_first (next, first_trees) == gtreeid
+           && first_descs[next] <= ids[ielem]) {
+      owner = next;
+      next =
+        t8_offset_next_nonempty_rank (owner, forest->mpisize, first_trees);
+    }
+    T8_ASSERT (t8_forest_element_check_owner_id (forest, gtreeid,
+                                                 ids[ielem], owner));
+    owners[ielem] = owner;
+  }
+  t8_forest_owner_cache_set (forest, owner);
+}
+
 /* This is a deprecated version of the element_find_owner algorithm which
  * searches for the owners of the coarse tree first */
 int
@@ -2568,12 +4830,12 @@ t8_forest_element_find_owner_old (t8_forest_t forest,
 }
 
 /* Recursively find all owners of descendants of a given element that touch a given face.
- * We do this by constructing the first and last possible descendants of the element that
- * touch the face. If those belong to different processes, we construct all children
- * of the element that touch the face.
+ * We do this by computing the linear ids of the first and last possible
+ * descendants of the element that touch the face. If those belong to
+ * different processes, we construct all children of the element that touch
+ * the face.
  * We pass those children to the recursion in order of their linear id to be sure
  * that we add owners in ascending order.
- * first_desc/last_desc should either point to the first/last descendant of element or be NULL
  */
 static void
 t8_forest_element_owners_at_face_recursion (t8_forest_t forest,
@@ -2582,60 +4844,50 @@ t8_forest_element_owners_at_face_recursion (t8_forest_t forest,
                                             t8_eclass_t eclass,
                                             t8_eclass_scheme_c * ts, int face,
                                             sc_array_t * owners,
-                                            int lower_bound, int upper_bound,
-                                            t8_element_t * first_desc,
-                                            t8_element_t * last_desc)
+                                            int lower_bound, int upper_bound)
 {
-  t8_element_t       *first_face_desc, *last_face_desc, **face_children;
+  t8_element_t      **face_children;
+  t8_linearidx_t      first_face_desc_id, last_face_desc_id;
   int                 first_owner, last_owner;
   int                 num_children, ichild;
   int                 child_face;
   int                 last_owner_entry;
 
   T8_ASSERT (element != NULL);
-  /* Create first and last descendants at face */
-  if (first_desc == NULL) {
-    ts->t8_element_new (1, &first_face_desc);
-    ts->t8_element_first_descendant_face (element, face, first_face_desc,
-                                          forest->maxlevel);
-  }
-  else {
-    first_face_desc = first_desc;
-  }
-  if (last_desc == NULL) {
-    ts->t8_element_new (1, &last_face_desc);
-    ts->t8_element_last_descendant_face (element, face, last_face_desc,
-                                         forest->maxlevel);
-  }
-  else {
-    last_face_desc = last_desc;
-  }
+  /* Compute the ids of the first and last descendants at face */
+  ts->t8_element_face_descendant_range (element, face, forest->maxlevel,
+                                        &first_face_desc_id,
+                                        &last_face_desc_id);
+
+  /* owner of first and last descendants */
+  first_owner =
+    t8_forest_element_find_owner_id (forest, gtreeid, first_face_desc_id,
+                                     lower_bound, upper_bound, lower_bound);
+  last_owner =
+    t8_forest_element_find_owner_id (forest, gtreeid, last_face_desc_id,
+                                     lower_bound, upper_bound, upper_bound);
 #ifdef T8_ENABLE_DEBUG
   {
-    /* Check if the computed or given descendants are the correct descendant */
+    /* Check the ids and owners with the constructed descendants */
     t8_element_t       *test_desc;
 
     ts->t8_element_new (1, &test_desc);
-    ts->t8_element_last_descendant_face (element, face, test_desc,
-                                         forest->maxlevel);
-    T8_ASSERT (!ts->t8_element_compare (test_desc, last_face_desc));
     ts->t8_element_first_descendant_face (element, face, test_desc,
                                           forest->maxlevel);
-    T8_ASSERT (!ts->t8_element_compare (test_desc, first_face_desc));
+    T8_ASSERT (ts->t8_element_get_linear_id (test_desc, forest->maxlevel)
+               == first_face_desc_id);
+    T8_ASSERT (t8_forest_element_check_owner
+               (forest, test_desc, gtreeid, eclass, first_owner, 1));
+    ts->t8_element_last_descendant_face (element, face, test_desc,
+                                         forest->maxlevel);
+    T8_ASSERT (ts->t8_element_get_linear_id (test_desc, forest->maxlevel)
+               == last_face_desc_id);
+    T8_ASSERT (t8_forest_element_check_owner
+               (forest, test_desc, gtreeid, eclass, last_owner, 1));
     ts->t8_element_destroy (1, &test_desc);
   }
 #endif
 
-  /* owner of first and last descendants */
-  first_owner =
-    t8_forest_element_find_owner_ext (forest, gtreeid, first_face_desc,
-                                      eclass, lower_bound, upper_bound,
-                                      lower_bound, 1);
-  last_owner =
-    t8_forest_element_find_owner_ext (forest, gtreeid, last_face_desc, eclass,
-                                      lower_bound, upper_bound, upper_bound,
-                                      1);
-
   /* It is impossible for an element with bigger id to belong to a smaller process */
   T8_ASSERT (first_owner <= last_owner);
 
@@ -2656,13 +4908,6 @@ t8_forest_element_owners_at_face_recursion (t8_forest_t forest,
       /* We did not count this process as an owner, thus we add it */
       *(int *) sc_array_push (owners) = first_owner;
     }
-    T8_ASSERT (t8_forest_element_check_owner
-               (forest, first_face_desc, gtreeid, eclass, first_owner, 1));
-    T8_ASSERT (t8_forest_element_check_owner
-               (forest, last_face_desc, gtreeid, eclass, first_owner, 1));
-    /* free memory */
-    ts->t8_element_destroy (1, &first_face_desc);
-    ts->t8_element_destroy (1, &last_face_desc);
     return;
   }
   else {
@@ -2681,16 +4926,11 @@ t8_forest_element_owners_at_face_recursion (t8_forest_t forest,
       /* the face number of the child may not be the same as face */
       child_face = ts->t8_element_face_child_face (element, face, ichild);
       /* find owners of this child */
-      /* For the first child, we reuse the first descendant */
-      first_desc = (ichild == 0 ? first_face_desc : NULL);
-      /* For the last child, we reuse the last descendant */
-      last_desc = (ichild == num_children - 1 ? last_face_desc : NULL);
       t8_forest_element_owners_at_face_recursion (forest, gtreeid,
                                                   face_children[ichild],
                                                   eclass, ts, child_face,
                                                   owners,
-                                                  lower_bound, upper_bound,
-                                                  first_desc, last_desc);
+                                                  lower_bound, upper_bound);
     }
     ts->t8_element_destroy (num_children, face_children);
     T8_FREE (face_children);
@@ -2732,8 +4972,7 @@ t8_forest_element_owners_at_face (t8_forest_t forest, t8_gloidx_t gtreeid,
   /* call the recursion */
   t8_forest_element_owners_at_face_recursion (forest, gtreeid, element,
                                               eclass, ts, face, owners,
-                                              lower_bound, upper_bound,
-                                              NULL, NULL);
+                                              lower_bound, upper_bound);
 }
 
 void
@@ -2742,27 +4981,23 @@ t8_forest_element_owners_bounds (t8_forest_t forest, t8_gloidx_t gtreeid,
                                  t8_eclass_t eclass, int *lower, int *upper)
 {
   t8_eclass_scheme_c *ts;
-  t8_element_t       *first_desc, *last_desc;
+  t8_linearidx_t      first_desc_id, last_desc_id;
 
   if (*lower >= *upper) {
     /* Either there is no owner or it is unique. */
     return;
   }
 
-  /* Compute the first and last descendant of element */
+  /* Compute the ids of the first and last descendant of element */
   ts = t8_forest_get_eclass_scheme (forest, eclass);
-  ts->t8_element_new (1, &first_desc);
-  ts->t8_element_first_descendant (element, first_desc, forest->maxlevel);
-  ts->t8_element_new (1, &last_desc);
-  ts->t8_element_last_descendant (element, last_desc, forest->maxlevel);
+  ts->t8_element_descendant_range (element, forest->maxlevel,
+                                   &first_desc_id, &last_desc_id);
 
   /* Compute their owners as bounds for all of element's owners */
-  *lower = t8_forest_element_find_owner_ext (forest, gtreeid, first_desc,
-                                             eclass, *lower, *upper, *lower,
-                                             1);
-  *upper =
-    t8_forest_element_find_owner_ext (forest, gtreeid, last_desc, eclass,
-                                      *lower, *upper, *upper, 1);
+  *lower = t8_forest_element_find_owner_id (forest, gtreeid, first_desc_id,
+                                            *lower, *upper, *lower);
+  *upper = t8_forest_element_find_owner_id (forest, gtreeid, last_desc_id,
+                                            *lower, *upper, *upper);
 }
 
 void
@@ -2773,7 +5008,7 @@ t8_forest_element_owners_at_face_bounds (t8_forest_t forest,
                                          int *lower, int *upper)
 {
   t8_eclass_scheme_c *ts;
-  t8_element_t       *first_face_desc, *last_face_desc;
+  t8_linearidx_t      first_face_desc_id, last_face_desc_id;
 
   if (*lower >= *upper) {
     /* Either there is no owner or it is unique. */
@@ -2781,22 +5016,17 @@ t8_forest_element_owners_at_face_bounds (t8_forest_t forest,
   }
 
   ts = t8_forest_get_eclass_scheme (forest, eclass);
-  ts->t8_element_new (1, &first_face_desc);
-  ts->t8_element_first_descendant_face (element, face, first_face_desc,
-                                        forest->maxlevel);
-  ts->t8_element_new (1, &last_face_desc);
-  ts->t8_element_last_descendant_face (element, face, last_face_desc,
-                                       forest->maxlevel);
+  ts->t8_element_face_descendant_range (element, face, forest->maxlevel,
+                                        &first_face_desc_id,
+                                        &last_face_desc_id);
 
   /* owner of first and last descendants */
   *lower =
-    t8_forest_element_find_owner_ext (forest, gtreeid, first_face_desc,
-                                      eclass, *lower, *upper, *lower, 1);
+    t8_forest_element_find_owner_id (forest, gtreeid, first_face_desc_id,
+                                     *lower, *upper, *lower);
   *upper =
-    t8_forest_element_find_owner_ext (forest, gtreeid, last_face_desc, eclass,
-                                      *lower, *upper, *upper, 1);
-  ts->t8_element_destroy (1, &first_face_desc);
-  ts->t8_element_destroy (1, &last_face_desc);
+    t8_forest_element_find_owner_id (forest, gtreeid, last_face_desc_id,
+                                     *lower, *upper, *upper);
 }
 
 void
@@ -2880,6 +5110,7 @@ t8_forest_element_has_leaf_desc (t8_forest_t forest, t8_gloidx_t gtreeid,
 {
   t8_locidx_t         ltreeid;
   t8_element_array_t *elements;
+  t8_element_array_soa_t *soa;
   t8_element_t       *last_desc, *elem_found;
   t8_locidx_t         ghost_treeid;
   t8_linearidx_t      last_desc_id, elem_id;
@@ -2930,21 +5161,18 @@ t8_forest_element_has_leaf_desc (t8_forest_t forest, t8_gloidx_t gtreeid,
      * as well */
     ghost_treeid = t8_forest_ghost_get_ghost_treeid (forest, gtreeid);
     if (ghost_treeid >= 0) {
-      /* The tree is a ghost tree */
-      elements = t8_forest_ghost_get_tree_elements (forest, ghost_treeid);
-      index =
-        t8_forest_bin_search_lower (elements, last_desc_id, forest->maxlevel);
+      /* The tree is a ghost tree. We use the precomputed levels and
+       * linear ids of its elements instead of accessing the elements. */
+      soa = t8_forest_ghost_get_tree_soa (forest, ghost_treeid);
+      index = t8_element_array_soa_search_lower (soa, last_desc_id);
       if (index >= 0) {
         /* There exists an element in the array with id <= last_desc_id,
          * If also elem_id < id, then we found a true decsendant of element */
-        elem_found = t8_element_array_index_int (elements, index);
-        elem_id = ts->t8_element_get_linear_id (elem_found, forest->maxlevel);
-        level_found = ts->t8_element_level (elem_found);
+        elem_id = t8_element_array_soa_get_id (soa, index);
+        level_found = t8_element_array_soa_get_level (soa, index);
         if (ts->t8_element_get_linear_id (element, forest->maxlevel)
             <= elem_id && level < level_found) {
           /* The element is a true descendant */
-          T8_ASSERT (ts->t8_element_level (elem_found) >
-                     ts->t8_element_level (element));
           /* clean-up */
           ts->t8_element_destroy (1, &last_desc);
           return 1;
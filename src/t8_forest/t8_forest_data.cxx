@@ -0,0 +1,313 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_forest/t8_forest_data.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+static t8_forest_data_field_t *
+t8_forest_data_field (t8_forest_t forest, int ifield)
+{
+  T8_ASSERT (forest->data_fields != NULL);
+  T8_ASSERT (0 <= ifield && (size_t) ifield < forest->data_fields->elem_count);
+  return (t8_forest_data_field_t *) sc_array_index_int (forest->data_fields,
+                                                        ifield);
+}
+
+/* Create the fields of forest with the same definitions as the fields of
+ * forest_from and empty data. Return the number of fields. */
+static int
+t8_forest_data_init_fields (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_data_field_t *field, *field_from;
+  int                 num_fields, ifield;
+
+  T8_ASSERT (forest->data_fields == NULL);
+  num_fields = t8_forest_data_get_num_fields (forest_from);
+  if (num_fields == 0) {
+    return 0;
+  }
+  forest->data_fields =
+    sc_array_new_count (sizeof (t8_forest_data_field_t), num_fields);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    field = t8_forest_data_field (forest, ifield);
+    field_from = t8_forest_data_field (forest_from, ifield);
+    *field = *field_from;
+    sc_array_init (&field->data, field_from->size);
+  }
+  return num_fields;
+}
+
+int
+t8_forest_data_add_field (t8_forest_t forest, size_t size,
+                          t8_forest_data_refine_t refine,
+                          t8_forest_data_coarsen_t coarsen, void *user)
+{
+  t8_forest_data_field_t *field;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (size > 0);
+
+  if (forest->data_fields == NULL) {
+    forest->data_fields = sc_array_new (sizeof (t8_forest_data_field_t));
+  }
+  field = (t8_forest_data_field_t *) sc_array_push (forest->data_fields);
+  field->size = size;
+  field->refine = refine;
+  field->coarsen = coarsen;
+  field->user = user;
+  sc_array_init_size (&field->data, size,
+                      t8_forest_get_local_num_elements (forest)
+                      + t8_forest_get_num_ghosts (forest));
+  memset (field->data.array, 0, field->data.elem_count * size);
+  return (int) forest->data_fields->elem_count - 1;
+}
+
+int
+t8_forest_data_get_num_fields (t8_forest_t forest)
+{
+  T8_ASSERT (forest != NULL);
+
+  return forest->data_fields == NULL ? 0 :
+    (int) forest->data_fields->elem_count;
+}
+
+void               *
+t8_forest_data_get_field (t8_forest_t forest, int ifield)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return t8_forest_data_field (forest, ifield)->data.array;
+}
+
+void
+t8_forest_data_exchange_ghosts (t8_forest_t forest)
+{
+  sc_array_t        **fields;
+  int                 num_fields, ifield;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  num_fields = t8_forest_data_get_num_fields (forest);
+  if (num_fields > 0) {
+    t8_forest_ghost_ensure (forest);
+  }
+  if (num_fields == 0 || forest->ghosts == NULL) {
+    return;
+  }
+  /* All fields are exchanged with one message per process */
+  fields = T8_ALLOC (sc_array_t *, num_fields);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    fields[ifield] = &t8_forest_data_field (forest, ifield)->data;
+  }
+  t8_forest_ghost_exchange_data_fields (forest, num_fields, fields);
+  T8_FREE (fields);
+}
+
+void
+t8_forest_data_copy (t8_forest_t forest, t8_forest_t forest_from, int move)
+{
+  t8_forest_data_field_t *field, *field_from;
+  t8_locidx_t         num_elements;
+  int                 num_fields, ifield;
+
+  num_fields = t8_forest_data_init_fields (forest, forest_from);
+  num_elements = t8_forest_get_local_num_elements (forest_from);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    field = t8_forest_data_field (forest, ifield);
+    field_from = t8_forest_data_field (forest_from, ifield);
+    if (move) {
+      /* Take over the array and drop the ghost entries */
+      field->data = field_from->data;
+      sc_array_init (&field_from->data, field_from->size);
+      sc_array_resize (&field->data, num_elements);
+    }
+    else {
+      sc_array_resize (&field->data, num_elements);
+      memcpy (field->data.array, field_from->data.array,
+              num_elements * field->size);
+    }
+  }
+  if (move && num_fields > 0) {
+    t8_forest_data_destroy (forest_from);
+  }
+}
+
+/* Interpolate one field along one run of the adaptation.
+ * The elements of the forest that was adapted from are not used, since
+ * they may have been moved into the adapted forest. */
+static void
+t8_forest_data_adapt_run (t8_forest_data_field_t * field,
+                          const t8_forest_data_field_t * field_from,
+                          const t8_forest_adapt_run_t * run)
+{
+  const char         *data_old;
+  char               *data_new;
+  const size_t        size = field->size;
+  const t8_locidx_t   count = run->num_per_element;
+  t8_locidx_t         iold, inew, icount;
+
+  data_old = (const char *) field_from->data.array + run->first_old * size;
+  data_new = (char *) field->data.array + run->first_new * size;
+  switch (run->kind) {
+  case T8_FOREST_ADAPT_UNCHANGED:
+    T8_ASSERT (run->num_old == run->num_new);
+    memcpy (data_new, data_old, run->num_old * size);
+    break;
+  case T8_FOREST_ADAPT_REFINED:
+    /* Each old element was replaced by count new elements */
+    for (iold = 0, inew = 0; iold < run->num_old; iold++, inew += count) {
+      T8_ASSERT (inew + count <= run->num_new);
+      if (field->refine != NULL) {
+        field->refine (data_old + iold * size, count,
+                       data_new + inew * size, field->user);
+      }
+      else {
+        for (icount = 0; icount < count; icount++) {
+          memcpy (data_new + (inew + icount) * size, data_old + iold * size,
+                  size);
+        }
+      }
+    }
+    T8_ASSERT (inew == run->num_new);
+    break;
+  case T8_FOREST_ADAPT_COARSENED:
+    /* Each new element replaced count old elements */
+    for (iold = 0, inew = 0; inew < run->num_new; inew++, iold += count) {
+      T8_ASSERT (iold + count <= run->num_old);
+      if (field->coarsen != NULL) {
+        field->coarsen (data_old + iold * size, count,
+                        data_new + inew * size, field->user);
+      }
+      else {
+        memcpy (data_new + inew * size, data_old + iold * size, size);
+      }
+    }
+    T8_ASSERT (iold == run->num_old);
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+void
+t8_forest_data_adapt (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_data_field_t *field;
+  const t8_forest_adapt_run_t *run;
+  size_t              irun;
+  int                 num_fields, ifield;
+
+  num_fields = t8_forest_data_init_fields (forest, forest_from);
+  if (num_fields == 0) {
+    return;
+  }
+  T8_ASSERT (forest->adapt_runs != NULL);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    field = t8_forest_data_field (forest, ifield);
+    sc_array_resize (&field->data, forest->local_num_elements);
+    for (irun = 0; irun < forest->adapt_runs->elem_count; irun++) {
+      run = (const t8_forest_adapt_run_t *)
+        sc_array_index (forest->adapt_runs, irun);
+      t8_forest_data_adapt_run (field,
+                                t8_forest_data_field (forest_from, ifield),
+                                run);
+    }
+  }
+}
+
+sc_array_t         *
+t8_forest_data_partition_begin (t8_forest_t forest, t8_forest_t forest_from)
+{
+  sc_array_t         *views;
+  int                 num_fields, ifield;
+
+  num_fields = t8_forest_data_init_fields (forest, forest_from);
+  if (num_fields == 0) {
+    return NULL;
+  }
+  /* The fields of forest_from also contain the ghost entries, we only
+   * partition the local entries. */
+  views = sc_array_new_count (sizeof (sc_array_t), num_fields);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    sc_array_init_view ((sc_array_t *) sc_array_index_int (views, ifield),
+                        &t8_forest_data_field (forest_from, ifield)->data, 0,
+                        t8_forest_get_local_num_elements (forest_from));
+    t8_forest_set_partition_data (forest, (const sc_array_t *)
+                                  sc_array_index_int (views, ifield),
+                                  &t8_forest_data_field (forest,
+                                                         ifield)->data);
+  }
+  return views;
+}
+
+void
+t8_forest_data_partition_end (t8_forest_t forest, sc_array_t * views)
+{
+  if (views != NULL) {
+    T8_ASSERT ((int) views->elem_count ==
+               t8_forest_data_get_num_fields (forest));
+    sc_array_destroy (views);
+  }
+}
+
+void
+t8_forest_data_ghost (t8_forest_t forest)
+{
+  t8_locidx_t         num_entries;
+  int                 num_fields, ifield;
+
+  num_fields = t8_forest_data_get_num_fields (forest);
+  if (num_fields == 0) {
+    return;
+  }
+  num_entries = t8_forest_get_local_num_elements (forest)
+    + t8_forest_get_num_ghosts (forest);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    sc_array_resize (&t8_forest_data_field (forest, ifield)->data,
+                     num_entries);
+  }
+  t8_forest_data_exchange_ghosts (forest);
+}
+
+void
+t8_forest_data_destroy (t8_forest_t forest)
+{
+  int                 num_fields, ifield;
+
+  num_fields = t8_forest_data_get_num_fields (forest);
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    sc_array_reset (&t8_forest_data_field (forest, ifield)->data);
+  }
+  if (forest->data_fields != NULL) {
+    sc_array_destroy (forest->data_fields);
+    forest->data_fields = NULL;
+  }
+}
+
+T8_EXTERN_C_END ();
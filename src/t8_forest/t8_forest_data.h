@@ -0,0 +1,90 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_data.h
+ * We define routines to carry the registered element data fields of a
+ * forest through the steps of \ref t8_forest_commit.
+ * \see t8_forest_data_add_field
+ */
+
+#ifndef T8_FOREST_DATA_H
+#define T8_FOREST_DATA_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Copy the data fields of a forest with the same local elements.
+ * \param [in,out] forest       A forest with the same local elements as
+ *                              \a forest_from. On output it has the fields
+ *                              of \a forest_from with their local entries.
+ * \param [in,out] forest_from  A committed forest.
+ * \param [in]     move         If true, the data is moved and
+ *                              \a forest_from has no fields afterwards.
+ */
+void                t8_forest_data_copy (t8_forest_t forest,
+                                         t8_forest_t forest_from, int move);
+
+/** Interpolate the data fields of a forest to an adapted forest.
+ * \param [in,out] forest       A forest that was adapted from \a forest_from
+ *                              with recorded adapt runs.
+ * \param [in]     forest_from  A committed forest.
+ */
+void                t8_forest_data_adapt (t8_forest_t forest,
+                                          t8_forest_t forest_from);
+
+/** Register the data fields of a forest to be partitioned with the elements.
+ * Must be called before \ref t8_forest_partition.
+ * \param [in,out] forest       The forest that is partitioned.
+ * \param [in]     forest_from  The committed forest that it is partitioned from.
+ * \return                      Views into the fields of \a forest_from that
+ *                              must be passed to
+ *                              \ref t8_forest_data_partition_end.
+ */
+sc_array_t         *t8_forest_data_partition_begin (t8_forest_t forest,
+                                                    t8_forest_t forest_from);
+
+/** Release the views of \ref t8_forest_data_partition_begin after
+ * \ref t8_forest_partition.
+ * \param [in,out] forest       The partitioned forest.
+ * \param [in,out] views        The return value of
+ *                              \ref t8_forest_data_partition_begin.
+ */
+void                t8_forest_data_partition_end (t8_forest_t forest,
+                                                  sc_array_t * views);
+
+/** Add the ghost entries to the data fields of a forest and fill them.
+ * \param [in,out] forest       A committed forest. If it has a ghost layer,
+ *                              the entries of its ghosts are appended to
+ *                              the fields and exchanged in one pass.
+ */
+void                t8_forest_data_ghost (t8_forest_t forest);
+
+/** Free the data fields of a forest.
+ * \param [in,out] forest       A forest.
+ */
+void                t8_forest_data_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_DATA_H! */
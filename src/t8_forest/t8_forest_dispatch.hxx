@@ -0,0 +1,329 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_dispatch.hxx
+ * Compile-time specialization of element operations for the default schemes.
+ *
+ * Each element operation of a \ref t8_eclass_scheme_c is a virtual function.
+ * In tight loops over the elements of a tree, the virtual dispatch prevents
+ * the compiler from inlining the operations.
+ * Since all trees of one tree class share one scheme, we can determine the
+ * implementation of the scheme once per tree and then run the loop with
+ * non-virtual calls.
+ *
+ * An operation is a class with a member function template
+ *   template < class TScheme > void operator () (TScheme & ts);
+ * where \a TScheme is a \ref t8_scheme_static_c.
+ * \ref t8_forest_dispatch_scheme calls this function with a
+ * t8_scheme_static_c<t8_default_scheme_tri_c> if the scheme is the default
+ * triangle scheme, and so on. If the scheme is not one of the default schemes
+ * (for example a user defined scheme) it calls it with a
+ * t8_scheme_static_c<t8_eclass_scheme_c> that uses the virtual functions.
+ *
+ * Since the dispatch is made for each tree, hybrid forests are specialized
+ * as well.
+ */
+
+#ifndef T8_FOREST_DISPATCH_HXX
+#define T8_FOREST_DISPATCH_HXX
+
+#include <t8.h>
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_common_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_vertex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_line_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_quad_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_tri_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_hex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_cquad_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_chex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_hquad_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_hhex_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_tet_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_prism_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_pyramid_cxx.hxx>
+
+/* Note that the templates in this file cannot have C linkage, thus
+ * we do not wrap them in T8_EXTERN_C_BEGIN/END. */
+
+/** Wrapper around a scheme of a known implementation \a TScheme.
+ * All functions call the corresponding function of \a TScheme with a
+ * qualified name, thus they are not dispatched via the virtual table.
+ * The element functions are a subset of those of \ref t8_eclass_scheme_c,
+ * see there for their documentation.
+ */
+template < class TScheme > class t8_scheme_static_c
+{
+public:
+  /** The wrapped scheme */
+  TScheme            *ts;
+
+  /** Constructor.
+   * \param [in] scheme   The scheme. Its implementation must be \a TScheme.
+   */
+  t8_scheme_static_c (TScheme * scheme):ts (scheme)
+  {
+  }
+
+  /** Return the wrapped scheme as a pointer to its base class. */
+  t8_eclass_scheme_c *get_scheme ()
+  {
+    return ts;
+  }
+
+  int                 level (const t8_element_t * elem)
+  {
+    return ts->TScheme::t8_element_level (elem);
+  }
+
+  int                 num_children (const t8_element_t * elem)
+  {
+    return ts->TScheme::t8_element_num_children (elem);
+  }
+
+  int                 child_id (const t8_element_t * elem)
+  {
+    return ts->TScheme::t8_element_child_id (elem);
+  }
+
+  int                 ancestor_id (const t8_element_t * elem, int level)
+  {
+    return ts->TScheme::t8_element_ancestor_id (elem, level);
+  }
+
+  int                 compare (const t8_element_t * elem1,
+                               const t8_element_t * elem2)
+  {
+    return ts->TScheme::t8_element_compare (elem1, elem2);
+  }
+
+  void                copy (const t8_element_t * source, t8_element_t * dest)
+  {
+    ts->TScheme::t8_element_copy (source, dest);
+  }
+
+  void                parent (const t8_element_t * elem,
+                              t8_element_t * parent)
+  {
+    ts->TScheme::t8_element_parent (elem, parent);
+  }
+
+  void                child (const t8_element_t * elem, int childid,
+                             t8_element_t * child)
+  {
+    ts->TScheme::t8_element_child (elem, childid, child);
+  }
+
+  void                set_linear_id (t8_element_t * elem, int level,
+                                     t8_linearidx_t id)
+  {
+    ts->TScheme::t8_element_set_linear_id (elem, level, id);
+  }
+
+  t8_linearidx_t      get_linear_id (const t8_element_t * elem, int level)
+  {
+    return ts->TScheme::t8_element_get_linear_id (elem, level);
+  }
+
+  void                successor (const t8_element_t * elem,
+                                 t8_element_t * succ, int level)
+  {
+    ts->TScheme::t8_element_successor (elem, succ, level);
+  }
+
+  void                first_descendant (const t8_element_t * elem,
+                                        t8_element_t * desc, int level)
+  {
+    ts->TScheme::t8_element_first_descendant (elem, desc, level);
+  }
+
+  void                last_descendant (const t8_element_t * elem,
+                                       t8_element_t * desc, int level)
+  {
+    ts->TScheme::t8_element_last_descendant (elem, desc, level);
+  }
+};
+
+/** Specialization for schemes of unknown implementation.
+ * All functions are dispatched via the virtual table. */
+template <> class t8_scheme_static_c < t8_eclass_scheme_c >
+{
+public:
+  /** The wrapped scheme */
+  t8_eclass_scheme_c *ts;
+
+  t8_scheme_static_c (t8_eclass_scheme_c * scheme):ts (scheme)
+  {
+  }
+
+  t8_eclass_scheme_c *get_scheme ()
+  {
+    return ts;
+  }
+
+  int                 level (const t8_element_t * elem)
+  {
+    return ts->t8_element_level (elem);
+  }
+
+  int                 num_children (const t8_element_t * elem)
+  {
+    return ts->t8_element_num_children (elem);
+  }
+
+  int                 child_id (const t8_element_t * elem)
+  {
+    return ts->t8_element_child_id (elem);
+  }
+
+  int                 ancestor_id (const t8_element_t * elem, int level)
+  {
+    return ts->t8_element_ancestor_id (elem, level);
+  }
+
+  int                 compare (const t8_element_t * elem1,
+                               const t8_element_t * elem2)
+  {
+    return ts->t8_element_compare (elem1, elem2);
+  }
+
+  void                copy (const t8_element_t * source, t8_element_t * dest)
+  {
+    ts->t8_element_copy (source, dest);
+  }
+
+  void                parent (const t8_element_t * elem,
+                              t8_element_t * parent)
+  {
+    ts->t8_element_parent (elem, parent);
+  }
+
+  void                child (const t8_element_t * elem, int childid,
+                             t8_element_t * child)
+  {
+    ts->t8_element_child (elem, childid, child);
+  }
+
+  void                set_linear_id (t8_element_t * elem, int level,
+                                     t8_linearidx_t id)
+  {
+    ts->t8_element_set_linear_id (elem, level, id);
+  }
+
+  t8_linearidx_t      get_linear_id (const t8_element_t * elem, int level)
+  {
+    return ts->t8_element_get_linear_id (elem, level);
+  }
+
+  void                successor (const t8_element_t * elem,
+                                 t8_element_t * succ, int level)
+  {
+    ts->t8_element_successor (elem, succ, level);
+  }
+
+  void                first_descendant (const t8_element_t * elem,
+                                        t8_element_t * desc, int level)
+  {
+    ts->t8_element_first_descendant (elem, desc, level);
+  }
+
+  void                last_descendant (const t8_element_t * elem,
+                                       t8_element_t * desc, int level)
+  {
+    ts->t8_element_last_descendant (elem, desc, level);
+  }
+};
+
+/* Call op with a static wrapper of ts if ts is of implementation TScheme.
+ * Return true if op was called. */
+template < class TScheme, class TOperation >
+  static inline int
+t8_forest_dispatch_try (t8_eclass_scheme_c * ts, TOperation & op)
+{
+  TScheme            *concrete;
+
+  concrete = dynamic_cast < TScheme * >(ts);
+  if (concrete != NULL) {
+    t8_scheme_static_c < TScheme > static_scheme (concrete);
+    op (static_scheme);
+    return 1;
+  }
+  return 0;
+}
+
+/** Call an operation with a wrapper of a scheme that allows non-virtual calls
+ * of the element functions.
+ * \param [in] ts       An eclass scheme.
+ * \param [in,out] op   The operation, see the description of this file.
+ * If \a ts is one of the default schemes, \a op's operator () is called with
+ * a \ref t8_scheme_static_c of the default scheme's class.
+ * Otherwise, it is called with a t8_scheme_static_c<t8_eclass_scheme_c>.
+ */
+template < class TOperation >
+  static inline void
+t8_forest_dispatch_scheme (t8_eclass_scheme_c * ts, TOperation & op)
+{
+  int                 found = 0;
+
+  T8_ASSERT (ts != NULL);
+  switch (ts->eclass) {
+  case T8_ECLASS_VERTEX:
+    found = t8_forest_dispatch_try < t8_default_scheme_vertex_c > (ts, op);
+    break;
+  case T8_ECLASS_LINE:
+    found = t8_forest_dispatch_try < t8_default_scheme_line_c > (ts, op);
+    break;
+  case T8_ECLASS_QUAD:
+    /* The Hilbert scheme derives from the Morton scheme, thus we must
+     * try it first */
+    found = t8_forest_dispatch_try < t8_default_scheme_hquad_c > (ts, op)
+      || t8_forest_dispatch_try < t8_default_scheme_quad_c > (ts, op)
+      || t8_forest_dispatch_try < t8_default_scheme_cquad_c > (ts, op);
+    break;
+  case T8_ECLASS_TRIANGLE:
+    found = t8_forest_dispatch_try < t8_default_scheme_tri_c > (ts, op);
+    break;
+  case T8_ECLASS_HEX:
+    found = t8_forest_dispatch_try < t8_default_scheme_hhex_c > (ts, op)
+      || t8_forest_dispatch_try < t8_default_scheme_hex_c > (ts, op)
+      || t8_forest_dispatch_try < t8_default_scheme_chex_c > (ts, op);
+    break;
+  case T8_ECLASS_TET:
+    found = t8_forest_dispatch_try < t8_default_scheme_tet_c > (ts, op);
+    break;
+  case T8_ECLASS_PRISM:
+    found = t8_forest_dispatch_try < t8_default_scheme_prism_c > (ts, op);
+    break;
+  case T8_ECLASS_PYRAMID:
+    found = t8_forest_dispatch_try < t8_default_scheme_pyramid_c > (ts, op);
+    break;
+  default:
+    break;
+  }
+  if (!found) {
+    /* This is not a default scheme, use the virtual functions */
+    t8_scheme_static_c < t8_eclass_scheme_c > virtual_scheme (ts);
+    op (virtual_scheme);
+  }
+}
+
+#endif /* !T8_FOREST_DISPATCH_HXX */
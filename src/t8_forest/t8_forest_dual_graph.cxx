@@ -0,0 +1,170 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_dual_graph.cxx
+ * Export the dual graph of a forest to an external graph partitioner and
+ * apply the assignment computed by it.
+ * \see t8_forest_dual_graph
+ */
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+static int
+t8_forest_dual_graph_compare (const void *a, const void *b)
+{
+  const t8_gloidx_t   ida = *(const t8_gloidx_t *) a;
+  const t8_gloidx_t   idb = *(const t8_gloidx_t *) b;
+
+  return ida < idb ? -1 : ida > idb;
+}
+
+t8_locidx_t
+t8_forest_dual_graph (t8_forest_t forest, t8_gloidx_t ** vtxdist,
+                      t8_locidx_t ** xadj, t8_gloidx_t ** adjncy,
+                      t8_locidx_t ** adjwgt)
+{
+  const t8_locidx_t  *face_offsets, *neighbor_offsets, *neighbor_indices;
+  const int          *dual_faces, *orientations;
+  t8_locidx_t         num_local, num_ghosts, lelement, ineigh, first, last;
+  t8_locidx_t         num_edges, iedge, begin, end;
+  t8_gloidx_t         local_num, element_id, *ids;
+  sc_array_t         *global_ids;
+  int                 mpiret, irank;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (vtxdist != NULL && xadj != NULL && adjncy != NULL);
+  SC_CHECK_ABORT (forest->face_connectivity != NULL,
+                  "The dual graph needs the face connectivity.\n");
+
+  num_local = t8_forest_get_face_connectivity (forest, &face_offsets,
+                                               &neighbor_offsets,
+                                               &neighbor_indices,
+                                               &dual_faces, &orientations);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+
+  /* The distribution of the vertices is the element partition */
+  *vtxdist = T8_ALLOC (t8_gloidx_t, forest->mpisize + 1);
+  local_num = num_local;
+  mpiret = sc_MPI_Allgather (&local_num, 1, T8_MPI_GLOIDX, *vtxdist + 1, 1,
+                             T8_MPI_GLOIDX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  (*vtxdist)[0] = 0;
+  for (irank = 0; irank < forest->mpisize; irank++) {
+    (*vtxdist)[irank + 1] += (*vtxdist)[irank];
+  }
+  T8_ASSERT ((*vtxdist)[forest->mpisize] == forest->global_num_elements);
+
+  /* Get the global ids of the ghosts from their owners */
+  global_ids = sc_array_new_count (sizeof (t8_gloidx_t),
+                                   num_local + num_ghosts);
+  ids = (t8_gloidx_t *) global_ids->array;
+  for (lelement = 0; lelement < num_local; lelement++) {
+    ids[lelement] = (*vtxdist)[forest->mpirank] + lelement;
+  }
+  if (forest->ghosts != NULL) {
+    t8_forest_ghost_exchange_data (forest, global_ids);
+  }
+
+  /* Each face neighbor is an edge; multiple faces to the same neighbor are
+   * merged into one edge, whose weight is the number of shared faces. */
+  num_edges = neighbor_offsets[face_offsets[num_local]];
+  *xadj = T8_ALLOC (t8_locidx_t, num_local + 1);
+  *adjncy = T8_ALLOC (t8_gloidx_t, num_edges);
+  if (adjwgt != NULL) {
+    *adjwgt = T8_ALLOC (t8_locidx_t, num_edges);
+  }
+  for (lelement = 0, iedge = 0; lelement < num_local; lelement++) {
+    (*xadj)[lelement] = begin = iedge;
+    first = neighbor_offsets[face_offsets[lelement]];
+    last = neighbor_offsets[face_offsets[lelement + 1]];
+    end = begin + last - first;
+    /* Sort the global ids of all face neighbors of the element */
+    for (ineigh = first; ineigh < last; ineigh++) {
+      T8_ASSERT (0 <= neighbor_indices[ineigh]
+                 && neighbor_indices[ineigh] < num_local + num_ghosts);
+      (*adjncy)[begin + ineigh - first] = ids[neighbor_indices[ineigh]];
+    }
+    qsort (*adjncy + begin, end - begin, sizeof (t8_gloidx_t),
+           t8_forest_dual_graph_compare);
+    /* Remove duplicates and the element itself at periodic boundaries */
+    element_id = ids[lelement];
+    for (ineigh = begin; ineigh < end; ineigh++) {
+      if ((*adjncy)[ineigh] == element_id) {
+        continue;
+      }
+      if (iedge > begin
+          && (*adjncy)[iedge - 1] == (*adjncy)[ineigh]) {
+        if (adjwgt != NULL) {
+          (*adjwgt)[iedge - 1]++;
+        }
+        continue;
+      }
+      (*adjncy)[iedge] = (*adjncy)[ineigh];
+      if (adjwgt != NULL) {
+        (*adjwgt)[iedge] = 1;
+      }
+      iedge++;
+    }
+  }
+  (*xadj)[num_local] = iedge;
+  sc_array_destroy (global_ids);
+
+  return num_local;
+}
+
+void
+t8_forest_partition_offsets_from_assignment (t8_forest_t forest,
+                                             const int *assignment,
+                                             t8_gloidx_t * offsets)
+{
+  t8_locidx_t         num_local, lelement;
+  t8_gloidx_t        *counts;
+  int                 mpiret, irank;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (offsets != NULL);
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  T8_ASSERT (num_local == 0 || assignment != NULL);
+  /* Count the elements that are assigned to each process */
+  counts = T8_ALLOC_ZERO (t8_gloidx_t, forest->mpisize);
+  for (lelement = 0; lelement < num_local; lelement++) {
+    T8_ASSERT (0 <= assignment[lelement]
+               && assignment[lelement] < forest->mpisize);
+    counts[assignment[lelement]]++;
+  }
+  mpiret = sc_MPI_Allreduce (counts, offsets + 1, forest->mpisize,
+                             T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (counts);
+  offsets[0] = 0;
+  for (irank = 0; irank < forest->mpisize; irank++) {
+    offsets[irank + 1] += offsets[irank];
+  }
+  T8_ASSERT (offsets[forest->mpisize] == forest->global_num_elements);
+}
+
+T8_EXTERN_C_END ();
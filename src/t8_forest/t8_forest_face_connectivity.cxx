@@ -0,0 +1,540 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_cmesh.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_partition.h>
+#include <t8_forest/t8_forest_face_connectivity.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_face_connectivity_compute (t8_forest_t forest)
+{
+  t8_forest_face_connectivity_t conn;
+  t8_forest_face_neighbor_workspace_t workspace;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         num_local_trees, itree, num_elements, ielement;
+  t8_locidx_t         lelement, num_faces, iface;
+  const t8_locidx_t  *element_indices;
+  sc_array_t          neighbor_indices, dual_faces;
+  int                 face, num_element_faces, num_neighbors;
+  const int          *neighbor_dual_faces;
+  int                 create_tree_array = 0, create_gfirst_desc_array = 0;
+  int                 create_element_array = 0;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->face_connectivity == NULL);
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL
+                  || t8_forest_get_local_num_elements (forest) == 0,
+                  "The face connectivity needs a ghost layer.\n");
+
+  /* The owner search of the neighbors needs the partition arrays */
+  if (forest->element_offsets == NULL) {
+    create_element_array = 1;
+    t8_forest_partition_create_offsets (forest);
+  }
+  if (forest->tree_offsets == NULL) {
+    create_tree_array = 1;
+    t8_forest_partition_create_tree_offsets (forest);
+  }
+  if (forest->global_first_desc == NULL) {
+    create_gfirst_desc_array = 1;
+    t8_forest_partition_create_first_desc (forest);
+  }
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  conn = forest->face_connectivity =
+    T8_ALLOC_ZERO (t8_forest_face_connectivity_struct_t, 1);
+  conn->num_elements = t8_forest_get_local_num_elements (forest);
+  conn->face_offsets = T8_ALLOC (t8_locidx_t, conn->num_elements + 1);
+
+  /* Count the faces of each element */
+  for (itree = 0, num_faces = 0, lelement = 0; itree < num_local_trees;
+       itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      conn->face_offsets[lelement] = num_faces;
+      num_faces +=
+        ts->t8_element_num_faces (t8_forest_get_element_in_tree
+                                  (forest, itree, ielement));
+    }
+  }
+  T8_ASSERT (lelement == conn->num_elements);
+  conn->face_offsets[conn->num_elements] = num_faces;
+  conn->neighbor_offsets = T8_ALLOC (t8_locidx_t, num_faces + 1);
+  conn->orientations = T8_ALLOC (int, num_faces);
+
+  /* Compute the neighbors of each face */
+  sc_array_init (&neighbor_indices, sizeof (t8_locidx_t));
+  sc_array_init (&dual_faces, sizeof (int));
+  workspace = t8_forest_face_neighbor_workspace_new (forest);
+  for (itree = 0, iface = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      num_element_faces = ts->t8_element_num_faces (element);
+      for (face = 0; face < num_element_faces; face++, iface++) {
+        conn->neighbor_offsets[iface] = neighbor_indices.elem_count;
+        conn->orientations[iface] =
+          t8_forest_leaf_face_orientation (forest, itree, element, face);
+        num_neighbors =
+          t8_forest_leaf_face_neighbors_workspace (forest, itree, element,
+                                                   face, workspace, NULL,
+                                                   &neighbor_dual_faces,
+                                                   &element_indices, NULL,
+                                                   1);
+        if (num_neighbors > 0) {
+          /* Append the neighbors of this face */
+          memcpy (sc_array_push_count (&neighbor_indices, num_neighbors),
+                  element_indices, num_neighbors * sizeof (t8_locidx_t));
+          memcpy (sc_array_push_count (&dual_faces, num_neighbors),
+                  neighbor_dual_faces, num_neighbors * sizeof (int));
+        }
+      }
+    }
+  }
+  t8_forest_face_neighbor_workspace_destroy (&workspace);
+  T8_ASSERT (iface == num_faces);
+  conn->neighbor_offsets[num_faces] = neighbor_indices.elem_count;
+
+  /* Copy the neighbors to arrays of the exact size */
+  conn->neighbor_indices =
+    T8_ALLOC (t8_locidx_t, neighbor_indices.elem_count);
+  memcpy (conn->neighbor_indices, neighbor_indices.array,
+          neighbor_indices.elem_count * sizeof (t8_locidx_t));
+  conn->dual_faces = T8_ALLOC (int, dual_faces.elem_count);
+  memcpy (conn->dual_faces, dual_faces.array,
+          dual_faces.elem_count * sizeof (int));
+  sc_array_reset (&neighbor_indices);
+  sc_array_reset (&dual_faces);
+
+  if (create_element_array) {
+    t8_shmem_array_destroy (&forest->element_offsets);
+  }
+  if (create_tree_array) {
+    t8_shmem_array_destroy (&forest->tree_offsets);
+  }
+  if (create_gfirst_desc_array) {
+    t8_shmem_array_destroy (&forest->global_first_desc);
+  }
+}
+
+void
+t8_forest_face_connectivity_destroy (t8_forest_t forest)
+{
+  t8_forest_face_connectivity_t conn;
+
+  T8_ASSERT (forest != NULL);
+  conn = forest->face_connectivity;
+  if (conn == NULL) {
+    return;
+  }
+  T8_FREE (conn->face_offsets);
+  T8_FREE (conn->neighbor_offsets);
+  T8_FREE (conn->neighbor_indices);
+  T8_FREE (conn->dual_faces);
+  T8_FREE (conn->orientations);
+  T8_FREE (conn);
+  forest->face_connectivity = NULL;
+}
+
+int
+t8_forest_has_face_connectivity (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->face_connectivity != NULL;
+}
+
+int
+t8_forest_element_cached_face_neighbors (t8_forest_t forest,
+                                         t8_locidx_t ltreeid,
+                                         t8_locidx_t leid_in_tree, int face,
+                                         const t8_locidx_t **
+                                         neighbor_indices,
+                                         const int **dual_faces,
+                                         int *orientation)
+{
+  t8_forest_face_connectivity_t conn;
+  t8_locidx_t         lelement, iface;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->face_connectivity != NULL);
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (0 <= leid_in_tree
+             && leid_in_tree < t8_forest_get_tree_num_elements (forest,
+                                                                ltreeid));
+
+  conn = forest->face_connectivity;
+  lelement = t8_forest_get_tree_element_offset (forest, ltreeid)
+    + leid_in_tree;
+  T8_ASSERT (0 <= face && face < conn->face_offsets[lelement + 1]
+             - conn->face_offsets[lelement]);
+  iface = conn->face_offsets[lelement] + face;
+
+  if (neighbor_indices != NULL) {
+    *neighbor_indices = conn->neighbor_indices + conn->neighbor_offsets[iface];
+  }
+  if (dual_faces != NULL) {
+    *dual_faces = conn->dual_faces + conn->neighbor_offsets[iface];
+  }
+  if (orientation != NULL) {
+    *orientation = conn->orientations[iface];
+  }
+  return conn->neighbor_offsets[iface + 1] - conn->neighbor_offsets[iface];
+}
+
+t8_locidx_t
+t8_forest_get_face_connectivity (t8_forest_t forest,
+                                 const t8_locidx_t ** face_offsets,
+                                 const t8_locidx_t ** neighbor_offsets,
+                                 const t8_locidx_t ** neighbor_indices,
+                                 const int **dual_faces,
+                                 const int **orientations)
+{
+  t8_forest_face_connectivity_t conn;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->face_connectivity != NULL);
+
+  conn = forest->face_connectivity;
+  *face_offsets = conn->face_offsets;
+  *neighbor_offsets = conn->neighbor_offsets;
+  *neighbor_indices = conn->neighbor_indices;
+  *dual_faces = conn->dual_faces;
+  *orientations = conn->orientations;
+  return conn->num_elements;
+}
+
+/* Append a face pair to a face list */
+static void
+t8_forest_face_list_push (sc_array_t * face_list, t8_locidx_t element,
+                          int face, t8_locidx_t neighbor, int dual_face,
+                          int subface)
+{
+  t8_forest_face_pair_t *pair;
+
+  pair = (t8_forest_face_pair_t *) sc_array_push (face_list);
+  pair->elements[0] = element;
+  pair->faces[0] = face;
+  pair->elements[1] = neighbor;
+  pair->faces[1] = dual_face;
+  pair->subface = subface;
+}
+
+t8_locidx_t
+t8_forest_face_list (t8_forest_t forest, sc_array_t * face_list)
+{
+  t8_forest_face_connectivity_t conn;
+  t8_locidx_t         lelement, neighbor, iface, ineigh, neigh_iface;
+  int                 face, num_neighbors, num_dual_neighbors, isub;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (face_list != NULL
+             && face_list->elem_size == sizeof (t8_forest_face_pair_t));
+  SC_CHECK_ABORT (forest->face_connectivity != NULL,
+                  "The face list needs the face connectivity.\n");
+
+  conn = forest->face_connectivity;
+  sc_array_truncate (face_list);
+  for (lelement = 0; lelement < conn->num_elements; lelement++) {
+    for (iface = conn->face_offsets[lelement], face = 0;
+         iface < conn->face_offsets[lelement + 1]; iface++, face++) {
+      ineigh = conn->neighbor_offsets[iface];
+      num_neighbors = conn->neighbor_offsets[iface + 1] - ineigh;
+      if (num_neighbors == 0) {
+        /* A face at the domain boundary */
+        t8_forest_face_list_push (face_list, lelement, face, -1, -1, -1);
+      }
+      else if (num_neighbors == 1) {
+        neighbor = conn->neighbor_indices[ineigh];
+        if (neighbor < conn->num_elements) {
+          /* A local neighbor of the same size lists the face if it has the
+           * smaller index, a larger local neighbor does not list it. */
+          neigh_iface = conn->face_offsets[neighbor]
+            + conn->dual_faces[ineigh];
+          num_dual_neighbors = conn->neighbor_offsets[neigh_iface + 1]
+            - conn->neighbor_offsets[neigh_iface];
+          if (num_dual_neighbors == 1 && neighbor < lelement) {
+            continue;
+          }
+        }
+        t8_forest_face_list_push (face_list, lelement, face, neighbor,
+                                  conn->dual_faces[ineigh], -1);
+      }
+      else {
+        /* A hanging face. The smaller local neighbors list their faces,
+         * we list the faces to the smaller ghosts. */
+        for (isub = 0; isub < num_neighbors; isub++) {
+          neighbor = conn->neighbor_indices[ineigh + isub];
+          if (neighbor >= conn->num_elements) {
+            t8_forest_face_list_push (face_list, lelement, face, neighbor,
+                                      conn->dual_faces[ineigh + isub], isub);
+          }
+        }
+      }
+    }
+  }
+  return (t8_locidx_t) face_list->elem_count;
+}
+
+/* A local smaller side of a mortar whose larger element is a ghost */
+typedef struct t8_forest_mortar_side
+{
+  t8_locidx_t         big_element;
+  int                 big_face;
+  int                 orientation;
+  int                 subface;
+  t8_locidx_t         small_element;
+  int                 small_face;
+} t8_forest_mortar_side_t;
+
+/* Sort the sides by their mortar and by their position in the big face */
+static int
+t8_forest_mortar_side_compare (const void *side_a, const void *side_b)
+{
+  const t8_forest_mortar_side_t *a = (const t8_forest_mortar_side_t *) side_a;
+  const t8_forest_mortar_side_t *b = (const t8_forest_mortar_side_t *) side_b;
+
+  if (a->big_element != b->big_element) {
+    return a->big_element < b->big_element ? -1 : 1;
+  }
+  if (a->big_face != b->big_face) {
+    return a->big_face - b->big_face;
+  }
+  return a->subface - b->subface;
+}
+
+/* Return the face child of the face \a big_face of a coarser neighbor of
+ * level \a big_level that contains the face \a face of a leaf. */
+static int
+t8_forest_mortar_subface (t8_forest_t forest, t8_locidx_t ltreeid,
+                          const t8_element_t * leaf, int face, int big_face,
+                          int big_level)
+{
+  t8_eclass_scheme_c *neigh_scheme;
+  t8_element_t       *neigh, *big;
+  t8_element_t       *face_children[T8_ECLASS_MAX_CHILDREN];
+  int                 child_indices[T8_ECLASS_MAX_CHILDREN];
+  int                 num_face_children, child_id, isub, dual_face;
+
+  neigh_scheme =
+    t8_forest_get_eclass_scheme (forest,
+                                 t8_forest_element_neighbor_eclass (forest,
+                                                                    ltreeid,
+                                                                    leaf,
+                                                                    face));
+  neigh_scheme->t8_element_new (1, &neigh);
+  neigh_scheme->t8_element_new (1, &big);
+  /* The same level neighbor of the leaf lies inside the coarser neighbor,
+   * its ancestor one level finer than the coarser neighbor is a child at
+   * the big face. */
+  (void) t8_forest_element_face_neighbor (forest, ltreeid, leaf, neigh,
+                                          neigh_scheme, face, &dual_face);
+  while (neigh_scheme->t8_element_level (neigh) > big_level + 1) {
+    neigh_scheme->t8_element_parent (neigh, neigh);
+  }
+  child_id = neigh_scheme->t8_element_child_id (neigh);
+  neigh_scheme->t8_element_parent (neigh, big);
+  num_face_children =
+    neigh_scheme->t8_element_num_face_children (big, big_face);
+  T8_ASSERT (num_face_children <= T8_ECLASS_MAX_CHILDREN);
+  neigh_scheme->t8_element_new (num_face_children, face_children);
+  neigh_scheme->t8_element_children_at_face (big, big_face, face_children,
+                                             num_face_children,
+                                             child_indices);
+  for (isub = 0; isub < num_face_children; isub++) {
+    if (child_indices[isub] == child_id) {
+      break;
+    }
+  }
+  T8_ASSERT (isub < num_face_children);
+  neigh_scheme->t8_element_destroy (num_face_children, face_children);
+  neigh_scheme->t8_element_destroy (1, &big);
+  neigh_scheme->t8_element_destroy (1, &neigh);
+  return isub;
+}
+
+/* Copy the entries of an array to an array of the exact size and reset it */
+static void        *
+t8_forest_mortars_copy_array (sc_array_t * array)
+{
+  char               *copy;
+
+  copy = T8_ALLOC (char, array->elem_count * array->elem_size);
+  memcpy (copy, array->array, array->elem_count * array->elem_size);
+  sc_array_reset (array);
+  return copy;
+}
+
+t8_forest_mortars_t
+t8_forest_mortars_new (t8_forest_t forest)
+{
+  t8_forest_face_connectivity_t conn;
+  t8_forest_mortars_t mortars;
+  t8_forest_mortar_side_t *side;
+  const t8_element_t *element;
+  sc_array_t          big_elements, big_faces, orientations, small_offsets;
+  sc_array_t          small_elements, small_faces, subfaces, ghost_sides;
+  t8_locidx_t         num_local_trees, itree, num_elements, ielement;
+  t8_locidx_t         lelement, iface, ineigh, neighbor, iside;
+  int8_t             *levels;
+  int                 face, num_neighbors, isub;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  SC_CHECK_ABORT (forest->face_connectivity != NULL,
+                  "The mortars need the face connectivity.\n");
+
+  conn = forest->face_connectivity;
+  levels = T8_ALLOC (int8_t, conn->num_elements
+                     + t8_forest_get_num_ghosts (forest));
+  t8_forest_element_levels (forest, levels);
+  sc_array_init (&big_elements, sizeof (t8_locidx_t));
+  sc_array_init (&big_faces, sizeof (int));
+  sc_array_init (&orientations, sizeof (int));
+  sc_array_init (&small_offsets, sizeof (t8_locidx_t));
+  sc_array_init (&small_elements, sizeof (t8_locidx_t));
+  sc_array_init (&small_faces, sizeof (int));
+  sc_array_init (&subfaces, sizeof (int));
+  sc_array_init (&ghost_sides, sizeof (t8_forest_mortar_side_t));
+
+  /* A face with finer neighbors is a mortar with a local big side.
+   * A face with a coarser ghost neighbor is a small side of a mortar
+   * whose big side is the ghost. */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, lelement = 0; itree < num_local_trees; itree++) {
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      for (iface = conn->face_offsets[lelement], face = 0;
+           iface < conn->face_offsets[lelement + 1]; iface++, face++) {
+        ineigh = conn->neighbor_offsets[iface];
+        num_neighbors = conn->neighbor_offsets[iface + 1] - ineigh;
+        if (num_neighbors > 1 || (num_neighbors == 1
+                                  && levels[conn->neighbor_indices[ineigh]]
+                                  > levels[lelement])) {
+          *(t8_locidx_t *) sc_array_push (&big_elements) = lelement;
+          *(int *) sc_array_push (&big_faces) = face;
+          *(int *) sc_array_push (&orientations) = conn->orientations[iface];
+          *(t8_locidx_t *) sc_array_push (&small_offsets) =
+            small_elements.elem_count;
+          /* The neighbors are in the order of the face children */
+          for (isub = 0; isub < num_neighbors; isub++) {
+            *(t8_locidx_t *) sc_array_push (&small_elements) =
+              conn->neighbor_indices[ineigh + isub];
+            *(int *) sc_array_push (&small_faces) =
+              conn->dual_faces[ineigh + isub];
+            *(int *) sc_array_push (&subfaces) = isub;
+          }
+        }
+        else if (num_neighbors == 1) {
+          neighbor = conn->neighbor_indices[ineigh];
+          if (neighbor < conn->num_elements
+              || levels[neighbor] >= levels[lelement]) {
+            /* A conforming face or a local big side that lists it */
+            continue;
+          }
+          element = t8_forest_get_element_in_tree (forest, itree, ielement);
+          side = (t8_forest_mortar_side_t *) sc_array_push (&ghost_sides);
+          side->big_element = neighbor;
+          side->big_face = conn->dual_faces[ineigh];
+          side->orientation = conn->orientations[iface];
+          side->subface =
+            t8_forest_mortar_subface (forest, itree, element, face,
+                                      side->big_face, levels[neighbor]);
+          side->small_element = lelement;
+          side->small_face = face;
+        }
+      }
+    }
+  }
+  T8_ASSERT (lelement == conn->num_elements);
+
+  /* Group the small sides of the ghost mortars, these follow the local
+   * mortars since the ghosts are indexed after the local elements. */
+  sc_array_sort (&ghost_sides, t8_forest_mortar_side_compare);
+  for (iside = 0; iside < (t8_locidx_t) ghost_sides.elem_count; iside++) {
+    side = (t8_forest_mortar_side_t *) sc_array_index (&ghost_sides, iside);
+    if (iside == 0 || side[-1].big_element != side->big_element
+        || side[-1].big_face != side->big_face) {
+      *(t8_locidx_t *) sc_array_push (&big_elements) = side->big_element;
+      *(int *) sc_array_push (&big_faces) = side->big_face;
+      *(int *) sc_array_push (&orientations) = side->orientation;
+      *(t8_locidx_t *) sc_array_push (&small_offsets) =
+        small_elements.elem_count;
+    }
+    *(t8_locidx_t *) sc_array_push (&small_elements) = side->small_element;
+    *(int *) sc_array_push (&small_faces) = side->small_face;
+    *(int *) sc_array_push (&subfaces) = side->subface;
+  }
+  *(t8_locidx_t *) sc_array_push (&small_offsets) = small_elements.elem_count;
+
+  /* Copy the arrays to the mortars */
+  mortars = T8_ALLOC (t8_forest_mortars_struct_t, 1);
+  mortars->num_mortars = big_elements.elem_count;
+  mortars->big_elements =
+    (t8_locidx_t *) t8_forest_mortars_copy_array (&big_elements);
+  mortars->big_faces = (int *) t8_forest_mortars_copy_array (&big_faces);
+  mortars->orientations =
+    (int *) t8_forest_mortars_copy_array (&orientations);
+  mortars->small_offsets =
+    (t8_locidx_t *) t8_forest_mortars_copy_array (&small_offsets);
+  mortars->small_elements =
+    (t8_locidx_t *) t8_forest_mortars_copy_array (&small_elements);
+  mortars->small_faces = (int *) t8_forest_mortars_copy_array (&small_faces);
+  mortars->subfaces = (int *) t8_forest_mortars_copy_array (&subfaces);
+  sc_array_reset (&ghost_sides);
+  T8_FREE (levels);
+  return mortars;
+}
+
+void
+t8_forest_mortars_destroy (t8_forest_mortars_t * pmortars)
+{
+  t8_forest_mortars_t mortars;
+
+  T8_ASSERT (pmortars != NULL && *pmortars != NULL);
+  mortars = *pmortars;
+  T8_FREE (mortars->big_elements);
+  T8_FREE (mortars->big_faces);
+  T8_FREE (mortars->orientations);
+  T8_FREE (mortars->small_offsets);
+  T8_FREE (mortars->small_elements);
+  T8_FREE (mortars->small_faces);
+  T8_FREE (mortars->subfaces);
+  T8_FREE (mortars);
+  *pmortars = NULL;
+}
+
+T8_EXTERN_C_END ();
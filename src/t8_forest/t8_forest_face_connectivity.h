@@ -0,0 +1,52 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_face_connectivity.h
+ * We define routines to compute and store the face neighbors of the
+ * local elements of a forest.
+ * \see t8_forest_set_face_connectivity
+ */
+
+#ifndef T8_FOREST_FACE_CONNECTIVITY_H
+#define T8_FOREST_FACE_CONNECTIVITY_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the face connectivity of a forest.
+ * \param [in,out] forest       A balanced forest with local elements,
+ *                              computed tree element offsets and, if it has
+ *                              more than one process, a ghost layer.
+ *                              On output its face connectivity is set.
+ */
+void                t8_forest_face_connectivity_compute (t8_forest_t forest);
+
+/** Free the memory of the face connectivity of a forest, if it has one.
+ * \param [in,out] forest       A forest. On output its face connectivity is NULL.
+ */
+void                t8_forest_face_connectivity_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_FACE_CONNECTIVITY_H! */
@@ -0,0 +1,324 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_geometry_cache.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* Compute the face geometry of the element with local index lelement
+ * and store it in the cache. The face offsets must already be set. */
+static void
+t8_forest_geometry_cache_compute_faces (t8_forest_t forest,
+                                        t8_forest_geometry_cache_t cache,
+                                        t8_locidx_t ltreeid,
+                                        const t8_element_t * element,
+                                        const double *tree_vertices,
+                                        t8_locidx_t lelement)
+{
+  t8_locidx_t         iface;
+  int                 face;
+
+  for (iface = cache->face_offsets[lelement], face = 0;
+       iface < cache->face_offsets[lelement + 1]; iface++, face++) {
+    cache->face_areas[iface] =
+      t8_forest_element_face_area (forest, ltreeid, element, face,
+                                   tree_vertices);
+    t8_forest_element_face_normal (forest, ltreeid, element, face,
+                                   tree_vertices,
+                                   cache->face_normals + 3 * iface);
+    t8_forest_element_face_centroid (forest, ltreeid, element, face,
+                                     tree_vertices,
+                                     cache->face_centroids + 3 * iface);
+  }
+}
+
+/* Compute the geometry of the element with local index lelement
+ * and store it in the cache. The face offsets must already be set. */
+static void
+t8_forest_geometry_cache_compute_element (t8_forest_t forest,
+                                          t8_forest_geometry_cache_t cache,
+                                          t8_locidx_t ltreeid,
+                                          const t8_element_t * element,
+                                          const double *tree_vertices,
+                                          t8_locidx_t lelement)
+{
+  t8_forest_element_centroid (forest, ltreeid, element, tree_vertices,
+                              cache->centroids + 3 * lelement);
+  cache->volumes[lelement] =
+    t8_forest_element_volume (forest, ltreeid, element, tree_vertices);
+  t8_forest_geometry_cache_compute_faces (forest, cache, ltreeid, element,
+                                          tree_vertices, lelement);
+}
+
+/* Copy the geometry of the element with local index lelement_from
+ * in the cache of forest_from to the entry lelement in cache. */
+static void
+t8_forest_geometry_cache_copy_element (t8_forest_geometry_cache_t cache,
+                                       t8_locidx_t lelement,
+                                       const t8_forest_geometry_cache_t
+                                       cache_from, t8_locidx_t lelement_from)
+{
+  t8_locidx_t         first_face, first_face_from, num_faces;
+
+  first_face = cache->face_offsets[lelement];
+  first_face_from = cache_from->face_offsets[lelement_from];
+  num_faces = cache->face_offsets[lelement + 1] - first_face;
+  T8_ASSERT (num_faces ==
+             cache_from->face_offsets[lelement_from + 1] - first_face_from);
+
+  memcpy (cache->centroids + 3 * lelement,
+          cache_from->centroids + 3 * lelement_from, 3 * sizeof (double));
+  cache->volumes[lelement] = cache_from->volumes[lelement_from];
+  memcpy (cache->face_areas + first_face,
+          cache_from->face_areas + first_face_from,
+          num_faces * sizeof (double));
+  memcpy (cache->face_normals + 3 * first_face,
+          cache_from->face_normals + 3 * first_face_from,
+          3 * num_faces * sizeof (double));
+  memcpy (cache->face_centroids + 3 * first_face,
+          cache_from->face_centroids + 3 * first_face_from,
+          3 * num_faces * sizeof (double));
+}
+
+void
+t8_forest_geometry_cache_compute (t8_forest_t forest, t8_forest_t forest_from)
+{
+  t8_forest_geometry_cache_t cache;
+  t8_element_array_t *elements, *elements_from;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  const double       *tree_vertices;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_elements, ielement, lelement;
+  t8_locidx_t         num_elements_from, ielement_from, offset_from;
+  t8_locidx_t         num_faces;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->geometry_cache == NULL);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  if (forest_from != NULL) {
+    T8_ASSERT (t8_forest_is_committed (forest_from));
+    T8_ASSERT (forest_from->geometry_cache != NULL);
+    /* We can only reuse the data if both forests have the same local trees,
+     * which is the case for adapted forests. */
+    if (forest_from->first_local_tree != forest->first_local_tree
+        || t8_forest_get_num_local_trees (forest_from) != num_local_trees) {
+      forest_from = NULL;
+    }
+  }
+
+  cache = forest->geometry_cache =
+    T8_ALLOC_ZERO (t8_forest_geometry_cache_struct_t, 1);
+  cache->num_elements = t8_forest_get_local_num_elements (forest);
+  cache->centroids = T8_ALLOC (double, 3 * cache->num_elements);
+  cache->volumes = T8_ALLOC (double, cache->num_elements);
+  cache->face_offsets = T8_ALLOC (t8_locidx_t, cache->num_elements + 1);
+
+  /* Count the faces of each element */
+  for (itree = 0, num_faces = 0, lelement = 0; itree < num_local_trees;
+       itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      cache->face_offsets[lelement] = num_faces;
+      num_faces +=
+        ts->t8_element_num_faces (t8_element_array_index_locidx
+                                  (elements, ielement));
+    }
+  }
+  T8_ASSERT (lelement == cache->num_elements);
+  cache->face_offsets[cache->num_elements] = num_faces;
+  cache->face_areas = T8_ALLOC (double, num_faces);
+  cache->face_normals = T8_ALLOC (double, 3 * num_faces);
+  cache->face_centroids = T8_ALLOC (double, 3 * num_faces);
+
+  for (itree = 0, lelement = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    if (forest_from != NULL) {
+      elements_from = t8_forest_get_tree_element_array (forest_from, itree);
+      num_elements_from =
+        t8_forest_get_tree_num_elements (forest_from, itree);
+      offset_from = t8_forest_get_tree_element_offset (forest_from, itree);
+    }
+    else {
+      /* Nothing to reuse, we compute the centroids and volumes of the
+       * whole tree at once and only the faces element by element. */
+      t8_forest_tree_element_centroids (forest, itree,
+                                        cache->centroids + 3 * lelement);
+      t8_forest_tree_element_volumes (forest, itree,
+                                      cache->volumes + lelement);
+      for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+        element = t8_element_array_index_locidx (elements, ielement);
+        t8_forest_geometry_cache_compute_faces (forest, cache, itree,
+                                                element, tree_vertices,
+                                                lelement);
+      }
+      continue;
+    }
+    ielement_from = 0;
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      element = t8_element_array_index_locidx (elements, ielement);
+      /* Both element arrays are sorted. We skip the elements of the old tree
+       * that are smaller than the current element and check whether the
+       * next one is the current element. */
+      while (ielement_from < num_elements_from
+             && ts->t8_element_compare (t8_element_array_index_locidx
+                                        (elements_from, ielement_from),
+                                        element) < 0) {
+        ielement_from++;
+      }
+      if (ielement_from < num_elements_from
+          && !ts->t8_element_compare (t8_element_array_index_locidx
+                                      (elements_from, ielement_from),
+                                      element)) {
+        /* The element did not change */
+        t8_forest_geometry_cache_copy_element (cache, lelement,
+                                               forest_from->geometry_cache,
+                                               offset_from + ielement_from);
+      }
+      else {
+        t8_forest_geometry_cache_compute_element (forest, cache, itree,
+                                                  element, tree_vertices,
+                                                  lelement);
+      }
+    }
+  }
+}
+
+void
+t8_forest_geometry_cache_destroy (t8_forest_t forest)
+{
+  t8_forest_geometry_cache_t cache;
+
+  T8_ASSERT (forest != NULL);
+  cache = forest->geometry_cache;
+  if (cache == NULL) {
+    return;
+  }
+  T8_FREE (cache->centroids);
+  T8_FREE (cache->volumes);
+  T8_FREE (cache->face_offsets);
+  T8_FREE (cache->face_areas);
+  T8_FREE (cache->face_normals);
+  T8_FREE (cache->face_centroids);
+  T8_FREE (cache);
+  forest->geometry_cache = NULL;
+}
+
+int
+t8_forest_has_geometry_cache (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->geometry_cache != NULL;
+}
+
+/* Return the local index of an element of a local tree */
+static              t8_locidx_t
+t8_forest_geometry_cache_index (t8_forest_t forest, t8_locidx_t ltreeid,
+                                t8_locidx_t leid_in_tree)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->geometry_cache != NULL);
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (0 <= leid_in_tree
+             && leid_in_tree < t8_forest_get_tree_num_elements (forest,
+                                                                ltreeid));
+
+  return t8_forest_get_tree_element_offset (forest, ltreeid) + leid_in_tree;
+}
+
+/* Return the index of a face of an element in the face arrays */
+static              t8_locidx_t
+t8_forest_geometry_cache_face_index (t8_forest_t forest, t8_locidx_t ltreeid,
+                                     t8_locidx_t leid_in_tree, int face)
+{
+  t8_locidx_t         lelement;
+
+  lelement = t8_forest_geometry_cache_index (forest, ltreeid, leid_in_tree);
+  T8_ASSERT (0 <= face
+             && face < forest->geometry_cache->face_offsets[lelement + 1]
+             - forest->geometry_cache->face_offsets[lelement]);
+
+  return forest->geometry_cache->face_offsets[lelement] + face;
+}
+
+const double       *
+t8_forest_element_cached_centroid (t8_forest_t forest, t8_locidx_t ltreeid,
+                                   t8_locidx_t leid_in_tree)
+{
+  return forest->geometry_cache->centroids +
+    3 * t8_forest_geometry_cache_index (forest, ltreeid, leid_in_tree);
+}
+
+double
+t8_forest_element_cached_volume (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 t8_locidx_t leid_in_tree)
+{
+  return forest->geometry_cache->volumes
+    [t8_forest_geometry_cache_index (forest, ltreeid, leid_in_tree)];
+}
+
+double
+t8_forest_element_cached_face_area (t8_forest_t forest, t8_locidx_t ltreeid,
+                                    t8_locidx_t leid_in_tree, int face)
+{
+  return forest->geometry_cache->face_areas
+    [t8_forest_geometry_cache_face_index
+     (forest, ltreeid, leid_in_tree, face)];
+}
+
+const double       *
+t8_forest_element_cached_face_normal (t8_forest_t forest,
+                                      t8_locidx_t ltreeid,
+                                      t8_locidx_t leid_in_tree, int face)
+{
+  return forest->geometry_cache->face_normals +
+    3 * t8_forest_geometry_cache_face_index (forest, ltreeid, leid_in_tree,
+                                             face);
+}
+
+const double       *
+t8_forest_element_cached_face_centroid (t8_forest_t forest,
+                                        t8_locidx_t ltreeid,
+                                        t8_locidx_t leid_in_tree, int face)
+{
+  return forest->geometry_cache->face_centroids +
+    3 * t8_forest_geometry_cache_face_index (forest, ltreeid, leid_in_tree,
+                                             face);
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,57 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_geometry_cache.h
+ * We define routines to compute and store the centroids, volumes and face
+ * data of the local elements of a forest.
+ * \see t8_forest_set_geometry_cache
+ */
+
+#ifndef T8_FOREST_GEOMETRY_CACHE_H
+#define T8_FOREST_GEOMETRY_CACHE_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the geometry cache of a forest.
+ * \param [in,out] forest       A forest with local elements and computed
+ *                              tree element offsets. On output its geometry
+ *                              cache is set.
+ * \param [in]     forest_from  If not NULL, a committed forest with geometry
+ *                              cache from which \a forest was adapted.
+ *                              The data of the elements that did not change
+ *                              is copied from its cache.
+ */
+void                t8_forest_geometry_cache_compute (t8_forest_t forest,
+                                                      t8_forest_t
+                                                      forest_from);
+
+/** Free the memory of the geometry cache of a forest, if it has one.
+ * \param [in,out] forest       A forest. On output its geometry cache is NULL.
+ */
+void                t8_forest_geometry_cache_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_GEOMETRY_CACHE_H! */
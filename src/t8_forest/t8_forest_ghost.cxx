@@ -25,6 +25,8 @@
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_private.h>
 #include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_trace.h>
 #include <t8_forest.h>
 #include <t8_cmesh/t8_cmesh_trees.h>
 #include <t8_element_cxx.hxx>
@@ -33,6 +35,18 @@
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
+#if defined (SC_ENABLE_MPI) && defined (SC_ENABLE_MPIWINSHARED)
+/* Ghost data can be exchanged via shared memory between the processes
+ * of a node */
+#define T8_GHOST_ENABLE_SHMEM
+/* Ghost data can be exchanged with MPI-3 one-sided communication */
+#define T8_GHOST_ENABLE_RMA
+#endif
+
+/* The number of elements whose half face neighbors are computed at once
+ * when filling the remote ghosts */
+#define T8_GHOST_HALF_NEIGHBORS_CHUNK 256
+
 /* The information for a remote process, what data
  * we have to send to them.
  */
@@ -50,6 +64,7 @@ typedef struct
   t8_gloidx_t         global_id;        /* global id of the tree */
   t8_locidx_t         element_offset;   /* The count of all ghost elements in all smaller ghost trees */
   t8_element_array_t  elements; /* The ghost elements of that tree */
+  t8_element_array_soa_t soa;   /* The levels and linear ids of the ghost elements */
   t8_eclass_t         eclass;   /* The trees element class */
 } t8_ghost_tree_t;
 
@@ -180,29 +195,106 @@ t8_ghost_remote_equal_function (const void *remote_dataa,
   return remotea->remote_rank == remoteb->remote_rank;
 }
 
+/* Compare two global tree entries by their global id. */
+static int
+t8_ghost_gtree_compare (const void *ghost_gtreea, const void *ghost_gtreeb)
+{
+  const t8_ghost_gtree_hash_t *objecta =
+    (const t8_ghost_gtree_hash_t *) ghost_gtreea;
+  const t8_ghost_gtree_hash_t *objectb =
+    (const t8_ghost_gtree_hash_t *) ghost_gtreeb;
+
+  return (objecta->global_id > objectb->global_id)
+    - (objecta->global_id < objectb->global_id);
+}
+
+/* Compare two process offset entries by their rank. */
+static int
+t8_ghost_process_compare (const void *process_dataa,
+                          const void *process_datab)
+{
+  return sc_int_compare (&((const t8_ghost_process_hash_t *)
+                           process_dataa)->mpirank,
+                         &((const t8_ghost_process_hash_t *)
+                           process_datab)->mpirank);
+}
+
+/* Compare two remote entries by their rank. */
+static int
+t8_ghost_remote_compare (const void *remote_dataa, const void *remote_datab)
+{
+  return sc_int_compare (&((const t8_ghost_remote_t *)
+                           remote_dataa)->remote_rank,
+                         &((const t8_ghost_remote_t *)
+                           remote_datab)->remote_rank);
+}
+
 /** This struct is used during a ghost data exchange.
  * Since we use asynchronuous communication, we store the
  * send buffers and mpi requests until we end the communication.
  */
-typedef struct
+typedef struct t8_ghost_data_exchange
 {
+  t8_forest_t         forest;
+                    /** The forest whose ghost data is exchanged */
   int                 num_remotes;
                     /** The number of processes, we send to */
   char              **send_buffers;
-                      /** For each remote the send buffer */
+                      /** For each remote the send buffer, NULL if the data
+                          is sent directly from the element data */
   sc_MPI_Request     *send_requests;
                            /** For each process we send to, the MPI request used */
   sc_MPI_Request     *recv_requests;
                            /** For each process we receive from, the MPI request used */
+#ifdef T8_GHOST_ENABLE_SHMEM
+  sc_MPI_Comm         intranode;
+                         /** The communicator of the processes of our node if
+                             the data is exchanged via shared memory,
+                             sc_MPI_COMM_NULL otherwise */
+  MPI_Win             window;
+                    /** The shared window in which we store the data for the
+                        remotes on our node */
+  int                 mpirank;
+                    /** Our rank in the forest's communicator */
+  int                 num_shared;
+                       /** The number of remotes on our node */
+  int                *shared_ranks;
+                        /** For each remote on our node its rank in intranode */
+  char              **shared_recv;
+                        /** For each remote on our node the position in
+                            the element data of its first ghost */
+  size_t             *shared_bytes;
+                        /** For each remote on our node the number of bytes
+                            that we copy from its window */
+#endif
+#ifdef T8_GHOST_ENABLE_RMA
+  t8_ghost_rma_t      rma;
+                 /** The synchronization of a one-sided exchange,
+                     T8_GHOST_RMA_NONE if messages are used */
+  MPI_Win             rma_window;
+                        /** The window with the data for all remotes */
+  MPI_Group           rma_group;
+                       /** The group of the remotes for T8_GHOST_RMA_PSCW */
+#endif
 } t8_ghost_data_exchange_t;
 
+#ifdef T8_GHOST_ENABLE_SHMEM
+/* The shared window of a process in a ghost data exchange starts with
+ * the number of remotes on its node, followed by one entry for each of
+ * these remotes and then by the data for these remotes. */
+typedef struct
+{
+  int                 remote_rank;      /* The rank of the remote process */
+  size_t              offset;   /* The position of its data in the window */
+} t8_ghost_shmem_entry_t;
+#endif
+
 void
 t8_forest_ghost_init (t8_forest_ghost_t * pghost, t8_ghost_type_t ghost_type)
 {
   t8_forest_ghost_t   ghost;
 
-  /* We currently only support face-neighbor ghosts */
-  T8_ASSERT (ghost_type == T8_GHOST_FACES);
+  T8_ASSERT (ghost_type != T8_GHOST_NONE);
 
   /* Allocate memory for ghost */
   ghost = *pghost = T8_ALLOC_ZERO (t8_forest_ghost_struct_t, 1);
@@ -233,6 +325,8 @@ t8_forest_ghost_init (t8_forest_ghost_t * pghost, t8_ghost_type_t ghost_type)
                        t8_ghost_remote_equal_function, NULL);
   /* initialize the remote processes array */
   ghost->remote_processes = sc_array_new (sizeof (int));
+  /* On default there is one ghost layer */
+  ghost->num_layers = 1;
 }
 
 /* Return the remote struct of a given remote rank */
@@ -244,10 +338,19 @@ t8_forest_ghost_get_remote (t8_forest_t forest, int remote)
   int                 ret;
 #endif
   size_t              index;
+  ssize_t             sindex;
 
   T8_ASSERT (t8_forest_is_committed (forest));
 
   remote_search.remote_rank = remote;
+  if (forest->ghosts->remotes != NULL) {
+    /* The ghost layer is constructed, we search in the sorted array */
+    sindex = sc_array_bsearch (forest->ghosts->remotes, &remote_search,
+                               t8_ghost_remote_compare);
+    T8_ASSERT (sindex >= 0);
+    return (t8_ghost_remote_t *) sc_array_index_ssize_t (forest->ghosts->
+                                                         remotes, sindex);
+  }
 #ifdef T8_ENABLE_DEBUG
   ret =
 #else
@@ -266,6 +369,7 @@ t8_forest_ghost_get_proc_info (t8_forest_t forest, int remote)
 {
   t8_ghost_process_hash_t proc_hash_search, **pproc_hash_found,
     *proc_hash_found;
+  ssize_t             sindex;
 #ifdef T8_ENABLE_DEBUG
   int                 ret;
 #endif
@@ -273,6 +377,14 @@ t8_forest_ghost_get_proc_info (t8_forest_t forest, int remote)
   T8_ASSERT (t8_forest_is_committed (forest));
 
   proc_hash_search.mpirank = remote;
+  if (forest->ghosts->process_offsets_sorted != NULL) {
+    /* The ghost layer is constructed, we search in the sorted array */
+    sindex = sc_array_bsearch (forest->ghosts->process_offsets_sorted,
+                               &proc_hash_search, t8_ghost_process_compare);
+    T8_ASSERT (sindex >= 0);
+    return (t8_ghost_process_hash_t *)
+      sc_array_index_ssize_t (forest->ghosts->process_offsets_sorted, sindex);
+  }
 #ifdef T8_ENABLE_DEBUG
   ret =
 #else
@@ -290,6 +402,7 @@ t8_forest_ghost_get_proc_info (t8_forest_t forest, int remote)
 t8_locidx_t
 t8_forest_ghost_num_trees (t8_forest_t forest)
 {
+  t8_forest_ghost_ensure (forest);
   if (forest->ghosts == NULL) {
     return 0;
   }
@@ -353,15 +466,36 @@ t8_forest_ghost_get_tree_elements (t8_forest_t forest,
   return &t8_forest_ghost_get_tree (forest, lghost_tree)->elements;
 }
 
+t8_element_array_soa_t *
+t8_forest_ghost_get_tree_soa (t8_forest_t forest, t8_locidx_t lghost_tree)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest->ghosts != NULL);
+
+  return &t8_forest_ghost_get_tree (forest, lghost_tree)->soa;
+}
+
 t8_locidx_t
 t8_forest_ghost_get_ghost_treeid (t8_forest_t forest, t8_gloidx_t gtreeid)
 {
   t8_ghost_gtree_hash_t query, *found, **pfound;
+  ssize_t             sindex;
 
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (forest->ghosts != NULL);
 
   query.global_id = gtreeid;
+  if (forest->ghosts->ghost_tree_ids != NULL) {
+    /* The ghost layer is constructed, we search in the sorted array */
+    sindex = sc_array_bsearch (forest->ghosts->ghost_tree_ids, &query,
+                               t8_ghost_gtree_compare);
+    if (sindex < 0) {
+      return -1;
+    }
+    return ((t8_ghost_gtree_hash_t *)
+            sc_array_index_ssize_t (forest->ghosts->ghost_tree_ids,
+                                    sindex))->index;
+  }
   if (sc_hash_lookup (forest->ghosts->global_tree_to_ghost_tree, &query,
                       (void ***) &pfound)) {
     /* The tree was found */
@@ -937,14 +1071,24 @@ t8_forest_ghost_search_boundary (t8_forest_t forest, t8_locidx_t ltreeid,
       /* Store the new bounds at the entry for this element */
       new_bounds[iface * 2] = lower;
       new_bounds[iface * 2 + 1] = upper;
-      if (lower == upper && lower == forest->mpirank) {
-        /* All neighbor leafs at this face are owned by the current rank */
+      if ((lower == upper && lower == forest->mpirank) || lower > upper) {
+        /* All neighbor leafs at this face are owned by the current rank
+         * or the face is on the domain boundary */
         faces_totally_owned = faces_totally_owned && 1;
       }
       else {
         faces_totally_owned = 0;
       }
     }
+    else if (lower >= upper) {
+      /* The element is a leaf and the owner bounds of its parent already
+       * determine the owner of the neighbor leafs at this face, or that
+       * there is no neighbor. We do not need to compute the neighbor. */
+      if (lower == upper && lower != forest->mpirank) {
+        t8_ghost_add_remote (forest, forest->ghosts, lower, ltreeid,
+                             element, tree_leaf_index);
+      }
+    }
     else {
       /* The element is a leaf, we compute all of its face neighbor owners
        * and add the element as a remote element to all of them. */
@@ -995,6 +1139,282 @@ t8_forest_ghost_search_boundary (t8_forest_t forest, t8_locidx_t ltreeid,
   return 1;
 }
 
+/* Add a local element as remote element to the process that owns the leaf
+ * at a given corner of an element of the tree \a gtreeid.
+ * We descend from the element towards the corner with integer coordinates
+ * \a coords until the owner of the leaf at the corner is unique.
+ * \a desc is a workspace of two elements of the scheme \a ts. */
+static void
+t8_forest_ghost_add_corner_owner (t8_forest_t forest,
+                                  t8_forest_ghost_t ghost,
+                                  t8_locidx_t ltreeid,
+                                  const t8_element_t * elem,
+                                  t8_locidx_t ielem, t8_gloidx_t gtreeid,
+                                  t8_eclass_t eclass,
+                                  t8_eclass_scheme_c * ts,
+                                  const t8_element_t * corner_elem,
+                                  const int coords[3], t8_element_t ** desc)
+{
+  int                 lower, upper, current;
+
+  ts->t8_element_copy (corner_elem, desc[0]);
+  current = 0;
+  lower = 0;
+  upper = forest->mpisize - 1;
+  t8_forest_element_owners_bounds (forest, gtreeid, desc[current],
+                                   eclass, &lower, &upper);
+  while (lower < upper) {
+    /* The element has more than one owner, we continue with its
+     * child at the corner. */
+    T8_ASSERT (ts->t8_element_level (desc[current]) < forest->maxlevel);
+    ts->t8_element_vertex_child (desc[current],
+                                 ts->t8_element_find_vertex (desc[current],
+                                                             coords),
+                                 desc[1 - current]);
+    current = 1 - current;
+    t8_forest_element_owners_bounds (forest, gtreeid, desc[current],
+                                     eclass, &lower, &upper);
+  }
+  if (lower != forest->mpirank) {
+    t8_ghost_add_remote (forest, ghost, lower, ltreeid, elem, ielem);
+  }
+}
+
+/* Return true if a corner of an element lies on a given face of it. */
+static int
+t8_forest_ghost_face_has_corner (t8_eclass_scheme_c * ts,
+                                 const t8_element_t * elem, int face,
+                                 int corner)
+{
+  int                 iface_corner, num_face_corners;
+
+  num_face_corners =
+    t8_eclass_num_vertices[ts->t8_element_face_shape (elem, face)];
+  for (iface_corner = 0; iface_corner < num_face_corners; iface_corner++) {
+    if (ts->t8_element_get_face_corner (elem, face, iface_corner) == corner) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Add a local element as remote element to all processes that own a leaf
+ * of the neighbor tree across a tree face at a corner of the element.
+ * The element \a face_elem of the same tree and level as \a elem has the
+ * corner \a corner of \a elem on its face \a face, which lies on the tree
+ * boundary. Let N be the face neighbor of \a face_elem in the neighbor tree.
+ * We add the owners of N and of all elements of its level at the corner
+ * of N that coincides with \a corner.
+ * To find this corner of N, we compare the face neighbor of the child of
+ * \a face_elem at \a corner with the children of N at the corners of its
+ * face. If \a face_elem has maximum level, we use all corners of this face.
+ * \a children is a workspace of two elements of the scheme \a ts. */
+static void
+t8_forest_ghost_add_face_corner_remotes (t8_forest_t forest,
+                                         t8_forest_ghost_t ghost,
+                                         t8_locidx_t ltreeid,
+                                         t8_eclass_scheme_c * ts,
+                                         const t8_element_t * elem,
+                                         t8_locidx_t ielem,
+                                         const t8_element_t * face_elem,
+                                         int face, int corner,
+                                         t8_element_t ** children)
+{
+  t8_element_t       *neighbors[T8_ELEMENT_MAX_CORNER_NEIGHBORS];
+  t8_element_t       *desc[2], *face_neigh, *child_neigh, *neigh_child;
+  t8_element_scratch_mark_t mark;
+  t8_eclass_scheme_c *neigh_ts;
+  t8_eclass_t         neigh_eclass;
+  t8_gloidx_t         neigh_gtreeid;
+  int                 coords[3];
+  int                 neigh_face, child_face, dummy_face;
+  int                 iface_corner, num_face_corners, neigh_corner;
+  int                 ineigh, num_neighbors;
+
+  neigh_eclass =
+    t8_forest_element_neighbor_eclass (forest, ltreeid, face_elem, face);
+  neigh_ts = t8_forest_get_eclass_scheme (forest, neigh_eclass);
+  mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (neigh_ts, 1, &face_neigh);
+  neigh_gtreeid =
+    t8_forest_element_face_neighbor (forest, ltreeid, face_elem, face_neigh,
+                                     neigh_ts, face, &neigh_face);
+  if (neigh_gtreeid < 0) {
+    /* The face is a domain boundary */
+    t8_element_scratch_release (mark);
+    return;
+  }
+  t8_element_scratch_new (neigh_ts, T8_ELEMENT_MAX_CORNER_NEIGHBORS,
+                          neighbors);
+  t8_element_scratch_new (neigh_ts, 2, desc);
+  t8_element_scratch_new (neigh_ts, 1, &child_neigh);
+  t8_element_scratch_new (neigh_ts, 1, &neigh_child);
+
+  /* Find the face of the child of face_elem at corner that lies on the
+   * same tree face as face. */
+  child_face = -1;
+  if (ts->t8_element_level (face_elem) < forest->maxlevel) {
+    int                 tree_face = ts->t8_element_tree_face (face_elem,
+                                                              face);
+    int                 iface, num_faces;
+
+    ts->t8_element_vertex_child (face_elem, corner, children[0]);
+    num_faces = ts->t8_element_num_faces (children[0]);
+    for (iface = 0; iface < num_faces && child_face < 0; iface++) {
+      if (ts->t8_element_is_root_boundary (children[0], iface)
+          && ts->t8_element_tree_face (children[0], iface) == tree_face) {
+        child_face = iface;
+      }
+    }
+  }
+  if (child_face >= 0) {
+    t8_forest_element_face_neighbor (forest, ltreeid, children[0],
+                                     child_neigh, neigh_ts, child_face,
+                                     &dummy_face);
+  }
+
+  num_face_corners =
+    t8_eclass_num_vertices[neigh_ts->t8_element_face_shape (face_neigh,
+                                                            neigh_face)];
+  for (iface_corner = 0; iface_corner < num_face_corners; iface_corner++) {
+    neigh_corner = neigh_ts->t8_element_get_face_corner (face_neigh,
+                                                         neigh_face,
+                                                         iface_corner);
+    if (child_face >= 0) {
+      /* Check whether this corner of the neighbor is the corner of elem */
+      neigh_ts->t8_element_vertex_child (face_neigh, neigh_corner,
+                                         neigh_child);
+      if (neigh_ts->t8_element_compare (neigh_child, child_neigh)) {
+        continue;
+      }
+    }
+    coords[0] = coords[1] = coords[2] = 0;
+    neigh_ts->t8_element_vertex_coords (face_neigh, neigh_corner, coords);
+    t8_forest_ghost_add_corner_owner (forest, ghost, ltreeid, elem, ielem,
+                                      neigh_gtreeid, neigh_eclass, neigh_ts,
+                                      face_neigh, coords, desc);
+    num_neighbors =
+      neigh_ts->t8_element_corner_neighbors_inside
+      (face_neigh, neigh_corner, T8_ELEMENT_MAX_CORNER_NEIGHBORS, neighbors);
+    for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      t8_forest_ghost_add_corner_owner (forest, ghost, ltreeid, elem, ielem,
+                                        neigh_gtreeid, neigh_eclass,
+                                        neigh_ts, neighbors[ineigh], coords,
+                                        desc);
+    }
+  }
+  t8_element_scratch_release (mark);
+}
+
+/* Add a local element as remote element to all processes that own a leaf
+ * that touches one of the element's corners, but is not necessarily a face
+ * neighbor.
+ * For each element of the same level at a corner, we descend towards the
+ * corner until the owner of the leaf at the corner is unique.
+ * If the corner lies on a tree face, we also consider the leaves in the
+ * neighbor tree at this corner. We find them through the face neighbors of
+ * the element and of its neighbors at the corner that have a face on the
+ * tree boundary containing the corner.
+ * Trees that share only an edge or a vertex with the element's tree are not
+ * considered, since the coarse mesh only stores face connections. */
+static void
+t8_forest_ghost_add_corner_remotes (t8_forest_t forest,
+                                    t8_forest_ghost_t ghost,
+                                    t8_locidx_t ltreeid,
+                                    t8_eclass_scheme_c * ts,
+                                    const t8_element_t * elem,
+                                    t8_locidx_t ielem)
+{
+  t8_element_t       *neighbors[T8_ELEMENT_MAX_CORNER_NEIGHBORS];
+  t8_element_t       *desc[2];
+  const t8_element_t *face_elem;
+  t8_element_scratch_mark_t mark;
+  t8_eclass_t         eclass;
+  t8_gloidx_t         gtreeid;
+  int                 coords[3];
+  int                 icorner, num_corners, ineigh, num_neighbors;
+  int                 iface, num_faces, face_corner;
+
+  eclass = t8_forest_get_tree_class (forest, ltreeid);
+  gtreeid = ltreeid + t8_forest_get_first_local_tree_id (forest);
+  mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (ts, T8_ELEMENT_MAX_CORNER_NEIGHBORS, neighbors);
+  t8_element_scratch_new (ts, 2, desc);
+  num_corners = ts->t8_element_num_corners (elem);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    coords[0] = coords[1] = coords[2] = 0;
+    ts->t8_element_vertex_coords (elem, icorner, coords);
+    num_neighbors =
+      ts->t8_element_corner_neighbors_inside (elem, icorner,
+                                              T8_ELEMENT_MAX_CORNER_NEIGHBORS,
+                                              neighbors);
+    for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      t8_forest_ghost_add_corner_owner (forest, ghost, ltreeid, elem, ielem,
+                                        gtreeid, eclass, ts,
+                                        neighbors[ineigh], coords, desc);
+    }
+    /* Look for faces on the tree boundary at this corner, of elem
+     * (ineigh == -1) and of its neighbors at the corner. */
+    for (ineigh = -1; ineigh < num_neighbors; ineigh++) {
+      face_elem = ineigh < 0 ? elem : neighbors[ineigh];
+      face_corner = ts->t8_element_find_vertex (face_elem, coords);
+      T8_ASSERT (face_corner >= 0);
+      num_faces = ts->t8_element_num_faces (face_elem);
+      for (iface = 0; iface < num_faces; iface++) {
+        if (ts->t8_element_is_root_boundary (face_elem, iface)
+            && t8_forest_ghost_face_has_corner (ts, face_elem, iface,
+                                                face_corner)) {
+          t8_forest_ghost_add_face_corner_remotes (forest, ghost, ltreeid,
+                                                   ts, elem, ielem,
+                                                   face_elem, iface,
+                                                   face_corner, desc);
+        }
+      }
+    }
+  }
+  t8_element_scratch_release (mark);
+}
+
+/* If a process sends ghost elements to us, we also need to send a message
+ * to this process, since the sending and receiving processes are the same.
+ * For face neighbors this is always the case. For corner neighbors, we add
+ * a remote process without elements to each process that sends to us but
+ * does not receive from us. */
+static void
+t8_forest_ghost_symmetrize_remotes (t8_forest_t forest,
+                                    t8_forest_ghost_t ghost)
+{
+  t8_ghost_remote_t   remote_entry_lookup, *remote_entry;
+  int                *sends_to, *receives_from;
+  size_t              iproc, index;
+  int                 rank, mpiret;
+
+  sends_to = T8_ALLOC_ZERO (int, forest->mpisize);
+  receives_from = T8_ALLOC (int, forest->mpisize);
+  for (iproc = 0; iproc < ghost->remote_processes->elem_count; iproc++) {
+    sends_to[*(int *) sc_array_index (ghost->remote_processes, iproc)] = 1;
+  }
+  mpiret = sc_MPI_Alltoall (sends_to, 1, sc_MPI_INT, receives_from, 1,
+                            sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (rank = 0; rank < forest->mpisize; rank++) {
+    if (receives_from[rank] && !sends_to[rank]) {
+      remote_entry_lookup.remote_rank = rank;
+      remote_entry = (t8_ghost_remote_t *)
+        sc_hash_array_insert_unique (ghost->remote_ghosts,
+                                     (void *) &remote_entry_lookup, &index);
+      T8_ASSERT (remote_entry != NULL);
+      remote_entry->remote_rank = rank;
+      remote_entry->num_elements = 0;
+      sc_array_init (&remote_entry->remote_trees,
+                     sizeof (t8_ghost_remote_tree_t));
+      *(int *) sc_array_push (ghost->remote_processes) = rank;
+    }
+  }
+  T8_FREE (sends_to);
+  T8_FREE (receives_from);
+}
+
 /* Fill the remote ghosts of a ghost structure.
  * We iterate through all elements and check if their neighbors
  * lie on remote processes. If so, we add the element to the
@@ -1037,6 +1457,180 @@ t8_forest_ghost_fill_remote_v3 (t8_forest_t forest)
 #endif
 }
 
+/* Return true if the remote ghosts of forest_from can be reused for
+ * forest. This is the case if forest was adapted from forest_from,
+ * since then the processes own the same parts of the domain and the
+ * face neighbor owners of an element only depend on these parts. */
+static int
+t8_forest_ghost_can_reuse_remotes (t8_forest_t forest,
+                                   t8_forest_t forest_from)
+{
+  const t8_gloidx_t  *first_desc, *first_desc_from;
+
+  if (forest_from == NULL || forest_from->ghosts == NULL
+      || forest_from->ghost_type != T8_GHOST_FACES
+      || forest_from->ghosts->num_layers > 1
+      || forest_from->first_local_tree != forest->first_local_tree
+      || t8_forest_get_num_local_trees (forest_from)
+      != t8_forest_get_num_local_trees (forest)
+      || forest_from->mpisize != forest->mpisize
+      || forest_from->global_first_desc == NULL) {
+    return 0;
+  }
+  first_desc = t8_shmem_array_get_gloidx_array (forest->global_first_desc);
+  first_desc_from =
+    t8_shmem_array_get_gloidx_array (forest_from->global_first_desc);
+  /* This check is local, all processes reach the same result */
+  return !memcmp (first_desc, first_desc_from,
+                  forest->mpisize * sizeof (t8_gloidx_t));
+}
+
+/* Fill the remote ghosts of a ghost structure of a forest that was adapted
+ * from forest_from, which has a face ghost layer.
+ * For elements that did not change during adapt we copy the remote
+ * processes from the ghost layer of forest_from. Only for the new elements
+ * we compute the owners of their face neighbors.
+ * Thus, the number of owner searches is proportional to the number of
+ * changed elements. */
+static void
+t8_forest_ghost_fill_remote_incremental (t8_forest_t forest,
+                                         t8_forest_t forest_from)
+{
+  t8_forest_ghost_t   ghost = forest->ghosts;
+  t8_forest_ghost_t   ghost_from = forest_from->ghosts;
+  t8_ghost_remote_t  *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  t8_element_array_t *elements, *elements_from;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t        *rank_offsets, *rank_fill;
+  t8_locidx_t         num_elements_from, num_local_trees, itree, ltree_from;
+  t8_locidx_t         num_elements, ielement, ielement_from, offset_from;
+  t8_locidx_t         index, irank, num_changed = 0;
+  sc_array_t          face_owners;
+  size_t              iremote, iremote_tree, iowner;
+  int                *ranks, remote_rank, iface, num_faces;
+
+  num_elements_from = t8_forest_get_local_num_elements (forest_from);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+
+  /* For each element of forest_from we store the processes that it was
+   * sent to. The processes of element i are the entries
+   * rank_offsets[i] to rank_offsets[i + 1] - 1 of ranks. */
+  rank_offsets = T8_ALLOC_ZERO (t8_locidx_t, num_elements_from + 1);
+  for (iremote = 0; iremote < ghost_from->remote_processes->elem_count;
+       iremote++) {
+    remote_rank =
+      *(int *) sc_array_index (ghost_from->remote_processes, iremote);
+    remote_entry = t8_forest_ghost_get_remote (forest_from, remote_rank);
+    for (iremote_tree = 0;
+         iremote_tree < remote_entry->remote_trees.elem_count;
+         iremote_tree++) {
+      remote_tree = (t8_ghost_remote_tree_t *)
+        sc_array_index (&remote_entry->remote_trees, iremote_tree);
+      ltree_from = t8_forest_get_local_id (forest_from,
+                                           remote_tree->global_id);
+      offset_from = t8_forest_get_tree_element_offset (forest_from,
+                                                       ltree_from);
+      for (iowner = 0; iowner < remote_tree->element_indices.elem_count;
+           iowner++) {
+        index = *(t8_locidx_t *)
+          sc_array_index (&remote_tree->element_indices, iowner);
+        rank_offsets[offset_from + index + 1]++;
+      }
+    }
+  }
+  for (ielement = 0; ielement < num_elements_from; ielement++) {
+    rank_offsets[ielement + 1] += rank_offsets[ielement];
+  }
+  ranks = T8_ALLOC (int, rank_offsets[num_elements_from]);
+  rank_fill = T8_ALLOC (t8_locidx_t, num_elements_from);
+  memcpy (rank_fill, rank_offsets, num_elements_from * sizeof (t8_locidx_t));
+  for (iremote = 0; iremote < ghost_from->remote_processes->elem_count;
+       iremote++) {
+    remote_rank =
+      *(int *) sc_array_index (ghost_from->remote_processes, iremote);
+    remote_entry = t8_forest_ghost_get_remote (forest_from, remote_rank);
+    for (iremote_tree = 0;
+         iremote_tree < remote_entry->remote_trees.elem_count;
+         iremote_tree++) {
+      remote_tree = (t8_ghost_remote_tree_t *)
+        sc_array_index (&remote_entry->remote_trees, iremote_tree);
+      ltree_from = t8_forest_get_local_id (forest_from,
+                                           remote_tree->global_id);
+      offset_from = t8_forest_get_tree_element_offset (forest_from,
+                                                       ltree_from);
+      for (iowner = 0; iowner < remote_tree->element_indices.elem_count;
+           iowner++) {
+        index = offset_from + *(t8_locidx_t *)
+          sc_array_index (&remote_tree->element_indices, iowner);
+        ranks[rank_fill[index]++] = remote_rank;
+      }
+    }
+  }
+  T8_FREE (rank_fill);
+
+  sc_array_init (&face_owners, sizeof (int));
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elements = t8_forest_get_tree_element_array (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    elements_from = t8_forest_get_tree_element_array (forest_from, itree);
+    num_elements_from = t8_forest_get_tree_num_elements (forest_from, itree);
+    offset_from = t8_forest_get_tree_element_offset (forest_from, itree);
+    ielement_from = 0;
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_element_array_index_locidx (elements, ielement);
+      /* Both element arrays are sorted. We skip the elements of the old tree
+       * that are smaller than the current element and check whether the
+       * next one is the current element. */
+      while (ielement_from < num_elements_from
+             && ts->t8_element_compare (t8_element_array_index_locidx
+                                        (elements_from, ielement_from),
+                                        element) < 0) {
+        ielement_from++;
+      }
+      if (ielement_from < num_elements_from
+          && !ts->t8_element_compare (t8_element_array_index_locidx
+                                      (elements_from, ielement_from),
+                                      element)) {
+        /* The element did not change, it has the same remote processes */
+        index = offset_from + ielement_from;
+        for (irank = rank_offsets[index]; irank < rank_offsets[index + 1];
+             irank++) {
+          t8_ghost_add_remote (forest, ghost, ranks[irank], itree, element,
+                               ielement);
+        }
+        continue;
+      }
+      /* The element is new, we compute the owners at its faces */
+      num_changed++;
+      num_faces = ts->t8_element_num_faces (element);
+      for (iface = 0; iface < num_faces; iface++) {
+        sc_array_truncate (&face_owners);
+        t8_forest_element_owners_at_neigh_face (forest, itree, element,
+                                                iface, &face_owners);
+        for (iowner = 0; iowner < face_owners.elem_count; iowner++) {
+          remote_rank = *(int *) sc_array_index (&face_owners, iowner);
+          if (remote_rank != forest->mpirank) {
+            t8_ghost_add_remote (forest, ghost, remote_rank, itree, element,
+                                 ielement);
+          }
+        }
+      }
+    }
+  }
+  t8_debugf ("Computed remotes of %li changed elements, reused %li.\n",
+             (long) num_changed,
+             (long) (t8_forest_get_local_num_elements (forest)
+                     - num_changed));
+  sc_array_reset (&face_owners);
+  T8_FREE (rank_offsets);
+  T8_FREE (ranks);
+}
+
 /* Fill the remote ghosts of a ghost structure.
  * We iterate through all elements and check if their neighbors
  * lie on remote processes. If so, we add the element to the
@@ -1050,24 +1644,26 @@ static void
 t8_forest_ghost_fill_remote (t8_forest_t forest, t8_forest_ghost_t ghost,
                              int ghost_method)
 {
-  t8_element_t       *elem, **half_neighbors = NULL;
+  t8_element_t       *elem, *half_neighbors[T8_ECLASS_MAX_CHILDREN];
   t8_locidx_t         num_local_trees, num_tree_elems;
-  t8_locidx_t         itree, ielem;
+  t8_locidx_t         itree, ielem, chunk_first, chunk_last;
   t8_tree_t           tree;
-  t8_eclass_t         tree_class, neigh_class, last_class;
+  t8_eclass_t         tree_class, neigh_class;
   t8_gloidx_t         neighbor_tree;
-  t8_eclass_scheme_c *ts, *neigh_scheme = NULL, *prev_neigh_scheme = NULL;
+  t8_eclass_scheme_c *ts;
+  t8_forest_half_neighbors_t half;
 
   int                 iface, num_faces;
-  int                 num_face_children, max_num_face_children = 0;
+  int                 num_face_children;
   int                 ichild, owner;
   sc_array_t          owners, tree_owners;
-  int                 is_atom;
 
-  last_class = T8_ECLASS_COUNT;
   num_local_trees = t8_forest_get_num_local_trees (forest);
 
-  if (ghost_method != 0) {
+  if (ghost_method == 0) {
+    t8_forest_half_neighbors_init (&half);
+  }
+  else {
     sc_array_init (&owners, sizeof (int));
     sc_array_init (&tree_owners, sizeof (int));
   }
@@ -1081,71 +1677,30 @@ t8_forest_ghost_fill_remote (t8_forest_t forest, t8_forest_ghost_t ghost,
     tree_class = t8_forest_get_tree_class (forest, itree);
     ts = t8_forest_get_eclass_scheme (forest, tree_class);
 
-    /* Loop over the elements of this tree */
+    /* Loop over the elements of this tree in chunks */
     num_tree_elems = t8_forest_get_tree_element_count (tree);
-    for (ielem = 0; ielem < num_tree_elems; ielem++) {
-      /* Get the element of the tree */
-      elem = t8_forest_get_tree_element (tree, ielem);
-      num_faces = ts->t8_element_num_faces (elem);
-      if (ts->t8_element_level (elem) == ts->t8_element_maxlevel ()) {
-        /* flag to decide whether this element is at the maximum level */
-        is_atom = 1;
-      }
-      else {
-        is_atom = 0;
+    for (chunk_first = 0; chunk_first < num_tree_elems;
+         chunk_first = chunk_last) {
+      chunk_last = SC_MIN (num_tree_elems,
+                           chunk_first + T8_GHOST_HALF_NEIGHBORS_CHUNK);
+      if (ghost_method == 0) {
+        /* Construct the half size neighbors of all faces of the chunk */
+        t8_forest_tree_half_face_neighbors (forest, itree, chunk_first,
+                                            chunk_last, &half);
       }
-      for (iface = 0; iface < num_faces; iface++) {
-        /* TODO: Check whether the neighbor element is inside the forest,
-         *       if not then do not compute the half_neighbors.
-         *       This will save computing time. Needs an "element is in forest" function
-         *       Currently we perform this check in the half_neighbors function. */
-
-        /* Get the element class of the neighbor tree */
-        neigh_class =
-          t8_forest_element_neighbor_eclass (forest, itree, elem, iface);
-        neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
-        if (ghost_method == 0) {
-          /* Use half neighbors */
-          /* Get the number of face children of the element at this face */
-          num_face_children = ts->t8_element_num_face_children (elem, iface);
-          /* regrow the half_neighbors array if neccessary.
-           * We also need to reallocate it, if the element class of the neighbor
-           * changes */
-          if (max_num_face_children < num_face_children ||
-              last_class != neigh_class) {
-            if (max_num_face_children > 0) {
-              /* Clean-up memory */
-              prev_neigh_scheme->t8_element_destroy (max_num_face_children,
-                                                     half_neighbors);
-              T8_FREE (half_neighbors);
-            }
-            half_neighbors = T8_ALLOC (t8_element_t *, num_face_children);
-            /* Allocate memory for the half size face neighbors */
-            neigh_scheme->t8_element_new (num_face_children, half_neighbors);
-            max_num_face_children = num_face_children;
-            last_class = neigh_class;
-            prev_neigh_scheme = neigh_scheme;
-          }
-          if (!is_atom) {
-            /* Construct each half size neighbor */
-            neighbor_tree =
-              t8_forest_element_half_face_neighbors (forest, itree, elem,
-                                                     half_neighbors,
-                                                     neigh_scheme, iface,
-                                                     num_face_children, NULL);
-          }
-          else {
-            int                 dummy_neigh_face;
-            /* This element has maximum level, we only construct its neighbor */
-            neighbor_tree =
-              t8_forest_element_face_neighbor (forest, itree, elem,
-                                               half_neighbors[0],
-                                               neigh_scheme, iface,
-                                               &dummy_neigh_face);
-          }
-          if (neighbor_tree >= 0) {
-            /* If there exist face neighbor elements (we are not at a domain boundary */
-            /* Find the owner process of each face_child */
+      for (ielem = chunk_first; ielem < chunk_last; ielem++) {
+        /* Get the element of the tree */
+        elem = t8_forest_get_tree_element (tree, ielem);
+        num_faces = ts->t8_element_num_faces (elem);
+        for (iface = 0; iface < num_faces; iface++) {
+          if (ghost_method == 0) {
+            /* Use half neighbors */
+            num_face_children =
+              t8_forest_half_neighbors_get (&half, ielem, iface,
+                                            &neighbor_tree, &neigh_class,
+                                            half_neighbors, NULL);
+            /* If there exist face neighbor elements (we are not at a domain
+             * boundary), find the owner process of each face_child */
             for (ichild = 0; ichild < num_face_children; ichild++) {
               /* find the owner */
               owner =
@@ -1159,28 +1714,34 @@ t8_forest_ghost_fill_remote (t8_forest_t forest, t8_forest_ghost_t ghost,
                                      ielem);
               }
             }
-          }
-        }                       /* end ghost_method 0 */
-        else {
-          size_t              iowner;
-          /* Construc the owners at the face of the neighbor element */
-          t8_forest_element_owners_at_neigh_face (forest, itree, elem, iface,
-                                                  &owners);
-          T8_ASSERT (owners.elem_count >= 0);
-          /* Iterate over all owners and if any is not the current process,
-           * add this element as remote */
-          for (iowner = 0; iowner < owners.elem_count; iowner++) {
-            owner = *(int *) sc_array_index (&owners, iowner);
-            T8_ASSERT (0 <= owner && owner < forest->mpisize);
-            if (owner != forest->mpirank) {
-              /* Add the element as a remote element */
-              t8_ghost_add_remote (forest, ghost, owner, itree, elem, ielem);
+          }                     /* end ghost_method 0 */
+          else {
+            size_t              iowner;
+            /* Construc the owners at the face of the neighbor element */
+            t8_forest_element_owners_at_neigh_face (forest, itree, elem,
+                                                    iface, &owners);
+            T8_ASSERT (owners.elem_count >= 0);
+            /* Iterate over all owners and if any is not the current process,
+             * add this element as remote */
+            for (iowner = 0; iowner < owners.elem_count; iowner++) {
+              owner = *(int *) sc_array_index (&owners, iowner);
+              T8_ASSERT (0 <= owner && owner < forest->mpisize);
+              if (owner != forest->mpirank) {
+                /* Add the element as a remote element */
+                t8_ghost_add_remote (forest, ghost, owner, itree, elem,
+                                     ielem);
+              }
             }
+            sc_array_truncate (&owners);
           }
-          sc_array_truncate (&owners);
+        }                       /* end face loop */
+        if (ghost->ghost_type != T8_GHOST_FACES) {
+          /* Also add the element for the owners of its corner neighbors */
+          t8_forest_ghost_add_corner_remotes (forest, ghost, itree, ts, elem,
+                                              ielem);
         }
-      }                         /* end face loop */
-    }                           /* end element loop */
+      }                         /* end element loop */
+    }                           /* end chunk loop */
   }                             /* end tree loop */
 
   if (forest->profile != NULL) {
@@ -1189,11 +1750,7 @@ t8_forest_ghost_fill_remote (t8_forest_t forest, t8_forest_ghost_t ghost,
   }
   /* Clean-up memory */
   if (ghost_method == 0) {
-    if (half_neighbors != NULL) {
-      neigh_scheme->t8_element_destroy (max_num_face_children,
-                                        half_neighbors);
-      T8_FREE (half_neighbors);
-    }
+    t8_forest_half_neighbors_reset (&half);
   }
   else {
     sc_array_reset (&owners);
@@ -1226,6 +1783,7 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost,
   size_t              acc_el_count = 0;
 #endif
   int                 mpiret;
+  const int           compress = forest->compress_messages > 0;
 
   /* Allocate a send_buffer for each remote rank */
   num_remotes = ghost->remote_processes->elem_count;
@@ -1281,6 +1839,14 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost,
       /* add padding before the elements */
       current_send_info->num_bytes +=
         T8_ADD_PADDING (current_send_info->num_bytes);
+      if (compress) {
+        /* The number of bytes of the encoded elements and an upper bound
+         * for them, the buffer is shrunk after encoding */
+        current_send_info->num_bytes += sizeof (size_t);
+        current_send_info->num_bytes +=
+          T8_ADD_PADDING (current_send_info->num_bytes);
+        element_bytes = element_count * T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES;
+      }
       current_send_info->num_bytes += element_bytes;
       /* add padding after the elements */
       current_send_info->num_bytes +=
@@ -1328,13 +1894,28 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost,
               sizeof (size_t));
       bytes_written += sizeof (size_t);
       bytes_written += T8_ADD_PADDING (bytes_written);
-      /* The byte count of the elements */
-      element_size = t8_element_array_get_size (&remote_tree->elements);
-      element_bytes = element_size * element_count;
-      /* Copy the elements into the send buffer */
-      memcpy (current_buffer + bytes_written,
-              t8_element_array_get_data (&remote_tree->elements),
-              element_bytes);
+      if (compress) {
+        /* Encode the elements behind their number of bytes */
+        element_bytes =
+          t8_element_array_encode (&remote_tree->elements, 0, element_count,
+                                   forest->maxlevel,
+                                   current_buffer + bytes_written
+                                   + sizeof (size_t)
+                                   + T8_ADD_PADDING (sizeof (size_t)));
+        memcpy (current_buffer + bytes_written, &element_bytes,
+                sizeof (size_t));
+        bytes_written += sizeof (size_t);
+        bytes_written += T8_ADD_PADDING (bytes_written);
+      }
+      else {
+        /* The byte count of the elements */
+        element_size = t8_element_array_get_size (&remote_tree->elements);
+        element_bytes = element_size * element_count;
+        /* Copy the elements into the send buffer */
+        memcpy (current_buffer + bytes_written,
+                t8_element_array_get_data (&remote_tree->elements),
+                element_bytes);
+      }
       bytes_written += element_bytes;
       /* add padding after the elements */
       bytes_written += T8_ADD_PADDING (bytes_written);
@@ -1346,13 +1927,23 @@ t8_forest_ghost_send_start (t8_forest_t forest, t8_forest_ghost_t ghost,
 #endif
     }                           /* End tree loop */
 
-    T8_ASSERT (bytes_written == current_send_info->num_bytes);
+    T8_ASSERT (compress ? bytes_written <= current_send_info->num_bytes
+               : bytes_written == current_send_info->num_bytes);
+    if (bytes_written < current_send_info->num_bytes) {
+      /* Free the unused upper bound of the encoded elements */
+      current_send_info->buffer =
+        T8_REALLOC (current_send_info->buffer, char, bytes_written);
+      current_send_info->num_bytes = bytes_written;
+      current_buffer = current_send_info->buffer;
+    }
     /* We can now post the MPI_Isend for the remote process */
     mpiret =
       sc_MPI_Isend (current_buffer, bytes_written, sc_MPI_BYTE, remote_rank,
                     T8_MPI_GHOST_FOREST, forest->mpicomm,
                     *requests + proc_index);
     SC_CHECK_MPI (mpiret);
+    t8_forest_profile_add_bytes (forest, T8_PROFILE_PHASE_GHOST_SEND,
+                                 bytes_written);
   }                             /* end process loop */
   return send_info;
 }
@@ -1409,157 +2000,251 @@ t8_forest_ghost_receive_message (int recv_rank, sc_MPI_Comm comm,
   return recv_buffer;
 }
 
-/* Parse a message from a remote process and correctly include the received
- * elements in the ghost structure.
+/* A tree in a received ghost message. */
+typedef struct
+{
+  t8_gloidx_t         global_id;        /**< The global id of the tree */
+  t8_eclass_t         eclass;           /**< The element class of the tree */
+  size_t              num_elements;     /**< The number of elements of the tree in the message */
+  size_t              data_offset;      /**< The position of the elements in the message */
+  size_t              ghost_tree;       /**< The index of the ghost tree of the elements, set by the merge */
+  size_t              first_element;    /**< The position of the first element in the ghost tree, set by the merge */
+} t8_ghost_message_tree_t;
+
+/* A received ghost message with the trees that it contains. */
+typedef struct
+{
+  char               *buffer;           /**< The received message */
+  int                 bytes;            /**< The number of bytes in \a buffer */
+  sc_array_t          trees;            /**< The trees of the message, entries are t8_ghost_message_tree_t */
+} t8_ghost_message_t;
+
+/* Read the trees of a message from a remote process into message->trees.
+ * The elements are not copied, the trees only store their position.
  * The message looks like:
  * num_trees | pad | treeid 0 | pad | eclass 0 | pad | num_elems 0 | pad | elements | pad | treeid 1 | ...
  *  size_t   |     |t8_gloidx |     |t8_eclass |     | size_t      |     | t8_element_t |
  *
  * pad is paddind, see T8_ADD_PADDING
- *
- * current_element_offset is updated in each step to store the element offset
- * of the next ghost tree to be inserted.
- * When called with the first message, current_element_offset must be set to 0.
+ * If the messages are compressed, the elements are preceded by their number of
+ * bytes as size_t and padding, and are encoded with t8_element_array_encode.
  */
-/* Currently we expect that the messages arrive in order of the sender's rank. */
 static void
-t8_forest_ghost_parse_received_message (t8_forest_t forest,
-                                        t8_forest_ghost_t ghost,
-                                        t8_locidx_t * current_element_offset,
-                                        int recv_rank, char *recv_buffer,
-                                        int recv_bytes)
-{
-  size_t              bytes_read, first_tree_index = 0, first_element_index =
-    0;
+t8_forest_ghost_scan_received_message (t8_forest_t forest,
+                                       t8_ghost_message_t * message,
+                                       int recv_rank)
+{
+  size_t              bytes_read, element_bytes;
   t8_locidx_t         num_trees, itree;
-  t8_gloidx_t         global_id;
-  t8_eclass_t         eclass;
-  size_t              num_elements, old_elem_count, ghosts_offset;
-  t8_ghost_gtree_hash_t *tree_hash, **pfound_tree, *found_tree;
-  t8_ghost_tree_t    *ghost_tree;
+  t8_ghost_message_tree_t *tree;
   t8_eclass_scheme_c *ts;
-  t8_element_t       *element_insert;
-  t8_ghost_process_hash_t *process_hash;
-#ifdef T8_ENABLE_DEBUG
-  int                 added_process;
-#endif
 
   bytes_read = 0;
   /* read the number of trees */
-  num_trees = *(size_t *) recv_buffer;
+  num_trees = *(size_t *) message->buffer;
   bytes_read += sizeof (size_t);
   bytes_read += T8_ADD_PADDING (bytes_read);
 
   t8_debugf ("Received %li trees from %i (%i bytes)\n",
-             (long) num_trees, recv_rank, recv_bytes);
+             (long) num_trees, recv_rank, message->bytes);
 
-  /* Count the total number of ghosts that we receive from this rank */
-  ghosts_offset = ghost->num_ghosts_elements;
+  sc_array_init_size (&message->trees, sizeof (t8_ghost_message_tree_t),
+                      num_trees);
   for (itree = 0; itree < num_trees; itree++) {
-    /* Get tree id */
-    /* search if tree was inserted */
-    /* if not: new entry, add elements */
-    /* if yes: add the elements to the end of the tree's element array. */
-
+    tree =
+      (t8_ghost_message_tree_t *) sc_array_index (&message->trees, itree);
     /* read the global id of this tree. */
-    global_id = *(t8_gloidx_t *) (recv_buffer + bytes_read);
+    tree->global_id = *(t8_gloidx_t *) (message->buffer + bytes_read);
     bytes_read += sizeof (t8_gloidx_t);
     bytes_read += T8_ADD_PADDING (bytes_read);
     /* read the element class of the tree */
-    eclass = *(t8_eclass_t *) (recv_buffer + bytes_read);
+    tree->eclass = *(t8_eclass_t *) (message->buffer + bytes_read);
     bytes_read += sizeof (t8_eclass_t);
     bytes_read += T8_ADD_PADDING (bytes_read);
     /* read the number of elements sent */
-    num_elements = *(size_t *) (recv_buffer + bytes_read);
-
-    /* Add to the counter of ghost elements. */
-    ghost->num_ghosts_elements += num_elements;
-
+    tree->num_elements = *(size_t *) (message->buffer + bytes_read);
     bytes_read += sizeof (size_t);
     bytes_read += T8_ADD_PADDING (bytes_read);
-    /* Search for the tree in the ghost_trees array */
-    tree_hash =
-      (t8_ghost_gtree_hash_t *) sc_mempool_alloc (ghost->glo_tree_mempool);
-    tree_hash->global_id = global_id;
-
-    /* Get the element scheme for this tree */
-    ts = t8_forest_get_eclass_scheme (forest, eclass);
-    if (sc_hash_insert_unique (ghost->global_tree_to_ghost_tree, tree_hash,
-                               (void ***) &pfound_tree)) {
-      /* The tree was not stored already, tree_hash is now an entry in the hash table. */
-      /* If the tree was not contained, it is the newest tree in the array and
-       * thus has as index the number of currently inserted trees. */
-      tree_hash->index = ghost->ghost_trees->elem_count;
-      found_tree = tree_hash;
-      /* We grow the array by one and initilize the entry */
-      ghost_tree = (t8_ghost_tree_t *) sc_array_push (ghost->ghost_trees);
-      ghost_tree->global_id = global_id;
-      ghost_tree->eclass = eclass;
-      /* Initialize the element array */
-      t8_element_array_init_size (&ghost_tree->elements, ts, num_elements);
-      /* pointer to where the elements are to be inserted */
-      element_insert = t8_element_array_get_data (&ghost_tree->elements);
-      /* Compute the element offset of this new tree by adding the offset
-       * of the previous tree to the element count of the previous tree. */
-      ghost_tree->element_offset = *current_element_offset;
-      /* Allocate a new tree_hash for the next search */
-      old_elem_count = 0;
-      tree_hash =
-        (t8_ghost_gtree_hash_t *) sc_mempool_alloc (ghost->glo_tree_mempool);
+    /* skip the elements */
+    if (forest->compress_messages > 0) {
+      element_bytes = *(size_t *) (message->buffer + bytes_read);
+      bytes_read += sizeof (size_t);
+      bytes_read += T8_ADD_PADDING (bytes_read);
     }
     else {
-      /* The entry was found in the trees array */
-      found_tree = *pfound_tree;
-      T8_ASSERT (found_tree->global_id == global_id);
-      /* Get a pointer to the tree */
-      ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
-                                                       found_tree->index);
-      T8_ASSERT (ghost_tree->eclass == eclass);
-      T8_ASSERT (ghost_tree->global_id == global_id);
-      T8_ASSERT (ghost_tree->elements.scheme == ts);
-
-      old_elem_count = t8_element_array_get_count (&ghost_tree->elements);
-
-      /* Grow the elements array of the tree to fit the new elements */
-      t8_element_array_resize (&ghost_tree->elements,
-                               old_elem_count + num_elements);
-      /* Get a pointer to where the new elements are to be inserted */
-      element_insert = t8_element_array_index_locidx (&ghost_tree->elements,
-                                                      old_elem_count);
-    }
-    if (itree == 0) {
-      /* We store the index of the first tree and the first element of this
-       * rank */
-      first_tree_index = found_tree->index;
-      first_element_index = old_elem_count;
-    }
-    /* Insert the new elements */
-    memcpy (element_insert, recv_buffer + bytes_read,
-            num_elements * ts->t8_element_size ());
-
-    bytes_read += num_elements * ts->t8_element_size ();
+      ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+      element_bytes = tree->num_elements * ts->t8_element_size ();
+    }
+    tree->data_offset = bytes_read;
+    bytes_read += element_bytes;
     bytes_read += T8_ADD_PADDING (bytes_read);
-    *current_element_offset += num_elements;
-  }
-  T8_ASSERT (bytes_read == (size_t) recv_bytes);
-  T8_FREE (recv_buffer);
-
-  /* At last we add the receiving rank to the ghosts process_offset hash table */
-  process_hash =
-    (t8_ghost_process_hash_t *) sc_mempool_alloc (ghost->proc_offset_mempool);
-  process_hash->mpirank = recv_rank;
-  process_hash->tree_index = first_tree_index;
-  process_hash->first_element = first_element_index;
-  process_hash->ghost_offset = ghosts_offset;
-  /* Insert this rank into the hash table. We assert if the rank was not already
-   * contained. */
+  }
+  T8_ASSERT (bytes_read == (size_t) message->bytes);
+}
+
+/* Allocate the element array of the ghost tree with index itree
+ * for num_elements elements. */
+static void
+t8_forest_ghost_tree_allocate (t8_forest_t forest, t8_forest_ghost_t ghost,
+                               size_t itree, size_t num_elements)
+{
+  t8_ghost_tree_t    *ghost_tree;
+
+  ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees, itree);
+  t8_element_array_init_size (&ghost_tree->elements,
+                              t8_forest_get_eclass_scheme (forest,
+                                                           ghost_tree->eclass),
+                              num_elements);
+}
+
+/* Build the ghost trees from the received messages of all remote processes,
+ * which are given in order of the ranks in ghost->remote_processes.
+ * Since each process sends its trees in ascending order and the processes
+ * own ascending ranges of trees, all trees are in ascending order of their
+ * global id, where a tree can only continue with the first tree of the next
+ * message. Thus the merge of the messages is a concatenation, which we
+ * compute with one pass over the trees. Afterwards we know where the
+ * elements of each message are stored and copy them in parallel.
+ * The buffers of the messages are freed. */
+static void
+t8_forest_ghost_merge_received_messages (t8_forest_t forest,
+                                         t8_forest_ghost_t ghost,
+                                         t8_ghost_message_t * messages)
+{
+  t8_ghost_message_t *message;
+  t8_ghost_message_tree_t *tree;
+  t8_ghost_tree_t    *ghost_tree;
+  t8_ghost_gtree_hash_t *tree_hash;
+  t8_ghost_process_hash_t *process_hash;
+  t8_locidx_t         current_element_offset = 0;
+  size_t              itree, num_tree_elements = 0, ghosts_offset;
+  int                 num_remotes, iremote;
+#ifdef T8_ENABLE_OPENMP
+  int                 num_threads;
+#endif
 #ifdef T8_ENABLE_DEBUG
-  added_process =
+  int                 added;
+#endif
+
+  T8_ASSERT (ghost->ghost_trees->elem_count == 0);
+  num_remotes = ghost->remote_processes->elem_count;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    message = messages + iremote;
+    ghosts_offset = ghost->num_ghosts_elements;
+    for (itree = 0; itree < message->trees.elem_count; itree++) {
+      tree = (t8_ghost_message_tree_t *) sc_array_index (&message->trees,
+                                                        itree);
+      ghost_tree = ghost->ghost_trees->elem_count == 0 ? NULL :
+        (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
+                                            ghost->ghost_trees->elem_count -
+                                            1);
+      if (ghost_tree == NULL || ghost_tree->global_id != tree->global_id) {
+        /* This is a new tree */
+        T8_ASSERT (ghost_tree == NULL
+                   || ghost_tree->global_id < tree->global_id);
+        if (ghost_tree != NULL) {
+          t8_forest_ghost_tree_allocate (forest, ghost,
+                                         ghost->ghost_trees->elem_count - 1,
+                                         num_tree_elements);
+        }
+        ghost_tree = (t8_ghost_tree_t *) sc_array_push (ghost->ghost_trees);
+        ghost_tree->global_id = tree->global_id;
+        ghost_tree->eclass = tree->eclass;
+        ghost_tree->element_offset = current_element_offset;
+        /* The structure of arrays is filled when all ghosts are received */
+        memset (&ghost_tree->soa, 0, sizeof (t8_element_array_soa_t));
+        num_tree_elements = 0;
+        /* Insert the tree into the hash table of the global ids */
+        tree_hash = (t8_ghost_gtree_hash_t *)
+          sc_mempool_alloc (ghost->glo_tree_mempool);
+        tree_hash->global_id = tree->global_id;
+        tree_hash->index = ghost->ghost_trees->elem_count - 1;
+#ifdef T8_ENABLE_DEBUG
+        added =
 #else
-  (void)
+        (void)
+#endif
+          sc_hash_insert_unique (ghost->global_tree_to_ghost_tree, tree_hash,
+                                 NULL);
+        T8_ASSERT (added);
+      }
+      T8_ASSERT (ghost_tree->eclass == tree->eclass);
+      tree->ghost_tree = ghost->ghost_trees->elem_count - 1;
+      tree->first_element = num_tree_elements;
+      num_tree_elements += tree->num_elements;
+      current_element_offset += tree->num_elements;
+      ghost->num_ghosts_elements += tree->num_elements;
+    }
+
+    /* Add the remote rank to the ghosts process_offset hash table */
+    process_hash = (t8_ghost_process_hash_t *)
+      sc_mempool_alloc (ghost->proc_offset_mempool);
+    process_hash->mpirank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    if (message->trees.elem_count > 0) {
+      tree = (t8_ghost_message_tree_t *) sc_array_index (&message->trees, 0);
+      process_hash->tree_index = tree->ghost_tree;
+      process_hash->first_element = tree->first_element;
+    }
+    else {
+      process_hash->tree_index = 0;
+      process_hash->first_element = 0;
+    }
+    process_hash->ghost_offset = ghosts_offset;
+    /* Insert this rank into the hash table. We assert if the rank was not
+     * already contained. */
+#ifdef T8_ENABLE_DEBUG
+    added =
+#else
+    (void)
+#endif
+      sc_hash_insert_unique (ghost->process_offsets, process_hash, NULL);
+    T8_ASSERT (added);
+  }
+  if (ghost->ghost_trees->elem_count > 0) {
+    t8_forest_ghost_tree_allocate (forest, ghost,
+                                   ghost->ghost_trees->elem_count - 1,
+                                   num_tree_elements);
+  }
+
+  /* Copy the elements of all messages into the ghost trees */
+#ifdef T8_ENABLE_OPENMP
+  num_threads = t8_forest_get_num_threads (forest);
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
 #endif
-    sc_hash_insert_unique (ghost->process_offsets, process_hash, NULL);
-  T8_ASSERT (added_process);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    t8_ghost_message_t *const message_c = messages + iremote;
+    size_t              itree_c;
+
+    for (itree_c = 0; itree_c < message_c->trees.elem_count; itree_c++) {
+      const t8_ghost_message_tree_t *const tree_c =
+        (const t8_ghost_message_tree_t *)
+        sc_array_index (&message_c->trees, itree_c);
+      t8_ghost_tree_t    *const ghost_tree_c =
+        (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
+                                            tree_c->ghost_tree);
+
+      if (tree_c->num_elements > 0 && forest->compress_messages > 0) {
+        (void) t8_element_array_decode (&ghost_tree_c->elements,
+                                        tree_c->first_element,
+                                        tree_c->num_elements,
+                                        forest->maxlevel,
+                                        message_c->buffer +
+                                        tree_c->data_offset);
+      }
+      else if (tree_c->num_elements > 0) {
+        memcpy (t8_element_array_index_locidx (&ghost_tree_c->elements,
+                                               tree_c->first_element),
+                message_c->buffer + tree_c->data_offset,
+                tree_c->num_elements *
+                ghost_tree_c->elements.scheme->t8_element_size ());
+      }
+    }
+  }
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (&messages[iremote].trees);
+    T8_FREE (messages[iremote].buffer);
+  }
 }
 
 /* In forest_ghost_receive we need a lookup table to give us the position
@@ -1592,8 +2277,9 @@ t8_recv_list_entry_equal (const void *v1, const void *v2, const void *u)
 }
 
 /* Probe for all incoming messages from the remote ranks and receive them.
- * We receive the message in the order in which they arrive. To achieve this,
- * we have to use polling. */
+ * We receive the messages in the order in which they arrive and read the
+ * trees of each message directly after it arrived. When all messages are
+ * received, we merge them into the ghost trees. */
 static void
 t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
 {
@@ -1601,8 +2287,16 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
   int                 proc_pos;
   int                 recv_rank;
   int                 mpiret;
+  int                 received_messages;
   sc_MPI_Comm         comm;
   sc_MPI_Status       status;
+  t8_ghost_message_t *messages;
+  t8_recv_list_entry_t **pfound, *found;
+  t8_recv_list_entry_t recv_list_entry, *recv_list_entries;
+  sc_hash_t          *recv_list_entries_hash;
+#ifdef T8_ENABLE_DEBUG
+  int                 ret;
+#endif
 
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (ghost != NULL);
@@ -1616,232 +2310,626 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
     return;
   }
 
-  {
-    /*       This code receives the message in order of their arrival.
-     *       This is effective in terms of runtime, but makes it more difficult
-     *       to store the received data, since the data has to be stored in order of
-     *       ascending ranks.
-     *       We include the received data into the ghost structure in order of the
-     *       ranks of the receivers and we do this as soon as the message from
-     *       the next rank that we can include was received. */
-    char              **buffer;
-    int                *recv_bytes;
-    int                 received_messages = 0;
-    int                *received_flag;
-    int                 last_rank_parsed = -1, parse_it;
-#undef T8_POLLING               /* activates polling for Mpi messages, currently used for testing */
-#ifdef T8_POLLING
-    sc_link_t          *proc_it, *prev;
-    int                 iprobe_flag;
-    sc_list_t          *receivers;
-#else
-    t8_recv_list_entry_t **pfound, *found;
-#ifdef T8_ENABLE_DEBUG
-    int                 ret;
-#endif
-    sc_hash_t          *recv_list_entries_hash;
-#endif
-    t8_recv_list_entry_t recv_list_entry, *recv_list_entries;
-    t8_locidx_t         current_element_offset = 0;
-
-    buffer = T8_ALLOC (char *, num_remotes);
-    recv_bytes = T8_ALLOC (int, num_remotes);
-    received_flag = T8_ALLOC_ZERO (int, num_remotes);
-    recv_list_entries = T8_ALLOC (t8_recv_list_entry_t, num_remotes);
-
-    /* Sort the array of remote processes, such that the ranks are in
-     * ascending order. */
-    sc_array_sort (ghost->remote_processes, sc_int_compare);
-
-    /* We build a hash table of all ranks from which we receive and their position
-     * in the remote_processes array. */
-#ifdef T8_POLLING               /* polling */
-    receivers = sc_list_new (NULL);
-#else
-    recv_list_entries_hash = sc_hash_new (t8_recv_list_entry_hash,
-                                          t8_recv_list_entry_equal, NULL,
-                                          NULL);
-#endif
-    for (proc_pos = 0; proc_pos < num_remotes; proc_pos++) {
-      recv_list_entries[proc_pos].rank =
-        *(int *) sc_array_index_int (ghost->remote_processes, proc_pos);
-      recv_list_entries[proc_pos].pos_in_remote_processes = proc_pos;
-#ifndef T8_POLLING
+  messages = T8_ALLOC_ZERO (t8_ghost_message_t, num_remotes);
+  recv_list_entries = T8_ALLOC (t8_recv_list_entry_t, num_remotes);
+
+  /* Sort the array of remote processes, such that the ranks are in
+   * ascending order. */
+  sc_array_sort (ghost->remote_processes, sc_int_compare);
+
+  /* We build a hash table of all ranks from which we receive and their position
+   * in the remote_processes array. */
+  recv_list_entries_hash = sc_hash_new (t8_recv_list_entry_hash,
+                                        t8_recv_list_entry_equal, NULL, NULL);
+  for (proc_pos = 0; proc_pos < num_remotes; proc_pos++) {
+    recv_list_entries[proc_pos].rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, proc_pos);
+    recv_list_entries[proc_pos].pos_in_remote_processes = proc_pos;
 #ifdef T8_ENABLE_DEBUG
-      ret =
+    ret =
 #else
-      (void)
-#endif
-        sc_hash_insert_unique (recv_list_entries_hash,
-                               recv_list_entries + proc_pos, NULL);
-      T8_ASSERT (ret == 1);
-#else /* polling */
-      sc_list_append (receivers, recv_list_entries + proc_pos);
+    (void)
 #endif
-    }
+      sc_hash_insert_unique (recv_list_entries_hash,
+                             recv_list_entries + proc_pos, NULL);
+    T8_ASSERT (ret == 1);
+  }
 
-  /****     Actual communication    ****/
-
-    /* Until there is only one sender left we iprobe for a message for each
-     * sender and if there is one we receive it and remove the sender from
-     * the list.
-     * The last message can be received via probe */
-#ifdef T8_POLLING
-    while (received_messages < num_remotes - 1) {
-      /* TODO: This part of the code using polling and IProbe to receive the
-       *       messages. We replaced with a non-polling version that uses the
-       *       blocking Probe. */
-      iprobe_flag = 0;
-      prev = NULL;              /* ensure that if the first receive entry is matched first,
-                                   it is removed properly. */
-      for (proc_it = receivers->first; proc_it != NULL && iprobe_flag == 0;) {
-        /* pointer to the rank of a receiver */
-        recv_rank = ((t8_recv_list_entry_t *) proc_it->data)->rank;
-        proc_pos =
-          ((t8_recv_list_entry_t *) proc_it->data)->pos_in_remote_processes;
-
-        mpiret = sc_MPI_Iprobe (recv_rank, T8_MPI_GHOST_FOREST, comm,
-                                &iprobe_flag, &status);
-        SC_CHECK_MPI (mpiret);
-#else
-    while (received_messages < num_remotes) {
-      /* blocking probe for a message. */
-      mpiret = sc_MPI_Probe (sc_MPI_ANY_SOURCE, T8_MPI_GHOST_FOREST, comm,
-                             &status);
-      SC_CHECK_MPI (mpiret);
-#endif
-#ifdef T8_POLLING
-      if (iprobe_flag == 0) {
-        /* There is no message to receive, we continue */
-        prev = proc_it;
-        proc_it = proc_it->next;
-      }
-      else {
-#else
-      /* There is a message to receive, we receive it. */
-      recv_rank = status.MPI_SOURCE;
-      /* Get the position of this rank in the remote processes array */
-      recv_list_entry.rank = recv_rank;
+  /* Receive the messages in order of their arrival
+   * and read the trees of each message */
+  for (received_messages = 0; received_messages < num_remotes;
+       received_messages++) {
+    /* blocking probe for a message. */
+    mpiret = sc_MPI_Probe (sc_MPI_ANY_SOURCE, T8_MPI_GHOST_FOREST, comm,
+                           &status);
+    SC_CHECK_MPI (mpiret);
+    recv_rank = status.MPI_SOURCE;
+    /* Get the position of this rank in the remote processes array */
+    recv_list_entry.rank = recv_rank;
 #ifdef T8_ENABLE_DEBUG
-      ret =
+    ret =
 #else
-      (void)
-#endif
-        sc_hash_lookup (recv_list_entries_hash, &recv_list_entry,
-                        (void ***) &pfound);
-      T8_ASSERT (ret != 0);
-      found = *pfound;
-      proc_pos = found->pos_in_remote_processes;
+    (void)
 #endif
-      T8_ASSERT (status.MPI_TAG == T8_MPI_GHOST_FOREST);
-      buffer[proc_pos] =
-        t8_forest_ghost_receive_message (recv_rank, comm, status,
-                                         recv_bytes + proc_pos);
-      /* mark this entry as received. */
-      T8_ASSERT (received_flag[proc_pos] == 0);
-      received_flag[proc_pos] = 1;
-      received_messages++;
-      /* Parse all messages that we can parse now.
-       * We have to parse the messages in order of their rank. */
-      T8_ASSERT (last_rank_parsed < proc_pos);
-      /* For all ranks that we haven't parsed yet, but can be parsed in order */
-      for (parse_it = last_rank_parsed + 1; parse_it < num_remotes &&
-           received_flag[parse_it] == 1; parse_it++) {
-        recv_rank =
-          *(int *) sc_array_index_int (ghost->remote_processes, parse_it);
-        t8_forest_ghost_parse_received_message (forest, ghost,
-                                                &current_element_offset,
-                                                recv_rank, buffer[parse_it],
-                                                recv_bytes[parse_it]);
-        last_rank_parsed++;
-      }
+      sc_hash_lookup (recv_list_entries_hash, &recv_list_entry,
+                      (void ***) &pfound);
+    T8_ASSERT (ret != 0);
+    found = *pfound;
+    proc_pos = found->pos_in_remote_processes;
+    T8_ASSERT (messages[proc_pos].buffer == NULL);
+    messages[proc_pos].buffer =
+      t8_forest_ghost_receive_message (recv_rank, comm, status,
+                                       &messages[proc_pos].bytes);
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_RECEIVE_PARSE);
+    t8_forest_ghost_scan_received_message (forest, messages + proc_pos,
+                                           recv_rank);
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_RECEIVE_PARSE);
+  }
 
-#ifdef T8_POLLING               /* polling */
-      /* Remove the process from the list of receivers. */
-      proc_it = proc_it->next;
-      sc_list_remove (receivers, prev);
-    }
-  }                             /* end for */
-#endif
-#if 0
-  {                             /* this is for indent */
-    {
-#endif
-    }                           /* end while */
-#ifdef T8_POLLING
-    /* polling */
-    T8_ASSERT (receivers->elem_count == 1);
-    /* Get the last rank from which we didnt receive yet */
-    recv_list_entry = *(t8_recv_list_entry_t *) sc_list_pop (receivers);
-    recv_rank = recv_list_entry.rank;
-    proc_pos = recv_list_entry.pos_in_remote_processes;
-    /* destroy the list */
-    sc_list_destroy (receivers);
-    /* Blocking probe for the last message */
-    mpiret = sc_MPI_Probe (recv_rank, T8_MPI_GHOST_FOREST, comm, &status);
-    SC_CHECK_MPI (mpiret);
-    /* Receive the message */
-    T8_ASSERT (received_flag[proc_pos] == 0);
-    buffer[proc_pos] = t8_forest_ghost_receive_message (recv_rank, comm,
-                                                        status,
-                                                        recv_bytes +
-                                                        proc_pos);
-    received_flag[proc_pos] = 1;
-    received_messages++;
-    T8_ASSERT (received_messages == num_remotes);
-    /* parse all messages that are left */
-    /* For all ranks that we haven't parsed yet, but can be parsed in order */
-    for (parse_it = last_rank_parsed + 1; parse_it < num_remotes &&
-         received_flag[parse_it] == 1; parse_it++) {
-      recv_rank =
-        *(int *) sc_array_index_int (ghost->remote_processes, parse_it);
-      t8_forest_ghost_parse_received_message (forest, ghost,
-                                              &current_element_offset,
-                                              recv_rank, buffer[parse_it],
-                                              recv_bytes[parse_it]);
-      last_rank_parsed++;
+  /* Build the ghost trees from all messages */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_RECEIVE_PARSE);
+  t8_forest_ghost_merge_received_messages (forest, ghost, messages);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_RECEIVE_PARSE);
+
+  /* clean-up */
+  sc_hash_destroy (recv_list_entries_hash);
+  T8_FREE (messages);
+  T8_FREE (recv_list_entries);
+}
+
+/* Compute the structure of arrays of the elements of each ghost tree.
+ * The linear ids are computed at the maxlevel of the forest, such that
+ * they can be used to search for the leaf ancestors of elements. */
+static void
+t8_forest_ghost_init_soa (t8_forest_t forest, t8_forest_ghost_t ghost)
+{
+  size_t              itree;
+  t8_ghost_tree_t    *ghost_tree;
+
+  for (itree = 0; itree < ghost->ghost_trees->elem_count; itree++) {
+    ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
+                                                     itree);
+    t8_element_array_soa_init (&ghost_tree->soa, &ghost_tree->elements,
+                               forest->maxlevel);
+  }
+}
+
+/* Store the indices in the element data of the elements that we send to
+ * a remote process in indices. Return the number of these elements. */
+static              t8_locidx_t
+t8_forest_ghost_exchange_plan_indices (t8_forest_t forest, int remote,
+                                       t8_locidx_t * indices)
+{
+  t8_ghost_remote_t  *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  t8_tree_t           local_tree;
+  t8_locidx_t         itree, ielement, num_indices = 0;
+  size_t              elem_count;
+
+  remote_entry = t8_forest_ghost_get_remote (forest, remote);
+  for (itree = 0; itree < (t8_locidx_t) remote_entry->remote_trees.elem_count;
+       itree++) {
+    remote_tree = (t8_ghost_remote_tree_t *)
+      t8_sc_array_index_locidx (&remote_entry->remote_trees, itree);
+    local_tree = t8_forest_get_tree (forest,
+                                     t8_forest_get_local_id (forest,
+                                                             remote_tree->
+                                                             global_id));
+    elem_count = t8_element_array_get_count (&remote_tree->elements);
+    for (ielement = 0; ielement < (t8_locidx_t) elem_count; ielement++) {
+      indices[num_indices++] = local_tree->elements_offset + *(t8_locidx_t *)
+        t8_sc_array_index_locidx (&remote_tree->element_indices, ielement);
     }
-#endif
-#ifdef T8_ENABLE_DEBUG
-    for (parse_it = 0; parse_it < num_remotes; parse_it++) {
-      T8_ASSERT (received_flag[parse_it] == 1);
+  }
+  T8_ASSERT (num_indices == remote_entry->num_elements);
+  return num_indices;
+}
+
+/* Compute the runs of consecutive local elements that we send to each
+ * remote process, if they were not computed yet. The elements that we send
+ * to a remote are sorted by their local index and usually form few runs
+ * along the process boundary, such that the send buffer of a remote is
+ * packed with one memcpy per run. A remote with a single run is sent
+ * directly from the element data. */
+static void
+t8_forest_ghost_send_runs (t8_forest_t forest, t8_forest_ghost_t ghost)
+{
+  t8_locidx_t        *indices, *runs;
+  t8_locidx_t         num_send, isend, num_runs;
+  int                 num_remotes, iremote, remote_rank;
+
+  T8_ASSERT (ghost != NULL);
+  if (ghost->send_runs != NULL) {
+    return;
+  }
+  num_remotes = ghost->remote_processes->elem_count;
+  ghost->send_run_offsets = T8_ALLOC (t8_locidx_t, num_remotes + 1);
+  /* There are at most as many runs as elements that we send */
+  runs = T8_ALLOC (t8_locidx_t, 2 * SC_MAX (ghost->num_remote_elements, 1));
+  indices = T8_ALLOC (t8_locidx_t, SC_MAX (ghost->num_remote_elements, 1));
+  num_runs = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    ghost->send_run_offsets[iremote] = num_runs;
+    num_send = t8_forest_ghost_exchange_plan_indices (forest, remote_rank,
+                                                      indices);
+    for (isend = 0; isend < num_send; isend++) {
+      if (isend > 0 && indices[isend] == indices[isend - 1] + 1) {
+        /* This element continues the last run */
+        runs[2 * num_runs - 1]++;
+      }
+      else {
+        runs[2 * num_runs] = indices[isend];
+        runs[2 * num_runs + 1] = 1;
+        num_runs++;
+      }
     }
-#endif
-    T8_ASSERT (last_rank_parsed == num_remotes - 1);
+  }
+  ghost->send_run_offsets[num_remotes] = num_runs;
+  ghost->send_runs = T8_REALLOC (runs, t8_locidx_t, 2 * SC_MAX (num_runs, 1));
+  T8_FREE (indices);
+}
 
-    /* clean-up */
-#ifndef T8_POLLING
-    sc_hash_destroy (recv_list_entries_hash);
-#endif
-    T8_FREE (buffer);
-    T8_FREE (received_flag);
-    T8_FREE (recv_list_entries);
-    T8_FREE (recv_bytes);
+/* Send the remote elements to the remote processes, receive the ghost
+ * elements from them and store their levels and linear ids. */
+static void
+t8_forest_ghost_communicate_elements (t8_forest_t forest,
+                                      t8_forest_ghost_t ghost)
+{
+  t8_ghost_mpi_send_info_t *send_info;
+  sc_MPI_Request     *requests;
+
+  /* Start sending the remote elements */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_SEND);
+  send_info = t8_forest_ghost_send_start (forest, ghost, &requests);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_SEND);
+
+  /* Reveive the ghost elements from the remote processes */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_RECEIVE);
+  t8_forest_ghost_receive (forest, ghost);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_RECEIVE);
+
+  /* End sending the remote elements */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_SEND);
+  t8_forest_ghost_send_end (forest, ghost, send_info, requests);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_SEND);
+
+  /* Store the levels and linear ids of the ghost elements contiguously */
+  t8_forest_ghost_init_soa (forest, ghost);
+}
+
+/* A process to which a local element is sent as ghost, together with the
+ * layer of the element on that process. */
+typedef struct
+{
+  int                 rank;     /* The rank of the process */
+  int                 layer;    /* The layer of the element on this process */
+} t8_ghost_rank_layer_t;
 
+/* Compare two rank-layer pairs by rank and then by layer. */
+static int
+t8_ghost_rank_layer_compare (const void *pa, const void *pb)
+{
+  const t8_ghost_rank_layer_t *A = (const t8_ghost_rank_layer_t *) pa;
+  const t8_ghost_rank_layer_t *B = (const t8_ghost_rank_layer_t *) pb;
+
+  if (A->rank != B->rank) {
+    return A->rank < B->rank ? -1 : 1;
   }
+  return (A->layer > B->layer) - (A->layer < B->layer);
+}
 
-#if 0
-  /* Receive the message in order of the sender's rank,
-   * this is a non-optimized version of the code below.
-   * slow but simple. */
+/* Send the current remote processes of the elements that we send to
+ * each remote process of the first ghost layer and receive the remote
+ * processes of our ghosts from them.
+ * On output ghost_sets[i] points to the number of remote processes of
+ * ghost i followed by these processes. The pointers refer to the memory
+ * in recv_buffers, which has one entry for each remote process. */
+static void
+t8_forest_ghost_layers_exchange_sets (t8_forest_t forest,
+                                      const t8_locidx_t * send_offsets,
+                                      const t8_locidx_t * send_indices,
+                                      const t8_locidx_t * set_offsets,
+                                      const t8_ghost_rank_layer_t * sets,
+                                      int **recv_buffers, int **ghost_sets)
+{
+  t8_forest_ghost_t   ghost = forest->ghosts;
+  sc_array_t         *send_buffers;
+  sc_MPI_Request     *requests;
+  sc_MPI_Status       status;
+  t8_locidx_t         isend, index, iset, ighost, remote_offset;
+  t8_locidx_t         next_offset;
+  int                 num_remotes, iremote, remote_rank, recv_count, pos;
+  int                 mpiret;
 
-  /* Sort the array of remote processes, such that the ranks are in
-   * ascending order. */
-  sc_array_sort (ghost->remote_processes, sc_int_compare);
+  num_remotes = ghost->remote_processes->elem_count;
+  send_buffers = T8_ALLOC (sc_array_t, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, num_remotes);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    /* For each element that we send to this remote, pack the number of
+     * its remote processes followed by the processes */
+    sc_array_init (send_buffers + iremote, sizeof (int));
+    for (isend = send_offsets[iremote]; isend < send_offsets[iremote + 1];
+         isend++) {
+      index = send_indices[isend];
+      *(int *) sc_array_push (send_buffers + iremote) =
+        set_offsets[index + 1] - set_offsets[index];
+      for (iset = set_offsets[index]; iset < set_offsets[index + 1]; iset++) {
+        *(int *) sc_array_push (send_buffers + iremote) = sets[iset].rank;
+      }
+    }
+    mpiret = sc_MPI_Isend (send_buffers[iremote].array,
+                           send_buffers[iremote].elem_count, sc_MPI_INT,
+                           remote_rank, T8_MPI_GHOST_LAYERS, forest->mpicomm,
+                           requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
 
-  for (proc_pos = 0; proc_pos < num_remotes; proc_pos++) {
-    recv_rank =
-      (int *) sc_array_index_int (ghost->remote_processes, proc_pos);
-    /* blocking probe for a message. */
-    mpiret = sc_MPI_Probe (*recv_rank, T8_MPI_GHOST_FOREST, comm, &status);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    mpiret = sc_MPI_Probe (remote_rank, T8_MPI_GHOST_LAYERS, forest->mpicomm,
+                           &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_INT, &recv_count);
     SC_CHECK_MPI (mpiret);
-    /* receive message */
-    buffer =
-      t8_forest_ghost_receive_message (*recv_rank, comm, status, &recv_bytes);
-    t8_forest_ghost_parse_received_message (forest, ghost, *recv_rank, buffer,
-                                            recv_bytes);
+    recv_buffers[iremote] = T8_ALLOC (int, recv_count);
+    mpiret = sc_MPI_Recv (recv_buffers[iremote], recv_count, sc_MPI_INT,
+                          remote_rank, T8_MPI_GHOST_LAYERS, forest->mpicomm,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    /* The ghosts of this remote are stored contiguously and in the same
+     * order as the remote sends its elements */
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    pos = 0;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      T8_ASSERT (pos < recv_count);
+      ghost_sets[ighost] = recv_buffers[iremote] + pos;
+      pos += 1 + recv_buffers[iremote][pos];
+    }
+    T8_ASSERT (pos == recv_count);
+  }
+
+  mpiret = sc_MPI_Waitall (num_remotes, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    sc_array_reset (send_buffers + iremote);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (requests);
+}
+
+/* Extend a face ghost layer of a forest to num_layers layers.
+ * For each local element we compute the set of processes that it is
+ * sent to and its layer on these processes. Layer 1 are the processes
+ * of the given ghost layer. An element is in layer k of a process if
+ * it is not in a smaller layer and a face neighbor is in layer k - 1 or
+ * owned by the process. For the ghost neighbors, the owning process
+ * sends the sets of layer k - 1 in one round of communication with the
+ * processes of the first layer.
+ * Then the ghost structure is rebuilt with the new remote elements and
+ * the layers of the ghosts are exchanged. */
+static void
+t8_forest_ghost_add_layers (t8_forest_t forest, int num_layers)
+{
+  t8_forest_ghost_t   ghost = forest->ghosts;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_ghost_rank_layer_t *set_entries, *candidate, *new_entry;
+  t8_locidx_t        *neigh_offsets, *neigh_indices;
+  t8_locidx_t        *set_offsets, *new_offsets, *set_fill;
+  t8_locidx_t        *send_offsets, *send_indices;
+  t8_locidx_t         num_local, num_ghosts, num_send, ielement, itree;
+  t8_locidx_t         num_tree_elements, ineigh, neighbor, iset, isend;
+  t8_locidx_t         remote_offset, next_offset, ighost, index;
+  sc_array_t          neighbors, candidates, *sets, *new_sets;
+  size_t              icandidate;
+  int               **recv_buffers, **ghost_sets, *ghost_owners;
+  int                 num_remotes, iremote, remote_rank, ilayer, iface;
+  int                 irank;
+
+  T8_ASSERT (ghost != NULL && ghost->ghost_type == T8_GHOST_FACES);
+  T8_ASSERT (num_layers > 1);
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = ghost->num_ghosts_elements;
+  num_remotes = ghost->remote_processes->elem_count;
+
+  /* Store the owner of each ghost */
+  ghost_owners = T8_ALLOC (int, num_ghosts);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : num_ghosts;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      ghost_owners[ighost] = remote_rank;
+    }
+  }
+
+  /* Compute the local and ghost face neighbors of each local element.
+   * The neighbors of element i are neigh_indices[neigh_offsets[i]], ...,
+   * neigh_indices[neigh_offsets[i + 1] - 1]. */
+  neigh_offsets = T8_ALLOC (t8_locidx_t, num_local + 1);
+  sc_array_init (&neighbors, sizeof (t8_locidx_t));
+  neigh_offsets[0] = 0;
+  ielement = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (index = 0; index < num_tree_elements; index++, ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, index);
+      for (iface = 0; iface < ts->t8_element_num_faces (element); iface++) {
+        t8_forest_leaf_face_neighbors_search (forest, itree, element, iface,
+                                              &neighbors, NULL, NULL);
+      }
+      neigh_offsets[ielement + 1] = neighbors.elem_count;
+    }
+  }
+  T8_ASSERT (ielement == num_local);
+  neigh_indices = (t8_locidx_t *) neighbors.array;
+
+  /* The indices of the elements that we send to each remote process of
+   * the first layer */
+  send_offsets = T8_ALLOC (t8_locidx_t, num_remotes + 1);
+  send_offsets[0] = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    send_offsets[iremote + 1] = send_offsets[iremote]
+      + t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+  }
+  num_send = send_offsets[num_remotes];
+  send_indices = T8_ALLOC (t8_locidx_t, num_send);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank,
+                                           send_indices +
+                                           send_offsets[iremote]);
+  }
+
+  /* Layer 1: The processes of element i are
+   * sets[set_offsets[i]], ..., sets[set_offsets[i + 1] - 1], sorted by rank.
+   * Since the remote processes are sorted, so are the sets. */
+  set_offsets = T8_ALLOC_ZERO (t8_locidx_t, num_local + 1);
+  for (isend = 0; isend < num_send; isend++) {
+    set_offsets[send_indices[isend] + 1]++;
+  }
+  for (ielement = 0; ielement < num_local; ielement++) {
+    set_offsets[ielement + 1] += set_offsets[ielement];
+  }
+  sets = sc_array_new_count (sizeof (t8_ghost_rank_layer_t), num_send);
+  set_fill = T8_ALLOC (t8_locidx_t, num_local);
+  memcpy (set_fill, set_offsets, num_local * sizeof (t8_locidx_t));
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    for (isend = send_offsets[iremote]; isend < send_offsets[iremote + 1];
+         isend++) {
+      new_entry = (t8_ghost_rank_layer_t *)
+        sc_array_index (sets, set_fill[send_indices[isend]]++);
+      new_entry->rank = remote_rank;
+      new_entry->layer = 1;
+    }
+  }
+  T8_FREE (set_fill);
+
+  /* Compute the further layers, one round of communication each */
+  recv_buffers = T8_ALLOC (int *, num_remotes);
+  ghost_sets = T8_ALLOC (int *, num_ghosts);
+  sc_array_init (&candidates, sizeof (t8_ghost_rank_layer_t));
+  for (ilayer = 2; ilayer <= num_layers; ilayer++) {
+    t8_forest_ghost_layers_exchange_sets (forest, send_offsets, send_indices,
+                                          set_offsets,
+                                          (t8_ghost_rank_layer_t *)
+                                          sets->array, recv_buffers,
+                                          ghost_sets);
+    set_entries = (t8_ghost_rank_layer_t *) sets->array;
+    new_offsets = T8_ALLOC (t8_locidx_t, num_local + 1);
+    new_offsets[0] = 0;
+    new_sets = sc_array_new (sizeof (t8_ghost_rank_layer_t));
+    for (ielement = 0; ielement < num_local; ielement++) {
+      /* Collect the current processes of the element and the processes
+       * of its neighbors with the new layer */
+      sc_array_truncate (&candidates);
+      for (iset = set_offsets[ielement]; iset < set_offsets[ielement + 1];
+           iset++) {
+        *(t8_ghost_rank_layer_t *) sc_array_push (&candidates) =
+          set_entries[iset];
+      }
+      for (ineigh = neigh_offsets[ielement];
+           ineigh < neigh_offsets[ielement + 1]; ineigh++) {
+        neighbor = neigh_indices[ineigh];
+        if (neighbor < num_local) {
+          for (iset = set_offsets[neighbor]; iset < set_offsets[neighbor + 1];
+               iset++) {
+            candidate =
+              (t8_ghost_rank_layer_t *) sc_array_push (&candidates);
+            candidate->rank = set_entries[iset].rank;
+            candidate->layer = ilayer;
+          }
+        }
+        else {
+          ighost = neighbor - num_local;
+          candidate = (t8_ghost_rank_layer_t *) sc_array_push (&candidates);
+          candidate->rank = ghost_owners[ighost];
+          candidate->layer = ilayer;
+          for (irank = 1; irank <= ghost_sets[ighost][0]; irank++) {
+            if (ghost_sets[ighost][irank] != forest->mpirank) {
+              candidate =
+                (t8_ghost_rank_layer_t *) sc_array_push (&candidates);
+              candidate->rank = ghost_sets[ighost][irank];
+              candidate->layer = ilayer;
+            }
+          }
+        }
+      }
+      /* Keep each process once with its smallest layer */
+      sc_array_sort (&candidates, t8_ghost_rank_layer_compare);
+      for (icandidate = 0; icandidate < candidates.elem_count; icandidate++) {
+        candidate =
+          (t8_ghost_rank_layer_t *) sc_array_index (&candidates, icandidate);
+        if (icandidate == 0 || candidate->rank != (candidate - 1)->rank) {
+          *(t8_ghost_rank_layer_t *) sc_array_push (new_sets) = *candidate;
+        }
+      }
+      new_offsets[ielement + 1] = new_sets->elem_count;
+    }
+    for (iremote = 0; iremote < num_remotes; iremote++) {
+      T8_FREE (recv_buffers[iremote]);
+    }
+    T8_FREE (set_offsets);
+    sc_array_destroy (sets);
+    set_offsets = new_offsets;
+    sets = new_sets;
+  }
+  sc_array_reset (&candidates);
+  sc_array_reset (&neighbors);
+  T8_FREE (recv_buffers);
+  T8_FREE (ghost_sets);
+  T8_FREE (ghost_owners);
+  T8_FREE (neigh_offsets);
+  T8_FREE (send_offsets);
+  T8_FREE (send_indices);
+
+  /* Rebuild the ghost structure with the remote elements of all layers */
+  t8_forest_ghost_unref (&forest->ghosts);
+  t8_forest_ghost_init (&forest->ghosts, T8_GHOST_FACES);
+  ghost = forest->ghosts;
+  ghost->num_layers = num_layers;
+  set_entries = (t8_ghost_rank_layer_t *) sets->array;
+  ielement = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (index = 0; index < num_tree_elements; index++, ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, index);
+      for (iset = set_offsets[ielement]; iset < set_offsets[ielement + 1];
+           iset++) {
+        t8_ghost_add_remote (forest, ghost, set_entries[iset].rank, itree,
+                             element, index);
+      }
+    }
+  }
+  t8_forest_ghost_communicate_elements (forest, ghost);
+
+  /* Store the layer of each remote element on its remote process and
+   * send it to this process */
+  num_remotes = ghost->remote_processes->elem_count;
+  ghost->remote_layers = T8_ALLOC (int, ghost->num_remote_elements);
+  send_indices = T8_ALLOC (t8_locidx_t, ghost->num_remote_elements);
+  num_send = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_send +=
+      t8_forest_ghost_exchange_plan_indices (forest, remote_rank,
+                                             send_indices + num_send);
+    for (isend = num_send
+         - t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+         isend < num_send; isend++) {
+      index = send_indices[isend];
+      for (iset = set_offsets[index]; set_entries[iset].rank != remote_rank;
+           iset++) {
+        T8_ASSERT (iset + 1 < set_offsets[index + 1]);
+      }
+      ghost->remote_layers[isend] = set_entries[iset].layer;
+    }
+  }
+  T8_ASSERT (num_send == ghost->num_remote_elements);
+  ghost->ghost_layers = T8_ALLOC (int, ghost->num_ghosts_elements);
+  t8_forest_ghost_exchange_packed (forest, ghost->remote_layers,
+                                   ghost->ghost_layers, sizeof (int));
+  T8_FREE (send_indices);
+  T8_FREE (set_offsets);
+  sc_array_destroy (sets);
+}
+
+/* Replace the hash tables of a constructed ghost structure by arrays
+ * sorted by global tree id and rank. The lookups then use binary search
+ * on contiguous memory instead of hashing and following pointers into
+ * the memory pools. Afterwards no remote elements can be added. */
+static void
+t8_forest_ghost_freeze_lookups (t8_forest_ghost_t ghost)
+{
+  t8_ghost_gtree_hash_t *gtree_entry;
+  t8_ghost_process_hash_t proc_search, **pproc_found;
+  size_t              itree, iremote;
+#ifdef T8_ENABLE_DEBUG
+  int                 ret;
+#endif
+
+  T8_ASSERT (ghost->remotes == NULL);
+
+  /* The ghost trees and their indices */
+  ghost->ghost_tree_ids =
+    sc_array_new_count (sizeof (t8_ghost_gtree_hash_t),
+                        ghost->ghost_trees->elem_count);
+  for (itree = 0; itree < ghost->ghost_trees->elem_count; itree++) {
+    gtree_entry =
+      (t8_ghost_gtree_hash_t *) sc_array_index (ghost->ghost_tree_ids, itree);
+    gtree_entry->global_id =
+      ((t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
+                                           itree))->global_id;
+    gtree_entry->index = itree;
   }
+  sc_array_sort (ghost->ghost_tree_ids, t8_ghost_gtree_compare);
+  T8_ASSERT (ghost->ghost_tree_ids->elem_count ==
+             ghost->global_tree_to_ghost_tree->elem_count);
+
+  /* The process offsets. For each remote process there is one entry.
+   * Since remote_processes is sorted, so is the new array. */
+  ghost->process_offsets_sorted =
+    sc_array_new_count (sizeof (t8_ghost_process_hash_t),
+                        ghost->remote_processes->elem_count);
+  for (iremote = 0; iremote < ghost->remote_processes->elem_count;
+       iremote++) {
+    proc_search.mpirank =
+      *(int *) sc_array_index (ghost->remote_processes, iremote);
+#ifdef T8_ENABLE_DEBUG
+    ret =
+#else
+    (void)
 #endif
+      sc_hash_lookup (ghost->process_offsets, &proc_search,
+                      (void ***) &pproc_found);
+    T8_ASSERT (ret);
+    *(t8_ghost_process_hash_t *)
+      sc_array_index (ghost->process_offsets_sorted, iremote) =
+      **pproc_found;
+  }
+  T8_ASSERT (ghost->process_offsets_sorted->elem_count ==
+             ghost->process_offsets->elem_count);
+
+  /* The remote entries. We take over the array of the hash array. */
+  ghost->remotes = sc_array_new (sizeof (t8_ghost_remote_t));
+  sc_hash_array_rip (ghost->remote_ghosts, ghost->remotes);
+  ghost->remote_ghosts = NULL;
+  sc_array_sort (ghost->remotes, t8_ghost_remote_compare);
+
+  /* Clean-up the hash tables and their memory pools */
+  sc_hash_destroy (ghost->global_tree_to_ghost_tree);
+  sc_hash_destroy (ghost->process_offsets);
+  sc_mempool_destroy (ghost->glo_tree_mempool);
+  sc_mempool_destroy (ghost->proc_offset_mempool);
+  ghost->global_tree_to_ghost_tree = NULL;
+  ghost->process_offsets = NULL;
+  ghost->glo_tree_mempool = NULL;
+  ghost->proc_offset_mempool = NULL;
 }
 
 /* Create one layer of ghost elements, following the algorithm
@@ -1855,19 +2943,83 @@ t8_forest_ghost_receive (t8_forest_t forest, t8_forest_ghost_t ghost)
  *
  * verion 3 with top-down search
  * for unbalanced_version = -1
+ *
+ * If forest_from is not NULL and forest was adapted from it, the remote
+ * elements that did not change are taken from the ghost layer of forest_from.
+ *
+ * If the ghost depth of forest is greater than 1, the further layers
+ * are added with t8_forest_ghost_add_layers.
  */
-void
-t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
+/* Return the synchronization of the one-sided ghost data exchange of
+ * forest, or T8_GHOST_RMA_NONE if the data is exchanged with messages. */
+static              t8_ghost_rma_t
+t8_forest_ghost_exchange_rma (t8_forest_t forest)
 {
-  t8_forest_ghost_t   ghost = NULL;
-  t8_ghost_mpi_send_info_t *send_info;
+#ifdef T8_GHOST_ENABLE_RMA
+  return forest->ghost_rma;
+#else
+  return T8_GHOST_RMA_NONE;
+#endif
+}
+
+#ifdef T8_GHOST_ENABLE_RMA
+/* Compute for each remote process the position of our ghost data in its
+ * one-sided exchange window. In the window of a process the data for its
+ * remotes is stored contiguously in the order of remote_processes, thus
+ * each process sends the offset of each remote's block to that remote. */
+static void
+t8_forest_ghost_rma_displacements (t8_forest_t forest,
+                                   t8_forest_ghost_t ghost)
+{
+  t8_locidx_t        *send_offsets, offset;
   sc_MPI_Request     *requests;
+  int                 num_remotes, iremote, remote_rank, mpiret;
+
+  T8_ASSERT (ghost != NULL && ghost->rma_displacements == NULL);
+  num_remotes = ghost->remote_processes->elem_count;
+  ghost->rma_displacements = T8_ALLOC (t8_locidx_t, num_remotes + 1);
+  send_offsets = T8_ALLOC (t8_locidx_t, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  offset = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    send_offsets[iremote] = offset;
+    offset += t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    mpiret = sc_MPI_Isend (send_offsets + iremote, 1, T8_MPI_LOCIDX,
+                           remote_rank, T8_MPI_GHOST_RMA, forest->mpicomm,
+                           requests + iremote);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Irecv (ghost->rma_displacements + iremote, 1,
+                           T8_MPI_LOCIDX, remote_rank, T8_MPI_GHOST_RMA,
+                           forest->mpicomm, requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+  /* The number of elements in our own window */
+  ghost->rma_displacements[num_remotes] = offset;
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (send_offsets);
+  T8_FREE (requests);
+}
+#endif
+
+static void
+t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version,
+                            t8_forest_t forest_from)
+{
+  t8_forest_ghost_t   ghost = NULL;
   int                 create_tree_array = 0, create_gfirst_desc_array = 0;
   int                 create_element_array = 0;
 
   T8_ASSERT (t8_forest_is_committed (forest));
   t8_global_productionf ("Into t8_forest_ghost with %i local elements.\n",
                          t8_forest_get_local_num_elements (forest));
+  SC_CHECK_ABORT (forest->ghost_depth == 1
+                  || forest->ghost_type == T8_GHOST_FACES,
+                  "Multiple ghost layers are only supported for face "
+                  "neighbors.\n");
 
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of ghost_create */
@@ -1879,6 +3031,8 @@ t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
     t8_global_productionf ("Start ghost at %f  %f\n", sc_MPI_Wtime (),
                            forest->profile->ghost_runtime);
   }
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST);
+  T8_TRACE_BEGIN ("t8_forest_ghost_create");
 
   if (forest->element_offsets == NULL) {
     /* create element offset array if not done already */
@@ -1900,32 +3054,50 @@ t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
     if (forest->ghost_type == T8_GHOST_NONE) {
       t8_debugf ("WARNING: Trying to construct ghosts with ghost_type NONE. "
                  "Ghost layer is not constructed.\n");
+      t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST);
+      T8_TRACE_END ("t8_forest_ghost_create");
       return;
     }
-    /* Currently we only support face ghosts */
-    T8_ASSERT (forest->ghost_type == T8_GHOST_FACES);
-
     /* Initialize the ghost structure */
     t8_forest_ghost_init (&forest->ghosts, forest->ghost_type);
     ghost = forest->ghosts;
 
-    if (unbalanced_version == -1) {
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_GHOST_FILL_REMOTE);
+    if (forest->ghost_type == T8_GHOST_FACES
+        && t8_forest_ghost_can_reuse_remotes (forest, forest_from)) {
+      t8_forest_ghost_fill_remote_incremental (forest, forest_from);
+    }
+    else if (unbalanced_version == -1
+             && forest->ghost_type == T8_GHOST_FACES) {
       t8_forest_ghost_fill_remote_v3 (forest);
     }
     else {
-      /* Construct the remote elements and processes. */
+      /* Construct the remote elements and processes.
+       * The top-down search only supports face neighbors. */
       t8_forest_ghost_fill_remote (forest, ghost, unbalanced_version != 0);
     }
+    if (forest->ghost_type != T8_GHOST_FACES) {
+      t8_forest_ghost_symmetrize_remotes (forest, ghost);
+    }
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST_FILL_REMOTE);
 
-    /* Start sending the remote elements */
-    send_info = t8_forest_ghost_send_start (forest, ghost, &requests);
-
-    /* Reveive the ghost elements from the remote processes */
-    t8_forest_ghost_receive (forest, ghost);
+    /* Communicate the remote and ghost elements */
+    t8_forest_ghost_communicate_elements (forest, ghost);
 
-    /* End sending the remote elements */
-    t8_forest_ghost_send_end (forest, ghost, send_info, requests);
+    if (forest->ghost_depth > 1) {
+      /* Add the further ghost layers. This rebuilds the ghost structure. */
+      t8_forest_ghost_add_layers (forest, forest->ghost_depth);
+      ghost = forest->ghosts;
+    }
 
+    /* From now on we only look up entries in the ghost structure */
+    t8_forest_ghost_freeze_lookups (ghost);
+#ifdef T8_GHOST_ENABLE_RMA
+    if (t8_forest_ghost_exchange_rma (forest) != T8_GHOST_RMA_NONE) {
+      /* Precompute the positions of our ghost data in the remotes' windows */
+      t8_forest_ghost_rma_displacements (forest, ghost);
+    }
+#endif
   }
 
   if (create_element_array) {
@@ -1941,6 +3113,8 @@ t8_forest_ghost_create_ext (t8_forest_t forest, int unbalanced_version)
     t8_shmem_array_destroy (&forest->global_first_desc);
   }
 
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_GHOST);
+  T8_TRACE_END ("t8_forest_ghost_create");
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of ghost_create */
     forest->profile->ghost_runtime += sc_MPI_Wtime ();
@@ -1973,7 +3147,7 @@ t8_forest_ghost_create (t8_forest_t forest)
   T8_ASSERT (t8_forest_is_committed (forest));
   if (forest->mpisize > 1) {
     /* call unbalanced version of ghost algorithm */
-    t8_forest_ghost_create_ext (forest, 1);
+    t8_forest_ghost_create_ext (forest, 1, NULL);
   }
 }
 
@@ -1984,7 +3158,7 @@ t8_forest_ghost_create_balanced_only (t8_forest_t forest)
   if (forest->mpisize > 1) {
     /* TODO: assert that forest is balanced */
     /* Call balanced version of ghost algorithm */
-    t8_forest_ghost_create_ext (forest, 0);
+    t8_forest_ghost_create_ext (forest, 0, NULL);
   }
 }
 
@@ -1993,7 +3167,47 @@ t8_forest_ghost_create_topdown (t8_forest_t forest)
 {
   T8_ASSERT (t8_forest_is_committed (forest));
 
-  t8_forest_ghost_create_ext (forest, -1);
+  t8_forest_ghost_create_ext (forest, -1, NULL);
+}
+
+void
+t8_forest_ghost_create_incremental (t8_forest_t forest,
+                                    t8_forest_t forest_from)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (forest_from == NULL || t8_forest_is_committed (forest_from));
+
+  t8_forest_ghost_create_ext (forest, -1, forest_from);
+}
+
+void
+t8_forest_ghost_ensure (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (!forest->ghost_pending) {
+    return;
+  }
+  /* Reset the flag first, since the creation queries the ghost layer */
+  forest->ghost_pending = 0;
+  T8_ASSERT (forest->ghosts == NULL);
+  t8_debugf ("Creating the deferred ghost layer\n");
+  if (forest->ghost_algorithm == 1) {
+    t8_forest_ghost_create_balanced_only (forest);
+  }
+  else if (forest->ghost_algorithm == 2) {
+    t8_forest_ghost_create (forest);
+  }
+  else {
+    /* The source forest that the incremental version needs is gone */
+    t8_forest_ghost_create_topdown (forest);
+  }
+  if (forest->tree_maps != NULL) {
+    /* Add the coordinate maps of the ghost trees */
+    T8_FREE (forest->tree_maps);
+    forest->tree_maps = NULL;
+    t8_forest_tree_maps_compute (forest);
+  }
 }
 
 /** Return the array of remote ranks.
@@ -2005,6 +3219,7 @@ int                *
 t8_forest_ghost_get_remotes (t8_forest_t forest, int *num_remotes)
 {
   T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
   if (forest->ghosts == NULL) {
     *num_remotes = 0;
     return NULL;
@@ -2053,103 +3268,493 @@ t8_forest_ghost_remote_first_elem (t8_forest_t forest, int remote)
   return proc_entry->ghost_offset;
 }
 
-/* Fill the send buffer for a ghost data exchange for on remote rank.
- * returns the number of bytes in the buffer. */
-static              size_t
-t8_forest_ghost_exchange_fill_send_buffer (t8_forest_t forest, int remote,
-                                           char **pbuffer,
-                                           sc_array_t * element_data)
+t8_locidx_t
+t8_forest_get_num_ghosts_before (t8_forest_t forest)
 {
-  char               *buffer;
-  t8_ghost_remote_t   lookup_rank, *remote_entry;
-  t8_ghost_remote_tree_t *remote_tree;
-  t8_forest_ghost_t   ghost;
-  size_t              index, element_index, data_size;
-  size_t              elements_inserted, byte_count;
-  t8_tree_t           local_tree;
-#ifdef T8_ENABLE_DEBUG
-  int                 ret;
-#endif
-  t8_locidx_t         itree, ielement, element_pos;
-  t8_locidx_t         ltreeid;
-  size_t              elem_count;
-
-  ghost = forest->ghosts;
-  data_size = element_data->elem_size;
-  elements_inserted = 0;
-  lookup_rank.remote_rank = remote;
-
-  /* Lookup the remote entry of this remote process */
-#ifdef T8_ENABLE_DEBUG
-  ret =
-#else
-  (void)
-#endif
-    sc_hash_array_lookup (ghost->remote_ghosts, &lookup_rank, &index);
-  T8_ASSERT (ret != 0);
-  remote_entry =
-    (t8_ghost_remote_t *) sc_array_index (&ghost->remote_ghosts->a, index);
-  T8_ASSERT (remote_entry->remote_rank == remote);
+  int                *remotes, num_remotes, iremote;
 
-  /* allocate memory for the send buffer */
-  byte_count = data_size * remote_entry->num_elements;
-  buffer = *pbuffer = T8_ALLOC (char, byte_count);
-
-  /* We now iterate over the remote trees and their elements to find the
-   * local element indices of the remote elements */
-  for (itree = 0; itree < (t8_locidx_t) remote_entry->remote_trees.elem_count;
-       itree++) {
-    /* tree loop */
-    remote_tree = (t8_ghost_remote_tree_t *)
-      t8_sc_array_index_locidx (&remote_entry->remote_trees, itree);
-    /* Get the local id of this tree */
-    /* TODO: Why does remote_tree store the global id? could be local instead */
-    ltreeid = t8_forest_get_local_id (forest, remote_tree->global_id);
-    /* Get a pointer to the forest tree */
-    local_tree = t8_forest_get_tree (forest, ltreeid);
-    elem_count = t8_element_array_get_count (&remote_tree->elements);
-    for (ielement = 0; ielement < (t8_locidx_t) elem_count; ielement++) {
-      /* element loop */
-      /* Get the index of this remote element in its local tree */
-      element_pos = *(t8_locidx_t *)
-        t8_sc_array_index_locidx (&remote_tree->element_indices, ielement);
-      T8_ASSERT (0 <= element_pos);
-      /* Compute the index of this element in the element_data array */
-      element_index = local_tree->elements_offset + element_pos;
-      /* Copy the data of this element from the element_data array to the send buffer */
-      memcpy (buffer + elements_inserted * data_size,
-              sc_array_index (element_data, element_index), data_size);
-      elements_inserted++;
-    }
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  if (forest->ghosts == NULL) {
+    return 0;
+  }
+  /* The forest is partitioned along the space-filling curve and the ghosts
+   * are ordered by process. Thus, the ghosts of the processes with smaller
+   * rank are exactly the ghosts that precede the local elements. */
+  remotes = t8_forest_ghost_get_remotes (forest, &num_remotes);
+  for (iremote = 0; iremote < num_remotes
+       && remotes[iremote] < forest->mpirank; iremote++) {
+  }
+  if (iremote == num_remotes) {
+    return forest->ghosts->num_ghosts_elements;
   }
-  return byte_count;
+  return t8_forest_ghost_remote_first_elem (forest, remotes[iremote]);
 }
 
-static t8_ghost_data_exchange_t *
-t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
+void
+t8_forest_get_sfc_order (t8_forest_t forest, t8_locidx_t * sfc_to_index,
+                         t8_locidx_t * index_to_sfc)
 {
-  t8_ghost_data_exchange_t *data_exchange;
-  t8_forest_ghost_t   ghost;
+  t8_locidx_t         num_local, num_ghosts, num_before;
+  t8_locidx_t         index, sfc_index;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  num_before = t8_forest_get_num_ghosts_before (forest);
+  /* In SFC order, the ghosts of smaller ranks come first, followed by
+   * the local elements and the ghosts of larger ranks. */
+  for (index = 0; index < num_local + num_ghosts; index++) {
+    if (index < num_local) {
+      sfc_index = num_before + index;
+    }
+    else if (index < num_local + num_before) {
+      sfc_index = index - num_local;
+    }
+    else {
+      sfc_index = index;
+    }
+    if (sfc_to_index != NULL) {
+      sfc_to_index[sfc_index] = index;
+    }
+    if (index_to_sfc != NULL) {
+      index_to_sfc[index] = sfc_index;
+    }
+  }
+}
+
+/* Copy element data between the canonical numbering and the SFC order.
+ * Both orders consist of the three blocks of the ghosts before the local
+ * elements, the local elements and the ghosts after the local elements,
+ * such that we copy each block with one memcpy. */
+static void
+t8_forest_element_data_sfc_copy (t8_forest_t forest, const sc_array_t * src,
+                                 sc_array_t * dest, int to_sfc)
+{
+  t8_locidx_t         num_local, num_ghosts, num_before;
+  size_t              data_size, canonical_pos[3], sfc_pos[3], bytes[3];
+  int                 iblock;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (src != NULL && dest != NULL && src != dest);
+  T8_ASSERT (src->elem_size == dest->elem_size);
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  num_before = t8_forest_get_num_ghosts_before (forest);
+  T8_ASSERT ((t8_locidx_t) src->elem_count == num_local + num_ghosts);
+  T8_ASSERT ((t8_locidx_t) dest->elem_count == num_local + num_ghosts);
+
+  data_size = src->elem_size;
+  /* The ghosts before the local elements */
+  canonical_pos[0] = num_local * data_size;
+  sfc_pos[0] = 0;
+  bytes[0] = num_before * data_size;
+  /* The local elements */
+  canonical_pos[1] = 0;
+  sfc_pos[1] = num_before * data_size;
+  bytes[1] = num_local * data_size;
+  /* The ghosts after the local elements keep their position */
+  canonical_pos[2] = sfc_pos[2] = (num_local + num_before) * data_size;
+  bytes[2] = (num_ghosts - num_before) * data_size;
+  for (iblock = 0; iblock < 3; iblock++) {
+    if (to_sfc) {
+      memcpy (dest->array + sfc_pos[iblock],
+              src->array + canonical_pos[iblock], bytes[iblock]);
+    }
+    else {
+      memcpy (dest->array + canonical_pos[iblock],
+              src->array + sfc_pos[iblock], bytes[iblock]);
+    }
+  }
+}
+
+void
+t8_forest_element_data_to_sfc_order (t8_forest_t forest,
+                                     const sc_array_t * element_data,
+                                     sc_array_t * sfc_data)
+{
+  t8_forest_element_data_sfc_copy (forest, element_data, sfc_data, 1);
+}
+
+void
+t8_forest_element_data_from_sfc_order (t8_forest_t forest,
+                                       const sc_array_t * sfc_data,
+                                       sc_array_t * element_data)
+{
+  t8_forest_element_data_sfc_copy (forest, sfc_data, element_data, 0);
+}
+
+/* Return the number of bytes that we send to a remote rank in
+ * a ghost data exchange. */
+static              size_t
+t8_forest_ghost_exchange_send_bytes (t8_forest_t forest, int remote,
+                                     sc_array_t * element_data)
+{
+  t8_ghost_remote_t  *remote_entry;
+
+  remote_entry = t8_forest_ghost_get_remote (forest, remote);
+  T8_ASSERT (remote_entry->remote_rank == remote);
+  return element_data->elem_size * remote_entry->num_elements;
+}
+
+/* Fill the send buffer for a ghost data exchange for the remote process
+ * with index iremote in remote_processes.
+ * buffer must have space for as many bytes as
+ * t8_forest_ghost_exchange_send_bytes returns. */
+static void
+t8_forest_ghost_exchange_fill_send_buffer (t8_forest_t forest, int iremote,
+                                           char *buffer,
+                                           sc_array_t * element_data)
+{
+  t8_forest_ghost_t   ghost;
+  const t8_locidx_t  *run;
+  t8_locidx_t         irun;
+  size_t              data_size, bytes_inserted;
+
+  ghost = forest->ghosts;
+  t8_forest_ghost_send_runs (forest, ghost);
+  data_size = element_data->elem_size;
+  bytes_inserted = 0;
+  /* Copy each run of elements from the element_data array to the send
+   * buffer at once */
+  for (irun = ghost->send_run_offsets[iremote];
+       irun < ghost->send_run_offsets[iremote + 1]; irun++) {
+    run = ghost->send_runs + 2 * irun;
+    memcpy (buffer + bytes_inserted, sc_array_index (element_data, run[0]),
+            run[1] * data_size);
+    bytes_inserted += run[1] * data_size;
+  }
+  T8_ASSERT (bytes_inserted ==
+             t8_forest_ghost_exchange_send_bytes (forest, *(int *)
+                                                  sc_array_index_int
+                                                  (ghost->remote_processes,
+                                                   iremote), element_data));
+}
+
+/* Return the position in element_data of the data that we send to the
+ * remote process with index iremote, if it is stored contiguously and
+ * zero-copy sends are enabled, see t8_forest_set_ghost_zero_copy.
+ * Return NULL otherwise. */
+static char        *
+t8_forest_ghost_exchange_send_direct (t8_forest_t forest, int iremote,
+                                      sc_array_t * element_data)
+{
+  t8_forest_ghost_t   ghost;
+
+  if (!forest->ghost_zero_copy) {
+    return NULL;
+  }
+  ghost = forest->ghosts;
+  t8_forest_ghost_send_runs (forest, ghost);
+  if (ghost->send_run_offsets[iremote + 1]
+      - ghost->send_run_offsets[iremote] != 1) {
+    return NULL;
+  }
+  return (char *) sc_array_index (element_data,
+                                  ghost->send_runs[2 * ghost->send_run_offsets
+                                                   [iremote]]);
+}
+
+/* Return the communicator of the processes on our node, if the ghost data
+ * of forest is exchanged via shared memory. Return sc_MPI_COMM_NULL
+ * otherwise. */
+static              sc_MPI_Comm
+t8_forest_ghost_exchange_intranode (t8_forest_t forest)
+{
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL;
+#ifdef T8_GHOST_ENABLE_SHMEM
+  sc_MPI_Comm         internode;
+
+  if (forest->ghost_shmem
+      && t8_forest_ghost_exchange_rma (forest) == T8_GHOST_RMA_NONE) {
+    sc_mpi_comm_get_node_comms (forest->mpicomm, &intranode, &internode);
+  }
+#endif
+  return intranode;
+}
+
+#ifdef T8_GHOST_ENABLE_SHMEM
+/* Compute for each remote process its rank in the communicator of our
+ * node, or sc_MPI_UNDEFINED if it is on another node.
+ * Allocate the shared window and fill it with the data for the remotes
+ * on our node. */
+static void
+t8_forest_ghost_exchange_shmem_begin (t8_forest_t forest,
+                                      t8_ghost_data_exchange_t *
+                                      data_exchange, int *node_ranks,
+                                      sc_array_t * element_data)
+{
+  MPI_Group           group, node_group;
+  t8_ghost_shmem_entry_t *entries;
+  char               *window_data;
+  size_t              window_bytes, offset;
+  int                 iremote, ishared, remote_rank, mpiret;
+  int                *remotes;
+
+  data_exchange->num_shared = 0;
+  remotes = NULL;
+  if (data_exchange->num_remotes > 0) {
+    remotes = (int *) forest->ghosts->remote_processes->array;
+    mpiret = MPI_Comm_group (forest->mpicomm, &group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Comm_group (data_exchange->intranode, &node_group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_translate_ranks (group, data_exchange->num_remotes,
+                                        remotes, node_group, node_ranks);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_free (&group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_free (&node_group);
+    SC_CHECK_MPI (mpiret);
+  }
+  /* Count the remotes on our node and the size of our window */
+  window_bytes = sizeof (size_t);
+  for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
+    if (node_ranks[iremote] != sc_MPI_UNDEFINED) {
+      data_exchange->num_shared++;
+      window_bytes += sizeof (t8_ghost_shmem_entry_t)
+        + t8_forest_ghost_exchange_send_bytes (forest, remotes[iremote],
+                                               element_data);
+    }
+  }
+  mpiret = MPI_Win_allocate_shared (window_bytes, 1, MPI_INFO_NULL,
+                                    data_exchange->intranode, &window_data,
+                                    &data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Win_lock_all (MPI_MODE_NOCHECK, data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+
+  data_exchange->shared_ranks = T8_ALLOC (int, data_exchange->num_shared);
+  data_exchange->shared_recv = T8_ALLOC (char *, data_exchange->num_shared);
+  data_exchange->shared_bytes = T8_ALLOC (size_t, data_exchange->num_shared);
+  /* Write the header and the data for each remote on our node */
+  *(size_t *) window_data = data_exchange->num_shared;
+  entries = (t8_ghost_shmem_entry_t *) (window_data + sizeof (size_t));
+  offset = sizeof (size_t)
+    + data_exchange->num_shared * sizeof (t8_ghost_shmem_entry_t);
+  for (iremote = 0, ishared = 0; iremote < data_exchange->num_remotes;
+       iremote++) {
+    if (node_ranks[iremote] != sc_MPI_UNDEFINED) {
+      remote_rank = remotes[iremote];
+      entries[ishared].remote_rank = remote_rank;
+      entries[ishared].offset = offset;
+      t8_forest_ghost_exchange_fill_send_buffer (forest, iremote,
+                                                 window_data + offset,
+                                                 element_data);
+      offset += t8_forest_ghost_exchange_send_bytes (forest, remote_rank,
+                                                     element_data);
+      data_exchange->shared_ranks[ishared++] = node_ranks[iremote];
+    }
+  }
+  T8_ASSERT (offset == window_bytes);
+}
+
+/* Copy the data of the remotes on our node from their windows and
+ * free our window. */
+static void
+t8_forest_ghost_exchange_shmem_end (t8_ghost_data_exchange_t *
+                                    data_exchange)
+{
+  t8_ghost_shmem_entry_t *entries;
+  MPI_Aint            window_bytes;
+  char               *window_data;
+  size_t              ientry, num_entries;
+  int                 ishared, disp_unit, mpiret;
+
+  /* Wait until all processes of the node have filled their windows */
+  mpiret = MPI_Win_sync (data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Barrier (data_exchange->intranode);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Win_sync (data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+
+  for (ishared = 0; ishared < data_exchange->num_shared; ishared++) {
+    mpiret = MPI_Win_shared_query (data_exchange->window,
+                                   data_exchange->shared_ranks[ishared],
+                                   &window_bytes, &disp_unit, &window_data);
+    SC_CHECK_MPI (mpiret);
+    /* Find our entry in the window of the remote process */
+    num_entries = *(size_t *) window_data;
+    entries = (t8_ghost_shmem_entry_t *) (window_data + sizeof (size_t));
+    for (ientry = 0; ientry < num_entries
+         && entries[ientry].remote_rank != data_exchange->mpirank;
+         ientry++) {
+    }
+    T8_ASSERT (ientry < num_entries);
+    T8_ASSERT (entries[ientry].offset + data_exchange->shared_bytes[ishared]
+               <= (size_t) window_bytes);
+    memcpy (data_exchange->shared_recv[ishared],
+            window_data + entries[ientry].offset,
+            data_exchange->shared_bytes[ishared]);
+  }
+
+  /* Wait until all processes of the node have read their data */
+  mpiret = sc_MPI_Barrier (data_exchange->intranode);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Win_unlock_all (data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Win_free (&data_exchange->window);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (data_exchange->shared_ranks);
+  T8_FREE (data_exchange->shared_recv);
+  T8_FREE (data_exchange->shared_bytes);
+}
+#endif
+
+#ifdef T8_GHOST_ENABLE_RMA
+/* Pack the data for all remotes into our window, open the access epoch
+ * and fetch our ghost data from the windows of the remotes. */
+static void
+t8_forest_ghost_exchange_rma_begin (t8_forest_t forest,
+                                    t8_ghost_data_exchange_t *
+                                    data_exchange, sc_array_t * element_data)
+{
+  t8_forest_ghost_t   ghost;
+  MPI_Group           group;
+  char               *window_data;
+  size_t              data_size, ghost_start, offset;
+  t8_locidx_t         window_elements, remote_offset, next_offset;
+  int                 iremote, remote_rank, bytes_recv, mpiret;
+
+  ghost = forest->ghosts;
+  data_size = element_data->elem_size;
+  if (ghost != NULL && ghost->rma_displacements == NULL) {
+    /* The ghost layer was not created for a one-sided exchange */
+    t8_forest_ghost_rma_displacements (forest, ghost);
+  }
+  window_elements =
+    ghost == NULL ? 0 : ghost->rma_displacements[data_exchange->num_remotes];
+  mpiret = MPI_Win_allocate ((MPI_Aint) (window_elements * data_size), 1,
+                             MPI_INFO_NULL, forest->mpicomm, &window_data,
+                             &data_exchange->rma_window);
+  SC_CHECK_MPI (mpiret);
+
+  /* Pack the data for all remotes contiguously into our window */
+  offset = 0;
+  for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    t8_forest_ghost_exchange_fill_send_buffer (forest, iremote,
+                                               window_data + offset,
+                                               element_data);
+    offset += t8_forest_ghost_exchange_send_bytes (forest, remote_rank,
+                                                   element_data);
+    data_exchange->send_requests[iremote] = sc_MPI_REQUEST_NULL;
+    data_exchange->recv_requests[iremote] = sc_MPI_REQUEST_NULL;
+  }
+  T8_ASSERT (offset == window_elements * data_size);
+
+  /* Open the exposure and access epochs */
+  if (data_exchange->rma == T8_GHOST_RMA_FENCE) {
+    mpiret = MPI_Win_fence (MPI_MODE_NOPRECEDE | MPI_MODE_NOPUT,
+                            data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+  }
+  else {
+    T8_ASSERT (data_exchange->rma == T8_GHOST_RMA_PSCW);
+    mpiret = MPI_Comm_group (forest->mpicomm, &group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_incl (group, data_exchange->num_remotes,
+                             data_exchange->num_remotes == 0 ? NULL :
+                             (int *) ghost->remote_processes->array,
+                             &data_exchange->rma_group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_free (&group);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Win_post (data_exchange->rma_group, MPI_MODE_NOPUT,
+                           data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Win_start (data_exchange->rma_group, 0,
+                            data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Fetch the ghost data of each remote to the position of its first
+   * ghost in element_data */
+  ghost_start = t8_forest_get_local_num_elements (forest);
+  for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < data_exchange->num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    bytes_recv = (next_offset - remote_offset) * data_size;
+    mpiret = MPI_Get (sc_array_index (element_data,
+                                      ghost_start + remote_offset),
+                      bytes_recv, MPI_BYTE, remote_rank,
+                      (MPI_Aint) ghost->rma_displacements[iremote]
+                      * data_size, bytes_recv, MPI_BYTE,
+                      data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
+/* Close the epochs of a one-sided exchange and free our window. */
+static void
+t8_forest_ghost_exchange_rma_end (t8_ghost_data_exchange_t * data_exchange)
+{
+  int                 mpiret;
+
+  if (data_exchange->rma == T8_GHOST_RMA_FENCE) {
+    mpiret = MPI_Win_fence (MPI_MODE_NOSUCCEED, data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+  }
+  else {
+    /* Complete our fetches and wait until the remotes completed theirs */
+    mpiret = MPI_Win_complete (data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Win_wait (data_exchange->rma_window);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Group_free (&data_exchange->rma_group);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Win_free (&data_exchange->rma_window);
+  SC_CHECK_MPI (mpiret);
+}
+#endif
+
+t8_ghost_exchange_t
+t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
+{
+  t8_ghost_data_exchange_t *data_exchange;
+  t8_forest_ghost_t   ghost;
   size_t              bytes_to_send, ghost_start;
-  int                 iremote, remote_rank;
+  int                 iremote, ishared, remote_rank;
   int                 mpiret, recv_rank, bytes_recv;
-#ifdef T8_ENABLE_DEBUG
-  int                 ret;
-#endif
-  char              **send_buffers;
-  t8_ghost_process_hash_t lookup_proc, *process_entry, **pfound;
+  char              **send_buffers, *send_data;
+  t8_ghost_process_hash_t *process_entry;
   t8_locidx_t         remote_offset, next_offset;
+  int                *node_ranks;
 
+  t8_debugf ("Entering ghost_exchange_begin\n");
   T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+
+  if (forest->ghosts == NULL
+      && t8_forest_ghost_exchange_intranode (forest) == sc_MPI_COMM_NULL
+      && t8_forest_ghost_exchange_rma (forest) == T8_GHOST_RMA_NONE) {
+    /* This process has no ghosts. If we use shared memory or one-sided
+     * communication, it still takes part in the collective window. */
+    return NULL;
+  }
+
   T8_ASSERT (element_data != NULL);
-  T8_ASSERT (forest->ghosts != NULL);
+  T8_ASSERT ((t8_locidx_t) element_data->elem_count ==
+             t8_forest_get_local_num_elements (forest)
+             + t8_forest_get_num_ghosts (forest));
 
   ghost = forest->ghosts;
 
   /* Allocate the new exchange context */
   data_exchange = T8_ALLOC (t8_ghost_data_exchange_t, 1);
+  data_exchange->forest = forest;
   /* The number of processes we need to send to */
-  data_exchange->num_remotes = ghost->remote_processes->elem_count;
+  data_exchange->num_remotes =
+    ghost == NULL ? 0 : ghost->remote_processes->elem_count;
   /* Allocate MPI requests */
   data_exchange->send_requests = T8_ALLOC (sc_MPI_Request,
                                            data_exchange->num_remotes);
@@ -2157,20 +3762,54 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
                                            data_exchange->num_remotes);
   /* Allocate pointers to send buffers */
   send_buffers = data_exchange->send_buffers =
-    T8_ALLOC (char *, data_exchange->num_remotes);
+    T8_ALLOC_ZERO (char *, data_exchange->num_remotes);
+#ifdef T8_GHOST_ENABLE_RMA
+  data_exchange->rma = t8_forest_ghost_exchange_rma (forest);
+  if (data_exchange->rma != T8_GHOST_RMA_NONE) {
+    /* Fetch the ghost data from the windows of the remotes */
+    data_exchange->intranode = sc_MPI_COMM_NULL;
+    t8_forest_ghost_exchange_rma_begin (forest, data_exchange, element_data);
+    return data_exchange;
+  }
+#endif
+  /* For each remote its rank in the communicator of our node
+   * if we use shared memory, or sc_MPI_UNDEFINED */
+  node_ranks = T8_ALLOC (int, data_exchange->num_remotes);
+  for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
+    node_ranks[iremote] = sc_MPI_UNDEFINED;
+  }
+#ifdef T8_GHOST_ENABLE_SHMEM
+  data_exchange->mpirank = forest->mpirank;
+  data_exchange->intranode = t8_forest_ghost_exchange_intranode (forest);
+  if (data_exchange->intranode != sc_MPI_COMM_NULL) {
+    /* Store the data for the remotes on our node in our shared window */
+    t8_forest_ghost_exchange_shmem_begin (forest, data_exchange, node_ranks,
+                                          element_data);
+  }
+#endif
 
   for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
     /* Iterate over all remote processes and fill their send buffers */
     remote_rank =
       *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    if (node_ranks[iremote] != sc_MPI_UNDEFINED) {
+      /* This remote reads its data from our shared window */
+      data_exchange->send_requests[iremote] = sc_MPI_REQUEST_NULL;
+      continue;
+    }
     /* Fill the send buffers and compute the number of bytes to send */
     bytes_to_send =
-      t8_forest_ghost_exchange_fill_send_buffer (forest, remote_rank,
-                                                 send_buffers + iremote,
-                                                 element_data);
+      t8_forest_ghost_exchange_send_bytes (forest, remote_rank, element_data);
+    send_data =
+      t8_forest_ghost_exchange_send_direct (forest, iremote, element_data);
+    if (send_data == NULL) {
+      send_data = send_buffers[iremote] = T8_ALLOC (char, bytes_to_send);
+      t8_forest_ghost_exchange_fill_send_buffer (forest, iremote,
+                                                 send_data, element_data);
+    }
 
     /* Post the asynchronuos send */
-    mpiret = sc_MPI_Isend (send_buffers[iremote], bytes_to_send, sc_MPI_BYTE,
+    mpiret = sc_MPI_Isend (send_data, bytes_to_send, sc_MPI_BYTE,
                            remote_rank, T8_MPI_GHOST_EXC_FOREST,
                            forest->mpicomm,
                            data_exchange->send_requests + iremote);
@@ -2193,12 +3832,7 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
 
     /* We need to compute the offset in element_data to which we can receive the message */
     /* Search for this process' entry in the ghost struct */
-    lookup_proc.mpirank = recv_rank;
-    ret =
-      sc_hash_lookup (ghost->process_offsets, &lookup_proc,
-                      (void ***) &pfound);
-    T8_ASSERT (ret);
-    process_entry = *pfound;
+    process_entry = t8_forest_ghost_get_proc_info (forest, recv_rank);
     /* In process_entry we stored the offset of this ranks ghosts under all
      * ghosts. Thus in element_data we look at the position
      *  ghost_start + offset
@@ -2211,21 +3845,13 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
     received_messages++;
   }
 #endif
-  for (iremote = 0; iremote < data_exchange->num_remotes; iremote++) {
+  for (iremote = 0, ishared = 0; iremote < data_exchange->num_remotes;
+       iremote++) {
     /* We need to compute the offset in element_data to which we can receive the message */
     /* Search for this processes' entry in the ghost struct */
     recv_rank =
       *(int *) sc_array_index_int (ghost->remote_processes, iremote);
-    lookup_proc.mpirank = recv_rank;
-#ifdef T8_ENABLE_DEBUG
-    ret =
-#else
-    (void)
-#endif
-      sc_hash_lookup (ghost->process_offsets, &lookup_proc,
-                      (void ***) &pfound);
-    T8_ASSERT (ret);
-    process_entry = *pfound;
+    process_entry = t8_forest_ghost_get_proc_info (forest, recv_rank);
     /* In process_entry we stored the offset of this ranks ghosts under all
      * ghosts. Thus in element_data we look at the position
      *  ghost_start + offset
@@ -2233,17 +3859,10 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
     remote_offset = process_entry->ghost_offset;
     /* Compute the offset of the next remote rank */
     if (iremote + 1 < data_exchange->num_remotes) {
-      lookup_proc.mpirank =
-        *(int *) sc_array_index_int (ghost->remote_processes, iremote + 1);
-#ifdef T8_ENABLE_DEBUG
-      ret =
-#else
-      (void)
-#endif
-        sc_hash_lookup (ghost->process_offsets, &lookup_proc,
-                        (void ***) &pfound);
-      T8_ASSERT (ret);
-      process_entry = *pfound;
+      process_entry =
+        t8_forest_ghost_get_proc_info (forest, *(int *) sc_array_index_int
+                                       (ghost->remote_processes,
+                                        iremote + 1));
       next_offset = process_entry->ghost_offset;
     }
     else {
@@ -2252,6 +3871,19 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
     }
     /* Calculate the number of bytes to receive */
     bytes_recv = (next_offset - remote_offset) * element_data->elem_size;
+    if (node_ranks[iremote] != sc_MPI_UNDEFINED) {
+#ifdef T8_GHOST_ENABLE_SHMEM
+      /* We copy the data from the shared window of this remote */
+      T8_ASSERT (data_exchange->shared_ranks[ishared] ==
+                 node_ranks[iremote]);
+      data_exchange->shared_recv[ishared] =
+        (char *) sc_array_index (element_data, ghost_start + remote_offset);
+      data_exchange->shared_bytes[ishared] = bytes_recv;
+#endif
+      ishared++;
+      data_exchange->recv_requests[iremote] = sc_MPI_REQUEST_NULL;
+      continue;
+    }
     /* receive the message */
     mpiret =
       sc_MPI_Irecv (sc_array_index
@@ -2260,15 +3892,40 @@ t8_forest_ghost_exchange_begin (t8_forest_t forest, sc_array_t * element_data)
                     forest->mpicomm, data_exchange->recv_requests + iremote);
     SC_CHECK_MPI (mpiret);
   }
+  T8_FREE (node_ranks);
   return data_exchange;
 }
 
-static void
-t8_forest_ghost_exchange_end (t8_ghost_data_exchange_t * data_exchange)
+void
+t8_forest_ghost_exchange_end (t8_ghost_exchange_t * pexchange)
 {
+  t8_ghost_data_exchange_t *data_exchange;
+  t8_forest_t         forest;
   int                 iproc;
 
-  T8_ASSERT (data_exchange != NULL);
+  T8_ASSERT (pexchange != NULL);
+  data_exchange = *pexchange;
+  if (data_exchange == NULL) {
+    /* This process has no ghosts */
+    return;
+  }
+  forest = data_exchange->forest;
+  if (forest->profile != NULL) {
+    /* Measure the time for ghost_exchange_end */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+#ifdef T8_GHOST_ENABLE_SHMEM
+  if (data_exchange->intranode != sc_MPI_COMM_NULL) {
+    /* Copy the data of the remotes on our node */
+    t8_forest_ghost_exchange_shmem_end (data_exchange);
+  }
+#endif
+#ifdef T8_GHOST_ENABLE_RMA
+  if (data_exchange->rma != T8_GHOST_RMA_NONE) {
+    /* Wait until our ghost data is fetched and the remotes fetched theirs */
+    t8_forest_ghost_exchange_rma_end (data_exchange);
+  }
+#endif
   /* Wait for all communications to end */
   sc_MPI_Waitall (data_exchange->num_remotes, data_exchange->recv_requests,
                   sc_MPI_STATUSES_IGNORE);
@@ -2284,57 +3941,800 @@ t8_forest_ghost_exchange_end (t8_ghost_data_exchange_t * data_exchange)
   T8_FREE (data_exchange->send_requests);
   T8_FREE (data_exchange->recv_requests);
   T8_FREE (data_exchange);
+  *pexchange = NULL;
+  if (forest->profile != NULL) {
+    /* Measure the time for ghost_exchange_end */
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+  t8_debugf ("Finished ghost_exchange_end\n");
 }
 
 void
 t8_forest_ghost_exchange_data (t8_forest_t forest, sc_array_t * element_data)
 {
-  t8_ghost_data_exchange_t *data_exchange;
+  t8_ghost_exchange_t data_exchange;
 
   t8_debugf ("Entering ghost_exchange_data\n");
   T8_ASSERT (t8_forest_is_committed (forest));
 
-  if (forest->ghosts == NULL) {
-    /* This process has no ghosts */
-    return;
-  }
+  T8_TRACE_BEGIN ("t8_forest_ghost_exchange");
+  data_exchange = t8_forest_ghost_exchange_begin (forest, element_data);
+  t8_forest_ghost_exchange_end (&data_exchange);
+  T8_TRACE_END ("t8_forest_ghost_exchange");
+  t8_debugf ("Finished ghost_exchange_data\n");
+}
 
-  T8_ASSERT (forest->ghosts != NULL);
+/* A persistent plan for ghost data exchanges */
+typedef struct t8_ghost_exchange_plan
+{
+  t8_forest_t         forest;   /* The forest whose ghost data is exchanged */
+  sc_array_t         *element_data;     /* The data of the elements and ghosts */
+  int                 num_remotes;      /* The number of remote processes */
+  t8_locidx_t        *send_offsets;     /* For each remote the position of its
+                                           data in send_buffer in elements,
+                                           num_remotes + 1 entries */
+  int                *send_direct;      /* For each remote true if its data is
+                                           sent directly from element_data */
+  char               *send_buffer;      /* The send buffers of all remotes */
+  sc_MPI_Request     *requests; /* num_remotes send requests followed by
+                                   num_remotes receive requests */
+  int                 started;  /* True while an exchange is in progress */
+} t8_ghost_exchange_plan_struct_t;
+
+t8_ghost_exchange_plan_t
+t8_forest_ghost_exchange_plan_new (t8_forest_t forest,
+                                   sc_array_t * element_data)
+{
+  t8_ghost_exchange_plan_t plan;
+  t8_forest_ghost_t   ghost;
+  size_t              data_size;
+  t8_locidx_t         num_send, ghost_start, remote_offset, next_offset;
+  int                 iremote, remote_rank;
+  char               *send_data;
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+#endif
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
   T8_ASSERT (element_data != NULL);
   T8_ASSERT ((t8_locidx_t) element_data->elem_count ==
              t8_forest_get_local_num_elements (forest)
              + t8_forest_get_num_ghosts (forest));
 
-  data_exchange = t8_forest_ghost_exchange_begin (forest, element_data);
-  if (forest->profile != NULL) {
-    /* Measure the time for ghost_exchange_end */
-    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  ghost = forest->ghosts;
+  data_size = element_data->elem_size;
+  plan = T8_ALLOC_ZERO (t8_ghost_exchange_plan_struct_t, 1);
+  plan->forest = forest;
+  plan->element_data = element_data;
+  plan->num_remotes = ghost == NULL ? 0 : ghost->remote_processes->elem_count;
+
+  /* Compute the indices of the elements that we send to each remote */
+  plan->send_offsets = T8_ALLOC (t8_locidx_t, plan->num_remotes + 1);
+  plan->send_offsets[0] = 0;
+  num_send = 0;
+  for (iremote = 0; iremote < plan->num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_send += t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    plan->send_offsets[iremote + 1] = num_send;
   }
-  t8_forest_ghost_exchange_end (data_exchange);
-  if (forest->profile != NULL) {
-    /* Measure the time for ghost_exchange_end */
-    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  plan->send_direct = T8_ALLOC (int, plan->num_remotes);
+  plan->send_buffer = T8_ALLOC (char, num_send * data_size);
+  plan->requests = T8_ALLOC (sc_MPI_Request, 2 * plan->num_remotes);
+
+  ghost_start = t8_forest_get_local_num_elements (forest);
+  for (iremote = 0; iremote < plan->num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    send_data =
+      t8_forest_ghost_exchange_send_direct (forest, iremote, element_data);
+    plan->send_direct[iremote] = send_data != NULL;
+    if (send_data == NULL) {
+      send_data = plan->send_buffer + plan->send_offsets[iremote] * data_size;
+    }
+    /* The ghosts of this remote are stored contiguously */
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < plan->num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+#ifdef SC_ENABLE_MPI
+    mpiret = MPI_Send_init (send_data,
+                            (plan->send_offsets[iremote + 1]
+                             - plan->send_offsets[iremote]) * data_size,
+                            sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_PLAN,
+                            forest->mpicomm, plan->requests + iremote);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Recv_init (sc_array_index (element_data,
+                                            ghost_start + remote_offset),
+                            (next_offset - remote_offset) * data_size,
+                            sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_PLAN,
+                            forest->mpicomm,
+                            plan->requests + plan->num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+#else
+    SC_ABORT_NOT_REACHED ();
+#endif
   }
-  t8_debugf ("Finished ghost_exchange_data\n");
+  return plan;
 }
 
-/* Print a forest ghost structure */
 void
-t8_forest_ghost_print (t8_forest_t forest)
+t8_forest_ghost_exchange_plan_start (t8_ghost_exchange_plan_t plan)
 {
-  t8_forest_ghost_t   ghost;
-  t8_ghost_remote_t  *remote_found;
-  t8_ghost_remote_tree_t *remote_tree;
-  t8_ghost_process_hash_t proc_hash, **pfound, *found;
-  size_t              iremote, itree;
-#ifdef T8_ENABLE_DEBUG
-  int                 ret;
+  size_t              data_size;
+  int                 iremote;
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
 #endif
-  int                 remote_rank;
-  char                remote_buffer[BUFSIZ] = "";
-  char                buffer[BUFSIZ] = "";
 
-  if (forest->ghosts == NULL) {
+  T8_ASSERT (plan != NULL);
+  T8_ASSERT (!plan->started);
+
+  /* Pack the data of the elements that we send, except for the remotes
+   * whose data is sent directly from element_data */
+  data_size = plan->element_data->elem_size;
+  for (iremote = 0; iremote < plan->num_remotes; iremote++) {
+    if (!plan->send_direct[iremote]) {
+      t8_forest_ghost_exchange_fill_send_buffer (plan->forest, iremote,
+                                                 plan->send_buffer +
+                                                 plan->send_offsets[iremote]
+                                                 * data_size,
+                                                 plan->element_data);
+    }
+  }
+#ifdef SC_ENABLE_MPI
+  if (plan->num_remotes > 0) {
+    mpiret = MPI_Startall (2 * plan->num_remotes, plan->requests);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+  plan->started = 1;
+}
+
+void
+t8_forest_ghost_exchange_plan_wait (t8_ghost_exchange_plan_t plan)
+{
+  t8_forest_t         forest;
+  int                 mpiret;
+
+  T8_ASSERT (plan != NULL);
+  T8_ASSERT (plan->started);
+
+  forest = plan->forest;
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * plan->num_remotes, plan->requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+  plan->started = 0;
+}
+
+void
+t8_forest_ghost_exchange_plan_destroy (t8_ghost_exchange_plan_t * pplan)
+{
+  t8_ghost_exchange_plan_t plan;
+#ifdef SC_ENABLE_MPI
+  int                 ireq, mpiret;
+#endif
+
+  T8_ASSERT (pplan != NULL);
+  plan = *pplan;
+  T8_ASSERT (plan != NULL);
+  T8_ASSERT (!plan->started);
+
+#ifdef SC_ENABLE_MPI
+  for (ireq = 0; ireq < 2 * plan->num_remotes; ireq++) {
+    mpiret = MPI_Request_free (plan->requests + ireq);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+  T8_FREE (plan->send_offsets);
+  T8_FREE (plan->send_direct);
+  T8_FREE (plan->send_buffer);
+  T8_FREE (plan->requests);
+  T8_FREE (plan);
+  *pplan = NULL;
+}
+
+void
+t8_forest_ghost_exchange_data_fields (t8_forest_t forest, int num_fields,
+                                      sc_array_t ** fields)
+{
+  t8_forest_ghost_t   ghost;
+  sc_MPI_Request     *requests;
+  char              **send_buffers, **recv_buffers, *pos;
+  t8_locidx_t        *send_indices, *remote_offsets;
+  t8_locidx_t         num_send, num_recv, ghost_start, isend;
+  size_t              bytes_per_element, elem_size;
+  int                 num_remotes, iremote, remote_rank, ifield, mpiret;
+
+  t8_debugf ("Entering ghost_exchange_data_fields\n");
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (num_fields >= 0);
+  T8_ASSERT (num_fields == 0 || fields != NULL);
+
+  ghost = forest->ghosts;
+  if (ghost == NULL || num_fields == 0) {
+    /* This process has no ghosts or there is nothing to exchange */
+    return;
+  }
+  /* The number of bytes of all fields for one element */
+  bytes_per_element = 0;
+  for (ifield = 0; ifield < num_fields; ifield++) {
+    T8_ASSERT (fields[ifield] != NULL);
+    T8_ASSERT ((t8_locidx_t) fields[ifield]->elem_count ==
+               t8_forest_get_local_num_elements (forest)
+               + t8_forest_get_num_ghosts (forest));
+    bytes_per_element += fields[ifield]->elem_size;
+  }
+
+  num_remotes = ghost->remote_processes->elem_count;
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  send_buffers = T8_ALLOC (char *, num_remotes);
+  recv_buffers = T8_ALLOC (char *, num_remotes);
+  remote_offsets = T8_ALLOC (t8_locidx_t, num_remotes + 1);
+  ghost_start = t8_forest_get_local_num_elements (forest);
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offsets[iremote] =
+      t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    /* Pack the data of all fields for this remote, field by field */
+    num_send = t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    send_indices = T8_ALLOC (t8_locidx_t, num_send);
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank, send_indices);
+    pos = send_buffers[iremote] =
+      T8_ALLOC (char, num_send * bytes_per_element);
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      elem_size = fields[ifield]->elem_size;
+      for (isend = 0; isend < num_send; isend++) {
+        memcpy (pos, t8_sc_array_index_locidx (fields[ifield],
+                                               send_indices[isend]),
+                elem_size);
+        pos += elem_size;
+      }
+    }
+    T8_FREE (send_indices);
+    mpiret = sc_MPI_Isend (send_buffers[iremote],
+                           num_send * bytes_per_element, sc_MPI_BYTE,
+                           remote_rank, T8_MPI_GHOST_EXC_FIELDS,
+                           forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+  remote_offsets[num_remotes] = ghost->num_ghosts_elements;
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_recv = remote_offsets[iremote + 1] - remote_offsets[iremote];
+    recv_buffers[iremote] = T8_ALLOC (char, num_recv * bytes_per_element);
+    mpiret = sc_MPI_Irecv (recv_buffers[iremote],
+                           num_recv * bytes_per_element, sc_MPI_BYTE,
+                           remote_rank, T8_MPI_GHOST_EXC_FIELDS,
+                           forest->mpicomm,
+                           requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+
+  /* Copy the received data of each field to its ghost entries */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    num_recv = remote_offsets[iremote + 1] - remote_offsets[iremote];
+    pos = recv_buffers[iremote];
+    for (ifield = 0; ifield < num_fields; ifield++) {
+      elem_size = fields[ifield]->elem_size;
+      if (num_recv > 0) {
+        memcpy (t8_sc_array_index_locidx (fields[ifield], ghost_start
+                                          + remote_offsets[iremote]),
+                pos, num_recv * elem_size);
+      }
+      pos += num_recv * elem_size;
+    }
+    T8_FREE (send_buffers[iremote]);
+    T8_FREE (recv_buffers[iremote]);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (recv_buffers);
+  T8_FREE (remote_offsets);
+  T8_FREE (requests);
+  t8_debugf ("Finished ghost_exchange_data_fields\n");
+}
+
+void
+t8_forest_ghost_exchange_data_strided (t8_forest_t forest,
+                                       const void *local_data,
+                                       void *ghost_data, size_t elem_size,
+                                       size_t stride)
+{
+  t8_forest_ghost_t   ghost;
+  sc_MPI_Request     *requests;
+  char              **send_buffers, **recv_buffers, *ghost_pos;
+  t8_locidx_t        *send_indices, *remote_offsets;
+  t8_locidx_t         num_send, num_recv, ielem;
+  int                 num_remotes, iremote, remote_rank, mpiret;
+  /* If there is no padding, we receive directly into the ghost data */
+  const int           contiguous = stride == elem_size;
+
+  t8_debugf ("Entering ghost_exchange_data_strided\n");
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (stride >= elem_size);
+
+  ghost = forest->ghosts;
+  if (ghost == NULL || elem_size == 0) {
+    /* This process has no ghosts or there is nothing to exchange */
+    return;
+  }
+  T8_ASSERT (local_data != NULL || t8_forest_get_local_num_elements (forest)
+             == 0);
+  T8_ASSERT (ghost_data != NULL || ghost->num_ghosts_elements == 0);
+
+  num_remotes = ghost->remote_processes->elem_count;
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  send_buffers = T8_ALLOC (char *, num_remotes);
+  recv_buffers = T8_ALLOC_ZERO (char *, num_remotes);
+  remote_offsets = T8_ALLOC (t8_locidx_t, num_remotes + 1);
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offsets[iremote] =
+      t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    /* Pack the data for this remote from the user memory */
+    num_send = t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    send_indices = T8_ALLOC (t8_locidx_t, num_send);
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank, send_indices);
+    send_buffers[iremote] = T8_ALLOC (char, num_send * elem_size);
+    for (ielem = 0; ielem < num_send; ielem++) {
+      memcpy (send_buffers[iremote] + ielem * elem_size,
+              (const char *) local_data + send_indices[ielem] * stride,
+              elem_size);
+    }
+    T8_FREE (send_indices);
+    mpiret = sc_MPI_Isend (send_buffers[iremote], num_send * elem_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+  remote_offsets[num_remotes] = ghost->num_ghosts_elements;
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_recv = remote_offsets[iremote + 1] - remote_offsets[iremote];
+    ghost_pos = (char *) ghost_data + remote_offsets[iremote] * stride;
+    if (!contiguous) {
+      ghost_pos = recv_buffers[iremote] = T8_ALLOC (char,
+                                                    num_recv * elem_size);
+    }
+    mpiret = sc_MPI_Irecv (ghost_pos, num_recv * elem_size, sc_MPI_BYTE,
+                           remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    if (!contiguous) {
+      /* Copy the received data to the strided ghost entries */
+      num_recv = remote_offsets[iremote + 1] - remote_offsets[iremote];
+      ghost_pos = (char *) ghost_data + remote_offsets[iremote] * stride;
+      for (ielem = 0; ielem < num_recv; ielem++) {
+        memcpy (ghost_pos + ielem * stride,
+                recv_buffers[iremote] + ielem * elem_size, elem_size);
+      }
+      T8_FREE (recv_buffers[iremote]);
+    }
+    T8_FREE (send_buffers[iremote]);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (recv_buffers);
+  T8_FREE (remote_offsets);
+  T8_FREE (requests);
+  t8_debugf ("Finished ghost_exchange_data_strided\n");
+}
+
+void
+t8_forest_ghost_exchange_send_indices (t8_forest_t forest,
+                                       sc_array_t * send_indices)
+{
+  t8_forest_ghost_t   ghost;
+  t8_locidx_t         num_send;
+  int                 iremote, remote_rank;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (send_indices != NULL);
+  T8_ASSERT (send_indices->elem_size == sizeof (t8_locidx_t));
+
+  ghost = forest->ghosts;
+  sc_array_truncate (send_indices);
+  if (ghost == NULL) {
+    return;
+  }
+  for (iremote = 0; iremote < (int) ghost->remote_processes->elem_count;
+       iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_send = t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    /* Append the indices of this remote */
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank,
+                                           (t8_locidx_t *)
+                                           sc_array_push_count (send_indices,
+                                                                num_send));
+  }
+}
+
+void
+t8_forest_ghost_exchange_packed (t8_forest_t forest, const void *send_buffer,
+                                 void *ghost_data, size_t elem_size)
+{
+  t8_forest_ghost_t   ghost;
+  sc_MPI_Request     *requests;
+  t8_locidx_t         send_offset, num_send, remote_offset, next_offset;
+  int                 num_remotes, iremote, remote_rank, mpiret;
+
+  t8_debugf ("Entering ghost_exchange_packed\n");
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+
+  ghost = forest->ghosts;
+  if (ghost == NULL || elem_size == 0) {
+    /* This process has no ghosts or there is nothing to exchange */
+    return;
+  }
+
+  num_remotes = ghost->remote_processes->elem_count;
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  send_offset = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    num_send = t8_forest_ghost_get_remote (forest, remote_rank)->num_elements;
+    mpiret = sc_MPI_Isend ((char *) send_buffer + send_offset * elem_size,
+                           num_send * elem_size, sc_MPI_BYTE, remote_rank,
+                           T8_MPI_GHOST_EXC_FOREST, forest->mpicomm,
+                           requests + iremote);
+    SC_CHECK_MPI (mpiret);
+    send_offset += num_send;
+
+    /* The ghosts of this remote are stored contiguously */
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    mpiret = sc_MPI_Irecv ((char *) ghost_data + remote_offset * elem_size,
+                           (next_offset - remote_offset) * elem_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+  T8_FREE (requests);
+  t8_debugf ("Finished ghost_exchange_packed\n");
+}
+
+void
+t8_forest_ghost_exchange_data_layers (t8_forest_t forest,
+                                      sc_array_t * element_data,
+                                      int max_layer)
+{
+  t8_forest_ghost_t   ghost;
+  t8_ghost_remote_t  *remote_entry;
+  sc_MPI_Request     *requests;
+  char              **send_buffers, **recv_buffers;
+  size_t              data_size;
+  t8_locidx_t        *indices, isend, num_send, remote_layer_offset;
+  t8_locidx_t         num_local, ighost, remote_offset, next_offset;
+  t8_locidx_t         num_recv;
+  int                 num_remotes, iremote, remote_rank, mpiret;
+
+  t8_debugf ("Entering ghost_exchange_data_layers\n");
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (element_data != NULL);
+  T8_ASSERT (max_layer >= 1);
+
+  ghost = forest->ghosts;
+  if (ghost == NULL || ghost->ghost_layers == NULL
+      || max_layer >= ghost->num_layers) {
+    /* All ghosts are updated */
+    t8_forest_ghost_exchange_data (forest, element_data);
+    return;
+  }
+  T8_ASSERT ((t8_locidx_t) element_data->elem_count ==
+             t8_forest_get_local_num_elements (forest)
+             + ghost->num_ghosts_elements);
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_remotes = ghost->remote_processes->elem_count;
+  data_size = element_data->elem_size;
+  send_buffers = T8_ALLOC (char *, num_remotes);
+  recv_buffers = T8_ALLOC (char *, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  indices = T8_ALLOC (t8_locidx_t, ghost->num_remote_elements);
+  remote_layer_offset = 0;
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_entry = t8_forest_ghost_get_remote (forest, remote_rank);
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank, indices);
+    /* Pack the data of the remote elements in the requested layers */
+    send_buffers[iremote] =
+      T8_ALLOC (char, remote_entry->num_elements * data_size);
+    num_send = 0;
+    for (isend = 0; isend < remote_entry->num_elements; isend++) {
+      if (ghost->remote_layers[remote_layer_offset + isend] <= max_layer) {
+        memcpy (send_buffers[iremote] + num_send * data_size,
+                t8_sc_array_index_locidx (element_data, indices[isend]),
+                data_size);
+        num_send++;
+      }
+    }
+    remote_layer_offset += remote_entry->num_elements;
+    mpiret = sc_MPI_Isend (send_buffers[iremote], num_send * data_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+
+    /* Receive the data of the ghosts of this remote in the requested
+     * layers. They are sent in the same order. */
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    num_recv = 0;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      num_recv += ghost->ghost_layers[ighost] <= max_layer;
+    }
+    recv_buffers[iremote] = T8_ALLOC (char, num_recv * data_size);
+    mpiret = sc_MPI_Irecv (recv_buffers[iremote], num_recv * data_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+  T8_ASSERT (remote_layer_offset == ghost->num_remote_elements);
+
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+
+  /* Copy the received data to the ghost entries */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    num_recv = 0;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      if (ghost->ghost_layers[ighost] <= max_layer) {
+        memcpy (t8_sc_array_index_locidx (element_data, num_local + ighost),
+                recv_buffers[iremote] + num_recv * data_size, data_size);
+        num_recv++;
+      }
+    }
+    T8_FREE (send_buffers[iremote]);
+    T8_FREE (recv_buffers[iremote]);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (recv_buffers);
+  T8_FREE (requests);
+  T8_FREE (indices);
+  t8_debugf ("Finished ghost_exchange_data_layers\n");
+}
+
+void
+t8_forest_ghost_exchange_data_selected (t8_forest_t forest,
+                                        sc_array_t * element_data,
+                                        const int8_t *selected)
+{
+  t8_forest_ghost_t   ghost;
+  t8_ghost_remote_t  *remote_entry;
+  sc_MPI_Request     *requests;
+  char              **send_buffers, **recv_buffers;
+  size_t              data_size;
+  t8_locidx_t        *indices, isend, num_send;
+  t8_locidx_t         num_local, ighost, remote_offset, next_offset;
+  t8_locidx_t         num_recv;
+  int                 num_remotes, iremote, remote_rank, mpiret;
+
+  t8_debugf ("Entering ghost_exchange_data_selected\n");
+  T8_ASSERT (t8_forest_is_committed (forest));
+  t8_forest_ghost_ensure (forest);
+  T8_ASSERT (element_data != NULL);
+  T8_ASSERT (selected != NULL);
+
+  ghost = forest->ghosts;
+  if (ghost == NULL) {
+    return;
+  }
+  num_local = t8_forest_get_local_num_elements (forest);
+  T8_ASSERT ((t8_locidx_t) element_data->elem_count ==
+             num_local + ghost->num_ghosts_elements);
+
+  num_remotes = ghost->remote_processes->elem_count;
+  data_size = element_data->elem_size;
+  send_buffers = T8_ALLOC (char *, num_remotes);
+  recv_buffers = T8_ALLOC (char *, num_remotes);
+  requests = T8_ALLOC (sc_MPI_Request, 2 * num_remotes);
+  indices = T8_ALLOC (t8_locidx_t, ghost->num_remote_elements);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_entry = t8_forest_ghost_get_remote (forest, remote_rank);
+    t8_forest_ghost_exchange_plan_indices (forest, remote_rank, indices);
+    /* Pack the data of the selected remote elements */
+    send_buffers[iremote] =
+      T8_ALLOC (char, remote_entry->num_elements * data_size);
+    num_send = 0;
+    for (isend = 0; isend < remote_entry->num_elements; isend++) {
+      if (selected[indices[isend]]) {
+        memcpy (send_buffers[iremote] + num_send * data_size,
+                t8_sc_array_index_locidx (element_data, indices[isend]),
+                data_size);
+        num_send++;
+      }
+    }
+    mpiret = sc_MPI_Isend (send_buffers[iremote], num_send * data_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + iremote);
+    SC_CHECK_MPI (mpiret);
+
+    /* Receive the data of the selected ghosts of this remote.
+     * They are sent in the same order. */
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    num_recv = 0;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      num_recv += selected[num_local + ighost] != 0;
+    }
+    recv_buffers[iremote] = T8_ALLOC (char, num_recv * data_size);
+    mpiret = sc_MPI_Irecv (recv_buffers[iremote], num_recv * data_size,
+                           sc_MPI_BYTE, remote_rank, T8_MPI_GHOST_EXC_FOREST,
+                           forest->mpicomm, requests + num_remotes + iremote);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  if (forest->profile != NULL) {
+    /* Measure the time for waiting */
+    forest->profile->ghost_waittime = -sc_MPI_Wtime ();
+  }
+  mpiret = sc_MPI_Waitall (2 * num_remotes, requests,
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+  if (forest->profile != NULL) {
+    forest->profile->ghost_waittime += sc_MPI_Wtime ();
+  }
+
+  /* Copy the received data to the ghost entries */
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    remote_rank =
+      *(int *) sc_array_index_int (ghost->remote_processes, iremote);
+    remote_offset = t8_forest_ghost_remote_first_elem (forest, remote_rank);
+    next_offset = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, *(int *) sc_array_index_int
+                                         (ghost->remote_processes,
+                                          iremote + 1))
+      : ghost->num_ghosts_elements;
+    num_recv = 0;
+    for (ighost = remote_offset; ighost < next_offset; ighost++) {
+      if (selected[num_local + ighost]) {
+        memcpy (t8_sc_array_index_locidx (element_data, num_local + ighost),
+                recv_buffers[iremote] + num_recv * data_size, data_size);
+        num_recv++;
+      }
+    }
+    T8_FREE (send_buffers[iremote]);
+    T8_FREE (recv_buffers[iremote]);
+  }
+  T8_FREE (send_buffers);
+  T8_FREE (recv_buffers);
+  T8_FREE (requests);
+  T8_FREE (indices);
+  t8_debugf ("Finished ghost_exchange_data_selected\n");
+}
+
+void
+t8_forest_ghost_exchange_data_levels (t8_forest_t forest,
+                                      sc_array_t * element_data,
+                                      int min_level, int max_level)
+{
+  int8_t             *levels;
+  t8_locidx_t         ielement, num_elements;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (min_level <= max_level);
+
+  if (forest->ghosts == NULL) {
+    return;
+  }
+  /* The levels of the local elements decide which remote elements are sent,
+   * the levels of the ghosts which ghost entries are received. */
+  num_elements = t8_forest_get_local_num_elements (forest)
+    + forest->ghosts->num_ghosts_elements;
+  levels = T8_ALLOC (int8_t, num_elements);
+  t8_forest_element_levels (forest, levels);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    levels[ielement] = min_level <= levels[ielement]
+      && levels[ielement] <= max_level;
+  }
+  t8_forest_ghost_exchange_data_selected (forest, element_data, levels);
+  T8_FREE (levels);
+}
+
+/* Print a forest ghost structure */
+void
+t8_forest_ghost_print (t8_forest_t forest)
+{
+  t8_forest_ghost_t   ghost;
+  t8_ghost_remote_t  *remote_found;
+  t8_ghost_remote_tree_t *remote_tree;
+  t8_ghost_process_hash_t *found;
+  size_t              iremote, itree;
+  int                 remote_rank;
+  char                remote_buffer[BUFSIZ] = "";
+  char                buffer[BUFSIZ] = "";
+
+  if (forest->ghosts == NULL) {
     return;
   }
   T8_ASSERT (forest->ghosts != NULL);
@@ -2369,18 +4769,7 @@ t8_forest_ghost_print (t8_forest_t forest)
       }
 
       /* Investigate the elements that we received from this process */
-      proc_hash.mpirank = remote_rank;
-      /* look up this rank in the hash table */
-#ifdef T8_ENABLE_DEBUG
-      ret =
-#else
-      (void)
-#endif
-        sc_hash_lookup (ghost->process_offsets, &proc_hash,
-                        (void ***) &pfound);
-
-      T8_ASSERT (ret);
-      found = *pfound;
+      found = t8_forest_ghost_get_proc_info (forest, remote_rank);
       snprintf (buffer + strlen (buffer), BUFSIZ - strlen (buffer),
                 "\t[Rank %i] First tree: %li\n\t\t First element: %li\n",
                 remote_rank,
@@ -2399,6 +4788,7 @@ t8_forest_ghost_reset (t8_forest_ghost_t * pghost)
   t8_ghost_tree_t    *ghost_tree;
   t8_ghost_remote_t  *remote_entry;
   t8_ghost_remote_tree_t *remote_tree;
+  sc_array_t         *remotes;
 
   T8_ASSERT (pghost != NULL);
   ghost = *pghost;
@@ -2410,17 +4800,28 @@ t8_forest_ghost_reset (t8_forest_ghost_t * pghost)
     ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
                                                      it_trees);
     t8_element_array_reset (&ghost_tree->elements);
+    t8_element_array_soa_reset (&ghost_tree->soa);
   }
 
   sc_array_destroy (ghost->ghost_trees);
   sc_array_destroy (ghost->remote_processes);
-  /* Clean-up the hashtables */
-  sc_hash_destroy (ghost->global_tree_to_ghost_tree);
-  sc_hash_destroy (ghost->process_offsets);
+  if (ghost->ghost_layers != NULL) {
+    T8_FREE (ghost->ghost_layers);
+  }
+  if (ghost->remote_layers != NULL) {
+    T8_FREE (ghost->remote_layers);
+  }
+  if (ghost->rma_displacements != NULL) {
+    T8_FREE (ghost->rma_displacements);
+  }
+  if (ghost->send_runs != NULL) {
+    T8_FREE (ghost->send_run_offsets);
+    T8_FREE (ghost->send_runs);
+  }
   /* Clean-up the remote ghost entries */
-  for (it = 0; it < ghost->remote_ghosts->a.elem_count; it++) {
-    remote_entry = (t8_ghost_remote_t *)
-      sc_array_index (&ghost->remote_ghosts->a, it);
+  remotes = ghost->remotes != NULL ? ghost->remotes : &ghost->remote_ghosts->a;
+  for (it = 0; it < remotes->elem_count; it++) {
+    remote_entry = (t8_ghost_remote_t *) sc_array_index (remotes, it);
     for (it_trees = 0; it_trees < remote_entry->remote_trees.elem_count;
          it_trees++) {
       remote_tree = (t8_ghost_remote_tree_t *)
@@ -2430,18 +4831,94 @@ t8_forest_ghost_reset (t8_forest_ghost_t * pghost)
     }
     sc_array_reset (&remote_entry->remote_trees);
   }
-  sc_hash_array_destroy (ghost->remote_ghosts);
-
-  /* Clean-up the memory pools for the data inside
-   * the hash tables */
-  sc_mempool_destroy (ghost->glo_tree_mempool);
-  sc_mempool_destroy (ghost->proc_offset_mempool);
+  if (ghost->remotes != NULL) {
+    /* The hash tables were already replaced by sorted arrays */
+    sc_array_destroy (ghost->remotes);
+    sc_array_destroy (ghost->ghost_tree_ids);
+    sc_array_destroy (ghost->process_offsets_sorted);
+  }
+  else {
+    /* Clean-up the hashtables */
+    sc_hash_destroy (ghost->global_tree_to_ghost_tree);
+    sc_hash_destroy (ghost->process_offsets);
+    sc_hash_array_destroy (ghost->remote_ghosts);
+
+    /* Clean-up the memory pools for the data inside
+     * the hash tables */
+    sc_mempool_destroy (ghost->glo_tree_mempool);
+    sc_mempool_destroy (ghost->proc_offset_mempool);
+  }
 
   /* Free the ghost */
   T8_FREE (ghost);
   pghost = NULL;
 }
 
+size_t
+t8_forest_ghost_memory_usage (t8_forest_ghost_t ghost, size_t *hash_bytes)
+{
+  size_t              it, it_trees, bytes;
+  t8_ghost_tree_t    *ghost_tree;
+  t8_ghost_remote_t  *remote_entry;
+  t8_ghost_remote_tree_t *remote_tree;
+  sc_array_t         *remotes;
+
+  T8_ASSERT (ghost != NULL);
+  T8_ASSERT (hash_bytes != NULL);
+
+  bytes = sizeof (t8_forest_ghost_struct_t);
+  /* The ghost elements */
+  bytes += sc_array_memory_used (ghost->ghost_trees, 1);
+  for (it_trees = 0; it_trees < ghost->ghost_trees->elem_count; it_trees++) {
+    ghost_tree = (t8_ghost_tree_t *) sc_array_index (ghost->ghost_trees,
+                                                     it_trees);
+    bytes += sc_array_memory_used (&ghost_tree->elements.array, 0);
+    bytes += ghost_tree->soa.count * (sizeof (int) + sizeof (t8_linearidx_t));
+  }
+  bytes += sc_array_memory_used (ghost->remote_processes, 1);
+  if (ghost->ghost_layers != NULL) {
+    bytes += ghost->num_ghosts_elements * sizeof (int);
+  }
+  if (ghost->remote_layers != NULL) {
+    bytes += ghost->num_remote_elements * sizeof (int);
+  }
+  if (ghost->rma_displacements != NULL) {
+    bytes += (ghost->remote_processes->elem_count + 1) * sizeof (t8_locidx_t);
+  }
+  if (ghost->send_runs != NULL) {
+    bytes += (ghost->remote_processes->elem_count + 1) * sizeof (t8_locidx_t);
+    bytes += 2 * ghost->send_run_offsets[ghost->remote_processes->elem_count]
+      * sizeof (t8_locidx_t);
+  }
+  /* The remote elements */
+  remotes = ghost->remotes != NULL ? ghost->remotes : &ghost->remote_ghosts->a;
+  for (it = 0; it < remotes->elem_count; it++) {
+    remote_entry = (t8_ghost_remote_t *) sc_array_index (remotes, it);
+    bytes += sc_array_memory_used (&remote_entry->remote_trees, 0);
+    for (it_trees = 0; it_trees < remote_entry->remote_trees.elem_count;
+         it_trees++) {
+      remote_tree = (t8_ghost_remote_tree_t *)
+        sc_array_index (&remote_entry->remote_trees, it_trees);
+      bytes += sc_array_memory_used (&remote_tree->elements.array, 0);
+      bytes += sc_array_memory_used (&remote_tree->element_indices, 0);
+    }
+  }
+  if (ghost->remotes != NULL) {
+    /* The hash tables were already replaced by sorted arrays */
+    bytes += sc_array_memory_used (ghost->remotes, 1);
+    *hash_bytes = sc_array_memory_used (ghost->ghost_tree_ids, 1)
+      + sc_array_memory_used (ghost->process_offsets_sorted, 1);
+  }
+  else {
+    *hash_bytes = sc_hash_memory_used (ghost->global_tree_to_ghost_tree)
+      + sc_hash_memory_used (ghost->process_offsets)
+      + sc_hash_array_memory_used (ghost->remote_ghosts)
+      + sc_mempool_memory_used (ghost->glo_tree_mempool)
+      + sc_mempool_memory_used (ghost->proc_offset_mempool);
+  }
+  return bytes;
+}
+
 void
 t8_forest_ghost_ref (t8_forest_ghost_t ghost)
 {
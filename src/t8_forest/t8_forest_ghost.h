@@ -32,6 +32,7 @@
 
 #include <t8.h>
 #include <t8_forest/t8_forest_types.h>
+#include <t8_data/t8_containers.h>
 
 T8_EXTERN_C_BEGIN ();
 
@@ -81,6 +82,18 @@ t8_element_array_t *t8_forest_ghost_get_tree_elements (t8_forest_t forest,
                                                        t8_locidx_t
                                                        lghost_tree);
 
+/** Get a pointer to the levels and linear ids of the elements of a ghost tree.
+ * \param [in]  forest    The forest. Ghost layer must exist.
+ * \param [in]  lghost_tree The ghost tree id of a ghost tree.
+ * \return                A pointer to the structure of arrays of the ghost
+ *                        elements of the tree. The linear ids refer to the
+ *                        maxlevel of \a forest.
+ * \a forest must be committed before calling this function.
+ */
+t8_element_array_soa_t *t8_forest_ghost_get_tree_soa (t8_forest_t forest,
+                                                      t8_locidx_t
+                                                      lghost_tree);
+
 /** Given a global tree compute the ghost local tree id of it.
  * \param [in]  forest    The forest. Ghost layer must exist.
  * \param [in]  gtreeid   A global tree in \a forest.
@@ -158,6 +171,19 @@ void                t8_forest_ghost_unref (t8_forest_ghost_t * pghost);
  */
 void                t8_forest_ghost_destroy (t8_forest_ghost_t * pghost);
 
+/** Compute the number of bytes that a ghost structure occupies.
+ * \param [in]      ghost       A ghost structure.
+ * \param [out]     hash_bytes  On output the bytes of the lookup tables of
+ *                              \a ghost, either hash tables and their memory
+ *                              pools or the sorted arrays that replace them.
+ * \return                      The bytes of the ghost and remote elements, the
+ *                              layers and the ghost structure itself, without
+ *                              \a hash_bytes.
+ * \see t8_forest_memory_usage
+ */
+size_t              t8_forest_ghost_memory_usage (t8_forest_ghost_t ghost,
+                                                  size_t *hash_bytes);
+
 /** Create one layer of ghost elements for a forest.
  * \see t8_forest_set_ghost
  * \param [in,out]    forest     The forest.
@@ -175,9 +201,65 @@ void                t8_forest_ghost_create (t8_forest_t forest);
  */
 void                t8_forest_ghost_create_balanced_only (t8_forest_t forest);
 
-/* experimental version using the ghost_v3 algorithm */
+/** Create one layer of ghost elements for a forest.
+ * This version uses a top-down search through the local trees and prunes
+ * all subtrees that are local and whose face neighbors are local as well.
+ * It is the default algorithm of \ref t8_forest_set_ghost and is used
+ * for face ghosts only, for other ghost types the iterative algorithm
+ * of \ref t8_forest_ghost_create is used.
+ * \param [in,out]    forest     The forest.
+ * \a forest must be committed before calling this function.
+ */
 void                t8_forest_ghost_create_topdown (t8_forest_t forest);
 
+/** Create one layer of face ghost elements for a forest that was adapted
+ * from a forest with face ghost layer.
+ * The remote processes of the elements that did not change are taken from
+ * the ghost layer of \a forest_from. Only for the refined and coarsened
+ * elements the owners of their face neighbors are computed, such that the
+ * cost of this step is proportional to the number of changed elements.
+ * The ghost elements are then exchanged as in \ref t8_forest_ghost_create_topdown.
+ * If the remote processes cannot be reused, for example because \a forest was
+ * partitioned, this function falls back to \ref t8_forest_ghost_create_topdown.
+ * \param [in,out]    forest      The forest.
+ * \param [in]        forest_from The forest from which \a forest was adapted, or NULL.
+ * \a forest must be committed before calling this function.
+ */
+void                t8_forest_ghost_create_incremental (t8_forest_t forest,
+                                                        t8_forest_t
+                                                        forest_from);
+
+/** Create the ghost layer of a forest if its creation was deferred with
+ * \ref t8_forest_set_ghost_lazy and it was not yet used.
+ * The functions that need the ghost layer call this function, thus it is
+ * only needed to control when the communication takes place.
+ * \param [in,out]    forest     The forest.
+ * \a forest must be committed before calling this function.
+ * \note If the ghost layer is pending, this function is collective over
+ * the forest's communicator. Otherwise it returns immediately.
+ */
+void                t8_forest_ghost_ensure (t8_forest_t forest);
+
+/** Exchange ghost information of user defined element data only for
+ * selected elements.
+ * Each process sends the entries of its selected remote elements and
+ * receives those of its selected ghosts, thus the selection of an element
+ * must be the same on its owner and on each process where it is a ghost.
+ * The other ghost entries are not changed.
+ * \param [in] forest       The forest. Must be committed.
+ * \param [in,out] element_data An array of length num_local_elements + num_ghosts
+ *                         as in \ref t8_forest_ghost_exchange_data.
+ * \param [in] selected     An array of length num_local_elements + num_ghosts.
+ *                         An element is selected if its entry is non-zero.
+ * \note This function is collective.
+ */
+void                t8_forest_ghost_exchange_data_selected (t8_forest_t
+                                                            forest,
+                                                            sc_array_t *
+                                                            element_data,
+                                                            const int8_t *
+                                                            selected);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_GHOST_H! */
@@ -0,0 +1,250 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_hash.h>
+#include <t8_data/t8_hash.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The number of elements whose levels and ids are computed at once */
+#define T8_FOREST_HASH_BATCH 64
+
+/* Return the sum of the hashes of the elements first, ..., first + count - 1
+ * of a local tree. The hash of an element only depends on its global tree,
+ * its level and its linear id, such that the sum is independent of the
+ * partition and can be updated element by element. */
+static              uint64_t
+t8_forest_hash_elements (t8_forest_t forest, t8_locidx_t ltreeid,
+                         t8_locidx_t first, t8_locidx_t count)
+{
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_linearidx_t      ids[T8_FOREST_HASH_BATCH];
+  t8_gloidx_t         gtreeid;
+  t8_locidx_t         ielement;
+  int                 levels[T8_FOREST_HASH_BATCH];
+  int                 maxlevel, batch_count, ibatch;
+  uint64_t            hash = 0;
+
+  if (count <= 0) {
+    return 0;
+  }
+  tree = t8_forest_get_tree (forest, ltreeid);
+  T8_ASSERT (tree->packed_elements == NULL);
+  T8_ASSERT (first + count <=
+             (t8_locidx_t) t8_element_array_get_count (&tree->elements));
+  ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+  gtreeid = forest->first_local_tree + ltreeid;
+  maxlevel = ts->t8_element_maxlevel ();
+  for (ielement = first; ielement < first + count; ielement += batch_count) {
+    batch_count =
+      (int) SC_MIN (T8_FOREST_HASH_BATCH, first + count - ielement);
+    element = t8_element_array_index_locidx (&tree->elements, ielement);
+    ts->t8_element_batch_level (element, batch_count, levels);
+    ts->t8_element_batch_get_linear_id (element, batch_count, maxlevel, ids);
+    for (ibatch = 0; ibatch < batch_count; ibatch++) {
+      hash += t8_hash_mix (ids[ibatch] ^ t8_hash_mix (((uint64_t) gtreeid << 8)
+                                                      | levels[ibatch]));
+    }
+  }
+  return hash;
+}
+
+void
+t8_forest_hash_compute (t8_forest_t forest)
+{
+  t8_tree_t           tree;
+  t8_locidx_t         ltreeid, num_trees;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  if (forest->hash_valid) {
+    return;
+  }
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (ltreeid = 0; ltreeid < num_trees; ltreeid++) {
+    tree = t8_forest_get_tree (forest, ltreeid);
+    SC_CHECK_ABORT (tree->packed_elements == NULL,
+                    "Cannot hash the elements of a compressed forest.\n");
+    tree->hash = t8_forest_hash_elements (forest, ltreeid, 0,
+                                          t8_forest_get_tree_element_count
+                                          (tree));
+  }
+  forest->hash_valid = 1;
+}
+
+void
+t8_forest_hash_adapt (t8_forest_t forest, int new_elements)
+{
+  const t8_forest_adapt_run_t *run;
+  t8_forest_t         forest_elements;
+  t8_tree_t           tree;
+  t8_locidx_t         ltreeid, first, num, num_in_tree, tree_end;
+  size_t              irun;
+  uint64_t            hash;
+
+  if (!forest->hash_valid) {
+    return;
+  }
+  if (forest->adapt_runs == NULL) {
+    /* We do not know which elements changed */
+    forest->hash_valid = 0;
+    return;
+  }
+  forest_elements = new_elements ? forest : forest->set_from;
+  ltreeid = 0;
+  for (irun = 0; irun < forest->adapt_runs->elem_count; irun++) {
+    run = (const t8_forest_adapt_run_t *)
+      sc_array_index (forest->adapt_runs, irun);
+    if (run->kind == T8_FOREST_ADAPT_UNCHANGED) {
+      continue;
+    }
+    first = new_elements ? run->first_new : run->first_old;
+    num = new_elements ? run->num_new : run->num_old;
+    /* A run may cover several trees */
+    while (num > 0) {
+      tree = t8_forest_get_tree (forest_elements, ltreeid);
+      tree_end = tree->elements_offset +
+        t8_forest_get_tree_element_count (tree);
+      if (first >= tree_end) {
+        ltreeid++;
+        continue;
+      }
+      num_in_tree = SC_MIN (num, tree_end - first);
+      hash = t8_forest_hash_elements (forest_elements, ltreeid,
+                                      first - tree->elements_offset,
+                                      num_in_tree);
+      tree = t8_forest_get_tree (forest, ltreeid);
+      if (new_elements) {
+        tree->hash += hash;
+      }
+      else {
+        tree->hash -= hash;
+      }
+      first += num_in_tree;
+      num -= num_in_tree;
+    }
+  }
+}
+
+void
+t8_forest_hash_partition (t8_forest_t forest)
+{
+  t8_forest_t         forest_from;
+  t8_tree_t           tree, tree_from;
+  t8_gloidx_t         first_from, end_from, first_to, end_to;
+  t8_gloidx_t         keep_first, keep_end, tree_first, tree_first_from;
+  t8_locidx_t         ltreeid, ltreeid_from, num_trees, count, count_from;
+  t8_locidx_t         first, end, first_from_tree, end_from_tree;
+  uint64_t            hash;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (forest_from != NULL);
+  if (!forest_from->hash_valid) {
+    forest->hash_valid = 0;
+    return;
+  }
+  T8_ASSERT (forest->element_offsets != NULL
+             && forest_from->element_offsets != NULL);
+  first_from = t8_shmem_array_get_gloidx (forest_from->element_offsets,
+                                          forest->mpirank);
+  end_from = t8_shmem_array_get_gloidx (forest_from->element_offsets,
+                                        forest->mpirank + 1);
+  first_to = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                        forest->mpirank);
+  end_to = t8_shmem_array_get_gloidx (forest->element_offsets,
+                                      forest->mpirank + 1);
+  /* The global ids of the elements that stayed on this process */
+  keep_first = SC_MAX (first_from, first_to);
+  keep_end = SC_MIN (end_from, end_to);
+
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (ltreeid = 0; ltreeid < num_trees; ltreeid++) {
+    tree = t8_forest_get_tree (forest, ltreeid);
+    count = t8_forest_get_tree_element_count (tree);
+    tree_first = first_to + tree->elements_offset;
+    /* The kept elements of the tree are first, ..., end - 1 */
+    first = (t8_locidx_t) (SC_MAX (tree_first, keep_first) - tree_first);
+    end = (t8_locidx_t) (SC_MIN (tree_first + count, keep_end) - tree_first);
+    if (first < end) {
+      /* Take the hash of the kept elements from forest_from and only hash
+       * the sent and received elements */
+      ltreeid_from = (t8_locidx_t) (forest->first_local_tree + ltreeid
+                                    - forest_from->first_local_tree);
+      tree_from = t8_forest_get_tree (forest_from, ltreeid_from);
+      count_from = t8_forest_get_tree_element_count (tree_from);
+      tree_first_from = first_from + tree_from->elements_offset;
+      first_from_tree = (t8_locidx_t) (tree_first + first - tree_first_from);
+      end_from_tree = (t8_locidx_t) (tree_first + end - tree_first_from);
+      hash = tree_from->hash
+        - t8_forest_hash_elements (forest_from, ltreeid_from, 0,
+                                   first_from_tree)
+        - t8_forest_hash_elements (forest_from, ltreeid_from, end_from_tree,
+                                   count_from - end_from_tree)
+        + t8_forest_hash_elements (forest, ltreeid, 0, first)
+        + t8_forest_hash_elements (forest, ltreeid, end, count - end);
+    }
+    else {
+      /* All elements of this tree were received */
+      hash = t8_forest_hash_elements (forest, ltreeid, 0, count);
+    }
+    tree->hash = hash;
+  }
+  forest->hash_valid = 1;
+}
+
+uint64_t
+t8_forest_get_tree_hash (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  t8_forest_hash_compute (forest);
+  return t8_forest_get_tree (forest, ltreeid)->hash;
+}
+
+uint64_t
+t8_forest_get_hash (t8_forest_t forest)
+{
+  t8_locidx_t         ltreeid, num_trees;
+  /* The wrapping sum of unsigned 64-bit integers as for the tree hashes */
+  unsigned long long  local_hash = 0, global_hash;
+  int                 mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  t8_forest_hash_compute (forest);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (ltreeid = 0; ltreeid < num_trees; ltreeid++) {
+    local_hash += t8_forest_get_tree (forest, ltreeid)->hash;
+  }
+  mpiret = sc_MPI_Allreduce (&local_hash, &global_hash, 1,
+                             sc_MPI_UNSIGNED_LONG_LONG, sc_MPI_SUM,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  return (uint64_t) global_hash;
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,70 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_hash.h
+ * We define routines to maintain the content hashes of the local trees of
+ * a forest through adapt and partition, such that only the changed and
+ * moved elements are hashed.
+ * \see t8_forest_get_tree_hash
+ */
+
+#ifndef T8_FOREST_HASH_H
+#define T8_FOREST_HASH_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the hashes of all local trees of a forest, if they are not
+ * valid yet.
+ * \param [in,out] forest       A committed forest.
+ */
+void                t8_forest_hash_compute (t8_forest_t forest);
+
+/** Update the tree hashes of a forest that is adapted from
+ * forest->set_from along its recorded adapt runs.
+ * The tree hashes of \a forest must be the ones of forest->set_from.
+ * This is done in two steps, since the old elements may be overwritten
+ * by the adaptation.
+ * \param [in,out] forest       A forest in the course of adaptation.
+ *                              If it has no adapt runs, its hashes are
+ *                              marked invalid.
+ * \param [in]     new_elements If false, subtract the hashes of the old
+ *                              elements of the changed runs from set_from.
+ *                              If true, add the hashes of the new elements.
+ */
+void                t8_forest_hash_adapt (t8_forest_t forest,
+                                          int new_elements);
+
+/** Compute the tree hashes of a forest after partitioning it from
+ * forest->set_from. Only the elements that are sent or received are
+ * hashed, the hashes of the kept elements are taken from set_from.
+ * \param [in,out] forest       A forest after \ref t8_forest_partition,
+ *                              whose partition table and the one of
+ *                              set_from exist.
+ */
+void                t8_forest_hash_partition (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_HASH_H */
@@ -0,0 +1,683 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest_hdf5.h>
+#include <t8_element_cxx.hxx>
+#include "t8_forest_types.h"
+#include <vector>
+#if T8_WITH_HDF5
+#include <hdf5.h>
+#endif
+
+#if T8_WITH_HDF5
+/* The XDMF cell type ids of the element shapes in the order of
+ * t8_eclass_t. Vertices and lines are written as poly-vertices and
+ * poly-lines, which are followed by their number of nodes. */
+static const int    t8_forest_hdf5_xdmf_type[T8_ECLASS_COUNT] = {
+  1, 2, 5, 4, 9, 6, 8, 7
+};
+
+/* Write the local rows of a two dimensional dataset of global_rows times
+ * num_columns entries, starting at global row first_row.
+ * If num_columns is 1, the dataset is one dimensional.
+ * Must be called on all processes. Returns a negative value on error. */
+static int
+t8_forest_hdf5_write_dataset (hid_t file, hid_t dxpl, const char *name,
+                              hid_t type, hsize_t num_columns,
+                              hsize_t local_rows, hsize_t global_rows,
+                              hsize_t first_row, const void *buffer)
+{
+  hsize_t             dims[2], chunk[2], start[2], count[2];
+  hid_t               filespace, memspace, dcpl, dataset;
+  const int           rank = num_columns > 1 ? 2 : 1;
+  herr_t              status = 0;
+  unsigned int        filter_info;
+
+  dims[0] = global_rows;
+  dims[1] = num_columns;
+  filespace = H5Screate_simple (rank, dims, NULL);
+  dcpl = H5Pcreate (H5P_DATASET_CREATE);
+  if (global_rows > 0) {
+    /* Chunking is required for compression and must not have empty chunks */
+    chunk[0] = SC_MIN (global_rows, T8_FOREST_HDF5_CHUNK_SIZE);
+    chunk[1] = num_columns;
+    H5Pset_chunk (dcpl, rank, chunk);
+    if (H5Zfilter_avail (H5Z_FILTER_DEFLATE) > 0
+        && H5Zget_filter_info (H5Z_FILTER_DEFLATE, &filter_info) >= 0
+        && (filter_info & H5Z_FILTER_CONFIG_ENCODE_ENABLED)) {
+      H5Pset_deflate (dcpl, 1);
+    }
+  }
+  dataset = H5Dcreate2 (file, name, type, filespace, H5P_DEFAULT, dcpl,
+                        H5P_DEFAULT);
+  H5Pclose (dcpl);
+  if (dataset < 0) {
+    H5Sclose (filespace);
+    return -1;
+  }
+
+  /* Select the rows of this process in the file */
+  count[0] = local_rows;
+  count[1] = num_columns;
+  memspace = H5Screate_simple (rank, local_rows > 0 ? count : dims, NULL);
+  if (local_rows > 0) {
+    start[0] = first_row;
+    start[1] = 0;
+    H5Sselect_hyperslab (filespace, H5S_SELECT_SET, start, NULL, count,
+                         NULL);
+  }
+  else {
+    /* We still take part in the collective write */
+    H5Sselect_none (filespace);
+    H5Sselect_none (memspace);
+  }
+  status = H5Dwrite (dataset, type, memspace, filespace, dxpl, buffer);
+
+  H5Sclose (memspace);
+  H5Sclose (filespace);
+  H5Dclose (dataset);
+  return status;
+}
+
+/* Write an Attribute entry of a cell centered dataset to the xdmf file */
+static void
+t8_forest_hdf5_xdmf_attribute (FILE * xdmffile, const char *h5name,
+                               const char *name, int is_vector,
+                               const char *number_type, int precision,
+                               t8_gloidx_t global_num_elements)
+{
+  fprintf (xdmffile, "      <Attribute Name=\"%s\" AttributeType=\"%s\" "
+           "Center=\"Cell\">\n", name, is_vector ? "Vector" : "Scalar");
+  fprintf (xdmffile, "        <DataItem Dimensions=\"%lli%s\" "
+           "NumberType=\"%s\" Precision=\"%i\" Format=\"HDF\">\n",
+           (long long) global_num_elements, is_vector ? " 3" : "",
+           number_type, precision);
+  fprintf (xdmffile, "          %s:/%s\n", h5name, name);
+  fprintf (xdmffile, "        </DataItem>\n      </Attribute>\n");
+}
+
+/* Return the name of an h5 file relative to the directory of the xdmf
+ * file, which is the same as that of the h5 file. */
+static const char  *
+t8_forest_hdf5_relative_name (const char *h5filename)
+{
+  const char         *h5name;
+
+  h5name = strrchr (h5filename, '/');
+  return h5name == NULL ? h5filename : h5name + 1;
+}
+
+/* Write the Grid entry of one forest to the xdmf file. The mesh datasets
+ * are read from mesh_h5name, the mpirank and user data from data_h5name.
+ * If time is not NULL, the grid is a step of a time series.
+ * global_sizes are the global numbers of corners, topology entries and
+ * elements. */
+static void
+t8_forest_hdf5_xdmf_grid (FILE * xdmffile, const char *grid_name,
+                          const double *time, const char *mesh_h5name,
+                          const char *data_h5name, int write_treeid,
+                          int write_mpirank, int write_level, int num_data,
+                          t8_vtk_data_field_t * data,
+                          const long long *global_sizes)
+{
+  int                 idata;
+
+  fprintf (xdmffile, "    <Grid Name=\"%s\" GridType=\"Uniform\">\n",
+           grid_name);
+  if (time != NULL) {
+    fprintf (xdmffile, "      <Time Value=\"%.16g\"/>\n", *time);
+  }
+  fprintf (xdmffile, "      <Topology TopologyType=\"Mixed\" "
+           "NumberOfElements=\"%lli\">\n", global_sizes[2]);
+  fprintf (xdmffile, "        <DataItem Dimensions=\"%lli\" "
+           "NumberType=\"Int\" Precision=\"8\" Format=\"HDF\">\n",
+           global_sizes[1]);
+  fprintf (xdmffile, "          %s:/topology\n", mesh_h5name);
+  fprintf (xdmffile, "        </DataItem>\n      </Topology>\n");
+  fprintf (xdmffile, "      <Geometry GeometryType=\"XYZ\">\n");
+  fprintf (xdmffile, "        <DataItem Dimensions=\"%lli 3\" "
+           "NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">\n",
+           global_sizes[0]);
+  fprintf (xdmffile, "          %s:/coordinates\n", mesh_h5name);
+  fprintf (xdmffile, "        </DataItem>\n      </Geometry>\n");
+
+  t8_forest_hdf5_xdmf_attribute (xdmffile, mesh_h5name, "eclass", 0, "Int",
+                                 4, global_sizes[2]);
+  if (write_treeid) {
+    t8_forest_hdf5_xdmf_attribute (xdmffile, mesh_h5name, "treeid", 0,
+                                   "Int", 8, global_sizes[2]);
+  }
+  if (write_mpirank) {
+    t8_forest_hdf5_xdmf_attribute (xdmffile, data_h5name, "mpirank", 0,
+                                   "Int", 4, global_sizes[2]);
+  }
+  if (write_level) {
+    t8_forest_hdf5_xdmf_attribute (xdmffile, mesh_h5name, "level", 0,
+                                   "Int", 4, global_sizes[2]);
+  }
+  for (idata = 0; idata < num_data; idata++) {
+    t8_forest_hdf5_xdmf_attribute (xdmffile, data_h5name,
+                                   data[idata].description,
+                                   data[idata].type == T8_VTK_VECTOR,
+                                   "Float", 8, global_sizes[2]);
+  }
+  fprintf (xdmffile, "    </Grid>\n");
+}
+
+/* Write the xdmf descriptor that references the datasets of the h5 file.
+ * Returns true on success. */
+static int
+t8_forest_hdf5_write_xdmf (const char *fileprefix, const char *h5filename,
+                           int write_treeid, int write_mpirank,
+                           int write_level, int num_data,
+                           t8_vtk_data_field_t * data,
+                           const long long *global_sizes)
+{
+  char                xdmffilename[BUFSIZ];
+  const char         *h5name;
+  FILE               *xdmffile;
+
+  if (snprintf (xdmffilename, BUFSIZ, "%s.xmf", fileprefix) >= BUFSIZ) {
+    t8_errorf ("Error when writing xdmf file. Filename too long.\n");
+    return 0;
+  }
+  /* The h5 file is referenced relative to the xdmf file */
+  h5name = t8_forest_hdf5_relative_name (h5filename);
+
+  xdmffile = fopen (xdmffilename, "w");
+  if (xdmffile == NULL) {
+    t8_errorf ("Could not open file %s for output.\n", xdmffilename);
+    return 0;
+  }
+  fprintf (xdmffile, "<?xml version=\"1.0\" ?>\n");
+  fprintf (xdmffile, "<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd\" []>\n");
+  fprintf (xdmffile, "<Xdmf Version=\"3.0\">\n  <Domain>\n");
+  t8_forest_hdf5_xdmf_grid (xdmffile, "t8_forest", NULL, h5name, h5name,
+                            write_treeid, write_mpirank, write_level,
+                            num_data, data, global_sizes);
+  fprintf (xdmffile, "  </Domain>\n</Xdmf>\n");
+
+  if (fclose (xdmffile)) {
+    t8_errorf ("Error when closing file %s.\n", xdmffilename);
+    return 0;
+  }
+  return 1;
+}
+
+/* The mesh datasets of the local elements and the position of this
+ * process' rows in the global datasets. */
+typedef struct
+{
+  std::vector < double >coordinates;
+  std::vector < long long >topology, treeids;
+  std::vector < int >eclasses, levels;
+  long long           local_sizes[3];   /* Corners, topology, elements */
+  long long           offsets[3];       /* The first row of this process */
+  long long           global_sizes[3];  /* The global number of rows */
+} t8_forest_hdf5_mesh_t;
+
+/* Collect the element corners, topology, eclasses and, if requested,
+ * tree ids and levels of the local elements and compute the offsets of
+ * the local rows. This function is collective. */
+static void
+t8_forest_hdf5_compute_mesh (t8_forest_t forest, int write_treeid,
+                             int write_level, t8_forest_hdf5_mesh_t * mesh)
+{
+  t8_locidx_t         itree, ielement, num_local_trees, num_elements;
+  t8_locidx_t         num_local_elements;
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_element_shape_t  shape;
+  t8_gloidx_t         gtreeid;
+  double             *tree_vertices, element_coordinates[3];
+  int                 ivertex, mpiret;
+
+  /* The node ids in the topology are local for now and shifted below. */
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  mesh->eclasses.reserve (num_local_elements);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    gtreeid = t8_forest_global_tree_id (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      shape = ts->t8_element_shape (element);
+      mesh->topology.push_back (t8_forest_hdf5_xdmf_type[shape]);
+      if (shape == T8_ECLASS_VERTEX || shape == T8_ECLASS_LINE) {
+        mesh->topology.push_back (t8_eclass_num_vertices[shape]);
+      }
+      for (ivertex = 0; ivertex < t8_eclass_num_vertices[shape]; ivertex++) {
+        mesh->topology.push_back (mesh->coordinates.size () / 3);
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      t8_eclass_vtk_corner_number[shape]
+                                      [ivertex], element_coordinates);
+        mesh->coordinates.insert (mesh->coordinates.end (),
+                                  element_coordinates,
+                                  element_coordinates + 3);
+      }
+      mesh->eclasses.push_back (tree_class);
+      if (write_treeid) {
+        mesh->treeids.push_back (gtreeid);
+      }
+      if (write_level) {
+        mesh->levels.push_back (ts->t8_element_level (element));
+      }
+    }
+  }
+  T8_ASSERT ((t8_locidx_t) mesh->eclasses.size () == num_local_elements);
+
+  /* Compute the offsets of this process' corners and topology entries */
+  mesh->local_sizes[0] = mesh->coordinates.size () / 3;
+  mesh->local_sizes[1] = mesh->topology.size ();
+  mesh->local_sizes[2] = num_local_elements;
+  mpiret = sc_MPI_Exscan (mesh->local_sizes, mesh->offsets, 3,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (mesh->local_sizes, mesh->global_sizes, 3,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The result of Exscan is undefined on the first process */
+    mesh->offsets[0] = mesh->offsets[1] = mesh->offsets[2] = 0;
+  }
+  T8_ASSERT (t8_forest_get_first_local_element_id (forest) ==
+             mesh->offsets[2]);
+  if (mesh->offsets[0] > 0) {
+    /* Shift the node ids to global ids, skipping the type entries */
+    std::vector < long long >&topology = mesh->topology;
+    size_t              ientry = 0;
+    int                 num_nodes;
+
+    while (ientry < topology.size ()) {
+      switch (topology[ientry++]) {
+      case 1:
+      case 2:
+        num_nodes = topology[ientry++];
+        break;
+      case 4:
+        num_nodes = 3;
+        break;
+      case 5:
+      case 6:
+        num_nodes = 4;
+        break;
+      case 7:
+        num_nodes = 5;
+        break;
+      case 8:
+        num_nodes = 6;
+        break;
+      default:
+        T8_ASSERT (topology[ientry - 1] == 9);
+        num_nodes = 8;
+      }
+      for (ivertex = 0; ivertex < num_nodes; ivertex++) {
+        topology[ientry++] += mesh->offsets[0];
+      }
+    }
+  }
+}
+
+/* Create the h5 file on all processes of the forest and the transfer
+ * properties for its datasets. Returns a negative value on error. */
+static              hid_t
+t8_forest_hdf5_create_file (t8_forest_t forest, const char *h5filename,
+                            hid_t * dxpl)
+{
+  hid_t               fapl, file;
+
+  fapl = H5Pcreate (H5P_FILE_ACCESS);
+  *dxpl = H5Pcreate (H5P_DATASET_XFER);
+#ifdef H5_HAVE_PARALLEL
+  H5Pset_fapl_mpio (fapl, forest->mpicomm, sc_MPI_INFO_NULL);
+  H5Pset_dxpl_mpio (*dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+  file = H5Fcreate (h5filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+  H5Pclose (fapl);
+  if (file < 0) {
+    t8_global_errorf ("Could not open file %s for output.\n", h5filename);
+    H5Pclose (*dxpl);
+  }
+  return file;
+}
+
+/* Write the mesh datasets. Must be called on all processes.
+ * Returns true if an error occured. */
+static int
+t8_forest_hdf5_write_mesh (hid_t file, hid_t dxpl,
+                           const t8_forest_hdf5_mesh_t * mesh,
+                           int write_treeid, int write_level)
+{
+  const long long    *local_sizes = mesh->local_sizes;
+  const long long    *offsets = mesh->offsets;
+  const long long    *global_sizes = mesh->global_sizes;
+  int                 failed = 0;
+
+  /* The calls are collective, thus we do not return early on errors. */
+  failed |= t8_forest_hdf5_write_dataset (file, dxpl, "coordinates",
+                                          H5T_NATIVE_DOUBLE, 3,
+                                          local_sizes[0], global_sizes[0],
+                                          offsets[0],
+                                          mesh->coordinates.data ()) < 0;
+  failed |= t8_forest_hdf5_write_dataset (file, dxpl, "topology",
+                                          H5T_NATIVE_LLONG, 1,
+                                          local_sizes[1], global_sizes[1],
+                                          offsets[1],
+                                          mesh->topology.data ()) < 0;
+  failed |= t8_forest_hdf5_write_dataset (file, dxpl, "eclass",
+                                          H5T_NATIVE_INT, 1,
+                                          local_sizes[2], global_sizes[2],
+                                          offsets[2],
+                                          mesh->eclasses.data ()) < 0;
+  if (write_treeid) {
+    failed |= t8_forest_hdf5_write_dataset (file, dxpl, "treeid",
+                                            H5T_NATIVE_LLONG, 1,
+                                            local_sizes[2], global_sizes[2],
+                                            offsets[2],
+                                            mesh->treeids.data ()) < 0;
+  }
+  if (write_level) {
+    failed |= t8_forest_hdf5_write_dataset (file, dxpl, "level",
+                                            H5T_NATIVE_INT, 1,
+                                            local_sizes[2], global_sizes[2],
+                                            offsets[2],
+                                            mesh->levels.data ()) < 0;
+  }
+  return failed;
+}
+
+/* Write the mpirank and the user data of the local elements, which are
+ * the rows first_element, ... of global_num_elements rows.
+ * Must be called on all processes. Returns true if an error occured. */
+static int
+t8_forest_hdf5_write_fields (hid_t file, hid_t dxpl, t8_forest_t forest,
+                             long long global_num_elements,
+                             long long first_element, int write_mpirank,
+                             int num_data, t8_vtk_data_field_t * data)
+{
+  const long long     num_local_elements =
+    t8_forest_get_local_num_elements (forest);
+  int                 idata, failed = 0;
+
+  if (write_mpirank) {
+    std::vector < int >ranks (num_local_elements, forest->mpirank);
+
+    failed |= t8_forest_hdf5_write_dataset (file, dxpl, "mpirank",
+                                            H5T_NATIVE_INT, 1,
+                                            num_local_elements,
+                                            global_num_elements,
+                                            first_element, ranks.data ()) < 0;
+  }
+  for (idata = 0; idata < num_data; idata++) {
+    failed |= t8_forest_hdf5_write_dataset (file, dxpl,
+                                            data[idata].description,
+                                            H5T_NATIVE_DOUBLE,
+                                            data[idata].type ==
+                                            T8_VTK_VECTOR ? 3 : 1,
+                                            num_local_elements,
+                                            global_num_elements,
+                                            first_element,
+                                            data[idata].data) < 0;
+  }
+  return failed;
+}
+
+/* Check whether the hdf5 library can write from the processes of
+ * forest. Returns true if so. */
+static int
+t8_forest_hdf5_check_parallel (t8_forest_t forest, const char *fileprefix)
+{
+#ifndef H5_HAVE_PARALLEL
+  if (forest->mpisize > 1) {
+    t8_global_errorf ("Error: The hdf5 library has no parallel support. "
+                      "Cannot write %s on more than one process.\n",
+                      fileprefix);
+    return 0;
+  }
+#endif
+  return 1;
+}
+#endif
+
+int
+t8_forest_write_hdf5 (t8_forest_t forest, const char *fileprefix,
+                      int write_treeid, int write_mpirank, int write_level,
+                      int num_data, t8_vtk_data_field_t * data)
+{
+#if T8_WITH_HDF5
+  t8_forest_hdf5_mesh_t mesh;
+  char                h5filename[BUFSIZ];
+  hid_t               dxpl, file;
+  int                 failed = 0, xdmf_ok = 1;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (num_data == 0 || data != NULL);
+
+  if (!t8_forest_hdf5_check_parallel (forest, fileprefix)) {
+    return 0;
+  }
+  if (snprintf (h5filename, BUFSIZ, "%s.h5", fileprefix) >= BUFSIZ) {
+    t8_global_errorf ("Error when writing hdf5 file. Filename too long.\n");
+    return 0;
+  }
+
+  t8_forest_hdf5_compute_mesh (forest, write_treeid, write_level, &mesh);
+
+  /* Open the file on all processes */
+  file = t8_forest_hdf5_create_file (forest, h5filename, &dxpl);
+  if (file < 0) {
+    return 0;
+  }
+
+  /* Write the datasets */
+  failed |= t8_forest_hdf5_write_mesh (file, dxpl, &mesh, write_treeid,
+                                       write_level);
+  failed |= t8_forest_hdf5_write_fields (file, dxpl, forest,
+                                         mesh.global_sizes[2],
+                                         mesh.offsets[2], write_mpirank,
+                                         num_data, data);
+  H5Pclose (dxpl);
+  failed |= H5Fclose (file) < 0;
+
+  /* Process 0 writes the xdmf descriptor */
+  if (forest->mpirank == 0) {
+    xdmf_ok = t8_forest_hdf5_write_xdmf (fileprefix, h5filename,
+                                         write_treeid, write_mpirank,
+                                         write_level, num_data, data,
+                                         mesh.global_sizes);
+  }
+  if (failed) {
+    t8_errorf ("Error when writing file %s.\n", h5filename);
+  }
+  return !failed && xdmf_ok;
+#else
+  t8_global_errorf ("Warning: t8code is not linked against hdf5. "
+                    "Did not write %s.h5.\n", fileprefix);
+  return 0;
+#endif
+}
+
+/* The state of a time series output */
+struct t8_forest_hdf5_series
+{
+  char               *fileprefix;       /* The prefix of all files */
+  int                 num_steps;        /* The number of written steps */
+  int                 mesh_step;        /* The last step that wrote the mesh,
+                                           -1 if none */
+  uint64_t            mesh_hash;        /* The forest hash of mesh_step */
+  int                 mesh_treeid;      /* True if mesh_step has tree ids */
+  int                 mesh_level;       /* True if mesh_step has levels */
+  long long           mesh_sizes[3];    /* The global mesh sizes */
+  FILE               *xdmffile; /* The open xdmf file on process 0 */
+  long                xdmf_end; /* The position of the closing tags */
+};
+
+t8_forest_hdf5_series_t
+t8_forest_hdf5_series_new (const char *fileprefix)
+{
+  t8_forest_hdf5_series_t series;
+
+  T8_ASSERT (fileprefix != NULL);
+
+  series = T8_ALLOC_ZERO (struct t8_forest_hdf5_series, 1);
+  series->fileprefix = T8_ALLOC (char, strlen (fileprefix) + 1);
+  strcpy (series->fileprefix, fileprefix);
+  series->mesh_step = -1;
+  return series;
+}
+
+int
+t8_forest_hdf5_series_write (t8_forest_hdf5_series_t series,
+                             t8_forest_t forest, double time,
+                             int write_treeid, int write_mpirank,
+                             int write_level, int num_data,
+                             t8_vtk_data_field_t * data)
+{
+#if T8_WITH_HDF5
+  t8_forest_hdf5_mesh_t mesh;
+  char                h5filename[BUFSIZ], meshfilename[BUFSIZ];
+  char                grid_name[BUFSIZ], xdmffilename[BUFSIZ];
+  hid_t               dxpl, file;
+  uint64_t            hash;
+  long long           global_num_elements, first_element;
+  int                 write_mesh, failed = 0, xdmf_ok = 1;
+
+  T8_ASSERT (series != NULL);
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (num_data == 0 || data != NULL);
+
+  if (!t8_forest_hdf5_check_parallel (forest, series->fileprefix)) {
+    return 0;
+  }
+  if (snprintf (h5filename, BUFSIZ, "%s_%04d.h5", series->fileprefix,
+                series->num_steps) >= BUFSIZ
+      || snprintf (meshfilename, BUFSIZ, "%s_%04d.h5", series->fileprefix,
+                   SC_MAX (series->mesh_step, 0)) >= BUFSIZ) {
+    t8_global_errorf ("Error when writing hdf5 file. Filename too long.\n");
+    return 0;
+  }
+
+  /* The mesh is only written if its elements changed since the last step
+   * that wrote it. The hash does not depend on the partition, and neither
+   * do the mesh datasets, which are ordered by global element id. */
+  hash = t8_forest_get_hash (forest);
+  global_num_elements = t8_forest_get_global_num_elements (forest);
+  write_treeid = (write_treeid != 0);
+  write_level = (write_level != 0);
+  write_mesh = series->mesh_step < 0 || hash != series->mesh_hash
+    || global_num_elements != series->mesh_sizes[2]
+    || write_treeid != series->mesh_treeid
+    || write_level != series->mesh_level;
+  first_element = t8_forest_get_first_local_element_id (forest);
+  if (write_mesh) {
+    t8_forest_hdf5_compute_mesh (forest, write_treeid, write_level, &mesh);
+  }
+
+  file = t8_forest_hdf5_create_file (forest, h5filename, &dxpl);
+  if (file < 0) {
+    return 0;
+  }
+  if (write_mesh) {
+    failed |= t8_forest_hdf5_write_mesh (file, dxpl, &mesh, write_treeid,
+                                         write_level);
+  }
+  failed |= t8_forest_hdf5_write_fields (file, dxpl, forest,
+                                         global_num_elements, first_element,
+                                         write_mpirank, num_data, data);
+  H5Pclose (dxpl);
+  failed |= H5Fclose (file) < 0;
+
+  if (write_mesh) {
+    series->mesh_step = series->num_steps;
+    series->mesh_hash = hash;
+    series->mesh_treeid = write_treeid;
+    series->mesh_level = write_level;
+    memcpy (series->mesh_sizes, mesh.global_sizes, sizeof (mesh.global_sizes));
+    strcpy (meshfilename, h5filename);
+  }
+
+  /* Process 0 appends the step to the temporal collection of the xdmf
+   * file. The closing tags are overwritten by the next step, such that
+   * the file is complete after each step. */
+  if (forest->mpirank == 0 && series->xdmffile == NULL) {
+    snprintf (xdmffilename, BUFSIZ, "%s.xmf", series->fileprefix);
+    series->xdmffile = fopen (xdmffilename, "w");
+    if (series->xdmffile == NULL) {
+      t8_errorf ("Could not open file %s for output.\n", xdmffilename);
+      xdmf_ok = 0;
+    }
+    else {
+      fprintf (series->xdmffile, "<?xml version=\"1.0\" ?>\n");
+      fprintf (series->xdmffile, "<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd\" []>\n");
+      fprintf (series->xdmffile, "<Xdmf Version=\"3.0\">\n  <Domain>\n");
+      fprintf (series->xdmffile, "    <Grid Name=\"t8_forest_series\" "
+               "GridType=\"Collection\" CollectionType=\"Temporal\">\n");
+      series->xdmf_end = ftell (series->xdmffile);
+    }
+  }
+  if (series->xdmffile != NULL) {
+    fseek (series->xdmffile, series->xdmf_end, SEEK_SET);
+    snprintf (grid_name, BUFSIZ, "t8_forest_%04d", series->num_steps);
+    t8_forest_hdf5_xdmf_grid (series->xdmffile, grid_name, &time,
+                              t8_forest_hdf5_relative_name (meshfilename),
+                              t8_forest_hdf5_relative_name (h5filename),
+                              series->mesh_treeid, write_mpirank,
+                              series->mesh_level, num_data, data,
+                              series->mesh_sizes);
+    series->xdmf_end = ftell (series->xdmffile);
+    fprintf (series->xdmffile, "    </Grid>\n  </Domain>\n</Xdmf>\n");
+    xdmf_ok = fflush (series->xdmffile) == 0;
+  }
+  series->num_steps++;
+  if (failed) {
+    t8_errorf ("Error when writing file %s.\n", h5filename);
+  }
+  return !failed && xdmf_ok;
+#else
+  t8_global_errorf ("Warning: t8code is not linked against hdf5. "
+                    "Did not write %s.\n", series->fileprefix);
+  return 0;
+#endif
+}
+
+void
+t8_forest_hdf5_series_destroy (t8_forest_hdf5_series_t * pseries)
+{
+  t8_forest_hdf5_series_t series;
+
+  T8_ASSERT (pseries != NULL && *pseries != NULL);
+  series = *pseries;
+  if (series->xdmffile != NULL) {
+    fclose (series->xdmffile);
+  }
+  T8_FREE (series->fileprefix);
+  T8_FREE (series);
+  *pseries = NULL;
+}
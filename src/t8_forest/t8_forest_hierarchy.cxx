@@ -0,0 +1,296 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_hierarchy.cxx
+ * A hierarchy of successively coarsened forests with the maps from the
+ * elements of each level to their parents on the next coarser level, as
+ * needed for geometric multigrid.
+ * \see t8_forest_hierarchy_new
+ */
+
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_partition.h>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The levels of the hierarchy. Level 0 is the finest. */
+typedef struct t8_forest_hierarchy
+{
+  int                 num_levels;       /* The number of levels. */
+  t8_forest_t        *forests;  /* The forest of each level. */
+  t8_forest_t        *coarsened;        /* The forest of each level before it
+                                           was aggregated, NULL if it was not. */
+  t8_locidx_t       **parents;  /* For each level but the coarsest, the index
+                                   of the parent of each local element among
+                                   the local elements of the next level
+                                   before its aggregation. */
+  t8_locidx_t        *num_parents;      /* The number of local elements of each
+                                           level before its aggregation. */
+} t8_forest_hierarchy_struct_t;
+
+/* Coarsen all families of the local elements of forest and return the
+ * coarsened forest, which has the same kind of ghost layer. The parent of
+ * each element of forest is stored in parents, which has one entry per
+ * local element of forest.
+ * We do not take ownership of forest. */
+static t8_forest_t
+t8_forest_hierarchy_coarsen (t8_forest_t forest, t8_locidx_t *parents)
+{
+  t8_forest_t         forest_coarse;
+  const t8_forest_adapt_run_t *runs;
+  t8_locidx_t         num_runs, irun, ielement, iparent, ltreeid, last;
+  t8_locidx_t         num_elements;
+  const t8_element_t *element;
+  t8_eclass_scheme_c *ts;
+  int8_t             *markers;
+  int                 num_siblings, isibling;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  /* Every family that lies on this process is coarsened. We allocate
+   * at least one marker, since the array may not be NULL. */
+  markers = T8_ALLOC (int8_t, SC_MAX (num_elements, 1));
+  memset (markers, -1, num_elements * sizeof (int8_t));
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_coarse);
+  t8_forest_set_adapt_markers (forest_coarse, forest, markers, -1);
+  t8_forest_set_adapt_record_runs (forest_coarse, 1);
+  t8_forest_set_adapt_threaded (forest_coarse, 1);
+  if (t8_forest_has_ghost_setting (forest)) {
+    t8_forest_set_ghost_ext (forest_coarse, 1, forest->ghost_type,
+                             forest->ghost_algorithm);
+  }
+  t8_forest_commit (forest_coarse);
+  T8_FREE (markers);
+
+  /* The adapt runs give the parents without comparing the elements */
+  runs = t8_forest_get_adapt_runs (forest_coarse, &num_runs);
+  T8_ASSERT (runs != NULL || num_elements == 0);
+  for (irun = 0; irun < num_runs; irun++) {
+    ielement = runs[irun].first_old;
+    last = ielement + runs[irun].num_old;
+    iparent = runs[irun].first_new;
+    if (runs[irun].kind == T8_FOREST_ADAPT_UNCHANGED) {
+      for (; ielement < last; ielement++) {
+        parents[ielement] = iparent++;
+      }
+      continue;
+    }
+    T8_ASSERT (runs[irun].kind == T8_FOREST_ADAPT_COARSENED);
+    /* The families of the run follow each other */
+    while (ielement < last) {
+      element = t8_forest_get_element (forest, ielement, &ltreeid);
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_get_tree_class (forest,
+                                                                  ltreeid));
+      num_siblings = ts->t8_element_num_siblings (element);
+      for (isibling = 0; isibling < num_siblings; isibling++) {
+        parents[ielement++] = iparent;
+      }
+      iparent++;
+    }
+    T8_ASSERT (iparent == runs[irun].first_new + runs[irun].num_new);
+  }
+  return forest_coarse;
+}
+
+t8_forest_hierarchy_t
+t8_forest_hierarchy_new (t8_forest_t forest, int max_levels,
+                         t8_gloidx_t min_elements)
+{
+  t8_forest_hierarchy_t hierarchy;
+  t8_forest_t         fine, coarse, aggregated;
+  t8_gloidx_t        *offsets;
+  int                 level;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (max_levels >= 1);
+  T8_ASSERT (min_elements >= 0);
+
+  hierarchy = T8_ALLOC_ZERO (t8_forest_hierarchy_struct_t, 1);
+  hierarchy->forests = T8_ALLOC_ZERO (t8_forest_t, max_levels);
+  hierarchy->coarsened = T8_ALLOC_ZERO (t8_forest_t, max_levels);
+  hierarchy->parents = T8_ALLOC_ZERO (t8_locidx_t *, max_levels);
+  hierarchy->num_parents = T8_ALLOC_ZERO (t8_locidx_t, max_levels);
+
+  hierarchy->forests[0] = forest;
+  hierarchy->num_parents[0] = t8_forest_get_local_num_elements (forest);
+  hierarchy->num_levels = 1;
+  for (level = 1; level < max_levels; level++) {
+    fine = hierarchy->forests[level - 1];
+    hierarchy->parents[level - 1] =
+      T8_ALLOC (t8_locidx_t, t8_forest_get_local_num_elements (fine));
+    coarse = t8_forest_hierarchy_coarsen (fine, hierarchy->parents[level - 1]);
+    if (t8_forest_get_global_num_elements (coarse) ==
+        t8_forest_get_global_num_elements (fine)) {
+      /* No family could be coarsened anywhere */
+      t8_forest_unref (&coarse);
+      T8_FREE (hierarchy->parents[level - 1]);
+      hierarchy->parents[level - 1] = NULL;
+      break;
+    }
+    hierarchy->num_parents[level] = t8_forest_get_local_num_elements (coarse);
+    if (min_elements > 0) {
+      /* Move the elements to fewer processes if they are too few */
+      t8_forest_concentrate_offsets (coarse, min_elements, &offsets);
+      if (offsets != NULL) {
+        t8_forest_ref (coarse);
+        t8_forest_init (&aggregated);
+        t8_forest_set_partition (aggregated, coarse, 0);
+        t8_forest_set_partition_offsets (aggregated, offsets);
+        if (t8_forest_has_ghost_setting (fine)) {
+          t8_forest_set_ghost_ext (aggregated, 1, fine->ghost_type,
+                                   fine->ghost_algorithm);
+        }
+        t8_forest_commit (aggregated);
+        T8_FREE (offsets);
+        hierarchy->coarsened[level] = coarse;
+        coarse = aggregated;
+      }
+    }
+    hierarchy->forests[level] = coarse;
+    hierarchy->num_levels++;
+  }
+  t8_debugf ("Built a forest hierarchy with %i levels\n",
+             hierarchy->num_levels);
+  return hierarchy;
+}
+
+int
+t8_forest_hierarchy_get_num_levels (t8_forest_hierarchy_t hierarchy)
+{
+  T8_ASSERT (hierarchy != NULL);
+  return hierarchy->num_levels;
+}
+
+t8_forest_t
+t8_forest_hierarchy_get_forest (t8_forest_hierarchy_t hierarchy, int level)
+{
+  T8_ASSERT (hierarchy != NULL);
+  T8_ASSERT (0 <= level && level < hierarchy->num_levels);
+  return hierarchy->forests[level];
+}
+
+const t8_locidx_t  *
+t8_forest_hierarchy_get_parents (t8_forest_hierarchy_t hierarchy, int level,
+                                 t8_locidx_t *num_parents)
+{
+  T8_ASSERT (hierarchy != NULL);
+  T8_ASSERT (0 <= level && level < hierarchy->num_levels - 1);
+  if (num_parents != NULL) {
+    *num_parents = hierarchy->num_parents[level + 1];
+  }
+  return hierarchy->parents[level];
+}
+
+int
+t8_forest_hierarchy_is_aggregated (t8_forest_hierarchy_t hierarchy,
+                                   int level)
+{
+  T8_ASSERT (hierarchy != NULL);
+  T8_ASSERT (0 <= level && level < hierarchy->num_levels);
+  return hierarchy->coarsened[level] != NULL;
+}
+
+/* Copy the entries of data_in to data_out, either by partitioning them
+ * from forest_from to forest_to or locally if both are the same. */
+static void
+t8_forest_hierarchy_move_data (t8_forest_t forest_from,
+                               t8_forest_t forest_to,
+                               const sc_array_t *data_in,
+                               sc_array_t *data_out)
+{
+  T8_ASSERT (data_in->elem_size == data_out->elem_size);
+  if (forest_from == forest_to) {
+    T8_ASSERT (data_in->elem_count == data_out->elem_count);
+    memcpy (data_out->array, data_in->array,
+            data_in->elem_count * data_in->elem_size);
+  }
+  else {
+    t8_forest_partition_data (forest_from, forest_to, data_in, data_out);
+  }
+}
+
+void
+t8_forest_hierarchy_aggregate_data (t8_forest_hierarchy_t hierarchy,
+                                    int level, const sc_array_t *data_in,
+                                    sc_array_t *data_out)
+{
+  t8_forest_t         coarsened;
+
+  T8_ASSERT (hierarchy != NULL);
+  T8_ASSERT (1 <= level && level < hierarchy->num_levels);
+  T8_ASSERT (data_in->elem_count == (size_t) hierarchy->num_parents[level]);
+
+  coarsened = hierarchy->coarsened[level];
+  t8_forest_hierarchy_move_data (coarsened != NULL ? coarsened :
+                                 hierarchy->forests[level],
+                                 hierarchy->forests[level], data_in,
+                                 data_out);
+}
+
+void
+t8_forest_hierarchy_disaggregate_data (t8_forest_hierarchy_t hierarchy,
+                                       int level, const sc_array_t *data_in,
+                                       sc_array_t *data_out)
+{
+  t8_forest_t         coarsened;
+
+  T8_ASSERT (hierarchy != NULL);
+  T8_ASSERT (1 <= level && level < hierarchy->num_levels);
+  T8_ASSERT (data_out->elem_count == (size_t) hierarchy->num_parents[level]);
+
+  coarsened = hierarchy->coarsened[level];
+  t8_forest_hierarchy_move_data (hierarchy->forests[level],
+                                 coarsened != NULL ? coarsened :
+                                 hierarchy->forests[level], data_in,
+                                 data_out);
+}
+
+void
+t8_forest_hierarchy_destroy (t8_forest_hierarchy_t *phierarchy)
+{
+  t8_forest_hierarchy_t hierarchy;
+  int                 level;
+
+  T8_ASSERT (phierarchy != NULL && *phierarchy != NULL);
+  hierarchy = *phierarchy;
+  for (level = 0; level < hierarchy->num_levels; level++) {
+    t8_forest_unref (&hierarchy->forests[level]);
+    if (hierarchy->coarsened[level] != NULL) {
+      t8_forest_unref (&hierarchy->coarsened[level]);
+    }
+    T8_FREE (hierarchy->parents[level]);
+  }
+  T8_FREE (hierarchy->forests);
+  T8_FREE (hierarchy->coarsened);
+  T8_FREE (hierarchy->parents);
+  T8_FREE (hierarchy->num_parents);
+  T8_FREE (hierarchy);
+  *phierarchy = NULL;
+}
+
+T8_EXTERN_C_END ();
@@ -22,64 +22,92 @@
 
 #include <t8_forest/t8_forest_iterate.h>
 #include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_partition.h>
+#include <t8_forest/t8_forest_ghost.h>
 #include <t8_forest.h>
+#include <t8_cmesh.h>
 #include <t8_element_cxx.hxx>
 
-/* We want to export the whole implementation to be callable from "C" */
-T8_EXTERN_C_BEGIN ();
+#include <t8_forest/t8_forest_dispatch.hxx>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
-typedef struct
+template < class TScheme > struct t8_forest_child_type_query
 {
-  t8_eclass_scheme_c *ts;
+  TScheme            *ts;
   int                 level;
-  int                 num_children;
-} t8_forest_child_type_query_t;
+};
 
 /* This is the function that we call in sc_split_array to determine for an
  * element E that is a descendant of an element e, of which of e's children,
- * E is a descendant. */
-static              size_t
+ * E is a descendant.
+ * TScheme is a t8_scheme_static_c, such that the element functions are
+ * not dispatched via the virtual table. */
+template < class TScheme > static size_t
 t8_forest_determine_child_type (sc_array_t * leaf_elements,
                                 size_t index, void *data)
 {
-  t8_forest_child_type_query_t *query_data =
-    (t8_forest_child_type_query_t *) data;
+  t8_forest_child_type_query < TScheme > *query_data =
+    (t8_forest_child_type_query < TScheme > *)data;
   t8_element_t       *element;
 
   /* Get a pointer to the element */
   element = (t8_element_t *) t8_sc_array_index_locidx (leaf_elements, index);
-  T8_ASSERT (query_data->level < query_data->ts->t8_element_level (element));
+  T8_ASSERT (query_data->level < query_data->ts->level (element));
   /* Compute the element's ancestor id at the stored level and return it
    * as the element's type */
-  return query_data->ts->t8_element_ancestor_id (element,
-                                                 query_data->level + 1);
+  return query_data->ts->ancestor_id (element, query_data->level + 1);
 }
 
+/* Operation for t8_forest_dispatch_scheme that splits an array of leaf
+ * elements according to their ancestor ids at a given level. */
+struct t8_forest_split_array_op
+{
+  sc_array_t         *element_array;    /* The leaf elements */
+  sc_array_t         *offset_view;      /* The offsets to fill */
+  int                 level;    /* The level of the element to split at */
+  int                 num_children;     /* Number of children of this element */
+
+  template < class TScheme > void operator () (TScheme & ts)
+  {
+    t8_forest_child_type_query < TScheme > query_data;
+
+    query_data.ts = &ts;
+    query_data.level = level;
+    sc_array_split (element_array, offset_view, num_children,
+                    t8_forest_determine_child_type < TScheme >,
+                    (void *) &query_data);
+  }
+};
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
 void
 t8_forest_split_array (const t8_element_t * element,
                        t8_element_array_t * leaf_elements, size_t * offsets)
 {
   sc_array_t          offset_view;
-  sc_array_t         *element_array;
-  t8_forest_child_type_query_t query_data;
+  t8_forest_split_array_op split_op;
   t8_eclass_scheme_c *ts;
 
   ts = t8_element_array_get_scheme (leaf_elements);
   /* Store the number of children and the level of element */
-  query_data.num_children = ts->t8_element_num_children (element);
-  query_data.level = ts->t8_element_level (element);
-  query_data.ts = ts;
+  split_op.num_children = ts->t8_element_num_children (element);
+  split_op.level = ts->t8_element_level (element);
 
-  element_array = t8_element_array_get_array (leaf_elements);
+  split_op.element_array = t8_element_array_get_array (leaf_elements);
   /* Split the elements array according to the elements' ancestor id at
    * the given level. In other words for each child C of element, find
    * the indices i, j such that all descendants of C are
    * elements[i], ..., elements[j-1]
    */
   sc_array_init_data (&offset_view, offsets, sizeof (size_t),
-                      query_data.num_children + 1);
-  sc_array_split (element_array, &offset_view, query_data.num_children,
-                  t8_forest_determine_child_type, (void *) &query_data);
+                      split_op.num_children + 1);
+  split_op.offset_view = &offset_view;
+  t8_forest_dispatch_scheme (ts, split_op);
 }
 
 void
@@ -175,58 +203,417 @@ t8_forest_iterate_faces (t8_forest_t forest, t8_locidx_t ltreeid,
   }
 }
 
-/* The recursion that is called from t8_forest_search_tree
- * Input is an element and an array of all leaf elements of this element.
- * The callback function is called on element and if it returns true,
- * the search continues with the children of the element.
- * Additionally a query function and a set of queries can be given.
- * In this case the recursion stops when either the search_fn function
- * returns false or the query_fn function returns false for all active queries.
- * (Thus, if there are no active queries left, the recursion also stops.)
- * A query is active for an element if the query_fn callback returned true
- * for the parent element.
+/* Return true if a face of a local element is passed to the callback of
+ * t8_forest_iterate_all_faces from this element. */
+static int
+t8_forest_iterate_all_faces_visit (t8_forest_t forest,
+                                   const t8_forest_face_info_t * info,
+                                   int level)
+{
+  const t8_locidx_t   num_local = t8_forest_get_local_num_elements (forest);
+  const t8_locidx_t   neighbor_index = info->neighbor_indices[0];
+  int                 neighbor_level;
+
+  neighbor_level = info->neighbor_scheme->t8_element_level (info->neighbors[0]);
+  if (neighbor_level > level || neighbor_index >= num_local) {
+    /* We are the coarse side of a hanging face or the neighbor is a ghost */
+    return 1;
+  }
+  if (neighbor_level < level) {
+    /* The local coarse neighbor passes this face */
+    return 0;
+  }
+  /* The element with the smaller index passes the face. For an element
+   * that is its own neighbor, the smaller face passes it. */
+  return neighbor_index > info->element_index
+    || (neighbor_index == info->element_index
+        && info->face <= info->dual_faces[0]);
+}
+
+/* Call the face callback for the faces of a local element that are passed
+ * from this element, \see t8_forest_iterate_all_faces.
+ * If workspace is not NULL, the forest is balanced and the neighbors are
+ * computed with the workspace. */
+static void
+t8_forest_iterate_element_faces (t8_forest_t forest, t8_locidx_t ltreeid,
+                                 t8_eclass_scheme_c * ts,
+                                 const t8_element_t * element,
+                                 t8_locidx_t element_index,
+                                 t8_forest_face_neighbor_workspace_t
+                                 workspace,
+                                 t8_forest_iterate_all_faces_fn callback,
+                                 void *user_data)
+{
+  t8_forest_face_info_t info;
+  t8_element_t      **neighbor_leafs;
+  const int          *dual_faces;
+  const t8_locidx_t  *neighbor_indices;
+  int                *alloc_dual_faces;
+  t8_locidx_t        *alloc_indices;
+  int                 num_faces, level;
+
+  info.ltreeid = ltreeid;
+  info.element = element;
+  info.element_index = element_index;
+  level = ts->t8_element_level (element);
+  num_faces = ts->t8_element_num_faces (element);
+  for (info.face = 0; info.face < num_faces; info.face++) {
+    /* Compute the neighbors, with the workspace if we can */
+    if (workspace != NULL) {
+      info.num_neighbors =
+        t8_forest_leaf_face_neighbors_workspace (forest, ltreeid, element,
+                                                 info.face, workspace,
+                                                 &neighbor_leafs, &dual_faces,
+                                                 &neighbor_indices,
+                                                 &info.neighbor_scheme, 1);
+    }
+    else {
+      t8_forest_leaf_face_neighbors (forest, ltreeid, element,
+                                     &neighbor_leafs, info.face,
+                                     &alloc_dual_faces, &info.num_neighbors,
+                                     &alloc_indices, &info.neighbor_scheme,
+                                     0);
+      dual_faces = alloc_dual_faces;
+      neighbor_indices = alloc_indices;
+    }
+    info.neighbors = neighbor_leafs;
+    info.dual_faces = dual_faces;
+    info.neighbor_indices = neighbor_indices;
+    info.is_hanging = 0;
+    if (info.num_neighbors > 0) {
+      info.is_hanging = level !=
+        info.neighbor_scheme->t8_element_level (neighbor_leafs[0]);
+    }
+    if (info.num_neighbors == 0
+        || t8_forest_iterate_all_faces_visit (forest, &info, level)) {
+      info.orientation =
+        t8_forest_leaf_face_orientation (forest, ltreeid, element, info.face);
+      callback (forest, &info, user_data);
+    }
+    if (workspace == NULL && info.num_neighbors > 0) {
+      info.neighbor_scheme->t8_element_destroy (info.num_neighbors,
+                                                neighbor_leafs);
+      T8_FREE (neighbor_leafs);
+      T8_FREE (alloc_dual_faces);
+      T8_FREE (alloc_indices);
+    }
+  }
+}
+
+void
+t8_forest_iterate_all_faces (t8_forest_t forest,
+                             t8_forest_iterate_all_faces_fn callback,
+                             void *user_data, int forest_is_balanced)
+{
+  t8_forest_face_neighbor_workspace_t workspace = NULL;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         num_local_trees, itree, num_elements, ielement;
+  t8_locidx_t         offset;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (callback != NULL);
+  t8_forest_ghost_ensure (forest);
+  SC_CHECK_ABORT (forest->mpisize == 1 || forest->ghosts != NULL
+                  || t8_forest_get_local_num_elements (forest) == 0,
+                  "The face iteration needs a ghost layer.\n");
+
+  if (forest_is_balanced) {
+    workspace = t8_forest_face_neighbor_workspace_new (forest);
+  }
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    offset = t8_forest_get_tree_element_offset (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      t8_forest_iterate_element_faces (forest, itree, ts,
+                                       t8_forest_get_element_in_tree (forest,
+                                                                      itree,
+                                                                      ielement),
+                                       offset + ielement, workspace,
+                                       callback, user_data);
+    }
+  }
+  if (workspace != NULL) {
+    t8_forest_face_neighbor_workspace_destroy (&workspace);
+  }
+}
+
+/* A corner of a local element with the quantized coordinates of its
+ * position, by which the corners of the same point are grouped */
+typedef struct
+{
+  long long           key[3];   /* The quantized coordinates */
+  t8_locidx_t         element_index;    /* The local index of the element */
+  int                 corner;   /* The corner number in the element */
+  double              coordinates[3];   /* The coordinates of the corner */
+} t8_forest_iterate_corner_t;
+
+/* Order corners by their quantized coordinates and then by element */
+static bool
+t8_forest_iterate_corner_less (const t8_forest_iterate_corner_t & a,
+                               const t8_forest_iterate_corner_t & b)
+{
+  int                 i;
+
+  for (i = 0; i < 3; i++) {
+    if (a.key[i] != b.key[i]) {
+      return a.key[i] < b.key[i];
+    }
+  }
+  if (a.element_index != b.element_index) {
+    return a.element_index < b.element_index;
+  }
+  return a.corner < b.corner;
+}
+
+/* Collect the corners of all local elements and group the corners at the
+ * same position. On output corners is sorted by groups, group_offsets[g]
+ * is the first corner of group g and the groups are sorted by their first
+ * element index, which is the smallest element index in the group. */
+static void
+t8_forest_iterate_corner_groups (t8_forest_t forest,
+                                 std::vector < t8_forest_iterate_corner_t >
+                                 &corners,
+                                 std::vector < size_t > &group_offsets)
+{
+  std::vector < t8_forest_iterate_corner_t > sorted;
+  std::vector < std::pair < t8_locidx_t, size_t > >groups;
+  t8_forest_iterate_corner_t corner;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  const double       *tree_vertices;
+  t8_locidx_t         num_local_trees, itree, num_elements, ielement;
+  double              lower[3], upper[3], extent, resolution;
+  size_t              icorner, igroup, next;
+  int                 num_corners, i;
+
+  /* Compute the coordinates of all corners */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (i = 0; i < 3; i++) {
+    lower[i] = 0;
+    upper[i] = 0;
+  }
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      corner.element_index =
+        t8_forest_get_tree_element_offset (forest, itree) + ielement;
+      num_corners = ts->t8_element_num_corners (element);
+      for (corner.corner = 0; corner.corner < num_corners; corner.corner++) {
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      corner.corner, corner.coordinates);
+        for (i = 0; i < 3; i++) {
+          if (corners.empty ()) {
+            lower[i] = upper[i] = corner.coordinates[i];
+          }
+          lower[i] = SC_MIN (lower[i], corner.coordinates[i]);
+          upper[i] = SC_MAX (upper[i], corner.coordinates[i]);
+        }
+        corners.push_back (corner);
+      }
+    }
+  }
+
+  /* Quantize the coordinates relative to the extent of the local domain,
+   * such that rounding errors of the corner computation vanish */
+  for (i = 0, extent = 0; i < 3; i++) {
+    extent = SC_MAX (extent, upper[i] - lower[i]);
+  }
+  resolution = extent > 0 ? 1e-10 * extent : 1;
+  for (icorner = 0; icorner < corners.size (); icorner++) {
+    for (i = 0; i < 3; i++) {
+      corners[icorner].key[i] =
+        llround ((corners[icorner].coordinates[i] - lower[i]) / resolution);
+    }
+  }
+  std::sort (corners.begin (), corners.end (),
+             t8_forest_iterate_corner_less);
+
+  /* Find the groups and sort them by their first element */
+  for (icorner = 0; icorner < corners.size (); icorner = next) {
+    groups.push_back (std::make_pair (corners[icorner].element_index,
+                                      icorner));
+    for (next = icorner + 1; next < corners.size ()
+         && !memcmp (corners[next].key, corners[icorner].key,
+                     sizeof (corners[icorner].key)); next++) {
+    }
+  }
+  std::sort (groups.begin (), groups.end ());
+  sorted.reserve (corners.size ());
+  group_offsets.clear ();
+  for (igroup = 0; igroup < groups.size (); igroup++) {
+    group_offsets.push_back (sorted.size ());
+    icorner = groups[igroup].second;
+    do {
+      sorted.push_back (corners[icorner++]);
+    } while (icorner < corners.size ()
+             && !memcmp (corners[icorner].key, sorted.back ().key,
+                         sizeof (sorted.back ().key)));
+  }
+  group_offsets.push_back (sorted.size ());
+  corners.swap (sorted);
+}
+
+void
+t8_forest_iterate (t8_forest_t forest,
+                   t8_forest_iterate_volume_fn volume_fn,
+                   t8_forest_iterate_all_faces_fn face_fn,
+                   t8_forest_iterate_corner_fn corner_fn,
+                   t8_forest_iterate_prefetch_fn prefetch_fn,
+                   t8_locidx_t prefetch_distance, void *user_data,
+                   int forest_is_balanced)
+{
+  t8_forest_face_neighbor_workspace_t workspace = NULL;
+  t8_forest_corner_info_t corner_info;
+  std::vector < t8_forest_iterate_corner_t > corners;
+  std::vector < size_t > group_offsets;
+  std::vector < t8_locidx_t > corner_elements;
+  std::vector < int >corner_numbers;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_locidx_t         num_local_trees, itree, num_elements, ielement;
+  t8_locidx_t         num_local_elements, element_index, iprefetch;
+  size_t              igroup, icorner;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (prefetch_distance >= 0);
+  if (face_fn != NULL) {
+    t8_forest_ghost_ensure (forest);
+  }
+  SC_CHECK_ABORT (face_fn == NULL || forest->mpisize == 1
+                  || forest->ghosts != NULL
+                  || t8_forest_get_local_num_elements (forest) == 0,
+                  "The face iteration needs a ghost layer.\n");
+
+  if (face_fn != NULL && forest_is_balanced) {
+    workspace = t8_forest_face_neighbor_workspace_new (forest);
+  }
+  if (corner_fn != NULL) {
+    t8_forest_iterate_corner_groups (forest, corners, group_offsets);
+  }
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  if (prefetch_fn != NULL) {
+    /* Announce the first elements before we start */
+    for (iprefetch = 0;
+         iprefetch < SC_MIN (prefetch_distance, num_local_elements);
+         iprefetch++) {
+      prefetch_fn (forest, iprefetch, user_data);
+    }
+  }
+
+  /* Walk the elements in SFC order. For each element we call the volume
+   * callback, the face callback for its faces and the corner callback for
+   * the corners at which it is the first element. */
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  igroup = 0;
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      element_index =
+        t8_forest_get_tree_element_offset (forest, itree) + ielement;
+      if (prefetch_fn != NULL
+          && element_index + prefetch_distance < num_local_elements) {
+        prefetch_fn (forest, element_index + prefetch_distance, user_data);
+      }
+      if (volume_fn != NULL) {
+        volume_fn (forest, itree, element, element_index, user_data);
+      }
+      if (face_fn != NULL) {
+        t8_forest_iterate_element_faces (forest, itree, ts, element,
+                                         element_index, workspace, face_fn,
+                                         user_data);
+      }
+      for (; corner_fn != NULL && igroup + 1 < group_offsets.size ()
+           && corners[group_offsets[igroup]].element_index == element_index;
+           igroup++) {
+        corner_elements.clear ();
+        corner_numbers.clear ();
+        for (icorner = group_offsets[igroup];
+             icorner < group_offsets[igroup + 1]; icorner++) {
+          corner_elements.push_back (corners[icorner].element_index);
+          corner_numbers.push_back (corners[icorner].corner);
+        }
+        corner_info.num_sides = (int) corner_elements.size ();
+        corner_info.element_indices = &corner_elements[0];
+        corner_info.corners = &corner_numbers[0];
+        corner_info.coordinates = corners[group_offsets[igroup]].coordinates;
+        corner_fn (forest, &corner_info, user_data);
+      }
+    }
+  }
+  T8_ASSERT (corner_fn == NULL || igroup + 1 == group_offsets.size ());
+  if (workspace != NULL) {
+    t8_forest_face_neighbor_workspace_destroy (&workspace);
+  }
+}
+
+/* The callbacks and the state of one top-down search.
+ * The active queries of the element that is currently searched are a
+ * contiguous range at the end of active_queries. This range is a stack: the
+ * active queries of the children are appended and removed again after the
+ * children were searched. */
+struct t8_forest_search_context
+{
+  t8_forest_search_query_fn search_fn;  /* The search callback */
+  t8_forest_search_query_fn query_fn;   /* The query callback or NULL */
+  t8_forest_search_batch_query_fn batch_query_fn;       /* The batched query
+                                                           callback or NULL */
+  sc_array_t         *queries;  /* The queries or NULL */
+  std::vector < size_t > active_queries;        /* The active query indices */
+  std::vector < int > matches;  /* The results of the batched query callback */
+  /* If not NULL, the query indices and local element indices of all
+   * matches of a query with a leaf are pushed here */
+  std::vector < std::pair < size_t, t8_locidx_t > >*leaf_matches;
+};
+
+/* Call the search callback and the query callback for all active queries
+ * of an element. The active queries of element are the entries
+ * first_active, ..., active_queries.size () - 1 of the context.
+ * Returns true if the search continues with the children of element.
+ * In this case the queries that are active for the children are appended
+ * to the active queries.
  * If the callback function (search_fn) returns false for an element,
  * the query function is not called for this element.
  */
-static void
-t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
-                            t8_eclass_t eclass, t8_element_t * element,
-                            t8_eclass_scheme_c * ts,
-                            t8_element_array_t * leaf_elements,
-                            t8_locidx_t tree_lindex_of_first_leaf,
-                            t8_forest_search_query_fn search_fn,
-                            t8_forest_search_query_fn query_fn,
-                            sc_array_t * queries, sc_array_t * active_queries)
+static int
+t8_forest_search_element (t8_forest_t forest, t8_locidx_t ltreeid,
+                          const t8_element_t * element,
+                          t8_eclass_scheme_c * ts,
+                          t8_element_array_t * leaf_elements,
+                          t8_locidx_t tree_lindex_of_first_leaf,
+                          t8_forest_search_context & context,
+                          size_t first_active)
 {
-  t8_element_t       *leaf, **children;
-  int                 num_children, ichild;
-  size_t             *split_offsets, indexa, indexb;
-  t8_element_array_t  child_leafs;
+  std::vector < size_t > &active_queries = context.active_queries;
+  t8_element_t       *leaf;
   size_t              elem_count;
-  size_t              num_active;
+  size_t              num_active, end_active;
   int                 ret, query_ret, is_leaf;
   void               *current_query;
   size_t              iactive, query_index;
-  sc_array_t         *new_active_queries = NULL;
-
-  /* Assertions to check for necessary requirements */
-  /* The forest must be committed */
-  T8_ASSERT (t8_forest_is_committed (forest));
-  /* The tree must be local */
-  T8_ASSERT (0 <= ltreeid
-             && ltreeid < t8_forest_get_num_local_trees (forest));
-  /* If we have queries, we also must have a query function */
-  T8_ASSERT ((queries == NULL) == (query_fn == NULL));
 
   elem_count = t8_element_array_get_count (leaf_elements);
   if (elem_count == 0) {
     /* There are no leafs left, so we have nothing to do */
-    return;
+    return 0;
   }
-  num_active = queries == NULL ? 0 : active_queries->elem_count;
-  if (queries != NULL && num_active == 0) {
+  end_active = active_queries.size ();
+  num_active = context.queries == NULL ? 0 : end_active - first_active;
+  if (context.queries != NULL && num_active == 0) {
     /* There are no queries left. We stop the recursion */
-    return;
+    return 0;
   }
 
   is_leaf = 0;
@@ -245,63 +632,173 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
     }
   }
   /* Call the callback function for the element */
-  ret = search_fn (forest, ltreeid, element, is_leaf, leaf_elements,
-                   tree_lindex_of_first_leaf, NULL, 0);
+  ret = context.search_fn (forest, ltreeid, element, is_leaf, leaf_elements,
+                           tree_lindex_of_first_leaf, NULL, 0);
 
   if (!ret) {
     /* The function returned false. We abort the recursion */
-    return;
+    return 0;
   }
 
+  if (num_active > 0 && context.batch_query_fn != NULL) {
+    /* Evaluate all active queries with one call */
+    context.matches.resize (num_active);
+    context.batch_query_fn (forest, ltreeid, element, is_leaf,
+                            leaf_elements, tree_lindex_of_first_leaf,
+                            context.queries, &active_queries[first_active],
+                            num_active, &context.matches[0]);
+  }
   /* Check the queries.
    * If the current element is not a leaf, we store the queries that
-   * return true in order to pass them on to the children of the element. */
-
-  if (!is_leaf && num_active > 0) {
-    /* Initialize the new active query array */
-    new_active_queries = sc_array_new (sizeof (size_t));
-  }
-  /* Call the query function for all active queries */
-  for (iactive = 0; iactive < num_active; ++iactive) {
-    query_index = *(size_t *) sc_array_index (active_queries, iactive);
-    current_query = sc_array_index (queries, query_index);
-    query_ret =
-      query_fn (forest, ltreeid, element, is_leaf, leaf_elements,
-                tree_lindex_of_first_leaf, current_query, query_index);
+   * return true in order to pass them on to the children of the element.
+   * We index the active queries since pushing may move them. */
+  for (iactive = first_active; iactive < end_active && num_active > 0;
+       ++iactive) {
+    query_index = active_queries[iactive];
+    if (context.batch_query_fn != NULL) {
+      query_ret = context.matches[iactive - first_active];
+    }
+    else {
+      current_query = sc_array_index (context.queries, query_index);
+      query_ret =
+        context.query_fn (forest, ltreeid, element, is_leaf, leaf_elements,
+                          tree_lindex_of_first_leaf, current_query,
+                          query_index);
+    }
     if (!is_leaf && query_ret) {
       /* If element is not a leaf and this query returned true, we add this
        * query to the new active queries */
-      *(size_t *) sc_array_push (new_active_queries) = query_index;
+      active_queries.push_back (query_index);
+    }
+    else if (is_leaf && query_ret && context.leaf_matches != NULL) {
+      /* Record the match of the query with this leaf */
+      context.leaf_matches->push_back (std::make_pair
+                                       (query_index,
+                                        t8_forest_get_tree_element_offset
+                                        (forest, ltreeid)
+                                        + tree_lindex_of_first_leaf));
     }
   }
   if (is_leaf) {
     /* The element was a leaf. We abort the recursion. */
-    return;
+    return 0;
+  }
+  /* If no queries returned true for this element, we abort the recursion */
+  return num_active == 0 || active_queries.size () > end_active;
+}
+
+/* Return true if the search index of the forest covers the tree.
+ * It does not cover the ghost trees. */
+static int
+t8_forest_search_has_index (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  return forest->search_index != NULL
+    && ltreeid < t8_forest_get_num_local_trees (forest);
+}
+
+/* Return the offsets of the children of element in the leaf array of
+ * element. If the forest has a search index for the tree, they are read
+ * from the node of element, otherwise they are computed and stored in
+ * split_offsets. */
+static const size_t *
+t8_forest_search_split (t8_forest_t forest, t8_locidx_t ltreeid,
+                        const t8_element_t * element,
+                        t8_element_array_t * leaf_elements, size_t node,
+                        size_t *split_offsets)
+{
+  t8_forest_search_index_t index = forest->search_index;
+
+  if (t8_forest_search_has_index (forest, ltreeid)) {
+    T8_ASSERT (node < index->num_nodes);
+    return index->split_offsets + index->node_offsets[node] + node;
   }
+  t8_forest_split_array (element, leaf_elements, split_offsets);
+  return split_offsets;
+}
 
-  if (num_active > 0 && new_active_queries->elem_count == 0) {
-    /* No queries returned true for this element. We abort the recursion */
-    sc_array_destroy (new_active_queries);
+/* Return the node of a child of the element with the given node in the
+ * search index, or 0 if the forest has no search index for the tree. */
+static size_t
+t8_forest_search_child_node (t8_forest_t forest, t8_locidx_t ltreeid,
+                             size_t node, int ichild)
+{
+  t8_forest_search_index_t index = forest->search_index;
+
+  if (t8_forest_search_has_index (forest, ltreeid)) {
+    return index->child_nodes[index->node_offsets[node] + ichild];
+  }
+  return 0;
+}
+
+/* The recursion that is called from t8_forest_search_tree
+ * Input is an element and an array of all leaf elements of this element.
+ * The callback function is called on element and if it returns true,
+ * the search continues with the children of the element.
+ * Additionally a query function and a set of queries can be given.
+ * In this case the recursion stops when either the search_fn function
+ * returns false or the query_fn function returns false for all active queries.
+ * (Thus, if there are no active queries left, the recursion also stops.)
+ * A query is active for an element if the query_fn callback returned true
+ * for the parent element.
+ * The active queries of element are stored in the active queries of the
+ * context starting at first_active.
+ * The children are taken from the scratch memory of the calling thread,
+ * such that the recursion can be executed by multiple threads.
+ * If the forest has a search index, node is the node of element in it.
+ */
+static void
+t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
+                            t8_eclass_t eclass, t8_element_t * element,
+                            t8_eclass_scheme_c * ts,
+                            t8_element_array_t * leaf_elements,
+                            t8_locidx_t tree_lindex_of_first_leaf,
+                            t8_forest_search_context & context,
+                            size_t first_active, size_t node)
+{
+  t8_element_t       *children[T8_ECLASS_MAX_CHILDREN];
+  int                 num_children, ichild;
+  size_t              split_offsets[T8_ECLASS_MAX_CHILDREN + 1];
+  const size_t       *child_offsets;
+  size_t              indexa, indexb, children_active;
+  t8_element_array_t  child_leafs;
+  t8_element_scratch_mark_t scratch_mark;
+
+  /* Assertions to check for necessary requirements */
+  /* The forest must be committed */
+  T8_ASSERT (t8_forest_is_committed (forest));
+  /* The tree must be local or a ghost tree */
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest)
+             + t8_forest_get_num_ghost_trees (forest));
+  /* If we have queries, we also must have a query function */
+  T8_ASSERT ((context.queries == NULL) ==
+             (context.query_fn == NULL && context.batch_query_fn == NULL));
+
+  children_active = context.active_queries.size ();
+  if (!t8_forest_search_element (forest, ltreeid, element, ts,
+                                 leaf_elements, tree_lindex_of_first_leaf,
+                                 context, first_active)) {
+    /* The search does not continue with the children of element */
+    context.active_queries.resize (children_active);
     return;
   }
 
   /* Enter the recursion (the element is definitely not a leaf at this point) */
   /* We compute all children of E, compute their leaf arrays and
    * call search_recursion */
-  /* allocate the memory to store the children */
   num_children = ts->t8_element_num_children (element);
-  children = T8_ALLOC (t8_element_t *, num_children);
-  ts->t8_element_new (num_children, children);
-  /* Memory for the indices that split the leaf_elements array */
-  split_offsets = T8_ALLOC (size_t, num_children + 1);
+  T8_ASSERT (num_children <= T8_ECLASS_MAX_CHILDREN);
+  scratch_mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (ts, num_children, children);
   /* Compute the children */
   ts->t8_element_children (element, num_children, children);
   /* Split the leafs array in portions belonging to the children of element */
-  t8_forest_split_array (element, leaf_elements, split_offsets);
+  child_offsets = t8_forest_search_split (forest, ltreeid, element,
+                                          leaf_elements, node, split_offsets);
   for (ichild = 0; ichild < num_children; ichild++) {
     /* Check if there are any leaf elements for this child */
-    indexa = split_offsets[ichild];     /* first leaf of this child */
-    indexb = split_offsets[ichild + 1]; /* first leaf of next child */
+    indexa = child_offsets[ichild];     /* first leaf of this child */
+    indexb = child_offsets[ichild + 1]; /* first leaf of next child */
     if (indexa < indexb) {
       /* There exist leafs of this child in leaf_elements,
        * we construct an array of these leafs */
@@ -311,36 +808,26 @@ t8_forest_search_recursion (t8_forest_t forest, t8_locidx_t ltreeid,
       t8_forest_search_recursion (forest, ltreeid, eclass, children[ichild],
                                   ts, &child_leafs,
                                   indexa + tree_lindex_of_first_leaf,
-                                  search_fn, query_fn, queries,
-                                  new_active_queries);
+                                  context, children_active,
+                                  t8_forest_search_child_node (forest,
+                                                               ltreeid, node,
+                                                               ichild));
     }
   }
   /* clean-up */
-  ts->t8_element_destroy (num_children, children);
-  T8_FREE (children);
-  T8_FREE (split_offsets);
-  if (num_active > 0) {
-    sc_array_destroy (new_active_queries);
-  }
+  t8_element_scratch_release (scratch_mark);
+  context.active_queries.resize (children_active);
 }
 
-/* Perform a top-down search in one tree of the forest */
+/* Compute the nearest common ancestor of the leafs of a tree and store
+ * all queries as its active queries. */
 static void
-t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
-                       t8_forest_search_query_fn search_fn,
-                       t8_forest_search_query_fn query_fn,
-                       sc_array_t * queries)
+t8_forest_search_tree_begin (t8_element_array_t * leaf_elements,
+                             t8_eclass_scheme_c * ts, t8_element_t * nca,
+                             t8_forest_search_context & context)
 {
-  t8_eclass_t         eclass;
-  t8_eclass_scheme_c *ts;
-  t8_element_t       *nca, *first_el, *last_el;
-  t8_element_array_t *leaf_elements;
-  sc_array_t         *active_queries = NULL;
-
-  /* Get the element class, scheme and leaf elements of this tree */
-  eclass = t8_forest_get_eclass (forest, ltreeid);
-  ts = t8_forest_get_eclass_scheme (forest, eclass);
-  leaf_elements = t8_forest_tree_get_leafs (forest, ltreeid);
+  t8_element_t       *first_el, *last_el;
+  size_t              iquery;
 
   /* assert for empty tree */
   T8_ASSERT (t8_element_array_get_count (leaf_elements) >= 0);
@@ -351,41 +838,934 @@ t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
                                    t8_element_array_get_count (leaf_elements)
                                    - 1);
   /* Compute their nearest common ancestor */
-  ts->t8_element_new (1, &nca);
   ts->t8_element_nca (first_el, last_el, nca);
 
   /* If we have queries build a list of all active queries,
    * thus all queries in the array */
-  if (queries != NULL) {
-    size_t              iquery;
-    size_t              num_queries = queries->elem_count;
-    /* build an array and write 0, 1, 2, 3,... into it */
-    active_queries = sc_array_new_count (sizeof (size_t), num_queries);
-    for (iquery = 0; iquery < num_queries; ++iquery) {
-      *(size_t *) sc_array_index (active_queries, iquery) = iquery;
+  context.active_queries.clear ();
+  if (context.queries != NULL) {
+    /* write 0, 1, 2, 3,... into the array */
+    for (iquery = 0; iquery < context.queries->elem_count; ++iquery) {
+      context.active_queries.push_back (iquery);
     }
   }
+}
+
+/* Return the node of the nearest common ancestor of a tree in the search
+ * index, or 0 if the forest has no search index. */
+static size_t
+t8_forest_search_tree_node (t8_forest_t forest, t8_locidx_t ltreeid)
+{
+  if (forest->search_index != NULL) {
+    T8_ASSERT (ltreeid < forest->search_index->num_local_trees);
+    return forest->search_index->tree_first_node[ltreeid];
+  }
+  return 0;
+}
+
+/* Perform a top-down search in one tree of the forest */
+static void
+t8_forest_search_tree (t8_forest_t forest, t8_locidx_t ltreeid,
+                       t8_forest_search_context & context)
+{
+  t8_eclass_t         eclass;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *nca;
+
+  /* Get the element class and scheme of this tree */
+  eclass = t8_forest_get_eclass (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  ts->t8_element_new (1, &nca);
+  t8_forest_search_tree_begin (t8_forest_tree_get_leafs (forest, ltreeid),
+                               ts, nca, context);
 
   /* Start the top-down search */
-  t8_forest_search_recursion (forest, ltreeid, eclass, nca, ts, leaf_elements,
-                              0, search_fn, query_fn, queries,
-                              active_queries);
+  t8_forest_search_recursion (forest, ltreeid, eclass, nca, ts,
+                              t8_forest_tree_get_leafs (forest, ltreeid),
+                              0, context, 0,
+                              t8_forest_search_tree_node (forest, ltreeid));
+  ts->t8_element_destroy (1, &nca);
+}
+
+/* Perform a top-down search in one ghost tree of the forest.
+ * The callbacks get the ghost tree as local tree
+ * num_local_trees + lghost_tree. */
+static void
+t8_forest_search_ghost_tree (t8_forest_t forest, t8_locidx_t lghost_tree,
+                             t8_forest_search_context & context)
+{
+  t8_eclass_t         eclass;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *nca;
+  t8_element_array_t *leaf_elements;
 
-  /* Clean up the array of active queries */
-  if (queries != NULL) {
-    sc_array_destroy (active_queries);
+  leaf_elements = t8_forest_ghost_get_tree_elements (forest, lghost_tree);
+  if (t8_element_array_get_count (leaf_elements) == 0) {
+    /* There is nothing to search */
+    return;
   }
+  eclass = t8_forest_ghost_get_tree_class (forest, lghost_tree);
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  ts->t8_element_new (1, &nca);
+  t8_forest_search_tree_begin (leaf_elements, ts, nca, context);
+
+  /* The search index does not cover the ghost trees */
+  t8_forest_search_recursion (forest,
+                              t8_forest_get_num_local_trees (forest)
+                              + lghost_tree, eclass, nca, ts, leaf_elements,
+                              0, context, 0, 0);
+  ts->t8_element_destroy (1, &nca);
 }
 
-void
-t8_forest_search (t8_forest_t forest, t8_forest_search_query_fn search_fn,
-                  t8_forest_search_query_fn query_fn, sc_array_t * queries)
+#ifdef T8_ENABLE_OPENMP
+/* A subtree of a local tree that is searched by one thread */
+typedef struct
+{
+  t8_locidx_t         ltreeid;          /**< The local tree of the subtree */
+  t8_element_t       *element;          /**< The root element of the subtree */
+  size_t              first_leaf;       /**< The index of the first leaf of the subtree in the tree */
+  size_t              num_leafs;        /**< The number of leafs of the subtree */
+  size_t              first_active;     /**< The first active query of the subtree in the task queries */
+  size_t              num_active;       /**< The number of active queries of the subtree */
+  size_t              node;             /**< The node of the root in the search index */
+} t8_forest_search_task_t;
+
+/* Search the nearest common ancestor of each tree serially and then
+ * the subtrees of its children in parallel. */
+static void
+t8_forest_search_threaded_context (t8_forest_t forest,
+                                   t8_forest_search_context & context)
+{
+  t8_locidx_t         num_local_trees, itree, itask, num_tasks;
+  t8_eclass_scheme_c *ts;
+  t8_element_array_t *leaf_elements;
+  t8_element_t       *nca;
+  t8_forest_search_task_t *task;
+  std::vector < size_t > task_queries;
+  std::vector < size_t > &active_queries = context.active_queries;
+  size_t              split_offsets[T8_ECLASS_MAX_CHILDREN + 1];
+  const size_t       *child_offsets;
+  size_t              ichild, num_queries, nca_node;
+  int                 num_children, num_threads;
+  sc_array_t          tasks;
+
+  num_threads = t8_forest_get_num_threads (forest);
+  /* Collect the children of the nearest common ancestors as subtrees
+   * that are searched in parallel */
+  num_queries = context.queries == NULL ? 0 : context.queries->elem_count;
+  sc_array_init (&tasks, sizeof (t8_forest_search_task_t));
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_eclass (forest, itree));
+    leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+    ts->t8_element_new (1, &nca);
+    t8_forest_search_tree_begin (leaf_elements, ts, nca, context);
+    if (t8_forest_search_element (forest, itree, nca, ts, leaf_elements, 0,
+                                  context, 0)) {
+      /* The queries active for the children were appended to the queries
+       * of the nca. We store them for the tasks of this tree. */
+      num_children = ts->t8_element_num_children (nca);
+      nca_node = t8_forest_search_tree_node (forest, itree);
+      child_offsets = t8_forest_search_split (forest, itree, nca,
+                                              leaf_elements, nca_node,
+                                              split_offsets);
+      for (ichild = 0; ichild < (size_t) num_children; ichild++) {
+        if (child_offsets[ichild] < child_offsets[ichild + 1]) {
+          task = (t8_forest_search_task_t *) sc_array_push (&tasks);
+          task->ltreeid = itree;
+          ts->t8_element_new (1, &task->element);
+          ts->t8_element_child (nca, ichild, task->element);
+          task->first_leaf = child_offsets[ichild];
+          task->num_leafs = child_offsets[ichild + 1] - child_offsets[ichild];
+          task->first_active = task_queries.size ();
+          task->num_active = active_queries.size () - num_queries;
+          task->node = t8_forest_search_child_node (forest, itree,
+                                                    nca_node, ichild);
+        }
+      }
+      task_queries.insert (task_queries.end (), active_queries.begin ()
+                           + num_queries, active_queries.end ());
+    }
+    ts->t8_element_destroy (1, &nca);
+  }
+
+  /* Search the subtrees in parallel, each with its own active queries */
+  num_tasks = (t8_locidx_t) tasks.elem_count;
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (itask = 0; itask < num_tasks; itask++) {
+    const t8_forest_search_task_t *const task_s =
+      (t8_forest_search_task_t *) sc_array_index (&tasks, itask);
+    const t8_eclass_t   eclass_s =
+      t8_forest_get_eclass (forest, task_s->ltreeid);
+    t8_element_array_t  subtree_leafs;
+    t8_forest_search_context subtree_context;
+
+    subtree_context.search_fn = context.search_fn;
+    subtree_context.query_fn = context.query_fn;
+    subtree_context.batch_query_fn = context.batch_query_fn;
+    subtree_context.queries = context.queries;
+    subtree_context.leaf_matches = NULL;
+    subtree_context.active_queries.assign (task_queries.begin ()
+                                           + task_s->first_active,
+                                           task_queries.begin ()
+                                           + task_s->first_active
+                                           + task_s->num_active);
+    t8_element_array_init_view (&subtree_leafs,
+                                t8_forest_tree_get_leafs (forest,
+                                                          task_s->ltreeid),
+                                task_s->first_leaf, task_s->num_leafs);
+    t8_forest_search_recursion (forest, task_s->ltreeid, eclass_s,
+                                task_s->element,
+                                t8_forest_get_eclass_scheme (forest,
+                                                             eclass_s),
+                                &subtree_leafs, task_s->first_leaf,
+                                subtree_context, 0, task_s->node);
+  }
+
+  /* clean up */
+  for (itask = 0; itask < num_tasks; itask++) {
+    task = (t8_forest_search_task_t *) sc_array_index (&tasks, itask);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_eclass (forest,
+                                                            task->ltreeid));
+    ts->t8_element_destroy (1, &task->element);
+  }
+  sc_array_reset (&tasks);
+}
+#endif
+
+/* Search all local trees with the callbacks of the context, with multiple
+ * threads if threaded is true and OpenMP is available. */
+static void
+t8_forest_search_context_run (t8_forest_t forest,
+                              t8_forest_search_context & context,
+                              int threaded)
 {
   t8_locidx_t         num_local_trees, itree;
 
+  T8_ASSERT (t8_forest_is_committed (forest));
+  /* Recording the matches is not thread-safe */
+  T8_ASSERT (!threaded || context.leaf_matches == NULL);
+#ifdef T8_ENABLE_OPENMP
+  if (threaded) {
+    t8_forest_search_threaded_context (forest, context);
+    return;
+  }
+#endif
   num_local_trees = t8_forest_get_num_local_trees (forest);
   for (itree = 0; itree < num_local_trees; itree++) {
-    t8_forest_search_tree (forest, itree, search_fn, query_fn, queries);
+    t8_forest_search_tree (forest, itree, context);
+  }
+}
+
+void
+t8_forest_search (t8_forest_t forest, t8_forest_search_query_fn search_fn,
+                  t8_forest_search_query_fn query_fn, sc_array_t * queries)
+{
+  t8_forest_search_context context;
+
+  context.search_fn = search_fn;
+  context.query_fn = query_fn;
+  context.batch_query_fn = NULL;
+  context.queries = queries;
+  context.leaf_matches = NULL;
+  t8_forest_search_context_run (forest, context, 0);
+}
+
+void
+t8_forest_search_threaded (t8_forest_t forest,
+                           t8_forest_search_query_fn search_fn,
+                           t8_forest_search_query_fn query_fn,
+                           sc_array_t * queries)
+{
+  t8_forest_search_context context;
+
+  context.search_fn = search_fn;
+  context.query_fn = query_fn;
+  context.batch_query_fn = NULL;
+  context.queries = queries;
+  context.leaf_matches = NULL;
+  t8_forest_search_context_run (forest, context, 1);
+}
+
+void
+t8_forest_search_with_ghosts (t8_forest_t forest,
+                              t8_forest_search_query_fn search_fn,
+                              t8_forest_search_query_fn query_fn,
+                              sc_array_t * queries, int threaded)
+{
+  t8_forest_search_context context;
+  t8_locidx_t         num_ghost_trees, ighost;
+
+  context.search_fn = search_fn;
+  context.query_fn = query_fn;
+  context.batch_query_fn = NULL;
+  context.queries = queries;
+  context.leaf_matches = NULL;
+  t8_forest_search_context_run (forest, context, threaded);
+
+  /* The ghost layer is small, we search its trees serially */
+  num_ghost_trees = t8_forest_get_num_ghost_trees (forest);
+  for (ighost = 0; ighost < num_ghost_trees; ighost++) {
+    t8_forest_search_ghost_tree (forest, ighost, context);
+  }
+}
+
+void
+t8_forest_search_batched (t8_forest_t forest,
+                          t8_forest_search_query_fn search_fn,
+                          t8_forest_search_batch_query_fn batch_query_fn,
+                          sc_array_t * queries, int threaded)
+{
+  t8_forest_search_context context;
+
+  T8_ASSERT (batch_query_fn != NULL && queries != NULL);
+
+  context.search_fn = search_fn;
+  context.query_fn = NULL;
+  context.batch_query_fn = batch_query_fn;
+  context.queries = queries;
+  context.leaf_matches = NULL;
+  t8_forest_search_context_run (forest, context, threaded);
+}
+
+/* A search callback that continues the search everywhere */
+static int
+t8_forest_search_partition_continue (t8_forest_t forest, t8_locidx_t ltreeid,
+                                     const t8_element_t * element,
+                                     const int is_leaf,
+                                     t8_element_array_t * leaf_elements,
+                                     t8_locidx_t tree_leaf_index,
+                                     void *query, size_t query_index)
+{
+  return 1;
+}
+
+/* Descend from an element of a global tree whose descendants are owned by
+ * the processes pfirst, ..., plast and call partition_fn for the active
+ * queries. Each query that matches an element with a unique owner is
+ * routed to this owner by pushing the pair of owner and query index
+ * to routes. The active queries of element are the entries first_active,
+ * ..., active_queries.size () - 1 of active_queries. */
+static void
+t8_forest_search_partition_recursion (t8_forest_t forest,
+                                      t8_gloidx_t gtreeid,
+                                      t8_eclass_t eclass,
+                                      t8_eclass_scheme_c * ts,
+                                      const t8_element_t * element,
+                                      int pfirst, int plast,
+                                      t8_forest_search_partition_fn
+                                      partition_fn, sc_array_t * queries,
+                                      std::vector < size_t > &active_queries,
+                                      size_t first_active,
+                                      std::vector < std::pair < int,
+                                      size_t > >&routes)
+{
+  t8_element_t       *children[T8_ECLASS_MAX_CHILDREN];
+  t8_element_scratch_mark_t scratch_mark;
+  size_t              iactive, end_active, query_index;
+  int                 num_children, ichild, lower, upper, iproc;
+  int                 is_unique;
+
+  end_active = active_queries.size ();
+  /* If the element cannot be refined further, all of its owners are
+   * possible targets */
+  is_unique = pfirst == plast
+    || ts->t8_element_level (element) == forest->maxlevel;
+  for (iactive = first_active; iactive < end_active; ++iactive) {
+    query_index = active_queries[iactive];
+    if (partition_fn (forest, gtreeid, element, ts, pfirst, plast,
+                      sc_array_index (queries, query_index), query_index)) {
+      if (is_unique) {
+        for (iproc = pfirst; iproc <= plast; ++iproc) {
+          routes.push_back (std::make_pair (iproc, query_index));
+        }
+      }
+      else {
+        active_queries.push_back (query_index);
+      }
+    }
+  }
+  if (active_queries.size () > end_active) {
+    /* Some queries match the element, we continue with its children */
+    num_children = ts->t8_element_num_children (element);
+    scratch_mark = t8_element_scratch_mark ();
+    t8_element_scratch_new (ts, num_children, children);
+    ts->t8_element_children (element, num_children, children);
+    for (ichild = 0; ichild < num_children; ichild++) {
+      lower = pfirst;
+      upper = plast;
+      t8_forest_element_owners_bounds (forest, gtreeid, children[ichild],
+                                       eclass, &lower, &upper);
+      t8_forest_search_partition_recursion (forest, gtreeid, eclass, ts,
+                                            children[ichild], lower, upper,
+                                            partition_fn, queries,
+                                            active_queries, end_active,
+                                            routes);
+    }
+    t8_element_scratch_release (scratch_mark);
+  }
+  active_queries.resize (end_active);
+}
+
+/* Send records of record_size bytes to other processes and receive the
+ * records that the other processes send to us.
+ * The records in send_buffer are sorted by their target process and
+ * send_counts[p] records go to process p.
+ * On output recv_buffer stores the received records sorted by their source
+ * process and recv_counts[p] is the number of records from process p. */
+static void
+t8_forest_search_partition_exchange (t8_forest_t forest, size_t record_size,
+                                     std::vector < char >&send_buffer,
+                                     std::vector < int >&send_counts,
+                                     std::vector < char >&recv_buffer,
+                                     std::vector < int >&recv_counts,
+                                     int tag)
+{
+  std::vector < sc_MPI_Request > requests;
+  size_t              send_offset, recv_offset, total_recv;
+  int                 iproc, mpiret;
+
+  /* Tell each process how many records we send to it */
+  recv_counts.assign (forest->mpisize, 0);
+  mpiret = sc_MPI_Alltoall (&send_counts[0], 1, sc_MPI_INT,
+                            &recv_counts[0], 1, sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (iproc = 0, total_recv = 0; iproc < forest->mpisize; ++iproc) {
+    total_recv += recv_counts[iproc];
+  }
+  recv_buffer.resize (SC_MAX (total_recv * record_size, 1));
+  /* Reserve the requests such that they are not moved */
+  requests.reserve (2 * forest->mpisize);
+
+  /* Post the receives and sends, our own records are copied */
+  recv_offset = send_offset = 0;
+  for (iproc = 0; iproc < forest->mpisize; ++iproc) {
+    if (iproc == forest->mpirank) {
+      T8_ASSERT (send_counts[iproc] == recv_counts[iproc]);
+      memcpy (&recv_buffer[recv_offset], &send_buffer[send_offset],
+              send_counts[iproc] * record_size);
+    }
+    else {
+      if (recv_counts[iproc] > 0) {
+        requests.push_back (sc_MPI_REQUEST_NULL);
+        mpiret = sc_MPI_Irecv (&recv_buffer[recv_offset],
+                               recv_counts[iproc] * record_size,
+                               sc_MPI_BYTE, iproc, tag, forest->mpicomm,
+                               &requests.back ());
+        SC_CHECK_MPI (mpiret);
+      }
+      if (send_counts[iproc] > 0) {
+        requests.push_back (sc_MPI_REQUEST_NULL);
+        mpiret = sc_MPI_Isend (&send_buffer[send_offset],
+                               send_counts[iproc] * record_size,
+                               sc_MPI_BYTE, iproc, tag, forest->mpicomm,
+                               &requests.back ());
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    recv_offset += recv_counts[iproc] * record_size;
+    send_offset += send_counts[iproc] * record_size;
+  }
+  if (!requests.empty ()) {
+    mpiret = sc_MPI_Waitall ((int) requests.size (), &requests[0],
+                             sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+
+/* A match of a query as it is sent back to the process of the query */
+typedef struct
+{
+  size_t              query_index;      /* The index of the query on its process */
+  t8_gloidx_t         element_id;       /* The global index of the leaf */
+} t8_forest_search_partition_match_t;
+
+/* Compare two results by query index, owner and element id */
+static int
+t8_forest_search_partition_result_compare (const void *pa, const void *pb)
+{
+  const t8_forest_search_partition_result_t *A =
+    (const t8_forest_search_partition_result_t *) pa;
+  const t8_forest_search_partition_result_t *B =
+    (const t8_forest_search_partition_result_t *) pb;
+
+  if (A->query_index != B->query_index) {
+    return A->query_index < B->query_index ? -1 : 1;
+  }
+  if (A->owner != B->owner) {
+    return A->owner < B->owner ? -1 : 1;
+  }
+  return (A->element_id > B->element_id) - (A->element_id < B->element_id);
+}
+
+void
+t8_forest_search_partition (t8_forest_t forest,
+                            t8_forest_search_partition_fn partition_fn,
+                            t8_forest_search_query_fn query_fn,
+                            sc_array_t * queries, sc_array_t * results)
+{
+  t8_cmesh_t          cmesh;
+  t8_eclass_t         eclass;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *root;
+  t8_gloidx_t         gtreeid, first_element;
+  t8_forest_search_context context;
+  t8_forest_search_partition_match_t match;
+  t8_forest_search_partition_result_t *result;
+  std::vector < size_t > active_queries;
+  std::vector < std::pair < int, size_t > >routes;
+  std::vector < std::pair < size_t, t8_locidx_t > >leaf_matches;
+  std::vector < char >send_buffer, recv_buffer;
+  std::vector < int >send_counts, recv_counts, query_origins;
+  std::vector < size_t > query_origin_indices;
+  sc_array_t          recv_queries;
+  size_t              record_size, iroute, iquery, num_recv, imatch;
+  size_t              offset;
+  int                 lower, upper, iproc, irecv;
+  int                 create_tree_array = 0, create_gfirst_desc_array = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (queries != NULL && results != NULL);
+  T8_ASSERT (results->elem_size ==
+             sizeof (t8_forest_search_partition_result_t));
+  cmesh = t8_forest_get_cmesh (forest);
+  SC_CHECK_ABORT (!t8_cmesh_is_partitioned (cmesh),
+                  "The partition search needs a replicated cmesh.\n");
+
+  /* The owner search needs the partition arrays */
+  if (forest->tree_offsets == NULL) {
+    create_tree_array = 1;
+    t8_forest_partition_create_tree_offsets (forest);
+  }
+  if (forest->global_first_desc == NULL) {
+    create_gfirst_desc_array = 1;
+    t8_forest_partition_create_first_desc (forest);
+  }
+
+  /* Route our queries through the global trees to the owner processes */
+  if (t8_forest_get_global_num_elements (forest) > 0) {
+    for (gtreeid = 0; gtreeid < forest->global_num_trees; ++gtreeid) {
+      eclass = t8_cmesh_get_tree_class (cmesh, (t8_locidx_t) gtreeid);
+      ts = t8_forest_get_eclass_scheme (forest, eclass);
+      ts->t8_element_new (1, &root);
+      ts->t8_element_set_linear_id (root, 0, 0);
+      lower = 0;
+      upper = forest->mpisize - 1;
+      t8_forest_element_owners_bounds (forest, gtreeid, root, eclass,
+                                       &lower, &upper);
+      active_queries.clear ();
+      for (iquery = 0; iquery < queries->elem_count; ++iquery) {
+        active_queries.push_back (iquery);
+      }
+      t8_forest_search_partition_recursion (forest, gtreeid, eclass, ts,
+                                            root, lower, upper,
+                                            partition_fn, queries,
+                                            active_queries, 0, routes);
+      ts->t8_element_destroy (1, &root);
+    }
+  }
+  /* A query may match multiple elements of the same process */
+  std::sort (routes.begin (), routes.end ());
+  routes.erase (std::unique (routes.begin (), routes.end ()), routes.end ());
+
+  /* Send each query with its index to the processes that it is routed to */
+  record_size = sizeof (size_t) + queries->elem_size;
+  send_counts.assign (forest->mpisize, 0);
+  send_buffer.resize (SC_MAX (routes.size () * record_size, 1));
+  for (iroute = 0; iroute < routes.size (); ++iroute) {
+    send_counts[routes[iroute].first]++;
+    memcpy (&send_buffer[iroute * record_size], &routes[iroute].second,
+            sizeof (size_t));
+    memcpy (&send_buffer[iroute * record_size + sizeof (size_t)],
+            sc_array_index (queries, routes[iroute].second),
+            queries->elem_size);
+  }
+  t8_forest_search_partition_exchange (forest, record_size, send_buffer,
+                                       send_counts, recv_buffer,
+                                       recv_counts,
+                                       T8_MPI_SEARCH_PARTITION_QUERY);
+
+  /* Unpack the received queries and remember where they come from */
+  for (iproc = 0, num_recv = 0; iproc < forest->mpisize; ++iproc) {
+    num_recv += recv_counts[iproc];
+  }
+  sc_array_init_size (&recv_queries, queries->elem_size, num_recv);
+  query_origins.resize (num_recv);
+  query_origin_indices.resize (num_recv);
+  for (iproc = 0, iquery = 0; iproc < forest->mpisize; ++iproc) {
+    for (irecv = 0; irecv < recv_counts[iproc]; ++irecv, ++iquery) {
+      query_origins[iquery] = iproc;
+      memcpy (&query_origin_indices[iquery],
+              &recv_buffer[iquery * record_size], sizeof (size_t));
+      memcpy (sc_array_index (&recv_queries, iquery),
+              &recv_buffer[iquery * record_size + sizeof (size_t)],
+              queries->elem_size);
+    }
+  }
+
+  /* Search the received queries in our local trees */
+  context.search_fn = t8_forest_search_partition_continue;
+  context.query_fn = query_fn;
+  context.batch_query_fn = NULL;
+  context.queries = &recv_queries;
+  context.leaf_matches = &leaf_matches;
+  if (num_recv > 0) {
+    t8_forest_search_context_run (forest, context, 0);
+  }
+  /* The received queries are sorted by their process, thus sorting the
+   * matches by the query sorts them by the process, too */
+  std::sort (leaf_matches.begin (), leaf_matches.end ());
+
+  /* Send the matches back to the processes of the queries */
+  first_element = t8_forest_get_first_local_element_id (forest);
+  record_size = sizeof (t8_forest_search_partition_match_t);
+  send_counts.assign (forest->mpisize, 0);
+  send_buffer.resize (SC_MAX (leaf_matches.size () * record_size, 1));
+  for (imatch = 0; imatch < leaf_matches.size (); ++imatch) {
+    iquery = leaf_matches[imatch].first;
+    send_counts[query_origins[iquery]]++;
+    match.query_index = query_origin_indices[iquery];
+    match.element_id = first_element + leaf_matches[imatch].second;
+    memcpy (&send_buffer[imatch * record_size], &match, record_size);
+  }
+  t8_forest_search_partition_exchange (forest, record_size, send_buffer,
+                                       send_counts, recv_buffer,
+                                       recv_counts,
+                                       T8_MPI_SEARCH_PARTITION_RESULT);
+
+  /* Store the results of our queries */
+  offset = 0;
+  for (iproc = 0; iproc < forest->mpisize; ++iproc) {
+    for (irecv = 0; irecv < recv_counts[iproc]; ++irecv) {
+      memcpy (&match, &recv_buffer[offset], record_size);
+      offset += record_size;
+      result = (t8_forest_search_partition_result_t *) sc_array_push (results);
+      result->query_index = match.query_index;
+      result->owner = iproc;
+      result->element_id = match.element_id;
+    }
+  }
+  qsort (results->array, results->elem_count, results->elem_size,
+         t8_forest_search_partition_result_compare);
+
+  sc_array_reset (&recv_queries);
+  if (create_tree_array) {
+    t8_shmem_array_destroy (&forest->tree_offsets);
+  }
+  if (create_gfirst_desc_array) {
+    t8_shmem_array_destroy (&forest->global_first_desc);
+  }
+}
+
+/* The barycentric coordinates of the point p with respect to the simplex
+ * of dim + 1 vertices v, returns the smallest of them. */
+static double
+t8_forest_sort_points_simplex (const double v[][3], const double p[3],
+                               int dim)
+{
+  double              a[3], b[3], c[3], r[3], det, l1, l2, l3;
+  int                 i;
+
+  for (i = 0; i < 3; i++) {
+    a[i] = v[1][i] - v[0][i];
+    b[i] = v[2][i] - v[0][i];
+    c[i] = dim == 3 ? v[3][i] - v[0][i] : 0;
+    r[i] = p[i] - v[0][i];
+  }
+  if (dim == 2) {
+    det = a[0] * b[1] - a[1] * b[0];
+    l1 = (r[0] * b[1] - r[1] * b[0]) / det;
+    l2 = (a[0] * r[1] - a[1] * r[0]) / det;
+    return SC_MIN (1 - l1 - l2, SC_MIN (l1, l2));
+  }
+  T8_ASSERT (dim == 3);
+  det = a[0] * (b[1] * c[2] - b[2] * c[1])
+    - a[1] * (b[0] * c[2] - b[2] * c[0]) + a[2] * (b[0] * c[1] - b[1] * c[0]);
+  l1 = (r[0] * (b[1] * c[2] - b[2] * c[1])
+        - r[1] * (b[0] * c[2] - b[2] * c[0])
+        + r[2] * (b[0] * c[1] - b[1] * c[0])) / det;
+  l2 = (a[0] * (r[1] * c[2] - r[2] * c[1])
+        - a[1] * (r[0] * c[2] - r[2] * c[0])
+        + a[2] * (r[0] * c[1] - r[1] * c[0])) / det;
+  l3 = (a[0] * (b[1] * r[2] - b[2] * r[1])
+        - a[1] * (b[0] * r[2] - b[2] * r[0])
+        + a[2] * (b[0] * r[1] - b[1] * r[0])) / det;
+  return SC_MIN (SC_MIN (1 - l1 - l2 - l3, l1), SC_MIN (l2, l3));
+}
+
+/* Measure how deep the point p, given in the integer reference coordinates
+ * of the scheme, lies inside an element. The result is non-negative if p
+ * is inside the element and the larger, the farther p is from the element
+ * boundary relative to the element size. */
+static double
+t8_forest_sort_points_measure (t8_eclass_scheme_c *ts,
+                               const t8_element_t *element,
+                               const double p[3])
+{
+  double              v[T8_ECLASS_MAX_CORNERS][3], tet[4][3], measure;
+  int                 coords[3], num_corners, icorner, i, dim;
+  const int           pyra_tets[2][4] = { {0, 1, 3, 4}, {0, 2, 3, 4} };
+  t8_element_shape_t  shape;
+
+  shape = ts->t8_element_shape (element);
+  num_corners = ts->t8_element_num_corners (element);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    coords[0] = coords[1] = coords[2] = 0;
+    ts->t8_element_vertex_coords (element, icorner, coords);
+    for (i = 0; i < 3; i++) {
+      v[icorner][i] = coords[i];
+    }
+  }
+  dim = t8_eclass_to_dimension[shape];
+  switch (shape) {
+  case T8_ECLASS_VERTEX:
+    return 0;
+  case T8_ECLASS_LINE:
+  case T8_ECLASS_QUAD:
+  case T8_ECLASS_HEX:
+    /* The element is an axis-aligned box from its first to its last corner */
+    measure = 1;
+    for (i = 0; i < dim; i++) {
+      measure = SC_MIN (measure, SC_MIN (p[i] - v[0][i],
+                                         v[num_corners - 1][i] - p[i])
+                        / (v[num_corners - 1][i] - v[0][i]));
+    }
+    return measure;
+  case T8_ECLASS_TRIANGLE:
+  case T8_ECLASS_TET:
+    return t8_forest_sort_points_simplex (v, p, dim);
+  case T8_ECLASS_PRISM:
+    /* A triangle in the x-y plane times a line in z direction */
+    measure = t8_forest_sort_points_simplex (v, p, 2);
+    return SC_MIN (measure, SC_MIN (p[2] - v[0][2], v[3][2] - p[2])
+                   / (v[3][2] - v[0][2]));
+  case T8_ECLASS_PYRAMID:
+    /* The pyramid is the union of two tetrahedra */
+    measure = -1e300;
+    for (icorner = 0; icorner < 2; icorner++) {
+      for (i = 0; i < 4; i++) {
+        memcpy (tet[i], v[pyra_tets[icorner][i]], sizeof (tet[i]));
+      }
+      measure = SC_MAX (measure, t8_forest_sort_points_simplex (tet, p, 3));
+    }
+    return measure;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  return 0;
+}
+
+/* Compute the linear id at level maxlevel of the element of a tree that
+ * contains a point given in reference coordinates. We descend from the root
+ * and pick the child that contains the point best. */
+static              t8_linearidx_t
+t8_forest_sort_points_key (t8_eclass_scheme_c *ts, const double ref[3],
+                           int maxlevel)
+{
+  t8_element_t       *element, *children[T8_ECLASS_MAX_CHILDREN];
+  double              p[3], measure, best_measure;
+  int                 level, num_children, ichild, best_child, i;
+  t8_linearidx_t      key;
+
+  ts->t8_element_new (1, &element);
+  ts->t8_element_new (T8_ECLASS_MAX_CHILDREN, children);
+  ts->t8_element_set_linear_id (element, 0, 0);
+  for (i = 0; i < 3; i++) {
+    p[i] = ref[i] * ts->t8_element_root_len (element);
+  }
+  for (level = 0; level < maxlevel; level++) {
+    num_children = ts->t8_element_num_children (element);
+    ts->t8_element_children (element, num_children, children);
+    best_child = 0;
+    best_measure = -1e300;
+    for (ichild = 0; ichild < num_children; ichild++) {
+      measure = t8_forest_sort_points_measure (ts, children[ichild], p);
+      if (measure > best_measure) {
+        best_measure = measure;
+        best_child = ichild;
+      }
+      if (measure >= 0) {
+        /* The point is inside this child */
+        break;
+      }
+    }
+    ts->t8_element_copy (children[best_child], element);
+  }
+  key = ts->t8_element_get_linear_id (element, maxlevel);
+  ts->t8_element_destroy (T8_ECLASS_MAX_CHILDREN, children);
+  ts->t8_element_destroy (1, &element);
+  return key;
+}
+
+/* Order two points of the same buffer by tree and key and points with
+ * equal key by their position in the buffer */
+static bool
+t8_forest_point_less (const char *a, const char *b)
+{
+  const t8_forest_point_t *A = (const t8_forest_point_t *) a;
+  const t8_forest_point_t *B = (const t8_forest_point_t *) b;
+
+  if (A->gtreeid != B->gtreeid) {
+    return A->gtreeid < B->gtreeid;
+  }
+  if (A->key != B->key) {
+    return A->key < B->key;
+  }
+  return a < b;
+}
+
+/* Sort the entries of a buffer of points of size record_size by tree and
+ * key into an sc_array. For equal keys the order in the buffer is kept. */
+static void
+t8_forest_sort_points_buffer (const char *buffer, size_t num_points,
+                              size_t record_size, sc_array_t * points)
+{
+  std::vector < const char *>order (num_points);
+  size_t              ipoint;
+
+  for (ipoint = 0; ipoint < num_points; ++ipoint) {
+    order[ipoint] = buffer + ipoint * record_size;
+  }
+  std::sort (order.begin (), order.end (), t8_forest_point_less);
+  sc_array_resize (points, num_points);
+  for (ipoint = 0; ipoint < num_points; ++ipoint) {
+    memcpy (sc_array_index (points, ipoint), order[ipoint], record_size);
+  }
+}
+
+void
+t8_forest_sort_points (t8_forest_t forest, sc_array_t * points)
+{
+  t8_cmesh_t          cmesh;
+  t8_eclass_t         eclass;
+  t8_eclass_scheme_c *ts;
+  t8_forest_point_t  *point;
+  t8_gloidx_t         first_tree;
+  t8_locidx_t         ltreeid, num_tree_elements, ielement, offset;
+  std::vector < char >send_buffer, recv_buffer;
+  std::vector < int >send_counts, recv_counts, owners;
+  std::vector < t8_linearidx_t > ids;
+  size_t              record_size, ipoint, jpoint, num_points, num_recv;
+  int                 iproc;
+  int                 create_tree_array = 0, create_gfirst_desc_array = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (points != NULL);
+  T8_ASSERT (points->elem_size >= sizeof (t8_forest_point_t));
+  cmesh = t8_forest_get_cmesh (forest);
+  SC_CHECK_ABORT (!t8_cmesh_is_partitioned (cmesh),
+                  "Sorting points needs a replicated cmesh.\n");
+  SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest) > 0,
+                  "Cannot sort points onto an empty forest.\n");
+
+  /* The owner search needs the partition arrays */
+  if (forest->tree_offsets == NULL) {
+    create_tree_array = 1;
+    t8_forest_partition_create_tree_offsets (forest);
+  }
+  if (forest->global_first_desc == NULL) {
+    create_gfirst_desc_array = 1;
+    t8_forest_partition_create_first_desc (forest);
+  }
+
+  /* Compute the keys of our points and sort them along the curve */
+  record_size = points->elem_size;
+  num_points = points->elem_count;
+  for (ipoint = 0; ipoint < num_points; ++ipoint) {
+    point = (t8_forest_point_t *) sc_array_index (points, ipoint);
+    T8_ASSERT (0 <= point->gtreeid
+               && point->gtreeid < forest->global_num_trees);
+    eclass = t8_cmesh_get_tree_class (cmesh, (t8_locidx_t) point->gtreeid);
+    ts = t8_forest_get_eclass_scheme (forest, eclass);
+    point->key = t8_forest_sort_points_key (ts, point->ref_coords,
+                                            forest->maxlevel);
+    point->lelement_id = -1;
+  }
+  send_buffer.resize (SC_MAX (num_points * record_size, 1));
+  if (num_points > 0) {
+    memcpy (&send_buffer[0], points->array, num_points * record_size);
+  }
+  t8_forest_sort_points_buffer (&send_buffer[0], num_points, record_size,
+                                points);
+
+  /* Find the owners of the points tree by tree. Since the partition follows
+   * the curve, the points are now sorted by their owners. */
+  send_counts.assign (forest->mpisize, 0);
+  owners.resize (num_points);
+  ids.resize (num_points);
+  for (ipoint = 0; ipoint < num_points; ipoint = jpoint) {
+    point = (t8_forest_point_t *) sc_array_index (points, ipoint);
+    for (jpoint = ipoint; jpoint < num_points; ++jpoint) {
+      const t8_forest_point_t *next =
+        (const t8_forest_point_t *) sc_array_index (points, jpoint);
+      if (next->gtreeid != point->gtreeid) {
+        break;
+      }
+      ids[jpoint] = next->key;
+    }
+    t8_forest_element_find_owners_sorted_ids (forest, point->gtreeid,
+                                              &ids[ipoint],
+                                              (t8_locidx_t) (jpoint -
+                                                             ipoint),
+                                              &owners[ipoint]);
+  }
+  for (ipoint = 0; ipoint < num_points; ++ipoint) {
+    T8_ASSERT (ipoint == 0 || owners[ipoint - 1] <= owners[ipoint]);
+    send_counts[owners[ipoint]]++;
+  }
+  if (num_points > 0) {
+    memcpy (&send_buffer[0], points->array, num_points * record_size);
+  }
+  t8_forest_search_partition_exchange (forest, record_size, send_buffer,
+                                       send_counts, recv_buffer,
+                                       recv_counts, T8_MPI_SORT_POINTS);
+
+  /* The points of each process are sorted, we sort them all */
+  for (iproc = 0, num_recv = 0; iproc < forest->mpisize; ++iproc) {
+    num_recv += recv_counts[iproc];
+  }
+  t8_forest_sort_points_buffer (&recv_buffer[0], num_recv, record_size,
+                                points);
+
+  /* Find the leaf of each point. The leaf of a point is the last leaf of
+   * its tree whose first descendant is not behind the point. */
+  first_tree = t8_forest_get_first_local_tree_id (forest);
+  for (ipoint = 0; ipoint < num_recv; ipoint = jpoint) {
+    point = (t8_forest_point_t *) sc_array_index (points, ipoint);
+    ltreeid = (t8_locidx_t) (point->gtreeid - first_tree);
+    T8_ASSERT (0 <= ltreeid
+               && ltreeid < t8_forest_get_num_local_trees (forest));
+    eclass = t8_forest_get_tree_class (forest, ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest, eclass);
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+    offset = t8_forest_get_tree_element_offset (forest, ltreeid);
+    ids.resize (num_tree_elements);
+    ts->t8_element_batch_get_linear_id (t8_forest_get_element_in_tree
+                                        (forest, ltreeid, 0),
+                                        num_tree_elements, forest->maxlevel,
+                                        &ids[0]);
+    ielement = 0;
+    for (jpoint = ipoint; jpoint < num_recv; ++jpoint) {
+      point = (t8_forest_point_t *) sc_array_index (points, jpoint);
+      if (point->gtreeid != first_tree + ltreeid) {
+        break;
+      }
+      while (ielement + 1 < num_tree_elements
+             && ids[ielement + 1] <= point->key) {
+        ielement++;
+      }
+      T8_ASSERT (ids[ielement] <= point->key);
+      point->lelement_id = offset + ielement;
+    }
+  }
+
+  if (create_tree_array) {
+    t8_shmem_array_destroy (&forest->tree_offsets);
+  }
+  if (create_gfirst_desc_array) {
+    t8_shmem_array_destroy (&forest->global_first_desc);
   }
 }
 
@@ -468,4 +1848,108 @@ t8_forest_iterate_replace (t8_forest_t forest_new,
   t8_global_productionf ("Done t8_forest_iterate_replace\n");
 }
 
+void
+t8_forest_iterate_replace_runs (t8_forest_t forest_new,
+                                t8_forest_t forest_old,
+                                t8_forest_replace_t replace_fn,
+                                sc_array_t * data_new,
+                                const sc_array_t * data_old)
+{
+  t8_locidx_t         ielem_new, ielem_old, elems_per_tree_old,
+    elems_per_tree_new;
+  t8_locidx_t         itree, num_local_trees;
+  t8_locidx_t         offset_new, offset_old;
+  t8_locidx_t         run_new, run_old, run_length;
+  t8_locidx_t         family_size;
+  t8_element_t       *elem_new, *elem_old;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         eclass;
+  int                 level_new, level_old;
+
+  t8_global_productionf ("Into t8_forest_iterate_replace_runs\n");
+  T8_ASSERT (t8_forest_is_committed (forest_old));
+  T8_ASSERT (t8_forest_is_committed (forest_new));
+  T8_ASSERT (replace_fn != NULL);
+  T8_ASSERT ((data_new == NULL) == (data_old == NULL));
+  T8_ASSERT (data_new == NULL || data_new->elem_size == data_old->elem_size);
+  T8_ASSERT (data_new == NULL || data_new->elem_count >=
+             (size_t) t8_forest_get_local_num_elements (forest_new));
+  T8_ASSERT (data_old == NULL || data_old->elem_count >=
+             (size_t) t8_forest_get_local_num_elements (forest_old));
+
+  num_local_trees = t8_forest_get_num_local_trees (forest_new);
+  T8_ASSERT (num_local_trees == t8_forest_get_num_local_trees (forest_old));
+
+  for (itree = 0; itree < num_local_trees; itree++) {
+    elems_per_tree_new = t8_forest_get_tree_num_elements (forest_new, itree);
+    elems_per_tree_old = t8_forest_get_tree_num_elements (forest_old, itree);
+    offset_new = t8_forest_get_tree_element_offset (forest_new, itree);
+    offset_old = t8_forest_get_tree_element_offset (forest_old, itree);
+    eclass = t8_forest_get_tree_class (forest_new, itree);
+    T8_ASSERT (eclass == t8_forest_get_tree_class (forest_old, itree));
+    ts = t8_forest_get_eclass_scheme (forest_new, eclass);
+    ielem_new = ielem_old = 0;
+    while (ielem_new < elems_per_tree_new && ielem_old < elems_per_tree_old) {
+      elem_new = t8_forest_get_element_in_tree (forest_new, itree, ielem_new);
+      elem_old = t8_forest_get_element_in_tree (forest_old, itree, ielem_old);
+      level_new = ts->t8_element_level (elem_new);
+      level_old = ts->t8_element_level (elem_old);
+      if (level_old < level_new) {
+        T8_ASSERT (level_new == level_old + 1);
+        /* elem_old was refined */
+        family_size = ts->t8_element_num_children (elem_old);
+        replace_fn (forest_old, forest_new, itree, ts, 1, ielem_old,
+                    family_size, ielem_new);
+        ielem_new += family_size;
+        ielem_old++;
+      }
+      else if (level_old > level_new) {
+        T8_ASSERT (level_new == level_old - 1);
+        /* elem_old was coarsened */
+        family_size = ts->t8_element_num_children (elem_new);
+        replace_fn (forest_old, forest_new, itree, ts, family_size, ielem_old,
+                    1, ielem_new);
+        ielem_new++;
+        ielem_old += family_size;
+      }
+      else {
+        /* Find the run of unchanged elements. Since the forests only differ
+         * by refined elements and coarsened families, elements of the same
+         * level at matching positions are equal. */
+        run_new = ielem_new;
+        run_old = ielem_old;
+        do {
+          T8_ASSERT (!ts->t8_element_compare (t8_forest_get_element_in_tree
+                                              (forest_new, itree, ielem_new),
+                                              t8_forest_get_element_in_tree
+                                              (forest_old, itree,
+                                               ielem_old)));
+          ielem_new++;
+          ielem_old++;
+        } while (ielem_new < elems_per_tree_new
+                 && ielem_old < elems_per_tree_old
+                 && ts->t8_element_level (t8_forest_get_element_in_tree
+                                          (forest_new, itree, ielem_new))
+                 == ts->t8_element_level (t8_forest_get_element_in_tree
+                                          (forest_old, itree, ielem_old)));
+        run_length = ielem_new - run_new;
+        if (data_new != NULL) {
+          /* Copy the data of the whole run */
+          memcpy (t8_sc_array_index_locidx (data_new, offset_new + run_new),
+                  t8_sc_array_index_locidx ((sc_array_t *) data_old,
+                                            offset_old + run_old),
+                  run_length * data_new->elem_size);
+        }
+        else {
+          replace_fn (forest_old, forest_new, itree, ts, run_length, run_old,
+                      run_length, run_new);
+        }
+      }
+    }                           /* element loop */
+    T8_ASSERT (ielem_new == elems_per_tree_new);
+    T8_ASSERT (ielem_old == elems_per_tree_old);
+  }                             /* tree loop */
+  t8_global_productionf ("Done t8_forest_iterate_replace_runs\n");
+}
+
 T8_EXTERN_C_END ();
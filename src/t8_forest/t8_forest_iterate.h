@@ -69,6 +69,156 @@ typedef int         (*t8_forest_search_query_fn) (t8_forest_t forest,
                                                   void *query,
                                                   size_t query_index);
 
+/** A query callback that evaluates multiple queries for one element.
+ * forest, ltreeid, element, is_leaf, leaf_elements and tree_leaf_index are
+ * as in \ref t8_forest_search_query_fn.
+ * queries         the array of all queries passed to \ref t8_forest_search_batched
+ * query_indices   the indices in \a queries of the queries that are active
+ *                 for \a element, in ascending order
+ * num_active      the number of entries in \a query_indices
+ * matches         on output, for each active query true if and only if
+ *                 \a element 'matches' the query
+ */
+typedef void        (*t8_forest_search_batch_query_fn) (t8_forest_t forest,
+                                                        t8_locidx_t ltreeid,
+                                                        const t8_element_t *
+                                                        element,
+                                                        const int is_leaf,
+                                                        t8_element_array_t *
+                                                        leaf_elements,
+                                                        t8_locidx_t
+                                                        tree_leaf_index,
+                                                        sc_array_t * queries,
+                                                        const size_t *
+                                                        query_indices,
+                                                        size_t num_active,
+                                                        int *matches);
+
+/** A callback that decides whether a query is routed to the owners of an
+ * element in a partition search. The element is not necessarily local
+ * and may be owned by multiple processes.
+ * forest          the forest
+ * gtreeid         the global id of the tree of \a element
+ * element         the element
+ * ts              the eclass scheme of \a element
+ * pfirst, plast   the first and last process that own descendants of \a element
+ * query           the query
+ * query_index     the index of \a query in the array of queries
+ * returns         true if \a query may match a leaf below \a element.
+ */
+typedef int         (*t8_forest_search_partition_fn) (t8_forest_t forest,
+                                                      t8_gloidx_t gtreeid,
+                                                      const t8_element_t *
+                                                      element,
+                                                      t8_eclass_scheme_c *
+                                                      ts, int pfirst,
+                                                      int plast, void *query,
+                                                      size_t query_index);
+
+/** A match of a query with a leaf in a partition search */
+typedef struct
+{
+  size_t              query_index;      /**< The index of the query */
+  int                 owner;            /**< The process owning the leaf */
+  t8_gloidx_t         element_id;       /**< The global index of the leaf */
+} t8_forest_search_partition_result_t;
+
+/** A point that is sorted onto the partition of a forest with
+ * \ref t8_forest_sort_points.
+ * The entries of the point array start with this struct and may store
+ * arbitrary data without pointers behind it, which is sent along.
+ */
+typedef struct
+{
+  t8_gloidx_t         gtreeid;          /**< The global id of the tree of the point */
+  double              ref_coords[3];    /**< The reference coordinates of the point in its tree */
+  t8_linearidx_t      key;              /**< On output the linear id of the maximum level element
+                                             that contains the point */
+  t8_locidx_t         lelement_id;      /**< On output the local index of the leaf that contains the point */
+} t8_forest_point_t;
+
+/** The data of a face that is passed to the callback of
+ * \ref t8_forest_iterate_all_faces.
+ * The face is seen from a local element. Its neighbors are the leaves on the
+ * other side of the face, which are either a single leaf of the same or a
+ * coarser level, or the leaves at the face of a hanging face.
+ */
+typedef struct
+{
+  t8_locidx_t         ltreeid;          /**< The local tree of \a element */
+  t8_locidx_t         element_index;    /**< The local index of \a element in the forest */
+  const t8_element_t *element;          /**< The local element */
+  int                 face;             /**< The face of \a element */
+  int                 num_neighbors;    /**< The number of neighbor leaves, 0 on the domain boundary */
+  t8_element_t      **neighbors;        /**< The neighbor leaves */
+  const int          *dual_faces;       /**< For each neighbor its face at this face */
+  const t8_locidx_t  *neighbor_indices; /**< For each neighbor its local index, or the number of local
+                                             elements plus its ghost index if it is a ghost */
+  t8_eclass_scheme_c *neighbor_scheme;  /**< The eclass scheme of the neighbors */
+  int                 is_hanging;       /**< True if the neighbors have a different level than \a element */
+  int                 orientation;      /**< The orientation of the face, \see t8_forest_leaf_face_orientation */
+} t8_forest_face_info_t;
+
+/** The callback of \ref t8_forest_iterate_all_faces.
+ * forest          the forest
+ * info            the data of the face
+ * user_data       the user data passed to \ref t8_forest_iterate_all_faces
+ */
+typedef void        (*t8_forest_iterate_all_faces_fn) (t8_forest_t forest,
+                                                       const
+                                                       t8_forest_face_info_t *
+                                                       info,
+                                                       void *user_data);
+
+/** The data of a corner that is passed to the corner callback of
+ * \ref t8_forest_iterate.
+ * The corners of the local elements at the same position form one corner.
+ */
+typedef struct
+{
+  int                 num_sides;        /**< The number of local elements at the corner */
+  const t8_locidx_t  *element_indices;  /**< The local indices of the elements, in ascending order */
+  const int          *corners;          /**< For each element its corner number at the corner */
+  const double       *coordinates;      /**< The coordinates of the corner */
+} t8_forest_corner_info_t;
+
+/** The volume callback of \ref t8_forest_iterate.
+ * forest          the forest
+ * ltreeid         the local tree of \a element
+ * element         a local element
+ * element_index   the local index of \a element in the forest
+ * user_data       the user data passed to \ref t8_forest_iterate
+ */
+typedef void        (*t8_forest_iterate_volume_fn) (t8_forest_t forest,
+                                                    t8_locidx_t ltreeid,
+                                                    const t8_element_t *
+                                                    element,
+                                                    t8_locidx_t element_index,
+                                                    void *user_data);
+
+/** The corner callback of \ref t8_forest_iterate.
+ * forest          the forest
+ * info            the data of the corner
+ * user_data       the user data passed to \ref t8_forest_iterate
+ */
+typedef void        (*t8_forest_iterate_corner_fn) (t8_forest_t forest,
+                                                    const
+                                                    t8_forest_corner_info_t *
+                                                    info, void *user_data);
+
+/** The prefetch callback of \ref t8_forest_iterate.
+ * It announces that the callbacks will soon be called for an element, such
+ * that the application can prefetch the data of this element, for example
+ * with __builtin_prefetch.
+ * forest          the forest
+ * element_index   the local index of the element
+ * user_data       the user data passed to \ref t8_forest_iterate
+ */
+typedef void        (*t8_forest_iterate_prefetch_fn) (t8_forest_t forest,
+                                                      t8_locidx_t
+                                                      element_index,
+                                                      void *user_data);
+
 T8_EXTERN_C_BEGIN ();
 
 /* TODO: Document */
@@ -106,6 +256,189 @@ void                t8_forest_search (t8_forest_t forest,
                                       t8_forest_search_query_fn query_fn,
                                       sc_array_t * queries);
 
+/** Perform the same search as \ref t8_forest_search with multiple threads.
+ * For each local tree, \a search_fn and \a query_fn are called for the
+ * nearest common ancestor of its leafs. The subtrees of the children of
+ * these ancestors are then searched in parallel.
+ * The callbacks must thus be thread-safe: They may be called concurrently for
+ * different elements, in particular for the same query, and in any order.
+ * They may only read from \a forest. Results that are written to a query
+ * must be protected by the caller, for example with atomic operations.
+ * Without OpenMP this function is the same as \ref t8_forest_search.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  search_fn The search callback, \see t8_forest_search_query_fn.
+ * \param [in]  query_fn  The query callback. May be NULL if \a queries is NULL.
+ * \param [in]  queries   An array of queries or NULL.
+ */
+void                t8_forest_search_threaded (t8_forest_t forest,
+                                               t8_forest_search_query_fn
+                                               search_fn,
+                                               t8_forest_search_query_fn
+                                               query_fn,
+                                               sc_array_t * queries);
+
+/** Perform the same search as \ref t8_forest_search in the local trees and
+ * then in the ghost trees of a forest.
+ * Queries near the process boundary, for example for particles that just
+ * left the local domain, can thus be answered without communication.
+ * For a ghost tree the callbacks get the local tree id
+ * num_local_trees + ghost tree id, which is accepted by
+ * \ref t8_forest_get_tree_class and \ref t8_forest_global_tree_id,
+ * and \a leaf_elements and
+ * \a tree_leaf_index refer to the elements of the ghost tree, see
+ * \ref t8_forest_ghost_get_tree_elements.
+ * \param [in]  forest    A committed forest. Without a ghost layer only the
+ *                        local trees are searched.
+ * \param [in]  search_fn The search callback, \see t8_forest_search_query_fn.
+ * \param [in]  query_fn  The query callback. May be NULL if \a queries is NULL.
+ * \param [in]  queries   An array of queries or NULL.
+ * \param [in]  threaded  If true, the local trees are searched with multiple
+ *                        threads as in \ref t8_forest_search_threaded.
+ *                        The ghost trees are searched serially.
+ */
+void                t8_forest_search_with_ghosts (t8_forest_t forest,
+                                                  t8_forest_search_query_fn
+                                                  search_fn,
+                                                  t8_forest_search_query_fn
+                                                  query_fn,
+                                                  sc_array_t * queries,
+                                                  int threaded);
+
+/** Iterate over all faces of the local elements of a forest and call a
+ * callback once for each face.
+ * An inner face between two local elements of the same level is passed once,
+ * from the element with the smaller local index. A hanging face is passed
+ * once from its coarse side, with all leaves on its fine side as neighbors.
+ * If the coarse side is a ghost, each fine local element passes its part of
+ * the face with the ghost as single neighbor.
+ * Faces between local elements and ghosts of the same level and faces on
+ * the domain boundary are passed from the local element.
+ * \param [in]  forest    A committed forest. If it is distributed over more
+ *                        than one process, it must have a ghost layer.
+ * \param [in]  callback  The callback, \see t8_forest_iterate_all_faces_fn.
+ * \param [in]  user_data Arbitrary data passed to \a callback.
+ * \param [in]  forest_is_balanced True if we know that \a forest is balanced,
+ *                        false otherwise, \see t8_forest_leaf_face_neighbors.
+ */
+void                t8_forest_iterate_all_faces (t8_forest_t forest,
+                                                 t8_forest_iterate_all_faces_fn
+                                                 callback, void *user_data,
+                                                 int forest_is_balanced);
+
+/** Iterate over the volumes, faces and corners of the local elements of a
+ * forest in the order of the space-filling curve.
+ * For each local element the volume callback is called, then the face
+ * callback for the faces that are passed from this element as in
+ * \ref t8_forest_iterate_all_faces, then the corner callback for each corner
+ * whose smallest element index is the element.
+ * \param [in]  forest    A committed forest. If it is distributed over more
+ *                        than one process and \a face_fn is not NULL, it
+ *                        must have a ghost layer.
+ * \param [in]  volume_fn If not NULL, the volume callback.
+ * \param [in]  face_fn   If not NULL, the face callback.
+ * \param [in]  corner_fn If not NULL, the corner callback.
+ * \param [in]  prefetch_fn If not NULL, called for each element
+ *                        \a prefetch_distance elements ahead of its other
+ *                        callbacks.
+ * \param [in]  prefetch_distance The number of elements by which the
+ *                        prefetch callback runs ahead.
+ * \param [in]  user_data Arbitrary data passed to all callbacks.
+ * \param [in]  forest_is_balanced True if we know that \a forest is balanced,
+ *                        false otherwise, \see t8_forest_leaf_face_neighbors.
+ * \note The corners are identified by the coordinates of the element
+ * corners. Only local elements are considered and hanging corners form a
+ * corner with the fine elements only. Corners that are identified by a
+ * periodic connection of trees are passed separately.
+ */
+void                t8_forest_iterate (t8_forest_t forest,
+                                       t8_forest_iterate_volume_fn volume_fn,
+                                       t8_forest_iterate_all_faces_fn face_fn,
+                                       t8_forest_iterate_corner_fn corner_fn,
+                                       t8_forest_iterate_prefetch_fn
+                                       prefetch_fn,
+                                       t8_locidx_t prefetch_distance,
+                                       void *user_data,
+                                       int forest_is_balanced);
+
+/** Perform a top-down search of the forest with a batched query callback.
+ * The search is the same as \ref t8_forest_search, but the query callback
+ * is called once per element for all queries that are active for it.
+ * Each child only receives the queries that matched its parent, thus
+ * the queries are filtered hierarchically. This is suited for the
+ * location of many points or probes.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  search_fn The search callback, \see t8_forest_search_query_fn.
+ * \param [in]  batch_query_fn The batched query callback.
+ * \param [in]  queries   An array of queries.
+ * \param [in]  threaded  If true, the search is executed with multiple
+ *                        threads as in \ref t8_forest_search_threaded.
+ *                        The callbacks must then be thread-safe.
+ */
+void                t8_forest_search_batched (t8_forest_t forest,
+                                              t8_forest_search_query_fn
+                                              search_fn,
+                                              t8_forest_search_batch_query_fn
+                                              batch_query_fn,
+                                              sc_array_t * queries,
+                                              int threaded);
+
+/** Search queries in the leaves of all processes.
+ * Each process descends with its queries from the roots of all global
+ * trees along the partition of the forest, calling \a partition_fn for
+ * the elements that it passes on its way. A query that matches an element
+ * with a unique owner is sent to this owner, which searches it in its local
+ * trees with \a query_fn. The matching leaves are sent back.
+ * This function is collective and the queries may differ between the
+ * processes. The locally stored queries need not overlap with the local
+ * part of the forest.
+ * \param [in]  forest    A committed forest with a replicated cmesh.
+ * \param [in]  partition_fn The callback that routes a query through
+ *                        the partition, \see t8_forest_search_partition_fn.
+ * \param [in]  query_fn  The query callback that is called by the owner
+ *                        processes, \see t8_forest_search_query_fn. It
+ *                        receives a copy of the query and the index of the
+ *                        copy in an array of the received queries.
+ * \param [in]  queries   An array of queries of this process. The queries
+ *                        are copied bytewise to other processes and thus
+ *                        must not contain pointers.
+ * \param [in,out] results An array of \ref t8_forest_search_partition_result_t.
+ *                        On output, for each leaf that matches one of our
+ *                        queries an entry is appended. The results are
+ *                        sorted by query index, owner and element id.
+ * \note The owner processes search each received query in all of their
+ * local trees, thus \a query_fn should reject the elements that
+ * \a partition_fn would reject.
+ */
+void                t8_forest_search_partition (t8_forest_t forest,
+                                                t8_forest_search_partition_fn
+                                                partition_fn,
+                                                t8_forest_search_query_fn
+                                                query_fn,
+                                                sc_array_t * queries,
+                                                sc_array_t * results);
+
+/** Sort points onto the partition of a forest.
+ * For each point the maximum level element of its tree that contains it
+ * is computed, its linear id is the key of the point along the space-filling
+ * curve. The points are sent to the processes that own their keys and are
+ * sorted there by tree and key, the same order as the leaves of the forest.
+ * Points on the boundary of two elements are assigned to one of them.
+ * This function is collective, each process may pass points in any tree
+ * and in any order.
+ * \param [in]  forest    A committed forest with a replicated cmesh and at
+ *                        least one element.
+ * \param [in,out] points An array whose entries start with a
+ *                        \ref t8_forest_point_t and whose \a gtreeid and
+ *                        \a ref_coords are set. On output the points of all
+ *                        processes that lie in the local leaves, sorted by
+ *                        tree and key, with \a key and \a lelement_id set.
+ *                        The entries of a leaf are contiguous and points with
+ *                        the same key keep the order of their source
+ *                        processes and of their input arrays.
+ */
+void                t8_forest_sort_points (t8_forest_t forest,
+                                           sc_array_t * points);
+
 /** Given two forest where the elemnts in one forest are either direct children or
  * parents of the elements in the other forest
  * compare the two forests and for each refined element or coarsened
@@ -122,6 +455,34 @@ void                t8_forest_iterate_replace (t8_forest_t forest_new,
                                                t8_forest_replace_t
                                                replace_fn);
 
+/** Like \ref t8_forest_iterate_replace, but handle runs of consecutive
+ * unchanged elements at once instead of calling \a replace_fn for each of
+ * them. \a replace_fn is called for each refined element and coarsened family
+ * as in \ref t8_forest_iterate_replace.
+ * If \a data_new and \a data_old are given, the data of unchanged runs is
+ * copied from \a data_old to \a data_new as a whole and \a replace_fn is only
+ * called for refined elements and coarsened families.
+ * Otherwise, \a replace_fn is called once for each run of unchanged elements
+ * with num_outgoing = num_incoming = length of the run.
+ * \param [in]  forest_new  A forest, each element is a parent or child of an element in \a forest_old.
+ * \param [in]  forest_old  The initial forest.
+ * \param [in]  replace_fn  A replace callback function.
+ * \param [in,out] data_new If not NULL, an array with one entry per local element of
+ *                          \a forest_new. The entries of unchanged elements are set on output.
+ * \param [in]  data_old    If not NULL, an array with one entry per local element of
+ *                          \a forest_old of the same size as those of \a data_new.
+ *                          Must be given if and only if \a data_new is given.
+ * \note To pass a user pointer to \a replace_fn use \ref t8_forest_set_user_data
+ * and \ref t8_forest_get_user_data.
+ */
+void                t8_forest_iterate_replace_runs (t8_forest_t forest_new,
+                                                    t8_forest_t forest_old,
+                                                    t8_forest_replace_t
+                                                    replace_fn,
+                                                    sc_array_t * data_new,
+                                                    const sc_array_t *
+                                                    data_old);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_ITERATE_H! */
@@ -0,0 +1,220 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_level_set.cxx
+ * We refine a forest in a band around the zero level set of a function.
+ * \see t8_forest_new_level_set
+ */
+
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The parameters of the level set adaptation, passed as user data of the
+ * adapted forest to the adapt callback. */
+typedef struct
+{
+  t8_forest_level_set_fn level_set;     /* The level set function. */
+  void               *udata;    /* Passed to level_set. */
+  double              band_width;       /* The width of the band in element diameters. */
+  int                 min_level;        /* The minimum level of the elements. */
+  int                 max_level;        /* The maximum level in the band. */
+} t8_forest_level_set_data_t;
+
+/* Return true if the absolute value of the level set function at the
+ * centroid of an element is smaller than band_width times its diameter. */
+static int
+t8_forest_level_set_in_band (t8_forest_t forest, t8_locidx_t ltreeid,
+                             const t8_element_t * element,
+                             const t8_forest_level_set_data_t * data)
+{
+  const double       *tree_vertices;
+  double              centroid[3], value;
+
+  tree_vertices = t8_forest_get_tree_vertices (forest, ltreeid);
+  t8_forest_element_centroid (forest, ltreeid, element, tree_vertices,
+                              centroid);
+  value = data->level_set (centroid, data->udata);
+  return fabs (value) < data->band_width *
+    t8_forest_element_diam (forest, ltreeid, element, tree_vertices);
+}
+
+/* The adapt callback of the level set adaptation.
+ * It refines the elements in the band up to the maximum level and coarsens
+ * the families whose parent is outside of the band down to the minimum
+ * level. The function is not evaluated below the minimum level and an
+ * element outside of the band is not refined, such that no descendants of
+ * elements far from the interface are ever created. */
+static int
+t8_forest_level_set_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                           t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                           t8_eclass_scheme_c * ts, int num_elements,
+                           t8_element_t * elements[])
+{
+  const t8_forest_level_set_data_t *data;
+  t8_element_t       *parent;
+  int                 level, parent_in_band;
+
+  data = (const t8_forest_level_set_data_t *)
+    t8_forest_get_user_data (forest);
+  level = ts->t8_element_level (elements[0]);
+  if (level < data->min_level) {
+    return 1;
+  }
+  if (num_elements > 1 && level > data->min_level) {
+    if (level > data->max_level) {
+      return -1;
+    }
+    /* We decide for the whole family with one evaluation at its parent */
+    ts->t8_element_new (1, &parent);
+    ts->t8_element_parent (elements[0], parent);
+    parent_in_band =
+      t8_forest_level_set_in_band (forest_from, which_tree, parent, data);
+    ts->t8_element_destroy (1, &parent);
+    if (!parent_in_band) {
+      return -1;
+    }
+  }
+  if (level < data->max_level
+      && t8_forest_level_set_in_band (forest_from, which_tree, elements[0],
+                                      data)) {
+    return 1;
+  }
+  return 0;
+}
+
+void
+t8_forest_level_set_markers (t8_forest_t forest, const double *values,
+                             double band_width, int min_level, int max_level,
+                             int8_t * markers)
+{
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  const double       *tree_vertices;
+  t8_locidx_t         num_local_trees, itree;
+  t8_locidx_t         num_elements, ielement, lelement;
+  int                 level, in_band;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (band_width > 0);
+  T8_ASSERT (0 <= min_level && min_level <= max_level);
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, lelement = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      level = ts->t8_element_level (element);
+      if (level < min_level) {
+        /* Refine to the minimum level in one step */
+        markers[lelement] = min_level - level;
+        continue;
+      }
+      if (level > max_level) {
+        markers[lelement] = -1;
+        continue;
+      }
+      in_band = fabs (values[lelement]) <
+        band_width * t8_forest_element_diam (forest, itree, element,
+                                             tree_vertices);
+      if (in_band) {
+        markers[lelement] = level < max_level;
+      }
+      else {
+        markers[lelement] = level > min_level ? -1 : 0;
+      }
+    }
+  }
+}
+
+/* Set partition and balance for a level set forest and commit it */
+static void
+t8_forest_level_set_commit (t8_forest_t forest, int do_balance,
+                            int do_face_ghost)
+{
+  if (do_balance) {
+    t8_forest_set_balance (forest, NULL, 0);
+  }
+  else {
+    t8_forest_set_partition (forest, NULL, 0);
+  }
+  t8_forest_set_ghost (forest, do_face_ghost, T8_GHOST_FACES);
+  t8_forest_commit (forest);
+}
+
+t8_forest_t
+t8_forest_new_level_set (t8_forest_t forest_from,
+                         t8_forest_level_set_fn level_set, void *udata,
+                         double band_width, int min_level, int max_level,
+                         int do_balance, int do_face_ghost)
+{
+  t8_forest_t         forest;
+  t8_forest_level_set_data_t data;
+
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  T8_ASSERT (level_set != NULL);
+  T8_ASSERT (band_width > 0);
+  T8_ASSERT (0 <= min_level && min_level <= max_level);
+
+  data.level_set = level_set;
+  data.udata = udata;
+  data.band_width = band_width;
+  data.min_level = min_level;
+  data.max_level = max_level;
+
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_from, t8_forest_level_set_adapt, 1);
+  t8_forest_set_user_data (forest, &data);
+  t8_forest_level_set_commit (forest, do_balance, do_face_ghost);
+  /* The data is not valid after we return */
+  t8_forest_set_user_data (forest, NULL);
+  return forest;
+}
+
+t8_forest_t
+t8_forest_new_level_set_values (t8_forest_t forest_from,
+                                const double *values, double band_width,
+                                int min_level, int max_level,
+                                int do_balance, int do_face_ghost)
+{
+  t8_forest_t         forest;
+  int8_t             *markers;
+
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+
+  markers = T8_ALLOC (int8_t, t8_forest_get_local_num_elements (forest_from));
+  t8_forest_level_set_markers (forest_from, values, band_width, min_level,
+                               max_level, markers);
+  t8_forest_init (&forest);
+  t8_forest_set_adapt_markers (forest, forest_from, markers, max_level);
+  t8_forest_level_set_commit (forest, do_balance, do_face_ghost);
+  T8_FREE (markers);
+  return forest;
+}
+
+T8_EXTERN_C_END ();
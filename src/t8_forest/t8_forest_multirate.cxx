@@ -0,0 +1,158 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_multirate.cxx
+ * Helper functions for local time stepping schemes that group the elements
+ * of a forest by their refinement level.
+ * \see t8_forest_tree_elements_by_level
+ */
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_ghost.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_element_levels (t8_forest_t forest, int8_t * levels)
+{
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_locidx_t         num_trees, itree, num_elements, ielement, index;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (levels != NULL);
+
+  index = 0;
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      levels[index++] = ts->t8_element_level (element);
+    }
+  }
+  T8_ASSERT (index == t8_forest_get_local_num_elements (forest));
+
+  /* The ghosts are stored tree by tree in the order of their ghost index */
+  num_trees = t8_forest_ghost_num_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_ghost_get_tree_class (forest,
+                                                                      itree));
+    num_elements = t8_forest_ghost_tree_num_elements (forest, itree);
+    T8_ASSERT (index == t8_forest_get_local_num_elements (forest)
+               + t8_forest_ghost_get_tree_element_offset (forest, itree));
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_ghost_get_element (forest, itree, ielement);
+      levels[index++] = ts->t8_element_level (element);
+    }
+  }
+  T8_ASSERT (index == t8_forest_get_local_num_elements (forest)
+             + t8_forest_get_num_ghosts (forest));
+}
+
+void
+t8_forest_tree_elements_by_level (t8_forest_t forest, t8_locidx_t ltreeid,
+                                  t8_locidx_t * level_offsets,
+                                  t8_locidx_t * element_indices)
+{
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  t8_locidx_t         num_elements, ielement;
+  int                 maxlevel, level;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (0 <= ltreeid
+             && ltreeid < t8_forest_get_num_local_trees (forest));
+  T8_ASSERT (level_offsets != NULL && element_indices != NULL);
+
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  num_elements = t8_forest_get_tree_num_elements (forest, ltreeid);
+  maxlevel = t8_forest_get_maxlevel (forest);
+
+  /* Count the elements of each level, shifted by one such that the
+   * prefix sum yields the offsets. */
+  memset (level_offsets, 0, (maxlevel + 2) * sizeof (t8_locidx_t));
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+    level = ts->t8_element_level (element);
+    T8_ASSERT (0 <= level && level <= maxlevel);
+    level_offsets[level + 1]++;
+  }
+  for (level = 0; level <= maxlevel; level++) {
+    level_offsets[level + 1] += level_offsets[level];
+  }
+  T8_ASSERT (level_offsets[maxlevel + 1] == num_elements);
+
+  /* Sort the indices into their level; we use the entry of the next level
+   * as insertion position and shift the offsets back afterwards. */
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, ltreeid, ielement);
+    level = ts->t8_element_level (element);
+    element_indices[level_offsets[level]++] = ielement;
+  }
+  for (level = maxlevel; level > 0; level--) {
+    level_offsets[level] = level_offsets[level - 1];
+  }
+  level_offsets[0] = 0;
+}
+
+t8_locidx_t
+t8_forest_face_list_levels (sc_array_t * face_list,
+                            const int8_t * levels, int min_level,
+                            int max_level, sc_array_t * level_face_list)
+{
+  const t8_forest_face_pair_t *pair;
+  size_t              ipair;
+  int                 in_range;
+
+  T8_ASSERT (face_list != NULL && level_face_list != NULL);
+  T8_ASSERT (face_list->elem_size == sizeof (t8_forest_face_pair_t));
+  T8_ASSERT (level_face_list->elem_size == sizeof (t8_forest_face_pair_t));
+  T8_ASSERT (face_list != level_face_list);
+  T8_ASSERT (levels != NULL);
+  T8_ASSERT (min_level <= max_level);
+
+  sc_array_truncate (level_face_list);
+  for (ipair = 0; ipair < face_list->elem_count; ipair++) {
+    pair = (const t8_forest_face_pair_t *) sc_array_index (face_list, ipair);
+    in_range = min_level <= levels[pair->elements[0]]
+      && levels[pair->elements[0]] <= max_level;
+    if (!in_range && pair->elements[1] >= 0) {
+      in_range = min_level <= levels[pair->elements[1]]
+        && levels[pair->elements[1]] <= max_level;
+    }
+    if (in_range) {
+      *(t8_forest_face_pair_t *) sc_array_push (level_face_list) = *pair;
+    }
+  }
+  return (t8_locidx_t) level_face_list->elem_count;
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,445 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest_netcdf.h>
+#include <t8_element_cxx.hxx>
+#include "t8_forest_types.h"
+#include <vector>
+#if T8_WITH_NETCDF
+#include <netcdf.h>
+#include <netcdf_meta.h>
+#if NC_HAS_PARALLEL4
+#include <netcdf_par.h>
+#endif
+#endif
+
+#if T8_WITH_NETCDF
+/* Execute a netcdf call if no previous call in this function failed and
+ * store its error code in status. */
+#define T8_NC_CALL(call) \
+  do { if (status == NC_NOERR) { status = (call); } } while (0)
+
+/* The UGRID names of the elements of a mesh of dimension 2 and 3 */
+static const char  *t8_forest_netcdf_location[2] = { "face", "volume" };
+
+/* Define a variable with ndims dimensions, the first of which has
+ * num_rows entries, and set its chunking and compression.
+ * Returns a netcdf error code. */
+static int
+t8_forest_netcdf_def_var (int ncid, const char *name, nc_type type,
+                          int ndims, const int *dimids, size_t num_rows,
+                          size_t num_columns, size_t chunk_rows,
+                          int deflate_level, int *varid)
+{
+  size_t              chunk[2];
+  int                 retval;
+
+  retval = nc_def_var (ncid, name, type, ndims, dimids, varid);
+  if (retval == NC_NOERR && num_rows > 0) {
+    /* Chunking is required for compression and must not have empty chunks */
+    chunk[0] = SC_MIN (num_rows, chunk_rows);
+    chunk[1] = num_columns;
+    retval = nc_def_var_chunking (ncid, *varid, NC_CHUNKED, chunk);
+    if (retval == NC_NOERR && deflate_level > 0) {
+      retval = nc_def_var_deflate (ncid, *varid, 1, 1, deflate_level);
+    }
+  }
+  return retval;
+}
+
+/* Define a variable of one value per element that belongs to the mesh.
+ * Returns a netcdf error code. */
+static int
+t8_forest_netcdf_def_element_var (int ncid, const char *name, nc_type type,
+                                  int ndims, const int *dimids,
+                                  size_t num_elements, size_t num_columns,
+                                  size_t chunk_rows, int deflate_level,
+                                  int dim, int *varid)
+{
+  const char         *location = t8_forest_netcdf_location[dim - 2];
+  int                 retval;
+
+  retval = t8_forest_netcdf_def_var (ncid, name, type, ndims, dimids,
+                                     num_elements, num_columns, chunk_rows,
+                                     deflate_level, varid);
+  if (retval == NC_NOERR) {
+    retval = nc_put_att_text (ncid, *varid, "mesh", 4, "Mesh");
+  }
+  if (retval == NC_NOERR) {
+    retval = nc_put_att_text (ncid, *varid, "location", strlen (location),
+                              location);
+  }
+  return retval;
+}
+
+/* Write the local rows first_row, ..., first_row + num_rows - 1 of a
+ * variable of num_columns columns. Must be called on all processes.
+ * Returns a netcdf error code. */
+static int
+t8_forest_netcdf_put (int ncid, int varid, size_t num_columns,
+                      size_t first_row, size_t num_rows, const void *buffer)
+{
+  size_t              start[2], count[2];
+  int                 retval = NC_NOERR;
+
+#if NC_HAS_PARALLEL4
+  retval = nc_var_par_access (ncid, varid, NC_COLLECTIVE);
+#endif
+  start[0] = first_row;
+  start[1] = 0;
+  count[0] = num_rows;
+  count[1] = num_columns;
+  if (retval == NC_NOERR) {
+    retval = nc_put_vara (ncid, varid, start, count, buffer);
+  }
+  return retval;
+}
+
+/* Put a text attribute from a null terminated string.
+ * Returns a netcdf error code. */
+static int
+t8_forest_netcdf_put_text (int ncid, int varid, const char *name,
+                           const char *text)
+{
+  return nc_put_att_text (ncid, varid, name, strlen (text), text);
+}
+#endif
+
+int
+t8_forest_write_netcdf (t8_forest_t forest, const char *fileprefix,
+                        int write_treeid, int write_mpirank, int write_level,
+                        int num_data, t8_vtk_data_field_t * data,
+                        int deflate_level)
+{
+#if T8_WITH_NETCDF
+  std::vector < double >coordinates[3];
+  std::vector < long long >connectivity, treeids;
+  std::vector < int >shapes, levels, ranks;
+  std::vector < int >data_varids (num_data);
+  t8_locidx_t         itree, ielement, num_local_trees, num_elements;
+  t8_locidx_t         num_local_elements;
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  t8_element_shape_t  shape;
+  t8_gloidx_t         gtreeid;
+  double             *tree_vertices, element_coordinates[3];
+  long long           local_sizes[2], offsets[2], global_sizes[2];
+  long long           fill = -1, start_index = 0;
+  size_t              ientry, element_chunk, node_chunk;
+  char                ncfilename[BUFSIZ], node_coordinates[BUFSIZ];
+  int                 dim, max_nodes, ivertex, idata, icoord, mpiret;
+  int                 ncid, retval, status = NC_NOERR;
+  int                 node_dim, element_dim, max_nodes_dim, three_dim;
+  int                 dimids[2], mesh_varid, coord_varids[3];
+  int                 connectivity_varid, shape_varid = -1, treeid_varid =
+    -1, rank_varid = -1, level_varid = -1;
+  const int           volume_shapes[4] = { T8_ECLASS_HEX, T8_ECLASS_TET,
+    T8_ECLASS_PRISM, T8_ECLASS_PYRAMID
+  };
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (num_data == 0 || data != NULL);
+  T8_ASSERT (0 <= deflate_level && deflate_level <= 9);
+
+  dim = forest->dimension;
+  if (dim != 2 && dim != 3) {
+    t8_global_errorf ("Error: NetCDF output is only available for two and "
+                      "three dimensional forests. Did not write %s.nc.\n",
+                      fileprefix);
+    return 0;
+  }
+#if !NC_HAS_PARALLEL4
+  if (forest->mpisize > 1) {
+    t8_global_errorf ("Error: The netcdf library has no parallel support. "
+                      "Cannot write %s.nc on more than one process.\n",
+                      fileprefix);
+    return 0;
+  }
+#endif
+  if (snprintf (ncfilename, BUFSIZ, "%s.nc", fileprefix) >= BUFSIZ) {
+    t8_global_errorf ("Error when writing netcdf file. Filename too long.\n");
+    return 0;
+  }
+  max_nodes = dim == 2 ? 4 : 8;
+
+  /* Collect the element nodes, connectivity and cell data. The node ids in
+   * the connectivity are local for now and shifted below.  */
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  connectivity.reserve ((size_t) num_local_elements * max_nodes);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    gtreeid = t8_forest_global_tree_id (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      shape = ts->t8_element_shape (element);
+      for (ivertex = 0; ivertex < max_nodes; ivertex++) {
+        if (ivertex >= t8_eclass_num_vertices[shape]) {
+          /* Pad the nodes of elements with fewer nodes */
+          connectivity.push_back (fill);
+          continue;
+        }
+        connectivity.push_back (coordinates[0].size ());
+        /* The vtk corner order is counterclockwise as required by UGRID */
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      t8_eclass_vtk_corner_number[shape]
+                                      [ivertex], element_coordinates);
+        for (icoord = 0; icoord < 3; icoord++) {
+          coordinates[icoord].push_back (element_coordinates[icoord]);
+        }
+      }
+      if (dim == 3) {
+        shapes.push_back (shape);
+      }
+      if (write_treeid) {
+        treeids.push_back (gtreeid);
+      }
+      if (write_mpirank) {
+        ranks.push_back (forest->mpirank);
+      }
+      if (write_level) {
+        levels.push_back (ts->t8_element_level (element));
+      }
+    }
+  }
+  T8_ASSERT (connectivity.size () ==
+             (size_t) num_local_elements * max_nodes);
+
+  /* Compute the offsets of this process' nodes and elements */
+  local_sizes[0] = coordinates[0].size ();
+  local_sizes[1] = num_local_elements;
+  mpiret = sc_MPI_Exscan (local_sizes, offsets, 2, sc_MPI_LONG_LONG_INT,
+                          sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (local_sizes, global_sizes, 2,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The result of Exscan is undefined on the first process */
+    offsets[0] = offsets[1] = 0;
+  }
+  T8_ASSERT (t8_forest_get_first_local_element_id (forest) == offsets[1]);
+  for (ientry = 0; ientry < connectivity.size (); ientry++) {
+    /* Shift the node ids to global ids, skipping the padding */
+    if (connectivity[ientry] != fill) {
+      connectivity[ientry] += offsets[0];
+    }
+  }
+  /* The chunks have the average number of rows per process, such that
+   * their boundaries are close to those of the partition */
+  element_chunk = SC_MAX (1, SC_MIN (T8_FOREST_NETCDF_CHUNK_SIZE,
+                                     (global_sizes[1] + forest->mpisize - 1)
+                                     / forest->mpisize));
+  node_chunk = SC_MAX (1, SC_MIN (T8_FOREST_NETCDF_CHUNK_SIZE,
+                                  (global_sizes[0] + forest->mpisize - 1)
+                                  / forest->mpisize));
+
+  /* Create the file on all processes */
+#if NC_HAS_PARALLEL4
+  retval = nc_create_par (ncfilename, NC_NETCDF4 | NC_CLOBBER,
+                          forest->mpicomm, sc_MPI_INFO_NULL, &ncid);
+#else
+  retval = nc_create (ncfilename, NC_NETCDF4 | NC_CLOBBER, &ncid);
+#endif
+  if (retval != NC_NOERR) {
+    t8_global_errorf ("Could not open file %s for output: %s\n", ncfilename,
+                      nc_strerror (retval));
+    return 0;
+  }
+
+  /* Define the dimensions and variables. The calls are collective, thus we
+   * do not return early on errors but skip the remaining calls. */
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, NC_GLOBAL, "Conventions",
+                                         "CF-1.8 UGRID-1.0"));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, NC_GLOBAL, "source",
+                                         "t8code"));
+  T8_NC_CALL (nc_def_dim (ncid, "nMesh_node", global_sizes[0], &node_dim));
+  T8_NC_CALL (nc_def_dim (ncid, dim == 2 ? "nMesh_face" : "nMesh_volume",
+                          global_sizes[1], &element_dim));
+  T8_NC_CALL (nc_def_dim (ncid, dim == 2 ? "nMaxMesh_face_nodes" :
+                          "nMaxMesh_volume_nodes", max_nodes,
+                          &max_nodes_dim));
+  T8_NC_CALL (nc_def_dim (ncid, "three", 3, &three_dim));
+
+  /* The mesh topology */
+  snprintf (node_coordinates, BUFSIZ, "Mesh_node_x Mesh_node_y%s",
+            dim == 3 ? " Mesh_node_z" : "");
+  T8_NC_CALL (nc_def_var (ncid, "Mesh", NC_INT, 0, NULL, &mesh_varid));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid, "cf_role",
+                                         "mesh_topology"));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid, "long_name",
+                                         "Topology data of the t8code forest"));
+  T8_NC_CALL (nc_put_att_int (ncid, mesh_varid, "topology_dimension", NC_INT,
+                              1, &dim));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid, "node_coordinates",
+                                         node_coordinates));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid, dim == 2 ?
+                                         "face_node_connectivity" :
+                                         "volume_node_connectivity",
+                                         dim == 2 ? "Mesh_face_nodes" :
+                                         "Mesh_volume_nodes"));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid, dim == 2 ?
+                                         "face_dimension" : "volume_dimension",
+                                         dim == 2 ? "nMesh_face" :
+                                         "nMesh_volume"));
+  if (dim == 3) {
+    T8_NC_CALL (t8_forest_netcdf_put_text (ncid, mesh_varid,
+                                           "volume_shape_type",
+                                           "Mesh_volume_types"));
+  }
+
+  /* The node coordinates */
+  for (icoord = 0; icoord < dim; icoord++) {
+    char                name[BUFSIZ];
+
+    snprintf (name, BUFSIZ, "Mesh_node_%c", 'x' + icoord);
+    T8_NC_CALL (t8_forest_netcdf_def_var (ncid, name, NC_DOUBLE, 1,
+                                          &node_dim, global_sizes[0], 1,
+                                          node_chunk, deflate_level,
+                                          &coord_varids[icoord]));
+    snprintf (name, BUFSIZ, "%c coordinate of the mesh nodes", 'x' + icoord);
+    T8_NC_CALL (t8_forest_netcdf_put_text (ncid, coord_varids[icoord],
+                                           "long_name", name));
+  }
+
+  /* The element node connectivity */
+  dimids[0] = element_dim;
+  dimids[1] = max_nodes_dim;
+  T8_NC_CALL (t8_forest_netcdf_def_var (ncid, dim == 2 ? "Mesh_face_nodes" :
+                                        "Mesh_volume_nodes", NC_INT64, 2,
+                                        dimids, global_sizes[1], max_nodes,
+                                        element_chunk, deflate_level,
+                                        &connectivity_varid));
+  T8_NC_CALL (t8_forest_netcdf_put_text (ncid, connectivity_varid, "cf_role",
+                                         dim == 2 ? "face_node_connectivity"
+                                         : "volume_node_connectivity"));
+  T8_NC_CALL (nc_put_att_longlong (ncid, connectivity_varid, "start_index",
+                                   NC_INT64, 1, &start_index));
+  T8_NC_CALL (nc_def_var_fill (ncid, connectivity_varid, 0, &fill));
+  if (dim == 3) {
+    T8_NC_CALL (t8_forest_netcdf_def_var (ncid, "Mesh_volume_types", NC_INT,
+                                          1, &element_dim, global_sizes[1], 1,
+                                          element_chunk, deflate_level,
+                                          &shape_varid));
+    T8_NC_CALL (t8_forest_netcdf_put_text (ncid, shape_varid, "cf_role",
+                                           "volume_shape_type"));
+    T8_NC_CALL (nc_put_att_int (ncid, shape_varid, "flag_values", NC_INT, 4,
+                                volume_shapes));
+    T8_NC_CALL (t8_forest_netcdf_put_text (ncid, shape_varid, "flag_meanings",
+                                           "hexahedron tetrahedron wedge "
+                                           "pyramid"));
+  }
+
+  /* The element variables */
+  if (write_treeid) {
+    T8_NC_CALL (t8_forest_netcdf_def_element_var (ncid, "Mesh_treeid",
+                                                  NC_INT64, 1, &element_dim,
+                                                  global_sizes[1], 1,
+                                                  element_chunk,
+                                                  deflate_level, dim,
+                                                  &treeid_varid));
+  }
+  if (write_mpirank) {
+    T8_NC_CALL (t8_forest_netcdf_def_element_var (ncid, "Mesh_mpirank",
+                                                  NC_INT, 1, &element_dim,
+                                                  global_sizes[1], 1,
+                                                  element_chunk,
+                                                  deflate_level, dim,
+                                                  &rank_varid));
+  }
+  if (write_level) {
+    T8_NC_CALL (t8_forest_netcdf_def_element_var (ncid, "Mesh_level",
+                                                  NC_INT, 1, &element_dim,
+                                                  global_sizes[1], 1,
+                                                  element_chunk,
+                                                  deflate_level, dim,
+                                                  &level_varid));
+  }
+  dimids[1] = three_dim;
+  for (idata = 0; idata < num_data; idata++) {
+    const int           is_vector = data[idata].type == T8_VTK_VECTOR;
+
+    T8_NC_CALL (t8_forest_netcdf_def_element_var (ncid,
+                                                  data[idata].description,
+                                                  NC_DOUBLE,
+                                                  is_vector ? 2 : 1, dimids,
+                                                  global_sizes[1],
+                                                  is_vector ? 3 : 1,
+                                                  element_chunk,
+                                                  deflate_level, dim,
+                                                  &data_varids[idata]));
+  }
+  T8_NC_CALL (nc_enddef (ncid));
+
+  /* Write the variables collectively */
+  for (icoord = 0; icoord < dim; icoord++) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, coord_varids[icoord], 1,
+                                      offsets[0], local_sizes[0],
+                                      coordinates[icoord].data ()));
+  }
+  T8_NC_CALL (t8_forest_netcdf_put (ncid, connectivity_varid, max_nodes,
+                                    offsets[1], local_sizes[1],
+                                    connectivity.data ()));
+  if (dim == 3) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, shape_varid, 1, offsets[1],
+                                      local_sizes[1], shapes.data ()));
+  }
+  if (write_treeid) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, treeid_varid, 1, offsets[1],
+                                      local_sizes[1], treeids.data ()));
+  }
+  if (write_mpirank) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, rank_varid, 1, offsets[1],
+                                      local_sizes[1], ranks.data ()));
+  }
+  if (write_level) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, level_varid, 1, offsets[1],
+                                      local_sizes[1], levels.data ()));
+  }
+  for (idata = 0; idata < num_data; idata++) {
+    T8_NC_CALL (t8_forest_netcdf_put (ncid, data_varids[idata],
+                                      data[idata].type == T8_VTK_VECTOR ? 3 :
+                                      1, offsets[1], local_sizes[1],
+                                      data[idata].data));
+  }
+  retval = nc_close (ncid);
+  if (status == NC_NOERR) {
+    status = retval;
+  }
+  if (status != NC_NOERR) {
+    t8_errorf ("Error when writing file %s: %s\n", ncfilename,
+               nc_strerror (status));
+  }
+  return status == NC_NOERR;
+#else
+  t8_global_errorf ("Warning: t8code is not linked against netcdf. "
+                    "Did not write %s.nc.\n", fileprefix);
+  return 0;
+#endif
+}
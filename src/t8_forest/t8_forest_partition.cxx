@@ -23,6 +23,9 @@
 #include <t8_forest/t8_forest_partition.h>
 #include <t8_forest/t8_forest_types.h>
 #include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_forest/t8_forest_hash.h>
+#include <t8_trace.h>
 #include <t8_forest.h>
 #include <t8_cmesh/t8_cmesh_offset.h>
 #include <t8_element_cxx.hxx>
@@ -40,6 +43,14 @@ typedef struct
   t8_locidx_t         num_elements;     /* The number of elements from this tree that were sent */
 } t8_forest_partition_tree_info_t;
 
+/* The maximum number of elements that we ship in one message when
+ * migrating elements. Larger sends are split into chunks, such that the
+ * receiver can insert the first chunks while the others are in flight. */
+#define T8_FOREST_PARTITION_CHUNK_ELEMENTS (1 << 15)
+
+/* The number of chunks that we receive concurrently from one process */
+#define T8_FOREST_PARTITION_CHUNK_WINDOW 2
+
 /* Given the element offset array and a rank, return the first
  * local element id of this rank */
 static              t8_gloidx_t
@@ -115,8 +126,11 @@ t8_forest_partition_create_offsets (t8_forest_t forest)
   /* Collect all first global indices in the array */
   t8_shmem_array_allgather (&first_local_element, 1, T8_MPI_GLOIDX,
                             forest->element_offsets, 1, T8_MPI_GLOIDX);
-  t8_shmem_array_set_gloidx (forest->element_offsets, forest->mpisize,
-                             forest->global_num_elements);
+  if (t8_shmem_array_start_writing (forest->element_offsets)) {
+    t8_shmem_array_set_gloidx (forest->element_offsets, forest->mpisize,
+                               forest->global_num_elements);
+  }
+  t8_shmem_array_end_writing (forest->element_offsets);
 }
 
 #ifdef T8_ENABLE_DEBUG
@@ -283,8 +297,11 @@ t8_forest_partition_create_tree_offsets (t8_forest_t forest)
   t8_shmem_array_allgather (&tree_offset, 1, T8_MPI_GLOIDX,
                             forest->tree_offsets, 1, T8_MPI_GLOIDX);
   /* Store the global number of trees at the entry mpisize in the array */
-  t8_shmem_array_set_gloidx (forest->tree_offsets, forest->mpisize,
-                             forest->global_num_trees);
+  if (t8_shmem_array_start_writing (forest->tree_offsets)) {
+    t8_shmem_array_set_gloidx (forest->tree_offsets, forest->mpisize,
+                               forest->global_num_trees);
+  }
+  t8_shmem_array_end_writing (forest->tree_offsets);
 
   /* Communicate whether we have empty processes */
   sc_MPI_Allreduce (&is_empty, &has_empty, 1, sc_MPI_INT, sc_MPI_LOR,
@@ -318,16 +335,465 @@ t8_forest_partition_create_tree_offsets (t8_forest_t forest)
   }
 }
 
+/* Return true if a partition boundary in front of the local element
+ * lelement_id of forest does not split a family of elements.
+ * This is the case if the element is the first child of its parent or if
+ * the previous element has a different level; otherwise both elements are
+ * siblings, since the previous sibling of an element precedes it in the SFC.
+ * prev_level is the level of the previous element on another process, if
+ * lelement_id is 0, and -1 if there is no previous element. */
+static int
+t8_forest_partition_is_family_boundary (t8_forest_t forest,
+                                        t8_locidx_t lelement_id,
+                                        int prev_level)
+{
+  t8_element_t       *element;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         ltree_id;
+  int                 level;
+
+  element = t8_forest_get_element (forest, lelement_id, &ltree_id);
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltree_id));
+  if (ts->t8_element_child_id (element) == 0) {
+    return 1;
+  }
+  level = ts->t8_element_level (element);
+  if (lelement_id > 0) {
+    element = t8_forest_get_element (forest, lelement_id - 1, &ltree_id);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltree_id));
+    prev_level = ts->t8_element_level (element);
+  }
+  return level != prev_level;
+}
+
+/* Move the new partition boundaries in new_offsets back, such that no family
+ * of elements of forest->set_from is split between two processes.
+ * After one round of adaptation, each family can then be coarsened.
+ * Each process computes the boundaries that lie in its element range.
+ * Since a boundary moves by less than the size of a family, processes with
+ * few elements may need the last boundary of a previous process, which
+ * is gathered from all processes. */
+static void
+t8_forest_partition_for_coarsening (t8_forest_t forest,
+                                    t8_gloidx_t * new_offsets)
+{
+  t8_forest_t         forest_from;
+  t8_gloidx_t        *offset_from, *last_boundaries, *boundaries;
+  t8_gloidx_t         first_local, last_boundary;
+  t8_locidx_t         num_local, lelement_id;
+  t8_element_t       *element;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         ltree_id;
+  int                 mpiret, iproc, iproc_from, prev_level, last_level;
+  int                *last_levels;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (forest_from->element_offsets != NULL);
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  first_local = offset_from[forest->mpirank];
+  num_local = forest_from->local_num_elements;
+
+  /* Gather the level of the last element of each process */
+  last_level = -1;
+  if (num_local > 0) {
+    element = t8_forest_get_element (forest_from, num_local - 1, &ltree_id);
+    ts = t8_forest_get_eclass_scheme (forest_from,
+                                      t8_forest_get_tree_class (forest_from,
+                                                                ltree_id));
+    last_level = ts->t8_element_level (element);
+  }
+  last_levels = T8_ALLOC (int, forest->mpisize);
+  mpiret = sc_MPI_Allgather (&last_level, 1, sc_MPI_INT, last_levels, 1,
+                             sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  /* The level of the element in front of our first element */
+  prev_level = -1;
+  for (iproc = forest->mpirank - 1; iproc >= 0 && prev_level < 0; iproc--) {
+    prev_level = last_levels[iproc];
+  }
+  T8_FREE (last_levels);
+
+  /* Gather the last family boundary of each process */
+  last_boundary = -1;
+  for (lelement_id = num_local - 1; lelement_id >= 0; lelement_id--) {
+    if (t8_forest_partition_is_family_boundary (forest_from, lelement_id,
+                                                prev_level)) {
+      last_boundary = first_local + lelement_id;
+      break;
+    }
+  }
+  last_boundaries = T8_ALLOC (t8_gloidx_t, forest->mpisize);
+  mpiret = sc_MPI_Allgather (&last_boundary, 1, T8_MPI_GLOIDX,
+                             last_boundaries, 1, T8_MPI_GLOIDX,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Compute the boundaries in our range, all others are set to 0 */
+  boundaries = T8_ALLOC_ZERO (t8_gloidx_t, forest->mpisize + 1);
+  for (iproc = 1; iproc < forest->mpisize; iproc++) {
+    if (new_offsets[iproc] < first_local
+        || new_offsets[iproc] >= first_local + num_local) {
+      continue;
+    }
+    /* Go back to the first family boundary */
+    for (lelement_id = new_offsets[iproc] - first_local; lelement_id >= 0;
+         lelement_id--) {
+      if (t8_forest_partition_is_family_boundary (forest_from, lelement_id,
+                                                  prev_level)) {
+        boundaries[iproc] = first_local + lelement_id;
+        break;
+      }
+    }
+    if (lelement_id < 0) {
+      /* The boundary is on a previous process */
+      for (iproc_from = forest->mpirank - 1; iproc_from >= 0; iproc_from--) {
+        if (last_boundaries[iproc_from] >= 0) {
+          boundaries[iproc] = last_boundaries[iproc_from];
+          break;
+        }
+      }
+    }
+  }
+  T8_FREE (last_boundaries);
+  mpiret = sc_MPI_Allreduce (boundaries + 1, new_offsets + 1,
+                             forest->mpisize - 1, T8_MPI_GLOIDX, sc_MPI_MAX,
+                             forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (boundaries);
+}
+
+/* Given the sums of the eclass weights of the local trees of
+ * forest->set_from, compute the boundaries of the weighted partition in our
+ * range as in t8_forest_partition_compute_weighted_offset.
+ * tree_prefix[t] is the weight of the local trees in front of tree t.
+ * Since all elements of a tree have the same weight, the boundaries are
+ * computed per tree without visiting the elements. */
+static void
+t8_forest_partition_eclass_boundaries (t8_forest_t forest,
+                                       const double *tree_prefix,
+                                       double first_weight,
+                                       double total_weight, double shift,
+                                       t8_gloidx_t * boundaries)
+{
+  t8_forest_t         forest_from = forest->set_from;
+  t8_gloidx_t        *offset_from;
+  t8_gloidx_t         first_local;
+  t8_locidx_t         ltree_id, num_trees, num_elements, tree_first;
+  t8_locidx_t         ielement;
+  double              weight, target;
+  int                 iproc;
+
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  first_local = offset_from[forest->mpirank];
+  num_trees = t8_forest_get_num_local_trees (forest_from);
+
+  /* The targets increase with iproc, thus we sweep once over the trees */
+  ltree_id = 0;
+  tree_first = 0;
+  num_elements = num_trees > 0 ?
+    t8_forest_get_tree_num_elements (forest_from, 0) : 0;
+  for (iproc = 1; iproc < forest->mpisize; iproc++) {
+    boundaries[iproc] = forest_from->global_num_elements;
+    target = ((iproc + shift) * total_weight) / forest->mpisize;
+    /* Find the first tree whose last element has at least the target
+     * weight in front of it */
+    while (ltree_id < num_trees) {
+      weight = num_elements > 0 ?
+        (tree_prefix[ltree_id + 1] - tree_prefix[ltree_id]) / num_elements
+        : 0;
+      if (num_elements > 0
+          && first_weight + tree_prefix[ltree_id + 1] - weight >= target) {
+        break;
+      }
+      tree_first += num_elements;
+      ltree_id++;
+      num_elements = ltree_id < num_trees ?
+        t8_forest_get_tree_num_elements (forest_from, ltree_id) : 0;
+    }
+    if (ltree_id >= num_trees) {
+      /* This and all following boundaries are not in our range */
+      break;
+    }
+    /* The first element in the tree that has the target weight in front */
+    ielement = 0;
+    if (weight > 0) {
+      ielement = (t8_locidx_t)
+        ceil ((target - first_weight - tree_prefix[ltree_id]) / weight);
+      ielement = SC_MAX (0, SC_MIN (ielement, num_elements - 1));
+    }
+    boundaries[iproc] = first_local + tree_first + ielement;
+  }
+  for (; iproc < forest->mpisize; iproc++) {
+    boundaries[iproc] = forest_from->global_num_elements;
+  }
+}
+
+/* Compute the first element of each process in a weighted partition of
+ * forest->set_from and store it in new_offsets.
+ * Process p starts with the first element for which the sum of the weights
+ * of all previous elements is at least (p + shift) / mpisize times the
+ * total weight.
+ * Each process computes the boundaries in its own range and the result is
+ * combined with one Allreduce.
+ * The weights are given per element, per eclass or by a cost model.
+ * Returns false if the total weight is zero, in which case new_offsets is
+ * not changed. */
+static int
+t8_forest_partition_compute_weighted_offset (t8_forest_t forest,
+                                             t8_gloidx_t * new_offsets,
+                                             double shift)
+{
+  t8_forest_t         forest_from;
+  t8_gloidx_t        *offset_from, *boundaries;
+  t8_gloidx_t         first_local;
+  t8_locidx_t         num_local, ltree_id, num_trees, num_elements;
+  t8_locidx_t         lelement_id, ielement, low, high, mid;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  t8_element_t       *element;
+  double             *prefix;
+  double              local_weight, first_weight, total_weight, weight;
+  double              target;
+  int                 mpiret, iproc;
+
+  forest_from = forest->set_from;
+  T8_ASSERT (forest_from->element_offsets != NULL);
+  T8_ASSERT (forest->set_partition_weights == NULL
+             || forest->set_partition_weight_fn == NULL);
+  T8_ASSERT (!forest->set_partition_use_eclass_weights
+             || (forest->set_partition_weights == NULL
+                 && forest->set_partition_weight_fn == NULL));
+  T8_ASSERT (forest->set_partition_cost_model == NULL
+             || (forest->set_partition_weights == NULL
+                 && forest->set_partition_weight_fn == NULL
+                 && !forest->set_partition_use_eclass_weights));
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  first_local = offset_from[forest->mpirank];
+  num_local = forest_from->local_num_elements;
+  num_trees = t8_forest_get_num_local_trees (forest_from);
+
+  if (forest->set_partition_use_eclass_weights) {
+    /* prefix[t] is the sum of the weights of the first t local trees */
+    prefix = T8_ALLOC (double, num_trees + 1);
+    prefix[0] = 0;
+    for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+      tree_class = t8_forest_get_tree_class (forest_from, ltree_id);
+      weight = forest->set_partition_eclass_weights[tree_class];
+      T8_ASSERT (weight >= 0);
+      prefix[ltree_id + 1] = prefix[ltree_id] + weight *
+        t8_forest_get_tree_num_elements (forest_from, ltree_id);
+    }
+    local_weight = prefix[num_trees];
+  }
+  else {
+    /* prefix[i] is the sum of the weights of the first i local elements */
+    prefix = T8_ALLOC (double, num_local + 1);
+    prefix[0] = 0;
+    lelement_id = 0;
+    for (ltree_id = 0; ltree_id < num_trees; ltree_id++) {
+      ts = t8_forest_get_eclass_scheme (forest_from,
+                                        t8_forest_get_tree_class
+                                        (forest_from, ltree_id));
+      num_elements = t8_forest_get_tree_num_elements (forest_from, ltree_id);
+      for (ielement = 0; ielement < num_elements; ielement++, lelement_id++) {
+        if (forest->set_partition_weights != NULL) {
+          weight = forest->set_partition_weights[lelement_id];
+        }
+        else if (forest->set_partition_cost_model != NULL) {
+          element = t8_forest_get_element_in_tree (forest_from, ltree_id,
+                                                   ielement);
+          weight =
+            t8_forest_cost_model_get_cost (forest->set_partition_cost_model,
+                                           ts->eclass,
+                                           ts->t8_element_level (element));
+        }
+        else {
+          element = t8_forest_get_element_in_tree (forest_from, ltree_id,
+                                                   ielement);
+          weight = forest->set_partition_weight_fn (forest_from, ltree_id,
+                                                    ielement, ts, element);
+        }
+        T8_ASSERT (weight >= 0);
+        prefix[lelement_id + 1] = prefix[lelement_id] + weight;
+      }
+    }
+    T8_ASSERT (lelement_id == num_local);
+    local_weight = prefix[num_local];
+  }
+
+  /* Compute the weight in front of our first element and the total weight */
+  mpiret = sc_MPI_Scan (&local_weight, &first_weight, 1, sc_MPI_DOUBLE,
+                        sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  /* MPI_Scan is inclusive, thus we subtract our own weight */
+  first_weight -= local_weight;
+  mpiret = sc_MPI_Allreduce (&local_weight, &total_weight, 1, sc_MPI_DOUBLE,
+                             sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (total_weight <= 0) {
+    T8_FREE (prefix);
+    return 0;
+  }
+
+  /* For each boundary, find the first local element that has at least the
+   * target weight in front of it. Boundaries outside of our range are set
+   * to the global number of elements. */
+  boundaries = T8_ALLOC (t8_gloidx_t, forest->mpisize + 1);
+  if (forest->set_partition_use_eclass_weights) {
+    t8_forest_partition_eclass_boundaries (forest, prefix, first_weight,
+                                           total_weight, shift, boundaries);
+  }
+  else {
+    for (iproc = 1; iproc < forest->mpisize; iproc++) {
+      boundaries[iproc] = forest_from->global_num_elements;
+      target = ((iproc + shift) * total_weight) / forest->mpisize;
+      if (num_local == 0 || first_weight + prefix[num_local - 1] < target) {
+        continue;
+      }
+      /* Binary search in prefix[0, ..., num_local - 1] */
+      low = 0;
+      high = num_local - 1;
+      while (low < high) {
+        mid = low + (high - low) / 2;
+        if (first_weight + prefix[mid] < target) {
+          low = mid + 1;
+        }
+        else {
+          high = mid;
+        }
+      }
+      boundaries[iproc] = first_local + low;
+    }
+  }
+  T8_FREE (prefix);
+  if (forest->mpisize > 1) {
+    mpiret = sc_MPI_Allreduce (boundaries + 1, new_offsets + 1,
+                               forest->mpisize - 1, T8_MPI_GLOIDX,
+                               sc_MPI_MIN, forest->mpicomm);
+    SC_CHECK_MPI (mpiret);
+  }
+  new_offsets[0] = 0;
+  T8_FREE (boundaries);
+  return 1;
+}
+
+/* Compute the first element of each process for the partition of
+ * forest->set_from, such that each process gets approximately the same
+ * weight, or the same number of elements if no weights are set.
+ * The boundary of process p is placed at (p + shift) / mpisize of the total
+ * weight, but never before the first or after the last element.
+ * new_offsets has mpisize + 1 entries. */
+static void
+t8_forest_partition_target_offsets (t8_forest_t forest,
+                                    t8_gloidx_t * new_offsets, double shift)
+{
+  t8_forest_t         forest_from = forest->set_from;
+  long double         target;
+  int                 i;
+
+  if ((forest->set_partition_weight_fn == NULL
+       && forest->set_partition_weights == NULL
+       && !forest->set_partition_use_eclass_weights
+       && forest->set_partition_cost_model == NULL)
+      || !t8_forest_partition_compute_weighted_offset (forest, new_offsets,
+                                                       shift)) {
+    for (i = 0; i < forest->mpisize; i++) {
+      /* Calculate the first element index for each process. We convert to doubles to
+       * prevent overflow */
+      target = (((double) i + shift) *
+                (long double) forest_from->global_num_elements)
+        / (double) forest->mpisize;
+      new_offsets[i] = i == 0 ? 0 :
+        SC_MAX (0, SC_MIN (target, forest_from->global_num_elements));
+      T8_ASSERT (0 <= new_offsets[i] &&
+                 new_offsets[i] <= forest_from->global_num_elements);
+    }
+  }
+  new_offsets[forest->mpisize] = forest_from->global_num_elements;
+}
+
+/* If the communicator of forest has node communicators attached
+ * (see t8_shmem_init) and the processes of each node have consecutive
+ * ranks, return an array with one entry per process that is true if the
+ * process has the smallest rank of its node. Otherwise return NULL.
+ * This function is collective. */
+static int         *
+t8_forest_partition_node_first (t8_forest_t forest)
+{
+  sc_MPI_Comm         comm, intranode, internode;
+  int                 intrarank, node_start, min_start, max_start;
+  int                 contiguous, all_contiguous, is_first, mpiret;
+  int                *node_first;
+
+  comm = forest->mpicomm;
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL) {
+    /* The node communicators are attached to comm on all processes or on
+     * none, so all processes return here. */
+    return NULL;
+  }
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  /* The processes of a node have consecutive ranks if and only if all of
+   * them compute the same rank for the first process of the node */
+  node_start = forest->mpirank - intrarank;
+  mpiret = sc_MPI_Allreduce (&node_start, &min_start, 1, sc_MPI_INT,
+                             sc_MPI_MIN, intranode);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&node_start, &max_start, 1, sc_MPI_INT,
+                             sc_MPI_MAX, intranode);
+  SC_CHECK_MPI (mpiret);
+  contiguous = min_start == max_start;
+  mpiret = sc_MPI_Allreduce (&contiguous, &all_contiguous, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!all_contiguous) {
+    t8_global_infof ("The ranks of a node are not consecutive. "
+                     "Partitioning without node awareness.\n");
+    return NULL;
+  }
+  is_first = intrarank == 0;
+  node_first = T8_ALLOC (int, forest->mpisize);
+  mpiret = sc_MPI_Allgather (&is_first, 1, sc_MPI_INT, node_first, 1,
+                             sc_MPI_INT, comm);
+  SC_CHECK_MPI (mpiret);
+  T8_ASSERT (node_first[0]);
+  return node_first;
+}
+
 /* Calculate the new element_offset for forest from
- * the element in forest->set_from assuming a partition without
- * element weights */
+ * the element in forest->set_from.
+ * If element weights are set, each process gets approximately the same
+ * weight, otherwise approximately the same number of elements.
+ * If forest->set_partition_tolerance is positive, the boundaries only move
+ * as little as necessary: Each new boundary is the old boundary clamped to
+ * the band of boundaries that are at most tolerance / 2 times the average
+ * load away from the ideal boundary. Thus no element moves if the forest
+ * is already balanced within the tolerance.
+ * If additionally forest->set_partition_node_aware is true, this only
+ * applies to the boundaries between compute nodes. The boundaries between
+ * the processes of a node are the ideal boundaries, restricted to the range
+ * of the node. Thus elements only move between nodes if a node is out of
+ * balance, and the balance within a node is restored with intranode
+ * messages.
+ * If forest->set_for_coarsening is true, the offsets are chosen such that
+ * no family of elements is split between processes. */
 static void
 t8_forest_partition_compute_new_offset (t8_forest_t forest)
 {
   t8_forest_t         forest_from;
   sc_MPI_Comm         comm;
-  t8_gloidx_t         new_first_element_id;
-  int                 i, mpiret, mpisize;
+  t8_gloidx_t        *new_offsets, *lower_offsets, *upper_offsets;
+  t8_gloidx_t        *old_offsets;
+  int                *node_first = NULL;
+  int                 i, node_begin, node_end, mpiret, mpisize;
 
   T8_ASSERT (t8_forest_is_initialized (forest));
   T8_ASSERT (forest->set_from != NULL);
@@ -344,19 +810,80 @@ t8_forest_partition_compute_new_offset (t8_forest_t forest)
   mpiret = sc_MPI_Comm_size (comm, &mpisize);
   SC_CHECK_MPI (mpiret);
 
-  for (i = 0; i < mpisize; i++) {
-    /* Calculate the first element index for each process. We convert to doubles to
-     * prevent overflow */
-    new_first_element_id =
-      (((double) i *
-        (long double) forest_from->global_num_elements) / (double) mpisize);
-    T8_ASSERT (0 <= new_first_element_id &&
-               new_first_element_id < forest_from->global_num_elements);
-    t8_shmem_array_set_gloidx (forest->element_offsets, i,
-                               new_first_element_id);
-  }
-  t8_shmem_array_set_gloidx (forest->element_offsets, forest->mpisize,
-                             forest->global_num_elements);
+  new_offsets = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+  if (forest->set_partition_offsets != NULL) {
+    /* The new partition was given by the user */
+    memcpy (new_offsets, forest->set_partition_offsets,
+            (mpisize + 1) * sizeof (t8_gloidx_t));
+    SC_CHECK_ABORT (new_offsets[0] == 0
+                    && new_offsets[mpisize] ==
+                    forest_from->global_num_elements,
+                    "The given partition does not cover the forest.\n");
+  }
+  else if (forest->set_partition_tolerance > 0 && mpisize > 1) {
+    if (forest->set_partition_node_aware) {
+      node_first = t8_forest_partition_node_first (forest);
+    }
+    if (node_first != NULL) {
+      /* We need the ideal boundaries within the nodes */
+      t8_forest_partition_target_offsets (forest, new_offsets, 0);
+    }
+    /* Compute the lower and upper end of the band of allowed boundaries */
+    lower_offsets = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+    upper_offsets = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+    t8_forest_partition_target_offsets (forest, lower_offsets,
+                                        -forest->set_partition_tolerance / 2);
+    t8_forest_partition_target_offsets (forest, upper_offsets,
+                                        forest->set_partition_tolerance / 2);
+    /* Move each old boundary into its band */
+    T8_ASSERT (forest_from->element_offsets != NULL);
+    old_offsets =
+      t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+    new_offsets[0] = 0;
+    new_offsets[mpisize] = forest_from->global_num_elements;
+    for (i = 1; i < mpisize; i++) {
+      T8_ASSERT (lower_offsets[i] <= upper_offsets[i]);
+      if (node_first == NULL || node_first[i]) {
+        new_offsets[i] = SC_MIN (SC_MAX (old_offsets[i], lower_offsets[i]),
+                                 upper_offsets[i]);
+      }
+    }
+    T8_FREE (lower_offsets);
+    T8_FREE (upper_offsets);
+    if (node_first != NULL) {
+      /* Restrict the boundaries within each node to the range of the node */
+      for (node_begin = 0; node_begin < mpisize; node_begin = node_end) {
+        for (node_end = node_begin + 1;
+             node_end < mpisize && !node_first[node_end]; node_end++) {
+        }
+        for (i = node_begin + 1; i < node_end; i++) {
+          new_offsets[i] = SC_MIN (SC_MAX (new_offsets[i],
+                                           new_offsets[node_begin]),
+                                   new_offsets[node_end]);
+        }
+      }
+      T8_FREE (node_first);
+    }
+  }
+  else {
+    t8_forest_partition_target_offsets (forest, new_offsets, 0);
+  }
+  if (forest->profile != NULL && forest->set_partition_cost_model != NULL) {
+    forest->profile->partition_imbalance =
+      t8_forest_cost_model_get_imbalance (forest->set_partition_cost_model);
+  }
+  if (forest->set_for_coarsening && mpisize > 1
+      && forest->set_partition_offsets == NULL) {
+    t8_forest_partition_for_coarsening (forest, new_offsets);
+  }
+  if (t8_shmem_array_start_writing (forest->element_offsets)) {
+    for (i = 0; i <= mpisize; i++) {
+      T8_ASSERT (i == 0 || new_offsets[i - 1] <= new_offsets[i]);
+      t8_shmem_array_set_gloidx (forest->element_offsets, i, new_offsets[i]);
+    }
+  }
+  t8_shmem_array_end_writing (forest->element_offsets);
+  T8_FREE (new_offsets);
 }
 
 /* Find the owner of a given element.
@@ -486,6 +1013,63 @@ t8_forest_partition_tree_first_last_el (t8_tree_t tree,
   return 0;
 }
 
+/* Return true if the elements of the tree_index-th tree of a message that
+ * a process sends to itself are left out of the message, since the new
+ * forest shares them with forest_from.
+ * This is the case for all trees whose elements are sent completely,
+ * except for the first tree of the message, whose elements may be appended
+ * to the elements of the same tree received from a smaller rank. */
+static int
+t8_forest_partition_tree_is_kept (int to_self, int tree_index,
+                                  t8_locidx_t num_elements, t8_tree_t tree)
+{
+  return to_self && tree_index > 0 && num_elements ==
+    (t8_locidx_t) t8_element_array_get_count (&tree->elements);
+}
+
+/* Return the number of bytes of the user data entries of one element
+ * that are shipped with the elements.
+ * For variable-size data, we ship the number of entries of the element.
+ * partition_data is either NULL or an array of t8_forest_partition_data_t */
+static size_t
+t8_forest_partition_data_entry_size (const sc_array_t * partition_data)
+{
+  size_t              idata, entry_size = 0;
+  t8_forest_partition_data_t *data;
+
+  if (partition_data == NULL) {
+    return 0;
+  }
+  for (idata = 0; idata < partition_data->elem_count; idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index ((sc_array_t *) partition_data, idata);
+    entry_size += data->offsets_in != NULL ? sizeof (size_t) :
+      data->data_in->elem_size;
+  }
+  return entry_size;
+}
+
+/* Return the number of variable-size arrays in partition_data.
+ * partition_data is either NULL or an array of t8_forest_partition_data_t */
+static int
+t8_forest_partition_data_num_variable (const sc_array_t * partition_data)
+{
+  size_t              idata;
+  int                 num_variable = 0;
+
+  if (partition_data == NULL) {
+    return 0;
+  }
+  for (idata = 0; idata < partition_data->elem_count; idata++) {
+    if (((t8_forest_partition_data_t *)
+         sc_array_index ((sc_array_t *) partition_data,
+                         idata))->offsets_in != NULL) {
+      num_variable++;
+    }
+  }
+  return num_variable;
+}
+
 /* Fill the send buffers for one send operation.
  * \param [in]  forest_from     The original forest
  * \param [in]  send_buffer     Unallocated send_buffer
@@ -495,10 +1079,19 @@ t8_forest_partition_tree_first_last_el (t8_tree_t tree,
  *                              we would send elements from to the next process.
  * \param [in]  first_element_send The local id of the first element that we need to send.
  * \param [in]  last_element_send The local id of the last element that we need to send.
+ * \param [in]  partition_data  NULL or an array of t8_forest_partition_data_t,
+ *                              whose entries are sent with the elements.
+ * \param [in]  compress        If true, the elements are encoded with
+ *                              t8_element_array_encode.
+ * \param [in]  to_self         If true, the message is sent to this process
+ *                              and the elements of the trees that the new
+ *                              forest shares with forest_from are left out,
+ *                              see t8_forest_partition_tree_is_kept.
  */
 /* The send buffer will look like this:
  *
  * | number of trees | padding | tree_1 info | ... | tree_n info | tree_1 elements | ... | tree_n elements |
+ * | data_1 entries | ... | data_m entries |
  */
 /* If send_data is true, data must be an array of length forest_from->num_local elements
  * and instead of shipping the elements of forest_from, we ship the data entries. */
@@ -507,7 +1100,9 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
                                  char **send_buffer, int *buffer_alloc,
                                  t8_locidx_t * current_tree,
                                  t8_locidx_t first_element_send,
-                                 t8_locidx_t last_element_send)
+                                 t8_locidx_t last_element_send,
+                                 const sc_array_t * partition_data,
+                                 int compress, int to_self)
 {
   t8_locidx_t         num_elements_send;
   t8_tree_t           tree;
@@ -518,7 +1113,9 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
   t8_forest_partition_tree_info_t *tree_info;
   t8_locidx_t        *pnum_trees_send;
   void               *pfirst_element;
-  size_t              elem_size;
+  size_t              elem_size, idata, data_bytes;
+  const size_t       *offsets;
+  t8_forest_partition_data_t *data;
 
   current_element = first_element_send;
   tree_id = *current_tree;
@@ -535,14 +1132,15 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
                                               *current_tree,
                                               &first_tree_element,
                                               &last_tree_element);
-    SC_CHECK_ABORT (tree->eclass != T8_ECLASS_PYRAMID,
-                    "Forest partition"
-                    " is not implement for pyramidal elements.");
     /* We now know how many elements this tree will send */
     num_elements_send = last_tree_element - first_tree_element + 1;
     T8_ASSERT (num_elements_send > 0);
-    elem_size = t8_element_array_get_size (&tree->elements);
-    element_alloc += num_elements_send * elem_size;
+    elem_size = compress ? T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES :
+      t8_element_array_get_size (&tree->elements);
+    if (!t8_forest_partition_tree_is_kept (to_self, num_trees_send,
+                                           num_elements_send, tree)) {
+      element_alloc += num_elements_send * elem_size;
+    }
     current_element += num_elements_send;
     num_trees_send++;
     tree_id++;
@@ -559,8 +1157,11 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
   byte_alloc += num_trees_send * sizeof (t8_forest_partition_tree_info_t);
   /* Store the position of the first element in the buffer */
   element_pos = byte_alloc;
-  /* and the bytes for each tree's elements */
+  /* the bytes for each tree's elements */
   byte_alloc += element_alloc;
+  /* and the bytes for the user data of the elements */
+  byte_alloc += t8_forest_partition_data_entry_size (partition_data)
+    * (last_element_send - first_element_send + 1);
   /* Note, that we do not add padding after the info structs and
    * each tree's elements, since these are multiples of structs and
    * structs are padded correctly */
@@ -592,7 +1193,19 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
       forest_from->first_local_tree;
     tree_info->num_elements = num_elements_send;
     tree_info_pos += sizeof (t8_forest_partition_tree_info_t);
+    if (t8_forest_partition_tree_is_kept (to_self, tree_id,
+                                          num_elements_send, tree)) {
+      /* The new forest shares the elements of this tree */
+      continue;
+    }
     /* We can now fill the send buffer with all elements of that tree */
+    if (compress) {
+      element_pos +=
+        t8_element_array_encode (&tree->elements, first_tree_element,
+                                 num_elements_send, forest_from->maxlevel,
+                                 *send_buffer + element_pos);
+      continue;
+    }
     pfirst_element =
       t8_element_array_index_locidx (&tree->elements, first_tree_element);
     elem_size = t8_element_array_get_size (&tree->elements);
@@ -600,6 +1213,39 @@ t8_forest_partition_fill_buffer (t8_forest_t forest_from,
             num_elements_send * elem_size);
     element_pos += num_elements_send * elem_size;
   }
+  if (partition_data != NULL) {
+    /* Append the user data entries of the elements */
+    for (idata = 0; idata < partition_data->elem_count; idata++) {
+      data = (t8_forest_partition_data_t *)
+        sc_array_index ((sc_array_t *) partition_data, idata);
+      if (data->offsets_in != NULL) {
+        /* Variable-size data, we ship the number of entries of each element */
+        for (current_element = first_element_send;
+             current_element <= last_element_send; current_element++) {
+          offsets = (const size_t *)
+            sc_array_index ((sc_array_t *) data->offsets_in,
+                            current_element);
+          data_bytes = offsets[1] - offsets[0];
+          /* The buffer position may not be aligned, thus we use memcpy */
+          memcpy (*send_buffer + element_pos, &data_bytes, sizeof (size_t));
+          element_pos += sizeof (size_t);
+        }
+        continue;
+      }
+      data_bytes = (last_element_send - first_element_send + 1)
+        * data->data_in->elem_size;
+      memcpy (*send_buffer + element_pos,
+              sc_array_index ((sc_array_t *) data->data_in,
+                              first_element_send), data_bytes);
+      element_pos += data_bytes;
+    }
+  }
+  T8_ASSERT (compress ? element_pos <= byte_alloc : element_pos == byte_alloc);
+  if (element_pos < byte_alloc) {
+    /* Free the unused upper bound of the encoded elements */
+    *send_buffer = T8_REALLOC (*send_buffer, char, element_pos);
+    byte_alloc = element_pos;
+  }
   *current_tree += num_trees_send - 1 + last_element_is_last_tree_element;
   *buffer_alloc = byte_alloc;
   t8_debugf ("Post send of %i trees\n", num_trees_send);
@@ -640,24 +1286,318 @@ t8_forest_partition_fill_buffer_data (t8_forest_t forest_from,
   memcpy (*send_buffer, data_entry, *buffer_alloc);
 }
 
+/* Compute the local ids of the first and last element of forest->set_from
+ * that we send to iproc in the new partition of forest.
+ * Returns the number of elements that we send to iproc. */
+static              t8_locidx_t
+t8_forest_partition_send_elements (t8_forest_t forest, const int iproc,
+                                   const int send_first, const int send_last,
+                                   t8_locidx_t * first_element_send,
+                                   t8_locidx_t * last_element_send)
+{
+  t8_gloidx_t        *offset_to, *offset_from;
+  t8_gloidx_t         gfirst_local_element;
+  t8_locidx_t         num_elements_send;
+
+  offset_to = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest->set_from->element_offsets);
+  /* The global id of the current first local element */
+  gfirst_local_element = offset_from[forest->mpirank];
+  if (iproc == send_first) {
+    /* If this is the first process we send to, the first element we send is
+     * our very first element */
+    *first_element_send = 0;
+  }
+  else {
+    /* Otherwise, the first element we send is the new first element on the
+     * process */
+    *first_element_send = offset_to[iproc] - gfirst_local_element;
+    /* assert for overflow error */
+    T8_ASSERT ((t8_gloidx_t) * first_element_send ==
+               offset_to[iproc] - gfirst_local_element);
+  }
+  if (iproc == send_last) {
+    /* To the last process we send all our remaining elements */
+    *last_element_send = forest->set_from->local_num_elements - 1;
+  }
+  else {
+    /* Otherwise, the last element we send to proc is the last
+     * element on proc in the new partition. */
+    *last_element_send = offset_to[iproc + 1] - 1 - gfirst_local_element;
+  }
+  num_elements_send = *last_element_send - *first_element_send + 1;
+  return SC_MAX (num_elements_send, 0);
+}
+
+/* Return the number of messages in which we ship num_elements elements
+ * to another process. */
+static int
+t8_forest_partition_num_chunks (t8_locidx_t num_elements)
+{
+  return (num_elements + T8_FOREST_PARTITION_CHUNK_ELEMENTS - 1)
+    / T8_FOREST_PARTITION_CHUNK_ELEMENTS;
+}
+
+/* For the variable-size arrays of forest->set_partition_data, compute the
+ * global index of the first payload entry at each process boundary of the
+ * old and the new partition.
+ * For the i-th variable-size array, the returned array stores at
+ * position 2 * i * (mpisize + 1) + p the index at the old boundary of
+ * process p and at position (2 * i + 1) * (mpisize + 1) + p the index at
+ * the new boundary of process p.
+ * Each process knows the payload offsets of its own elements, thus it fills
+ * the entries of the boundaries in its range and one Allreduce combines them.
+ */
+static t8_gloidx_t *
+t8_forest_partition_payload_offsets (t8_forest_t forest, int num_variable)
+{
+  t8_forest_t         forest_from = forest->set_from;
+  t8_gloidx_t        *offset_from, *offset_to;
+  t8_gloidx_t        *local_count, *first_payload;
+  t8_gloidx_t        *boundaries, *payload_offsets, *old_bounds, *new_bounds;
+  t8_gloidx_t         first_local;
+  t8_locidx_t         num_local;
+  t8_forest_partition_data_t *data;
+  size_t              idata;
+  int                 ivar, iproc, mpiret, num_entries;
+
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  offset_to = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  first_local = offset_from[forest->mpirank];
+  num_local = forest_from->local_num_elements;
+  num_entries = 2 * num_variable * (forest->mpisize + 1);
+
+  /* Compute the index of our first payload entry of each array */
+  local_count = T8_ALLOC (t8_gloidx_t, num_variable);
+  first_payload = T8_ALLOC (t8_gloidx_t, num_variable);
+  for (idata = 0, ivar = 0; idata < forest->set_partition_data->elem_count;
+       idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index (forest->set_partition_data, idata);
+    if (data->offsets_in == NULL) {
+      continue;
+    }
+    T8_ASSERT (data->offsets_in->elem_count == (size_t) num_local + 1);
+    T8_ASSERT (*(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                           0) == 0);
+    local_count[ivar] =
+      *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                  num_local);
+    T8_ASSERT ((size_t) local_count[ivar] == data->data_in->elem_count);
+    ivar++;
+  }
+  mpiret = sc_MPI_Scan (local_count, first_payload, num_variable,
+                        T8_MPI_GLOIDX, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Fill the boundaries in our range, all others are set to 0 */
+  boundaries = T8_ALLOC_ZERO (t8_gloidx_t, num_entries);
+  for (idata = 0, ivar = 0; idata < forest->set_partition_data->elem_count;
+       idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index (forest->set_partition_data, idata);
+    if (data->offsets_in == NULL) {
+      continue;
+    }
+    /* MPI_Scan is inclusive, thus we subtract our own count */
+    first_payload[ivar] -= local_count[ivar];
+    old_bounds = boundaries + 2 * ivar * (forest->mpisize + 1);
+    new_bounds = old_bounds + forest->mpisize + 1;
+    old_bounds[forest->mpirank] = first_payload[ivar];
+    if (forest->mpirank == forest->mpisize - 1) {
+      old_bounds[forest->mpisize] = first_payload[ivar] + local_count[ivar];
+    }
+    for (iproc = 0; iproc <= forest->mpisize; iproc++) {
+      if (first_local <= offset_to[iproc]
+          && offset_to[iproc] <= first_local + num_local) {
+        new_bounds[iproc] = first_payload[ivar] +
+          *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                      offset_to[iproc] - first_local);
+      }
+    }
+    ivar++;
+  }
+  payload_offsets = T8_ALLOC (t8_gloidx_t, num_entries);
+  mpiret = sc_MPI_Allreduce (boundaries, payload_offsets, num_entries,
+                             T8_MPI_GLOIDX, sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (local_count);
+  T8_FREE (first_payload);
+  T8_FREE (boundaries);
+  return payload_offsets;
+}
+
+/* Compute the global indices of the first and one after the last payload
+ * entry of the i-th variable-size array that we receive from proc. */
+static void
+t8_forest_partition_payload_range (t8_forest_t forest,
+                                   const t8_gloidx_t * payload_offsets,
+                                   int ivar, int proc, t8_gloidx_t * first,
+                                   t8_gloidx_t * end)
+{
+  t8_gloidx_t        *offset_from, *offset_to;
+  const t8_gloidx_t  *old_bounds, *new_bounds;
+
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest->set_from->element_offsets);
+  offset_to = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+  old_bounds = payload_offsets + 2 * ivar * (forest->mpisize + 1);
+  new_bounds = old_bounds + forest->mpisize + 1;
+  /* The range starts and ends either at a boundary of the old or of
+   * the new partition */
+  *first = offset_from[proc] >= offset_to[forest->mpirank] ?
+    old_bounds[proc] : new_bounds[forest->mpirank];
+  *end = offset_from[proc + 1] <= offset_to[forest->mpirank + 1] ?
+    old_bounds[proc + 1] : new_bounds[forest->mpirank + 1];
+  T8_ASSERT (*first <= *end);
+}
+
+/* Return the number of payload bytes that we receive from proc */
+static int
+t8_forest_partition_payload_bytes (t8_forest_t forest,
+                                   const t8_gloidx_t * payload_offsets,
+                                   int proc)
+{
+  t8_forest_partition_data_t *data;
+  t8_gloidx_t         first, end;
+  size_t              idata, bytes = 0;
+  int                 ivar;
+
+  for (idata = 0, ivar = 0; idata < forest->set_partition_data->elem_count;
+       idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index (forest->set_partition_data, idata);
+    if (data->offsets_in == NULL) {
+      continue;
+    }
+    t8_forest_partition_payload_range (forest, payload_offsets, ivar++, proc,
+                                       &first, &end);
+    bytes += (end - first) * data->data_out->elem_size;
+  }
+  return bytes;
+}
+
+/* Copy the payload that we receive from proc into the data_out arrays of
+ * the variable-size arrays of forest->set_partition_data.
+ * If proc is this process, the payload is copied directly from the data_in
+ * arrays and buffer is ignored. Otherwise, buffer is the payload message
+ * sent in sendloop. */
+static void
+t8_forest_partition_insert_payload (t8_forest_t forest,
+                                    const t8_gloidx_t * payload_offsets,
+                                    int proc, const char *buffer)
+{
+  t8_forest_partition_data_t *data;
+  t8_gloidx_t         first, end, first_new, first_old;
+  size_t              idata, bytes, cursor = 0;
+  int                 ivar;
+
+  for (idata = 0, ivar = 0; idata < forest->set_partition_data->elem_count;
+       idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index (forest->set_partition_data, idata);
+    if (data->offsets_in == NULL) {
+      continue;
+    }
+    t8_forest_partition_payload_range (forest, payload_offsets, ivar, proc,
+                                       &first, &end);
+    /* The first payload entry of the new and the old partition */
+    first_new = payload_offsets[(2 * ivar + 1) * (forest->mpisize + 1)
+                                + forest->mpirank];
+    first_old = payload_offsets[2 * ivar * (forest->mpisize + 1)
+                                + forest->mpirank];
+    ivar++;
+    if (end == first) {
+      continue;
+    }
+    bytes = (end - first) * data->data_out->elem_size;
+    if (proc == forest->mpirank) {
+      memcpy (sc_array_index (data->data_out, first - first_new),
+              sc_array_index ((sc_array_t *) data->data_in,
+                              first - first_old), bytes);
+    }
+    else {
+      memcpy (sc_array_index (data->data_out, first - first_new),
+              buffer + cursor, bytes);
+      cursor += bytes;
+    }
+  }
+}
+
+/* Fill the buffer of the payload message of the variable-size arrays
+ * in partition_data for the elements first_element_send, ...,
+ * last_element_send of forest_from. */
+static void
+t8_forest_partition_fill_payload (const sc_array_t * partition_data,
+                                  char **send_buffer, int *buffer_alloc,
+                                  t8_locidx_t first_element_send,
+                                  t8_locidx_t last_element_send)
+{
+  t8_forest_partition_data_t *data;
+  size_t              idata, first, end, bytes, cursor;
+
+  /* Compute the number of bytes */
+  bytes = 0;
+  for (idata = 0; idata < partition_data->elem_count; idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index ((sc_array_t *) partition_data, idata);
+    if (data->offsets_in != NULL) {
+      first = *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                          first_element_send);
+      end = *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                        last_element_send + 1);
+      bytes += (end - first) * data->data_in->elem_size;
+    }
+  }
+  *buffer_alloc = bytes;
+  *send_buffer = T8_ALLOC (char, bytes);
+  /* Copy the payload */
+  cursor = 0;
+  for (idata = 0; idata < partition_data->elem_count; idata++) {
+    data = (t8_forest_partition_data_t *)
+      sc_array_index ((sc_array_t *) partition_data, idata);
+    if (data->offsets_in != NULL) {
+      first = *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                          first_element_send);
+      end = *(size_t *) sc_array_index ((sc_array_t *) data->offsets_in,
+                                        last_element_send + 1);
+      if (end > first) {
+        memcpy (*send_buffer + cursor,
+                sc_array_index ((sc_array_t *) data->data_in, first),
+                (end - first) * data->data_in->elem_size);
+        cursor += (end - first) * data->data_in->elem_size;
+      }
+    }
+  }
+  T8_ASSERT (cursor == bytes);
+}
+
 /* Carry out all sending of elements */
 /* If send_data is true, the elements are not send but element data
  * stored in an sc_array of length forest->set_from->num_local_elements.
- * Returns true if we sent to ourselves. */
+ * Elements sent to another process are split into chunks of at most
+ * T8_FOREST_PARTITION_CHUNK_ELEMENTS elements, each chunk is sent as
+ * a separate message. Data and the elements to ourselves are not split.
+ * The payload of variable-size user data follows in one more message.
+ * On output, num_request_alloc is the number of messages, which is the
+ * length of requests and send_buffer.
+ * Returns true if we sent to ourselves, in which case sent_to_self is
+ * the buffer of this message and byte_to_self its size. */
 static int
 t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
                               const int send_last, sc_MPI_Request ** requests,
                               int *num_request_alloc, char ***send_buffer,
                               const int send_data, const sc_array_t * data_in,
-                              size_t * byte_to_self)
+                              char **sent_to_self, size_t * byte_to_self)
 {
-  int                 iproc, mpiret;
-  t8_gloidx_t         gfirst_element_send, glast_element_send;
-  t8_gloidx_t         gfirst_local_element;
+  int                 iproc, mpiret, imessage, ichunk, num_chunks;
+  int                 num_variable;
   t8_locidx_t         first_element_send, last_element_send;
+  t8_locidx_t         first_chunk_element, last_chunk_element;
   t8_locidx_t         current_tree;
   t8_locidx_t         num_elements_send;
-  t8_gloidx_t        *offset_to, *offset_from;
   t8_forest_t         forest_from;
   char              **buffer;
   int                 buffer_alloc;
@@ -678,117 +1618,134 @@ t8_forest_partition_sendloop (t8_forest_t forest, const int send_first,
              (size_t) forest_from->local_num_elements);
 
   comm = forest->mpicomm;
-  /* Determine the number of requests for MPI communication. */
-  *num_request_alloc = send_last - send_first + 1;
-  if (*num_request_alloc < 0) {
-    /* If there are no processes to send to, this value could get
-     * negative */
-    *num_request_alloc = 0;
-    T8_ASSERT (send_last - send_first + 1 == 0);
+  num_variable = send_data ? 0 :
+    t8_forest_partition_data_num_variable (forest->set_partition_data);
+  /* Determine the number of requests for MPI communication.
+   * We use one request for each process, except for the processes
+   * to which we send in several chunks, and one request for the payload
+   * of variable-size data. */
+  *num_request_alloc = 0;
+  for (iproc = send_first; iproc <= send_last; iproc++) {
+    num_elements_send =
+      t8_forest_partition_send_elements (forest, iproc, send_first,
+                                         send_last, &first_element_send,
+                                         &last_element_send);
+    if (!send_data && iproc != forest->mpirank && num_elements_send > 0) {
+      *num_request_alloc += t8_forest_partition_num_chunks (num_elements_send)
+        + (num_variable > 0);
+    }
+    else {
+      *num_request_alloc += 1;
+    }
   }
   *requests = T8_ALLOC (sc_MPI_Request, *num_request_alloc);
 
   /* Allocate memory for pointers to the send buffers */
   /* We allocate zero in order to set unused pointers to NULL so that
    * we can pass them to free */
-  *send_buffer = T8_ALLOC_ZERO (char *, send_last - send_first + 1);
-
-  /* Get the new and old offset array */
-  offset_to = t8_shmem_array_get_gloidx_array (forest->element_offsets);
-  offset_from =
-    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  *send_buffer = T8_ALLOC_ZERO (char *, *num_request_alloc);
 
-  /* Compute the global id of the current first local element */
-  gfirst_local_element = offset_from[forest->mpirank];
   /* loop over all processes that we send to */
+  imessage = 0;
+  current_tree = 0;
   for (iproc = send_first; iproc <= send_last; iproc++) {
     /* At first, we compute the local index of the first and last element
      * that we send to proc */
-    if (iproc == send_first) {
-      /* If this is the first process we send to, the first element we send is
-       * our very first element */
-      first_element_send = 0;
-      current_tree = 0;
-    }
-    else {
-      /* Otherwise, the first element we send is the new first element on the
-       * process */
-      gfirst_element_send = offset_to[iproc];
-      first_element_send = gfirst_element_send - gfirst_local_element;
-      /* assert for overflow error */
-      T8_ASSERT ((t8_gloidx_t) first_element_send ==
-                 gfirst_element_send - gfirst_local_element);
-    }
-    if (iproc == send_last) {
-      /* To the last process we send all our remaining elements */
-      last_element_send = forest_from->local_num_elements - 1;
-    }
-    else {
-      /* Otherwise, the last element we send to proc is the last
-       * element on proc in the new partition. */
-      glast_element_send = offset_to[iproc + 1] - 1;
-      last_element_send = glast_element_send - gfirst_local_element;
-    }
-    num_elements_send = last_element_send - first_element_send + 1;
-    if (num_elements_send < 0) {
-      num_elements_send = 0;
+    num_elements_send =
+      t8_forest_partition_send_elements (forest, iproc, send_first,
+                                         send_last, &first_element_send,
+                                         &last_element_send);
+    if (num_elements_send == 0) {
+      /* We do not send any elements to iproc (iproc is empty in new partition) */
+      /* Set the request to NULL, such that it is ignored when we wait for
+       * the requests to complete */
+      (*requests)[imessage++] = sc_MPI_REQUEST_NULL;
+      continue;
     }
     /* We now know the local indices of the first and last element that
      * we send to proc. */
-    buffer = *send_buffer + iproc - send_first;
-    if (num_elements_send > 0) {
-      if (iproc == forest->mpirank) {
-        to_self = 1;
-      }
+    if (iproc == forest->mpirank) {
+      to_self = 1;
+    }
+    num_chunks = send_data || iproc == forest->mpirank ? 1 :
+      t8_forest_partition_num_chunks (num_elements_send);
+    for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+      first_chunk_element = first_element_send
+        + ichunk * T8_FOREST_PARTITION_CHUNK_ELEMENTS;
+      last_chunk_element = num_chunks == 1 ? last_element_send :
+        SC_MIN (last_element_send, first_chunk_element
+                + T8_FOREST_PARTITION_CHUNK_ELEMENTS - 1);
+      buffer = *send_buffer + imessage;
       if (!send_data) {
         /* Fill the buffer with the elements and calculate the next tree
          * from which to send elements */
         t8_forest_partition_fill_buffer (forest_from,
                                          buffer, &buffer_alloc,
-                                         &current_tree, first_element_send,
-                                         last_element_send);
+                                         &current_tree, first_chunk_element,
+                                         last_chunk_element,
+                                         forest->set_partition_data,
+                                         forest->compress_messages > 0,
+                                         iproc == forest->mpirank);
       }
       else {
         T8_ASSERT (send_data);
         /* We are in send data mode. Fill the send buffer with the data */
         t8_forest_partition_fill_buffer_data (forest_from, buffer,
                                               &buffer_alloc,
-                                              first_element_send,
-                                              last_element_send, data_in);
+                                              first_chunk_element,
+                                              last_chunk_element, data_in);
       }
-      /* Post the MPI Send.
-       * TODO: This will also send to ourselves if proc==mpirank */
+      /* Post the MPI Send. */
       if (iproc != forest->mpirank) {
         t8_debugf ("Post send of %li elements (%i bytes) to process %i\n",
-                   (long) num_elements_send, buffer_alloc, iproc);
+                   (long) (last_chunk_element - first_chunk_element + 1),
+                   buffer_alloc, iproc);
         mpiret = sc_MPI_Isend (*buffer, buffer_alloc, sc_MPI_BYTE, iproc,
                                T8_MPI_PARTITION_FOREST, comm,
-                               *requests + iproc - send_first);
+                               *requests + imessage);
         SC_CHECK_MPI (mpiret);
+        if (!send_data && forest->profile != NULL) {
+          /* If profiling is enabled we count the bytes that we send */
+          forest->profile->partition_bytes_sent += buffer_alloc;
+          t8_forest_profile_add_bytes (forest, T8_PROFILE_PHASE_PARTITION_PACK,
+                                       buffer_alloc);
+        }
       }
       else {
+        *sent_to_self = *buffer;
         *byte_to_self = buffer_alloc;
-        *(*requests + iproc - send_first) = sc_MPI_REQUEST_NULL;
+        (*requests)[imessage] = sc_MPI_REQUEST_NULL;
       }
-      if (!send_data && forest->profile != NULL) {
-        if (iproc != forest->mpirank) {
-          /* If profiling is enabled we count the number of elements sent to
-           * other processes */
-          forest->profile->partition_elements_shipped += num_elements_send;
-          /* The number of procs we send to */
-          forest->profile->partition_procs_sent += 1;
-          /* The number of bytes that we send */
-          forest->profile->partition_bytes_sent += buffer_alloc;
-        }
+      imessage++;
+    }
+    if (num_variable > 0 && iproc != forest->mpirank) {
+      /* Send the payload of the variable-size data after the elements */
+      buffer = *send_buffer + imessage;
+      t8_forest_partition_fill_payload (forest->set_partition_data, buffer,
+                                        &buffer_alloc, first_element_send,
+                                        last_element_send);
+      mpiret = sc_MPI_Isend (*buffer, buffer_alloc, sc_MPI_BYTE, iproc,
+                             T8_MPI_PARTITION_FOREST, comm,
+                             *requests + imessage);
+      SC_CHECK_MPI (mpiret);
+      if (forest->profile != NULL) {
+        forest->profile->partition_bytes_sent += buffer_alloc;
+        t8_forest_profile_add_bytes (forest, T8_PROFILE_PHASE_PARTITION_PACK,
+                                     buffer_alloc);
       }
+      imessage++;
     }
-    else {
-      /* We do not send any elements to iproc (iproc is empty in new partition) */
-      /* Set the request to NULL, such that it is ignored when we wait for
-       * the requests to complete */
-      *(*requests + iproc - send_first) = sc_MPI_REQUEST_NULL;
+    if (!send_data && forest->profile != NULL) {
+      if (iproc != forest->mpirank) {
+        /* If profiling is enabled we count the number of elements sent to
+         * other processes */
+        forest->profile->partition_elements_shipped += num_elements_send;
+        /* The number of procs we send to */
+        forest->profile->partition_procs_sent += 1;
+      }
     }
   }
+  T8_ASSERT (imessage == *num_request_alloc);
   t8_debugf ("End send loop\n");
   return to_self;
 }
@@ -865,61 +1822,35 @@ t8_forest_partition_recv_message_data (t8_forest_t forest, sc_MPI_Comm comm,
   }
 }
 
-/* Receive a message send in sendloop to this rank.
+/* Insert the trees and elements of a message sent in sendloop into
+ * forest->trees.
  * \param [in]  forest      The new forest.
- * \param [in]  comm        The MPI communicator.
- * \param [in]  proc        The rank from which we receive.
- * \param [in]  status      MPI status with which we probed for the message.
- * \param [in]  prev_recvd  The count of messages that we already received.
- * \param [in]  sent_to_self If proc equals the rank of this process, the message
- *                          should be passed as this parameter.
- * \param [in]  byte_to_self If proc equals the rank of this process, the number of
- *                          bytes in the message.
- * It is important, that we receive the messages in order to properly fill the
- * forest->trees array.
+ * \param [in]  proc        The rank from which we received.
+ * \param [in]  prev_recvd  The count of messages that we already inserted.
+ * \param [in]  recv_buffer The message.
+ * \param [in]  recv_bytes  The number of bytes in the message.
+ * It is important, that we insert the messages in order to properly fill the
+ * forest->trees array and the arrays of forest->set_partition_data.
  */
 static void
-t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
-                                  int proc, sc_MPI_Status * status,
-                                  int prev_recvd, char *sent_to_self,
-                                  size_t byte_to_self)
+t8_forest_partition_insert_message (t8_forest_t forest, int proc,
+                                    int prev_recvd, char *recv_buffer,
+                                    int recv_bytes)
 {
-  int                 mpiret;
-  int                 recv_bytes;
-  char               *recv_buffer;
   t8_locidx_t         num_trees, itree;
-  t8_locidx_t         num_elements_recv;
+  t8_locidx_t         num_elements_recv, first_new_local;
+  t8_forest_partition_data_t *data;
+  size_t              idata, data_bytes;
   t8_locidx_t         old_num_elements, new_num_elements;
   size_t              tree_cursor, element_cursor;
   t8_forest_partition_tree_info_t *tree_info;
-  t8_tree_t           tree, last_tree;
+  t8_tree_t           tree, last_tree, fromtree;
   size_t              element_size;
   void               *first_new_element;
   t8_eclass_scheme_c *eclass_scheme;
 
-  if (proc != forest->mpirank) {
-    T8_ASSERT (proc == status->MPI_SOURCE);
-    T8_ASSERT (status->MPI_TAG == T8_MPI_PARTITION_FOREST);
-    /* Get the number of bytes to receive */
-    mpiret = sc_MPI_Get_count (status, sc_MPI_BYTE, &recv_bytes);
-    SC_CHECK_MPI (mpiret);
-  }
-  t8_debugf ("Receiving message of %i bytes from process %i\n", recv_bytes,
+  t8_debugf ("Inserting message of %i bytes from process %i\n", recv_bytes,
              proc);
-
-  if (proc != forest->mpirank) {
-    /* allocate the receive buffer */
-    recv_buffer = T8_ALLOC (char, recv_bytes);
-    /* receive the message */
-    mpiret = sc_MPI_Recv (recv_buffer, recv_bytes, sc_MPI_BYTE, proc,
-                          T8_MPI_PARTITION_FOREST, comm,
-                          sc_MPI_STATUS_IGNORE);
-    SC_CHECK_MPI (mpiret);
-  }
-  else {
-    recv_buffer = sent_to_self;
-    recv_bytes = byte_to_self;
-  }
   /* Read the number of trees, it is the first locidx_t in recv_buffer */
   num_trees = *(t8_locidx_t *) recv_buffer;
   /* Set the tree cursor to the first tree info entry in recv_buffer */
@@ -937,6 +1868,7 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
     forest->last_local_tree = tree_info->gtree_id - 1;
   }
   num_elements_recv = 0;
+  first_new_local = forest->local_num_elements;
   for (itree = 0; itree < num_trees; itree++) {
     num_elements_recv += tree_info->num_elements;
     T8_ASSERT (tree_info->gtree_id >= forest->last_local_tree);
@@ -944,6 +1876,9 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
       /* We will insert a new tree in the forest */
       tree = (t8_tree_t) sc_array_push (forest->trees);
       tree->eclass = tree_info->eclass;
+      tree->packed_elements = NULL;
+      tree->num_packed_elements = 0;
+      tree->shared = NULL;
       /* Calculate the element offset of the new tree */
       if (forest->last_local_tree >= forest->first_local_tree) {
         /* If there is a previous tree, we read it */
@@ -966,14 +1901,46 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
       eclass_scheme =
         t8_forest_get_eclass_scheme (forest->set_from, tree->eclass);
       element_size = eclass_scheme->t8_element_size ();
-      /* initialize the elements array and copy the elements from the receive buffer */
-      T8_ASSERT (element_cursor + tree_info->num_elements * element_size <=
-                 (size_t) recv_bytes);
-      t8_debugf ("[H} init array for tree %i\n", itree);
-      t8_element_array_init_copy (&tree->elements, eclass_scheme,
-                                  (t8_element_t *) (recv_buffer +
-                                                    element_cursor),
-                                  tree_info->num_elements);
+      fromtree = proc != forest->mpirank ? NULL :
+        t8_forest_get_tree (forest->set_from, tree_info->gtree_id
+                            - forest->set_from->first_local_tree);
+      if (fromtree != NULL
+          && t8_forest_partition_tree_is_kept (1, itree,
+                                               tree_info->num_elements,
+                                               fromtree)) {
+        /* The tree stays on this process unchanged, we share its elements
+         * with forest_from. They are not in the message. */
+        if (!t8_forest_tree_share_elements (tree, fromtree)) {
+          t8_element_array_init_size (&tree->elements, eclass_scheme,
+                                      tree_info->num_elements);
+          t8_element_array_copy (&tree->elements, &fromtree->elements);
+        }
+        element_size = 0;
+      }
+      else {
+        /* initialize the elements array and copy the elements from the
+         * receive buffer */
+        T8_ASSERT (forest->compress_messages > 0
+                   || element_cursor + tree_info->num_elements * element_size
+                   <= (size_t) recv_bytes);
+        t8_debugf ("[H} init array for tree %i\n", itree);
+        if (forest->compress_messages > 0) {
+          t8_element_array_init_size (&tree->elements, eclass_scheme,
+                                      tree_info->num_elements);
+          element_size =
+            t8_element_array_decode (&tree->elements, 0,
+                                     tree_info->num_elements,
+                                     forest->set_from->maxlevel,
+                                     recv_buffer + element_cursor);
+        }
+        else {
+          t8_element_array_init_copy (&tree->elements, eclass_scheme,
+                                      (t8_element_t *) (recv_buffer +
+                                                        element_cursor),
+                                      tree_info->num_elements);
+          element_size *= tree_info->num_elements;
+        }
+      }
 #if 0
       /* Debugging output */
       t8_debugf ("receive %li elements for tree %lli\n",
@@ -994,7 +1961,8 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
       /* Get the old number of elements in the tree and calculate the new number */
       old_num_elements = t8_forest_get_tree_element_count (tree);
       new_num_elements = old_num_elements + tree_info->num_elements;
-      /* Enlarge the elements array */
+      /* Enlarge the elements array, it may be shared with forest_from */
+      t8_forest_tree_unshare_elements (tree);
       t8_element_array_resize (&tree->elements, new_num_elements);
       first_new_element = t8_element_array_index_locidx (&tree->elements,
                                                          old_num_elements);
@@ -1009,25 +1977,56 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
         t8_forest_get_eclass_scheme (forest->set_from, tree->eclass);
       element_size = eclass_scheme->t8_element_size ();
       T8_ASSERT (element_size == t8_element_array_get_size (&tree->elements));
-      /* Copy the elements from the receive buffer to the elements array */
-      memcpy (first_new_element, recv_buffer + element_cursor,
-              tree_info->num_elements * element_size);
+      if (forest->compress_messages > 0) {
+        element_size = t8_element_array_decode (&tree->elements,
+                                                old_num_elements,
+                                                tree_info->num_elements,
+                                                forest->set_from->maxlevel,
+                                                recv_buffer + element_cursor);
+      }
+      else {
+        /* Copy the elements from the receive buffer to the elements array */
+        memcpy (first_new_element, recv_buffer + element_cursor,
+                tree_info->num_elements * element_size);
+        element_size *= tree_info->num_elements;
+      }
     }
 
     /* compute the new number of local elements */
     forest->local_num_elements += tree_info->num_elements;
     /* Set the new last local tree */
     forest->last_local_tree = tree_info->gtree_id;
-    /* advance the element cursor */
-    element_cursor += element_size * tree_info->num_elements;
+    /* advance the element cursor, element_size is now the number of bytes
+     * of the elements of this tree in the message */
+    element_cursor += element_size;
     /* Advance to the next tree_info entry in the recv buffer */
     tree_cursor += sizeof (t8_forest_partition_tree_info_t);
     tree_info += 1;
   }
-
-  if (proc != forest->mpirank) {
-    T8_FREE (recv_buffer);
+  if (forest->set_partition_data != NULL) {
+    /* Copy the user data entries of the received elements */
+    for (idata = 0; idata < forest->set_partition_data->elem_count; idata++) {
+      data = (t8_forest_partition_data_t *)
+        sc_array_index (forest->set_partition_data, idata);
+      if (data->offsets_in != NULL) {
+        /* Variable-size data, we store the number of entries of each
+         * element and compute the offsets when all messages arrived */
+        data_bytes = num_elements_recv * sizeof (size_t);
+        T8_ASSERT (element_cursor + data_bytes <= (size_t) recv_bytes);
+        memcpy (sc_array_index (data->offsets_out, first_new_local + 1),
+                recv_buffer + element_cursor, data_bytes);
+        element_cursor += data_bytes;
+        continue;
+      }
+      data_bytes = num_elements_recv * data->data_out->elem_size;
+      T8_ASSERT (element_cursor + data_bytes <= (size_t) recv_bytes);
+      memcpy (sc_array_index (data->data_out, first_new_local),
+              recv_buffer + element_cursor, data_bytes);
+      element_cursor += data_bytes;
+    }
   }
+  T8_ASSERT (element_cursor == (size_t) recv_bytes);
+
   if (forest->profile != NULL) {
     if (proc != forest->mpirank) {
       /* If profiling is enabled we count the number of elements received from
@@ -1037,17 +2036,290 @@ t8_forest_partition_recv_message (t8_forest_t forest, sc_MPI_Comm comm,
   }
 }
 
+/* Return an upper bound for the number of bytes of a message with
+ * num_elements elements, each of at most max_element_size bytes. */
+static int
+t8_forest_partition_message_bound (t8_locidx_t num_elements,
+                                   size_t max_element_size)
+{
+  size_t              bytes;
+
+  /* The number of trees and padding, ... */
+  bytes = sizeof (t8_locidx_t) + T8_ADD_PADDING (sizeof (t8_locidx_t));
+  /* at most one tree info per element, the elements and their data. */
+  bytes += num_elements * (sizeof (t8_forest_partition_tree_info_t)
+                           + max_element_size);
+  return bytes;
+}
+
+/* Post the receive of the chunk with index ichunk of the
+ * num_chunks messages that we receive from proc.
+ * If payload_offsets is not NULL, the last message is the payload of the
+ * variable-size data, whose size we know exactly. For the element chunks,
+ * the buffer is allocated with an upper bound for the message size. */
+static void
+t8_forest_partition_post_chunk (t8_forest_t forest, int proc,
+                                t8_locidx_t num_elements, int ichunk,
+                                int num_chunks, size_t max_element_size,
+                                const t8_gloidx_t * payload_offsets,
+                                char **buffer, int *bytes,
+                                sc_MPI_Request * request)
+{
+  t8_locidx_t         num_chunk_elements;
+  int                 mpiret;
+
+  if (payload_offsets != NULL && ichunk == num_chunks - 1) {
+    *bytes =
+      t8_forest_partition_payload_bytes (forest, payload_offsets, proc);
+  }
+  else {
+    num_chunk_elements = SC_MIN (T8_FOREST_PARTITION_CHUNK_ELEMENTS,
+                                 num_elements -
+                                 ichunk * T8_FOREST_PARTITION_CHUNK_ELEMENTS);
+    *bytes = t8_forest_partition_message_bound (num_chunk_elements,
+                                                max_element_size);
+  }
+  *buffer = T8_ALLOC (char, *bytes);
+  mpiret = sc_MPI_Irecv (*buffer, *bytes, sc_MPI_BYTE, proc,
+                         T8_MPI_PARTITION_FOREST, forest->mpicomm, request);
+  SC_CHECK_MPI (mpiret);
+}
+
 /* Receive the elements from all processes, we receive from.
- * The message are received in order of the sending rank,
- * since then we can easily build up the new trees array.
+ * Larger messages are sent in chunks, see t8_forest_partition_sendloop.
+ * We post the receives of up to T8_FOREST_PARTITION_CHUNK_WINDOW chunks per
+ * process and process them in the order in which they arrive.
+ * Since the new trees array must be built up in order of the sending ranks,
+ * a received chunk is inserted as soon as all chunks in front of it are
+ * inserted, while the other messages are still in flight.
+ * The receive buffers are allocated with an upper bound for the message size
+ * and shrunk to the actual size when the message has arrived.
+ * If payload_offsets is not NULL, we receive the payload of variable-size
+ * data in one additional message from each other process.
  */
 static void
 t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
-                              int recv_last, const int recv_data,
-                              sc_array_t * data_out, char *sent_to_self,
-                              size_t byte_to_self)
+                              int recv_last, char *sent_to_self,
+                              size_t byte_to_self,
+                              const t8_gloidx_t * payload_offsets)
+{
+  int                 iproc, isource, num_sources, ichunk, num_chunks;
+  int                 islot, num_slots, icompleted, num_completed;
+  int                 insert_source, insert_chunk, prev_recvd;
+  int                 mpiret, eclass;
+  int                *source_proc, *source_num_chunks, *source_first_chunk;
+  int                *source_num_posted, *slot_chunk, *completed;
+  int                *chunk_bytes;
+  char              **chunk_buffer, *chunk_done;
+  t8_locidx_t        *source_num_elements;
+  t8_gloidx_t        *offset_from, *offset_to;
+  t8_gloidx_t         first_recv, last_recv;
+  t8_forest_t         forest_from;
+  sc_MPI_Request     *requests;
+  sc_MPI_Status      *statuses;
+  t8_scheme_cxx_t    *scheme;
+  size_t              max_element_size;
+
+  /* Initial checks and inits */
+  T8_ASSERT (t8_forest_is_initialized (forest));
+  forest_from = forest->set_from;
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  offset_from =
+    t8_shmem_array_get_gloidx_array (forest_from->element_offsets);
+  offset_to = t8_shmem_array_get_gloidx_array (forest->element_offsets);
+
+  /* We do not know the element classes of the received trees, thus we
+   * bound the element size by the size of the largest element */
+  scheme = forest_from->scheme_cxx;
+  max_element_size = 0;
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    if (scheme->eclass_schemes[eclass] != NULL) {
+      max_element_size = SC_MAX (max_element_size,
+                                 scheme->eclass_schemes[eclass]->
+                                 t8_element_size ());
+    }
+  }
+  if (forest->compress_messages > 0) {
+    /* The elements are encoded */
+    max_element_size = T8_ELEMENT_ARRAY_ENCODE_MAX_BYTES;
+  }
+  /* The user data entries are shipped with the elements */
+  max_element_size +=
+    t8_forest_partition_data_entry_size (forest->set_partition_data);
+
+  /* Compute the number of elements and chunks that we receive from each
+   * nonempty rank between recv_first and recv_last */
+  num_sources = recv_last - recv_first + 1;
+  source_proc = T8_ALLOC (int, num_sources);
+  source_num_elements = T8_ALLOC (t8_locidx_t, num_sources);
+  source_num_chunks = T8_ALLOC (int, num_sources);
+  source_first_chunk = T8_ALLOC (int, num_sources + 1);
+  source_num_posted = T8_ALLOC_ZERO (int, num_sources);
+  isource = 0;
+  source_first_chunk[0] = 0;
+  for (iproc = recv_first; iproc <= recv_last; iproc++) {
+    first_recv = SC_MAX (offset_from[iproc], offset_to[forest->mpirank]);
+    last_recv = SC_MIN (offset_from[iproc + 1],
+                        offset_to[forest->mpirank + 1]);
+    if (last_recv <= first_recv) {
+      continue;
+    }
+    source_proc[isource] = iproc;
+    source_num_elements[isource] = last_recv - first_recv;
+    source_num_chunks[isource] = iproc == forest->mpirank ? 1 :
+      t8_forest_partition_num_chunks (source_num_elements[isource])
+      + (payload_offsets != NULL);
+    source_first_chunk[isource + 1] = source_first_chunk[isource]
+      + source_num_chunks[isource];
+    isource++;
+  }
+  num_sources = isource;
+
+  num_chunks = source_first_chunk[num_sources];
+  chunk_buffer = T8_ALLOC_ZERO (char *, num_chunks);
+  chunk_bytes = T8_ALLOC_ZERO (int, num_chunks);
+  chunk_done = T8_ALLOC_ZERO (char, num_chunks);
+  num_slots = num_sources * T8_FOREST_PARTITION_CHUNK_WINDOW;
+  requests = T8_ALLOC (sc_MPI_Request, num_slots);
+  statuses = T8_ALLOC (sc_MPI_Status, num_slots);
+  slot_chunk = T8_ALLOC (int, num_slots);
+  completed = T8_ALLOC (int, num_slots);
+
+  /****     Actual communication    ****/
+
+  /* Post the receives of the first chunks from each rank */
+  for (isource = 0; isource < num_sources; isource++) {
+    for (islot = isource * T8_FOREST_PARTITION_CHUNK_WINDOW;
+         islot < (isource + 1) * T8_FOREST_PARTITION_CHUNK_WINDOW; islot++) {
+      requests[islot] = sc_MPI_REQUEST_NULL;
+    }
+    if (source_proc[isource] == forest->mpirank) {
+      /* The message to ourselves is already there */
+      ichunk = source_first_chunk[isource];
+      chunk_buffer[ichunk] = sent_to_self;
+      chunk_bytes[ichunk] = byte_to_self;
+      chunk_done[ichunk] = 1;
+      source_num_posted[isource] = 1;
+      continue;
+    }
+    for (islot = isource * T8_FOREST_PARTITION_CHUNK_WINDOW;
+         islot < (isource + 1) * T8_FOREST_PARTITION_CHUNK_WINDOW
+         && source_num_posted[isource] < source_num_chunks[isource];
+         islot++) {
+      ichunk = source_first_chunk[isource] + source_num_posted[isource];
+      t8_forest_partition_post_chunk (forest, source_proc[isource],
+                                      source_num_elements[isource],
+                                      source_num_posted[isource],
+                                      source_num_chunks[isource],
+                                      max_element_size, payload_offsets,
+                                      chunk_buffer + ichunk,
+                                      chunk_bytes + ichunk, requests + islot);
+      slot_chunk[islot] = ichunk;
+      source_num_posted[isource]++;
+    }
+  }
+
+  /* Insert the chunks in order of the sending ranks and wait for the
+   * next chunk whenever it has not arrived yet. */
+  forest->local_num_elements = 0;
+  insert_source = 0;
+  insert_chunk = 0;
+  prev_recvd = 0;
+  while (insert_source < num_sources) {
+    ichunk = source_first_chunk[insert_source] + insert_chunk;
+    if (chunk_done[ichunk]) {
+      if (payload_offsets != NULL
+          && source_proc[insert_source] != forest->mpirank
+          && insert_chunk == source_num_chunks[insert_source] - 1) {
+        /* This is the payload of the variable-size data */
+        t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+        t8_forest_partition_insert_payload (forest, payload_offsets,
+                                            source_proc[insert_source],
+                                            chunk_buffer[ichunk]);
+        t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+      }
+      else {
+        t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+        t8_forest_partition_insert_message (forest,
+                                            source_proc[insert_source],
+                                            prev_recvd, chunk_buffer[ichunk],
+                                            chunk_bytes[ichunk]);
+        t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+        prev_recvd++;
+      }
+      if (source_proc[insert_source] != forest->mpirank) {
+        T8_FREE (chunk_buffer[ichunk]);
+      }
+      chunk_buffer[ichunk] = NULL;
+      if (++insert_chunk == source_num_chunks[insert_source]) {
+        insert_source++;
+        insert_chunk = 0;
+      }
+      continue;
+    }
+    /* Wait for any of the posted receives to complete */
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_WAIT);
+    mpiret = sc_MPI_Waitsome (num_slots, requests, &num_completed,
+                              completed, statuses);
+    SC_CHECK_MPI (mpiret);
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_WAIT);
+    T8_ASSERT (num_completed != sc_MPI_UNDEFINED && num_completed > 0);
+    for (icompleted = 0; icompleted < num_completed; icompleted++) {
+      islot = completed[icompleted];
+      ichunk = slot_chunk[islot];
+      isource = islot / T8_FOREST_PARTITION_CHUNK_WINDOW;
+      T8_ASSERT (statuses[icompleted].MPI_SOURCE == source_proc[isource]);
+      T8_ASSERT (statuses[icompleted].MPI_TAG == T8_MPI_PARTITION_FOREST);
+      /* Shrink the buffer to the actual size of the message */
+      mpiret = sc_MPI_Get_count (statuses + icompleted, sc_MPI_BYTE,
+                                 chunk_bytes + ichunk);
+      SC_CHECK_MPI (mpiret);
+      if (chunk_bytes[ichunk] > 0) {
+        chunk_buffer[ichunk] =
+          T8_REALLOC (chunk_buffer[ichunk], char, chunk_bytes[ichunk]);
+      }
+      chunk_done[ichunk] = 1;
+      if (source_num_posted[isource] < source_num_chunks[isource]) {
+        /* Post the receive of the next chunk from this rank */
+        ichunk = source_first_chunk[isource] + source_num_posted[isource];
+        t8_forest_partition_post_chunk (forest, source_proc[isource],
+                                        source_num_elements[isource],
+                                        source_num_posted[isource],
+                                        source_num_chunks[isource],
+                                        max_element_size, payload_offsets,
+                                        chunk_buffer + ichunk,
+                                        chunk_bytes + ichunk,
+                                        requests + islot);
+        slot_chunk[islot] = ichunk;
+        source_num_posted[isource]++;
+      }
+    }
+  }
+
+  T8_FREE (source_proc);
+  T8_FREE (source_num_elements);
+  T8_FREE (source_num_chunks);
+  T8_FREE (source_first_chunk);
+  T8_FREE (source_num_posted);
+  T8_FREE (chunk_buffer);
+  T8_FREE (chunk_bytes);
+  T8_FREE (chunk_done);
+  T8_FREE (requests);
+  T8_FREE (statuses);
+  T8_FREE (slot_chunk);
+  T8_FREE (completed);
+}
+
+/* Receive the element data from all processes, we receive from.
+ * The message are received in order of the sending rank,
+ * since then we can easily build up the data array.
+ */
+static void
+t8_forest_partition_recvloop_data (t8_forest_t forest, int recv_first,
+                                   int recv_last, sc_array_t * data_out,
+                                   char *sent_to_self, size_t byte_to_self)
 {
-  int                 iproc, num_receive, prev_recvd;
+  int                 iproc;
   t8_locidx_t         last_received_local_element = 0;
   t8_forest_t         forest_from;
   t8_gloidx_t        *offset_from;
@@ -1056,10 +2328,9 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
   sc_MPI_Status       status;
 
   /* Initial checks and inits */
-  T8_ASSERT (recv_data || t8_forest_is_initialized (forest));
-  T8_ASSERT (!recv_data || t8_forest_is_committed (forest));
-  T8_ASSERT (!recv_data
-             || data_out->elem_count == (size_t) forest->local_num_elements);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (data_out != NULL);
+  T8_ASSERT (data_out->elem_count == (size_t) forest->local_num_elements);
   forest_from = forest->set_from;
   T8_ASSERT (t8_forest_is_committed (forest_from));
   offset_from =
@@ -1068,18 +2339,10 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
 
   /****     Actual communication    ****/
 
-  /* In order of their ranks, receive the trees and elements from
-   * the other processes. */
-
-  num_receive = 0;
-  prev_recvd = 0;
-  if (!recv_data) {
-    forest->local_num_elements = 0;
-  }
+  /* In order of their ranks, receive the data from the other processes. */
   for (iproc = recv_first; iproc <= recv_last; iproc++) {
     if (!t8_forest_partition_empty (offset_from, iproc)) {
       /* We receive from each nonempty rank between recv_first and recv_last */
-      num_receive++;
       if (iproc != forest->mpirank) {
         /* Probe for the message */
         mpiret = sc_MPI_Probe (iproc, T8_MPI_PARTITION_FOREST, comm, &status);
@@ -1089,21 +2352,10 @@ t8_forest_partition_recvloop (t8_forest_t forest, int recv_first,
         T8_ASSERT (status.MPI_TAG == T8_MPI_PARTITION_FOREST);
       }
       /* Receive the actual message */
-      if (!recv_data) {
-        t8_forest_partition_recv_message (forest, comm, iproc, &status,
-                                          prev_recvd, sent_to_self,
-                                          byte_to_self);
-      }
-      else {
-        T8_ASSERT (data_out != NULL);
-        T8_ASSERT (data_out->elem_count ==
-                   (size_t) forest->local_num_elements);
-        t8_forest_partition_recv_message_data (forest, comm, iproc, &status,
-                                               &last_received_local_element,
-                                               data_out, sent_to_self,
-                                               byte_to_self);
-      }
-      prev_recvd++;
+      t8_forest_partition_recv_message_data (forest, comm, iproc, &status,
+                                             &last_received_local_element,
+                                             data_out, sent_to_self,
+                                             byte_to_self);
     }
   }
 }
@@ -1119,9 +2371,12 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
   sc_MPI_Request     *requests = NULL;
   int                 num_request_alloc;        /* The count of elements in the request array */
   char              **send_buffer, *sent_to_self;
-  int                 mpiret, i, to_self;
-  t8_locidx_t         num_new_elements;
+  int                 mpiret, i, to_self, num_variable;
+  t8_locidx_t         num_new_elements, ielement;
   size_t              byte_to_self = 0;
+  t8_gloidx_t        *payload_offsets = NULL;
+  t8_forest_partition_data_t *data;
+  size_t             *offsets;
 
   t8_debugf ("Start partition_given\n");
   T8_ASSERT (send_data || t8_forest_is_initialized (forest));
@@ -1133,16 +2388,23 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
   t8_debugf ("send_first = %i\n", send_first);
   t8_debugf ("send_last = %i\n", send_last);
 
+  /* Compute the offsets of the payload of variable-size data */
+  num_variable = send_data ? 0 :
+    t8_forest_partition_data_num_variable (forest->set_partition_data);
+  if (num_variable > 0) {
+    payload_offsets =
+      t8_forest_partition_payload_offsets (forest, num_variable);
+  }
+
   /* Send all elements to other ranks */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_PACK);
   to_self =
     t8_forest_partition_sendloop (forest, send_first, send_last, &requests,
                                   &num_request_alloc, &send_buffer, send_data,
-                                  data_in, &byte_to_self);
-  if (to_self) {
-    /* We have sent data to ourselves. */
-    sent_to_self = *(send_buffer + forest->mpirank - send_first);
-  }
-  else {
+                                  data_in, &sent_to_self, &byte_to_self);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_PACK);
+  if (!to_self) {
+    /* We have not sent data to ourselves. */
     sent_to_self = NULL;
   }
 
@@ -1156,11 +2418,43 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
     num_new_elements = t8_forest_get_local_num_elements (forest);
   }
 
+  if (!send_data && forest->set_partition_data != NULL) {
+    /* Allocate the user data arrays that we receive with the elements */
+    for (i = 0, num_variable = 0;
+         i < (int) forest->set_partition_data->elem_count; i++) {
+      data = (t8_forest_partition_data_t *)
+        sc_array_index_int (forest->set_partition_data, i);
+      if (data->offsets_in == NULL) {
+        sc_array_resize (data->data_out, num_new_elements);
+        continue;
+      }
+      /* Variable-size data */
+      sc_array_resize (data->offsets_out, num_new_elements + 1);
+      *(size_t *) sc_array_index (data->offsets_out, 0) = 0;
+      sc_array_resize (data->data_out,
+                       payload_offsets[(2 * num_variable + 1)
+                                       * (forest->mpisize + 1)
+                                       + forest->mpirank + 1]
+                       - payload_offsets[(2 * num_variable + 1)
+                                         * (forest->mpisize + 1)
+                                         + forest->mpirank]);
+      num_variable++;
+    }
+  }
+
   if (num_new_elements > 0) {
     /* Receive all element from other ranks */
     t8_forest_partition_recvrange (forest, &recv_first, &recv_last);
-    t8_forest_partition_recvloop (forest, recv_first, recv_last, send_data,
-                                  data_out, sent_to_self, byte_to_self);
+    if (!send_data) {
+      t8_forest_partition_recvloop (forest, recv_first, recv_last,
+                                    sent_to_self, byte_to_self,
+                                    payload_offsets);
+    }
+    else {
+      t8_forest_partition_recvloop_data (forest, recv_first, recv_last,
+                                         data_out, sent_to_self,
+                                         byte_to_self);
+    }
   }
   else if (!send_data) {
     /* This forest is empty, set first and last local tree such
@@ -1169,12 +2463,38 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
     forest->last_local_tree = -1;
     forest->local_num_elements = 0;
   }
+  if (payload_offsets != NULL) {
+    if (to_self) {
+      /* Copy the payload that stays on this process */
+      t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+      t8_forest_partition_insert_payload (forest, payload_offsets,
+                                          forest->mpirank, NULL);
+      t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_UNPACK);
+    }
+    /* We received the number of entries of each element, compute the
+     * offsets of the variable-size data */
+    for (i = 0; i < (int) forest->set_partition_data->elem_count; i++) {
+      data = (t8_forest_partition_data_t *)
+        sc_array_index_int (forest->set_partition_data, i);
+      if (data->offsets_in == NULL) {
+        continue;
+      }
+      offsets = (size_t *) data->offsets_out->array;
+      for (ielement = 0; ielement < num_new_elements; ielement++) {
+        offsets[ielement + 1] += offsets[ielement];
+      }
+      T8_ASSERT (offsets[num_new_elements] == data->data_out->elem_count);
+    }
+    T8_FREE (payload_offsets);
+  }
   /* Wait for all sends to complete */
   t8_debugf ("[HH] waiting...\n");
   if (num_request_alloc > 0) {
+    t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_WAIT);
     mpiret =
       sc_MPI_Waitall (num_request_alloc, requests, sc_MPI_STATUSES_IGNORE);
     SC_CHECK_MPI (mpiret);
+    t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_WAIT);
   }
   T8_FREE (requests);
   for (i = 0; i < num_request_alloc; i++) {
@@ -1187,8 +2507,8 @@ t8_forest_partition_given (t8_forest_t forest, const int send_data,
 
 /* Populate a forest with the partitioned elements of
  * forest->set_from.
- * Currently the elements are distributed evenly (each element
- * has the same weight).
+ * The elements are distributed evenly, or according to their weights
+ * if weights are set.
  */
 void
 t8_forest_partition (t8_forest_t forest)
@@ -1213,6 +2533,8 @@ t8_forest_partition (t8_forest_t forest)
     t8_global_productionf ("Start partition %f %f\n", sc_MPI_Wtime (),
                            forest->profile->partition_runtime);
   }
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION);
+  T8_TRACE_BEGIN ("t8_forest_partition");
 
   if (forest_from->element_offsets == NULL) {
     /* We create the partition table of forest_from */
@@ -1222,19 +2544,25 @@ t8_forest_partition (t8_forest_t forest)
   /* TODO: if offsets already exist on forest_from, check it for consistency */
 
   /* We now calculate the new element offsets */
+  t8_forest_profile_begin (forest, T8_PROFILE_PHASE_PARTITION_OFFSETS);
   t8_forest_partition_compute_new_offset (forest);
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION_OFFSETS);
   t8_forest_partition_given (forest, 0, NULL, NULL);
 
   T8_ASSERT ((size_t) t8_forest_get_num_local_trees (forest_from)
              == forest_from->trees->elem_count);
   T8_ASSERT ((size_t) t8_forest_get_num_local_trees (forest)
              == forest->trees->elem_count);
+  /* Carry the tree hashes of forest_from over to the new partition */
+  t8_forest_hash_partition (forest);
 
   if (create_offset_from) {
     /* Delete the offset memory that we allocated */
     t8_shmem_array_destroy (&forest_from->element_offsets);
   }
 
+  t8_forest_profile_end (forest, T8_PROFILE_PHASE_PARTITION);
+  T8_TRACE_END ("t8_forest_partition");
   if (forest->profile != NULL) {
     /* If profiling is enabled, we measure the runtime of partition */
     forest->profile->partition_runtime = sc_MPI_Wtime () -
@@ -28,6 +28,8 @@ t8_element_t *
 t8_forest_get_tree_element (t8_tree_t tree, t8_locidx_t elem_in_tree)
 {
   T8_ASSERT (tree != NULL);
+  /* The elements must have been decompressed via the forest */
+  T8_ASSERT (tree->packed_elements == NULL);
   T8_ASSERT (0 <= elem_in_tree
              && elem_in_tree < t8_forest_get_tree_element_count (tree));
   return t8_element_array_index_locidx (&tree->elements, elem_in_tree);
@@ -36,9 +38,62 @@ t8_forest_get_tree_element (t8_tree_t tree, t8_locidx_t elem_in_tree)
 t8_element_array_t *
 t8_forest_get_tree_element_array (t8_forest_t forest, t8_locidx_t ltreeid)
 {
+  t8_tree_t           tree;
+
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (0 <= ltreeid
              && ltreeid < t8_forest_get_num_local_trees (forest));
 
-  return &t8_forest_get_tree (forest, ltreeid)->elements;
+  tree = t8_forest_get_tree (forest, ltreeid);
+  /* Decode the elements if they are compressed */
+  t8_forest_tree_decompress (forest, tree);
+  return &tree->elements;
+}
+
+void
+t8_forest_tree_decompress (t8_forest_t forest, t8_tree_t tree)
+{
+  t8_linearidx_t     *packed_elements;
+
+  T8_ASSERT (tree != NULL);
+
+#ifdef T8_ENABLE_OPENMP
+  /* The elements are decoded by the first thread that accesses them,
+   * the other threads wait until they are decoded. */
+#pragma omp atomic read
+  packed_elements = tree->packed_elements;
+#pragma omp flush
+  if (packed_elements == NULL) {
+    /* The elements are not compressed */
+    return;
+  }
+#pragma omp critical (t8_forest_tree_decompress)
+  {
+    if (tree->packed_elements != NULL) {
+      T8_ASSERT (forest->compressed);
+      t8_element_array_unpack (&tree->elements, forest->maxlevel,
+                               tree->packed_elements,
+                               tree->num_packed_elements);
+      packed_elements = tree->packed_elements;
+      tree->num_packed_elements = 0;
+      /* Mark the tree as decoded only after its elements are written */
+#pragma omp flush
+#pragma omp atomic write
+      tree->packed_elements = NULL;
+      T8_FREE (packed_elements);
+    }
+  }
+#else
+  packed_elements = tree->packed_elements;
+  if (packed_elements == NULL) {
+    /* The elements are not compressed */
+    return;
+  }
+  T8_ASSERT (forest->compressed);
+  t8_element_array_unpack (&tree->elements, forest->maxlevel,
+                           packed_elements, tree->num_packed_elements);
+  T8_FREE (packed_elements);
+  tree->packed_elements = NULL;
+  tree->num_packed_elements = 0;
+#endif
 }
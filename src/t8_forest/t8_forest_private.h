@@ -44,6 +44,10 @@ void                t8_forest_compute_desc (t8_forest_t forest);
  * of the coarse mesh. */
 void                t8_forest_populate (t8_forest_t forest);
 
+/* Compute the maps from reference to physical coordinates of the local
+ * and ghost trees of a forest. Called once the ghost layer is created. */
+void                t8_forest_tree_maps_compute (t8_forest_t forest);
+
 /** Return the eclass scheme of a given element class associated to a forest.
  * This function does not check whether the given forest is committed, use with
  * caution and only if you are sure that the eclass_scheme was set.
@@ -58,6 +62,15 @@ t8_eclass_scheme_c *t8_forest_get_eclass_scheme_before_commit (t8_forest_t
                                                                t8_eclass_t
                                                                eclass);
 
+/** Restore the elements of a local tree that are stored in compressed form.
+ * If the elements of the tree are not compressed, nothing happens.
+ * \param [in]     forest  A committed forest.
+ * \param [in,out] tree    A local tree of \a forest.
+ * \see t8_forest_compress
+ */
+void                t8_forest_tree_decompress (t8_forest_t forest,
+                                               t8_tree_t tree);
+
 /** Compute the maximum possible refinement level in a forest.
  * This is the minimum over all maimum refinement level of the present element
  * classes.
@@ -65,6 +78,14 @@ t8_eclass_scheme_c *t8_forest_get_eclass_scheme_before_commit (t8_forest_t
  */
 void                t8_forest_compute_maxlevel (t8_forest_t forest);
 
+/** Return the number of threads of the thread parallel algorithms of a forest.
+ * \param [in]      forest      A forest, not necessarily committed.
+ * \return          The number set with \ref t8_forest_set_num_threads or,
+ *                  if none was set, the maximum number of threads of OpenMP.
+ *                  Without OpenMP 1.
+ */
+int                 t8_forest_get_num_threads (t8_forest_t forest);
+
 /** Compute the minimum possible uniform refinement level on a cmesh such
  * that no process is empty.
  * \param [in]  cmesh       The cmesh.
@@ -100,13 +121,63 @@ int                 t8_forest_first_tree_shared (t8_forest_t forest);
 int                 t8_forest_last_tree_shared (t8_forest_t forest);
 
 /* Allocate memory for trees and set their values as in from.
- * For each tree allocate enough element memory to fit the elements of from.
- * If copy_elements is true, copy the elements of from into the element memory.
+ * If copy_elements is true, the trees share the elements of from, see
+ * t8_forest_tree_share_elements, or copy them if they cannot be shared.
+ * Otherwise, the element arrays of the trees are left empty.
  */
 void                t8_forest_copy_trees (t8_forest_t forest,
                                           t8_forest_t from,
                                           int copy_elements);
 
+/** Let a tree share the elements of another tree instead of copying them.
+ * If the elements of \a fromtree are not yet shared, they are moved into a
+ * reference counted \ref t8_tree_shared_elements_t and \a fromtree stores
+ * a view on them. Afterwards both trees store a view on the same elements.
+ * Before a tree modifies its elements, it must call
+ * \ref t8_forest_tree_unshare_elements.
+ * \param [in,out] tree     A tree whose element array is not initialized.
+ * \param [in,out] fromtree A tree whose elements are not compressed.
+ * \return                  True if the elements are shared. False if they
+ *                          could not be shared, since \a fromtree stores a
+ *                          view on memory that it does not own, and
+ *                          \a tree is left unchanged.
+ */
+int                 t8_forest_tree_share_elements (t8_tree_t tree,
+                                                   t8_tree_t fromtree);
+
+/** Make the elements of a tree exclusive to this tree, such that they can
+ * be modified. If the elements are shared with other trees, they are
+ * copied. If this tree is the last one sharing them, it takes over their
+ * memory without copying. Does nothing if the elements are not shared.
+ * \param [in,out] tree     A tree.
+ */
+void                t8_forest_tree_unshare_elements (t8_tree_t tree);
+
+/** Free the element array of a tree. If the elements are shared, release
+ * the reference of this tree to them instead.
+ * \param [in,out] tree     A tree. Its element array is empty afterwards.
+ */
+void                t8_forest_tree_reset_elements (t8_tree_t tree);
+
+/* Take over the trees and elements of from instead of copying them as in
+ * t8_forest_copy_trees with copy_elements true.
+ * from must be committed and only be referenced by the caller.
+ * It has no local trees afterwards and should be destroyed.
+ */
+void                t8_forest_move_trees (t8_forest_t forest,
+                                          t8_forest_t from);
+
+/** If profiling is enabled, add the memory used by a forest that is being
+ * committed and by the forest it is derived from to the high-water mark of
+ * its profile.
+ * \param [in,out] forest      A forest during commit.
+ * \param [in]     forest_from A committed forest that exists at the same time
+ *                             as \a forest, or NULL.
+ * \see t8_forest_profile_get_memory_high_water
+ */
+void                t8_forest_profile_record_memory (t8_forest_t forest,
+                                                     t8_forest_t forest_from);
+
 /** Given the local id of a tree in a forest, return the coarse tree of the
  * cmesh that corresponds to this tree, also return the neighbor information of
  * the tree.
@@ -230,6 +301,56 @@ int                 t8_forest_element_find_owner_ext (t8_forest_t forest,
                                                       int guess,
                                                       int element_is_desc);
 
+/** Find the owner processes of elements of a tree that are sorted by their
+ * linear id, as for example the elements of a tree of a forest.
+ * Instead of searching for each element separately, we search the owner of
+ * the first element and then advance through the processes with the
+ * elements.
+ * \param [in]    forest  The forest.
+ * \param [in]    gtreeid The global id of the tree in which the elements lie.
+ * \param [in]    eclass  The element class of the tree \a gtreeid.
+ * \param [in]    elements Pointer to the first of \a num_elements contiguous
+ *                        elements, sorted ascending by their linear id.
+ * \param [in]    num_elements The number of elements.
+ * \param [out]   owners  Array of at least \a num_elements entries. On output
+ *                        owners[i] is the owner of the i-th element, as
+ *                        computed by \ref t8_forest_element_find_owner.
+ * \note \a forest must be committed before calling this function.
+ * \see t8_forest_element_find_owner
+ */
+void                t8_forest_element_find_owners_sorted (t8_forest_t forest,
+                                                          t8_gloidx_t gtreeid,
+                                                          t8_eclass_t eclass,
+                                                          const t8_element_t
+                                                          * elements,
+                                                          t8_locidx_t
+                                                          num_elements,
+                                                          int *owners);
+
+/** Find the owner processes of maximum level elements of a tree that are
+ * given by their sorted linear ids.
+ * \param [in]    forest  The forest.
+ * \param [in]    gtreeid The global id of the tree in which the elements lie.
+ * \param [in]    ids     The linear ids at the maximum level of the forest
+ *                        of \a num_ids elements, sorted ascending.
+ * \param [in]    num_ids The number of ids.
+ * \param [out]   owners  Array of at least \a num_ids entries. On output
+ *                        owners[i] is the owner of the i-th element.
+ * \note \a forest must be committed and have its tree offsets and first
+ *       descendants computed before calling this function.
+ * \see t8_forest_element_find_owners_sorted
+ */
+void                t8_forest_element_find_owners_sorted_ids (t8_forest_t
+                                                              forest,
+                                                              t8_gloidx_t
+                                                              gtreeid,
+                                                              const
+                                                              t8_linearidx_t
+                                                              * ids,
+                                                              t8_locidx_t
+                                                              num_ids,
+                                                              int *owners);
+
 /** Perform a constant runtime check if a given rank is owner of a given element.
  * If the element is owned by more than one rank, then this check is only true
  * for the smallest.
@@ -408,6 +529,88 @@ t8_gloidx_t         t8_forest_element_half_face_neighbors (t8_forest_t forest,
                                                            int num_neighs,
                                                            int dual_faces[]);
 
+/** The half face neighbors of all faces of a range of elements of a tree,
+ * see \ref t8_forest_tree_half_face_neighbors.
+ * Each element has \a max_faces face entries, the entry of face f of the
+ * i-th element of the range is i * max_faces + f. Entries of faces that the
+ * element does not have, for example the faces 3 and 4 of a tet in a
+ * pyramid tree, have no neighbors.
+ * The buffers are kept between calls, such that a structure can be reused
+ * for all trees without reallocating its memory.
+ */
+typedef struct t8_forest_half_neighbors
+{
+  t8_locidx_t         first_element; /**< The tree local index of the first element of the range. */
+  t8_locidx_t         num_elements; /**< The number of elements of the range. */
+  int                 max_faces;  /**< The number of face entries of each element. */
+  sc_array_t          face_offsets; /**< For each face entry the position of its first half neighbor in \a dual_faces, followed by the number of all half neighbors. t8_locidx_t */
+  sc_array_t          neighbor_trees; /**< For each face entry the global id of the neighbor tree, -1 if there is no neighbor. t8_gloidx_t */
+  sc_array_t          neighbor_classes; /**< For each face entry the class of the neighbor tree. t8_eclass_t */
+  sc_array_t          neighbor_first; /**< For each face entry the index of its first half neighbor in \a neighbors of its class. t8_locidx_t */
+  sc_array_t          dual_faces; /**< For each half neighbor its face at the face of the element. int */
+  t8_element_array_t  neighbors[T8_ECLASS_COUNT]; /**< For each class the half neighbors in trees of that class. Initialized on first use. */
+} t8_forest_half_neighbors_t;
+
+/** Initialize the buffers of the half face neighbors of a range of elements.
+ * \param [out]   half    The structure to be initialized. Must be freed
+ *                        with \ref t8_forest_half_neighbors_reset.
+ */
+void                t8_forest_half_neighbors_init (t8_forest_half_neighbors_t
+                                                   * half);
+
+/** Free the buffers of the half face neighbors of a range of elements.
+ * \param [in,out] half   An initialized structure.
+ */
+void                t8_forest_half_neighbors_reset (t8_forest_half_neighbors_t
+                                                    * half);
+
+/** Construct the face neighbors of half size of all faces of the elements
+ * \a first, ..., \a last - 1 of a local tree at once.
+ * For each face this computes the same neighbors as
+ * \ref t8_forest_element_half_face_neighbors, except for elements at the
+ * maximum level of their scheme, which cannot be refined and for which the
+ * same level face neighbor is computed instead.
+ * The neighbors are written into the buffers of \a half, which are
+ * overwritten by each call.
+ * \param [in]    forest  The forest.
+ * \param [in]    ltreeid The local id of a local tree.
+ * \param [in]    first   The tree local index of the first element.
+ * \param [in]    last    The tree local index after the last element.
+ * \param [in,out] half   An initialized structure. On output it stores the
+ *                        half face neighbors of the elements.
+ */
+void                t8_forest_tree_half_face_neighbors (t8_forest_t forest,
+                                                        t8_locidx_t ltreeid,
+                                                        t8_locidx_t first,
+                                                        t8_locidx_t last,
+                                                        t8_forest_half_neighbors_t
+                                                        * half);
+
+/** Return the half face neighbors of one face of an element from the output
+ * of \ref t8_forest_tree_half_face_neighbors.
+ * \param [in]    half    The half face neighbors of a range of elements.
+ * \param [in]    ielement The tree local index of an element of the range.
+ * \param [in]    face    A face of the element.
+ * \param [out]   neighbor_tree If not NULL, the global id of the neighbor
+ *                        tree, -1 if there is no neighbor.
+ * \param [out]   neigh_class If not NULL, the class of the neighbor tree.
+ * \param [out]   neighs  If not NULL, an array of T8_ECLASS_MAX_CHILDREN
+ *                        entries. On output pointers to the half neighbors,
+ *                        which stay valid until the next call of
+ *                        \ref t8_forest_tree_half_face_neighbors with \a half.
+ * \param [out]   dual_faces If not NULL, a pointer to the dual faces of the
+ *                        half neighbors.
+ * \return                The number of half neighbors, 0 if there is no
+ *                        neighbor across \a face.
+ */
+int                 t8_forest_half_neighbors_get (t8_forest_half_neighbors_t *
+                                                  half, t8_locidx_t ielement,
+                                                  int face,
+                                                  t8_gloidx_t * neighbor_tree,
+                                                  t8_eclass_t * neigh_class,
+                                                  t8_element_t * neighs[],
+                                                  int **dual_faces);
+
 /** Iterate over all leafs of a forest and for each face compute the face neighbor
  * leafs with \ref t8_forest_leaf_face_neighbors and print their local element ids.
  * This function is meant for debugging only.
@@ -434,6 +637,76 @@ int                 t8_forest_element_has_leaf_desc (t8_forest_t forest,
                                                      element,
                                                      t8_eclass_scheme_c * ts);
 
+/** Search for a linear element id in a sorted array of elements.
+ * If the element does not exist, return the largest index i
+ * such that the element at position i has a smaller id than the given one.
+ * \param [in]  elements  A sorted array of elements. Must not be empty.
+ * \param [in]  element_id The linear id to search for, at level \a maxlevel.
+ * \param [in]  maxlevel  The level at which the linear ids are computed.
+ * \return                The largest index i with id of element i at most
+ *                        \a element_id. -1 if no such i exists.
+ */
+t8_locidx_t         t8_forest_bin_search_lower (t8_element_array_t *
+                                                elements,
+                                                t8_linearidx_t element_id,
+                                                int maxlevel);
+
+/** Search the leaf face neighbors of a local leaf across a face in the
+ * local and ghost leafs of the neighbor tree.
+ * In contrast to the balanced algorithm of
+ * \ref t8_forest_leaf_face_neighbors the neighbors may have any level.
+ * All neighbors are found if the forest has a face ghost layer or
+ * only one process.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  ltreeid   A local tree id.
+ * \param [in]  leaf      A leaf in tree \a ltreeid of \a forest.
+ * \param [in]  face      A face of \a leaf.
+ * \param [in,out] indices The element indices of the neighbors are pushed
+ *                        to this array of t8_locidx_t. Ghosts have the number
+ *                        of local elements plus their ghost index.
+ * \param [in,out] dual_faces If not NULL, the face of each neighbor is pushed
+ *                        to this array of int.
+ * \param [in,out] leafs  If not NULL, pointers to the neighbor leafs are
+ *                        pushed to this array of const t8_element_t *.
+ */
+void                t8_forest_leaf_face_neighbors_search (t8_forest_t forest,
+                                                          t8_locidx_t
+                                                          ltreeid,
+                                                          const t8_element_t
+                                                          * leaf, int face,
+                                                          sc_array_t *
+                                                          indices,
+                                                          sc_array_t *
+                                                          dual_faces,
+                                                          sc_array_t *
+                                                          leafs);
+
+/** Compute the element offsets that move all elements of a forest to as many
+ * leading processes as possible, such that each of them has at least
+ * \a min_elements elements.
+ * \param [in]  forest    A committed forest.
+ * \param [in]  min_elements The minimum number of elements per active
+ *                        process. Must be positive.
+ * \param [out] poffsets  On output NULL if the elements of \a forest
+ *                        already are on the active processes only. Otherwise
+ *                        an array of mpisize + 1 offsets for
+ *                        \ref t8_forest_set_partition_offsets, which must be
+ *                        freed with T8_FREE.
+ * \return               The number of active processes, at least 1.
+ */
+int                 t8_forest_concentrate_offsets (t8_forest_t forest,
+                                                   t8_gloidx_t min_elements,
+                                                   t8_gloidx_t **poffsets);
+
+/** Query whether a ghost layer was requested for a forest.
+ * Since the request is reset in commit on multiple processes, this also
+ * checks for an existing or a deferred ghost layer. Use this to pass the
+ * ghost settings of a committed forest on to a new forest.
+ * \param [in]  forest    An initialized or committed forest.
+ * \return               True if \a forest was set to have a ghost layer.
+ */
+int                 t8_forest_has_ghost_setting (t8_forest_t forest);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_PRIVATE_H! */
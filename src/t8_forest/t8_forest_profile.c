@@ -0,0 +1,288 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest/t8_forest_profile.h>
+#include <t8_forest.h>
+#ifdef T8_HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* The names of the phases, in the order of t8_profile_phase_t */
+static const char  *t8_profile_phase_names[T8_PROFILE_PHASE_COUNT] = {
+  "adapt",
+  "partition",
+  "partition/offsets",
+  "partition/pack",
+  "partition/wait",
+  "partition/unpack",
+  "balance",
+  "balance/round",
+  "balance/round/adapt",
+  "balance/round/partition",
+  "balance/round/ghost",
+  "ghost",
+  "ghost/fill_remote",
+  "ghost/send",
+  "ghost/receive",
+  "ghost/receive/parse"
+};
+
+/* The names of the statistics of a phase, the runtime and the number of
+ * calls followed by the counters in the order of t8_profile_counter_t */
+static const char  *t8_profile_stat_names[T8_PROFILE_PHASE_NUM_STATS] = {
+  "runtime",
+  "calls",
+  "cycles",
+  "llc_misses",
+  "bytes"
+};
+
+/* The maximum length of the name of a phase statistic */
+#define T8_PROFILE_STAT_NAME_LENGTH 64
+
+/* The names of the phase statistics, set on first use since sc_stats only
+ * stores a pointer to them */
+static char
+  t8_profile_stat_full_names[T8_PROFILE_PHASE_NUM_STATS *
+                             T8_PROFILE_PHASE_COUNT]
+  [T8_PROFILE_STAT_NAME_LENGTH];
+
+/* The file descriptors of the hardware counters of this process,
+ * -1 if the counters are not enabled */
+static int          t8_profile_counter_fd[T8_PROFILE_NUM_HW_COUNTERS] =
+  { -1, -1 };
+
+#ifdef T8_HAVE_LINUX_PERF_EVENT_H
+/* Open a hardware counter of the calling thread and the threads that
+ * it creates afterwards. Return its file descriptor or -1 on failure. */
+static int
+t8_forest_profile_open_counter (uint64_t config)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof (attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  return (int) syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+int
+t8_forest_profile_set_counters (int enable)
+{
+  int                 icounter;
+
+  if (enable && t8_profile_counter_fd[0] >= 0) {
+    /* The counters are already enabled */
+    return 1;
+  }
+  for (icounter = 0; icounter < T8_PROFILE_NUM_HW_COUNTERS; icounter++) {
+#ifdef T8_HAVE_LINUX_PERF_EVENT_H
+    if (t8_profile_counter_fd[icounter] >= 0) {
+      (void) close (t8_profile_counter_fd[icounter]);
+    }
+#endif
+    t8_profile_counter_fd[icounter] = -1;
+  }
+  if (!enable) {
+    return 0;
+  }
+#ifdef T8_HAVE_LINUX_PERF_EVENT_H
+  t8_profile_counter_fd[T8_PROFILE_COUNTER_CYCLES] =
+    t8_forest_profile_open_counter (PERF_COUNT_HW_CPU_CYCLES);
+  t8_profile_counter_fd[T8_PROFILE_COUNTER_LLC_MISSES] =
+    t8_forest_profile_open_counter (PERF_COUNT_HW_CACHE_MISSES);
+  for (icounter = 0; icounter < T8_PROFILE_NUM_HW_COUNTERS; icounter++) {
+    if (t8_profile_counter_fd[icounter] < 0) {
+      /* The counters are not supported or not permitted */
+      t8_infof ("Could not open hardware counter %s.\n",
+                t8_profile_stat_names[2 + icounter]);
+      (void) t8_forest_profile_set_counters (0);
+      return 0;
+    }
+  }
+  return 1;
+#else
+  t8_infof ("Hardware counters are not supported by this build.\n");
+  return 0;
+#endif
+}
+
+int
+t8_forest_profile_counters_enabled (void)
+{
+  return t8_profile_counter_fd[0] >= 0;
+}
+
+/* Read the current values of the hardware counters, 0 if they are not
+ * enabled. */
+static void
+t8_forest_profile_read_counters (int64_t values[T8_PROFILE_NUM_HW_COUNTERS])
+{
+  int                 icounter;
+
+  for (icounter = 0; icounter < T8_PROFILE_NUM_HW_COUNTERS; icounter++) {
+    values[icounter] = 0;
+#ifdef T8_HAVE_LINUX_PERF_EVENT_H
+    if (t8_profile_counter_fd[icounter] >= 0) {
+      uint64_t            value;
+
+      if (read (t8_profile_counter_fd[icounter], &value, sizeof (value))
+          == (ssize_t) sizeof (value)) {
+        values[icounter] = (int64_t) value;
+      }
+    }
+#endif
+  }
+}
+
+void
+t8_forest_profile_begin (t8_forest_t forest, t8_profile_phase_t phase)
+{
+  t8_profile_phase_struct_t *data;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (0 <= phase && phase < T8_PROFILE_PHASE_COUNT);
+  if (forest->profile == NULL) {
+    /* Profiling is not enabled */
+    return;
+  }
+  data = forest->profile->phases + phase;
+  T8_ASSERT (!data->running);
+  data->running = 1;
+  t8_forest_profile_read_counters (data->counters_start);
+  data->start = sc_MPI_Wtime ();
+}
+
+void
+t8_forest_profile_end (t8_forest_t forest, t8_profile_phase_t phase)
+{
+  t8_profile_phase_struct_t *data;
+  int64_t             values[T8_PROFILE_NUM_HW_COUNTERS];
+  int                 icounter;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (0 <= phase && phase < T8_PROFILE_PHASE_COUNT);
+  if (forest->profile == NULL) {
+    /* Profiling is not enabled */
+    return;
+  }
+  data = forest->profile->phases + phase;
+  T8_ASSERT (data->running);
+  data->runtime += sc_MPI_Wtime () - data->start;
+  t8_forest_profile_read_counters (values);
+  for (icounter = 0; icounter < T8_PROFILE_NUM_HW_COUNTERS; icounter++) {
+    data->counters[icounter] += values[icounter] -
+      data->counters_start[icounter];
+  }
+  data->num_calls++;
+  data->running = 0;
+}
+
+void
+t8_forest_profile_add_bytes (t8_forest_t forest, t8_profile_phase_t phase,
+                             size_t bytes)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (0 <= phase && phase < T8_PROFILE_PHASE_COUNT);
+  if (forest->profile != NULL) {
+    forest->profile->phases[phase].counters[T8_PROFILE_COUNTER_BYTES] +=
+      bytes;
+  }
+}
+
+void
+t8_forest_profile_merge_phase (t8_forest_t forest, t8_profile_phase_t phase,
+                               t8_forest_t forest_from,
+                               t8_profile_phase_t phase_from)
+{
+  t8_profile_phase_struct_t *data;
+  const t8_profile_phase_struct_t *data_from;
+  int                 icounter;
+
+  T8_ASSERT (forest != NULL && forest_from != NULL);
+  T8_ASSERT (0 <= phase && phase < T8_PROFILE_PHASE_COUNT);
+  T8_ASSERT (0 <= phase_from && phase_from < T8_PROFILE_PHASE_COUNT);
+  if (forest->profile == NULL || forest_from->profile == NULL) {
+    /* There is nothing to add */
+    return;
+  }
+  data = forest->profile->phases + phase;
+  data_from = forest_from->profile->phases + phase_from;
+  T8_ASSERT (!data_from->running);
+  data->runtime += data_from->runtime;
+  data->num_calls += data_from->num_calls;
+  for (icounter = 0; icounter < T8_PROFILE_NUM_COUNTERS; icounter++) {
+    data->counters[icounter] += data_from->counters[icounter];
+  }
+}
+
+void
+t8_forest_profile_merge (t8_forest_t forest, t8_forest_t forest_from)
+{
+  int                 iphase;
+
+  for (iphase = 0; iphase < T8_PROFILE_PHASE_COUNT; iphase++) {
+    t8_forest_profile_merge_phase (forest, (t8_profile_phase_t) iphase,
+                                   forest_from, (t8_profile_phase_t) iphase);
+  }
+}
+
+void
+t8_forest_profile_set_phase_stats (const t8_profile_t * profile,
+                                   sc_statinfo_t * stats)
+{
+  const t8_profile_phase_struct_t *data;
+  int                 iphase, istat, index;
+  double              value;
+
+  T8_ASSERT (profile != NULL);
+  for (istat = 0; istat < T8_PROFILE_PHASE_NUM_STATS; istat++) {
+    for (iphase = 0; iphase < T8_PROFILE_PHASE_COUNT; iphase++) {
+      index = istat * T8_PROFILE_PHASE_COUNT + iphase;
+      if (t8_profile_stat_full_names[index][0] == '\0') {
+        snprintf (t8_profile_stat_full_names[index],
+                  T8_PROFILE_STAT_NAME_LENGTH, "%s/%s",
+                  t8_profile_phase_names[iphase],
+                  t8_profile_stat_names[istat]);
+      }
+      data = profile->phases + iphase;
+      if (istat == 0) {
+        value = data->runtime;
+      }
+      else if (istat == 1) {
+        value = data->num_calls;
+      }
+      else {
+        value = data->counters[istat - 2];
+      }
+      sc_stats_set1 (stats + index, value,
+                     t8_profile_stat_full_names[index]);
+    }
+  }
+}
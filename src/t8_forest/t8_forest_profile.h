@@ -0,0 +1,111 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_profile.h
+ * We define routines to time the phases of the forest algorithms and to
+ * accumulate counters for them in the profile of a forest.
+ * All routines do nothing if profiling is not enabled for the forest.
+ * \see t8_forest_set_profiling \see t8_forest_write_profile
+ */
+
+#ifndef T8_FOREST_PROFILE_H
+#define T8_FOREST_PROFILE_H
+
+#include <t8.h>
+#include <sc_statistics.h>
+#include <t8_forest/t8_forest_types.h>
+
+/** The number of statistics of each phase: the runtime, the number of
+ * calls and the counters. */
+#define T8_PROFILE_PHASE_NUM_STATS (2 + T8_PROFILE_NUM_COUNTERS)
+
+T8_EXTERN_C_BEGIN ();
+
+/** Start timing a phase.
+ * \param [in,out] forest       A forest. If it has a profile, the start time
+ *                              and the hardware counters are stored in it.
+ * \param [in]     phase        A phase that is not running.
+ */
+void                t8_forest_profile_begin (t8_forest_t forest,
+                                             t8_profile_phase_t phase);
+
+/** Stop timing a phase and add its runtime and counters to the profile.
+ * \param [in,out] forest       A forest.
+ * \param [in]     phase        A phase that was started with
+ *                              \ref t8_forest_profile_begin.
+ */
+void                t8_forest_profile_end (t8_forest_t forest,
+                                           t8_profile_phase_t phase);
+
+/** Add to the number of bytes that a phase sent to other processes.
+ * \param [in,out] forest       A forest.
+ * \param [in]     phase        A phase.
+ * \param [in]     bytes        The number of bytes.
+ */
+void                t8_forest_profile_add_bytes (t8_forest_t forest,
+                                                 t8_profile_phase_t phase,
+                                                 size_t bytes);
+
+/** Add the phases of the profile of an intermediate forest to the profile
+ * of a forest.
+ * \param [in,out] forest       A forest.
+ * \param [in]     forest_from A forest that was profiled, or a forest
+ *                              without profile.
+ */
+void                t8_forest_profile_merge (t8_forest_t forest,
+                                             t8_forest_t forest_from);
+
+/** Add one phase of the profile of another forest to a possibly different
+ * phase of the profile of a forest.
+ * \param [in,out] forest       A forest.
+ * \param [in]     phase        The phase of \a forest that is updated.
+ * \param [in]     forest_from A forest that was profiled, or a forest
+ *                              without profile.
+ * \param [in]     phase_from   The phase of \a forest_from that is added.
+ */
+void                t8_forest_profile_merge_phase (t8_forest_t forest,
+                                                   t8_profile_phase_t phase,
+                                                   t8_forest_t forest_from,
+                                                   t8_profile_phase_t
+                                                   phase_from);
+
+/** Set the statistics of the phases of a profile.
+ * The statistics are ordered by kind: First the runtimes of all phases,
+ * then their number of calls and then each counter of all phases.
+ * Their names are of the form phase/kind, for example ghost/send/runtime.
+ * \param [in]     profile      A profile.
+ * \param [out]    stats        At least \ref T8_PROFILE_PHASE_COUNT times
+ *                              \ref T8_PROFILE_PHASE_NUM_STATS statistics.
+ */
+void                t8_forest_profile_set_phase_stats (const t8_profile_t *
+                                                       profile,
+                                                       sc_statinfo_t * stats);
+
+/** Query whether hardware counters are measured by the profiles.
+ * \return                      True if \ref t8_forest_profile_set_counters
+ *                              enabled the counters successfully.
+ */
+int                 t8_forest_profile_counters_enabled (void);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_PROFILE_H */
@@ -0,0 +1,1211 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_cmesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_save.h>
+#include <t8_forest/t8_forest_types.h>
+#include <algorithm>
+#include <cmath>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+#ifdef T8_ENABLE_MPIIO
+/* The maximum number of bytes that one process reads or writes with one
+ * MPI I/O call. */
+#define T8_FOREST_SAVE_MAX_BYTES (1 << 30)
+#endif
+
+/* The maximum number of elements of a compressed chunk of user data */
+#define T8_FOREST_SAVE_CHUNK_ELEMENTS (1 << 16)
+
+/* The lossy codec only quantizes values whose quotient by the
+ * quantization step is smaller than this, such that the quotient and the
+ * differences of quotients are exact integers in an int64. */
+#define T8_FOREST_CODEC_MAX_QUOTIENT 4503599627370496.0
+
+/* A checkpoint file opened by all processes of a communicator */
+typedef struct
+{
+#ifdef T8_ENABLE_MPIIO
+  MPI_File            file;
+#else
+  FILE               *file;
+#endif
+  sc_MPI_Comm         comm;
+  int                 mpirank;
+  int                 mpisize;
+  int                 failed;   /* True if an operation failed on this process */
+} t8_forest_save_file_t;
+
+/* Open a file on all processes of comm for reading or writing.
+ * If the file is opened for writing, it is truncated.
+ * Returns true on all processes if the file was opened on all processes. */
+static int
+t8_forest_save_open (t8_forest_save_file_t * fh, const char *filename,
+                     int do_write, sc_MPI_Comm comm)
+{
+  int                 mpiret, local_success, success;
+
+  fh->comm = comm;
+  fh->failed = 0;
+  mpiret = sc_MPI_Comm_rank (comm, &fh->mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &fh->mpisize);
+  SC_CHECK_MPI (mpiret);
+#ifdef T8_ENABLE_MPIIO
+  if (do_write) {
+    /* Delete an old file, since MPI_MODE_CREATE does not truncate it */
+    if (fh->mpirank == 0) {
+      MPI_File_delete ((char *) filename, MPI_INFO_NULL);
+    }
+    mpiret = sc_MPI_Barrier (comm);
+    SC_CHECK_MPI (mpiret);
+  }
+  /* Errors on files are returned to the caller by default */
+  fh->failed = MPI_File_open (comm, (char *) filename,
+                              do_write ? MPI_MODE_WRONLY | MPI_MODE_CREATE
+                              : MPI_MODE_RDONLY, MPI_INFO_NULL,
+                              &fh->file) != MPI_SUCCESS;
+#else
+  /* Process 0 creates the file before the other processes open it */
+  if (!do_write || fh->mpirank == 0) {
+    fh->file = fopen (filename, do_write ? "wb" : "rb");
+  }
+  if (do_write) {
+    mpiret = sc_MPI_Barrier (comm);
+    SC_CHECK_MPI (mpiret);
+    if (fh->mpirank > 0) {
+      fh->file = fopen (filename, "r+b");
+    }
+  }
+  fh->failed = fh->file == NULL;
+#endif
+  local_success = !fh->failed;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, comm);
+  SC_CHECK_MPI (mpiret);
+  if (!success && !fh->failed) {
+    /* Some other process could not open the file, we close it again */
+#ifdef T8_ENABLE_MPIIO
+    MPI_File_close (&fh->file);
+#else
+    fclose (fh->file);
+#endif
+  }
+  return success;
+}
+
+/* Collectively write size bytes of a buffer at a given offset of a file.
+ * Processes that write nothing pass size 0. */
+static void
+t8_forest_save_write_at (t8_forest_save_file_t * fh, long long offset,
+                         const void *buffer, long long size)
+{
+#ifdef T8_ENABLE_MPIIO
+  long long           num_rounds, max_rounds, iround, count;
+  MPI_Status          status;
+  int                 mpiret;
+
+  /* The buffer may be larger than what fits into one MPI call, thus the
+   * processes write it in rounds of at most T8_FOREST_SAVE_MAX_BYTES */
+  num_rounds =
+    (size + T8_FOREST_SAVE_MAX_BYTES - 1) / T8_FOREST_SAVE_MAX_BYTES;
+  mpiret = sc_MPI_Allreduce (&num_rounds, &max_rounds, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  for (iround = 0; iround < max_rounds; iround++) {
+    count = SC_MAX (0, SC_MIN (size - iround * T8_FOREST_SAVE_MAX_BYTES,
+                               (long long) T8_FOREST_SAVE_MAX_BYTES));
+    fh->failed |=
+      MPI_File_write_at_all (fh->file, (MPI_Offset) offset
+                             + iround * T8_FOREST_SAVE_MAX_BYTES,
+                             (char *) buffer +
+                             (count > 0 ? iround * T8_FOREST_SAVE_MAX_BYTES :
+                              0), (int) count, MPI_BYTE,
+                             &status) != MPI_SUCCESS;
+  }
+#else
+  int                 iproc, mpiret;
+
+  /* Without MPI I/O the processes write one after the other */
+  for (iproc = 0; iproc < fh->mpisize; iproc++) {
+    if (iproc == fh->mpirank && size > 0) {
+      fh->failed |= fseek (fh->file, offset, SEEK_SET) != 0
+        || fwrite (buffer, 1, size, fh->file) != (size_t) size
+        || fflush (fh->file) != 0;
+    }
+    mpiret = sc_MPI_Barrier (fh->comm);
+    SC_CHECK_MPI (mpiret);
+  }
+#endif
+}
+
+/* Collectively read size bytes at a given offset of a file into a buffer.
+ * Processes that read nothing pass size 0. */
+static void
+t8_forest_save_read_at (t8_forest_save_file_t * fh, long long offset,
+                        void *buffer, long long size)
+{
+#ifdef T8_ENABLE_MPIIO
+  long long           num_rounds, max_rounds, iround, count;
+  MPI_Status          status;
+  int                 mpiret, num_read;
+
+  num_rounds =
+    (size + T8_FOREST_SAVE_MAX_BYTES - 1) / T8_FOREST_SAVE_MAX_BYTES;
+  mpiret = sc_MPI_Allreduce (&num_rounds, &max_rounds, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  for (iround = 0; iround < max_rounds; iround++) {
+    count = SC_MAX (0, SC_MIN (size - iround * T8_FOREST_SAVE_MAX_BYTES,
+                               (long long) T8_FOREST_SAVE_MAX_BYTES));
+    fh->failed |=
+      MPI_File_read_at_all (fh->file, (MPI_Offset) offset
+                            + iround * T8_FOREST_SAVE_MAX_BYTES,
+                            (char *) buffer +
+                            (count > 0 ? iround * T8_FOREST_SAVE_MAX_BYTES :
+                             0), (int) count, MPI_BYTE,
+                            &status) != MPI_SUCCESS;
+    /* Detect files that are too short */
+    fh->failed |= MPI_Get_count (&status, MPI_BYTE, &num_read)
+      != MPI_SUCCESS || num_read != count;
+  }
+#else
+  /* Reading from the file does not need to be serialized */
+  if (size > 0) {
+    fh->failed |= fseek (fh->file, offset, SEEK_SET) != 0
+      || fread (buffer, 1, size, fh->file) != (size_t) size;
+  }
+#endif
+}
+
+/* Close a file on all processes.
+ * Returns true on all processes if all operations were successful. */
+static int
+t8_forest_save_close (t8_forest_save_file_t * fh)
+{
+  int                 mpiret, local_success, success;
+
+#ifdef T8_ENABLE_MPIIO
+  fh->failed |= MPI_File_close (&fh->file) != MPI_SUCCESS;
+#else
+  fh->failed |= fclose (fh->file) != 0;
+#endif
+  local_success = !fh->failed;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  return success;
+}
+
+/* Read the header of a file and check whether it is a forest file
+ * in the current format. Returns true on all processes if so. */
+static int
+t8_forest_save_read_header (t8_forest_save_file_t * fh,
+                            t8_forest_save_header_t * header)
+{
+  int                 mpiret, local_success, success;
+
+  memset (header, 0, sizeof (t8_forest_save_header_t));
+  t8_forest_save_read_at (fh, 0, header, sizeof (t8_forest_save_header_t));
+  local_success = !fh->failed && header->magic == T8_FOREST_SAVE_MAGIC
+    && header->format == T8_FOREST_FORMAT;
+  mpiret = sc_MPI_Allreduce (&local_success, &success, 1, sc_MPI_INT,
+                             sc_MPI_LAND, fh->comm);
+  SC_CHECK_MPI (mpiret);
+  return success;
+}
+
+/* The offset of the linear ids in a forest file */
+static long long
+t8_forest_save_ids_offset (const t8_forest_save_header_t * header)
+{
+  return sizeof (t8_forest_save_header_t)
+    + 2 * header->num_trees * sizeof (int64_t);
+}
+
+/* Shuffle the bytes of num_elements elements of data_size bytes, such that
+ * the i-th bytes of all elements are stored contiguously, or undo this. */
+static void
+t8_forest_codec_shuffle (const char *in, char *out, size_t data_size,
+                         size_t num_elements, int inverse)
+{
+  size_t              ielem, ibyte;
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    for (ibyte = 0; ibyte < data_size; ibyte++) {
+      if (inverse) {
+        out[ielem * data_size + ibyte] = in[ibyte * num_elements + ielem];
+      }
+      else {
+        out[ibyte * num_elements + ielem] = in[ielem * data_size + ibyte];
+      }
+    }
+  }
+}
+
+/* The maximum number of bytes that t8_forest_codec_deflate writes */
+static size_t
+t8_forest_codec_deflate_bound (size_t bytes)
+{
+#ifdef SC_HAVE_ZLIB
+  return 1 + compressBound (bytes);
+#else
+  return 1 + bytes;
+#endif
+}
+
+/* Deflate bytes into out. The first byte of out is 1 if the data is
+ * deflated and 0 if it is stored, since it did not become smaller or zlib
+ * is not available. Returns the number of bytes written. */
+static size_t
+t8_forest_codec_deflate (const char *in, size_t bytes, char *out, int level)
+{
+#ifdef SC_HAVE_ZLIB
+  uLongf              out_bytes = compressBound (bytes);
+
+  if (compress2 ((Bytef *) out + 1, &out_bytes, (const Bytef *) in, bytes,
+                 level) == Z_OK && out_bytes < bytes) {
+    out[0] = 1;
+    return 1 + out_bytes;
+  }
+#endif
+  out[0] = 0;
+  memcpy (out + 1, in, bytes);
+  return 1 + bytes;
+}
+
+/* Inflate the in_bytes bytes written by t8_forest_codec_deflate into
+ * out, which has space for bytes bytes. Returns true on success. */
+static int
+t8_forest_codec_inflate (const char *in, size_t in_bytes, char *out,
+                         size_t bytes)
+{
+  if (in_bytes == 1 + bytes && in[0] == 0) {
+    memcpy (out, in + 1, bytes);
+    return 1;
+  }
+#ifdef SC_HAVE_ZLIB
+  if (in_bytes > 1 && in[0] == 1) {
+    uLongf              out_bytes = bytes;
+
+    return uncompress ((Bytef *) out, &out_bytes, (const Bytef *) in + 1,
+                       in_bytes - 1) == Z_OK && out_bytes == bytes;
+  }
+#endif
+  return 0;
+}
+
+static              size_t
+t8_forest_codec_lossless_bound (const t8_forest_codec_t * codec,
+                                size_t data_size, size_t num_elements)
+{
+  return t8_forest_codec_deflate_bound (data_size * num_elements);
+}
+
+static              size_t
+t8_forest_codec_lossless_compress (const t8_forest_codec_t * codec,
+                                   size_t data_size, size_t num_elements,
+                                   const void *in, void *out)
+{
+  char               *shuffled;
+  size_t              bytes = data_size * num_elements, out_bytes;
+
+  shuffled = T8_ALLOC (char, bytes);
+  t8_forest_codec_shuffle ((const char *) in, shuffled, data_size,
+                           num_elements, 0);
+  out_bytes = t8_forest_codec_deflate (shuffled, bytes, (char *) out,
+                                       codec->level);
+  T8_FREE (shuffled);
+  return out_bytes;
+}
+
+static int
+t8_forest_codec_lossless_decompress (const t8_forest_codec_t * codec,
+                                     size_t data_size, size_t num_elements,
+                                     const void *in, size_t in_bytes,
+                                     void *out)
+{
+  char               *shuffled;
+  size_t              bytes = data_size * num_elements;
+  int                 success;
+
+  shuffled = T8_ALLOC (char, bytes);
+  success = t8_forest_codec_inflate ((const char *) in, in_bytes, shuffled,
+                                     bytes);
+  if (success) {
+    t8_forest_codec_shuffle (shuffled, (char *) out, data_size,
+                             num_elements, 1);
+  }
+  T8_FREE (shuffled);
+  return success;
+}
+
+/* The lossy codec writes one byte that is 0 if the chunk is stored
+ * lossless and 1 if it is quantized. A quantized chunk continues with the
+ * quantization step and the lossless compression of the zigzag encoded
+ * differences of the quantized values to those of the previous element. */
+static              size_t
+t8_forest_codec_lossy_bound (const t8_forest_codec_t * codec,
+                             size_t data_size, size_t num_elements)
+{
+  return 1 + sizeof (double)
+    + t8_forest_codec_lossless_bound (codec, data_size, num_elements);
+}
+
+static              size_t
+t8_forest_codec_lossy_compress (const t8_forest_codec_t * codec,
+                                size_t data_size, size_t num_elements,
+                                const void *in, void *out)
+{
+  uint64_t           *deltas;
+  int64_t             quotient;
+  size_t              num_components, num_values, ivalue, compressed;
+  double              step, value;
+  char               *out_bytes = (char *) out;
+
+  num_components = data_size / sizeof (double);
+  num_values = num_components * num_elements;
+  step = 2 * codec->error_bound;
+  deltas = T8_ALLOC (uint64_t, num_values);
+  for (ivalue = 0; data_size % sizeof (double) == 0 && ivalue < num_values;
+       ivalue++) {
+    /* The data of the user need not be aligned */
+    memcpy (&value, (const char *) in + ivalue * sizeof (double),
+            sizeof (double));
+    if (!(fabs (value / step) < T8_FOREST_CODEC_MAX_QUOTIENT)) {
+      /* Infinite, NaN or too large */
+      break;
+    }
+    deltas[ivalue] = (uint64_t) (int64_t) floor (value / step + 0.5);
+  }
+  if (data_size % sizeof (double) != 0 || ivalue < num_values) {
+    /* This chunk cannot be quantized, we store it lossless */
+    T8_FREE (deltas);
+    out_bytes[0] = 0;
+    return 1 + t8_forest_codec_lossless_compress (codec, data_size,
+                                                  num_elements, in,
+                                                  out_bytes + 1);
+  }
+  /* Replace the quotients by the zigzag encoded differences to the
+   * previous element, beginning at the end */
+  for (ivalue = num_values; ivalue-- > 0;) {
+    quotient = (int64_t) deltas[ivalue];
+    if (ivalue >= num_components) {
+      quotient -= (int64_t) deltas[ivalue - num_components];
+    }
+    deltas[ivalue] = quotient < 0 ? ~((uint64_t) quotient << 1)
+      : (uint64_t) quotient << 1;
+  }
+  out_bytes[0] = 1;
+  memcpy (out_bytes + 1, &step, sizeof (double));
+  compressed =
+    t8_forest_codec_lossless_compress (codec, data_size, num_elements,
+                                       deltas,
+                                       out_bytes + 1 + sizeof (double));
+  T8_FREE (deltas);
+  return 1 + sizeof (double) + compressed;
+}
+
+static int
+t8_forest_codec_lossy_decompress (const t8_forest_codec_t * codec,
+                                  size_t data_size, size_t num_elements,
+                                  const void *in, size_t in_bytes,
+                                  void *out)
+{
+  const char         *in_bytes_data = (const char *) in;
+  uint64_t           *deltas, delta;
+  int64_t             quotient;
+  size_t              num_components, num_values, ivalue;
+  double              step, value;
+  int                 success;
+
+  if (in_bytes > 0 && in_bytes_data[0] == 0) {
+    return t8_forest_codec_lossless_decompress (codec, data_size,
+                                                num_elements,
+                                                in_bytes_data + 1,
+                                                in_bytes - 1, out);
+  }
+  if (in_bytes < 1 + sizeof (double) || in_bytes_data[0] != 1
+      || data_size % sizeof (double) != 0) {
+    return 0;
+  }
+  memcpy (&step, in_bytes_data + 1, sizeof (double));
+  num_components = data_size / sizeof (double);
+  num_values = num_components * num_elements;
+  deltas = T8_ALLOC (uint64_t, num_values);
+  success =
+    t8_forest_codec_lossless_decompress (codec, data_size, num_elements,
+                                         in_bytes_data + 1 + sizeof (double),
+                                         in_bytes - 1 - sizeof (double),
+                                         deltas);
+  for (ivalue = 0; success && ivalue < num_values; ivalue++) {
+    /* Undo the zigzag encoding and add the quotient of the previous
+     * element */
+    delta = deltas[ivalue];
+    quotient = (delta & 1) ? (int64_t) ~(delta >> 1) : (int64_t) (delta >> 1);
+    if (ivalue >= num_components) {
+      quotient += (int64_t) deltas[ivalue - num_components];
+    }
+    deltas[ivalue] = (uint64_t) quotient;
+    value = quotient * step;
+    memcpy ((char *) out + ivalue * sizeof (double), &value,
+            sizeof (double));
+  }
+  T8_FREE (deltas);
+  return success;
+}
+
+void
+t8_forest_codec_lossless (t8_forest_codec_t * codec, int level)
+{
+  T8_ASSERT (codec != NULL);
+  T8_ASSERT (-1 <= level && level <= 9);
+
+  memset (codec, 0, sizeof (t8_forest_codec_t));
+  codec->id = T8_FOREST_CODEC_LOSSLESS;
+  codec->bound = t8_forest_codec_lossless_bound;
+  codec->compress = t8_forest_codec_lossless_compress;
+  codec->decompress = t8_forest_codec_lossless_decompress;
+  codec->level = level;
+}
+
+void
+t8_forest_codec_lossy (t8_forest_codec_t * codec, double error_bound,
+                       int level)
+{
+  T8_ASSERT (codec != NULL);
+  T8_ASSERT (error_bound > 0);
+  T8_ASSERT (-1 <= level && level <= 9);
+
+  memset (codec, 0, sizeof (t8_forest_codec_t));
+  codec->id = T8_FOREST_CODEC_LOSSY;
+  codec->bound = t8_forest_codec_lossy_bound;
+  codec->compress = t8_forest_codec_lossy_compress;
+  codec->decompress = t8_forest_codec_lossy_decompress;
+  codec->level = level;
+  codec->error_bound = error_bound;
+}
+
+/* The offset of the user data in a forest file */
+static long long
+t8_forest_save_data_offset (const t8_forest_save_header_t * header)
+{
+  return t8_forest_save_ids_offset (header)
+    + header->num_elements * (sizeof (uint64_t) + sizeof (int8_t));
+}
+
+/* The offset of the raw elements of an eclass in a forest file */
+static long long
+t8_forest_save_elements_offset (const t8_forest_save_header_t * header,
+                                int eclass)
+{
+  long long           offset;
+  int                 iclass;
+
+  offset = t8_forest_save_data_offset (header) + header->data_bytes;
+  for (iclass = 0; iclass <= eclass; iclass++) {
+    offset = (offset + T8_FOREST_SAVE_ALIGN - 1)
+      / T8_FOREST_SAVE_ALIGN * T8_FOREST_SAVE_ALIGN;
+    if (iclass < eclass) {
+      offset += header->class_count[iclass] * header->element_size[iclass];
+    }
+  }
+  return offset;
+}
+
+/* Compress the user data of the local elements of a forest in chunks of
+ * consecutive elements of one tree. On output chunks holds the table
+ * entries of the local chunks with offsets relative to the local payload
+ * and payload holds their compressed data. */
+static void
+t8_forest_save_compress (t8_forest_t forest, size_t data_size,
+                         const void *data, const t8_forest_codec_t * codec,
+                         sc_array_t * chunks, sc_array_t * payload)
+{
+  t8_forest_save_chunk_t *chunk;
+  t8_locidx_t         itree, num_elems, start, count, tree_offset;
+  t8_gloidx_t         first_element;
+  size_t              bound, old_bytes, bytes;
+
+  first_element = t8_forest_get_first_local_element_id (forest);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    tree_offset = t8_forest_get_tree_element_offset (forest, itree);
+    num_elems = t8_forest_get_tree_num_elements (forest, itree);
+    /* A chunk never crosses a tree, such that the codec sees the data of
+     * neighboring elements of the space-filling curve */
+    for (start = 0; start < num_elems; start += count) {
+      count = SC_MIN (num_elems - start, T8_FOREST_SAVE_CHUNK_ELEMENTS);
+      chunk = (t8_forest_save_chunk_t *) sc_array_push (chunks);
+      chunk->first_element = first_element + tree_offset + start;
+      chunk->num_elements = count;
+      chunk->offset = payload->elem_count;
+      bound = codec->bound (codec, data_size, count);
+      old_bytes = payload->elem_count;
+      sc_array_resize (payload, old_bytes + bound);
+      bytes = codec->compress (codec, data_size, count, (const char *) data
+                               + (tree_offset + start) * data_size,
+                               payload->array + old_bytes);
+      SC_CHECK_ABORT (bytes <= bound, "Codec exceeded its compressed size");
+      sc_array_resize (payload, old_bytes + bytes);
+      chunk->bytes = bytes;
+    }
+  }
+}
+
+int
+t8_forest_save (t8_forest_t forest, const char *filename, size_t data_size,
+                const void *data)
+{
+  return t8_forest_save_ext (forest, filename, data_size, data, NULL);
+}
+
+int
+t8_forest_save_ext (t8_forest_t forest, const char *filename,
+                    size_t data_size, const void *data,
+                    const t8_forest_codec_t * codec)
+{
+  t8_forest_save_file_t fh;
+  t8_forest_save_header_t header;
+  t8_locidx_t         itree, num_local_trees, ielem, num_elems, ilocal;
+  t8_locidx_t         num_local_elements, first_owned_tree;
+  t8_gloidx_t         first_element;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  uint64_t           *ids;
+  int8_t             *levels;
+  int64_t            *tree_offsets, *class_offsets;
+  long long           local_counts[T8_ECLASS_COUNT];
+  long long           first_class_element[T8_ECLASS_COUNT];
+  long long           local_chunks[2], first_chunk[2], global_chunks[2];
+  sc_array_t          raw_elements[T8_ECLASS_COUNT];
+  sc_array_t          chunks, payload;
+  size_t              ichunk;
+  int                 level, iclass, mpiret, success = 0;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (data_size == 0 || data != NULL
+             || t8_forest_get_local_num_elements (forest) == 0);
+  T8_ASSERT (codec == NULL || codec->id > 0);
+
+  /* We need the elements to compute their linear ids */
+  t8_forest_decompress (forest);
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+
+  memset (&header, 0, sizeof (header));
+  header.magic = T8_FOREST_SAVE_MAGIC;
+  header.format = T8_FOREST_FORMAT;
+  header.dimension = forest->dimension;
+  header.num_trees = forest->global_num_trees;
+  header.num_elements = forest->global_num_elements;
+  header.data_size = data_size;
+  header.data_codec = codec != NULL && data_size > 0 ? codec->id : 0;
+  header.data_bytes = header.num_elements * (long long) data_size;
+
+  /* Compress the user data and count the chunks and their bytes globally
+   * and on smaller processes */
+  sc_array_init (&chunks, sizeof (t8_forest_save_chunk_t));
+  sc_array_init (&payload, sizeof (char));
+  if (header.data_codec != 0) {
+    t8_forest_save_compress (forest, data_size, data, codec, &chunks,
+                             &payload);
+    local_chunks[0] = chunks.elem_count;
+    local_chunks[1] = payload.elem_count;
+    mpiret = sc_MPI_Exscan (local_chunks, first_chunk, 2,
+                            sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                            forest->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (forest->mpirank == 0) {
+      first_chunk[0] = first_chunk[1] = 0;
+    }
+    mpiret = sc_MPI_Allreduce (local_chunks, global_chunks, 2,
+                               sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                               forest->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    for (ichunk = 0; ichunk < chunks.elem_count; ichunk++) {
+      ((t8_forest_save_chunk_t *) sc_array_index (&chunks, ichunk))->offset
+        += first_chunk[1];
+    }
+    header.num_data_chunks = global_chunks[0];
+    header.data_bytes = global_chunks[0] * sizeof (t8_forest_save_chunk_t)
+      + global_chunks[1];
+  }
+
+  /* Collect the linear ids and levels of the local elements and their
+   * raw memory sorted by eclass */
+  ids = T8_ALLOC (uint64_t, num_local_elements);
+  levels = T8_ALLOC (int8_t, num_local_elements);
+  tree_offsets = T8_ALLOC (int64_t, num_local_trees);
+  class_offsets = T8_ALLOC (int64_t, num_local_trees);
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    ts = forest->scheme_cxx->eclass_schemes[iclass];
+    header.element_size[iclass] = ts != NULL ? ts->t8_element_size () : 0;
+    sc_array_init (&raw_elements[iclass], SC_MAX (1,
+                                                  header.element_size
+                                                  [iclass]));
+  }
+  first_owned_tree = 0;
+  for (itree = 0, ilocal = 0; itree < num_local_trees; itree++) {
+    tree = t8_forest_get_tree (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree->eclass);
+    if (itree == 0 && ts->t8_element_get_linear_id (tree->first_desc,
+                                                    forest->maxlevel) > 0) {
+      /* The first element of this tree is on a smaller process */
+      first_owned_tree = 1;
+    }
+    tree_offsets[itree] =
+      first_element + t8_forest_get_tree_element_offset (forest, itree);
+    /* Shifted by the elements of this eclass on smaller processes below */
+    class_offsets[itree] = raw_elements[tree->eclass].elem_count;
+    num_elems = t8_forest_get_tree_num_elements (forest, itree);
+    memcpy (sc_array_push_count (&raw_elements[tree->eclass], num_elems),
+            t8_element_array_get_data (&tree->elements),
+            num_elems * ts->t8_element_size ());
+    for (ielem = 0; ielem < num_elems; ielem++, ilocal++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      level = ts->t8_element_level (element);
+      ids[ilocal] = ts->t8_element_get_linear_id (element, level);
+      levels[ilocal] = level;
+    }
+  }
+  T8_ASSERT (ilocal == num_local_elements);
+
+  /* Count the elements of each eclass globally and on smaller processes */
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    local_counts[iclass] = raw_elements[iclass].elem_count;
+  }
+  mpiret = sc_MPI_Exscan (local_counts, first_class_element, T8_ECLASS_COUNT,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (forest->mpirank == 0) {
+    /* The result of Exscan is undefined on the first process */
+    memset (first_class_element, 0, sizeof (first_class_element));
+  }
+  mpiret = sc_MPI_Allreduce (local_counts, header.class_count,
+                             T8_ECLASS_COUNT, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    class_offsets[itree] +=
+      first_class_element[t8_forest_get_tree (forest, itree)->eclass];
+  }
+
+  if (!t8_forest_save_open (&fh, filename, 1, forest->mpicomm)) {
+    t8_global_errorf ("Could not open file %s for writing.\n", filename);
+    goto t8_forest_save_cleanup;
+  }
+  t8_forest_save_write_at (&fh, 0, &header, forest->mpirank == 0 ?
+                           sizeof (t8_forest_save_header_t) : 0);
+  t8_forest_save_write_at (&fh, sizeof (t8_forest_save_header_t)
+                           + (forest->first_local_tree + first_owned_tree)
+                           * sizeof (int64_t), tree_offsets + first_owned_tree,
+                           (num_local_trees - first_owned_tree)
+                           * sizeof (int64_t));
+  t8_forest_save_write_at (&fh, sizeof (t8_forest_save_header_t)
+                           + (header.num_trees + forest->first_local_tree
+                              + first_owned_tree) * sizeof (int64_t),
+                           class_offsets + first_owned_tree,
+                           (num_local_trees - first_owned_tree)
+                           * sizeof (int64_t));
+  t8_forest_save_write_at (&fh, t8_forest_save_ids_offset (&header)
+                           + first_element * sizeof (uint64_t), ids,
+                           num_local_elements * sizeof (uint64_t));
+  t8_forest_save_write_at (&fh, t8_forest_save_ids_offset (&header)
+                           + header.num_elements * sizeof (uint64_t)
+                           + first_element, levels, num_local_elements);
+  if (header.data_codec != 0) {
+    t8_forest_save_write_at (&fh, t8_forest_save_data_offset (&header)
+                             + first_chunk[0]
+                             * sizeof (t8_forest_save_chunk_t),
+                             chunks.array, chunks.elem_count
+                             * sizeof (t8_forest_save_chunk_t));
+    t8_forest_save_write_at (&fh, t8_forest_save_data_offset (&header)
+                             + header.num_data_chunks
+                             * sizeof (t8_forest_save_chunk_t)
+                             + first_chunk[1], payload.array,
+                             payload.elem_count);
+  }
+  else if (data_size > 0) {
+    t8_forest_save_write_at (&fh, t8_forest_save_data_offset (&header)
+                             + first_element * (long long) data_size, data,
+                             num_local_elements * (long long) data_size);
+  }
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    t8_forest_save_write_at (&fh,
+                             t8_forest_save_elements_offset (&header, iclass)
+                             + first_class_element[iclass]
+                             * header.element_size[iclass],
+                             raw_elements[iclass].array,
+                             local_counts[iclass]
+                             * header.element_size[iclass]);
+  }
+  if (!t8_forest_save_close (&fh)) {
+    t8_global_errorf ("Error when writing file %s.\n", filename);
+    goto t8_forest_save_cleanup;
+  }
+  t8_global_productionf ("Saved forest with %lli global elements to %s.\n",
+                         (long long) header.num_elements, filename);
+  success = 1;
+
+t8_forest_save_cleanup:
+  T8_FREE (ids);
+  T8_FREE (levels);
+  T8_FREE (tree_offsets);
+  T8_FREE (class_offsets);
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    sc_array_reset (&raw_elements[iclass]);
+  }
+  sc_array_reset (&chunks);
+  sc_array_reset (&payload);
+  return success;
+}
+
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+/* Map the raw elements of the local trees of a forest from a file into
+ * memory. Each process maps one contiguous range per eclass.
+ * The mappings are private, such that the elements may be modified
+ * without changing the file. */
+static void
+t8_forest_load_mmap (t8_forest_t forest, const char *filename,
+                     const t8_forest_save_header_t * header,
+                     const t8_gloidx_t * tree_offsets,
+                     const t8_gloidx_t * class_offsets,
+                     t8_gloidx_t first_element, t8_gloidx_t end_element)
+{
+  t8_forest_mmap_region_t *region;
+  long long           first[T8_ECLASS_COUNT], end[T8_ECLASS_COUNT];
+  long long           offset, aligned_offset;
+  char               *class_data[T8_ECLASS_COUNT];
+  t8_gloidx_t         jt, start;
+  t8_tree_t           tree;
+  long                page_size;
+  int                 iclass, fd;
+
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    first[iclass] = end[iclass] = -1;
+    class_data[iclass] = NULL;
+  }
+  /* Find the range of the local elements of each eclass */
+  for (jt = forest->first_local_tree; jt <= forest->last_local_tree; jt++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees,
+                                                 jt -
+                                                 forest->first_local_tree);
+    start = class_offsets[jt]
+      + SC_MAX (first_element, tree_offsets[jt]) - tree_offsets[jt];
+    if (first[tree->eclass] < 0) {
+      first[tree->eclass] = start;
+    }
+    end[tree->eclass] = class_offsets[jt]
+      + SC_MIN (end_element, tree_offsets[jt + 1]) - tree_offsets[jt];
+  }
+
+  fd = open (filename, O_RDONLY);
+  SC_CHECK_ABORTF (fd >= 0, "Could not open forest file %s", filename);
+  page_size = sysconf (_SC_PAGESIZE);
+  forest->mmap_regions = sc_array_new (sizeof (t8_forest_mmap_region_t));
+  for (iclass = 0; iclass < T8_ECLASS_COUNT; iclass++) {
+    if (first[iclass] < 0) {
+      continue;
+    }
+    SC_CHECK_ABORTF (header->element_size[iclass] ==
+                     (int64_t) forest->scheme_cxx->eclass_schemes[iclass]->
+                     t8_element_size (),
+                     "Elements in forest file %s do not fit to the scheme",
+                     filename);
+    /* The offset of a mapping must be a multiple of the page size */
+    offset = t8_forest_save_elements_offset (header, iclass)
+      + first[iclass] * header->element_size[iclass];
+    aligned_offset = offset / page_size * page_size;
+    region = (t8_forest_mmap_region_t *)
+      sc_array_push (forest->mmap_regions);
+    region->length = offset - aligned_offset
+      + (end[iclass] - first[iclass]) * header->element_size[iclass];
+    region->address = mmap (NULL, region->length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE, fd, aligned_offset);
+    SC_CHECK_ABORTF (region->address != MAP_FAILED,
+                     "Could not map forest file %s", filename);
+    class_data[iclass] = (char *) region->address + (offset - aligned_offset);
+  }
+  close (fd);
+
+  /* Let the element arrays of the trees view the mapped memory */
+  for (jt = forest->first_local_tree; jt <= forest->last_local_tree; jt++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees,
+                                                 jt -
+                                                 forest->first_local_tree);
+    start = class_offsets[jt]
+      + SC_MAX (first_element, tree_offsets[jt]) - tree_offsets[jt];
+    t8_element_array_init_data (&tree->elements, (t8_element_t *)
+                                (class_data[tree->eclass]
+                                 + (start - first[tree->eclass])
+                                 * header->element_size[tree->eclass]),
+                                forest->scheme_cxx->
+                                eclass_schemes[tree->eclass],
+                                SC_MIN (end_element, tree_offsets[jt + 1])
+                                - SC_MAX (first_element, tree_offsets[jt]));
+  }
+}
+#endif
+
+void
+t8_forest_unmap_elements (t8_forest_t forest)
+{
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+  t8_forest_mmap_region_t *region;
+  size_t              iregion;
+
+  if (forest->mmap_regions == NULL) {
+    return;
+  }
+  for (iregion = 0; iregion < forest->mmap_regions->elem_count; iregion++) {
+    region = (t8_forest_mmap_region_t *)
+      sc_array_index (forest->mmap_regions, iregion);
+    munmap (region->address, region->length);
+  }
+  sc_array_destroy (forest->mmap_regions);
+  forest->mmap_regions = NULL;
+#else
+  T8_ASSERT (forest->mmap_regions == NULL);
+#endif
+}
+
+void
+t8_forest_load_elements (t8_forest_t forest)
+{
+  t8_forest_save_file_t fh;
+  t8_forest_save_header_t header;
+  t8_gloidx_t        *tree_offsets, *class_offsets, first_element;
+  t8_gloidx_t         end_element, jt, first_ctree, start, end;
+  t8_locidx_t         num_local_trees, num_local_elements, ielem, ilocal;
+  t8_tree_t           tree;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  uint64_t           *ids = NULL;
+  int8_t             *levels = NULL;
+  int                 do_mmap = forest->set_load_mmap;
+  const char         *filename = forest->set_load_file;
+
+  T8_ASSERT (filename != NULL);
+#if !defined(T8_HAVE_SYS_MMAN_H) || !defined(T8_HAVE_MMAP)
+  if (do_mmap) {
+    t8_global_errorf ("Warning: mmap is not available. "
+                      "Reading the elements of %s instead.\n", filename);
+    do_mmap = 0;
+  }
+#endif
+  SC_CHECK_ABORTF (t8_forest_save_open (&fh, filename, 0, forest->mpicomm),
+                   "Could not open forest file %s", filename);
+  SC_CHECK_ABORTF (t8_forest_save_read_header (&fh, &header),
+                   "File %s is no forest file of format %i", filename,
+                   T8_FOREST_FORMAT);
+  SC_CHECK_ABORTF (header.dimension == forest->dimension
+                   && header.num_trees ==
+                   t8_cmesh_get_num_trees (forest->cmesh),
+                   "Forest file %s does not fit to the coarse mesh",
+                   filename);
+
+  /* Read the offsets of all trees */
+  tree_offsets = T8_ALLOC (t8_gloidx_t, header.num_trees + 1);
+  t8_forest_save_read_at (&fh, sizeof (t8_forest_save_header_t),
+                          tree_offsets, header.num_trees * sizeof (int64_t));
+  tree_offsets[header.num_trees] = header.num_elements;
+  class_offsets = NULL;
+  if (do_mmap) {
+    class_offsets = T8_ALLOC (t8_gloidx_t, header.num_trees);
+  }
+  t8_forest_save_read_at (&fh, sizeof (t8_forest_save_header_t)
+                          + header.num_trees * sizeof (int64_t),
+                          class_offsets, do_mmap ?
+                          header.num_trees * sizeof (int64_t) : 0);
+
+  /* Distribute the elements evenly. We convert to doubles to
+   * prevent overflow, as in t8_forest_partition. */
+  first_element = ((long double) forest->mpirank * header.num_elements)
+    / (double) forest->mpisize;
+  end_element = forest->mpirank == forest->mpisize - 1 ? header.num_elements
+    : (t8_gloidx_t) (((long double) (forest->mpirank + 1)
+                      * header.num_elements) / (double) forest->mpisize);
+  num_local_elements = end_element - first_element;
+
+  if (!do_mmap) {
+    /* Read the linear ids and levels of our elements */
+    ids = T8_ALLOC (uint64_t, num_local_elements);
+    levels = T8_ALLOC (int8_t, num_local_elements);
+  }
+  t8_forest_save_read_at (&fh, t8_forest_save_ids_offset (&header)
+                          + first_element * sizeof (uint64_t), ids,
+                          do_mmap ? 0 : num_local_elements
+                          * sizeof (uint64_t));
+  t8_forest_save_read_at (&fh, t8_forest_save_ids_offset (&header)
+                          + header.num_elements * sizeof (uint64_t)
+                          + first_element, levels,
+                          do_mmap ? 0 : num_local_elements);
+  SC_CHECK_ABORTF (t8_forest_save_close (&fh),
+                   "Error when reading forest file %s", filename);
+
+  /* The last tree whose first element is at most first_element
+   * is our first tree, and similarly for the last tree. */
+  forest->first_local_tree =
+    std::upper_bound (tree_offsets, tree_offsets + header.num_trees,
+                      first_element) - tree_offsets - 1;
+  forest->last_local_tree =
+    std::upper_bound (tree_offsets, tree_offsets + header.num_trees,
+                      end_element - 1) - tree_offsets - 1;
+  if (num_local_elements == 0) {
+    /* This process is empty, we indicate this by a last tree smaller
+     * than the first tree */
+    forest->first_local_tree = SC_MAX (forest->first_local_tree, 0);
+    forest->last_local_tree = forest->first_local_tree - 1;
+  }
+  num_local_trees = forest->last_local_tree - forest->first_local_tree + 1;
+  first_ctree = t8_cmesh_get_first_treeid (forest->cmesh);
+  SC_CHECK_ABORT (num_local_trees == 0
+                  || (forest->first_local_tree >= first_ctree
+                      && forest->last_local_tree < first_ctree +
+                      t8_cmesh_get_num_local_trees (forest->cmesh)),
+                  "cmesh partition does not match the loaded forest partition");
+
+  /* Create the trees and their elements */
+  forest->trees =
+    sc_array_new_count (sizeof (t8_tree_struct_t), num_local_trees);
+  for (jt = forest->first_local_tree, ilocal = 0;
+       jt <= forest->last_local_tree; jt++) {
+    tree = (t8_tree_t) t8_sc_array_index_locidx (forest->trees,
+                                                 jt -
+                                                 forest->first_local_tree);
+    tree->eclass = t8_cmesh_get_tree_class (forest->cmesh, jt - first_ctree);
+    tree->elements_offset = ilocal;
+    tree->packed_elements = NULL;
+    tree->num_packed_elements = 0;
+    tree->shared = NULL;
+    ts = forest->scheme_cxx->eclass_schemes[tree->eclass];
+    T8_ASSERT (ts != NULL);
+    start = SC_MAX (first_element, tree_offsets[jt]);
+    end = SC_MIN (end_element, tree_offsets[jt + 1]);
+    SC_CHECK_ABORTF (start < end, "Empty tree %lli in forest file %s",
+                     (long long) jt, filename);
+    if (do_mmap) {
+      /* The elements are set to the mapped memory below */
+      ilocal += end - start;
+      continue;
+    }
+    t8_element_array_init_size (&tree->elements, ts, end - start);
+    for (ielem = 0; ielem < end - start; ielem++, ilocal++) {
+      SC_CHECK_ABORT (0 <= levels[ilocal]
+                      && levels[ilocal] <= forest->maxlevel,
+                      "Invalid element level in forest file");
+      element = t8_element_array_index_locidx (&tree->elements, ielem);
+      ts->t8_element_set_linear_id (element, levels[ilocal], ids[ilocal]);
+    }
+  }
+  T8_ASSERT (ilocal == num_local_elements);
+#if defined(T8_HAVE_SYS_MMAN_H) && defined(T8_HAVE_MMAP)
+  if (do_mmap) {
+    t8_forest_load_mmap (forest, filename, &header, tree_offsets,
+                         class_offsets, first_element, end_element);
+  }
+#endif
+  forest->local_num_elements = num_local_elements;
+  forest->global_num_elements = header.num_elements;
+  forest->global_num_trees = header.num_trees;
+
+  T8_FREE (ids);
+  T8_FREE (levels);
+  T8_FREE (tree_offsets);
+  T8_FREE (class_offsets);
+}
+
+/* Read the compressed user data of the elements first_element, ...,
+ * first_element + num_elements - 1 from a file. Each process reads the
+ * chunk table and the chunks that overlap its elements, and decompresses
+ * them. The data of chunks that are only partly ours is decompressed into
+ * a temporary buffer. */
+static void
+t8_forest_save_read_chunks (t8_forest_save_file_t * fh,
+                            const t8_forest_save_header_t * header,
+                            const t8_forest_codec_t * codec,
+                            t8_gloidx_t first_element,
+                            t8_locidx_t num_elements, size_t data_size,
+                            char *data)
+{
+  t8_forest_save_chunk_t *chunks, *chunk;
+  long long           num_chunks, first_chunk, end_chunk, ichunk;
+  long long           payload_start, payload_bytes, start, end, covered;
+  long long           data_offset;
+  char               *payload, *chunk_data;
+  int                 success;
+
+  num_chunks = header->num_data_chunks;
+  data_offset = t8_forest_save_data_offset (header);
+  chunks = T8_ALLOC (t8_forest_save_chunk_t, num_chunks);
+  t8_forest_save_read_at (fh, data_offset, chunks,
+                          num_chunks * sizeof (t8_forest_save_chunk_t));
+
+  /* The chunks are sorted by their first element */
+  for (first_chunk = 0; first_chunk < num_chunks
+       && chunks[first_chunk].first_element
+       + chunks[first_chunk].num_elements <= first_element; first_chunk++) {
+  }
+  for (end_chunk = first_chunk; num_elements > 0 && end_chunk < num_chunks
+       && chunks[end_chunk].first_element < first_element + num_elements;
+       end_chunk++) {
+  }
+  payload_start = payload_bytes = 0;
+  if (!fh->failed && first_chunk < end_chunk) {
+    payload_start = chunks[first_chunk].offset;
+    payload_bytes = chunks[end_chunk - 1].offset
+      + chunks[end_chunk - 1].bytes - payload_start;
+    fh->failed |= payload_start < 0 || payload_bytes < 0
+      || data_offset + num_chunks * (long long)
+      sizeof (t8_forest_save_chunk_t) + payload_start + payload_bytes
+      > data_offset + header->data_bytes;
+  }
+  if (fh->failed) {
+    payload_bytes = 0;
+  }
+  payload = T8_ALLOC (char, payload_bytes);
+  t8_forest_save_read_at (fh, data_offset + num_chunks
+                          * sizeof (t8_forest_save_chunk_t) + payload_start,
+                          payload, payload_bytes);
+
+  covered = 0;
+  for (ichunk = first_chunk; !fh->failed && ichunk < end_chunk; ichunk++) {
+    chunk = chunks + ichunk;
+    start = SC_MAX (chunk->first_element, first_element);
+    end = SC_MIN (chunk->first_element + chunk->num_elements,
+                  first_element + num_elements);
+    if (chunk->num_elements <= 0 || chunk->offset < payload_start
+        || chunk->offset + chunk->bytes > payload_start + payload_bytes) {
+      fh->failed = 1;
+      break;
+    }
+    if (start == chunk->first_element
+        && end == chunk->first_element + chunk->num_elements) {
+      /* The whole chunk is ours, we decompress it in place */
+      success = codec->decompress (codec, data_size, chunk->num_elements,
+                                   payload + chunk->offset - payload_start,
+                                   chunk->bytes, data + (start -
+                                                         first_element)
+                                   * data_size);
+    }
+    else {
+      chunk_data = T8_ALLOC (char, chunk->num_elements * data_size);
+      success = codec->decompress (codec, data_size, chunk->num_elements,
+                                   payload + chunk->offset - payload_start,
+                                   chunk->bytes, chunk_data);
+      if (success) {
+        memcpy (data + (start - first_element) * data_size,
+                chunk_data + (start - chunk->first_element) * data_size,
+                (end - start) * data_size);
+      }
+      T8_FREE (chunk_data);
+    }
+    fh->failed |= !success;
+    covered += end - start;
+  }
+  /* The chunks must cover all of our elements */
+  fh->failed |= covered != num_elements;
+  T8_FREE (chunks);
+  T8_FREE (payload);
+}
+
+int
+t8_forest_load_data (t8_forest_t forest, const char *filename,
+                     size_t data_size, void *data)
+{
+  return t8_forest_load_data_ext (forest, filename, data_size, data, NULL);
+}
+
+int
+t8_forest_load_data_ext (t8_forest_t forest, const char *filename,
+                         size_t data_size, void *data,
+                         const t8_forest_codec_t * codec)
+{
+  t8_forest_save_file_t fh;
+  t8_forest_save_header_t header;
+  t8_forest_codec_t   builtin;
+  int                 fits;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (filename != NULL);
+  T8_ASSERT (data_size > 0);
+  T8_ASSERT (data != NULL || t8_forest_get_local_num_elements (forest) == 0);
+
+  if (!t8_forest_save_open (&fh, filename, 0, forest->mpicomm)) {
+    t8_global_errorf ("Could not open file %s for reading.\n", filename);
+    return 0;
+  }
+  /* The header is the same on all processes, hence so is fits */
+  fits = t8_forest_save_read_header (&fh, &header)
+    && header.num_elements == forest->global_num_elements
+    && header.data_size == (int64_t) data_size;
+  if (fits && header.data_codec != 0 && codec == NULL) {
+    /* Data of the built-in codecs can be read without a codec.
+     * The lossy codec stores its quantization in the file. */
+    if (header.data_codec == T8_FOREST_CODEC_LOSSLESS) {
+      t8_forest_codec_lossless (&builtin, -1);
+      codec = &builtin;
+    }
+    else if (header.data_codec == T8_FOREST_CODEC_LOSSY) {
+      t8_forest_codec_lossy (&builtin, 1, -1);
+      codec = &builtin;
+    }
+  }
+  fits = fits && (header.data_codec == 0
+                  || (codec != NULL && codec->id == header.data_codec));
+  if (fits && header.data_codec != 0) {
+    t8_forest_save_read_chunks (&fh, &header, codec,
+                                t8_forest_get_first_local_element_id
+                                (forest),
+                                t8_forest_get_local_num_elements (forest),
+                                data_size, (char *) data);
+  }
+  else if (fits) {
+    t8_forest_save_read_at (&fh, t8_forest_save_data_offset (&header)
+                            + t8_forest_get_first_local_element_id (forest)
+                            * (long long) data_size, data,
+                            t8_forest_get_local_num_elements (forest)
+                            * (long long) data_size);
+  }
+  else {
+    t8_global_errorf ("The data in file %s does not fit to the forest.\n",
+                      filename);
+  }
+  return t8_forest_save_close (&fh) && fits;
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,120 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_save.h
+ * We define routines to save a forest to a checkpoint file and to
+ * construct a forest from it.
+ * The file stores, in this order and in native byte order,
+ *  - a header of type \ref t8_forest_save_header_t,
+ *  - for each global tree the global index of its first element (int64),
+ *  - for each global element its linear id (uint64) in global order,
+ *  - for each global element its refinement level (int8),
+ *  - for each global tree the index of its first element among the
+ *    elements of the same eclass (int64),
+ *  - for each global element its linear id (uint64) in global order,
+ *  - for each global element its refinement level (int8),
+ *  - optionally for each global element \a data_size bytes of user data,
+ *    or, if the data is compressed with a codec, a table of entries of
+ *    type \ref t8_forest_save_chunk_t followed by the compressed chunks,
+ *  - for each eclass the raw memory of its elements in global order,
+ *    starting at a multiple of \ref T8_FOREST_SAVE_ALIGN.
+ * Since the elements are stored independently of the partition, the
+ * file can be loaded on any number of processes.
+ * The linear ids and levels are independent of the element
+ * implementation. The raw elements can be mapped into memory without
+ * parsing them, if the file is loaded with the same scheme on the same
+ * architecture.
+ * \see t8_forest_save \see t8_forest_set_load \see t8_forest_set_load_mmap
+ */
+
+#ifndef T8_FOREST_SAVE_H
+#define T8_FOREST_SAVE_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+/** Increment this constant each time the file format changes.
+ *  We can only read files that were written in the same format. */
+#define T8_FOREST_FORMAT 0x0003
+
+/** The first 8 bytes of a forest checkpoint file, "t8forest" in ascii. */
+#define T8_FOREST_SAVE_MAGIC 0x7438666f72657374LL
+
+/** The alignment in bytes of the raw element sections of a forest file. */
+#define T8_FOREST_SAVE_ALIGN 64
+
+/** The header of a forest checkpoint file. */
+typedef struct t8_forest_save_header
+{
+  int64_t             magic;      /**< Always \ref T8_FOREST_SAVE_MAGIC. */
+  int64_t             format;     /**< The \ref T8_FOREST_FORMAT of the file. */
+  int64_t             dimension;  /**< The dimension of the forest. */
+  int64_t             num_trees;  /**< The global number of trees. */
+  int64_t             num_elements; /**< The global number of elements. */
+  int64_t             data_size;  /**< The number of bytes of user data per element. */
+  int64_t             element_size[T8_ECLASS_COUNT]; /**< The size of an element of each eclass. */
+  int64_t             class_count[T8_ECLASS_COUNT]; /**< The global number of elements of each eclass. */
+  int64_t             data_codec; /**< The id of the codec of the user data, 0 if uncompressed. */
+  int64_t             num_data_chunks; /**< The global number of compressed chunks. */
+  int64_t             data_bytes; /**< The number of bytes of the user data section. */
+} t8_forest_save_header_t;
+
+/** An entry of the chunk table of compressed user data.
+ * A chunk holds the data of consecutive elements of one tree. The chunks
+ * are stored in global element order. */
+typedef struct t8_forest_save_chunk
+{
+  int64_t             first_element; /**< The global index of the first element. */
+  int64_t             num_elements; /**< The number of elements. */
+  int64_t             offset;     /**< The position of the compressed data after the table. */
+  int64_t             bytes;      /**< The number of compressed bytes. */
+} t8_forest_save_chunk_t;
+
+/** A part of a forest file that is mapped into memory. */
+typedef struct t8_forest_mmap_region
+{
+  void               *address;  /**< The start of the mapping. */
+  size_t              length;   /**< The length of the mapping in bytes. */
+} t8_forest_mmap_region_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** Create the local elements of a forest from a checkpoint file.
+ * The elements are distributed evenly among the processes.
+ * \param [in,out] forest       A forest that is being committed and whose
+ *                              \a set_load_file is set. On output its trees
+ *                              and local and global number of elements are set.
+ * \note This function is collective and aborts if the file cannot be read
+ *       or does not fit to the coarse mesh of \a forest.
+ */
+void                t8_forest_load_elements (t8_forest_t forest);
+
+/** Unmap the memory of the elements of a forest if they were mapped from
+ * a file with \ref t8_forest_set_load_mmap.
+ * \param [in,out] forest       A forest whose trees were freed.
+ *                              On output its \a mmap_regions are NULL.
+ */
+void                t8_forest_unmap_elements (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_SAVE_H! */
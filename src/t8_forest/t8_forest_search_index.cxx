@@ -0,0 +1,178 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_search_index.h>
+#include <t8_element_cxx.hxx>
+#include <vector>
+
+/* Add the nodes of the search of element with the leafs leaf_elements to
+ * the search index. Returns the index of the node of element, or 0 if
+ * element is a leaf and thus has no node. Since the first node is the root
+ * of a tree, 0 is never the index of a child node. */
+static size_t
+t8_forest_search_index_node (t8_eclass_scheme_c * ts,
+                             const t8_element_t * element,
+                             t8_element_array_t * leaf_elements,
+                             std::vector < size_t > &node_offsets,
+                             std::vector < size_t > &split_offsets,
+                             std::vector < size_t > &child_nodes)
+{
+  t8_element_t       *children[T8_ECLASS_MAX_CHILDREN];
+  t8_element_t       *leaf;
+  t8_element_array_t  child_leafs;
+  t8_element_scratch_mark_t scratch_mark;
+  size_t              node, first_split, first_child, indexa, indexb;
+  int                 num_children, ichild;
+
+  T8_ASSERT (t8_element_array_get_count (leaf_elements) > 0);
+  if (t8_element_array_get_count (leaf_elements) == 1) {
+    leaf = t8_element_array_index_locidx (leaf_elements, 0);
+    if (ts->t8_element_level (element) == ts->t8_element_level (leaf)) {
+      /* The element is the leaf, it has no node */
+      return 0;
+    }
+  }
+
+  /* The children and split offsets of this node are appended */
+  node = node_offsets.size ();
+  num_children = ts->t8_element_num_children (element);
+  first_child = child_nodes.size ();
+  first_split = split_offsets.size ();
+  T8_ASSERT (first_split == first_child + node);
+  node_offsets.push_back (first_child);
+  child_nodes.resize (first_child + num_children, 0);
+  split_offsets.resize (first_split + num_children + 1);
+  t8_forest_split_array (element, leaf_elements, &split_offsets[first_split]);
+
+  scratch_mark = t8_element_scratch_mark ();
+  t8_element_scratch_new (ts, num_children, children);
+  ts->t8_element_children (element, num_children, children);
+  for (ichild = 0; ichild < num_children; ichild++) {
+    indexa = split_offsets[first_split + ichild];
+    indexb = split_offsets[first_split + ichild + 1];
+    if (indexa < indexb) {
+      t8_element_array_init_view (&child_leafs, leaf_elements, indexa,
+                                  indexb - indexa);
+      /* The vectors may be moved, thus we assign by index */
+      const size_t        child_node =
+        t8_forest_search_index_node (ts, children[ichild], &child_leafs,
+                                     node_offsets, split_offsets,
+                                     child_nodes);
+      child_nodes[first_child + ichild] = child_node;
+    }
+  }
+  t8_element_scratch_release (scratch_mark);
+  return node;
+}
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+void
+t8_forest_search_index_compute (t8_forest_t forest)
+{
+  t8_forest_search_index_t index;
+  t8_element_array_t *leaf_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *nca;
+  t8_locidx_t         num_local_trees, itree;
+  std::vector < size_t > node_offsets, split_offsets, child_nodes;
+  size_t              num_leafs;
+
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (forest->search_index == NULL);
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  index = forest->search_index =
+    T8_ALLOC_ZERO (t8_forest_search_index_struct_t, 1);
+  index->num_local_trees = num_local_trees;
+  index->tree_first_node = T8_ALLOC (size_t, num_local_trees + 1);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    index->tree_first_node[itree] = node_offsets.size ();
+    leaf_elements = t8_forest_tree_get_leafs (forest, itree);
+    num_leafs = t8_element_array_get_count (leaf_elements);
+    if (num_leafs == 0) {
+      continue;
+    }
+    /* The search starts at the nearest common ancestor of the leafs */
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    ts->t8_element_new (1, &nca);
+    ts->t8_element_nca (t8_element_array_index_locidx (leaf_elements, 0),
+                        t8_element_array_index_locidx (leaf_elements,
+                                                       num_leafs - 1), nca);
+    (void) t8_forest_search_index_node (ts, nca, leaf_elements,
+                                        node_offsets, split_offsets,
+                                        child_nodes);
+    ts->t8_element_destroy (1, &nca);
+  }
+  index->tree_first_node[num_local_trees] = node_offsets.size ();
+  index->num_nodes = node_offsets.size ();
+  node_offsets.push_back (child_nodes.size ());
+
+  /* Copy the nodes to arrays of the exact size */
+  index->node_offsets = T8_ALLOC (size_t, node_offsets.size ());
+  memcpy (index->node_offsets, &node_offsets[0],
+          node_offsets.size () * sizeof (size_t));
+  index->split_offsets = T8_ALLOC (size_t, split_offsets.size ());
+  if (!split_offsets.empty ()) {
+    memcpy (index->split_offsets, &split_offsets[0],
+            split_offsets.size () * sizeof (size_t));
+  }
+  index->child_nodes = T8_ALLOC (size_t, child_nodes.size ());
+  if (!child_nodes.empty ()) {
+    memcpy (index->child_nodes, &child_nodes[0],
+            child_nodes.size () * sizeof (size_t));
+  }
+}
+
+void
+t8_forest_search_index_destroy (t8_forest_t forest)
+{
+  t8_forest_search_index_t index;
+
+  T8_ASSERT (forest != NULL);
+  index = forest->search_index;
+  if (index == NULL) {
+    return;
+  }
+  T8_FREE (index->tree_first_node);
+  T8_FREE (index->node_offsets);
+  T8_FREE (index->split_offsets);
+  T8_FREE (index->child_nodes);
+  T8_FREE (index);
+  forest->search_index = NULL;
+}
+
+int
+t8_forest_has_search_index (t8_forest_t forest)
+{
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  return forest->search_index != NULL;
+}
+
+T8_EXTERN_C_END ();
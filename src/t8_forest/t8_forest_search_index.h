@@ -20,32 +20,31 @@
   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 */
 
-#include <t8_mesh.h>
-
-struct t8_mesh
-{
-  int                 t8_mesh_dummy;
-};
-
-t8_mesh_t          *
-t8_mesh_new (int dimension, t8_gloidx_t Kglobal, t8_locidx_t Klocal)
-{
-  return NULL;
-}
-
-/* setters */
-
-void
-t8_mesh_set_comm (t8_mesh_t * mesh, sc_MPI_Comm comm)
-{
-}
-
-void
-t8_mesh_build (t8_mesh_t * mesh)
-{
-}
-
-void
-t8_mesh_destroy (t8_mesh_t * mesh)
-{
-}
+/** \file t8_forest_search_index.h
+ * We define routines to compute and store the split offsets of the leaf
+ * arrays that are used in the top-down search of a forest.
+ * \see t8_forest_set_search_index
+ */
+
+#ifndef T8_FOREST_SEARCH_INDEX_H
+#define T8_FOREST_SEARCH_INDEX_H
+
+#include <t8.h>
+#include <t8_forest/t8_forest_types.h>
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the search index of a forest.
+ * \param [in,out] forest       A forest with local elements.
+ *                              On output its search index is set.
+ */
+void                t8_forest_search_index_compute (t8_forest_t forest);
+
+/** Free the memory of the search index of a forest, if it has one.
+ * \param [in,out] forest       A forest. On output its search index is NULL.
+ */
+void                t8_forest_search_index_destroy (t8_forest_t forest);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_SEARCH_INDEX_H! */
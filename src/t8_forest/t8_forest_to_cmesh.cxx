@@ -0,0 +1,424 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_to_cmesh.cxx
+ * We convert the elements of a forest at a given level into the trees
+ * of a new cmesh.
+ * \see t8_forest_to_cmesh
+ */
+
+#include <t8_forest.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_types.h>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* A tree of the new cmesh. Its faces are given in the face numbering of
+ * the element that it is built from, since the vertices of the tree may
+ * be reordered. */
+typedef struct
+{
+  t8_gloidx_t         global_id;        /* The global id of the tree. */
+  /* The global ids of the face neighbors, -1 at the domain boundary. */
+  t8_gloidx_t         neighbor[T8_ECLASS_MAX_FACES];
+  /* The vertex coordinates of the tree. */
+  double              vertices[3 * T8_ECLASS_MAX_CORNERS];
+  /* The element face numbers of the neighbors at each face. */
+  int8_t              neighbor_face[T8_ECLASS_MAX_FACES];
+  /* For each element face the tree face with the same vertices. */
+  int8_t              face_map[T8_ECLASS_MAX_FACES];
+  int8_t              eclass;   /* The class of the tree. */
+} t8_forest_to_cmesh_tree_t;
+
+/* Compute a value whose sign is the orientation of the vertices of
+ * an element of a given class. For 3D classes it is negative if and only
+ * if \ref t8_cmesh_tree_vertices_negative_volume is true. */
+static double
+t8_forest_to_cmesh_orientation_sign (t8_eclass_t eclass, double *vertices)
+{
+  switch (t8_eclass_to_dimension[eclass]) {
+  case 0:
+    return 1;
+  case 1:
+    return vertices[3] - vertices[0];
+  case 2:
+    return (vertices[3] - vertices[0]) * (vertices[7] - vertices[1])
+      - (vertices[4] - vertices[1]) * (vertices[6] - vertices[0]);
+  default:
+    return t8_cmesh_tree_vertices_negative_volume (eclass, vertices,
+                                                   t8_eclass_num_vertices
+                                                   [eclass]) ? -1 : 1;
+  }
+}
+
+/* Swap two vertices of an element. */
+static void
+t8_forest_to_cmesh_swap_vertices (double *vertices, int v1, int v2)
+{
+  double              temp[3];
+
+  memcpy (temp, vertices + 3 * v1, sizeof (temp));
+  memcpy (vertices + 3 * v1, vertices + 3 * v2, sizeof (temp));
+  memcpy (vertices + 3 * v2, temp, sizeof (temp));
+}
+
+/* Renumber the vertices of an element such that it is mirrored,
+ * as in cmesh refinement. */
+static void
+t8_forest_to_cmesh_mirror (t8_eclass_t eclass, double *vertices)
+{
+  T8_ASSERT (t8_eclass_to_dimension[eclass] >= 2);
+
+  t8_forest_to_cmesh_swap_vertices (vertices, 1, 2);
+  if (eclass == T8_ECLASS_PRISM) {
+    t8_forest_to_cmesh_swap_vertices (vertices, 4, 5);
+  }
+  else if (eclass == T8_ECLASS_HEX) {
+    t8_forest_to_cmesh_swap_vertices (vertices, 5, 6);
+  }
+}
+
+/* Return true if the vertex iv of vertices_a is one of the vertices
+ * of a face of an element of class eclass_b. */
+static int
+t8_forest_to_cmesh_is_face_vertex (const double *vertices_a, int iv,
+                                   t8_eclass_t eclass_b,
+                                   const double *vertices_b, int face_b)
+{
+  int                 num_corners, icorner;
+
+  num_corners = t8_eclass_num_vertices[t8_eclass_face_types[eclass_b]
+                                       [face_b]];
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    if (!memcmp (vertices_a + 3 * iv, vertices_b +
+                 3 * t8_face_vertex_to_tree_vertex[eclass_b][face_b]
+                 [icorner], 3 * sizeof (double))) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Given the vertices of an element and the reordered vertices of the
+ * tree built from it, compute for each element face the tree face with
+ * the same vertices. */
+static void
+t8_forest_to_cmesh_face_map (t8_eclass_t eclass,
+                             const double *elem_vertices,
+                             t8_forest_to_cmesh_tree_t * tree)
+{
+  int                 iface, tface, num_corners, icorner;
+
+  for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+    num_corners = t8_eclass_num_vertices[t8_eclass_face_types[eclass]
+                                         [iface]];
+    for (tface = 0; tface < t8_eclass_num_faces[eclass]; tface++) {
+      for (icorner = 0; icorner < num_corners &&
+           t8_forest_to_cmesh_is_face_vertex (elem_vertices,
+                                              t8_face_vertex_to_tree_vertex
+                                              [eclass][iface][icorner],
+                                              eclass, tree->vertices, tface);
+           icorner++) {
+      }
+      if (icorner == num_corners) {
+        break;
+      }
+    }
+    T8_ASSERT (tface < t8_eclass_num_faces[eclass]);
+    tree->face_map[iface] = tface;
+  }
+}
+
+/* Compute the orientation of a face connection between two trees.
+ * The orientation is the number of the vertex of the bigger face that
+ * coincides with the first vertex of the smaller one, as in cmesh
+ * refinement. Since the faces may be periodic, we compare the vertices
+ * relative to the face centers. */
+static int
+t8_forest_to_cmesh_orientation (const t8_forest_to_cmesh_tree_t * tree_a,
+                                int face_a,
+                                const t8_forest_to_cmesh_tree_t * tree_b,
+                                int face_b)
+{
+  const t8_forest_to_cmesh_tree_t *trees[2] = { tree_a, tree_b };
+  const int           faces[2] = { face_a, face_b };
+  double              corners[2][T8_ECLASS_MAX_CORNERS_2D][3];
+  double              center[3], dist, min_dist = -1;
+  t8_eclass_t         eclass;
+  int                 compare, num_corners, i, icorner, idim, smaller;
+  int                 orientation = -1;
+
+  eclass = (t8_eclass_t) tree_a->eclass;
+  num_corners = t8_eclass_num_vertices[t8_eclass_face_types[eclass][face_a]];
+  /* Compute the face corners relative to the face centers */
+  for (i = 0; i < 2; i++) {
+    eclass = (t8_eclass_t) trees[i]->eclass;
+    memset (center, 0, sizeof (center));
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      memcpy (corners[i][icorner], trees[i]->vertices +
+              3 * t8_face_vertex_to_tree_vertex[eclass][faces[i]][icorner],
+              3 * sizeof (double));
+      for (idim = 0; idim < 3; idim++) {
+        center[idim] += corners[i][icorner][idim] / num_corners;
+      }
+    }
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      for (idim = 0; idim < 3; idim++) {
+        corners[i][icorner][idim] -= center[idim];
+      }
+    }
+  }
+  compare = t8_eclass_compare ((t8_eclass_t) tree_a->eclass,
+                               (t8_eclass_t) tree_b->eclass);
+  smaller = compare < 0 || (compare == 0 && face_a <= face_b) ? 0 : 1;
+  /* Find the corner of the bigger face that is closest to the first
+   * corner of the smaller face */
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    dist = 0;
+    for (idim = 0; idim < 3; idim++) {
+      dist += (corners[smaller][0][idim] - corners[1 - smaller][icorner][idim])
+        * (corners[smaller][0][idim] - corners[1 - smaller][icorner][idim]);
+    }
+    if (min_dist < 0 || dist < min_dist) {
+      min_dist = dist;
+      orientation = icorner;
+    }
+  }
+  return orientation;
+}
+
+/* Build the tree of the new cmesh from an element of a local tree. */
+static void
+t8_forest_to_cmesh_tree (t8_forest_t forest, t8_locidx_t ltreeid,
+                         const t8_element_t * elem, int level,
+                         const t8_gloidx_t * tree_offsets,
+                         t8_forest_to_cmesh_tree_t * tree)
+{
+  t8_eclass_t         tree_class, eclass, neigh_class;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t       *neigh;
+  t8_gloidx_t         gneigh;
+  double             *tree_vertices;
+  double              elem_vertices[3 * T8_ECLASS_MAX_CORNERS];
+  int                 iv, iface, neigh_face;
+
+  tree_class = t8_forest_get_tree_class (forest, ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest, tree_class);
+  eclass = (t8_eclass_t) ts->t8_element_shape (elem);
+  tree->eclass = eclass;
+  tree->global_id = tree_offsets[t8_forest_global_tree_id (forest, ltreeid)]
+    + ts->t8_element_get_linear_id (elem, level);
+
+  /* Compute the vertices. If the element is not oriented as its tree,
+   * we reorder them. */
+  tree_vertices = t8_forest_get_tree_vertices (forest, ltreeid);
+  for (iv = 0; iv < t8_eclass_num_vertices[eclass]; iv++) {
+    t8_forest_element_coordinate (forest, ltreeid, elem, tree_vertices, iv,
+                                  elem_vertices + 3 * iv);
+  }
+  memcpy (tree->vertices, elem_vertices,
+          3 * t8_eclass_num_vertices[eclass] * sizeof (double));
+  if (t8_forest_to_cmesh_orientation_sign (eclass, elem_vertices) *
+      t8_forest_to_cmesh_orientation_sign (tree_class, tree_vertices) < 0) {
+    t8_forest_to_cmesh_mirror (eclass, tree->vertices);
+  }
+  t8_forest_to_cmesh_face_map (eclass, elem_vertices, tree);
+
+  /* Compute the face neighbors. They have the same level as elem. */
+  for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+    neigh_class = t8_forest_element_neighbor_eclass (forest, ltreeid, elem,
+                                                     iface);
+    neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+    neigh_scheme->t8_element_new (1, &neigh);
+    gneigh = t8_forest_element_face_neighbor (forest, ltreeid, elem, neigh,
+                                              neigh_scheme, iface,
+                                              &neigh_face);
+    if (gneigh >= 0) {
+      tree->neighbor[iface] = tree_offsets[gneigh] +
+        neigh_scheme->t8_element_get_linear_id (neigh, level);
+      tree->neighbor_face[iface] = neigh_face;
+    }
+    else {
+      tree->neighbor[iface] = -1;
+      tree->neighbor_face[iface] = -1;
+    }
+    neigh_scheme->t8_element_destroy (1, &neigh);
+  }
+}
+
+/* Compute for each global tree of a forest the global id of the first
+ * tree of the new cmesh that is built from it. */
+static t8_gloidx_t *
+t8_forest_to_cmesh_tree_offsets (t8_forest_t forest, int level)
+{
+  t8_gloidx_t         num_global_trees, *counts, *offsets, igtree;
+  t8_locidx_t         ltreeid;
+  t8_eclass_scheme_c *ts;
+  int                 mpiret;
+
+  num_global_trees = t8_forest_get_num_global_trees (forest);
+  counts = T8_ALLOC_ZERO (t8_gloidx_t, num_global_trees);
+  offsets = T8_ALLOC (t8_gloidx_t, num_global_trees + 1);
+  for (ltreeid = 0; ltreeid < t8_forest_get_num_local_trees (forest);
+       ltreeid++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltreeid));
+    counts[t8_forest_global_tree_id (forest, ltreeid)] =
+      ts->t8_element_count_leafs_from_root (level);
+  }
+  /* Each tree is local on at least one process, so we get all counts */
+  mpiret = sc_MPI_Allreduce (counts, offsets, num_global_trees,
+                             T8_MPI_GLOIDX, sc_MPI_MAX, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  memcpy (counts, offsets, num_global_trees * sizeof (t8_gloidx_t));
+  offsets[0] = 0;
+  for (igtree = 0; igtree < num_global_trees; igtree++) {
+    offsets[igtree + 1] = offsets[igtree] + counts[igtree];
+  }
+  T8_FREE (counts);
+  return offsets;
+}
+
+t8_cmesh_t
+t8_forest_to_cmesh (t8_forest_t forest, int level)
+{
+  t8_cmesh_t          cmesh;
+  t8_locidx_t         ltreeid, ielem, num_elems;
+  t8_linearidx_t      id, last_id;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *elem, *ancestor;
+  t8_gloidx_t        *tree_offsets;
+  t8_forest_to_cmesh_tree_t *trees, *all_trees, *tree, *neigh;
+  size_t              num_trees, num_all_trees, itree, ineigh;
+  int                *counts, *displs, num_bytes, iproc, iface, tface;
+  int                 mpiret;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (level >= 0);
+
+  /* Build the trees of the local elements. A tree may be built on two
+   * processes if the elements in it are partitioned. */
+  tree_offsets = t8_forest_to_cmesh_tree_offsets (forest, level);
+  num_trees = 0;
+  trees = T8_ALLOC (t8_forest_to_cmesh_tree_t,
+                    t8_forest_get_local_num_elements (forest));
+  for (ltreeid = 0; ltreeid < t8_forest_get_num_local_trees (forest);
+       ltreeid++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltreeid));
+    ts->t8_element_new (1, &ancestor);
+    num_elems = t8_forest_get_tree_num_elements (forest, ltreeid);
+    last_id = 0;
+    for (ielem = 0; ielem < num_elems; ielem++) {
+      elem = t8_forest_get_element_in_tree (forest, ltreeid, ielem);
+      SC_CHECK_ABORT (ts->t8_element_level (elem) >= level,
+                      "Forest elements must not be coarser than the "
+                      "level of the cmesh.");
+      id = ts->t8_element_get_linear_id (elem, level);
+      if (ielem == 0 || id != last_id) {
+        /* This is the first element in a new tree */
+        ts->t8_element_set_linear_id (ancestor, level, id);
+        t8_forest_to_cmesh_tree (forest, ltreeid, ancestor, level,
+                                 tree_offsets, trees + num_trees++);
+        last_id = id;
+      }
+    }
+    ts->t8_element_destroy (1, &ancestor);
+  }
+  T8_FREE (tree_offsets);
+
+  /* Collect the trees on all processes */
+  counts = T8_ALLOC (int, forest->mpisize);
+  displs = T8_ALLOC (int, forest->mpisize);
+  num_bytes = num_trees * sizeof (t8_forest_to_cmesh_tree_t);
+  mpiret = sc_MPI_Allgather (&num_bytes, 1, sc_MPI_INT, counts, 1,
+                             sc_MPI_INT, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  displs[0] = 0;
+  for (iproc = 1; iproc < forest->mpisize; iproc++) {
+    displs[iproc] = displs[iproc - 1] + counts[iproc - 1];
+  }
+  num_all_trees = (displs[forest->mpisize - 1] + counts[forest->mpisize - 1])
+    / sizeof (t8_forest_to_cmesh_tree_t);
+  all_trees = T8_ALLOC (t8_forest_to_cmesh_tree_t, num_all_trees);
+  mpiret = sc_MPI_Allgatherv (trees, num_bytes, sc_MPI_BYTE, all_trees,
+                              counts, displs, sc_MPI_BYTE, forest->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  T8_FREE (trees);
+  T8_FREE (counts);
+  T8_FREE (displs);
+
+  /* The trees are sorted by global id. We remove the trees that were
+   * built on more than one process. */
+  num_trees = 0;
+  for (itree = 0; itree < num_all_trees; itree++) {
+    if (num_trees == 0 ||
+        all_trees[itree].global_id != all_trees[num_trees - 1].global_id) {
+      if (itree != num_trees) {
+        all_trees[num_trees] = all_trees[itree];
+      }
+      num_trees++;
+    }
+  }
+  T8_ASSERT (num_trees == 0
+             || all_trees[num_trees - 1].global_id == (t8_gloidx_t)
+             num_trees - 1);
+
+  t8_cmesh_init (&cmesh);
+  for (itree = 0; itree < num_trees; itree++) {
+    tree = all_trees + itree;
+    t8_cmesh_set_tree_class (cmesh, itree, (t8_eclass_t) tree->eclass);
+    t8_cmesh_set_tree_vertices (cmesh, itree, t8_get_package_id (), 0,
+                                tree->vertices,
+                                t8_eclass_num_vertices[tree->eclass]);
+    for (iface = 0; iface < t8_eclass_num_faces[tree->eclass]; iface++) {
+      if (tree->neighbor[iface] < 0) {
+        continue;
+      }
+      ineigh = tree->neighbor[iface];
+      neigh = all_trees + ineigh;
+      tface = tree->face_map[iface];
+      /* Each connection is set once, from the tree with smaller id or
+       * from the smaller face of a tree connected to itself */
+      if (ineigh > itree || (ineigh == itree && tface <
+                             neigh->face_map[tree->neighbor_face[iface]])) {
+        t8_cmesh_set_join (cmesh, itree, ineigh, tface,
+                           neigh->face_map[tree->neighbor_face[iface]],
+                           t8_forest_to_cmesh_orientation (tree, tface, neigh,
+                                                           neigh->face_map
+                                                           [tree->neighbor_face
+                                                            [iface]]));
+      }
+    }
+  }
+  /* The tree vertices are not copied before commit */
+  t8_cmesh_commit (cmesh, forest->mpicomm);
+  T8_FREE (all_trees);
+  return cmesh;
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,445 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_transfer.cxx
+ * Transfer element data between two forests on the same coarse mesh that
+ * are refined and partitioned independently.
+ * \see t8_forest_transfer_new
+ */
+
+#include <vector>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* A leaf of a forest given by its global tree id and the linear ids of
+ * its first and last descendant at the maximum level. */
+typedef struct
+{
+  t8_gloidx_t         tree;
+  t8_linearidx_t      first;
+  t8_linearidx_t      last;
+} t8_forest_transfer_leaf_t;
+
+/* The position of the first leaf of a process on the space-filling curve. */
+typedef struct
+{
+  t8_gloidx_t         tree;
+  t8_linearidx_t      id;
+  int                 empty;
+} t8_forest_transfer_key_t;
+
+struct t8_forest_transfer
+{
+  sc_MPI_Comm         comm;
+  t8_locidx_t         num_from;         /* Local elements of forest_from */
+  t8_locidx_t         num_to;           /* Local elements of forest_to */
+  int                 num_send;         /* Number of processes we send to */
+  int                *send_ranks;
+  t8_locidx_t        *send_first;       /* First local element sent to each process */
+  t8_locidx_t        *send_count;       /* Number of elements sent to each process */
+  int                 num_recv;         /* Number of processes we receive from */
+  int                *recv_ranks;
+  t8_locidx_t        *recv_offsets;     /* num_recv + 1 offsets into the received leaves */
+  t8_locidx_t         num_pairs;        /* Overlaps of received and local leaves */
+  t8_locidx_t        *pair_recv;        /* Index of the received leaf */
+  t8_locidx_t        *pair_to;          /* Local element of forest_to */
+  double             *pair_weight;      /* Number of common maxlevel descendants */
+};
+
+/* Return true if the position (tree_a, id_a) is before (tree_b, id_b). */
+static inline int
+t8_forest_transfer_less (t8_gloidx_t tree_a, t8_linearidx_t id_a,
+                         t8_gloidx_t tree_b, t8_linearidx_t id_b)
+{
+  return tree_a < tree_b || (tree_a == tree_b && id_a < id_b);
+}
+
+/* Collect the local leaves of a forest in SFC order. */
+static void
+t8_forest_transfer_leaves (t8_forest_t forest,
+                           std::vector < t8_forest_transfer_leaf_t >
+                           &leaves)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *desc;
+  const t8_element_t *element;
+  t8_forest_transfer_leaf_t leaf;
+  t8_locidx_t         num_trees, itree, num_elements, ielement;
+  const int           maxlevel = t8_forest_get_maxlevel (forest);
+
+  leaves.clear ();
+  leaves.reserve (t8_forest_get_local_num_elements (forest));
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    ts->t8_element_new (1, &desc);
+    leaf.tree = t8_forest_global_tree_id (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      ts->t8_element_first_descendant (element, desc, maxlevel);
+      leaf.first = ts->t8_element_get_linear_id (desc, maxlevel);
+      ts->t8_element_last_descendant (element, desc, maxlevel);
+      leaf.last = ts->t8_element_get_linear_id (desc, maxlevel);
+      leaves.push_back (leaf);
+    }
+    ts->t8_element_destroy (1, &desc);
+  }
+}
+
+/* Gather the first position of each process on the space-filling curve.
+ * On output starts has mpisize + 1 entries and the leaves of process p
+ * are in [starts[p], starts[p + 1]). Empty processes get the start of the
+ * next nonempty process, such that their range is empty. */
+static void
+t8_forest_transfer_starts (t8_forest_t forest,
+                           const std::vector < t8_forest_transfer_leaf_t >
+                           &leaves,
+                           std::vector < t8_forest_transfer_key_t > &starts)
+{
+  t8_forest_transfer_key_t mykey;
+  int                 mpisize, mpiret, iproc;
+
+  mpiret = sc_MPI_Comm_size (t8_forest_get_mpicomm (forest), &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  mykey.empty = leaves.empty ();
+  mykey.tree = mykey.empty ? 0 : leaves[0].tree;
+  mykey.id = mykey.empty ? 0 : leaves[0].first;
+  starts.resize (mpisize + 1);
+  mpiret = sc_MPI_Allgather (&mykey, sizeof (t8_forest_transfer_key_t),
+                             sc_MPI_BYTE, starts.data (),
+                             sizeof (t8_forest_transfer_key_t), sc_MPI_BYTE,
+                             t8_forest_get_mpicomm (forest));
+  SC_CHECK_MPI (mpiret);
+
+  /* The end of the last process is the end of the last tree */
+  starts[mpisize].tree = t8_forest_get_num_global_trees (forest);
+  starts[mpisize].id = 0;
+  starts[mpisize].empty = 0;
+  for (iproc = mpisize - 1; iproc >= 0; iproc--) {
+    if (starts[iproc].empty) {
+      starts[iproc] = starts[iproc + 1];
+      starts[iproc].empty = 1;
+    }
+  }
+}
+
+/* Return true if the range of process p in starts_a overlaps the range of
+ * process q in starts_b. */
+static int
+t8_forest_transfer_overlap (const std::vector < t8_forest_transfer_key_t >
+                            &starts_a, int p,
+                            const std::vector < t8_forest_transfer_key_t >
+                            &starts_b, int q)
+{
+  if (starts_a[p].empty || starts_b[q].empty) {
+    return 0;
+  }
+  return t8_forest_transfer_less (starts_a[p].tree, starts_a[p].id,
+                                  starts_b[q + 1].tree, starts_b[q + 1].id)
+    && t8_forest_transfer_less (starts_b[q].tree, starts_b[q].id,
+                                starts_a[p + 1].tree, starts_a[p + 1].id);
+}
+
+/* Return the first leaf in [first, last) that does not end (if use_last is
+ * true) or start (if use_last is false) before key. The leaves are sorted. */
+static const t8_forest_transfer_leaf_t *
+t8_forest_transfer_search (const t8_forest_transfer_leaf_t *first,
+                           const t8_forest_transfer_leaf_t *last,
+                           const t8_forest_transfer_key_t *key, int use_last)
+{
+  const t8_forest_transfer_leaf_t *middle;
+
+  while (first < last) {
+    middle = first + (last - first) / 2;
+    if (t8_forest_transfer_less (middle->tree,
+                                 use_last ? middle->last : middle->first,
+                                 key->tree, key->id)) {
+      first = middle + 1;
+    }
+    else {
+      last = middle;
+    }
+  }
+  return first;
+}
+
+t8_forest_transfer_t
+t8_forest_transfer_new (t8_forest_t forest_from, t8_forest_t forest_to)
+{
+  t8_forest_transfer_t transfer;
+  std::vector < t8_forest_transfer_leaf_t > leaves_from, leaves_to;
+  std::vector < t8_forest_transfer_leaf_t > leaves_recv;
+  std::vector < t8_forest_transfer_key_t > starts_from, starts_to;
+  std::vector < sc_MPI_Request > requests;
+  std::vector < t8_locidx_t > pair_recv, pair_to;
+  std::vector < double >pair_weight;
+  sc_MPI_Comm         comm;
+  sc_MPI_Status       status;
+  const t8_forest_transfer_leaf_t *first, *last;
+  int                 mpisize, mpirank, mpiret, iproc, count;
+  size_t              irecv, ito;
+
+  T8_ASSERT (t8_forest_is_committed (forest_from));
+  T8_ASSERT (t8_forest_is_committed (forest_to));
+  comm = t8_forest_get_mpicomm (forest_from);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  {
+    int                 size_to;
+    mpiret = sc_MPI_Comm_size (t8_forest_get_mpicomm (forest_to), &size_to);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (size_to == mpisize,
+                    "Forests must live on the same communicator.");
+  }
+  SC_CHECK_ABORT (t8_forest_get_num_global_trees (forest_from)
+                  == t8_forest_get_num_global_trees (forest_to),
+                  "Forests must have the same coarse mesh.");
+  SC_CHECK_ABORT (t8_forest_get_maxlevel (forest_from)
+                  == t8_forest_get_maxlevel (forest_to),
+                  "Forests must have the same maximum level.");
+
+  transfer = T8_ALLOC_ZERO (struct t8_forest_transfer, 1);
+  transfer->comm = comm;
+  transfer->num_from = t8_forest_get_local_num_elements (forest_from);
+  transfer->num_to = t8_forest_get_local_num_elements (forest_to);
+
+  t8_forest_transfer_leaves (forest_from, leaves_from);
+  t8_forest_transfer_leaves (forest_to, leaves_to);
+  t8_forest_transfer_starts (forest_from, leaves_from, starts_from);
+  t8_forest_transfer_starts (forest_to, leaves_to, starts_to);
+
+  /* For each process whose target range overlaps our source range, find
+   * the contiguous range of our leaves that overlaps and send their
+   * descriptions. */
+  transfer->send_ranks = T8_ALLOC (int, mpisize);
+  transfer->send_first = T8_ALLOC (t8_locidx_t, mpisize);
+  transfer->send_count = T8_ALLOC (t8_locidx_t, mpisize);
+  first = leaves_from.data ();
+  last = leaves_from.data () + leaves_from.size ();
+  for (iproc = 0; iproc < mpisize; iproc++) {
+    const t8_forest_transfer_key_t *key_begin = &starts_to[iproc];
+    const t8_forest_transfer_key_t *key_end = &starts_to[iproc + 1];
+    const t8_forest_transfer_leaf_t *begin, *end;
+
+    if (!t8_forest_transfer_overlap (starts_from, mpirank, starts_to, iproc)) {
+      continue;
+    }
+    /* The leaves that end at or after the start of the range and start
+     * before its end */
+    begin = t8_forest_transfer_search (first, last, key_begin, 1);
+    end = t8_forest_transfer_search (begin, last, key_end, 0);
+    T8_ASSERT (begin < end);
+    transfer->send_ranks[transfer->num_send] = iproc;
+    transfer->send_first[transfer->num_send] = begin - leaves_from.data ();
+    transfer->send_count[transfer->num_send] = end - begin;
+    transfer->num_send++;
+    /* The last leaf may overlap the range of the next process as well */
+    first = end - 1;
+  }
+  requests.resize (transfer->num_send);
+  for (iproc = 0; iproc < transfer->num_send; iproc++) {
+    mpiret = sc_MPI_Isend (leaves_from.data () + transfer->send_first[iproc],
+                           transfer->send_count[iproc]
+                           * sizeof (t8_forest_transfer_leaf_t), sc_MPI_BYTE,
+                           transfer->send_ranks[iproc],
+                           T8_MPI_FOREST_TRANSFER, comm, &requests[iproc]);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* Receive the leaf descriptions of all processes whose source range
+   * overlaps our target range in ascending order, such that the received
+   * leaves are in SFC order. */
+  transfer->recv_ranks = T8_ALLOC (int, mpisize);
+  transfer->recv_offsets = T8_ALLOC (t8_locidx_t, mpisize + 1);
+  transfer->recv_offsets[0] = 0;
+  for (iproc = 0; iproc < mpisize; iproc++) {
+    if (!t8_forest_transfer_overlap (starts_from, iproc, starts_to, mpirank)) {
+      continue;
+    }
+    mpiret = sc_MPI_Probe (iproc, T8_MPI_FOREST_TRANSFER, comm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &count);
+    SC_CHECK_MPI (mpiret);
+    T8_ASSERT (count > 0 && count % sizeof (t8_forest_transfer_leaf_t) == 0);
+    irecv = leaves_recv.size ();
+    leaves_recv.resize (irecv + count / sizeof (t8_forest_transfer_leaf_t));
+    mpiret = sc_MPI_Recv (leaves_recv.data () + irecv, count, sc_MPI_BYTE,
+                          iproc, T8_MPI_FOREST_TRANSFER, comm,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    transfer->recv_ranks[transfer->num_recv++] = iproc;
+    transfer->recv_offsets[transfer->num_recv] = leaves_recv.size ();
+  }
+  mpiret = sc_MPI_Waitall (transfer->num_send, requests.data (),
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* Intersect the received leaves with our target leaves. Both cover the
+   * target range in SFC order, so we walk them simultaneously. */
+  irecv = ito = 0;
+  while (irecv < leaves_recv.size () && ito < leaves_to.size ()) {
+    const t8_forest_transfer_leaf_t *src = &leaves_recv[irecv];
+    const t8_forest_transfer_leaf_t *dst = &leaves_to[ito];
+
+    if (src->tree == dst->tree) {
+      const t8_linearidx_t lower = SC_MAX (src->first, dst->first);
+      const t8_linearidx_t upper = SC_MIN (src->last, dst->last);
+      if (lower <= upper) {
+        pair_recv.push_back (irecv);
+        pair_to.push_back (ito);
+        pair_weight.push_back ((double) (upper - lower) + 1.);
+      }
+    }
+    if (t8_forest_transfer_less (src->tree, src->last, dst->tree, dst->last)) {
+      irecv++;
+    }
+    else if (t8_forest_transfer_less
+             (dst->tree, dst->last, src->tree, src->last)) {
+      ito++;
+    }
+    else {
+      irecv++;
+      ito++;
+    }
+  }
+  transfer->num_pairs = pair_recv.size ();
+  transfer->pair_recv = T8_ALLOC (t8_locidx_t, transfer->num_pairs);
+  transfer->pair_to = T8_ALLOC (t8_locidx_t, transfer->num_pairs);
+  transfer->pair_weight = T8_ALLOC (double, transfer->num_pairs);
+  memcpy (transfer->pair_recv, pair_recv.data (),
+          transfer->num_pairs * sizeof (t8_locidx_t));
+  memcpy (transfer->pair_to, pair_to.data (),
+          transfer->num_pairs * sizeof (t8_locidx_t));
+  memcpy (transfer->pair_weight, pair_weight.data (),
+          transfer->num_pairs * sizeof (double));
+  return transfer;
+}
+
+void
+t8_forest_transfer_data (t8_forest_transfer_t transfer,
+                         sc_array_t *data_from, sc_array_t *data_to)
+{
+  std::vector < sc_MPI_Request > requests;
+  std::vector < double >weights;
+  double             *recv_buffer, *values;
+  size_t              elem_size, num_values, ivalue;
+  t8_locidx_t         ipair, ielement;
+  int                 iproc, mpiret;
+
+  T8_ASSERT (transfer != NULL);
+  T8_ASSERT (data_from != NULL && data_to != NULL);
+  T8_ASSERT (data_from->elem_size == data_to->elem_size);
+  T8_ASSERT (data_from->elem_size % sizeof (double) == 0);
+  T8_ASSERT (data_from->elem_count >= (size_t) transfer->num_from);
+  T8_ASSERT (data_to->elem_count >= (size_t) transfer->num_to);
+
+  elem_size = data_from->elem_size;
+  num_values = elem_size / sizeof (double);
+  recv_buffer = T8_ALLOC (double, num_values *
+                          transfer->recv_offsets[transfer->num_recv]);
+  requests.resize (transfer->num_recv + transfer->num_send);
+
+  /* The local elements that go to one process are contiguous, so we send
+   * directly out of data_from. */
+  for (iproc = 0; iproc < transfer->num_recv; iproc++) {
+    const t8_locidx_t   offset = transfer->recv_offsets[iproc];
+    mpiret = sc_MPI_Irecv (recv_buffer + num_values * offset,
+                           (transfer->recv_offsets[iproc + 1] - offset)
+                           * elem_size, sc_MPI_BYTE,
+                           transfer->recv_ranks[iproc],
+                           T8_MPI_FOREST_TRANSFER, transfer->comm,
+                           &requests[iproc]);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (iproc = 0; iproc < transfer->num_send; iproc++) {
+    mpiret = sc_MPI_Isend (t8_sc_array_index_locidx (data_from,
+                                                     transfer->send_first
+                                                     [iproc]),
+                           transfer->send_count[iproc] * elem_size,
+                           sc_MPI_BYTE, transfer->send_ranks[iproc],
+                           T8_MPI_FOREST_TRANSFER, transfer->comm,
+                           &requests[transfer->num_recv + iproc]);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = sc_MPI_Waitall (requests.size (), requests.data (),
+                           sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* Each target value is the average of the overlapping source values,
+   * weighted by the number of common descendants at the maximum level.
+   * If the source element is coarser, this copies its value; if it is finer,
+   * this is the mean over the source children. */
+  weights.assign (transfer->num_to, 0.);
+  for (ielement = 0; ielement < transfer->num_to; ielement++) {
+    memset (t8_sc_array_index_locidx (data_to, ielement), 0, elem_size);
+  }
+  for (ipair = 0; ipair < transfer->num_pairs; ipair++) {
+    const double        weight = transfer->pair_weight[ipair];
+    const double       *src = recv_buffer
+      + num_values * transfer->pair_recv[ipair];
+
+    values = (double *) t8_sc_array_index_locidx (data_to,
+                                                  transfer->pair_to[ipair]);
+    for (ivalue = 0; ivalue < num_values; ivalue++) {
+      values[ivalue] += weight * src[ivalue];
+    }
+    weights[transfer->pair_to[ipair]] += weight;
+  }
+  for (ielement = 0; ielement < transfer->num_to; ielement++) {
+    T8_ASSERT (weights[ielement] > 0);
+    values = (double *) t8_sc_array_index_locidx (data_to, ielement);
+    for (ivalue = 0; ivalue < num_values; ivalue++) {
+      values[ivalue] /= weights[ielement];
+    }
+  }
+  T8_FREE (recv_buffer);
+}
+
+void
+t8_forest_transfer_destroy (t8_forest_transfer_t *ptransfer)
+{
+  t8_forest_transfer_t transfer;
+
+  T8_ASSERT (ptransfer != NULL && *ptransfer != NULL);
+  transfer = *ptransfer;
+  T8_FREE (transfer->send_ranks);
+  T8_FREE (transfer->send_first);
+  T8_FREE (transfer->send_count);
+  T8_FREE (transfer->recv_ranks);
+  T8_FREE (transfer->recv_offsets);
+  T8_FREE (transfer->pair_recv);
+  T8_FREE (transfer->pair_to);
+  T8_FREE (transfer->pair_weight);
+  T8_FREE (transfer);
+  *ptransfer = NULL;
+}
+
+T8_EXTERN_C_END ();
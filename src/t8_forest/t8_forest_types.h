@@ -31,12 +31,18 @@
 #include <t8_refcount.h>
 #include <t8_cmesh.h>
 #include <t8_element.h>
+#include <t8_geometry.h>
 #include <t8_data/t8_containers.h>
 #include <t8_forest/t8_forest_adapt.h>
 #include <t8_forest.h>
 
 typedef struct t8_profile t8_profile_t; /* Defined below */
 typedef struct t8_forest_ghost *t8_forest_ghost_t;      /* Defined below */
+typedef struct t8_forest_geometry_cache *t8_forest_geometry_cache_t;    /* Defined below */
+typedef struct t8_forest_face_connectivity *t8_forest_face_connectivity_t;      /* Defined below */
+typedef struct t8_forest_search_index *t8_forest_search_index_t;    /* Defined below */
+typedef struct t8_forest_bvh *t8_forest_bvh_t;  /* Defined below */
+typedef struct t8_forest_boundary_index *t8_forest_boundary_index_t;    /* Defined below */
 
 /** If a forest is to be derived from another forest, there are different
  * possibilities how the original forest is modified.
@@ -60,19 +66,77 @@ typedef int8_t      t8_forest_from_t;
 #define T8_FOREST_BALANCE_REPART 1 /**< Value of forest->set_balance if balancing with repartitioning */
 #define T8_FOREST_BALANCE_NO_REPART 2 /**< Value of forest->set_balance if balancing without repartitioning */
 
+/** A user data array that is partitioned together with the elements.
+ * For fixed-size data, \a data_in has one entry per element. For variable-size
+ * data, \a data_in is the payload and the entries of element i are
+ * offsets_in[i], ..., offsets_in[i + 1] - 1.
+ * \see t8_forest_set_partition_data, t8_forest_set_partition_data_variable */
+typedef struct t8_forest_partition_data
+{
+  const sc_array_t   *data_in;  /**< The entries of the local elements of \a set_from. */
+  sc_array_t         *data_out; /**< Filled with the entries of the local elements of the new forest. */
+  const sc_array_t   *offsets_in; /**< For variable-size data, the size_t offsets of the elements in
+                                     \a data_in. NULL for fixed-size data. */
+  sc_array_t         *offsets_out; /**< For variable-size data, filled with the offsets in \a data_out. */
+} t8_forest_partition_data_t;
+
+/** An element data field of a forest. \see t8_forest_data_add_field */
+typedef struct t8_forest_data_field
+{
+  size_t              size;     /**< The number of bytes per element. */
+  t8_forest_data_refine_t refine; /**< Interpolation to the children, or NULL to copy. */
+  t8_forest_data_coarsen_t coarsen; /**< Restriction to the parent, or NULL to copy the first child. */
+  void               *user;     /**< Passed to \a refine and \a coarsen. */
+  sc_array_t          data;     /**< The entries of the local elements followed by those of the ghosts. */
+} t8_forest_data_field_t;
+
 /** This structure is private to the implementation. */
 typedef struct t8_forest
 {
   t8_refcount_t       rc;               /**< Reference counter. */
 
   int                 set_level;        /**< Level to use in new construction. */
+  char               *set_load_file;    /**< If not NULL, the elements are loaded from this file
+                                             in new construction. \see t8_forest_set_load */
+  int                 set_load_mmap;    /**< If True, the loaded elements are mapped into memory.
+                                             \see t8_forest_set_load_mmap */
+  int                 set_comm_change;  /**< If True, the elements are taken over from \a set_comm_from
+                                             in new construction. \see t8_forest_shrink */
+  t8_forest_t         set_comm_from;    /**< The forest on another communicator whose elements are taken over,
+                                             NULL on the processes that are not in its communicator. */
   int                 set_for_coarsening;       /**< Change partition to allow
                                                      for one round of coarsening */
+  t8_forest_partition_weight_t set_partition_weight_fn; /**< Weight of an element when partitioning.
+                                             \see t8_forest_set_partition_weights */
+  const double       *set_partition_weights; /**< Weights of the local elements of \a set_from when partitioning,
+                                             used instead of \a set_partition_weight_fn if not NULL. */
+  int                 set_partition_use_eclass_weights; /**< If true, partition with \a set_partition_eclass_weights.
+                                             \see t8_forest_set_partition_eclass_weights */
+  double              set_partition_eclass_weights[T8_ECLASS_COUNT]; /**< Weight of an element of each eclass
+                                             when partitioning. */
+  t8_forest_cost_model_t set_partition_cost_model; /**< If not NULL, the model whose costs are the weights
+                                             when partitioning. \see t8_forest_set_partition_cost_model */
+  double              set_partition_tolerance; /**< Allowed deviation of the load of a process
+                                             from the average when partitioning.
+                                             \see t8_forest_set_partition_tolerance */
+  int                 set_partition_node_aware; /**< If true, the tolerance only applies to
+                                             boundaries between compute nodes.
+                                             \see t8_forest_set_partition_node_aware */
+  const t8_gloidx_t  *set_partition_offsets; /**< If not NULL, the given new element offsets.
+                                             \see t8_forest_set_partition_offsets */
+  sc_array_t         *set_partition_data; /**< Array of \ref t8_forest_partition_data_t that are
+                                             shipped with the elements when partitioning. May be NULL.
+                                             \see t8_forest_set_partition_data */
 
   sc_MPI_Comm         mpicomm;          /**< MPI communicator to use. */
   t8_cmesh_t          cmesh;            /**< Coarse mesh to use. */
   //t8_scheme_t        *scheme;        /**< Scheme for element types. */
   t8_scheme_cxx_t    *scheme_cxx;        /**< Scheme for element types. */
+  t8_geometry_t       geometry;         /**< If not NULL, the geometry of the trees.
+                                             \see t8_forest_set_geometry */
+  struct t8_forest_tree_map *tree_maps; /**< The maps from reference to physical coordinates
+                                             of the local and ghost trees. \see t8_forest_get_tree_map */
+  t8_locidx_t         tree_maps_num_trees; /**< The number of entries of \a tree_maps. */
   int                 maxlevel;         /**< The maximum allowed refinement level for elements in this forest. */
   int                 maxlevel_existing;/**< If >= 0, the maximum occurring refinemnent level of a forest element. */
   int                 do_dup;           /**< Communicator shall be duped. */
@@ -87,16 +151,73 @@ typedef struct t8_forest
 #endif
   t8_forest_adapt_t   set_adapt_fn;     /**< refinement and coarsen function. Called when \b from_method
                                              is set to T8_FOREST_FROM_ADAPT. */
+  t8_forest_adapt_batch_t set_adapt_batch_fn; /**< Batched refinement and coarsen function,
+                                             used instead of \a set_adapt_fn if not NULL.
+                                             \see t8_forest_set_adapt_batch */
+  const int8_t       *set_adapt_markers; /**< Refinement markers of the local elements of \a set_from,
+                                             used instead of \a set_adapt_fn if not NULL.
+                                             \see t8_forest_set_adapt_markers */
+  int                 set_adapt_markers_maxlevel; /**< Elements are not refined beyond this level by the markers.
+                                                       If negative, only the maximum level of the forest is used. */
   int                 set_adapt_recursive; /**< Flag to decide whether coarsen and refine
                                                 are carried out recursive */
+  int                 set_adapt_threaded; /**< If True, the adapt callback may be called from multiple threads.
+                                             \see t8_forest_set_adapt_threaded */
+  int                 num_threads; /**< The number of threads of the thread parallel algorithms,
+                                             0 for the OpenMP default. \see t8_forest_set_num_threads */
+  int                 set_adapt_record_runs; /**< If True, the changed ranges of elements are recorded when adapting.
+                                             \see t8_forest_set_adapt_record_runs */
   int                 set_balance;      /**< Flag to decide whether to forest will be balance in \ref t8_forest_commit.
                                              See \ref t8_forest_set_balance.
                                              If 0, no balance. If 1 balance with repartitioning, if 2 balance without
                                              repartitioning, \see t8_forest_balance */
+  int                 set_balance_local;        /**< If true, balance in local rounds against the ghost layer.
+                                             \see t8_forest_set_balance_local */
+  t8_ghost_type_t     set_balance_type; /**< The neighbors that are balanced. \see t8_forest_set_balance_type */
+  int                 set_balance_repartition_once;     /**< If true, balance with repartitioning only partitions the
+                                             balanced forest. \see t8_forest_set_balance_repartition_once */
   int                 do_ghost;         /**< If True, a ghost layer will be created when the forest is committed. */
+  int                 set_compress;     /**< If True, the elements are compressed after the forest is committed.
+                                             \see t8_forest_set_compress */
+  int                 set_contiguous_leaves; /**< If True, the elements of all local trees are stored in one
+                                             allocation after commit. \see t8_forest_set_contiguous_leaves */
+  int                 set_geometry_cache; /**< If True, the geometry cache is computed when the forest is committed.
+                                             \see t8_forest_set_geometry_cache */
+  int                 set_face_connectivity; /**< If True, the face connectivity is computed when the forest
+                                             is committed. \see t8_forest_set_face_connectivity */
+  int                 set_search_index; /**< If True, the search index is computed when the forest is committed.
+                                             \see t8_forest_set_search_index */
+  int                 set_element_index; /**< If True, the element index is computed when the forest is committed.
+                                             \see t8_forest_set_element_index */
+  int                 set_bvh;          /**< If True, the bounding volume hierarchy is computed when the forest
+                                             is committed. \see t8_forest_set_bvh */
+  int                 set_boundary_index; /**< If True, the boundary index is computed when the forest is committed.
+                                             \see t8_forest_set_boundary_index */
+  int                 compressed;       /**< True if at least one local tree stores its elements compressed. */
+  int                 compress_messages;        /**< Positive if the elements in ghost and partition messages are
+                                                     encoded, negative if not, 0 if not set, then the setting
+                                                     of set_from is used. \see t8_forest_set_compress_messages */
+  sc_array_t         *mmap_regions;     /**< If not NULL, the \ref t8_forest_mmap_region_t that
+                                             store the elements of the local trees. */
+  char               *leaf_storage;     /**< If not NULL, the memory of the elements and of the first and
+                                             last descendants of all local trees. The element arrays of the
+                                             trees are views into it. \see t8_forest_set_contiguous_leaves */
+  size_t              leaf_storage_bytes; /**< The size of \a leaf_storage in bytes. */
   t8_ghost_type_t     ghost_type;       /**< If a ghost layer will be created, the type of neighbors that count as ghost. */
   int                 ghost_algorithm;  /**< Controls the algorithm used for ghost. 1 = balanced only. 2 = also unbalanced
                                              3 = top-down search and unbalanced. */
+  int                 ghost_depth;      /**< The number of ghost layers. \see t8_forest_set_ghost_depth */
+  int                 ghost_lazy;       /**< If True, the ghost layer is created on first use instead of
+                                             in commit. \see t8_forest_set_ghost_lazy */
+  int                 ghost_pending;    /**< True if the ghost layer of a committed forest was deferred
+                                             and is not yet created. \see t8_forest_ghost_ensure */
+  int                 ghost_shmem;      /**< If True, ghost data is exchanged via shared memory between
+                                             the processes of a node. \see t8_forest_set_ghost_shmem */
+  t8_ghost_rma_t      ghost_rma;        /**< The synchronization of the one-sided ghost data exchange,
+                                             T8_GHOST_RMA_NONE if messages are used.
+                                             \see t8_forest_set_ghost_rma */
+  int                 ghost_zero_copy;  /**< If True, contiguous ghost data is sent without send buffer.
+                                             \see t8_forest_set_ghost_zero_copy */
   void               *user_data;        /**< Pointer for arbitrary user data. \see t8_forest_set_user_data. */
   void                (*user_function) ();/**< Pointer for arbitrary user function. \see t8_forest_set_user_function. */
   void               *t8code_data;      /**< Pointer for arbitrary data that is used internally. */
@@ -109,6 +230,31 @@ typedef struct t8_forest
   t8_gloidx_t         global_num_trees; /**< The total number of global trees */
   sc_array_t         *trees;
   t8_forest_ghost_t   ghosts;           /**< If not NULL, the ghost elements. \see t8_forest_ghost.h */
+  t8_forest_geometry_cache_t geometry_cache; /**< If not NULL, the geometry of the local elements.
+                                                  \see t8_forest_set_geometry_cache */
+  t8_forest_face_connectivity_t face_connectivity; /**< If not NULL, the face neighbors of the local elements.
+                                                  \see t8_forest_set_face_connectivity */
+  t8_forest_search_index_t search_index; /**< If not NULL, the split offsets of the leaf arrays for the search.
+                                             \see t8_forest_set_search_index */
+  t8_locidx_t        *element_trees;    /**< If not NULL, for each local element the id of its local tree.
+                                             \see t8_forest_set_element_index */
+  t8_forest_bvh_t     bvh;              /**< If not NULL, the bounding volume hierarchy of the local elements.
+                                             \see t8_forest_set_bvh */
+  t8_forest_boundary_index_t boundary_index; /**< If not NULL, the leaves at the domain boundary of each tree face.
+                                             \see t8_forest_set_boundary_index */
+  sc_array_t         *adapt_runs;      /**< If not NULL, the runs of unchanged, refined and coarsened elements
+                                             of the last adaptation. \see t8_forest_get_adapt_runs */
+  int                 hash_valid;       /**< If true, the \a hash of each local tree is valid.
+                                             \see t8_forest_get_tree_hash */
+  sc_array_t         *data_fields;     /**< If not NULL, the \ref t8_forest_data_field_t of the element data fields
+                                             that are carried along at commit. \see t8_forest_data_add_field */
+  double             *tree_bounding_boxes; /**< If not NULL, for each local tree the lower and upper corner
+                                               of its axis-aligned bounding box. Computed on first use.
+                                               \see t8_forest_tree_bounding_box */
+  double             *leaf_bounding_boxes; /**< If not NULL, for each local element the lower and upper corner
+                                               of its axis-aligned bounding box. Each box is computed on first use,
+                                               boxes with lower corner larger than their upper corner are not
+                                               computed yet. \see t8_forest_leaf_bounding_box */
   t8_shmem_array_t    element_offsets; /**< If partitioned, for each process the global index
                                             of its first element. Since it is memory consuming,
                                             it is usually only constructed when needed and otherwise unallocated. */
@@ -122,6 +268,8 @@ typedef struct t8_forest
                                           if the first tree on that process is shared.
                                           Since this is memory consuming we only construct it when needed.
                                           This array follows the same logic as \a tree_offsets in \a t8_cmesh_t */
+  int                 owner_cache; /**< The last owner process found by \ref t8_forest_element_find_owner_ext.
+                                        The next search checks this process and its neighbors first. */
 
   t8_locidx_t         local_num_elements;  /**< Number of elements on this processor. */
   t8_gloidx_t         global_num_elements; /**< Number of elements on all processors. */
@@ -130,6 +278,19 @@ typedef struct t8_forest
 }
 t8_forest_struct_t;
 
+/** The element memory of a tree that is shared between the trees of
+ * several forests, for example a forest and the forests derived from it.
+ * The trees sharing the elements store a view on \a elements.
+ * The elements must not be modified as long as they are shared.
+ * \see t8_forest_tree_share_elements
+ */
+typedef struct t8_tree_shared_elements
+{
+  t8_refcount_t       rc;       /**< The number of trees sharing the elements. */
+  t8_element_array_t  elements; /**< The shared elements. */
+}
+t8_tree_shared_elements_t;
+
 /** The t8 tree datatype */
 typedef struct t8_tree
 {
@@ -141,9 +302,73 @@ typedef struct t8_tree
   t8_locidx_t         elements_offset;      /**< cumulative sum over earlier
                                                   trees on this processor
                                                   (locals only) */
+  t8_linearidx_t     *packed_elements;       /**< If not NULL, the elements of this tree
+                                                  in compressed form and \a elements is empty.
+                                                  \see t8_forest_compress */
+  t8_locidx_t         num_packed_elements;   /**< The number of entries in \a packed_elements */
+  uint64_t            hash;                  /**< The sum of the hashes of the local elements,
+                                                  valid if the forest's \a hash_valid is true. */
+  t8_tree_shared_elements_t *shared;         /**< If not NULL, \a elements is a view on these
+                                                  elements, which are shared with other trees.
+                                                  They are copied before they are modified. */
 }
 t8_tree_struct_t;
 
+/** The phases of the forest algorithms that are timed by a profile.
+ * The phases are hierarchical, a phase runs inside of the phase whose name
+ * is the prefix of its name.
+ * \see t8_forest_profile_begin
+ */
+typedef enum
+{
+  T8_PROFILE_PHASE_ADAPT = 0,   /**< adapt: A call to \a t8_forest_adapt. */
+  T8_PROFILE_PHASE_PARTITION,   /**< partition: A call to \a t8_forest_partition. */
+  T8_PROFILE_PHASE_PARTITION_OFFSETS, /**< partition/offsets: Computing the new element offsets. */
+  T8_PROFILE_PHASE_PARTITION_PACK, /**< partition/pack: Packing the elements and posting their sends. */
+  T8_PROFILE_PHASE_PARTITION_WAIT, /**< partition/wait: Waiting for sent and received messages. */
+  T8_PROFILE_PHASE_PARTITION_UNPACK, /**< partition/unpack: Inserting the received elements. */
+  T8_PROFILE_PHASE_BALANCE,     /**< balance: A call to \a t8_forest_balance. */
+  T8_PROFILE_PHASE_BALANCE_ROUND, /**< balance/round: One round of balance. */
+  T8_PROFILE_PHASE_BALANCE_ROUND_ADAPT, /**< balance/round/adapt: The adaptation of a round. */
+  T8_PROFILE_PHASE_BALANCE_ROUND_PARTITION, /**< balance/round/partition: The repartitioning of a round. */
+  T8_PROFILE_PHASE_BALANCE_ROUND_GHOST, /**< balance/round/ghost: The ghost layer of a round. */
+  T8_PROFILE_PHASE_GHOST,       /**< ghost: The creation of the ghost layer. */
+  T8_PROFILE_PHASE_GHOST_FILL_REMOTE, /**< ghost/fill_remote: Finding the remote elements. */
+  T8_PROFILE_PHASE_GHOST_SEND,  /**< ghost/send: Packing, sending and waiting for the remote elements. */
+  T8_PROFILE_PHASE_GHOST_RECEIVE, /**< ghost/receive: Receiving the ghost elements. */
+  T8_PROFILE_PHASE_GHOST_RECEIVE_PARSE, /**< ghost/receive/parse: Inserting the received ghost elements. */
+  T8_PROFILE_PHASE_COUNT        /**< The number of phases. */
+} t8_profile_phase_t;
+
+/** The counters that a profile accumulates for each phase.
+ * The first \ref T8_PROFILE_NUM_HW_COUNTERS are hardware counters.
+ * \see t8_forest_profile_set_counters
+ */
+typedef enum
+{
+  T8_PROFILE_COUNTER_CYCLES = 0, /**< The CPU cycles. */
+  T8_PROFILE_COUNTER_LLC_MISSES, /**< The last level cache misses. */
+  T8_PROFILE_COUNTER_BYTES,     /**< The bytes sent to other processes. */
+  T8_PROFILE_NUM_COUNTERS       /**< The number of counters. */
+} t8_profile_counter_t;
+
+/** The number of hardware counters among the counters of a phase. */
+#define T8_PROFILE_NUM_HW_COUNTERS 2
+
+/** The runtime and counters of one phase of a profile, accumulated over
+ * all calls of that phase. */
+typedef struct t8_profile_phase
+{
+  double              runtime;  /**< The runtime of all calls. */
+  double              start;    /**< The start time of the running call. */
+  long                num_calls; /**< The number of calls. */
+  int                 running;  /**< True while the phase is running. */
+  int64_t             counters[T8_PROFILE_NUM_COUNTERS]; /**< The counters of all calls. */
+  int64_t             counters_start[T8_PROFILE_NUM_HW_COUNTERS]; /**< The hardware counters at the
+                                                                       start of the running call. */
+}
+t8_profile_phase_struct_t;
+
 /** This struct is used to profile forest algorithms.
  * The forest struct stores a pointer to a profile struct, and if
  * it is nonzero, various runtimes and data measurements are stored here.
@@ -151,7 +376,7 @@ t8_tree_struct_t;
  */
 
 /** The number of statistics collected by a profile struct. */
-#define T8_PROFILE_NUM_STATS 14
+#define T8_PROFILE_NUM_STATS 16
 typedef struct t8_profile
 {
   t8_locidx_t         partition_elements_shipped; /**< The number of elements this process has
@@ -172,10 +397,114 @@ typedef struct t8_profile
   double              ghost_waittime;     /**< Amount of synchronisation time in ghost. */
   double              balance_runtime;    /**< The runtime of the last call to \a t8_forest_balance. */
   double              commit_runtime;     /**< The runtime of the last call to \a t8_cmesh_commit. */
-
+  size_t              memory_high_water;  /**< The maximum number of bytes of the forests during the last call to
+                                               \a t8_forest_commit. \see t8_forest_profile_get_memory_high_water */
+  double              partition_imbalance; /**< The runtime imbalance of the cost model used in the last partition.
+                                               \see t8_forest_profile_get_partition_imbalance */
+  t8_profile_phase_struct_t phases[T8_PROFILE_PHASE_COUNT]; /**< The runtimes and counters of the phases.
+                                               \see t8_forest_profile_begin */
 }
 t8_profile_struct_t;
 
+/** The geometric quantities of all local elements of a forest.
+ * The element data is indexed by the local element index, the face data
+ * of an element starts at its entry in \a face_offsets.
+ * \see t8_forest_set_geometry_cache
+ */
+typedef struct t8_forest_geometry_cache
+{
+  t8_locidx_t         num_elements;     /**< The number of local elements. */
+  double             *centroids;        /**< For each element the 3 coordinates of its centroid. */
+  double             *volumes;          /**< For each element its volume. */
+  t8_locidx_t        *face_offsets;     /**< For each element the index of its first face in the face arrays.
+                                             Has \a num_elements + 1 entries. */
+  double             *face_areas;       /**< For each face of each element its area. */
+  double             *face_normals;     /**< For each face of each element the 3 coordinates of its
+                                             outward pointing normal. */
+  double             *face_centroids;   /**< For each face of each element the 3 coordinates of its centroid. */
+}
+t8_forest_geometry_cache_struct_t;
+
+/** The face neighbors of all local elements of a forest in compressed
+ * row storage. The faces of an element start at its entry in \a face_offsets,
+ * the neighbors of a face start at its entry in \a neighbor_offsets.
+ * \see t8_forest_set_face_connectivity
+ */
+typedef struct t8_forest_face_connectivity
+{
+  t8_locidx_t         num_elements;     /**< The number of local elements. */
+  t8_locidx_t        *face_offsets;     /**< For each element the index of its first face in \a neighbor_offsets.
+                                             Has \a num_elements + 1 entries. */
+  t8_locidx_t        *neighbor_offsets; /**< For each face the index of its first neighbor in \a neighbor_indices.
+                                             Has one entry more than there are faces. */
+  t8_locidx_t        *neighbor_indices; /**< For each neighbor its local element index, or the number of
+                                             local elements plus its ghost index if it is a ghost. */
+  int                *dual_faces;       /**< For each neighbor the face number of the neighbor at this face. */
+  int                *orientations;     /**< For each face the orientation of the tree connection across it.
+                                             0 if the face is inside the tree or on the domain boundary. */
+}
+t8_forest_face_connectivity_struct_t;
+
+/** The split offsets of the leaf arrays of all local trees as they are
+ * computed in the top-down search of a forest.
+ * A node of the index is an element that the search visits and that is not a
+ * leaf, the nodes are stored in depth-first order starting at the nearest
+ * common ancestor of each tree. The children of node n start at entry
+ * node_offsets[n] of \a child_nodes and its split offsets start at entry
+ * node_offsets[n] + n of \a split_offsets.
+ * \see t8_forest_set_search_index
+ */
+typedef struct t8_forest_search_index
+{
+  t8_locidx_t         num_local_trees;  /**< The number of local trees. */
+  size_t              num_nodes;        /**< The number of nodes. */
+  size_t             *tree_first_node;  /**< For each tree the index of its first node.
+                                             Has \a num_local_trees + 1 entries. */
+  size_t             *node_offsets;     /**< For each node the index of its first child in \a child_nodes.
+                                             Has \a num_nodes + 1 entries. */
+  size_t             *split_offsets;    /**< For each node the offsets of its children in its leaf array
+                                             as computed by \ref t8_forest_split_array. */
+  size_t             *child_nodes;      /**< For each child of a node the index of its node, or 0 if the child
+                                             is a leaf or has no leafs. */
+}
+t8_forest_search_index_struct_t;
+
+/** The leaves of the local trees of a forest that lie at the domain boundary.
+ * The leaves at the face f of the local tree t are stored in the entries
+ * face_offsets[i], ..., face_offsets[i + 1] - 1 of \a leaves and \a faces
+ * with i = t * T8_ECLASS_MAX_FACES + f, in ascending order.
+ * Faces of a tree that are connected to another tree have no leaves.
+ * \see t8_forest_set_boundary_index
+ */
+typedef struct t8_forest_boundary_index
+{
+  t8_locidx_t         num_local_trees;  /**< The number of local trees. */
+  t8_locidx_t        *face_offsets;     /**< For each tree face the index of its first leaf.
+                                             Has \a num_local_trees * T8_ECLASS_MAX_FACES + 1 entries. */
+  t8_locidx_t        *leaves;           /**< For each boundary leaf its index in its tree. */
+  int                *faces;            /**< For each boundary leaf its face that lies at the tree face. */
+}
+t8_forest_boundary_index_struct_t;
+
+/** A bounding volume hierarchy over the local elements of a forest.
+ * Each node covers a range of elements in linear order and stores the union
+ * of their axis-aligned bounding boxes. An inner node has two children that
+ * cover the two halves of its range. The left child directly follows its
+ * parent in the node arrays.
+ * \see t8_forest_set_bvh
+ */
+typedef struct t8_forest_bvh
+{
+  t8_locidx_t         num_elements;     /**< The number of local elements. */
+  t8_locidx_t         num_nodes;        /**< The number of nodes. */
+  double             *element_boxes;    /**< For each element the lower and upper corner of its bounding box. */
+  double             *node_boxes;       /**< For each node the lower and upper corner of its bounding box. */
+  t8_locidx_t        *node_first;       /**< For each node the local index of its first element. */
+  t8_locidx_t        *node_count;       /**< For each node the number of its elements. */
+  t8_locidx_t        *node_right;       /**< For each node the index of its right child, -1 for leaf nodes. */
+}
+t8_forest_bvh_struct_t;
+
 /* TODO: document */
 typedef struct t8_forest_ghost
 {
@@ -207,6 +536,28 @@ typedef struct t8_forest_ghost
                                          */
   sc_array_t         *remote_processes; /* The ranks of the processes for which local elements are ghost.
                                            Array of int's. */
+  sc_array_t         *ghost_tree_ids;   /* After construction the hash tables are replaced by
+                                           sorted arrays. The global tree ids and indices of the
+                                           ghost trees, sorted by global id. */
+  sc_array_t         *process_offsets_sorted; /* The entries of process_offsets, sorted by rank. */
+  sc_array_t         *remotes;  /* The entries of remote_ghosts, sorted by rank. */
+  int                 num_layers;       /**< The number of ghost layers. */
+  int                *ghost_layers;     /* For each ghost element its layer, 1 for face neighbors
+                                           of local elements. NULL if num_layers is 1. */
+  int                *remote_layers;    /* For each remote process in remote_processes and each of
+                                           its remote elements the layer of the element on the remote
+                                           process. NULL if num_layers is 1. */
+  t8_locidx_t        *rma_displacements;        /* For each remote process in remote_processes the
+                                                   position of our ghost data in its one-sided
+                                                   exchange window, followed by the number of
+                                                   elements in our own window. In elements.
+                                                   NULL if not computed. */
+  t8_locidx_t        *send_run_offsets; /* For each remote process in remote_processes the
+                                           index of its first run in send_runs, followed by
+                                           the number of all runs. NULL if not computed. */
+  t8_locidx_t        *send_runs;        /* The runs of consecutive local elements that we send
+                                           to the remote processes, as pairs of the local index
+                                           of the first element and the number of elements. */
 
   sc_mempool_t       *glo_tree_mempool;
   sc_mempool_t       *proc_offset_mempool;
@@ -0,0 +1,311 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_view.cxx
+ * A view of a subset of the local elements and ghosts of a forest, stored
+ * as ranges of element indices into the leaf arrays.
+ * \see t8_forest_view_new
+ */
+
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_ghost.h>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The selected elements of a forest. */
+typedef struct t8_forest_view
+{
+  t8_forest_t         forest;   /* The viewed forest, referenced. */
+  sc_array_t          ranges;   /* The t8_forest_view_range_t of the selected
+                                   elements, sorted by element index. A range
+                                   does not extend over more than one tree. */
+  t8_locidx_t        *tree_first_range; /* For each local and ghost tree the
+                                           index of its first range, with one
+                                           additional entry at the end. */
+  t8_locidx_t         num_elements;     /* The number of selected local
+                                           elements. */
+  t8_locidx_t         num_ghosts;       /* The number of selected ghosts. */
+} t8_forest_view_struct_t;
+
+/* Select the elements of one local or ghost tree and append their ranges.
+ * The elements are the ones of leafs, which have the element indices
+ * first_index, first_index + 1, ... */
+static t8_locidx_t
+t8_forest_view_select_tree (t8_forest_view_t view, t8_locidx_t ltreeid,
+                            t8_element_array_t *leafs,
+                            t8_locidx_t first_index,
+                            t8_forest_view_select_fn select_fn,
+                            void *user_data)
+{
+  t8_forest_view_range_t *range = NULL;
+  t8_locidx_t         ielement, num_leafs, num_selected = 0;
+  const t8_element_t *element;
+
+  num_leafs = (t8_locidx_t) t8_element_array_get_count (leafs);
+  for (ielement = 0; ielement < num_leafs; ielement++) {
+    element = t8_element_array_index_locidx (leafs, ielement);
+    if (!select_fn (view->forest, ltreeid, element, first_index + ielement,
+                    user_data)) {
+      range = NULL;
+      continue;
+    }
+    if (range == NULL) {
+      /* Start a new range */
+      range = (t8_forest_view_range_t *) sc_array_push (&view->ranges);
+      range->first = first_index + ielement;
+      range->num = 0;
+    }
+    range->num++;
+    num_selected++;
+  }
+  return num_selected;
+}
+
+t8_forest_view_t
+t8_forest_view_new (t8_forest_t forest, t8_forest_view_select_fn select_fn,
+                    void *user_data)
+{
+  t8_forest_view_t    view;
+  t8_locidx_t         num_local_trees, num_ghost_trees, itree;
+  t8_locidx_t         num_local;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+  T8_ASSERT (select_fn != NULL);
+
+  view = T8_ALLOC_ZERO (t8_forest_view_struct_t, 1);
+  t8_forest_ref (forest);
+  view->forest = forest;
+  sc_array_init (&view->ranges, sizeof (t8_forest_view_range_t));
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  num_ghost_trees = t8_forest_get_num_ghost_trees (forest);
+  view->tree_first_range =
+    T8_ALLOC (t8_locidx_t, num_local_trees + num_ghost_trees + 1);
+
+  /* The local trees and then the ghost trees, whose elements follow the
+   * local elements */
+  for (itree = 0; itree < num_local_trees; itree++) {
+    view->tree_first_range[itree] = (t8_locidx_t) view->ranges.elem_count;
+    view->num_elements +=
+      t8_forest_view_select_tree (view, itree,
+                                  t8_forest_tree_get_leafs (forest, itree),
+                                  t8_forest_get_tree_element_offset (forest,
+                                                                     itree),
+                                  select_fn, user_data);
+  }
+  num_local = t8_forest_get_local_num_elements (forest);
+  for (itree = 0; itree < num_ghost_trees; itree++) {
+    view->tree_first_range[num_local_trees + itree] =
+      (t8_locidx_t) view->ranges.elem_count;
+    view->num_ghosts +=
+      t8_forest_view_select_tree (view, num_local_trees + itree,
+                                  t8_forest_ghost_get_tree_elements (forest,
+                                                                     itree),
+                                  num_local +
+                                  t8_forest_ghost_get_tree_element_offset
+                                  (forest, itree), select_fn, user_data);
+  }
+  view->tree_first_range[num_local_trees + num_ghost_trees] =
+    (t8_locidx_t) view->ranges.elem_count;
+  t8_debugf ("Selected %li elements and %li ghosts in %li ranges\n",
+             (long) view->num_elements, (long) view->num_ghosts,
+             (long) view->ranges.elem_count);
+  return view;
+}
+
+void
+t8_forest_view_destroy (t8_forest_view_t *pview)
+{
+  t8_forest_view_t    view;
+
+  T8_ASSERT (pview != NULL && *pview != NULL);
+  view = *pview;
+  t8_forest_unref (&view->forest);
+  sc_array_reset (&view->ranges);
+  T8_FREE (view->tree_first_range);
+  T8_FREE (view);
+  *pview = NULL;
+}
+
+t8_forest_t
+t8_forest_view_get_forest (t8_forest_view_t view)
+{
+  T8_ASSERT (view != NULL);
+  return view->forest;
+}
+
+t8_locidx_t
+t8_forest_view_get_num_elements (t8_forest_view_t view)
+{
+  T8_ASSERT (view != NULL);
+  return view->num_elements;
+}
+
+t8_locidx_t
+t8_forest_view_get_num_ghosts (t8_forest_view_t view)
+{
+  T8_ASSERT (view != NULL);
+  return view->num_ghosts;
+}
+
+const t8_forest_view_range_t *
+t8_forest_view_get_tree_ranges (t8_forest_view_t view, t8_locidx_t ltreeid,
+                                t8_locidx_t *num_ranges)
+{
+  T8_ASSERT (view != NULL);
+  T8_ASSERT (0 <= ltreeid && ltreeid <
+             t8_forest_get_num_local_trees (view->forest)
+             + t8_forest_get_num_ghost_trees (view->forest));
+  T8_ASSERT (num_ranges != NULL);
+
+  *num_ranges = view->tree_first_range[ltreeid + 1]
+    - view->tree_first_range[ltreeid];
+  if (*num_ranges == 0) {
+    return NULL;
+  }
+  return (const t8_forest_view_range_t *)
+    t8_sc_array_index_locidx (&view->ranges,
+                              view->tree_first_range[ltreeid]);
+}
+
+/* Compare an element index with a range for sc_array_bsearch. */
+static int
+t8_forest_view_range_compare (const void *pindex, const void *prange)
+{
+  const t8_locidx_t   index = *(const t8_locidx_t *) pindex;
+  const t8_forest_view_range_t *range =
+    (const t8_forest_view_range_t *) prange;
+
+  if (index < range->first) {
+    return -1;
+  }
+  return index >= range->first + range->num;
+}
+
+int
+t8_forest_view_contains (t8_forest_view_t view, t8_locidx_t element_index)
+{
+  T8_ASSERT (view != NULL);
+  T8_ASSERT (0 <= element_index);
+
+  return sc_array_bsearch (&view->ranges, &element_index,
+                           t8_forest_view_range_compare) >= 0;
+}
+
+void
+t8_forest_view_iterate (t8_forest_view_t view,
+                        t8_forest_view_iterate_fn iterate_fn,
+                        void *user_data)
+{
+  t8_locidx_t         num_local_trees, itree, irange, ielement, offset;
+  const t8_forest_view_range_t *range;
+  t8_element_array_t *leafs;
+
+  T8_ASSERT (view != NULL);
+  T8_ASSERT (iterate_fn != NULL);
+
+  num_local_trees = t8_forest_get_num_local_trees (view->forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    leafs = t8_forest_tree_get_leafs (view->forest, itree);
+    offset = t8_forest_get_tree_element_offset (view->forest, itree);
+    for (irange = view->tree_first_range[itree];
+         irange < view->tree_first_range[itree + 1]; irange++) {
+      range = (const t8_forest_view_range_t *)
+        t8_sc_array_index_locidx (&view->ranges, irange);
+      for (ielement = range->first; ielement < range->first + range->num;
+           ielement++) {
+        iterate_fn (view->forest, itree,
+                    t8_element_array_index_locidx (leafs, ielement - offset),
+                    ielement, user_data);
+      }
+    }
+  }
+}
+
+void
+t8_forest_view_leaf_face_neighbors (t8_forest_view_t view,
+                                    t8_locidx_t ltreeid,
+                                    const t8_element_t *leaf, int face,
+                                    sc_array_t *indices,
+                                    sc_array_t *dual_faces)
+{
+  size_t              first, ineigh, num_kept;
+  t8_locidx_t         index;
+
+  T8_ASSERT (view != NULL);
+  T8_ASSERT (indices != NULL);
+  T8_ASSERT (dual_faces == NULL || dual_faces->elem_count
+             == indices->elem_count);
+
+  first = indices->elem_count;
+  t8_forest_leaf_face_neighbors_search (view->forest, ltreeid, leaf, face,
+                                        indices, dual_faces, NULL);
+  /* Keep the neighbors in the view */
+  num_kept = first;
+  for (ineigh = first; ineigh < indices->elem_count; ineigh++) {
+    index = *(t8_locidx_t *) sc_array_index (indices, ineigh);
+    if (!t8_forest_view_contains (view, index)) {
+      continue;
+    }
+    *(t8_locidx_t *) sc_array_index (indices, num_kept) = index;
+    if (dual_faces != NULL) {
+      *(int *) sc_array_index (dual_faces, num_kept) =
+        *(int *) sc_array_index (dual_faces, ineigh);
+    }
+    num_kept++;
+  }
+  sc_array_resize (indices, num_kept);
+  if (dual_faces != NULL) {
+    sc_array_resize (dual_faces, num_kept);
+  }
+}
+
+void
+t8_forest_view_ghost_exchange_data (t8_forest_view_t view,
+                                    sc_array_t *element_data)
+{
+  int8_t             *selected;
+  t8_locidx_t         num_elements, irange, ielement;
+  const t8_forest_view_range_t *range;
+
+  T8_ASSERT (view != NULL);
+
+  num_elements = t8_forest_get_local_num_elements (view->forest)
+    + t8_forest_get_num_ghosts (view->forest);
+  selected = T8_ALLOC_ZERO (int8_t, SC_MAX (num_elements, 1));
+  for (irange = 0; irange < (t8_locidx_t) view->ranges.elem_count; irange++) {
+    range = (const t8_forest_view_range_t *)
+      t8_sc_array_index_locidx (&view->ranges, irange);
+    for (ielement = range->first; ielement < range->first + range->num;
+         ielement++) {
+      selected[ielement] = 1;
+    }
+  }
+  t8_forest_ghost_exchange_data_selected (view->forest, element_data,
+                                          selected);
+  T8_FREE (selected);
+}
+
+T8_EXTERN_C_END ();
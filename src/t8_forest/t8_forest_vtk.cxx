@@ -28,6 +28,8 @@
 #include <t8_vec.h>
 #include "t8_cmesh/t8_cmesh_trees.h"
 #include "t8_forest_types.h"
+#include "t8_forest_private.h"
+#include <t8_trace.h>
 #if T8_WITH_VTK
 #include <vtkActor.h>
 #include <vtkCellArray.h>
@@ -35,20 +37,15 @@
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkProperty.h>
-#include <vtkTetra.h>
-#include <vtkHexahedron.h>
-#include <vtkVertex.h>
-#include <vtkLine.h>
-#include <vtkQuad.h>
-#include <vtkTriangle.h>
-#include <vtkPyramid.h>
-#include <vtkWedge.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkVertexGlyphFilter.h>
 #include <vtkXMLPUnstructuredGridWriter.h>
 #include <vtkXMLUnstructuredGridWriter.h>
 #include <vtkUnsignedCharArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkSmartPointer.h>
+#include <vtkVersion.h>
 #if T8_ENABLE_MPI
 #include <vtkMPI.h>
 #include <vtkMPICommunicator.h>
@@ -58,12 +55,23 @@
 #include <t8.h>
 #include <t8_forest.h>
 #include <t8_schemes/t8_default_cxx.hxx>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
 
-/* TODO: Currently we only use ASCII mode and no data compression.
- *       We also do not use sc_io to buffer our output stream. */
+/* The files are either written in ASCII mode or in binary mode.
+ * In binary mode all data arrays are collected in memory and written to
+ * an appended data section at the end of the file, optionally compressed
+ * with zlib. */
 
 /* There are different cell data to write, e.g. connectivity, type, vertices, ...
  * The structure is always the same:
@@ -102,6 +110,12 @@ typedef enum
  *                      In this cas \a tree is NULL.
  *                      All ghost element will be traversed after all elements are
  * \param [in,out] vtufile The open file stream to which we write the forest.
+ * \param [in,out] values  If not NULL, the file is written in binary format and
+ *                         the callback appends its values to this array instead
+ *                         of printing them to \a vtufile. The element size of
+ *                         \a values is the size of the binary data type.
+ *                         Use \ref t8_forest_vtk_push_int and
+ *                         \ref t8_forest_vtk_push_float to append values.
  * \param [in,out] columns An integer counting the number of written columns.
  *                         The callback should increase this value by the number
  *                         of values written to the file.
@@ -120,11 +134,146 @@ typedef int         (*t8_forest_vtk_cell_data_kernel) (t8_forest_t forest,
                                                        t8_eclass_scheme_c *
                                                        ts, int is_ghost,
                                                        FILE * vtufile,
+                                                       sc_array_t * values,
                                                        int *columns,
                                                        void **data,
                                                        T8_VTK_KERNEL_MODUS
                                                        modus);
 
+/* The state of a .vtu file while it is written. */
+typedef struct
+{
+  FILE               *vtufile;  /* The open file stream */
+  t8_vtk_format_t     format;   /* The output format of the data arrays */
+  sc_array_t          appended; /* In binary mode, the bytes of the appended
+                                   data section, written at the end */
+  long long           base_offset;      /* Added to all offsets into the appended data */
+  sc_array_t         *array_offsets;    /* If not NULL, the offsets of all binary
+                                           arrays in appended are recorded here */
+  int                 replay;   /* If true, the binary arrays were already computed
+                                   and the offsets are taken from array_offsets */
+  size_t              next_array;       /* In replay mode, the next array to write */
+  int                 shared_vertices;  /* If true, each vertex is written only once */
+  t8_locidx_t         num_points;       /* With shared vertices, the number of vertices */
+  t8_locidx_t        *point_ids;        /* With shared vertices, the vertex of each
+                                           element corner in connectivity order */
+  double             *point_coordinates;        /* With shared vertices, the
+                                                   coordinates of the vertices */
+} t8_forest_vtk_output_t;
+
+/* The number of uncompressed bytes in one block of zlib compressed data.
+ * This is the default block size of vtkZLibDataCompressor. */
+#define T8_VTK_ZLIB_BLOCK_SIZE 32768
+
+/* Append an integer value to the binary data of an array.
+ * The value is converted to the element size of \a values. */
+static void
+t8_forest_vtk_push_int (sc_array_t * values, long long value)
+{
+  if (values->elem_size == sizeof (int64_t)) {
+    *(int64_t *) sc_array_push (values) = (int64_t) value;
+  }
+  else {
+    T8_ASSERT (values->elem_size == sizeof (int32_t));
+    *(int32_t *) sc_array_push (values) = (int32_t) value;
+  }
+}
+
+/* Append a floating point value to the binary data of an array. */
+static void
+t8_forest_vtk_push_float (sc_array_t * values, double value)
+{
+  if (values->elem_size == sizeof (double)) {
+    *(double *) sc_array_push (values) = value;
+  }
+  else {
+    T8_ASSERT (values->elem_size == sizeof (float));
+    *(float *) sc_array_push (values) = (float) value;
+  }
+}
+
+/* Return the number of bytes of a vtk data type given by its name. */
+static size_t
+t8_forest_vtk_type_size (const char *datatype)
+{
+  if (!strcmp (datatype, "Int64") || !strcmp (datatype, "Float64")) {
+    return 8;
+  }
+  T8_ASSERT (!strcmp (datatype, "Int32") || !strcmp (datatype, "Float32"));
+  return 4;
+}
+
+/* Append the binary data of one array to the appended data section.
+ * In raw binary format the data is preceded by its number of bytes.
+ * In compressed format, the data is split into blocks that are compressed
+ * separately and preceded by the header of vtkZLibDataCompressor:
+ * The number of blocks, the uncompressed block size, the uncompressed size
+ * of the last block and the compressed size of each block.
+ * Returns true on success. */
+static int
+t8_forest_vtk_append_array (t8_forest_vtk_output_t * output,
+                            const sc_array_t * values)
+{
+  const uint64_t      num_bytes = values->elem_count * values->elem_size;
+  char               *dest;
+
+  T8_ASSERT (output->format != T8_VTK_FORMAT_ASCII);
+  if (output->format == T8_VTK_FORMAT_BINARY) {
+    dest = (char *) sc_array_push_count (&output->appended,
+                                         sizeof (uint64_t) + num_bytes);
+    memcpy (dest, &num_bytes, sizeof (uint64_t));
+    if (num_bytes > 0) {
+      memcpy (dest + sizeof (uint64_t), values->array, num_bytes);
+    }
+    return 1;
+  }
+#ifdef SC_HAVE_ZLIB
+  else {
+    const uint64_t      num_blocks =
+      (num_bytes + T8_VTK_ZLIB_BLOCK_SIZE - 1) / T8_VTK_ZLIB_BLOCK_SIZE;
+    uint64_t            header[3], iblock, block_bytes;
+    size_t              header_offset, block_offset;
+    uLongf              compressed_bytes;
+    int                 zreturn;
+
+    header[0] = num_blocks;
+    header[1] = T8_VTK_ZLIB_BLOCK_SIZE;
+    header[2] = num_bytes % T8_VTK_ZLIB_BLOCK_SIZE;
+    dest = (char *) sc_array_push_count (&output->appended,
+                                         (3 + num_blocks) * sizeof (uint64_t));
+    memcpy (dest, header, sizeof (header));
+    /* The compressed block sizes are filled in while compressing */
+    header_offset = output->appended.elem_count
+      - num_blocks * sizeof (uint64_t);
+    for (iblock = 0; iblock < num_blocks; iblock++) {
+      block_bytes = SC_MIN (num_bytes - iblock * T8_VTK_ZLIB_BLOCK_SIZE,
+                            (uint64_t) T8_VTK_ZLIB_BLOCK_SIZE);
+      compressed_bytes = compressBound ((uLong) block_bytes);
+      block_offset = output->appended.elem_count;
+      dest = (char *) sc_array_push_count (&output->appended,
+                                           compressed_bytes);
+      zreturn = compress2 ((Bytef *) dest, &compressed_bytes,
+                           (const Bytef *) values->array
+                           + iblock * T8_VTK_ZLIB_BLOCK_SIZE,
+                           (uLong) block_bytes, Z_BEST_SPEED);
+      if (zreturn != Z_OK) {
+        t8_errorf ("Error when compressing vtk data.\n");
+        return 0;
+      }
+      /* Shrink the appended data to the actual compressed size */
+      sc_array_resize (&output->appended, block_offset + compressed_bytes);
+      header[0] = compressed_bytes;
+      memcpy (output->appended.array + header_offset
+              + iblock * sizeof (uint64_t), header, sizeof (uint64_t));
+    }
+    return 1;
+  }
+#else
+  SC_ABORT_NOT_REACHED ();
+  return 0;
+#endif
+}
+
 void
 t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
 {
@@ -135,112 +284,129 @@ t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
   T8_ASSERT (forest->committed);
   T8_ASSERT (fileprefix != NULL);
 
-  long int            point_id = 0;     /* The id of the point in the points Object. */
   t8_locidx_t         ielement; /* The iterator over elements in a tree. */
-  t8_locidx_t         itree, ivertex;
-  double             *vertices;
-  double              coordinates[3];
-  int                 elem_id = 0;
-
-/* Since we want to use different element types and a points Array and cellArray 
- * we have to declare these vtk objects. The cellArray stores the Elements.
- * The points and cellArray are needed to store the data we want to write in the Unstructured Grid. 
- */
-  vtkNew < vtkPoints > points;
-  vtkNew < vtkCellArray > cellArray;
-  vtkNew < vtkHexahedron > hexa;
-  vtkNew < vtkVertex > vertex;
-  vtkNew < vtkLine > line;
-  vtkNew < vtkQuad > quad;
-  vtkNew < vtkTriangle > tri;
-  vtkNew < vtkPyramid > pyramid;
-  vtkNew < vtkWedge > prism;
-  vtkNew < vtkTetra > tet;
+  t8_locidx_t         itree, num_local_elements, first_tree_element;
+  vtkIdType           num_points;
+  vtkIdType          *offsets, *connectivity;
+  double             *coordinates;
+  unsigned char      *cellTypes;
+
+  /* We fill contiguous arrays for the points, the connectivity and the
+   * cell types and pass them to vtk without copying.
+   * Since the elements do not share points, the connectivity of a cell
+   * consists of the points from its offset to the next cell's offset. */
+  num_local_elements = t8_forest_get_local_num_elements (forest);
+  offsets = T8_ALLOC (vtkIdType, num_local_elements + 1);
+  cellTypes = T8_ALLOC (unsigned char, num_local_elements);
+
+  /* In a first pass we compute the offsets and the cell types. */
+  offsets[0] = 0;
+  first_tree_element = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    t8_eclass_scheme_c *scheme =
+      t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest,
+                                                                     itree));
+    t8_locidx_t         elems_in_tree =
+      t8_forest_get_tree_num_elements (forest, itree);
 
-  /* 
-   * The cellTypes Array stores the element types as integers(see vtk doc).
-   */
-  int                *cellTypes =
-    T8_ALLOC (int, t8_forest_get_local_num_elements (forest));
+    for (ielement = 0; ielement < elems_in_tree; ielement++) {
+      const t8_element_t *element =
+        t8_forest_get_element_in_tree (forest, itree, ielement);
+      t8_element_shape_t  element_shape = scheme->t8_element_shape (element);
 
-/* We iterate over all local trees*/
+      T8_ASSERT (element != NULL);
+      cellTypes[first_tree_element + ielement] =
+        t8_eclass_vtk_type[element_shape];
+      offsets[first_tree_element + ielement + 1] =
+        offsets[first_tree_element + ielement] +
+        t8_eclass_num_vertices[element_shape];
+    }
+    first_tree_element += elems_in_tree;
+  }
+  num_points = offsets[num_local_elements];
+  coordinates = T8_ALLOC (double, 3 * num_points);
+  connectivity = T8_ALLOC (vtkIdType, num_points);
+
+  /* In a second pass we compute the coordinates of the points.
+   * Each element writes to its own range of the arrays, thus we can fill
+   * them in parallel. */
+  first_tree_element = 0;
   for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
-/* 
- * We get the vertices, the current tree, the scheme for this tree
- * and the number of elements in this tree. We need the vertices of
- * the tree to get the coordinates of the elements later. We need
- * the number of elements in this tree to iterate over all of them.
- */
-    vertices = t8_forest_get_tree_vertices (forest, itree);
     t8_eclass_scheme_c *scheme =
       t8_forest_get_eclass_scheme (forest, t8_forest_get_tree_class (forest,
                                                                      itree));
     t8_locidx_t         elems_in_tree =
       t8_forest_get_tree_num_elements (forest, itree);
+    double             *vertices = t8_forest_get_tree_vertices (forest,
+                                                                itree);
 
-    /* We iterate over all elements in the tree */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
     for (ielement = 0; ielement < elems_in_tree; ielement++) {
-
-      t8_element_t       *element =
+      const t8_element_t *element =
         t8_forest_get_element_in_tree (forest, itree, ielement);
-      T8_ASSERT (element != NULL);
-      vtkSmartPointer < vtkCell > pvtkCell = NULL;
       t8_element_shape_t  element_shape = scheme->t8_element_shape (element);
-      int                 num_corners =
-        scheme->t8_element_num_corners (element);
-
-      /* depending on the element type we choose the correct vtk cell to insert points to */
-      switch (element_shape) {
-      case T8_ECLASS_VERTEX:
-        pvtkCell = vertex;
-        break;
-      case T8_ECLASS_LINE:
-        pvtkCell = line;
-        break;
-      case T8_ECLASS_QUAD:
-        pvtkCell = quad;
-        break;
-      case T8_ECLASS_TRIANGLE:
-        pvtkCell = tri;
-        break;
-      case T8_ECLASS_HEX:
-        pvtkCell = hexa;
-        break;
-      case T8_ECLASS_TET:
-        pvtkCell = tet;
-        break;
-      case T8_ECLASS_PRISM:
-        pvtkCell = prism;
-        break;
-      case T8_ECLASS_PYRAMID:
-        pvtkCell = pyramid;
-        break;
-      default:
-        SC_ABORT_NOT_REACHED ();
-      }
+      vtkIdType           offset = offsets[first_tree_element + ielement];
+      int                 ivertex;
 
-      /* For each element we iterate over all points */
-      for (ivertex = 0; ivertex < num_corners; ivertex++, point_id++) {
+      for (ivertex = 0; ivertex < t8_eclass_num_vertices[element_shape];
+           ivertex++) {
         /* We take the element coordinates in vtk order */
-        t8_forest_element_coordinate (forest, itree, element,
-                                      vertices,
+        t8_forest_element_coordinate (forest, itree, element, vertices,
                                       t8_eclass_vtk_corner_number
-                                      [element_shape]
-                                      [ivertex], coordinates);
-
-        /* Insert point in the points array */
-        points->InsertNextPoint (coordinates[0], coordinates[1],
-                                 coordinates[2]);
-        /* Set the point ids to the vtk cell */
-        pvtkCell->GetPointIds ()->SetId (ivertex, point_id);
+                                      [element_shape][ivertex],
+                                      coordinates + 3 * (offset + ivertex));
+        connectivity[offset + ivertex] = offset + ivertex;
       }
-      /* We insert the next cell in the cell array */
-      cellArray->InsertNextCell (pvtkCell);
+    }
+    first_tree_element += elems_in_tree;
+  }
+
+  /* We wrap the arrays in vtk arrays. The last argument of SetArray
+   * indicates that vtk must not free the memory. */
+  vtkNew < vtkDoubleArray > pointCoordinates;
+  pointCoordinates->SetNumberOfComponents (3);
+  pointCoordinates->SetArray (coordinates, 3 * num_points, 1);
+  vtkNew < vtkPoints > points;
+  points->SetData (pointCoordinates);
 
-      cellTypes[elem_id] = t8_eclass_vtk_type[element_shape];
-      elem_id++;
+  vtkNew < vtkUnsignedCharArray > cellTypesArray;
+  cellTypesArray->SetArray (cellTypes, num_local_elements, 1);
+
+  vtkNew < vtkCellArray > cellArray;
+#if VTK_MAJOR_VERSION >= 9
+  vtkNew < vtkIdTypeArray > offsetsArray;
+  vtkNew < vtkIdTypeArray > connectivityArray;
+  offsetsArray->SetArray (offsets, num_local_elements + 1, 1);
+  connectivityArray->SetArray (connectivity, num_points, 1);
+  cellArray->SetData (offsetsArray, connectivityArray);
+#else
+  /* Older vtk versions store the number of points in front of the point
+   * ids of each cell. We build this layout from the offsets. */
+  vtkIdType          *legacy_cells =
+    T8_ALLOC (vtkIdType, num_local_elements + num_points);
+  vtkIdType          *cellLocations = T8_ALLOC (vtkIdType,
+                                                num_local_elements);
+  vtkIdType           ipoint;
+
+  for (ielement = 0; ielement < num_local_elements; ielement++) {
+    vtkIdType           position = offsets[ielement] + ielement;
+
+    cellLocations[ielement] = position;
+    legacy_cells[position] = offsets[ielement + 1] - offsets[ielement];
+    for (ipoint = offsets[ielement]; ipoint < offsets[ielement + 1];
+         ipoint++) {
+      legacy_cells[position + 1 + ipoint - offsets[ielement]] = ipoint;
     }
   }
+  vtkNew < vtkIdTypeArray > legacyCellsArray;
+  legacyCellsArray->SetArray (legacy_cells,
+                              num_local_elements + num_points, 1);
+  cellArray->SetCells (num_local_elements, legacyCellsArray);
+  vtkNew < vtkIdTypeArray > cellLocationsArray;
+  cellLocationsArray->SetArray (cellLocations, num_local_elements, 1);
+#endif
 
   /* 
    * Write file: First we construct the unstructured Grid 
@@ -251,7 +417,11 @@ t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
 
   vtkNew < vtkUnstructuredGrid > unstructuredGrid;
   unstructuredGrid->SetPoints (points);
-  unstructuredGrid->SetCells (cellTypes, cellArray);
+#if VTK_MAJOR_VERSION >= 9
+  unstructuredGrid->SetCells (cellTypesArray, cellArray);
+#else
+  unstructuredGrid->SetCells (cellTypesArray, cellLocationsArray, cellArray);
+#endif
   /*
    * We define the filename used to write the pvtu and the vtu files.
    * The pwriterObj is of class XMLPUnstructuredGridWriter, the P in
@@ -275,6 +445,9 @@ t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
  * are given based on the name of the pvtu file and the process number.
  */
   pwriterObj->EncodeAppendedDataOff ();
+  /* We write the data binary and compressed to the appended section. */
+  pwriterObj->SetDataModeToAppended ();
+  pwriterObj->SetCompressorTypeToZLib ();
   pwriterObj->SetFileName (mpifilename);
 
 /*
@@ -312,8 +485,15 @@ t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
   pwriterObj->SetInputData (unstructuredGrid);
   pwriterObj->Update ();
   pwriterObj->Write ();
-/* We have to free the allocated memory for the cellTypes Array. */
+/* We have to free the arrays that we passed to vtk. */
+  T8_FREE (offsets);
+  T8_FREE (connectivity);
+  T8_FREE (coordinates);
   T8_FREE (cellTypes);
+#if VTK_MAJOR_VERSION < 9
+  T8_FREE (legacy_cells);
+  T8_FREE (cellLocations);
+#endif
 #else
   t8_global_errorf
     ("Warning: t8code is not linked against vtk library. Vtk output will not be generated.\n");
@@ -322,20 +502,44 @@ t8_forest_write_vtk_via_API (t8_forest_t forest, const char *fileprefix)
 #endif
 }
 
+/* Count the number of points of all elements in an element array.
+ * Only in pyramid trees the number of points differs between the
+ * elements, since they contain pyramids and tetrahedra. */
+static              t8_locidx_t
+t8_forest_num_points_array (t8_forest_t forest, t8_eclass_t eclass,
+                            t8_element_array_t * elements)
+{
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         ielem, num_elements, num_points;
+
+  num_elements = (t8_locidx_t) t8_element_array_get_count (elements);
+  if (eclass != T8_ECLASS_PYRAMID) {
+    return t8_eclass_num_vertices[eclass] * num_elements;
+  }
+  ts = t8_forest_get_eclass_scheme (forest, eclass);
+  num_points = 0;
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    num_points +=
+      ts->t8_element_num_corners (t8_element_array_index_locidx
+                                  (elements, ielem));
+  }
+  return num_points;
+}
+
 static              t8_locidx_t
 t8_forest_num_points (t8_forest_t forest, int count_ghosts)
 {
   t8_locidx_t         itree, num_points, num_ghosts;
   t8_tree_t           tree;
   t8_eclass_t         ghost_class;
+  t8_element_array_t *ghost_elements;
 
   num_points = 0;
   for (itree = 0; itree < (t8_locidx_t) forest->trees->elem_count; itree++) {
     /* Get the tree that stores the elements */
     tree = (t8_tree_t) t8_sc_array_index_topidx (forest->trees, itree);
-    /* TODO: This will cause problems when pyramids are introduced. */
-    num_points += t8_eclass_num_vertices[tree->eclass] *
-      t8_element_array_get_count (&tree->elements);
+    num_points += t8_forest_num_points_array (forest, tree->eclass,
+                                              &tree->elements);
   }
   if (count_ghosts) {
     T8_ASSERT (forest->ghosts != NULL);
@@ -344,16 +548,223 @@ t8_forest_num_points (t8_forest_t forest, int count_ghosts)
     for (itree = 0; itree < num_ghosts; itree++) {
       /* Get the element class of the ghost */
       ghost_class = t8_forest_ghost_get_tree_class (forest, itree);
-      /* TODO: does not work with pyramids */
-      SC_CHECK_ABORT (ghost_class != T8_ECLASS_PYRAMID,
-                      "Pyramids are not supported in vtk output");
-      num_points += t8_eclass_num_vertices[ghost_class]
-        * t8_forest_ghost_tree_num_elements (forest, itree);
+      ghost_elements = t8_forest_ghost_get_tree_elements (forest, itree);
+      num_points += t8_forest_num_points_array (forest, ghost_class,
+                                                ghost_elements);
     }
   }
   return num_points;
 }
 
+/* A corner of an element with its quantized coordinates, used to find
+ * the corners that share a vertex. */
+typedef struct
+{
+  long long           key[3];   /* The quantized coordinates */
+  size_t              corner;   /* The index of the corner in output order */
+} t8_forest_vtk_corner_t;
+
+/* Order corners by their quantized coordinates and then by index */
+static bool
+t8_forest_vtk_corner_less (const t8_forest_vtk_corner_t & a,
+                           const t8_forest_vtk_corner_t & b)
+{
+  int                 i;
+
+  for (i = 0; i < 3; i++) {
+    if (a.key[i] != b.key[i]) {
+      return a.key[i] < b.key[i];
+    }
+  }
+  return a.corner < b.corner;
+}
+
+/* Compute the coordinates of the corners of an element in the order
+ * in which t8_forest_vtk_cells_vertices_kernel writes them and store
+ * them in coordinates. Return the number of corners. */
+static int
+t8_forest_vtk_corner_coordinates (t8_forest_t forest, t8_locidx_t ltreeid,
+                                  const double *tree_vertices,
+                                  t8_eclass_scheme_c * ts,
+                                  const t8_element_t * element,
+                                  double *coordinates)
+{
+  t8_element_shape_t  element_shape;
+  int                 ivertex;
+
+  element_shape = ts->t8_element_shape (element);
+  for (ivertex = 0; ivertex < t8_eclass_num_vertices[element_shape];
+       ivertex++) {
+    t8_forest_element_coordinate (forest, ltreeid, element, tree_vertices,
+                                  t8_eclass_vtk_corner_number[element_shape]
+                                  [ivertex], coordinates + 3 * ivertex);
+  }
+  return t8_eclass_num_vertices[element_shape];
+}
+
+/* Find the element corners that share the same vertex and number the
+ * distinct vertices. On output, output->point_ids stores for each corner,
+ * in the order of the connectivity, the index of its vertex, and
+ * output->point_coordinates the coordinates of the vertices.
+ * Vertices are identified by their coordinates, quantized relative to the
+ * extent of the local domain. They are numbered in the order of their
+ * first occurrence to keep the locality of the elements. */
+static void
+t8_forest_vtk_compute_shared_points (t8_forest_t forest, int write_ghosts,
+                                     t8_forest_vtk_output_t * output)
+{
+  std::vector < double >coordinates;
+  std::vector < t8_forest_vtk_corner_t > corners;
+  std::vector < std::pair < size_t, size_t > >groups;
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         tree_class;
+  const double       *tree_vertices;
+  const t8_element_t *element;
+  t8_locidx_t         num_local_trees, itree, ielem, num_elements;
+  t8_locidx_t         ighost, ipoint;
+  double              lower[3], upper[3], extent, resolution;
+  size_t              num_corners, icorner, igroup, next;
+  int                 i, num_vertices;
+#ifdef T8_ENABLE_OPENMP
+  int                 num_threads;
+#endif
+
+  /* Compute the coordinates of all corners of the local elements.
+   * Except for pyramid trees, all elements of a tree have the same number
+   * of corners, and we compute their coordinates in parallel. */
+#ifdef T8_ENABLE_OPENMP
+  num_threads = t8_forest_get_num_threads (forest);
+#endif
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, num_corners = 0; itree < num_local_trees; itree++) {
+    num_corners += t8_forest_get_tree_num_corners (forest, itree);
+  }
+  coordinates.resize (3 * num_corners);
+  for (itree = 0, icorner = 0; itree < num_local_trees; itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    if (tree_class != T8_ECLASS_PYRAMID) {
+      double             *tree_coordinates = coordinates.data () + 3 * icorner;
+
+      num_vertices = t8_eclass_num_vertices[tree_class];
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+#endif
+      for (ielem = 0; ielem < num_elements; ielem++) {
+        t8_forest_vtk_corner_coordinates (forest, itree, tree_vertices, ts,
+                                          t8_forest_get_element_in_tree
+                                          (forest, itree, ielem),
+                                          tree_coordinates
+                                          + 3 * ielem * num_vertices);
+      }
+      icorner += num_elements * num_vertices;
+    }
+    else {
+      for (ielem = 0; ielem < num_elements; ielem++) {
+        icorner +=
+          t8_forest_vtk_corner_coordinates (forest, itree, tree_vertices, ts,
+                                            t8_forest_get_element_in_tree
+                                            (forest, itree, ielem),
+                                            coordinates.data () + 3 * icorner);
+      }
+    }
+  }
+  T8_ASSERT (icorner == num_corners);
+  if (write_ghosts) {
+    t8_cmesh_t          cmesh = t8_forest_get_cmesh (forest);
+
+    for (ighost = 0; ighost < t8_forest_ghost_num_trees (forest); ighost++) {
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_ghost_get_tree_class
+                                        (forest, ighost));
+      tree_vertices = (const double *)
+        t8_cmesh_get_attribute (cmesh, t8_get_package_id (), 0,
+                                t8_forest_ltreeid_to_cmesh_ltreeid
+                                (forest, ighost + num_local_trees));
+      num_elements = t8_forest_ghost_tree_num_elements (forest, ighost);
+      for (ielem = 0; ielem < num_elements; ielem++) {
+        element = t8_forest_ghost_get_element (forest, ighost, ielem);
+        num_vertices = t8_eclass_num_vertices[ts->t8_element_shape (element)];
+        coordinates.resize (3 * (num_corners + num_vertices));
+        num_corners +=
+          t8_forest_vtk_corner_coordinates (forest, ighost + num_local_trees,
+                                            tree_vertices, ts, element,
+                                            coordinates.data ()
+                                            + 3 * num_corners);
+      }
+    }
+  }
+
+  /* Quantize the coordinates relative to the extent of the local domain,
+   * such that rounding errors of the corner computation vanish */
+  T8_ASSERT (num_corners == coordinates.size () / 3);
+  for (i = 0; i < 3; i++) {
+    lower[i] = upper[i] = num_corners > 0 ? coordinates[i] : 0;
+  }
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    for (i = 0; i < 3; i++) {
+      lower[i] = SC_MIN (lower[i], coordinates[3 * icorner + i]);
+      upper[i] = SC_MAX (upper[i], coordinates[3 * icorner + i]);
+    }
+  }
+  for (i = 0, extent = 0; i < 3; i++) {
+    extent = SC_MAX (extent, upper[i] - lower[i]);
+  }
+  resolution = extent > 0 ? 1e-10 * extent : 1;
+  corners.resize (num_corners);
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(static) private(i) num_threads(num_threads)
+#endif
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    for (i = 0; i < 3; i++) {
+      corners[icorner].key[i] =
+        llround ((coordinates[3 * icorner + i] - lower[i]) / resolution);
+    }
+    corners[icorner].corner = icorner;
+  }
+  std::sort (corners.begin (), corners.end (), t8_forest_vtk_corner_less);
+
+  /* Find the groups of corners with the same vertex. Since the corners of a
+   * group are sorted, the first one has the smallest index. */
+  for (icorner = 0; icorner < num_corners; icorner = next) {
+    groups.push_back (std::make_pair (corners[icorner].corner, icorner));
+    for (next = icorner + 1; next < num_corners
+         && !memcmp (corners[next].key, corners[icorner].key,
+                     sizeof (corners[icorner].key)); next++) {
+    }
+  }
+  std::sort (groups.begin (), groups.end ());
+
+  /* Number the vertices by their first occurrence */
+  output->num_points = (t8_locidx_t) groups.size ();
+  output->point_ids = T8_ALLOC (t8_locidx_t, num_corners);
+  output->point_coordinates = T8_ALLOC (double, 3 * groups.size ());
+  for (igroup = 0; igroup < groups.size (); igroup++) {
+    ipoint = (t8_locidx_t) igroup;
+    memcpy (output->point_coordinates + 3 * igroup,
+            &coordinates[3 * groups[igroup].first], 3 * sizeof (double));
+    icorner = groups[igroup].second;
+    do {
+      output->point_ids[corners[icorner].corner] = ipoint;
+      icorner++;
+    } while (icorner < num_corners
+             && !memcmp (corners[icorner].key, corners[icorner - 1].key,
+                         sizeof (corners[icorner].key)));
+  }
+}
+
+/* Free the shared vertices computed by t8_forest_vtk_compute_shared_points */
+static void
+t8_forest_vtk_free_shared_points (t8_forest_vtk_output_t * output)
+{
+  T8_FREE (output->point_ids);
+  T8_FREE (output->point_coordinates);
+  output->point_ids = NULL;
+  output->point_coordinates = NULL;
+}
+
 static int
 t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
                                      t8_tree_t tree,
@@ -361,7 +772,8 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
                                      t8_element_t * element,
                                      t8_eclass_scheme_c * ts,
                                      int is_ghost,
-                                     FILE * vtufile, int *columns,
+                                     FILE * vtufile, sc_array_t * values,
+                                     int *columns,
                                      void **data, T8_VTK_KERNEL_MODUS modus)
 {
   struct t8_forest_vtk_vertices_t
@@ -369,6 +781,9 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
     t8_locidx_t         ltreeid;        /* Store the last treeid with which the lernel was called.
                                            This is either a local tree id or a local ghost tree id */
     double              tree_vertices[T8_ECLASS_MAX_CORNERS * 3];       /* Stores the vertex coordinates of the tree */
+    double             *corner_coordinates;     /* For local trees, the coordinates of all element corners of the tree */
+    size_t              corner_coordinates_size;        /* The number of points that fit into corner_coordinates */
+    t8_locidx_t         first_corner;   /* The index of the first corner of the current element in corner_coordinates */
   }                  *vertex_data;
 
 #if 0
@@ -376,8 +791,9 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
   double              midpoint[3];
 #endif
   double              element_coordinates[3];
-  int                 num_tree_vertices, ivertex;
+  int                 num_tree_vertices, ivertex, icorner, i;
   int                 freturn;
+  t8_element_shape_t  element_shape;
 
   if (modus == T8_VTK_KERNEL_INIT) {
     /* We initialize the user data to store NULL as the current tree */
@@ -388,6 +804,8 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
     return 1;
   }
   else if (modus == T8_VTK_KERNEL_CLEANUP) {
+    vertex_data = (struct t8_forest_vtk_vertices_t *) *data;
+    T8_FREE (vertex_data->corner_coordinates);
     T8_FREE (*data);
     return 1;
   }
@@ -415,22 +833,46 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
     num_tree_vertices = t8_eclass_num_vertices[ts->eclass];
     memcpy (vertex_data->tree_vertices, temp_vertices, sizeof (*temp_vertices)
             * num_tree_vertices * 3);
+    if (!is_ghost) {
+      size_t              num_corners;
+
+      /* Compute the coordinates of all corners of the tree at once */
+      num_corners = t8_forest_get_tree_num_corners (forest, ltree_id);
+      if (num_corners > vertex_data->corner_coordinates_size) {
+        vertex_data->corner_coordinates =
+          T8_REALLOC (vertex_data->corner_coordinates, double,
+                      3 * num_corners);
+        vertex_data->corner_coordinates_size = num_corners;
+      }
+      t8_forest_tree_element_coordinates (forest, ltree_id,
+                                          vertex_data->corner_coordinates);
+      vertex_data->first_corner = 0;
+    }
   }
 
-  /* TODO: be careful with pyramid class here.
-   *       does this work too over tree->class or do we need something else?
-   */
+  /* The shape of the element may differ from the tree's class,
+   * for example a pyramid tree contains tetrahedra. */
+  element_shape = ts->t8_element_shape (element);
 
 #if 0
   /* if we eventually implement scaling the elements, activate this line */
   t8_forest_element_centroid (forest, ltree_id, element,
                               vertex_data->tree_vertices, midpoint);
 #endif
-  for (ivertex = 0; ivertex < t8_eclass_num_vertices[ts->eclass]; ivertex++) {
-    t8_forest_element_coordinate (forest, ltree_id, element,
-                                  vertex_data->tree_vertices,
-                                  t8_eclass_vtk_corner_number[ts->eclass]
-                                  [ivertex], element_coordinates);
+  for (ivertex = 0; ivertex < t8_eclass_num_vertices[element_shape];
+       ivertex++) {
+    icorner = t8_eclass_vtk_corner_number[element_shape][ivertex];
+    if (!is_ghost) {
+      for (i = 0; i < 3; i++) {
+        element_coordinates[i] = vertex_data->corner_coordinates
+          [3 * (vertex_data->first_corner + icorner) + i];
+      }
+    }
+    else {
+      t8_forest_element_coordinate (forest, ltree_id, element,
+                                    vertex_data->tree_vertices, icorner,
+                                    element_coordinates);
+    }
 #if 0
     /* if we eventually implement scaling the elements, activate this line */
     /* replace 0.9 with the scale factor
@@ -438,6 +880,12 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
     t8_vec_ax (element_coordinates, 0.9);
     t8_vec_axpy (midpoint, element_coordinates, 0.1);
 #endif
+    if (values != NULL) {
+      for (i = 0; i < 3; i++) {
+        t8_forest_vtk_push_float (values, element_coordinates[i]);
+      }
+      continue;
+    }
     freturn = fprintf (vtufile, "         ");
     if (freturn <= 0) {
       return 0;
@@ -458,6 +906,10 @@ t8_forest_vtk_cells_vertices_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
      * by keeping the columns value constant. */
     *columns = 1;
   }
+  if (!is_ghost) {
+    /* The corners of the next element follow the ones of this element */
+    vertex_data->first_corner += t8_eclass_num_vertices[element_shape];
+  }
   return 1;
 }
 
@@ -577,11 +1029,12 @@ t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest,
                                          t8_element_t * elements,
                                          t8_eclass_scheme_c * ts,
                                          int is_ghost,
-                                         FILE * vtufile, int *columns,
+                                         FILE * vtufile, sc_array_t * values,
+                                         int *columns,
                                          void **data,
                                          T8_VTK_KERNEL_MODUS modus)
 {
-  int                 ivertex;
+  int                 ivertex, num_vertices;
   int                 freturn;
   t8_locidx_t        *count_vertices;
 
@@ -598,17 +1051,68 @@ t8_forest_vtk_cells_connectivity_kernel (t8_forest_t forest,
 
   count_vertices = (t8_locidx_t *) * data;
 
-  /* TODO: This will definitely break with pyramids */
-  SC_CHECK_ABORT (ts->eclass != T8_ECLASS_PYRAMID,
-                  "No vtk support for pyramids.");
-  for (ivertex = 0; ivertex < t8_eclass_num_vertices[ts->eclass];
-       ++ivertex, (*count_vertices)++) {
+  num_vertices = t8_eclass_num_vertices[ts->t8_element_shape (elements)];
+  for (ivertex = 0; ivertex < num_vertices; ++ivertex, (*count_vertices)++) {
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, *count_vertices);
+      continue;
+    }
     freturn = fprintf (vtufile, " %ld", (long) *count_vertices);
     if (freturn <= 0) {
       return 0;
     }
   }
-  *columns += t8_eclass_num_vertices[ts->eclass];
+  *columns += num_vertices;
+  return 1;
+}
+
+/* The data of t8_forest_vtk_cells_shared_connectivity_kernel */
+typedef struct
+{
+  const t8_locidx_t  *point_ids;        /* The vertex of each element corner */
+  t8_locidx_t         next_corner;      /* The next corner to write */
+} t8_forest_vtk_shared_connectivity_t;
+
+/* The connectivity kernel for shared vertices. Instead of counting the
+ * corners, it writes the index of the vertex of each corner. The data is
+ * a t8_forest_vtk_shared_connectivity_t provided by the caller. */
+static int
+t8_forest_vtk_cells_shared_connectivity_kernel (t8_forest_t forest,
+                                                t8_locidx_t ltree_id,
+                                                t8_tree_t tree,
+                                                t8_locidx_t element_index,
+                                                t8_element_t * elements,
+                                                t8_eclass_scheme_c * ts,
+                                                int is_ghost,
+                                                FILE * vtufile,
+                                                sc_array_t * values,
+                                                int *columns, void **data,
+                                                T8_VTK_KERNEL_MODUS modus)
+{
+  t8_forest_vtk_shared_connectivity_t *connectivity;
+  t8_locidx_t         point_id;
+  int                 ivertex, num_vertices;
+  int                 freturn;
+
+  if (modus != T8_VTK_KERNEL_EXECUTE) {
+    /* The data is owned by the caller */
+    return 1;
+  }
+  connectivity = (t8_forest_vtk_shared_connectivity_t *) * data;
+
+  num_vertices = t8_eclass_num_vertices[ts->t8_element_shape (elements)];
+  for (ivertex = 0; ivertex < num_vertices; ++ivertex) {
+    point_id = connectivity->point_ids[connectivity->next_corner++];
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, point_id);
+      continue;
+    }
+    freturn = fprintf (vtufile, " %ld", (long) point_id);
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  *columns += num_vertices;
   return 1;
 }
 
@@ -619,7 +1123,8 @@ t8_forest_vtk_cells_offset_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
                                    t8_element_t * element,
                                    t8_eclass_scheme_c * ts,
                                    int is_ghost,
-                                   FILE * vtufile, int *columns,
+                                   FILE * vtufile, sc_array_t * values,
+                                   int *columns,
                                    void **data, T8_VTK_KERNEL_MODUS modus)
 {
   long long          *offset;
@@ -637,10 +1142,11 @@ t8_forest_vtk_cells_offset_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
 
   offset = (long long *) *data;
 
-  /* TODO: This will also break with pyramids! */
-  SC_CHECK_ABORT (ts->eclass != T8_ECLASS_PYRAMID,
-                  "Pyramids not supported in vtk");
-  *offset += t8_eclass_num_vertices[ts->eclass];
+  *offset += t8_eclass_num_vertices[ts->t8_element_shape (element)];
+  if (values != NULL) {
+    t8_forest_vtk_push_int (values, *offset);
+    return 1;
+  }
   freturn = fprintf (vtufile, " %lld", *offset);
   if (freturn <= 0) {
     return 0;
@@ -657,13 +1163,21 @@ t8_forest_vtk_cells_type_kernel (t8_forest_t forest, t8_locidx_t ltree_id,
                                  t8_element_t * element,
                                  t8_eclass_scheme_c * ts,
                                  int is_ghost,
-                                 FILE * vtufile, int *columns,
+                                 FILE * vtufile, sc_array_t * values,
+                                 int *columns,
                                  void **data, T8_VTK_KERNEL_MODUS modus)
 {
   int                 freturn;
   if (modus == T8_VTK_KERNEL_EXECUTE) {
     /* print the vtk type of the element */
-    freturn = fprintf (vtufile, " %d", t8_eclass_vtk_type[ts->eclass]);
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values,
+                              t8_eclass_vtk_type[ts->t8_element_shape
+                                                 (element)]);
+      return 1;
+    }
+    freturn = fprintf (vtufile, " %d",
+                       t8_eclass_vtk_type[ts->t8_element_shape (element)]);
     if (freturn <= 0) {
       return 0;
     }
@@ -679,10 +1193,15 @@ t8_forest_vtk_cells_level_kernel (t8_forest_t forest,
                                   t8_element_t * element,
                                   t8_eclass_scheme_c * ts,
                                   int is_ghost,
-                                  FILE * vtufile, int *columns,
+                                  FILE * vtufile, sc_array_t * values,
+                                  int *columns,
                                   void **data, T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, ts->t8_element_level (element));
+      return 1;
+    }
     fprintf (vtufile, "%i ", ts->t8_element_level (element));
     *columns += 1;
   }
@@ -696,10 +1215,15 @@ t8_forest_vtk_cells_rank_kernel (t8_forest_t forest,
                                  t8_element_t * element,
                                  t8_eclass_scheme_c * ts,
                                  int is_ghost,
-                                 FILE * vtufile, int *columns,
+                                 FILE * vtufile, sc_array_t * values,
+                                 int *columns,
                                  void **data, T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, forest->mpirank);
+      return 1;
+    }
     fprintf (vtufile, "%i ", forest->mpirank);
     *columns += 1;
   }
@@ -713,7 +1237,8 @@ t8_forest_vtk_cells_treeid_kernel (t8_forest_t forest,
                                    t8_element_t * element,
                                    t8_eclass_scheme_c * ts,
                                    int is_ghost,
-                                   FILE * vtufile, int *columns,
+                                   FILE * vtufile, sc_array_t * values,
+                                   int *columns,
                                    void **data, T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
@@ -726,6 +1251,10 @@ t8_forest_vtk_cells_treeid_kernel (t8_forest_t forest,
       /* Otherwise the global tree id */
       tree_id = (long long) ltree_id + forest->first_local_tree;
     }
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, tree_id);
+      return 1;
+    }
     fprintf (vtufile, "%lli ", tree_id);
     *columns += 1;
   }
@@ -739,17 +1268,24 @@ t8_forest_vtk_cells_elementid_kernel (t8_forest_t forest,
                                       t8_element_t * element,
                                       t8_eclass_scheme_c * ts,
                                       int is_ghost,
-                                      FILE * vtufile, int *columns,
+                                      FILE * vtufile, sc_array_t * values,
+                                      int *columns,
                                       void **data, T8_VTK_KERNEL_MODUS modus)
 {
   if (modus == T8_VTK_KERNEL_EXECUTE) {
+    long long           element_id;
     if (!is_ghost) {
-      fprintf (vtufile, "%lli ", element_index + tree->elements_offset +
-               (long long) t8_forest_get_first_local_element_id (forest));
+      element_id = element_index + tree->elements_offset +
+        (long long) t8_forest_get_first_local_element_id (forest);
     }
     else {
-      fprintf (vtufile, "%lli ", (long long) -1);
+      element_id = -1;
+    }
+    if (values != NULL) {
+      t8_forest_vtk_push_int (values, element_id);
+      return 1;
     }
+    fprintf (vtufile, "%lli ", element_id);
     *columns += 1;
   }
   return 1;
@@ -762,7 +1298,8 @@ t8_forest_vtk_cells_scalar_kernel (t8_forest_t forest,
                                    t8_element_t * element,
                                    t8_eclass_scheme_c * ts,
                                    int is_ghost,
-                                   FILE * vtufile, int *columns,
+                                   FILE * vtufile, sc_array_t * values,
+                                   int *columns,
                                    void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double              element_value = 0;
@@ -778,6 +1315,10 @@ t8_forest_vtk_cells_scalar_kernel (t8_forest_t forest,
     else {
       element_value = 0;
     }
+    if (values != NULL) {
+      t8_forest_vtk_push_float (values, element_value);
+      return 1;
+    }
     fprintf (vtufile, "%g ", element_value);
     *columns += 1;
   }
@@ -791,7 +1332,8 @@ t8_forest_vtk_cells_vector_kernel (t8_forest_t forest,
                                    t8_element_t * element,
                                    t8_eclass_scheme_c * ts,
                                    int is_ghost,
-                                   FILE * vtufile, int *columns,
+                                   FILE * vtufile, sc_array_t * values,
+                                   int *columns,
                                    void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double             *element_values, null_vec[3] = { 0, 0, 0 };
@@ -812,7 +1354,12 @@ t8_forest_vtk_cells_vector_kernel (t8_forest_t forest,
       element_values = null_vec;
     }
     for (idim = 0; idim < dim; idim++) {
-      fprintf (vtufile, "%g ", element_values[idim]);
+      if (values != NULL) {
+        t8_forest_vtk_push_float (values, element_values[idim]);
+      }
+      else {
+        fprintf (vtufile, "%g ", element_values[idim]);
+      }
     }
     *columns += dim;
   }
@@ -827,7 +1374,8 @@ t8_forest_vtk_vertices_scalar_kernel (t8_forest_t forest,
                                       t8_element_t * element,
                                       t8_eclass_scheme_c * ts,
                                       int is_ghost,
-                                      FILE * vtufile, int *columns,
+                                      FILE * vtufile, sc_array_t * values,
+                                      int *columns,
                                       void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double              element_value = 0;
@@ -847,6 +1395,10 @@ t8_forest_vtk_vertices_scalar_kernel (t8_forest_t forest,
       else {
         element_value = 0;
       }
+      if (values != NULL) {
+        t8_forest_vtk_push_float (values, element_value);
+        continue;
+      }
       fprintf (vtufile, "%g ", element_value);
       *columns += 1;
     }
@@ -862,7 +1414,8 @@ t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest,
                                       t8_element_t * element,
                                       t8_eclass_scheme_c * ts,
                                       int is_ghost,
-                                      FILE * vtufile, int *columns,
+                                      FILE * vtufile, sc_array_t * values,
+                                      int *columns,
                                       void **data, T8_VTK_KERNEL_MODUS modus)
 {
   double             *element_values, null_vec[3] = { 0, 0, 0 };
@@ -886,7 +1439,12 @@ t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest,
         element_values = null_vec;
       }
       for (idim = 0; idim < dim; idim++) {
-        fprintf (vtufile, "%g ", element_values[idim]);
+        if (values != NULL) {
+          t8_forest_vtk_push_float (values, element_values[idim]);
+        }
+        else {
+          fprintf (vtufile, "%g ", element_values[idim]);
+        }
       }
       *columns += dim;
     }
@@ -894,10 +1452,153 @@ t8_forest_vtk_vertices_vector_kernel (t8_forest_t forest,
   return 1;
 }
 
+/* Write the header of a binary data array that refers to the appended
+ * data section and record the offset of the array.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_write_binary_header (t8_forest_vtk_output_t * output,
+                                   const char *dataname,
+                                   const char *datatype,
+                                   const char *component_string)
+{
+  size_t              offset = output->appended.elem_count;
+
+  if (output->replay) {
+    /* The data was already appended, we only need its offset */
+    T8_ASSERT (output->next_array < output->array_offsets->elem_count);
+    offset = *(size_t *) sc_array_index (output->array_offsets,
+                                         output->next_array++);
+  }
+  else if (output->array_offsets != NULL) {
+    *(size_t *) sc_array_push (output->array_offsets) = offset;
+  }
+  /* The data follows in the appended data section, starting at the
+   * current end of it. */
+  return fprintf (output->vtufile, "        <DataArray type=\"%s\" "
+                  "Name=\"%s\" %s format=\"appended\" offset=\"%lld\"/>\n",
+                  datatype, dataname, component_string,
+                  output->base_offset + (long long) offset) > 0;
+}
+
+/* Write a floating point data array with \a num_components values for
+ * each shared vertex.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_write_point_array (t8_forest_vtk_output_t * output,
+                                 const char *dataname,
+                                 const char *component_string,
+                                 int num_components,
+                                 const double *point_values)
+{
+  const size_t        num_values =
+    (size_t) num_components * output->num_points;
+  sc_array_t          values;
+  size_t              ivalue;
+  int                 freturn;
+
+  if (output->format != T8_VTK_FORMAT_ASCII) {
+    if (!t8_forest_vtk_write_binary_header (output, dataname,
+                                            T8_VTK_FLOAT_NAME,
+                                            component_string)) {
+      return 0;
+    }
+    if (output->replay) {
+      return 1;
+    }
+    sc_array_init_size (&values, sizeof (T8_VTK_FLOAT_TYPE), num_values);
+    for (ivalue = 0; ivalue < num_values; ivalue++) {
+      *(T8_VTK_FLOAT_TYPE *) sc_array_index (&values, ivalue) =
+        (T8_VTK_FLOAT_TYPE) point_values[ivalue];
+    }
+    freturn = t8_forest_vtk_append_array (output, &values);
+    sc_array_reset (&values);
+    return freturn;
+  }
+
+  freturn = fprintf (output->vtufile, "        <DataArray type=\"%s\" "
+                     "Name=\"%s\" %s format=\"ascii\">\n",
+                     T8_VTK_FLOAT_NAME, dataname, component_string);
+  if (freturn <= 0) {
+    return 0;
+  }
+  for (ivalue = 0; ivalue < num_values; ivalue++) {
+    /* We write the values of one vertex per line */
+#ifdef T8_VTK_DOUBLES
+    freturn = fprintf (output->vtufile, " %24.16e%s", point_values[ivalue],
+                       (ivalue + 1) % num_components ? "" : "\n");
+#else
+    freturn = fprintf (output->vtufile, " %16.8e%s", point_values[ivalue],
+                       (ivalue + 1) % num_components ? "" : "\n");
+#endif
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  freturn = fprintf (output->vtufile, "        </DataArray>\n");
+  return freturn > 0;
+}
+
+/* Compute the values of a data field at the shared vertices. The value
+ * of a vertex is the average of the values of the local elements that
+ * contain it, ghost elements do not contribute.
+ * Returns an allocated array of 1 (scalar) or 3 (vector) values per vertex,
+ * which must be freed by the caller. */
+static double      *
+t8_forest_vtk_shared_point_data (t8_forest_t forest,
+                                 t8_forest_vtk_output_t * output,
+                                 const t8_vtk_data_field_t * field)
+{
+  const int           dim = field->type == T8_VTK_SCALAR ? 1 : 3;
+  double             *point_values;
+  int                *counts;
+  t8_eclass_scheme_c *ts;
+  t8_locidx_t         itree, ielem, num_elements, element_index, ipoint;
+  size_t              icorner;
+  int                 ivertex, num_vertices, idim;
+
+  point_values = T8_ALLOC_ZERO (double, dim * output->num_points);
+  counts = T8_ALLOC_ZERO (int, output->num_points);
+  /* The corners of the local elements come first in the connectivity */
+  for (itree = 0, icorner = 0;
+       itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      element_index = t8_forest_get_tree_element_offset (forest, itree)
+        + ielem;
+      num_vertices = t8_eclass_num_vertices[ts->t8_element_shape
+                                            (t8_forest_get_element_in_tree
+                                             (forest, itree, ielem))];
+      for (ivertex = 0; ivertex < num_vertices; ivertex++, icorner++) {
+        ipoint = output->point_ids[icorner];
+        for (idim = 0; idim < dim; idim++) {
+          point_values[dim * ipoint + idim] +=
+            field->data[dim * element_index + idim];
+        }
+        counts[ipoint]++;
+      }
+    }
+  }
+  for (ipoint = 0; ipoint < output->num_points; ipoint++) {
+    for (idim = 0; idim < dim && counts[ipoint] > 0; idim++) {
+      point_values[dim * ipoint + idim] /= counts[ipoint];
+    }
+  }
+  T8_FREE (counts);
+  return point_values;
+}
+
 /* Iterate over all cells and write cell data to the file using
- * the cell_data_kernel as callback */
+ * the cell_data_kernel as callback.
+ * In ascii format the values are printed directly to the file.
+ * In binary format the values are collected and appended to the
+ * appended data section of \a output, the file only gets a reference
+ * to their offset. In replay mode only this reference is written. */
 static int
-t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
+t8_forest_vtk_write_cell_data (t8_forest_t forest,
+                               t8_forest_vtk_output_t * output,
                                const char *dataname,
                                const char *datatype,
                                const char *component_string,
@@ -914,14 +1615,26 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
   t8_element_t       *element;
   t8_eclass_scheme_c *ts;
   void               *data = NULL;
-
-  /* Write the connectivity information.
-   * Thus for each tree we write the indices of its corner vertices. */
-  freturn = fprintf (vtufile, "        <DataArray type=\"%s\" "
-                     "Name=\"%s\" %s format=\"ascii\">\n         ",
-                     datatype, dataname, component_string);
+  FILE               *vtufile = output->vtufile;
+  sc_array_t          binary_values, *values = NULL;
+
+  /* Write the header of the data array. */
+  if (output->format == T8_VTK_FORMAT_ASCII) {
+    freturn = fprintf (vtufile, "        <DataArray type=\"%s\" "
+                       "Name=\"%s\" %s format=\"ascii\">\n         ",
+                       datatype, dataname, component_string);
+  }
+  else {
+    freturn = t8_forest_vtk_write_binary_header (output, dataname, datatype,
+                                                 component_string);
+    if (output->replay) {
+      return freturn;
+    }
+    sc_array_init (&binary_values, t8_forest_vtk_type_size (datatype));
+    values = &binary_values;
+  }
   if (freturn <= 0) {
-    return 0;
+    goto t8_forest_vtk_cell_data_failure;
   }
 
   /* if udata != NULL, use it as the data pointer, in this case, the kernel
@@ -932,7 +1645,7 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
 
   /* Call the kernel in initilization modus to possibly initialize the
    * data pointer */
-  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, NULL, &data,
           T8_VTK_KERNEL_INIT);
   /* We iterate over the trees and count each trees vertices,
    * we add this to the already counted vertices and write it to the file */
@@ -956,29 +1669,17 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
       /* Execute the given callback on each element */
       if (!kernel
           (forest, itree, tree, element_index, element, ts, 0, vtufile,
-           &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
-        /* call the kernel in clean-up modus */
-        kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
-                T8_VTK_KERNEL_CLEANUP);
-        return 0;
+           values, &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
+        goto t8_forest_vtk_cell_data_cleanup;
       }
       /* After max_columns we break the line */
-      if (!(countcols % max_columns)) {
+      if (values == NULL && !(countcols % max_columns)) {
         freturn = fprintf (vtufile, "\n         ");
         if (freturn <= 0) {
-          /* call the kernel in clean-up modus */
-          kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
-                  T8_VTK_KERNEL_CLEANUP);
-          return 0;
+          goto t8_forest_vtk_cell_data_cleanup;
         }
       }
     }                           /* element loop ends here */
-    if (freturn <= 0) {
-      /* call the kernel in clean-up modus */
-      kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
-              T8_VTK_KERNEL_CLEANUP);
-      return 0;
-    }
   }                             /* tree loop ends here */
 
   if (write_ghosts) {
@@ -1001,40 +1702,48 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
         /* Execute the given callback on each element */
         if (!kernel
             (forest, ighost + num_local_trees, NULL, element_index, element,
-             ts, 1, vtufile, &countcols, &data, T8_VTK_KERNEL_EXECUTE)) {
-          /* call the kernel in clean-up modus */
-          kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data,
-                  T8_VTK_KERNEL_CLEANUP);
-          return 0;
+             ts, 1, vtufile, values, &countcols, &data,
+             T8_VTK_KERNEL_EXECUTE)) {
+          goto t8_forest_vtk_cell_data_cleanup;
         }
         /* After max_columns we break the line */
-        if (!(countcols % max_columns)) {
+        if (values == NULL && !(countcols % max_columns)) {
           freturn = fprintf (vtufile, "\n         ");
           if (freturn <= 0) {
-            /* call the kernel in clean-up modus */
-            kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data,
-                    T8_VTK_KERNEL_CLEANUP);
-            return 0;
+            goto t8_forest_vtk_cell_data_cleanup;
           }
         }
       }                         /* element loop ends here */
-      if (freturn <= 0) {
-        /* call the kernel in clean-up modus */
-        kernel (NULL, 0, NULL, 0, NULL, NULL, 1, NULL, NULL, &data,
-                T8_VTK_KERNEL_CLEANUP);
-        return 0;
-      }
     }                           /* ghost loop ends here */
   }                             /* write_ghosts ends here */
   /* call the kernel in clean-up modus */
-  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, &data,
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, NULL, &data,
           T8_VTK_KERNEL_CLEANUP);
-  freturn = fprintf (vtufile, "\n        </DataArray>\n");
-  if (freturn <= 0) {
-    return 0;
+  if (values == NULL) {
+    freturn = fprintf (vtufile, "\n        </DataArray>\n");
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  else {
+    /* Move the whole array to the appended data section at once */
+    freturn = t8_forest_vtk_append_array (output, values);
+    sc_array_reset (values);
+    if (!freturn) {
+      return 0;
+    }
   }
 
   return 1;
+t8_forest_vtk_cell_data_cleanup:
+  /* call the kernel in clean-up modus */
+  kernel (NULL, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, NULL, &data,
+          T8_VTK_KERNEL_CLEANUP);
+t8_forest_vtk_cell_data_failure:
+  if (values != NULL) {
+    sc_array_reset (values);
+  }
+  return 0;
 }
 
 /* Write the cell data to an open file stream.
@@ -1042,7 +1751,8 @@ t8_forest_vtk_write_cell_data (t8_forest_t forest, FILE * vtufile,
  * After completion the file will remain open, whether writing
  * cells was successful or not. */
 static int
-t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
+t8_forest_vtk_write_cells (t8_forest_t forest,
+                           t8_forest_vtk_output_t * output,
                            int write_treeid,
                            int write_mpirank,
                            int write_level, int write_element_id,
@@ -1051,6 +1761,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
 {
   int                 freturn;
   int                 idata;
+  FILE               *vtufile = output->vtufile;
 
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (vtufile != NULL);
@@ -1062,10 +1773,23 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
 
   /* Write the connectivity information.
    * Thus for each tree we write the indices of its corner vertices. */
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "connectivity",
-                                           T8_VTK_LOCIDX, "", 8,
-                                           t8_forest_vtk_cells_connectivity_kernel,
-                                           write_ghosts, NULL);
+  if (output->point_ids != NULL) {
+    t8_forest_vtk_shared_connectivity_t connectivity;
+
+    /* Each corner refers to its shared vertex */
+    connectivity.point_ids = output->point_ids;
+    connectivity.next_corner = 0;
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "connectivity",
+                                             T8_VTK_LOCIDX, "", 8,
+                                             t8_forest_vtk_cells_shared_connectivity_kernel,
+                                             write_ghosts, &connectivity);
+  }
+  else {
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "connectivity",
+                                             T8_VTK_LOCIDX, "", 8,
+                                             t8_forest_vtk_cells_connectivity_kernel,
+                                             write_ghosts, NULL);
+  }
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
   }
@@ -1077,7 +1801,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
    * For example if the trees are a square and a triangle, the offsets would
    * be 4 and 7, since indices 0,1,2,3 refer to the vertices of the square
    * and indices 4,5,6 to the indices of the triangle. */
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "offsets",
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "offsets",
                                            T8_VTK_LOCIDX, "", 8,
                                            t8_forest_vtk_cells_offset_kernel,
                                            write_ghosts, NULL);
@@ -1089,7 +1813,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
   /* Write the element types. The type specifies the element class, thus
    * square/triangle/tet etc. */
 
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "types",
+  freturn = t8_forest_vtk_write_cell_data (forest, output, "types",
                                            "Int32", "", 8,
                                            t8_forest_vtk_cells_type_kernel,
                                            write_ghosts, NULL);
@@ -1112,7 +1836,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
   if (write_treeid) {
     /* Write the tree ids. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "treeid",
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "treeid",
                                              T8_VTK_GLOIDX, "", 8,
                                              t8_forest_vtk_cells_treeid_kernel,
                                              write_ghosts, NULL);
@@ -1124,7 +1848,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
   if (write_mpirank) {
     /* Write the mpiranks. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "mpirank",
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "mpirank",
                                              "Int32", "", 8,
                                              t8_forest_vtk_cells_rank_kernel,
                                              write_ghosts, NULL);
@@ -1136,7 +1860,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
   if (write_level) {
     /* Write the element refinement levels. */
 
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "level",
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "level",
                                              "Int32", "", 8,
                                              t8_forest_vtk_cells_level_kernel,
                                              write_ghosts, NULL);
@@ -1153,7 +1877,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
     /* Use 32 bit ints if the global element count fits, 64 bit otherwise. */
     datatype = forest->global_num_elements > T8_LOCIDX_MAX ? T8_VTK_GLOIDX :
       T8_VTK_LOCIDX;
-    freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "element_id",
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "element_id",
                                              datatype, "", 8,
                                              t8_forest_vtk_cells_elementid_kernel,
                                              write_ghosts, NULL);
@@ -1167,7 +1891,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
   for (idata = 0; idata < num_data; idata++) {
     if (data[idata].type == T8_VTK_SCALAR) {
       freturn =
-        t8_forest_vtk_write_cell_data (forest, vtufile,
+        t8_forest_vtk_write_cell_data (forest, output,
                                        data[idata].description,
                                        T8_VTK_FLOAT_NAME, "", 8,
                                        t8_forest_vtk_cells_scalar_kernel,
@@ -1178,7 +1902,7 @@ t8_forest_vtk_write_cells (t8_forest_t forest, FILE * vtufile,
       T8_ASSERT (data[idata].type == T8_VTK_VECTOR);
       snprintf (component_string, BUFSIZ, "NumberOfComponents=\"3\"");
       freturn =
-        t8_forest_vtk_write_cell_data (forest, vtufile,
+        t8_forest_vtk_write_cell_data (forest, output,
                                        data[idata].description,
                                        T8_VTK_FLOAT_NAME,
                                        component_string,
@@ -1209,7 +1933,8 @@ t8_forest_vtk_cell_failure:
  * After completion the file will remain open, whether writing
  * cells was successful or not. */
 static int
-t8_forest_vtk_write_points (t8_forest_t forest, FILE * vtufile,
+t8_forest_vtk_write_points (t8_forest_t forest,
+                            t8_forest_vtk_output_t * output,
                             int write_ghosts,
                             int num_data, t8_vtk_data_field_t * data)
 {
@@ -1217,6 +1942,7 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE * vtufile,
   int                 sreturn;
   int                 idata;
   char                description[BUFSIZ];
+  FILE               *vtufile = output->vtufile;
 
   T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (vtufile != NULL);
@@ -1227,12 +1953,19 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE * vtufile,
   if (freturn <= 0) {
     goto t8_forest_vtk_cell_failure;
   }
-  freturn = t8_forest_vtk_write_cell_data (forest, vtufile, "Position",
-                                           T8_VTK_FLOAT_NAME,
-                                           "NumberOfComponents=\"3\"",
-                                           8,
-                                           t8_forest_vtk_cells_vertices_kernel,
-                                           write_ghosts, NULL);
+  if (output->point_ids != NULL) {
+    freturn = t8_forest_vtk_write_point_array (output, "Position",
+                                               "NumberOfComponents=\"3\"", 3,
+                                               output->point_coordinates);
+  }
+  else {
+    freturn = t8_forest_vtk_write_cell_data (forest, output, "Position",
+                                             T8_VTK_FLOAT_NAME,
+                                             "NumberOfComponents=\"3\"",
+                                             8,
+                                             t8_forest_vtk_cells_vertices_kernel,
+                                             write_ghosts, NULL);
+  }
   if (!freturn) {
     goto t8_forest_vtk_cell_failure;
   }
@@ -1258,11 +1991,21 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE * vtufile,
             ("Warning: Truncated vtk point data description to '%s'\n",
              description);
         }
-        freturn =
-          t8_forest_vtk_write_cell_data (forest, vtufile, description,
-                                         T8_VTK_FLOAT_NAME, "", 8,
-                                         t8_forest_vtk_vertices_scalar_kernel,
-                                         write_ghosts, data[idata].data);
+        if (output->point_ids != NULL) {
+          double             *point_values =
+            t8_forest_vtk_shared_point_data (forest, output, data + idata);
+
+          freturn = t8_forest_vtk_write_point_array (output, description, "",
+                                                     1, point_values);
+          T8_FREE (point_values);
+        }
+        else {
+          freturn =
+            t8_forest_vtk_write_cell_data (forest, output, description,
+                                           T8_VTK_FLOAT_NAME, "", 8,
+                                           t8_forest_vtk_vertices_scalar_kernel,
+                                           write_ghosts, data[idata].data);
+        }
       }
       else {
         char                component_string[BUFSIZ];
@@ -1282,12 +2025,24 @@ t8_forest_vtk_write_points (t8_forest_t forest, FILE * vtufile,
              description);
         }
 
-        freturn =
-          t8_forest_vtk_write_cell_data (forest, vtufile, description,
-                                         T8_VTK_FLOAT_NAME, component_string,
-                                         8 * forest->dimension,
-                                         t8_forest_vtk_vertices_vector_kernel,
-                                         write_ghosts, data[idata].data);
+        if (output->point_ids != NULL) {
+          double             *point_values =
+            t8_forest_vtk_shared_point_data (forest, output, data + idata);
+
+          freturn = t8_forest_vtk_write_point_array (output, description,
+                                                     component_string, 3,
+                                                     point_values);
+          T8_FREE (point_values);
+        }
+        else {
+          freturn =
+            t8_forest_vtk_write_cell_data (forest, output, description,
+                                           T8_VTK_FLOAT_NAME,
+                                           component_string,
+                                           8 * forest->dimension,
+                                           t8_forest_vtk_vertices_vector_kernel,
+                                           write_ghosts, data[idata].data);
+        }
       }
       if (!freturn) {
         goto t8_forest_vtk_cell_failure;
@@ -1303,6 +2058,163 @@ t8_forest_vtk_cell_failure:
   return 0;
 }
 
+/* Write the xml header of a .vtu file up to the opening tag of the
+ * unstructured grid.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_write_header (FILE * vtufile, t8_vtk_format_t format)
+{
+  int                 freturn;
+
+  freturn = fprintf (vtufile, "<?xml version=\"1.0\"?>\n");
+  if (freturn <= 0) {
+    return 0;
+  }
+  /* The header_type attribute is only read for file versions >= 1.0 */
+  freturn =
+    fprintf (vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"%s\"",
+             format == T8_VTK_FORMAT_ASCII ? "0.1" : "1.0");
+  if (freturn <= 0) {
+    return 0;
+  }
+  if (format != T8_VTK_FORMAT_ASCII) {
+    /* The sizes preceding the binary data arrays are 64 bit integers */
+    freturn = fprintf (vtufile, " header_type=\"UInt64\"%s",
+                       format == T8_VTK_FORMAT_COMPRESSED ?
+                       " compressor=\"vtkZLibDataCompressor\"" : "");
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+#ifdef SC_IS_BIGENDIAN
+  freturn = fprintf (vtufile, " byte_order=\"BigEndian\">\n");
+#else
+  freturn = fprintf (vtufile, " byte_order=\"LittleEndian\">\n");
+#endif
+  if (freturn <= 0) {
+    return 0;
+  }
+  freturn = fprintf (vtufile, "  <UnstructuredGrid>\n");
+  return freturn > 0;
+}
+
+/* Write the end of a .vtu file after its piece, that is the appended
+ * data section in binary format and the closing tags.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_write_footer (t8_forest_vtk_output_t * output)
+{
+  FILE               *vtufile = output->vtufile;
+  int                 freturn;
+
+  freturn = fprintf (vtufile, "  </UnstructuredGrid>\n");
+  if (freturn <= 0) {
+    return 0;
+  }
+  if (output->format != T8_VTK_FORMAT_ASCII) {
+    /* Write all binary data arrays. The raw data starts after the
+     * underscore and ends with the closing tag. */
+    freturn = fprintf (vtufile, "  <AppendedData encoding=\"raw\">\n   _");
+    if (freturn <= 0) {
+      return 0;
+    }
+    if (fwrite (output->appended.array, 1, output->appended.elem_count,
+                vtufile) != output->appended.elem_count) {
+      return 0;
+    }
+    freturn = fprintf (vtufile, "\n  </AppendedData>\n");
+    if (freturn <= 0) {
+      return 0;
+    }
+  }
+  freturn = fprintf (vtufile, "</VTKFile>\n");
+  return freturn > 0;
+}
+
+/* Write the piece of this process, that is its points and cells,
+ * to an open .vtu file.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_write_piece (t8_forest_t forest,
+                           t8_forest_vtk_output_t * output,
+                           int write_treeid,
+                           int write_mpirank,
+                           int write_level, int write_element_id,
+                           int write_ghosts,
+                           int num_data, t8_vtk_data_field_t * data)
+{
+  t8_locidx_t         num_elements, num_points;
+  int                 freturn;
+
+  /* The local number of elements */
+  num_elements = t8_forest_get_local_num_elements (forest);
+  if (write_ghosts) {
+    num_elements += t8_forest_get_num_ghosts (forest);
+  }
+  if (output->shared_vertices) {
+    /* The local number of distinct vertices */
+    if (output->point_ids == NULL) {
+      t8_forest_vtk_compute_shared_points (forest, write_ghosts, output);
+    }
+    num_points = output->num_points;
+  }
+  else {
+    /* The local number of points, counted with multiplicity */
+    num_points = t8_forest_num_points (forest, write_ghosts);
+  }
+
+  freturn = fprintf (output->vtufile,
+                     "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n",
+                     (long long) num_points, (long long) num_elements);
+  if (freturn <= 0) {
+    return 0;
+  }
+
+  /* write the point data */
+  if (!t8_forest_vtk_write_points
+      (forest, output, write_ghosts, num_data, data)) {
+    /* writings points was not succesful */
+    return 0;
+  }
+  /* write the cell data */
+  if (!t8_forest_vtk_write_cells
+      (forest, output, write_treeid, write_mpirank, write_level,
+       write_element_id, write_ghosts, num_data, data)) {
+    /* Writing cells was not successful */
+    return 0;
+  }
+
+  freturn = fprintf (output->vtufile, "    </Piece>\n");
+  return freturn > 0;
+}
+
+/* Check the ghost and format arguments of the vtk output functions.
+ * Switches off ghost output if there are no ghosts and compression if
+ * zlib is not available. */
+static void
+t8_forest_vtk_check_arguments (t8_forest_t forest, int *write_ghosts,
+                               t8_vtk_format_t * format)
+{
+  T8_ASSERT (forest != NULL);
+  T8_ASSERT (t8_forest_is_committed (forest));
+  if (*write_ghosts) {
+    t8_forest_ghost_ensure (forest);
+  }
+  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
+    /* Never write ghost elements if there aren't any */
+    *write_ghosts = 0;
+  }
+  T8_ASSERT (forest->ghosts != NULL || !*write_ghosts);
+
+#ifndef SC_HAVE_ZLIB
+  if (*format == T8_VTK_FORMAT_COMPRESSED) {
+    t8_global_errorf ("Warning: t8code is not linked against zlib. "
+                      "Writing uncompressed binary vtk output instead.\n");
+    *format = T8_VTK_FORMAT_BINARY;
+  }
+#endif
+}
+
 int
 t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
                           int write_treeid,
@@ -1310,23 +2222,35 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
                           int write_level, int write_element_id,
                           int write_ghosts,
                           int num_data, t8_vtk_data_field_t * data)
+{
+  return t8_forest_vtk_write_file_format (forest, fileprefix, write_treeid,
+                                          write_mpirank, write_level,
+                                          write_element_id, write_ghosts, 0,
+                                          num_data, data,
+                                          T8_VTK_FORMAT_ASCII);
+}
+
+int
+t8_forest_vtk_write_file_format (t8_forest_t forest, const char *fileprefix,
+                                 int write_treeid,
+                                 int write_mpirank,
+                                 int write_level, int write_element_id,
+                                 int write_ghosts, int shared_vertices,
+                                 int num_data, t8_vtk_data_field_t * data,
+                                 t8_vtk_format_t format)
 {
   FILE               *vtufile = NULL;
-  t8_locidx_t         num_elements, num_points;
+  t8_forest_vtk_output_t output;
   char                vtufilename[BUFSIZ];
   int                 freturn;
 
-  T8_ASSERT (forest != NULL);
-  T8_ASSERT (t8_forest_is_committed (forest));
   T8_ASSERT (fileprefix != NULL);
-  if (forest->ghosts == NULL || forest->ghosts->num_ghosts_elements == 0) {
-    /* Never write ghost elements if there aren't any */
-    write_ghosts = 0;
-  }
-  T8_ASSERT (forest->ghosts != NULL || !write_ghosts);
-
-  /* Currently we only support output in ascii format, not binary */
-  T8_ASSERT (T8_VTK_ASCII == 1);
+  T8_TRACE_BEGIN ("t8_forest_vtk_write");
+  t8_forest_vtk_check_arguments (forest, &write_ghosts, &format);
+  memset (&output, 0, sizeof (output));
+  output.format = format;
+  output.shared_vertices = shared_vertices;
+  sc_array_init (&output.appended, sizeof (char));
 
   /* process 0 creates the .pvtu file */
   if (forest->mpirank == 0) {
@@ -1338,14 +2262,6 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
     }
   }
 
-  /* The local number of elements */
-  num_elements = t8_forest_get_local_num_elements (forest);
-  if (write_ghosts) {
-    num_elements += t8_forest_get_num_ghosts (forest);
-  }
-  /* The local number of points, counted with multiplicity */
-  num_points = t8_forest_num_points (forest, write_ghosts);
-
   /* The filename for this processes file */
   freturn =
     snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix,
@@ -1355,61 +2271,30 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
     goto t8_forest_vtk_failure;
   }
 
-  /* Open the vtufile to write to */
-  vtufile = fopen (vtufilename, "w");
+  /* Open the vtufile to write to. We use binary mode, since the appended
+   * data section must not undergo newline conversion. */
+  vtufile = fopen (vtufilename, "wb");
   if (vtufile == NULL) {
     t8_errorf ("Error when opening file %s\n", vtufilename);
     goto t8_forest_vtk_failure;
   }
+  output.vtufile = vtufile;
   /* Write the header information in the .vtu file.
    * xml type, Unstructured grid and number of points and elements. */
-  freturn = fprintf (vtufile, "<?xml version=\"1.0\"?>\n");
-  if (freturn <= 0) {
+  if (!t8_forest_vtk_write_header (vtufile, format)) {
     goto t8_forest_vtk_failure;
   }
-  freturn =
-    fprintf (vtufile, "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-#ifdef SC_IS_BIGENDIAN
-  freturn = fprintf (vtufile, " byte_order=\"BigEndian\">\n");
-#else
-  freturn = fprintf (vtufile, " byte_order=\"LittleEndian\">\n");
-#endif
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-  freturn = fprintf (vtufile, "  <UnstructuredGrid>\n");
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-  freturn = fprintf (vtufile,
-                     "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n",
-                     (long long) num_points, (long long) num_elements);
-  if (freturn <= 0) {
-    goto t8_forest_vtk_failure;
-  }
-
-  /* write the point data */
-  if (!t8_forest_vtk_write_points
-      (forest, vtufile, write_ghosts, num_data, data)) {
-    /* writings points was not succesful */
-    goto t8_forest_vtk_failure;
-  }
-  /* write the cell data */
-  if (!t8_forest_vtk_write_cells
-      (forest, vtufile, write_treeid, write_mpirank, write_level,
+  if (!t8_forest_vtk_write_piece
+      (forest, &output, write_treeid, write_mpirank, write_level,
        write_element_id, write_ghosts, num_data, data)) {
-    /* Writing cells was not successful */
     goto t8_forest_vtk_failure;
   }
 
-  freturn = fprintf (vtufile, "    </Piece>\n"
-                     "  </UnstructuredGrid>\n" "</VTKFile>\n");
-  if (freturn <= 0) {
+  if (!t8_forest_vtk_write_footer (&output)) {
     goto t8_forest_vtk_failure;
   }
+  sc_array_reset (&output.appended);
+  t8_forest_vtk_free_shared_points (&output);
 
   freturn = fclose (vtufile);
   /* We set it not NULL, even if fclose was not successful, since then any
@@ -1422,13 +2307,890 @@ t8_forest_vtk_write_file (t8_forest_t forest, const char *fileprefix,
     goto t8_forest_vtk_failure;
   }
   /* Writing was successful */
+  T8_TRACE_END ("t8_forest_vtk_write");
   return 1;
 t8_forest_vtk_failure:
   if (vtufile != NULL) {
     fclose (vtufile);
   }
+  sc_array_reset (&output.appended);
+  t8_forest_vtk_free_shared_points (&output);
   t8_errorf ("Error when writing vtk file.\n");
+  T8_TRACE_END ("t8_forest_vtk_write");
   return 0;
 }
 
+/* A cell of the level of detail output. It is either a leaf element of the
+ * forest or the ancestor at the maximum output level of a range of
+ * consecutive leaf elements of the same tree. */
+typedef struct
+{
+  t8_locidx_t         ltreeid;  /* The local tree of the cell */
+  t8_locidx_t         first_element;    /* The index of the first leaf of the cell in its tree */
+  t8_locidx_t         num_elements;     /* The number of leaves of the cell */
+  t8_element_t       *element;  /* The element of the cell */
+  int                 is_ancestor;      /* True if element is owned by the cell */
+} t8_forest_vtk_lod_cell_t;
+
+/* Compute the output cells of the local trees for a maximum level.
+ * Leaves of a level larger than \a maxlevel are replaced by their ancestor
+ * at \a maxlevel. Since the leaves are sorted along the space filling curve,
+ * those with the same ancestor form a contiguous range.
+ * If \a maxlevel is negative, each leaf is its own cell. */
+static void
+t8_forest_vtk_lod_cells (t8_forest_t forest, int maxlevel, sc_array_t * cells)
+{
+  t8_locidx_t         itree, ielement;
+  t8_locidx_t         num_local_trees, elems_in_tree;
+  t8_element_t       *element, *ancestor;
+  t8_eclass_scheme_c *ts;
+  t8_forest_vtk_lod_cell_t *cell, *last_cell;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_local_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    elems_in_tree = t8_forest_get_tree_num_elements (forest, itree);
+    /* The last cell of this tree */
+    last_cell = NULL;
+    ancestor = NULL;
+    for (ielement = 0; ielement < elems_in_tree; ielement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      if (maxlevel < 0 || ts->t8_element_level (element) <= maxlevel) {
+        /* The leaf is written as it is */
+        last_cell = (t8_forest_vtk_lod_cell_t *) sc_array_push (cells);
+        last_cell->ltreeid = itree;
+        last_cell->first_element = ielement;
+        last_cell->num_elements = 1;
+        last_cell->element = element;
+        last_cell->is_ancestor = 0;
+        continue;
+      }
+      /* Compute the ancestor of the leaf at the maximum level */
+      if (ancestor == NULL) {
+        ts->t8_element_new (1, &ancestor);
+      }
+      ts->t8_element_copy (element, ancestor);
+      while (ts->t8_element_level (ancestor) > maxlevel) {
+        ts->t8_element_parent (ancestor, ancestor);
+      }
+      if (last_cell != NULL && last_cell->is_ancestor
+          && !ts->t8_element_compare (last_cell->element, ancestor)) {
+        /* The leaf belongs to the same ancestor as the previous one */
+        last_cell->num_elements++;
+        continue;
+      }
+      cell = (t8_forest_vtk_lod_cell_t *) sc_array_push (cells);
+      cell->ltreeid = itree;
+      cell->first_element = ielement;
+      cell->num_elements = 1;
+      cell->element = ancestor;
+      cell->is_ancestor = 1;
+      last_cell = cell;
+      /* The ancestor is owned by the cell now */
+      ancestor = NULL;
+    }
+    if (ancestor != NULL) {
+      ts->t8_element_destroy (1, &ancestor);
+    }
+  }
+}
+
+/* Free the ancestors of the level of detail cells and reset the array */
+static void
+t8_forest_vtk_lod_free_cells (t8_forest_t forest, sc_array_t * cells)
+{
+  t8_forest_vtk_lod_cell_t *cell;
+  t8_eclass_scheme_c *ts;
+  size_t              icell;
+
+  for (icell = 0; icell < cells->elem_count; icell++) {
+    cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+    if (cell->is_ancestor) {
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_get_tree_class (forest,
+                                                                  cell->ltreeid));
+      ts->t8_element_destroy (1, &cell->element);
+    }
+  }
+  sc_array_reset (cells);
+}
+
+/* Compute the value of a data field on a level of detail cell.
+ * It is the volume weighted average of the values of the leaves
+ * of the cell. If all leaves have zero volume, as for vertices,
+ * it is the arithmetic mean.
+ * \a value has 1 entry for scalar and 3 entries for vector fields. */
+static void
+t8_forest_vtk_lod_cell_value (t8_forest_t forest,
+                              const t8_forest_vtk_lod_cell_t * cell,
+                              const t8_vtk_data_field_t * field,
+                              double *value)
+{
+  const int           num_components = field->type == T8_VTK_SCALAR ? 1 : 3;
+  const t8_locidx_t   tree_offset =
+    t8_forest_get_tree_element_offset (forest, cell->ltreeid);
+  const double       *element_value;
+  double             *tree_vertices;
+  double              volume, total_volume = 0, sum[3] = { 0, 0, 0 };
+  t8_element_t       *element;
+  t8_locidx_t         ielement;
+  int                 i;
+
+  if (cell->num_elements == 1) {
+    /* A single leaf, its value is used as it is */
+    element_value =
+      field->data + num_components * (tree_offset + cell->first_element);
+    for (i = 0; i < num_components; i++) {
+      value[i] = element_value[i];
+    }
+    return;
+  }
+
+  tree_vertices = t8_forest_get_tree_vertices (forest, cell->ltreeid);
+  for (i = 0; i < num_components; i++) {
+    value[i] = 0;
+  }
+  for (ielement = cell->first_element;
+       ielement < cell->first_element + cell->num_elements; ielement++) {
+    element = t8_forest_get_element_in_tree (forest, cell->ltreeid, ielement);
+    volume = t8_forest_element_volume (forest, cell->ltreeid, element,
+                                       tree_vertices);
+    total_volume += volume;
+    element_value = field->data + num_components * (tree_offset + ielement);
+    for (i = 0; i < num_components; i++) {
+      value[i] += volume * element_value[i];
+      sum[i] += element_value[i];
+    }
+  }
+  for (i = 0; i < num_components; i++) {
+    value[i] = total_volume > 0 ? value[i] / total_volume
+      : sum[i] / cell->num_elements;
+  }
+}
+
+/* Write a data array of the level of detail output. The values are given
+ * as doubles and converted to \a datatype, which may be an integer or a
+ * floating point vtk type. In ascii format a line is broken after
+ * \a max_columns values.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_lod_write_array (t8_forest_vtk_output_t * output,
+                               const char *dataname, const char *datatype,
+                               const char *component_string,
+                               int max_columns, sc_array_t * values)
+{
+  const int           is_float = datatype[0] == 'F';
+  const int           is_double = !strcmp (datatype, "Float64");
+  FILE               *vtufile = output->vtufile;
+  sc_array_t          binary_values;
+  double              value;
+  size_t              ivalue;
+  int                 freturn;
+
+  T8_ASSERT (values->elem_size == sizeof (double));
+  if (output->format != T8_VTK_FORMAT_ASCII) {
+    if (!t8_forest_vtk_write_binary_header (output, dataname, datatype,
+                                            component_string)) {
+      return 0;
+    }
+    sc_array_init (&binary_values, t8_forest_vtk_type_size (datatype));
+    for (ivalue = 0; ivalue < values->elem_count; ivalue++) {
+      value = *(double *) sc_array_index (values, ivalue);
+      if (is_float) {
+        t8_forest_vtk_push_float (&binary_values, value);
+      }
+      else {
+        t8_forest_vtk_push_int (&binary_values, (long long) value);
+      }
+    }
+    freturn = t8_forest_vtk_append_array (output, &binary_values);
+    sc_array_reset (&binary_values);
+    return freturn;
+  }
+
+  freturn = fprintf (vtufile, "        <DataArray type=\"%s\" "
+                     "Name=\"%s\" %s format=\"ascii\">\n         ",
+                     datatype, dataname, component_string);
+  if (freturn <= 0) {
+    return 0;
+  }
+  for (ivalue = 0; ivalue < values->elem_count; ivalue++) {
+    value = *(double *) sc_array_index (values, ivalue);
+    if (is_double) {
+      freturn = fprintf (vtufile, " %24.16e", value);
+    }
+    else if (is_float) {
+      freturn = fprintf (vtufile, " %16.8e", value);
+    }
+    else {
+      freturn = fprintf (vtufile, " %lld", (long long) value);
+    }
+    if (freturn <= 0) {
+      return 0;
+    }
+    /* After max_columns we break the line */
+    if (!((ivalue + 1) % max_columns)) {
+      freturn = fprintf (vtufile, "\n         ");
+      if (freturn <= 0) {
+        return 0;
+      }
+    }
+  }
+  freturn = fprintf (vtufile, "\n        </DataArray>\n");
+  return freturn > 0;
+}
+
+/* Write the level of detail cells of this process as the piece of
+ * an open .vtu file. Floating point data is written with type
+ * \a float_name.
+ * Returns true on success and zero otherwise. */
+static int
+t8_forest_vtk_lod_write_piece (t8_forest_t forest,
+                               t8_forest_vtk_output_t * output,
+                               sc_array_t * cells, int write_treeid,
+                               int write_mpirank, int write_level,
+                               int num_data, t8_vtk_data_field_t * data,
+                               const char *float_name)
+{
+  const size_t        num_cells = cells->elem_count;
+  FILE               *vtufile = output->vtufile;
+  t8_forest_vtk_lod_cell_t *cell;
+  t8_eclass_scheme_c *ts;
+  t8_element_shape_t  shape;
+  sc_array_t          coordinates, connectivity, offsets, types;
+  sc_array_t          values;
+  double             *tree_vertices, cell_value[3];
+  char                description[BUFSIZ];
+  t8_locidx_t         num_points = 0;
+  size_t              icell;
+  int                 ivertex, num_vertices, num_components;
+  int                 idata, i;
+  int                 success = 0;
+
+  sc_array_init (&coordinates, sizeof (double));
+  sc_array_init (&connectivity, sizeof (double));
+  sc_array_init (&offsets, sizeof (double));
+  sc_array_init (&types, sizeof (double));
+  sc_array_init (&values, sizeof (double));
+
+  /* Compute the points and the connectivity of the cells. Each cell
+   * has its own points. */
+  for (icell = 0; icell < num_cells; icell++) {
+    cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                cell->ltreeid));
+    tree_vertices = t8_forest_get_tree_vertices (forest, cell->ltreeid);
+    shape = ts->t8_element_shape (cell->element);
+    num_vertices = t8_eclass_num_vertices[shape];
+    for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+      t8_forest_element_coordinate (forest, cell->ltreeid, cell->element,
+                                    tree_vertices,
+                                    t8_eclass_vtk_corner_number[shape]
+                                    [ivertex],
+                                    (double *) sc_array_push_count
+                                    (&coordinates, 3));
+      *(double *) sc_array_push (&connectivity) = num_points++;
+    }
+    *(double *) sc_array_push (&offsets) = num_points;
+    *(double *) sc_array_push (&types) = t8_eclass_vtk_type[shape];
+  }
+
+  if (fprintf (vtufile,
+               "    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n",
+               (long long) num_points, (long long) num_cells) <= 0
+      || fprintf (vtufile, "      <Points>\n") <= 0
+      || !t8_forest_vtk_lod_write_array (output, "Position", float_name,
+                                         "NumberOfComponents=\"3\"", 3,
+                                         &coordinates)
+      || fprintf (vtufile, "      </Points>\n") <= 0) {
+    goto t8_forest_vtk_lod_cleanup;
+  }
+
+  /* Write the data fields at the points of each cell */
+  if (num_data > 0) {
+    if (fprintf (vtufile, "      <PointData>\n") <= 0) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+    for (idata = 0; idata < num_data; idata++) {
+      num_components = data[idata].type == T8_VTK_SCALAR ? 1 : 3;
+      sc_array_truncate (&values);
+      for (icell = 0; icell < num_cells; icell++) {
+        cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+        ts = t8_forest_get_eclass_scheme (forest,
+                                          t8_forest_get_tree_class (forest,
+                                                                    cell->ltreeid));
+        t8_forest_vtk_lod_cell_value (forest, cell, data + idata, cell_value);
+        num_vertices =
+          t8_eclass_num_vertices[ts->t8_element_shape (cell->element)];
+        for (ivertex = 0; ivertex < num_vertices; ivertex++) {
+          for (i = 0; i < num_components; i++) {
+            *(double *) sc_array_push (&values) = cell_value[i];
+          }
+        }
+      }
+      snprintf (description, BUFSIZ, "%s_%s", data[idata].description,
+                "points");
+      if (!t8_forest_vtk_lod_write_array (output, description, float_name,
+                                          num_components == 1 ? "" :
+                                          "NumberOfComponents=\"3\"",
+                                          8 * num_components, &values)) {
+        goto t8_forest_vtk_lod_cleanup;
+      }
+    }
+    if (fprintf (vtufile, "      </PointData>\n") <= 0) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+  }
+
+  if (fprintf (vtufile, "      <Cells>\n") <= 0
+      || !t8_forest_vtk_lod_write_array (output, "connectivity",
+                                         T8_VTK_LOCIDX, "", 8, &connectivity)
+      || !t8_forest_vtk_lod_write_array (output, "offsets", T8_VTK_LOCIDX,
+                                         "", 8, &offsets)
+      || !t8_forest_vtk_lod_write_array (output, "types", "Int32", "", 8,
+                                         &types)
+      || fprintf (vtufile, "      </Cells>\n") <= 0
+      || fprintf (vtufile, "      <CellData Scalars =\"%s\">\n",
+                  "treeid,mpirank,level") <= 0) {
+    goto t8_forest_vtk_lod_cleanup;
+  }
+  if (write_treeid) {
+    sc_array_truncate (&values);
+    for (icell = 0; icell < num_cells; icell++) {
+      cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+      *(double *) sc_array_push (&values) =
+        t8_forest_global_tree_id (forest, cell->ltreeid);
+    }
+    if (!t8_forest_vtk_lod_write_array (output, "treeid", T8_VTK_GLOIDX, "",
+                                        8, &values)) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+  }
+  if (write_mpirank) {
+    sc_array_truncate (&values);
+    for (icell = 0; icell < num_cells; icell++) {
+      *(double *) sc_array_push (&values) = forest->mpirank;
+    }
+    if (!t8_forest_vtk_lod_write_array (output, "mpirank", "Int32", "", 8,
+                                        &values)) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+  }
+  if (write_level) {
+    sc_array_truncate (&values);
+    for (icell = 0; icell < num_cells; icell++) {
+      cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_get_tree_class (forest,
+                                                                  cell->ltreeid));
+      *(double *) sc_array_push (&values) =
+        ts->t8_element_level (cell->element);
+    }
+    if (!t8_forest_vtk_lod_write_array (output, "level", "Int32", "", 8,
+                                        &values)) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+  }
+  /* Write the user defined data fields per cell */
+  for (idata = 0; idata < num_data; idata++) {
+    num_components = data[idata].type == T8_VTK_SCALAR ? 1 : 3;
+    sc_array_truncate (&values);
+    for (icell = 0; icell < num_cells; icell++) {
+      cell = (t8_forest_vtk_lod_cell_t *) sc_array_index (cells, icell);
+      t8_forest_vtk_lod_cell_value (forest, cell, data + idata, cell_value);
+      memcpy (sc_array_push_count (&values, num_components), cell_value,
+              num_components * sizeof (double));
+    }
+    if (!t8_forest_vtk_lod_write_array (output, data[idata].description,
+                                        float_name,
+                                        num_components == 1 ? "" :
+                                        "NumberOfComponents=\"3\"",
+                                        8 * num_components, &values)) {
+      goto t8_forest_vtk_lod_cleanup;
+    }
+  }
+  if (fprintf (vtufile, "      </CellData>\n") <= 0
+      || fprintf (vtufile, "    </Piece>\n") <= 0) {
+    goto t8_forest_vtk_lod_cleanup;
+  }
+  success = 1;
+
+t8_forest_vtk_lod_cleanup:
+  sc_array_reset (&coordinates);
+  sc_array_reset (&connectivity);
+  sc_array_reset (&offsets);
+  sc_array_reset (&types);
+  sc_array_reset (&values);
+  return success;
+}
+
+int
+t8_forest_vtk_write_file_lod (t8_forest_t forest, const char *fileprefix,
+                              int write_treeid, int write_mpirank,
+                              int write_level, int num_data,
+                              t8_vtk_data_field_t * data,
+                              t8_vtk_format_t format, int use_float32,
+                              int maxlevel)
+{
+  const char         *float_name = use_float32 ? "Float32" : "Float64";
+  FILE               *vtufile = NULL;
+  t8_forest_vtk_output_t output;
+  sc_array_t          cells;
+  char                vtufilename[BUFSIZ];
+  int                 write_ghosts = 0;
+  int                 freturn;
+
+  T8_ASSERT (fileprefix != NULL);
+  t8_forest_vtk_check_arguments (forest, &write_ghosts, &format);
+  memset (&output, 0, sizeof (output));
+  output.format = format;
+  sc_array_init (&output.appended, sizeof (char));
+  sc_array_init (&cells, sizeof (t8_forest_vtk_lod_cell_t));
+
+  /* process 0 creates the .pvtu file */
+  if (forest->mpirank == 0) {
+    if (t8_write_pvtu_precision
+        (fileprefix, forest->mpisize, write_treeid, write_mpirank,
+         write_level, 0, num_data, data, float_name)) {
+      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+      goto t8_forest_vtk_lod_failure;
+    }
+  }
+
+  /* The filename for this processes file */
+  freturn =
+    snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix,
+              forest->mpirank);
+  if (freturn >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    goto t8_forest_vtk_lod_failure;
+  }
+  vtufile = fopen (vtufilename, "wb");
+  if (vtufile == NULL) {
+    t8_errorf ("Error when opening file %s\n", vtufilename);
+    goto t8_forest_vtk_lod_failure;
+  }
+  output.vtufile = vtufile;
+
+  /* Compute the output cells and write them */
+  t8_forest_vtk_lod_cells (forest, maxlevel, &cells);
+  if (!t8_forest_vtk_write_header (vtufile, format)
+      || !t8_forest_vtk_lod_write_piece (forest, &output, &cells,
+                                         write_treeid, write_mpirank,
+                                         write_level, num_data, data,
+                                         float_name)
+      || !t8_forest_vtk_write_footer (&output)) {
+    goto t8_forest_vtk_lod_failure;
+  }
+  t8_forest_vtk_lod_free_cells (forest, &cells);
+  sc_array_reset (&output.appended);
+
+  freturn = fclose (vtufile);
+  vtufile = NULL;
+  if (freturn != 0) {
+    t8_global_errorf ("Error when closing file %s\n", vtufilename);
+    goto t8_forest_vtk_lod_failure;
+  }
+  return 1;
+t8_forest_vtk_lod_failure:
+  if (vtufile != NULL) {
+    fclose (vtufile);
+  }
+  t8_forest_vtk_lod_free_cells (forest, &cells);
+  sc_array_reset (&output.appended);
+  t8_errorf ("Error when writing vtk file.\n");
+  return 0;
+}
+
+/* Append the contents of a temporary file to a char array.
+ * Returns true on success. */
+static int
+t8_forest_vtk_append_tmpfile (sc_array_t * buffer, FILE * tmp)
+{
+  long                size;
+  char               *dest;
+
+  size = ftell (tmp);
+  if (size < 0 || fseek (tmp, 0, SEEK_SET)) {
+    return 0;
+  }
+  dest = (char *) sc_array_push_count (buffer, size);
+  return fread (dest, 1, size, tmp) == (size_t) size;
+}
+
+#ifdef T8_ENABLE_MPIIO
+/* The maximum number of bytes that one process writes with one
+ * collective MPI I/O call. */
+#define T8_VTK_MPIIO_MAX_BYTES (1 << 30)
+
+/* Collectively write a buffer at a given offset of a file.
+ * The buffer may be larger than what fits into one MPI call, thus the
+ * processes write it in rounds of at most T8_VTK_MPIIO_MAX_BYTES bytes. */
+static void
+t8_forest_vtk_write_at_all (MPI_File file, long long offset,
+                            const char *buffer, long long size,
+                            sc_MPI_Comm comm)
+{
+  long long           num_rounds, max_rounds, iround, count;
+  MPI_Status          status;
+  int                 mpiret;
+
+  num_rounds =
+    (size + T8_VTK_MPIIO_MAX_BYTES - 1) / T8_VTK_MPIIO_MAX_BYTES;
+  mpiret = sc_MPI_Allreduce (&num_rounds, &max_rounds, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, comm);
+  SC_CHECK_MPI (mpiret);
+  for (iround = 0; iround < max_rounds; iround++) {
+    /* Processes that are done participate with zero bytes */
+    count = SC_MAX (0, SC_MIN (size - iround * T8_VTK_MPIIO_MAX_BYTES,
+                               (long long) T8_VTK_MPIIO_MAX_BYTES));
+    mpiret = MPI_File_write_at_all (file, (MPI_Offset) offset
+                                    + iround * T8_VTK_MPIIO_MAX_BYTES,
+                                    (void *) (count > 0 ? buffer + iround *
+                                              T8_VTK_MPIIO_MAX_BYTES :
+                                              buffer), (int) count,
+                                    MPI_BYTE, &status);
+    SC_CHECK_MPI (mpiret);
+  }
+}
+#endif
+
+int
+t8_forest_vtk_write_file_mpiio (t8_forest_t forest, const char *fileprefix,
+                                int write_treeid,
+                                int write_mpirank,
+                                int write_level, int write_element_id,
+                                int write_ghosts, int shared_vertices,
+                                int num_data, t8_vtk_data_field_t * data,
+                                t8_vtk_format_t format, int num_files)
+{
+#ifdef T8_ENABLE_MPIIO
+  t8_forest_vtk_output_t output;
+  sc_array_t          xml, array_offsets;
+  sc_MPI_Comm         group_comm;
+  MPI_File            file;
+  FILE               *tmp = NULL;
+  char                vtufilename[BUFSIZ];
+  long long           local_sizes[2], offsets[2], xml_total;
+  int                 group, group_rank, group_size;
+  int                 freturn, success, mpiret;
+
+  T8_ASSERT (fileprefix != NULL);
+  T8_ASSERT (num_files > 0);
+  T8_TRACE_BEGIN ("t8_forest_vtk_write");
+  t8_forest_vtk_check_arguments (forest, &write_ghosts, &format);
+  num_files = SC_MIN (num_files, forest->mpisize);
+  memset (&output, 0, sizeof (output));
+  output.format = format;
+  output.shared_vertices = shared_vertices;
+  sc_array_init (&output.appended, sizeof (char));
+  sc_array_init (&xml, sizeof (char));
+  sc_array_init (&array_offsets, sizeof (size_t));
+  success = 1;
+
+  /* process 0 creates the .pvtu file that links to the aggregated files */
+  if (forest->mpirank == 0) {
+    if (t8_write_pvtu
+        (fileprefix, num_files, write_treeid, write_mpirank,
+         write_level, write_element_id, num_data, data)) {
+      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+      success = 0;
+    }
+  }
+
+  /* The processes are split into num_files contiguous groups,
+   * each group writes one file. */
+  group = (int) (((long long) forest->mpirank * num_files) / forest->mpisize);
+  mpiret = sc_MPI_Comm_split (forest->mpicomm, group, forest->mpirank,
+                              &group_comm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (group_comm, &group_rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (group_comm, &group_size);
+  SC_CHECK_MPI (mpiret);
+
+  /* Each process writes its piece into a temporary file first.
+   * The offsets of binary arrays refer to the start of the appended data
+   * of all processes in the group, which is only known after the binary
+   * data of all processes has been computed. Thus, in binary format we
+   * compute the data arrays and record their local offsets, discarding
+   * this first description of the piece. We then write the description
+   * again from the recorded offsets, shifted by the data of the
+   * processes before us. */
+  if (format != T8_VTK_FORMAT_ASCII) {
+    output.array_offsets = &array_offsets;
+    tmp = tmpfile ();
+    output.vtufile = tmp;
+    success = success && tmp != NULL
+      && t8_forest_vtk_write_piece (forest, &output, write_treeid,
+                                    write_mpirank, write_level,
+                                    write_element_id, write_ghosts,
+                                    num_data, data);
+    if (tmp != NULL) {
+      fclose (tmp);
+    }
+  }
+  /* The offset of our data in the appended data section */
+  local_sizes[1] = output.appended.elem_count;
+  offsets[1] = 0;
+  mpiret = sc_MPI_Exscan (&local_sizes[1], &offsets[1], 1,
+                          sc_MPI_LONG_LONG_INT, sc_MPI_SUM, group_comm);
+  SC_CHECK_MPI (mpiret);
+  if (group_rank == 0) {
+    /* The result of Exscan is undefined on the first process */
+    offsets[1] = 0;
+  }
+  output.base_offset = offsets[1];
+  output.replay = format != T8_VTK_FORMAT_ASCII;
+
+  /* Write the description of our piece, with the file header on the first
+   * and the closing tags on the last process of the group. */
+  tmp = tmpfile ();
+  output.vtufile = tmp;
+  if (tmp != NULL) {
+    if (group_rank == 0) {
+      success = success && t8_forest_vtk_write_header (tmp, format);
+    }
+    success = success
+      && t8_forest_vtk_write_piece (forest, &output, write_treeid,
+                                    write_mpirank, write_level,
+                                    write_element_id, write_ghosts,
+                                    num_data, data);
+    if (group_rank == group_size - 1) {
+      freturn = fprintf (tmp, "  </UnstructuredGrid>\n%s",
+                         format != T8_VTK_FORMAT_ASCII ?
+                         "  <AppendedData encoding=\"raw\">\n   _" :
+                         "</VTKFile>\n");
+      success = success && freturn > 0;
+    }
+    success = success && t8_forest_vtk_append_tmpfile (&xml, tmp);
+    fclose (tmp);
+  }
+  else {
+    success = 0;
+  }
+  if (format != T8_VTK_FORMAT_ASCII && group_rank == group_size - 1) {
+    const char          footer[] = "\n  </AppendedData>\n</VTKFile>\n";
+
+    memcpy (sc_array_push_count (&output.appended, strlen (footer)), footer,
+            strlen (footer));
+  }
+
+  /* The xml descriptions come first in the file, in the order of the
+   * processes, followed by the appended data of all processes. */
+  local_sizes[0] = xml.elem_count;
+  local_sizes[1] = output.appended.elem_count;
+  mpiret = sc_MPI_Exscan (local_sizes, offsets, 2, sc_MPI_LONG_LONG_INT,
+                          sc_MPI_SUM, group_comm);
+  SC_CHECK_MPI (mpiret);
+  if (group_rank == 0) {
+    offsets[0] = offsets[1] = 0;
+  }
+  mpiret = sc_MPI_Allreduce (&local_sizes[0], &xml_total, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM, group_comm);
+  SC_CHECK_MPI (mpiret);
+
+  /* Open the file of our group and write to it */
+  freturn = snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, group);
+  if (freturn >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    success = 0;
+  }
+  mpiret = MPI_File_open (group_comm, vtufilename,
+                          MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL,
+                          &file);
+  SC_CHECK_MPI (mpiret);
+  /* Truncate the file if it existed before */
+  mpiret = MPI_File_set_size (file, 0);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_vtk_write_at_all (file, offsets[0], xml.array, xml.elem_count,
+                              group_comm);
+  t8_forest_vtk_write_at_all (file, xml_total + offsets[1],
+                              output.appended.array,
+                              output.appended.elem_count, group_comm);
+  mpiret = MPI_File_close (&file);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_free (&group_comm);
+  SC_CHECK_MPI (mpiret);
+
+  sc_array_reset (&output.appended);
+  sc_array_reset (&xml);
+  sc_array_reset (&array_offsets);
+  t8_forest_vtk_free_shared_points (&output);
+  if (!success) {
+    t8_errorf ("Error when writing vtk file.\n");
+  }
+  T8_TRACE_END ("t8_forest_vtk_write");
+  return success;
+#else
+  t8_global_errorf
+    ("Warning: t8code is not configured with MPI I/O. Writing one vtk file"
+     " per process instead.\n");
+  return t8_forest_vtk_write_file_format (forest, fileprefix, write_treeid,
+                                          write_mpirank, write_level,
+                                          write_element_id, write_ghosts,
+                                          shared_vertices, num_data, data,
+                                          format);
+#endif
+}
+
+/* A .vtu file of one process that is staged in memory and written
+ * to disk in the background. */
+struct t8_forest_vtk_async
+{
+  char                vtufilename[BUFSIZ];      /* The file to write */
+  sc_array_t          xml;      /* The xml description of the piece */
+  sc_array_t          appended; /* The appended data and the closing tags */
+  int                 success;  /* True as long as no error occurred */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_t           thread;   /* The thread that writes the file */
+  int                 thread_started;   /* True if thread was created */
+#endif
+};
+
+/* Write a staged .vtu file to disk. This function is run by the background
+ * thread, thus it must not call any libsc functions, since they are not
+ * thread safe. */
+static void        *
+t8_forest_vtk_async_write (void *arg)
+{
+  t8_forest_vtk_async_t async = (t8_forest_vtk_async_t) arg;
+  FILE               *vtufile;
+
+  vtufile = fopen (async->vtufilename, "wb");
+  if (vtufile == NULL) {
+    async->success = 0;
+    return NULL;
+  }
+  if (fwrite (async->xml.array, 1, async->xml.elem_count, vtufile)
+      != async->xml.elem_count
+      || fwrite (async->appended.array, 1, async->appended.elem_count,
+                 vtufile) != async->appended.elem_count) {
+    async->success = 0;
+  }
+  if (fclose (vtufile) != 0) {
+    async->success = 0;
+  }
+  return NULL;
+}
+
+t8_forest_vtk_async_t
+t8_forest_vtk_write_file_async (t8_forest_t forest, const char *fileprefix,
+                                int write_treeid,
+                                int write_mpirank,
+                                int write_level, int write_element_id,
+                                int write_ghosts, int shared_vertices,
+                                int num_data, t8_vtk_data_field_t * data,
+                                t8_vtk_format_t format)
+{
+  t8_forest_vtk_async_t async;
+  t8_forest_vtk_output_t output;
+  FILE               *tmp;
+  int                 freturn;
+
+  T8_ASSERT (fileprefix != NULL);
+  t8_forest_vtk_check_arguments (forest, &write_ghosts, &format);
+  async = T8_ALLOC_ZERO (struct t8_forest_vtk_async, 1);
+  sc_array_init (&async->xml, sizeof (char));
+  sc_array_init (&async->appended, sizeof (char));
+  async->success = 1;
+
+  /* process 0 creates the .pvtu file, it is small enough to be written
+   * right away */
+  if (forest->mpirank == 0) {
+    if (t8_write_pvtu
+        (fileprefix, forest->mpisize, write_treeid, write_mpirank,
+         write_level, write_element_id, num_data, data)) {
+      t8_errorf ("Error when writing file %s.pvtu\n", fileprefix);
+      async->success = 0;
+    }
+  }
+  freturn = snprintf (async->vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix,
+                      forest->mpirank);
+  if (freturn >= BUFSIZ) {
+    t8_errorf ("Error when writing vtu file. Filename too long.\n");
+    async->success = 0;
+    return async;
+  }
+
+  /* Take a snapshot of the forest's output. The xml description is
+   * staged through a temporary file, the binary data is collected in
+   * memory. After this, the forest is not needed anymore. */
+  memset (&output, 0, sizeof (output));
+  output.format = format;
+  output.shared_vertices = shared_vertices;
+  sc_array_init (&output.appended, sizeof (char));
+  tmp = tmpfile ();
+  output.vtufile = tmp;
+  if (tmp == NULL
+      || !t8_forest_vtk_write_header (tmp, format)
+      || !t8_forest_vtk_write_piece (forest, &output, write_treeid,
+                                     write_mpirank, write_level,
+                                     write_element_id, write_ghosts,
+                                     num_data, data)
+      || fprintf (tmp, "  </UnstructuredGrid>\n%s",
+                  format != T8_VTK_FORMAT_ASCII ?
+                  "  <AppendedData encoding=\"raw\">\n   _" :
+                  "</VTKFile>\n") <= 0
+      || !t8_forest_vtk_append_tmpfile (&async->xml, tmp)) {
+    t8_errorf ("Error when staging vtk file %s.\n", async->vtufilename);
+    async->success = 0;
+  }
+  if (tmp != NULL) {
+    fclose (tmp);
+  }
+  t8_forest_vtk_free_shared_points (&output);
+  /* We take over the appended data of the output */
+  async->appended = output.appended;
+  if (format != T8_VTK_FORMAT_ASCII) {
+    const char          footer[] = "\n  </AppendedData>\n</VTKFile>\n";
+
+    memcpy (sc_array_push_count (&async->appended, strlen (footer)), footer,
+            strlen (footer));
+  }
+  if (!async->success) {
+    return async;
+  }
+
+#ifdef SC_ENABLE_PTHREAD
+  /* Write the file in the background */
+  if (pthread_create (&async->thread, NULL, t8_forest_vtk_async_write,
+                      async) == 0) {
+    async->thread_started = 1;
+    return async;
+  }
+  t8_debugf ("Could not create vtk output thread, writing synchronously.\n");
+#endif
+  t8_forest_vtk_async_write (async);
+  return async;
+}
+
+int
+t8_forest_vtk_async_wait (t8_forest_vtk_async_t * pasync)
+{
+  t8_forest_vtk_async_t async;
+  int                 success;
+
+  T8_ASSERT (pasync != NULL && *pasync != NULL);
+  async = *pasync;
+#ifdef SC_ENABLE_PTHREAD
+  if (async->thread_started) {
+    SC_CHECK_ABORT (pthread_join (async->thread, NULL) == 0,
+                    "Could not join vtk output thread");
+  }
+#endif
+  success = async->success;
+  if (!success) {
+    t8_errorf ("Error when writing vtk file %s.\n", async->vtufilename);
+  }
+  sc_array_reset (&async->xml);
+  sc_array_reset (&async->appended);
+  T8_FREE (async);
+  *pasync = NULL;
+  return success;
+}
+
 T8_EXTERN_C_END ();
@@ -0,0 +1,118 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_conduit.h
+ * Describe the local leaves of a forest as a Conduit Mesh Blueprint for
+ * in-situ visualization with ParaView Catalyst or Ascent, without writing
+ * files. The mesh arrays are computed once into a \ref t8_forest_conduit_mesh_t
+ * and the Conduit node only references them and the user data fields.
+ * t8code must be configured with "--with-conduit" in order to publish the
+ * mesh to a Conduit node. The mesh arrays can be computed in any case.
+ */
+
+#ifndef T8_FOREST_CONDUIT_H
+#define T8_FOREST_CONDUIT_H
+
+#include <t8_vtk.h>
+#include <t8_forest.h>
+
+/** The element and point arrays of the local leaves of a forest in the
+ * layout of an unstructured Mesh Blueprint topology.
+ * Corners are not shared between elements, they are numbered element by
+ * element in vtk order.
+ */
+typedef struct
+{
+  t8_forest_t         forest;           /**< The forest, we hold a reference to it. */
+  t8_locidx_t         num_elements;     /**< The number of local elements. */
+  t8_locidx_t         num_points;       /**< The number of element corners. */
+  double             *coordinates;      /**< For each corner its x, y and z coordinate. */
+  int64_t            *connectivity;     /**< The corners of all elements, that is 0, 1, ... \a num_points - 1. */
+  int64_t            *offsets;          /**< For each element the index of its first corner in \a connectivity. */
+  int32_t            *sizes;            /**< For each element its number of corners. */
+  int32_t            *shapes;           /**< For each element the vtk cell type, which is
+                                             also used as id in the Blueprint shape map. */
+  int                 single_shape;     /**< If non-negative, the shape of all local elements. */
+  int64_t            *treeids;          /**< If not NULL, for each element its global tree id. */
+  int64_t            *element_ids;      /**< If not NULL, for each element its global index. */
+  int32_t            *mpiranks;         /**< If not NULL, for each element the rank of this process. */
+  int32_t            *levels;           /**< If not NULL, for each element its refinement level. */
+  int                 num_data;         /**< The number of user data fields. */
+  t8_vtk_data_field_t *data;            /**< The user data fields, they are not copied. */
+} t8_forest_conduit_mesh_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the mesh arrays of the local leaves of a forest.
+ * The coordinates of the corners are computed from the geometry of the
+ * forest as in \ref t8_forest_element_coordinate.
+ * This function is not collective.
+ * \param [out] mesh      The mesh arrays are allocated and computed.
+ *                        Free them with \ref t8_forest_conduit_mesh_reset.
+ * \param [in]  forest    A committed forest. We take a reference to it.
+ * \param [in]  write_treeid If true, the global tree id of each element is stored.
+ * \param [in]  write_mpirank If true, the mpirank of each element is stored.
+ * \param [in]  write_level If true, the refinement level of each element is stored.
+ * \param [in]  write_element_id If true, the global index of each element is stored.
+ * \param [in]  num_data  Number of user defined double valued data fields.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data.
+ *                        The array and the data of the fields must stay
+ *                        valid as long as \a mesh is published.
+ */
+void                t8_forest_conduit_mesh_init (t8_forest_conduit_mesh_t *
+                                                 mesh, t8_forest_t forest,
+                                                 int write_treeid,
+                                                 int write_mpirank,
+                                                 int write_level,
+                                                 int write_element_id,
+                                                 int num_data,
+                                                 t8_vtk_data_field_t * data);
+
+/** Free the mesh arrays and release the reference to the forest.
+ * \param [in,out] mesh   Mesh arrays computed by \ref t8_forest_conduit_mesh_init.
+ */
+void                t8_forest_conduit_mesh_reset (t8_forest_conduit_mesh_t *
+                                                  mesh);
+
+/** Describe the mesh arrays as a Conduit Mesh Blueprint.
+ * Below \a node the coordset "coords", the topology \a name and one field
+ * per stored element array and user data field are created. If the forest
+ * has a geometry cache, the cached centroids and volumes of the elements
+ * are added as fields "centroid" and "volume". All arrays are
+ * set as external, that is the node points to the memory of \a mesh and of
+ * the user data fields without copying. The node can then be passed to
+ * catalyst_execute or ascent_publish.
+ * \param [in]  mesh      Mesh arrays computed by \ref t8_forest_conduit_mesh_init.
+ * \param [in,out] node   A conduit_node pointer, for Catalyst usually the
+ *                        "catalyst/channels/<channel>/data" node.
+ * \param [in]  name      The name of the topology.
+ * \return  True if successful, false if t8code is not linked against Conduit
+ *          or, in debug mode, if the node does not verify as a Blueprint mesh.
+ */
+int                 t8_forest_conduit_publish (const t8_forest_conduit_mesh_t
+                                               * mesh, void *node,
+                                               const char *name);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_CONDUIT_H */
@@ -0,0 +1,134 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_hdf5.h
+ * Write a forest together with per element data to a single HDF5 file
+ * and an XDMF descriptor that can be opened with ParaView or VisIt.
+ * t8code must be configured with "--with-hdf5" in order to use this.
+ * For output on more than one process, the hdf5 library must support
+ * parallel MPI I/O.
+ */
+
+#ifndef T8_FOREST_HDF5_H
+#define T8_FOREST_HDF5_H
+
+#include <t8_vtk.h>
+#include <t8_forest.h>
+
+/** The maximum number of rows of a chunk in the HDF5 datasets. */
+#define T8_FOREST_HDF5_CHUNK_SIZE 65536
+
+/** Opaque handle of a time series output.
+ * \see t8_forest_hdf5_series_new */
+typedef struct t8_forest_hdf5_series *t8_forest_hdf5_series_t;
+
+T8_EXTERN_C_BEGIN ();
+
+/** Write the forest to the HDF5 file \a fileprefix.h5 and an XDMF
+ * descriptor \a fileprefix.xmf that references it.
+ * All processes write their part of each dataset collectively into the
+ * same file. The datasets are chunked and, if the hdf5 library provides
+ * the deflate filter, compressed.
+ * The file contains the datasets
+ *  - /coordinates  The corner coordinates of all elements, one row of
+ *                  3 doubles per corner. Corners are not shared between
+ *                  elements.
+ *  - /topology     The XDMF mixed topology array of all elements.
+ *  - /eclass       The eclass of the tree of each element.
+ *  - /treeid, /rank, /level  If requested, see below.
+ *  - One dataset per user data field, named after its description.
+ * This function is collective and must be called on all processes of
+ * the forest's communicator.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data.
+ *                        The descriptions must be unique valid HDF5 names.
+ * \return  True if succesful, false if not.
+ */
+int                 t8_forest_write_hdf5 (t8_forest_t forest,
+                                          const char *fileprefix,
+                                          int write_treeid,
+                                          int write_mpirank,
+                                          int write_level,
+                                          int num_data,
+                                          t8_vtk_data_field_t * data);
+
+/** Start a time series output of forests.
+ * Each call to \ref t8_forest_hdf5_series_write writes one step to the
+ * HDF5 file \a fileprefix_NNNN.h5, where NNNN is the number of the step,
+ * and adds it to the temporal collection of the XDMF descriptor
+ * \a fileprefix.xmf. The mesh datasets are only written for steps whose
+ * forest differs from that of the last step with a mesh. Other steps only
+ * contain the mpirank and the user data and reference the mesh of that
+ * step. Thus, steps in which only the data changes are much smaller.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \return              The time series, which must be destroyed with
+ *                      \ref t8_forest_hdf5_series_destroy.
+ */
+t8_forest_hdf5_series_t t8_forest_hdf5_series_new (const char *fileprefix);
+
+/** Write one step of a time series.
+ * Whether the forest changed is decided with \ref t8_forest_get_hash,
+ * thus a step reuses the mesh of a previous step if its forest has the
+ * same elements, even if it was adapted or repartitioned in between.
+ * The datasets are the same as in \ref t8_forest_write_hdf5.
+ * This function is collective and must be called on all processes of
+ * the forest's communicator, which must not change during the series.
+ * \param [in,out] series The time series.
+ * \param [in]  forest    The forest. Must not be compressed.
+ * \param [in]  time      The simulation time of this step.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data.
+ *                        The descriptions must be unique valid HDF5 names.
+ * \return  True if succesful, false if not.
+ * \note The mesh is the same if the elements are the same. If the tree
+ * geometry changes during the series, for example for moving meshes,
+ * start a new series.
+ */
+int                 t8_forest_hdf5_series_write (t8_forest_hdf5_series_t
+                                                 series, t8_forest_t forest,
+                                                 double time,
+                                                 int write_treeid,
+                                                 int write_mpirank,
+                                                 int write_level,
+                                                 int num_data,
+                                                 t8_vtk_data_field_t * data);
+
+/** Finish a time series output and free its memory.
+ * The files of all written steps remain valid.
+ * \param [in,out] pseries The time series. Set to NULL on output.
+ */
+void                t8_forest_hdf5_series_destroy (t8_forest_hdf5_series_t *
+                                                   pseries);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_HDF5_H */
@@ -0,0 +1,86 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_forest_netcdf.h
+ * Write a forest together with per element data to a NetCDF-4 file that
+ * follows the UGRID conventions for unstructured meshes.
+ * t8code must be configured with "--with-netcdf" in order to use this.
+ * For output on more than one process, the netcdf library must support
+ * parallel I/O of NetCDF-4 files.
+ */
+
+#ifndef T8_FOREST_NETCDF_H
+#define T8_FOREST_NETCDF_H
+
+#include <t8_vtk.h>
+#include <t8_forest.h>
+
+/** The maximum number of rows of a chunk in the NetCDF variables. */
+#define T8_FOREST_NETCDF_CHUNK_SIZE 1048576
+
+T8_EXTERN_C_BEGIN ();
+
+/** Write a two or three dimensional forest to the NetCDF-4 file
+ * \a fileprefix.nc as a UGRID mesh.
+ * All processes write their elements collectively into the same file.
+ * Each variable is chunked along the elements (or nodes) with the average
+ * number of elements (or nodes) per process, such that the chunks follow
+ * the space-filling curve partition, and optionally compressed.
+ * The file contains the variables
+ *  - Mesh               The UGRID mesh topology of dimension 2 or 3.
+ *  - Mesh_node_x, Mesh_node_y (, Mesh_node_z)  The coordinates of the nodes.
+ *                       Nodes are not shared between elements.
+ *  - Mesh_face_nodes (2D) or Mesh_volume_nodes (3D)  The nodes of each
+ *                       element, padded with -1 for elements with fewer
+ *                       nodes than the maximum.
+ *  - Mesh_volume_types (3D)  The eclass of each element.
+ *  - Mesh_treeid, Mesh_mpirank, Mesh_level  If requested, see below.
+ *  - One variable per user data field, named after its description and
+ *    with an additional dimension of length 3 for vector fields.
+ * This function is collective and must be called on all processes of
+ * the forest's communicator.
+ * \param [in]  forest    The forest. Its dimension must be 2 or 3.
+ * \param [in]  fileprefix  The prefix of the output file.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element.
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the user defined per element data.
+ *                        The descriptions must be unique valid NetCDF names.
+ * \param [in]  deflate_level The deflate compression level between 0 and 9.
+ *                        0 disables compression. Compressed parallel output
+ *                        requires netcdf 4.7.4 or newer.
+ * \return  True if succesful, false if not.
+ */
+int                 t8_forest_write_netcdf (t8_forest_t forest,
+                                            const char *fileprefix,
+                                            int write_treeid,
+                                            int write_mpirank,
+                                            int write_level,
+                                            int num_data,
+                                            t8_vtk_data_field_t * data,
+                                            int deflate_level);
+
+T8_EXTERN_C_END ();
+
+#endif /* !T8_FOREST_NETCDF_H */
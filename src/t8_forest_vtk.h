@@ -31,6 +31,10 @@
 #include <t8_vtk.h>
 #include <t8_forest.h>
 
+/** Opaque handle of a .vtu file that is written in the background.
+ * \see t8_forest_vtk_write_file_async */
+typedef struct t8_forest_vtk_async *t8_forest_vtk_async_t;
+
 T8_EXTERN_C_BEGIN ();
 /* function declarations */
 
@@ -38,6 +42,9 @@ T8_EXTERN_C_BEGIN ();
  * process and a meta .pvtu file.
  * This function uses the vtk library. t8code must be configured with
  * "--with-vtk" in order to use it.
+ * The points, connectivity and cell types are computed in contiguous arrays
+ * and passed to vtk without copying. The data is written binary and zlib
+ * compressed to the appended section of the files.
  * \param [in]  forest    The forest.
  * \param [in]  fileprefix The prefix of the output files. The meta file will be named \a fileprefix.pvtu .
  * \note If t8code was not configured with vtk, use \ref t8_forest_vtk_write_file
@@ -72,6 +79,153 @@ int                 t8_forest_vtk_write_file (t8_forest_t forest,
                                               int num_data,
                                               t8_vtk_data_field_t * data);
 
+/** Write the forest in .pvtu file format with a given output format
+ * for the .vtu files.
+ * In binary format each data array is collected in memory and all of
+ * them are written with a single fwrite into an appended data section
+ * at the end of each .vtu file. This is considerably faster and smaller
+ * than ascii output.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each element.
+ * \param [in]  write_mpirank If true, the mpirank is written for each element .
+ * \param [in]  write_level If true, the refinement level is written for each element.
+ * \param [in]  write_element_id If true, the global element id is written for each element.
+ * \param [in]  write_ghosts If true, each process additionally writes its ghost elements.
+ *                           For ghost element the treeid is -1.
+ * \param [in]  shared_vertices If true, the corners of neighboring elements
+ *                           that lie at the same position are written as one
+ *                           point. Otherwise, each element has its own points.
+ *                           The point data of a shared point is the average of
+ *                           the element data of its local elements.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ *                        If scalar and vector fields are used, all scalar fields
+ *                        must come first in the array.
+ * \param [in]  format    The format of the data arrays, see \ref t8_vtk_format_t.
+ * \return  True if succesful, false if not (process local).
+ * \note \ref t8_forest_vtk_write_file is equivalent to calling this function
+ *       with \a format = T8_VTK_FORMAT_ASCII.
+ */
+int                 t8_forest_vtk_write_file_format (t8_forest_t forest,
+                                                     const char *fileprefix,
+                                                     int write_treeid,
+                                                     int write_mpirank,
+                                                     int write_level,
+                                                     int write_element_id,
+                                                     int write_ghosts,
+                                                     int shared_vertices,
+                                                     int num_data,
+                                                     t8_vtk_data_field_t *
+                                                     data,
+                                                     t8_vtk_format_t format);
+
+/** Write the forest in .pvtu file format with reduced precision or
+ * reduced level of detail.
+ * If \a maxlevel is not negative, all leaf elements of a level larger than
+ * \a maxlevel are replaced by their ancestor at level \a maxlevel. The data
+ * of such an output cell is the volume weighted average of the data of the
+ * local leaf elements it contains. No coarsened forest is built, the cells
+ * are computed while writing.
+ * \param [in]  forest    The forest.
+ * \param [in]  fileprefix  The prefix of the output files.
+ * \param [in]  write_treeid If true, the global tree id is written for each cell.
+ * \param [in]  write_mpirank If true, the mpirank is written for each cell.
+ * \param [in]  write_level If true, the refinement level is written for each cell.
+ * \param [in]  num_data  Number of user defined double valued data fields to write.
+ * \param [in]  data      Array of t8_vtk_data_field_t of length \a num_data
+ *                        providing the used defined per element data.
+ *                        If scalar and vector fields are used, all scalar fields
+ *                        must come first in the array.
+ * \param [in]  format    The format of the data arrays, see \ref t8_vtk_format_t.
+ * \param [in]  use_float32 If true, coordinates and data fields are written as
+ *                        Float32, otherwise as Float64.
+ * \param [in]  maxlevel  The maximum refinement level of the output cells.
+ *                        If negative, the leaf elements are written.
+ * \return  True if succesful, false if not (process local).
+ * \note If the leaf elements of one ancestor are distributed to several
+ *       processes, each of these processes writes the ancestor with the
+ *       average of its local leaf elements.
+ */
+int                 t8_forest_vtk_write_file_lod (t8_forest_t forest,
+                                                  const char *fileprefix,
+                                                  int write_treeid,
+                                                  int write_mpirank,
+                                                  int write_level,
+                                                  int num_data,
+                                                  t8_vtk_data_field_t * data,
+                                                  t8_vtk_format_t format,
+                                                  int use_float32,
+                                                  int maxlevel);
+
+/** Write the forest in .pvtu file format into a small number of .vtu files
+ * using collective MPI I/O.
+ * The processes are split into \a num_files contiguous groups. Each group
+ * writes one .vtu file that contains one piece per process. The position
+ * of each process' data in the file is computed from a prefix sum over
+ * the local data sizes. This avoids creating one file per process, which
+ * is slow on parallel file systems for large numbers of processes.
+ * This function is collective and must be called on all processes of
+ * the forest.
+ * The parameters are the same as in \ref t8_forest_vtk_write_file_format.
+ * \param [in]  num_files The number of .vtu files to write. Must be positive.
+ *                        If it is larger than the number of processes, one
+ *                        file per process is written.
+ * \return  True if succesful, false if not (process local).
+ * \note If t8code is not configured with MPI I/O, this function falls back to
+ *       \ref t8_forest_vtk_write_file_format.
+ */
+int                 t8_forest_vtk_write_file_mpiio (t8_forest_t forest,
+                                                    const char *fileprefix,
+                                                    int write_treeid,
+                                                    int write_mpirank,
+                                                    int write_level,
+                                                    int write_element_id,
+                                                    int write_ghosts,
+                                                    int shared_vertices,
+                                                    int num_data,
+                                                    t8_vtk_data_field_t *
+                                                    data,
+                                                    t8_vtk_format_t format,
+                                                    int num_files);
+
+/** Write the forest in .pvtu file format without waiting for the files
+ * to be written.
+ * The output of this process is computed and staged in memory, then the
+ * .vtu file is written by a background thread. When this function returns,
+ * the forest and the data fields are not needed anymore, thus they may be
+ * adapted, modified or destroyed while the file is written.
+ * The .pvtu file is written by process 0 before this function returns.
+ * The parameters are the same as in \ref t8_forest_vtk_write_file_format.
+ * \return  A handle to the output that must be passed to
+ *          \ref t8_forest_vtk_async_wait.
+ * \note Background threads are only used if libsc was configured with
+ *       --enable-pthread. Otherwise the file is written before this
+ *       function returns.
+ */
+t8_forest_vtk_async_t t8_forest_vtk_write_file_async (t8_forest_t forest,
+                                                      const char *fileprefix,
+                                                      int write_treeid,
+                                                      int write_mpirank,
+                                                      int write_level,
+                                                      int write_element_id,
+                                                      int write_ghosts,
+                                                      int shared_vertices,
+                                                      int num_data,
+                                                      t8_vtk_data_field_t *
+                                                      data,
+                                                      t8_vtk_format_t
+                                                      format);
+
+/** Wait until an output started with \ref t8_forest_vtk_write_file_async
+ * is written and free its staging memory.
+ * \param [in,out] pasync  The handle of the output. Set to NULL on output.
+ * \return  True if succesful, false if not (process local).
+ */
+int                 t8_forest_vtk_async_wait (t8_forest_vtk_async_t *
+                                              pasync);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_FOREST_VTK_H */
@@ -32,6 +32,8 @@ typedef struct t8_geometry
   const char         *name;     /**< User's choice is arbitrary. */
   void               *user;     /**< User's choice is arbitrary. */
   t8_geometry_X_t     X;     /**< Coordinate transformation. */
+  t8_geometry_X_batch_t Xb;  /**< Batched coordinate transformation,
+                                  used instead of X if not NULL. */
   t8_geometry_reset_t reset;     /**< Destructor called by
                                              t8_geometry_reset.  If
                                              NULL, T8_FREE is called. */
@@ -72,6 +74,37 @@ t8_geometry_set_transformation (t8_geometry_t geom, t8_geometry_X_t X)
   geom->X = X;
 }
 
+void
+t8_geometry_set_batch_transformation (t8_geometry_t geom,
+                                      t8_geometry_X_batch_t Xb)
+{
+  T8_ASSERT (geom != NULL);
+
+  geom->Xb = Xb;
+}
+
+void
+t8_geometry_evaluate (t8_geometry_t geom, t8_topidx_t which_tree,
+                      size_t num_points, const double *abc, double *xyz,
+                      double *jacobian)
+{
+  size_t              ipoint;
+
+  T8_ASSERT (geom != NULL);
+  T8_ASSERT (num_points == 0 || abc != xyz);
+
+  if (geom->Xb != NULL) {
+    geom->Xb (geom, which_tree, num_points, abc, xyz, jacobian);
+    return;
+  }
+  SC_CHECK_ABORT (jacobian == NULL, "The Jacobian of a geometry can only be"
+                  " computed with a batched transformation");
+  SC_CHECK_ABORT (geom->X != NULL, "The geometry has no transformation");
+  for (ipoint = 0; ipoint < num_points; ipoint++) {
+    geom->X (geom, which_tree, abc + 3 * ipoint, xyz + 3 * ipoint);
+  }
+}
+
 void
 t8_geometry_set_reset (t8_geometry_t geom, t8_geometry_reset_t reset)
 {
@@ -115,7 +148,7 @@ t8_geometry_reset (t8_geometry_t * pgeom)
   }
   else {
     T8_FREE (geom);
-    pgeom = NULL;
+    *pgeom = NULL;
   }
 }
 
@@ -128,6 +161,24 @@ t8_geometry_identity_X (t8_geometry_t geom, t8_topidx_t which_tree,
   xyz[2] = abc[2];
 }
 
+static void
+t8_geometry_identity_X_batch (t8_geometry_t geom, t8_topidx_t which_tree,
+                              size_t num_points, const double *abc,
+                              double *xyz, double *jacobian)
+{
+  size_t              ipoint;
+  int                 i;
+
+  memcpy (xyz, abc, 3 * num_points * sizeof (double));
+  if (jacobian != NULL) {
+    for (ipoint = 0; ipoint < num_points; ipoint++) {
+      for (i = 0; i < 9; i++) {
+        jacobian[9 * ipoint + i] = i % 4 == 0 ? 1 : 0;
+      }
+    }
+  }
+}
+
 t8_geometry_t
 t8_geometry_new_identity (void)
 {
@@ -136,5 +187,6 @@ t8_geometry_new_identity (void)
   t8_geometry_init (&geom);
   t8_geometry_set_name (geom, "Identity");
   t8_geometry_set_transformation (geom, t8_geometry_identity_X);
+  t8_geometry_set_batch_transformation (geom, t8_geometry_identity_X_batch);
   return geom;
 }
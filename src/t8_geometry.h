@@ -22,7 +22,8 @@
 
 /** \file t8_geometry.h
  * We define the geometry transformation for a forest of trees in this file.
- * This is mainly used for vtk output.
+ * A geometry is set with \ref t8_forest_set_geometry and then used for
+ * all coordinates of the forest elements, including the vtk output.
  */
 
 #ifndef T8_GEOMETRY_H
@@ -47,6 +48,24 @@ typedef void        (*t8_geometry_X_t) (t8_geometry_t geom,
                                         t8_topidx_t which_tree,
                                         const double abc[3], double xyz[3]);
 
+/** Forward transformation of many points of the same tree in one call.
+ * \param [in] geom The underlying t8_geometry_t struct.
+ * \param [in] which_tree The tree_id of the coarse tree to be considered.
+ * \param [in] num_points The number of points.
+ * \param [in] abc  The reference coordinates in [0,1]^d of the points,
+ *                  stored as consecutive triples.
+ * \param [out] xyz The physical coordinates of the points, stored as
+ *                  consecutive triples. Does not overlap with \a abc.
+ * \param [out] jacobian If not NULL, for each point the 9 entries of the
+ *                  Jacobian matrix d xyz / d abc in row major order, that
+ *                  is entry 3 * i + j is the derivative of xyz[i] by abc[j].
+ */
+typedef void        (*t8_geometry_X_batch_t) (t8_geometry_t geom,
+                                              t8_topidx_t which_tree,
+                                              size_t num_points,
+                                              const double *abc,
+                                              double *xyz, double *jacobian);
+
 /** Destructor prototype for a user-allocated \a t8_geometry_t.
  * It is invoked by t8_geometry_reset.  If the user chooses to
  * reserve the structure statically, simply don't call t8_geometry_reset.
@@ -66,6 +85,36 @@ void                t8_geometry_set_user (t8_geometry_t geom, void *user);
 void                t8_geometry_set_transformation (t8_geometry_t geom,
                                                     t8_geometry_X_t X);
 
+/** Set the batched transformation of a geometry.
+ * If set, it is used instead of the transformation of
+ * \ref t8_geometry_set_transformation by \ref t8_geometry_evaluate.
+ * \param [in,out] geom  The geometry.
+ * \param [in]     Xb    The batched transformation.
+ */
+void                t8_geometry_set_batch_transformation (t8_geometry_t geom,
+                                                          t8_geometry_X_batch_t
+                                                          Xb);
+
+/** Map points of a tree from reference to physical coordinates.
+ * The batched transformation of the geometry is called once for all points
+ * if it is set, otherwise the transformation is called for each point.
+ * \param [in] geom The geometry.
+ * \param [in] which_tree The tree_id of the coarse tree to be considered.
+ * \param [in] num_points The number of points.
+ * \param [in] abc  The reference coordinates of the points,
+ *                  stored as consecutive triples.
+ * \param [out] xyz The physical coordinates of the points.
+ *                  Must not overlap with \a abc.
+ * \param [out] jacobian If not NULL, on output the Jacobian matrices of the
+ *                  points, see \ref t8_geometry_X_batch_t.
+ *                  This requires the batched transformation to be set.
+ */
+void                t8_geometry_evaluate (t8_geometry_t geom,
+                                          t8_topidx_t which_tree,
+                                          size_t num_points,
+                                          const double *abc, double *xyz,
+                                          double *jacobian);
+
 void                t8_geometry_set_reset (t8_geometry_t geom,
                                            t8_geometry_reset_t reset);
 
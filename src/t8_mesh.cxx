@@ -0,0 +1,550 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_mesh.cxx
+ * We build the explicit mesh of the local elements of a forest.
+ * \see t8_mesh_new_from_forest
+ */
+
+#include <t8_mesh.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_ghost.h>
+#include <algorithm>
+#include <vector>
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+struct t8_mesh
+{
+  sc_MPI_Comm         comm;     /* The communicator of the forest */
+  t8_locidx_t         num_elements;     /* The number of local elements */
+  t8_gloidx_t         first_element;    /* The global id of the first local element */
+  t8_locidx_t         num_nodes;        /* The number of local nodes */
+  t8_locidx_t         num_owned_nodes;  /* The number of owned nodes, they come first */
+  t8_gloidx_t         global_num_nodes; /* The number of nodes on all processes */
+  int                 max_support;      /* The maximum support length of a node */
+  t8_element_shape_t *element_shapes;   /* The shape of each element */
+  t8_locidx_t        *element_offsets;  /* For each element the position of its
+                                           first node in element_nodes,
+                                           num_elements + 1 entries */
+  t8_locidx_t        *element_nodes;    /* The nodes of the elements */
+  double             *node_coordinates; /* 3 coordinates for each node */
+  t8_gloidx_t        *node_gloids;      /* The global id of each node */
+  int                *node_owners;      /* The owner rank of each node */
+  t8_locidx_t        *support_offsets;  /* For each node the position of its
+                                           first element in support_elements,
+                                           num_nodes + 1 entries */
+  t8_locidx_t        *support_elements; /* The elements containing the nodes */
+};
+
+/* A corner of an element with its quantized coordinates, used to find
+ * the corners that share a node. */
+typedef struct
+{
+  long long           key[3];   /* The quantized coordinates */
+  size_t              corner;   /* element * T8_ECLASS_MAX_CORNERS + corner */
+} t8_mesh_corner_t;
+
+/* Order corners by their quantized coordinates and then by index */
+static bool
+t8_mesh_corner_less (const t8_mesh_corner_t & a, const t8_mesh_corner_t & b)
+{
+  int                 i;
+
+  for (i = 0; i < 3; i++) {
+    if (a.key[i] != b.key[i]) {
+      return a.key[i] < b.key[i];
+    }
+  }
+  return a.corner < b.corner;
+}
+
+/* Store the value of the node of each corner of the local elements in
+ * corner_values and exchange them with the ghosts. */
+static void
+t8_mesh_exchange_node_values (t8_forest_t forest,
+                              const t8_element_shape_t * shapes,
+                              const t8_locidx_t * corner_nodes,
+                              const t8_gloidx_t * node_values,
+                              sc_array_t * corner_values)
+{
+  t8_gloidx_t        *values;
+  t8_locidx_t         ielem, num_local;
+  int                 icorner;
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  for (ielem = 0; ielem < num_local; ielem++) {
+    values = (t8_gloidx_t *) t8_sc_array_index_locidx (corner_values, ielem);
+    for (icorner = 0; icorner < t8_eclass_num_vertices[shapes[ielem]];
+         icorner++) {
+      values[icorner] =
+        node_values[corner_nodes[ielem * T8_ECLASS_MAX_CORNERS + icorner]];
+    }
+  }
+  t8_forest_ghost_exchange_data (forest, corner_values);
+}
+
+t8_mesh_t          *
+t8_mesh_new_from_forest (t8_forest_t forest)
+{
+  t8_mesh_t          *mesh;
+  std::vector < double >tree_coordinates;
+  std::vector < t8_mesh_corner_t > corners;
+  std::vector < t8_locidx_t > corner_nodes, new_ids, support_positions;
+  std::vector < size_t >first_corners;
+  std::vector < t8_gloidx_t > node_values;
+  t8_element_shape_t *shapes;
+  sc_array_t          corner_coordinates, corner_values;
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  const t8_gloidx_t  *values;
+  const double       *coordinates;
+  t8_locidx_t         num_local, num_ghosts, num_trees, itree, ielem;
+  t8_locidx_t         num_elements, num_nodes, inode, lnode, num_owned;
+  t8_locidx_t         ighost, first_ghost, next_ghost, offset;
+  t8_gloidx_t         first_owned, local_counts[2], global_counts[2];
+  double              lower[3], upper[3], extent, resolution;
+  size_t              icorner, next, num_corners;
+  int                 mpirank, mpisize, mpiret, i, icorner_elem;
+  int                 num_remotes, iremote, *remotes;
+  int                 changed, global_changed;
+
+  T8_ASSERT (t8_forest_is_committed (forest));
+
+  mesh = T8_ALLOC_ZERO (t8_mesh_t, 1);
+  mesh->comm = t8_forest_get_mpicomm (forest);
+  mpiret = sc_MPI_Comm_rank (mesh->comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (mesh->comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (mpisize == 1 || t8_forest_get_num_ghost_layers (forest) > 0,
+                  "A mesh of a distributed forest needs a ghost layer");
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  shapes = T8_ALLOC (t8_element_shape_t, num_local + num_ghosts);
+
+  /* Compute the coordinates of the corners of the local elements with one
+   * pass per tree and get those of the ghosts from their owners. */
+  sc_array_init_size (&corner_coordinates,
+                      3 * T8_ECLASS_MAX_CORNERS * sizeof (double),
+                      num_local + num_ghosts);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0, offset = 0; itree < num_trees; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_coordinates.resize (3 * t8_forest_get_tree_num_corners (forest,
+                                                                 itree));
+    t8_forest_tree_element_coordinates (forest, itree,
+                                        tree_coordinates.data ());
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0, icorner = 0; ielem < num_elements; ielem++, offset++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      shapes[offset] = ts->t8_element_shape (element);
+      num_corners = t8_eclass_num_vertices[shapes[offset]];
+      memcpy (t8_sc_array_index_locidx (&corner_coordinates, offset),
+              &tree_coordinates[3 * icorner],
+              3 * num_corners * sizeof (double));
+      icorner += num_corners;
+    }
+  }
+  T8_ASSERT (offset == num_local);
+  for (itree = 0; itree < t8_forest_ghost_num_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_ghost_get_tree_class (forest,
+                                                                      itree));
+    num_elements = t8_forest_ghost_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, offset++) {
+      element = t8_forest_ghost_get_element (forest, itree, ielem);
+      shapes[offset] = ts->t8_element_shape (element);
+    }
+  }
+  T8_ASSERT (offset == num_local + num_ghosts);
+  t8_forest_ghost_exchange_data (forest, &corner_coordinates);
+
+  /* Identify the corners with their coordinates, quantized relative to the
+   * extent of the local domain as for the shared vertices of the vtk
+   * output. */
+  for (i = 0; i < 3; i++) {
+    lower[i] = upper[i] = 0;
+  }
+  for (ielem = 0, num_corners = 0; ielem < num_local + num_ghosts; ielem++) {
+    coordinates = (const double *)
+      t8_sc_array_index_locidx (&corner_coordinates, ielem);
+    for (icorner_elem = 0;
+         icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+         icorner_elem++, num_corners++) {
+      for (i = 0; i < 3; i++) {
+        if (num_corners == 0) {
+          lower[i] = upper[i] = coordinates[3 * icorner_elem + i];
+        }
+        lower[i] = SC_MIN (lower[i], coordinates[3 * icorner_elem + i]);
+        upper[i] = SC_MAX (upper[i], coordinates[3 * icorner_elem + i]);
+      }
+    }
+  }
+  for (i = 0, extent = 0; i < 3; i++) {
+    extent = SC_MAX (extent, upper[i] - lower[i]);
+  }
+  resolution = extent > 0 ? 1e-10 * extent : 1;
+  corners.resize (num_corners);
+  for (ielem = 0, icorner = 0; ielem < num_local + num_ghosts; ielem++) {
+    coordinates = (const double *)
+      t8_sc_array_index_locidx (&corner_coordinates, ielem);
+    for (icorner_elem = 0;
+         icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+         icorner_elem++, icorner++) {
+      for (i = 0; i < 3; i++) {
+        corners[icorner].key[i] =
+          llround ((coordinates[3 * icorner_elem + i] - lower[i])
+                   / resolution);
+      }
+      corners[icorner].corner =
+        (size_t) ielem * T8_ECLASS_MAX_CORNERS + icorner_elem;
+    }
+  }
+  std::sort (corners.begin (), corners.end (), t8_mesh_corner_less);
+
+  /* Number the nodes by their first corner. Since the corners of the local
+   * elements come first, so do the nodes of the local elements. */
+  corner_nodes.resize ((size_t) (num_local + num_ghosts)
+                       * T8_ECLASS_MAX_CORNERS, -1);
+  for (icorner = 0; icorner < num_corners; icorner = next) {
+    first_corners.push_back (corners[icorner].corner);
+    for (next = icorner + 1; next < num_corners
+         && !memcmp (corners[next].key, corners[icorner].key,
+                     sizeof (corners[icorner].key)); next++) {
+    }
+  }
+  std::sort (first_corners.begin (), first_corners.end ());
+  num_nodes = (t8_locidx_t)
+    (std::lower_bound (first_corners.begin (), first_corners.end (),
+                       (size_t) num_local * T8_ECLASS_MAX_CORNERS)
+     - first_corners.begin ());
+  for (icorner = 0; icorner < num_corners; icorner = next) {
+    inode = (t8_locidx_t)
+      (std::lower_bound (first_corners.begin (), first_corners.end (),
+                         corners[icorner].corner)
+       - first_corners.begin ());
+    next = icorner;
+    do {
+      corner_nodes[corners[next].corner] = inode;
+      next++;
+    } while (next < num_corners
+             && !memcmp (corners[next].key, corners[next - 1].key,
+                         sizeof (corners[next].key)));
+  }
+
+  /* The owner of a node is the smallest rank of the elements containing it.
+   * We start with the ranks of the local elements and ghosts and pass the
+   * minimum on to the neighbors until it does not change any more. */
+  node_values.resize (first_corners.size (), mpisize);
+  for (ielem = 0; ielem < num_local; ielem++) {
+    for (icorner_elem = 0;
+         icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+         icorner_elem++) {
+      node_values[corner_nodes[ielem * T8_ECLASS_MAX_CORNERS
+                               + icorner_elem]] = mpirank;
+    }
+  }
+  remotes = t8_forest_ghost_get_remotes (forest, &num_remotes);
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    first_ghost = t8_forest_ghost_remote_first_elem (forest,
+                                                     remotes[iremote]);
+    next_ghost = iremote + 1 < num_remotes ?
+      t8_forest_ghost_remote_first_elem (forest, remotes[iremote + 1])
+      : num_ghosts;
+    for (ighost = first_ghost; ighost < next_ghost; ighost++) {
+      ielem = num_local + ighost;
+      for (icorner_elem = 0;
+           icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+           icorner_elem++) {
+        inode = corner_nodes[ielem * T8_ECLASS_MAX_CORNERS + icorner_elem];
+        node_values[inode] = SC_MIN (node_values[inode], remotes[iremote]);
+      }
+    }
+  }
+  sc_array_init_size (&corner_values,
+                      T8_ECLASS_MAX_CORNERS * sizeof (t8_gloidx_t),
+                      num_local + num_ghosts);
+  do {
+    t8_mesh_exchange_node_values (forest, shapes, corner_nodes.data (),
+                                  node_values.data (), &corner_values);
+    changed = 0;
+    for (ielem = num_local; ielem < num_local + num_ghosts; ielem++) {
+      values = (const t8_gloidx_t *)
+        t8_sc_array_index_locidx (&corner_values, ielem);
+      for (icorner_elem = 0;
+           icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+           icorner_elem++) {
+        inode = corner_nodes[ielem * T8_ECLASS_MAX_CORNERS + icorner_elem];
+        if (values[icorner_elem] < node_values[inode]) {
+          node_values[inode] = values[icorner_elem];
+          changed = 1;
+        }
+      }
+    }
+    mpiret = sc_MPI_Allreduce (&changed, &global_changed, 1, sc_MPI_INT,
+                               sc_MPI_MAX, mesh->comm);
+    SC_CHECK_MPI (mpiret);
+  } while (global_changed);
+
+  /* Renumber the local nodes such that the owned nodes come first */
+  mesh->num_nodes = num_nodes;
+  mesh->node_owners = T8_ALLOC (int, num_nodes);
+  new_ids.resize (first_corners.size (), -1);
+  for (inode = 0, num_owned = 0; inode < num_nodes; inode++) {
+    if (node_values[inode] == mpirank) {
+      new_ids[inode] = num_owned++;
+    }
+  }
+  for (inode = 0, lnode = num_owned; inode < num_nodes; inode++) {
+    if (node_values[inode] != mpirank) {
+      new_ids[inode] = lnode++;
+    }
+    mesh->node_owners[new_ids[inode]] = (int) node_values[inode];
+  }
+  mesh->num_owned_nodes = num_owned;
+
+  /* The owners number their nodes consecutively in the order of the ranks.
+   * The other processes get the ids through the ghost layer. */
+  local_counts[0] = num_owned;
+  first_owned = 0;
+  mpiret = sc_MPI_Exscan (local_counts, &first_owned, 1, T8_MPI_GLOIDX,
+                          sc_MPI_SUM, mesh->comm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    first_owned = 0;
+  }
+  mpiret = sc_MPI_Allreduce (local_counts, &mesh->global_num_nodes, 1,
+                             T8_MPI_GLOIDX, sc_MPI_SUM, mesh->comm);
+  SC_CHECK_MPI (mpiret);
+  for (inode = 0; inode < (t8_locidx_t) node_values.size (); inode++) {
+    node_values[inode] = inode < num_nodes && new_ids[inode] < num_owned ?
+      first_owned + new_ids[inode] : -1;
+  }
+  do {
+    t8_mesh_exchange_node_values (forest, shapes, corner_nodes.data (),
+                                  node_values.data (), &corner_values);
+    local_counts[0] = local_counts[1] = 0;
+    for (ielem = num_local; ielem < num_local + num_ghosts; ielem++) {
+      values = (const t8_gloidx_t *)
+        t8_sc_array_index_locidx (&corner_values, ielem);
+      for (icorner_elem = 0;
+           icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+           icorner_elem++) {
+        inode = corner_nodes[ielem * T8_ECLASS_MAX_CORNERS + icorner_elem];
+        if (values[icorner_elem] >= 0 && node_values[inode] < 0) {
+          node_values[inode] = values[icorner_elem];
+          local_counts[1] = 1;
+        }
+      }
+    }
+    for (inode = 0; inode < num_nodes; inode++) {
+      local_counts[0] += node_values[inode] < 0;
+    }
+    /* The number of unresolved nodes and whether we made progress */
+    mpiret = sc_MPI_Allreduce (local_counts, global_counts, 2,
+                               T8_MPI_GLOIDX, sc_MPI_MAX, mesh->comm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (global_counts[0] == 0 || global_counts[1] > 0,
+                    "Could not resolve the global ids of the mesh nodes");
+  } while (global_counts[0] > 0);
+  sc_array_reset (&corner_values);
+
+  /* Store the nodes of the local elements and their supports */
+  mesh->num_elements = num_local;
+  mesh->first_element = t8_forest_get_first_local_element_id (forest);
+  mesh->element_shapes = T8_ALLOC (t8_element_shape_t, num_local);
+  mesh->element_offsets = T8_ALLOC (t8_locidx_t, num_local + 1);
+  mesh->node_gloids = T8_ALLOC (t8_gloidx_t, num_nodes);
+  mesh->node_coordinates = T8_ALLOC (double, 3 * num_nodes);
+  mesh->support_offsets = T8_ALLOC_ZERO (t8_locidx_t, num_nodes + 1);
+  mesh->element_offsets[0] = 0;
+  for (ielem = 0; ielem < num_local; ielem++) {
+    mesh->element_shapes[ielem] = shapes[ielem];
+    mesh->element_offsets[ielem + 1] = mesh->element_offsets[ielem]
+      + t8_eclass_num_vertices[shapes[ielem]];
+  }
+  mesh->element_nodes =
+    T8_ALLOC (t8_locidx_t, mesh->element_offsets[num_local]);
+  for (ielem = 0; ielem < num_local; ielem++) {
+    coordinates = (const double *)
+      t8_sc_array_index_locidx (&corner_coordinates, ielem);
+    for (icorner_elem = 0;
+         icorner_elem < t8_eclass_num_vertices[shapes[ielem]];
+         icorner_elem++) {
+      inode = corner_nodes[ielem * T8_ECLASS_MAX_CORNERS + icorner_elem];
+      lnode = new_ids[inode];
+      mesh->element_nodes[mesh->element_offsets[ielem] + icorner_elem] =
+        lnode;
+      mesh->node_gloids[lnode] = node_values[inode];
+      memcpy (mesh->node_coordinates + 3 * lnode,
+              coordinates + 3 * icorner_elem, 3 * sizeof (double));
+      mesh->support_offsets[lnode + 1]++;
+    }
+  }
+  for (lnode = 0, mesh->max_support = 0; lnode < num_nodes; lnode++) {
+    mesh->max_support = SC_MAX (mesh->max_support,
+                                mesh->support_offsets[lnode + 1]);
+    mesh->support_offsets[lnode + 1] += mesh->support_offsets[lnode];
+  }
+  mesh->support_elements =
+    T8_ALLOC (t8_locidx_t, mesh->support_offsets[num_nodes]);
+  support_positions.assign (mesh->support_offsets,
+                            mesh->support_offsets + num_nodes);
+  for (ielem = 0; ielem < num_local; ielem++) {
+    for (offset = mesh->element_offsets[ielem];
+         offset < mesh->element_offsets[ielem + 1]; offset++) {
+      lnode = mesh->element_nodes[offset];
+      mesh->support_elements[support_positions[lnode]++] = ielem;
+    }
+  }
+  sc_array_reset (&corner_coordinates);
+  T8_FREE (shapes);
+  return mesh;
+}
+
+sc_MPI_Comm
+t8_mesh_get_comm (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->comm;
+}
+
+t8_locidx_t
+t8_mesh_get_num_elements (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->num_elements;
+}
+
+t8_locidx_t
+t8_mesh_get_num_nodes (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->num_nodes;
+}
+
+t8_locidx_t
+t8_mesh_get_num_owned_nodes (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->num_owned_nodes;
+}
+
+t8_gloidx_t
+t8_mesh_get_global_num_nodes (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->global_num_nodes;
+}
+
+t8_element_shape_t
+t8_mesh_get_element_class (t8_mesh_t * mesh, t8_locidx_t locid)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= locid && locid < mesh->num_elements);
+  return mesh->element_shapes[locid];
+}
+
+t8_gloidx_t
+t8_mesh_get_element_gloid (t8_mesh_t * mesh, t8_locidx_t locid)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= locid && locid < mesh->num_elements);
+  return mesh->first_element + locid;
+}
+
+const t8_locidx_t  *
+t8_mesh_get_element_nodes (t8_mesh_t * mesh, t8_locidx_t locid,
+                           int *num_nodes)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= locid && locid < mesh->num_elements);
+  T8_ASSERT (num_nodes != NULL);
+  *num_nodes =
+    mesh->element_offsets[locid + 1] - mesh->element_offsets[locid];
+  return mesh->element_nodes + mesh->element_offsets[locid];
+}
+
+t8_gloidx_t
+t8_mesh_get_node_gloid (t8_mesh_t * mesh, t8_locidx_t lnode)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= lnode && lnode < mesh->num_nodes);
+  return mesh->node_gloids[lnode];
+}
+
+int
+t8_mesh_get_node_owner (t8_mesh_t * mesh, t8_locidx_t lnode)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= lnode && lnode < mesh->num_nodes);
+  return mesh->node_owners[lnode];
+}
+
+const double       *
+t8_mesh_get_node_coordinates (t8_mesh_t * mesh, t8_locidx_t lnode)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= lnode && lnode < mesh->num_nodes);
+  return mesh->node_coordinates + 3 * lnode;
+}
+
+int
+t8_mesh_get_maximum_support (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  return mesh->max_support;
+}
+
+const t8_locidx_t  *
+t8_mesh_get_node_support (t8_mesh_t * mesh, t8_locidx_t lnode,
+                          int *length_support)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_ASSERT (0 <= lnode && lnode < mesh->num_nodes);
+  T8_ASSERT (length_support != NULL);
+  *length_support =
+    mesh->support_offsets[lnode + 1] - mesh->support_offsets[lnode];
+  return mesh->support_elements + mesh->support_offsets[lnode];
+}
+
+void
+t8_mesh_destroy (t8_mesh_t * mesh)
+{
+  T8_ASSERT (mesh != NULL);
+  T8_FREE (mesh->element_shapes);
+  T8_FREE (mesh->element_offsets);
+  T8_FREE (mesh->element_nodes);
+  T8_FREE (mesh->node_coordinates);
+  T8_FREE (mesh->node_gloids);
+  T8_FREE (mesh->node_owners);
+  T8_FREE (mesh->support_offsets);
+  T8_FREE (mesh->support_elements);
+  T8_FREE (mesh);
+}
+
+T8_EXTERN_C_END ();
@@ -22,118 +22,165 @@
 
 /** \file t8_mesh.h
  * The mesh object is defined here.
- * The mesh object is intended for interfacing from and to other codes.  It can
- * be conforming or adaptive, and replicated or distributed in parallel.
- * On input to the creation of a forest, it provides the conforming mesh of
- * coarse elements that are the roots of the tree-based subdivision.  The
- * coarse input mesh must be conforming (have no hanging nodes).
- * On output this mesh contains the connectivity of a mesh that has possibly
- * been adaptively refined (has hanging nodes), including information on remote
- * neighbors.
+ * The mesh object is intended for interfacing to other codes, such as finite
+ * element codes that work on an explicit unstructured mesh.
+ * It is an explicit view of the local elements of a committed forest: the
+ * corners of the elements are numbered as nodes, each node has a unique
+ * global id across all processes, and for each element its nodes and for
+ * each node the elements that contain it (its support) are stored.
+ * The mesh is built in one pass over the forest and does not change when
+ * the forest changes. To follow an adapted or partitioned forest, a new mesh
+ * has to be built.
+ * Since the mesh may be adaptive, it can have hanging nodes. A hanging node
+ * is a node of the smaller elements only and not of the larger element on
+ * whose face or edge it lies.
  */
 
 #ifndef T8_MESH_H
 #define T8_MESH_H
 
 #include <t8_element.h>
+#include <t8_forest.h>
 
 typedef struct t8_mesh t8_mesh_t;
 
-/************************* preallocate **************************/
+T8_EXTERN_C_BEGIN ();
 
-t8_mesh_t          *t8_mesh_new (int dimension,
-                                 t8_gloidx_t Kglobal, t8_locidx_t Klocal);
-
-/************* all-in-one convenience constructors **************/
-
-t8_mesh_t          *t8_mesh_new_unitcube (t8_eclass_t theclass);
-
-/***************************** setters **************************/
-
-void                t8_mesh_set_comm (t8_mesh_t * mesh, sc_MPI_Comm comm);
+/***************************** construct ************************/
 
-/** Determine whether we partition in \ref t8_mesh_build.
- * Default true.
+/** Build the explicit mesh of the local elements of a forest.
+ * The corners of the elements are identified by their coordinates.
+ * Each node is owned by the smallest rank of the elements that contain it.
+ * The global ids of the nodes are numbered consecutively by the owners in
+ * the order of the ranks, and the ids of the other nodes are obtained from
+ * the ghost layer.
+ * \param [in]      forest    A committed forest. If it lives on more than
+ *                            one process, it must have a ghost layer, see
+ *                            \ref t8_forest_set_ghost.
+ * \return                    The mesh of the local elements of \a forest.
+ *                            It does not keep a reference to \a forest.
+ * \note This function is collective and hence must be called by all
+ *       processes in the forest's MPI Communicator.
  */
-void                t8_mesh_set_partition (t8_mesh_t * mesh, int enable);
-
-void                t8_mesh_set_element (t8_mesh_t * mesh,
-                                         t8_eclass_t theclass,
-                                         t8_gloidx_t gloid,
-                                         t8_locidx_t locid);
-
-void                t8_mesh_set_local_to_global (t8_mesh_t * mesh,
-                                                 t8_locidx_t ltog_length,
-                                                 const t8_gloidx_t * ltog);
+t8_mesh_t          *t8_mesh_new_from_forest (t8_forest_t forest);
 
-void                t8_mesh_set_face (t8_mesh_t * mesh,
-                                      t8_locidx_t locid1, int face1,
-                                      t8_locidx_t locid2, int face2,
-                                      int orientation);
-
-void                t8_mesh_set_element_vertices (t8_mesh_t * mesh,
-                                                  t8_locidx_t locid,
-                                                  t8_locidx_t vids_length,
-                                                  const t8_locidx_t * vids);
-
-#if 0
-void                t8_mesh_set_element_scheme (t8_mesh_t * mesh,
-                                                t8_locidx_t locid,
-                                                t8_scheme_t * scheme);
-#endif
+/****************************** queries *************************/
 
-/***************************** construct ************************/
+/** Return the MPI communicator of a mesh.
+ * \param [in]      mesh      A mesh.
+ * \return                    The communicator of the forest of \a mesh.
+ */
+sc_MPI_Comm         t8_mesh_get_comm (t8_mesh_t * mesh);
 
-/** Setup a mesh and turn it into a usable object.
+/** Return the number of local elements of a mesh.
+ * \param [in]      mesh      A mesh.
+ * \return                    The number of local elements. The local
+ *                            element ids are the local element ids of
+ *                            the forest.
  */
-void                t8_mesh_build (t8_mesh_t * mesh);
+t8_locidx_t         t8_mesh_get_num_elements (t8_mesh_t * mesh);
 
-/****************************** queries *************************/
+/** Return the number of local nodes of a mesh, that is the number of
+ * nodes of the local elements.
+ * The owned nodes come first.
+ * \param [in]      mesh      A mesh.
+ * \return                    The number of local nodes.
+ */
+t8_locidx_t         t8_mesh_get_num_nodes (t8_mesh_t * mesh);
 
-sc_MPI_Comm         t8_mesh_get_comm (t8_mesh_t * mesh);
+/** Return the number of local nodes of a mesh that this process owns.
+ * \param [in]      mesh      A mesh.
+ * \return                    The number of owned nodes. These are the
+ *                            local nodes 0, ..., num_owned_nodes - 1.
+ */
+t8_locidx_t         t8_mesh_get_num_owned_nodes (t8_mesh_t * mesh);
 
-t8_locidx_t         t8_mesh_get_element_count (t8_mesh_t * mesh,
-                                               t8_eclass_t theclass);
+/** Return the global number of nodes of a mesh.
+ * \param [in]      mesh      A mesh.
+ * \return                    The number of nodes on all processes.
+ */
+t8_gloidx_t         t8_mesh_get_global_num_nodes (t8_mesh_t * mesh);
 
-/** 
- * \param [in] locid            The local number can specify a point of any
- *                              dimension that is locally relevant.
- *                              The points are ordered in reverse to the
- *                              element classes in \ref t8_eclass_t.  The local
- *                              index is cumulative in this order.
+/** Return the shape of a local element.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      locid     A local element id.
+ * \return                    The shape of the element.
  */
-t8_locidx_t         t8_mesh_get_element_class (t8_mesh_t * mesh,
+t8_element_shape_t  t8_mesh_get_element_class (t8_mesh_t * mesh,
                                                t8_locidx_t locid);
 
-t8_locidx_t         t8_mesh_get_element_locid (t8_mesh_t * mesh,
-                                               t8_gloidx_t gloid);
-
+/** Return the global id of a local element.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      locid     A local element id.
+ * \return                    The global element id in the forest.
+ */
 t8_gloidx_t         t8_mesh_get_element_gloid (t8_mesh_t * mesh,
                                                t8_locidx_t locid);
 
-t8_element_t        t8_mesh_get_element (t8_mesh_t * mesh, t8_locidx_t locid);
+/** Return the nodes of a local element.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      locid     A local element id.
+ * \param [out]     num_nodes The number of corners of the element.
+ * \return                    The local node ids of the corners of the
+ *                            element in t8code corner order. Use
+ *                            \ref t8_eclass_vtk_corner_number for the
+ *                            vtk order.
+ */
+const t8_locidx_t  *t8_mesh_get_element_nodes (t8_mesh_t * mesh,
+                                               t8_locidx_t locid,
+                                               int *num_nodes);
+
+/** Return the global id of a local node.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      lnode     A local node id.
+ * \return                    The global id of the node.
+ */
+t8_gloidx_t         t8_mesh_get_node_gloid (t8_mesh_t * mesh,
+                                            t8_locidx_t lnode);
+
+/** Return the owner process of a local node.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      lnode     A local node id.
+ * \return                    The rank of the process that owns the node.
+ */
+int                 t8_mesh_get_node_owner (t8_mesh_t * mesh,
+                                            t8_locidx_t lnode);
 
-void                t8_mesh_get_element_boundary (t8_mesh_t * mesh,
-                                                  t8_locidx_t locid,
-                                                  int length_boundary,
-                                                  t8_locidx_t * elemid,
-                                                  int *orientation);
+/** Return the coordinates of a local node.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      lnode     A local node id.
+ * \return                    The x, y and z coordinates of the node.
+ */
+const double       *t8_mesh_get_node_coordinates (t8_mesh_t * mesh,
+                                                  t8_locidx_t lnode);
 
-/** Return the maximum of the length of the support of any local element.
+/** Return the maximum of the length of the support of any local node.
+ * \param [in]      mesh      A mesh.
+ * \return                    The maximum number of local elements that
+ *                            contain the same node.
  */
 int                 t8_mesh_get_maximum_support (t8_mesh_t * mesh);
 
-/**
- * \param [in,out] length_support
+/** Return the support of a local node, that is the local elements that
+ * contain the node.
+ * \param [in]      mesh      A mesh.
+ * \param [in]      lnode     A local node id.
+ * \param [out]     length_support The number of local elements containing
+ *                            the node.
+ * \return                    The local ids of these elements in ascending
+ *                            order.
  */
-void                t8_mesh_get_element_support (t8_mesh_t * mesh,
-                                                 t8_locidx_t locid,
-                                                 int *length_support,
-                                                 t8_locidx_t * elemid,
-                                                 int *orientation);
+const t8_locidx_t  *t8_mesh_get_node_support (t8_mesh_t * mesh,
+                                              t8_locidx_t lnode,
+                                              int *length_support);
 
 /***************************** destruct *************************/
 
+/** Free the memory of a mesh.
+ * \param [in,out]  mesh      A mesh built with \ref t8_mesh_new_from_forest.
+ */
 void                t8_mesh_destroy (t8_mesh_t * mesh);
 
+T8_EXTERN_C_END ();
+
 #endif /* !T8_MESH_H */
@@ -42,6 +42,54 @@ t8_refcount_new (void)
 void
 t8_refcount_destroy (t8_refcount_t * rc)
 {
-  T8_ASSERT (!sc_refcount_is_active (rc));
+  T8_ASSERT (!t8_refcount_is_active (rc));
   T8_FREE (rc);
 }
+
+#ifdef T8_ENABLE_ATOMIC_REFCOUNT
+
+#ifndef __GNUC__
+#error "--enable-atomic-refcount requires the __atomic compiler builtins"
+#endif
+
+void
+t8_refcount_ref (t8_refcount_t * rc)
+{
+  T8_ASSERT (rc->package_id == t8_get_package_id ());
+  T8_ASSERT (t8_refcount_is_active (rc));
+
+  /* Taking a new reference requires holding one already, so there is
+   * nothing to synchronize with. */
+  (void) __atomic_fetch_add (&rc->refcount, 1, __ATOMIC_RELAXED);
+}
+
+int
+t8_refcount_unref (t8_refcount_t * rc)
+{
+  int                 remaining;
+
+  T8_ASSERT (rc->package_id == t8_get_package_id ());
+  T8_ASSERT (t8_refcount_is_active (rc));
+
+  /* The release makes our accesses to the object visible to the thread that
+   * drops the last reference, the acquire lets that thread see all of them
+   * before it destroys the object. */
+  remaining = __atomic_sub_fetch (&rc->refcount, 1, __ATOMIC_ACQ_REL);
+  T8_ASSERT (remaining >= 0);
+
+  return remaining == 0;
+}
+
+int
+t8_refcount_is_active (const t8_refcount_t * rc)
+{
+  return __atomic_load_n (&rc->refcount, __ATOMIC_ACQUIRE) > 0;
+}
+
+int
+t8_refcount_is_last (const t8_refcount_t * rc)
+{
+  return __atomic_load_n (&rc->refcount, __ATOMIC_ACQUIRE) == 1;
+}
+
+#endif /* T8_ENABLE_ATOMIC_REFCOUNT */
@@ -25,6 +25,11 @@
  * We inherit the reference counting mechanism from libsc.
  * The only customization is to pass the package id of the t8code.
  * This file is compatible with sc_refcount_ref and sc_refcount_unref.
+ *
+ * If t8code is configured with --enable-atomic-refcount, the counter is
+ * modified with atomic operations.  Then threads may ref and unref the
+ * same forest, cmesh or ghost layer concurrently without external locking.
+ * The object itself is not protected; it must only be read while shared.
  */
 
 #ifndef T8_REFCOUNT_H
@@ -57,6 +62,30 @@ t8_refcount_t      *t8_refcount_new (void);
  */
 void                t8_refcount_destroy (t8_refcount_t * rc);
 
+#ifdef T8_ENABLE_ATOMIC_REFCOUNT
+
+/** Atomically increase the reference count by one.
+ * The count must be greater zero on input.
+ * \param [in,out] rc      A valid reference counter.
+ */
+void                t8_refcount_ref (t8_refcount_t * rc);
+
+/** Atomically decrease the reference count by one.
+ * The count must be greater zero on input.  Exactly one of several threads
+ * that unref the same counter concurrently observes the zero count.
+ * \param [in,out] rc      A valid reference counter.
+ * \return                 True if the count has reached zero.
+ */
+int                 t8_refcount_unref (t8_refcount_t * rc);
+
+/** Query wether a reference counter is has a positive value. */
+int                 t8_refcount_is_active (const t8_refcount_t * rc);
+
+/** Query wether a reference counter has value one. */
+int                 t8_refcount_is_last (const t8_refcount_t * rc);
+
+#else
+
 /** Increase the reference count by one.
  * It is not necessary to duplicate this functionality as a function. */
 #define t8_refcount_ref(rc) sc_refcount_ref(rc)
@@ -76,6 +105,8 @@ void                t8_refcount_destroy (t8_refcount_t * rc);
 /** Query wether a reference counter has value one. */
 #define t8_refcount_is_last(rc) sc_refcount_is_last(rc)
 
+#endif /* !T8_ENABLE_ATOMIC_REFCOUNT */
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_REFCOUNT_H */
@@ -0,0 +1,1108 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <p4est.h>
+#include <p8est.h>
+#include <sc_functions.h>
+#include "t8_dline_bits.h"
+#include "t8_default_common_cxx.hxx"
+#include "t8_default_aniso_cxx.hxx"
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* Return the length of an element of a given level in one direction */
+#define T8_DANISO_LEN(root_level,level) (1 << ((root_level) - (level)))
+
+/* Return the number of set bits of a refinement mask */
+static inline int
+t8_daniso_popcount (int mask)
+{
+  int                 count = 0;
+
+  for (; mask != 0; mask >>= 1) {
+    count += mask & 1;
+  }
+  return count;
+}
+
+/* Return the refinement mask of the step from level - 1 to level */
+static inline int
+t8_daniso_step_mask (const t8_daniso_t * a, int dim, int level)
+{
+  T8_ASSERT (1 <= level && level <= a->level);
+  return (int) ((a->history >> (dim * (level - 1))) & ((1 << dim) - 1));
+}
+
+/* Return true if two elements have the same position and history */
+static int
+t8_daniso_equal (const t8_daniso_t * a, const t8_daniso_t * b)
+{
+  return a->level == b->level && a->history == b->history
+    && a->coords[0] == b->coords[0] && a->coords[1] == b->coords[1]
+    && a->coords[2] == b->coords[2];
+}
+
+/* Set an element to the root element */
+static void
+t8_daniso_root (t8_daniso_t * a)
+{
+  a->history = 0;
+  a->coords[0] = a->coords[1] = a->coords[2] = 0;
+  a->level = 0;
+  a->dlevel[0] = a->dlevel[1] = a->dlevel[2] = 0;
+}
+
+/* Compute the parent of an element by undoing its last refinement step.
+ * a and p may point to the same element. */
+static void
+t8_daniso_parent (const t8_daniso_t * a, t8_daniso_t * p, int dim,
+                  int root_level)
+{
+  t8_daniso_t         tmp = *a;
+  int                 mask, i;
+
+  T8_ASSERT (a->level > 0);
+  mask = t8_daniso_step_mask (a, dim, a->level);
+  for (i = 0; i < dim; i++) {
+    if (mask & (1 << i)) {
+      tmp.coords[i] &= ~T8_DANISO_LEN (root_level, tmp.dlevel[i]);
+      tmp.dlevel[i]--;
+    }
+  }
+  tmp.history &= ~((uint64_t) ((1 << dim) - 1) << (dim * (a->level - 1)));
+  tmp.level--;
+  *p = tmp;
+}
+
+/* Return the child id of an element with respect to its last refinement */
+static int
+t8_daniso_child_id (const t8_daniso_t * a, int dim, int root_level)
+{
+  int                 mask, i, k, id;
+
+  if (a->level == 0) {
+    return 0;
+  }
+  mask = t8_daniso_step_mask (a, dim, a->level);
+  for (i = 0, k = 0, id = 0; i < dim; i++) {
+    if (mask & (1 << i)) {
+      if (a->coords[i] & T8_DANISO_LEN (root_level, a->dlevel[i])) {
+        id |= 1 << k;
+      }
+      k++;
+    }
+  }
+  return id;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_refine_mask (const t8_daniso_t * a) const
+{
+  const int           full = (1 << dim) - 1;
+  int                 coords[3], levels[3];
+  int                 mask, i;
+
+  if (direction == NULL) {
+    return full;
+  }
+  for (i = 0; i < 3; i++) {
+    coords[i] = a->coords[i];
+    levels[i] = a->dlevel[i];
+  }
+  mask = direction (dim, 1 << root_level, coords, levels, user_data) & full;
+  /* An empty mask refines isotropically */
+  return mask != 0 ? mask : full;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_mask_child (const t8_daniso_t * a,
+                                                  int mask, int childid,
+                                                  t8_daniso_t * c) const
+{
+  t8_daniso_t         tmp = *a;
+  int                 i, k;
+
+  T8_ASSERT (a->level < max_level);
+  T8_ASSERT (0 < mask && mask < 1 << dim);
+  T8_ASSERT (0 <= childid && childid < 1 << t8_daniso_popcount (mask));
+  for (i = 0, k = 0; i < dim; i++) {
+    if (mask & (1 << i)) {
+      tmp.dlevel[i]++;
+      if (childid & (1 << k)) {
+        tmp.coords[i] |= T8_DANISO_LEN (root_level, tmp.dlevel[i]);
+      }
+      k++;
+    }
+  }
+  tmp.history |= (uint64_t) mask << (dim * a->level);
+  tmp.level++;
+  *c = tmp;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_ancestor (const t8_daniso_t * a,
+                                                int level,
+                                                t8_daniso_t * anc) const
+{
+  T8_ASSERT (0 <= level && level <= a->level);
+  *anc = *a;
+  while (anc->level > level) {
+    t8_daniso_parent (anc, anc, dim, root_level);
+  }
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_face_descendant (const t8_daniso_t * a,
+                                                       int face, int last,
+                                                       t8_daniso_t * desc,
+                                                       int level) const
+{
+  t8_daniso_t         tmp = *a;
+  int                 mask, childid, normal, k;
+
+  T8_ASSERT (a->level <= level && level <= max_level);
+  while (tmp.level < level) {
+    mask = t8_element_refine_mask (&tmp);
+    childid = last ? (1 << t8_daniso_popcount (mask)) - 1 : 0;
+    if (face >= 0 && (mask & (1 << (face >> 1)))) {
+      /* The child has to be on the side of the face in normal direction */
+      normal = face >> 1;
+      k = t8_daniso_popcount (mask & ((1 << normal) - 1));
+      childid = (childid & ~(1 << k)) | ((face & 1) << k);
+    }
+    t8_element_mask_child (&tmp, mask, childid, &tmp);
+  }
+  *desc = tmp;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_locate (const int point[3], int level,
+                                              const int *dlevels,
+                                              t8_daniso_t * a) const
+{
+  int                 mask, childid, i, k, refine;
+
+  T8_ASSERT (0 <= level && level <= max_level);
+  t8_daniso_root (a);
+  while (a->level < level) {
+    if (dlevels != NULL) {
+      for (i = 0, refine = 0; i < dim; i++) {
+        refine = refine || (dlevels[i] >= 0 && a->dlevel[i] < dlevels[i]);
+      }
+      if (!refine) {
+        return;
+      }
+    }
+    mask = t8_element_refine_mask (a);
+    for (i = 0, k = 0, childid = 0; i < dim; i++) {
+      if (mask & (1 << i)) {
+        if (point[i] & T8_DANISO_LEN (root_level, a->dlevel[i] + 1)) {
+          childid |= 1 << k;
+        }
+        k++;
+      }
+    }
+    t8_element_mask_child (a, mask, childid, a);
+  }
+}
+
+t8_gloidx_t
+  t8_default_scheme_aniso_c::t8_element_count_descendants (const t8_daniso_t *
+                                                           a, int level) const
+{
+  t8_daniso_t         child;
+  t8_gloidx_t         count;
+  int                 mask, num_children, ichild;
+
+  if (a->level >= level) {
+    return a->level == level;
+  }
+  mask = t8_element_refine_mask (a);
+  num_children = 1 << t8_daniso_popcount (mask);
+  for (ichild = 0, count = 0; ichild < num_children; ichild++) {
+    t8_element_mask_child (a, mask, ichild, &child);
+    count += t8_element_count_descendants (&child, level);
+  }
+  return count;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_direction_level (const t8_element_t *
+                                                       elem, int dir) const
+{
+  T8_ASSERT (0 <= dir && dir < dim);
+  return ((const t8_daniso_t *) elem)->dlevel[dir];
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_maxlevel (void)
+{
+  return max_level;
+}
+
+/* *INDENT-OFF* */
+t8_eclass_t
+t8_default_scheme_aniso_c::t8_element_child_eclass (int childid)
+/* *INDENT-ON* */
+
+{
+  T8_ASSERT (0 <= childid && childid < 1 << dim);
+
+  return eclass;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_level (const t8_element_t * elem)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  return (int) ((const t8_daniso_t *) elem)->level;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_copy (const t8_element_t * source,
+                                            t8_element_t * dest)
+{
+  T8_ASSERT (t8_element_is_valid (source));
+  if (source == dest) {
+    return;
+  }
+  *(t8_daniso_t *) dest = *(const t8_daniso_t *) source;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_compare (const t8_element_t * elem1,
+                                               const t8_element_t * elem2)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem1;
+  const t8_daniso_t  *b = (const t8_daniso_t *) elem2;
+  t8_linearidx_t      id_a, id_b;
+  int                 level;
+
+  T8_ASSERT (t8_element_is_valid (elem1));
+  T8_ASSERT (t8_element_is_valid (elem2));
+  level = SC_MAX (a->level, b->level);
+  id_a = t8_element_get_linear_id (elem1, level);
+  id_b = t8_element_get_linear_id (elem2, level);
+  if (id_a == id_b) {
+    /* An ancestor is smaller than its descendants */
+    return a->level - b->level;
+  }
+  return id_a < id_b ? -1 : 1;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_parent (const t8_element_t * elem,
+                                              t8_element_t * parent)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  t8_daniso_parent ((const t8_daniso_t *) elem, (t8_daniso_t *) parent, dim,
+                    root_level);
+}
+
+/* *INDENT-OFF* */
+/* Indent bug: indent adds an additional const */
+int
+t8_default_scheme_aniso_c::t8_element_num_siblings (const t8_element_t * elem) const
+/* *INDENT-ON* */
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+
+  if (a->level == 0) {
+    return 1;
+  }
+  return 1 << t8_daniso_popcount (t8_daniso_step_mask (a, dim, a->level));
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_sibling (const t8_element_t * elem,
+                                               int sibid,
+                                               t8_element_t * sibling)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  t8_daniso_t         parent;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (a->level > 0);
+  t8_daniso_parent (a, &parent, dim, root_level);
+  t8_element_mask_child (&parent, t8_daniso_step_mask (a, dim, a->level),
+                         sibid, (t8_daniso_t *) sibling);
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_num_faces (const t8_element_t * elem)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  return 2 * dim;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_max_num_faces (const t8_element_t *
+                                                     elem)
+{
+  return 2 * dim;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_num_children (const t8_element_t * elem)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  return 1 << t8_daniso_popcount (t8_element_refine_mask
+                                  ((const t8_daniso_t *) elem));
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_num_face_children (const t8_element_t *
+                                                         elem, int face)
+{
+  int                 mask;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  mask = t8_element_refine_mask ((const t8_daniso_t *) elem);
+  return 1 << t8_daniso_popcount (mask & ~(1 << (face >> 1)));
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_get_face_corner (const t8_element_t *
+                                                       element, int face,
+                                                       int corner)
+{
+  /* The corners and faces are numbered as for the isotropic elements */
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  T8_ASSERT (0 <= corner && corner < 1 << (dim - 1));
+  return dim == 2 ? p4est_face_corners[face][corner]
+    : p8est_face_corners[face][corner];
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_get_corner_face (const t8_element_t *
+                                                       element, int corner,
+                                                       int face)
+{
+  T8_ASSERT (t8_element_is_valid (element));
+  T8_ASSERT (0 <= corner && corner < 1 << dim);
+  T8_ASSERT (0 <= face && face < dim);
+  return dim == 2 ? p4est_corner_faces[corner][face]
+    : p8est_corner_faces[corner][face];
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_child (const t8_element_t * elem,
+                                             int childid,
+                                             t8_element_t * child)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  t8_element_mask_child (a, t8_element_refine_mask (a), childid,
+                         (t8_daniso_t *) child);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_children (const t8_element_t * elem,
+                                                int length,
+                                                t8_element_t * c[])
+{
+  /* Copy the element since it may be the same as the first child */
+  const t8_daniso_t   a = *(const t8_daniso_t *) elem;
+  int                 mask, ichild;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  mask = t8_element_refine_mask (&a);
+  T8_ASSERT (length == 1 << t8_daniso_popcount (mask));
+  for (ichild = 0; ichild < length; ichild++) {
+    t8_element_mask_child (&a, mask, ichild, (t8_daniso_t *) c[ichild]);
+  }
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_child_id (const t8_element_t * elem)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  return t8_daniso_child_id ((const t8_daniso_t *) elem, dim, root_level);
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_ancestor_id (const t8_element_t * elem,
+                                                   int level)
+{
+  t8_daniso_t         anc;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  t8_element_ancestor ((const t8_daniso_t *) elem, level, &anc);
+  return t8_daniso_child_id (&anc, dim, root_level);
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_is_family (t8_element_t ** fam)
+{
+  const t8_daniso_t  *first = (const t8_daniso_t *) fam[0];
+  const t8_daniso_t  *a;
+  t8_daniso_t         parent, p;
+  int                 num_siblings, isib;
+
+  T8_ASSERT (t8_element_is_valid (fam[0]));
+  if (first->level == 0) {
+    return 0;
+  }
+  num_siblings = t8_element_num_siblings (fam[0]);
+  t8_daniso_parent (first, &parent, dim, root_level);
+  for (isib = 0; isib < num_siblings; isib++) {
+    a = (const t8_daniso_t *) fam[isib];
+    T8_ASSERT (t8_element_is_valid (fam[isib]));
+    if (a->level != first->level || a->history != first->history) {
+      return 0;
+    }
+    t8_daniso_parent (a, &p, dim, root_level);
+    if (!t8_daniso_equal (&p, &parent)
+        || t8_daniso_child_id (a, dim, root_level) != isib) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_nca (const t8_element_t * elem1,
+                                           const t8_element_t * elem2,
+                                           t8_element_t * nca)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem1;
+  const t8_daniso_t  *b = (const t8_daniso_t *) elem2;
+  t8_daniso_t         anc_a, anc_b;
+  int                 level;
+
+  T8_ASSERT (t8_element_is_valid (elem1));
+  T8_ASSERT (t8_element_is_valid (elem2));
+  /* The root is a common ancestor of all elements */
+  for (level = SC_MIN (a->level, b->level); level > 0; level--) {
+    t8_element_ancestor (a, level, &anc_a);
+    t8_element_ancestor (b, level, &anc_b);
+    if (t8_daniso_equal (&anc_a, &anc_b)) {
+      break;
+    }
+  }
+  t8_element_ancestor (a, level, (t8_daniso_t *) nca);
+}
+
+t8_element_shape_t
+  t8_default_scheme_aniso_c::t8_element_face_shape (const t8_element_t * elem,
+                                                    int face)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  return dim == 2 ? T8_ECLASS_LINE : T8_ECLASS_QUAD;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_children_at_face (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_element_t *
+                                                        children[],
+                                                        int num_children,
+                                                        int *child_indices)
+{
+  /* Copy the element since it may be the same as the first child */
+  const t8_daniso_t   a = *(const t8_daniso_t *) elem;
+  const int           normal = face >> 1;
+  int                 mask, k, ichild, iface_child, num_all;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  mask = t8_element_refine_mask (&a);
+  num_all = 1 << t8_daniso_popcount (mask);
+  /* The position of the normal direction's bit in the child ids */
+  k = t8_daniso_popcount (mask & ((1 << normal) - 1));
+  for (ichild = 0, iface_child = 0; ichild < num_all; ichild++) {
+    if ((mask & (1 << normal)) && ((ichild >> k) & 1) != (face & 1)) {
+      /* This child does not touch the face */
+      continue;
+    }
+    T8_ASSERT (iface_child < num_children);
+    if (child_indices != NULL) {
+      child_indices[iface_child] = ichild;
+    }
+    t8_element_mask_child (&a, mask, ichild,
+                           (t8_daniso_t *) children[iface_child]);
+    iface_child++;
+  }
+  T8_ASSERT (iface_child == num_children);
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_face_child_face (const t8_element_t *
+                                                       elem, int face,
+                                                       int face_child)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  /* The face of the child is the same as the face of the parent */
+  return face;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_face_parent_face (const t8_element_t *
+                                                        elem, int face)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  const int           normal = face >> 1;
+  int                 upper;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  if (a->level == 0) {
+    return face;
+  }
+  if (t8_daniso_step_mask (a, dim, a->level) & (1 << normal)) {
+    /* The element was split in normal direction, it lies at the face of
+     * its parent only if it is on the same side. */
+    upper = (a->coords[normal]
+             & T8_DANISO_LEN (root_level, a->dlevel[normal])) != 0;
+    if (upper != (face & 1)) {
+      return -1;
+    }
+  }
+  return face;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_transform_face (const t8_element_t *
+                                                      elem1,
+                                                      t8_element_t * elem2,
+                                                      int orientation,
+                                                      int sign,
+                                                      int is_smaller_face)
+{
+  const int           root_len = 1 << root_level;
+  t8_daniso_t         q = *(const t8_daniso_t *) elem1;
+  t8_daniso_t        *p = (t8_daniso_t *) elem2;
+  int                 swap, hx, hy, s, mask, x;
+
+  T8_ASSERT (dim == 2);
+  T8_ASSERT (t8_element_is_valid (elem1));
+  T8_ASSERT (0 <= orientation && orientation < P4EST_FACES);
+
+  /* See t8_default_scheme_quad_c::t8_element_transform_face for the
+   * meaning of orientation and sign. */
+  if (!is_smaller_face && (orientation == 1 || orientation == 2) && !sign) {
+    orientation = 3 - orientation;
+  }
+  swap = sign;
+  if (sign) {
+    x = q.coords[0];
+    q.coords[0] = q.coords[1];
+    q.coords[1] = x;
+  }
+  hx = T8_DANISO_LEN (root_level, sign ? q.dlevel[1] : q.dlevel[0]);
+  hy = T8_DANISO_LEN (root_level, sign ? q.dlevel[0] : q.dlevel[1]);
+  switch (orientation) {
+  case 0:
+    p->coords[0] = q.coords[0];
+    p->coords[1] = q.coords[1];
+    break;
+  case 1:
+    p->coords[0] = root_len - q.coords[1] - hy;
+    p->coords[1] = q.coords[0];
+    swap = !swap;
+    break;
+  case 2:
+    p->coords[0] = q.coords[1];
+    p->coords[1] = root_len - q.coords[0] - hx;
+    swap = !swap;
+    break;
+  case 3:
+    p->coords[0] = root_len - q.coords[0] - hx;
+    p->coords[1] = root_len - q.coords[1] - hy;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  p->coords[2] = 0;
+  p->level = q.level;
+  p->dlevel[0] = swap ? q.dlevel[1] : q.dlevel[0];
+  p->dlevel[1] = swap ? q.dlevel[0] : q.dlevel[1];
+  p->dlevel[2] = 0;
+  p->history = q.history;
+  if (swap) {
+    /* Exchange the x and y bits of each refinement step */
+    for (s = 0, p->history = 0; s < q.level; s++) {
+      mask = (int) ((q.history >> (2 * s)) & 3);
+      mask = ((mask & 1) << 1) | (mask >> 1);
+      p->history |= (uint64_t) mask << (2 * s);
+    }
+  }
+  T8_ASSERT (t8_element_is_valid (elem2));
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_extrude_face (const t8_element_t * face,
+                                                    const t8_eclass_scheme_c *
+                                                    face_scheme,
+                                                    t8_element_t * elem,
+                                                    int root_face)
+{
+  const int           normal = root_face >> 1;
+  int                 point[3] = { 0, 0, 0 };
+  int                 dlevels[3];
+  int                 t0, t1;
+
+  T8_ASSERT (0 <= root_face && root_face < 2 * dim);
+  T8_ASSERT (face_scheme->t8_element_is_valid (face));
+  if (dim == 2) {
+    const t8_dline_t   *l = (const t8_dline_t *) face;
+
+    T8_ASSERT (face_scheme->eclass == T8_ECLASS_LINE);
+    /* The tangential direction of faces 0, 1 is y, of faces 2, 3 x */
+    t0 = normal ? 0 : 1;
+    point[t0] = ((int64_t) l->x << root_level) / T8_DLINE_ROOT_LEN;
+    dlevels[t0] = l->level;
+  }
+  else {
+    const t8_daniso_t  *b = (const t8_daniso_t *) face;
+
+    T8_ASSERT (T8_COMMON_IS_TYPE
+               (face_scheme, const t8_default_scheme_aniso_c *));
+    T8_ASSERT (face_scheme->eclass == T8_ECLASS_QUAD);
+    /* The face coordinates are (y, z), (x, z) and (x, y) for the faces
+     * normal to x, y and z, see t8_element_boundary_face */
+    t0 = normal ? 0 : 1;
+    t1 = normal == 2 ? 1 : 2;
+    point[t0] = b->coords[0] / (P4EST_ROOT_LEN / P8EST_ROOT_LEN);
+    point[t1] = b->coords[1] / (P4EST_ROOT_LEN / P8EST_ROOT_LEN);
+    dlevels[t0] = b->dlevel[0];
+    dlevels[t1] = b->dlevel[1];
+  }
+  point[normal] = root_face & 1 ? (1 << root_level) - 1 : 0;
+  dlevels[normal] = -1;
+  /* Refine the root along the refinement tree until the element's face
+   * is at least as fine as the given face */
+  t8_element_locate (point, max_level, dlevels, (t8_daniso_t *) elem);
+  /* The face of the element is the same as the root face */
+  return root_face;
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_tree_face (const t8_element_t * elem,
+                                                 int face)
+{
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  /* The faces are numbered as the faces of the tree */
+  return face;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_first_descendant_face (const
+                                                             t8_element_t *
+                                                             elem, int face,
+                                                             t8_element_t *
+                                                             first_desc,
+                                                             int level)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  t8_element_face_descendant ((const t8_daniso_t *) elem, face, 0,
+                              (t8_daniso_t *) first_desc, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_last_descendant_face (const
+                                                            t8_element_t *
+                                                            elem, int face,
+                                                            t8_element_t *
+                                                            last_desc,
+                                                            int level)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  t8_element_face_descendant ((const t8_daniso_t *) elem, face, 1,
+                              (t8_daniso_t *) last_desc, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_boundary_face (const t8_element_t *
+                                                     elem, int face,
+                                                     t8_element_t * boundary,
+                                                     const t8_eclass_scheme_c
+                                                     * boundary_scheme)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  const int           normal = face >> 1;
+  int                 t0, t1, s, isotropic;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  if (dim == 2) {
+    t8_dline_t         *l = (t8_dline_t *) boundary;
+
+    T8_ASSERT (boundary_scheme->eclass == T8_ECLASS_LINE);
+    t0 = normal ? 0 : 1;
+    l->level = a->dlevel[t0];
+    l->x = ((int64_t) a->coords[t0] * T8_DLINE_ROOT_LEN) >> root_level;
+  }
+  else {
+    t8_daniso_t        *b = (t8_daniso_t *) boundary;
+
+    T8_ASSERT (T8_COMMON_IS_TYPE
+               (boundary_scheme, const t8_default_scheme_aniso_c *));
+    T8_ASSERT (boundary_scheme->eclass == T8_ECLASS_QUAD);
+    /* If face = 0 or face = 1 then b->x = a->y, b->y = a->z,
+     * if face = 2 or face = 3 then b->x = a->x, b->y = a->z,
+     * if face = 4 or face = 5 then b->x = a->x, b->y = a->y.
+     * We scale the coordinates to the root length of the quadrilaterals. */
+    t0 = normal ? 0 : 1;
+    t1 = normal == 2 ? 1 : 2;
+    b->coords[0] = a->coords[t0] * (P4EST_ROOT_LEN / P8EST_ROOT_LEN);
+    b->coords[1] = a->coords[t1] * (P4EST_ROOT_LEN / P8EST_ROOT_LEN);
+    b->coords[2] = 0;
+    b->dlevel[0] = a->dlevel[t0];
+    b->dlevel[1] = a->dlevel[t1];
+    b->dlevel[2] = 0;
+    /* The face's own refinement steps are not known, we refine it
+     * isotropically first and then in the finer direction */
+    b->level = SC_MAX (b->dlevel[0], b->dlevel[1]);
+    isotropic = SC_MIN (b->dlevel[0], b->dlevel[1]);
+    for (s = 0, b->history = 0; s < b->level; s++) {
+      b->history |= (uint64_t) (s < isotropic ? 3 :
+                                b->dlevel[0] > b->dlevel[1] ? 1 : 2)
+        << (2 * s);
+    }
+    T8_ASSERT (boundary_scheme->t8_element_is_valid (boundary));
+  }
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_boundary (const t8_element_t * elem,
+                                                int min_dim, int length,
+                                                t8_element_t ** boundary)
+{
+  SC_ABORT ("Not implemented\n");
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_is_root_boundary (const t8_element_t *
+                                                        elem, int face)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  const int           normal = face >> 1;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  return a->coords[normal] == (face & 1 ? (1 << root_level)
+                               - T8_DANISO_LEN (root_level,
+                                                a->dlevel[normal]) : 0);
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_face_neighbor_inside (const
+                                                            t8_element_t *
+                                                            elem,
+                                                            t8_element_t *
+                                                            neigh, int face,
+                                                            int *neigh_face)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  const int           normal = face >> 1;
+  t8_daniso_t         shifted = *a;
+  int                 len, point[3];
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < 2 * dim);
+  T8_ASSERT (neigh_face != NULL);
+  len = T8_DANISO_LEN (root_level, a->dlevel[normal]);
+  shifted.coords[normal] += face & 1 ? len : -len;
+  *neigh_face = face ^ 1;
+  if (shifted.coords[normal] < 0
+      || shifted.coords[normal] >= 1 << root_level) {
+    /* The neighbor is outside of the root, we keep the shifted element */
+    *(t8_daniso_t *) neigh = shifted;
+    return 0;
+  }
+  /* Find the element of the same level in the refinement tree */
+  point[0] = shifted.coords[0];
+  point[1] = shifted.coords[1];
+  point[2] = shifted.coords[2];
+  t8_element_locate (point, a->level, NULL, (t8_daniso_t *) neigh);
+  return 1;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_set_linear_id (t8_element_t * elem,
+                                                     int level,
+                                                     t8_linearidx_t id)
+{
+  t8_daniso_t        *a = (t8_daniso_t *) elem;
+  const int           full = (1 << dim) - 1;
+  int                 l;
+
+  T8_ASSERT (0 <= level && level <= max_level);
+  T8_ASSERT (id < ((t8_linearidx_t) 1) << (dim * level));
+  /* The linear ids are the Morton indices of the isotropic refinement */
+  t8_daniso_root (a);
+  for (l = 1; l <= level; l++) {
+    t8_element_mask_child (a, full, (int) ((id >> (dim * (level - l)))
+                                           & full), a);
+  }
+  T8_ASSERT (t8_element_is_valid (elem));
+}
+
+t8_linearidx_t
+  t8_default_scheme_aniso_c::t8_element_get_linear_id (const t8_element_t *
+                                                       elem, int level)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  t8_linearidx_t      id = 0;
+  int                 lev[3] = { 0, 0, 0 };
+  int                 num_steps, s, i, mask, digit;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= level && level <= max_level);
+  num_steps = SC_MIN (level, a->level);
+  for (s = 1; s <= num_steps; s++) {
+    mask = t8_daniso_step_mask (a, dim, s);
+    for (i = 0, digit = 0; i < dim; i++) {
+      if (mask & (1 << i)) {
+        lev[i]++;
+        if (a->coords[i] & T8_DANISO_LEN (root_level, lev[i])) {
+          digit |= 1 << i;
+        }
+      }
+    }
+    id = (id << dim) | digit;
+  }
+  /* Finer levels contribute the first descendant */
+  return id << (dim * (level - num_steps));
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_first_descendant (const t8_element_t *
+                                                        elem,
+                                                        t8_element_t * desc,
+                                                        int level)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  t8_element_face_descendant ((const t8_daniso_t *) elem, -1, 0,
+                              (t8_daniso_t *) desc, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_last_descendant (const t8_element_t *
+                                                       elem,
+                                                       t8_element_t * desc,
+                                                       int level)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  t8_element_face_descendant ((const t8_daniso_t *) elem, -1, 1,
+                              (t8_daniso_t *) desc, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_successor (const t8_element_t * elem,
+                                                 t8_element_t * s, int level)
+{
+  t8_daniso_t         a = *(const t8_daniso_t *) elem;
+  t8_daniso_t         parent;
+  int                 child_id, mask;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (a.level == level);
+  /* Go up to the first ancestor that is not the last child */
+  child_id = t8_daniso_child_id (&a, dim, root_level);
+  while (a.level > 0
+         && child_id == t8_element_num_siblings ((t8_element_t *) & a) - 1) {
+    t8_daniso_parent (&a, &a, dim, root_level);
+    child_id = t8_daniso_child_id (&a, dim, root_level);
+  }
+  SC_CHECK_ABORT (a.level > 0, "The last element has no successor");
+  /* Take the next sibling of this ancestor and its first descendant */
+  mask = t8_daniso_step_mask (&a, dim, a.level);
+  t8_daniso_parent (&a, &parent, dim, root_level);
+  t8_element_mask_child (&parent, mask, child_id + 1, &a);
+  t8_element_face_descendant (&a, -1, 0, (t8_daniso_t *) s, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_anchor (const t8_element_t * elem,
+                                              int anchor[3])
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  anchor[0] = a->coords[0];
+  anchor[1] = a->coords[1];
+  anchor[2] = a->coords[2];
+}
+
+int
+t8_default_scheme_aniso_c::t8_element_root_len (const t8_element_t * elem)
+{
+  return 1 << root_level;
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_vertex_coords (const t8_element_t * t,
+                                                     int vertex,
+                                                     int coords[])
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) t;
+  int                 i;
+
+  T8_ASSERT (t8_element_is_valid (t));
+  T8_ASSERT (0 <= vertex && vertex < 1 << dim);
+  /* Bit i of the vertex number is its position in direction i */
+  for (i = 0; i < dim; i++) {
+    coords[i] = a->coords[i]
+      + ((vertex >> i) & 1) * T8_DANISO_LEN (root_level, a->dlevel[i]);
+  }
+}
+
+t8_gloidx_t
+  t8_default_scheme_aniso_c::t8_element_count_leafs (const t8_element_t * t,
+                                                     int level)
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) t;
+
+  T8_ASSERT (t8_element_is_valid (t));
+  if (a->level > level) {
+    return 0;
+  }
+  if (direction == NULL) {
+    return sc_intpow64 (2, dim * (level - a->level));
+  }
+  return t8_element_count_descendants (a, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_descendant_range (const t8_element_t *
+                                                        elem, int level,
+                                                        t8_linearidx_t *
+                                                        first_id,
+                                                        t8_linearidx_t *
+                                                        last_id)
+{
+  t8_daniso_t         desc;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (t8_element_level (elem) <= level);
+  *first_id = t8_element_get_linear_id (elem, level);
+  t8_element_face_descendant ((const t8_daniso_t *) elem, -1, 1, &desc,
+                              level);
+  *last_id = t8_element_get_linear_id ((const t8_element_t *) &desc, level);
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_new (int length, t8_element_t ** elem)
+{
+  /* allocate memory for the elements */
+  t8_default_scheme_common_c::t8_element_new (length, elem);
+
+  /* initialize all elements as the root element */
+  {
+    int                 i;
+    for (i = 0; i < length; i++) {
+      t8_daniso_root ((t8_daniso_t *) elem[i]);
+    }
+  }
+}
+
+void
+t8_default_scheme_aniso_c::t8_element_init (int length, t8_element_t * elem,
+                                            int new_called)
+{
+#ifdef T8_ENABLE_DEBUG
+  if (!new_called) {
+    int                 i;
+    t8_daniso_t        *a = (t8_daniso_t *) elem;
+    for (i = 0; i < length; i++) {
+      t8_daniso_root (a + i);
+    }
+  }
+#endif
+}
+
+#ifdef T8_ENABLE_DEBUG
+/* *INDENT-OFF* */
+/* indent bug, indent adds a second "const" modifier */
+int
+t8_default_scheme_aniso_c::t8_element_is_valid (const t8_element_t * elem) const
+/* *INDENT-ON* */
+{
+  const t8_daniso_t  *a = (const t8_daniso_t *) elem;
+  int                 count[3] = { 0, 0, 0 };
+  int                 s, i, mask;
+
+  if (a->level < 0 || a->level > max_level) {
+    return 0;
+  }
+  /* Bits beyond the last refinement step must not be set */
+  if (a->level < 64 / dim && (a->history >> (dim * a->level)) != 0) {
+    return 0;
+  }
+  for (s = 1; s <= a->level; s++) {
+    mask = t8_daniso_step_mask (a, dim, s);
+    if (mask == 0) {
+      return 0;
+    }
+    for (i = 0; i < dim; i++) {
+      count[i] += (mask >> i) & 1;
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    if (i >= dim) {
+      if (a->dlevel[i] != 0 || a->coords[i] != 0) {
+        return 0;
+      }
+      continue;
+    }
+    /* The levels match the history and the coordinates are aligned */
+    if (a->dlevel[i] != count[i] || a->coords[i] < 0
+        || a->coords[i] >= 1 << root_level
+        || (a->coords[i] & (T8_DANISO_LEN (root_level, a->dlevel[i]) - 1))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+#endif
+
+/* *INDENT-OFF* */
+t8_default_scheme_aniso_c::t8_default_scheme_aniso_c (t8_eclass_t tree_class,
+                            t8_scheme_aniso_direction_t direction,
+                            void *user_data)
+/* *INDENT-ON* */
+{
+  T8_ASSERT (tree_class == T8_ECLASS_QUAD || tree_class == T8_ECLASS_HEX);
+  eclass = tree_class;
+  element_size = sizeof (t8_daniso_t);
+  ts_context = sc_mempool_new (element_size);
+  dim = tree_class == T8_ECLASS_QUAD ? 2 : 3;
+  root_level = dim == 2 ? P4EST_MAXLEVEL : P8EST_MAXLEVEL;
+  max_level = dim == 2 ? P4EST_QMAXLEVEL : P8EST_QMAXLEVEL;
+  this->direction = direction;
+  this->user_data = user_data;
+}
+
+t8_default_scheme_aniso_c::~t8_default_scheme_aniso_c ()
+{
+  /* The mempool is destroyed by the destructor of the common scheme */
+}
+
+T8_EXTERN_C_END ();
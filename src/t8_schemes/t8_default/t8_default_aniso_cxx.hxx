@@ -0,0 +1,342 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_default_aniso_cxx.hxx
+ * Anisotropic quadrilaterals and hexahedra.
+ * Each element stores its refinement level in every coordinate direction
+ * together with the directions in which it and its ancestors were refined.
+ * An element is refined in the directions returned by a function of its
+ * position and levels, see \ref t8_scheme_new_aniso_cxx.  Thus the
+ * refinement tree can be reconstructed from any single element.
+ */
+
+#ifndef T8_DEFAULT_ANISO_CXX_HXX
+#define T8_DEFAULT_ANISO_CXX_HXX
+
+#include <t8_element_cxx.hxx>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include "t8_default_common_cxx.hxx"
+
+/** The structure holding an anisotropic quadrilateral or hexahedron. */
+typedef struct t8_daniso
+{
+  /** The directions of all refinement steps from the root to the element.
+   * The step from level l - 1 to level l is stored as a bit mask of dim bits
+   * starting at bit dim * (l - 1), bit i stands for coordinate direction i.
+   * All bits above dim * level are zero. */
+  uint64_t            history;
+  int32_t             coords[3];  /**< The anchor coordinates, z is 0 in 2D. */
+  int8_t              level;      /**< The number of refinement steps. */
+  int8_t              dlevel[3];  /**< The level in each direction. */
+}
+t8_daniso_t;
+
+struct t8_default_scheme_aniso_c:public t8_default_scheme_common_c
+{
+public:
+  /** Constructor.
+   * \param [in] tree_class  Either T8_ECLASS_QUAD or T8_ECLASS_HEX.
+   * \param [in] direction   The function choosing the refinement directions.
+   *                         If NULL, all elements are refined isotropically.
+   * \param [in] user_data   Passed to \a direction.
+   */
+                      t8_default_scheme_aniso_c (t8_eclass_t tree_class,
+                                                 t8_scheme_aniso_direction_t
+                                                 direction, void *user_data);
+
+  ~t8_default_scheme_aniso_c ();
+
+  /** Return the refinement level of an element in a coordinate direction. */
+  int                 t8_element_direction_level (const t8_element_t * elem,
+                                                  int dir) const;
+
+  /** Allocate memory for a given number of elements.
+   * In debugging mode, ensure that all elements are valid \ref t8_element_is_valid.
+   */
+  virtual void        t8_element_new (int length, t8_element_t ** elem);
+
+  /** Initialize an array of allocated elements. */
+  virtual void        t8_element_init (int length, t8_element_t * elem,
+                                       int called_new);
+
+  /** Return the maximum level allowed for this element class. */
+  virtual int         t8_element_maxlevel (void);
+
+  /** Return the type of each child in the ordering of the implementation. */
+  virtual t8_eclass_t t8_element_child_eclass (int childid);
+
+  /** Return the number of refinement steps of an element. */
+  virtual int         t8_element_level (const t8_element_t * elem);
+
+  /** Copy one element to another */
+  virtual void        t8_element_copy (const t8_element_t * source,
+                                       t8_element_t * dest);
+
+  /** Compare two elements by their linear ids at the finer of their levels.
+   * An ancestor is smaller than its descendants. */
+  virtual int         t8_element_compare (const t8_element_t * elem1,
+                                          const t8_element_t * elem2);
+
+  /** Construct the parent of a given element. */
+  virtual void        t8_element_parent (const t8_element_t * elem,
+                                         t8_element_t * parent);
+
+  /** Return the number of siblings of an element including itself.
+   * This is the number of children of its parent. */
+  virtual int         t8_element_num_siblings (const t8_element_t *
+                                               elem) const;
+
+  /** Construct a same-size sibling of a given element. */
+  virtual void        t8_element_sibling (const t8_element_t * elem,
+                                          int sibid, t8_element_t * sibling);
+
+  /** Compute the number of face of a given element. */
+  virtual int         t8_element_num_faces (const t8_element_t * elem);
+
+  /** Compute the maximum number of faces of a given element and all of its
+   *  descendants. */
+  virtual int         t8_element_max_num_faces (const t8_element_t * elem);
+
+  /** Return the number of children of an element when it is refined. */
+  virtual int         t8_element_num_children (const t8_element_t * elem);
+
+  /** Return the number of children of an element's face when the element is refined. */
+  virtual int         t8_element_num_face_children (const t8_element_t *
+                                                    elem, int face);
+
+  /** Return the corner number of an element's face corner. */
+  virtual int         t8_element_get_face_corner (const t8_element_t *
+                                                  element, int face,
+                                                  int corner);
+
+  /** Return the face numbers of the faces sharing an element's corner. */
+  virtual int         t8_element_get_corner_face (const t8_element_t *
+                                                  element, int corner,
+                                                  int face);
+
+  /** Construct the child element of a given number. */
+  virtual void        t8_element_child (const t8_element_t * elem,
+                                        int childid, t8_element_t * child);
+
+  /** Construct all children of a given element. */
+  virtual void        t8_element_children (const t8_element_t * elem,
+                                           int length, t8_element_t * c[]);
+
+  /** Return the child id of an element */
+  virtual int         t8_element_child_id (const t8_element_t * elem);
+
+  /** Return the child id of an ancestor */
+  virtual int         t8_element_ancestor_id (const t8_element_t * elem,
+                                              int level);
+
+  /** Return nonzero if collection of elements is a family */
+  virtual int         t8_element_is_family (t8_element_t ** fam);
+
+  /** Construct the nearest common ancestor of two elements in the same tree. */
+  virtual void        t8_element_nca (const t8_element_t * elem1,
+                                      const t8_element_t * elem2,
+                                      t8_element_t * nca);
+
+  /** Compute the shape of the face of an element. */
+  virtual t8_element_shape_t t8_element_face_shape (const t8_element_t * elem,
+                                                    int face);
+
+  /** Given an element and a face of the element, compute all children of
+   * the element that touch the face. */
+  virtual void        t8_element_children_at_face (const t8_element_t * elem,
+                                                   int face,
+                                                   t8_element_t * children[],
+                                                   int num_children,
+                                                   int *child_indices);
+
+  /** Given a face of an element and a child number of a child of that face,
+   * return the face number of the child of the element that matches the
+   * child face. */
+  virtual int         t8_element_face_child_face (const t8_element_t * elem,
+                                                  int face, int face_child);
+
+  /** Given a face of an element return the face number
+   * of the parent of the element that matches the element's face. */
+  virtual int         t8_element_face_parent_face (const t8_element_t * elem,
+                                                   int face);
+
+  /** Transform the coordinates of a face element across a tree face.
+   * Only available for quadrilaterals. */
+  virtual void        t8_element_transform_face (const t8_element_t * elem1,
+                                                 t8_element_t * elem2,
+                                                 int orientation, int sign,
+                                                 int is_smaller_face);
+
+  /** Given a boundary face inside a root tree's face construct
+   *  the element inside the root tree that has the given face as a face.
+   *  This is the coarsest element of the refinement tree at this face
+   *  whose face is at least as fine as the given face. */
+  virtual int         t8_element_extrude_face (const t8_element_t * face,
+                                               const t8_eclass_scheme_c *
+                                               face_scheme,
+                                               t8_element_t * elem,
+                                               int root_face);
+
+  /** Return the tree face id given a boundary face. */
+  virtual int         t8_element_tree_face (const t8_element_t * elem,
+                                            int face);
+
+  /** Construct the first descendant of an element that touches a given face.   */
+  virtual void        t8_element_first_descendant_face (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_element_t *
+                                                        first_desc,
+                                                        int level);
+
+  /** Construct the last descendant of an element that touches a given face. */
+  virtual void        t8_element_last_descendant_face (const t8_element_t *
+                                                       elem, int face,
+                                                       t8_element_t *
+                                                       last_desc, int level);
+
+  /** Construct the boundary element at a specific face. */
+  virtual void        t8_element_boundary_face (const t8_element_t * elem,
+                                                int face,
+                                                t8_element_t * boundary,
+                                                const t8_eclass_scheme_c *
+                                                boundary_scheme);
+
+  /** Construct all codimension-one boundary elements of a given element. */
+  virtual void        t8_element_boundary (const t8_element_t * elem,
+                                           int min_dim, int length,
+                                           t8_element_t ** boundary);
+
+  /** Compute whether a given element shares a given face with its root tree. */
+  virtual int         t8_element_is_root_boundary (const t8_element_t * elem,
+                                                   int face);
+
+  /** Construct the face neighbor of a given element if this face neighbor
+   * is inside the root tree.  The neighbor is the element of the same level
+   * in the refinement tree that contains the anchor of the box next to
+   * \a elem at \a face.  It has the same size as \a elem if the refinement
+   * directions do not change across the face. */
+  virtual int         t8_element_face_neighbor_inside (const t8_element_t *
+                                                       elem,
+                                                       t8_element_t * neigh,
+                                                       int face,
+                                                       int *neigh_face);
+
+  /** Initialize the entries of an element according to a linear id of
+   * the isotropic refinement of a given level. */
+  virtual void        t8_element_set_linear_id (t8_element_t * elem,
+                                                int level, t8_linearidx_t id);
+
+  /** Compute the linear id of a given element in a hypothetical uniform
+   * refinement of a given level.
+   * Each refinement step contributes dim bits in which the child's
+   * coordinate bits of the refined directions are set.  For isotropic
+   * elements this is the Morton index. */
+  virtual t8_linearidx_t t8_element_get_linear_id (const
+                                                   t8_element_t *
+                                                   elem, int level);
+
+  /** Compute the first descendant of a given element. */
+  virtual void        t8_element_first_descendant (const t8_element_t *
+                                                   elem, t8_element_t * desc,
+                                                   int level);
+
+  /** Compute the last descendant of a given element. */
+  virtual void        t8_element_last_descendant (const t8_element_t *
+                                                  elem, t8_element_t * desc,
+                                                  int level);
+
+  /** Compute the element that follows a given element of the same level
+   * in the space-filling curve. */
+  virtual void        t8_element_successor (const t8_element_t * t,
+                                            t8_element_t * s, int level);
+
+  /** Get the integer coordinates of the anchor node of an element */
+  virtual void        t8_element_anchor (const t8_element_t * elem,
+                                         int anchor[3]);
+
+  /** Get the integer root length of an element */
+  virtual int         t8_element_root_len (const t8_element_t * elem);
+
+  /** Compute the integer coordinates of a given element vertex. */
+  virtual void        t8_element_vertex_coords (const t8_element_t * t,
+                                                int vertex, int coords[]);
+
+  /** Count the descendants of an element at a given level. */
+  virtual t8_gloidx_t t8_element_count_leafs (const t8_element_t * t,
+                                              int level);
+
+  /** Compute the interval of linear ids of the descendants of an element.
+   * Since the descendants do not use all ids, the last id is the one of
+   * the last descendant. */
+  virtual void        t8_element_descendant_range (const t8_element_t *
+                                                   elem, int level,
+                                                   t8_linearidx_t * first_id,
+                                                   t8_linearidx_t * last_id);
+
+#ifdef T8_ENABLE_DEBUG
+  /** Query whether an element is valid */
+  virtual int         t8_element_is_valid (const t8_element_t * t) const;
+#endif
+
+private:
+  /** Return the directions in which an element is refined as a bit mask. */
+  int                 t8_element_refine_mask (const t8_daniso_t * a) const;
+
+  /** Construct the child of an element with given child id that is
+   * refined in the directions of \a mask. */
+  void                t8_element_mask_child (const t8_daniso_t * a,
+                                             int mask, int childid,
+                                             t8_daniso_t * c) const;
+
+  /** Construct an ancestor of given level of an element. */
+  void                t8_element_ancestor (const t8_daniso_t * a,
+                                           int level, t8_daniso_t * anc) const;
+
+  /** Construct the descendant of given level of an element that is the
+   * first (\a last = 0) or last (\a last = 1) child at each refinement step
+   * among the children touching \a face.  If \a face is negative, all
+   * children are considered. */
+  void                t8_element_face_descendant (const t8_daniso_t * a,
+                                                  int face, int last,
+                                                  t8_daniso_t * desc,
+                                                  int level) const;
+
+  /** Construct the element of the refinement tree that contains a point.
+   * The element is refined until it has \a level refinement steps or until
+   * its level in each direction i with nonnegative \a dlevels[i] is at least
+   * \a dlevels[i].  \a dlevels may be NULL. */
+  void                t8_element_locate (const int point[3], int level,
+                                         const int *dlevels,
+                                         t8_daniso_t * a) const;
+
+  /** Count the descendants of given level of an element recursively. */
+  t8_gloidx_t         t8_element_count_descendants (const t8_daniso_t * a,
+                                                    int level) const;
+
+  int                 dim;        /**< The dimension, 2 or 3. */
+  int                 root_level; /**< The logarithm of the root length. */
+  int                 max_level;  /**< The maximum level of the elements. */
+  t8_scheme_aniso_direction_t direction; /**< The refinement directions. */
+  void               *user_data;  /**< Passed to \a direction. */
+};
+
+#endif /* !T8_DEFAULT_ANISO_CXX_HXX */
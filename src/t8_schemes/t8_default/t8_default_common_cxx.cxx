@@ -87,6 +87,10 @@ t8_default_mempool_alloc (sc_mempool_t * ts_context, int length,
   T8_ASSERT (0 <= length);
   T8_ASSERT (elem != NULL);
 
+  /* The mempool is shared by all threads */
+#ifdef T8_ENABLE_OPENMP
+#pragma omp critical (t8_default_mempool)
+#endif
   for (i = 0; i < length; ++i) {
     elem[i] = (t8_element_t *) sc_mempool_alloc (ts_context);
   }
@@ -102,6 +106,9 @@ t8_default_mempool_free (sc_mempool_t * ts_context, int length,
   T8_ASSERT (0 <= length);
   T8_ASSERT (elem != NULL);
 
+#ifdef T8_ENABLE_OPENMP
+#pragma omp critical (t8_default_mempool)
+#endif
   for (i = 0; i < length; ++i) {
     sc_mempool_free (ts_context, elem[i]);
   }
@@ -88,4 +88,137 @@ public:
                                                    void *outdata);
 };
 
+/* The batch templates below loop over an array of elements of type TElem
+ * of the scheme TScheme. They call the single element functions of TScheme
+ * with qualified names, such that these calls are not dispatched via the
+ * virtual table and can be inlined. The default schemes forward their batch
+ * functions to these templates unless they have a faster implementation. */
+
+/** Compute the levels of \a count consecutive elements. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_level (TScheme * scheme, const t8_element_t * elems,
+                        int count, int *levels)
+{
+  const TElem        *e = (const TElem *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    levels[ielem] =
+      scheme->TScheme::t8_element_level ((const t8_element_t *) (e + ielem));
+  }
+}
+
+/** Compute the child ids of \a count consecutive elements. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_child_id (TScheme * scheme, const t8_element_t * elems,
+                           int count, int *child_ids)
+{
+  const TElem        *e = (const TElem *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    child_ids[ielem] =
+      scheme->TScheme::t8_element_child_id ((const t8_element_t *)
+                                            (e + ielem));
+  }
+}
+
+/** Compute the parents of \a count consecutive elements. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_parent (TScheme * scheme, const t8_element_t * elems,
+                         int count, t8_element_t * parents)
+{
+  const TElem        *e = (const TElem *) elems;
+  TElem              *p = (TElem *) parents;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    scheme->TScheme::t8_element_parent ((const t8_element_t *) (e + ielem),
+                                        (t8_element_t *) (p + ielem));
+  }
+}
+
+/** Compute the NUM_CHILDREN children of each of \a count consecutive
+ * elements. The children of one element are stored consecutively. */
+template < class TElem, int NUM_CHILDREN, class TScheme > inline void
+t8_default_batch_children (TScheme * scheme, const t8_element_t * elems,
+                           int count, t8_element_t * children)
+{
+  const TElem        *e = (const TElem *) elems;
+  TElem              *c = (TElem *) children;
+  int                 ielem, ichild;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    for (ichild = 0; ichild < NUM_CHILDREN; ichild++) {
+      scheme->TScheme::t8_element_child ((const t8_element_t *) (e + ielem),
+                                         ichild, (t8_element_t *) c++);
+    }
+  }
+}
+
+/** Compute the linear ids of \a count consecutive elements. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_get_linear_id (TScheme * scheme, const t8_element_t * elems,
+                                int count, int level, t8_linearidx_t * ids)
+{
+  const TElem        *e = (const TElem *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    ids[ielem] =
+      scheme->TScheme::t8_element_get_linear_id ((const t8_element_t *)
+                                                 (e + ielem), level);
+  }
+}
+
+/** Construct \a count consecutive elements from the linear ids
+ * \a first_id, ..., \a first_id + \a count - 1.
+ * Each element is computed from its own linear id, thus there is no
+ * dependency between the iterations. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_set_linear_id (TScheme * scheme, t8_element_t * elems,
+                                int count, int level,
+                                t8_linearidx_t first_id)
+{
+  TElem              *e = (TElem *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    scheme->TScheme::t8_element_set_linear_id ((t8_element_t *) (e + ielem),
+                                               level, first_id + ielem);
+  }
+}
+
+/** Construct \a count consecutive elements from the linear ids
+ * \a first_id, ..., \a first_id + \a count - 1.
+ * Only the first element is computed from its linear id, the others are
+ * computed as successors. Use this for schemes where computing the successor
+ * is cheaper than computing an element from its linear id. */
+template < class TElem, class TScheme > inline void
+t8_default_batch_set_linear_id_successor (TScheme * scheme,
+                                          t8_element_t * elems, int count,
+                                          int level, t8_linearidx_t first_id)
+{
+  TElem              *e = (TElem *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  if (count == 0) {
+    return;
+  }
+  scheme->TScheme::t8_element_set_linear_id (elems, level, first_id);
+  for (ielem = 1; ielem < count; ielem++) {
+    scheme->TScheme::t8_element_successor ((const t8_element_t *)
+                                           (e + ielem - 1),
+                                           (t8_element_t *) (e + ielem),
+                                           level);
+  }
+}
+
 #endif /* !T8_DEFAULT_COMMON_CXX_HXX */
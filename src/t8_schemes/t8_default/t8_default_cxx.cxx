@@ -28,9 +28,15 @@
 #include "t8_default_line_cxx.hxx"
 #include "t8_default_quad_cxx.hxx"
 #include "t8_default_hex_cxx.hxx"
+#include "t8_default_cquad_cxx.hxx"
+#include "t8_default_chex_cxx.hxx"
+#include "t8_default_hquad_cxx.hxx"
+#include "t8_default_hhex_cxx.hxx"
+#include "t8_default_aniso_cxx.hxx"
 #include "t8_default_tri_cxx.hxx"
 #include "t8_default_tet_cxx.hxx"
 #include "t8_default_prism_cxx.hxx"
+#include "t8_default_pyramid_cxx.hxx"
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -50,10 +56,68 @@ t8_scheme_new_default_cxx (void)
   s->eclass_schemes[T8_ECLASS_TRIANGLE] = new t8_default_scheme_tri_c ();
   s->eclass_schemes[T8_ECLASS_TET] = new t8_default_scheme_tet_c ();
   s->eclass_schemes[T8_ECLASS_PRISM] = new t8_default_scheme_prism_c ();
+  s->eclass_schemes[T8_ECLASS_PYRAMID] = new t8_default_scheme_pyramid_c ();
 
   return s;
 }
 
+t8_scheme_cxx_t    *
+t8_scheme_new_compact_cxx (void)
+{
+  t8_scheme_cxx_t    *s;
+
+  s = t8_scheme_new_default_cxx ();
+  /* Replace the quad and hex schemes with their compact versions */
+  delete              s->eclass_schemes[T8_ECLASS_QUAD];
+  delete              s->eclass_schemes[T8_ECLASS_HEX];
+  s->eclass_schemes[T8_ECLASS_QUAD] = new t8_default_scheme_cquad_c ();
+  s->eclass_schemes[T8_ECLASS_HEX] = new t8_default_scheme_chex_c ();
+
+  return s;
+}
+
+t8_scheme_cxx_t    *
+t8_scheme_new_hilbert_cxx (void)
+{
+  t8_scheme_cxx_t    *s;
+
+  s = t8_scheme_new_default_cxx ();
+  /* Replace the quad and hex schemes with their Hilbert versions */
+  delete              s->eclass_schemes[T8_ECLASS_QUAD];
+  delete              s->eclass_schemes[T8_ECLASS_HEX];
+  s->eclass_schemes[T8_ECLASS_QUAD] = new t8_default_scheme_hquad_c ();
+  s->eclass_schemes[T8_ECLASS_HEX] = new t8_default_scheme_hhex_c ();
+
+  return s;
+}
+
+t8_scheme_cxx_t    *
+t8_scheme_new_aniso_cxx (t8_scheme_aniso_direction_t direction,
+                         void *user_data)
+{
+  t8_scheme_cxx_t    *s;
+
+  s = t8_scheme_new_default_cxx ();
+  /* Replace the quad and hex schemes with their anisotropic versions */
+  delete              s->eclass_schemes[T8_ECLASS_QUAD];
+  delete              s->eclass_schemes[T8_ECLASS_HEX];
+  s->eclass_schemes[T8_ECLASS_QUAD] =
+    new t8_default_scheme_aniso_c (T8_ECLASS_QUAD, direction, user_data);
+  s->eclass_schemes[T8_ECLASS_HEX] =
+    new t8_default_scheme_aniso_c (T8_ECLASS_HEX, direction, user_data);
+
+  return s;
+}
+
+int
+t8_scheme_aniso_element_level (t8_eclass_scheme_c * ts,
+                               const t8_element_t * elem, int dir)
+{
+  T8_ASSERT (T8_COMMON_IS_TYPE (ts, t8_default_scheme_aniso_c *));
+  return ((t8_default_scheme_aniso_c *) ts)->t8_element_direction_level
+    (elem, dir);
+}
+
 int
 t8_eclass_scheme_is_default (t8_eclass_scheme_c * ts)
 {
@@ -63,18 +127,21 @@ t8_eclass_scheme_is_default (t8_eclass_scheme_c * ts)
   case T8_ECLASS_LINE:
     return T8_COMMON_IS_TYPE (ts, t8_default_scheme_line_c *);
   case T8_ECLASS_QUAD:
-    return T8_COMMON_IS_TYPE (ts, t8_default_scheme_quad_c *);
+    return T8_COMMON_IS_TYPE (ts, t8_default_scheme_quad_c *)
+      || T8_COMMON_IS_TYPE (ts, t8_default_scheme_cquad_c *);
   case T8_ECLASS_TRIANGLE:
     return T8_COMMON_IS_TYPE (ts, t8_default_scheme_tri_c *);
   case T8_ECLASS_HEX:
-    return T8_COMMON_IS_TYPE (ts, t8_default_scheme_hex_c *);
+    return T8_COMMON_IS_TYPE (ts, t8_default_scheme_hex_c *)
+      || T8_COMMON_IS_TYPE (ts, t8_default_scheme_chex_c *);
   case T8_ECLASS_TET:
     return T8_COMMON_IS_TYPE (ts, t8_default_scheme_tet_c *);
   case T8_ECLASS_PRISM:
     return T8_COMMON_IS_TYPE (ts, t8_default_scheme_prism_c *);
+  case T8_ECLASS_PYRAMID:
+    return T8_COMMON_IS_TYPE (ts, t8_default_scheme_pyramid_c *);
   default:
     SC_ABORT_NOT_REACHED ();
-    /* TODO: Add pyramid as soon as pyramid scheme is implemented */
     /* TODO: Add a test for this function */
   }
   return 0;                     /* Default return value false */
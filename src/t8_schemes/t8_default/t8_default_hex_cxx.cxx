@@ -23,6 +23,7 @@
 #include <p8est_bits.h>
 #include <p4est_bits.h>
 #include "t8_default_common_cxx.hxx"
+#include "t8_default_morton.h"
 #include "t8_default_hex_cxx.hxx"
 
 /* We want to export the whole implementation to be callable from "C" */
@@ -207,9 +208,9 @@ t8_default_scheme_hex_c::t8_element_nca (const t8_element_t * elem1,
 {
   T8_ASSERT (t8_element_is_valid (elem1));
   T8_ASSERT (t8_element_is_valid (elem2));
-  p8est_nearest_common_ancestor ((const p8est_quadrant_t *) elem1,
-                                 (const p8est_quadrant_t *) elem2,
-                                 (p8est_quadrant_t *) nca);
+  t8_morton_oct_nca ((const p8est_quadrant_t *) elem1,
+                     (const p8est_quadrant_t *) elem2,
+                     (p8est_quadrant_t *) nca);
 }
 
 t8_element_shape_t
@@ -585,7 +586,7 @@ t8_default_scheme_hex_c::t8_element_set_linear_id (t8_element_t * elem,
   T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
   T8_ASSERT (0 <= id && id < ((t8_linearidx_t) 1) << P8EST_DIM * level);
 
-  p8est_quadrant_set_morton ((p8est_quadrant_t *) elem, level, id);
+  t8_morton_oct_set ((p8est_quadrant_t *) elem, level, id);
 }
 
 t8_linearidx_t
@@ -595,7 +596,7 @@ t8_linearidx_t
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
 
-  return p8est_quadrant_linear_id ((p8est_quadrant_t *) elem, level);
+  return t8_morton_oct_linear_id ((const p8est_quadrant_t *) elem, level);
 }
 
 void
@@ -634,9 +635,9 @@ t8_default_scheme_hex_c::t8_element_successor (const t8_element_t * elem1,
   T8_ASSERT (t8_element_is_valid (elem2));
   T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
 
-  id = p8est_quadrant_linear_id ((const p8est_quadrant_t *) elem1, level);
+  id = t8_morton_oct_linear_id ((const p8est_quadrant_t *) elem1, level);
   T8_ASSERT (id + 1 < ((t8_linearidx_t) 1) << P8EST_DIM * level);
-  p8est_quadrant_set_morton ((p8est_quadrant_t *) elem2, level, id + 1);
+  t8_morton_oct_set ((p8est_quadrant_t *) elem2, level, id + 1);
 }
 
 void
@@ -726,6 +727,94 @@ t8_default_scheme_hex_c::t8_element_is_valid (const t8_element_t *elem) const
 }
 #endif
 
+void
+t8_default_scheme_hex_c::t8_element_batch_level (const t8_element_t * elems,
+                                                 int count, int *levels)
+{
+  t8_default_batch_level<t8_phex_t> (this, elems, count, levels);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_batch_child_id (const t8_element_t * elems,
+                                                    int count, int *child_ids)
+{
+  t8_default_batch_child_id<t8_phex_t> (this, elems, count, child_ids);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_batch_parent (const t8_element_t * elems,
+                                                  int count,
+                                                  t8_element_t * parents)
+{
+  t8_default_batch_parent<t8_phex_t> (this, elems, count, parents);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_batch_children (const t8_element_t * elems,
+                                                    int count,
+                                                    t8_element_t * children)
+{
+  t8_default_batch_children<t8_phex_t, P8EST_CHILDREN> (this, elems, count,
+                                                        children);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_batch_get_linear_id (const t8_element_t *
+                                                         elems, int count,
+                                                         int level,
+                                                         t8_linearidx_t * ids)
+{
+  t8_default_batch_get_linear_id<t8_phex_t> (this, elems, count, level, ids);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                         int count, int level,
+                                                         t8_linearidx_t
+                                                         first_id)
+{
+  t8_default_batch_set_linear_id<t8_phex_t> (this, elems, count, level,
+                                             first_id);
+}
+
+void
+t8_default_scheme_hex_c::t8_element_descendant_range (const t8_element_t *
+                                                      elem, int level,
+                                                      t8_linearidx_t *
+                                                      first_id,
+                                                      t8_linearidx_t * last_id)
+{
+  const p8est_quadrant_t *q = (const p8est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (q->level <= level && level <= P8EST_QMAXLEVEL);
+  /* The descendants of a quadrant are consecutive in the Morton order */
+  *first_id = t8_morton_oct_linear_id (q, level);
+  *last_id = *first_id
+    + ((t8_linearidx_t) 1 << (P8EST_DIM * (level - q->level))) - 1;
+}
+
+void
+t8_default_scheme_hex_c::t8_element_face_descendant_range (const t8_element_t *
+                                                           elem, int face,
+                                                           int level,
+                                                           t8_linearidx_t *
+                                                           first_id,
+                                                           t8_linearidx_t *
+                                                           last_id)
+{
+  const p8est_quadrant_t *q = (const p8est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < P8EST_FACES);
+  /* The first and last descendant at a face lie in the first and last
+   * corner of the face */
+  *first_id =
+    t8_morton_oct_corner_descendant_id (q, p8est_face_corners[face][0], level);
+  *last_id =
+    t8_morton_oct_corner_descendant_id (q, p8est_face_corners[face][3], level);
+}
+
 /* Constructor */
 t8_default_scheme_hex_c::t8_default_scheme_hex_c (void)
 {
@@ -266,6 +266,50 @@ public:
   virtual void        t8_element_vertex_coords (const t8_element_t * t,
                                                 int vertex, int coords[]);
 
+  /** Compute the levels of a range of contiguous elements. */
+  virtual void        t8_element_batch_level (const t8_element_t * elems,
+                                              int count, int *levels);
+
+  /** Compute the child ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_child_id (const t8_element_t * elems,
+                                                 int count, int *child_ids);
+
+  /** Compute the parents of a range of contiguous elements. */
+  virtual void        t8_element_batch_parent (const t8_element_t * elems,
+                                               int count,
+                                               t8_element_t * parents);
+
+  /** Compute the children of a range of contiguous elements. */
+  virtual void        t8_element_batch_children (const t8_element_t * elems,
+                                                 int count,
+                                                 t8_element_t * children);
+
+  /** Compute the linear ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_get_linear_id (const t8_element_t *
+                                                      elems, int count,
+                                                      int level,
+                                                      t8_linearidx_t * ids);
+
+  /** Initialize a range of contiguous elements with consecutive linear ids. */
+  virtual void        t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                      int count, int level,
+                                                      t8_linearidx_t first_id);
+
+  /** Compute the interval of linear ids of the descendants of an element. */
+  virtual void        t8_element_descendant_range (const t8_element_t *
+                                                   elem, int level,
+                                                   t8_linearidx_t * first_id,
+                                                   t8_linearidx_t * last_id);
+
+  /** Compute the linear ids of the first and last descendant at a face. */
+  virtual void        t8_element_face_descendant_range (const t8_element_t *
+                                                        elem, int face,
+                                                        int level,
+                                                        t8_linearidx_t *
+                                                        first_id,
+                                                        t8_linearidx_t *
+                                                        last_id);
+
 #ifdef T8_ENABLE_DEBUG
   /** Query whether an element is valid */
   virtual int         t8_element_is_valid (const t8_element_t * t) const;
@@ -0,0 +1,155 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_default_hhex_cxx.hxx
+ * An implementation of the hexahedral element class in Hilbert order.
+ * The elements are the same octants as in \ref t8_default_scheme_hex_c,
+ * but children, linear ids and successors follow the Hilbert curve instead
+ * of the Morton curve. Consecutive elements of a uniform refinement share
+ * a face, thus the partitions of a forest are more compact.
+ * All geometric functions are inherited from the Morton scheme.
+ */
+
+#ifndef T8_DEFAULT_HHEX_CXX_HXX
+#define T8_DEFAULT_HHEX_CXX_HXX
+
+#include "t8_default_hex_cxx.hxx"
+
+struct t8_default_scheme_hhex_c:public t8_default_scheme_hex_c
+{
+public:
+  /** Constructor. */
+  t8_default_scheme_hhex_c ();
+
+  ~t8_default_scheme_hhex_c ();
+
+/** Compare two elements in Hilbert order. */
+  virtual int         t8_element_compare (const t8_element_t * elem1,
+                                          const t8_element_t * elem2);
+
+/** Construct a same-size sibling of a given element. */
+  virtual void        t8_element_sibling (const t8_element_t * elem,
+                                          int sibid, t8_element_t * sibling);
+
+/** Construct the child element of a given number. */
+  virtual void        t8_element_child (const t8_element_t * elem,
+                                        int childid, t8_element_t * child);
+
+/** Construct all children of a given element. */
+  virtual void        t8_element_children (const t8_element_t * elem,
+                                           int length, t8_element_t * c[]);
+
+/** Return the child id of an element */
+  virtual int         t8_element_child_id (const t8_element_t * elem);
+
+  /** Compute the ancestor id of an element */
+  virtual int         t8_element_ancestor_id (const t8_element_t * elem,
+                                              int level);
+
+/** Return nonzero if collection of elements is a family */
+  virtual int         t8_element_is_family (t8_element_t ** fam);
+
+  /** Given an element and a face of the element, compute all children of
+   * the element that touch the face. The children are in Hilbert order. */
+  virtual void        t8_element_children_at_face (const t8_element_t * elem,
+                                                   int face,
+                                                   t8_element_t * children[],
+                                                   int num_children,
+                                                   int *child_indices);
+
+  /** Construct the first descendant of an element that touches a given face. */
+  virtual void        t8_element_first_descendant_face (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_element_t *
+                                                        first_desc,
+                                                        int level);
+
+  /** Construct the last descendant of an element that touches a given face. */
+  virtual void        t8_element_last_descendant_face (const t8_element_t *
+                                                       elem, int face,
+                                                       t8_element_t *
+                                                       last_desc, int level);
+
+/** Initialize an element according to a given linear id */
+  virtual void        t8_element_set_linear_id (t8_element_t * elem,
+                                                int level, t8_linearidx_t id);
+
+/** Calculate the linear id of an element */
+  virtual t8_linearidx_t t8_element_get_linear_id (const
+                                                   t8_element_t *
+                                                   elem, int level);
+
+/** Calculate the first descendant of a given element e. That is, the
+ *  first element in a uniform refinement of e of the maximal possible level.
+ */
+  virtual void        t8_element_first_descendant (const t8_element_t *
+                                                   elem, t8_element_t * desc,
+                                                   int level);
+
+/** Calculate the last descendant of a given element e. That is, the
+ *  last element in a uniform refinement of e of the maximal possible level.
+ */
+  virtual void        t8_element_last_descendant (const t8_element_t *
+                                                  elem, t8_element_t * desc,
+                                                  int level);
+
+/** Compute s as a successor of t*/
+  virtual void        t8_element_successor (const t8_element_t * t,
+                                            t8_element_t * s, int level);
+
+  /** Compute the child ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_child_id (const t8_element_t * elems,
+                                                 int count, int *child_ids);
+
+  /** Compute the children of a range of contiguous elements. */
+  virtual void        t8_element_batch_children (const t8_element_t * elems,
+                                                 int count,
+                                                 t8_element_t * children);
+
+  /** Compute the linear ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_get_linear_id (const t8_element_t *
+                                                      elems, int count,
+                                                      int level,
+                                                      t8_linearidx_t * ids);
+
+  /** Initialize a range of contiguous elements with consecutive linear ids. */
+  virtual void        t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                      int count, int level,
+                                                      t8_linearidx_t first_id);
+
+  /** Compute the interval of linear ids of the descendants of an element. */
+  virtual void        t8_element_descendant_range (const t8_element_t *
+                                                   elem, int level,
+                                                   t8_linearidx_t * first_id,
+                                                   t8_linearidx_t * last_id);
+
+  /** Compute the linear ids of the first and last descendant at a face. */
+  virtual void        t8_element_face_descendant_range (const t8_element_t *
+                                                        elem, int face,
+                                                        int level,
+                                                        t8_linearidx_t *
+                                                        first_id,
+                                                        t8_linearidx_t *
+                                                        last_id);
+};
+
+#endif /* !T8_DEFAULT_HHEX_CXX_HXX */
@@ -0,0 +1,280 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_default_hilbert.h
+ * Hilbert curve arithmetic for the quadrilateral and hexahedral schemes.
+ * The Hilbert order of the children of an element depends on the state of
+ * the element, which encodes the rotation and reflection of the curve
+ * inside of it. The state of the root is 0 and the state of a child is
+ * looked up from the state of its parent and the child's Morton position,
+ * that is, the position given by the coordinate bits as in p4est.
+ * There are 4 states in 2D and 12 states in 3D.
+ * Since the state is not stored in the element, it is computed in a loop
+ * over the levels of the element.
+ */
+
+#ifndef T8_DEFAULT_HILBERT_H
+#define T8_DEFAULT_HILBERT_H
+
+#include <t8.h>
+#include <p4est.h>
+#include <p8est.h>
+
+/* *INDENT-OFF* */
+/** The Hilbert index of the child in a Morton position for each state. */
+static const int8_t t8_hilbert_quad_index[4][4] = {
+  {0, 3, 1, 2}, {0, 1, 3, 2}, {2, 3, 1, 0}, {2, 1, 3, 0}
+};
+
+/** The Morton position of the child with a Hilbert index for each state. */
+static const int8_t t8_hilbert_quad_morton[4][4] = {
+  {0, 2, 3, 1}, {0, 1, 3, 2}, {3, 2, 0, 1}, {3, 1, 0, 2}
+};
+
+/** The state of the child in a Morton position for each state. */
+static const int8_t t8_hilbert_quad_next[4][4] = {
+  {1, 2, 0, 0}, {0, 1, 3, 1}, {2, 0, 2, 3}, {3, 3, 1, 2}
+};
+
+/** The Hilbert index of the child in a Morton position for each state. */
+static const int8_t t8_hilbert_oct_index[12][8] = {
+  {0, 7, 1, 6, 3, 4, 2, 5}, {0, 3, 7, 4, 1, 2, 6, 5},
+  {4, 7, 3, 0, 5, 6, 2, 1}, {0, 1, 3, 2, 7, 6, 4, 5},
+  {6, 7, 5, 4, 1, 0, 2, 3}, {2, 5, 3, 4, 1, 6, 0, 7},
+  {2, 1, 5, 6, 3, 0, 4, 7}, {4, 5, 7, 6, 3, 2, 0, 1},
+  {6, 1, 7, 0, 5, 2, 4, 3}, {6, 5, 1, 2, 7, 4, 0, 3},
+  {2, 3, 1, 0, 5, 4, 6, 7}, {4, 3, 5, 2, 7, 0, 6, 1}
+};
+
+/** The Morton position of the child with a Hilbert index for each state. */
+static const int8_t t8_hilbert_oct_morton[12][8] = {
+  {0, 2, 6, 4, 5, 7, 3, 1}, {0, 4, 5, 1, 3, 7, 6, 2},
+  {3, 7, 6, 2, 0, 4, 5, 1}, {0, 1, 3, 2, 6, 7, 5, 4},
+  {5, 4, 6, 7, 3, 2, 0, 1}, {6, 4, 0, 2, 3, 1, 5, 7},
+  {5, 1, 0, 4, 6, 2, 3, 7}, {6, 7, 5, 4, 0, 1, 3, 2},
+  {3, 1, 5, 7, 6, 4, 0, 2}, {6, 2, 3, 7, 5, 1, 0, 4},
+  {3, 2, 0, 1, 5, 4, 6, 7}, {5, 7, 3, 1, 0, 2, 6, 4}
+};
+
+/** The state of the child in a Morton position for each state. */
+static const int8_t t8_hilbert_oct_next[12][8] = {
+  {1, 2, 3, 4, 5, 5, 3, 4}, {3, 6, 7, 6, 0, 0, 8, 8},
+  {9, 4, 9, 10, 0, 0, 8, 8}, {0, 1, 10, 1, 11, 9, 10, 9},
+  {2, 0, 2, 7, 6, 11, 6, 7}, {7, 10, 0, 0, 7, 10, 9, 6},
+  {11, 11, 5, 5, 1, 4, 1, 10}, {4, 1, 8, 1, 4, 9, 5, 9},
+  {7, 10, 1, 2, 7, 10, 11, 11}, {11, 11, 5, 5, 3, 2, 7, 2},
+  {2, 3, 2, 8, 6, 3, 6, 5}, {8, 8, 3, 4, 9, 6, 3, 4}
+};
+/* *INDENT-ON* */
+
+/** Return the Morton position of the ancestor of a quadrant at \a level
+ * in its parent. \a level must be in 1, ..., q->level. */
+static inline int
+t8_hilbert_quad_morton_child (const p4est_quadrant_t * q, int level)
+{
+  const int           shift = P4EST_MAXLEVEL - level;
+
+  T8_ASSERT (1 <= level && level <= q->level);
+  return ((q->x >> shift) & 1) | (((q->y >> shift) & 1) << 1);
+}
+
+/** Return the state of the ancestor of a quadrant at \a level. */
+static inline int
+t8_hilbert_quad_state (const p4est_quadrant_t * q, int level)
+{
+  int                 state = 0, l;
+
+  T8_ASSERT (0 <= level && level <= q->level);
+  for (l = 1; l <= level; l++) {
+    state = t8_hilbert_quad_next[state][t8_hilbert_quad_morton_child (q, l)];
+  }
+  return state;
+}
+
+/** Compute the Hilbert index of a quadrant at \a level.
+ * If \a level is larger than the level of \a q, this is the index of the
+ * first descendant of \a q at \a level. */
+static inline t8_linearidx_t
+t8_hilbert_quad_linear_id (const p4est_quadrant_t * q, int level)
+{
+  const int           qlevel = SC_MIN (level, (int) q->level);
+  t8_linearidx_t      id = 0;
+  int                 state = 0, l, m;
+
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+  for (l = 1; l <= qlevel; l++) {
+    m = t8_hilbert_quad_morton_child (q, l);
+    id = (id << P4EST_DIM) | t8_hilbert_quad_index[state][m];
+    state = t8_hilbert_quad_next[state][m];
+  }
+  return id << (P4EST_DIM * (level - qlevel));
+}
+
+/** Set a quadrant from its Hilbert index.
+ * Only the coordinates and the level of \a q are written. */
+static inline void
+t8_hilbert_quad_set (p4est_quadrant_t * q, int level, t8_linearidx_t id)
+{
+  p4est_qcoord_t      x = 0, y = 0;
+  int                 state = 0, l, m;
+
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+  T8_ASSERT (id < ((t8_linearidx_t) 1) << P4EST_DIM * level);
+  for (l = 1; l <= level; l++) {
+    m = t8_hilbert_quad_morton[state]
+      [(id >> (P4EST_DIM * (level - l))) & (P4EST_CHILDREN - 1)];
+    x |= (p4est_qcoord_t) (m & 1) << (P4EST_MAXLEVEL - l);
+    y |= (p4est_qcoord_t) ((m >> 1) & 1) << (P4EST_MAXLEVEL - l);
+    state = t8_hilbert_quad_next[state][m];
+  }
+  q->x = x;
+  q->y = y;
+  q->level = (int8_t) level;
+}
+
+/** Compute the Hilbert index at \a level of the first (if \a last is false)
+ * or last (if \a last is true) descendant of a quadrant that touches a face.
+ */
+static inline t8_linearidx_t
+t8_hilbert_quad_face_descendant_id (const p4est_quadrant_t * q, int face,
+                                    int level, int last)
+{
+  t8_linearidx_t      id = t8_hilbert_quad_linear_id (q, q->level);
+  int                 state = t8_hilbert_quad_state (q, q->level);
+  int                 l, i, m, best;
+
+  T8_ASSERT (0 <= face && face < P4EST_FACES);
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  for (l = q->level + 1; l <= level; l++) {
+    /* Choose the face child that comes first or last in the curve */
+    best = p4est_face_corners[face][0];
+    for (i = 1; i < P4EST_HALF; i++) {
+      m = p4est_face_corners[face][i];
+      if ((t8_hilbert_quad_index[state][m] >
+           t8_hilbert_quad_index[state][best]) == (last != 0)) {
+        best = m;
+      }
+    }
+    id = (id << P4EST_DIM) | t8_hilbert_quad_index[state][best];
+    state = t8_hilbert_quad_next[state][best];
+  }
+  return id;
+}
+
+/** Return the Morton position of the ancestor of an octant at \a level
+ * in its parent. \a level must be in 1, ..., q->level. */
+static inline int
+t8_hilbert_oct_morton_child (const p8est_quadrant_t * q, int level)
+{
+  const int           shift = P8EST_MAXLEVEL - level;
+
+  T8_ASSERT (1 <= level && level <= q->level);
+  return ((q->x >> shift) & 1) | (((q->y >> shift) & 1) << 1)
+    | (((q->z >> shift) & 1) << 2);
+}
+
+/** Return the state of the ancestor of an octant at \a level. */
+static inline int
+t8_hilbert_oct_state (const p8est_quadrant_t * q, int level)
+{
+  int                 state = 0, l;
+
+  T8_ASSERT (0 <= level && level <= q->level);
+  for (l = 1; l <= level; l++) {
+    state = t8_hilbert_oct_next[state][t8_hilbert_oct_morton_child (q, l)];
+  }
+  return state;
+}
+
+/** Compute the Hilbert index of an octant at \a level.
+ * If \a level is larger than the level of \a q, this is the index of the
+ * first descendant of \a q at \a level. */
+static inline t8_linearidx_t
+t8_hilbert_oct_linear_id (const p8est_quadrant_t * q, int level)
+{
+  const int           qlevel = SC_MIN (level, (int) q->level);
+  t8_linearidx_t      id = 0;
+  int                 state = 0, l, m;
+
+  T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
+  for (l = 1; l <= qlevel; l++) {
+    m = t8_hilbert_oct_morton_child (q, l);
+    id = (id << P8EST_DIM) | t8_hilbert_oct_index[state][m];
+    state = t8_hilbert_oct_next[state][m];
+  }
+  return id << (P8EST_DIM * (level - qlevel));
+}
+
+/** Set an octant from its Hilbert index.
+ * Only the coordinates and the level of \a q are written. */
+static inline void
+t8_hilbert_oct_set (p8est_quadrant_t * q, int level, t8_linearidx_t id)
+{
+  p4est_qcoord_t      x = 0, y = 0, z = 0;
+  int                 state = 0, l, m;
+
+  T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
+  T8_ASSERT (id < ((t8_linearidx_t) 1) << P8EST_DIM * level);
+  for (l = 1; l <= level; l++) {
+    m = t8_hilbert_oct_morton[state]
+      [(id >> (P8EST_DIM * (level - l))) & (P8EST_CHILDREN - 1)];
+    x |= (p4est_qcoord_t) (m & 1) << (P8EST_MAXLEVEL - l);
+    y |= (p4est_qcoord_t) ((m >> 1) & 1) << (P8EST_MAXLEVEL - l);
+    z |= (p4est_qcoord_t) ((m >> 2) & 1) << (P8EST_MAXLEVEL - l);
+    state = t8_hilbert_oct_next[state][m];
+  }
+  q->x = x;
+  q->y = y;
+  q->z = z;
+  q->level = (int8_t) level;
+}
+
+/** Compute the Hilbert index at \a level of the first (if \a last is false)
+ * or last (if \a last is true) descendant of an octant that touches a face.
+ */
+static inline t8_linearidx_t
+t8_hilbert_oct_face_descendant_id (const p8est_quadrant_t * q, int face,
+                                   int level, int last)
+{
+  t8_linearidx_t      id = t8_hilbert_oct_linear_id (q, q->level);
+  int                 state = t8_hilbert_oct_state (q, q->level);
+  int                 l, i, m, best;
+
+  T8_ASSERT (0 <= face && face < P8EST_FACES);
+  T8_ASSERT (q->level <= level && level <= P8EST_QMAXLEVEL);
+  for (l = q->level + 1; l <= level; l++) {
+    /* Choose the face child that comes first or last in the curve */
+    best = p8est_face_corners[face][0];
+    for (i = 1; i < P8EST_HALF; i++) {
+      m = p8est_face_corners[face][i];
+      if ((t8_hilbert_oct_index[state][m] >
+           t8_hilbert_oct_index[state][best]) == (last != 0)) {
+        best = m;
+      }
+    }
+    id = (id << P8EST_DIM) | t8_hilbert_oct_index[state][best];
+    state = t8_hilbert_oct_next[state][best];
+  }
+  return id;
+}
+
+#endif /* !T8_DEFAULT_HILBERT_H */
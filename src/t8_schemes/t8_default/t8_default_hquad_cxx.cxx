@@ -0,0 +1,412 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <p4est_bits.h>
+#include "t8_default_hilbert.h"
+#include "t8_default_hquad_cxx.hxx"
+
+/* We want to export the whole implementation to be callable from "C" */
+T8_EXTERN_C_BEGIN ();
+
+/* The functions below translate between Hilbert indices and the Morton
+ * positions of the base scheme. The geometric work is done by qualified
+ * calls of the functions of t8_default_scheme_quad_c. */
+
+int
+t8_default_scheme_hquad_c::t8_element_compare (const t8_element_t * elem1,
+                                               const t8_element_t * elem2)
+{
+  const p4est_quadrant_t *q1 = (const p4est_quadrant_t *) elem1;
+  const p4est_quadrant_t *q2 = (const p4est_quadrant_t *) elem2;
+  const int           level = SC_MIN (q1->level, q2->level);
+  t8_linearidx_t      id1, id2;
+
+  T8_ASSERT (t8_element_is_valid (elem1));
+  T8_ASSERT (t8_element_is_valid (elem2));
+  /* Compare the ancestors on the coarser level. If they are equal,
+   * one element is an ancestor of the other and comes first. */
+  id1 = t8_hilbert_quad_linear_id (q1, level);
+  id2 = t8_hilbert_quad_linear_id (q2, level);
+  if (id1 != id2) {
+    return id1 < id2 ? -1 : 1;
+  }
+  return q1->level - q2->level;
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_sibling (const t8_element_t * elem,
+                                               int sibid,
+                                               t8_element_t * sibling)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+  int                 state;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (q->level > 0);
+  T8_ASSERT (0 <= sibid && sibid < P4EST_CHILDREN);
+  state = t8_hilbert_quad_state (q, q->level - 1);
+  t8_default_scheme_quad_c::t8_element_sibling (elem,
+                                                t8_hilbert_quad_morton[state]
+                                                [sibid], sibling);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_child (const t8_element_t * elem,
+                                             int childid,
+                                             t8_element_t * child)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+  int                 state;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= childid && childid < P4EST_CHILDREN);
+  state = t8_hilbert_quad_state (q, q->level);
+  t8_default_scheme_quad_c::t8_element_child (elem,
+                                              t8_hilbert_quad_morton[state]
+                                              [childid], child);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_children (const t8_element_t * elem,
+                                                int length,
+                                                t8_element_t * c[])
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+  int                 state, ichild;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (length == P4EST_CHILDREN);
+  state = t8_hilbert_quad_state (q, q->level);
+  /* We compute the zeroth child last, since elem may be c[0] */
+  for (ichild = P4EST_CHILDREN - 1; ichild >= 0; ichild--) {
+    t8_default_scheme_quad_c::t8_element_child (elem,
+                                                t8_hilbert_quad_morton[state]
+                                                [ichild], c[ichild]);
+  }
+}
+
+int
+t8_default_scheme_hquad_c::t8_element_child_id (const t8_element_t * elem)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  return q->level == 0 ? 0 : t8_default_scheme_hquad_c::t8_element_ancestor_id
+    (elem, q->level);
+}
+
+int
+t8_default_scheme_hquad_c::t8_element_ancestor_id (const t8_element_t * elem,
+                                                   int level)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (0 <= level && level <= q->level);
+  if (level == 0) {
+    return 0;
+  }
+  return t8_hilbert_quad_index[t8_hilbert_quad_state (q, level - 1)]
+    [t8_hilbert_quad_morton_child (q, level)];
+}
+
+int
+t8_default_scheme_hquad_c::t8_element_is_family (t8_element_t ** fam)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) fam[0];
+  p4est_quadrant_t    parent, child;
+  int                 state, ichild;
+
+#ifdef T8_ENABLE_DEBUG
+  for (ichild = 0; ichild < P4EST_CHILDREN; ichild++) {
+    T8_ASSERT (t8_element_is_valid (fam[ichild]));
+  }
+#endif
+  if (q->level == 0) {
+    return 0;
+  }
+  /* The elements must be the children of the parent of fam[0] in
+   * Hilbert order */
+  p4est_quadrant_parent (q, &parent);
+  state = t8_hilbert_quad_state (q, parent.level);
+  for (ichild = 0; ichild < P4EST_CHILDREN; ichild++) {
+    p4est_quadrant_child (&parent, &child,
+                          t8_hilbert_quad_morton[state][ichild]);
+    if (!p4est_quadrant_is_equal (&child,
+                                  (const p4est_quadrant_t *) fam[ichild])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_children_at_face (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_element_t *
+                                                        children[],
+                                                        int num_children,
+                                                        int *child_indices)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+  int                 morton[P4EST_HALF], ichild, swap;
+  int                 state;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < P4EST_FACES);
+  T8_ASSERT (num_children == P4EST_HALF);
+
+  /* The children at a face are the children in the face's corners,
+   * we sort them by their Hilbert index */
+  state = t8_hilbert_quad_state (q, q->level);
+  morton[0] = p4est_face_corners[face][0];
+  morton[1] = p4est_face_corners[face][1];
+  if (t8_hilbert_quad_index[state][morton[0]] >
+      t8_hilbert_quad_index[state][morton[1]]) {
+    swap = morton[0];
+    morton[0] = morton[1];
+    morton[1] = swap;
+  }
+  /* We compute the zeroth child last, since elem may be children[0] */
+  for (ichild = P4EST_HALF - 1; ichild >= 0; ichild--) {
+    if (child_indices != NULL) {
+      child_indices[ichild] = t8_hilbert_quad_index[state][morton[ichild]];
+    }
+    t8_default_scheme_quad_c::t8_element_child (elem, morton[ichild],
+                                                children[ichild]);
+  }
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_first_descendant_face (const
+                                                             t8_element_t *
+                                                             elem, int face,
+                                                             t8_element_t *
+                                                             first_desc,
+                                                             int level)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (0 <= face && face < P4EST_FACES);
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  t8_hilbert_quad_set ((p4est_quadrant_t *) first_desc, level,
+                       t8_hilbert_quad_face_descendant_id (q, face, level,
+                                                           0));
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_last_descendant_face (const
+                                                            t8_element_t *
+                                                            elem, int face,
+                                                            t8_element_t *
+                                                            last_desc,
+                                                            int level)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (0 <= face && face < P4EST_FACES);
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  t8_hilbert_quad_set ((p4est_quadrant_t *) last_desc, level,
+                       t8_hilbert_quad_face_descendant_id (q, face, level,
+                                                           1));
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_set_linear_id (t8_element_t * elem,
+                                                     int level,
+                                                     t8_linearidx_t id)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+  T8_ASSERT (0 <= id && id < ((t8_linearidx_t) 1) << P4EST_DIM * level);
+
+  t8_hilbert_quad_set ((p4est_quadrant_t *) elem, level, id);
+  T8_QUAD_SET_TDIM ((p4est_quadrant_t *) elem, 2);
+}
+
+t8_linearidx_t
+  t8_default_scheme_hquad_c::t8_element_get_linear_id (const t8_element_t *
+                                                       elem, int level)
+{
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+
+  return t8_hilbert_quad_linear_id ((const p4est_quadrant_t *) elem, level);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_first_descendant (const t8_element_t *
+                                                        elem,
+                                                        t8_element_t * desc,
+                                                        int level)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (t8_element_is_valid (desc));
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  t8_hilbert_quad_set ((p4est_quadrant_t *) desc, level,
+                       t8_hilbert_quad_linear_id (q, level));
+  T8_QUAD_SET_TDIM ((p4est_quadrant_t *) desc, 2);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_last_descendant (const t8_element_t *
+                                                       elem,
+                                                       t8_element_t * desc,
+                                                       int level)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (t8_element_is_valid (desc));
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  t8_hilbert_quad_set ((p4est_quadrant_t *) desc, level,
+                       t8_hilbert_quad_linear_id (q, level)
+                       + ((t8_linearidx_t) 1 << (P4EST_DIM *
+                                                 (level - q->level))) - 1);
+  T8_QUAD_SET_TDIM ((p4est_quadrant_t *) desc, 2);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_successor (const t8_element_t * elem1,
+                                                 t8_element_t * elem2,
+                                                 int level)
+{
+  t8_linearidx_t      id;
+
+  T8_ASSERT (t8_element_is_valid (elem1));
+  T8_ASSERT (t8_element_is_valid (elem2));
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+
+  id = t8_hilbert_quad_linear_id ((const p4est_quadrant_t *) elem1, level);
+  T8_ASSERT (id + 1 < ((t8_linearidx_t) 1) << P4EST_DIM * level);
+  /* The copy keeps the surround information of elem1 */
+  t8_default_scheme_quad_c::t8_element_copy (elem1, elem2);
+  t8_hilbert_quad_set ((p4est_quadrant_t *) elem2, level, id + 1);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_batch_child_id (const t8_element_t *
+                                                      elems, int count,
+                                                      int *child_ids)
+{
+  t8_default_batch_child_id<t8_pquad_t> (this, elems, count, child_ids);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_batch_children (const t8_element_t *
+                                                      elems, int count,
+                                                      t8_element_t * children)
+{
+  const t8_pquad_t   *e = (const t8_pquad_t *) elems;
+  t8_pquad_t         *c = (t8_pquad_t *) children;
+  int                 ielem, ichild, state;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    /* The state is computed once for all children */
+    state = t8_hilbert_quad_state (e + ielem, e[ielem].level);
+    for (ichild = 0; ichild < P4EST_CHILDREN; ichild++) {
+      t8_default_scheme_quad_c::t8_element_child ((const t8_element_t *)
+                                                  (e + ielem),
+                                                  t8_hilbert_quad_morton
+                                                  [state][ichild],
+                                                  (t8_element_t *) c++);
+    }
+  }
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_batch_get_linear_id (const t8_element_t
+                                                           * elems, int count,
+                                                           int level,
+                                                           t8_linearidx_t *
+                                                           ids)
+{
+  const t8_pquad_t   *e = (const t8_pquad_t *) elems;
+  int                 ielem;
+
+  T8_ASSERT (count >= 0);
+  for (ielem = 0; ielem < count; ielem++) {
+    ids[ielem] = t8_hilbert_quad_linear_id (e + ielem, level);
+  }
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_batch_set_linear_id (t8_element_t *
+                                                           elems, int count,
+                                                           int level,
+                                                           t8_linearidx_t
+                                                           first_id)
+{
+  t8_default_batch_set_linear_id<t8_pquad_t> (this, elems, count, level,
+                                              first_id);
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_descendant_range (const t8_element_t *
+                                                        elem, int level,
+                                                        t8_linearidx_t *
+                                                        first_id,
+                                                        t8_linearidx_t *
+                                                        last_id)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  /* The descendants of a quadrant are consecutive in the Hilbert order */
+  *first_id = t8_hilbert_quad_linear_id (q, level);
+  *last_id = *first_id
+    + ((t8_linearidx_t) 1 << (P4EST_DIM * (level - q->level))) - 1;
+}
+
+void
+t8_default_scheme_hquad_c::t8_element_face_descendant_range (const
+                                                             t8_element_t *
+                                                             elem, int face,
+                                                             int level,
+                                                             t8_linearidx_t *
+                                                             first_id,
+                                                             t8_linearidx_t *
+                                                             last_id)
+{
+  const p4est_quadrant_t *q = (const p4est_quadrant_t *) elem;
+
+  T8_ASSERT (t8_element_is_valid (elem));
+  T8_ASSERT (0 <= face && face < P4EST_FACES);
+  *first_id = t8_hilbert_quad_face_descendant_id (q, face, level, 0);
+  *last_id = t8_hilbert_quad_face_descendant_id (q, face, level, 1);
+}
+
+/* Constructor */
+t8_default_scheme_hquad_c::t8_default_scheme_hquad_c (void)
+{
+  /* The element class and size are set by the Morton scheme */
+}
+
+t8_default_scheme_hquad_c::~t8_default_scheme_hquad_c ()
+{
+  /* The destructor of the Morton scheme frees the memory pool */
+}
+
+T8_EXTERN_C_END ();
@@ -0,0 +1,295 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_default_morton.h
+ * Branch-free Morton code arithmetic for the quadrilateral and hexahedral
+ * schemes.
+ * The bits of a coordinate are spread to every second (2D) or every third
+ * (3D) bit with a fixed sequence of shifts and masks, yielding a dilated
+ * integer.  The Morton index is the bitwise or of the shifted dilated
+ * coordinates.  This replaces the loops over all levels of the p4est
+ * functions p4est_quadrant_linear_id and p4est_quadrant_set_morton.
+ * All functions are inline, since they are called in the innermost loops
+ * of the element schemes.
+ */
+
+#ifndef T8_DEFAULT_MORTON_H
+#define T8_DEFAULT_MORTON_H
+
+#include <t8.h>
+#include <p4est.h>
+#include <p8est.h>
+
+/** Spread the 32 bits of \a x to the even bits of a 64 bit integer. */
+static inline uint64_t
+t8_morton_dilate2 (uint32_t x)
+{
+  uint64_t            d = x;
+
+  d = (d | (d << 16)) & 0x0000FFFF0000FFFFULL;
+  d = (d | (d << 8)) & 0x00FF00FF00FF00FFULL;
+  d = (d | (d << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  d = (d | (d << 2)) & 0x3333333333333333ULL;
+  d = (d | (d << 1)) & 0x5555555555555555ULL;
+  return d;
+}
+
+/** Collect the even bits of \a d, the inverse of \ref t8_morton_dilate2. */
+static inline uint32_t
+t8_morton_undilate2 (uint64_t d)
+{
+  d &= 0x5555555555555555ULL;
+  d = (d | (d >> 1)) & 0x3333333333333333ULL;
+  d = (d | (d >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+  d = (d | (d >> 4)) & 0x00FF00FF00FF00FFULL;
+  d = (d | (d >> 8)) & 0x0000FFFF0000FFFFULL;
+  d = (d | (d >> 16)) & 0x00000000FFFFFFFFULL;
+  return (uint32_t) d;
+}
+
+/** Spread the lower 21 bits of \a x to every third bit of a 64 bit integer. */
+static inline uint64_t
+t8_morton_dilate3 (uint32_t x)
+{
+  uint64_t            d = x & 0x1FFFFF;
+
+  d = (d | (d << 32)) & 0x001F00000000FFFFULL;
+  d = (d | (d << 16)) & 0x001F0000FF0000FFULL;
+  d = (d | (d << 8)) & 0x100F00F00F00F00FULL;
+  d = (d | (d << 4)) & 0x10C30C30C30C30C3ULL;
+  d = (d | (d << 2)) & 0x1249249249249249ULL;
+  return d;
+}
+
+/** Collect every third bit of \a d, the inverse of \ref t8_morton_dilate3. */
+static inline uint32_t
+t8_morton_undilate3 (uint64_t d)
+{
+  d &= 0x1249249249249249ULL;
+  d = (d | (d >> 2)) & 0x10C30C30C30C30C3ULL;
+  d = (d | (d >> 4)) & 0x100F00F00F00F00FULL;
+  d = (d | (d >> 8)) & 0x001F0000FF0000FFULL;
+  d = (d | (d >> 16)) & 0x001F00000000FFFFULL;
+  d = (d | (d >> 32)) & 0x00000000001FFFFFULL;
+  return (uint32_t) d;
+}
+
+/** Compute the Morton index of 2D integer coordinates. */
+static inline t8_linearidx_t
+t8_morton_encode2 (uint32_t x, uint32_t y)
+{
+  return t8_morton_dilate2 (x) | (t8_morton_dilate2 (y) << 1);
+}
+
+/** Compute the 2D integer coordinates of a Morton index. */
+static inline void
+t8_morton_decode2 (t8_linearidx_t id, uint32_t * x, uint32_t * y)
+{
+  *x = t8_morton_undilate2 (id);
+  *y = t8_morton_undilate2 (id >> 1);
+}
+
+/** Compute the Morton index of 3D integer coordinates below 2^21. */
+static inline t8_linearidx_t
+t8_morton_encode3 (uint32_t x, uint32_t y, uint32_t z)
+{
+  return t8_morton_dilate3 (x) | (t8_morton_dilate3 (y) << 1)
+    | (t8_morton_dilate3 (z) << 2);
+}
+
+/** Compute the 3D integer coordinates of a Morton index. */
+static inline void
+t8_morton_decode3 (t8_linearidx_t id, uint32_t * x, uint32_t * y,
+                   uint32_t * z)
+{
+  *x = t8_morton_undilate3 (id);
+  *y = t8_morton_undilate3 (id >> 1);
+  *z = t8_morton_undilate3 (id >> 2);
+}
+
+/** Return the number of significant bits of \a x, 0 for x = 0. */
+static inline int
+t8_morton_bit_length (uint32_t x)
+{
+#ifdef __GNUC__
+  return x == 0 ? 0 : 32 - __builtin_clz (x);
+#else
+  return SC_LOG2_32 (x) + 1;
+#endif
+}
+
+/** Compute the level of the nearest common ancestor of two elements from
+ * the exclusive or of their coordinates.
+ * \param [in] exclor     The bitwise or of the exclusive or of each pair of
+ *                        coordinates of the two elements.
+ * \param [in] maxlevel   The maximum level of a coordinate, P4EST_MAXLEVEL
+ *                        or P8EST_MAXLEVEL.
+ * \param [in] level1     The level of the first element.
+ * \param [in] level2     The level of the second element.
+ * \return                The level of the nearest common ancestor.
+ */
+static inline int
+t8_morton_nca_level (uint32_t exclor, int maxlevel, int level1, int level2)
+{
+  const int           level = maxlevel - t8_morton_bit_length (exclor);
+
+  return SC_MIN (level, SC_MIN (level1, level2));
+}
+
+/** Compute the Morton index of a quadrant, same as p4est_quadrant_linear_id.
+ * As in p4est, we keep two bits above \a level for extended quadrants.
+ */
+static inline t8_linearidx_t
+t8_morton_quad_linear_id (const p4est_quadrant_t * q, int level)
+{
+  const int           shift = P4EST_MAXLEVEL - level;
+  const uint32_t      mask = (uint32_t) (((uint64_t) 1 << (level + 2)) - 1);
+
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+  return t8_morton_encode2 ((uint32_t) (q->x >> shift) & mask,
+                            (uint32_t) (q->y >> shift) & mask);
+}
+
+/** Set a quadrant from its Morton index, same as p4est_quadrant_set_morton
+ * for quadrants inside the root.  Only the coordinates and the level of
+ * \a q are written. */
+static inline void
+t8_morton_quad_set (p4est_quadrant_t * q, int level, t8_linearidx_t id)
+{
+  const int           shift = P4EST_MAXLEVEL - level;
+  uint32_t            x, y;
+
+  T8_ASSERT (0 <= level && level <= P4EST_QMAXLEVEL);
+  T8_ASSERT (id < ((t8_linearidx_t) 1) << P4EST_DIM * level);
+  t8_morton_decode2 (id, &x, &y);
+  q->x = (p4est_qcoord_t) (x << shift);
+  q->y = (p4est_qcoord_t) (y << shift);
+  q->level = (int8_t) level;
+}
+
+/** Compute the nearest common ancestor of two quadrants, same as
+ * p4est_nearest_common_ancestor.  \a r may be equal to \a q1 or \a q2.
+ * Only the coordinates and the level of \a r are written. */
+static inline void
+t8_morton_quad_nca (const p4est_quadrant_t * q1, const p4est_quadrant_t * q2,
+                    p4est_quadrant_t * r)
+{
+  const uint32_t      exclor = (uint32_t) ((q1->x ^ q2->x) | (q1->y ^ q2->y));
+  const int           level = t8_morton_nca_level (exclor, P4EST_MAXLEVEL,
+                                                   q1->level, q2->level);
+  const p4est_qcoord_t mask = ~(P4EST_QUADRANT_LEN (level) - 1);
+
+  r->x = q1->x & mask;
+  r->y = q1->y & mask;
+  r->level = (int8_t) level;
+}
+
+/** Compute the Morton index at \a level of the descendant of a quadrant in
+ * a given corner, same as the index of the result of
+ * p4est_quadrant_corner_descendant, without constructing the descendant. */
+static inline t8_linearidx_t
+t8_morton_quad_corner_descendant_id (const p4est_quadrant_t * q,
+                                     int corner, int level)
+{
+  const p4est_qcoord_t shift =
+    P4EST_QUADRANT_LEN (q->level) - P4EST_QUADRANT_LEN (level);
+  p4est_quadrant_t    d;
+
+  T8_ASSERT (q->level <= level && level <= P4EST_QMAXLEVEL);
+  T8_ASSERT (0 <= corner && corner < P4EST_CHILDREN);
+  d.x = q->x + ((corner & 1) ? shift : 0);
+  d.y = q->y + ((corner & 2) ? shift : 0);
+  return t8_morton_quad_linear_id (&d, level);
+}
+
+/** Compute the Morton index of an octant, same as p8est_quadrant_linear_id.
+ * As in p8est, we keep two bits above \a level for extended octants.
+ */
+static inline t8_linearidx_t
+t8_morton_oct_linear_id (const p8est_quadrant_t * q, int level)
+{
+  const int           shift = P8EST_MAXLEVEL - level;
+  const uint32_t      mask = (uint32_t) (((uint64_t) 1 << (level + 2)) - 1);
+
+  T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
+  return t8_morton_encode3 ((uint32_t) (q->x >> shift) & mask,
+                            (uint32_t) (q->y >> shift) & mask,
+                            (uint32_t) (q->z >> shift) & mask);
+}
+
+/** Set an octant from its Morton index, same as p8est_quadrant_set_morton
+ * for octants inside the root.  Only the coordinates and the level of
+ * \a q are written. */
+static inline void
+t8_morton_oct_set (p8est_quadrant_t * q, int level, t8_linearidx_t id)
+{
+  const int           shift = P8EST_MAXLEVEL - level;
+  uint32_t            x, y, z;
+
+  T8_ASSERT (0 <= level && level <= P8EST_QMAXLEVEL);
+  T8_ASSERT (id < ((t8_linearidx_t) 1) << P8EST_DIM * level);
+  t8_morton_decode3 (id, &x, &y, &z);
+  q->x = (p4est_qcoord_t) (x << shift);
+  q->y = (p4est_qcoord_t) (y << shift);
+  q->z = (p4est_qcoord_t) (z << shift);
+  q->level = (int8_t) level;
+}
+
+/** Compute the nearest common ancestor of two octants, same as
+ * p8est_nearest_common_ancestor.  \a r may be equal to \a q1 or \a q2.
+ * Only the coordinates and the level of \a r are written. */
+static inline void
+t8_morton_oct_nca (const p8est_quadrant_t * q1, const p8est_quadrant_t * q2,
+                   p8est_quadrant_t * r)
+{
+  const uint32_t      exclor =
+    (uint32_t) ((q1->x ^ q2->x) | (q1->y ^ q2->y) | (q1->z ^ q2->z));
+  const int           level = t8_morton_nca_level (exclor, P8EST_MAXLEVEL,
+                                                   q1->level, q2->level);
+  const p4est_qcoord_t mask = ~(P8EST_QUADRANT_LEN (level) - 1);
+
+  r->x = q1->x & mask;
+  r->y = q1->y & mask;
+  r->z = q1->z & mask;
+  r->level = (int8_t) level;
+}
+
+/** Compute the Morton index at \a level of the descendant of an octant in
+ * a given corner, same as the index of the result of
+ * p8est_quadrant_corner_descendant, without constructing the descendant. */
+static inline t8_linearidx_t
+t8_morton_oct_corner_descendant_id (const p8est_quadrant_t * q,
+                                    int corner, int level)
+{
+  const p4est_qcoord_t shift =
+    P8EST_QUADRANT_LEN (q->level) - P8EST_QUADRANT_LEN (level);
+  p8est_quadrant_t    d;
+
+  T8_ASSERT (q->level <= level && level <= P8EST_QMAXLEVEL);
+  T8_ASSERT (0 <= corner && corner < P8EST_CHILDREN);
+  d.x = q->x + ((corner & 1) ? shift : 0);
+  d.y = q->y + ((corner & 2) ? shift : 0);
+  d.z = q->z + ((corner & 4) ? shift : 0);
+  return t8_morton_oct_linear_id (&d, level);
+}
+
+#endif /* !T8_DEFAULT_MORTON_H */
@@ -422,6 +422,63 @@ t8_default_scheme_prism_c::t8_element_is_valid (const t8_element_t * elem) const
 /* *INDENT-ON* */
 #endif /* T8_ENABLE_DEBUG */
 
+void
+t8_default_scheme_prism_c::t8_element_batch_level (const t8_element_t * elems,
+                                                   int count, int *levels)
+{
+  t8_default_batch_level<t8_default_prism_t> (this, elems, count, levels);
+}
+
+void
+t8_default_scheme_prism_c::t8_element_batch_child_id (const t8_element_t * elems,
+                                                      int count,
+                                                      int *child_ids)
+{
+  t8_default_batch_child_id<t8_default_prism_t> (this, elems, count,
+                                                 child_ids);
+}
+
+void
+t8_default_scheme_prism_c::t8_element_batch_parent (const t8_element_t * elems,
+                                                    int count,
+                                                    t8_element_t * parents)
+{
+  t8_default_batch_parent<t8_default_prism_t> (this, elems, count, parents);
+}
+
+void
+t8_default_scheme_prism_c::t8_element_batch_children (const t8_element_t * elems,
+                                                      int count,
+                                                      t8_element_t * children)
+{
+  t8_default_batch_children<t8_default_prism_t, T8_DPRISM_CHILDREN> (this,
+                                                                     elems,
+                                                                     count,
+                                                                     children);
+}
+
+void
+t8_default_scheme_prism_c::t8_element_batch_get_linear_id (const t8_element_t *
+                                                           elems, int count,
+                                                           int level,
+                                                           t8_linearidx_t * ids)
+{
+  t8_default_batch_get_linear_id<t8_default_prism_t> (this, elems, count,
+                                                      level, ids);
+}
+
+void
+t8_default_scheme_prism_c::t8_element_batch_set_linear_id (t8_element_t *
+                                                           elems, int count,
+                                                           int level,
+                                                           t8_linearidx_t
+                                                           first_id)
+{
+  t8_default_batch_set_linear_id_successor<t8_default_prism_t> (this, elems,
+                                                                count, level,
+                                                                first_id);
+}
+
 /* Constructor */
 t8_default_scheme_prism_c::t8_default_scheme_prism_c (void)
 {
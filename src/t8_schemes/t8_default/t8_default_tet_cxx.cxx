@@ -25,6 +25,7 @@
 #include "t8_dtet_bits.h"
 #include "t8_dtri_bits.h"
 #include "t8_dtet_connectivity.h"
+#include "t8_dtet_bits_inline.h"
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -70,7 +71,7 @@ t8_default_scheme_tet_c::t8_element_parent (const t8_element_t * elem,
 
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (t8_element_is_valid (parent));
-  t8_dtet_parent (t, p);
+  t8_dtet_parent_inline (t, p);
 }
 
 void
@@ -83,7 +84,7 @@ t8_default_scheme_tet_c::t8_element_sibling (const t8_element_t * elem,
 
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (t8_element_is_valid (sibling));
-  t8_dtet_sibling (t, sibid, s);
+  t8_dtet_sibling_inline (t, sibid, s);
 }
 
 int
@@ -133,7 +134,7 @@ t8_default_scheme_tet_c::t8_element_child (const t8_element_t * elem,
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (t8_element_is_valid (child));
 
-  t8_dtet_child (t, childid, c);
+  t8_dtet_child_inline (t, childid, c);
 }
 
 void
@@ -155,7 +156,7 @@ int
 t8_default_scheme_tet_c::t8_element_child_id (const t8_element_t * elem)
 {
   T8_ASSERT (t8_element_is_valid (elem));
-  return t8_dtet_child_id ((const t8_dtet_t *) elem);
+  return t8_dtet_child_id_inline ((const t8_dtet_t *) elem);
 }
 
 int
@@ -443,7 +444,7 @@ t8_default_scheme_tet_c::t8_element_face_neighbor_inside (const t8_element_t *
   T8_ASSERT (t8_element_is_valid (neigh));
   T8_ASSERT (0 <= face && face < T8_DTET_FACES);
   T8_ASSERT (neigh_face != NULL);
-  *neigh_face = t8_dtet_face_neighbour (t, face, n);
+  *neigh_face = t8_dtet_face_neighbour_inline (t, face, n);
   /* return true if neigh is inside the root */
   return t8_dtet_is_inside_root (n);
 }
@@ -531,7 +532,8 @@ t8_default_scheme_tet_c::t8_element_vertex_coords (const t8_element_t * t,
                                                    int vertex, int coords[])
 {
   T8_ASSERT (t8_element_is_valid (t));
-  t8_dtet_compute_coords ((const t8_default_tet_t *) t, vertex, coords);
+  t8_dtet_compute_coords_inline ((const t8_default_tet_t *) t, vertex,
+                                 coords);
 }
 
 void
@@ -591,6 +593,98 @@ t8_default_scheme_tet_c::t8_element_init (int length, t8_element_t * elem,
 #endif
 }
 
+void
+t8_default_scheme_tet_c::t8_element_batch_level (const t8_element_t * elems,
+                                                 int count, int *levels)
+{
+  t8_default_batch_level<t8_dtet_t> (this, elems, count, levels);
+}
+
+void
+t8_default_scheme_tet_c::t8_element_batch_child_id (const t8_element_t * elems,
+                                                    int count, int *child_ids)
+{
+  t8_default_batch_child_id<t8_dtet_t> (this, elems, count, child_ids);
+}
+
+void
+t8_default_scheme_tet_c::t8_element_batch_parent (const t8_element_t * elems,
+                                                  int count,
+                                                  t8_element_t * parents)
+{
+  t8_default_batch_parent<t8_dtet_t> (this, elems, count, parents);
+}
+
+void
+t8_default_scheme_tet_c::t8_element_batch_children (const t8_element_t * elems,
+                                                    int count,
+                                                    t8_element_t * children)
+{
+  t8_default_batch_children<t8_dtet_t, T8_DTET_CHILDREN> (this, elems, count,
+                                                          children);
+}
+
+void
+t8_default_scheme_tet_c::t8_element_batch_get_linear_id (const t8_element_t *
+                                                         elems, int count,
+                                                         int level,
+                                                         t8_linearidx_t * ids)
+{
+  T8_ASSERT (count >= 0);
+  /* All elements are processed by the vectorizable batch routine */
+  t8_dtet_linear_id_batch ((const t8_dtet_t *) elems, count, level, ids);
+}
+
+void
+t8_default_scheme_tet_c::t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                         int count, int level,
+                                                         t8_linearidx_t
+                                                         first_id)
+{
+  t8_default_batch_set_linear_id_successor<t8_dtet_t> (this, elems, count,
+                                                       level, first_id);
+}
+
+int
+t8_default_scheme_tet_c::t8_element_tree_face_neighbor (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_eclass_scheme_c *
+                                                        boundary_scheme,
+                                                        int orientation,
+                                                        int sign,
+                                                        int is_smaller_face,
+                                                        t8_eclass_scheme_c *
+                                                        neigh_scheme,
+                                                        t8_element_t * neigh,
+                                                        int neigh_tree_face)
+{
+  t8_dtri_t          face_element;
+  t8_element_t       *face_elem = (t8_element_t *) &face_element;
+
+  if (neigh_scheme != this) {
+    /* The neighbor tree is a prism */
+    return t8_eclass_scheme::t8_element_tree_face_neighbor (elem, face,
+                                                            boundary_scheme,
+                                                            orientation,
+                                                            sign,
+                                                            is_smaller_face,
+                                                            neigh_scheme,
+                                                            neigh,
+                                                            neigh_tree_face);
+  }
+  /* The triangle of the face lives on the stack and we call the scheme
+   * functions non-virtually */
+  memset (&face_element, 0, sizeof (t8_dtri_t));
+  t8_default_scheme_tet_c::t8_element_boundary_face (elem, face, face_elem,
+                                                     boundary_scheme);
+  t8_dtri_transform_face (&face_element, &face_element, orientation, sign,
+                          is_smaller_face);
+  return t8_default_scheme_tet_c::t8_element_extrude_face (face_elem,
+                                                           boundary_scheme,
+                                                           neigh,
+                                                           neigh_tree_face);
+}
+
  /* Constructor */
 t8_default_scheme_tet_c::t8_default_scheme_tet_c (void)
 {
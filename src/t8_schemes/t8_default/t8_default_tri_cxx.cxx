@@ -26,6 +26,7 @@
 #include "t8_dline_bits.h"
 #include "t8_dtet.h"
 #include "t8_dtri_connectivity.h"
+#include "t8_dtri_bits_inline.h"
 
 /* We want to export the whole implementation to be callable from "C" */
 T8_EXTERN_C_BEGIN ();
@@ -72,7 +73,7 @@ t8_default_scheme_tri_c::t8_element_parent (const t8_element_t * elem,
 
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (t8_element_is_valid (parent));
-  t8_dtri_parent (t, p);
+  t8_dtri_parent_inline (t, p);
 }
 
 void
@@ -84,7 +85,7 @@ t8_default_scheme_tri_c::t8_element_sibling (const t8_element_t * elem,
   t8_dtri_t          *s = (t8_dtri_t *) sibling;
 
   T8_ASSERT (t8_element_is_valid (elem));
-  t8_dtri_sibling (t, sibid, s);
+  t8_dtri_sibling_inline (t, sibid, s);
 }
 
 int
@@ -146,7 +147,7 @@ t8_default_scheme_tri_c::t8_element_child (const t8_element_t * elem,
 
   T8_ASSERT (t8_element_is_valid (elem));
   T8_ASSERT (t8_element_is_valid (child));
-  t8_dtri_child (t, childid, c);
+  t8_dtri_child_inline (t, childid, c);
 }
 
 void
@@ -171,7 +172,7 @@ int
 t8_default_scheme_tri_c::t8_element_child_id (const t8_element_t * elem)
 {
   T8_ASSERT (t8_element_is_valid (elem));
-  return t8_dtri_child_id ((t8_dtri_t *) elem);
+  return t8_dtri_child_id_inline ((t8_dtri_t *) elem);
 }
 
 int
@@ -464,7 +465,7 @@ t8_default_scheme_tri_c::t8_element_face_neighbor_inside (const t8_element_t *
   T8_ASSERT (0 <= face && face < T8_DTRI_FACES);
   T8_ASSERT (neigh_face != NULL);
 
-  *neigh_face = t8_dtri_face_neighbour (t, face, n);
+  *neigh_face = t8_dtri_face_neighbour_inline (t, face, n);
   /* return true if neigh is inside the root */
   return t8_dtri_is_inside_root (n);
 }
@@ -552,7 +553,7 @@ t8_default_scheme_tri_c::t8_element_vertex_coords (const t8_element_t * t,
                                                    int vertex, int coords[])
 {
   T8_ASSERT (t8_element_is_valid (t));
-  t8_dtri_compute_coords ((const t8_dtri_t *) t, vertex, coords);
+  t8_dtri_compute_coords_inline ((const t8_dtri_t *) t, vertex, coords);
 }
 
 void
@@ -611,6 +612,97 @@ t8_default_scheme_tri_c::t8_element_init (int length, t8_element_t * elem,
 #endif
 }
 
+void
+t8_default_scheme_tri_c::t8_element_batch_level (const t8_element_t * elems,
+                                                 int count, int *levels)
+{
+  t8_default_batch_level<t8_dtri_t> (this, elems, count, levels);
+}
+
+void
+t8_default_scheme_tri_c::t8_element_batch_child_id (const t8_element_t * elems,
+                                                    int count, int *child_ids)
+{
+  t8_default_batch_child_id<t8_dtri_t> (this, elems, count, child_ids);
+}
+
+void
+t8_default_scheme_tri_c::t8_element_batch_parent (const t8_element_t * elems,
+                                                  int count,
+                                                  t8_element_t * parents)
+{
+  t8_default_batch_parent<t8_dtri_t> (this, elems, count, parents);
+}
+
+void
+t8_default_scheme_tri_c::t8_element_batch_children (const t8_element_t * elems,
+                                                    int count,
+                                                    t8_element_t * children)
+{
+  t8_default_batch_children<t8_dtri_t, T8_DTRI_CHILDREN> (this, elems, count,
+                                                          children);
+}
+
+void
+t8_default_scheme_tri_c::t8_element_batch_get_linear_id (const t8_element_t *
+                                                         elems, int count,
+                                                         int level,
+                                                         t8_linearidx_t * ids)
+{
+  T8_ASSERT (count >= 0);
+  /* All elements are processed by the vectorizable batch routine */
+  t8_dtri_linear_id_batch ((const t8_dtri_t *) elems, count, level, ids);
+}
+
+void
+t8_default_scheme_tri_c::t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                         int count, int level,
+                                                         t8_linearidx_t
+                                                         first_id)
+{
+  t8_default_batch_set_linear_id_successor<t8_dtri_t> (this, elems, count,
+                                                       level, first_id);
+}
+
+int
+t8_default_scheme_tri_c::t8_element_tree_face_neighbor (const t8_element_t *
+                                                        elem, int face,
+                                                        t8_eclass_scheme_c *
+                                                        boundary_scheme,
+                                                        int orientation,
+                                                        int sign,
+                                                        int is_smaller_face,
+                                                        t8_eclass_scheme_c *
+                                                        neigh_scheme,
+                                                        t8_element_t * neigh,
+                                                        int neigh_tree_face)
+{
+  t8_dline_t         face_element;
+  t8_element_t       *face_elem = (t8_element_t *) &face_element;
+
+  if (neigh_scheme != this) {
+    /* The neighbor tree is a quadrilateral */
+    return t8_eclass_scheme::t8_element_tree_face_neighbor (elem, face,
+                                                            boundary_scheme,
+                                                            orientation,
+                                                            sign,
+                                                            is_smaller_face,
+                                                            neigh_scheme,
+                                                            neigh,
+                                                            neigh_tree_face);
+  }
+  /* The line of the face lives on the stack and we call the scheme
+   * functions non-virtually */
+  memset (&face_element, 0, sizeof (t8_dline_t));
+  t8_default_scheme_tri_c::t8_element_boundary_face (elem, face, face_elem,
+                                                     boundary_scheme);
+  t8_dline_transform_face (&face_element, &face_element, orientation);
+  return t8_default_scheme_tri_c::t8_element_extrude_face (face_elem,
+                                                           boundary_scheme,
+                                                           neigh,
+                                                           neigh_tree_face);
+}
+
 /* Constructor */
 t8_default_scheme_tri_c::t8_default_scheme_tri_c (void)
 {
@@ -269,6 +269,50 @@ public:
                                                    const void *indata,
                                                    void *outdata);
 
+  /** Compute the levels of a range of contiguous elements. */
+  virtual void        t8_element_batch_level (const t8_element_t * elems,
+                                              int count, int *levels);
+
+  /** Compute the child ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_child_id (const t8_element_t * elems,
+                                                 int count, int *child_ids);
+
+  /** Compute the parents of a range of contiguous elements. */
+  virtual void        t8_element_batch_parent (const t8_element_t * elems,
+                                               int count,
+                                               t8_element_t * parents);
+
+  /** Compute the children of a range of contiguous elements. */
+  virtual void        t8_element_batch_children (const t8_element_t * elems,
+                                                 int count,
+                                                 t8_element_t * children);
+
+  /** Compute the linear ids of a range of contiguous elements. */
+  virtual void        t8_element_batch_get_linear_id (const t8_element_t *
+                                                      elems, int count,
+                                                      int level,
+                                                      t8_linearidx_t * ids);
+
+  /** Initialize a range of contiguous elements with consecutive linear ids. */
+  virtual void        t8_element_batch_set_linear_id (t8_element_t * elems,
+                                                      int count, int level,
+                                                      t8_linearidx_t first_id);
+
+  /** Construct the face neighbor of an element across a tree face.
+   * If the neighbor tree is of the same class, no virtual calls or temporary
+   * elements are needed. */
+  virtual int         t8_element_tree_face_neighbor (const t8_element_t *
+                                                     elem, int face,
+                                                     t8_eclass_scheme_c *
+                                                     boundary_scheme,
+                                                     int orientation,
+                                                     int sign,
+                                                     int is_smaller_face,
+                                                     t8_eclass_scheme_c *
+                                                     neigh_scheme,
+                                                     t8_element_t * neigh,
+                                                     int neigh_tree_face);
+
 #ifdef T8_ENABLE_DEBUG
   /** Query whether an element is valid */
   virtual int         t8_element_is_valid (const t8_element_t * t) const;
@@ -72,12 +72,12 @@ t8_dprism_compare (const t8_dprism_t * p1, const t8_dprism_t * p2)
 }
 
 void
-t8_dprism_init_linear_id (t8_dprism_t * p, int level, uint64_t id)
+t8_dprism_init_linear_id_per_level (t8_dprism_t * p, int level, uint64_t id)
 {
   uint64_t            tri_id = 0;
   uint64_t            line_id = 0;
   int                 i;
-  int                 triangles_of_size_i = 1;
+  uint64_t            triangles_of_size_i = 1;
 
   T8_ASSERT (0 <= level && level <= T8_DPRISM_MAXLEVEL);
   T8_ASSERT (id < sc_intpow64u (T8_DPRISM_CHILDREN, level));
@@ -263,6 +263,77 @@ t8_dprism_child (const t8_dprism_t * p, int childid, t8_dprism_t * child)
   T8_ASSERT (child->line.level == child->tri.level);
 }
 
+void
+t8_dprism_child_line (const t8_dprism_t * p, int childid,
+                      t8_dprism_t * child)
+{
+  T8_ASSERT (0 <= childid && childid < T8_DLINE_CHILDREN);
+  T8_ASSERT (p->line.level < T8_DPRISM_MAXLEVEL);
+  t8_dtri_copy (&p->tri, &child->tri);
+  t8_dline_child (&p->line, childid, &child->line);
+}
+
+void
+t8_dprism_child_tri (const t8_dprism_t * p, int childid, t8_dprism_t * child)
+{
+  T8_ASSERT (0 <= childid && childid < T8_DTRI_CHILDREN);
+  T8_ASSERT (p->tri.level < T8_DPRISM_MAXLEVEL);
+  t8_dline_copy (&p->line, &child->line);
+  t8_dtri_child (&p->tri, childid, &child->tri);
+}
+
+void
+t8_dprism_parent_line (const t8_dprism_t * p, t8_dprism_t * parent)
+{
+  T8_ASSERT (p->line.level > 0);
+  t8_dtri_copy (&p->tri, &parent->tri);
+  t8_dline_parent (&p->line, &parent->line);
+}
+
+void
+t8_dprism_parent_tri (const t8_dprism_t * p, t8_dprism_t * parent)
+{
+  T8_ASSERT (p->tri.level > 0);
+  t8_dline_copy (&p->line, &parent->line);
+  t8_dtri_parent (&p->tri, &parent->tri);
+}
+
+int
+t8_dprism_is_family_line (t8_dprism_t ** fam)
+{
+  const t8_dline_t   *line_fam[T8_DLINE_CHILDREN];
+  int                 i;
+
+  for (i = 0; i < T8_DLINE_CHILDREN; i++) {
+    /* All children have the same triangle */
+    if (fam[0]->tri.level != fam[i]->tri.level
+        || fam[0]->tri.type != fam[i]->tri.type
+        || fam[0]->tri.x != fam[i]->tri.x
+        || fam[0]->tri.y != fam[i]->tri.y) {
+      return 0;
+    }
+    line_fam[i] = &fam[i]->line;
+  }
+  return t8_dline_is_familypv (line_fam);
+}
+
+int
+t8_dprism_is_family_tri (t8_dprism_t ** fam)
+{
+  const t8_dtri_t    *tri_fam[T8_DTRI_CHILDREN];
+  int                 i;
+
+  for (i = 0; i < T8_DTRI_CHILDREN; i++) {
+    /* All children have the same line */
+    if (fam[0]->line.level != fam[i]->line.level
+        || fam[0]->line.x != fam[i]->line.x) {
+      return 0;
+    }
+    tri_fam[i] = &fam[i]->tri;
+  }
+  return t8_dtri_is_familypv (tri_fam);
+}
+
 t8_element_shape_t
 t8_dprism_face_shape (const t8_dprism_t * p, int face)
 {
@@ -571,7 +642,7 @@ t8_dprism_vertex_coords (const t8_dprism_t * p, int vertex, int coords[3])
 }
 
 uint64_t
-t8_dprism_linear_id (const t8_dprism_t * p, int level)
+t8_dprism_linear_id_per_level (const t8_dprism_t * p, int level)
 {
   uint64_t            id = 0;
   uint64_t            tri_id;
@@ -619,6 +690,136 @@ t8_dprism_linear_id (const t8_dprism_t * p, int level)
   return id;
 }
 
+/* The linear id of a prism has 3 bits per level. The lower two bits are the
+ * local id of the triangle and the upper bit is the local id of the line.
+ * We thus interleave the triangle and line ids using lookup tables that
+ * process T8_DPRISM_TABLE_LEVELS levels at once. */
+#define T8_DPRISM_TABLE_LEVELS 4
+
+/* For 4 levels of a triangle id, the bits spread to the prism id positions */
+static uint16_t     t8_dprism_tri_spread[1 << (2 * T8_DPRISM_TABLE_LEVELS)];
+/* For 4 levels of a line id, the bits spread to the prism id positions */
+static uint16_t     t8_dprism_line_spread[1 << T8_DPRISM_TABLE_LEVELS];
+/* For 4 levels of a prism id, the triangle id bits and the line id bits
+ * in the upper byte */
+static uint16_t     t8_dprism_compact[1 << (3 * T8_DPRISM_TABLE_LEVELS)];
+static int          t8_dprism_tables_initialized = 0;
+
+/* Fill the lookup tables to interleave triangle and line ids */
+static void
+t8_dprism_tables_init (void)
+{
+  int                 input, j, tri_bits, line_bits;
+
+  for (input = 0; input < 1 << (2 * T8_DPRISM_TABLE_LEVELS); input++) {
+    t8_dprism_tri_spread[input] = 0;
+    for (j = 0; j < T8_DPRISM_TABLE_LEVELS; j++) {
+      t8_dprism_tri_spread[input] |= ((input >> (2 * j)) & 3) << (3 * j);
+    }
+  }
+  for (input = 0; input < 1 << T8_DPRISM_TABLE_LEVELS; input++) {
+    t8_dprism_line_spread[input] = 0;
+    for (j = 0; j < T8_DPRISM_TABLE_LEVELS; j++) {
+      t8_dprism_line_spread[input] |= ((input >> j) & 1) << (3 * j + 2);
+    }
+  }
+  for (input = 0; input < 1 << (3 * T8_DPRISM_TABLE_LEVELS); input++) {
+    tri_bits = line_bits = 0;
+    for (j = 0; j < T8_DPRISM_TABLE_LEVELS; j++) {
+      tri_bits |= ((input >> (3 * j)) & 3) << (2 * j);
+      line_bits |= ((input >> (3 * j + 2)) & 1) << j;
+    }
+    t8_dprism_compact[input] = tri_bits | (line_bits << 8);
+  }
+  t8_dprism_tables_initialized = 1;
+}
+
+void
+t8_dprism_init_linear_id (t8_dprism_t * p, int level, uint64_t id)
+{
+  uint64_t            tri_id = 0;
+  uint64_t            line_id = 0;
+  uint16_t            compact;
+  int                 i;
+#ifdef T8_ENABLE_DEBUG
+  t8_dprism_t         check;
+#endif
+
+  T8_ASSERT (0 <= level && level <= T8_DPRISM_MAXLEVEL);
+  T8_ASSERT (id < sc_intpow64u (T8_DPRISM_CHILDREN, level));
+  if (!t8_dprism_tables_initialized) {
+    t8_dprism_tables_init ();
+  }
+  for (i = 0; i < level; i += T8_DPRISM_TABLE_LEVELS) {
+    compact =
+      t8_dprism_compact[(id >> (3 * i)) &
+                        ((1 << (3 * T8_DPRISM_TABLE_LEVELS)) - 1)];
+    tri_id |= ((uint64_t) (compact & 0xff)) << (2 * i);
+    line_id |= ((uint64_t) (compact >> 8)) << i;
+  }
+  t8_dtri_init_linear_id (&p->tri, tri_id, level);
+  t8_dline_init_linear_id (&p->line, level, line_id);
+
+  T8_ASSERT (p->line.level == p->tri.level);
+#ifdef T8_ENABLE_DEBUG
+  t8_dprism_init_linear_id_per_level (&check, level, id);
+  T8_ASSERT (!t8_dprism_compare (&check, p));
+#endif
+}
+
+uint64_t
+t8_dprism_linear_id (const t8_dprism_t * p, int level)
+{
+  uint64_t            id = 0;
+  uint64_t            tri_id;
+  uint64_t            line_id;
+  int                 i;
+
+  T8_ASSERT (0 <= level && level <= T8_DPRISM_MAXLEVEL);
+  T8_ASSERT (p->line.level == p->tri.level);
+  if (!t8_dprism_tables_initialized) {
+    t8_dprism_tables_init ();
+  }
+  tri_id = t8_dtri_linear_id (&p->tri, level);
+  line_id = t8_dline_linear_id (&p->line, level);
+  for (i = 0; i < level; i += T8_DPRISM_TABLE_LEVELS) {
+    id |= ((uint64_t)
+           (t8_dprism_tri_spread[(tri_id >> (2 * i)) & 0xff]
+            | t8_dprism_line_spread[(line_id >> i) & 0xf])) << (3 * i);
+  }
+  T8_ASSERT (id == t8_dprism_linear_id_per_level (p, level));
+  return id;
+}
+
+uint64_t
+t8_dprism_linear_id_aniso (const t8_dprism_t * p)
+{
+  T8_ASSERT (t8_dprism_is_valid_aniso (p));
+  return (t8_dtri_linear_id (&p->tri, p->tri.level) << p->line.level)
+    + t8_dline_linear_id (&p->line, p->line.level);
+}
+
+void
+t8_dprism_init_linear_id_aniso (t8_dprism_t * p, int line_level,
+                                int tri_level, uint64_t id)
+{
+  T8_ASSERT (0 <= line_level && line_level <= T8_DPRISM_MAXLEVEL);
+  T8_ASSERT (0 <= tri_level && tri_level <= T8_DPRISM_MAXLEVEL);
+  T8_ASSERT (id < (sc_intpow64u (T8_DTRI_CHILDREN, tri_level)
+                   << line_level));
+  t8_dtri_init_linear_id (&p->tri, id >> line_level, tri_level);
+  t8_dline_init_linear_id (&p->line, line_level,
+                           id & ((((uint64_t) 1) << line_level) - 1));
+}
+
+int
+t8_dprism_is_valid_aniso (const t8_dprism_t * p)
+{
+  return t8_dtri_is_valid (&p->tri) && t8_dline_is_valid (&p->line)
+    && p->tri.level <= T8_DPRISM_MAXLEVEL
+    && p->line.level <= T8_DPRISM_MAXLEVEL;
+}
+
 /* Returns true if and only if p is a valid prism,
  * that is its triangle and line part are valid, and they have the same
  * refinement level. */
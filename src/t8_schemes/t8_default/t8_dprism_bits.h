@@ -64,6 +64,17 @@ int                 t8_dprism_compare (const t8_dprism_t * p1,
 void                t8_dprism_init_linear_id (t8_dprism_t * p, int level,
                                               uint64_t id);
 
+/** Initialize a prism from its linear id level by level.
+ * This is the reference implementation of \ref t8_dprism_init_linear_id,
+ * which processes several levels at once using lookup tables.
+ * \param [in,out] p  Existing prism whose data will be filled.
+ * \param [in] id     Index to be considered.
+ * \param [in] level  level of uniform grid to be considered.
+ */
+void                t8_dprism_init_linear_id_per_level (t8_dprism_t * p,
+                                                        int level,
+                                                        uint64_t id);
+
 /** Computes the successor of a prism in a uniform grid of level \a level.
  * \param [in] p  prism whose id will be computed.
  * \param [in,out] s Existing prism whose data will be filled with the
@@ -148,6 +159,110 @@ int                 t8_dprism_is_inside_root (t8_dprism_t * p);
 void                t8_dprism_child (const t8_dprism_t * p, int childid,
                                      t8_dprism_t * child);
 
+/* Anisotropic refinement.
+ * The line and the triangle of a prism may have different levels.
+ * Such a prism is the tensor product of a line of level line.level and a
+ * triangle of level tri.level. The following functions refine and coarsen
+ * a prism in only one of the two directions.
+ * The other functions in this file, except \ref t8_dprism_face_neighbour and
+ * \ref t8_dprism_vertex_coords, expect both levels to be equal.
+ * Anisotropic prisms are not used by the default prism scheme, since the
+ * descendants of a prism with different levels do not form a contiguous
+ * range of the linear ids at the maximum level. */
+
+/** Compute a child of a prism that is refined only in the line direction.
+ * \param [in] p    Input prism. Its line level must be smaller than
+ *                  \ref T8_DPRISM_MAXLEVEL.
+ * \param [in] childid The id of the child, 0 for the lower and 1 for the
+ *                  upper child.
+ * \param [in,out] child  Existing prism whose data will be filled
+ *                  with the data of the child. Its triangle is the triangle
+ *                  of \a p.
+ */
+void                t8_dprism_child_line (const t8_dprism_t * p,
+                                          int childid, t8_dprism_t * child);
+
+/** Compute a child of a prism that is refined only in the triangle
+ * direction.
+ * \param [in] p    Input prism. Its triangle level must be smaller than
+ *                  \ref T8_DPRISM_MAXLEVEL.
+ * \param [in] childid The id of the child, in 0 - 3, in Bey order of the
+ *                  triangle.
+ * \param [in,out] child  Existing prism whose data will be filled
+ *                  with the data of the child. Its line is the line of \a p.
+ */
+void                t8_dprism_child_tri (const t8_dprism_t * p,
+                                         int childid, t8_dprism_t * child);
+
+/** Compute the parent of a prism in the line direction.
+ * \param [in]  p  Input prism. Its line level must be positive.
+ * \param [in,out] parent Existing prism whose data will be filled with the
+ *                  data of the parent of the line of \a p and the triangle
+ *                  of \a p.
+ * \note \a p may point to the same prism as \a parent.
+ */
+void                t8_dprism_parent_line (const t8_dprism_t * p,
+                                           t8_dprism_t * parent);
+
+/** Compute the parent of a prism in the triangle direction.
+ * \param [in]  p  Input prism. Its triangle level must be positive.
+ * \param [in,out] parent Existing prism whose data will be filled with the
+ *                  data of the line of \a p and the parent of the triangle
+ *                  of \a p.
+ * \note \a p may point to the same prism as \a parent.
+ */
+void                t8_dprism_parent_tri (const t8_dprism_t * p,
+                                          t8_dprism_t * parent);
+
+/** Check whether two prisms are the children of a prism that is refined
+ * only in the line direction.
+ * \param [in]     fam  An array of two prisms.
+ * \return            Nonzero if \a fam are the children, as computed by
+ *                    \ref t8_dprism_child_line, of a prism.
+ */
+int                 t8_dprism_is_family_line (t8_dprism_t ** fam);
+
+/** Check whether four prisms are the children of a prism that is refined
+ * only in the triangle direction.
+ * \param [in]     fam  An array of four prisms.
+ * \return            Nonzero if \a fam are the children, as computed by
+ *                    \ref t8_dprism_child_tri, of a prism.
+ */
+int                 t8_dprism_is_family_tri (t8_dprism_t ** fam);
+
+/** Compute the linear id of a prism in the tensor product of a uniform
+ * line refinement of level p->line.level and a uniform triangle refinement
+ * of level p->tri.level.
+ * The prisms are ordered by their triangles first and by their lines
+ * second.
+ * \param [in] p  Input prism.
+ * \return        The id of \a p, in 0 to
+ *                2^line.level * 4^tri.level - 1.
+ */
+uint64_t            t8_dprism_linear_id_aniso (const t8_dprism_t * p);
+
+/** Initialize a prism from its linear id in the tensor product of a
+ * uniform line and a uniform triangle refinement.
+ * \param [in,out] p  Existing prism whose data will be filled.
+ * \param [in] line_level The level of the line of \a p.
+ * \param [in] tri_level  The level of the triangle of \a p.
+ * \param [in] id   The linear id, as computed by
+ *                  \ref t8_dprism_linear_id_aniso.
+ */
+void                t8_dprism_init_linear_id_aniso (t8_dprism_t * p,
+                                                    int line_level,
+                                                    int tri_level,
+                                                    uint64_t id);
+
+/** Query whether all entries of a possibly anisotropic prism are in valid
+ * ranges. Unlike \ref t8_dprism_is_valid the levels of the line and the
+ * triangle may differ.
+ * \param [in] p  prism to be considered.
+ * \return        True, if the line and the triangle of \a p are valid
+ *                and their levels do not exceed \ref T8_DPRISM_MAXLEVEL.
+ */
+int                 t8_dprism_is_valid_aniso (const t8_dprism_t * p);
+
 /** Return the shape of a face.
  * \param [in] p    Input prism.
  * \param [in] face A face id for \a p.
@@ -311,6 +426,16 @@ void                t8_dprism_vertex_coords (const t8_dprism_t * p,
  */
 uint64_t            t8_dprism_linear_id (const t8_dprism_t * p, int level);
 
+/** Compute the linear id of a prism level by level.
+ * This is the reference implementation of \ref t8_dprism_linear_id,
+ * which processes several levels at once using lookup tables.
+ * \param [in] p  Prism whose id will be computed.
+ * \param [in] level level of uniform grid to be considered.
+ * \return Returns the linear position of this prism on a grid.
+ */
+uint64_t            t8_dprism_linear_id_per_level (const t8_dprism_t * p,
+                                                   int level);
+
 /** Query whether all entries of a prism are in valid ranges.
  * A prism is valid if and only if its triangle and line member are valid.
  * \param [in] p  prism to be considered.
@@ -0,0 +1,99 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef T8_DPYRAMID_H
+#define T8_DPYRAMID_H
+
+/** \file t8_dpyramid.h
+ * The data types and constants of the default pyramid implementation.
+ *
+ * A pyramid is refined into 6 pyramids and 4 tetrahedra, a tetrahedron
+ * is refined into 8 tetrahedra via Bey's rule.
+ * Thus, the elements of a pyramid tree are pyramids and tetrahedra.
+ * Both are described by the smallest cube that contains them, that is by
+ * the anchor node and the level of the cube, and by a type.
+ * The types 0 to 5 are the tetrahedra of the cube in the numbering of
+ * \ref t8_dtet_t.
+ * Type 6 is the pyramid whose base is the lower z-face of the cube and whose
+ * apex is the cube corner (1,1,1). Type 7 is the pyramid whose base is the
+ * upper z-face of the cube and whose apex is the cube corner (0,0,0).
+ * The root pyramid has type 6.
+ */
+
+#include <t8.h>
+#include "t8_dtet.h"
+
+/** The number of children that a pyramid is refined into. */
+#define T8_DPYRAMID_CHILDREN 10
+
+/** The number of faces of a pyramid. */
+#define T8_DPYRAMID_FACES 5
+
+/** The number of children that a face of a pyramid is refined into. */
+#define T8_DPYRAMID_FACE_CHILDREN 4
+
+/** The number of corners of a pyramid. */
+#define T8_DPYRAMID_CORNERS 5
+
+/** The maximum refinement level allowed for a pyramid.
+ *  A pyramid of level 0 has 2 * 8^l - 6^l descendants of level l,
+ *  the maximum level is chosen such that these fit into a linear id.
+ *  Must be smaller than T8_DTET_MAXLEVEL. */
+#define T8_DPYRAMID_MAXLEVEL 20
+
+/** The length of the root pyramid in integer coordinates.
+ *  We use the coordinate system of the tetrahedra, such that
+ *  the tetrahedra in a pyramid tree are valid \ref t8_dtet_t elements. */
+#define T8_DPYRAMID_ROOT_LEN T8_DTET_ROOT_LEN
+
+/** The length of a pyramid at a given level in integer coordinates. */
+#define T8_DPYRAMID_LEN(l) T8_DTET_LEN(l)
+
+/** The type of the pyramid whose apex lies above its base. */
+#define T8_DPYRAMID_FIRST_TYPE 6
+
+/** The type of the pyramid whose apex lies below its base. */
+#define T8_DPYRAMID_SECOND_TYPE 7
+
+/** The type of a pyramid element, 0 to 5 for tetrahedra, 6 and 7 for
+ * pyramids. */
+typedef int8_t      t8_dpyramid_type_t;
+
+/** The coordinates of a pyramid are integers relative to the maximum
+ * refinement. */
+typedef t8_dtet_coord_t t8_dpyramid_coord_t;
+
+/** This data type stores an element of a pyramid tree. */
+typedef struct t8_dpyramid
+{
+  /** The anchor node, level and type of the element.
+   *  If the type is smaller than \ref T8_DPYRAMID_FIRST_TYPE, the element
+   *  is a tetrahedron and this entry can be passed to the t8_dtet
+   *  functions. */
+  t8_dtet_t           pyramid;
+  /** For a tetrahedron, the level of its coarsest tetrahedral ancestor,
+   *  whose parent is a pyramid. For a pyramid, this is -1. */
+  int8_t              switch_shape_at_level;
+}
+t8_dpyramid_t;
+
+#endif /* T8_DPYRAMID_H */
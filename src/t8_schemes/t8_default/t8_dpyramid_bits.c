@@ -0,0 +1,1096 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <p4est_bits.h>
+#include <sc_functions.h>
+#include "t8_dpyramid_bits.h"
+#include "t8_dtet_bits.h"
+#include "t8_dtet_connectivity.h"
+#include "t8_dtri.h"
+
+/* The pyramid types are shifted by T8_DPYRAMID_FIRST_TYPE in the tables below.
+ * The children of a pyramid are ordered by their cube id and within a cube
+ * by the order given here. The order of the children of the second pyramid
+ * type is the reversed order of the first type under the rotation
+ * (x,y,z) -> (1-y,1-x,1-z) that maps one pyramid type to the other. */
+static const int    t8_dpyramid_parenttype_Iloc_to_cid[2][10] = {
+  {0, 1, 1, 2, 2, 3, 3, 3, 3, 7},
+  {0, 4, 4, 4, 4, 5, 5, 6, 6, 7}
+};
+
+static const int    t8_dpyramid_parenttype_Iloc_to_type[2][10] = {
+  {6, 6, 3, 6, 0, 7, 0, 3, 6, 6},
+  {7, 7, 0, 3, 6, 3, 7, 0, 7, 7}
+};
+
+/* The number of pyramids among the first i children of a pyramid. */
+static const int    t8_dpyramid_parenttype_Iloc_num_pyra[2][11] = {
+  {0, 1, 2, 2, 3, 3, 4, 4, 4, 5, 6},
+  {0, 1, 2, 2, 2, 3, 3, 4, 4, 5, 6}
+};
+
+/* The type of the parent of a pyramid for each cube id and pyramid type.
+ * -1 if the combination does not occur. */
+static const int    t8_dpyramid_cid_type_to_parenttype[8][2] = {
+  {6, 7},
+  {6, -1},
+  {6, -1},
+  {6, 6},
+  {7, 7},
+  {-1, 7},
+  {-1, 7},
+  {6, 7}
+};
+
+/* The vertices of the pyramid types relative to the anchor of the cube,
+ * in multiples of the cube length. The second type is the rotation of
+ * the first one, such that the faces are numbered in the same way. */
+static const int    t8_dpyramid_type_vertex_coords[2][5][3] = {
+  {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 1, 1}},
+  {{1, 1, 1}, {1, 0, 1}, {0, 1, 1}, {0, 0, 1}, {0, 0, 0}}
+};
+
+/* The normal vectors of the faces of the root pyramid, pointing inwards,
+ * and whether the corresponding plane passes through the origin (0) or
+ * through the vertex (1,1,1) of the root (1). */
+static const int    t8_dpyramid_root_face_normal[T8_DPYRAMID_FACES][4] = {
+  {1, 0, -1, 0},
+  {-1, 0, 0, 1},
+  {0, 1, -1, 0},
+  {0, -1, 0, 1},
+  {0, 0, 1, 0}
+};
+
+/* We compute centroids and points close to faces exactly in integers.
+ * All coordinates are multiplied with this factor, which is divisible by
+ * 3, 4 and 5 times the 16 that we use to move a point away from a face. */
+#define T8_DPYRAMID_POINT_SCALE 3840
+
+/* Return true if the element is a pyramid and false if it is a tet. */
+static int
+t8_dpyramid_is_pyramid (const t8_dpyramid_t * p)
+{
+  return p->pyramid.type >= T8_DPYRAMID_FIRST_TYPE;
+}
+
+/* The cube id of the cube of the element at its level. */
+static int
+t8_dpyramid_cube_id (const t8_dpyramid_t * p)
+{
+  int                 cid = 0;
+  t8_dpyramid_coord_t h;
+
+  if (p->pyramid.level == 0) {
+    return 0;
+  }
+  h = T8_DPYRAMID_LEN (p->pyramid.level);
+  cid |= (p->pyramid.x & h) ? 0x01 : 0;
+  cid |= (p->pyramid.y & h) ? 0x02 : 0;
+  cid |= (p->pyramid.z & h) ? 0x04 : 0;
+  return cid;
+}
+
+/* Return true if the parent of an element is a pyramid. */
+static int
+t8_dpyramid_parent_is_pyramid (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_is_pyramid (p)
+    || p->pyramid.level == p->switch_shape_at_level;
+}
+
+/* Compute the type of the parent of an element whose parent is a pyramid. */
+static int
+t8_dpyramid_pyramid_parenttype (const t8_dpyramid_t * p)
+{
+  int                 cid;
+
+  T8_ASSERT (p->pyramid.level > 0);
+  T8_ASSERT (t8_dpyramid_parent_is_pyramid (p));
+  cid = t8_dpyramid_cube_id (p);
+  if (t8_dpyramid_is_pyramid (p)) {
+    return t8_dpyramid_cid_type_to_parenttype[cid]
+      [p->pyramid.type - T8_DPYRAMID_FIRST_TYPE];
+  }
+  /* The tetrahedra in cubes 1, 2, 3 are children of the first pyramid type,
+   * the tetrahedra in cubes 4, 5, 6 of the second type. */
+  T8_ASSERT (0 < cid && cid < 7);
+  return cid < 4 ? T8_DPYRAMID_FIRST_TYPE : T8_DPYRAMID_SECOND_TYPE;
+}
+
+int
+t8_dpyramid_get_level (const t8_dpyramid_t * p)
+{
+  return p->pyramid.level;
+}
+
+t8_element_shape_t
+t8_dpyramid_shape (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_is_pyramid (p) ? T8_ECLASS_PYRAMID : T8_ECLASS_TET;
+}
+
+void
+t8_dpyramid_copy (const t8_dpyramid_t * p, t8_dpyramid_t * dest)
+{
+  if (p == dest) {
+    return;
+  }
+  memcpy (dest, p, sizeof (t8_dpyramid_t));
+}
+
+int
+t8_dpyramid_compare (const t8_dpyramid_t * p1, const t8_dpyramid_t * p2)
+{
+  int                 maxlvl;
+  t8_linearidx_t      id1, id2;
+
+  /* The linear ids at the larger of the two levels have the same order
+   * as the ids at the maximum level */
+  maxlvl = SC_MAX (p1->pyramid.level, p2->pyramid.level);
+  id1 = t8_dpyramid_linear_id (p1, maxlvl);
+  id2 = t8_dpyramid_linear_id (p2, maxlvl);
+  if (id1 == id2) {
+    /* The elements are ancestor and descendant, the ancestor is smaller */
+    return p1->pyramid.level - p2->pyramid.level;
+  }
+  return id1 < id2 ? -1 : 1;
+}
+
+int
+t8_dpyramid_is_equal (const t8_dpyramid_t * p1, const t8_dpyramid_t * p2)
+{
+  return p1->pyramid.level == p2->pyramid.level
+    && p1->pyramid.type == p2->pyramid.type
+    && p1->pyramid.x == p2->pyramid.x && p1->pyramid.y == p2->pyramid.y
+    && p1->pyramid.z == p2->pyramid.z
+    && p1->switch_shape_at_level == p2->switch_shape_at_level;
+}
+
+void
+t8_dpyramid_init_root (t8_dpyramid_t * p)
+{
+#ifdef T8_ENABLE_DEBUG
+  /* The tetrahedra in a pyramid tree are valid t8_dtet_t */
+  p->pyramid.eclass_int8 = T8_ECLASS_TET;
+#endif
+  p->pyramid.level = 0;
+  p->pyramid.type = T8_DPYRAMID_FIRST_TYPE;
+  p->pyramid.x = p->pyramid.y = p->pyramid.z = 0;
+  p->switch_shape_at_level = -1;
+}
+
+int
+t8_dpyramid_num_corners (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_is_pyramid (p) ? T8_DPYRAMID_CORNERS : T8_DTET_CORNERS;
+}
+
+int
+t8_dpyramid_num_faces (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_is_pyramid (p) ? T8_DPYRAMID_FACES : T8_DTET_FACES;
+}
+
+int
+t8_dpyramid_num_children (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_is_pyramid (p) ? T8_DPYRAMID_CHILDREN :
+    T8_DTET_CHILDREN;
+}
+
+int
+t8_dpyramid_num_siblings (const t8_dpyramid_t * p)
+{
+  return t8_dpyramid_parent_is_pyramid (p) ? T8_DPYRAMID_CHILDREN :
+    T8_DTET_CHILDREN;
+}
+
+void
+t8_dpyramid_parent (const t8_dpyramid_t * p, t8_dpyramid_t * parent)
+{
+  t8_dpyramid_coord_t h;
+  int                 parenttype;
+
+  T8_ASSERT (p->pyramid.level > 0);
+  if (!t8_dpyramid_parent_is_pyramid (p)) {
+    /* The parent is a tetrahedron */
+    t8_dtet_parent (&p->pyramid, &parent->pyramid);
+    parent->switch_shape_at_level = p->switch_shape_at_level;
+    return;
+  }
+  parenttype = t8_dpyramid_pyramid_parenttype (p);
+  T8_ASSERT (parenttype >= T8_DPYRAMID_FIRST_TYPE);
+  h = T8_DPYRAMID_LEN (p->pyramid.level);
+#ifdef T8_ENABLE_DEBUG
+  parent->pyramid.eclass_int8 = T8_ECLASS_TET;
+#endif
+  parent->pyramid.x = p->pyramid.x & ~h;
+  parent->pyramid.y = p->pyramid.y & ~h;
+  parent->pyramid.z = p->pyramid.z & ~h;
+  parent->pyramid.type = parenttype;
+  parent->pyramid.level = p->pyramid.level - 1;
+  parent->switch_shape_at_level = -1;
+}
+
+void
+t8_dpyramid_ancestor (const t8_dpyramid_t * p, int level,
+                      t8_dpyramid_t * anc)
+{
+  T8_ASSERT (0 <= level && level <= p->pyramid.level);
+  t8_dpyramid_copy (p, anc);
+  while (anc->pyramid.level > level) {
+    t8_dpyramid_parent (anc, anc);
+  }
+}
+
+void
+t8_dpyramid_child (const t8_dpyramid_t * p, int childid,
+                   t8_dpyramid_t * child)
+{
+  t8_dpyramid_coord_t h;
+  int                 cid, type;
+
+  T8_ASSERT (p->pyramid.level < T8_DPYRAMID_MAXLEVEL);
+  T8_ASSERT (0 <= childid && childid < t8_dpyramid_num_children (p));
+  if (!t8_dpyramid_is_pyramid (p)) {
+    /* The children of a tetrahedron are tetrahedra */
+    t8_dtet_child (&p->pyramid, childid, &child->pyramid);
+#ifdef T8_ENABLE_DEBUG
+    child->pyramid.eclass_int8 = T8_ECLASS_TET;
+#endif
+    child->switch_shape_at_level = p->switch_shape_at_level;
+    return;
+  }
+  cid = t8_dpyramid_parenttype_Iloc_to_cid
+    [p->pyramid.type - T8_DPYRAMID_FIRST_TYPE][childid];
+  type = t8_dpyramid_parenttype_Iloc_to_type
+    [p->pyramid.type - T8_DPYRAMID_FIRST_TYPE][childid];
+  h = T8_DPYRAMID_LEN (p->pyramid.level + 1);
+#ifdef T8_ENABLE_DEBUG
+  child->pyramid.eclass_int8 = T8_ECLASS_TET;
+#endif
+  child->pyramid.x = p->pyramid.x + (cid & 0x01 ? h : 0);
+  child->pyramid.y = p->pyramid.y + (cid & 0x02 ? h : 0);
+  child->pyramid.z = p->pyramid.z + (cid & 0x04 ? h : 0);
+  child->pyramid.level = p->pyramid.level + 1;
+  child->pyramid.type = type;
+  child->switch_shape_at_level =
+    type >= T8_DPYRAMID_FIRST_TYPE ? -1 : child->pyramid.level;
+}
+
+void
+t8_dpyramid_children (const t8_dpyramid_t * p, int length,
+                      t8_dpyramid_t ** c)
+{
+  int                 ichild;
+
+  T8_ASSERT (length == t8_dpyramid_num_children (p));
+  /* We compute the children in reverse order, such that p may be
+   * the same as c[0] */
+  for (ichild = length - 1; ichild >= 0; ichild--) {
+    t8_dpyramid_child (p, ichild, c[ichild]);
+  }
+}
+
+int
+t8_dpyramid_child_id (const t8_dpyramid_t * p)
+{
+  int                 cid, parenttype, ichild;
+
+  if (p->pyramid.level == 0) {
+    return 0;
+  }
+  if (!t8_dpyramid_parent_is_pyramid (p)) {
+    return t8_dtet_child_id (&p->pyramid);
+  }
+  cid = t8_dpyramid_cube_id (p);
+  parenttype = t8_dpyramid_pyramid_parenttype (p) - T8_DPYRAMID_FIRST_TYPE;
+  for (ichild = 0; ichild < T8_DPYRAMID_CHILDREN; ichild++) {
+    if (t8_dpyramid_parenttype_Iloc_to_cid[parenttype][ichild] == cid
+        && t8_dpyramid_parenttype_Iloc_to_type[parenttype][ichild] ==
+        p->pyramid.type) {
+      return ichild;
+    }
+  }
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
+
+int
+t8_dpyramid_ancestor_id (const t8_dpyramid_t * p, int level)
+{
+  t8_dpyramid_t       anc;
+
+  t8_dpyramid_ancestor (p, level, &anc);
+  return t8_dpyramid_child_id (&anc);
+}
+
+void
+t8_dpyramid_sibling (const t8_dpyramid_t * p, int sibid,
+                     t8_dpyramid_t * sibling)
+{
+  T8_ASSERT (p->pyramid.level > 0);
+  T8_ASSERT (0 <= sibid && sibid < t8_dpyramid_num_siblings (p));
+  t8_dpyramid_parent (p, sibling);
+  t8_dpyramid_child (sibling, sibid, sibling);
+}
+
+int
+t8_dpyramid_is_family (t8_dpyramid_t ** fam)
+{
+  t8_dpyramid_t       parent, child;
+  int                 num_siblings, ichild;
+
+  if (fam[0]->pyramid.level == 0) {
+    return 0;
+  }
+  num_siblings = t8_dpyramid_num_siblings (fam[0]);
+  t8_dpyramid_parent (fam[0], &parent);
+  for (ichild = 0; ichild < num_siblings; ichild++) {
+    t8_dpyramid_child (&parent, ichild, &child);
+    if (!t8_dpyramid_is_equal (&child, fam[ichild])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+t8_dpyramid_nearest_common_ancestor (const t8_dpyramid_t * p1,
+                                     const t8_dpyramid_t * p2,
+                                     t8_dpyramid_t * nca)
+{
+  t8_dpyramid_t       anc1, anc2;
+  int                 level;
+
+  level = SC_MIN (p1->pyramid.level, p2->pyramid.level);
+  t8_dpyramid_ancestor (p1, level, &anc1);
+  t8_dpyramid_ancestor (p2, level, &anc2);
+  while (!t8_dpyramid_is_equal (&anc1, &anc2)) {
+    T8_ASSERT (anc1.pyramid.level > 0);
+    t8_dpyramid_parent (&anc1, &anc1);
+    t8_dpyramid_parent (&anc2, &anc2);
+  }
+  t8_dpyramid_copy (&anc1, nca);
+}
+
+t8_linearidx_t
+t8_dpyramid_linear_id (const t8_dpyramid_t * p, int level)
+{
+  t8_dpyramid_t       anc;
+  t8_linearidx_t      id = 0, num_tet_desc, num_pyra_desc, num_pyra;
+  int                 ichild, parenttype, depth;
+
+  T8_ASSERT (0 <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  t8_dpyramid_ancestor (p, SC_MIN (level, p->pyramid.level), &anc);
+  /* The number of level descendants of a tet and a pyramid at the
+   * level of anc */
+  depth = level - anc.pyramid.level;
+  num_tet_desc = sc_intpow64u (8, depth);
+  num_pyra_desc = 2 * num_tet_desc - sc_intpow64u (6, depth);
+  while (anc.pyramid.level > 0) {
+    ichild = t8_dpyramid_child_id (&anc);
+    if (t8_dpyramid_parent_is_pyramid (&anc)) {
+      /* The siblings before anc are pyramids and tetrahedra */
+      parenttype = t8_dpyramid_pyramid_parenttype (&anc)
+        - T8_DPYRAMID_FIRST_TYPE;
+      num_pyra = t8_dpyramid_parenttype_Iloc_num_pyra[parenttype][ichild];
+      id += num_pyra * num_pyra_desc + (ichild - num_pyra) * num_tet_desc;
+    }
+    else {
+      id += ichild * num_tet_desc;
+    }
+    t8_dpyramid_parent (&anc, &anc);
+    num_pyra_desc = 2 * 8 * num_tet_desc - 6 * (2 * num_tet_desc
+                                                - num_pyra_desc);
+    num_tet_desc *= 8;
+  }
+  return id;
+}
+
+void
+t8_dpyramid_init_linear_id (t8_dpyramid_t * p, int level, t8_linearidx_t id)
+{
+  t8_linearidx_t      num_tet_desc, num_pyra_desc, six_pow;
+  int                 ichild, ilevel, parenttype, num_pyra;
+
+  T8_ASSERT (0 <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  T8_ASSERT (id < (t8_linearidx_t) t8_dpyramid_count_leafs_from_root (level));
+  t8_dpyramid_init_root (p);
+  if (level == 0) {
+    return;
+  }
+  /* The number of descendants of the children of the current element */
+  num_tet_desc = sc_intpow64u (8, level - 1);
+  six_pow = sc_intpow64u (6, level - 1);
+  for (ilevel = 1; ilevel <= level; ilevel++) {
+    num_pyra_desc = 2 * num_tet_desc - six_pow;
+    if (t8_dpyramid_is_pyramid (p)) {
+      /* Find the child that contains the element with the given id */
+      parenttype = p->pyramid.type - T8_DPYRAMID_FIRST_TYPE;
+      for (ichild = 0; ichild < T8_DPYRAMID_CHILDREN - 1; ichild++) {
+        num_pyra = t8_dpyramid_parenttype_Iloc_num_pyra[parenttype]
+          [ichild + 1] - t8_dpyramid_parenttype_Iloc_num_pyra[parenttype]
+          [ichild];
+        if (id < (num_pyra ? num_pyra_desc : num_tet_desc)) {
+          break;
+        }
+        id -= num_pyra ? num_pyra_desc : num_tet_desc;
+      }
+    }
+    else {
+      ichild = id / num_tet_desc;
+      id -= ichild * num_tet_desc;
+    }
+    t8_dpyramid_child (p, ichild, p);
+    num_tet_desc /= 8;
+    six_pow /= 6;
+  }
+  T8_ASSERT (id == 0);
+}
+
+void
+t8_dpyramid_successor (const t8_dpyramid_t * p, t8_dpyramid_t * succ,
+                       int level)
+{
+  int                 ichild, num_up = 0;
+
+  T8_ASSERT (1 <= level && level <= p->pyramid.level);
+  t8_dpyramid_ancestor (p, level, succ);
+  /* Go up until we find an ancestor that is not the last of its siblings */
+  ichild = t8_dpyramid_child_id (succ);
+  while (ichild == t8_dpyramid_num_siblings (succ) - 1) {
+    T8_ASSERT (succ->pyramid.level > 1);
+    t8_dpyramid_parent (succ, succ);
+    ichild = t8_dpyramid_child_id (succ);
+    num_up++;
+  }
+  /* Take the next sibling and go down to level again */
+  t8_dpyramid_sibling (succ, ichild + 1, succ);
+  for (; num_up > 0; num_up--) {
+    t8_dpyramid_child (succ, 0, succ);
+  }
+  T8_ASSERT (succ->pyramid.level == level);
+}
+
+void
+t8_dpyramid_first_descendant (const t8_dpyramid_t * p, t8_dpyramid_t * desc,
+                              int level)
+{
+  T8_ASSERT (p->pyramid.level <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  /* The first child of a pyramid or tetrahedron has the same anchor node
+   * and the same type as its parent. */
+  t8_dpyramid_copy (p, desc);
+  desc->pyramid.level = level;
+}
+
+void
+t8_dpyramid_last_descendant (const t8_dpyramid_t * p, t8_dpyramid_t * desc,
+                             int level)
+{
+  t8_dpyramid_coord_t offset;
+
+  T8_ASSERT (p->pyramid.level <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  /* The last child of a pyramid or tetrahedron has the same type as its
+   * parent and lies in the last subcube. */
+  offset = T8_DPYRAMID_LEN (p->pyramid.level) - T8_DPYRAMID_LEN (level);
+  t8_dpyramid_copy (p, desc);
+  desc->pyramid.x += offset;
+  desc->pyramid.y += offset;
+  desc->pyramid.z += offset;
+  desc->pyramid.level = level;
+}
+
+t8_gloidx_t
+t8_dpyramid_count_leafs (const t8_dpyramid_t * p, int level)
+{
+  int                 depth;
+
+  if (level < p->pyramid.level) {
+    return 0;
+  }
+  depth = level - p->pyramid.level;
+  if (t8_dpyramid_is_pyramid (p)) {
+    return 2 * sc_intpow64 (8, depth) - sc_intpow64 (6, depth);
+  }
+  return sc_intpow64 (8, depth);
+}
+
+t8_gloidx_t
+t8_dpyramid_count_leafs_from_root (int level)
+{
+  T8_ASSERT (0 <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  return 2 * sc_intpow64 (8, level) - sc_intpow64 (6, level);
+}
+
+void
+t8_dpyramid_compute_coords (const t8_dpyramid_t * p, int vertex,
+                            t8_dpyramid_coord_t coords[3])
+{
+  const int          *vertex_coords;
+  t8_dpyramid_coord_t h;
+
+  T8_ASSERT (0 <= vertex && vertex < t8_dpyramid_num_corners (p));
+  if (!t8_dpyramid_is_pyramid (p)) {
+    t8_dtet_compute_coords (&p->pyramid, vertex, coords);
+    return;
+  }
+  h = T8_DPYRAMID_LEN (p->pyramid.level);
+  vertex_coords = t8_dpyramid_type_vertex_coords
+    [p->pyramid.type - T8_DPYRAMID_FIRST_TYPE][vertex];
+  coords[0] = p->pyramid.x + vertex_coords[0] * h;
+  coords[1] = p->pyramid.y + vertex_coords[1] * h;
+  coords[2] = p->pyramid.z + vertex_coords[2] * h;
+}
+
+t8_element_shape_t
+t8_dpyramid_face_shape (const t8_dpyramid_t * p, int face)
+{
+  T8_ASSERT (0 <= face && face < t8_dpyramid_num_faces (p));
+  return t8_dpyramid_is_pyramid (p) && face == 4 ? T8_ECLASS_QUAD :
+    T8_ECLASS_TRIANGLE;
+}
+
+int
+t8_dpyramid_get_face_corner (const t8_dpyramid_t * p, int face, int corner)
+{
+  T8_ASSERT (0 <= face && face < t8_dpyramid_num_faces (p));
+  if (t8_dpyramid_is_pyramid (p)) {
+    T8_ASSERT (0 <= corner && corner < (face == 4 ? 4 : 3));
+    return t8_face_vertex_to_tree_vertex[T8_ECLASS_PYRAMID][face][corner];
+  }
+  T8_ASSERT (0 <= corner && corner < 3);
+  return t8_dtet_face_corner[face][corner];
+}
+
+/* The faces of the elements in a pyramid tree are not described by tables.
+ * Instead we compute the vertices of a face and the plane that contains it.
+ * Since all faces are parallel to one of a few planes, the normal vectors
+ * have small integer entries and all computations are exact. */
+
+/* Compute the vertex coordinates of a face and return their number. */
+static int
+t8_dpyramid_face_vertices (const t8_dpyramid_t * p, int face,
+                           t8_dpyramid_coord_t coords[4][3])
+{
+  int                 icorner, num_corners;
+
+  num_corners = t8_dpyramid_face_shape (p, face) == T8_ECLASS_QUAD ? 4 : 3;
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    t8_dpyramid_compute_coords (p, t8_dpyramid_get_face_corner (p, face,
+                                                                icorner),
+                                coords[icorner]);
+  }
+  return num_corners;
+}
+
+/* Compute the plane n * x = d that contains a face. The normal n is
+ * divided by the greatest common divisor of its entries. */
+static void
+t8_dpyramid_face_plane (const t8_dpyramid_t * p, int face, int64_t normal[3],
+                        int64_t * d)
+{
+  t8_dpyramid_coord_t coords[4][3];
+  int64_t             u[3], v[3], gcd, a, b, r;
+  int                 i;
+
+  (void) t8_dpyramid_face_vertices (p, face, coords);
+  for (i = 0; i < 3; i++) {
+    u[i] = coords[1][i] - coords[0][i];
+    v[i] = coords[2][i] - coords[0][i];
+  }
+  normal[0] = u[1] * v[2] - u[2] * v[1];
+  normal[1] = u[2] * v[0] - u[0] * v[2];
+  normal[2] = u[0] * v[1] - u[1] * v[0];
+  gcd = 0;
+  for (i = 0; i < 3; i++) {
+    /* Euclid's algorithm for gcd (gcd, |normal[i]|) */
+    a = gcd;
+    b = normal[i] < 0 ? -normal[i] : normal[i];
+    while (b != 0) {
+      r = a % b;
+      a = b;
+      b = r;
+    }
+    gcd = a;
+  }
+  T8_ASSERT (gcd > 0);
+  for (i = 0; i < 3; i++) {
+    normal[i] /= gcd;
+  }
+  *d = normal[0] * coords[0][0] + normal[1] * coords[0][1]
+    + normal[2] * coords[0][2];
+}
+
+/* Return true if all vertices of a face lie in a given plane. */
+static int
+t8_dpyramid_face_in_plane (const t8_dpyramid_t * p, int face,
+                           const int64_t normal[3], int64_t d)
+{
+  t8_dpyramid_coord_t coords[4][3];
+  int                 icorner, num_corners;
+
+  num_corners = t8_dpyramid_face_vertices (p, face, coords);
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    if (normal[0] * coords[icorner][0] + normal[1] * coords[icorner][1]
+        + normal[2] * coords[icorner][2] != d) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Return the face of an element that lies in a given plane, -1 if there
+ * is none. */
+static int
+t8_dpyramid_face_in_plane_of (const t8_dpyramid_t * p,
+                              const int64_t normal[3], int64_t d)
+{
+  int                 iface;
+
+  for (iface = 0; iface < t8_dpyramid_num_faces (p); iface++) {
+    if (t8_dpyramid_face_in_plane (p, iface, normal, d)) {
+      return iface;
+    }
+  }
+  return -1;
+}
+
+/* Compute the plane of a face of the root pyramid */
+static void
+t8_dpyramid_root_face_plane (int root_face, int64_t normal[3], int64_t * d)
+{
+  const int          *n = t8_dpyramid_root_face_normal[root_face];
+
+  normal[0] = n[0];
+  normal[1] = n[1];
+  normal[2] = n[2];
+  *d = n[3] ? (int64_t) (n[0] + n[1] + n[2]) * T8_DPYRAMID_ROOT_LEN : 0;
+}
+
+/* Return true if a point, given in coordinates multiplied with
+ * T8_DPYRAMID_POINT_SCALE, lies inside the closure of an element. */
+static int
+t8_dpyramid_contains_point (const t8_dpyramid_t * p, const int64_t point[3])
+{
+  int64_t             x, y, z, h;
+
+  h = (int64_t) T8_DPYRAMID_LEN (p->pyramid.level) * T8_DPYRAMID_POINT_SCALE;
+  x = point[0] - (int64_t) p->pyramid.x * T8_DPYRAMID_POINT_SCALE;
+  y = point[1] - (int64_t) p->pyramid.y * T8_DPYRAMID_POINT_SCALE;
+  z = point[2] - (int64_t) p->pyramid.z * T8_DPYRAMID_POINT_SCALE;
+  if (x < 0 || x > h || y < 0 || y > h || z < 0 || z > h) {
+    /* The point is not inside the cube of p */
+    return 0;
+  }
+  /* Inside the cube each type is given by an order of the coordinates */
+  switch (p->pyramid.type) {
+  case 0:
+    return x >= z && z >= y;
+  case 1:
+    return x >= y && y >= z;
+  case 2:
+    return y >= x && x >= z;
+  case 3:
+    return y >= z && z >= x;
+  case 4:
+    return z >= y && y >= x;
+  case 5:
+    return z >= x && x >= y;
+  case T8_DPYRAMID_FIRST_TYPE:
+    return z <= x && z <= y;
+  case T8_DPYRAMID_SECOND_TYPE:
+    return z >= x && z >= y;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  return 0;
+}
+
+/* Given an ancestor of the element that we search and a point in the
+ * interior of this element, compute the element at a given level.
+ * The point is given in coordinates multiplied with
+ * T8_DPYRAMID_POINT_SCALE. */
+static void
+t8_dpyramid_locate_point (t8_dpyramid_t * p, const int64_t point[3],
+                          int level)
+{
+  int                 ichild, num_children;
+
+  T8_ASSERT (t8_dpyramid_contains_point (p, point));
+  while (p->pyramid.level < level) {
+    num_children = t8_dpyramid_num_children (p);
+    t8_dpyramid_child (p, 0, p);
+    for (ichild = 0; ichild < num_children - 1
+         && !t8_dpyramid_contains_point (p, point); ichild++) {
+      t8_dpyramid_sibling (p, ichild + 1, p);
+    }
+    T8_ASSERT (t8_dpyramid_contains_point (p, point));
+  }
+}
+
+/* Compute the centroid of a face of an element,
+ * multiplied with T8_DPYRAMID_POINT_SCALE. */
+static void
+t8_dpyramid_face_centroid (const t8_dpyramid_t * p, int face,
+                           int64_t centroid[3])
+{
+  t8_dpyramid_coord_t coords[4][3];
+  int                 icorner, num_corners, i;
+
+  num_corners = t8_dpyramid_face_vertices (p, face, coords);
+  for (i = 0; i < 3; i++) {
+    centroid[i] = 0;
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      centroid[i] += coords[icorner][i];
+    }
+    centroid[i] = centroid[i] * T8_DPYRAMID_POINT_SCALE / num_corners;
+  }
+}
+
+void
+t8_dpyramid_children_at_face (const t8_dpyramid_t * p, int face,
+                              t8_dpyramid_t * children[], int num_children,
+                              int *child_indices)
+{
+  t8_dpyramid_t       child, face_children[T8_DPYRAMID_FACE_CHILDREN];
+  int                 face_child_ids[T8_DPYRAMID_FACE_CHILDREN];
+  int64_t             normal[3], d;
+  int                 ichild, num_face_children = 0;
+
+  T8_ASSERT (num_children == T8_DPYRAMID_FACE_CHILDREN);
+  t8_dpyramid_face_plane (p, face, normal, &d);
+  /* We first compute all children, since p may be one of the children */
+  for (ichild = 0; ichild < t8_dpyramid_num_children (p); ichild++) {
+    t8_dpyramid_child (p, ichild, &child);
+    if (t8_dpyramid_face_in_plane_of (&child, normal, d) >= 0) {
+      T8_ASSERT (num_face_children < T8_DPYRAMID_FACE_CHILDREN);
+      t8_dpyramid_copy (&child, &face_children[num_face_children]);
+      face_child_ids[num_face_children++] = ichild;
+    }
+  }
+  T8_ASSERT (num_face_children == T8_DPYRAMID_FACE_CHILDREN);
+  for (ichild = 0; ichild < num_face_children; ichild++) {
+    t8_dpyramid_copy (&face_children[ichild], children[ichild]);
+    if (child_indices != NULL) {
+      child_indices[ichild] = face_child_ids[ichild];
+    }
+  }
+}
+
+int
+t8_dpyramid_face_child_face (const t8_dpyramid_t * p, int face,
+                             int face_child)
+{
+  t8_dpyramid_t       children[T8_DPYRAMID_FACE_CHILDREN];
+  t8_dpyramid_t      *child_pointers[T8_DPYRAMID_FACE_CHILDREN];
+  int64_t             normal[3], d;
+  int                 ichild;
+
+  T8_ASSERT (0 <= face_child && face_child < T8_DPYRAMID_FACE_CHILDREN);
+  for (ichild = 0; ichild < T8_DPYRAMID_FACE_CHILDREN; ichild++) {
+    child_pointers[ichild] = children + ichild;
+  }
+  t8_dpyramid_children_at_face (p, face, child_pointers,
+                                T8_DPYRAMID_FACE_CHILDREN, NULL);
+  t8_dpyramid_face_plane (p, face, normal, &d);
+  return t8_dpyramid_face_in_plane_of (&children[face_child], normal, d);
+}
+
+int
+t8_dpyramid_face_parent_face (const t8_dpyramid_t * p, int face)
+{
+  t8_dpyramid_t       parent;
+  int64_t             normal[3], d;
+  int                 iface;
+
+  if (p->pyramid.level == 0) {
+    return face;
+  }
+  t8_dpyramid_parent (p, &parent);
+  for (iface = 0; iface < t8_dpyramid_num_faces (&parent); iface++) {
+    t8_dpyramid_face_plane (&parent, iface, normal, &d);
+    if (t8_dpyramid_face_in_plane (p, face, normal, d)) {
+      return iface;
+    }
+  }
+  return -1;
+}
+
+int
+t8_dpyramid_tree_face (const t8_dpyramid_t * p, int face)
+{
+  int64_t             normal[3], d;
+  int                 root_face;
+
+  for (root_face = 0; root_face < T8_DPYRAMID_FACES; root_face++) {
+    t8_dpyramid_root_face_plane (root_face, normal, &d);
+    if (t8_dpyramid_face_in_plane (p, face, normal, d)) {
+      return root_face;
+    }
+  }
+  return -1;
+}
+
+int
+t8_dpyramid_is_root_boundary (const t8_dpyramid_t * p, int face)
+{
+  return t8_dpyramid_tree_face (p, face) >= 0;
+}
+
+int
+t8_dpyramid_face_neighbor_inside (const t8_dpyramid_t * p,
+                                  t8_dpyramid_t * neigh, int face,
+                                  int *neigh_face)
+{
+  t8_dpyramid_t       anc;
+  int64_t             face_centroid[3], point[3], normal[3], d;
+  t8_dpyramid_coord_t coords[3];
+  int                 i, ivertex, num_corners;
+
+  T8_ASSERT (0 <= face && face < t8_dpyramid_num_faces (p));
+  if (t8_dpyramid_is_root_boundary (p, face)) {
+    return 0;
+  }
+  /* We compute a point inside the neighbor close to the centroid of the
+   * face. The point is the face centroid moved away from the centroid
+   * of p by a sixteenth of their distance. */
+  t8_dpyramid_face_centroid (p, face, face_centroid);
+  num_corners = t8_dpyramid_num_corners (p);
+  for (i = 0; i < 3; i++) {
+    point[i] = 0;
+  }
+  for (ivertex = 0; ivertex < num_corners; ivertex++) {
+    t8_dpyramid_compute_coords (p, ivertex, coords);
+    for (i = 0; i < 3; i++) {
+      point[i] += coords[i];
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    point[i] = point[i] * T8_DPYRAMID_POINT_SCALE / num_corners;
+    point[i] = face_centroid[i] + (face_centroid[i] - point[i]) / 16;
+  }
+  /* The neighbor is the element of p's level that contains the point.
+   * We find it as a descendant of the first ancestor of p that contains
+   * the point. */
+  t8_dpyramid_copy (p, &anc);
+  while (!t8_dpyramid_contains_point (&anc, point)) {
+    T8_ASSERT (anc.pyramid.level > 0);
+    t8_dpyramid_parent (&anc, &anc);
+  }
+  t8_dpyramid_locate_point (&anc, point, p->pyramid.level);
+  t8_dpyramid_face_plane (p, face, normal, &d);
+  *neigh_face = t8_dpyramid_face_in_plane_of (&anc, normal, d);
+  T8_ASSERT (*neigh_face >= 0);
+  t8_dpyramid_copy (&anc, neigh);
+  return 1;
+}
+
+void
+t8_dpyramid_boundary_face (const t8_dpyramid_t * p, int face,
+                           t8_element_t * boundary)
+{
+  t8_dpyramid_coord_t coords[4][3];
+  t8_dpyramid_coord_t a[4], b[4], amin, bmin, h;
+  int                 root_face, icorner, num_corners, type;
+
+  root_face = t8_dpyramid_tree_face (p, face);
+  T8_ASSERT (root_face >= 0);
+  num_corners = t8_dpyramid_face_vertices (p, face, coords);
+  /* Compute the coordinates of the face corners in the face of the root.
+   * The face coordinates are given by the order of the corners of the root
+   * face, see t8_face_vertex_to_tree_vertex.
+   *  face 0: (y, x)  face 1: (y, z)  face 2: (x, y)  face 3: (x, z)
+   *  face 4: (x, y) */
+  amin = bmin = T8_DPYRAMID_ROOT_LEN;
+  for (icorner = 0; icorner < num_corners; icorner++) {
+    a[icorner] = coords[icorner][root_face == 0 || root_face == 1 ? 1 : 0];
+    b[icorner] = coords[icorner][root_face == 0 ? 0 :
+                                 root_face == 2 || root_face == 4 ? 1 : 2];
+    amin = SC_MIN (amin, a[icorner]);
+    bmin = SC_MIN (bmin, b[icorner]);
+  }
+  h = T8_DPYRAMID_LEN (p->pyramid.level);
+  if (root_face == 4) {
+    p4est_quadrant_t   *q = (p4est_quadrant_t *) boundary;
+
+    T8_ASSERT (num_corners == 4);
+    q->x = ((int64_t) amin * P4EST_ROOT_LEN) / T8_DPYRAMID_ROOT_LEN;
+    q->y = ((int64_t) bmin * P4EST_ROOT_LEN) / T8_DPYRAMID_ROOT_LEN;
+    q->level = p->pyramid.level;
+  }
+  else {
+    t8_dtri_t          *t = (t8_dtri_t *) boundary;
+
+    T8_ASSERT (num_corners == 3);
+    /* The triangle has type 0 if it contains the corner (amin + h, bmin) */
+    type = 1;
+    for (icorner = 0; icorner < num_corners; icorner++) {
+      if (a[icorner] == amin + h && b[icorner] == bmin) {
+        type = 0;
+      }
+    }
+    t->x = ((int64_t) amin * T8_DTRI_ROOT_LEN) / T8_DPYRAMID_ROOT_LEN;
+    t->y = ((int64_t) bmin * T8_DTRI_ROOT_LEN) / T8_DPYRAMID_ROOT_LEN;
+    t->type = type;
+    t->level = p->pyramid.level;
+  }
+}
+
+int
+t8_dpyramid_extrude_face (const t8_element_t * face, t8_dpyramid_t * p,
+                          int root_face)
+{
+  int64_t             a, b, point[3], normal[3], d, h;
+  int                 level;
+
+  T8_ASSERT (0 <= root_face && root_face < T8_DPYRAMID_FACES);
+  if (root_face == 4) {
+    const p4est_quadrant_t *q = (const p4est_quadrant_t *) face;
+
+    level = q->level;
+    /* the midpoint of the quad */
+    a = ((int64_t) q->x * T8_DPYRAMID_ROOT_LEN) / P4EST_ROOT_LEN;
+    b = ((int64_t) q->y * T8_DPYRAMID_ROOT_LEN) / P4EST_ROOT_LEN;
+    h = T8_DPYRAMID_LEN (level);
+    a = a * T8_DPYRAMID_POINT_SCALE + h * T8_DPYRAMID_POINT_SCALE / 2;
+    b = b * T8_DPYRAMID_POINT_SCALE + h * T8_DPYRAMID_POINT_SCALE / 2;
+  }
+  else {
+    const t8_dtri_t    *t = (const t8_dtri_t *) face;
+
+    level = t->level;
+    /* the centroid of the triangle */
+    a = ((int64_t) t->x * T8_DPYRAMID_ROOT_LEN) / T8_DTRI_ROOT_LEN;
+    b = ((int64_t) t->y * T8_DPYRAMID_ROOT_LEN) / T8_DTRI_ROOT_LEN;
+    h = T8_DPYRAMID_LEN (level);
+    a = a * T8_DPYRAMID_POINT_SCALE
+      + (t->type == 0 ? 2 : 1) * h * T8_DPYRAMID_POINT_SCALE / 3;
+    b = b * T8_DPYRAMID_POINT_SCALE
+      + (t->type == 0 ? 1 : 2) * h * T8_DPYRAMID_POINT_SCALE / 3;
+  }
+  T8_ASSERT (0 <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  /* Map the face coordinates to the root face,
+   * see t8_dpyramid_boundary_face. */
+  switch (root_face) {
+  case 0:
+    point[0] = b;
+    point[1] = a;
+    point[2] = b;
+    break;
+  case 1:
+    point[0] = (int64_t) T8_DPYRAMID_ROOT_LEN * T8_DPYRAMID_POINT_SCALE;
+    point[1] = a;
+    point[2] = b;
+    break;
+  case 2:
+    point[0] = a;
+    point[1] = b;
+    point[2] = b;
+    break;
+  case 3:
+    point[0] = a;
+    point[1] = (int64_t) T8_DPYRAMID_ROOT_LEN * T8_DPYRAMID_POINT_SCALE;
+    point[2] = b;
+    break;
+  default:
+    point[0] = a;
+    point[1] = b;
+    point[2] = 0;
+  }
+  /* Move the point into the interior of the root by a small multiple of the
+   * inner normal of the root face and find the element that contains it. */
+  t8_dpyramid_root_face_plane (root_face, normal, &d);
+  point[0] += normal[0] * h * T8_DPYRAMID_POINT_SCALE / 64;
+  point[1] += normal[1] * h * T8_DPYRAMID_POINT_SCALE / 64;
+  point[2] += normal[2] * h * T8_DPYRAMID_POINT_SCALE / 64;
+  t8_dpyramid_init_root (p);
+  t8_dpyramid_locate_point (p, point, level);
+  return t8_dpyramid_face_in_plane_of (p, normal, d);
+}
+
+/* Compute the first or last descendant of an element at a face */
+static void
+t8_dpyramid_corner_descendant_face (const t8_dpyramid_t * p, int face,
+                                    t8_dpyramid_t * desc, int level,
+                                    int last)
+{
+  int64_t             normal[3], d;
+  int                 ichild, num_children;
+
+  T8_ASSERT (p->pyramid.level <= level && level <= T8_DPYRAMID_MAXLEVEL);
+  t8_dpyramid_face_plane (p, face, normal, &d);
+  t8_dpyramid_copy (p, desc);
+  while (desc->pyramid.level < level) {
+    /* Find the first (last) child that has a face in the plane of face */
+    num_children = t8_dpyramid_num_children (desc);
+    ichild = last ? num_children - 1 : 0;
+    t8_dpyramid_child (desc, ichild, desc);
+    while (t8_dpyramid_face_in_plane_of (desc, normal, d) < 0) {
+      ichild += last ? -1 : 1;
+      T8_ASSERT (0 <= ichild && ichild < num_children);
+      t8_dpyramid_sibling (desc, ichild, desc);
+    }
+  }
+}
+
+void
+t8_dpyramid_first_descendant_face (const t8_dpyramid_t * p, int face,
+                                   t8_dpyramid_t * desc, int level)
+{
+  t8_dpyramid_corner_descendant_face (p, face, desc, level, 0);
+}
+
+void
+t8_dpyramid_last_descendant_face (const t8_dpyramid_t * p, int face,
+                                  t8_dpyramid_t * desc, int level)
+{
+  t8_dpyramid_corner_descendant_face (p, face, desc, level, 1);
+}
+
+int
+t8_dpyramid_is_valid (const t8_dpyramid_t * p)
+{
+  int                 is_valid;
+  t8_dpyramid_coord_t h;
+
+  is_valid = 0 <= p->pyramid.level && p->pyramid.level <= T8_DPYRAMID_MAXLEVEL;
+  is_valid = is_valid && 0 <= p->pyramid.type
+    && p->pyramid.type <= T8_DPYRAMID_SECOND_TYPE;
+  if (!is_valid) {
+    return 0;
+  }
+  /* The anchor node lies on the grid of the level */
+  h = T8_DPYRAMID_LEN (p->pyramid.level);
+  is_valid = p->pyramid.x % h == 0 && p->pyramid.y % h == 0
+    && p->pyramid.z % h == 0;
+  if (t8_dpyramid_is_pyramid (p)) {
+    is_valid = is_valid && p->switch_shape_at_level == -1;
+  }
+  else {
+    /* A tetrahedron has a pyramid ancestor */
+    is_valid = is_valid && 0 < p->switch_shape_at_level
+      && p->switch_shape_at_level <= p->pyramid.level
+      && t8_dtet_is_valid (&p->pyramid);
+  }
+  return is_valid;
+}
@@ -0,0 +1,404 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_dpyramid_bits.h
+ * Definitions of pyramid-specific functions.
+ */
+
+#ifndef T8_DPYRAMID_BITS_H
+#define T8_DPYRAMID_BITS_H
+
+#include <t8_element.h>
+#include "t8_dpyramid.h"
+
+T8_EXTERN_C_BEGIN ();
+
+/** Compute the level of a pyramid element.
+ * \param [in] p    Pyramid element whose level is computed.
+ * \return          The level of \a p.
+ */
+int                 t8_dpyramid_get_level (const t8_dpyramid_t * p);
+
+/** Compute the shape of a pyramid element.
+ * \param [in] p    Pyramid element whose shape is computed.
+ * \return          T8_ECLASS_PYRAMID if \a p is a pyramid and
+ *                  T8_ECLASS_TET if \a p is a tetrahedron.
+ */
+t8_element_shape_t  t8_dpyramid_shape (const t8_dpyramid_t * p);
+
+/** Copy all values from one pyramid element to another.
+ * \param [in] p    The element to be copied.
+ * \param [in,out] dest Existing element whose data will be filled with the
+ *                  data of \a p.
+ */
+void                t8_dpyramid_copy (const t8_dpyramid_t * p,
+                                      t8_dpyramid_t * dest);
+
+/** Compare two elements. returns negativ if p1 < p2, zero if p1 equals p2
+ *  and positiv if p1 > p2.
+ *  If p2 is a copy of p1 then the elements are equal.
+ */
+int                 t8_dpyramid_compare (const t8_dpyramid_t * p1,
+                                         const t8_dpyramid_t * p2);
+
+/** Query whether two elements are equal.
+ * \param [in] p1   The first element.
+ * \param [in] p2   The second element.
+ * \return          Nonzero if \a p1 and \a p2 are equal.
+ */
+int                 t8_dpyramid_is_equal (const t8_dpyramid_t * p1,
+                                          const t8_dpyramid_t * p2);
+
+/** Initialize an element as the root pyramid.
+ * \param [in,out] p  Existing element whose data will be filled.
+ */
+void                t8_dpyramid_init_root (t8_dpyramid_t * p);
+
+/** Compute the number of corners of a pyramid element.
+ * \param [in] p    The element.
+ * \return          5 for a pyramid and 4 for a tetrahedron.
+ */
+int                 t8_dpyramid_num_corners (const t8_dpyramid_t * p);
+
+/** Compute the number of faces of a pyramid element.
+ * \param [in] p    The element.
+ * \return          5 for a pyramid and 4 for a tetrahedron.
+ */
+int                 t8_dpyramid_num_faces (const t8_dpyramid_t * p);
+
+/** Compute the number of children of a pyramid element.
+ * \param [in] p    The element.
+ * \return          10 for a pyramid and 8 for a tetrahedron.
+ */
+int                 t8_dpyramid_num_children (const t8_dpyramid_t * p);
+
+/** Compute the number of siblings of a pyramid element, that is the number
+ * of children of its parent. The element itself is counted.
+ * \param [in] p    The element.
+ * \return          10 if the parent of \a p is a pyramid and 8 otherwise.
+ *                  For the root we return 10.
+ */
+int                 t8_dpyramid_num_siblings (const t8_dpyramid_t * p);
+
+/** Compute the parent of a pyramid element.
+ * \param [in]  p   Input element.
+ * \param [in,out] parent Existing element whose data will
+ *                  be filled with the data of p's parent.
+ * \note \a p may point to the same element as \a parent.
+ */
+void                t8_dpyramid_parent (const t8_dpyramid_t * p,
+                                        t8_dpyramid_t * parent);
+
+/** Compute the ancestor of a pyramid element at a given level.
+ * \param [in]  p   Input element.
+ * \param [in]  level A level smaller or equal to the level of \a p.
+ * \param [in,out] anc Existing element whose data will be filled with the
+ *                  data of p's ancestor at level \a level.
+ * \note \a p may point to the same element as \a anc.
+ */
+void                t8_dpyramid_ancestor (const t8_dpyramid_t * p, int level,
+                                          t8_dpyramid_t * anc);
+
+/** Compute a child of a pyramid element.
+ * \param [in]  p   Input element.
+ * \param [in]  childid The number of the child in the linear order,
+ *                  0 to \ref t8_dpyramid_num_children (p) - 1.
+ * \param [in,out] child Existing element whose data will be filled with the
+ *                  data of p's childid-th child.
+ * \note \a p may point to the same element as \a child.
+ */
+void                t8_dpyramid_child (const t8_dpyramid_t * p, int childid,
+                                       t8_dpyramid_t * child);
+
+/** Compute all children of a pyramid element.
+ * \param [in]  p   Input element.
+ * \param [in]  length The length of \a c, must equal the number of children.
+ * \param [in,out] c Existing elements whose data will be filled with the
+ *                  data of p's children.
+ * \note \a p may point to the same element as \a c[0].
+ */
+void                t8_dpyramid_children (const t8_dpyramid_t * p,
+                                          int length, t8_dpyramid_t ** c);
+
+/** Compute the position of an element among its siblings.
+ * \param [in] p    The element.
+ * \return          The child id of \a p, 0 for the root.
+ */
+int                 t8_dpyramid_child_id (const t8_dpyramid_t * p);
+
+/** Compute the child id of the ancestor of an element at a given level.
+ * \param [in] p    The element.
+ * \param [in] level A level smaller or equal to the level of \a p.
+ * \return          The child id of the ancestor of \a p at \a level.
+ */
+int                 t8_dpyramid_ancestor_id (const t8_dpyramid_t * p,
+                                             int level);
+
+/** Compute a sibling of a pyramid element.
+ * \param [in]  p   Input element.
+ * \param [in]  sibid The child id of the sibling.
+ * \param [in,out] sibling Existing element whose data will be filled with
+ *                  the data of the sibid-th sibling of \a p.
+ * \note \a p may point to the same element as \a sibling.
+ */
+void                t8_dpyramid_sibling (const t8_dpyramid_t * p, int sibid,
+                                         t8_dpyramid_t * sibling);
+
+/** Check whether a collection of elements is a family.
+ * \param [in] fam  An array of as many elements as the first element
+ *                  has siblings.
+ * \return          Nonzero if \a fam is a family.
+ */
+int                 t8_dpyramid_is_family (t8_dpyramid_t ** fam);
+
+/** Compute the nearest common ancestor of two elements in the same tree.
+ * \param [in] p1   First input element.
+ * \param [in] p2   Second input element.
+ * \param [in,out] nca Existing element whose data will be filled.
+ * \note \a p1, \a p2, \a nca may point to the same element.
+ */
+void                t8_dpyramid_nearest_common_ancestor (const t8_dpyramid_t
+                                                         * p1,
+                                                         const t8_dpyramid_t
+                                                         * p2,
+                                                         t8_dpyramid_t * nca);
+
+/** Compute the linear id of an element in a uniform refinement of the root
+ * pyramid of a given level.
+ * Since pyramids and tetrahedra have a different number of children,
+ * the ids are not a concatenation of child ids.
+ * \param [in] p    The element.
+ * \param [in] level The level of the uniform refinement.
+ *                  If it is smaller than the level of \a p, the id of the
+ *                  ancestor of \a p at \a level is computed.
+ * \return          The linear id of \a p.
+ */
+t8_linearidx_t      t8_dpyramid_linear_id (const t8_dpyramid_t * p,
+                                           int level);
+
+/** Initialize an element as the element with a given linear id in a
+ * uniform refinement of a given level.
+ * \param [in,out] p  Existing element whose data will be filled.
+ * \param [in] level  The level of the uniform refinement.
+ * \param [in] id     The linear id, 0 <= \a id <
+ *                    \ref t8_dpyramid_count_leafs_from_root (level).
+ */
+void                t8_dpyramid_init_linear_id (t8_dpyramid_t * p, int level,
+                                                t8_linearidx_t id);
+
+/** Compute the successor of an element in a uniform grid of level \a level.
+ * \param [in] p    The element, must not be the last element of its level.
+ * \param [in,out] succ Existing element whose data will be filled with the
+ *                  data of p's successor on level \a level.
+ * \param [in] level The level of the uniform grid, 1 <= \a level <= level
+ *                  of \a p.
+ * \note \a p may point to the same element as \a succ.
+ */
+void                t8_dpyramid_successor (const t8_dpyramid_t * p,
+                                           t8_dpyramid_t * succ, int level);
+
+/** Compute the first descendant of an element at a given level.
+ * \param [in] p    The element.
+ * \param [in,out] desc Existing element whose data will be filled.
+ * \param [in] level The level of the descendant.
+ */
+void                t8_dpyramid_first_descendant (const t8_dpyramid_t * p,
+                                                  t8_dpyramid_t * desc,
+                                                  int level);
+
+/** Compute the last descendant of an element at a given level.
+ * \param [in] p    The element.
+ * \param [in,out] desc Existing element whose data will be filled.
+ * \param [in] level The level of the descendant.
+ */
+void                t8_dpyramid_last_descendant (const t8_dpyramid_t * p,
+                                                 t8_dpyramid_t * desc,
+                                                 int level);
+
+/** Count the number of descendants of an element at a given level.
+ * \param [in] p    The element.
+ * \param [in] level The level of the descendants.
+ * \return          The number of descendants of \a p at \a level,
+ *                  0 if \a level is smaller than the level of \a p.
+ */
+t8_gloidx_t         t8_dpyramid_count_leafs (const t8_dpyramid_t * p,
+                                             int level);
+
+/** Count the number of elements in a uniform refinement of the root pyramid.
+ * \param [in] level The level of the uniform refinement.
+ * \return          2 * 8^level - 6^level.
+ */
+t8_gloidx_t         t8_dpyramid_count_leafs_from_root (int level);
+
+/** Compute the integer coordinates of a vertex of an element.
+ * \param [in] p    The element.
+ * \param [in] vertex The number of the vertex.
+ * \param [out] coords The coordinates of the vertex.
+ */
+void                t8_dpyramid_compute_coords (const t8_dpyramid_t * p,
+                                                int vertex,
+                                                t8_dpyramid_coord_t
+                                                coords[3]);
+
+/** Return the shape of a face of an element.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \return          T8_ECLASS_QUAD for the base of a pyramid and
+ *                  T8_ECLASS_TRIANGLE for all other faces.
+ */
+t8_element_shape_t  t8_dpyramid_face_shape (const t8_dpyramid_t * p,
+                                            int face);
+
+/** Return the vertex number of a corner of a face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \param [in] corner A corner of \a face.
+ * \return          The vertex of \a p that is the corner of \a face.
+ */
+int                 t8_dpyramid_get_face_corner (const t8_dpyramid_t * p,
+                                                 int face, int corner);
+
+/** Compute the children of an element that touch a given face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \param [in,out] children Existing elements that will be filled with the
+ *                  children at \a face in linear order.
+ * \param [in] num_children The length of \a children, must be
+ *                  \ref T8_DPYRAMID_FACE_CHILDREN.
+ * \param [out] child_indices If not NULL, the child ids of the children.
+ * \note \a p may point to one of the \a children.
+ */
+void                t8_dpyramid_children_at_face (const t8_dpyramid_t * p,
+                                                  int face,
+                                                  t8_dpyramid_t * children[],
+                                                  int num_children,
+                                                  int *child_indices);
+
+/** Given a face of an element and a child number of a child of that face,
+ * return the face number of the child of the element that matches the
+ * child face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \param [in] face_child A number 0 <= \a face_child <
+ *                  \ref T8_DPYRAMID_FACE_CHILDREN.
+ * \return          The face of the face_child-th child at \a face that lies
+ *                  in \a face.
+ */
+int                 t8_dpyramid_face_child_face (const t8_dpyramid_t * p,
+                                                 int face, int face_child);
+
+/** Given a face of an element return the face number of the parent of the
+ * element that contains the element's face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \return          The face of the parent of \a p that contains \a face,
+ *                  -1 if no such face exists. For the root \a face.
+ */
+int                 t8_dpyramid_face_parent_face (const t8_dpyramid_t * p,
+                                                  int face);
+
+/** Query whether a face of an element lies on the boundary of the root.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \return          Nonzero if \a face lies on a face of the root pyramid.
+ */
+int                 t8_dpyramid_is_root_boundary (const t8_dpyramid_t * p,
+                                                  int face);
+
+/** Compute the face of the root pyramid that contains a face of an element.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \return          The face of the root that contains \a face,
+ *                  -1 if \a face is not on the boundary of the root.
+ */
+int                 t8_dpyramid_tree_face (const t8_dpyramid_t * p,
+                                           int face);
+
+/** Compute the same level face neighbor of an element inside the root.
+ * \param [in] p    The element.
+ * \param [in,out] neigh Existing element whose data will be filled with the
+ *                  data of the face neighbor of \a p.
+ * \param [in] face A face of \a p.
+ * \param [out] neigh_face The face of \a neigh that is shared with \a p.
+ * \return          Nonzero if the neighbor lies inside the root pyramid.
+ *                  If zero, \a neigh and \a neigh_face are not changed.
+ */
+int                 t8_dpyramid_face_neighbor_inside (const t8_dpyramid_t *
+                                                      p,
+                                                      t8_dpyramid_t * neigh,
+                                                      int face,
+                                                      int *neigh_face);
+
+/** Construct the boundary element of an element face at the root boundary.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p with \ref t8_dpyramid_is_root_boundary.
+ * \param [in,out] boundary Existing triangle or quadrilateral whose data will
+ *                  be filled with the data of the face.
+ */
+void                t8_dpyramid_boundary_face (const t8_dpyramid_t * p,
+                                               int face,
+                                               t8_element_t * boundary);
+
+/** Construct the element inside the root pyramid that has a given boundary
+ * element at a face of the root as a face.
+ * \param [in] face A triangle or quadrilateral in the boundary of the root.
+ * \param [in,out] p Existing element whose data will be filled.
+ * \param [in] root_face The face of the root that contains \a face.
+ * \return          The face of \a p that coincides with \a face.
+ */
+int                 t8_dpyramid_extrude_face (const t8_element_t * face,
+                                              t8_dpyramid_t * p,
+                                              int root_face);
+
+/** Compute the first descendant of an element at a given level that touches
+ * a given face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \param [in,out] desc Existing element whose data will be filled.
+ * \param [in] level The level of the descendant.
+ */
+void                t8_dpyramid_first_descendant_face (const t8_dpyramid_t *
+                                                       p, int face,
+                                                       t8_dpyramid_t * desc,
+                                                       int level);
+
+/** Compute the last descendant of an element at a given level that touches
+ * a given face.
+ * \param [in] p    The element.
+ * \param [in] face A face of \a p.
+ * \param [in,out] desc Existing element whose data will be filled.
+ * \param [in] level The level of the descendant.
+ */
+void                t8_dpyramid_last_descendant_face (const t8_dpyramid_t *
+                                                      p, int face,
+                                                      t8_dpyramid_t * desc,
+                                                      int level);
+
+/** Query whether all entries of an element are in valid ranges.
+ * \param [in] p    The element.
+ * \return          True if \a p is a valid element.
+ */
+int                 t8_dpyramid_is_valid (const t8_dpyramid_t * p);
+
+T8_EXTERN_C_END ();
+
+#endif /* T8_DPYRAMID_BITS_H */
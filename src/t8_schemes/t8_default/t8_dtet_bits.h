@@ -262,6 +262,27 @@ t8_linearidx_t      t8_dtet_linear_id (const t8_dtet_t * t, int level);
 void                t8_dtet_init_linear_id (t8_dtet_t * t, t8_linearidx_t id,
                                             int level);
 
+/** Compute the linear id of a tetrahedron level by level.
+ * This is the reference implementation of \ref t8_dtet_linear_id,
+ * which processes several levels at once using lookup tables.
+ * \param [in] t  tetrahedron whose id will be computed.
+ * \param [in] level level of uniform grid to be considered.
+ * \return Returns the linear position of this tetrahedron on a grid of level \a level.
+ */
+t8_linearidx_t      t8_dtet_linear_id_per_level (const t8_dtet_t * t,
+                                                 int level);
+
+/** Initialize a tetrahedron from its linear id level by level.
+ * This is the reference implementation of \ref t8_dtet_init_linear_id,
+ * which processes several levels at once using lookup tables.
+ * \param [in,out] t  Existing tetrahedron whose data will be filled.
+ * \param [in] id     Index to be considered.
+ * \param [in] level  level of uniform grid to be considered.
+ */
+void                t8_dtet_init_linear_id_per_level (t8_dtet_t * t,
+                                                      t8_linearidx_t id,
+                                                      int level);
+
 /** Initialize a tetrahedron as the root tetrahedron (type 0 at level 0)
  * \param [in,out] t Existing tetrahedron whose data will be filled.
  */
@@ -276,6 +297,42 @@ void                t8_dtet_init_root (t8_dtet_t * t);
 void                t8_dtet_successor (const t8_dtet_t * t, t8_dtet_t * s,
                                        int level);
 
+/** Compute the linear ids of many tetrahedra in a uniform grid.
+ * This computes the same ids as \ref t8_dtet_linear_id, but processes
+ * several tetrahedra simultaneously without data dependent branches.
+ * \param [in] t      Array of tetrahedra whose ids will be computed.
+ * \param [in] count  The number of tetrahedra in \a t.
+ * \param [in] level  Level of uniform grid to be considered. Must be greater
+ *                    or equal to the level of each tetrahedron.
+ * \param [out] ids   Array of length \a count. On output the linear ids
+ *                    of the tetrahedra of \a t.
+ */
+void                t8_dtet_linear_id_batch (const t8_dtet_t * t, int count,
+                                             int level, t8_linearidx_t * ids);
+
+/** Initialize many tetrahedra from their linear ids in a uniform grid.
+ * This is the batch version of \ref t8_dtet_init_linear_id.
+ * \param [in,out] t  Array of \a count existing tetrahedra.
+ * \param [in] count  The number of tetrahedra in \a t.
+ * \param [in] ids    Array of \a count ids.
+ * \param [in] level  Level of uniform grid to be considered.
+ */
+void                t8_dtet_init_linear_id_batch (t8_dtet_t * t, int count,
+                                                  const t8_linearidx_t * ids,
+                                                  int level);
+
+/** Compute the successors of many tetrahedra in a uniform grid.
+ * This is the batch version of \ref t8_dtet_successor.
+ * \param [in] t      Array of \a count tetrahedra of level \a level.
+ * \param [in,out] s  Array of \a count existing tetrahedra whose data will be
+ *                    filled with the data of the successors of \a t.
+ * \param [in] count  The number of tetrahedra in \a t.
+ * \param [in] level  Level of uniform grid to be considered.
+ */
+void                t8_dtet_successor_batch (const t8_dtet_t * t,
+                                             t8_dtet_t * s, int count,
+                                             int level);
+
 /** Compute the first descendant of a tetrahedron at a given level. This is the descendant of
  * the tetrahedron in a uniform maxlevel refinement that has the smaller id.
  * \param [in] t        tetrahedron whose descendant is computed.
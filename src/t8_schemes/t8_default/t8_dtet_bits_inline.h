@@ -0,0 +1,233 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_dtet_bits_inline.h
+ * Header-inlined versions of the core tetrahedron kernels.
+ * The lookup tables are defined static in this header, such that the
+ * compiler can fold them into the kernels when inlining them into the
+ * tetrahedron scheme. The functions in t8_dtet_bits.h call these kernels.
+ */
+
+#ifndef T8_DTET_BITS_INLINE_H
+#define T8_DTET_BITS_INLINE_H
+
+#include "t8_dtet.h"
+#include "t8_dtet_connectivity.h"
+
+/* *INDENT-OFF* */
+/** The type of the parent for each (cube-id,type) combination. */
+static const int8_t t8_dtet_inline_cid_type_to_parenttype[8][6] =
+  T8_DTET_CID_TYPE_TO_PARENTTYPE;
+
+/** The type of the child for each (type,Bey child number) combination. */
+static const int8_t t8_dtet_inline_type_of_child[6][8] =
+  T8_DTET_TYPE_OF_CHILD;
+
+/** The Bey child number for each (type,Morton child number) combination. */
+static const int8_t t8_dtet_inline_index_to_bey_number[6][8] =
+  T8_DTET_INDEX_TO_BEY_NUMBER;
+
+/** The vertex that determines the anchor node of each Bey child. */
+static const int8_t t8_dtet_inline_beyid_to_vertex[8] =
+  T8_DTET_BEYID_TO_VERTEX;
+
+/** The local index for each (type,cube-id) combination. */
+static const int8_t t8_dtet_inline_type_cid_to_Iloc[6][8] =
+  T8_DTET_TYPE_CID_TO_ILOC;
+/* *INDENT-ON* */
+
+/** Compute the cube-id of the ancestor of a tetrahedron at a given level.
+ * \param [in] t      Input tetrahedron.
+ * \param [in] level  A level in 0, ..., T8_DTET_MAXLEVEL.
+ * \return            The cube-id, 0 if \a level is 0.
+ */
+static inline int
+t8_dtet_cube_id_inline (const t8_dtet_t * t, int level)
+{
+  const t8_dtet_coord_t h = T8_DTET_LEN (level);
+
+  T8_ASSERT (0 <= level && level <= T8_DTET_MAXLEVEL);
+  if (level == 0) {
+    return 0;
+  }
+  return ((t->x & h) ? 0x01 : 0) | ((t->y & h) ? 0x02 : 0)
+    | ((t->z & h) ? 0x04 : 0);
+}
+
+/** Return the type of the parent of a tetrahedron.
+ * \param [in] t  Input tetrahedron, its level must be greater than 0.
+ */
+static inline int
+t8_dtet_parent_type_inline (const t8_dtet_t * t)
+{
+  T8_ASSERT (t->level > 0);
+  return t8_dtet_inline_cid_type_to_parenttype[t8_dtet_cube_id_inline
+                                               (t, t->level)][t->type];
+}
+
+/** Return the type of a child of a tetrahedron.
+ * \param [in] t        Input tetrahedron.
+ * \param [in] childid  The child id in Morton order.
+ */
+static inline int
+t8_dtet_child_type_inline (const t8_dtet_t * t, int childid)
+{
+  T8_ASSERT (0 <= childid && childid < T8_DTET_CHILDREN);
+  return t8_dtet_inline_type_of_child[t->type]
+    [t8_dtet_inline_index_to_bey_number[t->type][childid]];
+}
+
+/** Compute the coordinates of a vertex of a tetrahedron.
+ * \see t8_dtet_compute_coords */
+static inline void
+t8_dtet_compute_coords_inline (const t8_dtet_t * t, int vertex,
+                               t8_dtet_coord_t coordinates[T8_DTET_DIM])
+{
+  const int           ei = t->type / 2;
+  const t8_dtet_coord_t h = T8_DTET_LEN (t->level);
+
+  T8_ASSERT (0 <= vertex && vertex < T8_DTET_FACES);
+  coordinates[0] = t->x;
+  coordinates[1] = t->y;
+  coordinates[2] = t->z;
+  if (vertex == 0) {
+    return;
+  }
+  coordinates[ei] += h;
+  if (vertex == 2) {
+    coordinates[(ei + ((t->type % 2 == 0) ? 2 : 1)) % 3] += h;
+  }
+  else if (vertex == 3) {
+    coordinates[(ei + 1) % 3] += h;
+    coordinates[(ei + 2) % 3] += h;
+  }
+}
+
+/** Compute the parent of a tetrahedron.
+ * \see t8_dtet_parent */
+static inline void
+t8_dtet_parent_inline (const t8_dtet_t * t, t8_dtet_t * parent)
+{
+  const t8_dtet_coord_t h = T8_DTET_LEN (t->level);
+
+  T8_ASSERT (t->level > 0);
+#ifdef T8_ENABLE_DEBUG
+  parent->eclass_int8 = t->eclass_int8;
+#endif
+  parent->type = t8_dtet_parent_type_inline (t);
+  parent->x = t->x & ~h;
+  parent->y = t->y & ~h;
+  parent->z = t->z & ~h;
+  parent->level = t->level - 1;
+}
+
+/** Compute a child of a tetrahedron. It is possible that \a t == \a child.
+ * \see t8_dtet_child */
+static inline void
+t8_dtet_child_inline (const t8_dtet_t * t, int childid, t8_dtet_t * child)
+{
+  t8_dtet_coord_t     t_coordinates[T8_DTET_DIM];
+  int                 Bey_cid;
+
+  T8_ASSERT (t->level < T8_DTET_MAXLEVEL);
+  T8_ASSERT (0 <= childid && childid < T8_DTET_CHILDREN);
+
+  Bey_cid = t8_dtet_inline_index_to_bey_number[t->type][childid];
+  /* i-th anchor coordinate of child is (X_(0,i)+X_(vertex,i))/2
+   * where X_(i,j) is the j-th coordinate of t's ith node.
+   * For Bey child 0 the vertex is 0 and the anchor node is t's. */
+  t8_dtet_compute_coords_inline (t, t8_dtet_inline_beyid_to_vertex[Bey_cid],
+                                 t_coordinates);
+  child->x = (t->x + t_coordinates[0]) >> 1;
+  child->y = (t->y + t_coordinates[1]) >> 1;
+  child->z = (t->z + t_coordinates[2]) >> 1;
+  child->type = t8_dtet_inline_type_of_child[t->type][Bey_cid];
+  child->level = t->level + 1;
+}
+
+/** Compute the child id of a tetrahedron in Morton order.
+ * \see t8_dtet_child_id */
+static inline int
+t8_dtet_child_id_inline (const t8_dtet_t * t)
+{
+  return t8_dtet_inline_type_cid_to_Iloc[t->type][t8_dtet_cube_id_inline
+                                                  (t, t->level)];
+}
+
+/** Compute a sibling of a tetrahedron.
+ * \see t8_dtet_sibling */
+static inline void
+t8_dtet_sibling_inline (const t8_dtet_t * t, int sibid, t8_dtet_t * sibling)
+{
+  T8_ASSERT (0 <= sibid && sibid < T8_DTET_CHILDREN);
+  T8_ASSERT (t->level > 0);
+  t8_dtet_parent_inline (t, sibling);
+  t8_dtet_child_inline (sibling, sibid, sibling);
+}
+
+/** Compute the face neighbour of a tetrahedron.
+ * \see t8_dtet_face_neighbour */
+static inline int
+t8_dtet_face_neighbour_inline (const t8_dtet_t * t, int face, t8_dtet_t * n)
+{
+  const int           type_old = t->type;
+  /* We compute modulo six and do not want negative numbers */
+  int                 type_new = type_old + 6;
+  int                 sign, ret;
+  t8_dtet_coord_t     coords[3];
+
+  T8_ASSERT (0 <= face && face < T8_DTET_FACES);
+  coords[0] = t->x;
+  coords[1] = t->y;
+  coords[2] = t->z;
+  if (face == 1 || face == 2) {
+    sign = (type_new % 2 == 0 ? 1 : -1);
+    sign *= (face % 2 == 0 ? 1 : -1);
+    type_new += sign;
+    ret = face;
+  }
+  else {
+    if (face == 0) {
+      /* type: 0,1 --> x+1
+       *       2,3 --> y+1
+       *       4,5 --> z+1 */
+      coords[type_old / 2] += T8_DTET_LEN (t->level);
+      type_new += (type_new % 2 == 0 ? 4 : 2);
+    }
+    else {
+      /* type: 1,2 --> z-1
+       *       3,4 --> x-1
+       *       5,0 --> y-1 */
+      coords[((type_new + 3) % 6) / 2] -= T8_DTET_LEN (t->level);
+      type_new += (type_new % 2 == 0 ? 2 : 4);
+    }
+    ret = 3 - face;
+  }
+  n->x = coords[0];
+  n->y = coords[1];
+  n->z = coords[2];
+  n->level = t->level;
+  n->type = type_new % 6;
+  return ret;
+}
+
+#endif /* T8_DTET_BITS_INLINE_H */
@@ -23,27 +23,12 @@
 #include "t8_dtri_to_dtet.h"
 #include "t8_dtet_connectivity.h"
 
-const int           t8_dtet_cid_type_to_parenttype[8][6] = {
-  {0, 1, 2, 3, 4, 5},
-  {0, 1, 1, 1, 0, 0},
-  {2, 2, 2, 3, 3, 3},
-  {1, 1, 2, 2, 2, 1},
-  {5, 5, 4, 4, 4, 5},
-  {0, 0, 0, 5, 5, 5},
-  {4, 3, 3, 3, 4, 4},
-  {0, 1, 2, 3, 4, 5}
-};
+const int           t8_dtet_cid_type_to_parenttype[8][6] =
+  T8_DTET_CID_TYPE_TO_PARENTTYPE;
 
 /* In dependence of a type x give the type of
  * the child with Bey number y */
-const int           t8_dtet_type_of_child[6][8] = {
-  {0, 0, 0, 0, 4, 5, 2, 1},
-  {1, 1, 1, 1, 3, 2, 5, 0},
-  {2, 2, 2, 2, 0, 1, 4, 3},
-  {3, 3, 3, 3, 5, 4, 1, 2},
-  {4, 4, 4, 4, 2, 3, 0, 5},
-  {5, 5, 5, 5, 1, 0, 3, 4}
-};
+const int           t8_dtet_type_of_child[6][8] = T8_DTET_TYPE_OF_CHILD;
 
 /* in dependence of a type x give the type of
  * the child with Morton number y */
@@ -58,16 +43,10 @@ const int           t8_dtet_type_of_child_morton[6][8] = {
 
 /* Line b, row I gives the Bey child-id of
  * a Tet with Parent type b and local morton index I */
-const int           t8_dtet_index_to_bey_number[6][8] = {
-  {0, 1, 4, 5, 2, 7, 6, 3},
-  {0, 1, 5, 4, 7, 2, 6, 3},
-  {0, 4, 5, 1, 2, 7, 6, 3},
-  {0, 1, 5, 4, 6, 7, 2, 3},
-  {0, 4, 5, 1, 6, 2, 7, 3},
-  {0, 5, 4, 1, 6, 7, 2, 3},
-};
+const int           t8_dtet_index_to_bey_number[6][8] =
+  T8_DTET_INDEX_TO_BEY_NUMBER;
 
-const int           t8_dtet_beyid_to_vertex[8] = { 0, 1, 2, 3, 1, 1, 2, 2 };
+const int           t8_dtet_beyid_to_vertex[8] = T8_DTET_BEYID_TO_VERTEX;
 
 /* Line b, row c gives the Bey child-id of
  * a Tet with type b and cubeid c */
@@ -91,14 +70,8 @@ const int           t8_dtet_parenttype_beyid_to_Iloc[6][8] = {
   {0, 3, 6, 7, 2, 1, 4, 5}
 };
 
-const int           t8_dtet_type_cid_to_Iloc[6][8] = {
-  {0, 1, 1, 4, 1, 4, 4, 7},
-  {0, 1, 2, 5, 2, 5, 4, 7},
-  {0, 2, 3, 4, 1, 6, 5, 7},
-  {0, 3, 1, 5, 2, 4, 6, 7},
-  {0, 2, 2, 6, 3, 5, 5, 7},
-  {0, 3, 3, 6, 3, 6, 6, 7}
-};
+const int           t8_dtet_type_cid_to_Iloc[6][8] =
+  T8_DTET_TYPE_CID_TO_ILOC;
 
 const int           t8_dtet_parenttype_Iloc_to_type[6][8] = {
   {0, 0, 4, 5, 0, 1, 2, 0},
@@ -34,6 +34,29 @@ T8_EXTERN_C_BEGIN ();
 /** The spatial dimension */
 #define T8_DTET_DIM (3)
 
+/* The initializers of the tables that are needed by the element kernels.
+ * They are shared with the header-inlined kernels in t8_dtet_bits_inline.h,
+ * such that both use the same values. */
+/* *INDENT-OFF* */
+#define T8_DTET_CID_TYPE_TO_PARENTTYPE \
+  {{0, 1, 2, 3, 4, 5}, {0, 1, 1, 1, 0, 0}, {2, 2, 2, 3, 3, 3}, \
+   {1, 1, 2, 2, 2, 1}, {5, 5, 4, 4, 4, 5}, {0, 0, 0, 5, 5, 5}, \
+   {4, 3, 3, 3, 4, 4}, {0, 1, 2, 3, 4, 5}}
+#define T8_DTET_TYPE_OF_CHILD \
+  {{0, 0, 0, 0, 4, 5, 2, 1}, {1, 1, 1, 1, 3, 2, 5, 0}, \
+   {2, 2, 2, 2, 0, 1, 4, 3}, {3, 3, 3, 3, 5, 4, 1, 2}, \
+   {4, 4, 4, 4, 2, 3, 0, 5}, {5, 5, 5, 5, 1, 0, 3, 4}}
+#define T8_DTET_INDEX_TO_BEY_NUMBER \
+  {{0, 1, 4, 5, 2, 7, 6, 3}, {0, 1, 5, 4, 7, 2, 6, 3}, \
+   {0, 4, 5, 1, 2, 7, 6, 3}, {0, 1, 5, 4, 6, 7, 2, 3}, \
+   {0, 4, 5, 1, 6, 2, 7, 3}, {0, 5, 4, 1, 6, 7, 2, 3}}
+#define T8_DTET_BEYID_TO_VERTEX {0, 1, 2, 3, 1, 1, 2, 2}
+#define T8_DTET_TYPE_CID_TO_ILOC \
+  {{0, 1, 1, 4, 1, 4, 4, 7}, {0, 1, 2, 5, 2, 5, 4, 7}, \
+   {0, 2, 3, 4, 1, 6, 5, 7}, {0, 3, 1, 5, 2, 4, 6, 7}, \
+   {0, 2, 2, 6, 3, 5, 5, 7}, {0, 3, 3, 6, 3, 6, 6, 7}}
+/* *INDENT-ON* */
+
 /** Store the type of parent for each (cube-id,type) combination. */
 extern const int    t8_dtet_cid_type_to_parenttype[8][6];
 
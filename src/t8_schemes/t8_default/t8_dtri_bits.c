@@ -23,9 +23,11 @@
 #ifndef T8_DTRI_TO_DTET
 #include "t8_dtri_bits.h"
 #include "t8_dtri_connectivity.h"
+#include "t8_dtri_bits_inline.h"
 #else
 #include "t8_dtet_bits.h"
 #include "t8_dtet_connectivity.h"
+#include "t8_dtet_bits_inline.h"
 #endif
 
 typedef int8_t      t8_dtri_cube_id_t;
@@ -35,25 +37,9 @@ typedef int8_t      t8_dtri_cube_id_t;
 static              t8_dtri_cube_id_t
 compute_cubeid (const t8_dtri_t * t, int level)
 {
-  t8_dtri_cube_id_t   id = 0;
-  t8_dtri_coord_t     h;
-
   /* TODO: assert that 0 < level? This may simplify code elsewhere */
 
-  T8_ASSERT (0 <= level && level <= T8_DTRI_MAXLEVEL);
-  h = T8_DTRI_LEN (level);
-
-  if (level == 0) {
-    return 0;
-  }
-
-  id |= ((t->x & h) ? 0x01 : 0);
-  id |= ((t->y & h) ? 0x02 : 0);
-#ifdef T8_DTRI_TO_DTET
-  id |= ((t->z & h) ? 0x04 : 0);
-#endif
-
-  return id;
+  return t8_dtri_cube_id_inline (t, level);
 }
 
 /* A routine to compute the type of t's ancestor of level "level",
@@ -133,28 +119,7 @@ t8_dtri_compare (const t8_dtri_t * t1, const t8_dtri_t * t2)
 void
 t8_dtri_parent (const t8_dtri_t * t, t8_dtri_t * parent)
 {
-  t8_dtri_cube_id_t   cid;
-  t8_dtri_coord_t     h;
-
-  T8_ASSERT (t->level > 0);
-
-#ifdef T8_ENABLE_DEBUG
-#ifdef T8_DTRI_TO_DTET
-  parent->eclass_int8 = t->eclass_int8;
-#endif
-#endif
-
-  h = T8_DTRI_LEN (t->level);
-  /* Compute type of parent */
-  cid = compute_cubeid (t, t->level);
-  parent->type = t8_dtri_cid_type_to_parenttype[cid][t->type];
-  /* Set coordinates of parent */
-  parent->x = t->x & ~h;
-  parent->y = t->y & ~h;
-#ifdef T8_DTRI_TO_DTET
-  parent->z = t->z & ~h;
-#endif
-  parent->level = t->level - 1;
+  t8_dtri_parent_inline (t, parent);
 }
 
 void
@@ -291,49 +256,7 @@ void
 t8_dtri_compute_coords (const t8_dtri_t * t, int vertex,
                         t8_dtri_coord_t coordinates[T8_DTRI_DIM])
 {
-  t8_dtri_type_t      type;
-  int                 ei;
-#ifdef T8_DTRI_TO_DTET
-  int                 ej;
-#endif
-  t8_dtri_coord_t     h;
-
-  T8_ASSERT (0 <= vertex && vertex < T8_DTRI_FACES);
-
-  type = t->type;
-  h = T8_DTRI_LEN (t->level);
-#ifndef T8_DTRI_TO_DTET
-  ei = type;
-#else
-  ei = type / 2;
-  ej = (ei + ((type % 2 == 0) ? 2 : 1)) % 3;
-#endif
-
-  coordinates[0] = t->x;
-  coordinates[1] = t->y;
-#ifdef T8_DTRI_TO_DTET
-  coordinates[2] = t->z;
-#endif
-  if (vertex == 0) {
-    return;
-  }
-  coordinates[ei] += h;
-#ifndef T8_DTRI_TO_DTET
-  if (vertex == 2) {
-    coordinates[1 - ei] += h;
-    return;
-  }
-#else
-  if (vertex == 2) {
-    coordinates[ej] += h;
-    return;
-  }
-  if (vertex == 3) {
-    coordinates[(ei + 1) % 3] += h;
-    coordinates[(ei + 2) % 3] += h;
-  }
-  /* done 3D */
-#endif
+  t8_dtri_compute_coords_inline (t, vertex, coordinates);
 }
 
 /* Compute the coordinates of each vertex of a triangle/tet */
@@ -404,42 +327,7 @@ t8_dtri_compute_all_coords (const t8_dtri_t * t,
 void
 t8_dtri_child (const t8_dtri_t * t, int childid, t8_dtri_t * child)
 {
-  t8_dtri_t          *c = (t8_dtri_t *) child;
-  t8_dtri_coord_t     t_coordinates[T8_DTRI_DIM];
-  int                 vertex;
-  int                 Bey_cid;
-
-  T8_ASSERT (t->level < T8_DTRI_MAXLEVEL);
-  T8_ASSERT (0 <= childid && childid < T8_DTRI_CHILDREN);
-
-  Bey_cid = t8_dtri_index_to_bey_number[t->type][childid];
-
-  /* Compute anchor coordinates of child */
-  if (Bey_cid == 0) {
-    /* TODO: would it be better do drop this if and
-     *       capture it with (t->x+t->x)>>1 below? */
-    c->x = t->x;
-    c->y = t->y;
-#ifdef T8_DTRI_TO_DTET
-    c->z = t->z;
-#endif
-  }
-  else {
-    vertex = t8_dtri_beyid_to_vertex[Bey_cid];
-    /* i-th anchor coordinate of child is (X_(0,i)+X_(vertex,i))/2
-     * where X_(i,j) is the j-th coordinate of t's ith node */
-    t8_dtri_compute_coords (t, vertex, t_coordinates);
-    c->x = (t->x + t_coordinates[0]) >> 1;
-    c->y = (t->y + t_coordinates[1]) >> 1;
-#ifdef T8_DTRI_TO_DTET
-    c->z = (t->z + t_coordinates[2]) >> 1;
-#endif
-  }
-
-  /* Compute type of child */
-  c->type = t8_dtri_type_of_child[t->type][Bey_cid];
-
-  c->level = t->level + 1;
+  t8_dtri_child_inline (t, childid, child);
 }
 
 void
@@ -542,10 +430,7 @@ t8_dtri_is_familypv (const t8_dtri_t * f[])
 void
 t8_dtri_sibling (const t8_dtri_t * elem, int sibid, t8_dtri_t * sibling)
 {
-  T8_ASSERT (0 <= sibid && sibid < T8_DTRI_CHILDREN);
-  T8_ASSERT (((const t8_dtri_t *) elem)->level > 0);
-  t8_dtri_parent (elem, sibling);
-  t8_dtri_child (sibling, sibid, sibling);
+  t8_dtri_sibling_inline (elem, sibid, sibling);
 }
 
 /* Saves the neighbour of T along face "face" in N
@@ -554,75 +439,7 @@ int
 t8_dtri_face_neighbour (const t8_dtri_t * t, int face, t8_dtri_t * n)
 {
   /* TODO: document what happens if outside of root tet */
-  int                 type_new, type_old;
-#ifdef T8_DTRI_TO_DTET
-  int                 sign;
-#endif
-  int                 ret = -1;
-  int8_t              level;
-  t8_dtri_coord_t     coords[3];
-
-  T8_ASSERT (0 <= face && face < T8_DTRI_FACES);
-
-  level = t->level;
-  type_old = t->type;
-  type_new = type_old;
-  coords[0] = t->x;
-  coords[1] = t->y;
-#ifdef T8_DTRI_TO_DTET
-  coords[2] = t->z;
-#endif
-
-#ifndef T8_DTRI_TO_DTET
-  /* 2D */
-  ret = 2 - face;
-  type_new = 1 - type_old;
-  if (face == 0) {
-    coords[type_old] += T8_DTRI_LEN (level);
-  }
-  else if (face == 2) {
-    coords[1 - type_old] -= T8_DTRI_LEN (level);
-  }
-  /* 2D end */
-#else
-  /* 3D */
-  type_new += 6;                /* We want to compute modulo six and dont want negative numbers */
-  if (face == 1 || face == 2) {
-    sign = (type_new % 2 == 0 ? 1 : -1);
-    sign *= (face % 2 == 0 ? 1 : -1);
-    type_new += sign;
-    type_new %= 6;
-    ret = face;
-  }
-  else {
-    if (face == 0) {
-      /* type: 0,1 --> x+1
-       *       2,3 --> y+1
-       *       4,5 --> z+1 */
-      coords[type_old / 2] += T8_DTRI_LEN (level);
-      type_new += (type_new % 2 == 0 ? 4 : 2);
-    }
-    else {                      /* face == 3 */
-
-      /* type: 1,2 --> z-1
-       *       3,4 --> x-1
-       *       5,0 --> y-1 */
-      coords[((type_new + 3) % 6) / 2] -= T8_DTRI_LEN (level);
-      type_new += (type_new % 2 == 0 ? 2 : 4);
-    }
-    type_new %= 6;
-    ret = 3 - face;
-  }
-  /* 3D end */
-#endif
-  n->x = coords[0];
-  n->y = coords[1];
-#ifdef T8_DTRI_TO_DTET
-  n->z = coords[2];
-#endif
-  n->level = level;
-  n->type = type_new;
-  return ret;
+  return t8_dtri_face_neighbour_inline (t, face, n);
 }
 
 void
@@ -906,57 +723,59 @@ t8_dtri_face_parent_face (const t8_dtri_t * triangle, int face)
 }
 
 #ifndef T8_DTRI_TO_DTET
+/* The coordinates of a face triangle in the neighbor tree as linear
+ * combinations of its coordinates x, y, its length h and the root length R.
+ * The table is indexed by sign, orientation (with respect to the smaller
+ * face), type and coordinate of the result, the entries are the factors
+ * of x, y, h and R.
+ * The corners of the triangle are enumerated like this
+ *        type 0                    type 1
+ *      also root tree
+ *         v_2                     v_1  v_2
+ *         x                         x--x
+ *        /|                         | /
+ *       / |                         |/
+ *      x--x                         x
+ *    v_0  v_1                      v_0
+ *
+ * If sign is true, the tree faces have the same topological orientation
+ * and the coordinates are switched before the orientation is applied,
+ * the sign = 1 entries are the composition of both maps.
+ */
+static const int8_t t8_dtri_transform_face_coeffs[2][3][2][2][4] = {
+  {
+   {{{ 1,  0,  0,  0}, { 0,  1,  0,  0}},
+    {{ 1,  0,  0,  0}, { 0,  1,  0,  0}}},
+   {{{ 0, -1, -1,  1}, { 1, -1,  0,  0}},
+    {{ 0, -1, -1,  1}, { 1, -1, -1,  0}}},
+   {{{-1,  1, -1,  1}, {-1,  0, -1,  1}},
+    {{-1,  1,  0,  1}, {-1,  0, -1,  1}}}
+  },
+  {
+   {{{ 1,  0,  0,  0}, { 1, -1,  0,  0}},
+    {{ 1,  0,  0,  0}, { 1, -1, -1,  0}}},
+   {{{-1,  1, -1,  1}, { 0,  1,  0,  0}},
+    {{-1,  1,  0,  1}, { 0,  1,  0,  0}}},
+   {{{ 0, -1, -1,  1}, {-1,  0, -1,  1}},
+    {{ 0, -1, -1,  1}, {-1,  0, -1,  1}}}
+  }
+};
+
 /* This function has only a triangle version. */
 void
 t8_dtri_transform_face (const t8_dtri_t * trianglein,
                         t8_dtri_t * triangle2,
                         int orientation, int sign, int is_smaller_face)
 {
-  const t8_dtri_t    *triangle1;
-  t8_dtri_coord_t     h = T8_DTRI_LEN (trianglein->level);
-  t8_dtri_coord_t     x = trianglein->x;
+  const int8_t       *cx, *cy;
+  const t8_dtri_coord_t h = T8_DTRI_LEN (trianglein->level);
+  const t8_dtri_coord_t x = trianglein->x;
+  const t8_dtri_coord_t y = trianglein->y;
 
-#if 0
-  t8_debugf ("[H] in %i %i type %i. or = %i sign = %i smaller %i\n",
-             trianglein->x, trianglein->y, trianglein->type,
-             orientation, sign, is_smaller_face);
-#endif
   T8_ASSERT (0 <= orientation && orientation <= 2);
-  triangle2->level = trianglein->level;
-  triangle2->type = trianglein->type;
-  /*
-   * The corners of the triangle are enumerated like this
-   *        type 0                    type 1
-   *      also root tree
-   *         v_2                     v_1  v_2
-   *         x                         x--x
-   *        /|                         | /
-   *       / |                         |/
-   *      x--x                         x
-   *    v_0  v_1                      v_0
-   *
-   */
-
-  if (sign) {
-    /* The tree faces have the same topological orientation, and
-     * thus we have to perform a coordinate switch. */
-    /* We use triangl2 as storage, since trianglein and triangle2 are allowed to
-     * point to the same triangle */
-    triangle1 = triangle2;
-    t8_dtri_copy (trianglein, (t8_dtri_t *) triangle1);
-    if (trianglein->type == 0) {
-      ((t8_dtri_t *) triangle1)->y = trianglein->x - trianglein->y;
-    }
-    else {
-      ((t8_dtri_t *) triangle1)->y = trianglein->x - trianglein->y - h;
-    }
-  }
-  else {
-    triangle1 = trianglein;
-  }
-
+  T8_ASSERT (trianglein->type == 0 || trianglein->type == 1);
   if (!is_smaller_face && orientation != 0 && !sign) {
-    /* Translate orientation if triangle1 is not on the smaller face.
+    /* Translate orientation if trianglein is not on the smaller face.
      *  sign = 0  sign = 1
      *  0 -> 0    0 -> 0
      *  1 -> 2    1 -> 1
@@ -964,37 +783,14 @@ t8_dtri_transform_face (const t8_dtri_t * trianglein,
      */
     orientation = 3 - orientation;
   }
-  x = triangle1->x;             /* temporary store x coord in case triangle1 = triangle2 */
-  switch (orientation) {
-  case 0:
-    t8_dtri_copy (triangle1, triangle2);
-    break;
-  case 1:
-    triangle2->x = T8_DTRI_ROOT_LEN - h - triangle1->y;
-    if (triangle1->type == 0) {
-      triangle2->y = x - triangle1->y;
-    }
-    else {
-      triangle2->y = x - triangle1->y - h;
-    }
-    break;
-  case 2:
-    if (triangle1->type == 0) {
-      triangle2->x = T8_DTRI_ROOT_LEN - h + triangle1->y - x;
-    }
-    else {
-      triangle2->x = T8_DTRI_ROOT_LEN + triangle1->y - x;
-    }
-    triangle2->y = T8_DTRI_ROOT_LEN - h - x;
-    break;
-  default:
-    SC_ABORT_NOT_REACHED ();
-  }
-#if 0
-  t8_debugf ("[H] out %i %i type %i. or = %i sign = %i smaller %i\n",
-             triangle2->x, triangle2->y, triangle2->type,
-             orientation, sign, is_smaller_face);
-#endif
+  sign = sign != 0;
+  cx = t8_dtri_transform_face_coeffs[sign][orientation][trianglein->type][0];
+  cy = t8_dtri_transform_face_coeffs[sign][orientation][trianglein->type][1];
+  /* We copied x and y, thus trianglein and triangle2 may be the same */
+  triangle2->level = trianglein->level;
+  triangle2->type = trianglein->type;
+  triangle2->x = cx[0] * x + cx[1] * y + cx[2] * h + cx[3] * T8_DTRI_ROOT_LEN;
+  triangle2->y = cy[0] * x + cy[1] * y + cy[2] * h + cy[3] * T8_DTRI_ROOT_LEN;
 }
 #endif
 
@@ -1319,7 +1115,7 @@ t8_dtri_linear_id_corner_desc (const t8_dtri_t * t, int corner, int level)
 }
 
 t8_linearidx_t
-t8_dtri_linear_id (const t8_dtri_t * t, int level)
+t8_dtri_linear_id_per_level (const t8_dtri_t * t, int level)
 {
   t8_linearidx_t      id = 0;
   int8_t              type_temp = 0;
@@ -1350,7 +1146,8 @@ t8_dtri_linear_id (const t8_dtri_t * t, int level)
 }
 
 void
-t8_dtri_init_linear_id (t8_dtri_t * t, t8_linearidx_t id, int level)
+t8_dtri_init_linear_id_per_level (t8_dtri_t * t, t8_linearidx_t id,
+                                  int level)
 {
   int                 i;
   int                 offset_coords, offset_index;
@@ -1386,6 +1183,192 @@ t8_dtri_init_linear_id (t8_dtri_t * t, t8_linearidx_t id, int level)
   t->type = type;
 }
 
+/* The number of levels that the table driven linear id routines
+ * process in one step. */
+#ifndef T8_DTRI_TO_DTET
+#define T8_DTRI_TABLE_LEVELS 4
+#else
+#define T8_DTRI_TABLE_LEVELS 3
+#endif
+/* The number of different inputs per type for one table step */
+#define T8_DTRI_TABLE_INPUTS (1 << (T8_DTRI_DIM * T8_DTRI_TABLE_LEVELS))
+/* The mask for T8_DTRI_TABLE_LEVELS coordinate bits */
+#define T8_DTRI_TABLE_MASK ((1 << T8_DTRI_TABLE_LEVELS) - 1)
+
+/* An entry of the linear id tables, see t8_dtri_tables_init. */
+typedef struct
+{
+  uint16_t            bits;     /* The computed local ids or coordinate bits */
+  int8_t              type;     /* The type after the last processed level */
+} t8_dtri_table_entry_t;
+
+static t8_dtri_table_entry_t
+  t8_dtri_encode_table[T8_DTRI_NUM_TYPES][T8_DTRI_TABLE_INPUTS];
+static t8_dtri_table_entry_t
+  t8_dtri_decode_table[T8_DTRI_NUM_TYPES][T8_DTRI_TABLE_INPUTS];
+static int          t8_dtri_tables_initialized = 0;
+
+/* Fill the tables that are used to process T8_DTRI_TABLE_LEVELS levels
+ * of a linear id at once.
+ * The coordinate bits of the levels are stored as x | y << k (| z << 2k),
+ * with k = T8_DTRI_TABLE_LEVELS, where bit j of x, y and z belongs to the
+ * j-th finest of the levels.
+ * The local ids of the levels are stored as in the linear id, that is
+ * the local id of the j-th finest level at bits T8_DTRI_DIM * j.
+ * t8_dtri_encode_table[type][coordinate bits] gives the local ids of the
+ * levels, if the finest level has the given type, and the parent type of
+ * the coarsest level.
+ * t8_dtri_decode_table[type][local ids] gives the coordinate bits of the
+ * levels, if the parent of the coarsest level has the given type, and the
+ * type of the finest level.
+ */
+static void
+t8_dtri_tables_init (void)
+{
+  int                 type, input, j, cid, iloc, out;
+  int8_t              cur_type;
+  const int           k = T8_DTRI_TABLE_LEVELS;
+
+  for (type = 0; type < T8_DTRI_NUM_TYPES; type++) {
+    for (input = 0; input < T8_DTRI_TABLE_INPUTS; input++) {
+      /* Encode from the finest to the coarsest level */
+      cur_type = type;
+      out = 0;
+      for (j = 0; j < k; j++) {
+        cid = ((input >> j) & 1) | (((input >> (k + j)) & 1) << 1);
+#ifdef T8_DTRI_TO_DTET
+        cid |= ((input >> (2 * k + j)) & 1) << 2;
+#endif
+        out |= t8_dtri_type_cid_to_Iloc[cur_type][cid] << (T8_DTRI_DIM * j);
+        cur_type = t8_dtri_cid_type_to_parenttype[cid][cur_type];
+      }
+      t8_dtri_encode_table[type][input].bits = out;
+      t8_dtri_encode_table[type][input].type = cur_type;
+
+      /* Decode from the coarsest to the finest level */
+      cur_type = type;
+      out = 0;
+      for (j = k - 1; j >= 0; j--) {
+        iloc = (input >> (T8_DTRI_DIM * j)) & (T8_DTRI_CHILDREN - 1);
+        cid = t8_dtri_parenttype_Iloc_to_cid[cur_type][iloc];
+        cur_type = t8_dtri_parenttype_Iloc_to_type[cur_type][iloc];
+        out |= (cid & 1) << j;
+        out |= ((cid >> 1) & 1) << (k + j);
+#ifdef T8_DTRI_TO_DTET
+        out |= ((cid >> 2) & 1) << (2 * k + j);
+#endif
+      }
+      t8_dtri_decode_table[type][input].bits = out;
+      t8_dtri_decode_table[type][input].type = cur_type;
+    }
+  }
+  t8_dtri_tables_initialized = 1;
+}
+
+t8_linearidx_t
+t8_dtri_linear_id (const t8_dtri_t * t, int level)
+{
+  t8_linearidx_t      id = 0;
+  const t8_dtri_table_entry_t *entry;
+  int8_t              type;
+  t8_dtri_cube_id_t   cid;
+  int                 i, shift, input, exponent;
+
+  T8_ASSERT (0 <= level && level <= T8_DTRI_MAXLEVEL);
+  if (!t8_dtri_tables_initialized) {
+    t8_dtri_tables_init ();
+  }
+  exponent = 0;
+  /* If the given level is bigger than t's level
+   * we first fill up with the ids of t's descendants at t's
+   * origin with the same type as t */
+  if (level > t->level) {
+    exponent = (level - t->level) * T8_DTRI_DIM;
+  }
+  type = t->type;
+  /* Process the levels i, i - 1, ..., i - T8_DTRI_TABLE_LEVELS + 1 at once */
+  for (i = t->level; i >= T8_DTRI_TABLE_LEVELS; i -= T8_DTRI_TABLE_LEVELS) {
+    shift = T8_DTRI_MAXLEVEL - i;
+    input = ((t->x >> shift) & T8_DTRI_TABLE_MASK)
+      | (((t->y >> shift) & T8_DTRI_TABLE_MASK) << T8_DTRI_TABLE_LEVELS);
+#ifdef T8_DTRI_TO_DTET
+    input |= ((t->z >> shift) & T8_DTRI_TABLE_MASK)
+      << (2 * T8_DTRI_TABLE_LEVELS);
+#endif
+    entry = &t8_dtri_encode_table[type][input];
+    id |= ((t8_linearidx_t) entry->bits) << exponent;
+    exponent += T8_DTRI_DIM * T8_DTRI_TABLE_LEVELS;
+    type = entry->type;
+  }
+  /* Process the remaining coarse levels one by one */
+  for (; i > 0; i--) {
+    cid = compute_cubeid (t, i);
+    id |= ((t8_linearidx_t) t8_dtri_type_cid_to_Iloc[type][cid]) << exponent;
+    exponent += T8_DTRI_DIM;
+    type = t8_dtri_cid_type_to_parenttype[cid][type];
+  }
+  T8_ASSERT (id == t8_dtri_linear_id_per_level (t, level));
+  return id;
+}
+
+void
+t8_dtri_init_linear_id (t8_dtri_t * t, t8_linearidx_t id, int level)
+{
+  const t8_dtri_table_entry_t *entry;
+  t8_dtri_type_t      type;
+  t8_dtri_cube_id_t   cid;
+  int                 i, input, offset_coords, local_index;
+#ifdef T8_ENABLE_DEBUG
+  t8_dtri_t           check;
+#endif
+
+  T8_ASSERT (0 <= id && id <= ((t8_linearidx_t) 1) << (T8_DTRI_DIM * level));
+  if (!t8_dtri_tables_initialized) {
+    t8_dtri_tables_init ();
+  }
+  t->level = level;
+  t->x = 0;
+  t->y = 0;
+#ifdef T8_DTRI_TO_DTET
+  t->z = 0;
+#else
+  t->n = 0;
+#endif
+  type = 0;                     /* This is the type of the root triangle */
+  /* Process the levels i + 1, ..., i + T8_DTRI_TABLE_LEVELS at once */
+  for (i = 0; i + T8_DTRI_TABLE_LEVELS <= level; i += T8_DTRI_TABLE_LEVELS) {
+    input = (int) (id >> (T8_DTRI_DIM * (level - i - T8_DTRI_TABLE_LEVELS)))
+      & (T8_DTRI_TABLE_INPUTS - 1);
+    entry = &t8_dtri_decode_table[type][input];
+    offset_coords = T8_DTRI_MAXLEVEL - i - T8_DTRI_TABLE_LEVELS;
+    t->x |= (entry->bits & T8_DTRI_TABLE_MASK) << offset_coords;
+    t->y |= ((entry->bits >> T8_DTRI_TABLE_LEVELS) & T8_DTRI_TABLE_MASK)
+      << offset_coords;
+#ifdef T8_DTRI_TO_DTET
+    t->z |= ((entry->bits >> (2 * T8_DTRI_TABLE_LEVELS)) & T8_DTRI_TABLE_MASK)
+      << offset_coords;
+#endif
+    type = entry->type;
+  }
+  /* Process the remaining fine levels one by one */
+  for (i = i + 1; i <= level; i++) {
+    offset_coords = T8_DTRI_MAXLEVEL - i;
+    local_index = (id >> (T8_DTRI_DIM * (level - i))) & (T8_DTRI_CHILDREN - 1);
+    cid = t8_dtri_parenttype_Iloc_to_cid[type][local_index];
+    type = t8_dtri_parenttype_Iloc_to_type[type][local_index];
+    t->x |= (cid & 1) ? 1 << offset_coords : 0;
+    t->y |= (cid & 2) ? 1 << offset_coords : 0;
+#ifdef T8_DTRI_TO_DTET
+    t->z |= (cid & 4) ? 1 << offset_coords : 0;
+#endif
+  }
+  t->type = type;
+#ifdef T8_ENABLE_DEBUG
+  t8_dtri_init_linear_id_per_level (&check, id, level);
+  T8_ASSERT (t8_dtri_is_equal (&check, t));
+#endif
+}
+
 void
 t8_dtri_init_root (t8_dtri_t * t)
 {
@@ -1461,6 +1444,159 @@ t8_dtri_successor (const t8_dtri_t * t, t8_dtri_t * s, int level)
   t8_dtri_succ_pred_recursion (t, s, level, 1);
 }
 
+/* The number of elements that the batch routines process at once.
+ * In the loops over these lanes the tables are accessed without data
+ * dependent branches, such that the compiler can vectorize them for the
+ * target architecture. */
+#define T8_DTRI_BATCH_LANES 16
+
+void
+t8_dtri_linear_id_batch (const t8_dtri_t * t, int count, int level,
+                         t8_linearidx_t * ids)
+{
+  t8_linearidx_t      lane_id[T8_DTRI_BATCH_LANES];
+  int                 lane_type[T8_DTRI_BATCH_LANES];
+  int                 lane_exponent[T8_DTRI_BATCH_LANES];
+  int                 lane_level[T8_DTRI_BATCH_LANES];
+  int                 offset, num, ilane, i, shift, active, max_level;
+  int                 cid, iloc;
+  const t8_dtri_t    *elem;
+
+  T8_ASSERT (count >= 0);
+  T8_ASSERT (0 <= level && level <= T8_DTRI_MAXLEVEL);
+  for (offset = 0; offset < count; offset += num) {
+    num = SC_MIN (count - offset, T8_DTRI_BATCH_LANES);
+    max_level = 0;
+    for (ilane = 0; ilane < num; ilane++) {
+      elem = t + offset + ilane;
+      T8_ASSERT (elem->level <= level);
+      lane_id[ilane] = 0;
+      lane_type[ilane] = elem->type;
+      lane_level[ilane] = elem->level;
+      /* The ids of the descendants at t's origin with t's type are 0 */
+      lane_exponent[ilane] = (level - elem->level) * T8_DTRI_DIM;
+      max_level = SC_MAX (max_level, elem->level);
+    }
+    /* Climb up from the finest level in the batch. Lanes whose element
+     * is coarser than the current level are masked. */
+    for (i = max_level; i > 0; i--) {
+      shift = T8_DTRI_MAXLEVEL - i;
+      for (ilane = 0; ilane < num; ilane++) {
+        elem = t + offset + ilane;
+        active = i <= lane_level[ilane];
+        cid = ((elem->x >> shift) & 1) | (((elem->y >> shift) & 1) << 1);
+#ifdef T8_DTRI_TO_DTET
+        cid |= ((elem->z >> shift) & 1) << 2;
+#endif
+        iloc = t8_dtri_type_cid_to_Iloc[lane_type[ilane]][cid];
+        lane_id[ilane] |=
+          ((t8_linearidx_t) (active ? iloc : 0)) << lane_exponent[ilane];
+        lane_exponent[ilane] += active ? T8_DTRI_DIM : 0;
+        lane_type[ilane] = active ?
+          t8_dtri_cid_type_to_parenttype[cid][lane_type[ilane]] :
+          lane_type[ilane];
+      }
+    }
+    for (ilane = 0; ilane < num; ilane++) {
+      ids[offset + ilane] = lane_id[ilane];
+      /* Validate against the scalar implementation */
+      T8_ASSERT (lane_id[ilane] ==
+                 t8_dtri_linear_id (t + offset + ilane, level));
+    }
+  }
+}
+
+void
+t8_dtri_init_linear_id_batch (t8_dtri_t * t, int count,
+                              const t8_linearidx_t * ids, int level)
+{
+  t8_dtri_coord_t     lane_x[T8_DTRI_BATCH_LANES];
+  t8_dtri_coord_t     lane_y[T8_DTRI_BATCH_LANES];
+#ifdef T8_DTRI_TO_DTET
+  t8_dtri_coord_t     lane_z[T8_DTRI_BATCH_LANES];
+#endif
+  int                 lane_type[T8_DTRI_BATCH_LANES];
+  int                 offset, num, ilane, i;
+  int                 offset_coords, offset_index, local_index, cid;
+  const int           children_m1 = T8_DTRI_CHILDREN - 1;
+#ifdef T8_ENABLE_DEBUG
+  t8_dtri_t           check;
+#endif
+
+  T8_ASSERT (count >= 0);
+  T8_ASSERT (0 <= level && level <= T8_DTRI_MAXLEVEL);
+  for (offset = 0; offset < count; offset += num) {
+    num = SC_MIN (count - offset, T8_DTRI_BATCH_LANES);
+    for (ilane = 0; ilane < num; ilane++) {
+      T8_ASSERT (ids[offset + ilane] <=
+                 ((t8_linearidx_t) 1) << (T8_DTRI_DIM * level));
+      lane_x[ilane] = lane_y[ilane] = 0;
+#ifdef T8_DTRI_TO_DTET
+      lane_z[ilane] = 0;
+#endif
+      /* This is the type of the root triangle */
+      lane_type[ilane] = 0;
+    }
+    for (i = 1; i <= level; i++) {
+      offset_coords = T8_DTRI_MAXLEVEL - i;
+      offset_index = level - i;
+      for (ilane = 0; ilane < num; ilane++) {
+        /* Get the local index of T's ancestor on level i */
+        local_index = (int) ((ids[offset + ilane]
+                              >> (T8_DTRI_DIM * offset_index)) & children_m1);
+        /* Get the type and cube-id of T's ancestor on level i */
+        cid = t8_dtri_parenttype_Iloc_to_cid[lane_type[ilane]][local_index];
+        lane_type[ilane] =
+          t8_dtri_parenttype_Iloc_to_type[lane_type[ilane]][local_index];
+        lane_x[ilane] |= (cid & 1) << offset_coords;
+        lane_y[ilane] |= ((cid >> 1) & 1) << offset_coords;
+#ifdef T8_DTRI_TO_DTET
+        lane_z[ilane] |= ((cid >> 2) & 1) << offset_coords;
+#endif
+      }
+    }
+    for (ilane = 0; ilane < num; ilane++) {
+      t[offset + ilane].level = level;
+      t[offset + ilane].type = lane_type[ilane];
+      t[offset + ilane].x = lane_x[ilane];
+      t[offset + ilane].y = lane_y[ilane];
+#ifdef T8_DTRI_TO_DTET
+      t[offset + ilane].z = lane_z[ilane];
+#else
+      t[offset + ilane].n = 0;
+#endif
+#ifdef T8_ENABLE_DEBUG
+      /* Validate against the scalar implementation */
+      t8_dtri_init_linear_id (&check, ids[offset + ilane], level);
+      T8_ASSERT (t8_dtri_is_equal (&check, t + offset + ilane));
+#endif
+    }
+  }
+}
+
+void
+t8_dtri_successor_batch (const t8_dtri_t * t, t8_dtri_t * s, int count,
+                         int level)
+{
+  t8_linearidx_t      ids[T8_DTRI_BATCH_LANES];
+  int                 offset, num, ilane;
+
+  T8_ASSERT (count >= 0);
+  T8_ASSERT (1 <= level && level <= T8_DTRI_MAXLEVEL);
+  for (offset = 0; offset < count; offset += num) {
+    num = SC_MIN (count - offset, T8_DTRI_BATCH_LANES);
+    /* The successor at level is the element with the next id at level */
+    t8_dtri_linear_id_batch (t + offset, num, level, ids);
+    for (ilane = 0; ilane < num; ilane++) {
+      T8_ASSERT (t[offset + ilane].level == level);
+      T8_ASSERT (ids[ilane] + 1 <
+                 ((t8_linearidx_t) 1) << (T8_DTRI_DIM * level));
+      ids[ilane]++;
+    }
+    t8_dtri_init_linear_id_batch (s + offset, num, ids, level);
+  }
+}
+
 void
 t8_dtri_first_descendant (const t8_dtri_t * t, t8_dtri_t * s, int level)
 {
@@ -1540,7 +1676,7 @@ t8_dtri_ancestor_id (const t8_dtri_t * t, int level)
 int
 t8_dtri_child_id (const t8_dtri_t * t)
 {
-  return t8_dtri_type_cid_to_Iloc[t->type][compute_cubeid (t, t->level)];
+  return t8_dtri_child_id_inline (t);
 }
 
 int
@@ -0,0 +1,200 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_dtri_bits_inline.h
+ * Header-inlined versions of the core triangle kernels.
+ * The lookup tables are defined static in this header, such that the
+ * compiler can fold them into the kernels when inlining them into the
+ * triangle scheme. The functions in t8_dtri_bits.h call these kernels.
+ */
+
+#ifndef T8_DTRI_BITS_INLINE_H
+#define T8_DTRI_BITS_INLINE_H
+
+#include "t8_dtri.h"
+#include "t8_dtri_connectivity.h"
+
+/* *INDENT-OFF* */
+/** The type of the parent for each (cube-id,type) combination. */
+static const int8_t t8_dtri_inline_cid_type_to_parenttype[4][2] =
+  T8_DTRI_CID_TYPE_TO_PARENTTYPE;
+
+/** The type of the child for each (type,Bey child number) combination. */
+static const int8_t t8_dtri_inline_type_of_child[2][4] =
+  T8_DTRI_TYPE_OF_CHILD;
+
+/** The Bey child number for each (type,Morton child number) combination. */
+static const int8_t t8_dtri_inline_index_to_bey_number[2][4] =
+  T8_DTRI_INDEX_TO_BEY_NUMBER;
+
+/** The vertex that determines the anchor node of each Bey child. */
+static const int8_t t8_dtri_inline_beyid_to_vertex[4] =
+  T8_DTRI_BEYID_TO_VERTEX;
+
+/** The local index for each (type,cube-id) combination. */
+static const int8_t t8_dtri_inline_type_cid_to_Iloc[2][4] =
+  T8_DTRI_TYPE_CID_TO_ILOC;
+/* *INDENT-ON* */
+
+/** Compute the cube-id of the ancestor of a triangle at a given level.
+ * \param [in] t      Input triangle.
+ * \param [in] level  A level in 0, ..., T8_DTRI_MAXLEVEL.
+ * \return            The cube-id, 0 if \a level is 0.
+ */
+static inline int
+t8_dtri_cube_id_inline (const t8_dtri_t * t, int level)
+{
+  const t8_dtri_coord_t h = T8_DTRI_LEN (level);
+
+  T8_ASSERT (0 <= level && level <= T8_DTRI_MAXLEVEL);
+  if (level == 0) {
+    return 0;
+  }
+  return ((t->x & h) ? 0x01 : 0) | ((t->y & h) ? 0x02 : 0);
+}
+
+/** Return the type of the parent of a triangle.
+ * \param [in] t  Input triangle, its level must be greater than 0.
+ */
+static inline int
+t8_dtri_parent_type_inline (const t8_dtri_t * t)
+{
+  T8_ASSERT (t->level > 0);
+  return t8_dtri_inline_cid_type_to_parenttype[t8_dtri_cube_id_inline
+                                               (t, t->level)][t->type];
+}
+
+/** Return the type of a child of a triangle.
+ * \param [in] t        Input triangle.
+ * \param [in] childid  The child id in Morton order.
+ */
+static inline int
+t8_dtri_child_type_inline (const t8_dtri_t * t, int childid)
+{
+  T8_ASSERT (0 <= childid && childid < T8_DTRI_CHILDREN);
+  return t8_dtri_inline_type_of_child[t->type]
+    [t8_dtri_inline_index_to_bey_number[t->type][childid]];
+}
+
+/** Compute the coordinates of a vertex of a triangle.
+ * \see t8_dtri_compute_coords */
+static inline void
+t8_dtri_compute_coords_inline (const t8_dtri_t * t, int vertex,
+                               t8_dtri_coord_t coordinates[T8_DTRI_DIM])
+{
+  const int           ei = t->type;
+  const t8_dtri_coord_t h = T8_DTRI_LEN (t->level);
+
+  T8_ASSERT (0 <= vertex && vertex < T8_DTRI_FACES);
+  coordinates[0] = t->x;
+  coordinates[1] = t->y;
+  if (vertex == 0) {
+    return;
+  }
+  coordinates[ei] += h;
+  if (vertex == 2) {
+    coordinates[1 - ei] += h;
+  }
+}
+
+/** Compute the parent of a triangle.
+ * \see t8_dtri_parent */
+static inline void
+t8_dtri_parent_inline (const t8_dtri_t * t, t8_dtri_t * parent)
+{
+  const t8_dtri_coord_t h = T8_DTRI_LEN (t->level);
+
+  T8_ASSERT (t->level > 0);
+  parent->type = t8_dtri_parent_type_inline (t);
+  parent->x = t->x & ~h;
+  parent->y = t->y & ~h;
+  parent->level = t->level - 1;
+}
+
+/** Compute a child of a triangle. It is possible that \a t == \a child.
+ * \see t8_dtri_child */
+static inline void
+t8_dtri_child_inline (const t8_dtri_t * t, int childid, t8_dtri_t * child)
+{
+  t8_dtri_coord_t     t_coordinates[T8_DTRI_DIM];
+  int                 Bey_cid;
+
+  T8_ASSERT (t->level < T8_DTRI_MAXLEVEL);
+  T8_ASSERT (0 <= childid && childid < T8_DTRI_CHILDREN);
+
+  Bey_cid = t8_dtri_inline_index_to_bey_number[t->type][childid];
+  /* i-th anchor coordinate of child is (X_(0,i)+X_(vertex,i))/2
+   * where X_(i,j) is the j-th coordinate of t's ith node.
+   * For Bey child 0 the vertex is 0 and the anchor node is t's. */
+  t8_dtri_compute_coords_inline (t, t8_dtri_inline_beyid_to_vertex[Bey_cid],
+                                 t_coordinates);
+  child->x = (t->x + t_coordinates[0]) >> 1;
+  child->y = (t->y + t_coordinates[1]) >> 1;
+  child->type = t8_dtri_inline_type_of_child[t->type][Bey_cid];
+  child->level = t->level + 1;
+}
+
+/** Compute the child id of a triangle in Morton order.
+ * \see t8_dtri_child_id */
+static inline int
+t8_dtri_child_id_inline (const t8_dtri_t * t)
+{
+  return t8_dtri_inline_type_cid_to_Iloc[t->type][t8_dtri_cube_id_inline
+                                                  (t, t->level)];
+}
+
+/** Compute a sibling of a triangle.
+ * \see t8_dtri_sibling */
+static inline void
+t8_dtri_sibling_inline (const t8_dtri_t * t, int sibid, t8_dtri_t * sibling)
+{
+  T8_ASSERT (0 <= sibid && sibid < T8_DTRI_CHILDREN);
+  T8_ASSERT (t->level > 0);
+  t8_dtri_parent_inline (t, sibling);
+  t8_dtri_child_inline (sibling, sibid, sibling);
+}
+
+/** Compute the face neighbour of a triangle.
+ * \see t8_dtri_face_neighbour */
+static inline int
+t8_dtri_face_neighbour_inline (const t8_dtri_t * t, int face, t8_dtri_t * n)
+{
+  const int           type_old = t->type;
+  t8_dtri_coord_t     coords[2];
+
+  T8_ASSERT (0 <= face && face < T8_DTRI_FACES);
+  coords[0] = t->x;
+  coords[1] = t->y;
+  if (face == 0) {
+    coords[type_old] += T8_DTRI_LEN (t->level);
+  }
+  else if (face == 2) {
+    coords[1 - type_old] -= T8_DTRI_LEN (t->level);
+  }
+  n->x = coords[0];
+  n->y = coords[1];
+  n->level = t->level;
+  n->type = 1 - type_old;
+  return 2 - face;
+}
+
+#endif /* T8_DTRI_BITS_INLINE_H */
@@ -22,19 +22,12 @@
 
 #include "t8_dtri_connectivity.h"
 
-const int           t8_dtri_cid_type_to_parenttype[4][2] = {
-  {0, 1},
-  {0, 0},
-  {1, 1},
-  {0, 1}
-};
+const int           t8_dtri_cid_type_to_parenttype[4][2] =
+  T8_DTRI_CID_TYPE_TO_PARENTTYPE;
 
 /* In dependence of a type x give the type of
  * the child with Bey number y */
-const int           t8_dtri_type_of_child[2][4] = {
-  {0, 0, 0, 1},
-  {1, 1, 1, 0}
-};
+const int           t8_dtri_type_of_child[2][4] = T8_DTRI_TYPE_OF_CHILD;
 
 /* in dependence of a type x give the type of
  * the child with Morton number y */
@@ -45,12 +38,10 @@ const int           t8_dtri_type_of_child_morton[2][4] = {
 
 /* Line b, row I gives the Bey child-id of
  * a Tet with Parent type b and local morton index I */
-const int           t8_dtri_index_to_bey_number[2][4] = {
-  {0, 1, 3, 2},
-  {0, 3, 1, 2}
-};
+const int           t8_dtri_index_to_bey_number[2][4] =
+  T8_DTRI_INDEX_TO_BEY_NUMBER;
 
-const int           t8_dtri_beyid_to_vertex[4] = { 0, 1, 2, 1 };
+const int           t8_dtri_beyid_to_vertex[4] = T8_DTRI_BEYID_TO_VERTEX;
 
 /* TODO: We us the next two tables after each other.
  *       We should replace this operation by a new table
@@ -72,10 +63,8 @@ const int           t8_dtri_parenttype_beyid_to_Iloc[2][4] = {
   {0, 2, 3, 1}
 };
 
-const int           t8_dtri_type_cid_to_Iloc[2][4] = {
-  {0, 1, 1, 3},
-  {0, 2, 2, 3}
-};
+const int           t8_dtri_type_cid_to_Iloc[2][4] =
+  T8_DTRI_TYPE_CID_TO_ILOC;
 
 const int           t8_dtri_parenttype_Iloc_to_type[2][4] = {
   {0, 0, 1, 0},
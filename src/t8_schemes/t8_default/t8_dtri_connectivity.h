@@ -33,6 +33,17 @@ T8_EXTERN_C_BEGIN ();
 /** The spatial dimension */
 #define T8_DTRI_DIM (2)
 
+/* The initializers of the tables that are needed by the element kernels.
+ * They are shared with the header-inlined kernels in t8_dtri_bits_inline.h,
+ * such that both use the same values. */
+/* *INDENT-OFF* */
+#define T8_DTRI_CID_TYPE_TO_PARENTTYPE {{0, 1}, {0, 0}, {1, 1}, {0, 1}}
+#define T8_DTRI_TYPE_OF_CHILD {{0, 0, 0, 1}, {1, 1, 1, 0}}
+#define T8_DTRI_INDEX_TO_BEY_NUMBER {{0, 1, 3, 2}, {0, 3, 1, 2}}
+#define T8_DTRI_BEYID_TO_VERTEX {0, 1, 2, 1}
+#define T8_DTRI_TYPE_CID_TO_ILOC {{0, 1, 1, 3}, {0, 2, 2, 3}}
+/* *INDENT-ON* */
+
 /** Store the type of parent for each (cube-id,type) combination. */
 extern const int    t8_dtri_cid_type_to_parenttype[4][2];
 
@@ -91,8 +91,13 @@ T8_EXTERN_C_BEGIN ();
 #define t8_dtri_linear_id t8_dtet_linear_id
 #define t8_dtri_linear_id_corner_desc t8_dtet_linear_id_corner_desc
 #define t8_dtri_init_linear_id t8_dtet_init_linear_id
+#define t8_dtri_linear_id_per_level t8_dtet_linear_id_per_level
+#define t8_dtri_init_linear_id_per_level t8_dtet_init_linear_id_per_level
 #define t8_dtri_init_root t8_dtet_init_root
 #define t8_dtri_successor t8_dtet_successor
+#define t8_dtri_linear_id_batch t8_dtet_linear_id_batch
+#define t8_dtri_init_linear_id_batch t8_dtet_init_linear_id_batch
+#define t8_dtri_successor_batch t8_dtet_successor_batch
 #define t8_dtri_first_descendant t8_dtet_first_descendant
 #define t8_dtri_last_descendant t8_dtet_last_descendant
 #define t8_dtri_corner_descendant t8_dtet_corner_descendant
@@ -103,6 +108,17 @@ T8_EXTERN_C_BEGIN ();
 #define t8_dtri_is_valid t8_dtet_is_valid
 #define t8_dtri_init t8_dtet_init
 
+/* functions in t8_dtri_bits_inline.h */
+#define t8_dtri_cube_id_inline t8_dtet_cube_id_inline
+#define t8_dtri_parent_type_inline t8_dtet_parent_type_inline
+#define t8_dtri_child_type_inline t8_dtet_child_type_inline
+#define t8_dtri_compute_coords_inline t8_dtet_compute_coords_inline
+#define t8_dtri_parent_inline t8_dtet_parent_inline
+#define t8_dtri_child_inline t8_dtet_child_inline
+#define t8_dtri_child_id_inline t8_dtet_child_id_inline
+#define t8_dtri_sibling_inline t8_dtet_sibling_inline
+#define t8_dtri_face_neighbour_inline t8_dtet_face_neighbour_inline
+
 T8_EXTERN_C_END ();
 
 #endif /* T8_DTET_TO_DTRI_H */
@@ -36,6 +36,75 @@ T8_EXTERN_C_BEGIN ();
 /** Return the default element implementation of t8code. */
 t8_scheme_cxx_t    *t8_scheme_new_default_cxx (void);
 
+/** Return the default element implementation of t8code with compact
+ * quadrilaterals and hexahedra.
+ * These store only the coordinates and the level of an element, which
+ * reduces the memory of a quadrilateral from 24 to 12 bytes and of a
+ * hexahedron from 24 to 16 bytes.
+ * The other element classes are the same as in \ref t8_scheme_new_default_cxx.
+ * Quadrilaterals of this scheme cannot be used as the faces of the
+ * hexahedra of \ref t8_scheme_new_default_cxx and vice versa.
+ */
+t8_scheme_cxx_t    *t8_scheme_new_compact_cxx (void);
+
+/** Return the default element implementation of t8code with quadrilaterals
+ * and hexahedra in Hilbert order instead of Morton order.
+ * Consecutive elements of a uniform refinement share a face, thus the
+ * partitions of a forest with this scheme are connected inside of each tree
+ * and have a smaller surface, which reduces the number of ghosts.
+ * The elements have the same storage as in \ref t8_scheme_new_default_cxx
+ * and the other element classes are the same, but the linear ids and the
+ * order of children of quadrilaterals and hexahedra differ.
+ */
+t8_scheme_cxx_t    *t8_scheme_new_hilbert_cxx (void);
+
+/** The type of a function that chooses the directions in which an element
+ * of the anisotropic schemes is refined, see \ref t8_scheme_new_aniso_cxx.
+ * It must only depend on its arguments and may be called concurrently.
+ * \param [in] dim       The dimension of the element, 2 or 3.
+ * \param [in] root_len  The length of the root element in integer coordinates.
+ * \param [in] coords    The integer coordinates of the element's anchor node.
+ * \param [in] levels    The refinement level of the element in each direction.
+ * \param [in] user_data The user data passed to \ref t8_scheme_new_aniso_cxx.
+ * \return               A bit mask of the directions to refine, bit i for
+ *                       direction i.  If none of the first \a dim bits is set,
+ *                       the element is refined in all directions.
+ */
+typedef int         (*t8_scheme_aniso_direction_t) (int dim, int root_len,
+                                                    const int coords[3],
+                                                    const int levels[3],
+                                                    void *user_data);
+
+/** Return the default element implementation of t8code with anisotropic
+ * quadrilaterals and hexahedra.
+ * An element is refined in the directions returned by \a direction for its
+ * position and levels, thus the children of an element and its position in
+ * the space-filling curve do not depend on the adapt callback.
+ * The linear id of an element concatenates the coordinate bits of its
+ * refinement steps, which is the Morton index for isotropic elements.
+ * Uniform forests are built isotropically, thus \a direction should refine
+ * all directions below the uniform level of the forest.
+ * Balancing a forest assumes isotropic elements.
+ * The other element classes are the same as in \ref t8_scheme_new_default_cxx.
+ * \param [in] direction The function choosing the refinement directions.
+ *                       If NULL, all elements are refined isotropically.
+ * \param [in] user_data Passed to \a direction.
+ */
+t8_scheme_cxx_t    *t8_scheme_new_aniso_cxx (t8_scheme_aniso_direction_t
+                                             direction, void *user_data);
+
+/** Return the refinement level of an element of the anisotropic schemes in a
+ * coordinate direction.
+ * \param [in] ts    The quadrilateral or hexahedral scheme of a scheme
+ *                   created by \ref t8_scheme_new_aniso_cxx.
+ * \param [in] elem  A valid element of \a ts.
+ * \param [in] dir   A coordinate direction, 0 <= \a dir < dim.
+ * \return           The level of \a elem in direction \a dir.
+ */
+int                 t8_scheme_aniso_element_level (t8_eclass_scheme_c *ts,
+                                                   const t8_element_t *elem,
+                                                   int dir);
+
 /** Check whether a given eclass_scheme is on of the default schemes.
  * \param [in] ts   A (pointer to a) scheme
  * \return          True (non-zero) if \a ts is one of the default schemes,
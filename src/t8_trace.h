@@ -0,0 +1,58 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/** \file t8_trace.h
+ * We define macros to annotate regions of t8code for external profilers.
+ * Each region starts with \ref T8_TRACE_BEGIN and ends with
+ * \ref T8_TRACE_END with the same name, which must be a string literal.
+ * Regions must be properly nested on each thread.
+ * The backend is selected at configure time with
+ * --with-trace=<nvtx|caliper|scorep>. Without a backend the macros
+ * compile to nothing.
+ */
+
+#ifndef T8_TRACE_H
+#define T8_TRACE_H
+
+#include <t8.h>
+
+#if defined(T8_TRACE_NVTX)
+#include <nvToolsExt.h>
+#define T8_TRACE_BEGIN(name) nvtxRangePushA (name)
+#define T8_TRACE_END(name) ((void) nvtxRangePop ())
+#elif defined(T8_TRACE_CALIPER)
+#include <caliper/cali.h>
+#define T8_TRACE_BEGIN(name) cali_begin_region (name)
+#define T8_TRACE_END(name) cali_end_region (name)
+#elif defined(T8_TRACE_SCOREP)
+#include <scorep/SCOREP_User.h>
+#define T8_TRACE_BEGIN(name) \
+  SCOREP_USER_REGION_BY_NAME_BEGIN (name, SCOREP_USER_REGION_TYPE_COMMON)
+#define T8_TRACE_END(name) SCOREP_USER_REGION_BY_NAME_END (name)
+#else
+/** Begin the region \a name. */
+#define T8_TRACE_BEGIN(name) ((void) 0)
+/** End the region \a name that was begun last. */
+#define T8_TRACE_END(name) ((void) 0)
+#endif
+
+#endif /* !T8_TRACE_H */
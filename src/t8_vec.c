@@ -114,3 +114,125 @@ t8_vec_cross (const double vec_x[3], const double vec_y[3], double cross[3])
       vec_x[(i + 2) % 3] * vec_y[(i + 1) % 3];
   }
 }
+
+/* The loops over arrays of vectors are marked as SIMD loops if we have
+ * OpenMP. They compute each vector with the same sequence of operations
+ * as the functions for a single vector, such that the results agree. */
+#ifdef T8_ENABLE_OPENMP
+#define T8_VEC_SIMD _Pragma ("omp simd")
+#else
+#define T8_VEC_SIMD
+#endif
+
+void
+t8_vec_soa_gather (const double *points, size_t stride, size_t n,
+                   t8_vec_soa_t * vec)
+{
+  size_t              i;
+
+  T8_ASSERT (stride >= 3);
+  for (i = 0; i < n; i++) {
+    vec->x[i] = points[i * stride];
+    vec->y[i] = points[i * stride + 1];
+    vec->z[i] = points[i * stride + 2];
+  }
+}
+
+void
+t8_vec_soa_scatter (const t8_vec_soa_t * vec, size_t n, size_t stride,
+                    double *points)
+{
+  size_t              i;
+
+  T8_ASSERT (stride >= 3);
+  for (i = 0; i < n; i++) {
+    points[i * stride] = vec->x[i];
+    points[i * stride + 1] = vec->y[i];
+    points[i * stride + 2] = vec->z[i];
+  }
+}
+
+void
+t8_vec_soa_norm (const t8_vec_soa_t * vec, size_t n, double *norm)
+{
+  const double       *x = vec->x, *y = vec->y, *z = vec->z;
+  size_t              i;
+
+  T8_VEC_SIMD
+  for (i = 0; i < n; i++) {
+    double              sum = 0;
+
+    sum += x[i] * x[i];
+    sum += y[i] * y[i];
+    sum += z[i] * z[i];
+    norm[i] = sqrt (sum);
+  }
+}
+
+void
+t8_vec_soa_ax (t8_vec_soa_t * vec_x, size_t n, double alpha)
+{
+  double             *x = vec_x->x, *y = vec_x->y, *z = vec_x->z;
+  size_t              i;
+
+  T8_VEC_SIMD
+  for (i = 0; i < n; i++) {
+    x[i] *= alpha;
+    y[i] *= alpha;
+    z[i] *= alpha;
+  }
+}
+
+/* y = y + alpha * x */
+void
+t8_vec_soa_axpy (const t8_vec_soa_t * vec_x, t8_vec_soa_t * vec_y, size_t n,
+                 double alpha)
+{
+  const double       *xx = vec_x->x, *xy = vec_x->y, *xz = vec_x->z;
+  double             *yx = vec_y->x, *yy = vec_y->y, *yz = vec_y->z;
+  size_t              i;
+
+  T8_VEC_SIMD
+  for (i = 0; i < n; i++) {
+    yx[i] += alpha * xx[i];
+    yy[i] += alpha * xy[i];
+    yz[i] += alpha * xz[i];
+  }
+}
+
+void
+t8_vec_soa_dot (const t8_vec_soa_t * vec_x, const t8_vec_soa_t * vec_y,
+                size_t n, double *dot)
+{
+  const double       *xx = vec_x->x, *xy = vec_x->y, *xz = vec_x->z;
+  const double       *yx = vec_y->x, *yy = vec_y->y, *yz = vec_y->z;
+  size_t              i;
+
+  T8_VEC_SIMD
+  for (i = 0; i < n; i++) {
+    double              sum = 0;
+
+    sum += xx[i] * yx[i];
+    sum += xy[i] * yy[i];
+    sum += xz[i] * yz[i];
+    dot[i] = sum;
+  }
+}
+
+void
+t8_vec_soa_cross (const t8_vec_soa_t * vec_x, const t8_vec_soa_t * vec_y,
+                  size_t n, t8_vec_soa_t * cross)
+{
+  const double       *xx = vec_x->x, *xy = vec_x->y, *xz = vec_x->z;
+  const double       *yx = vec_y->x, *yy = vec_y->y, *yz = vec_y->z;
+  double             *cx = cross->x, *cy = cross->y, *cz = cross->z;
+  size_t              i;
+
+  T8_ASSERT (cross != vec_x && cross != vec_y);
+  T8_VEC_SIMD
+  for (i = 0; i < n; i++) {
+    cx[i] = xy[i] * yz[i] - xz[i] * yy[i];
+    cy[i] = xz[i] * yx[i] - xx[i] * yz[i];
+    cz[i] = xx[i] * yy[i] - xy[i] * yx[i];
+  }
+}
@@ -22,6 +22,9 @@
 
 /** \file t8_vec.h
  * We define routines to handle 3-dimensional vectors.
+ * The t8_vec_soa_* functions apply the same operation to arrays of vectors
+ * that are stored as structures of arrays, such that the compiler can
+ * vectorize them.
  */
 
 #ifndef T8_VEC_H
@@ -31,6 +34,17 @@
 
 T8_EXTERN_C_BEGIN ();
 
+/** An array of 3D vectors stored as structure of arrays.
+ * The coordinates of the i-th vector are x[i], y[i] and z[i].
+ * The memory of the coordinates is owned by the user.
+ */
+typedef struct t8_vec_soa
+{
+  double             *x;        /**< The x coordinates of the vectors */
+  double             *y;        /**< The y coordinates of the vectors */
+  double             *z;        /**< The z coordinates of the vectors */
+} t8_vec_soa_t;
+
 /** Vector norm.
  * \param [in] vec  A 3D vector.
  * \return          The norm of \a vec.
@@ -96,6 +110,78 @@ double              t8_vec_dot (const double vec_x[3], const double vec_y[3]);
 void                t8_vec_cross (const double vec_x[3],
                                   const double vec_y[3], double cross[3]);
 
+/** Copy 3D vectors that are stored with a stride into a structure of arrays.
+ * \param [in]  points   The vectors. The i-th vector starts at
+ *                       \a points + i * \a stride.
+ * \param [in]  stride   The number of doubles between two vectors, at least 3.
+ * \param [in]  n        The number of vectors.
+ * \param [out] vec      On output the \a n vectors.
+ */
+void                t8_vec_soa_gather (const double *points, size_t stride,
+                                       size_t n, t8_vec_soa_t * vec);
+
+/** Copy 3D vectors from a structure of arrays into an array with a stride.
+ * \param [in]  vec      The vectors.
+ * \param [in]  n        The number of vectors.
+ * \param [in]  stride   The number of doubles between two vectors, at least 3.
+ * \param [out] points   On output the i-th vector is stored at
+ *                       \a points + i * \a stride.
+ */
+void                t8_vec_soa_scatter (const t8_vec_soa_t * vec, size_t n,
+                                        size_t stride, double *points);
+
+/** Vector norms of an array of vectors.
+ * \param [in]  vec      An array of \a n 3D vectors.
+ * \param [in]  n        The number of vectors.
+ * \param [out] norm     On output the \a n norms,
+ *                       see \ref t8_vec_norm.
+ */
+void                t8_vec_soa_norm (const t8_vec_soa_t * vec, size_t n,
+                                     double *norm);
+
+/** Compute X = alpha * X for an array of vectors.
+ * \param [in,out] vec_x  An array of \a n 3D vectors.
+ *                        On output each vector is multiplied by \a alpha.
+ * \param [in]     n      The number of vectors.
+ * \param [in]     alpha  A factor.
+ */
+void                t8_vec_soa_ax (t8_vec_soa_t * vec_x, size_t n,
+                                   double alpha);
+
+/** Y = Y + alpha * X for arrays of vectors.
+ * \param [in]     vec_x  An array of \a n 3D vectors.
+ * \param [in,out] vec_y  An array of \a n 3D vectors. On output each
+ *                        vector is set to \a vec_y + \a alpha * \a vec_x.
+ * \param [in]     n      The number of vectors.
+ * \param [in]     alpha  A factor.
+ */
+void                t8_vec_soa_axpy (const t8_vec_soa_t * vec_x,
+                                     t8_vec_soa_t * vec_y, size_t n,
+                                     double alpha);
+
+/** Dot products of arrays of vectors.
+ * \param [in]  vec_x    An array of \a n 3D vectors.
+ * \param [in]  vec_y    An array of \a n 3D vectors.
+ * \param [in]  n        The number of vectors.
+ * \param [out] dot      On output the \a n dot products,
+ *                       see \ref t8_vec_dot.
+ */
+void                t8_vec_soa_dot (const t8_vec_soa_t * vec_x,
+                                    const t8_vec_soa_t * vec_y, size_t n,
+                                    double *dot);
+
+/** Cross products of arrays of vectors.
+ * \param [in]  vec_x    An array of \a n 3D vectors.
+ * \param [in]  vec_y    An array of \a n 3D vectors.
+ * \param [in]  n        The number of vectors.
+ * \param [out] cross    On output the \a n cross products,
+ *                       see \ref t8_vec_cross.
+ *                       Must not be the same as \a vec_x or \a vec_y.
+ */
+void                t8_vec_soa_cross (const t8_vec_soa_t * vec_x,
+                                      const t8_vec_soa_t * vec_y, size_t n,
+                                      t8_vec_soa_t * cross);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_VEC_H! */
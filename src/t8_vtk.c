@@ -29,6 +29,17 @@ int
 t8_write_pvtu (const char *filename, int num_procs, int write_tree,
                int write_rank, int write_level, int write_id, int num_data,
                t8_vtk_data_field_t * data)
+{
+  return t8_write_pvtu_precision (filename, num_procs, write_tree,
+                                  write_rank, write_level, write_id,
+                                  num_data, data, T8_VTK_FLOAT_NAME);
+}
+
+int
+t8_write_pvtu_precision (const char *filename, int num_procs,
+                         int write_tree, int write_rank, int write_level,
+                         int write_id, int num_data,
+                         t8_vtk_data_field_t * data, const char *float_name)
 {
   char                pvtufilename[BUFSIZ], filename_cpy[BUFSIZ];
   FILE               *pvtufile;
@@ -67,7 +78,7 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree,
   fprintf (pvtufile, "    <PPoints>\n");
   fprintf (pvtufile, "      <PDataArray type=\"%s\" Name=\"Position\""
            " NumberOfComponents=\"3\" format=\"%s\"/>\n",
-           T8_VTK_FLOAT_NAME, T8_VTK_FORMAT_STRING);
+           float_name, T8_VTK_FORMAT_STRING);
   fprintf (pvtufile, "    </PPoints>\n");
 
   if (num_data > 0) {
@@ -148,7 +159,7 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree,
         fprintf (pvtufile,
                  "      "
                  "<PDataArray type=\"%s\" Name=\"%s\" format=\"%s\"/>\n",
-                 T8_VTK_FLOAT_NAME, description, T8_VTK_FORMAT_STRING);
+                 float_name, description, T8_VTK_FORMAT_STRING);
       }
 
       /* Write vector data fields */
@@ -170,7 +181,7 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree,
         fprintf (pvtufile,
                  "      "
                  "<PDataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"3\" "
-                 "format=\"%s\"/>\n", T8_VTK_FLOAT_NAME, description,
+                 "format=\"%s\"/>\n", float_name, description,
                  T8_VTK_FORMAT_STRING);
       }
       fprintf (pvtufile, "    </PPointData>\n");
@@ -256,7 +267,7 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree,
   for (idata = 0; idata < num_scalars; idata++) {
     fprintf (pvtufile, "      "
              "<PDataArray type=\"%s\" Name=\"%s\" format=\"%s\"/>\n",
-             T8_VTK_FLOAT_NAME, data[idata].description,
+             float_name, data[idata].description,
              T8_VTK_FORMAT_STRING);
   }
 
@@ -266,7 +277,7 @@ t8_write_pvtu (const char *filename, int num_procs, int write_tree,
     fprintf (pvtufile, "      "
              "<PDataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"3\" "
              "format=\"%s\"/>\n",
-             T8_VTK_FLOAT_NAME, data[idata].description,
+             float_name, data[idata].description,
              T8_VTK_FORMAT_STRING);
   }
   if (wrote_cell_data) {
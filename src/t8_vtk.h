@@ -56,6 +56,16 @@
 #define T8_VTK_FORMAT_STRING "binary"
 #endif
 
+/** The format in which the data arrays of a .vtu file are written. */
+typedef enum
+{
+  T8_VTK_FORMAT_ASCII,          /**< Human readable text */
+  T8_VTK_FORMAT_BINARY,         /**< Raw binary data in an appended data section */
+  T8_VTK_FORMAT_COMPRESSED      /**< Like T8_VTK_FORMAT_BINARY, but zlib compressed.
+                                     Falls back to T8_VTK_FORMAT_BINARY if
+                                     libsc was not configured with zlib. */
+} t8_vtk_format_t;
+
 /* TODO: Add support for integer data type. */
 typedef enum
 {
@@ -85,6 +95,17 @@ int                 t8_write_pvtu (const char *filename, int num_procs,
                                    int write_level, int write_id,
                                    int num_data, t8_vtk_data_field_t * data);
 
+/* Write the pvtu header file as \ref t8_write_pvtu, but with floating
+ * point data of type \a float_name ("Float32" or "Float64") instead
+ * of T8_VTK_FLOAT_NAME.
+ * Return 0 on success. */
+int                 t8_write_pvtu_precision (const char *filename,
+                                             int num_procs, int write_tree,
+                                             int write_rank, int write_level,
+                                             int write_id, int num_data,
+                                             t8_vtk_data_field_t * data,
+                                             const char *float_name);
+
 T8_EXTERN_C_END ();
 
 #endif /* !T8_VTK_H */
@@ -0,0 +1,231 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the anisotropic quadrilateral and hexahedral
+ * schemes of t8_scheme_new_aniso_cxx.
+ * We enumerate all elements of a level with the successor function and check
+ * that they are ordered, that they cover the root, that parents, children,
+ * families and descendant ranges are consistent and that the face neighbors
+ * are elements of the same level.
+ * We also refine and coarsen a forest and check the number of elements.
+ */
+
+/* Refine isotropically on the first level and then only in y direction. */
+static int
+test_aniso_direction_y (int dim, int root_len, const int coords[3],
+                        const int levels[3], void *user_data)
+{
+  return levels[0] == 0 ? 0 : 2;
+}
+
+/* Refine isotropically on the first level, then in y direction in the left
+ * half of the root and in x and z direction in the right half. */
+static int
+test_aniso_direction_mixed (int dim, int root_len, const int coords[3],
+                            const int levels[3], void *user_data)
+{
+  if (levels[0] == 0) {
+    return 0;
+  }
+  return coords[0] < root_len / 2 ? 2 : 5;
+}
+
+/* Return the volume of an element relative to a root of volume 2^(dim * 16) */
+static int64_t
+test_aniso_volume (t8_eclass_scheme_c * ts, const t8_element_t * elem,
+                   int dim)
+{
+  int                 idim;
+  int64_t             volume = 1;
+
+  for (idim = 0; idim < dim; idim++) {
+    volume <<= 16 - t8_scheme_aniso_element_level (ts, elem, idim);
+  }
+  return volume;
+}
+
+static void
+test_aniso_elements (t8_eclass_scheme_c * ts, int dim, int maxlevel)
+{
+  t8_element_t       *root, *parent, *child, *neigh, *last;
+  t8_element_t      **elems, **family;
+  t8_linearidx_t      first_id, last_id, id;
+  t8_gloidx_t         num_elements, ielem, jelem;
+  int64_t             volume;
+  int                 level, num_siblings, isib, iface, dual_face;
+  int                 found;
+
+  ts->t8_element_new (1, &root);
+  ts->t8_element_new (1, &parent);
+  ts->t8_element_new (1, &child);
+  ts->t8_element_new (1, &neigh);
+  ts->t8_element_new (1, &last);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  family = T8_ALLOC (t8_element_t *, 1 << dim);
+
+  for (level = 1; level <= maxlevel; level++) {
+    num_elements = ts->t8_element_count_leafs (root, level);
+    elems = T8_ALLOC (t8_element_t *, num_elements);
+    ts->t8_element_new (num_elements, elems);
+    ts->t8_element_first_descendant (root, elems[0], level);
+    for (ielem = 1; ielem < num_elements; ielem++) {
+      ts->t8_element_successor (elems[ielem - 1], elems[ielem], level);
+      SC_CHECK_ABORT (ts->t8_element_compare (elems[ielem - 1],
+                                              elems[ielem]) < 0,
+                      "Consecutive elements are not ordered");
+    }
+    ts->t8_element_last_descendant (root, last, level);
+    SC_CHECK_ABORT (!ts->t8_element_compare (last, elems[num_elements - 1]),
+                    "Wrong last descendant");
+    volume = 0;
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      volume += test_aniso_volume (ts, elems[ielem], dim);
+      ts->t8_element_parent (elems[ielem], parent);
+      ts->t8_element_child (parent, ts->t8_element_child_id (elems[ielem]),
+                            child);
+      SC_CHECK_ABORT (!ts->t8_element_compare (child, elems[ielem]),
+                      "Parent and child are not inverse");
+      num_siblings = ts->t8_element_num_siblings (elems[ielem]);
+      SC_CHECK_ABORT (num_siblings == ts->t8_element_num_children (parent),
+                      "Wrong number of siblings");
+      if (ts->t8_element_child_id (elems[ielem]) == 0) {
+        for (isib = 0; isib < num_siblings; isib++) {
+          family[isib] = elems[ielem + isib];
+        }
+        SC_CHECK_ABORT (ts->t8_element_is_family (family),
+                        "Siblings are not a family");
+      }
+      ts->t8_element_descendant_range (parent, level, &first_id, &last_id);
+      id = ts->t8_element_get_linear_id (elems[ielem], level);
+      SC_CHECK_ABORT (first_id <= id && id <= last_id,
+                      "Element is not in the descendant range");
+      for (iface = 0; iface < ts->t8_element_num_faces (elems[ielem]);
+           iface++) {
+        if (!ts->t8_element_face_neighbor_inside (elems[ielem], neigh, iface,
+                                                  &dual_face)) {
+          SC_CHECK_ABORT (ts->t8_element_is_root_boundary (elems[ielem],
+                                                           iface),
+                          "Face neighbor is not inside");
+          continue;
+        }
+        for (jelem = 0, found = 0; jelem < num_elements && !found; jelem++) {
+          found = !ts->t8_element_compare (neigh, elems[jelem]);
+        }
+        SC_CHECK_ABORT (found, "Face neighbor is not an element");
+      }
+    }
+    SC_CHECK_ABORT (volume == (int64_t) 1 << (dim * 16),
+                    "Elements do not cover the root");
+    ts->t8_element_destroy (num_elements, elems);
+    T8_FREE (elems);
+  }
+
+  T8_FREE (family);
+  ts->t8_element_destroy (1, &last);
+  ts->t8_element_destroy (1, &neigh);
+  ts->t8_element_destroy (1, &child);
+  ts->t8_element_destroy (1, &parent);
+  ts->t8_element_destroy (1, &root);
+}
+
+static int
+test_aniso_refine (t8_forest_t forest, t8_forest_t forest_from,
+                   t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                   t8_eclass_scheme_c * ts, int num_elements,
+                   t8_element_t * elements[])
+{
+  return ts->t8_element_level (elements[0]) < 4;
+}
+
+static int
+test_aniso_coarsen (t8_forest_t forest, t8_forest_t forest_from,
+                    t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                    t8_eclass_scheme_c * ts, int num_elements,
+                    t8_element_t * elements[])
+{
+  return num_elements > 1 && ts->t8_element_level (elements[0]) > 1 ? -1 : 0;
+}
+
+static void
+test_aniso_forests (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme;
+  t8_eclass_t         eclasses[2] = { T8_ECLASS_QUAD, T8_ECLASS_HEX };
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh;
+  t8_gloidx_t         num_uniform;
+  int                 iclass;
+
+  scheme = t8_scheme_new_aniso_cxx (test_aniso_direction_y, NULL);
+  for (iclass = 0; iclass < 2; iclass++) {
+    cmesh = t8_cmesh_new_hypercube (eclasses[iclass], comm, 0, 0, 0);
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (cmesh, scheme, 1, 0, comm);
+    num_uniform = t8_forest_get_global_num_elements (forest);
+    /* Each element of level 1 is split into 8 stripes in y direction */
+    forest = t8_forest_new_adapt (forest, test_aniso_refine, 1, 0, NULL);
+    SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest)
+                    == 8 * num_uniform, "Wrong number of refined elements");
+    forest = t8_forest_new_adapt (forest, test_aniso_coarsen, 1, 0, NULL);
+    SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest)
+                    == num_uniform, "Wrong number of coarsened elements");
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  t8_scheme_cxx_t    *scheme;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing anisotropic quad and hex schemes.\n");
+  scheme = t8_scheme_new_aniso_cxx (test_aniso_direction_y, NULL);
+  test_aniso_elements (scheme->eclass_schemes[T8_ECLASS_QUAD], 2, 6);
+  test_aniso_elements (scheme->eclass_schemes[T8_ECLASS_HEX], 3, 5);
+  t8_scheme_cxx_unref (&scheme);
+  scheme = t8_scheme_new_aniso_cxx (test_aniso_direction_mixed, NULL);
+  test_aniso_elements (scheme->eclass_schemes[T8_ECLASS_QUAD], 2, 6);
+  test_aniso_elements (scheme->eclass_schemes[T8_ECLASS_HEX], 3, 5);
+  t8_scheme_cxx_unref (&scheme);
+  test_aniso_forests (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing anisotropic quad and hex schemes.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_vec.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the bounding volume hierarchy of a forest.
+ * We build uniform forests with bounding volume hierarchy and compare the
+ * results of box queries with a test of all elements. The results of sphere
+ * and ray queries must contain all elements that contain a point of the
+ * sphere or ray. We then adapt these forests, such that the boxes of some
+ * elements are copied from the original hierarchy, and test again.
+ */
+
+/* Refine every third element */
+static int
+t8_test_bvh_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                   t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                   t8_eclass_scheme_c * ts, int num_elements,
+                   t8_element_t * elements[])
+{
+  return lelement_id % 3 == 0;
+}
+
+static int
+t8_test_bvh_compare (const void *a, const void *b)
+{
+  return t8_compare_locidx (a, b);
+}
+
+/* Return true if the local element with index lelement is in elements */
+static int
+t8_test_bvh_contains (sc_array_t * elements, t8_locidx_t lelement)
+{
+  return sc_array_bsearch (elements, &lelement, t8_test_bvh_compare) >= 0;
+}
+
+/* Check the queries of a forest against a test of all elements */
+static void
+t8_test_bvh_check (t8_forest_t forest)
+{
+  const double        box[6] = { 0.2, 0.1, 0.3, 0.6, 0.5, 0.7 };
+  const double        center[3] = { 0.5, 0.4, 0.5 };
+  const double        radius = 0.3;
+  const double        origin[3] = { 0, 0.1, 0.2 };
+  const double        direction[3] = { 1, 0.5, 0.25 };
+  double              bbox[6], point[3];
+  sc_array_t          box_elements, sphere_elements, ray_elements;
+  t8_locidx_t         itree, ielem, num_elements, lelement, ifound;
+  t8_element_t       *element;
+  double             *tree_vertices;
+  int                 overlaps, i, ipoint;
+  const int           num_points = 5;
+
+  SC_CHECK_ABORT (t8_forest_has_bvh (forest),
+                  "Forest has no bounding volume hierarchy");
+  sc_array_init (&box_elements, sizeof (t8_locidx_t));
+  sc_array_init (&sphere_elements, sizeof (t8_locidx_t));
+  sc_array_init (&ray_elements, sizeof (t8_locidx_t));
+  t8_forest_bvh_query_box (forest, box, &box_elements);
+  t8_forest_bvh_query_sphere (forest, center, radius, &sphere_elements);
+  t8_forest_bvh_query_ray (forest, origin, direction, 1, &ray_elements);
+
+  for (itree = 0, lelement = 0, ifound = 0;
+       itree < t8_forest_get_num_local_trees (forest); itree++) {
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      /* The box query must find exactly the elements with intersecting
+       * bounding box */
+      t8_forest_element_bounding_box (forest, itree, element, tree_vertices,
+                                      bbox);
+      for (i = 0, overlaps = 1; i < 3; i++) {
+        overlaps = overlaps && bbox[i] <= box[i + 3] && box[i] <= bbox[i + 3];
+      }
+      if (overlaps) {
+        SC_CHECK_ABORT (ifound < (t8_locidx_t) box_elements.elem_count
+                        && *(t8_locidx_t *) sc_array_index (&box_elements,
+                                                            ifound) ==
+                        lelement, "Box query missed an element");
+        ifound++;
+      }
+      /* The element containing the center must be found by the sphere
+       * query */
+      if (t8_forest_element_point_inside (forest, itree, element,
+                                          tree_vertices, center, 1e-10)) {
+        SC_CHECK_ABORT (t8_test_bvh_contains (&sphere_elements, lelement),
+                        "Sphere query missed an element");
+      }
+      /* The elements containing points of the ray must be found by the
+       * ray query */
+      for (ipoint = 0; ipoint < num_points; ipoint++) {
+        t8_vec_axpyz (direction, origin, point,
+                      ipoint / (double) (num_points - 1));
+        if (t8_forest_element_point_inside (forest, itree, element,
+                                            tree_vertices, point, 1e-10)) {
+          SC_CHECK_ABORT (t8_test_bvh_contains (&ray_elements, lelement),
+                          "Ray query missed an element");
+        }
+      }
+    }
+  }
+  SC_CHECK_ABORT (ifound == (t8_locidx_t) box_elements.elem_count,
+                  "Box query found too many elements");
+  sc_array_reset (&box_elements);
+  sc_array_reset (&sphere_elements);
+  sc_array_reset (&ray_elements);
+}
+
+static void
+t8_test_bvh (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      /* Build a uniform forest with bounding volume hierarchy */
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_bvh (forest, 1);
+      t8_forest_commit (forest);
+      t8_test_bvh_check (forest);
+
+      /* Adapt the forest, the boxes of the unchanged elements are reused */
+      t8_forest_init (&forest_adapt);
+      t8_forest_set_adapt (forest_adapt, forest, t8_test_bvh_adapt, 0);
+      t8_forest_set_bvh (forest_adapt, 1);
+      t8_forest_commit (forest_adapt);
+      t8_test_bvh_check (forest_adapt);
+      t8_forest_unref (&forest_adapt);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest bounding volume hierarchy.\n");
+  t8_test_bvh (sc_MPI_COMM_WORLD);
+  t8_global_productionf
+    ("Done testing the forest bounding volume hierarchy.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
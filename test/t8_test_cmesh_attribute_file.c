@@ -0,0 +1,149 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_partition.h>
+
+/* In this file we test attributes that are stored in an attribute file.
+ * We build a cmesh of two quads whose attributes are stored in a file,
+ * read them through t8_cmesh_get_attribute and read them again after
+ * the cmesh was partitioned. */
+
+#define T8_TEST_NUM_VALUES 5
+
+/* The value stored at position i of the attribute of a tree */
+static double
+test_attribute_value (t8_gloidx_t gtree_id, int i)
+{
+  return 10 * gtree_id + i + 0.5;
+}
+
+/* Check the attribute of each local tree of a cmesh */
+static void
+test_attribute_check (t8_cmesh_t cmesh, int package_id)
+{
+  t8_locidx_t         ltree;
+  t8_gloidx_t         gtree;
+  double             *values;
+  int                 i;
+
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh); ltree++) {
+    gtree = t8_cmesh_get_global_id (cmesh, ltree);
+    values = (double *) t8_cmesh_get_attribute (cmesh, package_id, 0, ltree);
+    SC_CHECK_ABORT (values != NULL, "Attribute was not read from file");
+    for (i = 0; i < T8_TEST_NUM_VALUES; i++) {
+      SC_CHECK_ABORT (values[i] == test_attribute_value (gtree, i),
+                      "Wrong attribute value read from file");
+    }
+    /* The attribute is read only once */
+    SC_CHECK_ABORT (values ==
+                    t8_cmesh_get_attribute (cmesh, package_id, 0, ltree),
+                    "Attribute was read twice");
+    SC_CHECK_ABORT (t8_cmesh_get_attribute (cmesh, package_id, 1, ltree)
+                    == NULL, "Found attribute that was not set");
+  }
+}
+
+static void
+test_cmesh_attribute_file (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh, cmesh_partition;
+  t8_cmesh_attribute_location_t location;
+  t8_shmem_array_t    offsets;
+  const char         *filename = "t8_test_cmesh_attribute_file.dat";
+  double              values[T8_TEST_NUM_VALUES];
+  const int           package_id = t8_get_package_id () + 1;
+  t8_gloidx_t         gtree;
+  FILE               *fp;
+  int                 mpirank, mpisize, mpiret, i;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Write the attributes of both trees one after the other */
+  if (mpirank == 0) {
+    fp = fopen (filename, "wb");
+    SC_CHECK_ABORT (fp != NULL, "Could not open attribute file");
+    for (gtree = 0; gtree < 2; gtree++) {
+      for (i = 0; i < T8_TEST_NUM_VALUES; i++) {
+        values[i] = test_attribute_value (gtree, i);
+      }
+      SC_CHECK_ABORT (fwrite (values, sizeof (values), 1, fp) == 1,
+                      "Could not write attribute file");
+    }
+    SC_CHECK_ABORT (fclose (fp) == 0, "Could not close attribute file");
+  }
+  mpiret = sc_MPI_Barrier (comm);
+  SC_CHECK_MPI (mpiret);
+
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, 2);
+  for (gtree = 0; gtree < 2; gtree++) {
+    t8_cmesh_set_tree_class (cmesh, gtree, T8_ECLASS_QUAD);
+    location.package_id = package_id;
+    location.key = 0;
+    location.offset = gtree * sizeof (values);
+    location.size = sizeof (values);
+    t8_cmesh_set_tree_attribute_file (cmesh, gtree, filename, 1, &location);
+  }
+  t8_cmesh_set_join (cmesh, 0, 1, 1, 0, 0);
+  t8_cmesh_commit (cmesh, comm);
+  test_attribute_check (cmesh, package_id);
+
+  /* Move all trees to the last process. The partitioned cmesh
+   * reads the attributes again. */
+  t8_cmesh_init (&cmesh_partition);
+  t8_cmesh_set_derive (cmesh_partition, cmesh);
+  offsets = t8_cmesh_offset_concentrate (mpisize - 1, comm, 2);
+  t8_cmesh_set_partition_offsets (cmesh_partition, offsets);
+  t8_cmesh_commit (cmesh_partition, comm);
+  test_attribute_check (cmesh_partition, package_id);
+  t8_cmesh_destroy (&cmesh_partition);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh attribute files.\n");
+  test_cmesh_attribute_file (comm);
+  t8_global_productionf ("Done testing cmesh attribute files.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,176 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_forest.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+
+/* We create the partitioned bricks on all processes and on each process
+ * alone, which gives the whole mesh, and check that the face connections
+ * of the local trees agree and that all face connections are symmetric.
+ * A brick of one cell must have the face connections of the hypercube. */
+
+/* Check that the face connections of all trees of a cmesh that has no
+ * ghosts point back to the tree. */
+static void
+test_cmesh_brick_symmetric (t8_cmesh_t cmesh)
+{
+  t8_locidx_t         ltree, lneigh;
+  t8_eclass_t         eclass;
+  int                 iface, dual_face, orientation;
+  int                 back_face, back_orientation;
+
+  SC_CHECK_ABORT (t8_cmesh_get_num_ghosts (cmesh) == 0,
+                  "Unexpected ghosts in a cmesh on one process");
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh); ltree++) {
+    eclass = t8_cmesh_get_tree_class (cmesh, ltree);
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      lneigh = t8_cmesh_get_face_neighbor (cmesh, ltree, iface, &dual_face,
+                                           &orientation);
+      if (lneigh < 0) {
+        continue;
+      }
+      SC_CHECK_ABORT (t8_cmesh_get_face_neighbor (cmesh, lneigh, dual_face,
+                                                  &back_face,
+                                                  &back_orientation) == ltree
+                      && back_face == iface
+                      && back_orientation == orientation,
+                      "Face connection is not symmetric");
+    }
+  }
+}
+
+/* Check that two cmeshes have the same face connections at the local
+ * trees of cmesh. cmesh_check is the same mesh on a single process
+ * or a replicated mesh. */
+static void
+test_cmesh_brick_compare (t8_cmesh_t cmesh, t8_cmesh_t cmesh_check)
+{
+  t8_locidx_t         ltree, lneigh, lcheck, lneigh_check;
+  t8_gloidx_t         gtree;
+  t8_eclass_t         eclass;
+  int                 iface, dual_face, orientation;
+  int                 dual_face_check, orientation_check;
+
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh) ==
+                  t8_cmesh_get_num_trees (cmesh_check),
+                  "Wrong number of trees");
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh); ltree++) {
+    gtree = t8_cmesh_get_global_id (cmesh, ltree);
+    lcheck = t8_cmesh_get_local_id (cmesh_check, gtree);
+    eclass = t8_cmesh_get_tree_class (cmesh, ltree);
+    SC_CHECK_ABORT (lcheck >= 0
+                    && t8_cmesh_get_tree_class (cmesh_check, lcheck)
+                    == eclass, "Wrong tree class");
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      lneigh = t8_cmesh_get_face_neighbor (cmesh, ltree, iface, &dual_face,
+                                           &orientation);
+      lneigh_check = t8_cmesh_get_face_neighbor (cmesh_check, lcheck, iface,
+                                                 &dual_face_check,
+                                                 &orientation_check);
+      SC_CHECK_ABORT ((lneigh < 0) == (lneigh_check < 0),
+                      "Face connection is missing");
+      if (lneigh >= 0) {
+        SC_CHECK_ABORT (t8_cmesh_get_global_id (cmesh, lneigh) ==
+                        t8_cmesh_get_global_id (cmesh_check, lneigh_check)
+                        && dual_face == dual_face_check
+                        && orientation == orientation_check,
+                        "Face connections differ");
+      }
+    }
+  }
+}
+
+/* Compare the partitioned cmesh with the one created on this process
+ * alone and build a forest with ghosts on it. */
+static void
+test_cmesh_brick (t8_cmesh_t cmesh, t8_cmesh_t cmesh_self, int dim,
+                  sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_gloidx_t         num_trees;
+
+  test_cmesh_brick_symmetric (cmesh_self);
+  test_cmesh_brick_compare (cmesh, cmesh_self);
+  t8_cmesh_destroy (&cmesh_self);
+
+  /* Each tree has 2^dim children */
+  num_trees = t8_cmesh_get_num_trees (cmesh);
+  forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), 1, 1,
+                                  comm);
+  SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest) ==
+                  num_trees << dim, "Wrong number of elements");
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, eclass;
+  sc_MPI_Comm         comm;
+  t8_cmesh_t          cmesh, cmesh_check;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing partitioned bricks.\n");
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_PYRAMID; eclass++) {
+    /* One cell has the face connections of the hypercube */
+    cmesh = t8_cmesh_new_hypercube_partitioned ((t8_eclass_t) eclass, 1,
+                                                sc_MPI_COMM_SELF);
+    cmesh_check = t8_cmesh_new_hypercube ((t8_eclass_t) eclass,
+                                          sc_MPI_COMM_SELF, 0, 0, 0);
+    test_cmesh_brick_compare (cmesh, cmesh_check);
+    t8_cmesh_destroy (&cmesh_check);
+    t8_cmesh_destroy (&cmesh);
+
+    test_cmesh_brick (t8_cmesh_new_brick_partitioned ((t8_eclass_t) eclass,
+                                                      4, 3, 2, comm),
+                      t8_cmesh_new_brick_partitioned ((t8_eclass_t) eclass,
+                                                      4, 3, 2,
+                                                      sc_MPI_COMM_SELF),
+                      t8_eclass_to_dimension[eclass], comm);
+    test_cmesh_brick (t8_cmesh_new_hypercube_partitioned ((t8_eclass_t)
+                                                          eclass, 3, comm),
+                      t8_cmesh_new_hypercube_partitioned ((t8_eclass_t)
+                                                          eclass, 3,
+                                                          sc_MPI_COMM_SELF),
+                      t8_eclass_to_dimension[eclass], comm);
+  }
+  test_cmesh_brick (t8_cmesh_new_hybrid_brick_partitioned (4, 3, 2, comm),
+                    t8_cmesh_new_hybrid_brick_partitioned (4, 3, 2,
+                                                           sc_MPI_COMM_SELF),
+                    3, comm);
+  t8_global_productionf ("Done testing partitioned bricks.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
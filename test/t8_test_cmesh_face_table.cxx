@@ -0,0 +1,129 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+
+/* We partition a cmesh twice, once with and once without face table,
+ * and check that the face connections of all local trees and ghosts
+ * are the same. */
+
+static              t8_cmesh_t
+test_cmesh_face_table_derive (t8_cmesh_t cmesh, int set_face_table,
+                              sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh_partition;
+
+  t8_cmesh_ref (cmesh);
+  t8_cmesh_init (&cmesh_partition);
+  t8_cmesh_set_derive (cmesh_partition, cmesh);
+  t8_cmesh_set_partition_uniform (cmesh_partition, 1,
+                                  t8_scheme_new_default_cxx ());
+  t8_cmesh_set_face_table (cmesh_partition, set_face_table);
+  t8_cmesh_commit (cmesh_partition, comm);
+  return cmesh_partition;
+}
+
+static void
+test_cmesh_face_table (t8_cmesh_t cmesh, sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh_table, cmesh_plain;
+  t8_locidx_t         ltree, num_local, lneigh, lneigh_plain;
+  t8_eclass_t         eclass;
+  int                 iface, dual_face, orientation;
+  int                 dual_face_plain, orientation_plain;
+
+  cmesh_table = test_cmesh_face_table_derive (cmesh, 1, comm);
+  cmesh_plain = test_cmesh_face_table_derive (cmesh, 0, comm);
+  SC_CHECK_ABORT (t8_cmesh_get_num_local_trees (cmesh_table) ==
+                  t8_cmesh_get_num_local_trees (cmesh_plain)
+                  && t8_cmesh_get_num_ghosts (cmesh_table) ==
+                  t8_cmesh_get_num_ghosts (cmesh_plain),
+                  "Number of local trees and ghosts does not match.");
+  num_local = t8_cmesh_get_num_local_trees (cmesh_table)
+    + t8_cmesh_get_num_ghosts (cmesh_table);
+  for (ltree = 0; ltree < num_local; ltree++) {
+    if (ltree < t8_cmesh_get_num_local_trees (cmesh_table)) {
+      eclass = t8_cmesh_get_tree_class (cmesh_table, ltree);
+    }
+    else {
+      eclass = t8_cmesh_get_ghost_class (cmesh_table, ltree -
+                                         t8_cmesh_get_num_local_trees
+                                         (cmesh_table));
+    }
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      SC_CHECK_ABORT (t8_cmesh_tree_face_is_boundary (cmesh_table, ltree,
+                                                      iface) ==
+                      t8_cmesh_tree_face_is_boundary (cmesh_plain, ltree,
+                                                      iface),
+                      "Boundary faces do not match.");
+      lneigh = t8_cmesh_get_face_neighbor (cmesh_table, ltree, iface,
+                                           &dual_face, &orientation);
+      lneigh_plain = t8_cmesh_get_face_neighbor (cmesh_plain, ltree, iface,
+                                                 &dual_face_plain,
+                                                 &orientation_plain);
+      SC_CHECK_ABORT (lneigh == lneigh_plain, "Face neighbors do not match.");
+      if (lneigh >= 0) {
+        SC_CHECK_ABORT (dual_face == dual_face_plain
+                        && orientation == orientation_plain,
+                        "Face connections do not match.");
+      }
+    }
+  }
+  t8_cmesh_destroy (&cmesh_table);
+  t8_cmesh_destroy (&cmesh_plain);
+  t8_cmesh_destroy (&cmesh);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, eclass, dim;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh face table.\n");
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+    test_cmesh_face_table (t8_cmesh_new_hypercube ((t8_eclass_t) eclass,
+                                                   comm, 0, 0, 0), comm);
+  }
+  for (dim = 1; dim <= 3; dim++) {
+    test_cmesh_face_table (t8_cmesh_new_periodic (comm, dim), comm);
+  }
+  test_cmesh_face_table (t8_cmesh_new_hypercube_hybrid (3, comm, 0, 0),
+                         comm);
+  t8_global_productionf ("Done testing cmesh face table.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_offset.h>
+
+/* In this file we test the owner searches in partition offset arrays.
+ * For each tree of some hand made partitions we compare the first, last
+ * and all owners of the tree with the ranks that have the tree in range.
+ * The partitions contain shared, unshared and empty ranks next to each
+ * other. */
+
+static void
+t8_test_cmesh_offset_owners (int mpisize, t8_gloidx_t * offset)
+{
+  t8_offset_lookup_t *lookup;
+  t8_gloidx_t         gtree, num_trees = offset[mpisize];
+  sc_array_t          owners;
+  int                 proc, first_owner, last_owner, some_owner;
+  size_t              num_owners;
+
+  T8_ASSERT (t8_offset_consistent (mpisize, offset, num_trees));
+  lookup = t8_offset_lookup_new (mpisize, offset);
+  sc_array_init (&owners, sizeof (int));
+  for (gtree = 0; gtree < num_trees; gtree++) {
+    /* Compute the owners by checking each rank */
+    first_owner = last_owner = -1;
+    num_owners = 0;
+    for (proc = 0; proc < mpisize; proc++) {
+      if (!t8_offset_empty (proc, offset)
+          && t8_offset_in_range (gtree, proc, offset)) {
+        if (first_owner < 0) {
+          first_owner = proc;
+        }
+        last_owner = proc;
+        num_owners++;
+      }
+    }
+    some_owner = -1;
+    SC_CHECK_ABORTF (t8_offset_first_owner_of_tree (mpisize, gtree, offset,
+                                                    &some_owner)
+                     == first_owner, "Wrong first owner of tree %lli",
+                     (long long) gtree);
+    SC_CHECK_ABORTF (t8_offset_last_owner_of_tree (mpisize, gtree, offset,
+                                                   &some_owner)
+                     == last_owner, "Wrong last owner of tree %lli",
+                     (long long) gtree);
+    some_owner = -1;
+    SC_CHECK_ABORTF (t8_offset_last_owner_of_tree (mpisize, gtree, offset,
+                                                   &some_owner)
+                     == last_owner, "Wrong last owner of tree %lli",
+                     (long long) gtree);
+    SC_CHECK_ABORTF (t8_offset_lookup_first_owner_of_tree (lookup, gtree)
+                     == first_owner
+                     && t8_offset_lookup_last_owner_of_tree (lookup, gtree)
+                     == last_owner, "Wrong lookup owners of tree %lli",
+                     (long long) gtree);
+    t8_offset_all_owners_of_tree (mpisize, gtree, offset, &owners);
+    SC_CHECK_ABORTF (owners.elem_count == num_owners
+                     && *(int *) sc_array_index (&owners, 0) == first_owner
+                     && *(int *) sc_array_index (&owners, num_owners - 1)
+                     == last_owner, "Wrong owners of tree %lli",
+                     (long long) gtree);
+    sc_array_truncate (&owners);
+  }
+  sc_array_reset (&owners);
+  t8_offset_lookup_destroy (&lookup);
+}
+
+static void
+t8_test_cmesh_offset (void)
+{
+  /* Each rank has one unshared tree */
+  t8_gloidx_t         offset_unshared[3] = { 0, 1, 2 };
+  /* An empty rank between two unshared ranks */
+  t8_gloidx_t         offset_empty[5] = { 0, 1, 1, 2, 3 };
+  /* Shared and unshared ranks next to an empty rank */
+  t8_gloidx_t         offset_mixed[7] = { 0, -1, 1, 1, 2, -3, 4 };
+  /* An empty rank between two owners of a shared tree */
+  t8_gloidx_t         offset_shared[5] = { 0, -2, 2, -2, 3 };
+
+  t8_test_cmesh_offset_owners (2, offset_unshared);
+  t8_test_cmesh_offset_owners (4, offset_empty);
+  t8_test_cmesh_offset_owners (6, offset_mixed);
+  t8_test_cmesh_offset_owners (4, offset_shared);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the owner searches in offset arrays.\n");
+  t8_test_cmesh_offset ();
+  t8_global_productionf ("Done testing the owner searches in offset "
+                         "arrays.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -52,6 +52,9 @@ test_cmesh_committed (t8_cmesh_t cmesh)
   SC_CHECK_ABORT (retval == 1, "Cmesh commit failed.");
   retval = t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees);
   SC_CHECK_ABORT (retval == 1, "Cmesh face consistency failed.");
+  /* The trees of a partitioned cmesh are merged into one part */
+  SC_CHECK_ABORT (t8_cmesh_trees_get_numproc (cmesh->trees) <= 1,
+                  "Cmesh trees are not compacted.");
 }
 
 /* For each process re-partition a partitioned cmesh to be concentrated on
@@ -0,0 +1,125 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <unistd.h>             /* Needed to check for file access */
+#include <t8.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh_tetgen.h>
+#include <t8_cmesh_triangle.h>
+#include "t8_cmesh/t8_cmesh_trees.h"
+
+/* In this file we test the parallel TETGEN and TRIANGLE readers.
+ * Both test meshes consist of two trees that share one face.
+ * We read them in parallel and check that the cmesh is partitioned,
+ * that the trees have positive volume and that they are connected. */
+
+static void
+t8_test_cmesh_read_tetgen_check (t8_cmesh_t cmesh, t8_eclass_t eclass)
+{
+  t8_locidx_t         ltree, lneigh;
+  t8_gloidx_t         gtree;
+  double             *vertices;
+  int                 iface, num_neighbors;
+
+  SC_CHECK_ABORT (cmesh != NULL, "Could not read cmesh in parallel.");
+  SC_CHECK_ABORT (t8_cmesh_is_partitioned (cmesh),
+                  "The cmesh read in parallel is not partitioned.");
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh) == 2,
+                  "Wrong number of trees in parallel read.");
+  SC_CHECK_ABORT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees),
+                  "Cmesh face consistency failed.");
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh); ltree++) {
+    gtree = t8_cmesh_get_global_id (cmesh, ltree);
+    SC_CHECK_ABORT (t8_cmesh_get_tree_class (cmesh, ltree) == eclass,
+                    "Wrong tree class in parallel read.");
+    vertices = t8_cmesh_get_tree_vertices (cmesh, ltree);
+    SC_CHECK_ABORT (vertices != NULL, "No tree vertices in parallel read.");
+    SC_CHECK_ABORT (!t8_cmesh_tree_vertices_negative_volume
+                    (eclass, vertices, t8_eclass_num_vertices[eclass]),
+                    "Negative tree volume in parallel read.");
+    /* Each tree has exactly one neighbor, the other tree */
+    num_neighbors = 0;
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      lneigh = t8_cmesh_get_face_neighbor (cmesh, ltree, iface, NULL, NULL);
+      if (lneigh >= 0) {
+        SC_CHECK_ABORT (t8_cmesh_get_global_id (cmesh, lneigh) == 1 - gtree,
+                        "Wrong face neighbor in parallel read.");
+        num_neighbors++;
+      }
+    }
+    SC_CHECK_ABORT (num_neighbors == 1,
+                    "Wrong number of face neighbors in parallel read.");
+  }
+}
+
+static void
+t8_test_cmesh_read_tetgen (const char *fileprefix, int dim)
+{
+  t8_cmesh_t          cmesh;
+  char                filename[BUFSIZ];
+
+  t8_global_productionf ("Checking parallel reading of %s...\n", fileprefix);
+  snprintf (filename, BUFSIZ, "%s.ele", fileprefix);
+  SC_CHECK_ABORTF (access (filename, R_OK) == 0, "Could not open file %s.\n",
+                   filename);
+  if (dim == 3) {
+    cmesh = t8_cmesh_from_tetgen_file ((char *) fileprefix, 1,
+                                       sc_MPI_COMM_WORLD, 0);
+  }
+  else {
+    cmesh = t8_cmesh_from_triangle_file ((char *) fileprefix, 1,
+                                         sc_MPI_COMM_WORLD, 0);
+  }
+  t8_test_cmesh_read_tetgen_check (cmesh, dim == 3 ? T8_ECLASS_TET
+                                   : T8_ECLASS_TRIANGLE);
+  t8_cmesh_destroy (&cmesh);
+
+  /* Reading a file that does not exist must fail on all processes */
+  cmesh = t8_cmesh_from_tetgen_file ((char *) "test/testfiles/no_file", 1,
+                                     sc_MPI_COMM_WORLD, 0);
+  SC_CHECK_ABORT (cmesh == NULL, "Expected fail of reading a missing file.");
+  t8_global_productionf ("Could successfully read in parallel.\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_test_cmesh_read_tetgen ("test/testfiles/test_tetgen_file", 3);
+  t8_test_cmesh_read_tetgen ("test/testfiles/test_triangle_file", 2);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,257 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element types in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <unistd.h>             /* Needed to check for file access */
+#include <t8.h>
+#include <t8_eclass.h>
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk.h>
+#include "t8_cmesh/t8_cmesh_trees.h"
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* In this file we test the parallel vtu reader.
+ * The test mesh consists of two hexahedra that share one face.
+ * We read it from an ascii file and from files with appended raw and
+ * compressed data that we write here. We check that the cmesh is
+ * partitioned, that the trees have positive volume and that they
+ * are connected. */
+
+/* The coordinates of the points and the connectivity of the hexahedra */
+static const double t8_test_vtu_points[36] = {
+  0, 0, 0, 1, 0, 0, 2, 0, 0, 0, 1, 0, 1, 1, 0, 2, 1, 0,
+  0, 0, 1, 1, 0, 1, 2, 0, 1, 0, 1, 1, 1, 1, 1, 2, 1, 1
+};
+
+static const int64_t t8_test_vtu_connectivity[16] = {
+  0, 1, 4, 3, 6, 7, 10, 9, 1, 2, 5, 4, 7, 8, 11, 10
+};
+
+static const int64_t t8_test_vtu_offsets[2] = { 8, 16 };
+
+static const uint8_t t8_test_vtu_types[2] = { 12, 12 };
+
+/* The uncompressed size of a block in the compressed test file.
+ * It is small, such that the arrays consist of several blocks. */
+#define T8_TEST_VTU_BLOCK_SIZE 64
+
+static void
+t8_test_cmesh_read_vtu_check (t8_cmesh_t cmesh)
+{
+  t8_locidx_t         ltree, lneigh;
+  t8_gloidx_t         gtree;
+  double             *vertices;
+  int                 iface, num_neighbors;
+
+  SC_CHECK_ABORT (cmesh != NULL, "Could not read cmesh in parallel.");
+  SC_CHECK_ABORT (t8_cmesh_is_partitioned (cmesh),
+                  "The cmesh read in parallel is not partitioned.");
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh) == 2,
+                  "Wrong number of trees in parallel read.");
+  SC_CHECK_ABORT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees),
+                  "Cmesh face consistency failed.");
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh); ltree++) {
+    gtree = t8_cmesh_get_global_id (cmesh, ltree);
+    SC_CHECK_ABORT (t8_cmesh_get_tree_class (cmesh, ltree) == T8_ECLASS_HEX,
+                    "Wrong tree class in parallel read.");
+    vertices = t8_cmesh_get_tree_vertices (cmesh, ltree);
+    SC_CHECK_ABORT (vertices != NULL, "No tree vertices in parallel read.");
+    SC_CHECK_ABORT (!t8_cmesh_tree_vertices_negative_volume
+                    (T8_ECLASS_HEX, vertices, 8),
+                    "Negative tree volume in parallel read.");
+    /* The first vertex of a tree is its corner with the smallest
+     * coordinates */
+    SC_CHECK_ABORT (vertices[0] == gtree && vertices[1] == 0
+                    && vertices[2] == 0, "Wrong tree vertices in parallel"
+                    " read.");
+    /* Each tree has exactly one neighbor, the other tree */
+    num_neighbors = 0;
+    for (iface = 0; iface < t8_eclass_num_faces[T8_ECLASS_HEX]; iface++) {
+      lneigh = t8_cmesh_get_face_neighbor (cmesh, ltree, iface, NULL, NULL);
+      if (lneigh >= 0) {
+        SC_CHECK_ABORT (t8_cmesh_get_global_id (cmesh, lneigh) == 1 - gtree,
+                        "Wrong face neighbor in parallel read.");
+        num_neighbors++;
+      }
+    }
+    SC_CHECK_ABORT (num_neighbors == 1,
+                    "Wrong number of face neighbors in parallel read.");
+  }
+}
+
+/* Add the bytes of an array to the appended data of a vtu file with
+ * UInt64 headers and return the offset of the array. */
+static long long
+t8_test_vtu_append (sc_array_t * appended, const void *values,
+                    size_t num_bytes, int compressed)
+{
+  const long long     offset = appended->elem_count;
+  uint64_t            header;
+
+  if (!compressed) {
+    header = num_bytes;
+    memcpy (sc_array_push_count (appended, sizeof (uint64_t)), &header,
+            sizeof (uint64_t));
+    memcpy (sc_array_push_count (appended, num_bytes), values, num_bytes);
+  }
+#ifdef SC_HAVE_ZLIB
+  else {
+    const size_t        num_blocks =
+      (num_bytes + T8_TEST_VTU_BLOCK_SIZE - 1) / T8_TEST_VTU_BLOCK_SIZE;
+    size_t              iblock, block_bytes, block_offset;
+    uLongf              compressed_bytes;
+    char               *dest;
+
+    sc_array_push_count (appended, (3 + num_blocks) * sizeof (uint64_t));
+    header = num_blocks;
+    memcpy (appended->array + offset, &header, sizeof (uint64_t));
+    header = T8_TEST_VTU_BLOCK_SIZE;
+    memcpy (appended->array + offset + 8, &header, sizeof (uint64_t));
+    header = num_bytes % T8_TEST_VTU_BLOCK_SIZE;
+    memcpy (appended->array + offset + 16, &header, sizeof (uint64_t));
+    for (iblock = 0; iblock < num_blocks; iblock++) {
+      block_bytes = SC_MIN (num_bytes - iblock * T8_TEST_VTU_BLOCK_SIZE,
+                            (size_t) T8_TEST_VTU_BLOCK_SIZE);
+      compressed_bytes = compressBound (block_bytes);
+      block_offset = appended->elem_count;
+      dest = (char *) sc_array_push_count (appended, compressed_bytes);
+      SC_CHECK_ABORT (compress2 ((Bytef *) dest, &compressed_bytes,
+                                 (const Bytef *) values
+                                 + iblock * T8_TEST_VTU_BLOCK_SIZE,
+                                 block_bytes, Z_BEST_SPEED) == Z_OK,
+                      "Could not compress test data.");
+      sc_array_resize (appended, block_offset + compressed_bytes);
+      header = compressed_bytes;
+      memcpy (appended->array + offset + (3 + iblock) * sizeof (uint64_t),
+              &header, sizeof (uint64_t));
+    }
+  }
+#endif
+  return offset;
+}
+
+/* Write the test mesh to a vtu file with appended data on process 0 */
+static void
+t8_test_vtu_write_appended (const char *filename, int compressed)
+{
+  FILE               *file;
+  sc_array_t          appended;
+  long long           offsets[4];
+  int                 mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    sc_array_init (&appended, sizeof (char));
+    offsets[0] = t8_test_vtu_append (&appended, t8_test_vtu_points,
+                                     sizeof (t8_test_vtu_points), compressed);
+    offsets[1] = t8_test_vtu_append (&appended, t8_test_vtu_connectivity,
+                                     sizeof (t8_test_vtu_connectivity),
+                                     compressed);
+    offsets[2] = t8_test_vtu_append (&appended, t8_test_vtu_offsets,
+                                     sizeof (t8_test_vtu_offsets),
+                                     compressed);
+    offsets[3] = t8_test_vtu_append (&appended, t8_test_vtu_types,
+                                     sizeof (t8_test_vtu_types), compressed);
+    file = fopen (filename, "wb");
+    SC_CHECK_ABORTF (file != NULL, "Could not open file %s.\n", filename);
+    fprintf (file, "<?xml version=\"1.0\"?>\n<VTKFile type=\"UnstructuredGrid\""
+             " version=\"1.0\" header_type=\"UInt64\"%s byte_order=\"%s\">\n",
+             compressed ? " compressor=\"vtkZLibDataCompressor\"" : "",
+#ifdef SC_IS_BIGENDIAN
+             "BigEndian"
+#else
+             "LittleEndian"
+#endif
+      );
+    fprintf (file, "  <UnstructuredGrid>\n"
+             "    <Piece NumberOfPoints=\"12\" NumberOfCells=\"2\">\n"
+             "      <Points>\n"
+             "        <DataArray type=\"Float64\" NumberOfComponents=\"3\""
+             " format=\"appended\" offset=\"%lld\"/>\n"
+             "      </Points>\n      <Cells>\n"
+             "        <DataArray type=\"Int64\" Name=\"connectivity\""
+             " format=\"appended\" offset=\"%lld\"/>\n"
+             "        <DataArray type=\"Int64\" Name=\"offsets\""
+             " format=\"appended\" offset=\"%lld\"/>\n"
+             "        <DataArray type=\"UInt8\" Name=\"types\""
+             " format=\"appended\" offset=\"%lld\"/>\n"
+             "      </Cells>\n    </Piece>\n  </UnstructuredGrid>\n"
+             "  <AppendedData encoding=\"raw\">\n   _", offsets[0],
+             offsets[1], offsets[2], offsets[3]);
+    fwrite (appended.array, 1, appended.elem_count, file);
+    fprintf (file, "\n  </AppendedData>\n</VTKFile>\n");
+    fclose (file);
+    sc_array_reset (&appended);
+  }
+  mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+}
+
+static void
+t8_test_cmesh_read_vtu (const char *filename)
+{
+  t8_cmesh_t          cmesh;
+
+  t8_global_productionf ("Checking parallel reading of %s...\n", filename);
+  SC_CHECK_ABORTF (access (filename, R_OK) == 0, "Could not open file %s.\n",
+                   filename);
+  cmesh = t8_cmesh_from_vtu_file (filename, sc_MPI_COMM_WORLD, 3);
+  t8_test_cmesh_read_vtu_check (cmesh);
+  t8_cmesh_destroy (&cmesh);
+  t8_global_productionf ("Could successfully read in parallel.\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  t8_cmesh_t          cmesh;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_test_cmesh_read_vtu ("test/testfiles/test_vtu_file.vtu");
+  t8_test_vtu_write_appended ("test_vtu_raw.vtu", 0);
+  t8_test_cmesh_read_vtu ("test_vtu_raw.vtu");
+#ifdef SC_HAVE_ZLIB
+  t8_test_vtu_write_appended ("test_vtu_compressed.vtu", 1);
+  t8_test_cmesh_read_vtu ("test_vtu_compressed.vtu");
+#endif
+
+  /* Reading a file that does not exist must fail on all processes */
+  cmesh = t8_cmesh_from_vtu_file ("test/testfiles/no_file.vtu",
+                                  sc_MPI_COMM_WORLD, 3);
+  SC_CHECK_ABORT (cmesh == NULL, "Expected fail of reading a missing file.");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
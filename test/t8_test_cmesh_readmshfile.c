@@ -28,10 +28,12 @@
 #include "t8_cmesh/t8_cmesh_trees.h"
 
 /* In this file we test the msh file (gmsh) reader of the cmesh.
- * Currently, we support version 2 ascii.
+ * Currently, we support version 2 ascii and version 4 binary.
  * We read a mesh file and check whether the constructed cmesh is correct.
- * We also try to read version 2 binary, version 4 ascii and version 4 binary
- * formats. All are not supported and we expect the reader to catch this.
+ * We also try to read version 2 binary and version 4 ascii formats.
+ * Both are not supported and we expect the reader to catch this.
+ * The parallel reader must produce the same trees and face connections
+ * as the serial reader.
  */
 
 /* Check whether the input cmesh matches a given coarse mesh.
@@ -163,6 +165,76 @@ t8_test_cmesh_readmshfile_version2_ascii ()
   t8_global_productionf ("Could successfully read.\n");
 }
 
+/* Read the version 2 ascii file in parallel and compare the partitioned
+ * cmesh with the replicated cmesh that is read serially. */
+static void
+t8_test_cmesh_readmshfile_parallel ()
+{
+  t8_cmesh_t          cmesh, cmesh_serial;
+  const char          fileprefix[BUFSIZ - 4] =
+    "test/testfiles/test_msh_file_vers2_ascii";
+  const char          binprefix[BUFSIZ - 4] =
+    "test/testfiles/test_msh_file_vers2_bin";
+  double             *vertices, *vertices_serial;
+  t8_gloidx_t         gtree_id;
+  t8_locidx_t         ltree_it, neighbor, neighbor_serial;
+  int                 face, dual_face, dual_face_serial;
+  int                 orientation, orientation_serial;
+
+  t8_global_productionf ("Checking parallel reading of msh file...\n");
+
+  cmesh = t8_cmesh_from_msh_file_parallel (fileprefix, sc_MPI_COMM_WORLD, 2);
+  SC_CHECK_ABORT (cmesh != NULL,
+                  "Could not read cmesh in parallel from ascii version 2.");
+  cmesh_serial =
+    t8_cmesh_from_msh_file (fileprefix, 0, sc_MPI_COMM_WORLD, 2, 0);
+  SC_CHECK_ABORT (cmesh_serial != NULL, "Could not read cmesh serially.");
+  SC_CHECK_ABORT (t8_cmesh_is_partitioned (cmesh),
+                  "The cmesh read in parallel is not partitioned.");
+  SC_CHECK_ABORT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees),
+                  "Cmesh face consistency failed.");
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh)
+                  == t8_cmesh_get_num_trees (cmesh_serial),
+                  "Wrong number of trees in parallel read.");
+
+  for (ltree_it = 0; ltree_it < t8_cmesh_get_num_local_trees (cmesh);
+       ltree_it++) {
+    gtree_id = t8_cmesh_get_global_id (cmesh, ltree_it);
+    SC_CHECK_ABORT (t8_cmesh_get_tree_class (cmesh, ltree_it)
+                    == t8_cmesh_get_tree_class (cmesh_serial,
+                                                (t8_locidx_t) gtree_id),
+                    "Wrong tree class in parallel read.");
+    vertices = t8_cmesh_get_tree_vertices (cmesh, ltree_it);
+    vertices_serial =
+      t8_cmesh_get_tree_vertices (cmesh_serial, (t8_locidx_t) gtree_id);
+    SC_CHECK_ABORT (!memcmp (vertices, vertices_serial, 9 * sizeof (double)),
+                    "Wrong tree vertices in parallel read.");
+    for (face = 0; face < 3; face++) {
+      neighbor = t8_cmesh_get_face_neighbor (cmesh, ltree_it, face,
+                                             &dual_face, &orientation);
+      neighbor_serial =
+        t8_cmesh_get_face_neighbor (cmesh_serial, (t8_locidx_t) gtree_id,
+                                    face, &dual_face_serial,
+                                    &orientation_serial);
+      SC_CHECK_ABORT ((neighbor < 0 && neighbor_serial < 0)
+                      || (neighbor >= 0 && neighbor_serial >= 0
+                          && t8_cmesh_get_global_id (cmesh, neighbor)
+                          == neighbor_serial
+                          && dual_face == dual_face_serial
+                          && orientation == orientation_serial),
+                      "Wrong face neighbor in parallel read.");
+    }
+  }
+  t8_cmesh_destroy (&cmesh);
+  t8_cmesh_destroy (&cmesh_serial);
+
+  /* Unsupported files must be caught as well */
+  cmesh = t8_cmesh_from_msh_file_parallel (binprefix, sc_MPI_COMM_WORLD, 2);
+  SC_CHECK_ABORT (cmesh == NULL,
+                  "Expected fail of parallel reading binary msh file v.2.");
+  t8_global_productionf ("Could successfully read in parallel.\n");
+}
+
 /* Read version 2 binary file. We expect this to fail. */
 static void
 t8_test_cmesh_readmshfile_version2_bin ()
@@ -220,7 +292,8 @@ t8_test_cmesh_readmshfile_version4_ascii ()
   t8_global_productionf ("Error handling successfull.\n");
 }
 
-/* Read version 4 bin file. We expect this to fail. */
+/* Read version 4 bin file. This should work and give the same cmesh
+ * as the version 2 ascii file. */
 static void
 t8_test_cmesh_readmshfile_version4_bin ()
 {
@@ -240,12 +313,15 @@ t8_test_cmesh_readmshfile_version4_bin ()
 
   /* Try to read cmesh */
   cmesh = t8_cmesh_from_msh_file (fileprefix, 1, sc_MPI_COMM_WORLD, 2, 0);
-  SC_CHECK_ABORT (cmesh == NULL,
-                  "Expected fail of reading binary msh file v4, but did not fail.");
+  SC_CHECK_ABORT (cmesh != NULL,
+                  "Could not read cmesh from binary version 4, but should be able to.");
   retval = t8_test_supported_msh_file (cmesh);
-  SC_CHECK_ABORT (retval == 0,
-                  "Unexpected return from t8_test_supported_msh_file.");
-  t8_global_productionf ("Error handling successfull.\n");
+  SC_CHECK_ABORT (retval == 1, "Cmesh incorrectly read from file.");
+
+  /* The cmesh was read sucessfully and we need to destroy it. */
+  t8_cmesh_destroy (&cmesh);
+
+  t8_global_productionf ("Could successfully read.\n");
 }
 
 int
@@ -268,13 +344,16 @@ main (int argc, char **argv)
   /* Testing supported msh-file version 2 (as example). */
   t8_test_cmesh_readmshfile_version2_ascii ();
 
+  /* Testing parallel reading of msh-file version 2. */
+  t8_test_cmesh_readmshfile_parallel ();
+
   /* Testing unsupported msh-file version 2 binary. */
   t8_test_cmesh_readmshfile_version2_bin ();
 
   /* Testing unsupported msh-file version 4 ascii. */
   t8_test_cmesh_readmshfile_version4_ascii ();
 
-  /* Testing unsupported msh-file version 4 binary. */
+  /* Testing supported msh-file version 4 binary. */
   t8_test_cmesh_readmshfile_version4_bin ();
 
   t8_debugf ("Test successfull\n");
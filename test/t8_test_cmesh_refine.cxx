@@ -0,0 +1,162 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include "t8_cmesh/t8_cmesh_trees.h"
+
+/* We refine a replicated and a partitioned version of the same cmesh
+ * and check that every local tree of the partitioned refined cmesh
+ * matches the tree with the same global id in the replicated one. */
+
+/* Check that a refined cmesh is committed properly and that its
+ * face connections are consistent. */
+static void
+test_cmesh_refine_committed (t8_cmesh_t cmesh)
+{
+  SC_CHECK_ABORT (t8_cmesh_is_committed (cmesh), "Cmesh commit failed.");
+  SC_CHECK_ABORT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees),
+                  "Cmesh face consistency failed.");
+}
+
+static              t8_cmesh_t
+test_cmesh_refine_derive (t8_cmesh_t cmesh, int level, sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh_refine;
+
+  t8_cmesh_init (&cmesh_refine);
+  t8_cmesh_set_derive (cmesh_refine, cmesh);
+  t8_cmesh_set_refine (cmesh_refine, level, t8_scheme_new_default_cxx ());
+  t8_cmesh_commit (cmesh_refine, comm);
+  test_cmesh_refine_committed (cmesh_refine);
+  return cmesh_refine;
+}
+
+static void
+test_cmesh_refine_compare (t8_cmesh_t cmesh_replicated,
+                           t8_cmesh_t cmesh_partitioned)
+{
+  t8_locidx_t         ltree, lneigh, lneigh_replicated;
+  t8_gloidx_t         gtree;
+  t8_eclass_t         eclass;
+  double             *vertices, *vertices_replicated;
+  int                 iface, ivertex, dual_face, orientation;
+  int                 dual_face_replicated, orientation_replicated;
+
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh_replicated) ==
+                  t8_cmesh_get_num_trees (cmesh_partitioned),
+                  "Number of refined trees does not match.");
+  for (ltree = 0; ltree < t8_cmesh_get_num_local_trees (cmesh_partitioned);
+       ltree++) {
+    gtree = t8_cmesh_get_global_id (cmesh_partitioned, ltree);
+    eclass = t8_cmesh_get_tree_class (cmesh_partitioned, ltree);
+    SC_CHECK_ABORT (eclass ==
+                    t8_cmesh_get_tree_class (cmesh_replicated, gtree),
+                    "Tree classes do not match.");
+    vertices = t8_cmesh_get_tree_vertices (cmesh_partitioned, ltree);
+    vertices_replicated = t8_cmesh_get_tree_vertices (cmesh_replicated,
+                                                      gtree);
+    for (ivertex = 0; ivertex < 3 * t8_eclass_num_vertices[eclass];
+         ivertex++) {
+      SC_CHECK_ABORT (vertices[ivertex] == vertices_replicated[ivertex],
+                      "Tree vertices do not match.");
+    }
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      lneigh = t8_cmesh_get_face_neighbor (cmesh_partitioned, ltree, iface,
+                                           &dual_face, &orientation);
+      lneigh_replicated =
+        t8_cmesh_get_face_neighbor (cmesh_replicated, gtree, iface,
+                                    &dual_face_replicated,
+                                    &orientation_replicated);
+      SC_CHECK_ABORT ((lneigh < 0) == (lneigh_replicated < 0),
+                      "Face neighbors do not match.");
+      if (lneigh >= 0) {
+        SC_CHECK_ABORT (t8_cmesh_get_global_id (cmesh_partitioned, lneigh)
+                        == lneigh_replicated
+                        && dual_face == dual_face_replicated
+                        && orientation == orientation_replicated,
+                        "Face connections do not match.");
+      }
+    }
+  }
+}
+
+static void
+test_cmesh_refine (t8_cmesh_t cmesh_replicated,
+                   t8_cmesh_t cmesh_partitioned, sc_MPI_Comm comm)
+{
+  t8_cmesh_t          refine_replicated, refine_partitioned;
+  t8_gloidx_t         num_trees;
+  int                 level;
+
+  num_trees = t8_cmesh_get_num_trees (cmesh_replicated);
+  for (level = 1; level <= 2; level++) {
+    t8_cmesh_ref (cmesh_replicated);
+    t8_cmesh_ref (cmesh_partitioned);
+    refine_replicated =
+      test_cmesh_refine_derive (cmesh_replicated, level, comm);
+    refine_partitioned =
+      test_cmesh_refine_derive (cmesh_partitioned, level, comm);
+    SC_CHECK_ABORT (t8_cmesh_get_num_trees (refine_replicated) > num_trees,
+                    "Refined cmesh has not more trees.");
+    test_cmesh_refine_compare (refine_replicated, refine_partitioned);
+    t8_cmesh_destroy (&refine_replicated);
+    t8_cmesh_destroy (&refine_partitioned);
+  }
+  t8_cmesh_destroy (&cmesh_replicated);
+  t8_cmesh_destroy (&cmesh_partitioned);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, eclass, dim;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh refine.\n");
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+    test_cmesh_refine (t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm,
+                                               0, 0, 0),
+                       t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm,
+                                               0, 1, 0), comm);
+  }
+  for (dim = 2; dim <= 3; dim++) {
+    test_cmesh_refine (t8_cmesh_new_hypercube_hybrid (dim, comm, 0, 0),
+                       t8_cmesh_new_hypercube_hybrid (dim, comm, 1, 0), comm);
+  }
+  t8_global_productionf ("Done testing cmesh refine.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
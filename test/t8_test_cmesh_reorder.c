@@ -0,0 +1,118 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk.h>
+
+/* In this file we test the reordering of the trees of a cmesh along
+ * a space-filling curve. We construct a row of quads whose tree ids are
+ * shuffled. After reordering, the trees must be sorted from left to right
+ * and their face neighbors must be updated accordingly. */
+
+#define T8_TEST_REORDER_NUM_TREES 7
+
+/* The position of each tree in the row */
+static const int    t8_test_position[T8_TEST_REORDER_NUM_TREES] =
+  { 3, 6, 0, 4, 1, 5, 2 };
+
+static              t8_cmesh_t
+t8_test_reorder_cmesh (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  double              vertices[12];
+  int                 itree, ivertex, tree_at[T8_TEST_REORDER_NUM_TREES];
+
+  t8_cmesh_init (&cmesh);
+  for (itree = 0; itree < T8_TEST_REORDER_NUM_TREES; itree++) {
+    t8_cmesh_set_tree_class (cmesh, itree, T8_ECLASS_QUAD);
+    for (ivertex = 0; ivertex < 4; ivertex++) {
+      vertices[3 * ivertex] = t8_test_position[itree] + (ivertex & 1);
+      vertices[3 * ivertex + 1] = ivertex >> 1;
+      vertices[3 * ivertex + 2] = 0;
+    }
+    t8_cmesh_set_tree_vertices (cmesh, itree, t8_get_package_id (), 0,
+                                vertices, 4);
+    tree_at[t8_test_position[itree]] = itree;
+  }
+  /* Connect the right face of each tree with the left face of its
+   * right neighbor */
+  for (itree = 0; itree < T8_TEST_REORDER_NUM_TREES - 1; itree++) {
+    t8_cmesh_set_join (cmesh, tree_at[itree], tree_at[itree + 1], 1, 0, 0);
+  }
+  t8_cmesh_set_reorder (cmesh, 1);
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
+static void
+test_cmesh_reorder (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  t8_locidx_t         itree, neighbor;
+  double             *vertices;
+  int                 dual_face;
+
+  cmesh = t8_test_reorder_cmesh (comm);
+  for (itree = 0; itree < T8_TEST_REORDER_NUM_TREES; itree++) {
+    vertices = t8_cmesh_get_tree_vertices (cmesh, itree);
+    SC_CHECK_ABORTF (vertices[0] == itree,
+                     "Tree %i is not at position %i after reordering.",
+                     itree, itree);
+    neighbor = t8_cmesh_get_face_neighbor (cmesh, itree, 1, &dual_face, NULL);
+    if (itree < T8_TEST_REORDER_NUM_TREES - 1) {
+      SC_CHECK_ABORTF (neighbor == itree + 1 && dual_face == 0,
+                       "Wrong right neighbor of tree %i after reordering.",
+                       itree);
+    }
+    else {
+      SC_CHECK_ABORTF (neighbor < 0,
+                       "Tree %i must not have a right neighbor.", itree);
+    }
+  }
+  t8_cmesh_destroy (&cmesh);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh reordering.\n");
+  test_cmesh_reorder (comm);
+  t8_global_productionf ("Done testing cmesh reordering.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
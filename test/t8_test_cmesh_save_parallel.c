@@ -0,0 +1,101 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+
+/* In this file we test saving and loading a cmesh with a single file.
+ * For each eclass we save a replicated and a partitioned hypercube and load
+ * them again replicated and partitioned. */
+
+static void
+test_cmesh_save_parallel (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh, cmesh_partition, cmesh_load;
+  const char         *filename = "t8_test_cmesh_save_parallel.t8c";
+  t8_gloidx_t         num_local_trees, num_trees;
+  int                 eclass, mpiret;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    SC_CHECK_ABORT (t8_cmesh_save_parallel (cmesh, filename, comm),
+                    "Could not save replicated cmesh");
+    cmesh_load = t8_cmesh_load_parallel (filename, 0, comm);
+    SC_CHECK_ABORT (cmesh_load != NULL && t8_cmesh_is_equal (cmesh,
+                                                             cmesh_load),
+                    "Loaded cmesh does not match the replicated cmesh");
+    t8_cmesh_destroy (&cmesh_load);
+
+    /* Save a partitioned cmesh, the ghosts must be written as global ids */
+    cmesh_partition =
+      t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 1, 0);
+    SC_CHECK_ABORT (t8_cmesh_save_parallel (cmesh_partition, filename, comm),
+                    "Could not save partitioned cmesh");
+    t8_cmesh_destroy (&cmesh_partition);
+    cmesh_load = t8_cmesh_load_parallel (filename, 0, comm);
+    SC_CHECK_ABORT (cmesh_load != NULL && t8_cmesh_is_equal (cmesh,
+                                                             cmesh_load),
+                    "Loaded cmesh does not match the partitioned cmesh");
+    t8_cmesh_destroy (&cmesh_load);
+
+    /* Load only a part of the trees on each process */
+    cmesh_load = t8_cmesh_load_parallel (filename, 1, comm);
+    SC_CHECK_ABORT (cmesh_load != NULL
+                    && t8_cmesh_is_partitioned (cmesh_load),
+                    "Could not load partitioned cmesh");
+    num_local_trees = t8_cmesh_get_num_local_trees (cmesh_load);
+    mpiret = sc_MPI_Allreduce (&num_local_trees, &num_trees, 1,
+                               T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (num_trees == t8_cmesh_get_num_trees (cmesh)
+                    && t8_cmesh_get_num_trees (cmesh_load) == num_trees,
+                    "Loaded partitioned cmesh has wrong number of trees");
+    t8_cmesh_destroy (&cmesh_load);
+    t8_cmesh_destroy (&cmesh);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing single file cmesh save and load.\n");
+  test_cmesh_save_parallel (comm);
+  t8_global_productionf ("Done testing single file cmesh save and load.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
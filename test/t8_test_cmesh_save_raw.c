@@ -0,0 +1,96 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh/t8_cmesh_partition.h>
+
+/* In this file we test saving and loading a replicated cmesh in raw format.
+ * For each eclass we save a hypercube, load it again and partition the
+ * loaded cmesh. We also check that a single cmesh file is rejected. */
+
+static void
+test_cmesh_save_raw (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh, cmesh_load, cmesh_partition;
+  t8_shmem_array_t    offsets;
+  const char         *filename = "t8_test_cmesh_save_raw.t8c";
+  int                 eclass;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    SC_CHECK_ABORT (t8_cmesh_save_raw (cmesh, filename, comm),
+                    "Could not save cmesh");
+    cmesh_load = t8_cmesh_load_raw (filename, comm);
+    SC_CHECK_ABORT (cmesh_load != NULL && t8_cmesh_is_equal (cmesh,
+                                                             cmesh_load),
+                    "Loaded cmesh does not match the saved cmesh");
+    SC_CHECK_ABORT (t8_cmesh_get_tree_vertices (cmesh_load, 0) != NULL,
+                    "Loaded cmesh has no vertices");
+
+    /* The loaded trees can be copied to a partitioned cmesh.
+     * The partitioned cmesh takes ownership of the loaded cmesh. */
+    t8_cmesh_init (&cmesh_partition);
+    t8_cmesh_set_derive (cmesh_partition, cmesh_load);
+    offsets = t8_cmesh_offset_concentrate (0, comm,
+                                           t8_cmesh_get_num_trees (cmesh));
+    t8_cmesh_set_partition_offsets (cmesh_partition, offsets);
+    t8_cmesh_commit (cmesh_partition, comm);
+    SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh_partition) ==
+                    t8_cmesh_get_num_trees (cmesh),
+                    "Partitioned cmesh has wrong number of trees");
+    t8_cmesh_destroy (&cmesh_partition);
+
+    /* A single cmesh file is not a raw cmesh file */
+    SC_CHECK_ABORT (t8_cmesh_save_parallel (cmesh, filename, comm),
+                    "Could not save single cmesh file");
+    SC_CHECK_ABORT (t8_cmesh_load_raw (filename, comm) == NULL,
+                    "Loaded a raw cmesh from a single cmesh file");
+    t8_cmesh_destroy (&cmesh);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing raw cmesh save and load.\n");
+  test_cmesh_save_raw (comm);
+  t8_global_productionf ("Done testing raw cmesh save and load.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_data/t8_shmem.h>
+
+/* In this file we test replicated cmeshes whose trees are stored in
+ * shared memory. For each eclass we copy a hypercube cmesh into a cmesh
+ * with shared memory and check that both are equal. */
+
+static void
+test_cmesh_shared_memory (sc_MPI_Comm comm, sc_MPI_Comm comm_nodes)
+{
+  t8_cmesh_t          cmesh, cmesh_shared;
+  int                 eclass;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; eclass++) {
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    t8_cmesh_ref (cmesh);
+    t8_cmesh_init (&cmesh_shared);
+    t8_cmesh_set_derive (cmesh_shared, cmesh);
+    t8_cmesh_set_shared_memory (cmesh_shared, 1);
+    t8_cmesh_commit (cmesh_shared, comm_nodes);
+    SC_CHECK_ABORTF (t8_cmesh_is_equal (cmesh, cmesh_shared),
+                     "Shared memory cmesh of class %s is not equal to the "
+                     "original.", t8_eclass_to_string[eclass]);
+    /* Both destroy calls are collective, since the trees of cmesh_shared
+     * are in shared memory. */
+    t8_cmesh_destroy (&cmesh_shared);
+    t8_cmesh_destroy (&cmesh);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm, comm_nodes;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  mpiret = sc_MPI_Comm_dup (comm, &comm_nodes);
+  SC_CHECK_MPI (mpiret);
+  t8_shmem_init (comm_nodes);
+  t8_shmem_set_type (comm_nodes, T8_SHMEM_BEST_TYPE);
+
+  t8_global_productionf ("Testing cmesh in shared memory.\n");
+  test_cmesh_shared_memory (comm, comm_nodes);
+  t8_global_productionf ("Done testing cmesh in shared memory.\n");
+
+  t8_shmem_finalize (comm_nodes);
+  mpiret = sc_MPI_Comm_free (&comm_nodes);
+  SC_CHECK_MPI (mpiret);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,306 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk.h>
+#include "t8_cmesh/t8_cmesh_types.h"
+#include "t8_cmesh/t8_cmesh_trees.h"
+#include <t8_eclass.h>
+#include "t8_cmesh/t8_cmesh_testcases.h"
+#include <p4est_connectivity.h>
+#include <p8est_connectivity.h>
+
+/* In this file we test the construction of a cmesh from tree arrays
+ * with t8_cmesh_set_tree_arrays. For each replicated test cmesh we
+ * extract its classes, face connections and vertices into arrays,
+ * construct a new cmesh from them and check that both are equal.
+ * We also construct cmeshes from p4est and p8est connectivities, which
+ * reads the connectivity arrays directly, and compare them to cmeshes
+ * that are built from the same connectivities via the stash. */
+
+/* Return true if we can rebuild the cmesh from arrays.
+ * This is the case if it is replicated and either all trees have
+ * exactly their vertices as attribute or no tree has an attribute. */
+static int
+t8_test_cmesh_tree_arrays_applies (t8_cmesh_t cmesh, int *has_vertices)
+{
+  t8_locidx_t         itree;
+  t8_ctree_t          tree;
+
+  if (t8_cmesh_is_partitioned (cmesh)) {
+    return 0;
+  }
+  *has_vertices = cmesh->num_local_trees > 0
+    && t8_cmesh_get_tree_vertices (cmesh, 0) != NULL;
+  for (itree = 0; itree < cmesh->num_local_trees; itree++) {
+    tree = t8_cmesh_trees_get_tree (cmesh->trees, itree);
+    if (tree->num_attributes != *has_vertices
+        || (*has_vertices && t8_cmesh_get_tree_vertices (cmesh, itree)
+            == NULL)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void
+test_cmesh_tree_arrays (int cmesh_id, sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh_original, cmesh;
+  t8_locidx_t         num_trees, itree, *face_neighbors, *face_neigh;
+  t8_eclass_t        *tree_classes, eclass;
+  int8_t             *tree_to_face, *ttf;
+  double             *vertices;
+  size_t              num_faces = 0, num_vertices = 0;
+  int                 iface, has_vertices;
+
+  cmesh_original = t8_test_create_cmesh (cmesh_id);
+  if (!t8_test_cmesh_tree_arrays_applies (cmesh_original, &has_vertices)) {
+    t8_cmesh_destroy (&cmesh_original);
+    return;
+  }
+  num_trees = t8_cmesh_get_num_local_trees (cmesh_original);
+  for (itree = 0; itree < num_trees; itree++) {
+    eclass = t8_cmesh_get_tree_class (cmesh_original, itree);
+    num_faces += t8_eclass_num_faces[eclass];
+    num_vertices += t8_eclass_num_vertices[eclass];
+  }
+  tree_classes = T8_ALLOC (t8_eclass_t, num_trees);
+  face_neighbors = T8_ALLOC (t8_locidx_t, num_faces);
+  tree_to_face = T8_ALLOC (int8_t, num_faces);
+  vertices = has_vertices ? T8_ALLOC (double, 3 * num_vertices) : NULL;
+  /* Extract the arrays in tree order */
+  num_faces = num_vertices = 0;
+  for (itree = 0; itree < num_trees; itree++) {
+    eclass = t8_cmesh_trees_get_tree_ext (cmesh_original->trees, itree,
+                                          &face_neigh, &ttf)->eclass;
+    tree_classes[itree] = eclass;
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      face_neighbors[num_faces + iface] = face_neigh[iface];
+      tree_to_face[num_faces + iface] = ttf[iface];
+    }
+    num_faces += t8_eclass_num_faces[eclass];
+    if (has_vertices) {
+      memcpy (vertices + 3 * num_vertices,
+              t8_cmesh_get_tree_vertices (cmesh_original, itree),
+              3 * t8_eclass_num_vertices[eclass] * sizeof (double));
+      num_vertices += t8_eclass_num_vertices[eclass];
+    }
+  }
+  /* Construct the new cmesh from the arrays */
+  t8_cmesh_init (&cmesh);
+  t8_cmesh_set_dimension (cmesh, cmesh_original->dimension);
+  t8_cmesh_set_tree_arrays (cmesh, num_trees, tree_classes, face_neighbors,
+                            tree_to_face, vertices);
+  t8_cmesh_commit (cmesh, comm);
+  SC_CHECK_ABORT (t8_cmesh_is_committed (cmesh), "Cmesh commit failed.");
+  SC_CHECK_ABORT (t8_cmesh_trees_is_face_consistend (cmesh, cmesh->trees),
+                  "Cmesh face consistency failed.");
+  SC_CHECK_ABORTF (t8_cmesh_is_equal (cmesh, cmesh_original),
+                   "Cmesh %i from tree arrays is not equal to the original.",
+                   cmesh_id);
+
+  T8_FREE (tree_classes);
+  T8_FREE (face_neighbors);
+  T8_FREE (tree_to_face);
+  T8_FREE (vertices);
+  t8_cmesh_destroy (&cmesh);
+  t8_cmesh_destroy (&cmesh_original);
+}
+
+/* Construct a cmesh from a p4est or p8est connectivity via the stash */
+static              t8_cmesh_t
+t8_test_cmesh_from_conn_stash (int dim, p4est_topidx_t num_trees,
+                               const p4est_topidx_t * tree_to_tree,
+                               const int8_t * tree_to_face,
+                               const p4est_topidx_t * tree_to_vertex,
+                               const double *conn_vertices,
+                               sc_MPI_Comm comm, int do_partition)
+{
+  t8_cmesh_t          cmesh;
+  const int           num_faces = 2 * dim;
+  const int           num_tvertices = 1 << dim;
+  double              vertices[24];
+  p4est_topidx_t      itree, ttt;
+  int                 iface, ivertex, mpirank, mpisize, mpiret;
+  int8_t              ttf;
+
+  t8_cmesh_init (&cmesh);
+  for (itree = 0; itree < num_trees; itree++) {
+    t8_cmesh_set_tree_class (cmesh, itree,
+                             dim == 2 ? T8_ECLASS_QUAD : T8_ECLASS_HEX);
+    for (ivertex = 0; ivertex < num_tvertices; ivertex++) {
+      memcpy (vertices + 3 * ivertex, conn_vertices +
+              3 * tree_to_vertex[num_tvertices * itree + ivertex],
+              3 * sizeof (double));
+    }
+    t8_cmesh_set_tree_vertices (cmesh, itree, t8_get_package_id (), 0,
+                                vertices, num_tvertices);
+    for (iface = 0; iface < num_faces; iface++) {
+      ttf = tree_to_face[num_faces * itree + iface];
+      ttt = tree_to_tree[num_faces * itree + iface];
+      if (itree < ttt || (itree == ttt && iface < ttf % num_faces)) {
+        t8_cmesh_set_join (cmesh, itree, ttt, iface, ttf % num_faces,
+                           ttf / num_faces);
+      }
+    }
+  }
+  if (do_partition) {
+    mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_size (comm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    t8_cmesh_set_partition_range (cmesh, 3, (mpirank * num_trees) / mpisize,
+                                  ((mpirank + 1) * num_trees) / mpisize - 1);
+  }
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
+/* Check that two cmeshes have the same local trees with the same
+ * vertices and face neighbors. The ghosts may be numbered differently. */
+static void
+t8_test_cmesh_compare_local_trees (t8_cmesh_t cmesh, t8_cmesh_t cmesh_stash)
+{
+  t8_locidx_t         itree, neigh, neigh_stash;
+  t8_eclass_t         eclass;
+  int                 iface, dual_face, dual_face_stash;
+  int                 orientation, orientation_stash;
+
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh)
+                  == t8_cmesh_get_num_trees (cmesh_stash)
+                  && t8_cmesh_get_first_treeid (cmesh)
+                  == t8_cmesh_get_first_treeid (cmesh_stash)
+                  && t8_cmesh_get_num_local_trees (cmesh)
+                  == t8_cmesh_get_num_local_trees (cmesh_stash)
+                  && t8_cmesh_get_num_ghosts (cmesh)
+                  == t8_cmesh_get_num_ghosts (cmesh_stash),
+                  "Cmesh from connectivity arrays has wrong tree counts.");
+  for (itree = 0; itree < t8_cmesh_get_num_local_trees (cmesh); itree++) {
+    eclass = t8_cmesh_get_tree_class (cmesh, itree);
+    SC_CHECK_ABORT (eclass == t8_cmesh_get_tree_class (cmesh_stash, itree),
+                    "Cmesh from connectivity arrays has wrong tree class.");
+    SC_CHECK_ABORT (!memcmp (t8_cmesh_get_tree_vertices (cmesh, itree),
+                             t8_cmesh_get_tree_vertices (cmesh_stash, itree),
+                             3 * t8_eclass_num_vertices[eclass]
+                             * sizeof (double)),
+                    "Cmesh from connectivity arrays has wrong vertices.");
+    for (iface = 0; iface < t8_eclass_num_faces[eclass]; iface++) {
+      dual_face = dual_face_stash = orientation = orientation_stash = -1;
+      neigh = t8_cmesh_get_face_neighbor (cmesh, itree, iface, &dual_face,
+                                          &orientation);
+      neigh_stash = t8_cmesh_get_face_neighbor (cmesh_stash, itree, iface,
+                                                &dual_face_stash,
+                                                &orientation_stash);
+      SC_CHECK_ABORTF ((neigh < 0) == (neigh_stash < 0)
+                       && (neigh < 0
+                           || t8_cmesh_get_global_id (cmesh, neigh)
+                           == t8_cmesh_get_global_id (cmesh_stash,
+                                                      neigh_stash))
+                       && dual_face == dual_face_stash
+                       && orientation == orientation_stash,
+                       "Cmesh from connectivity arrays has a wrong neighbor"
+                       " at face %i of tree %i.", iface, itree);
+    }
+  }
+}
+
+static void
+test_cmesh_from_p4est_arrays (sc_MPI_Comm comm)
+{
+  p4est_connectivity_t *conn4[3];
+  p8est_connectivity_t *conn8[3];
+  t8_cmesh_t          cmesh, cmesh_stash;
+  int                 iconn, do_partition;
+
+  conn4[0] = p4est_connectivity_new_moebius ();
+  conn4[1] = p4est_connectivity_new_brick (3, 4, 1, 0);
+  conn4[2] = p4est_connectivity_new_periodic ();
+  conn8[0] = p8est_connectivity_new_rotcubes ();
+  conn8[1] = p8est_connectivity_new_brick (2, 3, 4, 0, 1, 1);
+  conn8[2] = p8est_connectivity_new_twotrees (0, 1, 0);
+  for (iconn = 0; iconn < 3; iconn++) {
+    for (do_partition = 0; do_partition <= 1; do_partition++) {
+      cmesh = t8_cmesh_new_from_p4est (conn4[iconn], comm, do_partition);
+      cmesh_stash =
+        t8_test_cmesh_from_conn_stash (2, conn4[iconn]->num_trees,
+                                       conn4[iconn]->tree_to_tree,
+                                       conn4[iconn]->tree_to_face,
+                                       conn4[iconn]->tree_to_vertex,
+                                       conn4[iconn]->vertices, comm,
+                                       do_partition);
+      t8_test_cmesh_compare_local_trees (cmesh, cmesh_stash);
+      SC_CHECK_ABORT (do_partition
+                      || t8_cmesh_is_equal (cmesh, cmesh_stash),
+                      "Cmesh from p4est arrays is not equal to the original.");
+      t8_cmesh_destroy (&cmesh);
+      t8_cmesh_destroy (&cmesh_stash);
+
+      cmesh = t8_cmesh_new_from_p8est (conn8[iconn], comm, do_partition);
+      cmesh_stash =
+        t8_test_cmesh_from_conn_stash (3, conn8[iconn]->num_trees,
+                                       conn8[iconn]->tree_to_tree,
+                                       conn8[iconn]->tree_to_face,
+                                       conn8[iconn]->tree_to_vertex,
+                                       conn8[iconn]->vertices, comm,
+                                       do_partition);
+      t8_test_cmesh_compare_local_trees (cmesh, cmesh_stash);
+      SC_CHECK_ABORT (do_partition
+                      || t8_cmesh_is_equal (cmesh, cmesh_stash),
+                      "Cmesh from p8est arrays is not equal to the original.");
+      t8_cmesh_destroy (&cmesh);
+      t8_cmesh_destroy (&cmesh_stash);
+    }
+    p4est_connectivity_destroy (conn4[iconn]);
+    p8est_connectivity_destroy (conn8[iconn]);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh from tree arrays.\n");
+  for (int cmesh_id = 0; cmesh_id < t8_get_number_of_all_testcases ();
+       cmesh_id++) {
+    test_cmesh_tree_arrays (cmesh_id, comm);
+  }
+  test_cmesh_from_p4est_arrays (comm);
+
+  t8_global_productionf ("Done testing cmesh from tree arrays.\n");
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
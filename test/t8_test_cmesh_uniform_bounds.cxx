@@ -0,0 +1,155 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test t8_cmesh_uniform_bounds_for_rank.
+ * We compute the bounds of all ranks of different numbers of processes
+ * and check that they cover the elements of a uniform forest in order.
+ * We also check that t8_cmesh_uniform_bounds gives the bounds of the
+ * calling process and that the global number of elements of a uniform
+ * forest matches the sum of the local numbers.
+ */
+
+static void
+t8_test_uniform_bounds_cover (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                              int level, int num_ranks)
+{
+  t8_gloidx_t         first_tree, last_tree, child_begin, child_end;
+  t8_gloidx_t         children_per_tree, num_children, next_child;
+  t8_gloidx_t         first_child, end_child;
+  int8_t              first_tree_shared;
+  int                 rank;
+  t8_eclass_t         eclass;
+
+  /* The replicated hypercube consists of trees of one class */
+  eclass = t8_cmesh_get_tree_class (cmesh, 0);
+  children_per_tree =
+    scheme->eclass_schemes[eclass]->t8_element_count_leafs_from_root (level);
+  num_children = t8_cmesh_get_num_trees (cmesh) * children_per_tree;
+
+  next_child = 0;
+  for (rank = 0; rank < num_ranks; rank++) {
+    t8_cmesh_uniform_bounds_for_rank (cmesh, level, scheme, rank, num_ranks,
+                                      &first_tree, &child_begin, &last_tree,
+                                      &child_end, &first_tree_shared);
+    if (first_tree > last_tree) {
+      /* This rank is empty */
+      SC_CHECK_ABORT (!first_tree_shared,
+                      "An empty rank shares its first tree.");
+      continue;
+    }
+    first_child = first_tree * children_per_tree + child_begin;
+    end_child = last_tree * children_per_tree + child_end;
+    SC_CHECK_ABORT (first_child == next_child,
+                    "The bounds are not contiguous.");
+    SC_CHECK_ABORT (first_child < end_child, "Nonempty rank without elements.");
+    SC_CHECK_ABORT (first_tree_shared == (rank > 0 && child_begin > 0),
+                    "Wrong first tree shared flag.");
+    next_child = end_child;
+  }
+  SC_CHECK_ABORT (next_child == num_children,
+                  "The bounds do not cover all elements.");
+}
+
+static void
+t8_test_uniform_bounds (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  t8_gloidx_t         first_tree, last_tree, child_begin, child_end;
+  t8_gloidx_t         first_tree_r, last_tree_r, child_begin_r, child_end_r;
+  t8_gloidx_t         local_num_elements, global_num_elements;
+  int8_t              shared, shared_r;
+  int                 eclass, level, num_ranks, mpirank, mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    for (level = 0; level <= 3; level++) {
+      for (num_ranks = 1; num_ranks <= 17; num_ranks++) {
+        t8_test_uniform_bounds_cover (cmesh, scheme, level, num_ranks);
+      }
+      /* The bounds of this process */
+      t8_cmesh_uniform_bounds (cmesh, level, scheme, &first_tree,
+                               &child_begin, &last_tree, &child_end,
+                               &shared);
+      t8_cmesh_uniform_bounds_for_rank (cmesh, level, scheme, mpirank,
+                                        mpisize, &first_tree_r,
+                                        &child_begin_r, &last_tree_r,
+                                        &child_end_r, &shared_r);
+      SC_CHECK_ABORT (first_tree == first_tree_r && last_tree == last_tree_r
+                      && child_begin == child_begin_r
+                      && child_end == child_end_r && shared == shared_r,
+                      "The bounds of this process differ.");
+
+      /* The global number of elements is computed without communication */
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (cmesh, scheme, level, 0, comm);
+      local_num_elements = t8_forest_get_local_num_elements (forest);
+      mpiret = sc_MPI_Allreduce (&local_num_elements, &global_num_elements,
+                                 1, T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+      SC_CHECK_MPI (mpiret);
+      SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest)
+                      == global_num_elements,
+                      "Wrong global number of elements.");
+      t8_forest_unref (&forest);
+    }
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the uniform partition bounds.\n");
+  t8_test_uniform_bounds (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the uniform partition bounds.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8_cmesh.h>
+#include <t8_cmesh_vtk.h>
+
+/* In this file we test the vertex table of a cmesh.
+ * We construct a cmesh of two hexahedra sharing a face once with
+ * t8_cmesh_set_tree_vertices and once with a vertex table and
+ * t8_cmesh_set_tree_vertex_indices, and check that both are equal. */
+
+/* The 12 vertices of two unit cubes next to each other */
+static const double t8_test_vertices[36] = {
+  0, 0, 0, 1, 0, 0, 2, 0, 0,
+  0, 1, 0, 1, 1, 0, 2, 1, 0,
+  0, 0, 1, 1, 0, 1, 2, 0, 1,
+  0, 1, 1, 1, 1, 1, 2, 1, 1
+};
+
+/* The vertex indices of the two cubes */
+static const t8_gloidx_t t8_test_indices[2][8] = {
+  {0, 1, 3, 4, 6, 7, 9, 10},
+  {1, 2, 4, 5, 7, 8, 10, 11}
+};
+
+/* Create the cmesh with or without a vertex table */
+static              t8_cmesh_t
+t8_test_vertex_table_cmesh (int use_table, int single_precision,
+                            sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh;
+  double              vertices[24];
+  int                 itree, ivertex, icoord;
+
+  t8_cmesh_init (&cmesh);
+  if (use_table) {
+    t8_cmesh_set_vertex_table (cmesh, 12, t8_test_vertices,
+                               single_precision);
+  }
+  for (itree = 0; itree < 2; itree++) {
+    t8_cmesh_set_tree_class (cmesh, itree, T8_ECLASS_HEX);
+    if (use_table) {
+      t8_cmesh_set_tree_vertex_indices (cmesh, itree, t8_test_indices[itree],
+                                        8);
+    }
+    else {
+      for (ivertex = 0; ivertex < 8; ivertex++) {
+        for (icoord = 0; icoord < 3; icoord++) {
+          vertices[3 * ivertex + icoord] =
+            t8_test_vertices[3 * t8_test_indices[itree][ivertex] + icoord];
+        }
+      }
+      t8_cmesh_set_tree_vertices (cmesh, itree, t8_get_package_id (), 0,
+                                  vertices, 8);
+    }
+  }
+  t8_cmesh_set_join (cmesh, 0, 1, 1, 0, 0);
+  t8_cmesh_commit (cmesh, comm);
+  return cmesh;
+}
+
+static void
+test_cmesh_vertex_table (sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh, cmesh_table;
+  int                 single_precision;
+
+  cmesh = t8_test_vertex_table_cmesh (0, 0, comm);
+  for (single_precision = 0; single_precision <= 1; single_precision++) {
+    cmesh_table = t8_test_vertex_table_cmesh (1, single_precision, comm);
+    /* The coordinates are exactly representable as float */
+    SC_CHECK_ABORTF (t8_cmesh_is_equal (cmesh, cmesh_table),
+                     "Cmesh with vertex table (single precision %i) is not "
+                     "equal to the original.", single_precision);
+    t8_cmesh_destroy (&cmesh_table);
+  }
+  t8_cmesh_destroy (&cmesh);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing cmesh vertex table.\n");
+  test_cmesh_vertex_table (comm);
+  t8_global_productionf ("Done testing cmesh vertex table.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
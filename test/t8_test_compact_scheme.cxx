@@ -0,0 +1,205 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_cquad_cxx.hxx>
+#include <t8_schemes/t8_default/t8_default_chex_cxx.hxx>
+#include <t8_forest.h>
+#include <p4est_bits.h>
+#include <p8est_bits.h>
+
+/*
+ * In this file we test that the compact quadrilateral and hexahedral
+ * schemes of t8_scheme_new_compact_cxx produce the same forests as the
+ * default schemes.  We compare the elements of uniform forests, their
+ * face neighbors and boundary faces and the ghost layers.
+ * We also check that the conversions from and to p4est are inverse.
+ */
+
+/* Compare the elements of two forests, a default and a compact one. */
+static void
+test_compact_compare_forests (t8_forest_t forest_default,
+                              t8_forest_t forest_compact, int level)
+{
+  t8_eclass_scheme_c *ts_d, *ts_c, *fs_d = NULL, *fs_c = NULL;
+  t8_element_t       *elem_d, *elem_c, *neigh_d, *neigh_c;
+  t8_element_t       *face_d = NULL, *face_c = NULL;
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_t         eclass;
+  int                 iface, num_faces, nface_d, nface_c;
+  int                 inside_d, inside_c;
+
+  SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_default) ==
+                  t8_forest_get_local_num_elements (forest_compact),
+                  "Compact forest has different number of elements");
+  SC_CHECK_ABORT (t8_forest_get_num_ghosts (forest_default) ==
+                  t8_forest_get_num_ghosts (forest_compact),
+                  "Compact forest has different number of ghosts");
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest_default);
+       itree++) {
+    eclass = t8_forest_get_tree_class (forest_default, itree);
+    ts_d = t8_forest_get_eclass_scheme (forest_default, eclass);
+    ts_c = t8_forest_get_eclass_scheme (forest_compact, eclass);
+    SC_CHECK_ABORT (ts_c->t8_element_size () < ts_d->t8_element_size (),
+                    "Compact elements are not smaller");
+    ts_d->t8_element_new (1, &neigh_d);
+    ts_c->t8_element_new (1, &neigh_c);
+    if (eclass == T8_ECLASS_HEX) {
+      fs_d = t8_forest_get_eclass_scheme (forest_default, T8_ECLASS_QUAD);
+      fs_c = t8_forest_get_eclass_scheme (forest_compact, T8_ECLASS_QUAD);
+      fs_d->t8_element_new (1, &face_d);
+      fs_c->t8_element_new (1, &face_c);
+    }
+    num_elements = t8_forest_get_tree_num_elements (forest_default, itree);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      elem_d = t8_forest_get_element_in_tree (forest_default, itree, ielem);
+      elem_c = t8_forest_get_element_in_tree (forest_compact, itree, ielem);
+      SC_CHECK_ABORT (ts_d->t8_element_get_linear_id (elem_d, level) ==
+                      ts_c->t8_element_get_linear_id (elem_c, level),
+                      "Compact element differs");
+      SC_CHECK_ABORT (ts_d->t8_element_child_id (elem_d) ==
+                      ts_c->t8_element_child_id (elem_c),
+                      "Compact child id differs");
+      num_faces = ts_c->t8_element_num_faces (elem_c);
+      for (iface = 0; iface < num_faces; iface++) {
+        inside_d = ts_d->t8_element_face_neighbor_inside (elem_d, neigh_d,
+                                                          iface, &nface_d);
+        inside_c = ts_c->t8_element_face_neighbor_inside (elem_c, neigh_c,
+                                                          iface, &nface_c);
+        SC_CHECK_ABORT (inside_d == inside_c && nface_d == nface_c,
+                        "Compact face neighbor differs");
+        if (inside_c) {
+          SC_CHECK_ABORT (ts_d->t8_element_get_linear_id (neigh_d, level)
+                          == ts_c->t8_element_get_linear_id (neigh_c, level),
+                          "Compact face neighbor differs");
+        }
+        if (eclass == T8_ECLASS_HEX) {
+          ts_d->t8_element_boundary_face (elem_d, iface, face_d, fs_d);
+          ts_c->t8_element_boundary_face (elem_c, iface, face_c, fs_c);
+          SC_CHECK_ABORT (fs_d->t8_element_get_linear_id (face_d, level) ==
+                          fs_c->t8_element_get_linear_id (face_c, level),
+                          "Compact boundary face differs");
+        }
+      }
+    }
+    ts_d->t8_element_destroy (1, &neigh_d);
+    ts_c->t8_element_destroy (1, &neigh_c);
+    if (eclass == T8_ECLASS_HEX) {
+      fs_d->t8_element_destroy (1, &face_d);
+      fs_c->t8_element_destroy (1, &face_c);
+    }
+  }
+}
+
+static void
+test_compact_conversion ()
+{
+  p4est_quadrant_t    quad;
+  p8est_quadrant_t    oct;
+  t8_cquad_t          cquad, cquad2;
+  t8_chex_t           chex, chex2;
+  int                 level;
+
+  for (level = 0; level <= P4EST_QMAXLEVEL; level++) {
+    cquad.x = P4EST_LAST_OFFSET (level);
+    cquad.y = 0;
+    cquad.level = level;
+    cquad.pad8 = cquad.pad16 = 0;
+    t8_cquad_to_p4est (&cquad, &quad);
+    SC_CHECK_ABORT (p4est_quadrant_is_valid (&quad),
+                    "Converted quadrant is invalid");
+    t8_cquad_from_p4est (&quad, &cquad2);
+    SC_CHECK_ABORT (!memcmp (&cquad, &cquad2, sizeof (t8_cquad_t)),
+                    "Quadrant conversion is not inverse");
+  }
+  for (level = 0; level <= P8EST_QMAXLEVEL; level++) {
+    chex.x = 0;
+    chex.y = P8EST_LAST_OFFSET (level);
+    chex.z = P8EST_LAST_OFFSET (level);
+    chex.level = level;
+    chex.pad8 = chex.pad16 = 0;
+    t8_chex_to_p8est (&chex, &oct);
+    SC_CHECK_ABORT (p8est_quadrant_is_valid (&oct),
+                    "Converted octant is invalid");
+    t8_chex_from_p8est (&oct, &chex2);
+    SC_CHECK_ABORT (!memcmp (&chex, &chex2, sizeof (t8_chex_t)),
+                    "Octant conversion is not inverse");
+  }
+}
+
+static void
+test_compact_scheme (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *default_scheme = t8_scheme_new_default_cxx ();
+  t8_scheme_cxx_t    *compact_scheme = t8_scheme_new_compact_cxx ();
+  t8_eclass_t         eclasses[2] = { T8_ECLASS_QUAD, T8_ECLASS_HEX };
+  t8_forest_t         forest_default, forest_compact;
+  t8_cmesh_t          cmesh;
+  int                 iclass, level;
+  int                 maxlevel = 4;
+
+  for (iclass = 0; iclass < 2; iclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclasses[iclass]]);
+    for (level = 0; level < maxlevel; ++level) {
+      cmesh = t8_cmesh_new_hypercube (eclasses[iclass], comm, 0, 0, 0);
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (default_scheme);
+      t8_scheme_cxx_ref (compact_scheme);
+      forest_default =
+        t8_forest_new_uniform (cmesh, default_scheme, level, 1, comm);
+      forest_compact =
+        t8_forest_new_uniform (cmesh, compact_scheme, level, 1, comm);
+      test_compact_compare_forests (forest_default, forest_compact, level);
+      t8_forest_unref (&forest_default);
+      t8_forest_unref (&forest_compact);
+    }
+  }
+  t8_scheme_cxx_unref (&default_scheme);
+  t8_scheme_cxx_unref (&compact_scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing compact quad and hex schemes.\n");
+  test_compact_conversion ();
+  test_compact_scheme (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing compact quad and hex schemes.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest_conduit.h>
+#include <t8_element_cxx.hxx>
+#if T8_WITH_CONDUIT
+#include <conduit.h>
+#endif
+
+/*
+ * In this file we test the Conduit Mesh Blueprint of a forest.
+ * We compute the mesh arrays of uniform forests of each eclass with all
+ * element data fields and a scalar and vector user field and check them
+ * against the elements of the forest. Then we publish the mesh to a
+ * Conduit node, which is verified as a Blueprint mesh in debug mode.
+ * If t8code was not configured with --with-conduit then publishing must
+ * fail.
+ */
+
+static void
+t8_test_conduit_check_mesh (const t8_forest_conduit_mesh_t * mesh)
+{
+  t8_forest_t         forest = mesh->forest;
+  t8_locidx_t         itree, ielem, lelement, ipoint;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  double              coords[3];
+  int                 icorner, num_corners, mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (t8_forest_get_mpicomm (forest), &mpirank);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (mesh->num_elements ==
+                  t8_forest_get_local_num_elements (forest),
+                  "Wrong number of elements");
+  lelement = ipoint = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_corners = ts->t8_element_num_corners (element);
+      SC_CHECK_ABORT (mesh->offsets[lelement] == ipoint
+                      && mesh->sizes[lelement] == num_corners,
+                      "Wrong offset or size of an element");
+      SC_CHECK_ABORT (mesh->shapes[lelement] ==
+                      t8_eclass_vtk_type[ts->t8_element_shape (element)],
+                      "Wrong shape of an element");
+      SC_CHECK_ABORT (mesh->treeids[lelement] ==
+                      t8_forest_global_tree_id (forest, itree)
+                      && mesh->mpiranks[lelement] == mpirank
+                      && mesh->levels[lelement] ==
+                      ts->t8_element_level (element)
+                      && mesh->element_ids[lelement] ==
+                      t8_forest_get_first_local_element_id (forest)
+                      + lelement, "Wrong element data");
+      /* The first vtk corner is the first t8code corner */
+      t8_forest_element_coordinate (forest, itree, element,
+                                    t8_forest_get_tree_vertices (forest,
+                                                                 itree),
+                                    0, coords);
+      for (icorner = 0; icorner < 3; icorner++) {
+        SC_CHECK_ABORT (mesh->coordinates[3 * ipoint + icorner] ==
+                        coords[icorner], "Wrong corner coordinates");
+      }
+      for (icorner = 0; icorner < num_corners; icorner++, ipoint++) {
+        SC_CHECK_ABORT (mesh->connectivity[ipoint] == ipoint,
+                        "Wrong connectivity");
+      }
+    }
+  }
+  SC_CHECK_ABORT (ipoint == mesh->num_points, "Wrong number of corners");
+}
+
+static void
+t8_test_conduit (sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh;
+  t8_vtk_data_field_t fields[2];
+  t8_forest_conduit_mesh_t mesh;
+  double             *scalars, *vectors;
+  t8_locidx_t         num_elements, ielem;
+  int                 eclass, level = 2;
+  int                 retval;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; eclass++) {
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (),
+                                    level, 0, comm);
+    num_elements = t8_forest_get_local_num_elements (forest);
+    scalars = T8_ALLOC (double, num_elements);
+    vectors = T8_ALLOC (double, 3 * num_elements);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      scalars[ielem] = ielem;
+      vectors[3 * ielem] = vectors[3 * ielem + 1] = vectors[3 * ielem + 2] =
+        ielem;
+    }
+    fields[0].type = T8_VTK_SCALAR;
+    snprintf (fields[0].description, BUFSIZ, "scalar");
+    fields[0].data = scalars;
+    fields[1].type = T8_VTK_VECTOR;
+    snprintf (fields[1].description, BUFSIZ, "vector");
+    fields[1].data = vectors;
+
+    t8_forest_conduit_mesh_init (&mesh, forest, 1, 1, 1, 1, 2, fields);
+    /* The mesh keeps the forest alive */
+    t8_forest_unref (&forest);
+    t8_test_conduit_check_mesh (&mesh);
+#if T8_WITH_CONDUIT
+    {
+      conduit_node       *node = conduit_node_create ();
+
+      retval = t8_forest_conduit_publish (&mesh, node, "mesh");
+      SC_CHECK_ABORT (retval, "Error publishing the mesh");
+      conduit_node_destroy (node);
+    }
+#else
+    retval = t8_forest_conduit_publish (&mesh, NULL, "mesh");
+    SC_CHECK_ABORT (!retval, "Published mesh without conduit support");
+#endif
+    t8_forest_conduit_mesh_reset (&mesh);
+
+    T8_FREE (scalars);
+    T8_FREE (vectors);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_test_conduit (sc_MPI_COMM_WORLD);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
@@ -0,0 +1,157 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the contiguous storage of the leaves of a forest.
+ * We build a uniform forest of many trees with and without contiguous
+ * leaves and check that the elements are the same and that the elements of
+ * consecutive trees are adjacent in memory. We then adapt both forests and
+ * compare the results.
+ */
+
+#define T8_TEST_CONTIGUOUS_LEAVES_NUM_TREES 100
+
+/* Refine every third element */
+static int
+t8_test_contiguous_leaves_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                                 t8_locidx_t which_tree,
+                                 t8_locidx_t lelement_id,
+                                 t8_eclass_scheme_c * ts, int num_elements,
+                                 t8_element_t * elements[])
+{
+  return lelement_id % 3 == 0;
+}
+
+/* Check that two forests have the same elements */
+static void
+t8_test_contiguous_leaves_compare (t8_forest_t forest_a, t8_forest_t forest_b)
+{
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_scheme_c *ts;
+
+  SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_a)
+                  == t8_forest_get_local_num_elements (forest_b),
+                  "The forests have different numbers of elements");
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest_a); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest_a,
+                                      t8_forest_get_tree_class (forest_a,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest_a, itree);
+    SC_CHECK_ABORT (num_elements ==
+                    t8_forest_get_tree_num_elements (forest_b, itree),
+                    "The trees have different numbers of elements");
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      SC_CHECK_ABORT (!ts->t8_element_compare
+                      (t8_forest_get_element_in_tree (forest_a, itree, ielem),
+                       t8_forest_get_element_in_tree (forest_b, itree,
+                                                      ielem)),
+                      "The forests have different elements");
+    }
+  }
+}
+
+static void
+t8_test_contiguous_leaves (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_contiguous;
+  t8_forest_t         forest_adapt, forest_adapt_contiguous;
+  t8_element_array_t *leaves;
+  const char         *tree_end;
+  t8_locidx_t         itree;
+  int                 eclass;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_bigmesh
+                                    ((t8_eclass_t) eclass,
+                                     T8_TEST_CONTIGUOUS_LEAVES_NUM_TREES,
+                                     comm), scheme, 1, 0, comm);
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_init (&forest_contiguous);
+    t8_forest_set_cmesh (forest_contiguous, t8_cmesh_new_bigmesh
+                         ((t8_eclass_t) eclass,
+                          T8_TEST_CONTIGUOUS_LEAVES_NUM_TREES, comm), comm);
+    t8_forest_set_scheme (forest_contiguous, scheme);
+    t8_forest_set_level (forest_contiguous, 1);
+    t8_forest_set_contiguous_leaves (forest_contiguous, 1);
+    t8_forest_commit (forest_contiguous);
+
+    SC_CHECK_ABORT (t8_forest_has_contiguous_leaves (forest_contiguous),
+                    "The leaves are not contiguous");
+    SC_CHECK_ABORT (!t8_forest_has_contiguous_leaves (forest),
+                    "The leaves are contiguous without being set");
+    t8_test_contiguous_leaves_compare (forest, forest_contiguous);
+    /* The elements of a tree follow the elements of the previous tree */
+    tree_end = NULL;
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest_contiguous);
+         itree++) {
+      leaves = t8_forest_tree_get_leafs (forest_contiguous, itree);
+      SC_CHECK_ABORT (tree_end == NULL || tree_end <=
+                      (const char *) t8_element_array_get_data (leaves),
+                      "The trees are not stored in order");
+      tree_end = (const char *) t8_element_array_get_data (leaves)
+        + t8_element_array_get_count (leaves) * leaves->array.elem_size;
+    }
+
+    /* Adapting a forest with contiguous leaves gives the same result */
+    forest_adapt =
+      t8_forest_new_adapt (forest, t8_test_contiguous_leaves_adapt, 0, 0,
+                           NULL);
+    forest_adapt_contiguous =
+      t8_forest_new_adapt (forest_contiguous,
+                           t8_test_contiguous_leaves_adapt, 0, 0, NULL);
+    t8_test_contiguous_leaves_compare (forest_adapt, forest_adapt_contiguous);
+    t8_forest_unref (&forest_adapt);
+    t8_forest_unref (&forest_adapt_contiguous);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing contiguous leaves.\n");
+  t8_test_contiguous_leaves (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing contiguous leaves.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_data/t8_containers.h>
+
+/*
+ * In this file we test whether the batch element functions
+ * t8_element_batch_level, t8_element_batch_child_id, t8_element_batch_parent,
+ * t8_element_batch_children, t8_element_batch_get_linear_id and
+ * t8_element_batch_set_linear_id compute the same results as the
+ * corresponding single element functions.
+ * We check this for the elements of uniform forests of all classes.
+ */
+
+/* Check the batch functions for the elements of the first local tree */
+static void
+test_element_batch_tree (t8_forest_t forest, t8_eclass_scheme_c * ts,
+                         int level)
+{
+  t8_locidx_t         num_elements;
+  t8_element_t       *first, *elem, *single;
+  t8_element_array_t  parents, children, constructed;
+  t8_linearidx_t     *ids;
+  int                *levels, *child_ids;
+  int                 ielem, ichild, num_children;
+
+  num_elements = t8_forest_get_tree_num_elements (forest, 0);
+  if (num_elements == 0) {
+    return;
+  }
+  first = t8_forest_get_element_in_tree (forest, 0, 0);
+  num_children = ts->t8_element_num_children (first);
+  levels = T8_ALLOC (int, num_elements);
+  child_ids = T8_ALLOC (int, num_elements);
+  ids = T8_ALLOC (t8_linearidx_t, num_elements);
+  t8_element_array_init_size (&parents, ts, num_elements);
+  t8_element_array_init_size (&children, ts, num_elements * num_children);
+  t8_element_array_init_size (&constructed, ts, num_elements);
+  ts->t8_element_new (1, &single);
+
+  ts->t8_element_batch_level (first, num_elements, levels);
+  ts->t8_element_batch_child_id (first, num_elements, child_ids);
+  ts->t8_element_batch_get_linear_id (first, num_elements, level, ids);
+  ts->t8_element_batch_parent (first, num_elements,
+                               t8_element_array_index_int (&parents, 0));
+  ts->t8_element_batch_children (first, num_elements,
+                                 t8_element_array_index_int (&children, 0));
+  ts->t8_element_batch_set_linear_id (t8_element_array_index_int
+                                      (&constructed, 0), num_elements, level,
+                                      ts->t8_element_get_linear_id (first,
+                                                                    level));
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    elem = t8_forest_get_element_in_tree (forest, 0, ielem);
+    SC_CHECK_ABORT (levels[ielem] == ts->t8_element_level (elem),
+                    "Wrong batch level");
+    SC_CHECK_ABORT (child_ids[ielem] == ts->t8_element_child_id (elem),
+                    "Wrong batch child id");
+    SC_CHECK_ABORT (ids[ielem] == ts->t8_element_get_linear_id (elem, level),
+                    "Wrong batch linear id");
+    ts->t8_element_set_linear_id (single, level,
+                                  ts->t8_element_get_linear_id (elem, level));
+    SC_CHECK_ABORT (!ts->t8_element_compare
+                    (single, t8_element_array_index_int (&constructed,
+                                                         ielem)),
+                    "Wrong batch element from linear id");
+    ts->t8_element_parent (elem, single);
+    SC_CHECK_ABORT (!ts->t8_element_compare
+                    (single, t8_element_array_index_int (&parents, ielem)),
+                    "Wrong batch parent");
+    for (ichild = 0; ichild < num_children; ichild++) {
+      ts->t8_element_child (elem, ichild, single);
+      SC_CHECK_ABORT (!ts->t8_element_compare
+                      (single, t8_element_array_index_int (&children,
+                                                           ielem *
+                                                           num_children +
+                                                           ichild)),
+                      "Wrong batch child");
+    }
+  }
+
+  ts->t8_element_destroy (1, &single);
+  t8_element_array_reset (&parents);
+  t8_element_array_reset (&children);
+  t8_element_array_reset (&constructed);
+  T8_FREE (levels);
+  T8_FREE (child_ids);
+  T8_FREE (ids);
+}
+
+static void
+test_element_batch (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  int                 eclass, level;
+  int                 maxlevel = 4;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The elements of a pyramid tree do not all have the same number
+       * of children, which the batch children function requires. */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    /* We start at level 1, since we compute the parents of all elements */
+    for (level = 1; level < maxlevel; ++level) {
+      t8_scheme_cxx_ref (ts);
+      forest =
+        t8_forest_new_uniform (t8_cmesh_new_from_class
+                               ((t8_eclass_t) eclass, comm), ts, level, 0,
+                               comm);
+      if (t8_forest_get_num_local_trees (forest) > 0) {
+        test_element_batch_tree (forest, ts->eclass_schemes[eclass], level);
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing batch element functions.\n");
+  test_element_batch (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing batch element functions.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -27,11 +27,11 @@
  * function return the correct values for the default scheme.
  * This value should be  2^(dim * (level - element_level)) for
  * level >= element_level (for eclass != T8_ECLASS_PYRAMID).
+ * For pyramids it is 2 * 8^(level - element_level) - 6^(level - element_level).
  * For level < element_level the value should be zero.
  */
 /*
  * TODO:
- *  - Add a test for pyramids as soon as the function is available
  *  - Add a test for different schemes as soon as they are implemented
  */
 
@@ -47,10 +47,6 @@ test_element_count_leafs_one_level ()
   /* We iterate over all classes and all refinement levels and compute the
    * leafs of this refinement level. */
   for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
-    if (eclass == T8_ECLASS_PYRAMID) {
-      /* TODO: Add pyramid test, as soon as pyramids are supported */
-      continue;
-    }
     class_scheme = ts->eclass_schemes[eclass];
     int                 maxlevel = class_scheme->t8_element_maxlevel ();
     class_scheme->t8_element_new (1, &element);
@@ -88,10 +84,6 @@ test_element_count_leafs_less_level ()
   /* We iterate over all classes and all refinement levels and compute the
    * leafs of this refinement level. */
   for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
-    if (eclass == T8_ECLASS_PYRAMID) {
-      /* TODO: Add pyramid test, as soon as pyramids are supported */
-      continue;
-    }
     class_scheme = ts->eclass_schemes[eclass];
     int                 maxlevel = class_scheme->t8_element_maxlevel ();
     /* Allocate memory for an element */
@@ -135,13 +127,11 @@ test_element_count_leafs_root ()
   /* We iterate over all classes and all refinement levels and compute the
    * leafs of this refinement level. */
   for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
-    if (eclass == T8_ECLASS_PYRAMID) {
-      /* TODO: Add pyramid test, as soon as pyramids are supported */
-      continue;
-    }
     class_scheme = ts->eclass_schemes[eclass];
     int                 maxlevel = class_scheme->t8_element_maxlevel ();
     t8_gloidx_t         compare_value = 1;
+    /* Powers of 8 and 6 for the pyramid leaf count */
+    t8_gloidx_t         pow8 = 1, pow6 = 1;
     for (level = 0; level <= maxlevel; ++level) {
       t8_gloidx_t         leaf_count =
         class_scheme->t8_element_count_leafs_from_root (level);
@@ -149,9 +139,16 @@ test_element_count_leafs_root ()
                        "Incorrect leaf count %li at eclass %s and level %i"
                        " (expecting %li)", leaf_count,
                        t8_eclass_to_string[eclass], level, compare_value);
-      /* Multiply the compare_value with 2^dim (= number of children per element) */
-      /* TODO: Use a differente formula for pyramids */
-      compare_value *= 1 << t8_eclass_to_dimension[eclass];
+      if (eclass == T8_ECLASS_PYRAMID) {
+        /* A pyramid refines into 6 pyramids and 4 tetrahedra */
+        pow8 *= 8;
+        pow6 *= 6;
+        compare_value = 2 * pow8 - pow6;
+      }
+      else {
+        /* Multiply the compare_value with 2^dim (= number of children per element) */
+        compare_value *= 1 << t8_eclass_to_dimension[eclass];
+      }
     }
   }
   t8_scheme_cxx_unref (&ts);
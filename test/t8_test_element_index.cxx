@@ -0,0 +1,170 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the element index of a forest.
+ * We build an adapted and partitioned forest with and without element index
+ * and check that t8_forest_get_element and t8_forest_get_element_batch
+ * find the same trees and elements as a walk over the local trees.
+ */
+
+/* Refine the first child of each family up to level 4. */
+static int
+t8_test_element_index_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                             t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                             t8_eclass_scheme_c * ts, int num_elements,
+                             t8_element_t * elements[])
+{
+  int                 level = ts->t8_element_level (elements[0]);
+
+  return level < 4 && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+static t8_forest_t
+t8_test_element_index_forest (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                              int use_index, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  t8_forest_set_scheme (forest, scheme);
+  t8_forest_set_level (forest, 1);
+  t8_forest_commit (forest);
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_element_index_adapt,
+                       1);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_set_element_index (forest_adapt, use_index);
+  t8_forest_commit (forest_adapt);
+  SC_CHECK_ABORT (t8_forest_has_element_index (forest_adapt) == use_index,
+                  "Element index was not computed.");
+  return forest_adapt;
+}
+
+static void
+t8_test_element_index_check (t8_forest_t forest)
+{
+  t8_locidx_t         itree, num_trees, ielement, num_tree_elements;
+  t8_locidx_t         lelement_id, num_elements, ltree;
+  t8_locidx_t        *ltreeids, *tree_element_ids;
+  t8_gloidx_t        *gelement_ids, first_element;
+  t8_element_t      **elements, *element;
+  size_t              num_ids, iid;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_trees = t8_forest_get_num_local_trees (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  /* We look up all local elements in reverse order and one element before
+   * and after the local elements, which are not local. */
+  num_ids = num_elements + 2;
+  gelement_ids = T8_ALLOC (t8_gloidx_t, num_ids);
+  ltreeids = T8_ALLOC (t8_locidx_t, num_ids);
+  tree_element_ids = T8_ALLOC (t8_locidx_t, num_ids);
+  elements = T8_ALLOC (t8_element_t *, num_ids);
+  gelement_ids[0] = first_element - 1;
+  for (iid = 1; iid <= (size_t) num_elements; iid++) {
+    gelement_ids[iid] = first_element + num_elements - (t8_gloidx_t) iid;
+  }
+  gelement_ids[num_ids - 1] = first_element + num_elements;
+  t8_forest_get_element_batch (forest, num_ids, gelement_ids, ltreeids,
+                               tree_element_ids, elements);
+  SC_CHECK_ABORT (ltreeids[0] == -1 && elements[0] == NULL
+                  && ltreeids[num_ids - 1] == -1
+                  && elements[num_ids - 1] == NULL,
+                  "Found an element that is not local.");
+
+  lelement_id = 0;
+  for (itree = 0; itree < num_trees; itree++) {
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_tree_elements;
+         ielement++, lelement_id++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      SC_CHECK_ABORT (t8_forest_get_element (forest, lelement_id, &ltree)
+                      == element && ltree == itree,
+                      "Wrong element or tree returned.");
+      iid = num_elements - lelement_id;
+      SC_CHECK_ABORT (ltreeids[iid] == itree
+                      && tree_element_ids[iid] == ielement
+                      && elements[iid] == element,
+                      "Wrong element or tree returned by batch lookup.");
+    }
+  }
+  SC_CHECK_ABORT (lelement_id == num_elements, "Wrong number of elements.");
+
+  T8_FREE (gelement_ids);
+  T8_FREE (ltreeids);
+  T8_FREE (tree_element_ids);
+  T8_FREE (elements);
+}
+
+static void
+t8_test_element_index (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  int                 eclass, use_index;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    for (use_index = 0; use_index < 2; ++use_index) {
+      forest = t8_test_element_index_forest (cmesh, scheme, use_index, comm);
+      t8_test_element_index_check (forest);
+      t8_forest_unref (&forest);
+    }
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the element index.\n");
+  t8_test_element_index (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the element index.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
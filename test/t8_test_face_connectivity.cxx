@@ -0,0 +1,435 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the face connectivity table of a forest.
+ * We build uniform forests with face connectivity and compare the cached
+ * neighbors with the neighbors computed by t8_forest_leaf_face_neighbors
+ * and by t8_forest_leaf_face_neighbors_workspace.
+ * We also check that the face list covers each face of a local element
+ * exactly once, and that the level grouped element and face lists of a
+ * uniform forest contain all elements and faces in the group of its level.
+ * Finally we export the dual graph, check that each face neighbor is an
+ * edge and that a given partition is applied.
+ * On forests with one refined element per tree we check that the mortars
+ * list each hanging face with the face neighbors of its elements.
+ */
+
+static void
+t8_test_face_list_check (t8_forest_t forest)
+{
+  sc_array_t          face_list;
+  const t8_forest_face_pair_t *pair;
+  const t8_locidx_t  *face_offsets, *neighbor_offsets, *neighbor_indices;
+  const int          *dual_faces, *orientations;
+  t8_locidx_t         num_elements, num_pairs, ipair;
+  int                *face_count;
+  int                 iside;
+
+  num_elements =
+    t8_forest_get_face_connectivity (forest, &face_offsets, &neighbor_offsets,
+                                     &neighbor_indices, &dual_faces,
+                                     &orientations);
+  face_count = T8_ALLOC_ZERO (int, face_offsets[num_elements]);
+  sc_array_init (&face_list, sizeof (t8_forest_face_pair_t));
+  num_pairs = t8_forest_face_list (forest, &face_list);
+  for (ipair = 0; ipair < num_pairs; ipair++) {
+    pair = (const t8_forest_face_pair_t *)
+      sc_array_index_int (&face_list, ipair);
+    SC_CHECK_ABORT (0 <= pair->elements[0]
+                    && pair->elements[0] < num_elements,
+                    "Face list entry without local element");
+    SC_CHECK_ABORT (ipair == 0 || pair[-1].elements[0] <= pair->elements[0],
+                    "Face list is not sorted");
+    SC_CHECK_ABORT (pair->subface == -1, "Hanging face in uniform forest");
+    for (iside = 0; iside < 2; iside++) {
+      if (0 <= pair->elements[iside] && pair->elements[iside] < num_elements) {
+        face_count[face_offsets[pair->elements[iside]]
+                   + pair->faces[iside]]++;
+      }
+    }
+  }
+  for (ipair = 0; ipair < face_offsets[num_elements]; ipair++) {
+    SC_CHECK_ABORT (face_count[ipair] == 1,
+                    "Face is not listed exactly once");
+  }
+  sc_array_reset (&face_list);
+  T8_FREE (face_count);
+}
+
+/* Check the mortars against the face connectivity and return their number */
+static t8_locidx_t
+t8_test_mortars_check (t8_forest_t forest)
+{
+  t8_forest_mortars_t mortars;
+  const t8_locidx_t  *face_offsets, *neighbor_offsets, *neighbor_indices;
+  const int          *dual_faces, *orientations;
+  t8_locidx_t         num_elements, imortar, iside, iface, big, small;
+  t8_locidx_t         num_mortars, num_hanging;
+  int8_t             *levels;
+  int                 num_small;
+
+  num_elements =
+    t8_forest_get_face_connectivity (forest, &face_offsets, &neighbor_offsets,
+                                     &neighbor_indices, &dual_faces,
+                                     &orientations);
+  mortars = t8_forest_mortars_new (forest);
+  num_hanging = 0;
+  for (imortar = 0; imortar < mortars->num_mortars; imortar++) {
+    big = mortars->big_elements[imortar];
+    num_small = mortars->small_offsets[imortar + 1]
+      - mortars->small_offsets[imortar];
+    SC_CHECK_ABORT (num_small > 0, "Mortar without small side");
+    SC_CHECK_ABORT (imortar == 0 || mortars->big_elements[imortar - 1]
+                    <= big, "Mortars are not sorted");
+    if (big < num_elements) {
+      /* The small sides are the neighbors of the big face */
+      iface = face_offsets[big] + mortars->big_faces[imortar];
+      SC_CHECK_ABORT (num_small == neighbor_offsets[iface + 1]
+                      - neighbor_offsets[iface],
+                      "Wrong number of small sides");
+      SC_CHECK_ABORT (mortars->orientations[imortar] == orientations[iface],
+                      "Wrong mortar orientation");
+      for (iside = 0; iside < num_small; iside++) {
+        small = mortars->small_offsets[imortar] + iside;
+        SC_CHECK_ABORT (mortars->small_elements[small]
+                        == neighbor_indices[neighbor_offsets[iface] + iside]
+                        && mortars->small_faces[small]
+                        == dual_faces[neighbor_offsets[iface] + iside]
+                        && mortars->subfaces[small] == iside,
+                        "Wrong small side of a local mortar");
+      }
+      num_hanging++;
+    }
+    else {
+      /* The small sides are local and have the big ghost as neighbor */
+      for (iside = mortars->small_offsets[imortar];
+           iside < mortars->small_offsets[imortar + 1]; iside++) {
+        small = mortars->small_elements[iside];
+        SC_CHECK_ABORT (0 <= small && small < num_elements,
+                        "Small side of a ghost mortar is not local");
+        iface = face_offsets[small] + mortars->small_faces[iside];
+        SC_CHECK_ABORT (neighbor_offsets[iface + 1] - neighbor_offsets[iface]
+                        == 1 && neighbor_indices[neighbor_offsets[iface]]
+                        == big, "Wrong small side of a ghost mortar");
+        SC_CHECK_ABORT (iside == mortars->small_offsets[imortar]
+                        || mortars->subfaces[iside - 1]
+                        < mortars->subfaces[iside],
+                        "Small sides are not sorted");
+      }
+    }
+  }
+  /* Each face with finer neighbors is a local mortar */
+  levels = T8_ALLOC (int8_t, num_elements + t8_forest_get_num_ghosts (forest));
+  t8_forest_element_levels (forest, levels);
+  for (big = 0; big < num_elements; big++) {
+    for (iface = face_offsets[big]; iface < face_offsets[big + 1]; iface++) {
+      num_small = neighbor_offsets[iface + 1] - neighbor_offsets[iface];
+      if (num_small > 1 || (num_small == 1
+                            && levels[neighbor_indices[neighbor_offsets
+                                                       [iface]]]
+                            > levels[big])) {
+        num_hanging--;
+      }
+    }
+  }
+  SC_CHECK_ABORT (num_hanging == 0, "Wrong number of local mortars");
+  T8_FREE (levels);
+  num_mortars = mortars->num_mortars;
+  t8_forest_mortars_destroy (&mortars);
+  SC_CHECK_ABORT (mortars == NULL, "Mortars are not freed");
+  return num_mortars;
+}
+
+static void
+t8_test_level_lists_check (t8_forest_t forest, int level)
+{
+  sc_array_t          face_list, level_face_list;
+  int8_t             *levels;
+  t8_locidx_t        *level_offsets, *element_indices;
+  t8_locidx_t         itree, num_elements, num_pairs;
+  int                 maxlevel;
+
+  maxlevel = t8_forest_get_maxlevel (forest);
+  level_offsets = T8_ALLOC (t8_locidx_t, maxlevel + 2);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    element_indices = T8_ALLOC (t8_locidx_t, num_elements);
+    t8_forest_tree_elements_by_level (forest, itree, level_offsets,
+                                      element_indices);
+    SC_CHECK_ABORT (level_offsets[level] == 0
+                    && level_offsets[level + 1] == num_elements,
+                    "Wrong level offsets");
+    SC_CHECK_ABORT (num_elements == 0 || element_indices[0] == 0,
+                    "Level sort does not keep the element order");
+    T8_FREE (element_indices);
+  }
+  T8_FREE (level_offsets);
+
+  levels = T8_ALLOC (int8_t, t8_forest_get_local_num_elements (forest)
+                     + t8_forest_get_num_ghosts (forest));
+  t8_forest_element_levels (forest, levels);
+  sc_array_init (&face_list, sizeof (t8_forest_face_pair_t));
+  sc_array_init (&level_face_list, sizeof (t8_forest_face_pair_t));
+  num_pairs = t8_forest_face_list (forest, &face_list);
+  SC_CHECK_ABORT (t8_forest_face_list_levels (&face_list, levels, level,
+                                              level, &level_face_list)
+                  == num_pairs, "Face missing in level face list");
+  SC_CHECK_ABORT (t8_forest_face_list_levels (&face_list, levels, level + 1,
+                                              maxlevel + 1, &level_face_list)
+                  == 0, "Wrong face in level face list");
+  sc_array_reset (&face_list);
+  sc_array_reset (&level_face_list);
+  T8_FREE (levels);
+}
+
+static void
+t8_test_dual_graph_check (t8_forest_t forest)
+{
+  const t8_locidx_t  *face_offsets, *neighbor_offsets, *neighbor_indices;
+  const int          *dual_faces, *orientations;
+  t8_gloidx_t        *vtxdist, *adjncy, *offsets, num_edges, global_edges;
+  t8_locidx_t        *xadj, *adjwgt;
+  t8_locidx_t         num_elements, ielem, iedge;
+  t8_forest_t         forest_partition;
+  int                *assignment;
+  int                 mpisize, mpirank, mpiret, irank;
+  sc_MPI_Comm         comm;
+
+  comm = t8_forest_get_mpicomm (forest);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  t8_forest_get_face_connectivity (forest, &face_offsets, &neighbor_offsets,
+                                   &neighbor_indices, &dual_faces,
+                                   &orientations);
+  num_elements =
+    t8_forest_dual_graph (forest, &vtxdist, &xadj, &adjncy, &adjwgt);
+  SC_CHECK_ABORT (num_elements == t8_forest_get_local_num_elements (forest)
+                  && vtxdist[mpirank + 1] - vtxdist[mpirank] == num_elements,
+                  "Wrong number of dual graph vertices");
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    /* In a uniform forest each face has at most one neighbor and two
+     * elements share at most one face */
+    SC_CHECK_ABORT (xadj[ielem + 1] - xadj[ielem] ==
+                    neighbor_offsets[face_offsets[ielem + 1]]
+                    - neighbor_offsets[face_offsets[ielem]],
+                    "Wrong number of dual graph edges");
+    for (iedge = xadj[ielem]; iedge < xadj[ielem + 1]; iedge++) {
+      SC_CHECK_ABORT (adjwgt[iedge] == 1 && 0 <= adjncy[iedge]
+                      && adjncy[iedge] < vtxdist[mpisize]
+                      && adjncy[iedge] != vtxdist[mpirank] + ielem,
+                      "Wrong dual graph edge");
+      SC_CHECK_ABORT (iedge == xadj[ielem]
+                      || adjncy[iedge - 1] < adjncy[iedge],
+                      "Dual graph edges are not sorted");
+    }
+  }
+  /* Each edge is stored by both of its elements */
+  num_edges = xadj[num_elements];
+  mpiret = sc_MPI_Allreduce (&num_edges, &global_edges, 1, T8_MPI_GLOIDX,
+                             sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (global_edges % 2 == 0, "Dual graph is not symmetric");
+
+  /* Assign all elements to the last process and partition accordingly */
+  assignment = T8_ALLOC (int, num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    assignment[ielem] = mpisize - 1;
+  }
+  offsets = T8_ALLOC (t8_gloidx_t, mpisize + 1);
+  t8_forest_partition_offsets_from_assignment (forest, assignment, offsets);
+  for (irank = 0; irank < mpisize; irank++) {
+    SC_CHECK_ABORT (offsets[irank] == 0, "Wrong partition offsets");
+  }
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_partition);
+  t8_forest_set_partition (forest_partition, forest, 0);
+  t8_forest_set_partition_offsets (forest_partition, offsets);
+  t8_forest_commit (forest_partition);
+  SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_partition) ==
+                  (mpirank == mpisize - 1 ? vtxdist[mpisize] : 0),
+                  "Given partition was not applied");
+  t8_forest_unref (&forest_partition);
+  T8_FREE (assignment);
+  T8_FREE (offsets);
+  T8_FREE (vtxdist);
+  T8_FREE (xadj);
+  T8_FREE (adjncy);
+  T8_FREE (adjwgt);
+}
+
+static void
+t8_test_face_connectivity_check (t8_forest_t forest)
+{
+  t8_forest_face_neighbor_workspace_t workspace;
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t       *element, **neighbor_leafs;
+  t8_locidx_t        *element_indices;
+  const t8_locidx_t  *cached_indices;
+  const int          *cached_dual_faces;
+  const t8_locidx_t  *workspace_indices;
+  const int          *workspace_dual_faces;
+  int                *dual_faces;
+  int                 iface, num_faces, num_neighbors, ineigh;
+  int                 orientation;
+
+  SC_CHECK_ABORT (t8_forest_has_face_connectivity (forest),
+                  "Forest has no face connectivity");
+  workspace = t8_forest_face_neighbor_workspace_new (forest);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_faces = ts->t8_element_num_faces (element);
+      for (iface = 0; iface < num_faces; iface++) {
+        t8_forest_leaf_face_neighbors (forest, itree, element,
+                                       &neighbor_leafs, iface, &dual_faces,
+                                       &num_neighbors, &element_indices,
+                                       &neigh_scheme, 1);
+        SC_CHECK_ABORT (num_neighbors ==
+                        t8_forest_element_cached_face_neighbors
+                        (forest, itree, ielem, iface, &cached_indices,
+                         &cached_dual_faces, &orientation),
+                        "Wrong number of cached face neighbors");
+        SC_CHECK_ABORT (orientation >= 0, "Wrong cached orientation");
+        SC_CHECK_ABORT (num_neighbors ==
+                        t8_forest_leaf_face_neighbors_workspace
+                        (forest, itree, element, iface, workspace, NULL,
+                         &workspace_dual_faces, &workspace_indices, NULL, 1),
+                        "Wrong number of workspace face neighbors");
+        for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          SC_CHECK_ABORT (cached_indices[ineigh] == element_indices[ineigh],
+                          "Wrong cached face neighbor");
+          SC_CHECK_ABORT (cached_dual_faces[ineigh] == dual_faces[ineigh],
+                          "Wrong cached dual face");
+          SC_CHECK_ABORT (workspace_indices[ineigh] ==
+                          element_indices[ineigh],
+                          "Wrong workspace face neighbor");
+          SC_CHECK_ABORT (workspace_dual_faces[ineigh] == dual_faces[ineigh],
+                          "Wrong workspace dual face");
+        }
+        if (num_neighbors > 0) {
+          neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+          T8_FREE (element_indices);
+          T8_FREE (neighbor_leafs);
+          T8_FREE (dual_faces);
+        }
+      }
+    }
+  }
+  t8_forest_face_neighbor_workspace_destroy (&workspace);
+}
+
+/* Refine the first element of each tree */
+static int
+t8_test_refine_first (t8_forest_t forest, t8_forest_t forest_from,
+                      t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                      t8_eclass_scheme_c * ts, int num_elements,
+                      t8_element_t * elements[])
+{
+  return lelement_id == 0;
+}
+
+static void
+t8_test_face_connectivity (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* Face neighbors of pyramids are not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      /* Build a uniform forest with ghosts and face connectivity */
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+      t8_forest_set_face_connectivity (forest, 1);
+      t8_forest_commit (forest);
+      t8_test_face_connectivity_check (forest);
+      t8_test_face_list_check (forest);
+      t8_test_level_lists_check (forest, level);
+      t8_test_dual_graph_check (forest);
+      SC_CHECK_ABORT (t8_test_mortars_check (forest) == 0,
+                      "Mortars in a uniform forest");
+      t8_forest_unref (&forest);
+    }
+    /* Refine one element to obtain hanging faces */
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    scheme, 1, 0, comm);
+    t8_forest_init (&forest_adapt);
+    t8_forest_set_adapt (forest_adapt, forest, t8_test_refine_first, 0);
+    t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+    t8_forest_set_face_connectivity (forest_adapt, 1);
+    t8_forest_commit (forest_adapt);
+    t8_test_face_connectivity_check (forest_adapt);
+    (void) t8_test_mortars_check (forest_adapt);
+    t8_forest_unref (&forest_adapt);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest face connectivity.\n");
+  t8_test_face_connectivity (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the forest face connectivity.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -167,6 +167,50 @@ t8_test_find_multiple_owners (sc_MPI_Comm comm, t8_eclass_t eclass)
   sc_array_reset (&owners);
 }
 
+/* Check that the sorted owner search finds this process as owner of all
+ * local elements and agrees with the search for single elements */
+static void
+t8_test_find_owners_sorted (sc_MPI_Comm comm, t8_eclass_t eclass)
+{
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  t8_scheme_cxx_t    *default_scheme;
+  t8_element_array_t *telements;
+  t8_locidx_t         itree, ielem, num_elems;
+  t8_gloidx_t         gtreeid;
+  int                *owners, owner;
+  int                 level = 3;
+
+  default_scheme = t8_scheme_new_default_cxx ();
+  cmesh = t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0);
+  forest = t8_forest_new_uniform (cmesh, default_scheme, level, 0, comm);
+  t8_forest_partition_create_offsets (forest);
+  t8_forest_partition_create_first_desc (forest);
+  t8_forest_partition_create_tree_offsets (forest);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    telements = t8_forest_get_tree_element_array (forest, itree);
+    num_elems = (t8_locidx_t) t8_element_array_get_count (telements);
+    gtreeid = itree + t8_forest_get_first_local_tree_id (forest);
+    owners = T8_ALLOC (int, SC_MAX (num_elems, 1));
+    t8_forest_element_find_owners_sorted (forest, gtreeid, eclass,
+                                          t8_element_array_index_locidx
+                                          (telements, 0), num_elems, owners);
+    for (ielem = 0; ielem < num_elems; ielem++) {
+      SC_CHECK_ABORTF (owners[ielem] == forest->mpirank,
+                       "Wrong owner of element %i in tree %i.\n",
+                       ielem, itree);
+      owner =
+        t8_forest_element_find_owner (forest, gtreeid,
+                                      t8_element_array_index_locidx
+                                      (telements, ielem), eclass);
+      SC_CHECK_ABORT (owners[ielem] == owner,
+                      "Sorted and single owner search differ.\n");
+    }
+    T8_FREE (owners);
+  }
+  t8_forest_unref (&forest);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -186,6 +230,7 @@ main (int argc, char **argv)
     if (ieclass != T8_ECLASS_PYRAMID) {
       /* TODO: does not work with pyramids yet */
       t8_test_find_multiple_owners (mpic, (t8_eclass_t) ieclass);
+      t8_test_find_owners_sorted (mpic, (t8_eclass_t) ieclass);
     }
   }
 
@@ -0,0 +1,262 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the batched adapt callback and the adaptation
+ * by markers.
+ * We adapt a forest with a batched callback, with markers serially and
+ * thread parallel, and with an equivalent callback for single elements
+ * and families and check that the results are equal.
+ * We also refine uniform forests by more than one level with markers
+ * and compare them to uniform forests.
+ */
+
+#define T8_TEST_ADAPT_BATCH_MAXLEVEL 4
+
+/* Elements whose family would start at an element id divisible by 3 are
+ * marked for coarsening */
+static int
+t8_test_adapt_batch_coarsen (t8_eclass_scheme_c * ts,
+                             const t8_element_t * element,
+                             t8_locidx_t lelement_id)
+{
+  return ts->t8_element_level (element) > 0
+    && (lelement_id - ts->t8_element_child_id (element)) % 3 == 0;
+}
+
+/* Elements with odd element id are marked for refinement */
+static int
+t8_test_adapt_batch_refine (t8_eclass_scheme_c * ts,
+                            const t8_element_t * element,
+                            t8_locidx_t lelement_id)
+{
+  return lelement_id % 2 == 1
+    && ts->t8_element_level (element) < T8_TEST_ADAPT_BATCH_MAXLEVEL;
+}
+
+static void
+t8_test_adapt_batch_markers (t8_forest_t forest, t8_forest_t forest_from,
+                             t8_locidx_t which_tree, t8_eclass_scheme_c * ts,
+                             t8_locidx_t num_elements,
+                             const t8_element_t * elements, int *markers)
+{
+  const t8_element_t *element;
+  t8_locidx_t         ielem;
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    element = (const t8_element_t *) ((const char *) elements
+                                      + ielem * ts->t8_element_size ());
+    if (t8_test_adapt_batch_coarsen (ts, element, ielem)) {
+      markers[ielem] = -1;
+    }
+    else {
+      markers[ielem] = t8_test_adapt_batch_refine (ts, element, ielem);
+    }
+  }
+}
+
+/* The same adaptation for single elements and families */
+static int
+t8_test_adapt_batch_single (t8_forest_t forest, t8_forest_t forest_from,
+                            t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                            t8_eclass_scheme_c * ts, int num_elements,
+                            t8_element_t * elements[])
+{
+  if (t8_test_adapt_batch_coarsen (ts, elements[0], lelement_id)) {
+    /* Only a family can be coarsened, other marked elements are kept */
+    return num_elements > 1 ? -1 : 0;
+  }
+  return t8_test_adapt_batch_refine (ts, elements[0], lelement_id);
+}
+
+/* Fill the markers of all local elements of a forest */
+static int8_t      *
+t8_test_adapt_batch_fill_markers (t8_forest_t forest)
+{
+  t8_locidx_t         itree, ielem, num_elements, lelement_id;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  int8_t             *markers;
+
+  markers =
+    T8_ALLOC (int8_t,
+              SC_MAX (t8_forest_get_local_num_elements (forest), 1));
+  lelement_id = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, lelement_id++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      if (t8_test_adapt_batch_coarsen (ts, element, ielem)) {
+        markers[lelement_id] = -1;
+      }
+      else {
+        markers[lelement_id] = t8_test_adapt_batch_refine (ts, element,
+                                                           ielem);
+      }
+    }
+  }
+  return markers;
+}
+
+/* Refine uniform forests by two levels with markers */
+static void
+t8_test_adapt_markers_uniform (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_markers, forest_uniform;
+  t8_cmesh_t          cmesh;
+  int8_t             *markers;
+  int                 eclass, level;
+  t8_locidx_t         ielem;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    for (level = 0; level < 2; ++level) {
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (cmesh, scheme, level, 0, comm);
+      markers = T8_ALLOC (int8_t,
+                          SC_MAX (t8_forest_get_local_num_elements (forest),
+                                  1));
+      for (ielem = 0; ielem < t8_forest_get_local_num_elements (forest);
+           ielem++) {
+        markers[ielem] = 2;
+      }
+      t8_forest_init (&forest_markers);
+      t8_forest_set_adapt_markers (forest_markers, forest, markers, -1);
+      t8_forest_commit (forest_markers);
+      T8_FREE (markers);
+
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (scheme);
+      forest_uniform = t8_forest_new_uniform (cmesh, scheme, level + 2, 0,
+                                              comm);
+      SC_CHECK_ABORT (t8_forest_is_equal (forest_markers, forest_uniform),
+                      "Refinement by markers does not match");
+      t8_forest_unref (&forest_markers);
+      t8_forest_unref (&forest_uniform);
+    }
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+static void
+t8_test_adapt_batch (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_batch, forest_single;
+  t8_forest_t         forest_markers;
+  int8_t             *markers;
+  int                 eclass, level, istep;
+  const int           num_steps = 3;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < 3; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      for (istep = 0; istep < num_steps; ++istep) {
+        t8_forest_ref (forest);
+        t8_forest_init (&forest_single);
+        t8_forest_set_adapt (forest_single, forest,
+                             t8_test_adapt_batch_single, 0);
+        t8_forest_commit (forest_single);
+        /* Adapt with the same markers */
+        t8_forest_ref (forest);
+        markers = t8_test_adapt_batch_fill_markers (forest);
+        t8_forest_init (&forest_markers);
+        t8_forest_set_adapt_markers (forest_markers, forest, markers, -1);
+        t8_forest_commit (forest_markers);
+        SC_CHECK_ABORT (t8_forest_is_equal (forest_markers, forest_single),
+                        "Adaptation by markers does not match");
+        t8_forest_unref (&forest_markers);
+        /* Adapt with the same markers in parallel */
+        t8_forest_ref (forest);
+        t8_forest_init (&forest_markers);
+        t8_forest_set_adapt_markers (forest_markers, forest, markers, -1);
+        t8_forest_set_adapt_threaded (forest_markers, 1);
+        t8_forest_commit (forest_markers);
+        T8_FREE (markers);
+        SC_CHECK_ABORT (t8_forest_is_equal (forest_markers, forest_single),
+                        "Threaded adaptation by markers does not match");
+        t8_forest_unref (&forest_markers);
+        /* Adapt once while keeping forest and once in place */
+        t8_forest_ref (forest);
+        t8_forest_init (&forest_batch);
+        t8_forest_set_adapt_batch (forest_batch, forest,
+                                   t8_test_adapt_batch_markers);
+        t8_forest_commit (forest_batch);
+        SC_CHECK_ABORT (t8_forest_is_equal (forest_batch, forest_single),
+                        "Batched adaptation does not match");
+        t8_forest_unref (&forest_batch);
+        t8_forest_init (&forest_batch);
+        t8_forest_set_adapt_batch (forest_batch, forest,
+                                   t8_test_adapt_batch_markers);
+        t8_forest_commit (forest_batch);
+        SC_CHECK_ABORT (t8_forest_is_equal (forest_batch, forest_single),
+                        "Batched in place adaptation does not match");
+        t8_forest_unref (&forest_single);
+        forest = forest_batch;
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the batched adapt callback.\n");
+  t8_test_adapt_batch (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the batched adapt callback.\n");
+  t8_global_productionf ("Testing the adaptation by markers.\n");
+  t8_test_adapt_markers_uniform (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the adaptation by markers.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+
+/*
+ * In this file we test the in place adaptation of a forest.
+ * If the source forest of an adapt is owned exclusively by the new forest,
+ * its elements are adapted in place. Otherwise they are copied.
+ * We adapt the same forest in both ways and check that the results
+ * are equal. We also compare with the thread parallel adaptation.
+ * Copied and partitioned forests share the elements of their trees with the
+ * source forest, we check that the shared elements are copied before the
+ * source forest is adapted in place.
+ */
+
+#define T8_TEST_ADAPT_IN_PLACE_MAXLEVEL 4
+
+/* Coarsen every family starting at an element id divisible by 3 and
+ * refine every element with an odd element id. */
+static int
+t8_test_adapt_in_place_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                              t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                              t8_eclass_scheme_c * ts, int num_elements,
+                              t8_element_t * elements[])
+{
+  if (num_elements > 1 && lelement_id % 3 == 0) {
+    return -1;
+  }
+  return lelement_id % 2 == 1 && ts->t8_element_level (elements[0])
+    < T8_TEST_ADAPT_IN_PLACE_MAXLEVEL;
+}
+
+/* Adapt a forest with t8_test_adapt_in_place_adapt */
+static              t8_forest_t
+t8_test_adapt_in_place_step (t8_forest_t forest_from, int threaded)
+{
+  t8_forest_t         forest;
+
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_from, t8_test_adapt_in_place_adapt, 0);
+  t8_forest_set_adapt_threaded (forest, threaded);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+static void
+t8_test_adapt_in_place (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_copy, forest_threaded;
+  int                 eclass, level, istep;
+  const int           num_steps = 3;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < 3; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      for (istep = 0; istep < num_steps; ++istep) {
+        /* Keep forest alive, such that its elements are copied */
+        t8_forest_ref (forest);
+        forest_copy = t8_test_adapt_in_place_step (forest, 0);
+        t8_forest_ref (forest);
+        forest_threaded = t8_test_adapt_in_place_step (forest, 1);
+        /* Now forest is only owned by the new forest and adapted in place */
+        forest = t8_test_adapt_in_place_step (forest, 0);
+        SC_CHECK_ABORT (t8_forest_is_equal (forest, forest_copy),
+                        "In place adapted forest does not match");
+        SC_CHECK_ABORT (t8_forest_is_equal (forest_threaded, forest_copy),
+                        "Thread parallel adapted forest does not match");
+        t8_forest_unref (&forest_copy);
+        t8_forest_unref (&forest_threaded);
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+static void
+t8_test_adapt_in_place_shared (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_copy, forest_partition, forest_check;
+  t8_locidx_t         itree;
+  int                 eclass;
+  const int           level = 2;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing shared trees with eclass %s\n",
+               t8_eclass_to_string[eclass]);
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    scheme, level, 0, comm);
+    /* Derive a copy and a partitioned forest, both keep forest alive */
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_copy);
+    t8_forest_set_copy (forest_copy, forest);
+    t8_forest_commit (forest_copy);
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest_copy);
+         ++itree) {
+      SC_CHECK_ABORT (t8_forest_get_tree (forest_copy, itree)->shared != NULL
+                      && t8_forest_get_tree (forest_copy, itree)->shared ==
+                      t8_forest_get_tree (forest, itree)->shared,
+                      "The copied forest does not share its trees");
+    }
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_partition);
+    t8_forest_set_partition (forest_partition, forest, 0);
+    t8_forest_commit (forest_partition);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_partition, forest),
+                    "Partitioned forest does not match");
+    t8_scheme_cxx_ref (scheme);
+    forest_check = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                          ((t8_eclass_t) eclass, comm, 0, 0,
+                                           0), scheme, level, 0, comm);
+    /* Now forest is only owned by the new forest and adapted in place */
+    forest = t8_test_adapt_in_place_step (forest, 0);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_copy, forest_check),
+                    "Shared elements of the copy were modified");
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_partition, forest_check),
+                    "Shared elements of the partition were modified");
+    t8_forest_unref (&forest);
+    t8_forest_unref (&forest_copy);
+    t8_forest_unref (&forest_partition);
+    t8_forest_unref (&forest_check);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the in place adaptation of forests.\n");
+  t8_test_adapt_in_place (sc_MPI_COMM_WORLD);
+  t8_test_adapt_in_place_shared (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the in place adaptation.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the runs of changed elements that are recorded
+ * during adaptation. We check that the runs cover all old and new elements
+ * in order and that they match the elements of both forests.
+ * The runs of the in place, the copying and the thread parallel adaptation
+ * must be the same.
+ */
+
+#define T8_TEST_ADAPT_RUNS_MAXLEVEL 4
+
+/* Coarsen every family starting at an element id divisible by 3 and
+ * refine every element with an odd element id. */
+static int
+t8_test_adapt_runs_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                          t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                          t8_eclass_scheme_c * ts, int num_elements,
+                          t8_element_t * elements[])
+{
+  int                 level = ts->t8_element_level (elements[0]);
+
+  if (num_elements > 1 && lelement_id % 3 == 0 && level > 1) {
+    return -1;
+  }
+  return lelement_id % 2 == 1 && level < T8_TEST_ADAPT_RUNS_MAXLEVEL;
+}
+
+/* Adapt a forest with t8_test_adapt_runs_adapt and record the runs */
+static              t8_forest_t
+t8_test_adapt_runs_step (t8_forest_t forest_from, int recursive,
+                         int threaded)
+{
+  t8_forest_t         forest;
+
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_from, t8_test_adapt_runs_adapt,
+                       recursive);
+  t8_forest_set_adapt_threaded (forest, threaded);
+  t8_forest_set_adapt_record_runs (forest, 1);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+/* Return the level of a local element of a forest */
+static int
+t8_test_adapt_runs_level (t8_forest_t forest, t8_locidx_t lelement_id)
+{
+  t8_element_t       *element;
+  t8_locidx_t         ltree_id;
+
+  element = t8_forest_get_element (forest, lelement_id, &ltree_id);
+  return t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                ltree_id))->
+    t8_element_level (element);
+}
+
+/* Check that the runs of forest describe its adaptation from forest_from */
+static void
+t8_test_adapt_runs_check (t8_forest_t forest, t8_forest_t forest_from)
+{
+  const t8_forest_adapt_run_t *runs;
+  t8_locidx_t         num_runs, irun, ielem, next_old, next_new;
+  t8_locidx_t         ltree_id, ltree_id_from;
+  t8_element_t       *element, *element_from;
+  t8_eclass_scheme_c *ts;
+
+  runs = t8_forest_get_adapt_runs (forest, &num_runs);
+  SC_CHECK_ABORT (runs != NULL || t8_forest_get_local_num_elements (forest)
+                  == 0, "No runs were recorded");
+  next_old = next_new = 0;
+  for (irun = 0; irun < num_runs; irun++) {
+    SC_CHECK_ABORT (runs[irun].first_old == next_old
+                    && runs[irun].first_new == next_new,
+                    "Runs are not contiguous");
+    SC_CHECK_ABORT (runs[irun].num_old > 0 && runs[irun].num_new > 0,
+                    "Empty run");
+    switch (runs[irun].kind) {
+    case T8_FOREST_ADAPT_UNCHANGED:
+      SC_CHECK_ABORT (runs[irun].num_old == runs[irun].num_new,
+                      "Unchanged run changes the number of elements");
+      for (ielem = 0; ielem < runs[irun].num_old; ielem++) {
+        element = t8_forest_get_element (forest, next_new + ielem, &ltree_id);
+        element_from = t8_forest_get_element (forest_from, next_old + ielem,
+                                              &ltree_id_from);
+        ts = t8_forest_get_eclass_scheme (forest,
+                                          t8_forest_get_tree_class (forest,
+                                                                    ltree_id));
+        SC_CHECK_ABORT (ltree_id == ltree_id_from
+                        && !ts->t8_element_compare (element, element_from),
+                        "Unchanged run changes an element");
+      }
+      break;
+    case T8_FOREST_ADAPT_REFINED:
+      SC_CHECK_ABORT (runs[irun].num_new > runs[irun].num_old
+                      && t8_test_adapt_runs_level (forest, next_new)
+                      > t8_test_adapt_runs_level (forest_from, next_old),
+                      "Refined run does not refine");
+      SC_CHECK_ABORT (runs[irun].num_new
+                      == runs[irun].num_old * runs[irun].num_per_element,
+                      "Wrong number of new elements per refined element");
+      break;
+    case T8_FOREST_ADAPT_COARSENED:
+      SC_CHECK_ABORT (runs[irun].num_new < runs[irun].num_old
+                      && t8_test_adapt_runs_level (forest, next_new)
+                      < t8_test_adapt_runs_level (forest_from, next_old),
+                      "Coarsened run does not coarsen");
+      SC_CHECK_ABORT (runs[irun].num_old
+                      == runs[irun].num_new * runs[irun].num_per_element,
+                      "Wrong number of old elements per coarsened element");
+      break;
+    default:
+      SC_ABORT ("Invalid kind of run");
+    }
+    next_old += runs[irun].num_old;
+    next_new += runs[irun].num_new;
+  }
+  SC_CHECK_ABORT (next_old == t8_forest_get_local_num_elements (forest_from)
+                  && next_new == t8_forest_get_local_num_elements (forest),
+                  "Runs do not cover all elements");
+}
+
+/* Check that two forests recorded the same runs */
+static void
+t8_test_adapt_runs_compare (t8_forest_t forest_a, t8_forest_t forest_b)
+{
+  const t8_forest_adapt_run_t *runs_a, *runs_b;
+  t8_locidx_t         num_runs_a, num_runs_b, irun;
+
+  runs_a = t8_forest_get_adapt_runs (forest_a, &num_runs_a);
+  runs_b = t8_forest_get_adapt_runs (forest_b, &num_runs_b);
+  SC_CHECK_ABORT (num_runs_a == num_runs_b, "Number of runs does not match");
+  for (irun = 0; irun < num_runs_a; irun++) {
+    SC_CHECK_ABORT (runs_a[irun].kind == runs_b[irun].kind
+                    && runs_a[irun].first_old == runs_b[irun].first_old
+                    && runs_a[irun].num_old == runs_b[irun].num_old
+                    && runs_a[irun].first_new == runs_b[irun].first_new
+                    && runs_a[irun].num_new == runs_b[irun].num_new,
+                    "Runs do not match");
+  }
+}
+
+static void
+t8_test_adapt_runs (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_copy, forest_threaded, forest_rec;
+  int                 eclass, level, istep;
+  const int           num_steps = 3;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < 3; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      for (istep = 0; istep < num_steps; ++istep) {
+        /* Keep forest alive, such that we can compare with it */
+        t8_forest_ref (forest);
+        forest_copy = t8_test_adapt_runs_step (forest, 0, 0);
+        t8_test_adapt_runs_check (forest_copy, forest);
+        t8_forest_ref (forest);
+        forest_threaded = t8_test_adapt_runs_step (forest, 0, 1);
+        t8_test_adapt_runs_compare (forest_threaded, forest_copy);
+        t8_forest_ref (forest);
+        forest_rec = t8_test_adapt_runs_step (forest, 1, 0);
+        t8_test_adapt_runs_check (forest_rec, forest);
+        t8_forest_unref (&forest_rec);
+        /* Now forest is only owned by the new forest and adapted in place */
+        forest = t8_test_adapt_runs_step (forest, 0, 0);
+        t8_test_adapt_runs_compare (forest, forest_copy);
+        t8_forest_unref (&forest_copy);
+        t8_forest_unref (&forest_threaded);
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the recorded runs of adapted forests.\n");
+  t8_test_adapt_runs (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the recorded runs.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the balance of edge and corner neighbors.
+ * We refine a uniform forest towards the center of its trees and balance
+ * it. Then we check for each pair of local leaves in the same tree that
+ * share a corner, or an edge, that their levels differ by at most one.
+ */
+
+#define T8_TEST_BALANCE_CORNER_MAXLEVEL 5
+
+/* Refine all elements that have the center of the tree as a corner */
+static int
+t8_test_balance_corner_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                              t8_locidx_t which_tree,
+                              t8_locidx_t lelement_id,
+                              t8_eclass_scheme_c * ts, int num_elements,
+                              t8_element_t * elements[])
+{
+  int                 coords[3] = { 0, 0, 0 };
+  int                 idim;
+
+  if (ts->t8_element_level (elements[0]) >= T8_TEST_BALANCE_CORNER_MAXLEVEL) {
+    return 0;
+  }
+  for (idim = 0; idim < t8_eclass_to_dimension[ts->eclass]; idim++) {
+    coords[idim] = ts->t8_element_root_len (elements[0]) / 2;
+  }
+  return ts->t8_element_find_vertex (elements[0], coords) >= 0;
+}
+
+/* Return the number of corners that two elements share */
+static int
+t8_test_balance_corner_num_shared (t8_eclass_scheme_c * ts,
+                                   const t8_element_t * elem_a,
+                                   const t8_element_t * elem_b)
+{
+  int                 coords[3];
+  int                 icorner, num_shared = 0;
+
+  for (icorner = 0; icorner < ts->t8_element_num_corners (elem_a);
+       icorner++) {
+    coords[0] = coords[1] = coords[2] = 0;
+    ts->t8_element_vertex_coords (elem_a, icorner, coords);
+    num_shared += ts->t8_element_find_vertex (elem_b, coords) >= 0;
+  }
+  return num_shared;
+}
+
+/* Check that no local leaf has a corner of another local leaf in the
+ * same tree as a corner and a level larger than the other leaf's level + 1.
+ * If min_shared is 2, we only consider pairs of leaves such that the
+ * ancestor of the finer leaf at the level of the coarser leaf shares an
+ * edge with the coarser leaf. */
+static void
+t8_test_balance_corner_check (t8_forest_t forest, int min_shared)
+{
+  t8_locidx_t         itree, ielem, jelem, num_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *elem_a, *elem_b, *ancestor;
+  int                 level_a, level_b, ilevel;
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    ts->t8_element_new (1, &ancestor);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      elem_a = t8_forest_get_element_in_tree (forest, itree, ielem);
+      level_a = ts->t8_element_level (elem_a);
+      for (jelem = 0; jelem < num_elements; jelem++) {
+        elem_b = t8_forest_get_element_in_tree (forest, itree, jelem);
+        level_b = ts->t8_element_level (elem_b);
+        if (level_b < level_a + 2
+            || t8_test_balance_corner_num_shared (ts, elem_a, elem_b) == 0) {
+          continue;
+        }
+        if (min_shared > 1) {
+          ts->t8_element_copy (elem_b, ancestor);
+          for (ilevel = level_b; ilevel > level_a; ilevel--) {
+            ts->t8_element_parent (ancestor, ancestor);
+          }
+          if (t8_test_balance_corner_num_shared (ts, elem_a, ancestor)
+              < min_shared) {
+            continue;
+          }
+        }
+        SC_ABORTF ("Leaves %li and %li of tree %li are not balanced",
+                   (long) ielem, (long) jelem, (long) itree);
+      }
+    }
+    ts->t8_element_destroy (1, &ancestor);
+  }
+}
+
+static void
+t8_test_balance_corner (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt, forest_balance;
+  t8_gloidx_t         num_face_balanced;
+  int                 eclass, balance_type;
+
+  for (eclass = T8_ECLASS_QUAD; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The children of a pyramid have different shapes */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    scheme, 1, 0, comm);
+    forest_adapt =
+      t8_forest_new_adapt (forest, t8_test_balance_corner_adapt, 1, 0, NULL);
+    num_face_balanced = 0;
+    for (balance_type = T8_GHOST_FACES; balance_type <= T8_GHOST_VERTICES;
+         balance_type++) {
+      t8_forest_ref (forest_adapt);
+      t8_forest_init (&forest_balance);
+      t8_forest_set_balance (forest_balance, forest_adapt, 1);
+      t8_forest_set_balance_type (forest_balance,
+                                  (t8_ghost_type_t) balance_type);
+      t8_forest_commit (forest_balance);
+      if (balance_type == T8_GHOST_FACES) {
+        num_face_balanced =
+          t8_forest_get_global_num_elements (forest_balance);
+      }
+      else {
+        /* Balancing more neighbors can only refine more elements */
+        SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_balance)
+                        >= num_face_balanced,
+                        "Corner balance has fewer elements than face balance");
+        t8_test_balance_corner_check (forest_balance,
+                                      balance_type == T8_GHOST_EDGES ? 2 : 1);
+      }
+      t8_forest_unref (&forest_balance);
+    }
+    t8_forest_unref (&forest_adapt);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the corner balance.\n");
+  t8_test_balance_corner (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the corner balance.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
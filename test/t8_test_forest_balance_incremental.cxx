@@ -0,0 +1,159 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_balance.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the incremental balance check that only checks
+ * the elements that changed during adaptation.
+ * Starting from a uniform forest, we refine some elements once, which
+ * keeps the forest balanced, and then refine some of the new elements
+ * again, which may violate the balance.
+ * In both cases the result must match the check of all elements.
+ */
+
+/* Refine the first element of each local tree */
+static int
+t8_test_refine_first (t8_forest_t forest, t8_forest_t forest_from,
+                      t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                      t8_eclass_scheme_c * ts, int num_elements,
+                      t8_element_t * elements[])
+{
+  return lelement_id == 0;
+}
+
+/* Refine the last child of each family of the finest level */
+static int
+t8_test_refine_last (t8_forest_t forest, t8_forest_t forest_from,
+                     t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                     t8_eclass_scheme_c * ts, int num_elements,
+                     t8_element_t * elements[])
+{
+  int                 level = ts->t8_element_level (elements[0]);
+  int                 num_children;
+
+  if (level <= 1) {
+    return 0;
+  }
+  num_children = ts->t8_element_num_siblings (elements[0]);
+  return ts->t8_element_child_id (elements[0]) == num_children - 1
+    && level == *(int *) t8_forest_get_user_data (forest);
+}
+
+/* Adapt a forest, record the changed elements and create a ghost layer */
+static              t8_forest_t
+t8_test_balance_incremental_adapt (t8_forest_t forest_from,
+                                   t8_forest_adapt_t adapt_fn, int *level)
+{
+  t8_forest_t         forest;
+
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_from, adapt_fn, 0);
+  t8_forest_set_user_data (forest, level);
+  t8_forest_set_adapt_record_runs (forest, 1);
+  t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+/* Return true if all processes' local elements are balanced */
+static int
+t8_test_balance_incremental_full (t8_forest_t forest)
+{
+  int                 is_balanced, is_balanced_global, mpiret;
+
+  is_balanced = t8_forest_is_balanced (forest);
+  mpiret = sc_MPI_Allreduce (&is_balanced, &is_balanced_global, 1,
+                             sc_MPI_INT, sc_MPI_LAND,
+                             t8_forest_get_mpicomm (forest));
+  SC_CHECK_MPI (mpiret);
+  return is_balanced_global;
+}
+
+static void
+t8_test_balance_incremental (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_first, forest_last;
+  int                 eclass, level, fine_level;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The children of a pyramid have different shapes */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 1; level < 3; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      /* Refining elements of a uniform forest once keeps it balanced */
+      forest_first =
+        t8_test_balance_incremental_adapt (forest, t8_test_refine_first,
+                                           NULL);
+      SC_CHECK_ABORT (t8_forest_is_balanced_incremental (forest_first),
+                      "Refined uniform forest is not balanced");
+      SC_CHECK_ABORT (t8_test_balance_incremental_full (forest_first),
+                      "Refined uniform forest is not balanced");
+      /* Refining the new elements again may violate the balance */
+      fine_level = level + 1;
+      forest_last =
+        t8_test_balance_incremental_adapt (forest_first, t8_test_refine_last,
+                                           &fine_level);
+      SC_CHECK_ABORT (t8_forest_is_balanced_incremental (forest_last)
+                      == t8_test_balance_incremental_full (forest_last),
+                      "Incremental balance check does not match the "
+                      "full check");
+      t8_forest_unref (&forest_last);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the incremental balance check.\n");
+  t8_test_balance_incremental (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the incremental balance check.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
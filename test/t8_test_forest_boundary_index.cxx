@@ -0,0 +1,172 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the boundary index of a forest.
+ * For each face of each local tree we compare the indexed leaves with the
+ * leaves that we find by testing each face of each leaf of the tree.
+ * The index is built once from scratch for a uniform forest and then
+ * updated along two adaptations.
+ */
+
+/* Refine every third element up to level 3 */
+static int
+t8_test_boundary_index_refine (t8_forest_t forest, t8_forest_t forest_from,
+                               t8_locidx_t which_tree,
+                               t8_locidx_t lelement_id,
+                               t8_eclass_scheme_c * ts, int num_elements,
+                               t8_element_t * elements[])
+{
+  return lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) < 3;
+}
+
+/* Coarsen every second family */
+static int
+t8_test_boundary_index_coarsen (t8_forest_t forest, t8_forest_t forest_from,
+                                t8_locidx_t which_tree,
+                                t8_locidx_t lelement_id,
+                                t8_eclass_scheme_c * ts, int num_elements,
+                                t8_element_t * elements[])
+{
+  return num_elements > 1 && lelement_id % 2 == 0 ? -1 : 0;
+}
+
+static void
+t8_test_boundary_index_check (t8_forest_t forest)
+{
+  t8_cmesh_t          cmesh = t8_forest_get_cmesh (forest);
+  t8_locidx_t         itree, ielem, num_elements, num_leaves, ileaf;
+  const t8_locidx_t  *leaves;
+  const int          *faces;
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  int                 tree_face, iface, num_faces, is_boundary;
+
+  SC_CHECK_ABORT (t8_forest_has_boundary_index (forest),
+                  "Forest has no boundary index");
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (tree_face = 0; tree_face < T8_ECLASS_MAX_FACES; tree_face++) {
+      num_leaves = t8_forest_get_boundary_leaves (forest, itree, tree_face,
+                                                  &leaves, &faces);
+      is_boundary = tree_face < t8_eclass_num_faces[tree_class]
+        && t8_cmesh_tree_face_is_boundary (cmesh,
+                                           t8_forest_ltreeid_to_cmesh_ltreeid
+                                           (forest, itree), tree_face);
+      ileaf = 0;
+      for (ielem = 0; ielem < num_elements && is_boundary; ielem++) {
+        element = t8_forest_get_element_in_tree (forest, itree, ielem);
+        num_faces = ts->t8_element_num_faces (element);
+        for (iface = 0; iface < num_faces; iface++) {
+          if (ts->t8_element_is_root_boundary (element, iface)
+              && ts->t8_element_tree_face (element, iface) == tree_face) {
+            SC_CHECK_ABORTF (ileaf < num_leaves && leaves[ileaf] == ielem
+                             && faces[ileaf] == iface,
+                             "Face %i of leaf %i is missing in the boundary "
+                             "index of tree %i face %i", iface, ielem,
+                             itree, tree_face);
+            ileaf++;
+          }
+        }
+      }
+      SC_CHECK_ABORTF (ileaf == num_leaves, "Tree %i face %i has %i leaves "
+                       "in its boundary index instead of %i", itree,
+                       tree_face, num_leaves, ileaf);
+    }
+  }
+}
+
+static void
+t8_test_boundary_index (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  int                 eclass, level;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* Face neighbors of pyramids are not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < 3; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_boundary_index (forest, 1);
+      t8_forest_commit (forest);
+      t8_test_boundary_index_check (forest);
+
+      /* The index of an adapted forest is updated from forest */
+      t8_forest_init (&forest_adapt);
+      t8_forest_set_adapt (forest_adapt, forest,
+                           t8_test_boundary_index_refine, 1);
+      t8_forest_set_boundary_index (forest_adapt, 1);
+      t8_forest_commit (forest_adapt);
+      t8_test_boundary_index_check (forest_adapt);
+
+      forest = forest_adapt;
+      t8_forest_init (&forest_adapt);
+      t8_forest_set_adapt (forest_adapt, forest,
+                           t8_test_boundary_index_coarsen, 0);
+      t8_forest_set_boundary_index (forest_adapt, 1);
+      t8_forest_commit (forest_adapt);
+      t8_test_boundary_index_check (forest_adapt);
+      t8_forest_unref (&forest_adapt);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest boundary index.\n");
+  t8_test_boundary_index (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the forest boundary index.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -86,6 +86,24 @@ t8_test_forest_commit_abp (t8_forest_t forest, int maxlevel)
   return forest_ada_bal_par;
 }
 
+/* adapt, balance and partition a given forest in one step and only
+ * partition the balanced forest */
+static              t8_forest_t
+t8_test_forest_commit_abp_once (t8_forest_t forest, int maxlevel)
+{
+  t8_forest_t         forest_ada_bal_par;
+
+  t8_forest_init (&forest_ada_bal_par);
+  t8_forest_set_user_data (forest_ada_bal_par, &maxlevel);
+  t8_forest_set_adapt (forest_ada_bal_par, forest, t8_test_adapt_balance, 1);
+  t8_forest_set_balance (forest_ada_bal_par, NULL, 0);
+  t8_forest_set_balance_repartition_once (forest_ada_bal_par, 1);
+  t8_forest_set_partition (forest_ada_bal_par, NULL, 0);
+  t8_forest_commit (forest_ada_bal_par);
+
+  return forest_ada_bal_par;
+}
+
 /* adapt, balance and partition a given forest in 3 steps */
 static              t8_forest_t
 t8_test_forest_commit_abp_3step (t8_forest_t forest, int maxlevel)
@@ -118,6 +136,7 @@ t8_test_forest_commit (int cmesh_id)
   int                 level, min_level, maxlevel;
   t8_cmesh_t          cmesh;
   t8_forest_t         forest, forest_ada_bal_part, forest_abp_3part;
+  t8_forest_t         forest_abp_once;
   t8_scheme_cxx_t    *scheme;
 
   scheme = t8_scheme_new_default_cxx ();
@@ -135,12 +154,15 @@ t8_test_forest_commit (int cmesh_id)
     /* Create a uniformly refined forest */
     forest = t8_forest_new_uniform (cmesh, scheme, level, 1,
                                     sc_MPI_COMM_WORLD);
-    /* We need to use forest twice, so we ref it */
+    /* We need to use forest three times, so we ref it */
+    t8_forest_ref (forest);
     t8_forest_ref (forest);
     /* Adapt, balance and partition the forest */
     forest_ada_bal_part = t8_test_forest_commit_abp (forest, maxlevel);
     /* Adapt, balance and partition the forest using three seperate steps */
     forest_abp_3part = t8_test_forest_commit_abp_3step (forest, maxlevel);
+    /* Adapt, balance and partition the forest with one partition */
+    forest_abp_once = t8_test_forest_commit_abp_once (forest, maxlevel);
 /*
         if (ctype != 2) {
           t8_forest_write_vtk (forest_ada_bal_part, "test_1step");
@@ -150,9 +172,13 @@ t8_test_forest_commit (int cmesh_id)
     SC_CHECK_ABORT (t8_forest_is_equal
                     (forest_abp_3part, forest_ada_bal_part),
                     "The forests are not equal");
+    SC_CHECK_ABORT (t8_forest_is_equal
+                    (forest_abp_once, forest_ada_bal_part),
+                    "The forests are not equal");
     t8_scheme_cxx_ref (scheme);
     t8_forest_unref (&forest_ada_bal_part);
     t8_forest_unref (&forest_abp_3part);
+    t8_forest_unref (&forest_abp_once);
 
   }
   t8_scheme_cxx_unref (&scheme);
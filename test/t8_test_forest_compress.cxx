@@ -0,0 +1,230 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_ghost.h>
+
+/*
+ * In this file we test the compressed element storage of a forest.
+ * We build a compressed copy of a uniform forest, check that the
+ * elements are decoded correctly on access, and that a forest derived
+ * from a compressed forest has the same elements as the original one.
+ * We also check that a forest that is partitioned and gets a ghost layer
+ * with compressed messages has the same elements and ghosts as with the
+ * uncompressed messages.
+ */
+
+/* Check whether two forests have the same local elements */
+static void
+test_forest_compress_compare (t8_forest_t forest_a, t8_forest_t forest_b)
+{
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *elem_a, *elem_b;
+
+  SC_CHECK_ABORT (t8_forest_get_num_local_trees (forest_a) ==
+                  t8_forest_get_num_local_trees (forest_b),
+                  "Number of local trees differ");
+  SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_a) ==
+                  t8_forest_get_local_num_elements (forest_b),
+                  "Number of local elements differ");
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest_a); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest_a,
+                                      t8_forest_get_tree_class (forest_a,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest_a, itree);
+    SC_CHECK_ABORT (num_elements ==
+                    t8_forest_get_tree_num_elements (forest_b, itree),
+                    "Number of tree elements differ");
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      elem_a = t8_forest_get_element_in_tree (forest_a, itree, ielem);
+      elem_b = t8_forest_get_element_in_tree (forest_b, itree, ielem);
+      SC_CHECK_ABORT (!ts->t8_element_compare (elem_a, elem_b),
+                      "Decompressed element differs from original");
+      SC_CHECK_ABORT (ts->t8_element_level (elem_a) ==
+                      ts->t8_element_level (elem_b),
+                      "Decompressed element level differs from original");
+    }
+  }
+}
+
+/* Refine every second element of the first local tree, such that the
+ * repartition moves elements between the processes */
+static int
+test_forest_compress_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                            t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                            t8_eclass_scheme_c * ts, int num_elements,
+                            t8_element_t * elements[])
+{
+  return which_tree == 0 && lelement_id % 2 == 0;
+}
+
+/* Adapt and partition a forest and build its ghost layer */
+static t8_forest_t
+test_forest_compress_repartition (t8_forest_t forest_from, int compress)
+{
+  t8_forest_t         forest;
+
+  t8_forest_ref (forest_from);
+  t8_forest_init (&forest);
+  t8_forest_set_adapt (forest, forest_from, test_forest_compress_adapt, 0);
+  t8_forest_set_partition (forest, NULL, 0);
+  t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+  t8_forest_set_compress_messages (forest, compress);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+/* Check whether two forests have the same ghost elements */
+static void
+test_forest_compress_compare_ghosts (t8_forest_t forest_a,
+                                     t8_forest_t forest_b)
+{
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *elem_a, *elem_b;
+
+  SC_CHECK_ABORT (t8_forest_ghost_num_trees (forest_a) ==
+                  t8_forest_ghost_num_trees (forest_b),
+                  "Number of ghost trees differ");
+  for (itree = 0; itree < t8_forest_ghost_num_trees (forest_a); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest_a,
+                                      t8_forest_ghost_get_tree_class
+                                      (forest_a, itree));
+    num_elements = t8_forest_ghost_tree_num_elements (forest_a, itree);
+    SC_CHECK_ABORT (num_elements ==
+                    t8_forest_ghost_tree_num_elements (forest_b, itree),
+                    "Number of ghost tree elements differ");
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      elem_a = t8_forest_ghost_get_element (forest_a, itree, ielem);
+      elem_b = t8_forest_ghost_get_element (forest_b, itree, ielem);
+      SC_CHECK_ABORT (!ts->t8_element_compare (elem_a, elem_b)
+                      && ts->t8_element_level (elem_a) ==
+                      ts->t8_element_level (elem_b),
+                      "Decoded ghost differs from original");
+    }
+  }
+}
+
+static void
+test_forest_compress_messages (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_plain, forest_compressed;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The ghost layer of pyramids is not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      t8_scheme_cxx_ref (ts);
+      forest =
+        t8_forest_new_uniform (t8_cmesh_new_hypercube
+                               ((t8_eclass_t) eclass, comm, 0, 0, 0), ts,
+                               level, 0, comm);
+      forest_plain = test_forest_compress_repartition (forest, 0);
+      forest_compressed = test_forest_compress_repartition (forest, 1);
+      test_forest_compress_compare (forest_plain, forest_compressed);
+      test_forest_compress_compare_ghosts (forest_plain, forest_compressed);
+      t8_forest_unref (&forest_plain);
+      t8_forest_unref (&forest_compressed);
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+static void
+test_forest_compress (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_compressed, forest_copy;
+  int                 eclass, level;
+  int                 maxlevel = 4;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      t8_scheme_cxx_ref (ts);
+      forest =
+        t8_forest_new_uniform (t8_cmesh_new_from_class
+                               ((t8_eclass_t) eclass, comm), ts, level, 0,
+                               comm);
+      /* Create a compressed copy of forest */
+      t8_forest_ref (forest);
+      t8_forest_init (&forest_compressed);
+      t8_forest_set_copy (forest_compressed, forest);
+      t8_forest_set_compress (forest_compressed, 1);
+      t8_forest_commit (forest_compressed);
+      SC_CHECK_ABORT (t8_forest_is_compressed (forest_compressed),
+                      "Forest was not compressed");
+      /* Decode the elements on access */
+      test_forest_compress_compare (forest, forest_compressed);
+
+      /* Derive a forest from the compressed forest */
+      t8_forest_compress (forest_compressed);
+      t8_forest_init (&forest_copy);
+      t8_forest_set_copy (forest_copy, forest_compressed);
+      t8_forest_commit (forest_copy);
+      SC_CHECK_ABORT (!t8_forest_is_compressed (forest_copy),
+                      "Forest was compressed");
+      test_forest_compress_compare (forest, forest_copy);
+
+      t8_forest_unref (&forest_copy);
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing compressed forest storage.\n");
+  test_forest_compress (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing compressed forest storage.\n");
+  t8_global_productionf ("Testing compressed forest messages.\n");
+  test_forest_compress_messages (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing compressed forest messages.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,284 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test that the element data fields of a forest follow its
+ * adaptation and partition.
+ * We store the x coordinate of the centroid of each element of a uniform
+ * level 1 forest, refine the elements left of x = 0.5, partition the forest
+ * and coarsen all families again. The children inherit the entry of their
+ * parent and a coarsened family stores the average of its entries, such that
+ * each element stores the x coordinate of the centroid of its level 1
+ * ancestor.
+ * We repeat this with refining and coarsening all elements, such that
+ * the refined elements and coarsened families are adjacent, once while the
+ * original forest is still referenced and once while it is not, which
+ * adapts it in place. At last, we refine the elements at the origin
+ * recursively and balance the forest.
+ */
+
+static double
+t8_test_forest_data_expected (t8_forest_t forest, t8_locidx_t itree,
+                              t8_eclass_scheme_c * ts,
+                              const t8_element_t * element)
+{
+  t8_element_t       *ancestor;
+  double              centroid[3];
+
+  ts->t8_element_new (1, &ancestor);
+  ts->t8_element_copy (element, ancestor);
+  while (ts->t8_element_level (ancestor) > 1) {
+    ts->t8_element_parent (ancestor, ancestor);
+  }
+  t8_forest_element_centroid (forest, itree, ancestor,
+                              t8_forest_get_tree_vertices (forest, itree),
+                              centroid);
+  ts->t8_element_destroy (1, &ancestor);
+  return centroid[0];
+}
+
+static void
+t8_test_forest_data_check (t8_forest_t forest)
+{
+  t8_eclass_scheme_c *ts;
+  const t8_element_t *element;
+  const double       *field;
+  t8_locidx_t         itree, ielem, lelement = 0;
+
+  SC_CHECK_ABORT (t8_forest_data_get_num_fields (forest) == 1,
+                  "Wrong number of fields");
+  field = (const double *) t8_forest_data_get_field (forest, 0);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      SC_CHECK_ABORT (fabs (field[lelement] -
+                            t8_test_forest_data_expected (forest, itree, ts,
+                                                          element)) < 1e-12,
+                      "Wrong element data");
+    }
+  }
+}
+
+static int
+t8_test_forest_data_refine (t8_forest_t forest, t8_forest_t forest_from,
+                            t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                            t8_eclass_scheme_c * ts, int num_elements,
+                            t8_element_t * elements[])
+{
+  double              centroid[3];
+
+  t8_forest_element_centroid (forest_from, which_tree, elements[0],
+                              t8_forest_get_tree_vertices (forest_from,
+                                                           which_tree),
+                              centroid);
+  return ts->t8_element_level (elements[0]) < 2 && centroid[0] < 0.5;
+}
+
+static int
+t8_test_forest_data_coarsen (t8_forest_t forest, t8_forest_t forest_from,
+                             t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                             t8_eclass_scheme_c * ts, int num_elements,
+                             t8_element_t * elements[])
+{
+  return num_elements > 1 && ts->t8_element_level (elements[0]) > 1 ? -1 : 0;
+}
+
+static int
+t8_test_forest_data_refine_all (t8_forest_t forest, t8_forest_t forest_from,
+                                t8_locidx_t which_tree,
+                                t8_locidx_t lelement_id,
+                                t8_eclass_scheme_c * ts, int num_elements,
+                                t8_element_t * elements[])
+{
+  return ts->t8_element_level (elements[0]) < 2;
+}
+
+/* Refine the elements that have a vertex at the origin up to level 4 */
+static int
+t8_test_forest_data_refine_origin (t8_forest_t forest,
+                                   t8_forest_t forest_from,
+                                   t8_locidx_t which_tree,
+                                   t8_locidx_t lelement_id,
+                                   t8_eclass_scheme_c * ts,
+                                   int num_elements,
+                                   t8_element_t * elements[])
+{
+  double              coords[3];
+  int                 icorner;
+
+  if (ts->t8_element_level (elements[0]) >= 4) {
+    return 0;
+  }
+  for (icorner = 0; icorner < ts->t8_element_num_corners (elements[0]);
+       icorner++) {
+    t8_forest_element_coordinate (forest_from, which_tree, elements[0],
+                                  t8_forest_get_tree_vertices (forest_from,
+                                                               which_tree),
+                                  icorner, coords);
+    if (fabs (coords[0]) + fabs (coords[1]) + fabs (coords[2]) < 1e-12) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Store the average of the entries of a family in its parent */
+static void
+t8_test_forest_data_average (const void *data_old, t8_locidx_t num_old,
+                             void *data_new, void *user)
+{
+  const double       *old_values = (const double *) data_old;
+  double              sum = 0;
+  t8_locidx_t         iold;
+
+  for (iold = 0; iold < num_old; iold++) {
+    sum += old_values[iold];
+  }
+  *(double *) data_new = sum / num_old;
+}
+
+/* Adapt a forest and check the data of the adapted forest.
+ * If keep is true, we keep a reference to the original forest, such that it
+ * is not adapted in place, and check that its data did not change. */
+static t8_forest_t
+t8_test_forest_data_adapt (t8_forest_t forest, t8_forest_adapt_t adapt_fn,
+                           int keep)
+{
+  t8_forest_t         forest_adapt;
+
+  if (keep) {
+    t8_forest_ref (forest);
+  }
+  forest_adapt = t8_forest_new_adapt (forest, adapt_fn, 0, 0, NULL);
+  t8_test_forest_data_check (forest_adapt);
+  if (keep) {
+    t8_test_forest_data_check (forest);
+    t8_forest_unref (&forest);
+  }
+  return forest_adapt;
+}
+
+static void
+t8_test_forest_data (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_partition, forest_balance;
+  const t8_eclass_t   eclasses[3] =
+    { T8_ECLASS_QUAD, T8_ECLASS_TRIANGLE, T8_ECLASS_HEX };
+  double             *field;
+  double              centroid[3];
+  t8_locidx_t         itree, ielem, lelement;
+  int                 ieclass, keep;
+
+  for (ieclass = 0; ieclass < 3; ieclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclasses[ieclass]]);
+    t8_scheme_cxx_ref (ts);
+    forest =
+      t8_forest_new_uniform (t8_cmesh_new_hypercube
+                             (eclasses[ieclass], comm, 0, 0, 0), ts, 1, 0,
+                             comm);
+    /* Store the centroids of the level 1 elements */
+    t8_forest_data_add_field (forest, sizeof (double), NULL,
+                              t8_test_forest_data_average, NULL);
+    field = (double *) t8_forest_data_get_field (forest, 0);
+    for (itree = 0, lelement = 0;
+         itree < t8_forest_get_num_local_trees (forest); itree++) {
+      for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+           ielem++, lelement++) {
+        t8_forest_element_centroid (forest, itree,
+                                    t8_forest_get_element_in_tree (forest,
+                                                                   itree,
+                                                                   ielem),
+                                    t8_forest_get_tree_vertices (forest,
+                                                                 itree),
+                                    centroid);
+        field[lelement] = centroid[0];
+      }
+    }
+    t8_test_forest_data_check (forest);
+
+    forest = t8_test_forest_data_adapt (forest, t8_test_forest_data_refine, 0);
+
+    t8_forest_init (&forest_partition);
+    t8_forest_set_partition (forest_partition, forest, 0);
+    t8_forest_set_ghost (forest_partition, 1, T8_GHOST_FACES);
+    t8_forest_commit (forest_partition);
+    forest = forest_partition;
+    t8_test_forest_data_check (forest);
+
+    forest = t8_test_forest_data_adapt (forest, t8_test_forest_data_coarsen, 0);
+
+    /* Refine and coarsen adjacent elements, with and without
+     * adapting in place */
+    for (keep = 0; keep < 2; keep++) {
+      forest = t8_test_forest_data_adapt (forest,
+                                          t8_test_forest_data_refine_all,
+                                          keep);
+      forest = t8_test_forest_data_adapt (forest,
+                                          t8_test_forest_data_coarsen, keep);
+    }
+
+    /* Balance the forest after a recursive refinement. The local balance
+     * rounds adapt in place. */
+    t8_forest_init (&forest_balance);
+    t8_forest_set_adapt (forest_balance, forest,
+                         t8_test_forest_data_refine_origin, 1);
+    t8_forest_set_balance (forest_balance, NULL, 0);
+    t8_forest_commit (forest_balance);
+    forest = forest_balance;
+    t8_test_forest_data_check (forest);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing element data fields.\n");
+  t8_test_forest_data (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing element data fields.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
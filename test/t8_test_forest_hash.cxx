@@ -0,0 +1,163 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the content hashes of forests and coarse meshes.
+ * We adapt and partition two uniform forests in the same way. The first
+ * forest has its hashes computed before, such that they are maintained
+ * through adapt and partition, the hashes of the second forest are
+ * computed from scratch at the end. Both must agree.
+ */
+
+/* Refine the first child of each family and coarsen the families
+ * whose parent is the second child of its family. */
+static int
+t8_test_hash_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                    t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                    t8_eclass_scheme_c * ts, int num_elements,
+                    t8_element_t * elements[])
+{
+  int                 level = ts->t8_element_level (elements[0]);
+
+  if (num_elements > 1 && level >= 2
+      && ts->t8_element_ancestor_id (elements[0], level - 1) == 1) {
+    return -1;
+  }
+  return level > 0 && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+static t8_forest_t
+t8_test_hash_forest (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme, int level,
+                     int hash_first, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt, forest_partition;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  t8_forest_set_scheme (forest, scheme);
+  t8_forest_set_level (forest, level);
+  t8_forest_commit (forest);
+  if (hash_first) {
+    (void) t8_forest_get_hash (forest);
+  }
+  else {
+    /* Keep the forest, such that it is not adapted in place */
+    t8_forest_ref (forest);
+  }
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_hash_adapt, 0);
+  t8_forest_commit (forest_adapt);
+  t8_forest_init (&forest_partition);
+  t8_forest_set_partition (forest_partition, forest_adapt, 0);
+  t8_forest_commit (forest_partition);
+  if (!hash_first) {
+    t8_forest_unref (&forest);
+  }
+  return forest_partition;
+}
+
+static void
+t8_test_forest_hash (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh, cmesh_copy;
+  t8_forest_t         forest_a, forest_b, forest_uniform;
+  t8_locidx_t         itree;
+  uint64_t            hash_uniform;
+  int                 eclass, level;
+  int                 maxlevel = 4;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    cmesh_copy = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0,
+                                         0);
+    SC_CHECK_ABORT (t8_cmesh_get_hash (cmesh) ==
+                    t8_cmesh_get_hash (cmesh_copy)
+                    && t8_cmesh_is_equal (cmesh, cmesh_copy),
+                    "Equal cmeshes have different hashes");
+    t8_cmesh_destroy (&cmesh_copy);
+    for (level = 1; level < maxlevel; ++level) {
+      forest_a = t8_test_hash_forest (cmesh, scheme, level, 1, comm);
+      forest_b = t8_test_hash_forest (cmesh, scheme, level, 0, comm);
+      SC_CHECK_ABORT (t8_forest_get_hash (forest_a) ==
+                      t8_forest_get_hash (forest_b),
+                      "Maintained forest hash is wrong");
+      for (itree = 0; itree < t8_forest_get_num_local_trees (forest_a);
+           itree++) {
+        SC_CHECK_ABORT (t8_forest_get_tree_hash (forest_a, itree) ==
+                        t8_forest_get_tree_hash (forest_b, itree),
+                        "Maintained tree hash is wrong");
+      }
+      SC_CHECK_ABORT (t8_forest_is_equal (forest_a, forest_b),
+                      "Equal forests are not equal");
+
+      /* The adapted forest differs from the uniform one */
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest_uniform);
+      t8_forest_set_cmesh (forest_uniform, cmesh, comm);
+      t8_forest_set_scheme (forest_uniform, scheme);
+      t8_forest_set_level (forest_uniform, level);
+      t8_forest_commit (forest_uniform);
+      hash_uniform = t8_forest_get_hash (forest_uniform);
+      SC_CHECK_ABORT (hash_uniform != t8_forest_get_hash (forest_a),
+                      "Different forests have the same hash");
+      t8_forest_unref (&forest_uniform);
+      t8_forest_unref (&forest_a);
+      t8_forest_unref (&forest_b);
+    }
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest content hashes.\n");
+  t8_test_forest_hash (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the forest content hashes.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the forest hierarchy for geometric multigrid.
+ * We build the hierarchy of a uniform forest, restrict a description of
+ * each element to its parent along the parent maps, aggregate it and
+ * check that it matches the elements of the next coarser level.
+ */
+
+/* The description of an element that we restrict. */
+typedef struct
+{
+  t8_gloidx_t         gtree;
+  t8_linearidx_t      id;
+  int                 level;
+} t8_test_hierarchy_element_t;
+
+static void
+t8_test_hierarchy_describe (t8_forest_t forest, t8_locidx_t ltreeid,
+                            const t8_element_t *element,
+                            t8_test_hierarchy_element_t *desc)
+{
+  t8_eclass_scheme_c *ts;
+
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  desc->gtree = t8_forest_global_tree_id (forest, ltreeid);
+  desc->level = ts->t8_element_level (element);
+  desc->id = ts->t8_element_get_linear_id (element, desc->level);
+}
+
+/* Check the parents of one level against the next coarser level */
+static void
+t8_test_hierarchy_level (t8_forest_hierarchy_t hierarchy, int level)
+{
+  t8_forest_t         fine, coarse;
+  const t8_locidx_t  *parents;
+  t8_locidx_t         num_parents, ielement, ltreeid, num_elements;
+  t8_locidx_t        *num_children;
+  const t8_element_t *element;
+  t8_element_t       *parent;
+  t8_eclass_scheme_c *ts;
+  t8_test_hierarchy_element_t *desc, check;
+  sc_array_t         *restricted, *aggregated, *back;
+
+  fine = t8_forest_hierarchy_get_forest (hierarchy, level);
+  coarse = t8_forest_hierarchy_get_forest (hierarchy, level + 1);
+  parents = t8_forest_hierarchy_get_parents (hierarchy, level, &num_parents);
+  num_elements = t8_forest_get_local_num_elements (fine);
+
+  /* Count the children of each parent */
+  num_children = T8_ALLOC_ZERO (t8_locidx_t, num_parents);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    SC_CHECK_ABORT (0 <= parents[ielement] && parents[ielement] < num_parents,
+                    "Parent index out of range.");
+    SC_CHECK_ABORT (ielement == 0
+                    || parents[ielement - 1] <= parents[ielement],
+                    "The parents are not sorted.");
+    num_children[parents[ielement]]++;
+  }
+
+  /* Restrict the description of each element to its parent */
+  restricted = sc_array_new_count (sizeof (t8_test_hierarchy_element_t),
+                                   num_parents);
+  /* Zero the padding, since we compare the arrays bytewise */
+  memset (restricted->array, 0, restricted->elem_count
+          * restricted->elem_size);
+  for (ielement = 0; ielement < num_elements; ielement++) {
+    element = t8_forest_get_element (fine, ielement, &ltreeid);
+    desc = (t8_test_hierarchy_element_t *)
+      sc_array_index_int (restricted, parents[ielement]);
+    if (num_children[parents[ielement]] == 1) {
+      t8_test_hierarchy_describe (fine, ltreeid, element, desc);
+      continue;
+    }
+    ts = t8_forest_get_eclass_scheme (fine,
+                                      t8_forest_get_tree_class (fine,
+                                                                ltreeid));
+    ts->t8_element_new (1, &parent);
+    ts->t8_element_parent (element, parent);
+    t8_test_hierarchy_describe (fine, ltreeid, parent, &check);
+    SC_CHECK_ABORT (num_children[parents[ielement]]
+                    == ts->t8_element_num_children (parent),
+                    "The parent does not have all children.");
+    *desc = check;
+    ts->t8_element_destroy (1, &parent);
+  }
+
+  /* Move the descriptions to the coarse forest and compare */
+  aggregated = sc_array_new_count (sizeof (t8_test_hierarchy_element_t),
+                                   t8_forest_get_local_num_elements
+                                   (coarse));
+  t8_forest_hierarchy_aggregate_data (hierarchy, level + 1, restricted,
+                                      aggregated);
+  for (ielement = 0; ielement < t8_forest_get_local_num_elements (coarse);
+       ielement++) {
+    element = t8_forest_get_element (coarse, ielement, &ltreeid);
+    t8_test_hierarchy_describe (coarse, ltreeid, element, &check);
+    desc = (t8_test_hierarchy_element_t *)
+      sc_array_index_int (aggregated, ielement);
+    SC_CHECK_ABORT (desc->gtree == check.gtree && desc->level == check.level
+                    && desc->id == check.id,
+                    "The parent does not match the coarse element.");
+  }
+
+  /* Moving the data back restores it */
+  back = sc_array_new_count (sizeof (t8_test_hierarchy_element_t),
+                             num_parents);
+  t8_forest_hierarchy_disaggregate_data (hierarchy, level + 1, aggregated,
+                                         back);
+  SC_CHECK_ABORT (sc_array_is_equal (back, restricted),
+                  "Disaggregation does not reverse aggregation.");
+
+  sc_array_destroy (back);
+  sc_array_destroy (aggregated);
+  sc_array_destroy (restricted);
+  T8_FREE (num_children);
+}
+
+static void
+t8_test_hierarchy (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                   t8_gloidx_t min_elements, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_forest_hierarchy_t hierarchy;
+  int                 level, num_levels, mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  forest = t8_forest_new_uniform (cmesh, scheme, 3, 0, comm);
+  hierarchy = t8_forest_hierarchy_new (forest, 6, min_elements);
+  num_levels = t8_forest_hierarchy_get_num_levels (hierarchy);
+  /* On one process all families are local down to the trees */
+  SC_CHECK_ABORT (mpisize > 1 || num_levels == 4,
+                  "Wrong number of levels.");
+  SC_CHECK_ABORT (t8_forest_hierarchy_get_forest (hierarchy, 0) == forest,
+                  "The finest level is not the given forest.");
+
+  for (level = 0; level < num_levels; level++) {
+    SC_CHECK_ABORT (min_elements > 0
+                    || !t8_forest_hierarchy_is_aggregated (hierarchy, level),
+                    "A level is aggregated without min_elements.");
+    if (level < num_levels - 1) {
+      SC_CHECK_ABORT (t8_forest_get_global_num_elements
+                      (t8_forest_hierarchy_get_forest (hierarchy, level + 1))
+                      <
+                      t8_forest_get_global_num_elements
+                      (t8_forest_hierarchy_get_forest (hierarchy, level)),
+                      "A coarse level is not coarser.");
+      t8_test_hierarchy_level (hierarchy, level);
+    }
+  }
+  t8_forest_hierarchy_destroy (&hierarchy);
+  SC_CHECK_ABORT (hierarchy == NULL, "The hierarchy was not destroyed.");
+}
+
+static void
+t8_test_forest_hierarchy (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  int                 eclass, mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    /* Without and with aggregation of the coarse levels */
+    t8_test_hierarchy (cmesh, scheme, 0, comm);
+    t8_test_hierarchy (cmesh, scheme, 16, comm);
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest hierarchy.\n");
+  t8_test_forest_hierarchy (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the forest hierarchy.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
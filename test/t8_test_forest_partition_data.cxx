@@ -0,0 +1,202 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the partition of user data that is shipped together
+ * with the elements.
+ * We store the global id and the level of each element in two data arrays
+ * and partition a uniform forest with element weights, such that elements
+ * are moved between processes. Afterwards, the data must match the global
+ * ids and levels of the new local elements.
+ * In addition, each element carries a variable number of copies of its
+ * global id as variable-size data.
+ */
+
+/* The first element of each tree is more expensive than the others */
+static double
+t8_test_partition_data_weight (t8_forest_t forest_from,
+                               t8_locidx_t which_tree,
+                               t8_locidx_t lelement_id,
+                               t8_eclass_scheme_c * ts,
+                               const t8_element_t * element)
+{
+  return ts->t8_element_child_id (element) == 0 ? 5. : 1.;
+}
+
+/* Fill the global ids and levels of the local elements of forest */
+static void
+t8_test_partition_data_fill (t8_forest_t forest, sc_array_t * ids,
+                             sc_array_t * levels)
+{
+  t8_locidx_t         itree, ielement, num_elements, lelement_id;
+  t8_gloidx_t         first_id;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+
+  first_id = t8_forest_get_first_local_element_id (forest);
+  sc_array_resize (ids, t8_forest_get_local_num_elements (forest));
+  sc_array_resize (levels, t8_forest_get_local_num_elements (forest));
+  lelement_id = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement_id++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielement);
+      *(t8_gloidx_t *) sc_array_index_int (ids, lelement_id) =
+        first_id + lelement_id;
+      *(int *) sc_array_index_int (levels, lelement_id) =
+        ts->t8_element_level (element);
+    }
+  }
+}
+
+/* Fill the variable-size data of the local elements of forest.
+ * Element with global id i has i % 3 entries with value i. */
+static void
+t8_test_partition_data_fill_variable (t8_forest_t forest,
+                                      sc_array_t * offsets,
+                                      sc_array_t * payload)
+{
+  t8_locidx_t         lelement_id, num_elements;
+  t8_gloidx_t         global_id;
+  size_t              ientry, num_entries;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  sc_array_resize (offsets, num_elements + 1);
+  sc_array_truncate (payload);
+  *(size_t *) sc_array_index (offsets, 0) = 0;
+  for (lelement_id = 0; lelement_id < num_elements; lelement_id++) {
+    global_id = t8_forest_get_first_local_element_id (forest) + lelement_id;
+    num_entries = global_id % 3;
+    for (ientry = 0; ientry < num_entries; ientry++) {
+      *(t8_gloidx_t *) sc_array_push (payload) = global_id;
+    }
+    *(size_t *) sc_array_index (offsets, lelement_id + 1) =
+      payload->elem_count;
+  }
+}
+
+static void
+t8_test_partition_data (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_partition;
+  sc_array_t         *ids_in, *levels_in, *ids_out, *levels_out;
+  sc_array_t         *ids_check, *levels_check;
+  sc_array_t         *offsets_in, *offsets_out, *offsets_check;
+  sc_array_t         *payload_in, *payload_out, *payload_check;
+  int                 eclass, level;
+
+  ids_in = sc_array_new (sizeof (t8_gloidx_t));
+  ids_out = sc_array_new (sizeof (t8_gloidx_t));
+  ids_check = sc_array_new (sizeof (t8_gloidx_t));
+  levels_in = sc_array_new (sizeof (int));
+  levels_out = sc_array_new (sizeof (int));
+  levels_check = sc_array_new (sizeof (int));
+  offsets_in = sc_array_new (sizeof (size_t));
+  offsets_out = sc_array_new (sizeof (size_t));
+  offsets_check = sc_array_new (sizeof (size_t));
+  payload_in = sc_array_new (sizeof (t8_gloidx_t));
+  payload_out = sc_array_new (sizeof (t8_gloidx_t));
+  payload_check = sc_array_new (sizeof (t8_gloidx_t));
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 1; level < 4; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      t8_test_partition_data_fill (forest, ids_in, levels_in);
+      t8_test_partition_data_fill_variable (forest, offsets_in, payload_in);
+
+      t8_forest_init (&forest_partition);
+      t8_forest_set_partition (forest_partition, forest, 0);
+      t8_forest_set_partition_weights (forest_partition,
+                                       t8_test_partition_data_weight, NULL);
+      t8_forest_set_partition_data (forest_partition, ids_in, ids_out);
+      t8_forest_set_partition_data (forest_partition, levels_in, levels_out);
+      t8_forest_set_partition_data_variable (forest_partition, offsets_in,
+                                             payload_in, offsets_out,
+                                             payload_out);
+      t8_forest_commit (forest_partition);
+
+      /* Compare the partitioned data with the data of the new forest */
+      t8_test_partition_data_fill (forest_partition, ids_check,
+                                   levels_check);
+      SC_CHECK_ABORT (sc_array_is_equal (ids_out, ids_check),
+                      "Partitioned element ids do not match");
+      SC_CHECK_ABORT (sc_array_is_equal (levels_out, levels_check),
+                      "Partitioned element levels do not match");
+      t8_test_partition_data_fill_variable (forest_partition, offsets_check,
+                                            payload_check);
+      SC_CHECK_ABORT (sc_array_is_equal (offsets_out, offsets_check),
+                      "Partitioned data offsets do not match");
+      SC_CHECK_ABORT (sc_array_is_equal (payload_out, payload_check),
+                      "Partitioned variable-size data does not match");
+      t8_forest_unref (&forest_partition);
+    }
+  }
+  sc_array_destroy (ids_in);
+  sc_array_destroy (ids_out);
+  sc_array_destroy (ids_check);
+  sc_array_destroy (levels_in);
+  sc_array_destroy (levels_out);
+  sc_array_destroy (levels_check);
+  sc_array_destroy (offsets_in);
+  sc_array_destroy (offsets_out);
+  sc_array_destroy (offsets_check);
+  sc_array_destroy (payload_in);
+  sc_array_destroy (payload_out);
+  sc_array_destroy (payload_check);
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the partition of element data.\n");
+  t8_test_partition_data (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the partition of element data.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
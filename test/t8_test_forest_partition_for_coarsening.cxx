@@ -0,0 +1,118 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the partition for coarsening.
+ * We partition a uniform forest such that no family is split between
+ * processes and then coarsen every family. The result must be the uniform
+ * forest of one level coarser, which is only the case if no family is
+ * split between processes.
+ */
+
+/* Coarsen every family */
+static int
+t8_test_partition_for_coarsening_adapt (t8_forest_t forest,
+                                        t8_forest_t forest_from,
+                                        t8_locidx_t which_tree,
+                                        t8_locidx_t lelement_id,
+                                        t8_eclass_scheme_c * ts,
+                                        int num_elements,
+                                        t8_element_t * elements[])
+{
+  return num_elements > 1 ? -1 : 0;
+}
+
+static void
+t8_test_partition_for_coarsening (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_partition, forest_coarse;
+  t8_gloidx_t         num_coarse_elements;
+  int                 eclass, level;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The family of a pyramid does not coarsen to a uniform forest */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 1; level < 4; ++level) {
+      /* The number of elements of the coarser uniform forest */
+      t8_scheme_cxx_ref (scheme);
+      forest_coarse =
+        t8_forest_new_uniform (t8_cmesh_new_hypercube
+                               ((t8_eclass_t) eclass, comm, 0, 0, 0), scheme,
+                               level - 1, 0, comm);
+      num_coarse_elements =
+        t8_forest_get_global_num_elements (forest_coarse);
+      t8_forest_unref (&forest_coarse);
+
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      t8_forest_init (&forest_partition);
+      t8_forest_set_partition (forest_partition, forest, 1);
+      t8_forest_commit (forest_partition);
+      SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_partition)
+                      == t8_forest_get_global_num_elements (forest),
+                      "Partition changed the number of elements");
+      forest_coarse =
+        t8_forest_new_adapt (forest_partition,
+                             t8_test_partition_for_coarsening_adapt, 0, 0,
+                             NULL);
+      SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_coarse)
+                      == num_coarse_elements,
+                      "Not all families could be coarsened");
+      t8_forest_unref (&forest_coarse);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the partition for coarsening.\n");
+  t8_test_partition_for_coarsening (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the partition for coarsening.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,453 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the weighted partition of a forest.
+ * We partition a uniform forest with element weights and check that
+ * the weight of each process differs from the average weight by at most the
+ * weight of one element. We also check that passing the weights as an array
+ * results in the same partition as passing them as a callback.
+ * In a hybrid forest, partitioning with a weight per eclass must result in
+ * the same partition as partitioning with a callback that returns the
+ * weight of the eclass.
+ * A cost model that is fitted to runtimes proportional to the eclass
+ * weights must predict these weights, and partitioning with it must result
+ * in the same partition as partitioning with its costs as a weight array.
+ * Partitioning with a tolerance must not change a balanced forest, must
+ * keep the load of each process within the tolerance and must not move
+ * any process boundary further than the exact partition does.
+ * The counted adaptation must predict the elements of the adapted forest,
+ * and adapting after partitioning with the predicted weights must result
+ * in a balanced forest.
+ */
+
+#define T8_TEST_MAX_WEIGHT 3.
+
+/* Elements with odd child id are three times as expensive as others */
+static double
+t8_test_partition_weight (t8_forest_t forest_from, t8_locidx_t which_tree,
+                          t8_locidx_t lelement_id, t8_eclass_scheme_c * ts,
+                          const t8_element_t * element)
+{
+  return ts->t8_element_child_id (element) % 2 ? T8_TEST_MAX_WEIGHT : 1.;
+}
+
+/* The weight of each eclass for the hybrid test */
+static const double t8_test_eclass_weights[T8_ECLASS_COUNT] =
+  { 1, 1, 1, 1, 1, 1, 2, 1 };
+
+static double
+t8_test_partition_eclass_weight (t8_forest_t forest_from,
+                                 t8_locidx_t which_tree,
+                                 t8_locidx_t lelement_id,
+                                 t8_eclass_scheme_c * ts,
+                                 const t8_element_t * element)
+{
+  return t8_test_eclass_weights[t8_forest_get_tree_class (forest_from,
+                                                          which_tree)];
+}
+
+/* Compute the weights of all local elements of a committed forest.
+ * If weights is not NULL, store them in weights. Return their sum. */
+static double
+t8_test_partition_local_weight (t8_forest_t forest, double *weights)
+{
+  t8_locidx_t         itree, ielement, num_elements, lelement_id;
+  t8_eclass_scheme_c *ts;
+  double              weight, sum = 0;
+
+  lelement_id = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_elements; ielement++, lelement_id++) {
+      weight = t8_test_partition_weight (forest, itree, ielement, ts,
+                                         t8_forest_get_element_in_tree
+                                         (forest, itree, ielement));
+      if (weights != NULL) {
+        weights[lelement_id] = weight;
+      }
+      sum += weight;
+    }
+  }
+  return sum;
+}
+
+static void
+t8_test_partition_weights (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_partition, forest_array;
+  double             *weights;
+  double              local_weight, total_weight;
+  int                 eclass, level, mpiret, mpisize;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 1; level < 4; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 0, comm);
+      local_weight = t8_test_partition_local_weight (forest, NULL);
+      mpiret = sc_MPI_Allreduce (&local_weight, &total_weight, 1,
+                                 sc_MPI_DOUBLE, sc_MPI_SUM, comm);
+      SC_CHECK_MPI (mpiret);
+
+      /* Partition with the weight callback */
+      t8_forest_ref (forest);
+      t8_forest_init (&forest_partition);
+      t8_forest_set_partition (forest_partition, forest, 0);
+      t8_forest_set_partition_weights (forest_partition,
+                                       t8_test_partition_weight, NULL);
+      t8_forest_commit (forest_partition);
+      SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_partition)
+                      == t8_forest_get_global_num_elements (forest),
+                      "Partition changed the number of elements");
+      local_weight = t8_test_partition_local_weight (forest_partition, NULL);
+      SC_CHECK_ABORT (fabs (local_weight - total_weight / mpisize)
+                      <= T8_TEST_MAX_WEIGHT,
+                      "Weighted partition is not balanced");
+
+      /* Partition with the weight array */
+      weights = T8_ALLOC (double, t8_forest_get_local_num_elements (forest));
+      t8_test_partition_local_weight (forest, weights);
+      t8_forest_init (&forest_array);
+      t8_forest_set_partition (forest_array, forest, 0);
+      t8_forest_set_partition_weights (forest_array, NULL, weights);
+      t8_forest_commit (forest_array);
+      T8_FREE (weights);
+      SC_CHECK_ABORT (t8_forest_is_equal (forest_array, forest_partition),
+                      "Weight array and callback lead to different "
+                      "partitions");
+      t8_forest_unref (&forest_array);
+      t8_forest_unref (&forest_partition);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+static void
+t8_test_partition_eclass_weights (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_eclass, forest_callback;
+  int                 level;
+
+  for (level = 0; level < 4; ++level) {
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hybrid_gate (comm),
+                                    scheme, level, 0, comm);
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_eclass);
+    t8_forest_set_partition (forest_eclass, forest, 0);
+    t8_forest_set_partition_eclass_weights (forest_eclass,
+                                            t8_test_eclass_weights);
+    t8_forest_commit (forest_eclass);
+
+    t8_forest_init (&forest_callback);
+    t8_forest_set_partition (forest_callback, forest, 0);
+    t8_forest_set_partition_weights (forest_callback,
+                                     t8_test_partition_eclass_weight, NULL);
+    t8_forest_commit (forest_callback);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_eclass, forest_callback),
+                    "Eclass weights and callback lead to different "
+                    "partitions");
+    t8_forest_unref (&forest_eclass);
+    t8_forest_unref (&forest_callback);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+static void
+t8_test_partition_cost_model (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_array, forest_model;
+  t8_forest_cost_model_t model;
+  t8_locidx_t         itree, ielement, num_elements, half, lelement_id;
+  t8_eclass_t         tree_class;
+  double              imbalance, weight, *weights;
+  int                 level;
+
+  for (level = 0; level < 4; ++level) {
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hybrid_gate (comm),
+                                    scheme, level, 0, comm);
+    /* Record runtimes that follow the eclass weights, first once per tree
+     * and then in two halves per tree. */
+    model = t8_forest_cost_model_new (0.5);
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+      num_elements = t8_forest_get_tree_num_elements (forest, itree);
+      weight = t8_test_eclass_weights[t8_forest_get_tree_class (forest,
+                                                                itree)];
+      t8_forest_cost_model_record (model, forest, itree, 0, -1,
+                                   weight * num_elements);
+    }
+    imbalance = t8_forest_cost_model_fit (model, comm);
+    SC_CHECK_ABORT (imbalance >= 1 - 1e-12,
+                    "Invalid imbalance of the cost model");
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+      num_elements = t8_forest_get_tree_num_elements (forest, itree);
+      half = num_elements / 2;
+      weight = t8_test_eclass_weights[t8_forest_get_tree_class (forest,
+                                                                itree)];
+      t8_forest_cost_model_record (model, forest, itree, 0, half,
+                                   weight * half);
+      t8_forest_cost_model_record (model, forest, itree, half, -1,
+                                   weight * (num_elements - half));
+    }
+    t8_forest_cost_model_fit (model, comm);
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+      tree_class = t8_forest_get_tree_class (forest, itree);
+      SC_CHECK_ABORT (fabs (t8_forest_cost_model_get_cost (model, tree_class,
+                                                           level)
+                            - t8_test_eclass_weights[tree_class]) < 1e-12,
+                      "Cost model does not match the runtimes");
+    }
+
+    /* All elements of the uniform forest have the same level */
+    weights = T8_ALLOC (double, t8_forest_get_local_num_elements (forest));
+    lelement_id = 0;
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+      tree_class = t8_forest_get_tree_class (forest, itree);
+      num_elements = t8_forest_get_tree_num_elements (forest, itree);
+      for (ielement = 0; ielement < num_elements; ielement++) {
+        weights[lelement_id++] =
+          t8_forest_cost_model_get_cost (model, tree_class, level);
+      }
+    }
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_array);
+    t8_forest_set_partition (forest_array, forest, 0);
+    t8_forest_set_partition_weights (forest_array, NULL, weights);
+    t8_forest_commit (forest_array);
+    T8_FREE (weights);
+
+    t8_forest_init (&forest_model);
+    t8_forest_set_partition (forest_model, forest, 0);
+    t8_forest_set_partition_cost_model (forest_model, model);
+    t8_forest_set_profiling (forest_model, 1);
+    t8_forest_commit (forest_model);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_array, forest_model),
+                    "Cost model and its weights lead to different "
+                    "partitions");
+    SC_CHECK_ABORT (t8_forest_profile_get_partition_imbalance (forest_model)
+                    == t8_forest_cost_model_get_imbalance (model),
+                    "Imbalance is not stored in the profile");
+    t8_forest_cost_model_destroy (&model);
+    t8_forest_unref (&forest_array);
+    t8_forest_unref (&forest_model);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+/* Refine the second child of each family and coarsen the families in the
+ * first child of the root. This does not depend on the partition. */
+static int
+t8_test_partition_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                         t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                         t8_eclass_scheme_c * ts, int num_elements,
+                         t8_element_t * elements[])
+{
+  if (num_elements > 1 && ts->t8_element_level (elements[0]) > 1
+      && ts->t8_element_ancestor_id (elements[0], 1) == 0) {
+    return -1;
+  }
+  return ts->t8_element_child_id (elements[0]) == 1;
+}
+
+static void
+t8_test_partition_adapt_count (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt, forest_partition;
+  t8_locidx_t         itree, ielement, num_trees, num_counted;
+  t8_locidx_t        *tree_counts;
+  double             *weights;
+  double              sum, average;
+  int                 eclass, mpiret, mpisize;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    scheme, 2, 0, comm);
+    num_trees = t8_forest_get_num_local_trees (forest);
+    tree_counts = T8_ALLOC (t8_locidx_t, SC_MAX (num_trees, 1));
+    weights = T8_ALLOC (double,
+                        SC_MAX (t8_forest_get_local_num_elements (forest),
+                                1));
+
+    /* The counted elements must match the adapted forest */
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_adapt);
+    t8_forest_set_adapt (forest_adapt, forest, t8_test_partition_adapt, 0);
+    num_counted = t8_forest_adapt_count (forest_adapt, tree_counts, weights);
+    t8_forest_commit (forest_adapt);
+    SC_CHECK_ABORT (num_counted ==
+                    t8_forest_get_local_num_elements (forest_adapt),
+                    "Counted adaptation predicts a wrong number of elements");
+    for (itree = 0; itree < num_trees; itree++) {
+      SC_CHECK_ABORT (tree_counts[itree] ==
+                      t8_forest_get_tree_num_elements (forest_adapt, itree),
+                      "Counted adaptation predicts a wrong tree size");
+    }
+    sum = 0;
+    for (ielement = 0; ielement < t8_forest_get_local_num_elements (forest);
+         ielement++) {
+      sum += weights[ielement];
+    }
+    SC_CHECK_ABORT (fabs (sum - num_counted) < 1e-10,
+                    "Predicted weights do not sum up to the count");
+
+    /* Partition by the predicted weights and adapt afterwards */
+    t8_forest_init (&forest_partition);
+    t8_forest_set_partition (forest_partition, forest, 1);
+    t8_forest_set_partition_weights (forest_partition, NULL, weights);
+    t8_forest_commit (forest_partition);
+    T8_FREE (weights);
+    T8_FREE (tree_counts);
+    forest = forest_partition;
+    t8_forest_init (&forest_partition);
+    t8_forest_set_adapt (forest_partition, forest, t8_test_partition_adapt,
+                         0);
+    t8_forest_commit (forest_partition);
+    SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_partition)
+                    == t8_forest_get_global_num_elements (forest_adapt),
+                    "Adapting after partitioning changed the elements");
+    average = t8_forest_get_global_num_elements (forest_partition)
+      / (double) mpisize;
+    SC_CHECK_ABORT (fabs (t8_forest_get_local_num_elements (forest_partition)
+                          - average) <= 2 * T8_ECLASS_MAX_CHILDREN,
+                    "Adapting after partitioning is not balanced");
+    t8_forest_unref (&forest_partition);
+    t8_forest_unref (&forest_adapt);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+#define T8_TEST_TOLERANCE 0.5
+
+static void
+t8_test_partition_tolerance (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_weighted, forest_exact, forest_tol;
+  t8_gloidx_t         first_from, first_exact, first_tol;
+  double              average;
+  t8_locidx_t         num_local;
+  int                 level, mpiret, mpisize;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  for (level = 2; level < 5; ++level) {
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    (T8_ECLASS_QUAD, comm, 0, 0, 0),
+                                    scheme, level, 0, comm);
+    /* A balanced forest is not changed */
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_tol);
+    t8_forest_set_partition (forest_tol, forest, 0);
+    t8_forest_set_partition_tolerance (forest_tol, T8_TEST_TOLERANCE);
+    t8_forest_commit (forest_tol);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_tol, forest),
+                    "Partition with tolerance changed a balanced forest");
+    t8_forest_unref (&forest_tol);
+
+    /* The weighted partition has an imbalanced number of elements */
+    t8_forest_init (&forest_weighted);
+    t8_forest_set_partition (forest_weighted, forest, 0);
+    t8_forest_set_partition_weights (forest_weighted,
+                                     t8_test_partition_weight, NULL);
+    t8_forest_commit (forest_weighted);
+
+    t8_forest_ref (forest_weighted);
+    t8_forest_init (&forest_exact);
+    t8_forest_set_partition (forest_exact, forest_weighted, 0);
+    t8_forest_commit (forest_exact);
+    t8_forest_ref (forest_weighted);
+    t8_forest_init (&forest_tol);
+    t8_forest_set_partition (forest_tol, forest_weighted, 0);
+    t8_forest_set_partition_tolerance (forest_tol, T8_TEST_TOLERANCE);
+    t8_forest_commit (forest_tol);
+
+    average = t8_forest_get_global_num_elements (forest_tol)
+      / (double) mpisize;
+    num_local = t8_forest_get_local_num_elements (forest_tol);
+    SC_CHECK_ABORT (fabs (num_local - average)
+                    <= T8_TEST_TOLERANCE * average + 2,
+                    "Partition with tolerance is not balanced");
+    first_from = t8_forest_get_first_local_element_id (forest_weighted);
+    first_exact = t8_forest_get_first_local_element_id (forest_exact);
+    first_tol = t8_forest_get_first_local_element_id (forest_tol);
+    SC_CHECK_ABORT (SC_MAX (first_tol - first_from, first_from - first_tol)
+                    <= SC_MAX (first_exact - first_from,
+                               first_from - first_exact),
+                    "Partition with tolerance moved more elements than "
+                    "the exact partition");
+    t8_forest_unref (&forest_tol);
+    t8_forest_unref (&forest_exact);
+    t8_forest_unref (&forest_weighted);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the weighted partition.\n");
+  t8_test_partition_weights (sc_MPI_COMM_WORLD);
+  t8_test_partition_eclass_weights (sc_MPI_COMM_WORLD);
+  t8_test_partition_cost_model (sc_MPI_COMM_WORLD);
+  t8_test_partition_tolerance (sc_MPI_COMM_WORLD);
+  t8_test_partition_adapt_count (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the weighted partition.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,298 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+#include <cmath>
+
+/*
+ * In this file we test saving a forest to a checkpoint file and loading it.
+ * We adapt and partition a forest and save it together with the global
+ * ids of its elements. When loading the file on the same processes, we
+ * must get the same elements as the saved forest. We also load it on
+ * each half of the processes and check the global number of elements
+ * and the loaded data. Finally, we map the elements of the file into
+ * memory, compare them with the saved forest and adapt the mapped forest.
+ * We also save double valued data with the lossless and the lossy codec
+ * and check that it is restored exactly or within the error bound.
+ */
+
+/* Refine the first child of each family up to level 3 */
+static int
+t8_test_forest_save_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                           t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                           t8_eclass_scheme_c * ts, int num_elements,
+                           t8_element_t * elements[])
+{
+  return ts->t8_element_level (elements[0]) < 3
+    && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+/* Load the forest from the file on comm and check the loaded data */
+static t8_forest_t
+t8_test_forest_save_load (t8_eclass_t eclass, const char *filename,
+                          int do_mmap, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_gloidx_t        *ids, first_id;
+  t8_locidx_t         num_elements, ielem;
+
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0),
+                       comm);
+  t8_forest_set_scheme (forest, t8_scheme_new_default_cxx ());
+  t8_forest_set_load (forest, filename);
+  t8_forest_set_load_mmap (forest, do_mmap);
+  t8_forest_commit (forest);
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  first_id = t8_forest_get_first_local_element_id (forest);
+  ids = T8_ALLOC (t8_gloidx_t, num_elements);
+  SC_CHECK_ABORT (t8_forest_load_data (forest, filename,
+                                       sizeof (t8_gloidx_t), ids),
+                  "Could not load element data");
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    SC_CHECK_ABORT (ids[ielem] == first_id + ielem,
+                    "Loaded element data does not match");
+  }
+  /* Loading the data with a wrong size must fail */
+  SC_CHECK_ABORT (!t8_forest_load_data (forest, filename, 1, ids),
+                  "Loaded element data of wrong size");
+  T8_FREE (ids);
+  return forest;
+}
+
+/* The number of doubles per element in the codec test */
+#define T8_TEST_CODEC_COMPONENTS 2
+
+/* The value of a component of an element with a given global id.
+ * The first element has an infinite value, which the lossy codec
+ * must store lossless. */
+static double
+t8_test_forest_save_value (t8_gloidx_t id, int component)
+{
+  if (id == 0 && component == 0) {
+    return HUGE_VAL;
+  }
+  return component == 0 ? 1e-3 * id : 1.0 / (1 + id);
+}
+
+/* Load the forest from the file on comm and check the double valued
+ * data compressed with a codec. */
+static void
+t8_test_forest_save_load_codec (t8_eclass_t eclass, const char *filename,
+                                const t8_forest_codec_t * codec,
+                                double error_bound, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_forest_codec_t   other_codec;
+  t8_gloidx_t         first_id;
+  t8_locidx_t         num_elements, ielem;
+  double             *values, value;
+  int                 icomp;
+
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0),
+                       comm);
+  t8_forest_set_scheme (forest, t8_scheme_new_default_cxx ());
+  t8_forest_set_load (forest, filename);
+  t8_forest_commit (forest);
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  first_id = t8_forest_get_first_local_element_id (forest);
+  values = T8_ALLOC (double, T8_TEST_CODEC_COMPONENTS * num_elements);
+  /* The data of the built-in codecs can be read without a codec */
+  SC_CHECK_ABORT (t8_forest_load_data_ext (forest, filename,
+                                           T8_TEST_CODEC_COMPONENTS
+                                           * sizeof (double), values,
+                                           NULL),
+                  "Could not load compressed element data");
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    for (icomp = 0; icomp < T8_TEST_CODEC_COMPONENTS; icomp++) {
+      value = t8_test_forest_save_value (first_id + ielem, icomp);
+      SC_CHECK_ABORT (values[T8_TEST_CODEC_COMPONENTS * ielem + icomp]
+                      == value
+                      || fabs (values[T8_TEST_CODEC_COMPONENTS * ielem
+                                      + icomp] - value)
+                      <= error_bound * (1 + 1e-6),
+                      "Loaded compressed data does not match");
+    }
+  }
+  /* Loading with a different codec must fail */
+  if (codec->id == T8_FOREST_CODEC_LOSSLESS) {
+    t8_forest_codec_lossy (&other_codec, 1, -1);
+  }
+  else {
+    t8_forest_codec_lossless (&other_codec, -1);
+  }
+  SC_CHECK_ABORT (!t8_forest_load_data_ext (forest, filename,
+                                            T8_TEST_CODEC_COMPONENTS
+                                            * sizeof (double), values,
+                                            &other_codec),
+                  "Loaded compressed data with a wrong codec");
+  T8_FREE (values);
+  t8_forest_unref (&forest);
+}
+
+/* Save double valued data of a forest with the lossless and the lossy
+ * codec and load it on comm and half_comm */
+static void
+t8_test_forest_save_codec (t8_forest_t forest, t8_eclass_t eclass,
+                           const char *filename, sc_MPI_Comm comm,
+                           sc_MPI_Comm half_comm)
+{
+  t8_forest_codec_t   codec;
+  t8_gloidx_t         first_id;
+  t8_locidx_t         num_elements, ielem;
+  double             *values, error_bound;
+  int                 icodec, icomp;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  first_id = t8_forest_get_first_local_element_id (forest);
+  values = T8_ALLOC (double, T8_TEST_CODEC_COMPONENTS * num_elements);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    for (icomp = 0; icomp < T8_TEST_CODEC_COMPONENTS; icomp++) {
+      values[T8_TEST_CODEC_COMPONENTS * ielem + icomp] =
+        t8_test_forest_save_value (first_id + ielem, icomp);
+    }
+  }
+  for (icodec = 0; icodec < 2; icodec++) {
+    if (icodec == 0) {
+      t8_forest_codec_lossless (&codec, -1);
+      error_bound = 0;
+    }
+    else {
+      error_bound = 1e-6;
+      t8_forest_codec_lossy (&codec, error_bound, 9);
+    }
+    SC_CHECK_ABORT (t8_forest_save_ext (forest, filename,
+                                        T8_TEST_CODEC_COMPONENTS
+                                        * sizeof (double), values, &codec),
+                    "Could not save forest with compressed data");
+    t8_test_forest_save_load_codec (eclass, filename, &codec, error_bound,
+                                    comm);
+    t8_test_forest_save_load_codec (eclass, filename, &codec, error_bound,
+                                    half_comm);
+  }
+  T8_FREE (values);
+}
+
+static void
+t8_test_forest_save (sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt, forest_load;
+  t8_gloidx_t        *ids, first_id;
+  t8_locidx_t         num_elements, ielem;
+  sc_MPI_Comm         half_comm;
+  const char         *filename = "t8_test_forest_save.t8f";
+  int                 eclass, mpirank, mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_split (comm, mpirank < (mpisize + 1) / 2, mpirank,
+                              &half_comm);
+  SC_CHECK_MPI (mpiret);
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    t8_scheme_new_default_cxx (), 1, 0, comm);
+    t8_forest_init (&forest_adapt);
+    t8_forest_set_adapt (forest_adapt, forest, t8_test_forest_save_adapt, 1);
+    t8_forest_set_partition (forest_adapt, NULL, 0);
+    t8_forest_commit (forest_adapt);
+
+    /* Save the forest with the global ids of its elements */
+    num_elements = t8_forest_get_local_num_elements (forest_adapt);
+    first_id = t8_forest_get_first_local_element_id (forest_adapt);
+    ids = T8_ALLOC (t8_gloidx_t, num_elements);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      ids[ielem] = first_id + ielem;
+    }
+    SC_CHECK_ABORT (t8_forest_save (forest_adapt, filename,
+                                    sizeof (t8_gloidx_t), ids),
+                    "Could not save forest");
+    T8_FREE (ids);
+
+    /* The partitioned forest and the loaded forest distribute the
+     * elements evenly, thus they must have the same local elements */
+    forest_load = t8_test_forest_save_load ((t8_eclass_t) eclass, filename,
+                                            0, comm);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_adapt, forest_load),
+                    "Loaded forest does not match the saved forest");
+    t8_forest_unref (&forest_load);
+
+    /* Load the forest on a different number of processes */
+    forest_load = t8_test_forest_save_load ((t8_eclass_t) eclass, filename,
+                                            0, half_comm);
+    SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_load)
+                    == t8_forest_get_global_num_elements (forest_adapt),
+                    "Loaded forest has wrong number of elements");
+    t8_forest_unref (&forest_load);
+
+    /* Map the elements into memory */
+    forest_load = t8_test_forest_save_load ((t8_eclass_t) eclass, filename,
+                                            1, comm);
+    SC_CHECK_ABORT (t8_forest_is_equal (forest_adapt, forest_load),
+                    "Mapped forest does not match the saved forest");
+    /* The mapped elements can be used to derive new forests */
+    forest_load = t8_forest_new_adapt (forest_load,
+                                       t8_test_forest_save_adapt, 0, 0,
+                                       NULL);
+    t8_forest_unref (&forest_load);
+
+    /* Save and load compressed element data */
+    t8_test_forest_save_codec (forest_adapt, (t8_eclass_t) eclass, filename,
+                               comm, half_comm);
+    t8_forest_unref (&forest_adapt);
+  }
+  mpiret = sc_MPI_Comm_free (&half_comm);
+  SC_CHECK_MPI (mpiret);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing forest checkpoint and restart.\n");
+  t8_test_forest_save (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing forest checkpoint and restart.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
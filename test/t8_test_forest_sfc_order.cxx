@@ -0,0 +1,205 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_ghost.h>
+
+/*
+ * In this file we test the SFC order of the local elements and ghosts.
+ * We build an adapted and partitioned forest with ghosts and check that
+ * t8_forest_get_sfc_order sorts all elements by global tree id and
+ * within each tree along the space-filling curve. We then reorder
+ * element data to the SFC order and back.
+ */
+
+/* Refine the first child of each family up to level 4. */
+static int
+t8_test_sfc_order_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                         t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                         t8_eclass_scheme_c * ts, int num_elements,
+                         t8_element_t * elements[])
+{
+  int                 level = ts->t8_element_level (elements[0]);
+
+  return level < 4 && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+static              t8_forest_t
+t8_test_sfc_order_forest (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                          sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  forest = t8_forest_new_uniform (cmesh, scheme, 1, 0, comm);
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_sfc_order_adapt, 1);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest_adapt);
+  return forest_adapt;
+}
+
+static void
+t8_test_sfc_order_check (t8_forest_t forest)
+{
+  t8_locidx_t         num_local, num_ghosts, num_total, index, k;
+  t8_locidx_t         itree, ielement, num_tree_elements;
+  t8_locidx_t        *sfc_to_index, *index_to_sfc;
+  t8_gloidx_t        *gtree_ids;
+  t8_element_t      **elements;
+  t8_eclass_scheme_c **schemes;
+  t8_eclass_scheme_c *ts;
+  sc_array_t          element_data, sfc_data, element_data_back;
+
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  num_total = num_local + num_ghosts;
+  gtree_ids = T8_ALLOC (t8_gloidx_t, num_total);
+  elements = T8_ALLOC (t8_element_t *, num_total);
+  schemes = T8_ALLOC (t8_eclass_scheme_c *, num_total);
+
+  /* Collect the tree and the element of each index in canonical order */
+  index = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_tree_elements; ielement++, index++) {
+      gtree_ids[index] = t8_forest_global_tree_id (forest, itree);
+      elements[index] =
+        t8_forest_get_element_in_tree (forest, itree, ielement);
+      schemes[index] = ts;
+    }
+  }
+  for (itree = 0; itree < t8_forest_ghost_num_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_ghost_get_tree_class (forest,
+                                                                      itree));
+    num_tree_elements = t8_forest_ghost_tree_num_elements (forest, itree);
+    for (ielement = 0; ielement < num_tree_elements; ielement++, index++) {
+      gtree_ids[index] = t8_forest_ghost_get_global_treeid (forest, itree);
+      elements[index] = t8_forest_ghost_get_element (forest, itree, ielement);
+      schemes[index] = ts;
+    }
+  }
+  SC_CHECK_ABORT (index == num_total, "Wrong number of elements.");
+
+  sfc_to_index = T8_ALLOC (t8_locidx_t, num_total);
+  index_to_sfc = T8_ALLOC (t8_locidx_t, num_total);
+  t8_forest_get_sfc_order (forest, sfc_to_index, index_to_sfc);
+  for (k = 0; k < num_total; k++) {
+    SC_CHECK_ABORT (0 <= sfc_to_index[k] && sfc_to_index[k] < num_total
+                    && index_to_sfc[sfc_to_index[k]] == k,
+                    "The SFC order is not a permutation.");
+  }
+  SC_CHECK_ABORT (num_local == 0
+                  || sfc_to_index[t8_forest_get_num_ghosts_before (forest)]
+                  == 0,
+                  "The local elements do not follow the ghosts before.");
+  /* Check that consecutive elements in SFC order are sorted by tree and
+   * within a tree along the space-filling curve */
+  for (k = 1; k < num_total; k++) {
+    t8_locidx_t         prev = sfc_to_index[k - 1], next = sfc_to_index[k];
+
+    SC_CHECK_ABORT (gtree_ids[prev] < gtree_ids[next]
+                    || (gtree_ids[prev] == gtree_ids[next]
+                        && schemes[next]->t8_element_compare (elements[prev],
+                                                              elements[next])
+                        < 0), "Elements are not in SFC order.");
+  }
+
+  /* Reorder the canonical indices to SFC order and back */
+  sc_array_init_size (&element_data, sizeof (t8_locidx_t), num_total);
+  sc_array_init_size (&sfc_data, sizeof (t8_locidx_t), num_total);
+  sc_array_init_size (&element_data_back, sizeof (t8_locidx_t), num_total);
+  for (index = 0; index < num_total; index++) {
+    *(t8_locidx_t *) t8_sc_array_index_locidx (&element_data, index) = index;
+  }
+  t8_forest_element_data_to_sfc_order (forest, &element_data, &sfc_data);
+  for (k = 0; k < num_total; k++) {
+    SC_CHECK_ABORT (*(t8_locidx_t *) t8_sc_array_index_locidx (&sfc_data, k)
+                    == sfc_to_index[k], "Wrong data in SFC order.");
+  }
+  t8_forest_element_data_from_sfc_order (forest, &sfc_data,
+                                         &element_data_back);
+  SC_CHECK_ABORT (sc_array_is_equal (&element_data, &element_data_back),
+                  "Wrong data after reordering back.");
+
+  sc_array_reset (&element_data);
+  sc_array_reset (&sfc_data);
+  sc_array_reset (&element_data_back);
+  T8_FREE (sfc_to_index);
+  T8_FREE (index_to_sfc);
+  T8_FREE (gtree_ids);
+  T8_FREE (elements);
+  T8_FREE (schemes);
+}
+
+static void
+t8_test_sfc_order (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  int                 eclass;
+
+  /* Vertices have no face neighbors and thus no ghosts */
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    forest = t8_test_sfc_order_forest (cmesh, scheme, comm);
+    t8_test_sfc_order_check (forest);
+    t8_forest_unref (&forest);
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the SFC order of elements and ghosts.\n");
+  t8_test_sfc_order (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the SFC order.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
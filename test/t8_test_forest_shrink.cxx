@@ -0,0 +1,139 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test t8_forest_shrink and t8_forest_expand.
+ * We shrink a uniform forest with ghosts to a subcommunicator of two
+ * processes, check the shrunk forest, expand it back and compare it
+ * after partitioning with the partitioned original forest.
+ */
+
+static void
+t8_test_forest_shrink_expand (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                              sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_ref, forest_shrunk, forest_expand;
+  t8_forest_t         forest_partition, forest_ref_partition;
+  t8_gloidx_t         num_elements, min_elements;
+  int                 mpisize, mpiret, shrunk_size;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  forest = t8_forest_new_uniform (cmesh, scheme, 2, 1, comm);
+  num_elements = t8_forest_get_global_num_elements (forest);
+  /* Keep the forest for comparison */
+  t8_forest_ref (forest);
+  forest_ref = forest;
+
+  /* Each of at most two processes gets at least half of the elements */
+  min_elements = SC_MAX (num_elements / 2, 1);
+  forest_shrunk = t8_forest_shrink (forest, min_elements);
+  if (forest_shrunk != NULL) {
+    mpiret = sc_MPI_Comm_size (t8_forest_get_mpicomm (forest_shrunk),
+                               &shrunk_size);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (shrunk_size == SC_MIN (mpisize, 2),
+                    "Wrong size of the shrunk communicator.");
+    SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_shrunk)
+                    == num_elements, "The shrunk forest lost elements.");
+    SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_shrunk)
+                    >= min_elements, "Too few elements on a process.");
+    SC_CHECK_ABORT (shrunk_size == 1
+                    || t8_forest_get_num_ghosts (forest_shrunk) > 0, "The shrunk forest has no ghosts.");
+  }
+
+  /* Expand the forest back to comm and partition it */
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  forest_expand = t8_forest_expand (forest_shrunk, cmesh, scheme, comm);
+  SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest_expand)
+                  == num_elements, "The expanded forest lost elements.");
+  SC_CHECK_ABORT (forest_shrunk != NULL
+                  || t8_forest_get_local_num_elements (forest_expand) == 0,
+                  "A joining process has elements.");
+  t8_forest_init (&forest_partition);
+  t8_forest_set_partition (forest_partition, forest_expand, 0);
+  t8_forest_commit (forest_partition);
+
+  t8_forest_init (&forest_ref_partition);
+  t8_forest_set_partition (forest_ref_partition, forest_ref, 0);
+  t8_forest_commit (forest_ref_partition);
+  SC_CHECK_ABORT (t8_forest_is_equal (forest_partition,
+                                      forest_ref_partition),
+                  "The expanded forest does not match the original.");
+
+  t8_forest_unref (&forest_partition);
+  t8_forest_unref (&forest_ref_partition);
+}
+
+static void
+t8_test_forest_shrink (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  int                 eclass, do_partition;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    for (do_partition = 0; do_partition <= 1; do_partition++) {
+      t8_debugf ("Testing eclass %s with %s cmesh\n",
+                 t8_eclass_to_string[eclass],
+                 do_partition ? "partitioned" : "replicated");
+      cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0,
+                                      do_partition, 0);
+      t8_test_forest_shrink_expand (cmesh, scheme, comm);
+      t8_cmesh_destroy (&cmesh);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing forest shrinking and expanding.\n");
+  t8_test_forest_shrink (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing forest shrinking.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
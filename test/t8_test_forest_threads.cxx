@@ -0,0 +1,182 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <vector>
+
+/*
+ * In this file we test that the read-only queries of a committed forest
+ * can be called concurrently from multiple threads.
+ * For each local element we compute a signature from its face neighbors,
+ * once serially and once in a parallel loop on the compressed forest,
+ * such that the threads also decode the trees concurrently.
+ * Without OpenMP both computations are serial.
+ */
+
+/* Compute the signature of the local element with index lelement from
+ * its leaf face neighbors and its face neighbors. If check_box is true,
+ * check that its stored bounding box matches the computed one. */
+static              t8_gloidx_t
+t8_test_threads_signature (t8_forest_t forest, t8_locidx_t lelement,
+                           int check_box)
+{
+  t8_locidx_t         ltreeid, *element_indices;
+  t8_element_t       *element, *neigh, **neighbor_leafs;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_eclass_t         neigh_class;
+  const double       *leaf_box;
+  double              bbox[6];
+  t8_gloidx_t         signature, gneigh;
+  int                *dual_faces;
+  int                 iface, num_faces, num_neighbors, ineigh, neigh_face;
+  int                 i;
+
+  element = t8_forest_get_element (forest, lelement, &ltreeid);
+  ts = t8_forest_get_eclass_scheme (forest,
+                                    t8_forest_get_tree_class (forest,
+                                                              ltreeid));
+  num_faces = ts->t8_element_num_faces (element);
+  signature = 0;
+  for (iface = 0; iface < num_faces; iface++) {
+    /* The leaf face neighbors */
+    t8_forest_leaf_face_neighbors (forest, ltreeid, element, &neighbor_leafs,
+                                   iface, &dual_faces, &num_neighbors,
+                                   &element_indices, &neigh_scheme, 1);
+    signature += (iface + 1) * num_neighbors;
+    for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+      signature += (iface + 1) * (element_indices[ineigh] + 1)
+        * (dual_faces[ineigh] + 1);
+    }
+    if (num_neighbors > 0) {
+      neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+      T8_FREE (element_indices);
+      T8_FREE (neighbor_leafs);
+      T8_FREE (dual_faces);
+    }
+    /* The face neighbor of the same level */
+    neigh_class = t8_forest_element_neighbor_eclass (forest, ltreeid,
+                                                     element, iface);
+    neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+    neigh_scheme->t8_element_new (1, &neigh);
+    gneigh = t8_forest_element_face_neighbor (forest, ltreeid, element,
+                                              neigh, neigh_scheme, iface,
+                                              &neigh_face);
+    if (gneigh >= 0) {
+      signature += (iface + 1) * (gneigh + 1) * (neigh_face + 1)
+        * (t8_gloidx_t) (neigh_scheme->t8_element_get_linear_id
+                         (neigh, neigh_scheme->t8_element_level (neigh))
+                         + 1);
+    }
+    neigh_scheme->t8_element_destroy (1, &neigh);
+  }
+
+  if (!check_box) {
+    return signature;
+  }
+  /* The bounding box is computed on first use */
+  leaf_box = t8_forest_leaf_bounding_box (forest, ltreeid, lelement
+                                          -
+                                          t8_forest_get_tree_element_offset
+                                          (forest, ltreeid));
+  t8_forest_element_bounding_box (forest, ltreeid, element,
+                                  t8_forest_get_tree_vertices (forest,
+                                                               ltreeid),
+                                  bbox);
+  for (i = 0; i < 6; i++) {
+    SC_CHECK_ABORT (leaf_box[i] == bbox[i], "Wrong leaf bounding box");
+  }
+  return signature;
+}
+
+static void
+t8_test_forest_threads (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  t8_locidx_t         lelement, num_elements, num_errors;
+  std::vector < t8_gloidx_t > signatures;
+  int                 eclass;
+  int                 level = 2;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* Face neighbors of pyramids are not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                    scheme, level, 1, comm);
+    num_elements = t8_forest_get_local_num_elements (forest);
+    signatures.resize (num_elements);
+    for (lelement = 0; lelement < num_elements; lelement++) {
+      signatures[lelement] =
+        t8_test_threads_signature (forest, lelement, 0);
+    }
+
+    /* Compare with the signatures computed by multiple threads */
+    t8_forest_compress (forest);
+    num_errors = 0;
+#ifdef T8_ENABLE_OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+:num_errors)
+#endif
+    for (lelement = 0; lelement < num_elements; lelement++) {
+      if (t8_test_threads_signature (forest, lelement, 1) !=
+          signatures[lelement]) {
+        num_errors++;
+      }
+    }
+    SC_CHECK_ABORTF (num_errors == 0,
+                     "Wrong result of %i concurrent forest queries",
+                     (int) num_errors);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing concurrent forest queries.\n");
+  t8_test_forest_threads (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing concurrent forest queries.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
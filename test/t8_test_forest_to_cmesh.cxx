@@ -0,0 +1,118 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test converting a forest into a cmesh.
+ * We adapt a forest of level 1 and build a cmesh from its elements of
+ * level 1. The new cmesh must have one tree for each element of the
+ * uniform level 1 forest, and a uniform forest of level 1 on the new
+ * cmesh must have as many elements as the uniform level 2 forest on
+ * the original cmesh.
+ */
+
+/* Refine the first child of each family up to level 3 */
+static int
+t8_test_forest_to_cmesh_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                               t8_locidx_t which_tree,
+                               t8_locidx_t lelement_id,
+                               t8_eclass_scheme_c * ts, int num_elements,
+                               t8_element_t * elements[])
+{
+  return ts->t8_element_level (elements[0]) < 3
+    && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+static void
+t8_test_forest_to_cmesh (t8_cmesh_t cmesh, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt, forest_fine;
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh_new;
+  t8_gloidx_t         num_elements;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  forest = t8_forest_new_uniform (cmesh, scheme, 1, 0, comm);
+  num_elements = t8_forest_get_global_num_elements (forest);
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest,
+                       t8_test_forest_to_cmesh_adapt, 1);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_commit (forest_adapt);
+
+  cmesh_new = t8_forest_to_cmesh (forest_adapt, 1);
+  SC_CHECK_ABORT (t8_cmesh_is_committed (cmesh_new),
+                  "Cmesh commit failed");
+  SC_CHECK_ABORT (t8_cmesh_get_num_trees (cmesh_new) == num_elements,
+                  "Cmesh has wrong number of trees");
+  t8_forest_unref (&forest_adapt);
+
+  /* Refining the new cmesh once must give the elements of level 2 */
+  t8_scheme_cxx_ref (scheme);
+  forest_fine = t8_forest_new_uniform (cmesh, scheme, 2, 0, comm);
+  forest = t8_forest_new_uniform (cmesh_new, scheme, 1, 0, comm);
+  SC_CHECK_ABORT (t8_forest_get_global_num_elements (forest) ==
+                  t8_forest_get_global_num_elements (forest_fine),
+                  "Forest on the new cmesh has wrong number of elements");
+  t8_forest_unref (&forest);
+  t8_forest_unref (&forest_fine);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, eclass, dim;
+  sc_MPI_Comm         comm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  comm = sc_MPI_COMM_WORLD;
+  sc_init (comm, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing forest to cmesh.\n");
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    t8_test_forest_to_cmesh (t8_cmesh_new_hypercube ((t8_eclass_t) eclass,
+                                                     comm, 0, 0, 0), comm);
+  }
+  for (dim = 1; dim <= 3; dim++) {
+    t8_debugf ("Testing periodic cube of dimension %i\n", dim);
+    t8_test_forest_to_cmesh (t8_cmesh_new_periodic (comm, dim), comm);
+  }
+  t8_test_forest_to_cmesh (t8_cmesh_new_hypercube_hybrid (3, comm, 0, 0),
+                           comm);
+  t8_global_productionf ("Done testing forest to cmesh.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
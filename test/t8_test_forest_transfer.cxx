@@ -0,0 +1,150 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the data transfer between two forests.
+ * We build two uniform forests of different levels on the same coarse mesh,
+ * such that their partitions differ, and store the global element ids of
+ * the coarse forest. Transferring them to the fine forest must copy them
+ * to all children and transferring them back must reproduce them.
+ */
+
+static t8_forest_t
+t8_test_transfer_forest (t8_cmesh_t cmesh, t8_scheme_cxx_t *scheme,
+                         int level, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+
+  t8_cmesh_ref (cmesh);
+  t8_scheme_cxx_ref (scheme);
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  t8_forest_set_scheme (forest, scheme);
+  t8_forest_set_level (forest, level);
+  t8_forest_commit (forest);
+  return forest;
+}
+
+static void
+t8_test_transfer (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  t8_forest_t         coarse, fine;
+  t8_forest_transfer_t to_fine, to_coarse;
+  sc_array_t         *data_coarse, *data_fine, *data_back;
+  t8_locidx_t         ielem, num_coarse, num_fine;
+  t8_gloidx_t         first_coarse;
+  double              value, min, max;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    for (level = 0; level < maxlevel; ++level) {
+      coarse = t8_test_transfer_forest (cmesh, scheme, level, comm);
+      fine = t8_test_transfer_forest (cmesh, scheme, level + 1, comm);
+      num_coarse = t8_forest_get_local_num_elements (coarse);
+      num_fine = t8_forest_get_local_num_elements (fine);
+      first_coarse = t8_forest_get_first_local_element_id (coarse);
+
+      data_coarse = sc_array_new_count (sizeof (double), num_coarse);
+      data_fine = sc_array_new_count (sizeof (double), num_fine);
+      data_back = sc_array_new_count (sizeof (double), num_coarse);
+      for (ielem = 0; ielem < num_coarse; ielem++) {
+        *(double *) t8_sc_array_index_locidx (data_coarse, ielem) =
+          first_coarse + ielem;
+      }
+
+      to_fine = t8_forest_transfer_new (coarse, fine);
+      to_coarse = t8_forest_transfer_new (fine, coarse);
+      t8_forest_transfer_data (to_fine, data_coarse, data_fine);
+      /* Each coarse id is copied to its children, so the fine values are
+       * whole numbers in the range of the coarse ids */
+      min = 0;
+      max = t8_forest_get_global_num_elements (coarse) - 1;
+      for (ielem = 0; ielem < num_fine; ielem++) {
+        value = *(double *) t8_sc_array_index_locidx (data_fine, ielem);
+        SC_CHECK_ABORT (min <= value && value <= max
+                        && value == (double) (t8_gloidx_t) value,
+                        "Transfer to the fine forest did not copy");
+      }
+      t8_forest_transfer_data (to_coarse, data_fine, data_back);
+      for (ielem = 0; ielem < num_coarse; ielem++) {
+        SC_CHECK_ABORT (*(double *) t8_sc_array_index_locidx (data_back,
+                                                              ielem)
+                        == *(double *) t8_sc_array_index_locidx (data_coarse,
+                                                                 ielem),
+                        "Transfer back did not reproduce the data");
+      }
+      /* A transfer can be executed repeatedly */
+      t8_forest_transfer_data (to_fine, data_coarse, data_fine);
+      t8_forest_transfer_data (to_coarse, data_fine, data_back);
+      for (ielem = 0; ielem < num_coarse; ielem++) {
+        SC_CHECK_ABORT (*(double *) t8_sc_array_index_locidx (data_back,
+                                                              ielem)
+                        == first_coarse + ielem,
+                        "Repeated transfer did not reproduce the data");
+      }
+
+      t8_forest_transfer_destroy (&to_fine);
+      t8_forest_transfer_destroy (&to_coarse);
+      sc_array_destroy (data_coarse);
+      sc_array_destroy (data_fine);
+      sc_array_destroy (data_back);
+      t8_forest_unref (&coarse);
+      t8_forest_unref (&fine);
+    }
+    t8_cmesh_destroy (&cmesh);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the data transfer between forests.\n");
+  t8_test_transfer (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the data transfer between forests.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,197 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the forest views.
+ * We select the elements of a uniform forest with a face ghost layer
+ * whose centroid lies in the lower half of the unit cube and check the
+ * ranges, the iteration, the restricted face neighbors and the restricted
+ * ghost exchange.
+ */
+
+/* Select the elements whose centroid has an x coordinate below 0.5 */
+static int
+t8_test_view_select (t8_forest_t forest, t8_locidx_t ltreeid,
+                     const t8_element_t *element, t8_locidx_t element_index,
+                     void *user_data)
+{
+  double              centroid[3];
+
+  t8_forest_element_centroid (forest, ltreeid, element,
+                              t8_forest_get_tree_vertices (forest, ltreeid),
+                              centroid);
+  return centroid[0] < 0.5;
+}
+
+/* Count the iterated elements and check that they are selected */
+static void
+t8_test_view_iterate (t8_forest_t forest, t8_locidx_t ltreeid,
+                      const t8_element_t *element, t8_locidx_t element_index,
+                      void *user_data)
+{
+  t8_locidx_t         test_ltreeid;
+
+  SC_CHECK_ABORT (t8_forest_get_element (forest, element_index,
+                                         &test_ltreeid) == element
+                  && test_ltreeid == ltreeid,
+                  "Wrong element index in view iteration.");
+  SC_CHECK_ABORT (t8_test_view_select (forest, ltreeid, element,
+                                       element_index, NULL),
+                  "Iterated an element outside of the view.");
+  (*(t8_locidx_t *) user_data)++;
+}
+
+static void
+t8_test_forest_view_eclass (t8_eclass_t eclass, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_forest_view_t    view;
+  const t8_forest_view_range_t *ranges;
+  t8_locidx_t         num_local, num_ghosts, num_trees, itree, ielement;
+  t8_locidx_t         irange, num_ranges, num_selected, num_iterated;
+  t8_locidx_t         tree_offset, num_tree_elements;
+  t8_element_t       *element;
+  sc_array_t          indices, element_data;
+  int                 iface, num_faces, selected;
+  size_t              ineigh;
+  t8_eclass_scheme_c *ts;
+
+  forest = t8_forest_new_uniform (t8_cmesh_new_hypercube (eclass, comm, 0, 0,
+                                                          0),
+                                  t8_scheme_new_default_cxx (), 2, 1, comm);
+  view = t8_forest_view_new (forest, t8_test_view_select, NULL);
+  SC_CHECK_ABORT (t8_forest_view_get_forest (view) == forest,
+                  "Wrong forest of the view.");
+  num_local = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+
+  /* The view contains exactly the selected elements */
+  num_selected = 0;
+  for (ielement = 0; ielement < num_local; ielement++) {
+    element = t8_forest_get_element (forest, ielement, &itree);
+    selected = t8_test_view_select (forest, itree, element, ielement, NULL);
+    SC_CHECK_ABORT (t8_forest_view_contains (view, ielement) == selected,
+                    "The view does not contain the selected elements.");
+    num_selected += selected;
+  }
+  SC_CHECK_ABORT (num_selected == t8_forest_view_get_num_elements (view),
+                  "Wrong number of elements in the view.");
+  SC_CHECK_ABORT (t8_forest_view_get_num_ghosts (view) <= num_ghosts,
+                  "Wrong number of ghosts in the view.");
+
+  /* The ranges of the local trees lie in their trees */
+  num_trees = t8_forest_get_num_local_trees (forest);
+  for (itree = 0; itree < num_trees; itree++) {
+    ranges = t8_forest_view_get_tree_ranges (view, itree, &num_ranges);
+    tree_offset = t8_forest_get_tree_element_offset (forest, itree);
+    num_tree_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (irange = 0; irange < num_ranges; irange++) {
+      SC_CHECK_ABORT (ranges[irange].num > 0
+                      && tree_offset <= ranges[irange].first
+                      && ranges[irange].first + ranges[irange].num
+                      <= tree_offset + num_tree_elements,
+                      "A range is not in its tree.");
+    }
+  }
+
+  num_iterated = 0;
+  t8_forest_view_iterate (view, t8_test_view_iterate, &num_iterated);
+  SC_CHECK_ABORT (num_iterated == num_selected,
+                  "The iteration did not visit all elements of the view.");
+
+  /* All face neighbors are in the view */
+  sc_array_init (&indices, sizeof (t8_locidx_t));
+  for (ielement = 0; ielement < num_local; ielement++) {
+    element = t8_forest_get_element (forest, ielement, &itree);
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_faces = ts->t8_element_num_faces (element);
+    for (iface = 0; iface < num_faces; iface++) {
+      sc_array_truncate (&indices);
+      t8_forest_view_leaf_face_neighbors (view, itree, element, iface,
+                                          &indices, NULL);
+      for (ineigh = 0; ineigh < indices.elem_count; ineigh++) {
+        SC_CHECK_ABORT (t8_forest_view_contains (view, *(t8_locidx_t *)
+                                                 sc_array_index (&indices,
+                                                                 ineigh)),
+                        "A face neighbor is not in the view.");
+      }
+    }
+  }
+  sc_array_reset (&indices);
+
+  /* Only the ghosts in the view are updated */
+  sc_array_init_count (&element_data, sizeof (t8_gloidx_t),
+                       num_local + num_ghosts);
+  for (ielement = 0; ielement < num_local + num_ghosts; ielement++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&element_data, ielement) =
+      ielement < num_local ? t8_forest_get_first_local_element_id (forest)
+      + ielement : -1;
+  }
+  t8_forest_view_ghost_exchange_data (view, &element_data);
+  for (ielement = num_local; ielement < num_local + num_ghosts; ielement++) {
+    SC_CHECK_ABORT ((*(t8_gloidx_t *)
+                     t8_sc_array_index_locidx (&element_data, ielement) >= 0)
+                    == t8_forest_view_contains (view, ielement),
+                    "The ghost exchange is not restricted to the view.");
+  }
+  sc_array_reset (&element_data);
+
+  t8_forest_view_destroy (&view);
+  SC_CHECK_ABORT (view == NULL, "The view was not destroyed.");
+  t8_forest_unref (&forest);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret, eclass;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing forest views.\n");
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass != T8_ECLASS_PYRAMID) {
+      t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+      t8_test_forest_view_eclass ((t8_eclass_t) eclass, sc_MPI_COMM_WORLD);
+    }
+  }
+  t8_global_productionf ("Done testing forest views.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_vec.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the geometry cache of a forest.
+ * We build uniform forests with geometry cache and compare the cached
+ * values with the values computed by the t8_forest_element_* functions.
+ * We then adapt these forests, such that the data of some elements is
+ * copied from the original cache, and compare again.
+ */
+
+/* Refine every third element */
+static int
+t8_test_geometry_cache_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                              t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                              t8_eclass_scheme_c * ts, int num_elements,
+                              t8_element_t * elements[])
+{
+  return lelement_id % 3 == 0;
+}
+
+/* Check that the cache of a forest matches the computed geometry */
+static void
+t8_test_geometry_cache_check (t8_forest_t forest)
+{
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  double             *tree_vertices;
+  double              coords[3];
+  int                 iface, num_faces;
+
+  SC_CHECK_ABORT (t8_forest_has_geometry_cache (forest),
+                  "Forest has no geometry cache");
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      t8_forest_element_centroid (forest, itree, element, tree_vertices,
+                                  coords);
+      SC_CHECK_ABORT (t8_vec_dist (coords, t8_forest_element_cached_centroid
+                                   (forest, itree, ielem)) == 0,
+                      "Wrong cached centroid");
+      SC_CHECK_ABORT (t8_forest_element_volume
+                      (forest, itree, element, tree_vertices)
+                      == t8_forest_element_cached_volume (forest, itree,
+                                                          ielem),
+                      "Wrong cached volume");
+      num_faces = ts->t8_element_num_faces (element);
+      for (iface = 0; iface < num_faces; iface++) {
+        SC_CHECK_ABORT (t8_forest_element_face_area
+                        (forest, itree, element, iface, tree_vertices)
+                        == t8_forest_element_cached_face_area (forest, itree,
+                                                               ielem, iface),
+                        "Wrong cached face area");
+        t8_forest_element_face_normal (forest, itree, element, iface,
+                                       tree_vertices, coords);
+        SC_CHECK_ABORT (t8_vec_dist
+                        (coords,
+                         t8_forest_element_cached_face_normal (forest, itree,
+                                                               ielem,
+                                                               iface)) == 0,
+                        "Wrong cached face normal");
+        t8_forest_element_face_centroid (forest, itree, element, iface,
+                                         tree_vertices, coords);
+        SC_CHECK_ABORT (t8_vec_dist
+                        (coords,
+                         t8_forest_element_cached_face_centroid (forest,
+                                                                 itree,
+                                                                 ielem,
+                                                                 iface)) ==
+                        0, "Wrong cached face centroid");
+      }
+    }
+  }
+}
+
+static void
+t8_test_geometry_cache (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      /* Build a uniform forest with geometry cache */
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_geometry_cache (forest, 1);
+      t8_forest_commit (forest);
+      t8_test_geometry_cache_check (forest);
+
+      /* Adapt the forest, the data of the unchanged elements is reused */
+      t8_forest_init (&forest_adapt);
+      t8_forest_set_adapt (forest_adapt, forest,
+                           t8_test_geometry_cache_adapt, 0);
+      t8_forest_set_geometry_cache (forest_adapt, 1);
+      t8_forest_commit (forest_adapt);
+      t8_test_geometry_cache_check (forest_adapt);
+      t8_forest_unref (&forest_adapt);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the forest geometry cache.\n");
+  t8_test_geometry_cache (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the forest geometry cache.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -25,6 +25,7 @@
 #include <t8_forest.h>
 #include <t8_forest/t8_forest_ghost.h>
 #include <t8_forest/t8_forest_private.h>
+#include <t8_forest/t8_forest_types.h>
 #include <t8_cmesh.h>
 #include "t8_cmesh/t8_cmesh_testcases.h"
 
@@ -108,12 +109,62 @@ t8_test_gao_check (t8_forest_t forest)
   }
 }
 
+/* Check that two forests with the same elements have the same ghost layer */
+static void
+t8_test_gao_compare (t8_forest_t forest, t8_forest_t forest_compare)
+{
+  t8_locidx_t         num_ghost_trees, num_elems_in_tree, itree, ielem;
+  t8_eclass_scheme_c *ts;
+  int                 num_remotes, num_remotes_compare, iremote;
+  int                *remotes, *remotes_compare;
+
+  SC_CHECK_ABORT (t8_forest_get_num_ghosts (forest) ==
+                  t8_forest_get_num_ghosts (forest_compare),
+                  "Incremental ghost layer has wrong number of ghosts.\n");
+  remotes = t8_forest_ghost_get_remotes (forest, &num_remotes);
+  remotes_compare =
+    t8_forest_ghost_get_remotes (forest_compare, &num_remotes_compare);
+  SC_CHECK_ABORT (num_remotes == num_remotes_compare,
+                  "Incremental ghost layer has wrong remotes.\n");
+  for (iremote = 0; iremote < num_remotes; iremote++) {
+    SC_CHECK_ABORT (remotes[iremote] == remotes_compare[iremote]
+                    && t8_forest_ghost_remote_first_elem (forest,
+                                                          remotes[iremote])
+                    == t8_forest_ghost_remote_first_elem (forest_compare,
+                                                          remotes[iremote]),
+                    "Incremental ghost layer has wrong remotes.\n");
+  }
+  num_ghost_trees = t8_forest_ghost_num_trees (forest);
+  SC_CHECK_ABORT (num_ghost_trees ==
+                  t8_forest_ghost_num_trees (forest_compare),
+                  "Incremental ghost layer has wrong number of trees.\n");
+  for (itree = 0; itree < num_ghost_trees; itree++) {
+    num_elems_in_tree = t8_forest_ghost_tree_num_elements (forest, itree);
+    SC_CHECK_ABORT (t8_forest_ghost_get_global_treeid (forest, itree) ==
+                    t8_forest_ghost_get_global_treeid (forest_compare, itree)
+                    && num_elems_in_tree ==
+                    t8_forest_ghost_tree_num_elements (forest_compare,
+                                                       itree),
+                    "Incremental ghost layer has wrong trees.\n");
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_ghost_get_tree_class (forest,
+                                                                      itree));
+    for (ielem = 0; ielem < num_elems_in_tree; ielem++) {
+      SC_CHECK_ABORT (!ts->t8_element_compare
+                      (t8_forest_ghost_get_element (forest, itree, ielem),
+                       t8_forest_ghost_get_element (forest_compare, itree,
+                                                    ielem)),
+                      "Incremental ghost layer has wrong elements.\n");
+    }
+  }
+}
+
 static void
 t8_test_ghost_owner (int cmesh_id)
 {
   int                 level, min_level, maxlevel;
   t8_cmesh_t          cmesh;
-  t8_forest_t         forest, forest_adapt;
+  t8_forest_t         forest, forest_adapt, forest_copy;
   t8_scheme_cxx_t    *scheme;
 
   scheme = t8_scheme_new_default_cxx ();
@@ -141,6 +192,29 @@ t8_test_ghost_owner (int cmesh_id)
       t8_forest_new_adapt (forest, t8_test_gao_adapt, 1, 1, &maxlevel);
     /* Check the owners of the ghost elements */
     t8_test_gao_check (forest_adapt);
+    /* The ghost layer of forest_adapt was created incrementally from the
+     * ghost layer of forest. Compare it with a newly created one. */
+    t8_forest_ref (forest_adapt);
+    t8_forest_init (&forest_copy);
+    t8_forest_set_copy (forest_copy, forest_adapt);
+    t8_forest_set_ghost (forest_copy, 1, T8_GHOST_FACES);
+    t8_forest_commit (forest_copy);
+    t8_test_gao_compare (forest_adapt, forest_copy);
+    t8_forest_unref (&forest_copy);
+    /* A deferred ghost layer must be created on first use and equal
+     * the one created in commit. */
+    t8_forest_ref (forest_adapt);
+    t8_forest_init (&forest_copy);
+    t8_forest_set_copy (forest_copy, forest_adapt);
+    t8_forest_set_ghost (forest_copy, 1, T8_GHOST_FACES);
+    t8_forest_set_ghost_lazy (forest_copy, 1);
+    t8_forest_commit (forest_copy);
+    SC_CHECK_ABORT (forest_copy->mpisize == 1
+                    || forest_copy->ghosts == NULL,
+                    "The deferred ghost layer was created in commit.\n");
+    t8_test_gao_compare (forest_copy, forest_adapt);
+    t8_test_gao_check (forest_copy);
+    t8_forest_unref (&forest_copy);
     t8_forest_unref (&forest_adapt);
   }
   t8_cmesh_destroy (&cmesh);
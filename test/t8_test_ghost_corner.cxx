@@ -0,0 +1,188 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the ghost layer of vertex neighbors.
+ * We build a uniform forest with T8_GHOST_VERTICES and compare the number
+ * of its ghosts to the number of remote elements that share a vertex with a
+ * local element. We compute the latter with a replicated copy of the forest
+ * on each process.
+ * We only use coarse meshes in which all trees that share a vertex also share
+ * a face, since the ghost layer does not consider trees that only share an
+ * edge or a vertex.
+ */
+
+#define T8_TEST_GHOST_CORNER_LEVEL 2
+
+/* Store the vertex coordinates of all elements of a replicated forest */
+static double      *
+t8_test_ghost_corner_coords (t8_forest_t forest)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *elem;
+  double             *coords, *tree_vertices;
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_gloidx_t         gelem = 0;
+  int                 icorner, num_corners;
+
+  coords = T8_ALLOC_ZERO (double, 3 * T8_ECLASS_MAX_CORNERS *
+                          t8_forest_get_local_num_elements (forest));
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, gelem++) {
+      elem = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_corners = ts->t8_element_num_corners (elem);
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        t8_forest_element_coordinate (forest, itree, elem, tree_vertices,
+                                      icorner,
+                                      coords + 3 * (T8_ECLASS_MAX_CORNERS *
+                                                    gelem + icorner));
+      }
+      /* Mark the unused corners */
+      for (; icorner < T8_ECLASS_MAX_CORNERS; icorner++) {
+        coords[3 * (T8_ECLASS_MAX_CORNERS * gelem + icorner)] = -1;
+      }
+    }
+  }
+  return coords;
+}
+
+/* Return true if two elements share a vertex */
+static int
+t8_test_ghost_corner_share_vertex (const double *coords_a,
+                                   const double *coords_b)
+{
+  int                 icorner, jcorner;
+
+  for (icorner = 0; icorner < T8_ECLASS_MAX_CORNERS; icorner++) {
+    if (coords_a[3 * icorner] < 0) {
+      continue;
+    }
+    for (jcorner = 0; jcorner < T8_ECLASS_MAX_CORNERS; jcorner++) {
+      if (coords_b[3 * jcorner] >= 0
+          && fabs (coords_a[3 * icorner] - coords_b[3 * jcorner]) < 1e-10
+          && fabs (coords_a[3 * icorner + 1] - coords_b[3 * jcorner + 1])
+          < 1e-10
+          && fabs (coords_a[3 * icorner + 2] - coords_b[3 * jcorner + 2])
+          < 1e-10) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void
+t8_test_ghost_corner (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_replicated;
+  t8_gloidx_t         first, last, gelem, jelem, num_global;
+  t8_locidx_t         num_expected;
+  double             *coords;
+  int                 eclass;
+  const int           eclasses[4] = { T8_ECLASS_QUAD, T8_ECLASS_TRIANGLE,
+    T8_ECLASS_HEX, T8_ECLASS_PRISM
+  };
+
+  for (eclass = 0; eclass < 4; eclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclasses[eclass]]);
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_init (&forest);
+    t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                         ((t8_eclass_t) eclasses[eclass], comm, 0, 0, 0),
+                         comm);
+    t8_forest_set_scheme (forest, scheme);
+    t8_forest_set_level (forest, T8_TEST_GHOST_CORNER_LEVEL);
+    t8_forest_set_ghost (forest, 1, T8_GHOST_VERTICES);
+    t8_forest_commit (forest);
+
+    t8_scheme_cxx_ref (scheme);
+    forest_replicated =
+      t8_forest_new_uniform (t8_cmesh_new_hypercube
+                             ((t8_eclass_t) eclasses[eclass],
+                              sc_MPI_COMM_SELF, 0, 0, 0), scheme,
+                             T8_TEST_GHOST_CORNER_LEVEL, 0,
+                             sc_MPI_COMM_SELF);
+    coords = t8_test_ghost_corner_coords (forest_replicated);
+
+    /* Count the remote elements that share a vertex with a local element */
+    first = t8_forest_get_first_local_element_id (forest);
+    last = first + t8_forest_get_local_num_elements (forest);
+    num_global = t8_forest_get_global_num_elements (forest_replicated);
+    num_expected = 0;
+    for (gelem = 0; gelem < num_global; gelem++) {
+      if (first <= gelem && gelem < last) {
+        continue;
+      }
+      for (jelem = first; jelem < last; jelem++) {
+        if (t8_test_ghost_corner_share_vertex
+            (coords + 3 * T8_ECLASS_MAX_CORNERS * gelem,
+             coords + 3 * T8_ECLASS_MAX_CORNERS * jelem)) {
+          num_expected++;
+          break;
+        }
+      }
+    }
+    SC_CHECK_ABORTF (t8_forest_get_num_ghosts (forest) == num_expected,
+                     "Wrong number of vertex ghosts for %s: %li instead "
+                     "of %li", t8_eclass_to_string[eclasses[eclass]],
+                     (long) t8_forest_get_num_ghosts (forest),
+                     (long) num_expected);
+    T8_FREE (coords);
+    t8_forest_unref (&forest_replicated);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the vertex ghost layer.\n");
+  t8_test_ghost_corner (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the vertex ghost layer.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
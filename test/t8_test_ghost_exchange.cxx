@@ -39,6 +39,9 @@
  * coarse meshes.
  * One test is an integer entry '42' for each element,
  * in a second test, we store the element's linear id in the data array.
+ * A third test uses the non-blocking begin and end functions and changes
+ * the local entries while the exchange is in progress.
+ * The exchanges are repeated with zero-copy sends of contiguous data.
  */
 
 static int
@@ -168,6 +171,344 @@ t8_test_ghost_exchange_data_int (t8_forest_t forest)
   sc_array_reset (&element_data);
 }
 
+/* Like t8_test_ghost_exchange_data_int, but with the non-blocking
+ * exchange. After the exchange began, we overwrite the local entries,
+ * which must not change the received data. */
+static void
+t8_test_ghost_exchange_data_begin_end (t8_forest_t forest)
+{
+  sc_array_t          element_data;
+  t8_ghost_exchange_t exchange;
+  t8_locidx_t         num_elements, ielem, num_ghosts;
+  int                 ghost_int;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  sc_array_init_size (&element_data, sizeof (int), num_elements + num_ghosts);
+
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    *(int *) t8_sc_array_index_locidx (&element_data, ielem) = 42;
+  }
+  exchange = t8_forest_ghost_exchange_begin (forest, &element_data);
+  /* Change the local entries while the exchange is in progress */
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    *(int *) t8_sc_array_index_locidx (&element_data, ielem) = -1;
+  }
+  t8_forest_ghost_exchange_end (&exchange);
+  SC_CHECK_ABORT (exchange == NULL, "Exchange handle was not freed.\n");
+
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    ghost_int =
+      *(int *) t8_sc_array_index_locidx (&element_data, num_elements + ielem);
+    SC_CHECK_ABORT (ghost_int == 42,
+                    "Error when exchanging ghost data non-blocking. "
+                    "Received wrong data.\n");
+  }
+  sc_array_reset (&element_data);
+}
+
+/* Exchange the global element ids and their negatives with the same
+ * persistent plan and check the received ghost data. */
+static void
+t8_test_ghost_exchange_data_plan (t8_forest_t forest)
+{
+  sc_array_t          element_data;
+  t8_ghost_exchange_plan_t plan;
+  t8_locidx_t         num_elements, ielem, num_ghosts;
+  t8_gloidx_t         first_element, ghost_id, expected;
+  t8_gloidx_t        *ghost_ids;
+  int                 iround, sign;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_init_size (&element_data, sizeof (t8_gloidx_t),
+                      num_elements + num_ghosts);
+  /* Compute the reference ghost ids with the one-shot exchange */
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&element_data, ielem) =
+      first_element + ielem;
+  }
+  t8_forest_ghost_exchange_data (forest, &element_data);
+  ghost_ids = T8_ALLOC (t8_gloidx_t, num_ghosts);
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    ghost_ids[ielem] = *(t8_gloidx_t *)
+      t8_sc_array_index_locidx (&element_data, num_elements + ielem);
+  }
+
+  plan = t8_forest_ghost_exchange_plan_new (forest, &element_data);
+  for (iround = 0; iround < 2; iround++) {
+    sign = iround == 0 ? -1 : 1;
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      *(t8_gloidx_t *) t8_sc_array_index_locidx (&element_data, ielem) =
+        sign * (first_element + ielem + 1);
+    }
+    for (ielem = 0; ielem < num_ghosts; ielem++) {
+      *(t8_gloidx_t *)
+        t8_sc_array_index_locidx (&element_data, num_elements + ielem) = 0;
+    }
+    t8_forest_ghost_exchange_plan_start (plan);
+    t8_forest_ghost_exchange_plan_wait (plan);
+    for (ielem = 0; ielem < num_ghosts; ielem++) {
+      ghost_id = *(t8_gloidx_t *)
+        t8_sc_array_index_locidx (&element_data, num_elements + ielem);
+      expected = sign * (ghost_ids[ielem] + 1);
+      SC_CHECK_ABORTF (ghost_id == expected,
+                       "Error when exchanging ghost data with a plan. "
+                       "Received %lli instead of %lli.\n",
+                       (long long) ghost_id, (long long) expected);
+    }
+  }
+  t8_forest_ghost_exchange_plan_destroy (&plan);
+  SC_CHECK_ABORT (plan == NULL, "Exchange plan was not freed.\n");
+  T8_FREE (ghost_ids);
+  sc_array_reset (&element_data);
+}
+
+/* Exchange two fields of different element sizes in one exchange and
+ * compare them with the result of exchanging each field separately. */
+static void
+t8_test_ghost_exchange_data_fields (t8_forest_t forest)
+{
+  sc_array_t          ids, ids_ref, values, values_ref;
+  sc_array_t         *fields[2];
+  t8_locidx_t         num_elements, ielem, num_ghosts;
+  t8_gloidx_t         first_element;
+  double             *value;
+  int                 i;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_init_size (&ids, sizeof (t8_gloidx_t), num_elements + num_ghosts);
+  sc_array_init_size (&values, 3 * sizeof (double),
+                      num_elements + num_ghosts);
+  for (ielem = 0; ielem < num_elements; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids, ielem) =
+      first_element + ielem;
+    value = (double *) t8_sc_array_index_locidx (&values, ielem);
+    for (i = 0; i < 3; i++) {
+      value[i] = (first_element + ielem) * 3 + i;
+    }
+  }
+  /* Compute the reference values with single exchanges */
+  sc_array_init (&ids_ref, ids.elem_size);
+  sc_array_copy (&ids_ref, &ids);
+  sc_array_init (&values_ref, values.elem_size);
+  sc_array_copy (&values_ref, &values);
+  t8_forest_ghost_exchange_data (forest, &ids_ref);
+  t8_forest_ghost_exchange_data (forest, &values_ref);
+
+  fields[0] = &ids;
+  fields[1] = &values;
+  t8_forest_ghost_exchange_data_fields (forest, 2, fields);
+  SC_CHECK_ABORT (!memcmp (ids.array, ids_ref.array,
+                           ids.elem_count * ids.elem_size)
+                  && !memcmp (values.array, values_ref.array,
+                              values.elem_count * values.elem_size),
+                  "Error when exchanging multiple fields. "
+                  "Received wrong data.\n");
+  sc_array_reset (&ids);
+  sc_array_reset (&ids_ref);
+  sc_array_reset (&values);
+  sc_array_reset (&values_ref);
+}
+
+/* Exchange the global element ids stored in a padded user buffer and
+ * compare them with the result of t8_forest_ghost_exchange_data. */
+static void
+t8_test_ghost_exchange_data_strided (t8_forest_t forest)
+{
+  sc_array_t          ids;
+  t8_locidx_t         num_elements, ielem, num_ghosts;
+  t8_gloidx_t         first_element, ghost_id, *entry;
+  char               *buffer;
+  const size_t        stride = 2 * sizeof (t8_gloidx_t);
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_init_size (&ids, sizeof (t8_gloidx_t), num_elements + num_ghosts);
+  buffer = T8_ALLOC (char, (num_elements + num_ghosts) * stride);
+  for (ielem = 0; ielem < num_elements + num_ghosts; ielem++) {
+    entry = (t8_gloidx_t *) (buffer + ielem * stride);
+    entry[0] = ielem < num_elements ? first_element + ielem : -1;
+    /* The padding must not be modified by the exchange */
+    entry[1] = -2;
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids, ielem) = entry[0];
+  }
+  t8_forest_ghost_exchange_data (forest, &ids);
+  t8_forest_ghost_exchange_data_strided (forest, buffer,
+                                         buffer + num_elements * stride,
+                                         sizeof (t8_gloidx_t), stride);
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    entry = (t8_gloidx_t *) (buffer + (num_elements + ielem) * stride);
+    ghost_id = *(t8_gloidx_t *)
+      t8_sc_array_index_locidx (&ids, num_elements + ielem);
+    SC_CHECK_ABORT (entry[0] == ghost_id && entry[1] == -2,
+                    "Error when exchanging strided ghost data. "
+                    "Received wrong data.\n");
+  }
+  T8_FREE (buffer);
+  sc_array_reset (&ids);
+}
+
+/* Pack the global element ids with the send indices, exchange them with
+ * the packed exchange and compare with t8_forest_ghost_exchange_data. */
+static void
+t8_test_ghost_exchange_data_packed (t8_forest_t forest)
+{
+  sc_array_t          ids, ids_ref, send_indices, send_buffer;
+  t8_locidx_t         num_elements, ielem, num_ghosts, index;
+  t8_gloidx_t         first_element;
+
+  num_elements = t8_forest_get_local_num_elements (forest);
+  num_ghosts = t8_forest_get_num_ghosts (forest);
+  first_element = t8_forest_get_first_local_element_id (forest);
+  sc_array_init_size (&ids, sizeof (t8_gloidx_t), num_elements + num_ghosts);
+  sc_array_init_size (&ids_ref, sizeof (t8_gloidx_t),
+                      num_elements + num_ghosts);
+  for (ielem = 0; ielem < num_elements + num_ghosts; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids, ielem) =
+      *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids_ref, ielem) =
+      ielem < num_elements ? first_element + ielem : -1;
+  }
+  t8_forest_ghost_exchange_data (forest, &ids_ref);
+
+  sc_array_init (&send_indices, sizeof (t8_locidx_t));
+  t8_forest_ghost_exchange_send_indices (forest, &send_indices);
+  sc_array_init_size (&send_buffer, sizeof (t8_gloidx_t),
+                      send_indices.elem_count);
+  for (ielem = 0; ielem < (t8_locidx_t) send_indices.elem_count; ielem++) {
+    index = *(t8_locidx_t *) t8_sc_array_index_locidx (&send_indices, ielem);
+    SC_CHECK_ABORT (0 <= index && index < num_elements,
+                    "Invalid ghost send index.\n");
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&send_buffer, ielem) =
+      *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids, index);
+  }
+  t8_forest_ghost_exchange_packed (forest, send_buffer.array,
+                                   num_ghosts > 0 ?
+                                   t8_sc_array_index_locidx (&ids,
+                                                             num_elements) :
+                                   NULL, sizeof (t8_gloidx_t));
+  SC_CHECK_ABORT (!memcmp (ids.array, ids_ref.array,
+                           ids.elem_count * ids.elem_size),
+                  "Error when exchanging packed ghost data. "
+                  "Received wrong data.\n");
+  sc_array_reset (&send_indices);
+  sc_array_reset (&send_buffer);
+  sc_array_reset (&ids);
+  sc_array_reset (&ids_ref);
+}
+
+/* Create a copy of forest with two ghost layers. Check that the first layer
+ * consists of the ghosts of forest and that exchanging only the first layer
+ * updates exactly the ghosts of the first layer. */
+static void
+t8_test_ghost_exchange_data_layers (t8_forest_t forest)
+{
+  t8_forest_t         forest_layers;
+  sc_array_t          ids, ids_ref;
+  t8_locidx_t         num_elements, ielem, num_ghosts, num_first_layer;
+  t8_gloidx_t         first_element, id, id_ref;
+  int                 layer;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_layers);
+  t8_forest_set_copy (forest_layers, forest);
+  t8_forest_set_ghost (forest_layers, 1, T8_GHOST_FACES);
+  t8_forest_set_ghost_depth (forest_layers, 2);
+  t8_forest_commit (forest_layers);
+
+  num_elements = t8_forest_get_local_num_elements (forest_layers);
+  num_ghosts = t8_forest_get_num_ghosts (forest_layers);
+  first_element = t8_forest_get_first_local_element_id (forest_layers);
+  SC_CHECK_ABORT (num_ghosts >= t8_forest_get_num_ghosts (forest),
+                  "Error in ghost layers. Too few ghosts.\n");
+  SC_CHECK_ABORT (num_ghosts == 0
+                  || t8_forest_get_num_ghost_layers (forest_layers) == 2,
+                  "Error in ghost layers. Wrong number of layers.\n");
+  sc_array_init_size (&ids, sizeof (t8_gloidx_t), num_elements + num_ghosts);
+  sc_array_init_size (&ids_ref, sizeof (t8_gloidx_t),
+                      num_elements + num_ghosts);
+  for (ielem = 0; ielem < num_elements + num_ghosts; ielem++) {
+    *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids, ielem) =
+      *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids_ref, ielem) =
+      ielem < num_elements ? first_element + ielem : -1;
+  }
+  t8_forest_ghost_exchange_data (forest_layers, &ids_ref);
+  t8_forest_ghost_exchange_data_layers (forest_layers, &ids, 1);
+
+  num_first_layer = 0;
+  for (ielem = 0; ielem < num_ghosts; ielem++) {
+    layer = t8_forest_get_ghost_layer (forest_layers, ielem);
+    SC_CHECK_ABORT (1 <= layer && layer <= 2,
+                    "Error in ghost layers. Invalid layer.\n");
+    id = *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids,
+                                                     num_elements + ielem);
+    id_ref = *(t8_gloidx_t *) t8_sc_array_index_locidx (&ids_ref,
+                                                         num_elements +
+                                                         ielem);
+    SC_CHECK_ABORT (id_ref >= 0, "Error when exchanging ghost data. "
+                    "Received wrong data.\n");
+    SC_CHECK_ABORT (id == (layer == 1 ? id_ref : -1),
+                    "Error when exchanging ghost layer data. "
+                    "Received wrong data.\n");
+    num_first_layer += layer == 1;
+  }
+  SC_CHECK_ABORT (num_first_layer == t8_forest_get_num_ghosts (forest),
+                  "Error in ghost layers. Wrong number of first layer "
+                  "ghosts.\n");
+  sc_array_reset (&ids);
+  sc_array_reset (&ids_ref);
+  t8_forest_unref (&forest_layers);
+}
+
+/* Copy the forest with a one-sided ghost data exchange for each
+ * synchronization and check the exchanged data. */
+static void
+t8_test_ghost_exchange_data_rma (t8_forest_t forest)
+{
+  t8_forest_t         forest_rma;
+  int                 irma;
+  const t8_ghost_rma_t rma_modes[2] = { T8_GHOST_RMA_FENCE,
+    T8_GHOST_RMA_PSCW
+  };
+
+  for (irma = 0; irma < 2; irma++) {
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_rma);
+    t8_forest_set_copy (forest_rma, forest);
+    t8_forest_set_ghost (forest_rma, 1, T8_GHOST_FACES);
+    t8_forest_set_ghost_rma (forest_rma, rma_modes[irma]);
+    t8_forest_commit (forest_rma);
+    t8_test_ghost_exchange_data_int (forest_rma);
+    t8_test_ghost_exchange_data_id (forest_rma);
+    t8_test_ghost_exchange_data_begin_end (forest_rma);
+    t8_forest_unref (&forest_rma);
+  }
+}
+
+/* Copy the forest with zero-copy sends of contiguous ghost data and check
+ * the exchanged data. The local entries must not change during these
+ * exchanges, thus we do not test the begin and end functions. */
+static void
+t8_test_ghost_exchange_data_zero_copy (t8_forest_t forest)
+{
+  t8_forest_t         forest_zero_copy;
+
+  t8_forest_ref (forest);
+  t8_forest_init (&forest_zero_copy);
+  t8_forest_set_copy (forest_zero_copy, forest);
+  t8_forest_set_ghost (forest_zero_copy, 1, T8_GHOST_FACES);
+  t8_forest_set_ghost_zero_copy (forest_zero_copy, 1);
+  t8_forest_commit (forest_zero_copy);
+  t8_test_ghost_exchange_data_int (forest_zero_copy);
+  t8_test_ghost_exchange_data_id (forest_zero_copy);
+  t8_test_ghost_exchange_data_plan (forest_zero_copy);
+  t8_forest_unref (&forest_zero_copy);
+}
+
 static void
 t8_test_ghost_exchange (int cmesh_id)
 {
@@ -196,12 +537,22 @@ t8_test_ghost_exchange (int cmesh_id)
     /* exchange ghost data */
     t8_test_ghost_exchange_data_int (forest);
     t8_test_ghost_exchange_data_id (forest);
+    t8_test_ghost_exchange_data_begin_end (forest);
+    t8_test_ghost_exchange_data_plan (forest);
+    t8_test_ghost_exchange_data_fields (forest);
+    t8_test_ghost_exchange_data_strided (forest);
+    t8_test_ghost_exchange_data_packed (forest);
+    t8_test_ghost_exchange_data_layers (forest);
+    t8_test_ghost_exchange_data_rma (forest);
+    t8_test_ghost_exchange_data_zero_copy (forest);
     /* Adapt the forest and exchange data again */
     maxlevel = level + 2;
     forest_adapt =
       t8_forest_new_adapt (forest, t8_test_exchange_adapt, 1, 1, &maxlevel);
     t8_test_ghost_exchange_data_int (forest_adapt);
     t8_test_ghost_exchange_data_id (forest_adapt);
+    t8_test_ghost_exchange_data_layers (forest_adapt);
+    t8_test_ghost_exchange_data_zero_copy (forest_adapt);
     t8_forest_unref (&forest_adapt);
   }
   t8_cmesh_destroy (&cmesh);
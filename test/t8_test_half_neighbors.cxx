@@ -142,6 +142,88 @@ t8_test_half_neighbors (sc_MPI_Comm comm, t8_eclass_t eclass)
   }
 }
 
+/* Check that the batched half neighbors of a tree are the half neighbors
+ * of the single elements. */
+static void
+t8_test_half_neighbors_batch (sc_MPI_Comm comm, t8_eclass_t eclass)
+{
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  t8_forest_half_neighbors_t half;
+  t8_eclass_t         neigh_class, batch_class;
+  t8_eclass_scheme_c *ts, *neigh_scheme;
+  t8_element_t       *element, **half_neighbors;
+  t8_element_t       *batch_neighbors[T8_ECLASS_MAX_CHILDREN];
+  t8_locidx_t         itree, ielement, num_elements, first, last;
+  t8_gloidx_t         neigh_tree, batch_tree;
+  int                 num_face_neighs, num_batch, ineigh, face, irange;
+  int                *dual_faces, *batch_dual_faces;
+  int                 level = 2;
+
+  t8_debugf ("Testing batched half neighbors with eclass %s.\n",
+             t8_eclass_to_string[eclass]);
+  cmesh = t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0);
+  forest =
+    t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (), level, 0,
+                           comm);
+  t8_forest_half_neighbors_init (&half);
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    /* Compute the neighbors in two ranges to reuse the buffers */
+    for (irange = 0; irange < 2; irange++) {
+      first = irange == 0 ? 0 : num_elements / 2;
+      last = irange == 0 ? num_elements / 2 : num_elements;
+      t8_forest_tree_half_face_neighbors (forest, itree, first, last, &half);
+      for (ielement = first; ielement < last; ielement++) {
+        element = t8_forest_get_element_in_tree (forest, itree, ielement);
+        for (face = 0; face < ts->t8_element_num_faces (element); face++) {
+          neigh_class =
+            t8_forest_element_neighbor_eclass (forest, itree, element, face);
+          neigh_scheme = t8_forest_get_eclass_scheme (forest, neigh_class);
+          num_face_neighs = ts->t8_element_num_face_children (element, face);
+          half_neighbors = T8_ALLOC (t8_element_t *, num_face_neighs);
+          dual_faces = T8_ALLOC (int, num_face_neighs);
+          neigh_scheme->t8_element_new (num_face_neighs, half_neighbors);
+          neigh_tree =
+            t8_forest_element_half_face_neighbors (forest, itree, element,
+                                                   half_neighbors,
+                                                   neigh_scheme, face,
+                                                   num_face_neighs,
+                                                   dual_faces);
+          num_batch =
+            t8_forest_half_neighbors_get (&half, ielement, face, &batch_tree,
+                                          &batch_class, batch_neighbors,
+                                          &batch_dual_faces);
+          SC_CHECK_ABORTF (batch_tree == neigh_tree,
+                           "Batched neighbor tree at face %i is wrong.\n",
+                           face);
+          SC_CHECK_ABORT (num_batch == (neigh_tree >= 0 ? num_face_neighs : 0),
+                          "Wrong number of batched half neighbors.\n");
+          if (neigh_tree >= 0) {
+            SC_CHECK_ABORT (batch_class == neigh_class,
+                            "Wrong class of batched half neighbors.\n");
+          }
+          for (ineigh = 0; ineigh < num_batch; ineigh++) {
+            SC_CHECK_ABORTF (!neigh_scheme->t8_element_compare
+                             (batch_neighbors[ineigh], half_neighbors[ineigh])
+                             && batch_dual_faces[ineigh] == dual_faces[ineigh],
+                             "Batched half neighbor %i at face %i is not the "
+                             "half neighbor of the element.\n", ineigh, face);
+          }
+          neigh_scheme->t8_element_destroy (num_face_neighs, half_neighbors);
+          T8_FREE (half_neighbors);
+          T8_FREE (dual_faces);
+        }
+      }
+    }
+  }
+  t8_forest_half_neighbors_reset (&half);
+  t8_forest_unref (&forest);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -162,6 +244,7 @@ main (int argc, char **argv)
       /* TODO: activate prism test as soon as prism can create a uniform forest. */
       /* TODO: does not work with pyramids yet */
       t8_test_half_neighbors (mpic, (t8_eclass_t) ieclass);
+      t8_test_half_neighbors_batch (mpic, (t8_eclass_t) ieclass);
     }
   }
   sc_finalize ();
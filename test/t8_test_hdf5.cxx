@@ -0,0 +1,257 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest_hdf5.h>
+#if T8_WITH_HDF5
+#include <hdf5.h>
+#endif
+
+/*
+ * In this file we test the hdf5 output of a forest.
+ * We write uniform forests of each eclass with all element data fields
+ * and a scalar and vector user field. Process 0 reads the file back and
+ * checks the dimensions of the datasets and that the xdmf file exists.
+ * If t8code was not configured with --with-hdf5 then this test
+ * does nothing and is always passed.
+ */
+
+#if T8_WITH_HDF5
+/* Check that a dataset in an hdf5 file has the given dimensions */
+static void
+t8_test_hdf5_check_dims (hid_t file, const char *name, hsize_t num_rows,
+                         hsize_t num_columns)
+{
+  hid_t               dataset, dataspace;
+  hsize_t             dims[2];
+  int                 rank;
+
+  dataset = H5Dopen2 (file, name, H5P_DEFAULT);
+  SC_CHECK_ABORTF (dataset >= 0, "Could not open dataset %s", name);
+  dataspace = H5Dget_space (dataset);
+  rank = H5Sget_simple_extent_dims (dataspace, dims, NULL);
+  SC_CHECK_ABORTF (rank == (num_columns > 1 ? 2 : 1),
+                   "Wrong rank of dataset %s", name);
+  SC_CHECK_ABORTF (dims[0] == num_rows && (rank == 1
+                                           || dims[1] == num_columns),
+                   "Wrong dimensions of dataset %s", name);
+  H5Sclose (dataspace);
+  H5Dclose (dataset);
+}
+
+static void
+t8_test_hdf5_check_file (t8_forest_t forest, const char *fileprefix)
+{
+  char                filename[BUFSIZ];
+  FILE               *xdmffile;
+  hid_t               file;
+  t8_locidx_t         itree, ielem;
+  t8_eclass_scheme_c *ts;
+  long long           num_corners, global_num_corners;
+  t8_gloidx_t         num_elements;
+  int                 mpirank, mpiret;
+
+  /* Count the element corners of all processes */
+  num_corners = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++) {
+      num_corners +=
+        ts->t8_element_num_corners (t8_forest_get_element_in_tree
+                                    (forest, itree, ielem));
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&num_corners, &global_num_corners, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_SUM,
+                             t8_forest_get_mpicomm (forest));
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (t8_forest_get_mpicomm (forest), &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank != 0) {
+    return;
+  }
+
+  snprintf (filename, BUFSIZ, "%s.h5", fileprefix);
+  file = H5Fopen (filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  SC_CHECK_ABORT (file >= 0, "Could not open hdf5 file");
+  num_elements = t8_forest_get_global_num_elements (forest);
+  t8_test_hdf5_check_dims (file, "coordinates", global_num_corners, 3);
+  t8_test_hdf5_check_dims (file, "eclass", num_elements, 1);
+  t8_test_hdf5_check_dims (file, "treeid", num_elements, 1);
+  t8_test_hdf5_check_dims (file, "mpirank", num_elements, 1);
+  t8_test_hdf5_check_dims (file, "level", num_elements, 1);
+  t8_test_hdf5_check_dims (file, "scalar", num_elements, 1);
+  t8_test_hdf5_check_dims (file, "vector", num_elements, 3);
+  H5Fclose (file);
+
+  snprintf (filename, BUFSIZ, "%s.xmf", fileprefix);
+  xdmffile = fopen (filename, "r");
+  SC_CHECK_ABORT (xdmffile != NULL, "Could not open xdmf file");
+  fclose (xdmffile);
+}
+
+/* Check whether a step of a time series contains the mesh and the data */
+static void
+t8_test_hdf5_check_step (sc_MPI_Comm comm, const char *fileprefix, int step,
+                         int has_mesh)
+{
+  char                filename[BUFSIZ];
+  hid_t               file;
+  int                 mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank != 0) {
+    return;
+  }
+  snprintf (filename, BUFSIZ, "%s_%04d.h5", fileprefix, step);
+  file = H5Fopen (filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  SC_CHECK_ABORT (file >= 0, "Could not open hdf5 file");
+  SC_CHECK_ABORTF ((H5Lexists (file, "coordinates", H5P_DEFAULT) > 0)
+                   == has_mesh, "Wrong mesh output in step %i", step);
+  SC_CHECK_ABORTF (H5Lexists (file, "scalar", H5P_DEFAULT) > 0,
+                   "Missing data in step %i", step);
+  H5Fclose (file);
+}
+#endif
+
+/* Write a time series of three steps. The second step has the same forest
+ * as the first and must not contain the mesh, the third step is refined. */
+static void
+t8_test_hdf5_series (sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt;
+  t8_forest_hdf5_series_t series;
+  t8_vtk_data_field_t field;
+  double             *scalars;
+  t8_locidx_t         num_elements, ielem;
+  const char         *fileprefix = "t8_test_hdf5_series";
+  int                 step, retval;
+
+  forest =
+    t8_forest_new_uniform (t8_cmesh_new_hypercube (T8_ECLASS_QUAD, comm, 0,
+                                                   0, 0),
+                           t8_scheme_new_default_cxx (), 2, 0, comm);
+  series = t8_forest_hdf5_series_new (fileprefix);
+  field.type = T8_VTK_SCALAR;
+  snprintf (field.description, BUFSIZ, "scalar");
+  for (step = 0; step < 3; step++) {
+    if (step == 2) {
+      /* Refine all elements */
+      t8_cmesh_ref (t8_forest_get_cmesh (forest));
+      t8_scheme_cxx_ref (t8_forest_get_scheme (forest));
+      forest_adapt = t8_forest_new_uniform (t8_forest_get_cmesh (forest),
+                                            t8_forest_get_scheme (forest),
+                                            3, 0, comm);
+      t8_forest_unref (&forest);
+      forest = forest_adapt;
+    }
+    num_elements = t8_forest_get_local_num_elements (forest);
+    scalars = T8_ALLOC (double, SC_MAX (num_elements, 1));
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      scalars[ielem] = step + ielem;
+    }
+    field.data = scalars;
+    retval = t8_forest_hdf5_series_write (series, forest, 0.5 * step, 1, 1,
+                                          1, 1, &field);
+#if T8_WITH_HDF5
+    SC_CHECK_ABORT (retval, "Error writing hdf5 time series");
+    t8_test_hdf5_check_step (comm, fileprefix, step, step != 1);
+#else
+    SC_CHECK_ABORT (!retval, "Wrote hdf5 file without hdf5 support");
+#endif
+    T8_FREE (scalars);
+  }
+  t8_forest_hdf5_series_destroy (&series);
+  t8_forest_unref (&forest);
+}
+
+static void
+t8_test_hdf5 (sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh;
+  t8_vtk_data_field_t fields[2];
+  double             *scalars, *vectors;
+  t8_locidx_t         num_elements, ielem;
+  const char         *fileprefix = "t8_test_hdf5";
+  int                 eclass, level = 2;
+  int                 retval;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; eclass++) {
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (),
+                                    level, 0, comm);
+    num_elements = t8_forest_get_local_num_elements (forest);
+    scalars = T8_ALLOC (double, num_elements);
+    vectors = T8_ALLOC (double, 3 * num_elements);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      scalars[ielem] = ielem;
+      vectors[3 * ielem] = vectors[3 * ielem + 1] = vectors[3 * ielem + 2] =
+        ielem;
+    }
+    fields[0].type = T8_VTK_SCALAR;
+    snprintf (fields[0].description, BUFSIZ, "scalar");
+    fields[0].data = scalars;
+    fields[1].type = T8_VTK_VECTOR;
+    snprintf (fields[1].description, BUFSIZ, "vector");
+    fields[1].data = vectors;
+
+    retval = t8_forest_write_hdf5 (forest, fileprefix, 1, 1, 1, 2, fields);
+#if T8_WITH_HDF5
+    SC_CHECK_ABORT (retval, "Error writing hdf5 file");
+    t8_test_hdf5_check_file (forest, fileprefix);
+#else
+    SC_CHECK_ABORT (!retval, "Wrote hdf5 file without hdf5 support");
+#endif
+
+    T8_FREE (scalars);
+    T8_FREE (vectors);
+    t8_forest_unref (&forest);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_test_hdf5 (sc_MPI_COMM_WORLD);
+  t8_test_hdf5_series (sc_MPI_COMM_WORLD);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+  return 0;
+}
@@ -0,0 +1,251 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test the Hilbert ordered quadrilateral and hexahedral
+ * schemes of t8_scheme_new_hilbert_cxx.
+ * We enumerate all elements of a level by their linear id and check that
+ * consecutive elements share a face, that the successor, the children and
+ * the descendant ranges are consistent with the linear ids and that the
+ * children at a face are in Hilbert order.
+ * We also compare the ghost layers of uniform forests with the Morton order.
+ */
+
+/* Return true if two elements of the same level share a face. */
+static int
+test_hilbert_share_face (t8_eclass_scheme_c * ts, const t8_element_t * e1,
+                         const t8_element_t * e2, int dim)
+{
+  int                 anchor1[3], anchor2[3];
+  int                 len, idim, num_diff = 0, diff = 0;
+
+  len = ts->t8_element_root_len (e1) >> ts->t8_element_level (e1);
+  ts->t8_element_anchor (e1, anchor1);
+  ts->t8_element_anchor (e2, anchor2);
+  for (idim = 0; idim < dim; idim++) {
+    if (anchor1[idim] != anchor2[idim]) {
+      num_diff++;
+      diff = anchor1[idim] - anchor2[idim];
+    }
+  }
+  return num_diff == 1 && (diff == len || diff == -len);
+}
+
+/* Return true if an element touches the given face of the root. */
+static int
+test_hilbert_touches_face (t8_eclass_scheme_c * ts, const t8_element_t * e,
+                           int face)
+{
+  int                 anchor[3];
+  int                 len, root_len;
+
+  root_len = ts->t8_element_root_len (e);
+  len = root_len >> ts->t8_element_level (e);
+  ts->t8_element_anchor (e, anchor);
+  return (face % 2 == 0) ? anchor[face / 2] == 0
+    : anchor[face / 2] + len == root_len;
+}
+
+static void
+test_hilbert_elements (t8_eclass_scheme_c * ts, int dim, int maxlevel)
+{
+  t8_element_t       *elem, *prev, *succ, *parent, *root;
+  t8_element_t      **children, **face_children;
+  t8_linearidx_t      id, num_elements, first, last, face_first, face_last;
+  int                 level, ichild, num_children, iface, num_face_children;
+  int                 child_indices[8];
+
+  ts->t8_element_new (1, &elem);
+  ts->t8_element_new (1, &prev);
+  ts->t8_element_new (1, &succ);
+  ts->t8_element_new (1, &parent);
+  ts->t8_element_new (1, &root);
+  ts->t8_element_set_linear_id (root, 0, 0);
+  num_children = ts->t8_element_num_children (root);
+  children = T8_ALLOC (t8_element_t *, num_children);
+  ts->t8_element_new (num_children, children);
+  face_children = T8_ALLOC (t8_element_t *, num_children);
+  ts->t8_element_new (num_children, face_children);
+
+  for (level = 1; level <= maxlevel; level++) {
+    num_elements = (t8_linearidx_t) 1 << (dim * level);
+    for (id = 0; id < num_elements; id++) {
+      ts->t8_element_set_linear_id (elem, level, id);
+      SC_CHECK_ABORT (ts->t8_element_get_linear_id (elem, level) == id,
+                      "Linear id is not inverse");
+      if (id > 0) {
+        SC_CHECK_ABORT (test_hilbert_share_face (ts, prev, elem, dim),
+                        "Consecutive elements do not share a face");
+        SC_CHECK_ABORT (ts->t8_element_compare (prev, elem) < 0,
+                        "Consecutive elements are not ordered");
+        ts->t8_element_successor (prev, succ, level);
+        SC_CHECK_ABORT (!ts->t8_element_compare (succ, elem),
+                        "Wrong successor");
+      }
+      ts->t8_element_parent (elem, parent);
+      SC_CHECK_ABORT (ts->t8_element_get_linear_id (elem, level - 1)
+                      == id >> dim, "Wrong ancestor id");
+      SC_CHECK_ABORT (ts->t8_element_child_id (elem)
+                      == (int) (id % num_children), "Wrong child id");
+      if (id % num_children == 0) {
+        /* The children of the parent are the next elements */
+        ts->t8_element_children (parent, num_children, children);
+        SC_CHECK_ABORT (ts->t8_element_is_family (children),
+                        "Children are not a family");
+        for (ichild = 0; ichild < num_children; ichild++) {
+          SC_CHECK_ABORT (ts->t8_element_get_linear_id (children[ichild],
+                                                        level)
+                          == id + ichild, "Children are not in order");
+        }
+        ts->t8_element_descendant_range (parent, level, &first, &last);
+        SC_CHECK_ABORT (first == id && last == id + num_children - 1,
+                        "Wrong descendant range");
+        for (iface = 0; iface < ts->t8_element_num_faces (parent); iface++) {
+          num_face_children =
+            ts->t8_element_num_face_children (parent, iface);
+          ts->t8_element_children_at_face (parent, iface, face_children,
+                                           num_face_children,
+                                           child_indices);
+          ts->t8_element_face_descendant_range (parent, iface, level,
+                                                &face_first, &face_last);
+          for (ichild = 0; ichild < num_face_children; ichild++) {
+            SC_CHECK_ABORT (ichild == 0 || child_indices[ichild - 1]
+                            < child_indices[ichild],
+                            "Face children are not in Hilbert order");
+            SC_CHECK_ABORT (!ts->t8_element_compare
+                            (face_children[ichild],
+                             children[child_indices[ichild]]),
+                            "Wrong face child");
+          }
+          SC_CHECK_ABORT (face_first == id + child_indices[0]
+                          && face_last ==
+                          id + child_indices[num_face_children - 1],
+                          "Wrong face descendant range");
+        }
+      }
+      ts->t8_element_copy (elem, prev);
+    }
+    /* The first and last descendant at a root face are the first and last
+     * elements that touch the face */
+    for (iface = 0; iface < ts->t8_element_num_faces (root); iface++) {
+      ts->t8_element_face_descendant_range (root, iface, level,
+                                            &face_first, &face_last);
+      first = num_elements;
+      last = 0;
+      for (id = 0; id < num_elements; id++) {
+        ts->t8_element_set_linear_id (elem, level, id);
+        if (test_hilbert_touches_face (ts, elem, iface)) {
+          first = SC_MIN (first, id);
+          last = SC_MAX (last, id);
+        }
+      }
+      SC_CHECK_ABORT (first == face_first && last == face_last,
+                      "Wrong face descendant range of the root");
+    }
+  }
+
+  ts->t8_element_destroy (num_children, face_children);
+  ts->t8_element_destroy (num_children, children);
+  T8_FREE (face_children);
+  T8_FREE (children);
+  ts->t8_element_destroy (1, &root);
+  ts->t8_element_destroy (1, &parent);
+  ts->t8_element_destroy (1, &succ);
+  ts->t8_element_destroy (1, &prev);
+  ts->t8_element_destroy (1, &elem);
+}
+
+static void
+test_hilbert_forests (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *morton_scheme = t8_scheme_new_default_cxx ();
+  t8_scheme_cxx_t    *hilbert_scheme = t8_scheme_new_hilbert_cxx ();
+  t8_eclass_t         eclasses[2] = { T8_ECLASS_QUAD, T8_ECLASS_HEX };
+  t8_forest_t         forest_morton, forest_hilbert;
+  t8_cmesh_t          cmesh;
+  t8_locidx_t         num_ghosts[2], global_ghosts[2];
+  int                 iclass, level, mpiret;
+  int                 maxlevel = 4;
+
+  for (iclass = 0; iclass < 2; iclass++) {
+    for (level = 0; level < maxlevel; ++level) {
+      cmesh = t8_cmesh_new_hypercube (eclasses[iclass], comm, 0, 0, 0);
+      t8_cmesh_ref (cmesh);
+      t8_scheme_cxx_ref (morton_scheme);
+      t8_scheme_cxx_ref (hilbert_scheme);
+      forest_morton =
+        t8_forest_new_uniform (cmesh, morton_scheme, level, 1, comm);
+      forest_hilbert =
+        t8_forest_new_uniform (cmesh, hilbert_scheme, level, 1, comm);
+      SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest_morton)
+                      == t8_forest_get_local_num_elements (forest_hilbert),
+                      "Hilbert forest has a different partition");
+      num_ghosts[0] = t8_forest_get_num_ghosts (forest_morton);
+      num_ghosts[1] = t8_forest_get_num_ghosts (forest_hilbert);
+      mpiret = sc_MPI_Allreduce (num_ghosts, global_ghosts, 2,
+                                 T8_MPI_LOCIDX, sc_MPI_SUM, comm);
+      SC_CHECK_MPI (mpiret);
+      t8_global_productionf ("%s level %i: %li ghosts in Morton and %li "
+                             "ghosts in Hilbert order\n",
+                             t8_eclass_to_string[eclasses[iclass]], level,
+                             (long) global_ghosts[0],
+                             (long) global_ghosts[1]);
+      t8_forest_unref (&forest_morton);
+      t8_forest_unref (&forest_hilbert);
+    }
+  }
+  t8_scheme_cxx_unref (&morton_scheme);
+  t8_scheme_cxx_unref (&hilbert_scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  t8_scheme_cxx_t    *scheme;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing Hilbert quad and hex schemes.\n");
+  scheme = t8_scheme_new_hilbert_cxx ();
+  test_hilbert_elements (scheme->eclass_schemes[T8_ECLASS_QUAD], 2, 4);
+  test_hilbert_elements (scheme->eclass_schemes[T8_ECLASS_HEX], 3, 3);
+  t8_scheme_cxx_unref (&scheme);
+  test_hilbert_forests (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing Hilbert quad and hex schemes.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
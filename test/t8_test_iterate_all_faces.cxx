@@ -0,0 +1,260 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_iterate.h>
+
+/*
+ * In this file we test the iteration over all faces of a forest.
+ * We count for each face of each local element how often it is passed
+ * to the callback, either as the face of the element or as the dual face
+ * of a local neighbor. Each face must be counted exactly once.
+ * We then check that t8_forest_iterate passes each element once in order
+ * to the volume and prefetch callbacks and each corner of each element
+ * exactly once to the corner callback.
+ */
+
+/* The state of the volume, corner and prefetch callbacks */
+typedef struct
+{
+  t8_locidx_t         next_volume;      /* The next expected volume */
+  t8_locidx_t         next_prefetch;    /* The next expected prefetch */
+  t8_locidx_t         prefetch_distance;        /* The prefetch distance */
+  int                *corner_counts;    /* For each corner of each element its number of visits */
+} t8_test_iterate_state_t;
+
+/* Count the visits of the faces stored in the user data, an array with
+ * T8_ECLASS_MAX_FACES ints per local element */
+static void
+t8_test_iterate_all_faces_count (t8_forest_t forest,
+                                 const t8_forest_face_info_t * info,
+                                 void *user_data)
+{
+  int                *counts = (int *) user_data;
+  const t8_locidx_t   num_local = t8_forest_get_local_num_elements (forest);
+  int                 ineigh;
+
+  SC_CHECK_ABORT (info->element ==
+                  t8_forest_get_element (forest, info->element_index, NULL),
+                  "Wrong element index passed to face callback");
+  /* The forests in this test are uniform */
+  SC_CHECK_ABORT (!info->is_hanging, "Wrong hanging face information");
+  counts[T8_ECLASS_MAX_FACES * info->element_index + info->face]++;
+  for (ineigh = 0; ineigh < info->num_neighbors; ineigh++) {
+    if (info->neighbor_indices[ineigh] < num_local
+        && (info->neighbor_indices[ineigh] != info->element_index
+            || info->dual_faces[ineigh] != info->face)) {
+      counts[T8_ECLASS_MAX_FACES * info->neighbor_indices[ineigh]
+             + info->dual_faces[ineigh]]++;
+    }
+  }
+}
+
+static void
+t8_test_iterate_volume (t8_forest_t forest, t8_locidx_t ltreeid,
+                        const t8_element_t * element,
+                        t8_locidx_t element_index, void *user_data)
+{
+  t8_test_iterate_state_t *state = (t8_test_iterate_state_t *) user_data;
+
+  SC_CHECK_ABORT (element_index == state->next_volume,
+                  "Volumes are not passed in order");
+  SC_CHECK_ABORT (element == t8_forest_get_element_in_tree
+                  (forest, ltreeid,
+                   element_index - t8_forest_get_tree_element_offset (forest,
+                                                                      ltreeid)),
+                  "Wrong element passed to volume callback");
+  SC_CHECK_ABORT (state->next_prefetch ==
+                  SC_MIN (element_index + 1 + state->prefetch_distance,
+                          t8_forest_get_local_num_elements (forest)),
+                  "Element was not prefetched");
+  state->next_volume++;
+}
+
+static void
+t8_test_iterate_prefetch (t8_forest_t forest, t8_locidx_t element_index,
+                          void *user_data)
+{
+  t8_test_iterate_state_t *state = (t8_test_iterate_state_t *) user_data;
+
+  SC_CHECK_ABORT (element_index == state->next_prefetch,
+                  "Elements are not prefetched in order");
+  state->next_prefetch++;
+}
+
+static void
+t8_test_iterate_corner (t8_forest_t forest,
+                        const t8_forest_corner_info_t * info,
+                        void *user_data)
+{
+  t8_test_iterate_state_t *state = (t8_test_iterate_state_t *) user_data;
+  int                 iside;
+
+  SC_CHECK_ABORT (info->num_sides > 0, "Corner without elements");
+  for (iside = 0; iside < info->num_sides; iside++) {
+    SC_CHECK_ABORT (iside == 0 || info->element_indices[iside - 1]
+                    <= info->element_indices[iside],
+                    "Corner elements are not sorted");
+    state->corner_counts[T8_ECLASS_MAX_CORNERS * info->element_indices[iside]
+                         + info->corners[iside]]++;
+  }
+}
+
+/* Check the volumes, corners and prefetches of t8_forest_iterate */
+static void
+t8_test_iterate_check (t8_forest_t forest, t8_locidx_t prefetch_distance)
+{
+  t8_test_iterate_state_t state;
+  t8_locidx_t         itree, ielem, num_elements, lelement;
+  t8_eclass_scheme_c *ts;
+  int                 icorner, num_corners;
+
+  state.next_volume = 0;
+  state.next_prefetch = 0;
+  state.prefetch_distance = prefetch_distance;
+  state.corner_counts = T8_ALLOC_ZERO (int, T8_ECLASS_MAX_CORNERS *
+                                       t8_forest_get_local_num_elements
+                                       (forest));
+  t8_forest_iterate (forest, t8_test_iterate_volume, NULL,
+                     t8_test_iterate_corner, t8_test_iterate_prefetch,
+                     prefetch_distance, &state, 1);
+  SC_CHECK_ABORT (state.next_volume ==
+                  t8_forest_get_local_num_elements (forest),
+                  "Not all volumes were passed");
+  for (itree = 0, lelement = 0;
+       itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, lelement++) {
+      num_corners =
+        ts->t8_element_num_corners (t8_forest_get_element_in_tree
+                                    (forest, itree, ielem));
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        SC_CHECK_ABORT (state.corner_counts[T8_ECLASS_MAX_CORNERS * lelement
+                                            + icorner] == 1,
+                        "Corner was not passed exactly once");
+      }
+    }
+  }
+  T8_FREE (state.corner_counts);
+}
+
+static void
+t8_test_iterate_all_faces_check (t8_forest_t forest, int balanced)
+{
+  t8_locidx_t         itree, ielem, num_elements, lelement;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  int                *counts;
+  int                 iface, num_faces;
+
+  counts = T8_ALLOC_ZERO (int, T8_ECLASS_MAX_FACES *
+                          t8_forest_get_local_num_elements (forest));
+  t8_forest_iterate_all_faces (forest, t8_test_iterate_all_faces_count,
+                               counts, balanced);
+  for (itree = 0, lelement = 0;
+       itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_faces = ts->t8_element_num_faces (element);
+      for (iface = 0; iface < num_faces; iface++) {
+        SC_CHECK_ABORTF (counts[T8_ECLASS_MAX_FACES * lelement + iface] == 1,
+                         "Face %i of element %i was passed %i times", iface,
+                         lelement,
+                         counts[T8_ECLASS_MAX_FACES * lelement + iface]);
+      }
+    }
+  }
+  T8_FREE (counts);
+}
+
+static void
+t8_test_iterate_all_faces (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  int                 eclass, level, mpisize, mpiret;
+  int                 maxlevel = 3;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* Face neighbors of pyramids are not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      /* Build a uniform forest with ghosts */
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+      t8_forest_commit (forest);
+      t8_test_iterate_all_faces_check (forest, 1);
+      t8_test_iterate_check (forest, 0);
+      t8_test_iterate_check (forest, 3);
+      if (mpisize == 1) {
+        /* In parallel the unbalanced neighbor search would need a ghost
+         * layer for unbalanced forests */
+        t8_test_iterate_all_faces_check (forest, 0);
+      }
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the iteration over all faces.\n");
+  t8_test_iterate_all_faces (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the iteration over all faces.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_vec.h>
+
+/*
+ * In this file we test the refinement around a level set.
+ * Without balance, each leaf element of the adapted forest has at least
+ * the minimum level and either has the maximum level or is not in the band
+ * around the zero level set.
+ */
+
+/* The signed distance to a sphere around (0.5, 0.5, 0.5) */
+static double
+t8_test_level_set_sphere (const double x[3], void *udata)
+{
+  const double        center[3] = { 0.5, 0.5, 0.5 };
+
+  return t8_vec_dist (x, center) - *(double *) udata;
+}
+
+static void
+t8_test_level_set_check (t8_forest_t forest, double radius,
+                         double band_width, int min_level, int max_level)
+{
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  double             *tree_vertices;
+  double              centroid[3], value, diam;
+  t8_locidx_t         itree, ielem;
+  int                 level;
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      level = ts->t8_element_level (element);
+      SC_CHECK_ABORT (min_level <= level && level <= max_level,
+                      "Element level out of range");
+      if (level < max_level) {
+        t8_forest_element_centroid (forest, itree, element, tree_vertices,
+                                    centroid);
+        value = t8_test_level_set_sphere (centroid, &radius);
+        diam = t8_forest_element_diam (forest, itree, element,
+                                       tree_vertices);
+        SC_CHECK_ABORT (fabs (value) >= band_width * diam,
+                        "Element in the band is not refined");
+      }
+    }
+  }
+}
+
+static void
+t8_test_level_set (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  const t8_eclass_t   eclasses[2] = { T8_ECLASS_QUAD, T8_ECLASS_HEX };
+  double              radius = 0.3, band_width = 1;
+  int                 min_level = 1, max_level = 4;
+  int                 ieclass;
+
+  for (ieclass = 0; ieclass < 2; ieclass++) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclasses[ieclass]]);
+    t8_scheme_cxx_ref (ts);
+    forest =
+      t8_forest_new_uniform (t8_cmesh_new_hypercube
+                             (eclasses[ieclass], comm, 0, 0, 0), ts, 0, 0,
+                             comm);
+    forest = t8_forest_new_level_set (forest, t8_test_level_set_sphere,
+                                      &radius, band_width, min_level,
+                                      max_level, 0, 0);
+    t8_test_level_set_check (forest, radius, band_width, min_level,
+                             max_level);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing level set refinement.\n");
+  t8_test_level_set (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing level set refinement.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
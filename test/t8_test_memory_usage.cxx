@@ -0,0 +1,155 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the memory accounting of forests and cmeshes.
+ * We adapt, partition and ghost a uniform forest with profiling enabled
+ * and check that the components add up, that the local and ghost elements
+ * are covered and that the high-water mark of commit includes the final
+ * forest and the forest that it is derived from.
+ */
+
+#define T8_TEST_MEMORY_USAGE_MAXLEVEL 3
+
+/* Refine every second element */
+static int
+t8_test_memory_usage_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                            t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                            t8_eclass_scheme_c * ts, int num_elements,
+                            t8_element_t * elements[])
+{
+  return lelement_id % 2 == 0
+    && ts->t8_element_level (elements[0]) < T8_TEST_MEMORY_USAGE_MAXLEVEL;
+}
+
+/* Check the memory usage of a committed forest */
+static void
+t8_test_memory_usage_check (t8_forest_t forest,
+                            t8_forest_memory_usage_t * usage)
+{
+  t8_locidx_t         itree;
+  size_t              element_bytes = 0;
+
+  t8_forest_memory_usage (forest, usage);
+  SC_CHECK_ABORT (usage->total == usage->forest + usage->leaves
+                  + usage->ghosts + usage->hash_tables + usage->offsets
+                  + usage->caches + usage->profile,
+                  "Memory components do not add up");
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    element_bytes += t8_forest_get_tree_num_elements (forest, itree)
+      * t8_forest_get_eclass_scheme (forest,
+                                     t8_forest_get_tree_class (forest,
+                                                               itree))->
+      t8_element_size ();
+  }
+  SC_CHECK_ABORT (usage->leaves >= element_bytes,
+                  "Memory of the local elements is not counted");
+  SC_CHECK_ABORT (usage->offsets > 0, "Memory of the offsets is not counted");
+  if (t8_forest_get_num_ghosts (forest) > 0) {
+    SC_CHECK_ABORT (usage->ghosts > 0 && usage->hash_tables > 0,
+                    "Memory of the ghosts is not counted");
+  }
+}
+
+static void
+t8_test_memory_usage (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  t8_forest_memory_usage_t usage, usage_from;
+  t8_cmesh_memory_usage_t cmesh_usage;
+  t8_cmesh_t          cmesh;
+  int                 eclass;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    t8_scheme_cxx_ref (ts);
+    forest =
+      t8_forest_new_uniform (t8_cmesh_new_from_class
+                             ((t8_eclass_t) eclass, comm), ts, 1, 0, comm);
+    t8_test_memory_usage_check (forest, &usage_from);
+    SC_CHECK_ABORT (usage_from.ghosts == 0 && usage_from.profile == 0,
+                    "Memory of a missing component is counted");
+
+    /* Adapt, partition and ghost the forest with profiling */
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_adapt);
+    t8_forest_set_adapt (forest_adapt, forest, t8_test_memory_usage_adapt,
+                         1);
+    t8_forest_set_partition (forest_adapt, NULL, 0);
+    t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+    t8_forest_set_profiling (forest_adapt, 1);
+    t8_forest_commit (forest_adapt);
+    t8_test_memory_usage_check (forest_adapt, &usage);
+    SC_CHECK_ABORT (usage.profile > 0, "Memory of the profile is not counted");
+    SC_CHECK_ABORT (t8_forest_profile_get_memory_high_water (forest_adapt)
+                    >= usage.total, "High-water mark below final usage");
+    SC_CHECK_ABORT (t8_forest_profile_get_memory_high_water (forest_adapt)
+                    >= usage_from.total, "High-water mark below usage of "
+                    "the source forest");
+
+    /* The cmesh */
+    cmesh = t8_forest_get_cmesh (forest_adapt);
+    t8_cmesh_memory_usage (cmesh, &cmesh_usage);
+    SC_CHECK_ABORT (cmesh_usage.total == cmesh_usage.cmesh
+                    + cmesh_usage.trees + cmesh_usage.hash_tables
+                    + cmesh_usage.offsets + cmesh_usage.face_table
+                    + cmesh_usage.profile,
+                    "Cmesh memory components do not add up");
+    SC_CHECK_ABORT (t8_cmesh_get_num_local_trees (cmesh) == 0
+                    || cmesh_usage.trees > 0,
+                    "Memory of the trees is not counted");
+
+    t8_forest_unref (&forest_adapt);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing memory usage.\n");
+  t8_test_memory_usage (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing memory usage.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
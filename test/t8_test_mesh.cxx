@@ -0,0 +1,159 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_mesh.h>
+
+/*
+ * In this file we test the explicit mesh of a forest.
+ * We build uniform forests on the unit hypercube and check that the nodes
+ * and their supports are consistent and, for the tensor product classes,
+ * that the number of nodes is the number of points of the uniform grid.
+ */
+
+static void
+t8_test_mesh_check (t8_forest_t forest, t8_eclass_t eclass, int level)
+{
+  t8_mesh_t          *mesh;
+  const t8_locidx_t  *nodes, *support;
+  t8_locidx_t         ielem, lnode, total_corners, total_support;
+  t8_gloidx_t         num_owned, global_num_owned, gloid, expected;
+  int                 num_nodes, length_support, icorner, isupport;
+  int                 found, mpiret;
+
+  mesh = t8_mesh_new_from_forest (forest);
+  SC_CHECK_ABORT (t8_mesh_get_num_elements (mesh)
+                  == t8_forest_get_local_num_elements (forest),
+                  "Wrong number of mesh elements");
+
+  /* Each corner of an element is a node whose support contains it */
+  total_corners = 0;
+  for (ielem = 0; ielem < t8_mesh_get_num_elements (mesh); ielem++) {
+    nodes = t8_mesh_get_element_nodes (mesh, ielem, &num_nodes);
+    SC_CHECK_ABORT (num_nodes == t8_eclass_num_vertices
+                    [t8_mesh_get_element_class (mesh, ielem)],
+                    "Wrong number of element nodes");
+    for (icorner = 0; icorner < num_nodes; icorner++) {
+      SC_CHECK_ABORT (0 <= nodes[icorner]
+                      && nodes[icorner] < t8_mesh_get_num_nodes (mesh),
+                      "Invalid element node");
+      support = t8_mesh_get_node_support (mesh, nodes[icorner],
+                                          &length_support);
+      for (isupport = 0, found = 0; isupport < length_support; isupport++) {
+        found = found || support[isupport] == ielem;
+      }
+      SC_CHECK_ABORT (found, "Element is not in the support of its node");
+    }
+    total_corners += num_nodes;
+  }
+
+  /* The owned nodes come first and have consecutive global ids */
+  total_support = 0;
+  for (lnode = 0; lnode < t8_mesh_get_num_nodes (mesh); lnode++) {
+    gloid = t8_mesh_get_node_gloid (mesh, lnode);
+    SC_CHECK_ABORT (0 <= gloid && gloid < t8_mesh_get_global_num_nodes (mesh),
+                    "Invalid global node id");
+    if (lnode < t8_mesh_get_num_owned_nodes (mesh)) {
+      SC_CHECK_ABORT (lnode == 0 || gloid == t8_mesh_get_node_gloid
+                      (mesh, lnode - 1) + 1, "Owned ids not consecutive");
+    }
+    (void) t8_mesh_get_node_support (mesh, lnode, &length_support);
+    SC_CHECK_ABORT (0 < length_support
+                    && length_support <= t8_mesh_get_maximum_support (mesh),
+                    "Invalid node support");
+    total_support += length_support;
+  }
+  SC_CHECK_ABORT (total_support == total_corners,
+                  "Supports do not match the element nodes");
+
+  num_owned = t8_mesh_get_num_owned_nodes (mesh);
+  mpiret = sc_MPI_Allreduce (&num_owned, &global_num_owned, 1,
+                             T8_MPI_GLOIDX, sc_MPI_SUM,
+                             t8_mesh_get_comm (mesh));
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (global_num_owned == t8_mesh_get_global_num_nodes (mesh),
+                  "Each node must have exactly one owner");
+  if (eclass == T8_ECLASS_LINE || eclass == T8_ECLASS_QUAD
+      || eclass == T8_ECLASS_HEX) {
+    expected = sc_intpow64 ((1 << level) + 1, t8_eclass_to_dimension[eclass]);
+    SC_CHECK_ABORT (t8_mesh_get_global_num_nodes (mesh) == expected,
+                    "Wrong global number of nodes");
+  }
+  t8_mesh_destroy (mesh);
+}
+
+static void
+t8_test_mesh (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* The ghost layer of pyramids is not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      t8_scheme_cxx_ref (scheme);
+      t8_forest_init (&forest);
+      t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube
+                           ((t8_eclass_t) eclass, comm, 0, 0, 0), comm);
+      t8_forest_set_scheme (forest, scheme);
+      t8_forest_set_level (forest, level);
+      t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+      t8_forest_commit (forest);
+      t8_test_mesh_check (forest, (t8_eclass_t) eclass, level);
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the explicit mesh of a forest.\n");
+  t8_test_mesh (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the explicit mesh of a forest.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <p4est_bits.h>
+#include <p8est_bits.h>
+#include <t8_schemes/t8_default/t8_default_morton.h>
+
+/*
+ * In this file we test that the Morton code arithmetic of
+ * t8_default_morton.h computes the same linear ids, quadrants from ids
+ * and nearest common ancestors as the corresponding p4est functions.
+ * We check all quadrants and octants of the first levels and random
+ * pairs for the nearest common ancestor.
+ */
+
+static void
+test_morton_quad (int maxlevel)
+{
+  p4est_quadrant_t    q, r, nca1, nca2;
+  t8_linearidx_t      id, num_ids;
+  int                 level, ilevel, ipair;
+
+  for (level = 0; level <= maxlevel; level++) {
+    num_ids = (t8_linearidx_t) 1 << P4EST_DIM * level;
+    for (id = 0; id < num_ids; id++) {
+      p4est_quadrant_set_morton (&q, level, id);
+      memset (&r, 0, sizeof (r));
+      t8_morton_quad_set (&r, level, id);
+      SC_CHECK_ABORT (p4est_quadrant_is_equal (&q, &r),
+                      "Wrong quadrant from Morton index");
+      for (ilevel = 0; ilevel <= maxlevel; ilevel++) {
+        SC_CHECK_ABORT (t8_morton_quad_linear_id (&q, ilevel) ==
+                        p4est_quadrant_linear_id (&q, ilevel),
+                        "Wrong Morton index of quadrant");
+      }
+    }
+  }
+  /* Random pairs at the maximum level for the nearest common ancestor */
+  num_ids = (t8_linearidx_t) 1 << P4EST_DIM * P4EST_QMAXLEVEL;
+  for (ipair = 0; ipair < 10000; ipair++) {
+    p4est_quadrant_set_morton (&q, P4EST_QMAXLEVEL - ipair % 5,
+                               ((t8_linearidx_t) rand () * 7919) %
+                               (num_ids >> P4EST_DIM * (ipair % 5)));
+    p4est_quadrant_set_morton (&r, P4EST_QMAXLEVEL - ipair % 3,
+                               ((t8_linearidx_t) rand () * 104729) %
+                               (num_ids >> P4EST_DIM * (ipair % 3)));
+    p4est_nearest_common_ancestor (&q, &r, &nca1);
+    t8_morton_quad_nca (&q, &r, &nca2);
+    SC_CHECK_ABORT (p4est_quadrant_is_equal (&nca1, &nca2),
+                    "Wrong nearest common ancestor of quadrants");
+  }
+}
+
+static void
+test_morton_oct (int maxlevel)
+{
+  p8est_quadrant_t    q, r, nca1, nca2;
+  t8_linearidx_t      id, num_ids;
+  int                 level, ilevel, ipair;
+
+  for (level = 0; level <= maxlevel; level++) {
+    num_ids = (t8_linearidx_t) 1 << P8EST_DIM * level;
+    for (id = 0; id < num_ids; id++) {
+      p8est_quadrant_set_morton (&q, level, id);
+      memset (&r, 0, sizeof (r));
+      t8_morton_oct_set (&r, level, id);
+      SC_CHECK_ABORT (p8est_quadrant_is_equal (&q, &r),
+                      "Wrong octant from Morton index");
+      for (ilevel = 0; ilevel <= maxlevel; ilevel++) {
+        SC_CHECK_ABORT (t8_morton_oct_linear_id (&q, ilevel) ==
+                        p8est_quadrant_linear_id (&q, ilevel),
+                        "Wrong Morton index of octant");
+      }
+    }
+  }
+  num_ids = (t8_linearidx_t) 1 << P8EST_DIM * P8EST_QMAXLEVEL;
+  for (ipair = 0; ipair < 10000; ipair++) {
+    p8est_quadrant_set_morton (&q, P8EST_QMAXLEVEL - ipair % 5,
+                               ((t8_linearidx_t) rand () * 7919) %
+                               (num_ids >> P8EST_DIM * (ipair % 5)));
+    p8est_quadrant_set_morton (&r, P8EST_QMAXLEVEL - ipair % 3,
+                               ((t8_linearidx_t) rand () * 104729) %
+                               (num_ids >> P8EST_DIM * (ipair % 3)));
+    p8est_nearest_common_ancestor (&q, &r, &nca1);
+    t8_morton_oct_nca (&q, &r, &nca2);
+    SC_CHECK_ABORT (p8est_quadrant_is_equal (&nca1, &nca2),
+                    "Wrong nearest common ancestor of octants");
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  srand (0);
+  t8_global_productionf ("Testing Morton code arithmetic.\n");
+  test_morton_quad (5);
+  test_morton_oct (3);
+  t8_global_productionf ("Done testing Morton code arithmetic.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
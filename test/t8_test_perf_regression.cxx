@@ -0,0 +1,268 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+#include <unistd.h>
+
+/*
+ * In this file we test the performance of fixed workloads against stored
+ * baselines. This test is only built with --enable-perftests.
+ * We measure
+ *  - the ghost creation of a uniform level 7 hexahedral forest,
+ *  - the adaptation and balance of a forest on the hybrid gate cmesh.
+ * For each workload we store the fastest of a few runs, maximized over all
+ * processes, and the memory high-water mark of commit.
+ *
+ * The baselines are stored per machine and number of processes in the file
+ * t8_perf_baseline_<hostname>.txt in the directory given by the environment
+ * variable T8_PERF_BASELINE_DIR, default the working directory.
+ * If a baseline does not exist, it is recorded and the test passes.
+ * The test fails if a runtime or memory exceeds its baseline by more than
+ * the factor in T8_PERF_TOLERANCE, default 1.5. To record new baselines
+ * remove the file.
+ */
+
+#define T8_TEST_PERF_NUM_RUNS 3
+#define T8_TEST_PERF_LINE 256
+
+/* The measurement of a workload */
+typedef struct
+{
+  char                name[T8_TEST_PERF_LINE];  /* Workload and mpisize */
+  double              runtime;  /* The fastest runtime in seconds */
+  double              memory;   /* The memory high-water mark in bytes */
+} t8_test_perf_result_t;
+
+/* Refine every third element up to level 5 on the hybrid gate */
+static int
+t8_test_perf_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                    t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                    t8_eclass_scheme_c * ts, int num_elements,
+                    t8_element_t * elements[])
+{
+  return lelement_id % 3 == 0 && ts->t8_element_level (elements[0]) < 5;
+}
+
+/* Store the maximum over all processes of a runtime and a memory usage in
+ * result, if the runtime is faster than the runtime stored so far. */
+static void
+t8_test_perf_update (t8_test_perf_result_t * result, double runtime,
+                     size_t memory, sc_MPI_Comm comm)
+{
+  double              local[2], global[2];
+  int                 mpiret;
+
+  local[0] = runtime;
+  local[1] = (double) memory;
+  mpiret = sc_MPI_Allreduce (local, global, 2, sc_MPI_DOUBLE, sc_MPI_MAX,
+                             comm);
+  SC_CHECK_MPI (mpiret);
+  if (result->runtime < 0 || global[0] < result->runtime) {
+    result->runtime = global[0];
+    result->memory = global[1];
+  }
+}
+
+/* Create the ghost layer of a uniform level 7 hexahedral forest */
+static void
+t8_test_perf_ghost (t8_test_perf_result_t * result, sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_ghost;
+  t8_locidx_t         ghosts_sent;
+  int                 irun;
+
+  t8_global_productionf ("Timing ghost creation on a uniform hex forest\n");
+  forest =
+    t8_forest_new_uniform (t8_cmesh_new_hypercube (T8_ECLASS_HEX, comm, 0, 0,
+                                                   0),
+                           t8_scheme_new_default_cxx (), 7, 0, comm);
+  for (irun = 0; irun < T8_TEST_PERF_NUM_RUNS; irun++) {
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_ghost);
+    t8_forest_set_copy (forest_ghost, forest);
+    t8_forest_set_ghost (forest_ghost, 1, T8_GHOST_FACES);
+    t8_forest_set_profiling (forest_ghost, 1);
+    t8_forest_commit (forest_ghost);
+    t8_test_perf_update (result,
+                         t8_forest_profile_get_ghost_time (forest_ghost,
+                                                           &ghosts_sent),
+                         t8_forest_profile_get_memory_high_water
+                         (forest_ghost), comm);
+    t8_forest_unref (&forest_ghost);
+  }
+  t8_forest_unref (&forest);
+}
+
+/* Adapt and balance a forest on the hybrid gate */
+static void
+t8_test_perf_adapt_balance (t8_test_perf_result_t * result,
+                            sc_MPI_Comm comm)
+{
+  t8_forest_t         forest, forest_adapt;
+  int                 irun, balance_rounds;
+  double              runtime;
+
+  t8_global_productionf ("Timing adapt and balance on the hybrid gate\n");
+  forest = t8_forest_new_uniform (t8_cmesh_new_hybrid_gate (comm),
+                                  t8_scheme_new_default_cxx (), 2, 0, comm);
+  for (irun = 0; irun < T8_TEST_PERF_NUM_RUNS; irun++) {
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_adapt);
+    t8_forest_set_adapt (forest_adapt, forest, t8_test_perf_adapt, 1);
+    t8_forest_set_balance (forest_adapt, NULL, 1);
+    t8_forest_set_profiling (forest_adapt, 1);
+    t8_forest_commit (forest_adapt);
+    runtime = t8_forest_profile_get_adapt_time (forest_adapt)
+      + t8_forest_profile_get_balance_time (forest_adapt, &balance_rounds);
+    t8_test_perf_update (result, runtime,
+                         t8_forest_profile_get_memory_high_water
+                         (forest_adapt), comm);
+    t8_forest_unref (&forest_adapt);
+  }
+  t8_forest_unref (&forest);
+}
+
+/* Compare the results with the baselines in filename and return the number
+ * of regressions. Baselines that do not exist are appended to the file. */
+static int
+t8_test_perf_compare (const char *filename, t8_test_perf_result_t * results,
+                      int num_results, double tolerance)
+{
+  FILE               *file;
+  char                line[T8_TEST_PERF_LINE], name[T8_TEST_PERF_LINE];
+  double              runtime, memory;
+  int                 iresult, *found, num_regressions = 0;
+
+  found = T8_ALLOC_ZERO (int, num_results);
+  file = fopen (filename, "r");
+  if (file != NULL) {
+    while (fgets (line, T8_TEST_PERF_LINE, file) != NULL) {
+      if (sscanf (line, "%255s %lf %lf", name, &runtime, &memory) != 3) {
+        continue;
+      }
+      for (iresult = 0; iresult < num_results; iresult++) {
+        if (strcmp (name, results[iresult].name) != 0) {
+          continue;
+        }
+        found[iresult] = 1;
+        t8_global_productionf ("%s: %.6f s (baseline %.6f s), %.0f bytes "
+                               "(baseline %.0f bytes)\n", name,
+                               results[iresult].runtime, runtime,
+                               results[iresult].memory, memory);
+        if (results[iresult].runtime > tolerance * runtime) {
+          t8_global_errorf ("Runtime regression in %s\n", name);
+          num_regressions++;
+        }
+        if (results[iresult].memory > tolerance * memory) {
+          t8_global_errorf ("Memory regression in %s\n", name);
+          num_regressions++;
+        }
+      }
+    }
+    fclose (file);
+  }
+  /* Record the missing baselines */
+  for (iresult = 0; iresult < num_results; iresult++) {
+    if (found[iresult]) {
+      continue;
+    }
+    file = fopen (filename, "a");
+    SC_CHECK_ABORTF (file != NULL, "Could not open file %s", filename);
+    fprintf (file, "%s %.9g %.0f\n", results[iresult].name,
+             results[iresult].runtime, results[iresult].memory);
+    fclose (file);
+    t8_global_productionf ("Recorded baseline of %s in %s\n",
+                           results[iresult].name, filename);
+  }
+  T8_FREE (found);
+  return num_regressions;
+}
+
+static void
+t8_test_perf_regression (sc_MPI_Comm comm)
+{
+  t8_test_perf_result_t results[2];
+  const char         *dir, *tolerance_string;
+  char                hostname[T8_TEST_PERF_LINE];
+  char                filename[BUFSIZ];
+  double              tolerance;
+  int                 mpisize, mpirank, mpiret, num_regressions = 0;
+
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  memset (results, 0, sizeof (results));
+  snprintf (results[0].name, T8_TEST_PERF_LINE, "ghost_hex_level7_np%i",
+            mpisize);
+  snprintf (results[1].name, T8_TEST_PERF_LINE,
+            "adapt_balance_hybrid_gate_np%i", mpisize);
+  results[0].runtime = results[1].runtime = -1;
+  t8_test_perf_ghost (&results[0], comm);
+  t8_test_perf_adapt_balance (&results[1], comm);
+
+  if (mpirank == 0) {
+    dir = getenv ("T8_PERF_BASELINE_DIR");
+    tolerance_string = getenv ("T8_PERF_TOLERANCE");
+    tolerance = tolerance_string != NULL ? atof (tolerance_string) : 1.5;
+    SC_CHECK_ABORT (tolerance >= 1, "T8_PERF_TOLERANCE must be at least 1");
+    if (gethostname (hostname, T8_TEST_PERF_LINE) != 0) {
+      snprintf (hostname, T8_TEST_PERF_LINE, "unknown");
+    }
+    hostname[T8_TEST_PERF_LINE - 1] = '\0';
+    snprintf (filename, BUFSIZ, "%s/t8_perf_baseline_%s.txt",
+              dir != NULL ? dir : ".", hostname);
+    num_regressions = t8_test_perf_compare (filename, results, 2, tolerance);
+  }
+  mpiret = sc_MPI_Bcast (&num_regressions, 1, sc_MPI_INT, 0, comm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORTF (num_regressions == 0, "%i performance regressions",
+                   num_regressions);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing performance regressions.\n");
+  t8_test_perf_regression (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing performance regressions.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -56,6 +56,9 @@ t8_test_point_inside_level0 (sc_MPI_Comm comm, t8_eclass_t eclass)
   double             *tree_vertices;
   double              element_vertices[T8_ECLASS_MAX_CORNERS][3];
   double             *barycentric_coordinates;
+  double             *test_points;
+  int                *points_are_inside;
+  const double       *bbox;
   const double        barycentric_range_lower_bound = 0.001;    /* Must be > 0 */
   const double        barycentric_range_upper_bound = 1.1;      /* Should be > 1 */
   int                 num_steps;
@@ -88,6 +91,17 @@ t8_test_point_inside_level0 (sc_MPI_Comm comm, t8_eclass_t eclass)
                                     icorner, element_vertices[icorner]);
     }
 
+    /* The bounding box of the element must contain its corners */
+    bbox = t8_forest_leaf_bounding_box (forest, 0, 0);
+    for (icorner = 0; icorner < num_corners; ++icorner) {
+      for (icoord = 0; icoord < 3; ++icoord) {
+        SC_CHECK_ABORT (bbox[icoord] <= element_vertices[icorner][icoord]
+                        && element_vertices[icorner][icoord] <=
+                        bbox[3 + icoord],
+                        "Corner is not in the bounding box of the element.");
+      }
+    }
+
     /* Allocate the barycentric coordinates */
     barycentric_coordinates = T8_ALLOC (double, num_corners);
 
@@ -125,6 +139,8 @@ t8_test_point_inside_level0 (sc_MPI_Comm comm, t8_eclass_t eclass)
        barycentric_range_lower_bound) / (num_steps - 1);
     t8_debugf ("step size %g, steps %i, points %i (corners %i)\n", step,
                num_steps, num_points, num_corners);
+    test_points = T8_ALLOC (double, 3 * num_points);
+    points_are_inside = T8_ALLOC (int, num_points);
     int                 num_in = 0;
     double              dampening;
     for (ipoint = 0; ipoint < num_points; ++ipoint) {
@@ -180,8 +196,28 @@ t8_test_point_inside_level0 (sc_MPI_Comm comm, t8_eclass_t eclass)
                        test_point[0], test_point[1], test_point[2],
                        point_is_inside ? "" : "not",
                        t8_eclass_to_string[eclass]);
-
+      /* Store the point for the batched check */
+      for (icoord = 0; icoord < 3; ++icoord) {
+        test_points[3 * ipoint + icoord] = test_point[icoord];
+      }
+      points_are_inside[ipoint] = point_is_recognized_as_inside;
+    }
+    /* The batched check must give the same results */
+    int                *points_are_recognized_as_inside =
+      T8_ALLOC (int, num_points);
+    t8_forest_element_points_inside (forest, 0, element, tree_vertices,
+                                     test_points, num_points,
+                                     points_are_recognized_as_inside,
+                                     tolerance);
+    for (ipoint = 0; ipoint < num_points; ++ipoint) {
+      SC_CHECK_ABORTF (!points_are_recognized_as_inside[ipoint] ==
+                       !points_are_inside[ipoint],
+                       "The batched point inside check differs at point %i.",
+                       ipoint);
     }
+    T8_FREE (points_are_recognized_as_inside);
+    T8_FREE (test_points);
+    T8_FREE (points_are_inside);
     t8_debugf ("%i (%.2f%%) of test points are inside the element\n", num_in,
                (100.0 * num_in) / num_points);
 
@@ -0,0 +1,135 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_schemes/t8_default/t8_dprism_bits.h>
+
+/*
+ * In this file we test the anisotropic refinement of prisms.
+ * We refine the root prism alternately in the line and in the triangle
+ * direction and check that the parents, families and linear ids are
+ * consistent with the children. Refining a prism in both directions must
+ * give the children of the isotropic refinement.
+ */
+
+#define T8_TEST_PRISM_ANISO_MAXLEVEL 3
+
+/* Check the children of a prism in one direction */
+static void
+t8_test_prism_aniso_children (const t8_dprism_t * p, int line_direction)
+{
+  t8_dprism_t         children[T8_DTRI_CHILDREN], parent, check;
+  t8_dprism_t        *fam[T8_DTRI_CHILDREN];
+  int                 ichild, num_children;
+
+  num_children = line_direction ? T8_DLINE_CHILDREN : T8_DTRI_CHILDREN;
+  for (ichild = 0; ichild < num_children; ichild++) {
+    if (line_direction) {
+      t8_dprism_child_line (p, ichild, &children[ichild]);
+      t8_dprism_parent_line (&children[ichild], &parent);
+    }
+    else {
+      t8_dprism_child_tri (p, ichild, &children[ichild]);
+      t8_dprism_parent_tri (&children[ichild], &parent);
+    }
+    SC_CHECK_ABORT (t8_dprism_is_valid_aniso (&children[ichild]),
+                    "Invalid anisotropic child");
+    SC_CHECK_ABORT (parent.line.level == p->line.level
+                    && parent.tri.level == p->tri.level
+                    && parent.line.x == p->line.x
+                    && parent.tri.x == p->tri.x
+                    && parent.tri.y == p->tri.y
+                    && parent.tri.type == p->tri.type,
+                    "Parent of anisotropic child is wrong");
+    t8_dprism_init_linear_id_aniso (&check, children[ichild].line.level,
+                                    children[ichild].tri.level,
+                                    t8_dprism_linear_id_aniso (&children
+                                                               [ichild]));
+    SC_CHECK_ABORT (check.line.x == children[ichild].line.x
+                    && check.tri.x == children[ichild].tri.x
+                    && check.tri.y == children[ichild].tri.y
+                    && check.tri.type == children[ichild].tri.type,
+                    "Anisotropic linear id is wrong");
+    fam[ichild] = &children[ichild];
+  }
+  if (line_direction) {
+    SC_CHECK_ABORT (t8_dprism_is_family_line (fam),
+                    "Line children are no family");
+  }
+  else {
+    SC_CHECK_ABORT (t8_dprism_is_family_tri (fam),
+                    "Triangle children are no family");
+  }
+}
+
+/* Refine the root prism in one direction at a time and compare with the
+ * isotropic children. */
+static void
+t8_test_prism_aniso ()
+{
+  t8_dprism_t         root, line_child, iso_child, iso_check;
+  t8_dprism_t         levels[T8_TEST_PRISM_ANISO_MAXLEVEL + 1];
+  int                 level, ichild;
+
+  memset (&root, 0, sizeof (t8_dprism_t));
+  levels[0] = root;
+  for (level = 0; level < T8_TEST_PRISM_ANISO_MAXLEVEL; level++) {
+    t8_test_prism_aniso_children (&levels[level], 1);
+    t8_test_prism_aniso_children (&levels[level], 0);
+    for (ichild = 0; ichild < T8_DPRISM_CHILDREN; ichild++) {
+      /* The isotropic child is the triangle child of the line child */
+      t8_dprism_child (&levels[level], ichild, &iso_child);
+      t8_dprism_child_line (&levels[level], ichild / T8_DTRI_CHILDREN,
+                            &line_child);
+      t8_test_prism_aniso_children (&line_child, 0);
+      t8_dprism_child_tri (&line_child, ichild % T8_DTRI_CHILDREN,
+                           &iso_check);
+      SC_CHECK_ABORT (!t8_dprism_compare (&iso_child, &iso_check),
+                      "Anisotropic children do not match the isotropic "
+                      "children");
+    }
+    /* Continue with the last isotropic child */
+    levels[level + 1] = iso_child;
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing anisotropic prism refinement.\n");
+  t8_test_prism_aniso ();
+  t8_global_productionf ("Done testing anisotropic prism refinement.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the per-phase statistics of the forest profile.
+ * We adapt, partition and ghost a uniform forest with profiling enabled,
+ * write the profile as CSV and JSON and check that each phase of commit
+ * was called once on each process.
+ */
+
+#define T8_TEST_PROFILE_PHASES_MAXLEVEL 3
+#define T8_TEST_PROFILE_PHASES_LINE 256
+
+/* Refine every second element */
+static int
+t8_test_profile_phases_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                              t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                              t8_eclass_scheme_c * ts, int num_elements,
+                              t8_element_t * elements[])
+{
+  return lelement_id % 2 == 0
+    && ts->t8_element_level (elements[0]) < T8_TEST_PROFILE_PHASES_MAXLEVEL;
+}
+
+/* Return true if the file contains a line starting with prefix */
+static int
+t8_test_profile_phases_find (const char *filename, const char *prefix)
+{
+  FILE               *file;
+  char                line[T8_TEST_PROFILE_PHASES_LINE];
+  int                 found = 0;
+
+  file = fopen (filename, "r");
+  SC_CHECK_ABORTF (file != NULL, "Could not open %s", filename);
+  while (!found && fgets (line, T8_TEST_PROFILE_PHASES_LINE, file) != NULL) {
+    found = strncmp (line, prefix, strlen (prefix)) == 0;
+  }
+  fclose (file);
+  return found;
+}
+
+static void
+t8_test_profile_phases (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  const char         *csv_file = "test_profile_phases.csv";
+  const char         *json_file = "test_profile_phases.json";
+  int                 mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  forest =
+    t8_forest_new_uniform (t8_cmesh_new_from_class (T8_ECLASS_QUAD, comm),
+                           ts, 2, 0, comm);
+  t8_forest_init (&forest_adapt);
+  t8_forest_set_adapt (forest_adapt, forest, t8_test_profile_phases_adapt,
+                       1);
+  t8_forest_set_partition (forest_adapt, NULL, 0);
+  t8_forest_set_ghost (forest_adapt, 1, T8_GHOST_FACES);
+  t8_forest_set_profiling (forest_adapt, 1);
+  t8_forest_commit (forest_adapt);
+
+  SC_CHECK_ABORT (t8_forest_write_profile (forest_adapt, csv_file,
+                                           T8_FOREST_PROFILE_CSV),
+                  "Could not write the profile as CSV");
+  SC_CHECK_ABORT (t8_forest_write_profile (forest_adapt, json_file,
+                                           T8_FOREST_PROFILE_JSON),
+                  "Could not write the profile as JSON");
+  if (mpirank == 0) {
+    /* Each phase was called once on each process */
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "adapt/calls,1,1,1,"),
+                    "Wrong number of adapt calls");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "partition/calls,1,1,1,"),
+                    "Wrong number of partition calls");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "partition/offsets/calls,"
+                                                 "1,1,1,"),
+                    "Wrong number of partition offset calls");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "ghost/calls,1,1,1,"),
+                    "Wrong number of ghost calls");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "ghost/receive/calls,"),
+                    "Missing nested phase in the CSV profile");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (csv_file,
+                                                 "balance/calls,0,0,0,"),
+                    "Balance was counted without balancing");
+    SC_CHECK_ABORT (t8_test_profile_phases_find (json_file,
+                                                 "  \"ghost/send/bytes\": "),
+                    "Missing phase in the JSON profile");
+  }
+
+  t8_forest_unref (&forest_adapt);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing profile phases.\n");
+  t8_test_profile_phases (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing profile phases.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -24,6 +24,7 @@
 #include <t8_cmesh.h>
 #include <t8_forest.h>
 #include <t8_forest/t8_forest_iterate.h>
+#include <t8_forest/t8_forest_ghost.h>
 #include <t8_schemes/t8_default_cxx.hxx>
 
 /* A search function that matches all elements.
@@ -115,9 +116,109 @@ t8_test_search_query_all_fn (t8_forest_t forest,
   return 1;
 }
 
+/* A search function that matches all local and ghost elements.
+ * This function assumes that the forest user pointer is an sc_array
+ * with one int for each local leaf followed by one for each ghost.
+ * If this function is called for a leaf, it sets the corresponding entry to 1.
+ */
+static int
+t8_test_search_ghosts_fn (t8_forest_t forest,
+                          t8_locidx_t ltreeid,
+                          const t8_element_t *
+                          element,
+                          const int is_leaf,
+                          t8_element_array_t *
+                          leaf_elements,
+                          t8_locidx_t tree_leaf_index, void *query,
+                          size_t query_index)
+{
+  sc_array_t         *matched_leafs =
+    (sc_array_t *) t8_forest_get_user_data (forest);
+  t8_locidx_t         num_local_trees =
+    t8_forest_get_num_local_trees (forest);
+  t8_locidx_t         offset;
+
+  if (is_leaf) {
+    if (ltreeid < num_local_trees) {
+      offset = t8_forest_get_tree_element_offset (forest, ltreeid);
+    }
+    else {
+      /* The ghosts follow the local elements */
+      offset = t8_forest_get_local_num_elements (forest)
+        + t8_forest_ghost_get_tree_element_offset (forest,
+                                                   ltreeid -
+                                                   num_local_trees);
+    }
+    *(int *) t8_sc_array_index_locidx (matched_leafs,
+                                       offset + tree_leaf_index) += 1;
+  }
+  return 1;
+}
+
+/* A batched query callback that matches all queries with all elements */
+static void
+t8_test_search_batch_query_all_fn (t8_forest_t forest,
+                                   t8_locidx_t ltreeid,
+                                   const t8_element_t *
+                                   element,
+                                   const int is_leaf,
+                                   t8_element_array_t *
+                                   leaf_elements,
+                                   t8_locidx_t tree_leaf_index,
+                                   sc_array_t * queries,
+                                   const size_t * query_indices,
+                                   size_t num_active, int *matches)
+{
+  size_t              iactive;
+
+  for (iactive = 0; iactive < num_active; ++iactive) {
+    matches[iactive] =
+      t8_test_search_query_all_fn (forest, ltreeid, element, is_leaf,
+                                   leaf_elements, tree_leaf_index,
+                                   sc_array_index (queries,
+                                                   query_indices[iactive]),
+                                   query_indices[iactive]);
+  }
+}
+
+/* A partition callback that routes all queries to all processes */
+static int
+t8_test_search_partition_all_fn (t8_forest_t forest, t8_gloidx_t gtreeid,
+                                 const t8_element_t * element,
+                                 t8_eclass_scheme_c * ts, int pfirst,
+                                 int plast, void *query, size_t query_index)
+{
+  int                 mpisize, mpiret;
+
+  mpiret = sc_MPI_Comm_size (t8_forest_get_mpicomm (forest), &mpisize);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (0 <= pfirst && pfirst <= plast && plast < mpisize,
+                  "Wrong process range passed to partition callback.");
+  SC_CHECK_ABORT (*(int *) query == 42,
+                  "Wrong query argument passed to partition callback.");
+  return 1;
+}
+
+/* A query callback for the received queries of a partition search */
+static int
+t8_test_search_partition_query_fn (t8_forest_t forest,
+                                   t8_locidx_t ltreeid,
+                                   const t8_element_t *
+                                   element,
+                                   const int is_leaf,
+                                   t8_element_array_t *
+                                   leaf_elements,
+                                   t8_locidx_t tree_leaf_index, void *query,
+                                   size_t query_index)
+{
+  SC_CHECK_ABORT (*(int *) query == 42,
+                  "Wrong query argument passed to query callback.");
+  return 1;
+}
+
 static void
 t8_test_search_one_query_matches_all (sc_MPI_Comm comm, t8_eclass_t eclass,
-                                      int level)
+                                      int level, int use_index)
 {
   t8_cmesh_t          cmesh;
   t8_forest_t         forest;
@@ -127,12 +228,23 @@ t8_test_search_one_query_matches_all (sc_MPI_Comm comm, t8_eclass_t eclass,
   t8_locidx_t         num_elements;
   sc_array_t          queries;
   sc_array_t          matched_leafs;
+  int                 search_type;
+  sc_array_t          results;
+  t8_forest_search_partition_result_t *result;
+  size_t              iresult;
 
   default_scheme = t8_scheme_new_default_cxx ();
   /* Construct a cube coarse mesh */
   cmesh = t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0);
-  /* Build a uniform forest */
-  forest = t8_forest_new_uniform (cmesh, default_scheme, level, 0, comm);
+  /* Build a uniform forest, with a search index if use_index is true */
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  t8_forest_set_scheme (forest, default_scheme);
+  t8_forest_set_level (forest, level);
+  t8_forest_set_search_index (forest, use_index);
+  t8_forest_commit (forest);
+  SC_CHECK_ABORT (t8_forest_has_search_index (forest) == use_index,
+                  "Search index was not computed.");
 
   /* set up a single query containing our query */
   sc_array_init_size (&queries, sizeof (int), 1);
@@ -142,29 +254,102 @@ t8_test_search_one_query_matches_all (sc_MPI_Comm comm, t8_eclass_t eclass,
   /* set up an array in which we flag whether an element was matched in the
    * search */
   sc_array_init_size (&matched_leafs, sizeof (int), num_elements);
-  /* write 0 in every entry */
-  for (ielement = 0; ielement < num_elements; ++ielement) {
-    *(int *) t8_sc_array_index_locidx (&matched_leafs, ielement) = 0;
+  /* Set the array as user data so that we can access it in the search callback */
+  t8_forest_set_user_data (forest, &matched_leafs);
+
+  /* We test the serial, the threaded and the batched search */
+  for (search_type = 0; search_type < 3; ++search_type) {
+    /* write 0 in every entry */
+    for (ielement = 0; ielement < num_elements; ++ielement) {
+      *(int *) t8_sc_array_index_locidx (&matched_leafs, ielement) = 0;
+    }
+
+    /* Call search. This search matches all elements. After this call we expect
+     * all entries in the matched_leafs array to be set to 1.
+     * Each leaf is matched only once, so the callbacks are thread-safe. */
+    if (search_type == 1) {
+      t8_forest_search_threaded (forest, t8_test_search_all_fn,
+                                 t8_test_search_query_all_fn, &queries);
+    }
+    else if (search_type == 2) {
+      t8_forest_search_batched (forest, t8_test_search_all_fn,
+                                t8_test_search_batch_query_all_fn, &queries,
+                                1);
+    }
+    else {
+      t8_forest_search (forest, t8_test_search_all_fn,
+                        t8_test_search_query_all_fn, &queries);
+    }
+
+    /* Check whether matched_leafs entries are all 1 */
+    for (ielement = 0; ielement < num_elements; ++ielement) {
+      SC_CHECK_ABORTF (*(int *)
+                       t8_sc_array_index_locidx (&matched_leafs,
+                                                 ielement) == 1,
+                       "Search did not match all leafs. First missmatch at leaf %i.",
+                       ielement);
+    }
   }
 
-  /* Set the array as user data so that we can access it in the search callback */
+  /* The partition search matches each leaf of each process exactly once */
+  sc_array_init (&results, sizeof (t8_forest_search_partition_result_t));
+  t8_forest_search_partition (forest, t8_test_search_partition_all_fn,
+                              t8_test_search_partition_query_fn, &queries,
+                              &results);
+  SC_CHECK_ABORT ((t8_gloidx_t) results.elem_count ==
+                  t8_forest_get_global_num_elements (forest),
+                  "Partition search did not match all leafs.");
+  for (iresult = 0; iresult < results.elem_count; ++iresult) {
+    result = (t8_forest_search_partition_result_t *)
+      sc_array_index (&results, iresult);
+    SC_CHECK_ABORT (result->query_index == 0
+                    && result->element_id == (t8_gloidx_t) iresult,
+                    "Wrong result of partition search.");
+  }
+  sc_array_reset (&results);
+
+  t8_forest_unref (&forest);
+  sc_array_reset (&matched_leafs);
+  sc_array_reset (&queries);
+}
+
+/* Search a uniform forest with a face ghost layer including its ghost
+ * trees and check that each local leaf and each ghost is matched once. */
+static void
+t8_test_search_with_ghosts (sc_MPI_Comm comm, t8_eclass_t eclass, int level)
+{
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  t8_locidx_t         ielement, num_entries;
+  sc_array_t          matched_leafs;
+
+  cmesh = t8_cmesh_new_hypercube (eclass, comm, 0, 0, 0);
+  t8_forest_init (&forest);
+  t8_forest_set_cmesh (forest, cmesh, comm);
+  t8_forest_set_scheme (forest, t8_scheme_new_default_cxx ());
+  t8_forest_set_level (forest, level);
+  t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+  t8_forest_commit (forest);
+
+  num_entries = t8_forest_get_local_num_elements (forest)
+    + t8_forest_get_num_ghosts (forest);
+  sc_array_init_size (&matched_leafs, sizeof (int), num_entries);
+  for (ielement = 0; ielement < num_entries; ++ielement) {
+    *(int *) t8_sc_array_index_locidx (&matched_leafs, ielement) = 0;
+  }
   t8_forest_set_user_data (forest, &matched_leafs);
-  /* Call search. This search matches all elements. After this call we expect
-   * all entries in the matched_leafs array to be set to 1. */
-  t8_forest_search (forest, t8_test_search_all_fn,
-                    t8_test_search_query_all_fn, &queries);
 
-  /* Check whether matched_leafs entries are all 1 */
-  for (ielement = 0; ielement < num_elements; ++ielement) {
+  t8_forest_search_with_ghosts (forest, t8_test_search_ghosts_fn, NULL,
+                                NULL, 0);
+  for (ielement = 0; ielement < num_entries; ++ielement) {
     SC_CHECK_ABORTF (*(int *)
                      t8_sc_array_index_locidx (&matched_leafs, ielement) == 1,
-                     "Search did not match all leafs. First missmatch at leaf %i.",
+                     "Search with ghosts did not match leaf %i once.",
                      ielement);
   }
 
   t8_forest_unref (&forest);
   sc_array_reset (&matched_leafs);
-  sc_array_reset (&queries);
 }
 
 int
@@ -174,6 +359,7 @@ main (int argc, char **argv)
   sc_MPI_Comm         mpic;
   int                 ieclass;
   int                 ilevel;
+  int                 use_index;
   const int           maxlevel = 6;     /* the maximum refinement level to which we test */
 
   mpiret = sc_MPI_Init (&argc, &argv);
@@ -188,11 +374,25 @@ main (int argc, char **argv)
     if (ieclass != T8_ECLASS_PYRAMID) {
       /* TODO: does not work with pyramids yet */
       for (ilevel = 0; ilevel <= maxlevel; ++ilevel) {
+        for (use_index = 0; use_index < 2; ++use_index) {
+          t8_global_productionf
+            ("Testing search that matches all with eclass %s, level %i,"
+             " search index %i\n", t8_eclass_to_string[ieclass], ilevel,
+             use_index);
+          t8_test_search_one_query_matches_all (mpic, (t8_eclass_t) ieclass,
+                                                ilevel, use_index);
+        }
+      }
+    }
+  }
+
+  for (ieclass = T8_ECLASS_LINE; ieclass < T8_ECLASS_COUNT; ieclass++) {
+    if (ieclass != T8_ECLASS_PYRAMID) {
+      for (ilevel = 0; ilevel <= 3; ++ilevel) {
         t8_global_productionf
-          ("Testing search that matches all with eclass %s, level %i\n",
+          ("Testing search with ghosts with eclass %s, level %i\n",
            t8_eclass_to_string[ieclass], ilevel);
-        t8_test_search_one_query_matches_all (mpic, (t8_eclass_t) ieclass,
-                                              ilevel);
+        t8_test_search_with_ghosts (mpic, (t8_eclass_t) ieclass, ilevel);
       }
     }
   }
@@ -0,0 +1,291 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+#include <t8.h>
+#include <t8_data/t8_shmem.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_types.h>
+#include <t8_element_cxx.hxx>
+#include <t8_forest/t8_forest_ghost.h>
+
+/*
+ * In this file we test shared memory arrays on a communicator with
+ * attached node communicators, on which each array exists once per node.
+ * We fill an array with an allgather and by writing single entries and
+ * check its contents on all processes. We also check that a partitioned
+ * forest on such a communicator has the same element offsets as a forest
+ * on a communicator without node communicators.
+ * At last we check that a node aware partition with a tolerance places
+ * the boundaries between nodes as a partition without node awareness and
+ * keeps the load of each process within the tolerance.
+ * We also exchange ghost data via shared memory and check that each
+ * ghost receives the linear id of its element.
+ * On a communicator without node communicators, the best shared memory
+ * type must fall back to the basic type.
+ */
+
+#define T8_TEST_TOLERANCE 0.5
+
+static void
+t8_test_shmem_array (sc_MPI_Comm comm)
+{
+  t8_shmem_array_t    array;
+  t8_gloidx_t         value;
+  int                 mpirank, mpisize, mpiret, iproc;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  t8_shmem_array_init (&array, sizeof (t8_gloidx_t), mpisize + 1, comm);
+  value = 2 * mpirank;
+  t8_shmem_array_allgather (&value, 1, T8_MPI_GLOIDX, array, 1,
+                            T8_MPI_GLOIDX);
+  if (t8_shmem_array_start_writing (array)) {
+    t8_shmem_array_set_gloidx (array, mpisize, 2 * mpisize);
+  }
+  t8_shmem_array_end_writing (array);
+  for (iproc = 0; iproc <= mpisize; iproc++) {
+    SC_CHECK_ABORT (t8_shmem_array_get_gloidx (array, iproc) == 2 * iproc,
+                    "Wrong entry in shared memory array");
+  }
+  t8_shmem_array_destroy (&array);
+}
+
+static void
+t8_test_shmem_forest (sc_MPI_Comm comm, sc_MPI_Comm comm_nodes)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_nodes;
+  int                 level;
+
+  for (level = 0; level < 4; level++) {
+    t8_scheme_cxx_ref (scheme);
+    forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                    (T8_ECLASS_HEX, comm, 0, 0, 0),
+                                    scheme, level, 0, comm);
+    t8_scheme_cxx_ref (scheme);
+    forest_nodes = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                          (T8_ECLASS_HEX, comm_nodes, 0, 0,
+                                           0), scheme, level, 0, comm_nodes);
+    SC_CHECK_ABORT (t8_forest_get_local_num_elements (forest)
+                    == t8_forest_get_local_num_elements (forest_nodes),
+                    "Forests on different communicators differ");
+    SC_CHECK_ABORT (!memcmp (t8_shmem_array_get_array
+                             (forest->element_offsets),
+                             t8_shmem_array_get_array
+                             (forest_nodes->element_offsets),
+                             (forest->mpisize + 1) * sizeof (t8_gloidx_t)),
+                    "Element offsets on a node shared communicator differ");
+    t8_forest_unref (&forest);
+    t8_forest_unref (&forest_nodes);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+/* Elements with odd child id are three times as expensive as others */
+static double
+t8_test_shmem_weight (t8_forest_t forest_from, t8_locidx_t which_tree,
+                      t8_locidx_t lelement_id, t8_eclass_scheme_c * ts,
+                      const t8_element_t * element)
+{
+  return ts->t8_element_child_id (element) % 2 ? 3. : 1.;
+}
+
+static void
+t8_test_shmem_node_aware (sc_MPI_Comm comm_nodes)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_flat, forest_nodes;
+  sc_MPI_Comm         intranode, internode;
+  double              average;
+  t8_locidx_t         num_local;
+  int                 level, intrarank, mpiret;
+
+  sc_mpi_comm_get_node_comms (comm_nodes, &intranode, &internode);
+  intrarank = 0;
+  if (intranode != sc_MPI_COMM_NULL) {
+    mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (level = 2; level < 5; level++) {
+    /* Start with a partition that is imbalanced in the number of elements */
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_init (&forest);
+    t8_forest_set_partition (forest,
+                             t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                                    (T8_ECLASS_QUAD,
+                                                     comm_nodes, 0, 0, 0),
+                                                    scheme, level, 0,
+                                                    comm_nodes), 0);
+    t8_forest_set_partition_weights (forest, t8_test_shmem_weight, NULL);
+    t8_forest_commit (forest);
+
+    t8_forest_ref (forest);
+    t8_forest_init (&forest_flat);
+    t8_forest_set_partition (forest_flat, forest, 0);
+    t8_forest_set_partition_tolerance (forest_flat, T8_TEST_TOLERANCE);
+    t8_forest_commit (forest_flat);
+    t8_forest_init (&forest_nodes);
+    t8_forest_set_partition (forest_nodes, forest, 0);
+    t8_forest_set_partition_tolerance (forest_nodes, T8_TEST_TOLERANCE);
+    t8_forest_set_partition_node_aware (forest_nodes, 1);
+    t8_forest_commit (forest_nodes);
+
+    if (intrarank == 0) {
+      SC_CHECK_ABORT (t8_forest_get_first_local_element_id (forest_nodes)
+                      == t8_forest_get_first_local_element_id (forest_flat),
+                      "Node aware partition moved a node boundary");
+    }
+    average = t8_forest_get_global_num_elements (forest_nodes)
+      / (double) forest_nodes->mpisize;
+    num_local = t8_forest_get_local_num_elements (forest_nodes);
+    SC_CHECK_ABORT (fabs (num_local - average)
+                    <= T8_TEST_TOLERANCE * average + 2,
+                    "Node aware partition is not balanced");
+    t8_forest_unref (&forest_flat);
+    t8_forest_unref (&forest_nodes);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+static void
+t8_test_shmem_ghost_exchange (sc_MPI_Comm comm_nodes)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  sc_array_t          element_data;
+  t8_locidx_t         itree, ielement, num_elements, num_ghosts;
+  t8_linearidx_t      id;
+  size_t              index;
+  int                 level;
+
+  for (level = 1; level < 4; level++) {
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_init (&forest);
+    t8_forest_set_cmesh (forest, t8_cmesh_new_hypercube (T8_ECLASS_TET,
+                                                         comm_nodes, 0, 0, 0),
+                         comm_nodes);
+    t8_forest_set_scheme (forest, scheme);
+    t8_forest_set_level (forest, level);
+    t8_forest_set_ghost (forest, 1, T8_GHOST_FACES);
+    t8_forest_set_ghost_shmem (forest, 1);
+    t8_forest_commit (forest);
+
+    num_elements = t8_forest_get_local_num_elements (forest);
+    num_ghosts = t8_forest_get_num_ghosts (forest);
+    sc_array_init_size (&element_data, sizeof (t8_linearidx_t),
+                        num_elements + num_ghosts);
+    /* Store the linear id of each local element */
+    index = 0;
+    for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_get_tree_class (forest,
+                                                                  itree));
+      for (ielement = 0;
+           ielement < t8_forest_get_tree_num_elements (forest, itree);
+           ielement++, index++) {
+        element = t8_forest_get_element_in_tree (forest, itree, ielement);
+        *(t8_linearidx_t *) sc_array_index (&element_data, index) =
+          ts->t8_element_get_linear_id (element, level);
+      }
+    }
+    t8_forest_ghost_exchange_data (forest, &element_data);
+    /* Check that each ghost received its linear id */
+    for (itree = 0; itree < t8_forest_get_num_ghost_trees (forest); itree++) {
+      ts = t8_forest_get_eclass_scheme (forest,
+                                        t8_forest_ghost_get_tree_class
+                                        (forest, itree));
+      for (ielement = 0;
+           ielement < t8_forest_ghost_tree_num_elements (forest, itree);
+           ielement++, index++) {
+        element = t8_forest_ghost_get_element (forest, itree, ielement);
+        id = *(t8_linearidx_t *) sc_array_index (&element_data, index);
+        SC_CHECK_ABORT (id == ts->t8_element_get_linear_id (element, level),
+                        "Wrong ghost data in shared memory exchange");
+      }
+    }
+    sc_array_reset (&element_data);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+/* Check that a communicator without node communicators gets the basic
+ * shmem type and that its arrays work */
+static void
+t8_test_shmem_flat (void)
+{
+  sc_MPI_Comm         comm_flat;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &comm_flat);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (t8_shmem_set_type (comm_flat, T8_SHMEM_BEST_TYPE),
+                  "Could not set shmem type");
+  SC_CHECK_ABORT (sc_shmem_get_type (comm_flat) == SC_SHMEM_BASIC,
+                  "Expected basic shmem type without node communicators");
+  t8_test_shmem_array (comm_flat);
+  mpiret = sc_MPI_Comm_free (&comm_flat);
+  SC_CHECK_MPI (mpiret);
+}
+
+int
+main (int argc, char **argv)
+{
+  sc_MPI_Comm         comm_nodes;
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &comm_nodes);
+  SC_CHECK_MPI (mpiret);
+  t8_shmem_init (comm_nodes);
+  t8_shmem_set_type (comm_nodes, T8_SHMEM_BEST_TYPE);
+
+  t8_global_productionf ("Testing node shared memory arrays.\n");
+  t8_test_shmem_array (comm_nodes);
+  t8_test_shmem_forest (sc_MPI_COMM_WORLD, comm_nodes);
+  t8_test_shmem_node_aware (comm_nodes);
+  t8_test_shmem_ghost_exchange (comm_nodes);
+  t8_test_shmem_flat ();
+  t8_global_productionf ("Done testing node shared memory arrays.\n");
+
+  t8_shmem_finalize (comm_nodes);
+  mpiret = sc_MPI_Comm_free (&comm_nodes);
+  SC_CHECK_MPI (mpiret);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_iterate.h>
+#include <t8_element_cxx.hxx>
+
+/*
+ * In this file we test the sorting of points onto the partition of a forest.
+ * Each process creates points at the centroids of some elements that are
+ * finer than the leaves of a uniform forest, in reverse order. After sorting,
+ * each point must be in the local leaf that contains its element and the
+ * points must be sorted by tree and key.
+ */
+
+/* A point that remembers the element at whose centroid it was created */
+typedef struct
+{
+  t8_forest_point_t   point;
+  t8_linearidx_t      element_id;
+} t8_test_point_t;
+
+static void
+t8_test_sort_points_check (t8_forest_t forest, int level, sc_MPI_Comm comm)
+{
+  t8_cmesh_t          cmesh = t8_forest_get_cmesh (forest);
+  t8_eclass_scheme_c *ts;
+  t8_eclass_t         eclass;
+  t8_element_t       *element, *key_element, *nca, *leaf;
+  t8_test_point_t    *tpoint;
+  const t8_test_point_t *prev;
+  t8_gloidx_t         gtreeid, num_global_points, num_points_after;
+  t8_gloidx_t         num_local, first_tree;
+  t8_linearidx_t      id, num_tree_elements;
+  t8_locidx_t         ltreeid;
+  sc_array_t          points;
+  size_t              ipoint;
+  int                 icorner, num_corners, i, coords[3], mpirank, mpisize;
+  int                 mpiret, maxlevel;
+
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* Create the points of every mpisize-th element, backwards */
+  sc_array_init (&points, sizeof (t8_test_point_t));
+  num_global_points = 0;
+  for (gtreeid = t8_forest_get_num_global_trees (forest) - 1; gtreeid >= 0;
+       gtreeid--) {
+    eclass = t8_cmesh_get_tree_class (cmesh, (t8_locidx_t) gtreeid);
+    ts = t8_forest_get_eclass_scheme (forest, eclass);
+    ts->t8_element_new (1, &element);
+    num_tree_elements = ts->t8_element_count_leafs_from_root (level);
+    num_global_points += num_tree_elements;
+    for (id = num_tree_elements; id-- > 0;) {
+      if ((int) (id % mpisize) != mpirank) {
+        continue;
+      }
+      ts->t8_element_set_linear_id (element, level, id);
+      tpoint = (t8_test_point_t *) sc_array_push (&points);
+      tpoint->point.gtreeid = gtreeid;
+      tpoint->element_id = id;
+      num_corners = ts->t8_element_num_corners (element);
+      for (i = 0; i < 3; i++) {
+        tpoint->point.ref_coords[i] = 0;
+      }
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        coords[0] = coords[1] = coords[2] = 0;
+        ts->t8_element_vertex_coords (element, icorner, coords);
+        for (i = 0; i < 3; i++) {
+          tpoint->point.ref_coords[i] += (double) coords[i]
+            / ts->t8_element_root_len (element) / num_corners;
+        }
+      }
+    }
+    ts->t8_element_destroy (1, &element);
+  }
+
+  t8_forest_sort_points (forest, &points);
+
+  /* Check that all points arrived in the right leaves in order */
+  num_local = (t8_gloidx_t) points.elem_count;
+  mpiret = sc_MPI_Allreduce (&num_local, &num_points_after, 1,
+                             T8_MPI_GLOIDX, sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (num_points_after == num_global_points,
+                  "Points were lost while sorting.");
+  maxlevel = t8_forest_get_maxlevel (forest);
+  first_tree = t8_forest_get_first_local_tree_id (forest);
+  for (ipoint = 0; ipoint < points.elem_count; ipoint++) {
+    tpoint = (t8_test_point_t *) sc_array_index (&points, ipoint);
+    if (ipoint > 0) {
+      prev = (const t8_test_point_t *) sc_array_index (&points, ipoint - 1);
+      SC_CHECK_ABORT (prev->point.gtreeid < tpoint->point.gtreeid
+                      || (prev->point.gtreeid == tpoint->point.gtreeid
+                          && prev->point.key <= tpoint->point.key),
+                      "Points are not sorted.");
+    }
+    ltreeid = (t8_locidx_t) (tpoint->point.gtreeid - first_tree);
+    SC_CHECK_ABORT (0 <= ltreeid
+                    && ltreeid < t8_forest_get_num_local_trees (forest),
+                    "Point is not in a local tree.");
+    eclass = t8_forest_get_tree_class (forest, ltreeid);
+    ts = t8_forest_get_eclass_scheme (forest, eclass);
+    ts->t8_element_new (1, &element);
+    ts->t8_element_new (1, &key_element);
+    ts->t8_element_new (1, &nca);
+    ts->t8_element_set_linear_id (key_element, maxlevel,
+                                  tpoint->point.key);
+    /* The key lies in the element of the point */
+    ts->t8_element_set_linear_id (element, level, tpoint->element_id);
+    ts->t8_element_nca (element, key_element, nca);
+    SC_CHECK_ABORT (!ts->t8_element_compare (element, nca),
+                    "Wrong key of a point.");
+    /* and in the leaf of the point */
+    leaf = t8_forest_get_element (forest, tpoint->point.lelement_id, NULL);
+    ts->t8_element_nca (leaf, key_element, nca);
+    SC_CHECK_ABORT (!ts->t8_element_compare (leaf, nca),
+                    "Wrong leaf of a point.");
+    ts->t8_element_destroy (1, &element);
+    ts->t8_element_destroy (1, &key_element);
+    ts->t8_element_destroy (1, &nca);
+  }
+  sc_array_reset (&points);
+}
+
+static void
+t8_test_sort_points (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_cmesh_t          cmesh;
+  t8_forest_t         forest;
+  int                 eclass;
+  const int           level = 2;
+
+  for (eclass = T8_ECLASS_VERTEX; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    t8_scheme_cxx_ref (scheme);
+    t8_forest_init (&forest);
+    t8_forest_set_cmesh (forest, cmesh, comm);
+    t8_forest_set_scheme (forest, scheme);
+    t8_forest_set_level (forest, level);
+    t8_forest_commit (forest);
+    t8_test_sort_points_check (forest, level + 1, comm);
+    t8_forest_unref (&forest);
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing the sorting of points.\n");
+  t8_test_sort_points (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing the sorting of points.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
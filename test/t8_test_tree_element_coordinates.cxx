@@ -0,0 +1,241 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest/t8_forest_ghost.h>
+
+/*
+ * In this file we test that the coordinates computed for all corners of
+ * a tree at once match the coordinates computed corner by corner with
+ * t8_forest_element_coordinate.
+ * We also compare with t8_forest_element_coordinate for a copy of the tree
+ * vertices, for which the precomputed map of the tree is not used.
+ * Finally we check that the nodes of the elements at the reference corners
+ * are the corners of the elements.
+ * For the ghost trees, the cached vertices must be those of the cmesh and
+ * their maps must match t8_forest_element_coordinate.
+ */
+
+static void
+test_tree_element_coordinates_forest (t8_forest_t forest)
+{
+  t8_locidx_t         itree, ielem, num_elements, num_corners, ipoint;
+  t8_eclass_scheme_c *ts;
+  t8_element_t       *element;
+  double             *tree_vertices;
+  double             *coordinates;
+  double              element_coordinates[3], vertex_coordinates[3];
+  double              vertices_copy[T8_ECLASS_MAX_CORNERS * 3];
+  int                 icorner, i;
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    SC_CHECK_ABORT (t8_forest_get_tree_map (forest, itree) != NULL,
+                    "No map computed for tree");
+    memcpy (vertices_copy, tree_vertices, 3 * sizeof (double)
+            * t8_eclass_num_vertices[t8_forest_get_tree_class (forest,
+                                                                itree)]);
+    num_corners = t8_forest_get_tree_num_corners (forest, itree);
+    coordinates = T8_ALLOC (double, 3 * num_corners);
+    t8_forest_tree_element_coordinates (forest, itree, coordinates);
+
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0, ipoint = 0; ielem < num_elements; ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      for (icorner = 0; icorner < ts->t8_element_num_corners (element);
+           icorner++, ipoint++) {
+        SC_CHECK_ABORT (ipoint < num_corners, "Too few corners computed");
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      icorner, element_coordinates);
+        t8_forest_element_coordinate (forest, itree, element, vertices_copy,
+                                      icorner, vertex_coordinates);
+        for (i = 0; i < 3; i++) {
+          SC_CHECK_ABORT (fabs (element_coordinates[i] -
+                                coordinates[3 * ipoint + i]) < 1e-12,
+                          "Wrong corner coordinates computed");
+          SC_CHECK_ABORT (fabs (element_coordinates[i] -
+                                vertex_coordinates[i]) < 1e-12,
+                          "Wrong precomputed tree map");
+        }
+      }
+    }
+    SC_CHECK_ABORT (ipoint == num_corners, "Too many corners computed");
+    T8_FREE (coordinates);
+  }
+}
+
+static void
+test_tree_element_coordinates_ghosts (t8_forest_t forest)
+{
+  t8_locidx_t         num_local_trees, ighost, itree, ielem, num_elements;
+  t8_element_t       *element;
+  double             *tree_vertices, *cmesh_vertices;
+  double              element_coordinates[3], vertex_coordinates[3];
+  double              vertices_copy[T8_ECLASS_MAX_CORNERS * 3];
+  t8_eclass_t         tree_class;
+  t8_eclass_scheme_c *ts;
+  int                 icorner, i;
+
+  num_local_trees = t8_forest_get_num_local_trees (forest);
+  for (ighost = 0; ighost < t8_forest_get_num_ghost_trees (forest);
+       ighost++) {
+    itree = num_local_trees + ighost;
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    ts = t8_forest_get_eclass_scheme (forest, tree_class);
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    cmesh_vertices =
+      t8_cmesh_get_tree_vertices (t8_forest_get_cmesh (forest),
+                                  t8_forest_ltreeid_to_cmesh_ltreeid (forest,
+                                                                      itree));
+    SC_CHECK_ABORT (tree_vertices == cmesh_vertices,
+                    "Wrong cached ghost tree vertices");
+    SC_CHECK_ABORT (t8_forest_get_tree_map (forest, itree) != NULL,
+                    "No map computed for ghost tree");
+    memcpy (vertices_copy, tree_vertices,
+            3 * sizeof (double) * t8_eclass_num_vertices[tree_class]);
+    num_elements = t8_forest_ghost_tree_num_elements (forest, ighost);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      element = t8_forest_ghost_get_element (forest, ighost, ielem);
+      for (icorner = 0; icorner < ts->t8_element_num_corners (element);
+           icorner++) {
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      icorner, element_coordinates);
+        t8_forest_element_coordinate (forest, itree, element, vertices_copy,
+                                      icorner, vertex_coordinates);
+        for (i = 0; i < 3; i++) {
+          SC_CHECK_ABORT (fabs (element_coordinates[i] -
+                                vertex_coordinates[i]) < 1e-12,
+                          "Wrong precomputed ghost tree map");
+        }
+      }
+    }
+  }
+}
+
+/* The corners of the reference elements in the order of
+ * t8_forest_element_coordinate, see t8_forest_tree_element_nodes */
+static const double t8_test_reference_corners[T8_ECLASS_COUNT][24] = {
+  {0, 0, 0},                    /* vertex */
+  {0, 0, 0, 1, 0, 0},           /* line */
+  {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0}, /* quad */
+  {0, 0, 0, 1, 0, 0, 1, 1, 0},  /* triangle */
+  {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0,
+   0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1}, /* hex */
+  {0, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1}, /* tet */
+  {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 1}, /* prism */
+  {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 1, 1} /* pyramid */
+};
+
+static void
+test_tree_element_nodes_forest (t8_forest_t forest)
+{
+  t8_locidx_t         itree, ielem, num_elements;
+  t8_eclass_t         tree_class;
+  t8_element_t       *element;
+  double             *tree_vertices;
+  double             *nodes;
+  double              element_coordinates[3];
+  int                 icorner, num_corners, i;
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    tree_class = t8_forest_get_tree_class (forest, itree);
+    if (tree_class == T8_ECLASS_PYRAMID) {
+      /* Pyramid trees also contain tets with fewer corners */
+      continue;
+    }
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    num_corners = t8_eclass_num_vertices[tree_class];
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    nodes = T8_ALLOC (double, 3 * num_corners * num_elements);
+    t8_forest_tree_element_nodes (forest, itree, num_corners,
+                                  t8_test_reference_corners[tree_class],
+                                  nodes);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      for (icorner = 0; icorner < num_corners; icorner++) {
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      icorner, element_coordinates);
+        for (i = 0; i < 3; i++) {
+          SC_CHECK_ABORT (fabs (element_coordinates[i] -
+                                nodes[3 * (num_corners * ielem + icorner)
+                                      + i]) < 1e-12,
+                          "Wrong element nodes computed");
+        }
+      }
+    }
+    T8_FREE (nodes);
+  }
+}
+
+static void
+test_tree_element_coordinates (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *ts = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest;
+  int                 eclass, level;
+  int                 maxlevel = 4;
+
+  for (eclass = T8_ECLASS_ZERO; eclass < T8_ECLASS_COUNT; ++eclass) {
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      t8_scheme_cxx_ref (ts);
+      forest =
+        t8_forest_new_uniform (t8_cmesh_new_hypercube
+                               ((t8_eclass_t) eclass, comm, 0, 0, 0), ts,
+                               level, eclass != T8_ECLASS_VERTEX, comm);
+      test_tree_element_coordinates_forest (forest);
+      test_tree_element_nodes_forest (forest);
+      test_tree_element_coordinates_ghosts (forest);
+      t8_forest_unref (&forest);
+    }
+  }
+  t8_scheme_cxx_unref (&ts);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing tree element coordinates.\n");
+  test_tree_element_coordinates (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing tree element coordinates.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,236 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_cmesh.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+
+/*
+ * In this file we test t8_forest_leaf_face_neighbors for unbalanced forests.
+ * On uniform forests we compare the result with the balanced algorithm.
+ * We then refine the forests without balancing them and check that
+ * the face neighbor relation between the local leafs is symmetric and
+ * that neighbors across the same face cover the face only once.
+ * We also check that t8_forest_leaf_face_neighbors_workspace computes
+ * the same neighbors.
+ */
+
+/* Refine the first element of each tree up to level 4, such that the
+ * forest is not balanced. */
+static int
+t8_test_unbalanced_adapt (t8_forest_t forest, t8_forest_t forest_from,
+                          t8_locidx_t which_tree, t8_locidx_t lelement_id,
+                          t8_eclass_scheme_c * ts, int num_elements,
+                          t8_element_t * elements[])
+{
+  return ts->t8_element_level (elements[0]) < 4
+    && ts->t8_element_child_id (elements[0]) == 0;
+}
+
+/* Return true if the face neighbors of the local element with index
+ * lelement across the face face contain the local element with index
+ * neighbor. */
+static int
+t8_test_unbalanced_has_neighbor (t8_forest_t forest, t8_locidx_t lelement,
+                                 int face, t8_locidx_t neighbor)
+{
+  t8_locidx_t         ltreeid, *element_indices;
+  t8_element_t       *element, **neighbor_leafs;
+  t8_eclass_scheme_c *neigh_scheme;
+  int                *dual_faces;
+  int                 num_neighbors, ineigh, found = 0;
+
+  element = t8_forest_get_element (forest, lelement, &ltreeid);
+  t8_forest_leaf_face_neighbors (forest, ltreeid, element, &neighbor_leafs,
+                                 face, &dual_faces, &num_neighbors,
+                                 &element_indices, &neigh_scheme, 0);
+  for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+    found = found || element_indices[ineigh] == neighbor;
+  }
+  if (num_neighbors > 0) {
+    neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+    T8_FREE (element_indices);
+    T8_FREE (neighbor_leafs);
+    T8_FREE (dual_faces);
+  }
+  return found;
+}
+
+/* Check the unbalanced face neighbors of all local leafs. If compare is
+ * true, the forest is balanced and we compare with the balanced algorithm. */
+static void
+t8_test_unbalanced_check (t8_forest_t forest, int compare)
+{
+  t8_forest_face_neighbor_workspace_t workspace;
+  t8_locidx_t         itree, ielem, num_elements, lelement;
+  t8_locidx_t        *element_indices, *balanced_indices;
+  const t8_locidx_t  *workspace_indices;
+  t8_eclass_scheme_c *ts, *neigh_scheme, *workspace_scheme;
+  t8_element_t       *element, **neighbor_leafs, **balanced_leafs;
+  t8_element_t      **workspace_leafs;
+  int                *dual_faces, *balanced_dual_faces;
+  const int          *workspace_dual_faces;
+  int                 iface, num_faces, num_neighbors, num_balanced;
+  int                 ineigh, jneigh, found;
+
+  workspace = t8_forest_face_neighbor_workspace_new (forest);
+  lelement = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    num_elements = t8_forest_get_tree_num_elements (forest, itree);
+    for (ielem = 0; ielem < num_elements; ielem++, lelement++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_faces = ts->t8_element_num_faces (element);
+      for (iface = 0; iface < num_faces; iface++) {
+        t8_forest_leaf_face_neighbors (forest, itree, element,
+                                       &neighbor_leafs, iface, &dual_faces,
+                                       &num_neighbors, &element_indices,
+                                       &neigh_scheme, 0);
+        for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          SC_CHECK_ABORT (element_indices[ineigh] != lelement,
+                          "Element is its own face neighbor");
+          if (element_indices[ineigh] <
+              t8_forest_get_local_num_elements (forest)) {
+            /* The neighbor is local, it must have us as neighbor */
+            SC_CHECK_ABORT (t8_test_unbalanced_has_neighbor
+                            (forest, element_indices[ineigh],
+                             dual_faces[ineigh], lelement),
+                            "Face neighbor relation is not symmetric");
+          }
+          if (num_neighbors > 1) {
+            /* Neighbors that are not the only ones are smaller than
+             * the element */
+            SC_CHECK_ABORT (neigh_scheme->t8_element_level
+                            (neighbor_leafs[ineigh]) >
+                            ts->t8_element_level (element),
+                            "Wrong level of face neighbor");
+          }
+        }
+        /* The workspace version finds the same neighbors in the same order */
+        SC_CHECK_ABORT (num_neighbors ==
+                        t8_forest_leaf_face_neighbors_workspace
+                        (forest, itree, element, iface, workspace,
+                         &workspace_leafs, &workspace_dual_faces,
+                         &workspace_indices, &workspace_scheme, 0),
+                        "Wrong number of workspace face neighbors");
+        for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+          SC_CHECK_ABORT (workspace_indices[ineigh] == element_indices[ineigh]
+                          && workspace_dual_faces[ineigh] ==
+                          dual_faces[ineigh]
+                          && !workspace_scheme->t8_element_compare
+                          (workspace_leafs[ineigh], neighbor_leafs[ineigh]),
+                          "Wrong workspace face neighbor");
+        }
+        if (compare) {
+          t8_forest_leaf_face_neighbors (forest, itree, element,
+                                         &balanced_leafs, iface,
+                                         &balanced_dual_faces,
+                                         &num_balanced, &balanced_indices,
+                                         &neigh_scheme, 1);
+          SC_CHECK_ABORT (num_balanced == num_neighbors,
+                          "Wrong number of unbalanced face neighbors");
+          for (ineigh = 0; ineigh < num_neighbors; ineigh++) {
+            /* The neighbors may be in a different order */
+            for (jneigh = 0, found = 0; jneigh < num_neighbors; jneigh++) {
+              found = found ||
+                (element_indices[ineigh] == balanced_indices[jneigh]
+                 && dual_faces[ineigh] == balanced_dual_faces[jneigh]);
+            }
+            SC_CHECK_ABORT (found, "Wrong unbalanced face neighbor");
+          }
+          if (num_balanced > 0) {
+            neigh_scheme->t8_element_destroy (num_balanced, balanced_leafs);
+            T8_FREE (balanced_indices);
+            T8_FREE (balanced_leafs);
+            T8_FREE (balanced_dual_faces);
+          }
+        }
+        if (num_neighbors > 0) {
+          neigh_scheme->t8_element_destroy (num_neighbors, neighbor_leafs);
+          T8_FREE (element_indices);
+          T8_FREE (neighbor_leafs);
+          T8_FREE (dual_faces);
+        }
+      }
+    }
+  }
+  t8_forest_face_neighbor_workspace_destroy (&workspace);
+}
+
+static void
+t8_test_unbalanced_face_neighbors (sc_MPI_Comm comm)
+{
+  t8_scheme_cxx_t    *scheme = t8_scheme_new_default_cxx ();
+  t8_forest_t         forest, forest_adapt;
+  int                 eclass, level;
+  int                 maxlevel = 3;
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; ++eclass) {
+    if (eclass == T8_ECLASS_PYRAMID) {
+      /* Face neighbors of pyramids are not supported yet */
+      continue;
+    }
+    t8_debugf ("Testing eclass %s\n", t8_eclass_to_string[eclass]);
+    for (level = 0; level < maxlevel; ++level) {
+      /* Build a uniform forest with ghosts */
+      t8_scheme_cxx_ref (scheme);
+      forest = t8_forest_new_uniform (t8_cmesh_new_hypercube
+                                      ((t8_eclass_t) eclass, comm, 0, 0, 0),
+                                      scheme, level, 1, comm);
+      t8_test_unbalanced_check (forest, 1);
+
+      /* Refine the forest without balancing it */
+      forest_adapt =
+        t8_forest_new_adapt (forest, t8_test_unbalanced_adapt, 1, 1, NULL);
+      t8_test_unbalanced_check (forest_adapt, 0);
+      t8_forest_unref (&forest_adapt);
+    }
+  }
+  t8_scheme_cxx_unref (&scheme);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing unbalanced leaf face neighbors.\n");
+  t8_test_unbalanced_face_neighbors (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing unbalanced leaf face neighbors.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,339 @@
+/*
+  This file is part of t8code.
+  t8code is a C library to manage a collection (a forest) of multiple
+  connected adaptive space-trees of general element classes in parallel.
+
+  Copyright (C) 2015 the developers
+
+  t8code is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  t8code is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with t8code; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <t8.h>
+#include <t8_schemes/t8_default_cxx.hxx>
+#include <t8_forest.h>
+#include <t8_forest_vtk.h>
+
+/*
+ * In this file we test the binary vtk output of a forest.
+ * We write uniform forests with all element data fields in ascii, binary and
+ * compressed format. For binary output we read back the header of the first
+ * appended data array, the point positions, and check its size.
+ * We also write all pieces into a single file with MPI I/O and check that
+ * the file contains one piece per process. Finally, we write the files
+ * in the background and overwrite the data fields while doing so.
+ * With shared vertices, the position array must contain each distinct
+ * corner position once. With a reduced level of detail, it must contain
+ * the corners of the ancestors of the elements.
+ */
+
+/* Count the distinct corner positions of the local elements */
+static              uint64_t
+t8_test_vtk_binary_num_shared_points (t8_forest_t forest)
+{
+  double             *coordinates, *tree_vertices;
+  t8_element_t       *element;
+  t8_locidx_t         itree, ielem;
+  t8_eclass_scheme_c *ts;
+  size_t              num_corners, icorner, jcorner;
+  uint64_t            num_points;
+  int                 num_element_corners, ic;
+
+  coordinates = T8_ALLOC (double, 3 * T8_ECLASS_MAX_CORNERS
+                          * t8_forest_get_local_num_elements (forest));
+  num_corners = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    tree_vertices = t8_forest_get_tree_vertices (forest, itree);
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      num_element_corners = ts->t8_element_num_corners (element);
+      for (ic = 0; ic < num_element_corners; ic++, num_corners++) {
+        t8_forest_element_coordinate (forest, itree, element, tree_vertices,
+                                      ic, coordinates + 3 * num_corners);
+      }
+    }
+  }
+  /* Compare each corner with all previous ones */
+  for (icorner = 0, num_points = 0; icorner < num_corners; icorner++) {
+    for (jcorner = 0; jcorner < icorner; jcorner++) {
+      if (fabs (coordinates[3 * icorner] - coordinates[3 * jcorner]) < 1e-10
+          && fabs (coordinates[3 * icorner + 1]
+                   - coordinates[3 * jcorner + 1]) < 1e-10
+          && fabs (coordinates[3 * icorner + 2]
+                   - coordinates[3 * jcorner + 2]) < 1e-10) {
+        break;
+      }
+    }
+    num_points += jcorner == icorner;
+  }
+  T8_FREE (coordinates);
+  return num_points;
+}
+
+/* Count the corners of the ancestors at level \a maxlevel of the local
+ * elements. Each ancestor is counted once. */
+static              uint64_t
+t8_test_vtk_binary_num_lod_points (t8_forest_t forest, int maxlevel)
+{
+  t8_element_t       *element, *ancestor, *last;
+  t8_locidx_t         itree, ielem;
+  t8_eclass_scheme_c *ts;
+  uint64_t            num_points = 0;
+
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest); itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    ts->t8_element_new (1, &ancestor);
+    ts->t8_element_new (1, &last);
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++) {
+      element = t8_forest_get_element_in_tree (forest, itree, ielem);
+      ts->t8_element_copy (element, ancestor);
+      while (ts->t8_element_level (ancestor) > maxlevel) {
+        ts->t8_element_parent (ancestor, ancestor);
+      }
+      if (ielem == 0 || ts->t8_element_compare (ancestor, last)) {
+        num_points += ts->t8_element_num_corners (ancestor);
+        ts->t8_element_copy (ancestor, last);
+      }
+    }
+    ts->t8_element_destroy (1, &ancestor);
+    ts->t8_element_destroy (1, &last);
+  }
+  return num_points;
+}
+
+/* Return the number of bytes of the position array in a binary .vtu file */
+static              uint64_t
+t8_test_vtk_binary_position_bytes (t8_forest_t forest, const char *fileprefix)
+{
+  const char          marker[] = "<AppendedData encoding=\"raw\">\n   _";
+  char                vtufilename[BUFSIZ], *contents, *start;
+  FILE               *vtufile;
+  long                file_size;
+  uint64_t            num_bytes;
+  int                 mpirank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (t8_forest_get_mpicomm (forest), &mpirank);
+  SC_CHECK_MPI (mpiret);
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, mpirank);
+  vtufile = fopen (vtufilename, "rb");
+  SC_CHECK_ABORT (vtufile != NULL, "Could not open vtu file");
+  fseek (vtufile, 0, SEEK_END);
+  file_size = ftell (vtufile);
+  fseek (vtufile, 0, SEEK_SET);
+  contents = T8_ALLOC (char, file_size + 1);
+  SC_CHECK_ABORT (fread (contents, 1, file_size, vtufile)
+                  == (size_t) file_size, "Could not read vtu file");
+  contents[file_size] = '\0';
+  fclose (vtufile);
+
+  /* The position array is the first one in the appended data section */
+  start = strstr (contents, marker);
+  SC_CHECK_ABORT (start != NULL, "No appended data in vtu file");
+  start += strlen (marker);
+  SC_CHECK_ABORT (start + sizeof (uint64_t) <= contents + file_size,
+                  "Appended data too short");
+  memcpy (&num_bytes, start, sizeof (uint64_t));
+  T8_FREE (contents);
+  return num_bytes;
+}
+
+/* Check the number of bytes of the position array in a binary .vtu file */
+static void
+t8_test_vtk_binary_check_file (t8_forest_t forest, const char *fileprefix,
+                               int shared_vertices)
+{
+  uint64_t            num_bytes, num_points;
+  t8_locidx_t         itree, ielem;
+  t8_eclass_scheme_c *ts;
+
+  num_bytes = t8_test_vtk_binary_position_bytes (forest, fileprefix);
+  num_points = 0;
+  for (itree = 0; itree < t8_forest_get_num_local_trees (forest)
+       && !shared_vertices; itree++) {
+    ts = t8_forest_get_eclass_scheme (forest,
+                                      t8_forest_get_tree_class (forest,
+                                                                itree));
+    for (ielem = 0; ielem < t8_forest_get_tree_num_elements (forest, itree);
+         ielem++) {
+      num_points +=
+        ts->t8_element_num_corners (t8_forest_get_element_in_tree
+                                    (forest, itree, ielem));
+    }
+  }
+  if (shared_vertices) {
+    num_points = t8_test_vtk_binary_num_shared_points (forest);
+  }
+  SC_CHECK_ABORT (num_bytes == 3 * num_points * sizeof (T8_VTK_FLOAT_TYPE),
+                  "Wrong size of binary position array");
+}
+
+#ifdef T8_ENABLE_MPIIO
+/* Count the pieces in the first .vtu file of a prefix. We only read the
+ * part of the file in front of the appended data. */
+static int
+t8_test_vtk_binary_count_pieces (const char *fileprefix)
+{
+  char                vtufilename[BUFSIZ], line[BUFSIZ];
+  FILE               *vtufile;
+  int                 num_pieces = 0;
+
+  snprintf (vtufilename, BUFSIZ, "%s_%04d.vtu", fileprefix, 0);
+  vtufile = fopen (vtufilename, "rb");
+  SC_CHECK_ABORT (vtufile != NULL, "Could not open vtu file");
+  while (fgets (line, BUFSIZ, vtufile) != NULL
+         && strstr (line, "<AppendedData") == NULL) {
+    num_pieces += strstr (line, "<Piece ") != NULL;
+  }
+  fclose (vtufile);
+  return num_pieces;
+}
+#endif
+
+static void
+t8_test_vtk_binary (sc_MPI_Comm comm)
+{
+  t8_forest_t         forest;
+  t8_cmesh_t          cmesh;
+  t8_vtk_data_field_t fields[2];
+  double             *scalars, *vectors;
+  t8_locidx_t         num_elements, ielem;
+  t8_forest_vtk_async_t async;
+  const char         *fileprefix = "t8_test_vtk_binary";
+  int                 eclass, level = 2;
+  int                 mpirank, mpiret;
+#ifdef T8_ENABLE_MPIIO
+  int                 mpisize;
+#endif
+
+  for (eclass = T8_ECLASS_LINE; eclass < T8_ECLASS_COUNT; eclass++) {
+    cmesh = t8_cmesh_new_hypercube ((t8_eclass_t) eclass, comm, 0, 0, 0);
+    forest = t8_forest_new_uniform (cmesh, t8_scheme_new_default_cxx (),
+                                    level, 1, comm);
+    num_elements = t8_forest_get_local_num_elements (forest);
+    scalars = T8_ALLOC (double, num_elements);
+    vectors = T8_ALLOC (double, 3 * num_elements);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      scalars[ielem] = ielem;
+      vectors[3 * ielem] = vectors[3 * ielem + 1] = vectors[3 * ielem + 2] =
+        ielem;
+    }
+    fields[0].type = T8_VTK_SCALAR;
+    snprintf (fields[0].description, BUFSIZ, "scalar");
+    fields[0].data = scalars;
+    fields[1].type = T8_VTK_VECTOR;
+    snprintf (fields[1].description, BUFSIZ, "vector");
+    fields[1].data = vectors;
+
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_format
+                    (forest, fileprefix, 1, 1, 1, 1, 1, 0, 2, fields,
+                     T8_VTK_FORMAT_ASCII), "Error writing ascii vtk file");
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_format
+                    (forest, fileprefix, 1, 1, 1, 1, 1, 0, 2, fields,
+                     T8_VTK_FORMAT_COMPRESSED),
+                    "Error writing compressed vtk file");
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_format
+                    (forest, fileprefix, 1, 1, 1, 1, 0, 0, 2, fields,
+                     T8_VTK_FORMAT_BINARY), "Error writing binary vtk file");
+    t8_test_vtk_binary_check_file (forest, fileprefix, 0);
+
+    /* Write each vertex once */
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_format
+                    (forest, fileprefix, 1, 1, 1, 1, 1, 1, 2, fields,
+                     T8_VTK_FORMAT_ASCII),
+                    "Error writing ascii vtk file with shared vertices");
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_format
+                    (forest, fileprefix, 1, 1, 1, 1, 0, 1, 2, fields,
+                     T8_VTK_FORMAT_BINARY),
+                    "Error writing binary vtk file with shared vertices");
+    t8_test_vtk_binary_check_file (forest, fileprefix, 1);
+
+    /* Write the ancestors at level - 1 in double precision */
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_lod
+                    (forest, fileprefix, 1, 1, 1, 2, fields,
+                     T8_VTK_FORMAT_ASCII, 1, level - 1),
+                    "Error writing ascii level of detail vtk file");
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_lod
+                    (forest, fileprefix, 1, 1, 1, 2, fields,
+                     T8_VTK_FORMAT_BINARY, 0, level - 1),
+                    "Error writing binary level of detail vtk file");
+    SC_CHECK_ABORT (t8_test_vtk_binary_position_bytes (forest, fileprefix)
+                    == 3 * t8_test_vtk_binary_num_lod_points (forest,
+                                                              level - 1)
+                    * sizeof (double),
+                    "Wrong size of level of detail position array");
+
+    /* Write one file with all pieces. Its first array belongs to rank 0. */
+    SC_CHECK_ABORT (t8_forest_vtk_write_file_mpiio
+                    (forest, fileprefix, 1, 1, 1, 1, 0, 0, 2, fields,
+                     T8_VTK_FORMAT_BINARY, 1),
+                    "Error writing vtk file with MPI I/O");
+    mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+    SC_CHECK_MPI (mpiret);
+    if (mpirank == 0) {
+      t8_test_vtk_binary_check_file (forest, fileprefix, 0);
+#ifdef T8_ENABLE_MPIIO
+      mpiret = sc_MPI_Comm_size (comm, &mpisize);
+      SC_CHECK_MPI (mpiret);
+      SC_CHECK_ABORT (t8_test_vtk_binary_count_pieces (fileprefix)
+                      == mpisize, "Wrong number of pieces in vtu file");
+#endif
+    }
+
+    /* The output must not depend on the fields after the call returned */
+    async = t8_forest_vtk_write_file_async (forest, fileprefix, 1, 1, 1, 1, 0,
+                                            0, 2, fields,
+                                            T8_VTK_FORMAT_BINARY);
+    for (ielem = 0; ielem < num_elements; ielem++) {
+      scalars[ielem] = -1;
+    }
+    SC_CHECK_ABORT (t8_forest_vtk_async_wait (&async) && async == NULL,
+                    "Error writing vtk file in the background");
+    t8_test_vtk_binary_check_file (forest, fileprefix, 0);
+
+    T8_FREE (scalars);
+    T8_FREE (vectors);
+    t8_forest_unref (&forest);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_PRODUCTION);
+  p4est_init (NULL, SC_LP_ESSENTIAL);
+  t8_init (SC_LP_DEFAULT);
+
+  t8_global_productionf ("Testing binary vtk output.\n");
+  t8_test_vtk_binary (sc_MPI_COMM_WORLD);
+  t8_global_productionf ("Done testing binary vtk output.\n");
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}